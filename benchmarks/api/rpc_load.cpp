@@ -0,0 +1,435 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <array>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include "api/rpc/ws.hpp"
+#include "primitives/address/address_codec.hpp"
+#include "primitives/tipset/tipset.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "vm/state/impl/state_tree_impl.hpp"
+
+namespace fc::api {
+  namespace beast = boost::beast;
+  namespace websocket = beast::websocket;
+  namespace net = boost::asio;
+  using markets::storage::StorageDeal;
+  using primitives::address::Address;
+  using primitives::block::BlockHeader;
+  using primitives::tipset::HeadChangeType;
+  using storage::ipfs::InMemoryDatastore;
+  using tcp = net::ip::tcp;
+  using vm::actor::Actor;
+  using vm::state::StateTreeImpl;
+  using Clock = std::chrono::steady_clock;
+
+  /// Latency histogram with power of two microsecond buckets
+  struct Histogram {
+    void add(Clock::duration time) {
+      auto us{static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(time).count())};
+      size_t bucket{0};
+      while (us != 0 && bucket + 1 < buckets.size()) {
+        us >>= 1;
+        ++bucket;
+      }
+      ++buckets[bucket];
+      ++count;
+    }
+
+    void merge(const Histogram &other) {
+      for (size_t i{0}; i < buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+      }
+      count += other.count;
+      errors += other.errors;
+    }
+
+    /// Upper bound of bucket containing percentile, microseconds
+    uint64_t percentile(double p) const {
+      auto rank{static_cast<uint64_t>(p * count)};
+      uint64_t seen{0};
+      for (size_t i{0}; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen > rank) {
+          return uint64_t{1} << i;
+        }
+      }
+      return uint64_t{1} << (buckets.size() - 1);
+    }
+
+    std::array<uint64_t, 32> buckets{};
+    uint64_t count{};
+    uint64_t errors{};
+  };
+
+  struct LoadConfig {
+    std::string host{"127.0.0.1"};
+    std::string port{"1234"};
+    /// Serve synthetic api in process instead of connecting to node
+    bool in_process{true};
+    size_t sessions{16};
+    /// Requests of each session
+    size_t requests{1000};
+    uint64_t seed{};
+    size_t dispatcher_threads{rpc::DispatcherConfig{}.threads};
+    size_t tipsets{100};
+    size_t deals{1000};
+    std::string actor;
+    std::string miner;
+    /// Method weights of request mix
+    std::map<std::string, double> weights{
+        {"ChainHead", 30},
+        {"ChainGetTipSet", 25},
+        {"StateGetActor", 25},
+        {"StateMinerPower", 15},
+        {"StateMarketDeals", 1},
+        {"ChainNotify", 4},
+    };
+  };
+
+  /**
+   * Synthetic node: chain of tipsets and state tree in memory datastore,
+   * fixed miner power and market deals. Methods are cheap, so load measures
+   * rpc server and dispatcher overhead.
+   */
+  outcome::result<Api> makeSyntheticApi(LoadConfig &config) {
+    auto ipld{std::make_shared<InMemoryDatastore>()};
+    StateTreeImpl tree{ipld};
+    auto miner{Address::makeFromId(1000)};
+    auto market{Address::makeFromId(5)};
+    OUTCOME_TRY(tree.set(miner,
+                         {vm::actor::kStorageMinerCodeCid, {}, 0, 1000}));
+    OUTCOME_TRY(tree.set(market,
+                         {vm::actor::kStorageMarketCodeCid, {}, 0, 1000}));
+    OUTCOME_TRY(state_root, tree.flush());
+    config.actor = primitives::address::encodeToString(market);
+    config.miner = primitives::address::encodeToString(miner);
+
+    Tipset head;
+    for (size_t height{0}; height < config.tipsets; ++height) {
+      BlockHeader block;
+      block.miner = miner;
+      block.parents = head.cids;
+      block.height = height;
+      block.parent_state_root = state_root;
+      block.parent_message_receipts = state_root;
+      block.messages = state_root;
+      OUTCOME_TRY(cid, ipld->setCbor(block));
+      OUTCOME_TRYA(head, Tipset::create({block}, {cid}));
+    }
+
+    auto deals{std::make_shared<MarketDealMap>()};
+    for (size_t i{0}; i < config.deals; ++i) {
+      StorageDeal deal{};
+      deal.proposal.piece_cid = state_root;
+      deal.proposal.piece_size = primitives::piece::PaddedPieceSize{2048};
+      deal.proposal.client = Address::makeFromId(2000 + i);
+      deal.proposal.provider = miner;
+      deal.proposal.start_epoch = 10;
+      deal.proposal.end_epoch = 1000;
+      (*deals)[std::to_string(i)] = std::move(deal);
+    }
+
+    Api api;
+    api.ChainHead = {[=]() -> outcome::result<Tipset> { return head; }};
+    api.ChainGetTipSet = {[=](auto &key) -> outcome::result<Tipset> {
+      return Tipset::load(*ipld, key.cids);
+    }};
+    api.ChainNotify = {[=]() {
+      auto channel{std::make_shared<Channel<std::vector<HeadChange>>>()};
+      channel->write({{HeadChangeType::CURRENT, head}});
+      return Chan{std::move(channel)};
+    }};
+    api.StateGetActor = {[=](auto &address, auto &key)
+                             -> outcome::result<Actor> {
+      OUTCOME_TRY(tipset, Tipset::load(*ipld, key.cids));
+      return StateTreeImpl{ipld, tipset.getParentStateRoot()}.get(address);
+    }};
+    api.StateMinerPower = {[=](auto &address, auto &key)
+                               -> outcome::result<MinerPower> {
+      StoragePower power{uint64_t{32} << 30};
+      StoragePower total{uint64_t{1} << 50};
+      return MinerPower{{power, power}, {total, total}};
+    }};
+    api.StateMarketDeals = {[=](auto &key) -> outcome::result<MarketDealMap> {
+      return *deals;
+    }};
+    return api;
+  }
+
+  /// Closed loop client, sends next request after response of previous one
+  class Session {
+   public:
+    Session(const LoadConfig &config, size_t index)
+        : config_(config),
+          socket_(ioc_),
+          random_(config.seed + index),
+          methods_(config.weights.size()) {
+      std::vector<double> weights;
+      size_t i{0};
+      for (const auto &[method, weight] : config.weights) {
+        methods_[i++] = method;
+        weights.push_back(weight);
+      }
+      pick_ = std::discrete_distribution<size_t>{weights.begin(),
+                                                 weights.end()};
+    }
+
+    bool connect() {
+      boost::system::error_code ec;
+      tcp::resolver resolver{ioc_};
+      auto endpoints{resolver.resolve(config_.host, config_.port, ec)};
+      if (!ec) {
+        net::connect(socket_.next_layer(), endpoints, ec);
+      }
+      if (!ec) {
+        socket_.handshake(config_.host, "/rpc/v0", ec);
+      }
+      if (ec) {
+        std::cerr << "cannot connect: " << ec.message() << std::endl;
+        return false;
+      }
+      // requests take tipset key of head
+      rapidjson::Document head;
+      if (!call("ChainHead", "[]", head) || !head.HasMember("result")) {
+        std::cerr << "cannot get chain head" << std::endl;
+        return false;
+      }
+      rapidjson::StringBuffer key;
+      rapidjson::Writer<rapidjson::StringBuffer> writer{key};
+      head["result"]["Cids"].Accept(writer);
+      key_ = key.GetString();
+      return true;
+    }
+
+    void run() {
+      for (size_t i{0}; i < config_.requests; ++i) {
+        auto &method{methods_[pick_(random_)]};
+        auto start{Clock::now()};
+        rapidjson::Document response;
+        if (!call(method, params(method), response)) {
+          return;
+        }
+        auto &histogram{stats[method]};
+        histogram.add(Clock::now() - start);
+        if (response.HasMember("error")) {
+          ++histogram.errors;
+        }
+      }
+    }
+
+    std::map<std::string, Histogram> stats;
+
+   private:
+    std::string params(const std::string &method) const {
+      if (method == "ChainGetTipSet" || method == "StateMarketDeals") {
+        return "[" + key_ + "]";
+      }
+      if (method == "StateGetActor") {
+        return R"([")" + config_.actor + R"(",)" + key_ + "]";
+      }
+      if (method == "StateMinerPower") {
+        return R"([")" + config_.miner + R"(",)" + key_ + "]";
+      }
+      return "[]";
+    }
+
+    /// Sends request and reads until its response, skips channel messages
+    bool call(const std::string &method,
+              const std::string &params,
+              rapidjson::Document &response) {
+      auto id{next_id_++};
+      auto request{R"({"jsonrpc":"2.0","id":)" + std::to_string(id)
+                   + R"(,"method":"Filecoin.)" + method + R"(","params":)"
+                   + params + "}"};
+      boost::system::error_code ec;
+      socket_.text(true);
+      socket_.write(net::buffer(request), ec);
+      while (!ec) {
+        beast::flat_buffer buffer;
+        socket_.read(buffer, ec);
+        if (ec) {
+          break;
+        }
+        response.Parse(static_cast<const char *>(buffer.cdata().data()),
+                       buffer.cdata().size());
+        if (response.HasParseError() || !response.IsObject()) {
+          std::cerr << "invalid response to " << method << std::endl;
+          return false;
+        }
+        if (!response.HasMember("method") && response.HasMember("id")
+            && response["id"].IsUint64() && response["id"].GetUint64() == id) {
+          return true;
+        }
+      }
+      std::cerr << method << ": " << ec.message() << std::endl;
+      return false;
+    }
+
+    const LoadConfig &config_;
+    net::io_context ioc_;
+    websocket::stream<tcp::socket> socket_;
+    std::mt19937_64 random_;
+    std::vector<std::string> methods_;
+    std::discrete_distribution<size_t> pick_;
+    std::string key_;
+    uint64_t next_id_{};
+  };
+
+  int load(int argc, char **argv) {
+    LoadConfig config;
+    for (auto i{1}; i < argc; ++i) {
+      auto has_value{i + 1 < argc};
+      if (!strcmp(argv[i], "--connect") && has_value) {
+        std::string address{argv[++i]};
+        auto colon{address.rfind(':')};
+        if (colon == std::string::npos) {
+          std::cerr << "address must be <host>:<port>" << std::endl;
+          return 1;
+        }
+        config.host = address.substr(0, colon);
+        config.port = address.substr(colon + 1);
+        config.in_process = false;
+      } else if (!strcmp(argv[i], "--port") && has_value) {
+        config.port = argv[++i];
+      } else if (!strcmp(argv[i], "--sessions") && has_value) {
+        config.sessions = std::stoull(argv[++i]);
+      } else if (!strcmp(argv[i], "--requests") && has_value) {
+        config.requests = std::stoull(argv[++i]);
+      } else if (!strcmp(argv[i], "--seed") && has_value) {
+        config.seed = std::stoull(argv[++i]);
+      } else if (!strcmp(argv[i], "--threads") && has_value) {
+        config.dispatcher_threads = std::stoull(argv[++i]);
+      } else if (!strcmp(argv[i], "--tipsets") && has_value) {
+        config.tipsets = std::max<size_t>(1, std::stoull(argv[++i]));
+      } else if (!strcmp(argv[i], "--deals") && has_value) {
+        config.deals = std::stoull(argv[++i]);
+      } else if (!strcmp(argv[i], "--actor") && has_value) {
+        config.actor = argv[++i];
+      } else if (!strcmp(argv[i], "--miner") && has_value) {
+        config.miner = argv[++i];
+      } else if (!strcmp(argv[i], "--weight") && has_value) {
+        std::string arg{argv[++i]};
+        auto eq{arg.find('=')};
+        if (eq == std::string::npos
+            || config.weights.count(arg.substr(0, eq)) == 0) {
+          std::cerr << "weight must be <method>=<weight> of known method"
+                    << std::endl;
+          return 1;
+        }
+        config.weights[arg.substr(0, eq)] = std::stod(arg.substr(eq + 1));
+      } else {
+        std::cerr << "usage: " << argv[0]
+                  << " [--connect HOST:PORT --actor ADDR --miner ADDR]"
+                     " [--port N] [--sessions N] [--requests N] [--seed N]"
+                     " [--threads N] [--tipsets N] [--deals N]"
+                     " [--weight METHOD=W]..."
+                  << std::endl
+                  << "  without --connect synthetic api is served in process "
+                     "on --port with --threads dispatcher threads"
+                  << std::endl;
+        return 1;
+      }
+    }
+    if (!config.in_process && (config.actor.empty() || config.miner.empty())) {
+      std::cerr << "--actor and --miner are required with --connect"
+                << std::endl;
+      return 1;
+    }
+
+    net::io_context ioc;
+    std::thread io_thread;
+    if (config.in_process) {
+      auto api{makeSyntheticApi(config)};
+      if (!api) {
+        std::cerr << "cannot make api: " << api.error().message() << std::endl;
+        return 1;
+      }
+      rpc::DispatcherConfig dispatcher;
+      dispatcher.threads = config.dispatcher_threads;
+      serve(std::move(api.value()),
+            ioc,
+            config.host,
+            static_cast<unsigned short>(std::stoul(config.port)),
+            dispatcher);
+      io_thread = std::thread{[&] { ioc.run(); }};
+    }
+
+    std::vector<std::unique_ptr<Session>> sessions;
+    for (size_t i{0}; i < config.sessions; ++i) {
+      sessions.push_back(std::make_unique<Session>(config, i));
+      if (!sessions.back()->connect()) {
+        ioc.stop();
+        if (io_thread.joinable()) {
+          io_thread.join();
+        }
+        return 1;
+      }
+    }
+    auto start{Clock::now()};
+    std::vector<std::thread> threads;
+    for (auto &session : sessions) {
+      threads.emplace_back([&session] { session->run(); });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto seconds{std::chrono::duration<double>(Clock::now() - start).count()};
+    ioc.stop();
+    if (io_thread.joinable()) {
+      io_thread.join();
+    }
+
+    std::map<std::string, Histogram> methods;
+    Histogram all;
+    for (auto &session : sessions) {
+      for (auto &[method, histogram] : session->stats) {
+        methods[method].merge(histogram);
+        all.merge(histogram);
+      }
+    }
+    std::cout << "sessions: " << config.sessions
+              << ", requests: " << all.count << ", errors: " << all.errors
+              << ", seconds: " << seconds << std::endl
+              << "requests/sec: " << all.count / seconds
+              << ", p50 us: " << all.percentile(0.5)
+              << ", p99 us: " << all.percentile(0.99) << std::endl
+              << std::endl
+              << std::left << std::setw(20) << "method" << std::right
+              << std::setw(10) << "count" << std::setw(10) << "errors"
+              << std::setw(12) << "req/sec" << std::setw(10) << "p50 us"
+              << std::setw(10) << "p99 us" << std::endl;
+    for (auto &[method, histogram] : methods) {
+      std::cout << std::left << std::setw(20) << method << std::right
+                << std::setw(10) << histogram.count << std::setw(10)
+                << histogram.errors << std::setw(12)
+                << static_cast<uint64_t>(histogram.count / seconds)
+                << std::setw(10) << histogram.percentile(0.5) << std::setw(10)
+                << histogram.percentile(0.99) << std::endl;
+    }
+    return all.errors == 0 ? 0 : 2;
+  }
+}  // namespace fc::api
+
+int main(int argc, char **argv) {
+  return fc::api::load(argc, argv);
+}
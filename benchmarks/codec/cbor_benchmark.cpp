@@ -0,0 +1,111 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "codec/cbor/cbor.hpp"
+#include "primitives/block/block.hpp"
+#include "primitives/cid/cid_of_cbor.hpp"
+#include "vm/actor/actor.hpp"
+#include "vm/message/message.hpp"
+#include "vm/runtime/runtime_types.hpp"
+
+namespace fc::codec::cbor {
+  using crypto::signature::BlsSignature;
+  using primitives::address::Address;
+  using primitives::block::BeaconEntry;
+  using primitives::block::BlockHeader;
+  using primitives::cid::getCidOfCbor;
+  using primitives::sector::PoStProof;
+  using primitives::sector::RegisteredProof;
+  using vm::actor::Actor;
+  using vm::message::SignedMessage;
+  using vm::runtime::MessageReceipt;
+
+  /// Cid of small value, different for different seeds
+  CID cid(uint64_t seed) {
+    return getCidOfCbor(seed).value();
+  }
+
+  /// Header of mainnet-like size: two parents, one beacon, one proof
+  BlockHeader makeHeader() {
+    BlockHeader block;
+    block.miner = Address::makeFromId(1000);
+    block.ticket = primitives::ticket::Ticket{BlsSignature{}};
+    block.election_proof.vrf_proof = common::Buffer(96, 1);
+    block.beacon_entries.push_back(BeaconEntry{1, std::vector<uint8_t>(96, 2)});
+    block.win_post_proof.push_back(PoStProof{
+        RegisteredProof::StackedDRG32GiBWinningPoSt,
+        std::vector<uint8_t>(192, 3)});
+    block.parents = {cid(1), cid(2)};
+    block.parent_weight = 1000000;
+    block.height = 100000;
+    block.parent_state_root = cid(3);
+    block.parent_message_receipts = cid(4);
+    block.messages = cid(5);
+    block.bls_aggregate = BlsSignature{};
+    block.timestamp = 1600000000;
+    block.block_sig = BlsSignature{};
+    return block;
+  }
+
+  SignedMessage makeMessage() {
+    SignedMessage message;
+    message.message.to = Address::makeFromId(1001);
+    message.message.from = Address::makeFromId(1002);
+    message.message.nonce = 42;
+    message.message.value = 1000000000;
+    message.message.gasPrice = 1;
+    message.message.gasLimit = 1000000;
+    message.message.method = vm::actor::MethodNumber{2};
+    message.message.params = vm::actor::MethodParams{common::Buffer(64, 4)};
+    message.signature = BlsSignature{};
+    return message;
+  }
+
+  MessageReceipt makeReceipt() {
+    return {vm::VMExitCode::kOk, common::Buffer(32, 5), 1000000};
+  }
+
+  Actor makeActor() {
+    return {vm::actor::CodeId{cid(6)}, cid(7), 42, 1000000000};
+  }
+
+  /// Messages of blocksync response, or receipts of tipset
+  template <typename T>
+  std::vector<T> many(const T &value) {
+    return std::vector<T>(1000, value);
+  }
+
+  template <typename T>
+  void Encode(benchmark::State &state, const T &value) {
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(encode(value));
+    }
+    state.SetBytesProcessed(state.iterations() * encode(value).value().size());
+  }
+
+  template <typename T>
+  void Decode(benchmark::State &state, const T &value) {
+    auto bytes{encode(value).value()};
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(decode<T>(bytes));
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+  }
+
+  BENCHMARK_CAPTURE(Encode, BlockHeader, makeHeader());
+  BENCHMARK_CAPTURE(Decode, BlockHeader, makeHeader());
+  BENCHMARK_CAPTURE(Encode, SignedMessage, makeMessage());
+  BENCHMARK_CAPTURE(Decode, SignedMessage, makeMessage());
+  BENCHMARK_CAPTURE(Encode, UnsignedMessage, makeMessage().message);
+  BENCHMARK_CAPTURE(Decode, UnsignedMessage, makeMessage().message);
+  BENCHMARK_CAPTURE(Encode, MessageReceipt, makeReceipt());
+  BENCHMARK_CAPTURE(Decode, MessageReceipt, makeReceipt());
+  BENCHMARK_CAPTURE(Encode, Actor, makeActor());
+  BENCHMARK_CAPTURE(Decode, Actor, makeActor());
+  BENCHMARK_CAPTURE(Decode, BlocksyncMessages, many(makeMessage()));
+  BENCHMARK_CAPTURE(Encode, Receipts, many(makeReceipt()));
+}  // namespace fc::codec::cbor
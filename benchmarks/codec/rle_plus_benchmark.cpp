@@ -0,0 +1,77 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "codec/rle/rle_plus.hpp"
+
+namespace fc::codec::rle {
+  /**
+   * Bitset of n set bits in runs of varying length, like sector bitfields
+   * after faults and terminations
+   */
+  std::set<uint64_t> makeBits(int64_t n) {
+    std::set<uint64_t> bits;
+    uint64_t index{};
+    for (uint64_t run{}; static_cast<int64_t>(bits.size()) < n; ++run) {
+      auto length{1 + run % 17};
+      for (uint64_t i = 0; i < length; ++i) {
+        bits.insert(index++);
+      }
+      index += 1 + run % 5;
+    }
+    return bits;
+  }
+
+  void RlePlusEncode(benchmark::State &state) {
+    auto bits{makeBits(state.range(0))};
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(encode(bits));
+    }
+    state.SetItemsProcessed(state.iterations() * bits.size());
+  }
+
+  void RlePlusDecode(benchmark::State &state) {
+    auto bits{makeBits(state.range(0))};
+    auto bytes{encode(bits)};
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(decode<uint64_t>(bytes));
+    }
+    state.SetItemsProcessed(state.iterations() * bits.size());
+  }
+
+  std::vector<std::pair<uint64_t, uint64_t>> makeRuns(int64_t n) {
+    std::vector<std::pair<uint64_t, uint64_t>> runs;
+    for (auto bit : makeBits(n)) {
+      if (!runs.empty() && runs.back().second == bit) {
+        ++runs.back().second;
+      } else {
+        runs.emplace_back(bit, bit + 1);
+      }
+    }
+    return runs;
+  }
+
+  void RlePlusEncodeRuns(benchmark::State &state) {
+    auto runs{makeRuns(state.range(0))};
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(encode(runs));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  void RlePlusDecodeRuns(benchmark::State &state) {
+    auto bytes{encode(makeRuns(state.range(0)))};
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(decodeRuns<uint64_t>(bytes));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  BENCHMARK(RlePlusEncode)->RangeMultiplier(10)->Range(1000, 1000000);
+  BENCHMARK(RlePlusDecode)->RangeMultiplier(10)->Range(1000, 1000000);
+  BENCHMARK(RlePlusEncodeRuns)->RangeMultiplier(10)->Range(1000, 1000000);
+  BENCHMARK(RlePlusDecodeRuns)->RangeMultiplier(10)->Range(1000, 1000000);
+}  // namespace fc::codec::rle
@@ -0,0 +1,57 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "primitives/big_int.hpp"
+
+namespace fc::primitives {
+  /// Balance of 1e9 FIL in attoFIL and typical gas values
+  const BigInt kBalance{"1000000000000000000000000000"};
+  const BigInt kGasPrice{"1000000000"};
+  constexpr int64_t kGasLimit{10000000};
+
+  void ConvertInt256(benchmark::State &state) {
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(BigInt{Int256{kBalance}});
+    }
+  }
+
+  /// Charge of message gas cost with BigInt operands
+  void GasChargeBigInt(benchmark::State &state) {
+    for (auto _ : state) {
+      BigInt cost{kGasLimit * kGasPrice};
+      benchmark::DoNotOptimize(BigInt{kBalance - cost});
+    }
+  }
+
+  /// Charge of message gas cost with Int256 operands
+  void GasChargeChecked(benchmark::State &state) {
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(checkedMath(
+          [](auto balance, auto limit, auto price) -> decltype(balance) {
+            return balance - limit * price;
+          },
+          kBalance,
+          kGasLimit,
+          kGasPrice));
+    }
+  }
+
+  /// Gas cost converted to BigInt and back before charge
+  void GasChargeRoundTrip(benchmark::State &state) {
+    auto mul{[](auto a, auto b) -> decltype(a) { return a * b; }};
+    auto sub{[](auto a, auto b) -> decltype(a) { return a - b; }};
+    for (auto _ : state) {
+      auto cost{checkedMath(mul, kGasLimit, kGasPrice)};
+      benchmark::DoNotOptimize(checkedMath(sub, kBalance, cost));
+    }
+  }
+
+  BENCHMARK(ConvertInt256);
+  BENCHMARK(GasChargeBigInt);
+  BENCHMARK(GasChargeChecked);
+  BENCHMARK(GasChargeRoundTrip);
+}  // namespace fc::primitives
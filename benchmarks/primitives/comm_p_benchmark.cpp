@@ -0,0 +1,81 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+#include "primitives/piece/comm_p.hpp"
+#include "proofs/proofs.hpp"
+
+namespace fc::primitives::piece {
+  using proofs::Proofs;
+  using sector::RegisteredProof;
+
+  /// Piece file of deterministic bytes, removed at exit
+  struct PieceFile {
+    explicit PieceFile(UnpaddedPieceSize size)
+        : path{boost::filesystem::unique_path(
+                   boost::filesystem::temp_directory_path()
+                   / "comm_p_%%%%-%%%%")
+                   .string()} {
+      std::ofstream file{path, std::ios::binary};
+      for (uint64_t i{0}; i < size; ++i) {
+        file.put(static_cast<char>(i * 7));
+      }
+    }
+
+    ~PieceFile() {
+      boost::filesystem::remove(path);
+    }
+
+    std::string path;
+  };
+
+  /// Unpadded size of 8MiB sector, largest piece of proof type below
+  const UnpaddedPieceSize kPieceSize{127 << 16};
+
+  void CommPFfi(benchmark::State &state) {
+    PieceFile piece{kPieceSize};
+    for (auto _ : state) {
+      auto cid{Proofs::generatePieceCIDFromFile(
+          RegisteredProof::StackedDRG8MiBSeal, piece.path, kPieceSize)};
+      if (!cid) {
+        state.SkipWithError(cid.error().message().c_str());
+        return;
+      }
+      benchmark::DoNotOptimize(cid.value());
+    }
+    state.SetBytesProcessed(state.iterations() * kPieceSize);
+  }
+
+  /// Native commitment on pool of range(0) threads, caller thread only at 0
+  void CommPNative(benchmark::State &state) {
+    PieceFile piece{kPieceSize};
+    std::shared_ptr<boost::asio::thread_pool> pool;
+    if (state.range(0) != 0) {
+      pool = std::make_shared<boost::asio::thread_pool>(state.range(0));
+    }
+    for (auto _ : state) {
+      std::ifstream input{piece.path, std::ios::binary};
+      auto cid{generatePieceCommitment(input, kPieceSize, pool)};
+      if (!cid) {
+        state.SkipWithError(cid.error().message().c_str());
+        return;
+      }
+      benchmark::DoNotOptimize(cid.value());
+    }
+    state.SetBytesProcessed(state.iterations() * kPieceSize);
+  }
+
+  BENCHMARK(CommPFfi)->Unit(benchmark::kMillisecond)->UseRealTime();
+  BENCHMARK(CommPNative)
+      ->Arg(0)
+      ->Arg(2)
+      ->Arg(4)
+      ->Arg(8)
+      ->Unit(benchmark::kMillisecond)
+      ->UseRealTime();
+}  // namespace fc::primitives::piece
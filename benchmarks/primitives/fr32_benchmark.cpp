@@ -0,0 +1,46 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "primitives/piece/fr32.hpp"
+
+namespace fc::primitives::piece {
+  /// Deterministic unpadded bytes of chunks
+  std::vector<uint8_t> unpaddedData(int64_t chunks) {
+    std::vector<uint8_t> data(chunks * 127);
+    for (size_t i = 0; i < data.size(); ++i) {
+      data[i] = static_cast<uint8_t>(i * 7);
+    }
+    return data;
+  }
+
+  void Fr32Pad(benchmark::State &state) {
+    auto chunks{state.range(0)};
+    auto data{unpaddedData(chunks)};
+    std::vector<uint8_t> padded(chunks * 128);
+    for (auto _ : state) {
+      pad(data, padded);
+      benchmark::DoNotOptimize(padded.data());
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+  }
+
+  void Fr32Unpad(benchmark::State &state) {
+    auto chunks{state.range(0)};
+    std::vector<uint8_t> padded(chunks * 128);
+    pad(unpaddedData(chunks), padded);
+    std::vector<uint8_t> data(chunks * 127);
+    for (auto _ : state) {
+      unpad(padded, data);
+      benchmark::DoNotOptimize(data.data());
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+  }
+
+  // 8 << 10 chunks are read buffer of Proofs::readPiece
+  BENCHMARK(Fr32Pad)->Arg(1)->Arg(256)->Arg(8 << 10);
+  BENCHMARK(Fr32Unpad)->Arg(1)->Arg(256)->Arg(8 << 10);
+}  // namespace fc::primitives::piece
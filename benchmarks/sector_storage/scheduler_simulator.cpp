@@ -0,0 +1,716 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <tuple>
+
+#include "primitives/piece/piece_data.hpp"
+#include "sector_storage/impl/allocate_selector.hpp"
+#include "sector_storage/impl/existing_selector.hpp"
+#include "sector_storage/impl/scheduler_impl.hpp"
+#include "sector_storage/impl/task_selector.hpp"
+#include "sector_storage/stores/impl/index_impl.hpp"
+
+namespace fc::sector_storage {
+  using primitives::FsStat;
+  using primitives::StoragePath;
+  using primitives::WorkerInfo;
+  using primitives::WorkerResources;
+  using primitives::piece::PaddedPieceSize;
+  using primitives::piece::PieceData;
+  using primitives::sector::InteractiveRandomness;
+  using primitives::sector::SealRandomness;
+  using stores::SectorIndex;
+  using stores::SectorIndexImpl;
+  using stores::StorageInfo;
+  using Clock = std::chrono::steady_clock;
+
+  const auto kSealedCache{static_cast<SectorFileType>(
+      SectorFileType::FTSealed | SectorFileType::FTCache)};
+
+  /// Paths are not filled by simulated sectors
+  const FsStat kPathStat{.capacity = uint64_t{1} << 50,
+                         .available = uint64_t{1} << 50,
+                         .used = 0};
+
+  /// Histogram with power of two buckets
+  struct Histogram {
+    void add(uint64_t value) {
+      size_t bucket{0};
+      for (auto v{value}; v != 0 && bucket + 1 < buckets.size(); v >>= 1) {
+        ++bucket;
+      }
+      ++buckets[bucket];
+      ++count;
+      total += value;
+      max = std::max(max, value);
+    }
+
+    /// Upper bound of bucket containing percentile
+    uint64_t percentile(double p) const {
+      auto rank{static_cast<uint64_t>(p * count)};
+      uint64_t seen{0};
+      for (size_t i{0}; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen > rank) {
+          return uint64_t{1} << i;
+        }
+      }
+      return uint64_t{1} << (buckets.size() - 1);
+    }
+
+    uint64_t mean() const {
+      return count == 0 ? 0 : total / count;
+    }
+
+    std::array<uint64_t, 40> buckets{};
+    uint64_t count{};
+    uint64_t total{};
+    uint64_t max{};
+  };
+
+  /// Synthetic worker of fleet
+  struct WorkerSpec {
+    std::string hostname;
+    WorkerResources resources;
+    /// Simulated seconds of supported tasks
+    std::map<TaskType, double> durations;
+    /// Simulated seconds to fetch sector files from other worker
+    double fetch{};
+    std::vector<StoragePath> paths;
+  };
+
+  struct SimConfig {
+    uint64_t sectors{1000};
+    size_t pc1_workers{8};
+    size_t gpu_workers{2};
+    uint64_t seed{};
+    /// Task durations vary uniformly by this fraction
+    double jitter{0.1};
+    /// Wall microseconds per simulated second
+    double scale{10};
+    /// Simulated seconds between sector arrivals, all arrive at once if zero
+    double interval{};
+    /// Simulated seconds of tasks, override defaults for all workers
+    std::map<TaskType, double> durations;
+  };
+
+  /// Statistics of task type, times in simulated seconds
+  struct TaskStats {
+    /// Time from scheduling to start of preparation on worker
+    Histogram wait;
+    /// Time of preparation, sector files fetch
+    Histogram prepare;
+    Histogram work;
+  };
+
+  struct WorkerStats {
+    uint64_t tasks{};
+    /// Sum of work time of tasks, simulated seconds
+    double busy{};
+    uint64_t running{};
+    uint64_t peak{};
+  };
+
+  /// Sealing pipeline stages in order, as scheduled by sector manager
+  const std::vector<TaskType> kStages{primitives::kTTAddPiece,
+                                      primitives::kTTPreCommit1,
+                                      primitives::kTTPreCommit2,
+                                      primitives::kTTCommit1,
+                                      primitives::kTTCommit2,
+                                      primitives::kTTFinalize,
+                                      primitives::kTTFetch};
+
+  class Simulation;
+
+  /// Worker which sleeps for scaled synthetic durations instead of sealing
+  class SimWorker : public Worker {
+   public:
+    SimWorker(WorkerSpec spec,
+              std::shared_ptr<SectorIndex> index,
+              Simulation &sim)
+        : spec_(std::move(spec)), index_(std::move(index)), sim_(sim) {}
+
+    outcome::result<PieceInfo> addPiece(
+        const SectorId &sector,
+        gsl::span<const UnpaddedPieceSize> piece_sizes,
+        const UnpaddedPieceSize &new_piece_size,
+        const proofs::PieceData &piece_data) override {
+      OUTCOME_TRY(run(primitives::kTTAddPiece, sector));
+      OUTCOME_TRY(declare(sector, SectorFileType::FTUnsealed, true));
+      return PieceInfo{.size = new_piece_size.padded(), .cid = {}};
+    }
+
+    outcome::result<PreCommit1Output> sealPreCommit1(
+        const SectorId &sector,
+        const SealRandomness &ticket,
+        gsl::span<const PieceInfo> pieces) override {
+      OUTCOME_TRY(run(primitives::kTTPreCommit1, sector));
+      OUTCOME_TRY(declare(sector, kSealedCache, true));
+      return PreCommit1Output{};
+    }
+
+    outcome::result<SectorCids> sealPreCommit2(
+        const SectorId &sector,
+        const PreCommit1Output &pre_commit_1_output) override {
+      OUTCOME_TRY(run(primitives::kTTPreCommit2, sector));
+      return SectorCids{};
+    }
+
+    outcome::result<Commit1Output> sealCommit1(
+        const SectorId &sector,
+        const SealRandomness &ticket,
+        const InteractiveRandomness &seed,
+        gsl::span<const PieceInfo> pieces,
+        const SectorCids &cids) override {
+      OUTCOME_TRY(run(primitives::kTTCommit1, sector));
+      return Commit1Output{};
+    }
+
+    outcome::result<Proof> sealCommit2(
+        const SectorId &sector, const Commit1Output &commit_1_output) override {
+      OUTCOME_TRY(run(primitives::kTTCommit2, sector));
+      return Proof{};
+    }
+
+    outcome::result<void> finalizeSector(const SectorId &sector) override {
+      return run(primitives::kTTFinalize, sector);
+    }
+
+    outcome::result<void> remove(const SectorId &sector) override {
+      return outcome::success();
+    }
+
+    outcome::result<void> moveStorage(const SectorId &sector) override {
+      OUTCOME_TRY(run(primitives::kTTFetch, sector));
+      return declare(sector, kSealedCache, false);
+    }
+
+    /// Sleeps for fetch time unless files are on paths of worker already
+    outcome::result<void> fetch(const SectorId &sector,
+                                const SectorFileType &file_type,
+                                bool can_seal) override;
+
+    outcome::result<void> unsealPiece(const SectorId &sector,
+                                      UnpaddedByteIndex offset,
+                                      const UnpaddedPieceSize &size,
+                                      const SealRandomness &randomness,
+                                      const CID &unsealed_cid) override {
+      return run(primitives::kTTUnseal, sector);
+    }
+
+    outcome::result<void> readPiece(proofs::PieceData output,
+                                    const SectorId &sector,
+                                    UnpaddedByteIndex offset,
+                                    const UnpaddedPieceSize &size) override {
+      return run(primitives::kTTReadUnsealed, sector);
+    }
+
+    outcome::result<primitives::WorkerInfo> getInfo() override {
+      return WorkerInfo{.hostname = spec_.hostname,
+                        .resources = spec_.resources};
+    }
+
+    outcome::result<std::set<primitives::TaskType>> getSupportedTask()
+        override {
+      std::set<TaskType> tasks;
+      for (const auto &[task, duration] : spec_.durations) {
+        tasks.insert(task);
+      }
+      return tasks;
+    }
+
+    outcome::result<std::vector<primitives::StoragePath>> getAccessiblePaths()
+        override {
+      return spec_.paths;
+    }
+
+    const WorkerSpec &spec() const {
+      return spec_;
+    }
+
+   private:
+    /// Sleeps for duration of task and accounts it
+    outcome::result<void> run(const TaskType &task, const SectorId &sector);
+
+    /// Declares files of sector in first sealing or storing path
+    outcome::result<void> declare(const SectorId &sector,
+                                  SectorFileType file_type,
+                                  bool sealing) {
+      for (const auto &path : spec_.paths) {
+        if (sealing ? path.can_seal : path.can_store) {
+          return index_->storageDeclareSector(path.id, sector, file_type);
+        }
+      }
+      return outcome::success();
+    }
+
+    WorkerSpec spec_;
+    std::shared_ptr<SectorIndex> index_;
+    Simulation &sim_;
+  };
+
+  /**
+   * Drives scheduler with sectors through sealing pipeline on simulated
+   * workers. Synthetic durations of tasks are scaled to wall time, as
+   * scheduler uses real clock and threads. Durations are deterministic for
+   * seed, order of assignments depends on timing of threads like in
+   * production.
+   */
+  class Simulation {
+   public:
+    explicit Simulation(SimConfig config)
+        : config_(std::move(config)),
+          index_(std::make_shared<SectorIndexImpl>()),
+          scheduler_(std::make_shared<SchedulerImpl>(
+              RegisteredProof::StackedDRG32GiBSeal, index_)) {}
+
+    outcome::result<void> addWorker(WorkerSpec spec) {
+      for (auto &[task, duration] : spec.durations) {
+        auto it{config_.durations.find(task)};
+        if (it != config_.durations.end()) {
+          duration = it->second;
+        }
+      }
+      for (const auto &path : spec.paths) {
+        OUTCOME_TRY(attach(path));
+      }
+      auto handle{std::make_unique<WorkerHandle>()};
+      auto worker{std::make_shared<SimWorker>(spec, index_, *this)};
+      OUTCOME_TRYA(handle->info, worker->getInfo());
+      handle->worker = worker;
+      workers_.push_back(worker);
+      workers_stats_[spec.hostname];
+      scheduler_->newWorker(std::move(handle));
+      return outcome::success();
+    }
+
+    /// Shared path is attached once, by first worker
+    outcome::result<void> attach(const StoragePath &path) {
+      if (paths_.count(path.id) != 0) {
+        return outcome::success();
+      }
+      paths_.insert(path.id);
+      return index_->storageAttach(
+          StorageInfo{.id = path.id,
+                      .urls = {"http://" + path.id + ":3456/remote"},
+                      .weight = path.weight,
+                      .can_seal = path.can_seal,
+                      .can_store = path.can_store},
+          kPathStat);
+    }
+
+    /// Reports health of paths, so index keeps offering them
+    void heartbeat() {
+      for (const auto &id : paths_) {
+        std::ignore = index_->storageReportHealth(
+            id, {.stat = kPathStat, .error = boost::none});
+      }
+    }
+
+    int run() {
+      std::cout << "sectors: " << config_.sectors
+                << ", workers: " << workers_.size()
+                << ", seed: " << config_.seed
+                << ", scale: " << config_.scale << " us/s"
+                << ", scheduler threads: "
+                << std::thread::hardware_concurrency() << std::endl;
+      start_ = Clock::now();
+      auto next_heartbeat{start_ + stores::kHeartbeatInterval};
+      for (uint64_t i{0}; i < config_.sectors; ++i) {
+        submit(SectorId{.miner = 1000, .sector = i}, 0);
+        if (config_.interval > 0) {
+          std::this_thread::sleep_for(wall(config_.interval));
+        }
+        if (Clock::now() > next_heartbeat) {
+          heartbeat();
+          next_heartbeat = Clock::now() + stores::kHeartbeatInterval;
+        }
+      }
+      std::unique_lock lock{mutex_};
+      while (finished_ + failed_ < config_.sectors) {
+        cv_.wait_for(lock, stores::kHeartbeatInterval);
+        heartbeat();
+      }
+      lock.unlock();
+      report(simulated(Clock::now() - start_));
+      return failed_ == 0 ? 0 : 2;
+    }
+
+    /// Schedules stage of sector, next stage is scheduled on its completion
+    void submit(const SectorId &sector, size_t stage) {
+      const auto &task{kStages[stage]};
+      auto selector{makeSelector(task, sector)};
+      if (!selector) {
+        fail(sector, task, selector.error());
+        return;
+      }
+      auto queued{Clock::now()};
+      WorkerAction prepare{[this, task, sector, queued](
+                               const std::shared_ptr<Worker> &worker)
+                               -> outcome::result<void> {
+        auto start{Clock::now()};
+        record(task, &TaskStats::wait, start - queued);
+        auto result{prepareTask(task, sector, *worker)};
+        record(task, &TaskStats::prepare, Clock::now() - start);
+        return result;
+      }};
+      WorkerAction work{[task, sector](const std::shared_ptr<Worker> &worker)
+                            -> outcome::result<void> {
+        return workTask(task, sector, *worker);
+      }};
+      ReturnCb<void> callback{
+          [this, task, sector, stage](outcome::result<void> result) {
+            if (!result) {
+              fail(sector, task, result.error());
+            } else if (stage + 1 < kStages.size()) {
+              submit(sector, stage + 1);
+            } else {
+              std::lock_guard lock{mutex_};
+              ++finished_;
+              cv_.notify_all();
+            }
+          }};
+      auto start{Clock::now()};
+      scheduler_->scheduleAsync(sector, task, selector.value(), prepare, work,
+                                callback);
+      auto latency{Clock::now() - start};
+      std::lock_guard lock{mutex_};
+      decision_.add(
+          std::chrono::duration_cast<std::chrono::microseconds>(latency)
+              .count());
+    }
+
+    /// Wall time of simulated seconds
+    std::chrono::microseconds wall(double seconds) const {
+      return std::chrono::microseconds{
+          static_cast<int64_t>(seconds * config_.scale)};
+    }
+
+    /// Simulated seconds of wall time
+    double simulated(Clock::duration time) const {
+      return std::chrono::duration<double, std::micro>(time).count()
+             / config_.scale;
+    }
+
+    /// Synthetic duration of task, same for sector and seed on every run
+    double duration(const TaskType &task,
+                    const SectorId &sector,
+                    double base) const {
+      std::seed_seq seq{config_.seed,
+                        sector.sector,
+                        static_cast<uint64_t>(std::hash<std::string>{}(task))};
+      std::mt19937_64 random{seq};
+      std::uniform_real_distribution<double> factor{1 - config_.jitter,
+                                                    1 + config_.jitter};
+      return base * factor(random);
+    }
+
+    void started(const std::string &hostname) {
+      std::lock_guard lock{mutex_};
+      auto &stats{workers_stats_[hostname]};
+      stats.peak = std::max(stats.peak, ++stats.running);
+      fleet_peak_ = std::max(fleet_peak_, ++fleet_running_);
+    }
+
+    void stopped(const std::string &hostname,
+                 const TaskType &task,
+                 Clock::duration time) {
+      std::lock_guard lock{mutex_};
+      auto &stats{workers_stats_[hostname]};
+      --stats.running;
+      --fleet_running_;
+      ++stats.tasks;
+      stats.busy += simulated(time);
+      tasks_[task].work.add(static_cast<uint64_t>(simulated(time)));
+    }
+
+   private:
+    outcome::result<std::shared_ptr<WorkerSelector>> makeSelector(
+        const TaskType &task, const SectorId &sector) {
+      if (task == primitives::kTTAddPiece) {
+        return std::make_shared<AllocateSelector>(
+            index_, SectorFileType::FTUnsealed, true);
+      }
+      if (task == primitives::kTTPreCommit1) {
+        return std::make_shared<AllocateSelector>(index_, kSealedCache, true);
+      }
+      if (task == primitives::kTTCommit2) {
+        return std::make_shared<TaskSelector>();
+      }
+      if (task == primitives::kTTFetch) {
+        return std::make_shared<AllocateSelector>(index_, kSealedCache, false);
+      }
+      OUTCOME_TRY(selector,
+                  ExistingSelector::newExistingSelector(
+                      index_,
+                      sector,
+                      kSealedCache,
+                      task == primitives::kTTPreCommit2));
+      return std::shared_ptr<WorkerSelector>{std::move(selector)};
+    }
+
+    /// Fetches files needed by task, as sector manager does
+    static outcome::result<void> prepareTask(const TaskType &task,
+                                             const SectorId &sector,
+                                             Worker &worker) {
+      if (task == primitives::kTTPreCommit1) {
+        return worker.fetch(sector, SectorFileType::FTUnsealed, true);
+      }
+      if (task == primitives::kTTPreCommit2 || task == primitives::kTTCommit1
+          || task == primitives::kTTFinalize) {
+        return worker.fetch(sector, kSealedCache, true);
+      }
+      if (task == primitives::kTTFetch) {
+        return worker.fetch(sector, kSealedCache, false);
+      }
+      return outcome::success();
+    }
+
+    static outcome::result<void> workTask(const TaskType &task,
+                                          const SectorId &sector,
+                                          Worker &worker) {
+      if (task == primitives::kTTAddPiece) {
+        PieceData data{""};
+        OUTCOME_TRY(worker.addPiece(
+            sector, {}, PaddedPieceSize{uint64_t{32} << 30}.unpadded(), data));
+      } else if (task == primitives::kTTPreCommit1) {
+        OUTCOME_TRY(worker.sealPreCommit1(sector, {}, {}));
+      } else if (task == primitives::kTTPreCommit2) {
+        OUTCOME_TRY(worker.sealPreCommit2(sector, {}));
+      } else if (task == primitives::kTTCommit1) {
+        OUTCOME_TRY(worker.sealCommit1(sector, {}, {}, {}, {}));
+      } else if (task == primitives::kTTCommit2) {
+        OUTCOME_TRY(worker.sealCommit2(sector, {}));
+      } else if (task == primitives::kTTFinalize) {
+        OUTCOME_TRY(worker.finalizeSector(sector));
+      } else if (task == primitives::kTTFetch) {
+        OUTCOME_TRY(worker.moveStorage(sector));
+      }
+      return outcome::success();
+    }
+
+    void record(const TaskType &task,
+                Histogram TaskStats::*histogram,
+                Clock::duration time) {
+      std::lock_guard lock{mutex_};
+      (tasks_[task].*histogram).add(static_cast<uint64_t>(simulated(time)));
+    }
+
+    void fail(const SectorId &sector,
+              const TaskType &task,
+              const std::error_code &error) {
+      std::lock_guard lock{mutex_};
+      if (failed_ < 10) {
+        std::cerr << "sector " << sector.sector << " " << task << ": "
+                  << error.message() << std::endl;
+      }
+      ++failed_;
+      cv_.notify_all();
+    }
+
+    void report(double elapsed) {
+      std::lock_guard lock{mutex_};
+      auto hours{elapsed / 3600};
+      std::cout << "finished: " << finished_ << ", failed: " << failed_
+                << ", simulated hours: " << hours << std::endl
+                << "sectors/day: " << finished_ / hours * 24
+                << ", peak running tasks: " << fleet_peak_ << std::endl
+                << "scheduleAsync us: mean " << decision_.mean() << ", p50 "
+                << decision_.percentile(0.5) << ", p99 "
+                << decision_.percentile(0.99) << ", max " << decision_.max
+                << std::endl
+                << std::endl
+                << std::left << std::setw(24) << "task" << std::right
+                << std::setw(8) << "count" << std::setw(12) << "wait s"
+                << std::setw(12) << "p99 wait" << std::setw(12) << "max wait"
+                << std::setw(12) << "prepare s" << std::setw(12) << "work s"
+                << std::endl;
+      for (const auto &task : kStages) {
+        const auto &stats{tasks_[task]};
+        std::cout << std::left << std::setw(24) << task << std::right
+                  << std::setw(8) << stats.work.count << std::setw(12)
+                  << stats.wait.mean() << std::setw(12)
+                  << stats.wait.percentile(0.99) << std::setw(12)
+                  << stats.wait.max << std::setw(12) << stats.prepare.mean()
+                  << std::setw(12) << stats.work.mean() << std::endl;
+      }
+      std::cout << std::endl
+                << std::left << std::setw(24) << "worker" << std::right
+                << std::setw(8) << "tasks" << std::setw(12) << "busy h"
+                << std::setw(12) << "mean run" << std::setw(12) << "peak run"
+                << std::endl;
+      for (const auto &[hostname, stats] : workers_stats_) {
+        std::cout << std::left << std::setw(24) << hostname << std::right
+                  << std::setw(8) << stats.tasks << std::setw(12)
+                  << stats.busy / 3600 << std::setw(12)
+                  << stats.busy / elapsed << std::setw(12) << stats.peak
+                  << std::endl;
+      }
+    }
+
+    SimConfig config_;
+    std::shared_ptr<SectorIndex> index_;
+    std::shared_ptr<Scheduler> scheduler_;
+    std::vector<std::shared_ptr<SimWorker>> workers_;
+    std::set<std::string> paths_;
+    Clock::time_point start_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    uint64_t finished_{};
+    uint64_t failed_{};
+    std::map<TaskType, TaskStats> tasks_;
+    std::map<std::string, WorkerStats> workers_stats_;
+    uint64_t fleet_running_{};
+    uint64_t fleet_peak_{};
+    Histogram decision_;
+  };
+
+  outcome::result<void> SimWorker::fetch(const SectorId &sector,
+                                         const SectorFileType &file_type,
+                                         bool can_seal) {
+    OUTCOME_TRY(found, index_->storageFindSector(sector, file_type, false));
+    for (const auto &storage : found) {
+      for (const auto &path : spec_.paths) {
+        if (path.id == storage.id
+            && (can_seal ? path.can_seal : path.can_store)) {
+          return outcome::success();
+        }
+      }
+    }
+    std::this_thread::sleep_for(
+        sim_.wall(sim_.duration(primitives::kTTFetch, sector, spec_.fetch)));
+    return declare(sector, file_type, can_seal);
+  }
+
+  outcome::result<void> SimWorker::run(const TaskType &task,
+                                       const SectorId &sector) {
+    auto it{spec_.durations.find(task)};
+    if (it == spec_.durations.end()) {
+      return WorkerErrors::kUnsupportedPlatform;
+    }
+    sim_.started(spec_.hostname);
+    auto start{Clock::now()};
+    std::this_thread::sleep_for(
+        sim_.wall(sim_.duration(task, sector, it->second)));
+    sim_.stopped(spec_.hostname, task, Clock::now() - start);
+    return outcome::success();
+  }
+
+  /// Precommit 1 worker, with two sealing paths
+  WorkerSpec pc1Worker(size_t i) {
+    auto name{"pc1-" + std::to_string(i)};
+    return {
+        .hostname = name,
+        .resources = {.physical_memory = uint64_t{512} << 30,
+                      .swap_memory = uint64_t{64} << 30,
+                      .reserved_memory = uint64_t{8} << 30,
+                      .cpus = 64,
+                      .gpus = {}},
+        .durations = {{primitives::kTTAddPiece, 600},
+                      {primitives::kTTPreCommit1, 14400}},
+        .fetch = 900,
+        .paths = {{name + "-nvme0", 10, "/nvme0", true, false},
+                  {name + "-nvme1", 10, "/nvme1", true, false}},
+    };
+  }
+
+  /// Gpu worker, with sealing path and shared long-term storage
+  WorkerSpec gpuWorker(size_t i) {
+    auto name{"gpu-" + std::to_string(i)};
+    return {
+        .hostname = name,
+        .resources = {.physical_memory = uint64_t{256} << 30,
+                      .swap_memory = uint64_t{64} << 30,
+                      .reserved_memory = uint64_t{8} << 30,
+                      .cpus = 32,
+                      .gpus = {"gpu0"}},
+        .durations = {{primitives::kTTPreCommit2, 2400},
+                      {primitives::kTTCommit1, 60},
+                      {primitives::kTTCommit2, 2400},
+                      {primitives::kTTFinalize, 300},
+                      {primitives::kTTFetch, 600}},
+        .fetch = 900,
+        .paths = {{name + "-nvme0", 10, "/nvme0", true, false},
+                  {"store", 1, "/store", false, true}},
+    };
+  }
+
+  int simulate(int argc, char **argv) {
+    SimConfig config;
+    for (auto i{1}; i < argc; ++i) {
+      auto has_value{i + 1 < argc};
+      if (!strcmp(argv[i], "--sectors") && has_value) {
+        config.sectors = std::stoull(argv[++i]);
+      } else if (!strcmp(argv[i], "--pc1-workers") && has_value) {
+        config.pc1_workers = std::stoull(argv[++i]);
+      } else if (!strcmp(argv[i], "--gpu-workers") && has_value) {
+        config.gpu_workers = std::stoull(argv[++i]);
+      } else if (!strcmp(argv[i], "--seed") && has_value) {
+        config.seed = std::stoull(argv[++i]);
+      } else if (!strcmp(argv[i], "--jitter") && has_value) {
+        config.jitter = std::stod(argv[++i]);
+      } else if (!strcmp(argv[i], "--scale") && has_value) {
+        config.scale = std::stod(argv[++i]);
+      } else if (!strcmp(argv[i], "--interval") && has_value) {
+        config.interval = std::stod(argv[++i]);
+      } else if (!strcmp(argv[i], "--duration") && has_value) {
+        std::string arg{argv[++i]};
+        auto eq{arg.find('=')};
+        if (eq == std::string::npos) {
+          std::cerr << "duration must be <task>=<seconds>" << std::endl;
+          return 1;
+        }
+        config.durations[TaskType{arg.substr(0, eq)}] =
+            std::stod(arg.substr(eq + 1));
+      } else {
+        std::cerr
+            << "usage: " << argv[0]
+            << " [--sectors N] [--pc1-workers N] [--gpu-workers N] [--seed N]"
+               " [--jitter F] [--scale US] [--interval S]"
+               " [--duration TASK=S]..."
+            << std::endl
+            << "  durations are simulated seconds, scale is wall "
+               "microseconds per simulated second"
+            << std::endl;
+        return 1;
+      }
+    }
+
+    Simulation sim{config};
+    for (size_t i{0}; i < config.pc1_workers; ++i) {
+      auto added{sim.addWorker(pc1Worker(i))};
+      if (!added) {
+        std::cerr << "cannot add worker: " << added.error().message()
+                  << std::endl;
+        return 1;
+      }
+    }
+    for (size_t i{0}; i < config.gpu_workers; ++i) {
+      auto added{sim.addWorker(gpuWorker(i))};
+      if (!added) {
+        std::cerr << "cannot add worker: " << added.error().message()
+                  << std::endl;
+        return 1;
+      }
+    }
+    return sim.run();
+  }
+}  // namespace fc::sector_storage
+
+int main(int argc, char **argv) {
+  return fc::sector_storage::simulate(argc, argv);
+}
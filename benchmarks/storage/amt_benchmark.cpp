@@ -0,0 +1,68 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "storage/amt/amt.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+
+namespace fc::storage::amt {
+  using ipfs::InMemoryDatastore;
+
+  void AmtSet(benchmark::State &state) {
+    auto n{static_cast<uint64_t>(state.range(0))};
+    for (auto _ : state) {
+      Amt amt{std::make_shared<InMemoryDatastore>()};
+      for (uint64_t i = 0; i < n; ++i) {
+        benchmark::DoNotOptimize(amt.setCbor(i, i));
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+  }
+
+  void AmtFlush(benchmark::State &state) {
+    auto n{static_cast<uint64_t>(state.range(0))};
+    for (auto _ : state) {
+      state.PauseTiming();
+      Amt amt{std::make_shared<InMemoryDatastore>()};
+      for (uint64_t i = 0; i < n; ++i) {
+        amt.setCbor(i, i).value();
+      }
+      state.ResumeTiming();
+      benchmark::DoNotOptimize(amt.flush());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+  }
+
+  void AmtGet(benchmark::State &state) {
+    auto n{static_cast<uint64_t>(state.range(0))};
+    auto ipld{std::make_shared<InMemoryDatastore>()};
+    Amt source{ipld};
+    for (uint64_t i = 0; i < n; ++i) {
+      source.setCbor(i, i).value();
+    }
+    auto root{source.flush().value()};
+    for (auto _ : state) {
+      Amt amt{ipld, root};
+      for (uint64_t i = 0; i < n; ++i) {
+        benchmark::DoNotOptimize(amt.getCbor<uint64_t>(i));
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+  }
+
+  BENCHMARK(AmtSet)
+      ->RangeMultiplier(10)
+      ->Range(1000, 10000000)
+      ->Unit(benchmark::kMillisecond);
+  BENCHMARK(AmtFlush)
+      ->RangeMultiplier(10)
+      ->Range(1000, 10000000)
+      ->Unit(benchmark::kMillisecond);
+  BENCHMARK(AmtGet)
+      ->RangeMultiplier(10)
+      ->Range(1000, 10000000)
+      ->Unit(benchmark::kMillisecond);
+}  // namespace fc::storage::amt
@@ -0,0 +1,314 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <sys/resource.h>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#include <boost/asio/steady_timer.hpp>
+#include <boost/di/extension/scopes/shared.hpp>
+#include <libp2p/injector/host_injector.hpp>
+#include <libp2p/protocol/common/asio/asio_scheduler.hpp>
+
+#include "codec/cbor/streams_annotation.hpp"
+#include "data_transfer/impl/graphsync/graphsync_manager.hpp"
+#include "storage/ipfs/graphsync/impl/graphsync_impl.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "storage/ipld/impl/ipld_node_impl.hpp"
+
+namespace fc::storage::ipfs::graphsync {
+  using common::Buffer;
+  using data_transfer::RequestValidator;
+  using data_transfer::Voucher;
+  using data_transfer::graphsync::GraphSyncManager;
+  using ipld::IPLDNodeImpl;
+  using ipld::Selector;
+  using libp2p::Host;
+  using libp2p::multi::Multiaddress;
+  using libp2p::peer::PeerInfo;
+  using Clock = std::chrono::steady_clock;
+
+  constexpr auto kVoucherType{"benchmark"};
+
+  struct LoopbackConfig {
+    /// Levels of dag below root
+    size_t depth{3};
+    size_t fanout{8};
+    size_t block_size{256 << 10};
+    /// Dag-pb blocks like unixfs files, otherwise dag-cbor
+    bool pb{false};
+    /// Pull through data transfer manager instead of graphsync request
+    bool data_transfer{false};
+    /// Sequential fetches of the dag
+    size_t passes{1};
+    uint64_t seed{};
+    uint16_t port{40010};
+  };
+
+  /// Dag-cbor block of dag
+  struct CborBlock {
+    Buffer data;
+    std::vector<CID> links;
+  };
+  CBOR_TUPLE(CborBlock, data, links)
+
+  struct Dag {
+    CID root;
+    uint64_t blocks{};
+    uint64_t bytes{};
+  };
+
+  /// Generates tree of blocks with random payload, returns cid of subtree
+  outcome::result<CID> makeDag(InMemoryDatastore &ipld,
+                               const LoopbackConfig &config,
+                               std::mt19937_64 &random,
+                               size_t depth,
+                               Dag &dag) {
+    std::vector<std::pair<std::string, CID>> children;
+    if (depth != 0) {
+      for (size_t i{0}; i < config.fanout; ++i) {
+        OUTCOME_TRY(child, makeDag(ipld, config, random, depth - 1, dag));
+        children.emplace_back(std::to_string(i), std::move(child));
+      }
+    }
+    Buffer data(config.block_size);
+    for (auto &byte : data) {
+      byte = static_cast<uint8_t>(random());
+    }
+    CID cid;
+    if (config.pb) {
+      auto node{IPLDNodeImpl::createFromString(
+          std::string{data.begin(), data.end()})};
+      for (const auto &[name, child] : children) {
+        OUTCOME_TRY(block, ipld.get(child));
+        OUTCOME_TRY(child_node, IPLDNodeImpl::createFromRawBytes(block));
+        OUTCOME_TRY(node->addChild(name, child_node));
+      }
+      cid = node->getCID();
+      ++dag.blocks;
+      dag.bytes += node->getRawBytes().size();
+      OUTCOME_TRY(ipld.set(cid, node->getRawBytes()));
+    } else {
+      CborBlock block{std::move(data), {}};
+      for (auto &child : children) {
+        block.links.push_back(std::move(child.second));
+      }
+      OUTCOME_TRY(bytes, codec::cbor::encode(block));
+      OUTCOME_TRYA(cid, ipld.setCbor(block));
+      ++dag.blocks;
+      dag.bytes += bytes.size();
+    }
+    return cid;
+  }
+
+  /// Accepts all vouchers
+  struct AcceptAll : RequestValidator {
+    outcome::result<void> validatePush(const PeerInfo &,
+                                       std::vector<uint8_t>,
+                                       CID,
+                                       std::shared_ptr<Selector>) override {
+      return outcome::success();
+    }
+
+    outcome::result<void> validatePull(const PeerInfo &,
+                                       std::vector<uint8_t>,
+                                       CID,
+                                       std::shared_ptr<Selector>) override {
+      return outcome::success();
+    }
+  };
+
+  /// Host with graphsync on shared io context
+  struct Peer {
+    explicit Peer(const std::shared_ptr<boost::asio::io_context> &io) {
+      // override allows several hosts in one process
+      auto injector{libp2p::injector::makeHostInjector<
+          boost::di::extension::shared_config>(
+          boost::di::bind<boost::asio::io_context>.to(
+              io)[boost::di::override])};
+      host = injector.create<std::shared_ptr<Host>>();
+      graphsync = std::make_shared<GraphsyncImpl>(
+          host,
+          std::make_shared<libp2p::protocol::AsioScheduler>(
+              *io, libp2p::protocol::SchedulerConfig{}));
+    }
+
+    std::shared_ptr<Host> host;
+    std::shared_ptr<GraphsyncImpl> graphsync;
+    std::shared_ptr<InMemoryDatastore> ipld{
+        std::make_shared<InMemoryDatastore>()};
+    std::shared_ptr<GraphSyncManager> manager;
+  };
+
+  /// Cpu time of process, user and system
+  std::chrono::microseconds cpuTime(const rusage &usage) {
+    return std::chrono::seconds{usage.ru_utime.tv_sec + usage.ru_stime.tv_sec}
+           + std::chrono::microseconds{usage.ru_utime.tv_usec
+                                       + usage.ru_stime.tv_usec};
+  }
+
+  int loopback(int argc, char **argv) {
+    LoopbackConfig config;
+    for (auto i{1}; i < argc; ++i) {
+      auto has_value{i + 1 < argc};
+      if (!strcmp(argv[i], "--pb")) {
+        config.pb = true;
+      } else if (!strcmp(argv[i], "--data-transfer")) {
+        config.data_transfer = true;
+      } else if (!strcmp(argv[i], "--depth") && has_value) {
+        config.depth = std::stoull(argv[++i]);
+      } else if (!strcmp(argv[i], "--fanout") && has_value) {
+        config.fanout = std::stoull(argv[++i]);
+      } else if (!strcmp(argv[i], "--block-size") && has_value) {
+        config.block_size = std::stoull(argv[++i]);
+      } else if (!strcmp(argv[i], "--passes") && has_value) {
+        config.passes = std::max<size_t>(1, std::stoull(argv[++i]));
+      } else if (!strcmp(argv[i], "--seed") && has_value) {
+        config.seed = std::stoull(argv[++i]);
+      } else if (!strcmp(argv[i], "--port") && has_value) {
+        config.port = std::stoul(argv[++i]);
+      } else {
+        std::cerr << "usage: " << argv[0]
+                  << " [--depth N] [--fanout N] [--block-size BYTES] [--pb]"
+                     " [--data-transfer] [--passes N] [--seed N] [--port N]"
+                  << std::endl;
+        return 1;
+      }
+    }
+
+    auto io{std::make_shared<boost::asio::io_context>()};
+    Peer server{io}, client{io};
+    std::mt19937_64 random{config.seed};
+    Dag dag;
+    auto root{makeDag(*server.ipld, config, random, config.depth, dag)};
+    if (!root) {
+      std::cerr << "cannot make dag: " << root.error().message() << std::endl;
+      return 1;
+    }
+    dag.root = root.value();
+    /*
+     * Data transfer doesn't forward selector of channel yet, so its pull
+     * moves root block only.
+     */
+    auto expected{config.data_transfer ? Dag{dag.root, 1, 0} : dag};
+    std::cout << "dag: " << dag.blocks << " blocks, " << dag.bytes
+              << " bytes, " << (config.pb ? "dag-pb" : "dag-cbor") << std::endl;
+
+    auto address{Multiaddress::create("/ip4/127.0.0.1/tcp/"
+                                      + std::to_string(config.port))
+                     .value()};
+    if (auto listen{server.host->listen(address)}; !listen) {
+      std::cerr << "cannot listen: " << listen.error().message() << std::endl;
+      return 1;
+    }
+    server.graphsync->start(MerkleDagBridge::create(server.ipld),
+                            [](auto, auto) {});
+    server.host->start();
+
+    uint64_t blocks{}, bytes{};
+    size_t pass{0};
+    auto failed{false};
+    Subscription request;
+    std::function<void()> fetch;
+    client.graphsync->start(MerkleDagBridge::create(client.ipld),
+                            [&](CID, Buffer data) {
+                              ++blocks;
+                              bytes += data.size();
+                            });
+    client.host->start();
+
+    PeerInfo server_info{server.host->getId(), {address}};
+    boost::asio::steady_timer poll{*io};
+    if (config.data_transfer) {
+      auto validator{std::make_shared<AcceptAll>()};
+      for (auto peer : {&server, &client}) {
+        peer->manager =
+            std::make_shared<GraphSyncManager>(peer->host, peer->graphsync);
+        if (auto init{peer->manager->init(kVoucherType, validator)}; !init) {
+          std::cerr << "cannot init data transfer: " << init.error().message()
+                    << std::endl;
+          return 1;
+        }
+      }
+      // manager has no completion callback, queue counts finished transfers
+      std::function<void()> wait{[&] {
+        if (client.manager->transferQueue()->stats().finished > pass) {
+          return ++pass == config.passes ? io->stop() : fetch();
+        }
+        poll.expires_after(std::chrono::milliseconds{1});
+        poll.async_wait([&](auto) { wait(); });
+      }};
+      fetch = [&] {
+        auto channel{client.manager->openPullDataChannel(
+            server_info,
+            Voucher{kVoucherType, {}},
+            dag.root,
+            std::make_shared<Selector>(ipld::kAllSelector))};
+        if (!channel) {
+          std::cerr << "cannot open channel: " << channel.error().message()
+                    << std::endl;
+          failed = true;
+          return io->stop();
+        }
+        wait();
+      };
+    } else {
+      fetch = [&] {
+        request = client.graphsync->makeRequest(
+            server_info.id,
+            server_info.addresses.front(),
+            dag.root,
+            ipld::kAllSelector.raw,
+            {},
+            [&](ResponseStatusCode code, const std::vector<Extension> &) {
+              if (!isTerminal(code)) {
+                return;
+              }
+              if (!isSuccess(code)) {
+                std::cerr << "request failed: " << statusCodeToString(code)
+                          << std::endl;
+                failed = true;
+                return io->stop();
+              }
+              if (++pass == config.passes) {
+                return io->stop();
+              }
+              io->post(fetch);
+            });
+      };
+    }
+
+    rusage usage_before{}, usage_after{};
+    getrusage(RUSAGE_SELF, &usage_before);
+    auto start{Clock::now()};
+    io->post(fetch);
+    io->run();
+    auto seconds{std::chrono::duration<double>(Clock::now() - start).count()};
+    getrusage(RUSAGE_SELF, &usage_after);
+    client.graphsync->stop();
+    server.graphsync->stop();
+    client.host->stop();
+    server.host->stop();
+    if (failed) {
+      return 1;
+    }
+
+    auto cpu{cpuTime(usage_after) - cpuTime(usage_before)};
+    std::cout << "passes: " << config.passes << ", blocks: " << blocks
+              << ", bytes: " << bytes << ", seconds: " << seconds << std::endl
+              << "MB/s: " << bytes / seconds / 1e6
+              << ", blocks/s: " << blocks / seconds << std::endl
+              << "cpu seconds: " << cpu.count() / 1e6 << ", cpu ns/byte: "
+              << (bytes == 0 ? 0 : cpu.count() * 1e3 / bytes) << std::endl
+              << "peak rss KiB: " << usage_after.ru_maxrss
+              << ", before fetch: " << usage_before.ru_maxrss << std::endl;
+    return blocks == expected.blocks * config.passes ? 0 : 2;
+  }
+}  // namespace fc::storage::ipfs::graphsync
+
+int main(int argc, char **argv) {
+  return fc::storage::ipfs::graphsync::loopback(argc, argv);
+}
@@ -0,0 +1,80 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "storage/hamt/hamt.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+
+namespace fc::storage::hamt {
+  using ipfs::InMemoryDatastore;
+
+  /// Keys are deterministic, so runs are comparable
+  std::string key(int64_t i) {
+    return "key" + std::to_string(i);
+  }
+
+  /// Hamt with n keys flushed to fresh store
+  CID makeHamt(const std::shared_ptr<InMemoryDatastore> &ipld, int64_t n) {
+    Hamt hamt{ipld};
+    for (int64_t i = 0; i < n; ++i) {
+      hamt.setCbor(key(i), i).value();
+    }
+    return hamt.flush().value();
+  }
+
+  void HamtSet(benchmark::State &state) {
+    auto n{state.range(0)};
+    for (auto _ : state) {
+      Hamt hamt{std::make_shared<InMemoryDatastore>()};
+      for (int64_t i = 0; i < n; ++i) {
+        benchmark::DoNotOptimize(hamt.setCbor(key(i), i));
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+  }
+
+  void HamtFlush(benchmark::State &state) {
+    auto n{state.range(0)};
+    for (auto _ : state) {
+      state.PauseTiming();
+      auto ipld{std::make_shared<InMemoryDatastore>()};
+      Hamt hamt{ipld};
+      for (int64_t i = 0; i < n; ++i) {
+        hamt.setCbor(key(i), i).value();
+      }
+      state.ResumeTiming();
+      benchmark::DoNotOptimize(hamt.flush());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+  }
+
+  void HamtGet(benchmark::State &state) {
+    auto n{state.range(0)};
+    auto ipld{std::make_shared<InMemoryDatastore>()};
+    auto root{makeHamt(ipld, n)};
+    for (auto _ : state) {
+      // loaded from store, nodes are cached by hamt
+      Hamt hamt{ipld, root};
+      for (int64_t i = 0; i < n; ++i) {
+        benchmark::DoNotOptimize(hamt.getCbor<int64_t>(key(i)));
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+  }
+
+  BENCHMARK(HamtSet)
+      ->RangeMultiplier(10)
+      ->Range(1000, 10000000)
+      ->Unit(benchmark::kMillisecond);
+  BENCHMARK(HamtFlush)
+      ->RangeMultiplier(10)
+      ->Range(1000, 10000000)
+      ->Unit(benchmark::kMillisecond);
+  BENCHMARK(HamtGet)
+      ->RangeMultiplier(10)
+      ->Range(1000, 10000000)
+      ->Unit(benchmark::kMillisecond);
+}  // namespace fc::storage::hamt
@@ -0,0 +1,76 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+#include <boost/filesystem.hpp>
+
+#include "codec/cbor/cbor.hpp"
+#include "storage/ipfs/impl/datastore_leveldb.hpp"
+
+namespace fc::storage::ipfs {
+  namespace fs = boost::filesystem;
+
+  /// Leveldb datastore in temporary directory, removed on destruction
+  struct TempDatastore {
+    TempDatastore()
+        : path{fs::temp_directory_path() / fs::unique_path()},
+          ipld{[&] {
+            leveldb::Options options;
+            options.create_if_missing = true;
+            return LeveldbDatastore::create(path.string(), options).value();
+          }()} {}
+
+    ~TempDatastore() {
+      ipld.reset();
+      fs::remove_all(path);
+    }
+
+    fs::path path;
+    std::shared_ptr<LeveldbDatastore> ipld;
+  };
+
+  /// Block of 256 bytes with value-dependent content
+  common::Buffer block(int64_t i) {
+    return common::Buffer(256, static_cast<uint8_t>(i))
+        .putUint64(static_cast<uint64_t>(i));
+  }
+
+  void LeveldbSet(benchmark::State &state) {
+    auto n{state.range(0)};
+    for (auto _ : state) {
+      state.PauseTiming();
+      TempDatastore store;
+      state.ResumeTiming();
+      for (int64_t i = 0; i < n; ++i) {
+        benchmark::DoNotOptimize(store.ipld->setCbor(block(i)));
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+  }
+
+  void LeveldbGet(benchmark::State &state) {
+    auto n{state.range(0)};
+    TempDatastore store;
+    std::vector<CID> cids;
+    for (int64_t i = 0; i < n; ++i) {
+      cids.push_back(store.ipld->setCbor(block(i)).value());
+    }
+    for (auto _ : state) {
+      for (auto &cid : cids) {
+        benchmark::DoNotOptimize(store.ipld->get(cid));
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+  }
+
+  BENCHMARK(LeveldbSet)
+      ->RangeMultiplier(10)
+      ->Range(1000, 1000000)
+      ->Unit(benchmark::kMillisecond);
+  BENCHMARK(LeveldbGet)
+      ->RangeMultiplier(10)
+      ->Range(1000, 1000000)
+      ->Unit(benchmark::kMillisecond);
+}  // namespace fc::storage::ipfs
@@ -0,0 +1,52 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <cstdlib>
+#include <fstream>
+
+#include <benchmark/benchmark.h>
+
+#include "primitives/tipset/tipset.hpp"
+#include "storage/car/car.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "vm/interpreter/impl/interpreter_impl.hpp"
+
+namespace fc::vm::interpreter {
+  using primitives::tipset::Tipset;
+  using storage::ipfs::InMemoryDatastore;
+
+  /// Environment variable with path to car exported by "lotus chain export"
+  constexpr auto kCarEnv{"FUHON_BENCHMARK_CAR"};
+
+  /**
+   * Interprets tipset recorded in car, car roots are tipset block cids.
+   * Car must contain parent state of the tipset and its messages.
+   */
+  void Interpret(benchmark::State &state) {
+    auto path{std::getenv(kCarEnv)};
+    if (!path) {
+      return state.SkipWithError("car path is not set");
+    }
+    std::ifstream file{path, std::ios::binary};
+    auto ipld{std::make_shared<InMemoryDatastore>()};
+    auto roots{storage::car::loadCar(*ipld, file)};
+    if (!roots) {
+      return state.SkipWithError("cannot load car");
+    }
+    auto ts{Tipset::load(*ipld, roots.value())};
+    if (!ts) {
+      return state.SkipWithError("cannot load tipset");
+    }
+    for (auto _ : state) {
+      // interpreter writes state to store, so runs after first overwrite it
+      auto result{InterpreterImpl{}.interpret(ipld, ts.value())};
+      if (!result) {
+        return state.SkipWithError(result.error().message().c_str());
+      }
+    }
+  }
+
+  BENCHMARK(Interpret)->Unit(benchmark::kMillisecond);
+}  // namespace fc::vm::interpreter
@@ -0,0 +1,220 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+
+#include "primitives/tipset/tipset.hpp"
+#include "storage/car/car.hpp"
+#include "storage/in_memory/in_memory_storage.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "vm/interpreter/impl/interpreter_impl.hpp"
+#include "vm/state/impl/state_tree_impl.hpp"
+
+namespace fc::vm::interpreter {
+  using message::UnsignedMessage;
+  using primitives::tipset::Tipset;
+  using runtime::MessageReceipt;
+  using state::StateTreeImpl;
+  using storage::InMemoryStorage;
+  using storage::ipfs::InMemoryDatastore;
+  using Clock = std::chrono::steady_clock;
+  using Nanoseconds = std::chrono::nanoseconds;
+
+  /// Apply time histogram with power of two microsecond buckets
+  struct Histogram {
+    void add(Nanoseconds time, uint64_t gas_used) {
+      auto us{static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(time).count())};
+      size_t bucket{0};
+      while (us != 0 && bucket + 1 < buckets.size()) {
+        us >>= 1;
+        ++bucket;
+      }
+      ++buckets[bucket];
+      ++count;
+      total += time;
+      gas += gas_used;
+    }
+
+    /// Upper bound of bucket containing percentile, microseconds
+    uint64_t percentile(double p) const {
+      auto rank{static_cast<uint64_t>(p * count)};
+      uint64_t seen{0};
+      for (size_t i{0}; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen > rank) {
+          return uint64_t{1} << i;
+        }
+      }
+      return uint64_t{1} << (buckets.size() - 1);
+    }
+
+    std::array<uint64_t, 32> buckets{};
+    uint64_t count{};
+    Nanoseconds total{};
+    uint64_t gas{};
+  };
+
+  /// Builtin actor codes are identity cids of actor name
+  std::string codeName(const CID &code) {
+    auto &hash{code.content_address};
+    if (hash.getType() == libp2p::multi::HashType::identity) {
+      auto name{hash.getHash()};
+      return {name.begin(), name.end()};
+    }
+    return code.toString().value();
+  }
+
+  /// Tipsets from car roots down to oldest tipset with parents in car
+  outcome::result<std::vector<Tipset>> loadChain(Ipld &ipld,
+                                                 const std::vector<CID> &roots,
+                                                 size_t limit) {
+    std::vector<Tipset> chain;
+    OUTCOME_TRY(head, Tipset::load(ipld, roots));
+    chain.push_back(std::move(head));
+    while (chain.size() < limit && chain.back().height != 0) {
+      auto parent{chain.back().loadParent(ipld)};
+      if (!parent) {
+        break;
+      }
+      chain.push_back(std::move(parent.value()));
+    }
+    std::reverse(chain.begin(), chain.end());
+    return chain;
+  }
+
+  int replay(int argc, char **argv) {
+    if (argc < 2) {
+      std::cerr << "usage: " << argv[0]
+                << " <car> [--tipsets N] [--passes N] [--cached]" << std::endl
+                << "  car is exported by \"lotus chain export\" with state of "
+                   "oldest tipset, roots are head tipset"
+                << std::endl;
+      return 1;
+    }
+    size_t limit{std::numeric_limits<size_t>::max()}, passes{1};
+    auto cached{false};
+    for (auto i{2}; i < argc; ++i) {
+      if (!strcmp(argv[i], "--cached")) {
+        cached = true;
+      } else if (!strcmp(argv[i], "--tipsets") && i + 1 < argc) {
+        limit = std::stoull(argv[++i]);
+      } else if (!strcmp(argv[i], "--passes") && i + 1 < argc) {
+        passes = std::stoull(argv[++i]);
+      }
+    }
+
+    auto ipld{std::make_shared<InMemoryDatastore>()};
+    std::ifstream file{argv[1], std::ios::binary};
+    auto roots{storage::car::loadCar(*ipld, file)};
+    if (!roots) {
+      std::cerr << "cannot load car: " << roots.error().message() << std::endl;
+      return 1;
+    }
+    auto chain{loadChain(*ipld, roots.value(), limit)};
+    if (!chain) {
+      std::cerr << "cannot load tipsets: " << chain.error().message()
+                << std::endl;
+      return 1;
+    }
+    if (chain.value().size() < 2) {
+      std::cerr << "car must contain at least two tipsets" << std::endl;
+      return 1;
+    }
+
+    // receiver actors are resolved in parent state of interpreted tipset
+    std::shared_ptr<StateTreeImpl> parent_state;
+    std::map<std::pair<std::string, uint64_t>, Histogram> methods;
+    auto impl{std::make_shared<InterpreterImpl>(
+        [&](const UnsignedMessage &message,
+            const MessageReceipt &receipt,
+            Nanoseconds time) {
+          auto actor{parent_state->get(message.to)};
+          auto code{actor ? codeName(actor.value().code) : "<new>"};
+          methods[{code, message.method.method_number}].add(time, receipt.gas_used);
+        })};
+    std::shared_ptr<Interpreter> interpreter{impl};
+    if (cached) {
+      interpreter = std::make_shared<CachedInterpreter>(
+          impl, std::make_shared<InMemoryStorage>());
+    }
+
+    // last tipset has no child with expected result, so it is not replayed
+    auto &tipsets{chain.value()};
+    size_t mismatches{0};
+    Nanoseconds elapsed{};
+    for (size_t pass{0}; pass < passes; ++pass) {
+      for (size_t i{0}; i + 1 < tipsets.size(); ++i) {
+        auto &tipset{tipsets[i]};
+        auto &child{tipsets[i + 1]};
+        parent_state =
+            std::make_shared<StateTreeImpl>(ipld, tipset.getParentStateRoot());
+        auto start{Clock::now()};
+        auto result{interpreter->interpret(ipld, tipset)};
+        elapsed += Clock::now() - start;
+        if (!result) {
+          std::cerr << "height " << tipset.height
+                    << ": interpret failed: " << result.error().message()
+                    << std::endl;
+          return 1;
+        }
+        if (result.value().state_root != child.getParentStateRoot()
+            || result.value().message_receipts
+                   != child.getParentMessageReceipts()) {
+          ++mismatches;
+          std::cerr << "height " << tipset.height << ": state root "
+                    << result.value().state_root.toString().value()
+                    << ", expected "
+                    << child.getParentStateRoot().toString().value()
+                    << std::endl;
+        }
+      }
+    }
+
+    Histogram all;
+    for (auto &[key, histogram] : methods) {
+      all.count += histogram.count;
+      all.total += histogram.total;
+      all.gas += histogram.gas;
+    }
+    auto seconds{std::chrono::duration<double>(elapsed).count()};
+    std::cout << "tipsets: " << (tipsets.size() - 1) * passes
+              << ", messages: " << all.count << ", gas: " << all.gas
+              << ", seconds: " << seconds << std::endl
+              << "messages/sec: " << all.count / seconds
+              << ", gas/sec: " << all.gas / seconds << std::endl
+              << "mismatches: " << mismatches << std::endl
+              << std::endl
+              << std::left << std::setw(24) << "actor" << std::right
+              << std::setw(8) << "method" << std::setw(10) << "count"
+              << std::setw(12) << "mean us" << std::setw(10) << "p50 us"
+              << std::setw(10) << "p99 us" << std::setw(16) << "gas"
+              << std::endl;
+    for (auto &[key, histogram] : methods) {
+      auto mean{std::chrono::duration_cast<std::chrono::microseconds>(
+                    histogram.total)
+                    .count()
+                / histogram.count};
+      std::cout << std::left << std::setw(24) << key.first << std::right
+                << std::setw(8) << key.second << std::setw(10)
+                << histogram.count << std::setw(12) << mean << std::setw(10)
+                << histogram.percentile(0.5) << std::setw(10)
+                << histogram.percentile(0.99) << std::setw(16)
+                << histogram.gas << std::endl;
+    }
+    return mismatches == 0 ? 0 : 2;
+  }
+}  // namespace fc::vm::interpreter
+
+int main(int argc, char **argv) {
+  return fc::vm::interpreter::replay(argc, argv);
+}
@@ -26,6 +26,17 @@ function(addtest test_name)
   disable_clang_tidy(${test_name})
 endfunction()
 
+function(addbenchmark benchmark_name)
+  add_executable(${benchmark_name} ${ARGN})
+  target_link_libraries(${benchmark_name}
+      benchmark::benchmark_main
+      )
+  set_target_properties(${benchmark_name} PROPERTIES
+      RUNTIME_OUTPUT_DIRECTORY ${CMAKE_BINARY_DIR}/benchmark_bin
+      )
+  disable_clang_tidy(${benchmark_name})
+endfunction()
+
 function(addtest_part test_name)
   if (POLICY CMP0076)
     cmake_policy(SET CMP0076 NEW)
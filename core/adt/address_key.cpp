@@ -10,6 +10,21 @@
 
 namespace fc::adt {
   std::string AddressKeyer::encode(const Key &key) {
+    if (auto id = boost::get<uint64_t>(&key.data)) {
+      // protocol and varint fit small string, no buffers are allocated
+      std::string bytes;
+      bytes.push_back(primitives::address::Protocol::ID);
+      auto value = *id;
+      do {
+        auto byte = static_cast<char>(value & 0x7f);
+        value >>= 7;
+        if (value != 0) {
+          byte |= static_cast<char>(0x80);
+        }
+        bytes.push_back(byte);
+      } while (value != 0);
+      return bytes;
+    }
     auto bytes = primitives::address::encode(key);
     return {bytes.begin(), bytes.end()};
   }
@@ -16,6 +16,13 @@ namespace fc::adt {
   struct Array {
     using Key = uint64_t;
     using Visitor = std::function<outcome::result<void>(Key, const Value &)>;
+    using WhileVisitor =
+        std::function<outcome::result<bool>(Key, const Value &)>;
+    /// Receives none as before for added value, none as after for removed
+    using DiffVisitor =
+        std::function<outcome::result<void>(Key,
+                                            const boost::optional<Value> &,
+                                            const boost::optional<Value> &)>;
 
     Array(IpldPtr ipld = nullptr) : amt{ipld} {}
 
@@ -53,6 +60,19 @@ namespace fc::adt {
       return set(count, value);
     }
 
+    /// Replace content with values at keys from zero, writes each node once
+    template <typename Values>
+    outcome::result<void> assign(const Values &values) {
+      storage::amt::AmtBuilder builder{amt.ipld};
+      Key key{0};
+      for (auto &value : values) {
+        OUTCOME_TRY(builder.appendCbor(key++, value));
+      }
+      OUTCOME_TRY(root, builder.flush());
+      amt = {amt.ipld, root};
+      return outcome::success();
+    }
+
     outcome::result<void> visit(const Visitor &visitor) {
       return amt.visit([&](auto key, auto &value) -> outcome::result<void> {
         OUTCOME_TRY(value2, amt.ipld->decode<Value>(value));
@@ -60,6 +80,66 @@ namespace fc::adt {
       });
     }
 
+    /// Visit values with keys in [from, to) until visitor returns false
+    outcome::result<void> visitRange(Key from,
+                                     Key to,
+                                     const WhileVisitor &visitor) {
+      return amt.visitRange(
+          from, to, [&](auto key, auto &value) -> outcome::result<bool> {
+            OUTCOME_TRY(value2, amt.ipld->decode<Value>(value));
+            return visitor(key, value2);
+          });
+    }
+
+    /**
+     * Visit and remove values with keys in [from, to) in ascending order.
+     * Only nodes overlapping range are loaded.
+     */
+    outcome::result<void> popRange(Key from,
+                                   Key to,
+                                   const Visitor &visitor) {
+      std::vector<Key> keys;
+      OUTCOME_TRY(visitRange(
+          from, to, [&](auto key, auto &value) -> outcome::result<bool> {
+            OUTCOME_TRY(visitor(key, value));
+            keys.push_back(key);
+            return true;
+          }));
+      for (auto key : keys) {
+        OUTCOME_TRY(remove(key));
+      }
+      return outcome::success();
+    }
+
+    /// Visit values with keys from set, other subtrees are not loaded
+    outcome::result<void> visitIndices(const std::set<Key> &keys,
+                                       const Visitor &visitor) {
+      return amt.visitIndices(
+          keys, [&](auto key, auto &value) -> outcome::result<void> {
+            OUTCOME_TRY(value2, amt.ipld->decode<Value>(value));
+            return visitor(key, value2);
+          });
+    }
+
+    /// Visit changes from flushed before array to this flushed array
+    outcome::result<void> diff(const Array &before,
+                               const DiffVisitor &visitor) {
+      return Amt::diff(
+          amt.ipld,
+          before.amt.cid(),
+          amt.cid(),
+          [&](auto key, auto &bytes1, auto &bytes2) -> outcome::result<void> {
+            boost::optional<Value> value1, value2;
+            if (bytes1) {
+              OUTCOME_TRYA(value1, amt.ipld->decode<Value>(*bytes1));
+            }
+            if (bytes2) {
+              OUTCOME_TRYA(value2, amt.ipld->decode<Value>(*bytes2));
+            }
+            return visitor(key, value1, value2);
+          });
+    }
+
     outcome::result<std::vector<Value>> values() {
       std::vector<Value> values;
       OUTCOME_TRY(visit([&](auto, auto &value) {
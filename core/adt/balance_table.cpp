@@ -14,29 +14,70 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::adt, BalanceTableError, e) {
 }
 
 namespace fc::adt {
+  using primitives::checkedMath;
+
+  constexpr auto kAdd{[](auto a, auto b) -> decltype(a) { return a + b; }};
+
   outcome::result<void> BalanceTable::add(const Key &key, TokenAmount amount) {
-    OUTCOME_TRY(value, get(key));
-    value += amount;
-    OUTCOME_TRY(set(key, value));
-    return outcome::success();
+    return update(key, [&](auto &value) -> outcome::result<void> {
+      if (!value) {
+        return storage::hamt::HamtError::kNotFound;
+      }
+      *value = checkedMath(kAdd, *value, amount);
+      return outcome::success();
+    });
+  }
+
+  outcome::result<void> BalanceTable::addMany(
+      const std::vector<std::pair<Key, TokenAmount>> &amounts) {
+    std::vector<Key> keys;
+    keys.reserve(amounts.size());
+    for (auto &pair : amounts) {
+      keys.push_back(pair.first);
+    }
+    return updateMany(keys, [&](auto i, auto &value) -> outcome::result<void> {
+      if (!value) {
+        return storage::hamt::HamtError::kNotFound;
+      }
+      *value = checkedMath(kAdd, *value, amounts[i].second);
+      return outcome::success();
+    });
   }
 
   outcome::result<void> BalanceTable::addCreate(const Key &key,
                                                 TokenAmount amount) {
-    OUTCOME_TRY(value, tryGet(key));
-    if (value) {
-      amount += *value;
-    }
-    return set(key, amount);
+    return update(key, [&](auto &value) -> outcome::result<void> {
+      if (value) {
+        *value = checkedMath(kAdd, *value, amount);
+      } else {
+        value = amount;
+      }
+      return outcome::success();
+    });
   }
 
   outcome::result<TokenAmount> BalanceTable::subtractWithMin(const Key &key,
                                                              TokenAmount amount,
                                                              TokenAmount min) {
-    OUTCOME_TRY(value, get(key));
-    TokenAmount subtracted =
-        std::min(amount, std::max(TokenAmount{value - min}, TokenAmount{0}));
-    OUTCOME_TRY(set(key, value - subtracted));
+    TokenAmount subtracted;
+    OUTCOME_TRY(update(key, [&](auto &value) -> outcome::result<void> {
+      if (!value) {
+        return storage::hamt::HamtError::kNotFound;
+      }
+      subtracted = checkedMath(
+          [](auto amount, auto value, auto min) -> decltype(amount) {
+            decltype(amount) left = value - min;
+            if (left < 0) {
+              left = 0;
+            }
+            return amount < left ? amount : left;
+          },
+          amount,
+          *value,
+          min);
+      *value -= subtracted;
+      return outcome::success();
+    }));
     return subtracted;
   }
 
@@ -20,6 +20,10 @@ namespace fc::adt {
 
     outcome::result<void> add(const Key &key, TokenAmount amount);
 
+    /// Adds amounts to existing balances, walks shared hamt paths once
+    outcome::result<void> addMany(
+        const std::vector<std::pair<Key, TokenAmount>> &amounts);
+
     outcome::result<void> addCreate(const Key &key, TokenAmount amount);
 
     outcome::result<TokenAmount> subtractWithMin(const Key &key,
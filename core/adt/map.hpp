@@ -32,12 +32,98 @@ namespace fc::adt {
     using Key = typename Keyer::Key;
     using Visitor =
         std::function<outcome::result<void>(const Key &, const Value &)>;
+    /// Returns false to stop visit
+    using WhileVisitor =
+        std::function<outcome::result<bool>(const Key &, const Value &)>;
+    /// Receives none if key is absent, set none to remove
+    using Updater =
+        std::function<outcome::result<void>(boost::optional<Value> &)>;
+    /// Receives position of key in batch, none if key is absent
+    using ManyUpdater =
+        std::function<outcome::result<void>(size_t, boost::optional<Value> &)>;
+    using HashedKey = Hamt::HashedKey;
+    /// Receives none as before for added value, none as after for removed
+    using DiffVisitor =
+        std::function<outcome::result<void>(const Key &,
+                                            const boost::optional<Value> &,
+                                            const boost::optional<Value> &)>;
 
     Map(IpldPtr ipld = nullptr) : hamt{ipld, bit_width} {}
 
     Map(const CID &root, IpldPtr ipld = nullptr)
         : hamt{ipld, root, bit_width} {}
 
+    /// Encode and hash key once for repeated operations
+    HashedKey hashKey(const Key &key) const {
+      return hamt.hashKey(Keyer::encode(key));
+    }
+
+    outcome::result<boost::optional<Value>> tryGet(const HashedKey &key) {
+      return hamt.tryGetCbor<Value>(key);
+    }
+
+    outcome::result<bool> has(const HashedKey &key) {
+      return hamt.contains(key);
+    }
+
+    outcome::result<Value> get(const HashedKey &key) {
+      return hamt.getCbor<Value>(key);
+    }
+
+    outcome::result<void> set(const HashedKey &key, const Value &value) {
+      return hamt.setCbor(key, value);
+    }
+
+    outcome::result<void> remove(const HashedKey &key) {
+      return hamt.remove(key);
+    }
+
+    /// Read-modify-write value by key, walks hamt path once
+    outcome::result<void> update(const Key &key, const Updater &updater) {
+      return hamt.update(
+          Keyer::encode(key),
+          [&](boost::optional<storage::hamt::Value> &bytes)
+              -> outcome::result<void> {
+            boost::optional<Value> value;
+            if (bytes) {
+              OUTCOME_TRYA(value, hamt.ipld->decode<Value>(*bytes));
+            }
+            OUTCOME_TRY(updater(value));
+            if (value) {
+              OUTCOME_TRYA(bytes, Ipld::encode(*value));
+            } else {
+              bytes = boost::none;
+            }
+            return outcome::success();
+          });
+    }
+
+    /// Read-modify-write values of keys, walks shared hamt paths once
+    outcome::result<void> updateMany(const std::vector<Key> &keys,
+                                     const ManyUpdater &updater) {
+      std::vector<HashedKey> hashed;
+      hashed.reserve(keys.size());
+      for (auto &key : keys) {
+        hashed.push_back(hashKey(key));
+      }
+      return hamt.updateMany(
+          hashed,
+          [&](auto i, boost::optional<storage::hamt::Value> &bytes)
+              -> outcome::result<void> {
+            boost::optional<Value> value;
+            if (bytes) {
+              OUTCOME_TRYA(value, hamt.ipld->decode<Value>(*bytes));
+            }
+            OUTCOME_TRY(updater(i, value));
+            if (value) {
+              OUTCOME_TRYA(bytes, Ipld::encode(*value));
+            } else {
+              bytes = boost::none;
+            }
+            return outcome::success();
+          });
+    }
+
     outcome::result<boost::optional<Value>> tryGet(const Key &key) {
       return hamt.tryGetCbor<Value>(Keyer::encode(key));
     }
@@ -66,6 +152,55 @@ namespace fc::adt {
       });
     }
 
+    /// Visit subtrees concurrently on pool, see Hamt::visitParallel
+    outcome::result<void> visitParallel(const Visitor &visitor,
+                                        boost::asio::thread_pool &pool,
+                                        bool ordered) {
+      return hamt.visitParallel(
+          [&](auto &key, auto &value) -> outcome::result<void> {
+            OUTCOME_TRY(key2, Keyer::decode(key));
+            OUTCOME_TRY(value2, hamt.ipld->decode<Value>(value));
+            return visitor(key2, value2);
+          },
+          pool,
+          ordered);
+    }
+
+    /// Visit pairs following key in hamt order, until visitor returns false
+    outcome::result<void> visitAfter(const boost::optional<Key> &after,
+                                     const WhileVisitor &visitor) {
+      boost::optional<std::string> after2;
+      if (after) {
+        after2 = Keyer::encode(*after);
+      }
+      return hamt.visitAfter(
+          after2, [&](auto &key, auto &value) -> outcome::result<bool> {
+            OUTCOME_TRY(key2, Keyer::decode(key));
+            OUTCOME_TRY(value2, hamt.ipld->decode<Value>(value));
+            return visitor(key2, value2);
+          });
+    }
+
+    /// Visit changes from flushed before map to this flushed map
+    outcome::result<void> diff(const Map &before,
+                               const DiffVisitor &visitor) {
+      return Hamt::diff(
+          hamt.ipld,
+          before.hamt.cid(),
+          hamt.cid(),
+          [&](auto &key, auto &bytes1, auto &bytes2) -> outcome::result<void> {
+            OUTCOME_TRY(key2, Keyer::decode(key));
+            boost::optional<Value> value1, value2;
+            if (bytes1) {
+              OUTCOME_TRYA(value1, hamt.ipld->decode<Value>(*bytes1));
+            }
+            if (bytes2) {
+              OUTCOME_TRYA(value2, hamt.ipld->decode<Value>(*bytes2));
+            }
+            return visitor(key2, value1, value2);
+          });
+    }
+
     outcome::result<std::vector<Key>> keys() {
       std::vector<Key> keys;
       OUTCOME_TRY(hamt.visit([&](auto &key, auto &) -> outcome::result<void> {
@@ -24,6 +24,26 @@ namespace fc::adt {
       return map.set(key, *array);
     }
 
+    /// Appends values to array of key, loads and stores array once
+    template <typename Value, typename Keyer, size_t bit_width>
+    static outcome::result<void> appendMany(
+        Map<Array<Value>, Keyer, bit_width> &map,
+        const typename Keyer::Key &key,
+        const std::vector<Value> &values) {
+      if (values.empty()) {
+        return outcome::success();
+      }
+      return map.update(key, [&](auto &array) -> outcome::result<void> {
+        if (!array) {
+          array = Array<Value>{map.hamt.ipld};
+        }
+        for (auto &value : values) {
+          OUTCOME_TRY(array->append(value));
+        }
+        return outcome::success();
+      });
+    }
+
     template <typename Value, typename Keyer, size_t bit_width>
     static outcome::result<void> visit(
         Map<Array<Value>, Keyer, bit_width> &map,
@@ -19,7 +19,18 @@ namespace fc::adt {
   }
 
   template <typename Keyer>
-  struct Set : Map<SetValue, Keyer> {};
+  struct Set : Map<SetValue, Keyer> {
+    using Map<SetValue, Keyer>::Map;
+
+    /// Puts keys, walks shared hamt paths once
+    outcome::result<void> putMany(
+        const std::vector<typename Keyer::Key> &keys) {
+      return this->updateMany(keys, [](auto, auto &value) {
+        value = SetValue{};
+        return outcome::success();
+      });
+    }
+  };
 }  // namespace fc::adt
 
 namespace fc {
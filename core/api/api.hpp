@@ -11,6 +11,7 @@
 #include <libp2p/peer/peer_info.hpp>
 
 #include "adt/channel.hpp"
+#include "api/rpc/chan_outbox.hpp"
 #include "common/libp2p/peer/cbor_peer_id.hpp"
 #include "common/todo_error.hpp"
 #include "crypto/randomness/randomness_types.hpp"
@@ -24,11 +25,13 @@
 #include "primitives/ticket/epost_ticket.hpp"
 #include "primitives/ticket/ticket.hpp"
 #include "primitives/tipset/tipset.hpp"
+#include "storage/leveldb/leveldb_metrics.hpp"
 #include "storage/mpool/mpool.hpp"
 #include "vm/actor/builtin/market/actor.hpp"
 #include "vm/actor/builtin/miner/types.hpp"
 #include "vm/actor/builtin/payment_channel/payment_channel_actor_state.hpp"
 #include "vm/actor/builtin/storage_power/storage_power_actor_state.hpp"
+#include "vm/runtime/profiler.hpp"
 #include "vm/runtime/runtime_types.hpp"
 
 #define API_METHOD(_name, _result, ...)                                    \
@@ -55,6 +58,7 @@ namespace fc::api {
   using primitives::ChainEpoch;
   using primitives::DealId;
   using primitives::EpochDuration;
+  using primitives::GasAmount;
   using primitives::RleBitset;
   using primitives::SectorNumber;
   using primitives::SectorSize;
@@ -89,6 +93,7 @@ namespace fc::api {
   using vm::message::UnsignedMessage;
   using vm::runtime::ExecutionResult;
   using vm::runtime::MessageReceipt;
+  using vm::runtime::MethodProfile;
 
   template <typename... T>
   using ParamsTuple =
@@ -100,6 +105,15 @@ namespace fc::api {
     Chan(std::shared_ptr<Channel<T>> channel) : channel{std::move(channel)} {}
     uint64_t id{};
     std::shared_ptr<Channel<T>> channel;
+    /**
+     * Called once rpc is reading channel, writes values produced on demand.
+     * Argument blocks until subscriber has room for value, false if channel
+     * is closed.
+     */
+    std::function<void(std::function<bool()>)> produce;
+    /// Unsent values buffered for subscriber
+    size_t capacity{kChanCapacity};
+    ChanOverflow overflow{ChanOverflow::kWait};
   };
 
   template <typename T>
@@ -162,6 +176,16 @@ namespace fc::api {
     SectorNumber id;
   };
 
+  /**
+   * Part of large result.
+   * Cursor is opaque position to pass for next page, none after last page.
+   */
+  template <typename T>
+  struct Page {
+    T items;
+    boost::optional<std::string> cursor;
+  };
+
   struct MsgWait {
     MessageReceipt receipt;
     Tipset tipset;
@@ -172,6 +196,7 @@ namespace fc::api {
     std::vector<SignedMessage> secp;
     std::vector<CID> cids;
   };
+  CBOR_TUPLE(BlockMessages, bls, secp, cids)
 
   struct CidMessage {
     CID cid;
@@ -183,6 +208,12 @@ namespace fc::api {
     Buffer raw;
   };
 
+  /// Metrics of leveldb store since open
+  struct StoreStats {
+    std::string name;
+    storage::LevelDBStats stats;
+  };
+
   struct VersionResult {
     std::string version;
     uint64_t api_version;
@@ -298,6 +329,21 @@ namespace fc::api {
                const FileRef &)
     API_METHOD(ClientStartDeal, Wait<CID>, const StartDealParams &)
 
+    /**
+     * Estimates gas price for message to be included within given number
+     * of blocks, from prices of messages in recent blocks
+     * @param blocks - number of blocks to be included within
+     * @param sender - sender of message
+     * @param gas_limit - gas limit of message
+     * @param tipset_key - head to count blocks from, empty for current one
+     */
+    API_METHOD(GasEstimateGasPrice,
+               TokenAmount,
+               uint64_t,
+               const Address &,
+               GasAmount,
+               const TipsetKey &)
+
     /**
      * Ensures that a storage market participant has a certain amount of
      * available funds. If additional funds are needed, they will be sent from
@@ -324,6 +370,7 @@ namespace fc::api {
 
     API_METHOD(MpoolPending, std::vector<SignedMessage>, const TipsetKey &)
     API_METHOD(MpoolPushMessage, SignedMessage, const UnsignedMessage &)
+    API_METHOD(MpoolSelect, std::vector<SignedMessage>, const TipsetKey &)
     API_METHOD(MpoolSub, Chan<MpoolUpdate>)
 
     API_METHOD(NetAddrsListen, PeerInfo)
@@ -333,23 +380,57 @@ namespace fc::api {
                InvocResult,
                const UnsignedMessage &,
                const TipsetKey &)
+    /// Calls messages concurrently on same state, failed call has error set
+    API_METHOD(StateCallMany,
+               std::vector<InvocResult>,
+               const std::vector<UnsignedMessage> &,
+               const TipsetKey &)
     API_METHOD(StateListMessages,
                std::vector<CID>,
                const UnsignedMessage &,
                const TipsetKey &,
                ChainEpoch)
+    API_METHOD(StateListMessagesPage,
+               Page<std::vector<CID>>,
+               const UnsignedMessage &,
+               const TipsetKey &,
+               ChainEpoch,
+               const boost::optional<std::string> &,
+               uint64_t)
     API_METHOD(StateGetActor, Actor, const Address &, const TipsetKey &)
     API_METHOD(StateReadState, ActorState, const Actor &, const TipsetKey &)
     API_METHOD(StateGetReceipt, MessageReceipt, const CID &, const TipsetKey &)
     API_METHOD(StateListMiners, std::vector<Address>, const TipsetKey &)
     API_METHOD(StateListActors, std::vector<Address>, const TipsetKey &)
+    API_METHOD(StateListActorsPage,
+               Page<std::vector<Address>>,
+               const TipsetKey &,
+               const boost::optional<std::string> &,
+               uint64_t)
+    /// Streams actor addresses in pages of given size
+    API_METHOD(StateListActorsChan,
+               Chan<std::vector<Address>>,
+               const TipsetKey &,
+               uint64_t)
     API_METHOD(StateMarketBalance,
                MarketBalance,
                const Address &,
                const TipsetKey &)
     API_METHOD(StateMarketDeals, MarketDealMap, const TipsetKey &)
+    API_METHOD(StateMarketDealsPage,
+               Page<MarketDealMap>,
+               const TipsetKey &,
+               const boost::optional<std::string> &,
+               uint64_t)
+    /// Streams deals in pages of given size
+    API_METHOD(StateMarketDealsChan,
+               Chan<MarketDealMap>,
+               const TipsetKey &,
+               uint64_t)
     API_METHOD(StateLookupID, Address, const Address &, const TipsetKey &)
     API_METHOD(StateMarketStorageDeal, StorageDeal, DealId, const TipsetKey &)
+    /// Actor method stats collected by interpreter profiler since start
+    API_METHOD(StateMethodProfile, std::vector<MethodProfile>)
     API_METHOD(StateMinerDeadlines,
                Deadlines,
                const Address &,
@@ -371,6 +452,12 @@ namespace fc::api {
                const boost::optional<RleBitset> &,
                bool,
                const TipsetKey &)
+    API_METHOD(StateMinerSectorsPage,
+               Page<std::vector<ChainSectorInfo>>,
+               const Address &,
+               const TipsetKey &,
+               const boost::optional<std::string> &,
+               uint64_t)
     API_METHOD(StateMinerSectorSize,
                SectorSize,
                const Address &,
@@ -379,6 +466,9 @@ namespace fc::api {
     API_METHOD(StateNetworkName, std::string)
     API_METHOD(StateWaitMsg, Wait<MsgWait>, const CID &)
 
+    /// Latencies, hits and per prefix bytes of each leveldb store
+    API_METHOD(StorageStats, std::vector<StoreStats>)
+
     API_METHOD(SyncSubmitBlock, void, const BlockWithCids &)
 
     API_METHOD(Version, VersionResult)
@@ -5,10 +5,15 @@
 
 #include "api/make.hpp"
 
+#include <limits>
+
 #include <boost/algorithm/string.hpp>
 #include <libp2p/peer/peer_id.hpp>
 
 #include "blockchain/production/block_producer.hpp"
+#include "codec/cbor/streams_annotation.hpp"
+#include "common/hexutil.hpp"
+#include "common/lru_cache.hpp"
 #include "proofs/proofs.hpp"
 #include "storage/hamt/hamt.hpp"
 #include "vm/actor/builtin/account/account_actor.hpp"
@@ -16,7 +21,7 @@
 #include "vm/actor/builtin/market/actor.hpp"
 #include "vm/actor/builtin/miner/types.hpp"
 #include "vm/actor/builtin/storage_power/storage_power_actor_state.hpp"
-#include "vm/actor/impl/invoker_impl.hpp"
+#include "vm/interpreter/impl/call_simulator.hpp"
 #include "vm/message/impl/message_signer_impl.hpp"
 #include "vm/runtime/env.hpp"
 #include "vm/state/impl/state_tree_impl.hpp"
@@ -36,10 +41,12 @@ namespace fc::api {
   using crypto::signature::BlsSignature;
   using libp2p::peer::PeerId;
   using primitives::block::MsgMeta;
+  using primitives::tipset::HeadChangeType;
+  using primitives::tipset::MessageVisitor;
   using vm::isVMExitCode;
   using vm::normalizeVMExitCode;
   using vm::VMExitCode;
-  using vm::actor::InvokerImpl;
+  using vm::interpreter::CachedBlockMessages;
   using vm::runtime::Env;
   using vm::state::StateTreeImpl;
   using connection_t = boost::signals2::connection;
@@ -47,25 +54,127 @@ namespace fc::api {
 
   constexpr EpochDuration kWinningPoStSectorSetLookback{10};
 
+  /// Position of messages page, tipset and count of its returned messages
+  struct MessagesCursor {
+    std::vector<CID> tipset;
+    uint64_t offset{};
+  };
+  CBOR_TUPLE(MessagesCursor, tipset, offset)
+
+  /**
+   * Position of actors page, with tipset of first page, so later pages read
+   * same state after head changed
+   */
+  struct ActorsCursor {
+    std::vector<CID> tipset;
+    Address after;
+  };
+  CBOR_TUPLE(ActorsCursor, tipset, after)
+
+  /// Position of deals or sectors page, next index and tipset of first page
+  struct IndexCursor {
+    std::vector<CID> tipset;
+    uint64_t next{};
+  };
+  CBOR_TUPLE(IndexCursor, tipset, next)
+
+  /// Page cursors are hex of cbor encoded position
+  template <typename T>
+  std::string encodeCursor(const T &position) {
+    return common::hex_lower(codec::cbor::encode(position).value());
+  }
+
+  template <typename T>
+  outcome::result<T> decodeCursor(const std::string &cursor) {
+    OUTCOME_TRY(bytes, common::unhex(cursor));
+    return codec::cbor::decode<T>(bytes);
+  }
+
+  constexpr size_t kTipsetContextCacheSize{32};
+  constexpr size_t kCallThreads{4};
+  /// Unsent head changes before they are coalesced into current head
+  constexpr size_t kChainNotifyCapacity{16};
+  /// Unsent mpool updates before oldest of them are dropped
+  constexpr size_t kMpoolSubCapacity{1024};
+
+  /**
+   * Tipset data shared by queries of same tipset.
+   * Actor states are decoded once and copied on use, so copies load adt
+   * nodes independently.
+   */
+  struct TipsetCacheEntry {
+    /// Guards loading and decoded states
+    std::mutex mutex;
+    bool loaded{false};
+    Tipset tipset;
+    boost::optional<InterpreterResult> interpreted;
+    boost::optional<MarketActorState> market;
+    boost::optional<StoragePowerActorState> power;
+    boost::optional<InitActorState> init;
+    std::map<Address, MinerActorState> miners;
+  };
+
+  /// Entries of recently queried tipsets, reverted tipsets are evicted
+  struct TipsetContextCache {
+    using Cache = common::LruCache<TipsetKey, std::shared_ptr<TipsetCacheEntry>>;
+
+    /// Concurrent queries of same tipset wait for single load
+    std::mutex mutex;
+    Cache parent_state{kTipsetContextCacheSize};
+    Cache interpreted{kTipsetContextCacheSize};
+    boost::signals2::scoped_connection head_changes;
+  };
+
+  /// Single head change subscription shared by ChainNotify channels
+  struct HeadChangeFanout {
+    std::mutex mutex;
+    Channel<std::vector<HeadChange>>::Many channels;
+    boost::signals2::scoped_connection head_changes;
+  };
+
   struct TipsetContext {
     Tipset tipset;
     StateTreeImpl state_tree;
     boost::optional<InterpreterResult> interpreted;
+    std::shared_ptr<TipsetCacheEntry> cached;
+
+    template <typename T>
+    outcome::result<T> cachedState(boost::optional<T> TipsetCacheEntry::*slot,
+                                   const Address &address) {
+      if (!cached) {
+        return state_tree.state<T>(address);
+      }
+      std::lock_guard lock{cached->mutex};
+      auto &state{(*cached).*slot};
+      if (!state) {
+        OUTCOME_TRYA(state, state_tree.state<T>(address));
+      }
+      return *state;
+    }
 
     auto marketState() {
-      return state_tree.state<MarketActorState>(kStorageMarketAddress);
+      return cachedState(&TipsetCacheEntry::market, kStorageMarketAddress);
     }
 
-    auto minerState(const Address &address) {
-      return state_tree.state<MinerActorState>(address);
+    outcome::result<MinerActorState> minerState(const Address &address) {
+      if (!cached) {
+        return state_tree.state<MinerActorState>(address);
+      }
+      std::lock_guard lock{cached->mutex};
+      auto it{cached->miners.find(address)};
+      if (it == cached->miners.end()) {
+        OUTCOME_TRY(state, state_tree.state<MinerActorState>(address));
+        it = cached->miners.emplace(address, std::move(state)).first;
+      }
+      return it->second;
     }
 
     auto powerState() {
-      return state_tree.state<StoragePowerActorState>(kStoragePowerAddress);
+      return cachedState(&TipsetCacheEntry::power, kStoragePowerAddress);
     }
 
     auto initState() {
-      return state_tree.state<InitActorState>(kInitAddress);
+      return cachedState(&TipsetCacheEntry::init, kInitAddress);
     }
 
     outcome::result<Address> accountKey(const Address &id) {
@@ -82,30 +191,107 @@ namespace fc::api {
                std::shared_ptr<Interpreter> interpreter,
                std::shared_ptr<MsgWaiter> msg_waiter,
                std::shared_ptr<Beaconizer> beaconizer,
-               std::shared_ptr<KeyStore> key_store) {
+               std::shared_ptr<KeyStore> key_store,
+               std::shared_ptr<SecpVerifier> secp_verifier,
+               std::shared_ptr<Profiler> profiler,
+               std::shared_ptr<Stores> stores,
+               std::shared_ptr<boost::asio::thread_pool> scan_pool,
+               std::shared_ptr<MessageCache> message_cache) {
+    auto context_cache{std::make_shared<TipsetContextCache>()};
+    context_cache->head_changes = chain_store->subscribeHeadChanges(
+        [weak{std::weak_ptr{context_cache}}](auto &change) {
+          if (change.type != HeadChangeType::REVERT) {
+            return;
+          }
+          if (auto cache{weak.lock()}) {
+            TipsetKey key{change.value.cids};
+            cache->parent_state.remove(key);
+            cache->interpreted.remove(key);
+          }
+        });
+    auto simulator{
+        std::make_shared<vm::interpreter::CallSimulator>(ipld, kCallThreads)};
+    auto invocResult =
+        [](const UnsignedMessage &message,
+           vm::interpreter::CallSimulator::CallResult maybe_result)
+        -> outcome::result<InvocResult> {
+      InvocResult result;
+      result.message = message;
+      if (maybe_result) {
+        result.receipt = {VMExitCode::kOk, maybe_result.value(), 0};
+      } else {
+        if (isVMExitCode(maybe_result.error())) {
+          auto ret_code =
+              normalizeVMExitCode(VMExitCode{maybe_result.error().value()});
+          BOOST_ASSERT_MSG(ret_code, "c++ actor code returned unknown error");
+          result.receipt = {*ret_code, {}, 0};
+        } else {
+          return maybe_result.error();
+        }
+      }
+      return result;
+    };
+    auto head_fanout{std::make_shared<HeadChangeFanout>()};
+    head_fanout->head_changes = chain_store->subscribeHeadChanges(
+        [weak{std::weak_ptr{head_fanout}}](auto &change) {
+          if (auto fanout{weak.lock()}) {
+            std::lock_guard lock{fanout->mutex};
+            // closed channels are removed
+            adt::writeMany(fanout->channels, std::vector<HeadChange>{change});
+          }
+        });
     auto tipsetContext = [=](const TipsetKey &tipset_key,
                              bool interpret =
                                  false) -> outcome::result<TipsetContext> {
-      Tipset tipset;
+      auto &cache{interpret ? context_cache->interpreted
+                            : context_cache->parent_state};
+      boost::optional<Tipset> head;
       if (tipset_key.cids.empty()) {
-        tipset = chain_store->heaviestTipset();
-      } else {
-        OUTCOME_TRYA(tipset, Tipset::load(*ipld, tipset_key.cids));
+        head = chain_store->heaviestTipset();
       }
-      TipsetContext context{tipset, {ipld, tipset.getParentStateRoot()}, {}};
-      if (interpret) {
-        OUTCOME_TRY(result, interpreter->interpret(ipld, tipset));
-        context.state_tree = {ipld, result.state_root};
-        context.interpreted = result;
+      TipsetKey key{head ? head->cids : tipset_key.cids};
+      std::shared_ptr<TipsetCacheEntry> entry;
+      {
+        std::lock_guard lock{context_cache->mutex};
+        entry = cache.get(key).value_or(nullptr);
+        if (!entry) {
+          entry = std::make_shared<TipsetCacheEntry>();
+          cache.put(key, entry);
+        }
       }
-      return context;
+      {
+        std::lock_guard lock{entry->mutex};
+        if (!entry->loaded) {
+          // failed load is retried by next query
+          if (head) {
+            entry->tipset = std::move(*head);
+          } else {
+            OUTCOME_TRYA(entry->tipset, Tipset::load(*ipld, key.cids));
+          }
+          if (interpret) {
+            OUTCOME_TRYA(entry->interpreted,
+                         interpreter->interpret(ipld, entry->tipset));
+          }
+          entry->loaded = true;
+        }
+      }
+      auto &tipset{entry->tipset};
+      return TipsetContext{
+          tipset,
+          {ipld,
+           entry->interpreted ? entry->interpreted->state_root
+                              : tipset.getParentStateRoot()},
+          entry->interpreted,
+          entry,
+      };
     };
     auto getLookbackTipSetForRound =
         [=](auto tipset, auto epoch) -> outcome::result<TipsetContext> {
       auto lookback{
           std::max(ChainEpoch{0}, epoch - kWinningPoStSectorSetLookback)};
-      while (tipset.height > static_cast<uint64_t>(lookback)) {
-        OUTCOME_TRYA(tipset, tipset.loadParent(*ipld));
+      if (tipset.height > static_cast<uint64_t>(lookback)) {
+        OUTCOME_TRYA(tipset,
+                     chain_store->getTipsetByHeight(tipset, lookback, true));
       }
       OUTCOME_TRY(result, interpreter->interpret(ipld, tipset));
       return TipsetContext{
@@ -132,9 +318,125 @@ namespace fc::api {
         for (auto &i : indices) {
           result.push_back(sectors[i]);
         }
+        return result;
       }
       return sectors;
     };
+    // matching messages of tipset blocks, without duplicates
+    auto tipsetMessages = [=](const UnsignedMessage &match, const Tipset &tipset)
+        -> outcome::result<std::vector<CID>> {
+      // TODO(artyom-yurin): Make sure at least one of 'to' or 'from' is
+      // defined
+      auto matchFunc = [&](const UnsignedMessage &message) -> bool {
+        return match.to == message.to && match.from == message.from;
+      };
+      std::vector<CID> result;
+      std::set<CID> visited_cid;
+      auto isDuplicateMessage = [&](const CID &cid) -> bool {
+        return !visited_cid.insert(cid).second;
+      };
+      for (const BlockHeader &block : tipset.blks) {
+        OUTCOME_TRY(meta, ipld->getCbor<MsgMeta>(block.messages));
+        OUTCOME_TRY(meta.bls_messages.visit(
+            [&](auto, auto &cid) -> outcome::result<void> {
+              OUTCOME_TRY(message, ipld->getCbor<UnsignedMessage>(cid));
+              if (!isDuplicateMessage(cid) && matchFunc(message)) {
+                result.push_back(cid);
+              }
+              return outcome::success();
+            }));
+        OUTCOME_TRY(meta.secp_messages.visit(
+            [&](auto, auto &cid) -> outcome::result<void> {
+              OUTCOME_TRY(message, ipld->getCbor<SignedMessage>(cid));
+              if (!isDuplicateMessage(cid) && matchFunc(message.message)) {
+                result.push_back(cid);
+              }
+              return outcome::success();
+            }));
+      }
+      return result;
+    };
+    auto listActorsPage = [=](auto &tipset_key, auto &cursor, auto limit)
+        -> outcome::result<Page<std::vector<Address>>> {
+      if (limit == 0) {
+        return TodoError::kError;
+      }
+      boost::optional<Address> after;
+      TipsetKey key{tipset_key};
+      if (cursor) {
+        OUTCOME_TRY(position, decodeCursor<ActorsCursor>(*cursor));
+        key = TipsetKey{std::move(position.tipset)};
+        after = std::move(position.after);
+      }
+      OUTCOME_TRY(context, tipsetContext(key));
+      OUTCOME_TRY(root, context.state_tree.flush());
+      adt::Map<Actor, adt::AddressKeyer> actors{root, ipld};
+      Page<std::vector<Address>> page;
+      OUTCOME_TRY(actors.visitAfter(
+          after, [&](auto &address, auto &) -> outcome::result<bool> {
+            if (page.items.size() == limit) {
+              page.cursor = encodeCursor(
+                  ActorsCursor{context.tipset.cids, page.items.back()});
+              return false;
+            }
+            page.items.push_back(address);
+            return true;
+          }));
+      return page;
+    };
+    auto marketDealsPage = [=](auto &tipset_key, auto &cursor, auto limit)
+        -> outcome::result<Page<MarketDealMap>> {
+      if (limit == 0) {
+        return TodoError::kError;
+      }
+      IndexCursor position{tipset_key.cids, 0};
+      if (cursor) {
+        OUTCOME_TRYA(position, decodeCursor<IndexCursor>(*cursor));
+      }
+      OUTCOME_TRY(context, tipsetContext(position.tipset));
+      OUTCOME_TRY(state, context.marketState());
+      Page<MarketDealMap> page;
+      OUTCOME_TRY(state.proposals.visitRange(
+          position.next,
+          std::numeric_limits<DealId>::max(),
+          [&](auto deal_id, auto &deal) -> outcome::result<bool> {
+            if (page.items.size() == limit) {
+              page.cursor =
+                  encodeCursor(IndexCursor{context.tipset.cids, deal_id});
+              return false;
+            }
+            OUTCOME_TRY(deal_state, state.states.get(deal_id));
+            page.items.emplace(std::to_string(deal_id),
+                               StorageDeal{deal, deal_state});
+            return true;
+          }));
+      return page;
+    };
+    // writes pages to channel after reader is attached, until last page
+    auto pageChan = [](auto page_size, auto page) {
+      using Items = decltype(
+          page(std::declval<const boost::optional<std::string> &>(), page_size)
+              .value()
+              .items);
+      auto channel{std::make_shared<Channel<Items>>()};
+      Chan<Items> chan{channel};
+      chan.produce = [=](auto ready) {
+        boost::optional<std::string> cursor;
+        do {
+          // waits outside of channel lock, with page not produced yet
+          if (!ready()) {
+            break;
+          }
+          auto result{page(cursor, page_size)};
+          if (!result || !channel->write(std::move(result.value().items))) {
+            break;
+          }
+          cursor = std::move(result.value().cursor);
+        } while (cursor);
+        channel->closeWrite();
+      };
+      return chan;
+    };
     return {
         .AuthNew = {[](auto) {
           return Buffer{1, 2, 3};
@@ -146,6 +448,11 @@ namespace fc::api {
                                       -> outcome::result<BlockMessages> {
           BlockMessages messages;
           OUTCOME_TRY(block, ipld->getCbor<BlockHeader>(block_cid));
+          if (message_cache) {
+            if (auto cached{message_cache->block(block.messages)}) {
+              return BlockMessages{cached->bls, cached->secp, cached->cids};
+            }
+          }
           OUTCOME_TRY(meta, ipld->getCbor<MsgMeta>(block.messages));
           OUTCOME_TRY(meta.bls_messages.visit(
               [&](auto, auto &cid) -> outcome::result<void> {
@@ -161,6 +468,12 @@ namespace fc::api {
                 messages.cids.push_back(cid);
                 return outcome::success();
               }));
+          if (message_cache) {
+            message_cache->putBlock(
+                block.messages,
+                std::make_shared<CachedBlockMessages>(CachedBlockMessages{
+                    block.height, messages.bls, messages.secp, messages.cids}));
+          }
           return messages;
         }},
         .ChainGetGenesis = {[=]() -> outcome::result<Tipset> {
@@ -187,19 +500,32 @@ namespace fc::api {
             {[=](auto &block_cid) -> outcome::result<std::vector<CidMessage>> {
               std::vector<CidMessage> messages;
               OUTCOME_TRY(block, ipld->getCbor<BlockHeader>(block_cid));
+              if (message_cache) {
+                if (auto executed{
+                        message_cache->executed(TipsetKey{block.parents})}) {
+                  messages.reserve(executed->cids.size());
+                  for (size_t i{0}; i < executed->cids.size(); ++i) {
+                    messages.push_back(
+                        {executed->cids[i], executed->messages[i]});
+                  }
+                  return messages;
+                }
+              }
+              // deduplicated like executed messages, so they match receipts
+              MessageVisitor visitor{ipld};
               for (auto &parent_cid : block.parents) {
                 OUTCOME_TRY(parent, ipld->getCbor<BlockHeader>(parent_cid));
-                OUTCOME_TRY(meta, ipld->getCbor<MsgMeta>(parent.messages));
-                OUTCOME_TRY(meta.bls_messages.visit(
-                    [&](auto, auto &cid) -> outcome::result<void> {
-                      OUTCOME_TRY(message, ipld->getCbor<UnsignedMessage>(cid));
-                      messages.push_back({cid, std::move(message)});
-                      return outcome::success();
-                    }));
-                OUTCOME_TRY(meta.secp_messages.visit(
-                    [&](auto, auto &cid) -> outcome::result<void> {
-                      OUTCOME_TRY(message, ipld->getCbor<SignedMessage>(cid));
-                      messages.push_back({cid, std::move(message.message)});
+                OUTCOME_TRY(visitor.visit(
+                    parent,
+                    [&](auto, auto bls, auto &cid) -> outcome::result<void> {
+                      if (bls) {
+                        OUTCOME_TRY(message,
+                                    ipld->getCbor<UnsignedMessage>(cid));
+                        messages.push_back({cid, std::move(message)});
+                      } else {
+                        OUTCOME_TRY(message, ipld->getCbor<SignedMessage>(cid));
+                        messages.push_back({cid, std::move(message.message)});
+                      }
                       return outcome::success();
                     }));
               }
@@ -209,6 +535,16 @@ namespace fc::api {
             {[=](auto &block_cid)
                  -> outcome::result<std::vector<MessageReceipt>> {
               OUTCOME_TRY(block, ipld->getCbor<BlockHeader>(block_cid));
+              if (message_cache) {
+                // block may claim receipts other than computed ones
+                if (auto executed{
+                        message_cache->executed(TipsetKey{block.parents})};
+                    executed
+                    && executed->receipts_root
+                           == block.parent_message_receipts) {
+                  return executed->receipts;
+                }
+              }
               return adt::Array<MessageReceipt>{block.parent_message_receipts,
                                                 ipld}
                   .values();
@@ -224,34 +560,24 @@ namespace fc::api {
         }},
         .ChainGetTipSetByHeight = {[=](auto height2, auto &tipset_key)
                                        -> outcome::result<Tipset> {
-          // TODO(turuslan): use height index from chain store
-          // TODO(turuslan): return genesis if height is zero
           auto height = static_cast<uint64_t>(height2);
           OUTCOME_TRY(context, tipsetContext(tipset_key));
           auto &tipset{context.tipset};
           if (tipset.height < height) {
             return TodoError::kError;
           }
-          while (tipset.height > height) {
-            OUTCOME_TRY(parent, tipset.loadParent(*ipld));
-            if (parent.height < height) {
-              break;
-            }
-            tipset = std::move(parent);
-          }
-          return std::move(tipset);
+          return chain_store->getTipsetByHeight(tipset, height, false);
         }},
         .ChainHead = {[=]() { return chain_store->heaviestTipset(); }},
         .ChainNotify = {[=]() {
           auto channel = std::make_shared<Channel<std::vector<HeadChange>>>();
-          auto cnn = std::make_shared<connection_t>();
-          *cnn = chain_store->subscribeHeadChanges([=](auto &change) {
-            if (!channel->write({change})) {
-              assert(cnn->connected());
-              cnn->disconnect();
-            }
-          });
-          return Chan{std::move(channel)};
+          std::lock_guard lock{head_fanout->mutex};
+          head_fanout->channels.push_back(channel);
+          Chan chan{std::move(channel)};
+          // slow subscriber gets current head instead of missed changes
+          chan.capacity = kChainNotifyCapacity;
+          chan.overflow = ChanOverflow::kCoalesce;
+          return chan;
         }},
         .ChainReadObj = {[=](const auto &cid) { return ipld->get(cid); }},
         // TODO(turuslan): FIL-165 implement method
@@ -275,6 +601,45 @@ namespace fc::api {
         .ClientRetrieve = {},
         // TODO(turuslan): FIL-165 implement method
         .ClientStartDeal = {},
+        .GasEstimateGasPrice = {[=](auto blocks,
+                                    auto &,
+                                    auto,
+                                    auto &tipset_key)
+                                    -> outcome::result<TokenAmount> {
+          auto tipset{chain_store->heaviestTipset()};
+          if (!tipset_key.cids.empty()) {
+            OUTCOME_TRYA(tipset, Tipset::load(*ipld, tipset_key.cids));
+          }
+          std::vector<std::pair<TokenAmount, GasAmount>> prices;
+          for (uint64_t i{0}; i < blocks && tipset.height != 0; ++i) {
+            OUTCOME_TRY(tipset.visitMessages(
+                ipld, [&](auto, auto bls, auto &cid) -> outcome::result<void> {
+                  UnsignedMessage message;
+                  if (bls) {
+                    OUTCOME_TRYA(message, ipld->getCbor<UnsignedMessage>(cid));
+                  } else {
+                    OUTCOME_TRY(signed_message,
+                                ipld->getCbor<SignedMessage>(cid));
+                    message = std::move(signed_message.message);
+                  }
+                  prices.emplace_back(message.gasPrice, message.gasLimit);
+                  return outcome::success();
+                }));
+            OUTCOME_TRYA(tipset, tipset.loadParent(*ipld));
+          }
+          // lowest price of messages filling half of blocks gas gets in
+          std::sort(prices.begin(), prices.end(), [](auto &l, auto &r) {
+            return l.first > r.first;
+          });
+          BigInt gas{blocks * storage::mpool::kBlockGasLimit / 2};
+          for (auto &[price, limit] : prices) {
+            gas -= limit;
+            if (gas <= 0) {
+              return price + 1;
+            }
+          }
+          return vm::message::kDefaultGasPrice;
+        }},
         // TODO(turuslan): FIL-165 implement method
         .MarketEnsureAvailable = {},
         .MinerCreateBlock = {[=](auto &t) -> outcome::result<BlockWithCids> {
@@ -355,6 +720,11 @@ namespace fc::api {
           OUTCOME_TRY(mpool->add(signed_message));
           return std::move(signed_message);
         }},
+        .MpoolSelect = {[=](auto &tipset_key)
+                            -> outcome::result<std::vector<SignedMessage>> {
+          OUTCOME_TRY(context, tipsetContext(tipset_key));
+          return mpool->select(context.tipset);
+        }},
         .MpoolSub = {[=]() {
           auto channel{std::make_shared<Channel<MpoolUpdate>>()};
           auto cnn{std::make_shared<connection_t>()};
@@ -364,7 +734,10 @@ namespace fc::api {
               cnn->disconnect();
             }
           });
-          return Chan{std::move(channel)};
+          Chan chan{std::move(channel)};
+          chan.capacity = kMpoolSubCapacity;
+          chan.overflow = ChanOverflow::kDropOldest;
+          return chan;
         }},
         // TODO(turuslan): FIL-165 implement method
         .NetAddrsListen = {},
@@ -379,77 +752,46 @@ namespace fc::api {
         .StateCall = {[=](auto &message,
                           auto &tipset_key) -> outcome::result<InvocResult> {
           OUTCOME_TRY(context, tipsetContext(tipset_key));
-          auto env = std::make_shared<Env>(
-              std::make_shared<InvokerImpl>(), ipld, context.tipset);
-          InvocResult result;
-          result.message = message;
-          auto maybe_result = env->applyImplicitMessage(message);
-          if (maybe_result) {
-            result.receipt = {VMExitCode::kOk, maybe_result.value(), 0};
-          } else {
-            if (isVMExitCode(maybe_result.error())) {
-              auto ret_code =
-                  normalizeVMExitCode(VMExitCode{maybe_result.error().value()});
-              BOOST_ASSERT_MSG(ret_code,
-                               "c++ actor code returned unknown error");
-              result.receipt = {*ret_code, {}, 0};
+          return invocResult(message, simulator->call(context.tipset, message));
+        }},
+        .StateCallMany = {[=](auto &messages, auto &tipset_key)
+                              -> outcome::result<std::vector<InvocResult>> {
+          OUTCOME_TRY(context, tipsetContext(tipset_key));
+          auto calls{simulator->callMany(context.tipset, messages)};
+          std::vector<InvocResult> results;
+          results.reserve(calls.size());
+          for (size_t i{0}; i < calls.size(); ++i) {
+            // failure of one call does not fail others
+            auto result{invocResult(messages[i], std::move(calls[i]))};
+            if (!result) {
+              auto &failed{results.emplace_back()};
+              failed.message = messages[i];
+              failed.error = result.error().message();
             } else {
-              return maybe_result.error();
+              results.push_back(std::move(result.value()));
             }
           }
-          return result;
+          return results;
         }},
         .StateListMessages = {[=](auto &match, auto &tipset_key, auto to_height)
                                   -> outcome::result<std::vector<CID>> {
           OUTCOME_TRY(context, tipsetContext(tipset_key));
-
-          // TODO(artyom-yurin): Make sure at least one of 'to' or 'from' is
-          // defined
-
-          auto matchFunc = [&](const UnsignedMessage &message) -> bool {
-            if (match.to != message.to) {
-              return false;
-            }
-
-            if (match.from != message.from) {
-              return false;
-            }
-
-            return true;
-          };
-
           std::vector<CID> result;
-
-          while (static_cast<int64_t>(context.tipset.height) >= to_height) {
-            std::set<CID> visited_cid;
-
-            auto isDuplicateMessage = [&](const CID &cid) -> bool {
-              return !visited_cid.insert(cid).second;
-            };
-
-            for (const BlockHeader &block : context.tipset.blks) {
-              OUTCOME_TRY(meta, ipld->getCbor<MsgMeta>(block.messages));
-              OUTCOME_TRY(meta.bls_messages.visit(
-                  [&](auto, auto &cid) -> outcome::result<void> {
-                    OUTCOME_TRY(message, ipld->getCbor<UnsignedMessage>(cid));
-
-                    if (!isDuplicateMessage(cid) && matchFunc(message)) {
-                      result.push_back(cid);
-                    }
-
-                    return outcome::success();
-                  }));
-              OUTCOME_TRY(meta.secp_messages.visit(
-                  [&](auto, auto &cid) -> outcome::result<void> {
-                    OUTCOME_TRY(message, ipld->getCbor<SignedMessage>(cid));
-
-                    if (!isDuplicateMessage(cid)
-                        && matchFunc(message.message)) {
-                      result.push_back(cid);
-                    }
-                    return outcome::success();
-                  }));
+          auto height{static_cast<ChainEpoch>(context.tipset.height)};
+          // ancestors of indexed tipset are in index, tipset itself is not
+          if (height > 0 && msg_waiter->index->applied(context.tipset)) {
+            if (height >= to_height) {
+              OUTCOME_TRYA(result, tipsetMessages(match, context.tipset));
             }
+            OUTCOME_TRY(indexed,
+                        msg_waiter->index->list(
+                            match.from, match.to, to_height, height - 1));
+            result.insert(result.end(), indexed.begin(), indexed.end());
+            return result;
+          }
+          while (static_cast<int64_t>(context.tipset.height) >= to_height) {
+            OUTCOME_TRY(cids, tipsetMessages(match, context.tipset));
+            result.insert(result.end(), cids.begin(), cids.end());
 
             if (context.tipset.height == 0) break;
 
@@ -461,6 +803,39 @@ namespace fc::api {
 
           return result;
         }},
+        .StateListMessagesPage =
+            {[=](auto &match,
+                 auto &tipset_key,
+                 auto to_height,
+                 auto &cursor,
+                 auto limit) -> outcome::result<Page<std::vector<CID>>> {
+              if (limit == 0) {
+                return TodoError::kError;
+              }
+              MessagesCursor position{tipset_key.cids, 0};
+              if (cursor) {
+                OUTCOME_TRYA(position, decodeCursor<MessagesCursor>(*cursor));
+              }
+              OUTCOME_TRY(context, tipsetContext(position.tipset));
+              Page<std::vector<CID>> page;
+              while (static_cast<int64_t>(context.tipset.height) >= to_height) {
+                OUTCOME_TRY(cids, tipsetMessages(match, context.tipset));
+                for (auto i{position.offset}; i < cids.size(); ++i) {
+                  if (page.items.size() == limit) {
+                    page.cursor =
+                        encodeCursor(MessagesCursor{context.tipset.cids, i});
+                    return page;
+                  }
+                  page.items.push_back(cids[i]);
+                }
+                if (context.tipset.height == 0) break;
+                OUTCOME_TRY(parent_context,
+                            tipsetContext(context.tipset.getParents()));
+                context = std::move(parent_context);
+                position.offset = 0;
+              }
+              return page;
+            }},
         .StateGetActor = {[=](auto &address,
                               auto &tipset_key) -> outcome::result<Actor> {
           OUTCOME_TRY(context, tipsetContext(tipset_key, true));
@@ -479,11 +854,11 @@ namespace fc::api {
         .StateGetReceipt = {[=](auto &cid, auto &tipset_key)
                                 -> outcome::result<MessageReceipt> {
           OUTCOME_TRY(context, tipsetContext(tipset_key));
-          auto result{msg_waiter->results.find(cid)};
-          if (result != msg_waiter->results.end()) {
-            OUTCOME_TRY(ts, Tipset::load(*ipld, result->second.second.cids));
+          OUTCOME_TRY(result, msg_waiter->find(cid));
+          if (result) {
+            OUTCOME_TRY(ts, Tipset::load(*ipld, result->second.cids));
             if (context.tipset.height <= ts.height) {
-              return result->second.first;
+              return result->first;
             }
           }
           return TodoError::kError;
@@ -500,7 +875,30 @@ namespace fc::api {
           OUTCOME_TRY(root, context.state_tree.flush());
           adt::Map<Actor, adt::AddressKeyer> actors{root, ipld};
 
-          return actors.keys();
+          if (!scan_pool) {
+            return actors.keys();
+          }
+          std::vector<Address> keys;
+          OUTCOME_TRY(actors.hamt.visitParallel(
+              [&](auto &key, auto &) -> outcome::result<void> {
+                OUTCOME_TRY(address, adt::AddressKeyer::decode(key));
+                keys.push_back(std::move(address));
+                return outcome::success();
+              },
+              *scan_pool,
+              true));
+          return keys;
+        }},
+        .StateListActorsPage = {listActorsPage},
+        .StateListActorsChan = {[=](auto &tipset_key, auto page_size)
+                                    -> outcome::result<
+                                        Chan<std::vector<Address>>> {
+          if (page_size == 0) {
+            return TodoError::kError;
+          }
+          return pageChan(page_size, [=](auto &cursor, auto limit) {
+            return listActorsPage(tipset_key, cursor, limit);
+          });
         }},
         .StateMarketBalance = {[=](auto &address, auto &tipset_key)
                                    -> outcome::result<MarketBalance> {
@@ -530,6 +928,16 @@ namespace fc::api {
           }));
           return map;
         }},
+        .StateMarketDealsPage = {marketDealsPage},
+        .StateMarketDealsChan = {[=](auto &tipset_key, auto page_size)
+                                     -> outcome::result<Chan<MarketDealMap>> {
+          if (page_size == 0) {
+            return TodoError::kError;
+          }
+          return pageChan(page_size, [=](auto &cursor, auto limit) {
+            return marketDealsPage(tipset_key, cursor, limit);
+          });
+        }},
         .StateLookupID = {[=](auto &address,
                               auto &tipset_key) -> outcome::result<Address> {
           OUTCOME_TRY(context, tipsetContext(tipset_key));
@@ -548,6 +956,13 @@ namespace fc::api {
           }
           return StorageDeal{deal, *deal_state};
         }},
+        .StateMethodProfile = {[=]()
+                                   -> outcome::result<std::vector<MethodProfile>> {
+          if (!profiler) {
+            return std::vector<MethodProfile>{};
+          }
+          return profiler->snapshot();
+        }},
         .StateMinerDeadlines = {[=](auto &address, auto &tipset_key)
                                     -> outcome::result<Deadlines> {
           OUTCOME_TRY(context, tipsetContext(tipset_key));
@@ -599,7 +1014,7 @@ namespace fc::api {
               OUTCOME_TRY(context, tipsetContext(tipset_key));
               OUTCOME_TRY(state, context.minerState(address));
               std::vector<ChainSectorInfo> sectors;
-              OUTCOME_TRY(state.sectors.visit([&](auto id, auto &info) {
+              auto visitor{[&](auto id, auto &info) {
                 if (!filter
                     || filter_out == (filter->find(id) == filter->end())) {
                   sectors.push_back({
@@ -608,9 +1023,45 @@ namespace fc::api {
                   });
                 }
                 return outcome::success();
-              }));
+              }};
+              if (filter && !filter_out) {
+                OUTCOME_TRY(state.sectors.visitIndices(
+                    {filter->begin(), filter->end()}, visitor));
+              } else {
+                OUTCOME_TRY(state.sectors.visit(visitor));
+              }
               return sectors;
             }},
+        .StateMinerSectorsPage =
+            {[=](auto &address, auto &tipset_key, auto &cursor, auto limit)
+                 -> outcome::result<Page<std::vector<ChainSectorInfo>>> {
+              if (limit == 0) {
+                return TodoError::kError;
+              }
+              IndexCursor position{tipset_key.cids, 0};
+              if (cursor) {
+                OUTCOME_TRYA(position, decodeCursor<IndexCursor>(*cursor));
+              }
+              OUTCOME_TRY(context, tipsetContext(position.tipset));
+              OUTCOME_TRY(state, context.minerState(address));
+              Page<std::vector<ChainSectorInfo>> page;
+              OUTCOME_TRY(state.sectors.visitRange(
+                  position.next,
+                  std::numeric_limits<SectorNumber>::max(),
+                  [&](auto id, auto &info) -> outcome::result<bool> {
+                    if (page.items.size() == limit) {
+                      page.cursor =
+                          encodeCursor(IndexCursor{context.tipset.cids, id});
+                      return false;
+                    }
+                    page.items.push_back({
+                        .info = info,
+                        .id = id,
+                    });
+                    return true;
+                  }));
+              return page;
+            }},
         .StateMinerSectorSize = {[=](auto address, auto tipset_key)
                                      -> outcome::result<SectorSize> {
           OUTCOME_TRY(context, tipsetContext(tipset_key));
@@ -640,20 +1091,39 @@ namespace fc::api {
           });
           return Wait{channel};
         }},
+        .StorageStats = {[=]() -> outcome::result<std::vector<StoreStats>> {
+          std::vector<StoreStats> stats;
+          if (stores) {
+            for (auto &[name, store] : stores->named()) {
+              stats.push_back({name, store->stats()});
+            }
+          }
+          return stats;
+        }},
         .SyncSubmitBlock = {[=](auto block) -> outcome::result<void> {
           // TODO(turuslan): chain store must validate blocks before adding
           MsgMeta meta;
           ipld->load(meta);
-          for (auto &cid : block.bls_messages) {
-            OUTCOME_TRY(meta.bls_messages.append(cid));
-          }
-          for (auto &cid : block.secp_messages) {
-            OUTCOME_TRY(meta.secp_messages.append(cid));
-          }
+          OUTCOME_TRY(meta.bls_messages.assign(block.bls_messages));
+          OUTCOME_TRY(meta.secp_messages.assign(block.secp_messages));
           OUTCOME_TRY(messages, ipld->setCbor(meta));
           if (block.header.messages != messages) {
             return TodoError::kError;
           }
+          if (secp_verifier) {
+            // messages selected from mpool are found in cache
+            for (auto &cid : block.secp_messages) {
+              OUTCOME_TRY(message, ipld->getCbor<SignedMessage>(cid));
+              if (!message.message.from.isKeyType()) {
+                continue;
+              }
+              OUTCOME_TRY(valid,
+                          secp_verifier->verify(message, message.message.from));
+              if (!valid) {
+                return vm::message::MessageError::kVerificationFailure;
+              }
+            }
+          }
           OUTCOME_TRY(chain_store->addBlock(block.header));
           return outcome::success();
         }},
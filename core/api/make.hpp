@@ -6,6 +6,8 @@
 #ifndef CPP_FILECOIN_CORE_API_MAKE_HPP
 #define CPP_FILECOIN_CORE_API_MAKE_HPP
 
+#include <boost/asio/thread_pool.hpp>
+
 #include "api/api.hpp"
 #include "blockchain/weight_calculator.hpp"
 #include "common/logger.hpp"
@@ -13,9 +15,12 @@
 #include "drand/beaconizer.hpp"
 #include "storage/chain/chain_store.hpp"
 #include "storage/chain/msg_waiter.hpp"
+#include "storage/config/storage_config.hpp"
 #include "storage/keystore/keystore.hpp"
 #include "storage/mpool/mpool.hpp"
+#include "vm/interpreter/impl/message_cache.hpp"
 #include "vm/interpreter/interpreter.hpp"
+#include "vm/message/impl/secp_verifier.hpp"
 
 namespace fc::api {
   using blockchain::weight::WeightCalculator;
@@ -23,15 +28,24 @@ namespace fc::api {
   using drand::Beaconizer;
   using storage::blockchain::ChainStore;
   using storage::blockchain::MsgWaiter;
+  using storage::config::Stores;
   using storage::keystore::KeyStore;
   using storage::mpool::Mpool;
   using vm::interpreter::Interpreter;
+  using vm::interpreter::MessageCache;
+  using vm::message::SecpVerifier;
+  using vm::runtime::Profiler;
   using Logger = common::Logger;
 
   outcome::result<IpldObject> getNode(std::shared_ptr<Ipld> ipld,
                                       const CID &root,
                                       gsl::span<const std::string> parts);
 
+  /**
+   * @param scan_pool - optional, full state scans visit hamt subtrees on it
+   * @param message_cache - optional, serves decoded messages and receipts of
+   * recent tipsets, filled by interpreter sharing it
+   */
   Api makeImpl(std::shared_ptr<ChainStore> chain_store,
                std::shared_ptr<WeightCalculator> weight_calculator,
                std::shared_ptr<Ipld> ipld,
@@ -39,7 +53,12 @@ namespace fc::api {
                std::shared_ptr<Interpreter> interpreter,
                std::shared_ptr<MsgWaiter> msg_waiter,
                std::shared_ptr<Beaconizer> beaconizer,
-               std::shared_ptr<KeyStore> key_store);
+               std::shared_ptr<KeyStore> key_store,
+               std::shared_ptr<SecpVerifier> secp_verifier = nullptr,
+               std::shared_ptr<Profiler> profiler = nullptr,
+               std::shared_ptr<Stores> stores = nullptr,
+               std::shared_ptr<boost::asio::thread_pool> scan_pool = nullptr,
+               std::shared_ptr<MessageCache> message_cache = nullptr);
 }  // namespace fc::api
 
 #endif  // CPP_FILECOIN_CORE_API_MAKE_HPP
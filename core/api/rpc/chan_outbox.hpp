@@ -0,0 +1,213 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_API_RPC_CHAN_OUTBOX_HPP
+#define CPP_FILECOIN_CORE_API_RPC_CHAN_OUTBOX_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include <boost/optional.hpp>
+
+namespace fc::api {
+  /// What channel does when subscriber reads slower than values are written
+  enum class ChanOverflow {
+    /**
+     * Writer waits for subscriber before write, for channels produced on
+     * demand
+     */
+    kWait,
+    /// Channel is closed, subscriber may subscribe again
+    kClose,
+    /// Oldest unsent values are dropped
+    kDropOldest,
+    /// Unsent values are merged with new one
+    kCoalesce,
+  };
+
+  /// Unsent values of channel buffered by default
+  constexpr size_t kChanCapacity{16};
+}  // namespace fc::api
+
+namespace fc::api::rpc {
+  /// Values of one channel passed to session and not written yet
+  constexpr size_t kChanMaxInFlight{4};
+  /// Writer of waiting channel gives up and closes channel after timeout
+  constexpr std::chrono::seconds kChanWaitTimeout{30};
+
+  /**
+   * Bounded queue between channel and session of its subscriber.
+   * Values are passed to session while less than kChanMaxInFlight of them
+   * are not written, then wait in queue of given capacity, overflow of queue
+   * is handled by policy of channel. Close is sent after queued values.
+   * Push is called under lock of channel, so it never blocks, writers of
+   * waiting channel call waitRoom before write instead.
+   */
+  template <typename T>
+  class ChanOutbox : public std::enable_shared_from_this<ChanOutbox<T>> {
+   public:
+    using Sent = std::function<void(bool)>;
+    using SendValue = std::function<void(T, Sent)>;
+    using SendClose = std::function<void()>;
+    /// Merges new value into full queue, queue is replaced by it by default
+    using Coalesce = std::function<void(std::deque<T> &, T)>;
+
+    ChanOutbox(size_t capacity,
+               ChanOverflow overflow,
+               SendValue send_value,
+               SendClose send_close,
+               Coalesce coalesce = {})
+        : capacity_{std::max<size_t>(1, capacity)},
+          overflow_{overflow},
+          send_value_{std::move(send_value)},
+          send_close_{std::move(send_close)},
+          coalesce_{std::move(coalesce)} {}
+
+    /**
+     * Blocks writer until queue has room, channel is closed after
+     * kChanWaitTimeout. Returns immediately unless policy is kWait.
+     * @return false if channel is closed
+     */
+    bool waitRoom() {
+      std::unique_lock lock{mutex_};
+      if (overflow_ != ChanOverflow::kWait) {
+        return !closed_;
+      }
+      if (!sent_.wait_for(lock, kChanWaitTimeout, [&] {
+            return closed_ || queue_.size() < capacity_;
+          })) {
+        close(lock);
+        return false;
+      }
+      return !closed_;
+    }
+
+    /**
+     * Handles value read from channel, none closes channel after queued
+     * values are sent. Waiting channel queues value over capacity, its
+     * writer should have waited for room.
+     * @return false if channel is closed
+     */
+    bool push(boost::optional<T> value) {
+      std::unique_lock lock{mutex_};
+      if (closed_) {
+        return false;
+      }
+      if (!value) {
+        closing_ = true;
+        if (in_flight_ == 0 && queue_.empty()) {
+          close(lock);
+        }
+        return true;
+      }
+      if (queue_.empty() && in_flight_ < kChanMaxInFlight) {
+        ++in_flight_;
+        lock.unlock();
+        send(std::move(*value));
+        return true;
+      }
+      if (queue_.size() >= capacity_) {
+        switch (overflow_) {
+          case ChanOverflow::kWait:
+            break;
+          case ChanOverflow::kClose:
+            close(lock);
+            return false;
+          case ChanOverflow::kDropOldest:
+            queue_.pop_front();
+            ++dropped_;
+            break;
+          case ChanOverflow::kCoalesce: {
+            const auto values{queue_.size() + 1};
+            if (coalesce_) {
+              coalesce_(queue_, std::move(*value));
+            } else {
+              queue_.clear();
+              queue_.push_back(std::move(*value));
+            }
+            dropped_ += values - queue_.size();
+            return true;
+          }
+        }
+      }
+      queue_.push_back(std::move(*value));
+      return true;
+    }
+
+    /// Values dropped or merged by overflow policy
+    size_t dropped() const {
+      std::lock_guard lock{mutex_};
+      return dropped_;
+    }
+
+    /// Values waiting in queue
+    size_t queued() const {
+      std::lock_guard lock{mutex_};
+      return queue_.size();
+    }
+
+   private:
+    void send(T value) {
+      send_value_(std::move(value),
+                  [self{this->shared_from_this()}](bool ok) {
+                    self->onSent(ok);
+                  });
+    }
+
+    void onSent(bool ok) {
+      std::unique_lock lock{mutex_};
+      --in_flight_;
+      if (!ok) {
+        // subscriber is gone, close is not sent
+        closed_ = true;
+        queue_.clear();
+        sent_.notify_all();
+        return;
+      }
+      if (closed_) {
+        return;
+      }
+      if (!queue_.empty()) {
+        auto value{std::move(queue_.front())};
+        queue_.pop_front();
+        ++in_flight_;
+        sent_.notify_all();
+        lock.unlock();
+        send(std::move(value));
+        return;
+      }
+      if (closing_ && in_flight_ == 0) {
+        close(lock);
+      }
+    }
+
+    void close(std::unique_lock<std::mutex> &lock) {
+      closed_ = true;
+      queue_.clear();
+      sent_.notify_all();
+      lock.unlock();
+      send_close_();
+    }
+
+    size_t capacity_;
+    ChanOverflow overflow_;
+    SendValue send_value_;
+    SendClose send_close_;
+    Coalesce coalesce_;
+    mutable std::mutex mutex_;
+    std::condition_variable sent_;
+    std::deque<T> queue_;
+    size_t in_flight_{};
+    size_t dropped_{};
+    bool closing_{false};
+    bool closed_{false};
+  };
+}  // namespace fc::api::rpc
+
+#endif  // CPP_FILECOIN_CORE_API_RPC_CHAN_OUTBOX_HPP
@@ -0,0 +1,85 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "api/rpc/dispatcher.hpp"
+
+#include <thread>
+
+#include <boost/asio/post.hpp>
+
+namespace fc::api::rpc {
+  Dispatcher::Dispatcher(DispatcherConfig config)
+      : config_{std::move(config)},
+        pool_{std::make_shared<boost::asio::thread_pool>(config_.threads)},
+        serial_{pool_->get_executor()} {}
+
+  Dispatcher::~Dispatcher() {
+    // last owner may be released by call, pool can't join own thread
+    if (pool_->get_executor().running_in_this_thread()) {
+      pool_->stop();
+      std::thread{[pool{std::move(pool_)}] { pool->join(); }}.detach();
+      return;
+    }
+    pool_->join();
+  }
+
+  void Dispatcher::dispatch(const std::string &method, Call call) {
+    if (config_.inline_methods.count(method) != 0) {
+      return call();
+    }
+    auto limit_it{config_.limits.find(method)};
+    {
+      std::lock_guard lock{mutex_};
+      auto &state{methods_[method]};
+      if (limit_it != config_.limits.end()
+          && state.stats.running >= limit_it->second) {
+        state.queue.push_back(std::move(call));
+        ++state.stats.queued;
+        return;
+      }
+      ++state.stats.running;
+    }
+    run(method, std::move(call));
+  }
+
+  std::map<std::string, MethodStats> Dispatcher::stats() const {
+    std::lock_guard lock{mutex_};
+    std::map<std::string, MethodStats> stats;
+    for (auto &[name, method] : methods_) {
+      stats.emplace(name, method.stats);
+    }
+    return stats;
+  }
+
+  void Dispatcher::run(const std::string &method, Call call) {
+    auto task{[this, method, call{std::move(call)}] {
+      call();
+      onDone(method);
+    }};
+    if (config_.pool_methods.count(method) != 0) {
+      boost::asio::post(*pool_, std::move(task));
+    } else {
+      boost::asio::post(serial_, std::move(task));
+    }
+  }
+
+  void Dispatcher::onDone(const std::string &method) {
+    Call next;
+    {
+      std::lock_guard lock{mutex_};
+      auto &state{methods_[method]};
+      ++state.stats.completed;
+      if (state.queue.empty()) {
+        --state.stats.running;
+        return;
+      }
+      // queued call takes slot of finished one
+      next = std::move(state.queue.front());
+      state.queue.pop_front();
+      --state.stats.queued;
+    }
+    run(method, std::move(next));
+  }
+}  // namespace fc::api::rpc
@@ -0,0 +1,83 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_API_RPC_DISPATCHER_HPP
+#define CPP_FILECOIN_CORE_API_RPC_DISPATCHER_HPP
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+namespace fc::api::rpc {
+  /// Rpc dispatcher tuning
+  struct DispatcherConfig {
+    /// Worker threads running api methods
+    size_t threads{4};
+    /// Cheap methods called directly on io thread
+    std::set<std::string> inline_methods{"ChainHead", "Version"};
+    /// Methods safe to call concurrently, others run one at a time
+    std::set<std::string> pool_methods;
+    /// Max concurrent calls of pool method, not listed are not limited
+    std::map<std::string, size_t> limits{
+        {"StateCallMany", 1},
+        {"StateListMessages", 1},
+        {"StateMarketDeals", 1},
+        {"StateMarketDealsChan", 1},
+    };
+  };
+
+  /// Calls of one method
+  struct MethodStats {
+    size_t running{};
+    /// Calls waiting for method limit
+    size_t queued{};
+    uint64_t completed{};
+  };
+
+  /**
+   * Runs api method calls on worker pool, so slow calls don't block io thread
+   * and other sessions. Calls over method limit wait in per-method queue.
+   * Shared by all sessions of server, only pool methods are called
+   * concurrently, other ones run in order on one strand of pool.
+   */
+  class Dispatcher {
+   public:
+    using Call = std::function<void()>;
+
+    explicit Dispatcher(DispatcherConfig config);
+
+    /// Joins pool, or leaves it to other thread if called on pool
+    ~Dispatcher();
+
+    /// Runs call of method on calling io thread if method is inline, or on
+    /// workers
+    void dispatch(const std::string &method, Call call);
+
+    /// Running and queued calls by method
+    std::map<std::string, MethodStats> stats() const;
+
+   private:
+    struct Method {
+      MethodStats stats;
+      std::deque<Call> queue;
+    };
+
+    void run(const std::string &method, Call call);
+    void onDone(const std::string &method);
+
+    DispatcherConfig config_;
+    std::shared_ptr<boost::asio::thread_pool> pool_;
+    /// Runs methods not safe to call concurrently
+    boost::asio::strand<boost::asio::thread_pool::executor_type> serial_;
+    mutable std::mutex mutex_;
+    std::map<std::string, Method> methods_;
+  };
+}  // namespace fc::api::rpc
+
+#endif  // CPP_FILECOIN_CORE_API_RPC_DISPATCHER_HPP
@@ -0,0 +1,48 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "api/rpc/io_pool.hpp"
+
+namespace fc::api::rpc {
+  IoPool::IoPool(size_t threads) {
+    threads = std::max<size_t>(threads, 1);
+    for (size_t i{0}; i < threads; ++i) {
+      // one thread per context
+      ios_.push_back(std::make_unique<IoContext>(1));
+      guards_.push_back(boost::asio::make_work_guard(*ios_.back()));
+    }
+    for (auto &io : ios_) {
+      threads_.emplace_back([io{io.get()}] { io->run(); });
+    }
+  }
+
+  IoPool::~IoPool() {
+    stop();
+  }
+
+  IoPool::IoContext &IoPool::next() {
+    return at(next_.fetch_add(1, std::memory_order_relaxed));
+  }
+
+  IoPool::IoContext &IoPool::at(size_t index) {
+    return *ios_[index % ios_.size()];
+  }
+
+  size_t IoPool::size() const {
+    return ios_.size();
+  }
+
+  void IoPool::stop() {
+    guards_.clear();
+    for (auto &io : ios_) {
+      io->stop();
+    }
+    for (auto &thread : threads_) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
+}  // namespace fc::api::rpc
@@ -0,0 +1,55 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_API_RPC_IO_POOL_HPP
+#define CPP_FILECOIN_CORE_API_RPC_IO_POOL_HPP
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
+namespace fc::api::rpc {
+  /**
+   * Io threads of rpc server, separate from node io context, so api load
+   * doesn't delay libp2p and sync handlers. Each thread runs own io
+   * context, so handlers of session run on one thread without locking.
+   */
+  class IoPool {
+   public:
+    using IoContext = boost::asio::io_context;
+
+    /// Starts threads, at least one
+    explicit IoPool(size_t threads);
+    IoPool(const IoPool &) = delete;
+    IoPool &operator=(const IoPool &) = delete;
+    /// Stops and joins threads
+    ~IoPool();
+
+    /// Io context for next session, round-robin
+    IoContext &next();
+
+    IoContext &at(size_t index);
+
+    size_t size() const;
+
+    /// Stops io contexts, pending handlers are dropped
+    void stop();
+
+   private:
+    using WorkGuard =
+        boost::asio::executor_work_guard<IoContext::executor_type>;
+
+    std::vector<std::unique_ptr<IoContext>> ios_;
+    std::vector<WorkGuard> guards_;
+    std::vector<std::thread> threads_;
+    std::atomic_size_t next_{};
+  };
+}  // namespace fc::api::rpc
+
+#endif  // CPP_FILECOIN_CORE_API_RPC_IO_POOL_HPP
@@ -42,6 +42,10 @@ namespace fc::api {
   using primitives::ticket::Ticket;
   using primitives::tipset::HeadChangeType;
   using rapidjson::Document;
+  using storage::LatencyHistogram;
+  using storage::LevelDBMetrics;
+  using storage::LevelDBOp;
+  using storage::PrefixCounters;
   using rapidjson::Value;
   using vm::actor::builtin::miner::SectorPreCommitInfo;
   using vm::actor::builtin::miner::WorkerKeyChange;
@@ -122,6 +126,17 @@ namespace fc::api {
           [&](const Response::Error &error) { Set(j, "error", error); },
           [&](const Document &result) {
             Set(j, "result", Value{result, allocator});
+          },
+          [&](const Response::Stream &stream) {
+            std::string json;
+            ChunkedOutput output{
+                SIZE_MAX, [&](auto chunk) { json += chunk; }};
+            JsonWriter writer{output};
+            stream(writer);
+            json += output.finish();
+            Document result;
+            result.Parse(json.data(), json.size());
+            Set(j, "result", Value{result, allocator});
           });
       return j;
     }
@@ -836,6 +851,20 @@ namespace fc::api {
       return decode(v.id, j);
     }
 
+    template <typename T>
+    ENCODE(Page<T>) {
+      Value j{rapidjson::kObjectType};
+      Set(j, "Items", v.items);
+      Set(j, "Cursor", v.cursor);
+      return j;
+    }
+
+    template <typename T>
+    DECODE(Page<T>) {
+      decode(v.items, Get(j, "Items"));
+      decode(v.cursor, Get(j, "Cursor"));
+    }
+
     ENCODE(Actor) {
       Value j{rapidjson::kObjectType};
       Set(j, "Code", v.code);
@@ -954,6 +983,58 @@ namespace fc::api {
       return j;
     }
 
+    ENCODE(MethodProfile) {
+      Value j{rapidjson::kObjectType};
+      Set(j, "Code", static_cast<const CID &>(v.code));
+      Set(j, "Method", v.method.method_number);
+      Set(j, "Calls", v.stats.calls);
+      Set(j, "TimeNs", static_cast<int64_t>(v.stats.time.count()));
+      Set(j, "Gas", v.stats.gas);
+      Set(j, "IpldGets", v.stats.ipld.gets);
+      Set(j, "IpldGetBytes", v.stats.ipld.get_bytes);
+      Set(j, "IpldPuts", v.stats.ipld.puts);
+      Set(j, "IpldPutBytes", v.stats.ipld.put_bytes);
+      return j;
+    }
+
+    ENCODE(LatencyHistogram::Snapshot) {
+      Value j{rapidjson::kObjectType};
+      Set(j, "Count", v.count);
+      Set(j, "TimeNs", static_cast<int64_t>(v.total.count()));
+      Set(j,
+          "BucketsUs",
+          std::vector<uint64_t>(v.buckets.begin(), v.buckets.end()));
+      return j;
+    }
+
+    ENCODE(PrefixCounters) {
+      Value j{rapidjson::kObjectType};
+      Set(j, "Name", v.name);
+      Set(j, "Reads", v.reads);
+      Set(j, "ReadBytes", v.read_bytes);
+      Set(j, "Writes", v.writes);
+      Set(j, "WriteBytes", v.write_bytes);
+      return j;
+    }
+
+    ENCODE(StoreStats) {
+      Value j{rapidjson::kObjectType};
+      std::map<std::string, LatencyHistogram::Snapshot> ops;
+      for (size_t i{0}; i < storage::kLevelDBOps; ++i) {
+        ops.emplace(LevelDBMetrics::opName(static_cast<LevelDBOp>(i)),
+                    v.stats.ops[i]);
+      }
+      Set(j, "Name", v.name);
+      Set(j, "Ops", ops);
+      Set(j, "Hits", v.stats.hits);
+      Set(j, "Misses", v.stats.misses);
+      Set(j, "Prefixes", v.stats.prefixes);
+      Set(j,
+          "BlockCacheBytes",
+          static_cast<uint64_t>(v.stats.block_cache_bytes));
+      return j;
+    }
+
     ENCODE(MiningBaseInfo) {
       Value j{rapidjson::kObjectType};
       Set(j, "MinerPower", v.miner_power);
@@ -1202,6 +1283,49 @@ namespace fc::api {
     return document;
   }
 
+  /// Results written by element, not built as whole document
+  template <typename T>
+  struct is_streamed : std::false_type {};
+
+  template <typename T>
+  struct is_streamed<std::vector<T>>
+      : std::bool_constant<!std::is_same_v<T, uint8_t>> {};
+
+  template <typename T>
+  struct is_streamed<std::map<std::string, T>> : std::true_type {};
+
+  template <typename T>
+  struct is_string_map : std::false_type {};
+
+  template <typename T>
+  struct is_string_map<std::map<std::string, T>> : std::true_type {};
+
+  /**
+   * Writes value to json writer. Elements of arrays and maps are encoded and
+   * written one by one, so only one element document is alive at a time.
+   */
+  template <typename T>
+  void encodeStream(JsonWriter &writer, const T &v) {
+    if constexpr (is_streamed<T>{}) {
+      if constexpr (is_string_map<T>{}) {
+        writer.StartObject();
+        for (auto &[key, elem] : v) {
+          writer.Key(key.data(), key.size());
+          encodeStream(writer, elem);
+        }
+        writer.EndObject(v.size());
+      } else {
+        writer.StartArray();
+        for (auto &elem : v) {
+          encodeStream(writer, elem);
+        }
+        writer.EndArray(v.size());
+      }
+    } else {
+      encode(v).Accept(writer);
+    }
+  }
+
   template <typename T>
   outcome::result<T> decode(const Value &j) {
     try {
@@ -4,9 +4,85 @@
  */
 
 #include "api/rpc/make.hpp"
+
+#include <deque>
+
 #include "api/rpc/json.hpp"
+#include "common/lru_cache.hpp"
 
 namespace fc::api {
+  using primitives::tipset::HeadChangeType;
+  using rpc::ChanOutbox;
+
+  rpc::SharedJson encodeShared(const Document &document) {
+    ChunkedOutput output{SIZE_MAX, {}};
+    JsonWriter writer{output};
+    document.Accept(writer);
+    return std::make_shared<const std::string>(output.finish());
+  }
+
+  template <typename T>
+  rpc::SharedJson encodeShared(const T &value) {
+    return encodeShared(encode(value));
+  }
+
+  /// Same head changes are sent to all subscribers, so they are encoded once
+  rpc::SharedJson encodeShared(const std::vector<HeadChange> &changes) {
+    static common::LruCache<std::string, rpc::SharedJson> cache{16};
+    std::string key;
+    for (auto &change : changes) {
+      key.push_back(static_cast<char>(change.type));
+      for (auto &cid : change.value.cids) {
+        auto bytes{cid.toBytes().value()};
+        key.append(bytes.begin(), bytes.end());
+      }
+    }
+    if (auto json{cache.get(key)}) {
+      return *json;
+    }
+    auto json{encodeShared(encode(changes))};
+    cache.put(key, json);
+    return json;
+  }
+
+  /**
+   * Full queue of head changes is replaced by current head, subscriber
+   * resets to it like after subscribing. Parent of reverted tipset is not
+   * known here, so reverts are merged with queued changes until next apply.
+   */
+  void coalesceHeadChanges(std::deque<std::vector<HeadChange>> &queue,
+                           std::vector<HeadChange> changes) {
+    if (!changes.empty() && changes.back().type != HeadChangeType::REVERT) {
+      queue.clear();
+      queue.push_back({{HeadChangeType::CURRENT, changes.back().value}});
+      return;
+    }
+    std::vector<HeadChange> merged;
+    for (auto &queued : queue) {
+      merged.insert(merged.end(), queued.begin(), queued.end());
+    }
+    merged.insert(merged.end(), changes.begin(), changes.end());
+    queue.clear();
+    queue.push_back(std::move(merged));
+  }
+
+  /// Makes outbox of channel read by rpc, head changes are coalesced
+  template <typename T>
+  std::shared_ptr<ChanOutbox<T>> makeOutbox(
+      const Chan<T> &chan,
+      typename ChanOutbox<T>::SendValue send_value,
+      typename ChanOutbox<T>::SendClose send_close) {
+    typename ChanOutbox<T>::Coalesce coalesce;
+    if constexpr (std::is_same_v<T, std::vector<HeadChange>>) {
+      coalesce = coalesceHeadChanges;
+    }
+    return std::make_shared<ChanOutbox<T>>(chan.capacity,
+                                           chan.overflow,
+                                           std::move(send_value),
+                                           std::move(send_close),
+                                           std::move(coalesce));
+  }
+
   template <typename M>
   void setup(Rpc &rpc, const M &method) {
     using Result = typename M::Result;
@@ -41,29 +117,99 @@ namespace fc::api {
                 }
               });
               return;
+            } else if constexpr (is_streamed<Result>{}) {
+              respond(Response::Stream{
+                  [result{std::make_shared<Result>(std::move(result))}](
+                      auto &writer) { encodeStream(writer, *result); }});
             } else {
               respond(api::encode(result));
             }
             if constexpr (is_chan<Result>{}) {
-              result.channel->read([send{std::move(send)},
-                                    chan{result}](auto opt) {
-                if (opt) {
-                  send("xrpc.ch.val",
-                       encode(std::make_tuple(chan.id, std::move(*opt))),
-                       [chan](auto ok) {
+              auto produce{std::move(result.produce)};
+              auto outbox{makeOutbox(
+                  result,
+                  [send, chan{result}](auto value, auto sent) {
+                    send("xrpc.ch.val",
+                         rpc::ChanValue{chan.id, encodeShared(value)},
+                         [chan, sent{std::move(sent)}](auto ok) {
+                           sent(ok);
+                           if (!ok) {
+                             chan.channel->closeRead();
+                           }
+                         });
+                  },
+                  [send, id{result.id}] {
+                    send("xrpc.ch.close", encode(std::make_tuple(id)), {});
+                  })};
+              result.channel->read([outbox](auto opt) {
+                return outbox->push(std::move(opt));
+              });
+              if (produce) {
+                produce([outbox] { return outbox->waitRoom(); });
+              }
+            }
+            return;
+          }
+          respond(Document{});
+        });
+  }
+
+  /// Binary transport variant of method with cbor encodable result
+  template <typename M>
+  void setupCbor(Rpc &rpc, const M &method) {
+    using Result = typename M::Result;
+    rpc.setupCbor(
+        M::name,
+        [&](auto &jparams,
+            rpc::CborRespond respond,
+            rpc::MakeChan make_chan,
+            rpc::CborSend send) {
+          auto maybe_params = decode<typename M::Params>(jparams);
+          if (!maybe_params) {
+            return respond(Response::Error{kInvalidParams,
+                                           maybe_params.error().message()});
+          }
+          auto maybe_result = std::apply(method, maybe_params.value());
+          if (!maybe_result) {
+            return respond(Response::Error{kInternalError,
+                                           maybe_result.error().message()});
+          }
+          auto &result = maybe_result.value();
+          if constexpr (is_chan<Result>{}) {
+            result.id = make_chan();
+            respond(Buffer{codec::cbor::encode(result.id).value()});
+            auto produce{std::move(result.produce)};
+            auto outbox{makeOutbox(
+                result,
+                [send, chan{result}](auto value, auto sent) {
+                  auto encoded{codec::cbor::encode(value)};
+                  if (!encoded) {
+                    // called while channel is locked, next write closes it
+                    return sent(false);
+                  }
+                  send(chan.id,
+                       Buffer{encoded.value()},
+                       [chan, sent{std::move(sent)}](auto ok) {
+                         sent(ok);
                          if (!ok) {
                            chan.channel->closeRead();
                          }
                        });
-                } else {
-                  send("xrpc.ch.close", encode(std::make_tuple(chan.id)), {});
-                }
-                return true;
-              });
+                },
+                [send, id{result.id}] { send(id, boost::none, {}); })};
+            result.channel->read(
+                [outbox](auto opt) { return outbox->push(std::move(opt)); });
+            if (produce) {
+              produce([outbox] { return outbox->waitRoom(); });
             }
-            return;
+          } else {
+            auto encoded{codec::cbor::encode(result)};
+            if (!encoded) {
+              return respond(Response::Error{kInternalError,
+                                             encoded.error().message()});
+            }
+            respond(Buffer{encoded.value()});
           }
-          respond(Document{});
         });
   }
 
@@ -91,25 +237,34 @@ namespace fc::api {
     setup(rpc, api.ClientQueryAsk);
     setup(rpc, api.ClientRetrieve);
     setup(rpc, api.ClientStartDeal);
+    setup(rpc, api.GasEstimateGasPrice);
     setup(rpc, api.MarketEnsureAvailable);
     setup(rpc, api.MinerCreateBlock);
     setup(rpc, api.MinerGetBaseInfo);
     setup(rpc, api.MpoolPending);
     setup(rpc, api.MpoolPushMessage);
+    setup(rpc, api.MpoolSelect);
     setup(rpc, api.MpoolSub);
     setup(rpc, api.NetAddrsListen);
     setup(rpc, api.StateAccountKey);
     setup(rpc, api.StateCall);
+    setup(rpc, api.StateCallMany);
     setup(rpc, api.StateListMessages);
+    setup(rpc, api.StateListMessagesPage);
     setup(rpc, api.StateGetActor);
     setup(rpc, api.StateReadState);
     setup(rpc, api.StateGetReceipt);
     setup(rpc, api.StateListMiners);
     setup(rpc, api.StateListActors);
+    setup(rpc, api.StateListActorsPage);
+    setup(rpc, api.StateListActorsChan);
     setup(rpc, api.StateMarketBalance);
     setup(rpc, api.StateMarketDeals);
+    setup(rpc, api.StateMarketDealsPage);
+    setup(rpc, api.StateMarketDealsChan);
     setup(rpc, api.StateLookupID);
     setup(rpc, api.StateMarketStorageDeal);
+    setup(rpc, api.StateMethodProfile);
     setup(rpc, api.StateMinerDeadlines);
     setup(rpc, api.StateMinerFaults);
     setup(rpc, api.StateMinerInfo);
@@ -117,10 +272,12 @@ namespace fc::api {
     setup(rpc, api.StateMinerProvingDeadline);
     setup(rpc, api.StateMinerProvingSet);
     setup(rpc, api.StateMinerSectors);
+    setup(rpc, api.StateMinerSectorsPage);
     setup(rpc, api.StateMinerSectorSize);
     setup(rpc, api.StateMinerWorker);
     setup(rpc, api.StateNetworkName);
     setup(rpc, api.StateWaitMsg);
+    setup(rpc, api.StorageStats);
     setup(rpc, api.SyncSubmitBlock);
     setup(rpc, api.Version);
     setup(rpc, api.WalletBalance);
@@ -134,5 +291,13 @@ namespace fc::api {
     setup(rpc, api.PaychVoucherAdd);
     setup(rpc, api.PaychVoucherCheckValid);
     setup(rpc, api.PaychVoucherCreate);
+
+    setupCbor(rpc, api.ChainGetBlock);
+    setupCbor(rpc, api.ChainGetBlockMessages);
+    setupCbor(rpc, api.ChainGetMessage);
+    setupCbor(rpc, api.ChainGetTipSet);
+    setupCbor(rpc, api.ChainHead);
+    setupCbor(rpc, api.ChainNotify);
+    setupCbor(rpc, api.ChainReadObj);
   }
 }  // namespace fc::api
@@ -9,12 +9,47 @@
 #include <map>
 
 #include <rapidjson/document.h>
+#include <rapidjson/writer.h>
 
+#include "common/buffer.hpp"
 #include "common/outcome.hpp"
 
 namespace fc::api {
   using rapidjson::Document;
 
+  /// Rapidjson output stream passing filled chunks to callback
+  class ChunkedOutput {
+   public:
+    using Ch = char;
+    using OnChunk = std::function<void(std::string)>;
+
+    ChunkedOutput(size_t chunk_size, OnChunk on_chunk)
+        : chunk_size_{chunk_size}, on_chunk_{std::move(on_chunk)} {}
+
+    void Put(Ch c) {
+      chunk_.push_back(c);
+      if (chunk_.size() >= chunk_size_) {
+        on_chunk_(std::move(chunk_));
+        chunk_.clear();
+      }
+    }
+
+    /// Called by writer when value is complete, remainder is taken by finish
+    void Flush() {}
+
+    /// Returns remainder of output not passed to callback
+    std::string finish() {
+      return std::move(chunk_);
+    }
+
+   private:
+    size_t chunk_size_;
+    OnChunk on_chunk_;
+    std::string chunk_;
+  };
+
+  using JsonWriter = rapidjson::Writer<ChunkedOutput>;
+
   struct Request {
     uint64_t id;
     std::string method;
@@ -27,8 +62,11 @@ namespace fc::api {
       std::string message;
     };
 
+    /// Writes large result directly to json writer
+    using Stream = std::function<void(JsonWriter &)>;
+
     boost::optional<uint64_t> id;
-    boost::variant<Error, Document> result;
+    boost::variant<Error, Document, Stream> result;
   };
 
   constexpr auto kInvalidParams = INT64_C(-32602);
@@ -39,19 +77,52 @@ namespace fc::api::rpc {
   using rapidjson::Value;
 
   using OkCb = std::function<void(bool)>;
-  using Respond =
-      std::function<void(boost::variant<Response::Error, Document>)>;
-  using Send = std::function<void(std::string, Document, OkCb)>;
+  using Respond = std::function<void(
+      boost::variant<Response::Error, Document, Response::Stream>)>;
+  /// Encoded json shared by messages to several sessions
+  using SharedJson = std::shared_ptr<const std::string>;
+  /// Channel value params, encoded value is spliced without copying document
+  struct ChanValue {
+    uint64_t chan;
+    SharedJson value;
+  };
+  using Send = std::function<void(
+      std::string, boost::variant<Document, ChanValue>, OkCb)>;
   using MakeChan = std::function<uint64_t()>;
 
   using Method = std::function<void(const Value &, Respond, MakeChan, Send)>;
 
+  /**
+   * Binary transport.
+   * Request is same json in binary frame, methods with cbor codecs respond
+   * with binary frames of cbor lists:
+   * - response: [0, id, null or [code, message], result or null]
+   * - channel value: [1, channel id, value]
+   * - channel close: [2, channel id]
+   */
+  enum class CborFrame { kResponse, kChanValue, kChanClose };
+
+  using CborRespond =
+      std::function<void(boost::variant<Response::Error, common::Buffer>)>;
+  /// Writes channel value, closes channel if value is none
+  using CborSend =
+      std::function<void(uint64_t, boost::optional<common::Buffer>, OkCb)>;
+
+  using CborMethod =
+      std::function<void(const Value &, CborRespond, MakeChan, CborSend)>;
+
   struct Rpc {
     std::map<std::string, Method> ms;
+    /// Methods available over binary transport
+    std::map<std::string, CborMethod> cbor_ms;
 
     inline void setup(const std::string &name, Method &&method) {
       ms.emplace(name, std::move(method));
     }
+
+    inline void setupCbor(const std::string &name, CborMethod &&method) {
+      cbor_ms.emplace(name, std::move(method));
+    }
   };
 }  // namespace fc::api::rpc
 
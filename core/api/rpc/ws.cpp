@@ -5,16 +5,23 @@
 
 #include "api/rpc/ws.hpp"
 
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
 #include <queue>
 
-#include <rapidjson/writer.h>
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 
+#include "api/rpc/dispatcher.hpp"
+#include "api/rpc/io_pool.hpp"
 #include "api/rpc/json.hpp"
 #include "api/rpc/make.hpp"
+#include "codec/cbor/cbor.hpp"
+#include "metrics/metrics.hpp"
 
 namespace fc::api {
   namespace beast = boost::beast;
@@ -22,7 +29,11 @@ namespace fc::api {
   namespace websocket = beast::websocket;
   namespace net = boost::asio;
   using tcp = boost::asio::ip::tcp;
-  using rapidjson::StringBuffer;
+  using codec::cbor::CborEncodeStream;
+  using rpc::CborFrame;
+  using rpc::Dispatcher;
+  using rpc::DispatcherConfig;
+  using rpc::ChanValue;
   using rpc::OkCb;
 
   constexpr auto kParseError = INT64_C(-32700);
@@ -31,13 +42,77 @@ namespace fc::api {
 
   const auto kChanCloseDelay{boost::posix_time::milliseconds(100)};
 
+  /// Websocket frame size of streamed responses
+  constexpr size_t kStreamChunkSize{64 << 10};
+
+  /// Parse allocator memory owned by session, small requests don't allocate
+  constexpr size_t kParseChunkSize{16 << 10};
+
+  /**
+   * Bytes queued for write to session before its channel values are
+   * rejected, channels of stuck subscriber are closed instead of growing
+   * queue. Responses are always queued.
+   */
+  constexpr size_t kSessionMaxQueuedBytes{64 << 20};
+
+  using Chunk = std::shared_ptr<const std::string>;
+
+  /// Time from request decode to response of method
+  inline metrics::Histogram &methodLatency(const std::string &method) {
+    return metrics::Registry::global().histogram("fc_rpc_request_seconds",
+                                                 "Latency of rpc requests",
+                                                 {{"method", method}},
+                                                 1e-9);
+  }
+
+  inline Chunk makeChunk(std::string chunk) {
+    return std::make_shared<const std::string>(std::move(chunk));
+  }
+
+  /// Bytes queued for write by all sessions
+  inline metrics::Gauge &queuedBytesGauge() {
+    static auto &gauge{metrics::Registry::global().gauge(
+        "fc_rpc_send_queue_bytes", "Bytes queued for write to rpc sessions")};
+    return gauge;
+  }
+
+  /// Message queued for write, streamed message gets chunks while written
+  struct Outgoing {
+    std::mutex mutex;
+    /// Written from shared buffers without copying
+    std::deque<Chunk> chunks;
+    bool done{false};
+    OkCb cb;
+    /// Written as binary frame
+    bool binary{false};
+    bool started{false};
+  };
+
   struct ServerSession : std::enable_shared_from_this<ServerSession> {
-    ServerSession(tcp::socket &&socket, const Api &api)
-        : socket{std::move(socket)}, timer{this->socket.get_executor()} {
+    ServerSession(tcp::socket &&socket,
+                  const Api &api,
+                  std::shared_ptr<Dispatcher> dispatcher)
+        : socket{std::move(socket)},
+          timer{this->socket.get_executor()},
+          dispatcher{std::move(dispatcher)} {
       setupRpc(rpc, api);
     }
 
+    ~ServerSession() {
+      // chunks of dropped streamed messages are still counted
+      queuedBytesGauge().add(-queued_bytes);
+    }
+
     void run() {
+      websocket::permessage_deflate deflate;
+      deflate.server_enable = true;
+      /*
+       * Beast of used boost version compresses every message once deflate is
+       * negotiated, low level keeps small messages cheap and json compresses
+       * well at it.
+       */
+      deflate.compLevel = 3;
+      socket.set_option(deflate);
       socket.async_accept([self{shared_from_this()}](auto ec) {
         if (ec) {
           return;
@@ -56,116 +131,493 @@ namespace fc::api {
       });
     }
 
+    using Result = decltype(Response::result);
+    using OnResponse =
+        std::function<void(boost::optional<uint64_t>, Result)>;
+
     void onRead() {
       std::string_view s_req{static_cast<const char *>(buffer.cdata().data()),
                              buffer.cdata().size()};
-      rapidjson::Document j_req;
+      // previous request document is gone, its values are dropped at once
+      parse_allocator.Clear();
+      // values live in session pool, request decode copies params
+      rapidjson::Document j_req{&parse_allocator};
       j_req.Parse(s_req.data(), s_req.size());
       buffer.clear();
       if (j_req.HasParseError()) {
         return _write(Response{{}, Response::Error{kParseError, "Parse error"}},
                       {});
       }
-      auto maybe_req = decode<Request>(j_req);
-      if (!maybe_req) {
+      if (j_req.IsArray()) {
+        return onBatch(j_req);
+      }
+      // binary request gets binary response if method has cbor variant
+      if (socket.got_binary() && callCbor(j_req)) {
+        return;
+      }
+      // method may respond from worker thread, writes are done on io thread
+      call(j_req, [self{shared_from_this()}](auto id, Result res) {
+        if (auto stream{boost::get<Response::Stream>(&res)}) {
+          return self->_writeStream(*id, *stream);
+        }
+        net::post(self->socket.get_executor(),
+                  [id, self, res{std::move(res)}]() mutable {
+                    self->_write(Response{id, std::move(res)}, {});
+                  });
+      });
+    }
+
+    /**
+     * Batch entries run in parallel on dispatcher, responses are written as
+     * single array after last entry responds.
+     * Entries with same tipset share its context through api tipset cache.
+     */
+    void onBatch(const rapidjson::Document &j_reqs) {
+      if (j_reqs.Empty()) {
         return _write(
             Response{{}, Response::Error{kInvalidRequest, "Invalid request"}},
             {});
       }
-      auto &req = maybe_req.value();
-      auto respond = [id{req.id}, self{shared_from_this()}](auto res) {
-        self->_write(Response{id, std::move(res)}, {});
+      struct Batch {
+        std::mutex mutex;
+        std::vector<std::string> responses;
+        size_t remaining;
       };
-      auto it = rpc.ms.find(req.method);
+      auto batch{std::make_shared<Batch>()};
+      batch->responses.resize(j_reqs.Size());
+      batch->remaining = j_reqs.Size();
+      for (size_t i{0}; i < j_reqs.Size(); ++i) {
+        call(j_reqs[i],
+             [self{shared_from_this()}, batch, i](auto id, Result res) {
+               auto json{toJson(id, std::move(res))};
+               std::lock_guard lock{batch->mutex};
+               batch->responses[i] = std::move(json);
+               if (--batch->remaining != 0) {
+                 return;
+               }
+               std::string joined{"["};
+               for (auto &response : batch->responses) {
+                 if (joined.size() != 1) {
+                   joined += ',';
+                 }
+                 joined += response;
+               }
+               joined += ']';
+               net::post(self->socket.get_executor(),
+                         [self, joined{std::move(joined)}]() mutable {
+                           self->_writeJson(std::move(joined), {});
+                         });
+             });
+      }
+    }
+
+    /// Decodes request and runs method on dispatcher
+    void call(const rapidjson::Value &j_req, OnResponse on_response) {
+      auto maybe_req = decode<Request>(j_req);
+      if (!maybe_req) {
+        return on_response(
+            {}, Response::Error{kInvalidRequest, "Invalid request"});
+      }
+      auto req{std::make_shared<Request>(std::move(maybe_req.value()))};
+      auto it = rpc.ms.find(req->method);
       if (it == rpc.ms.end() || !it->second) {
-        return respond(Response::Error{kMethodNotFound, "Method not found"});
-      }
-      it->second(
-          req.params,
-          std::move(respond),
-          [&]() { return next_channel++; },
-          [self{shared_from_this()}](auto method, auto params, auto cb) {
-            Request req{self->next_request++, method, std::move(params)};
-            if (method == "xrpc.ch.close") {
-              self->timer.expires_from_now(kChanCloseDelay);
-              self->timer.async_wait(
-                  [self, req{std::move(req)}, cb{std::move(cb)}](auto) {
-                    self->_write(req, std::move(cb));
-                  });
-              return;
-            }
-            self->_write(req, std::move(cb));
+        return on_response(
+            req->id, Response::Error{kMethodNotFound, "Method not found"});
+      }
+      auto respond = [id{req->id},
+                      on_response{std::move(on_response)},
+                      &latency{methodLatency(req->method)},
+                      start{std::chrono::steady_clock::now()}](Result res) {
+        latency.observe(std::chrono::steady_clock::now() - start);
+        on_response(id, std::move(res));
+      };
+      dispatcher->dispatch(
+          req->method,
+          [self{shared_from_this()},
+           &method{it->second},
+           req,
+           respond{std::move(respond)}] {
+            method(
+                req->params,
+                std::move(respond),
+                [self] { return self->next_channel++; },
+                [self](auto name, auto params, auto cb) {
+                  net::post(self->socket.get_executor(),
+                            [self,
+                             name{std::move(name)},
+                             params{std::move(params)},
+                             cb{std::move(cb)}]() mutable {
+                              self->send(std::move(name),
+                                         std::move(params),
+                                         std::move(cb));
+                            });
+                });
+          });
+    }
+
+    /// Runs cbor variant of method, returns false if there is none
+    bool callCbor(const rapidjson::Value &j_req) {
+      auto maybe_req = decode<Request>(j_req);
+      if (!maybe_req) {
+        return false;
+      }
+      auto req{std::make_shared<Request>(std::move(maybe_req.value()))};
+      auto it = rpc.cbor_ms.find(req->method);
+      if (it == rpc.cbor_ms.end() || !it->second) {
+        return false;
+      }
+      auto self{shared_from_this()};
+      auto respond{[id{req->id},
+                    self,
+                    &latency{methodLatency(req->method)},
+                    start{std::chrono::steady_clock::now()}](auto res) {
+        latency.observe(std::chrono::steady_clock::now() - start);
+        auto frame{CborEncodeStream::list()};
+        frame << CborFrame::kResponse << id;
+        visit_in_place(
+            res,
+            [&](const Response::Error &error) {
+              auto j_error{CborEncodeStream::list()};
+              j_error << error.code << error.message;
+              frame << j_error << nullptr;
+            },
+            [&](const Buffer &result) {
+              frame << nullptr << CborEncodeStream::wrap(result, 1);
+            });
+        self->_postBinary(std::move(frame), {});
+      }};
+      dispatcher->dispatch(
+          req->method,
+          [self, &method{it->second}, req, respond{std::move(respond)}] {
+            method(
+                req->params,
+                std::move(respond),
+                [self] { return self->next_channel++; },
+                [self](auto chan, auto value, auto cb) {
+                  auto frame{CborEncodeStream::list()};
+                  if (value && self->overloaded()) {
+                    // cb is called on io thread, caller holds channel lock
+                    frame << CborFrame::kChanClose << chan;
+                    self->_postBinary(std::move(frame), {});
+                    if (cb) {
+                      net::post(self->socket.get_executor(),
+                                [cb{std::move(cb)}] { cb(false); });
+                    }
+                    return;
+                  }
+                  if (value) {
+                    frame << CborFrame::kChanValue << chan
+                          << CborEncodeStream::wrap(*value, 1);
+                  } else {
+                    frame << CborFrame::kChanClose << chan;
+                  }
+                  self->_postBinary(std::move(frame), std::move(cb));
+                });
           });
+      return true;
+    }
+
+    /// Response as single json string, streamed result is written whole
+    static std::string toJson(boost::optional<uint64_t> id, Result res) {
+      ChunkedOutput output{SIZE_MAX, {}};
+      JsonWriter writer{output};
+      if (auto stream{boost::get<Response::Stream>(&res)}) {
+        writeStreamed(writer, *id, *stream);
+      } else {
+        encode(Response{id, std::move(res)}).Accept(writer);
+      }
+      return output.finish();
+    }
+
+    static void writeStreamed(JsonWriter &writer,
+                              uint64_t id,
+                              const Response::Stream &stream) {
+      writer.StartObject();
+      writer.Key("jsonrpc");
+      writer.String("2.0");
+      writer.Key("id");
+      writer.Uint64(id);
+      writer.Key("result");
+      stream(writer);
+      writer.EndObject();
+    }
+
+    void send(std::string method,
+              boost::variant<Document, ChanValue> params,
+              OkCb cb) {
+      if (auto value{boost::get<ChanValue>(&params)}) {
+        if (overloaded()) {
+          _write(Request{next_request++,
+                         "xrpc.ch.close",
+                         encode(std::make_tuple(value->chan))},
+                 {});
+          if (cb) {
+            cb(false);
+          }
+          return;
+        }
+        // shared value is written between own prefix and suffix
+        auto message{std::make_shared<Outgoing>()};
+        message->chunks.push_back(makeChunk(
+            R"({"jsonrpc":"2.0","id":)" + std::to_string(next_request++)
+            + R"(,"method":")" + method + R"(","params":[)"
+            + std::to_string(value->chan) + ","));
+        message->chunks.push_back(value->value);
+        message->chunks.push_back(makeChunk("]}"));
+        message->done = true;
+        message->cb = std::move(cb);
+        return _push(std::move(message));
+      }
+      Request req{next_request++,
+                  method,
+                  std::move(boost::get<Document>(params))};
+      if (method == "xrpc.ch.close") {
+        timer.expires_from_now(kChanCloseDelay);
+        timer.async_wait([self{shared_from_this()},
+                          req{std::move(req)},
+                          cb{std::move(cb)}](auto) {
+          self->_write(req, std::move(cb));
+        });
+        return;
+      }
+      _write(req, std::move(cb));
     }
 
     template <typename T>
     void _write(const T &v, OkCb cb) {
-      StringBuffer buffer;
-      rapidjson::Writer<StringBuffer> writer{buffer};
+      ChunkedOutput output{SIZE_MAX, {}};
+      JsonWriter writer{output};
       encode(v).Accept(writer);
-      pending_writes.emplace(std::move(buffer), std::move(cb));
+      _writeJson(output.finish(), std::move(cb));
+    }
+
+    /// Writes cbor list as binary frame on io thread
+    void _postBinary(CborEncodeStream frame, OkCb cb) {
+      CborEncodeStream s;
+      s << frame;
+      auto bytes{s.data()};
+      net::post(socket.get_executor(),
+                [self{shared_from_this()},
+                 cbor{std::string{bytes.begin(), bytes.end()}},
+                 cb{std::move(cb)}]() mutable {
+                  auto message{std::make_shared<Outgoing>()};
+                  message->chunks.push_back(makeChunk(std::move(cbor)));
+                  message->done = true;
+                  message->cb = std::move(cb);
+                  message->binary = true;
+                  self->_push(std::move(message));
+                });
+    }
+
+    void _writeJson(std::string json, OkCb cb) {
+      auto message{std::make_shared<Outgoing>()};
+      message->chunks.push_back(makeChunk(std::move(json)));
+      message->done = true;
+      message->cb = std::move(cb);
+      _push(std::move(message));
+    }
+
+    /// Queues complete message on io thread
+    void _push(std::shared_ptr<Outgoing> message) {
+      int64_t bytes{};
+      for (auto &chunk : message->chunks) {
+        bytes += chunk->size();
+      }
+      queued(bytes);
+      pending_writes.push(std::move(message));
       _flush();
     }
 
+    /// Counts bytes queued for write, called from any thread
+    void queued(int64_t bytes) {
+      queued_bytes += bytes;
+      queuedBytesGauge().add(bytes);
+    }
+
+    /// Queue of slow reader is full, its channel values are rejected
+    bool overloaded() const {
+      return queued_bytes > static_cast<int64_t>(kSessionMaxQueuedBytes);
+    }
+
+    /**
+     * Writes response produced on calling thread, filled chunks are sent as
+     * websocket frames on io thread while rest of response is produced
+     */
+    void _writeStream(uint64_t id, const Response::Stream &stream) {
+      auto message{std::make_shared<Outgoing>()};
+      net::post(socket.get_executor(), [self{shared_from_this()}, message] {
+        self->pending_writes.push(message);
+        self->_flush();
+      });
+      auto push{[&](std::string chunk, bool done) {
+        queued(chunk.size());
+        {
+          std::lock_guard lock{message->mutex};
+          message->chunks.push_back(makeChunk(std::move(chunk)));
+          message->done = done;
+        }
+        net::post(socket.get_executor(),
+                  [self{shared_from_this()}] { self->_flush(); });
+      }};
+      ChunkedOutput output{kStreamChunkSize,
+                           [&](auto chunk) { push(std::move(chunk), false); }};
+      JsonWriter writer{output};
+      writeStreamed(writer, id, stream);
+      push(output.finish(), true);
+    }
+
     void _flush() {
-      if (!writing && !pending_writes.empty()) {
-        auto &[buffer, cb] = pending_writes.front();
-        writing = true;
-        socket.async_write(
-            net::buffer(buffer.GetString(), buffer.GetSize()),
-            [self{shared_from_this()}, cb{std::move(cb)}](auto e, auto) {
-              self->writing = false;
-              auto ok = !e;
-              if (!ok) {
-                self->pending_writes = {};
-              } else {
+      if (writing || pending_writes.empty()) {
+        return;
+      }
+      auto message{pending_writes.front()};
+      // available chunks are written as one frame
+      auto chunks{std::make_shared<std::vector<Chunk>>()};
+      auto fin{false};
+      {
+        std::lock_guard lock{message->mutex};
+        // streamed message waits for next chunk
+        if (message->chunks.empty()) {
+          return;
+        }
+        chunks->assign(message->chunks.begin(), message->chunks.end());
+        message->chunks.clear();
+        fin = message->done;
+      }
+      std::vector<net::const_buffer> buffers;
+      buffers.reserve(chunks->size());
+      for (auto &chunk : *chunks) {
+        buffers.push_back(net::buffer(*chunk));
+      }
+      // frame type is set once per message
+      if (!message->started) {
+        message->started = true;
+        socket.binary(message->binary);
+      }
+      writing = true;
+      socket.async_write_some(
+          fin,
+          buffers,
+          [self{shared_from_this()}, message, chunks, fin](auto e, auto) {
+            self->writing = false;
+            int64_t written{};
+            for (auto &chunk : *chunks) {
+              written += chunk->size();
+            }
+            self->queued(-written);
+            auto ok = !e;
+            if (!ok) {
+              self->dropPending();
+            } else {
+              if (fin) {
                 self->pending_writes.pop();
-                self->_flush();
-              }
-              if (cb) {
-                cb(ok);
               }
-            });
+              self->_flush();
+            }
+            if ((fin || !ok) && message->cb) {
+              message->cb(ok);
+            }
+          });
+    }
+
+    /// Drops queued messages of failed session, their bytes are uncounted
+    void dropPending() {
+      int64_t dropped{};
+      for (; !pending_writes.empty(); pending_writes.pop()) {
+        auto &message{pending_writes.front()};
+        std::lock_guard lock{message->mutex};
+        for (auto &chunk : message->chunks) {
+          dropped += chunk->size();
+        }
+        message->chunks.clear();
       }
+      queued(-dropped);
     }
 
-    std::queue<std::pair<StringBuffer, OkCb>> pending_writes;
+    std::queue<std::shared_ptr<Outgoing>> pending_writes;
+    /// Bytes of messages in pending writes, including chunks being written
+    std::atomic_int64_t queued_bytes{};
     bool writing{false};
-    uint64_t next_channel{}, next_request{};
+    std::atomic<uint64_t> next_channel{};
+    uint64_t next_request{};
     websocket::stream<tcp::socket> socket;
     net::deadline_timer timer;
     beast::flat_buffer buffer;
+    /// First chunk of request parse pool, reused by all requests
+    std::array<char, kParseChunkSize> parse_chunk{};
+    rapidjson::MemoryPoolAllocator<> parse_allocator{parse_chunk.data(),
+                                                     parse_chunk.size()};
     Rpc rpc;
+    std::shared_ptr<Dispatcher> dispatcher;
   };
 
+  /**
+   * Accepts connections, each session runs on io context given by session
+   * io, so sessions may be spread over io pool
+   */
   struct Server : std::enable_shared_from_this<Server> {
-    Server(tcp::acceptor &&acceptor, Api api)
-        : acceptor{std::move(acceptor)}, api{api} {}
+    using SessionIo = std::function<net::io_context &()>;
+
+    Server(tcp::acceptor &&acceptor,
+           SessionIo session_io,
+           Api api,
+           std::shared_ptr<Dispatcher> dispatcher)
+        : acceptor{std::move(acceptor)},
+          session_io{std::move(session_io)},
+          api{api},
+          dispatcher{std::move(dispatcher)} {}
 
     void run() {
       doAccept();
     }
 
     void doAccept() {
-      acceptor.async_accept([self{shared_from_this()}](auto ec, auto socket) {
-        if (ec) {
-          return;
-        }
-        std::make_shared<ServerSession>(std::move(socket), self->api)->run();
-        self->doAccept();
-      });
+      auto socket{std::make_shared<tcp::socket>(session_io())};
+      acceptor.async_accept(
+          *socket, [self{shared_from_this()}, socket](auto ec) {
+            if (ec) {
+              return;
+            }
+            std::make_shared<ServerSession>(
+                std::move(*socket), self->api, self->dispatcher)
+                ->run();
+            self->doAccept();
+          });
     }
 
     tcp::acceptor acceptor;
+    SessionIo session_io;
     Api api;
+    std::shared_ptr<Dispatcher> dispatcher;
   };
 
-  void serve(Api api,
-             boost::asio::io_context &ioc,
-             std::string_view ip,
-             unsigned short port) {
+  std::shared_ptr<Dispatcher> serve(Api api,
+                                    boost::asio::io_context &ioc,
+                                    std::string_view ip,
+                                    unsigned short port,
+                                    DispatcherConfig config) {
+    auto dispatcher{std::make_shared<Dispatcher>(std::move(config))};
+    std::make_shared<Server>(
+        tcp::acceptor{ioc, {net::ip::make_address(ip), port}},
+        [&ioc]() -> net::io_context & { return ioc; },
+        std::move(api),
+        dispatcher)
+        ->run();
+    return dispatcher;
+  }
+
+  std::shared_ptr<Dispatcher> serve(Api api,
+                                    rpc::IoPool &io_pool,
+                                    std::string_view ip,
+                                    unsigned short port,
+                                    DispatcherConfig config) {
+    auto dispatcher{std::make_shared<Dispatcher>(std::move(config))};
     std::make_shared<Server>(
-        tcp::acceptor{ioc, {net::ip::make_address(ip), port}}, std::move(api))
+        tcp::acceptor{io_pool.at(0), {net::ip::make_address(ip), port}},
+        [&io_pool]() -> net::io_context & { return io_pool.next(); },
+        std::move(api),
+        dispatcher)
         ->run();
+    return dispatcher;
   }
 }  // namespace fc::api
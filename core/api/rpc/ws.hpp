@@ -7,16 +7,33 @@
 #define CPP_FILECOIN_CORE_API_RPC_WS_HPP
 
 #include "api/api.hpp"
+#include "api/rpc/dispatcher.hpp"
 
-namespace boost::asio {
-  class io_context;
-}  // namespace boost::asio
+namespace fc::api::rpc {
+  class IoPool;
+}  // namespace fc::api::rpc
 
 namespace fc::api {
-  void serve(Api api,
-             boost::asio::io_context &ioc,
-             std::string_view ip,
-             unsigned short port);
+  /**
+   * Serves api over websocket, methods are called by returned dispatcher
+   * @return dispatcher with method queue stats
+   */
+  std::shared_ptr<rpc::Dispatcher> serve(Api api,
+                                         boost::asio::io_context &ioc,
+                                         std::string_view ip,
+                                         unsigned short port,
+                                         rpc::DispatcherConfig config = {});
+
+  /**
+   * Serves api over websocket on own io threads, sessions are spread over
+   * io contexts of pool round-robin. Pool must outlive server.
+   * @return dispatcher with method queue stats
+   */
+  std::shared_ptr<rpc::Dispatcher> serve(Api api,
+                                         rpc::IoPool &io_pool,
+                                         std::string_view ip,
+                                         unsigned short port,
+                                         rpc::DispatcherConfig config = {});
 }  // namespace fc::api
 
 #endif  // CPP_FILECOIN_CORE_API_RPC_WS_HPP
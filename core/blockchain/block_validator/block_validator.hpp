@@ -6,6 +6,8 @@
 #ifndef CPP_FILECOIN_CORE_CHAIN_BLOCK_VALIDATOR_HPP
 #define CPP_FILECOIN_CORE_CHAIN_BLOCK_VALIDATOR_HPP
 
+#include <vector>
+
 #include "common/outcome.hpp"
 
 #include "blockchain/block_validator/block_validator_scenarios.hpp"
@@ -30,6 +32,22 @@ namespace fc::blockchain::block_validator {
      */
     virtual outcome::result<void> validateBlock(const BlockHeader &header,
                                                 scenarios::Scenario scenario) const = 0;
+
+    /**
+     * @brief Validate blocks arrived together, like blocks of one tipset
+     * @param headers - headers to validate
+     * @param scenario - required validation stages
+     * @return validation result of each block
+     */
+    virtual std::vector<outcome::result<void>> validateBlocks(
+        const std::vector<BlockHeader> &headers,
+        scenarios::Scenario scenario) const {
+      std::vector<outcome::result<void>> results;
+      for (const auto &header : headers) {
+        results.push_back(validateBlock(header, scenario));
+      }
+      return results;
+    }
   };
 
 }  // namespace fc::blockchain::block_validator
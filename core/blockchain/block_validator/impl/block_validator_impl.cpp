@@ -5,11 +5,14 @@
 
 #include "blockchain/block_validator/impl/block_validator_impl.hpp"
 
+#include <condition_variable>
+
+#include <boost/asio/post.hpp>
+
 #include "blockchain/block_validator/impl/consensus_rules.hpp"
 #include "blockchain/block_validator/impl/syntax_rules.hpp"
 #include "codec/cbor/cbor.hpp"
 #include "storage/amt/amt.hpp"
-#include "storage/ipld/ipld_block.hpp"
 
 namespace fc::blockchain::block_validator {
   using primitives::address::Protocol;
@@ -20,7 +23,6 @@ namespace fc::blockchain::block_validator {
   using BlsCryptoPubKey = crypto::bls::PublicKey;
   using SecpCryptoSignature = crypto::secp256k1::Signature;
   using SecpCryptoPubKey = crypto::secp256k1::PublicKey;
-  using IPLDBlock = storage::ipld::IPLDBlock;
 
   const std::map<scenarios::Stage, BlockValidatorImpl::StageExecutor>
       BlockValidatorImpl::stage_executors_{
@@ -33,18 +35,88 @@ namespace fc::blockchain::block_validator {
 
   outcome::result<void> BlockValidatorImpl::validateBlock(
       const BlockHeader &block, scenarios::Scenario scenario) const {
+    OUTCOME_TRY(stages, stageExecutors(scenario));
+    for (auto &result : runStages({std::cref(block)}, stages)) {
+      if (result.has_error()) {
+        return result;
+      }
+    }
+    return outcome::success();
+  }
+
+  std::vector<outcome::result<void>> BlockValidatorImpl::validateBlocks(
+      const std::vector<BlockHeader> &blocks,
+      scenarios::Scenario scenario) const {
+    auto stages = stageExecutors(scenario);
+    if (!stages) {
+      return std::vector<outcome::result<void>>(blocks.size(),
+                                                stages.error());
+    }
+    std::vector<std::reference_wrapper<const BlockHeader>> refs{blocks.begin(),
+                                                                blocks.end()};
+    auto stage_results = runStages(refs, stages.value());
+    std::vector<outcome::result<void>> results;
+    auto stage_result = stage_results.begin();
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      outcome::result<void> result = outcome::success();
+      for (size_t j = 0; j < stages.value().size(); ++j, ++stage_result) {
+        if (result && stage_result->has_error()) {
+          result = *stage_result;
+        }
+      }
+      results.push_back(result);
+    }
+    return results;
+  }
+
+  outcome::result<std::vector<BlockValidatorImpl::StageExecutor>>
+  BlockValidatorImpl::stageExecutors(scenarios::Scenario scenario) const {
+    std::vector<StageExecutor> stages;
     for (const auto &stage : scenario) {
       auto executor = stage_executors_.find(stage);
-      if (executor != stage_executors_.end()) {
-        auto result = std::invoke(executor->second, this, block);
-        if (result.has_error()) {
-          return result;
-        }
-      } else {
+      if (executor == stage_executors_.end()) {
         return ValidatorError::kUnknownStage;
       }
+      stages.push_back(executor->second);
     }
-    return outcome::success();
+    return stages;
+  }
+
+  std::vector<outcome::result<void>> BlockValidatorImpl::runStages(
+      const std::vector<std::reference_wrapper<const BlockHeader>> &blocks,
+      const std::vector<StageExecutor> &stages) const {
+    std::vector<outcome::result<void>> results(blocks.size() * stages.size(),
+                                               outcome::success());
+    if (!pool_) {
+      // sequential validation stops at first failed stage of block
+      for (size_t i = 0; i < blocks.size(); ++i) {
+        for (size_t j = 0; j < stages.size(); ++j) {
+          auto &result = results[i * stages.size() + j];
+          result = std::invoke(stages[j], this, blocks[i].get());
+          if (result.has_error()) {
+            break;
+          }
+        }
+      }
+      return results;
+    }
+    std::mutex mutex;
+    std::condition_variable done;
+    auto pending = results.size();
+    for (size_t i = 0; i < results.size(); ++i) {
+      boost::asio::post(*pool_, [&, i] {
+        auto &block = blocks[i / stages.size()].get();
+        auto result = std::invoke(stages[i % stages.size()], this, block);
+        std::lock_guard lock{mutex};
+        results[i] = std::move(result);
+        if (--pending == 0) {
+          done.notify_one();
+        }
+      });
+    }
+    std::unique_lock lock{mutex};
+    done.wait(lock, [&] { return pending == 0; });
+    return results;
   }
 
   outcome::result<void> BlockValidatorImpl::syntax(
@@ -64,7 +136,7 @@ namespace fc::blockchain::block_validator {
     OUTCOME_TRY(ConsensusRules::activeMiner(block, power_table_));
     OUTCOME_TRY(parent_tipset, getParentTipset(block));
     OUTCOME_TRY(ConsensusRules::parentWeight(
-        block, parent_tipset.get(), weight_calculator_));
+        block, parent_tipset, weight_calculator_));
     OUTCOME_TRY(chain_epoch, epoch_clock_->epochAtTime(clock_->nowUTC()));
     OUTCOME_TRY(ConsensusRules::epoch(block, chain_epoch));
     return outcome::success();
@@ -77,6 +149,10 @@ namespace fc::blockchain::block_validator {
     using ActorExecHash = primitives::address::ActorExecHash;
     const auto &block_signature = block.block_sig.value();
     OUTCOME_TRY(block_bytes, codec::cbor::encode(block));
+    OUTCOME_TRY(block_cid, common::getCidOf(block_bytes));
+    if (verified_signatures_.get(block_cid)) {
+      return outcome::success();
+    }
     auto validation_result = visit_in_place(
         block.miner.data,
         [](uint64_t) -> outcome::result<void> {
@@ -85,7 +161,7 @@ namespace fc::blockchain::block_validator {
         [](const ActorExecHash &) -> outcome::result<void> {
           return ValidatorError::kInvalidMinerPublicKey;
         },
-        [&block_signature, &block_bytes, *this](
+        [&block_signature, &block_bytes, this](
             const SecpPubKey &public_key) -> outcome::result<void> {
           crypto::secp256k1::PublicKey secp_public_key;
           auto secp_signature =
@@ -102,7 +178,7 @@ namespace fc::blockchain::block_validator {
           }
           return ValidatorError::kInvalidBlockSignature;
         },
-        [&block_signature, &block_bytes, *this](
+        [&block_signature, &block_bytes, this](
             const BlsPubKey &public_key) -> outcome::result<void> {
           auto bls_signature =
               boost::get<crypto::bls::Signature>(block_signature);
@@ -119,6 +195,9 @@ namespace fc::blockchain::block_validator {
           }
           return ValidatorError::kInvalidBlockSignature;
         });
+    if (validation_result) {
+      verified_signatures_.put(block_cid, true);
+    }
     return validation_result;
   }
 
@@ -148,12 +227,12 @@ namespace fc::blockchain::block_validator {
     return ValidatorError::kInvalidParentState;
   }
 
-  outcome::result<std::reference_wrapper<BlockValidatorImpl::Tipset>>
+  outcome::result<BlockValidatorImpl::Tipset>
   BlockValidatorImpl::getParentTipset(const BlockHeader &block) const {
-    IPLDBlock ipld_block = IPLDBlock::create(block);
-    if (parent_tipset_cache_
-        && parent_tipset_cache_.value().first == ipld_block.cid) {
-      return parent_tipset_cache_.value().second;
+    TipsetKey parents{block.parents};
+    std::lock_guard lock{parent_tipset_mutex_};
+    if (parent_tipset_cache_ && parent_tipset_cache_->first == parents) {
+      return parent_tipset_cache_->second;
     }
     std::vector<BlockHeader> parent_blocks;
     for (const CID &parent_block_cid : block.parents) {
@@ -171,9 +250,8 @@ namespace fc::blockchain::block_validator {
       }
     }
     OUTCOME_TRY(tipset, Tipset::create(parent_blocks));
-    parent_tipset_cache_ =
-        std::make_pair(std::move(ipld_block.cid), std::move(tipset));
-    return parent_tipset_cache_.value().second;
+    parent_tipset_cache_ = std::make_pair(std::move(parents), tipset);
+    return std::move(tipset);
   }
 
 }  // namespace fc::blockchain::block_validator
@@ -9,13 +9,16 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 
+#include <boost/asio/thread_pool.hpp>
 #include <boost/optional.hpp>
 #include <libp2p/crypto/secp256k1_provider.hpp>
 #include "blockchain/block_validator/block_validator.hpp"
 #include "blockchain/weight_calculator.hpp"
 #include "clock/chain_epoch_clock.hpp"
 #include "clock/utc_clock.hpp"
+#include "common/lru_cache.hpp"
 #include "crypto/bls/bls_provider.hpp"
 #include "power/power_table.hpp"
 #include "storage/ipfs/datastore.hpp"
@@ -35,6 +38,7 @@ namespace fc::blockchain::block_validator {
     using SecpProvider = crypto::secp256k1::Secp256k1ProviderDefault;
     using Interpreter = vm::interpreter::Interpreter;
     using Tipset = primitives::tipset::Tipset;
+    using TipsetKey = primitives::tipset::TipsetKey;
 
    public:
     using StageExecutor = outcome::result<void> (BlockValidatorImpl::*)(
@@ -47,7 +51,8 @@ namespace fc::blockchain::block_validator {
                        std::shared_ptr<PowerTable> power_table,
                        std::shared_ptr<BlsProvider> bls_crypto_provider,
                        std::shared_ptr<SecpProvider> secp_crypto_provider,
-                       std::shared_ptr<Interpreter> vm_interpreter)
+                       std::shared_ptr<Interpreter> vm_interpreter,
+                       std::shared_ptr<boost::asio::thread_pool> pool = nullptr)
         : datastore_{std::move(ipfs_store)},
           clock_{std::move(utc_clock)},
           epoch_clock_{std::move(epoch_clock)},
@@ -55,11 +60,22 @@ namespace fc::blockchain::block_validator {
           power_table_{std::move(power_table)},
           bls_provider_{std::move(bls_crypto_provider)},
           secp_provider_{std::move(secp_crypto_provider)},
-          vm_interpreter_{std::move(vm_interpreter)} {}
+          vm_interpreter_{std::move(vm_interpreter)},
+          pool_{std::move(pool)} {}
 
+    /**
+     * Stages don't depend on each other, so they run concurrently on pool
+     * when it is set. Must not be called from pool thread.
+     * @return first failed stage result in scenario order
+     */
     outcome::result<void> validateBlock(
         const BlockHeader &header, scenarios::Scenario scenario) const override;
 
+    /// Runs stages of all blocks concurrently on pool when it is set
+    std::vector<outcome::result<void>> validateBlocks(
+        const std::vector<BlockHeader> &headers,
+        scenarios::Scenario scenario) const override;
+
    private:
     const static std::map<scenarios::Stage, StageExecutor> stage_executors_;
 
@@ -71,13 +87,30 @@ namespace fc::blockchain::block_validator {
     std::shared_ptr<BlsProvider> bls_provider_;
     std::shared_ptr<SecpProvider> secp_provider_;
     std::shared_ptr<Interpreter> vm_interpreter_;
+    /// Optional, runs validation stages concurrently
+    std::shared_ptr<boost::asio::thread_pool> pool_;
+
+    /**
+     * Parent tipset key -> Parent tipset
+     * Blocks validated together usually have same parents
+     */
+    mutable std::mutex parent_tipset_mutex_;
+    mutable boost::optional<std::pair<TipsetKey, Tipset>> parent_tipset_cache_;
+
+    /// CIDs of blocks with verified signatures
+    mutable common::LruCache<CID, bool> verified_signatures_{1024};
 
     /**
-     * BlockHeader CID -> Parent tipset
-     * Assuming that block validation executes sequentially,
-     * so for several blocks parent tipset will be the same
+     * @brief Run stages of blocks, concurrently on pool if it is set
+     * @return result of each stage of each block, in order
      */
-    mutable boost::optional<std::pair<CID, Tipset>> parent_tipset_cache_;
+    std::vector<outcome::result<void>> runStages(
+        const std::vector<std::reference_wrapper<const BlockHeader>> &headers,
+        const std::vector<StageExecutor> &stages) const;
+
+    /// Finds executors of scenario stages
+    outcome::result<std::vector<StageExecutor>> stageExecutors(
+        scenarios::Scenario scenario) const;
 
     /**
      * @brief Check block syntax
@@ -133,8 +166,7 @@ namespace fc::blockchain::block_validator {
      * @param header - selected block
      * @return operation result
      */
-    outcome::result<std::reference_wrapper<Tipset>> getParentTipset(
-        const BlockHeader &header) const;
+    outcome::result<Tipset> getParentTipset(const BlockHeader &header) const;
   };
 
   enum class ValidatorError {
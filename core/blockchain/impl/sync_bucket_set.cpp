@@ -14,7 +14,7 @@ namespace fc::blockchain::sync_manager {
     }
 
     SyncTargetBucket b;
-    b.tipsets.resize(tipsets.size());
+    b.tipsets.reserve(tipsets.size());
     for (auto &t : tipsets) {
       b.tipsets.push_back(t);
     }
@@ -39,12 +39,28 @@ namespace fc::blockchain::sync_manager {
   }
 
   void SyncBucketSet::insert(Tipset ts) {
-    for (auto &b : buckets_)
-      if (b.isSameChain(ts)) {
-        return b.addTipset(ts);
+    boost::optional<SyncTargetBucket> joined;
+    for (auto it = buckets_.begin(); it != buckets_.end();) {
+      auto related = it->isSameChain(ts);
+      if (!related || !related.value()) {
+        ++it;
+        continue;
+      }
+      if (!joined) {
+        joined = std::move(*it);
+      } else {
+        for (auto &t : it->tipsets) {
+          joined->addTipset(t);
+        }
       }
+      it = buckets_.erase(it);
+    }
 
-    buckets_.emplace_back(SyncTargetBucket{{ts}});
+    if (!joined) {
+      joined = SyncTargetBucket{};
+    }
+    joined->addTipset(ts);
+    buckets_.push_back(std::move(*joined));
   }
 
   void SyncBucketSet::append(SyncTargetBucket bucket) {
@@ -127,6 +143,10 @@ namespace fc::blockchain::sync_manager {
     return buckets_.size();
   }
 
+  const std::vector<SyncTargetBucket> &SyncBucketSet::getBuckets() const {
+    return buckets_;
+  }
+
 }  // namespace fc::blockchain::sync_manager
 
 OUTCOME_CPP_DEFINE_CATEGORY(fc::blockchain::sync_manager,
@@ -25,7 +25,10 @@ namespace fc::blockchain::sync_manager {
     /** @brief checks if tipset is related to one of chains */
     outcome::result<bool> isRelatedToAny(const Tipset &ts) const;
 
-    /** @brief insert tipset */
+    /**
+     * @brief insert tipset into bucket of its chain, buckets of chains joined
+     * by tipset are merged
+     */
     void insert(Tipset ts);
 
     /** @brief appends bucket */
@@ -50,6 +53,9 @@ namespace fc::blockchain::sync_manager {
     /** @brief returns buckets count */
     size_t getSize() const;
 
+    /** @brief returns buckets */
+    const std::vector<SyncTargetBucket> &getBuckets() const;
+
    protected:
     std::vector<SyncTargetBucket> buckets_;
   };
@@ -5,23 +5,26 @@
 
 #include "blockchain/impl/sync_manager_impl.hpp"
 
+#include <boost/asio/post.hpp>
 #include <boost/assert.hpp>
 
 namespace fc::blockchain::sync_manager {
 
   SyncManagerImpl::SyncManagerImpl(boost::asio::io_context &context,
-                                   SyncFunction sync_function)
-      : peer_heads_{},
+                                   SyncFunction sync_function,
+                                   FetchFunction fetch_function,
+                                   size_t fetch_workers)
+      : io_{context},
         state_{BootstrapState::STATE_INIT},
-        bootstrap_threshold_{1},
-        sync_targets_{},
-        sync_results_{},
-        incoming_tipsets_{},
-        active_syncs_{},
+        bootstrap_threshold_{kBootstrapThresholdDefault},
+        fetch_workers_{fetch_workers},
         sync_function_(std::move(sync_function)),
+        fetch_function_(std::move(fetch_function)),
         logger_{common::createLogger("SyncManager")} {
     BOOST_ASSERT_MSG(static_cast<bool>(sync_function_),
                      "sync function is not callable");
+    BOOST_ASSERT_MSG(static_cast<bool>(fetch_function_),
+                     "fetch function is not callable");
   }
 
   BootstrapState SyncManagerImpl::getBootstrapState() const {
@@ -45,184 +48,164 @@ namespace fc::blockchain::sync_manager {
     return count;
   }
 
-  outcome::result<SyncManagerImpl::Tipset> SyncManagerImpl::selectSyncTarget() {
-    SyncBucketSet buckets(std::vector<Tipset>{});
-    std::vector<Tipset> peer_heads;
-    for (auto &[_, ts] : peer_heads_) {
-      peer_heads.push_back(ts);
-    }
-
-    std::sort(peer_heads.begin(),
-              peer_heads.end(),
-              [](const Tipset &l, const Tipset &r) -> bool {
-                return l.height < r.height;
-              });
-    for (auto &ts : peer_heads) {
-      buckets.insert(ts);
-    }
-
-    if (buckets.getSize() > 1) {
-      logger_->warn(
-          "caution, multiple distinct chains seen during head selections");
-    }
+  const boost::optional<SyncTargetBucket> &SyncManagerImpl::activeBucket()
+      const {
+    return active_bucket_;
+  }
 
-    return buckets.getHeaviestTipset();
+  const SyncBucketSet &SyncManagerImpl::syncQueue() const {
+    return sync_queue_;
   }
 
-  outcome::result<void> SyncManagerImpl::processResult(
-      const SyncResult &result) {
-    if (result.success) {
-      setBootstrapState(BootstrapState::STATE_COMPLETE);
-    }
+  outcome::result<void> SyncManagerImpl::setPeerHead(PeerId peer_id,
+                                                     const Tipset &tipset) {
+    peer_heads_.insert_or_assign(peer_id, tipset);
+    tipset_peers_.emplace(TipsetKey{tipset.cids}, peer_id);
 
-    OUTCOME_TRY(key, result.tipset.makeKey());
-    active_syncs_.erase(key);
-
-    OUTCOME_TRY(related_bucket, active_sync_tips_.popRelated(result.tipset));
-    if (related_bucket != boost::none) {
-      if (result.success) {
-        if (boost::none == next_sync_target_) {
-          next_sync_target_ = related_bucket;
-          auto heaviest_tipset = next_sync_target_->getHeaviestTipset();
-          if (boost::none == heaviest_tipset) {
-            return SyncTargetBucketError::kBucketIsEmpty;
-          }
-          OUTCOME_TRY(processSyncTargets(*heaviest_tipset));
-        } else {
-          sync_queue_.append(*related_bucket);
+    auto related = false;
+    if (active_bucket_) {
+      OUTCOME_TRYA(related, active_bucket_->isSameChain(tipset));
+    }
+    if (related) {
+      active_bucket_->addTipset(tipset);
+      // queued chains joined by tipset are synced with active one
+      while (true) {
+        OUTCOME_TRY(joined, sync_queue_.popRelated(tipset));
+        if (!joined) {
+          break;
+        }
+        for (auto &ts : joined->tipsets) {
+          active_bucket_->addTipset(ts);
         }
-        return outcome::success();
-      } else {
-        // TODO: this is the case where we try to sync a chain, and
-        // fail, and we have more blocks on top of that chain that
-        // have come in since.  The question is, should we try to
-        // sync these? or just drop them?
       }
+    } else {
+      sync_queue_.insert(tipset);
     }
 
-    if (next_sync_target_ == boost::none && !sync_queue_.isEmpty()) {
-      auto &&target = sync_queue_.pop();
-      if (target != boost::none) {
-        next_sync_target_ = std::move(target);
-        auto heaviest_tipset = next_sync_target_->getHeaviestTipset();
-        if (boost::none == heaviest_tipset) {
-          return SyncTargetBucketError::kBucketIsEmpty;
-        }
-        OUTCOME_TRY(processSyncTargets(*heaviest_tipset));
+    if (state_ == BootstrapState::STATE_INIT) {
+      auto synced_count = syncedPeerCount();
+      if (synced_count < bootstrap_threshold_) {
+        logger_->info("sync bootstrap has {} peers", synced_count);
+        return outcome::success();
+      }
+      if (sync_queue_.getSize() > 1) {
+        logger_->warn(
+            "caution, multiple distinct chains seen during head selections");
       }
+      state_ = BootstrapState::STATE_SELECTED;
     }
-
+    schedule();
     return outcome::success();
   }
 
-  outcome::result<void> SyncManagerImpl::processIncomingTipset(
-      const Tipset &tipset) {
-    logger_->info("scheduling incoming tipset sync %s",
-                  fmt::join(tipset.cids, ","));
-
-    if (getBootstrapState() == BootstrapState::STATE_SELECTED) {
-      setBootstrapState(BootstrapState::STATE_SCHEDULED);
-      sync_targets_.push_back(tipset);
+  void SyncManagerImpl::schedule() {
+    if (!active_sync_) {
+      if (!active_bucket_) {
+        active_bucket_ = sync_queue_.pop();
+      }
+      if (active_bucket_) {
+        active_sync_ = active_bucket_->getHeaviestTipset();
+        if (!active_sync_) {
+          active_bucket_.reset();
+        }
+      }
+      if (active_sync_) {
+        if (state_ == BootstrapState::STATE_SELECTED) {
+          state_ = BootstrapState::STATE_SCHEDULED;
+        }
+        TipsetKey key{active_sync_->cids};
+        logger_->info("syncing tipset {} at height {}",
+                      fmt::join(key.cids, ","),
+                      active_sync_->height);
+        sync_function_(
+            *active_sync_,
+            peerOf(key),
+            [weak{weak_from_this()}, io{&io_}, ts{*active_sync_}](
+                outcome::result<void> result) {
+              boost::asio::post(*io, [weak, ts, result] {
+                if (auto self{weak.lock()}) {
+                  self->onSynced(ts, result);
+                }
+              });
+            });
+      }
     }
 
-    bool is_related_to_active_sync = false;
-    for (auto &[_, acts] : active_syncs_) {
-      if (tipset == acts) break;
-      OUTCOME_TRY(key, acts.makeKey());
-      if (tipset.getParents() == key) {
-        is_related_to_active_sync = true;
+    // workers fetch chains of next buckets while active one is synced
+    for (auto &bucket : sync_queue_.getBuckets()) {
+      if (fetching_.size() >= fetch_workers_) {
         break;
       }
-    }
-    OUTCOME_TRY(is_related_to_ast, active_sync_tips_.isRelatedToAny(tipset));
-    is_related_to_active_sync |= is_related_to_ast;
-    if (is_related_to_active_sync) {
-      active_sync_tips_.insert(tipset);
-      return outcome::success();
-    }
-
-    if (getBootstrapState() == BootstrapState::STATE_SCHEDULED) {
-      sync_queue_.insert(tipset);
-      return outcome::success();
-    }
-
-    if (boost::none != next_sync_target_
-        && next_sync_target_->isSameChain(tipset)) {
-      next_sync_target_->addTipset(tipset);
-    } else {
-      sync_queue_.insert(tipset);
-      if (boost::none == next_sync_target_) {
-        next_sync_target_ = sync_queue_.pop();
-        auto heaviest_tipset = next_sync_target_->getHeaviestTipset();
-        if (boost::none == heaviest_tipset) {
-          return SyncTargetBucketError::kBucketIsEmpty;
-        }
-        OUTCOME_TRY(processSyncTargets(*heaviest_tipset));
+      auto heaviest = bucket.getHeaviestTipset();
+      if (!heaviest) {
+        continue;
+      }
+      TipsetKey key{heaviest->cids};
+      if (fetching_.count(key) != 0 || fetched_.count(key) != 0) {
+        continue;
       }
+      fetching_.insert(key);
+      fetch_function_(*heaviest,
+                      peerOf(key),
+                      [weak{weak_from_this()}, io{&io_}, key] {
+                        boost::asio::post(*io, [weak, key] {
+                          if (auto self{weak.lock()}) {
+                            self->onFetched(key);
+                          }
+                        });
+                      });
     }
-
-    return outcome::success();
   }
 
-  outcome::result<void> SyncManagerImpl::doSync() {
-    while (!sync_targets_.empty()) {
-      auto &&ts = std::move(sync_targets_.front());
-      sync_targets_.pop_front();
-      // do external sync
-      auto &&res = sync_function_(ts);
-      if (!res) {
-        logger_->error("sync error %s", res.error().message());
-      }
-
-      SyncResult sync_result{std::move(ts), res};
-      if (auto &&result = processResult(sync_result); !result) {
-        logger_->error("sync failed: " + result.error().message());
+  void SyncManagerImpl::onSynced(const Tipset &tipset,
+                                 const outcome::result<void> &result) {
+    active_sync_.reset();
+    auto forget = [&](const Tipset &ts) {
+      TipsetKey key{ts.cids};
+      tipset_peers_.erase(key);
+      fetched_.erase(key);
+    };
+    forget(tipset);
+    if (!result) {
+      logger_->warn("sync of tipset {} failed: {}",
+                    fmt::join(tipset.cids, ","),
+                    result.error().message());
+    } else {
+      setBootstrapState(BootstrapState::STATE_COMPLETE);
+    }
+    if (active_bucket_) {
+      auto &tipsets = active_bucket_->tipsets;
+      // lighter tipsets of synced chain would not become head
+      auto end = std::remove_if(tipsets.begin(), tipsets.end(), [&](auto &ts) {
+        auto done = ts == tipset
+                    || (result
+                        && ts.getParentWeight() <= tipset.getParentWeight());
+        if (done) {
+          forget(ts);
+        }
+        return done;
+      });
+      tipsets.erase(end, tipsets.end());
+      if (tipsets.empty()) {
+        active_bucket_.reset();
       }
     }
-
-    return outcome::success();
+    schedule();
   }
 
-  // worker
-  outcome::result<void> SyncManagerImpl::processSyncTargets(Tipset ts) {
-    // schedule work sent
-    OUTCOME_TRY(key, ts.makeKey());
-    active_syncs_[key] = ts;
-    if (!sync_queue_.isEmpty()) {
-      next_sync_target_ = sync_queue_.pop();
-    } else {
-      next_sync_target_ = boost::none;
+  void SyncManagerImpl::onFetched(const TipsetKey &key) {
+    if (fetching_.erase(key) != 0) {
+      fetched_.insert(key);
     }
-    // do sync
-    sync_targets_.push_back(std::move(ts));
-    return doSync();
+    schedule();
   }
 
-  outcome::result<void> SyncManagerImpl::setPeerHead(PeerId peer_id,
-                                                     const Tipset &tipset) {
-    peer_heads_[peer_id] = tipset;
-    auto state = state_;
-    switch (state) {
-      case BootstrapState::STATE_INIT: {
-        auto synced_count = syncedPeerCount();
-        if (synced_count >= bootstrap_threshold_) {
-          auto &&target = selectSyncTarget();
-          if (!target) {
-            logger_->error("failed to select sync target: %s",
-                           target.error().message());
-            return target.error();
-          }
-          state_ = BootstrapState::STATE_SELECTED;
-          return processIncomingTipset(target.value());
-        }
-        logger_->info("sync bootstrap has %d peers", synced_count);
-        return outcome::success();
-      }
-      case BootstrapState::STATE_SELECTED:
-      case BootstrapState::STATE_SCHEDULED:
-      case BootstrapState::STATE_COMPLETE:
-        return processIncomingTipset(tipset);
+  const PeerId &SyncManagerImpl::peerOf(const TipsetKey &key) const {
+    auto it = tipset_peers_.find(key);
+    if (it != tipset_peers_.end()) {
+      return it->second;
     }
+    return peer_heads_.begin()->first;
   }
 
 }  // namespace fc::blockchain::sync_manager
@@ -235,5 +218,7 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::blockchain::sync_manager, SyncManagerError, e) {
       return "shutting down";
     case Error::kNoSyncTarget:
       return "no sync target present";
+    case Error::kInvalid:
+      return "synced chain is invalid";
   }
 }
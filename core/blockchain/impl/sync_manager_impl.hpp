@@ -9,36 +9,48 @@
 #include "blockchain/sync_manager.hpp"
 
 #include <unordered_map>
+#include <unordered_set>
 
 #include <boost/asio/io_context.hpp>
 #include "blockchain/impl/sync_bucket_set.hpp"
-#include "blockchain/syncer_state.hpp"
 #include "common/logger.hpp"
 #include "common/outcome.hpp"
 #include "primitives/tipset/tipset.hpp"
 #include "primitives/tipset/tipset_key.hpp"
 
 namespace fc::blockchain::sync_manager {
-
-  using SyncFunction = std::function<outcome::result<void>(
-      std::reference_wrapper<const primitives::tipset::Tipset>)>;
-
-  enum class SyncManagerError { kShuttingDown = 1, kNoSyncTarget };
-
-  struct SyncResult {
-    primitives::tipset::Tipset tipset;
-    outcome::result<void> success;
-  };
-
+  using PeerId = libp2p::peer::PeerId;
+  using Tipset = primitives::tipset::Tipset;
+
+  using SyncCallback = std::function<void(outcome::result<void>)>;
+  /// Syncs and validates chain ending with tipset reported by peer
+  using SyncFunction =
+      std::function<void(const Tipset &, const PeerId &, SyncCallback)>;
+  /// Fetches headers of chain ending with tipset, without validating it
+  using FetchFunction = std::function<void(
+      const Tipset &, const PeerId &, std::function<void()>)>;
+
+  enum class SyncManagerError { kShuttingDown = 1, kNoSyncTarget, kInvalid };
+
+  /**
+   * Buckets peer heads by chain and syncs heaviest bucket, while workers
+   * fetch headers of other buckets, so they are synced faster when their
+   * turn comes. Tipsets joining chains of several buckets merge them.
+   * Methods and callbacks run on io thread, sync and fetch functions
+   * results are posted to io, so functions may complete synchronously.
+   */
   class SyncManagerImpl : public SyncManager,
                           public std::enable_shared_from_this<SyncManagerImpl> {
    public:
     const static size_t kBootstrapThresholdDefault = 1;
+    const static size_t kFetchWorkersDefault = 4;
 
     using TipsetKey = primitives::tipset::TipsetKey;
 
     SyncManagerImpl(boost::asio::io_context &context,
-                    SyncFunction sync_function);
+                    SyncFunction sync_function,
+                    FetchFunction fetch_function,
+                    size_t fetch_workers = kFetchWorkersDefault);
 
     ~SyncManagerImpl() override = default;
 
@@ -53,27 +65,38 @@ namespace fc::blockchain::sync_manager {
 
     bool isBootstrapped() const;
 
+    /** @brief bucket being synced, none when idle */
+    const boost::optional<SyncTargetBucket> &activeBucket() const;
+
+    /** @brief buckets waiting for sync */
+    const SyncBucketSet &syncQueue() const;
+
    private:
-    outcome::result<void> processIncomingTipset(const Tipset &tipset);
+    /** @brief starts sync of next target and header fetches of queue */
+    void schedule();
 
-    outcome::result<Tipset> selectSyncTarget();
+    void onSynced(const Tipset &tipset, const outcome::result<void> &result);
 
-    outcome::result<void> processSyncTargets(Tipset ts);
+    void onFetched(const TipsetKey &key);
 
-    outcome::result<void> doSync();
+    const PeerId &peerOf(const TipsetKey &key) const;
 
-    outcome::result<void> processResult(const SyncResult &result);
+    boost::asio::io_context &io_;
     std::unordered_map<PeerId, Tipset> peer_heads_;
+    /// First peer reporting tipset, which is asked for its chain
+    std::unordered_map<TipsetKey, PeerId> tipset_peers_;
     BootstrapState state_;
     const uint64_t bootstrap_threshold_{kBootstrapThresholdDefault};
-    std::deque<Tipset> sync_targets_;
-    std::deque<SyncResult> sync_results_;
-    std::deque<Tipset> incoming_tipsets_;
-    std::unordered_map<TipsetKey, Tipset> active_syncs_;
-    boost::optional<SyncTargetBucket> next_sync_target_;
-    SyncBucketSet sync_queue_{gsl::span<Tipset>{}};
-    SyncBucketSet active_sync_tips_{gsl::span<Tipset>{}};
+    const size_t fetch_workers_;
+    SyncBucketSet sync_queue_{std::vector<Tipset>{}};
+    /// Bucket of tipset being synced, tipsets of its chain join it
+    boost::optional<SyncTargetBucket> active_bucket_;
+    boost::optional<Tipset> active_sync_;
+    /// Heads of queued buckets with headers being fetched or fetched
+    std::unordered_set<TipsetKey> fetching_;
+    std::unordered_set<TipsetKey> fetched_;
     SyncFunction sync_function_;
+    FetchFunction fetch_function_;
     common::Logger logger_;
   };
 
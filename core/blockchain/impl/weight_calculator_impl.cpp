@@ -26,15 +26,23 @@ namespace fc::blockchain::weight {
   constexpr uint64_t kWRatioDen{2};
   constexpr uint64_t kBlocksPerEpoch{5};
 
-  WeightCalculatorImpl::WeightCalculatorImpl(std::shared_ptr<Ipld> ipld)
-      : ipld_{std::move(ipld)} {}
+  WeightCalculatorImpl::WeightCalculatorImpl(
+      std::shared_ptr<Ipld> ipld,
+      std::shared_ptr<PowerSummaries> power_summaries)
+      : ipld_{std::move(ipld)}, power_summaries_{std::move(power_summaries)} {}
 
   outcome::result<BigInt> WeightCalculatorImpl::calculateWeight(
       const Tipset &tipset) {
-    OUTCOME_TRY(state,
-                StateTreeImpl{ipld_, tipset.getParentStateRoot()}
-                    .state<StoragePowerActorState>(kStoragePowerAddress));
-    auto network_power = state.total_qa_power;
+    BigInt network_power;
+    if (power_summaries_) {
+      OUTCOME_TRY(summary, power_summaries_->get(tipset.getParentStateRoot()));
+      network_power = summary.total_qa_power;
+    } else {
+      OUTCOME_TRY(state,
+                  StateTreeImpl{ipld_, tipset.getParentStateRoot()}
+                      .state<StoragePowerActorState>(kStoragePowerAddress));
+      network_power = state.total_qa_power;
+    }
     if (network_power <= 0) {
       return outcome::failure(WeightCalculatorError::kNoNetworkPower);
     }
@@ -9,13 +9,22 @@
 #include "blockchain/weight_calculator.hpp"
 
 #include "storage/ipfs/datastore.hpp"
+#include "vm/actor/builtin/storage_power/power_summary.hpp"
 
 namespace fc::blockchain::weight {
+  using vm::actor::builtin::storage_power::PowerSummaries;
+
   enum class WeightCalculatorError { kNoNetworkPower = 1 };
 
   class WeightCalculatorImpl : public WeightCalculator {
    public:
-    explicit WeightCalculatorImpl(std::shared_ptr<Ipld> ipld);
+    /**
+     * @param power_summaries - optional, network power is read from power
+     * actor state without it
+     */
+    explicit WeightCalculatorImpl(
+        std::shared_ptr<Ipld> ipld,
+        std::shared_ptr<PowerSummaries> power_summaries = nullptr);
 
     ~WeightCalculatorImpl() override = default;
 
@@ -23,6 +32,7 @@ namespace fc::blockchain::weight {
 
    private:
     std::shared_ptr<Ipld> ipld_;
+    std::shared_ptr<PowerSummaries> power_summaries_;
   };
 
 }  // namespace fc::blockchain::weight
@@ -15,18 +15,20 @@ fc::outcome::result<void> GasPriceScoredMessageStorage::put(
     const SignedMessage &message) {
   auto res = messages_.insert(message);
   if (!res.second) return MessagePoolError::kMessageAlreadyInPool;
+  scored_.insert(message);
   return fc::outcome::success();
 }
 
 void GasPriceScoredMessageStorage::remove(const SignedMessage &message) {
-  messages_.erase(message);
+  auto it = messages_.find(message);
+  if (it == messages_.end()) return;
+  scored_.erase(*it);
+  messages_.erase(it);
 }
 
 std::vector<SignedMessage> GasPriceScoredMessageStorage::getTopScored(
     size_t n) const {
-  std::set<SignedMessage, decltype(compareGasFunctor)> score(
-      messages_.begin(), messages_.end(), compareGasFunctor);
   return std::vector<SignedMessage>(
-      score.begin(),
-      (n < score.size()) ? std::next(score.begin(), n) : score.end());
+      scored_.begin(),
+      (n < scored_.size()) ? std::next(scored_.begin(), n) : scored_.end());
 }
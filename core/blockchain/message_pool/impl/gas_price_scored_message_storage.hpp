@@ -52,6 +52,9 @@ namespace fc::blockchain::message_pool {
    private:
     std::set<SignedMessage, decltype(compareMessagesFunctor)> messages_{
         compareMessagesFunctor};
+    /// Same messages ordered by score, updated on put and remove
+    std::set<SignedMessage, decltype(compareGasFunctor)> scored_{
+        compareGasFunctor};
   };
 
 }  // namespace fc::blockchain::message_pool
@@ -5,6 +5,8 @@
 
 #include "blockchain/production/block_producer.hpp"
 
+#include <future>
+
 #include "blockchain/impl/weight_calculator_impl.hpp"
 #include "crypto/bls/impl/bls_provider_impl.hpp"
 
@@ -15,33 +17,83 @@ namespace fc::blockchain::production {
   using vm::message::SignedMessage;
   using vm::message::UnsignedMessage;
 
+  /// Signatures aggregated by one task of aggregation tree
+  constexpr size_t kAggregateChunk{64};
+
+  /**
+   * Aggregates signatures as tree, chunks of each level are aggregated
+   * concurrently. Aggregation is addition of curve points, so result is same
+   * as aggregating all signatures at once.
+   */
+  outcome::result<crypto::bls::Signature> aggregateTree(
+      std::vector<crypto::bls::Signature> signatures) {
+    crypto::bls::BlsProviderImpl bls;
+    while (signatures.size() > kAggregateChunk) {
+      std::vector<std::future<outcome::result<crypto::bls::Signature>>> tasks;
+      for (size_t begin{0}; begin < signatures.size();
+           begin += kAggregateChunk) {
+        const auto size{std::min(kAggregateChunk, signatures.size() - begin)};
+        tasks.push_back(std::async(std::launch::async, [&, begin, size] {
+          return bls.aggregateSignatures(
+              gsl::make_span(signatures).subspan(begin, size));
+        }));
+      }
+      std::vector<crypto::bls::Signature> aggregates;
+      for (auto &task : tasks) {
+        OUTCOME_TRY(aggregate, task.get());
+        aggregates.push_back(aggregate);
+      }
+      signatures = std::move(aggregates);
+    }
+    return bls.aggregateSignatures(signatures);
+  }
+
   outcome::result<BlockWithMessages> generate(Interpreter &interpreter,
                                               std::shared_ptr<Ipld> ipld,
                                               BlockTemplate t) {
-    OUTCOME_TRY(parent_tipset,
-                primitives::tipset::Tipset::load(*ipld, t.parents));
-    OUTCOME_TRY(vm_result, interpreter.interpret(ipld, parent_tipset));
     BlockWithMessages b;
-    MsgMeta msg_meta;
-    ipld->load(msg_meta);
     std::vector<crypto::bls::Signature> bls_signatures;
     for (auto &message : t.messages) {
-      OUTCOME_TRY(visit_in_place(
+      visit_in_place(
           message.signature,
-          [&](const BlsSignature &signature) -> outcome::result<void> {
+          [&](const BlsSignature &signature) {
             b.bls_messages.emplace_back(message.message);
             bls_signatures.push_back(signature);
-            OUTCOME_TRY(message_cid, ipld->setCbor(message.message));
-            OUTCOME_TRY(msg_meta.bls_messages.append(message_cid));
-            return outcome::success();
           },
-          [&](const Secp256k1Signature &signature) -> outcome::result<void> {
+          [&](const Secp256k1Signature &signature) {
             b.secp_messages.emplace_back(message);
-            OUTCOME_TRY(message_cid, ipld->setCbor(message));
-            OUTCOME_TRY(msg_meta.secp_messages.append(message_cid));
-            return outcome::success();
-          }));
+          });
+    }
+    // ffi aggregation doesn't touch ipld, so it overlaps with what follows
+    auto bls_aggregate{std::async(std::launch::async,
+                                  aggregateTree,
+                                  std::move(bls_signatures))};
+
+    OUTCOME_TRY(parent_tipset,
+                primitives::tipset::Tipset::load(*ipld, t.parents));
+    // parent is usually interpreted already when its child is produced
+    OUTCOME_TRY(cached, interpreter.tryGet(t.parents));
+    if (!cached) {
+      OUTCOME_TRYA(cached, interpreter.interpret(ipld, parent_tipset));
+    }
+    auto &vm_result{*cached};
+
+    std::vector<CID> bls_cids, secp_cids;
+    bls_cids.reserve(b.bls_messages.size());
+    secp_cids.reserve(b.secp_messages.size());
+    for (const auto &message : b.bls_messages) {
+      OUTCOME_TRY(message_cid, ipld->setCbor(message));
+      bls_cids.push_back(std::move(message_cid));
     }
+    for (const auto &message : b.secp_messages) {
+      OUTCOME_TRY(message_cid, ipld->setCbor(message));
+      secp_cids.push_back(std::move(message_cid));
+    }
+    MsgMeta msg_meta;
+    ipld->load(msg_meta);
+    OUTCOME_TRY(msg_meta.bls_messages.assign(bls_cids));
+    OUTCOME_TRY(msg_meta.secp_messages.assign(secp_cids));
+
     b.header.miner = std::move(t.miner);
     b.header.ticket = std::move(t.ticket);
     b.header.election_proof = std::move(t.election_proof);
@@ -55,9 +107,7 @@ namespace fc::blockchain::production {
     b.header.parent_state_root = std::move(vm_result.state_root);
     b.header.parent_message_receipts = std::move(vm_result.message_receipts);
     OUTCOME_TRYA(b.header.messages, ipld->setCbor(msg_meta));
-    OUTCOME_TRYA(
-        b.header.bls_aggregate,
-        crypto::bls::BlsProviderImpl{}.aggregateSignatures(bls_signatures));
+    OUTCOME_TRYA(b.header.bls_aggregate, bls_aggregate.get());
     b.header.timestamp = t.timestamp;
     // TODO: the only caller of "generate" is MinerCreateBlock, it signs block
     b.header.block_sig = {};
@@ -0,0 +1,174 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "clock/timer_wheel.hpp"
+
+#include <boost/asio/post.hpp>
+#include <boost/assert.hpp>
+
+namespace fc::clock {
+  void TimerWheel::Timer::cancel() {
+    cancelled_ = true;
+  }
+
+  bool TimerWheel::Timer::cancelled() const {
+    return cancelled_;
+  }
+
+  TimerWheel::TimerWheel(std::shared_ptr<boost::asio::io_context> io,
+                         std::shared_ptr<ChainEpochClock> epoch_clock,
+                         Clock::duration resolution,
+                         Clock::time_point start)
+      : io_{std::move(io)},
+        epoch_clock_{std::move(epoch_clock)},
+        resolution_{resolution},
+        start_{start},
+        driver_{*io_} {
+    BOOST_ASSERT(resolution_.count() > 0);
+  }
+
+  TimerWheel::~TimerWheel() {
+    auto pending{pending_.exchange(nullptr)};
+    while (pending) {
+      delete std::exchange(pending, pending->next);
+    }
+  }
+
+  TimerWheel::TimerPtr TimerWheel::at(Clock::time_point time,
+                                      Callback callback) {
+    auto timer{std::make_shared<Timer>()};
+    timer->time = time;
+    timer->tick = tickOf(time);
+    timer->callback = std::move(callback);
+    auto pending{new Pending{timer, pending_.load()}};
+    while (!pending_.compare_exchange_weak(pending->next, pending)) {
+    }
+    if (size_.fetch_add(1) == 0) {
+      // wheel was idle, so driver must be armed on io
+      boost::asio::post(*io_, [weak{weak_from_this()}] {
+        if (auto self{weak.lock()}) {
+          self->arm();
+        }
+      });
+    }
+    return timer;
+  }
+
+  TimerWheel::TimerPtr TimerWheel::after(Clock::duration delay,
+                                         Callback callback) {
+    return at(Clock::now() + delay, std::move(callback));
+  }
+
+  TimerWheel::TimerPtr TimerWheel::atEpoch(ChainEpoch epoch,
+                                           Callback callback) {
+    return at(epochTime(epoch), std::move(callback));
+  }
+
+  TimerWheel::Clock::time_point TimerWheel::epochTime(ChainEpoch epoch) const {
+    BOOST_ASSERT(epoch_clock_);
+    return Clock::time_point{epoch_clock_->genesisTime()
+                             + epoch * kEpochDuration};
+  }
+
+  size_t TimerWheel::size() const {
+    return size_;
+  }
+
+  uint64_t TimerWheel::tickOf(Clock::time_point time) const {
+    if (time <= start_) {
+      return 0;
+    }
+    // timer expires at first tick not before its time
+    return (time - start_ + resolution_ - Clock::duration{1}) / resolution_;
+  }
+
+  void TimerWheel::insert(TimerPtr timer) {
+    auto tick{std::max(timer->tick, current_ + 1)};
+    auto delta{tick - current_};
+    size_t level{0};
+    while (level + 1 < kLevels
+           && delta >= (uint64_t{1} << ((level + 1) * kLevelBits))) {
+      ++level;
+    }
+    // timers beyond last level are put in its farthest slot and inserted
+    // again when reached
+    auto max_tick{current_ + (uint64_t{1} << (kLevels * kLevelBits)) - 1};
+    tick = std::min(tick, max_tick);
+    auto slot{(tick >> (level * kLevelBits)) & (kSlots - 1)};
+    levels_[level][slot].push_back(std::move(timer));
+  }
+
+  void TimerWheel::drainPending() {
+    auto pending{pending_.exchange(nullptr)};
+    while (pending) {
+      insert(std::move(pending->timer));
+      delete std::exchange(pending, pending->next);
+    }
+  }
+
+  void TimerWheel::cascade(size_t level) {
+    auto slot{(current_ >> (level * kLevelBits)) & (kSlots - 1)};
+    auto timers{std::move(levels_[level][slot])};
+    levels_[level][slot].clear();
+    for (auto &timer : timers) {
+      insert(std::move(timer));
+    }
+  }
+
+  void TimerWheel::advance(Clock::time_point now) {
+    drainPending();
+    uint64_t target{0};
+    if (now > start_) {
+      target = (now - start_) / resolution_;
+    }
+    while (current_ < target) {
+      if (size_ == 0) {
+        current_ = target;
+        break;
+      }
+      ++current_;
+      for (size_t level{1}; level < kLevels; ++level) {
+        if ((current_ & ((uint64_t{1} << (level * kLevelBits)) - 1)) != 0) {
+          break;
+        }
+        cascade(level);
+      }
+      auto &slot{levels_[0][current_ & (kSlots - 1)]};
+      auto timers{std::move(slot)};
+      slot.clear();
+      for (auto &timer : timers) {
+        if (timer->tick > current_ && !timer->cancelled()) {
+          insert(std::move(timer));
+          continue;
+        }
+        --size_;
+        if (!timer->cancelled()) {
+          timer->callback();
+        }
+      }
+      // callbacks may register timers expiring at current tick
+      drainPending();
+    }
+  }
+
+  void TimerWheel::arm() {
+    if (armed_ || size_ == 0) {
+      return;
+    }
+    armed_ = true;
+    driver_.expires_at(start_
+                       + static_cast<int64_t>(current_ + 1) * resolution_);
+    driver_.async_wait([weak{weak_from_this()}](auto ec) {
+      if (ec) {
+        return;
+      }
+      if (auto self{weak.lock()}) {
+        self->armed_ = false;
+        self->advance(Clock::now());
+        self->arm();
+      }
+    });
+  }
+}  // namespace fc::clock
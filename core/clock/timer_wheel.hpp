@@ -0,0 +1,108 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_CLOCK_TIMER_WHEEL_HPP
+#define CPP_FILECOIN_CORE_CLOCK_TIMER_WHEEL_HPP
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/system_timer.hpp>
+
+#include "clock/chain_epoch_clock.hpp"
+
+namespace fc::clock {
+  /**
+   * Hierarchical timer wheel shared by components waiting for wall time or
+   * epochs, so many pending deadlines cost one asio timer. Each of levels
+   * has 256 slots, slot of level covers 256 slots of level below, timers are
+   * moved down when their slot is reached. Registration and cancellation are
+   * lock-free and may be called from any thread, callbacks run on io thread.
+   */
+  class TimerWheel : public std::enable_shared_from_this<TimerWheel> {
+   public:
+    using Clock = std::chrono::system_clock;
+    using Callback = std::function<void()>;
+
+    static constexpr std::chrono::milliseconds kResolutionDefault{100};
+    static constexpr size_t kLevelBits{8};
+    static constexpr size_t kSlots{1 << kLevelBits};
+    static constexpr size_t kLevels{4};
+
+    /// Pending timer, callback is not called after cancel
+    struct Timer {
+      void cancel();
+      bool cancelled() const;
+
+      Clock::time_point time;
+      uint64_t tick{};
+      Callback callback;
+      std::atomic_bool cancelled_{false};
+    };
+    using TimerPtr = std::shared_ptr<Timer>;
+
+    /**
+     * @param epoch_clock - optional, needed to wait for epochs
+     * @param start - time of first tick, timers before it expire on first
+     * advance
+     */
+    TimerWheel(std::shared_ptr<boost::asio::io_context> io,
+               std::shared_ptr<ChainEpochClock> epoch_clock = nullptr,
+               Clock::duration resolution = kResolutionDefault,
+               Clock::time_point start = Clock::now());
+    ~TimerWheel();
+
+    /// Calls callback on io at or after time
+    TimerPtr at(Clock::time_point time, Callback callback);
+
+    TimerPtr after(Clock::duration delay, Callback callback);
+
+    /// Calls callback when epoch starts, requires epoch clock
+    TimerPtr atEpoch(ChainEpoch epoch, Callback callback);
+
+    /// Wall time of epoch start
+    Clock::time_point epochTime(ChainEpoch epoch) const;
+
+    /// Runs callbacks of timers expired by now, called on io thread
+    void advance(Clock::time_point now);
+
+    /// Number of timers not run yet, including cancelled ones not dropped
+    size_t size() const;
+
+   private:
+    struct Pending {
+      TimerPtr timer;
+      Pending *next;
+    };
+    using Slot = std::vector<TimerPtr>;
+
+    uint64_t tickOf(Clock::time_point time) const;
+    void insert(TimerPtr timer);
+    void drainPending();
+    /// Moves timers of slot of level down
+    void cascade(size_t level);
+    /// Arms asio timer for next tick while there are timers
+    void arm();
+
+    std::shared_ptr<boost::asio::io_context> io_;
+    std::shared_ptr<ChainEpochClock> epoch_clock_;
+    Clock::duration resolution_;
+    Clock::time_point start_;
+    boost::asio::system_timer driver_;
+    bool armed_{};
+    /// Timers registered but not inserted into wheel yet
+    std::atomic<Pending *> pending_{nullptr};
+    std::atomic_size_t size_{0};
+    /// Last processed tick
+    uint64_t current_{};
+    std::array<std::array<Slot, kSlots>, kLevels> levels_;
+  };
+}  // namespace fc::clock
+
+#endif  // CPP_FILECOIN_CORE_CLOCK_TIMER_WHEEL_HPP
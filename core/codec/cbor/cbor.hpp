@@ -25,7 +25,7 @@ namespace fc::codec::cbor {
     try {
       CborEncodeStream encoder;
       encoder << arg;
-      return Buffer{encoder.data()};
+      return Buffer{std::move(encoder).data()};
     } catch (std::system_error &e) {
       return outcome::failure(e.code());
     }
@@ -42,8 +42,12 @@ namespace fc::codec::cbor {
   outcome::result<T> decode(gsl::span<const uint8_t> input) {
     try {
       T data{};
-      CborDecodeStream decoder(input);
+      // malformed input is rejected without unwinding through decoders
+      auto decoder = CborDecodeStream::borrow(input, true);
       decoder >> data;
+      if (decoder.error()) {
+        return outcome::failure(decoder.error());
+      }
       return data;
     } catch (std::system_error &e) {
       return outcome::failure(e.code());
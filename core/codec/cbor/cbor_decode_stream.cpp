@@ -7,79 +7,136 @@
 
 namespace fc::codec::cbor {
   CborDecodeStream::CborDecodeStream(gsl::span<const uint8_t> data)
-      : data_(std::make_shared<std::vector<uint8_t>>(data.begin(), data.end())),
-        parser_(std::make_shared<CborParser>()) {
+      : data_(std::make_shared<std::vector<uint8_t>>(data.begin(), data.end())) {
+    init(*data_, false);
+  }
+
+  CborDecodeStream CborDecodeStream::borrow(gsl::span<const uint8_t> data,
+                                            bool nothrow) {
+    CborDecodeStream stream;
+    stream.init(data, nothrow);
+    return stream;
+  }
+
+  void CborDecodeStream::init(gsl::span<const uint8_t> data, bool nothrow) {
+    state_ = std::make_shared<State>();
+    state_->nothrow = nothrow;
     if (CborNoError
         != cbor_parser_init(
-            data_->data(), data_->size(), 0, parser_.get(), &value_)) {
-      outcome::raise(CborDecodeError::kInvalidCbor);
+            data.data(), data.size(), 0, &state_->parser, &value_)) {
+      return fail(CborDecodeError::kInvalidCbor);
     }
     value_.remaining = UINT32_MAX;
   }
 
-  CborDecodeStream &CborDecodeStream::operator>>(gsl::span<uint8_t> bytes) {
-    auto size = bytesLength();
-    if (static_cast<size_t>(bytes.size()) != size) {
-      outcome::raise(CborDecodeError::kWrongSize);
+  const std::error_code &CborDecodeStream::error() const {
+    return state_->error;
+  }
+
+  void CborDecodeStream::fail(CborDecodeError error) {
+    if (!state_->nothrow) {
+      outcome::raise(error);
     }
-    auto value = value_;
-    value.remaining = 1;
-    if (CborNoError
-        != cbor_value_copy_byte_string(&value, bytes.data(), &size, nullptr)) {
-      outcome::raise(CborDecodeError::kInvalidCbor);
+    if (!state_->error) {
+      state_->error = make_error_code(error);
     }
-    next();
+    // failed stream is at end, so following reads fail without parsing
+    value_.type = CborInvalidType;
+    value_.remaining = 0;
+  }
+
+  CborDecodeStream &CborDecodeStream::operator>>(gsl::span<uint8_t> bytes) {
+    auto view = bytesView();
+    if (view.size() != bytes.size()) {
+      fail(CborDecodeError::kWrongSize);
+      return *this;
+    }
+    std::copy(view.begin(), view.end(), bytes.begin());
     return *this;
   }
 
   CborDecodeStream &CborDecodeStream::operator>>(std::vector<uint8_t> &bytes) {
-    bytes.resize(bytesLength());
-    return *this >> gsl::make_span(bytes);
+    auto view = bytesView();
+    bytes.assign(view.begin(), view.end());
+    return *this;
   }
 
   CborDecodeStream &CborDecodeStream::operator>>(std::string &str) {
-    if (!cbor_value_is_text_string(&value_)) {
-      outcome::raise(CborDecodeError::kWrongType);
+    auto view = strView();
+    str.assign(view.begin(), view.end());
+    return *this;
+  }
+
+  gsl::span<const uint8_t> CborDecodeStream::bytesView() {
+    if (!isBytes()) {
+      fail(CborDecodeError::kWrongType);
+      return {};
+    }
+    return stringView();
+  }
+
+  std::string_view CborDecodeStream::strView() {
+    if (!isStr()) {
+      fail(CborDecodeError::kWrongType);
+      return {};
     }
+    auto view = stringView();
+    return {reinterpret_cast<const char *>(view.data()),
+            static_cast<size_t>(view.size())};
+  }
+
+  gsl::span<const uint8_t> CborDecodeStream::stringView() {
     size_t size;
     if (CborNoError != cbor_value_get_string_length(&value_, &size)) {
-      outcome::raise(CborDecodeError::kInvalidCbor);
+      fail(CborDecodeError::kInvalidCbor);
+      return {};
     }
-    str.resize(size);
-    auto value = value_;
-    value.remaining = 1;
-    if (CborNoError
-        != cbor_value_copy_text_string(&value, str.data(), &size, nullptr)) {
-      outcome::raise(CborDecodeError::kInvalidCbor);
+    // head size from additional info, chunked strings have no single view
+    auto info = *value_.ptr & 0x1F;
+    size_t head = 1;
+    if (info == 24) {
+      head = 2;
+    } else if (info == 25) {
+      head = 3;
+    } else if (info == 26) {
+      head = 5;
+    } else if (info == 27) {
+      head = 9;
+    } else if (info > 27) {
+      fail(CborDecodeError::kInvalidCbor);
+      return {};
+    }
+    auto begin = value_.ptr + head;
+    if (static_cast<size_t>(state_->parser.end - begin) < size) {
+      fail(CborDecodeError::kInvalidCbor);
+      return {};
     }
     next();
-    return *this;
+    return gsl::make_span(begin, size);
   }
 
   CborDecodeStream &CborDecodeStream::operator>>(CID &cid) {
-    if (!cbor_value_is_tag(&value_)) {
-      outcome::raise(CborDecodeError::kInvalidCborCID);
-    }
-    CborTag tag;
-    cbor_value_get_tag(&value_, &tag);
-    if (tag != kCidTag) {
-      outcome::raise(CborDecodeError::kInvalidCborCID);
+    if (!isCid()) {
+      fail(CborDecodeError::kInvalidCborCID);
+      return *this;
     }
     if (CborNoError != cbor_value_advance(&value_)) {
-      outcome::raise(CborDecodeError::kInvalidCbor);
+      fail(CborDecodeError::kInvalidCbor);
+      return *this;
     }
-    if (!cbor_value_is_byte_string(&value_)) {
-      outcome::raise(CborDecodeError::kInvalidCborCID);
+    if (!isBytes()) {
+      fail(CborDecodeError::kInvalidCborCID);
+      return *this;
     }
-    std::vector<uint8_t> bytes;
-    *this >> bytes;
-    if (bytes[0] != 0) {
-      outcome::raise(CborDecodeError::kInvalidCborCID);
+    auto bytes = bytesView();
+    if (bytes.empty() || bytes[0] != 0) {
+      fail(CborDecodeError::kInvalidCborCID);
+      return *this;
     }
-    bytes.erase(bytes.begin());
-    auto maybe_cid = CID::fromBytes(bytes);
+    auto maybe_cid = CID::fromBytes(bytes.subspan(1));
     if (maybe_cid.has_error()) {
-      outcome::raise(CborDecodeError::kInvalidCID);
+      fail(CborDecodeError::kInvalidCID);
+      return *this;
     }
     cid = std::move(maybe_cid.value());
     return *this;
@@ -87,7 +144,8 @@ namespace fc::codec::cbor {
 
   CborDecodeStream CborDecodeStream::list() {
     if (!isList()) {
-      outcome::raise(CborDecodeError::kWrongType);
+      fail(CborDecodeError::kWrongType);
+      return *this;
     }
     auto stream = container();
     next();
@@ -95,25 +153,28 @@ namespace fc::codec::cbor {
   }
 
   void CborDecodeStream::next() {
+    if (cbor_value_at_end(&value_)) {
+      return fail(CborDecodeError::kInvalidCbor);
+    }
     if (isCid()) {
       if (CborNoError != cbor_value_skip_tag(&value_)) {
-        outcome::raise(CborDecodeError::kInvalidCbor);
+        return fail(CborDecodeError::kInvalidCbor);
       }
     }
     auto remaining = value_.remaining;
     value_.remaining = 1;
     if (CborNoError != cbor_value_advance(&value_)) {
-      outcome::raise(CborDecodeError::kInvalidCbor);
+      return fail(CborDecodeError::kInvalidCbor);
     }
-    if (value_.ptr != parser_->end) {
+    if (value_.ptr != state_->parser.end) {
       remaining += value_.remaining - 1;
       if (CborNoError
           != cbor_parser_init(value_.ptr,
-                              parser_->end - value_.ptr,
+                              state_->parser.end - value_.ptr,
                               0,
-                              parser_.get(),
+                              &state_->parser,
                               &value_)) {
-        outcome::raise(CborDecodeError::kInvalidCbor);
+        return fail(CborDecodeError::kInvalidCbor);
       }
       value_.remaining = remaining;
     }
@@ -156,71 +217,92 @@ namespace fc::codec::cbor {
     return cbor_value_is_byte_string(&value_);
   }
 
-  size_t CborDecodeStream::listLength() const {
+  size_t CborDecodeStream::listLength() {
     if (!isList()) {
-      outcome::raise(CborDecodeError::kWrongType);
+      fail(CborDecodeError::kWrongType);
+      return 0;
     }
     size_t length;
     if (CborNoError != cbor_value_get_array_length(&value_, &length)) {
-      outcome::raise(CborDecodeError::kInvalidCbor);
+      fail(CborDecodeError::kInvalidCbor);
+      return 0;
+    }
+    // each element takes at least one byte, so length can't exceed input
+    if (length > static_cast<size_t>(state_->parser.end - value_.ptr)) {
+      fail(CborDecodeError::kInvalidCbor);
+      return 0;
     }
     return length;
   }
 
   std::vector<uint8_t> CborDecodeStream::raw() {
+    auto view = rawView();
+    return {view.begin(), view.end()};
+  }
+
+  gsl::span<const uint8_t> CborDecodeStream::rawView() {
     auto begin = value_.ptr;
+    // failed next does not move, so view is empty
     next();
-    return {begin, value_.ptr};
+    return gsl::make_span(begin, value_.ptr);
   }
 
   std::map<std::string, CborDecodeStream> CborDecodeStream::map() {
-    if (!cbor_value_is_map(&value_)) {
-      outcome::raise(CborDecodeError::kWrongType);
+    if (!isMap()) {
+      fail(CborDecodeError::kWrongType);
+      return {};
     }
     auto stream = container();
     next();
     std::map<std::string, CborDecodeStream> map;
-    std::string key;
-    const uint8_t *begin;
     while (!cbor_value_at_end(&stream.value_)) {
-      stream >> key;
-      begin = stream.value_.ptr;
-      auto stream2 = stream;
-      stream2.parser_ = std::make_shared<CborParser>();
-      if (CborNoError != cbor_value_skip_tag(&stream.value_)) {
-        outcome::raise(CborDecodeError::kInvalidCbor);
-      }
-      if (CborNoError != cbor_value_advance(&stream.value_)) {
-        outcome::raise(CborDecodeError::kInvalidCbor);
-      }
-      if (CborNoError
-          != cbor_parser_init(begin,
-                              stream.value_.ptr - begin,
-                              0,
-                              stream2.parser_.get(),
-                              &stream2.value_)) {
-        outcome::raise(CborDecodeError::kInvalidCbor);
-      }
-      map.insert(std::make_pair(key, stream2));
+      auto key = stream.strView();
+      map.emplace(key, stream.element());
+      stream.next();
     }
     return map;
   }
 
-  size_t CborDecodeStream::bytesLength() const {
-    if (!cbor_value_is_byte_string(&value_)) {
-      outcome::raise(CborDecodeError::kWrongType);
+  boost::optional<CborDecodeStream> CborDecodeStream::mapFind(
+      std::string_view key) {
+    if (!isMap()) {
+      fail(CborDecodeError::kWrongType);
+      return boost::none;
+    }
+    auto stream = container();
+    while (!cbor_value_at_end(&stream.value_)) {
+      if (stream.strView() == key) {
+        return stream.element();
+      }
+      stream.next();
+    }
+    return boost::none;
+  }
+
+  size_t CborDecodeStream::bytesLength() {
+    if (!isBytes()) {
+      fail(CborDecodeError::kWrongType);
+      return 0;
     }
     size_t size;
     if (CborNoError != cbor_value_get_string_length(&value_, &size)) {
-      outcome::raise(CborDecodeError::kInvalidCbor);
+      fail(CborDecodeError::kInvalidCbor);
+      return 0;
     }
     return size;
   }
 
-  CborDecodeStream CborDecodeStream::container() const {
+  CborDecodeStream CborDecodeStream::element() const {
+    auto stream = *this;
+    stream.value_.remaining = 1;
+    return stream;
+  }
+
+  CborDecodeStream CborDecodeStream::container() {
     auto stream = *this;
     if (CborNoError != cbor_value_enter_container(&value_, &stream.value_)) {
-      outcome::raise(CborDecodeError::kInvalidCbor);
+      fail(CborDecodeError::kInvalidCbor);
+      return *this;
     }
     return stream;
   }
@@ -8,6 +8,7 @@
 
 #include "codec/cbor/cbor_common.hpp"
 
+#include <string_view>
 #include <vector>
 
 #include <cbor.h>
@@ -23,6 +24,18 @@ namespace fc::codec::cbor {
 
     explicit CborDecodeStream(gsl::span<const uint8_t> data);
 
+    /**
+     * Creates stream reading data without copying it, data must outlive
+     * stream and its substreams
+     * @param nothrow - decode errors are recorded instead of thrown, failed
+     * stream is at end and reads from it fail, see error()
+     */
+    static CborDecodeStream borrow(gsl::span<const uint8_t> data,
+                                   bool nothrow = false);
+
+    /// First error recorded by nothrow stream or its substreams
+    const std::error_code &error() const;
+
     /** Decodes integer or bool */
     template <
         typename T,
@@ -36,23 +49,27 @@ namespace fc::codec::cbor {
       }
       if constexpr (std::is_same_v<T, bool>) {
         if (!cbor_value_is_boolean(&value_)) {
-          outcome::raise(CborDecodeError::kWrongType);
+          fail(CborDecodeError::kWrongType);
+          return *this;
         }
         bool bool_value;
         cbor_value_get_boolean(&value_, &bool_value);
         num = bool_value;
       } else {
         if (!cbor_value_is_integer(&value_)) {
-          outcome::raise(CborDecodeError::kWrongType);
+          fail(CborDecodeError::kWrongType);
+          return *this;
         }
         if constexpr (std::is_unsigned_v<T>) {
           if (!cbor_value_is_unsigned_integer(&value_)) {
-            outcome::raise(CborDecodeError::kIntOverflow);
+            fail(CborDecodeError::kIntOverflow);
+            return *this;
           }
           uint64_t num64;
           cbor_value_get_uint64(&value_, &num64);
           if (num64 > std::numeric_limits<T>::max()) {
-            outcome::raise(CborDecodeError::kIntOverflow);
+            fail(CborDecodeError::kIntOverflow);
+            return *this;
           }
           num = static_cast<T>(num64);
         } else {
@@ -60,7 +77,8 @@ namespace fc::codec::cbor {
           cbor_value_get_int64(&value_, &num64);
           if (num64 > static_cast<int64_t>(std::numeric_limits<T>::max())
               || num64 < static_cast<int64_t>(std::numeric_limits<T>::min())) {
-            outcome::raise(CborDecodeError::kIntOverflow);
+            fail(CborDecodeError::kIntOverflow);
+            return *this;
           }
           num = static_cast<T>(num64);
         }
@@ -83,6 +101,31 @@ namespace fc::codec::cbor {
       return *this;
     }
 
+    /**
+     * Decodes list elements in place with decode reading from this stream,
+     * then skips list
+     */
+    template <typename F>
+    CborDecodeStream &tuple(const F &decode) {
+      if (!isList()) {
+        fail(CborDecodeError::kWrongType);
+        return *this;
+      }
+      auto list{value_};
+      if (CborNoError != cbor_value_enter_container(&list, &value_)) {
+        fail(CborDecodeError::kInvalidCbor);
+        return *this;
+      }
+      decode();
+      // failed nothrow stream stays at end
+      if (state_->error) {
+        return *this;
+      }
+      value_ = list;
+      next();
+      return *this;
+    }
+
     /// Decodes list elements into vector
     template <typename T>
     CborDecodeStream &operator>>(std::vector<T> &values) {
@@ -113,6 +156,10 @@ namespace fc::codec::cbor {
     CborDecodeStream &operator>>(std::vector<uint8_t> &bytes);
     /** Decodes string */
     CborDecodeStream &operator>>(std::string &str);
+    /** Returns view of bytes in input (and advances to the next element) */
+    gsl::span<const uint8_t> bytesView();
+    /** Returns view of string in input (and advances to the next element) */
+    std::string_view strView();
     /** Decodes CID */
     CborDecodeStream &operator>>(CID &cid);
     /** Creates list container decode substream */
@@ -131,20 +178,42 @@ namespace fc::codec::cbor {
     bool isStr() const;
     bool isBytes() const;
     /** Returns count of items in current element list container */
-    size_t listLength() const;
+    size_t listLength();
     /** Reads CBOR bytes of current element (and advances to the next element)
      */
     std::vector<uint8_t> raw();
+    /** Returns view of CBOR bytes of current element in input (and advances
+     * to the next element) */
+    gsl::span<const uint8_t> rawView();
     /** Creates map container decode substream map */
     std::map<std::string, CborDecodeStream> map();
+    /** Finds value of key in current element map container by scanning
+     * entries, does not advance */
+    boost::optional<CborDecodeStream> mapFind(std::string_view key);
     /// Returns bytestring length
-    size_t bytesLength() const;
+    size_t bytesLength();
 
    private:
-    CborDecodeStream container() const;
+    /// Parser and error shared by all substreams of top-level stream
+    struct State {
+      CborParser parser{};
+      bool nothrow{false};
+      std::error_code error;
+    };
+
+    CborDecodeStream() = default;
+    void init(gsl::span<const uint8_t> data, bool nothrow);
+    /// Raises error, or records it and moves stream to end if nothrow
+    void fail(CborDecodeError error);
+    CborDecodeStream container();
+    /// Returns payload of definite length byte string or text string
+    gsl::span<const uint8_t> stringView();
+    /// Substream of single current element, shares parser
+    CborDecodeStream element() const;
 
+    /// Owned copy of input, null if input is borrowed
     std::shared_ptr<std::vector<uint8_t>> data_;
-    std::shared_ptr<CborParser> parser_;
+    std::shared_ptr<State> state_;
     CborValue value_{};
   };
 }  // namespace fc::codec::cbor
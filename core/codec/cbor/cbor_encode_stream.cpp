@@ -6,6 +6,50 @@
 #include "codec/cbor/cbor_encode_stream.hpp"
 
 namespace fc::codec::cbor {
+  namespace {
+    constexpr uint8_t kBytesType{2};
+    constexpr uint8_t kStringType{3};
+    constexpr uint8_t kListType{4};
+    constexpr uint8_t kMapType{5};
+    constexpr uint8_t kTagType{6};
+    constexpr uint8_t kNull{0xF6};
+
+    using Head = std::array<uint8_t, 9>;
+
+    /// Encodes head of major type with argument, returns head size
+    size_t encodeHead(Head &head, uint8_t type, uint64_t value) {
+      type <<= 5;
+      if (value < 24) {
+        head[0] = type | value;
+        return 1;
+      }
+      size_t bytes{8};
+      uint8_t info{27};
+      if (value <= UINT8_MAX) {
+        bytes = 1;
+        info = 24;
+      } else if (value <= UINT16_MAX) {
+        bytes = 2;
+        info = 25;
+      } else if (value <= UINT32_MAX) {
+        bytes = 4;
+        info = 26;
+      }
+      head[0] = type | info;
+      for (size_t i{0}; i < bytes; ++i) {
+        head[bytes - i] = value >> (8 * i);
+      }
+      return bytes + 1;
+    }
+
+    void addHead(std::vector<uint8_t> &out, uint8_t type, uint64_t value) {
+      Head head;
+      out.insert(out.end(),
+                 head.begin(),
+                 head.begin() + encodeHead(head, type, value));
+    }
+  }  // namespace
+
   CborEncodeStream &CborEncodeStream::operator<<(
       const std::vector<uint8_t> &bytes) {
     return *this << gsl::make_span(bytes);
@@ -14,29 +58,15 @@ namespace fc::codec::cbor {
   CborEncodeStream &CborEncodeStream::operator<<(
       gsl::span<const uint8_t> bytes) {
     addCount(1);
-
-    std::vector<uint8_t> encoded(9 + bytes.size());
-    CborEncoder encoder;
-    cbor_encoder_init(&encoder, encoded.data(), encoded.size(), 0);
-    cbor_encode_byte_string(&encoder, bytes.data(), bytes.size());
-    data_.insert(data_.end(),
-                 encoded.begin(),
-                 encoded.begin()
-                     + cbor_encoder_get_buffer_size(&encoder, encoded.data()));
+    addHead(data_, kBytesType, bytes.size());
+    data_.insert(data_.end(), bytes.begin(), bytes.end());
     return *this;
   }
 
   CborEncodeStream &CborEncodeStream::operator<<(const std::string &str) {
     addCount(1);
-
-    std::vector<uint8_t> encoded(9 + str.size());
-    CborEncoder encoder;
-    cbor_encoder_init(&encoder, encoded.data(), encoded.size(), 0);
-    cbor_encode_text_string(&encoder, str.data(), str.size());
-    data_.insert(data_.end(),
-                 encoded.begin(),
-                 encoded.begin()
-                     + cbor_encoder_get_buffer_size(&encoder, encoded.data()));
+    addHead(data_, kStringType, str.size());
+    data_.insert(data_.end(), str.begin(), str.end());
     return *this;
   }
 
@@ -45,26 +75,31 @@ namespace fc::codec::cbor {
     if (maybe_cid_bytes.has_error()) {
       outcome::raise(CborEncodeError::kInvalidCID);
     }
-    auto cid_bytes = maybe_cid_bytes.value();
-    cid_bytes.insert(cid_bytes.begin(), 0);
-
-    std::array<uint8_t, 9> encoded{0};
-    CborEncoder encoder;
-    cbor_encoder_init(&encoder, encoded.data(), encoded.size(), 0);
-    cbor_encode_tag(&encoder, kCidTag);
-    data_.insert(data_.end(),
-                 encoded.begin(),
-                 encoded.begin()
-                     + cbor_encoder_get_buffer_size(&encoder, encoded.data()));
-    *this << cid_bytes;
+    auto &cid_bytes = maybe_cid_bytes.value();
+
+    addCount(1);
+    addHead(data_, kTagType, kCidTag);
+    // multibase identity prefix
+    addHead(data_, kBytesType, cid_bytes.size() + 1);
+    data_.push_back(0);
+    data_.insert(data_.end(), cid_bytes.begin(), cid_bytes.end());
     return *this;
   }
 
   CborEncodeStream &CborEncodeStream::operator<<(
       const CborEncodeStream &other) {
     addCount(other.is_list_ ? 1 : other.count_);
-    auto other_data = other.data();
-    data_.insert(data_.end(), other_data.begin(), other_data.end());
+    other.appendTo(data_);
+    return *this;
+  }
+
+  CborEncodeStream &CborEncodeStream::operator<<(CborEncodeStream &&other) {
+    if (is_list_ || !data_.empty()) {
+      return *this << static_cast<const CborEncodeStream &>(other);
+    }
+    other.finishList();
+    data_ = std::move(other.data_);
+    count_ = other.count_;
     return *this;
   }
 
@@ -82,28 +117,22 @@ namespace fc::codec::cbor {
   CborEncodeStream &CborEncodeStream::operator<<(
       const std::map<std::string, CborEncodeStream> &map) {
     addCount(1);
+    addHead(data_, kMapType, map.size());
 
-    std::array<uint8_t, 9> prefix{0};
-    CborEncoder encoder;
-    CborEncoder container;
-    cbor_encoder_init(&encoder, prefix.data(), prefix.size(), 0);
-    cbor_encoder_create_map(&encoder, &container, map.size());
-    data_.insert(data_.end(),
-                 prefix.begin(),
-                 prefix.begin()
-                     + cbor_encoder_get_buffer_size(&container, prefix.data()));
-
-    std::map<std::vector<uint8_t>, std::vector<uint8_t>, LessCborKey> sorted;
+    std::map<std::vector<uint8_t>, const CborEncodeStream *, LessCborKey>
+        sorted;
     for (const auto &pair : map) {
       if (pair.second.count_ != 1) {
         outcome::raise(CborEncodeError::kExpectedMapValueSingle);
       }
-      sorted.insert(std::make_pair((CborEncodeStream() << pair.first).data(),
-                                   pair.second.data()));
+      std::vector<uint8_t> key;
+      addHead(key, kStringType, pair.first.size());
+      key.insert(key.end(), pair.first.begin(), pair.first.end());
+      sorted.emplace(std::move(key), &pair.second);
     }
     for (const auto &pair : sorted) {
       data_.insert(data_.end(), pair.first.begin(), pair.first.end());
-      data_.insert(data_.end(), pair.second.begin(), pair.second.end());
+      pair.second->appendTo(data_);
     }
 
     return *this;
@@ -111,38 +140,29 @@ namespace fc::codec::cbor {
 
   CborEncodeStream &CborEncodeStream::operator<<(std::nullptr_t) {
     addCount(1);
-
-    std::array<uint8_t, 1> prefix{0};
-    CborEncoder encoder;
-    cbor_encoder_init(&encoder, prefix.data(), prefix.size(), 0);
-    cbor_encode_null(&encoder);
-    data_.insert(
-        data_.end(),
-        prefix.begin(),
-        prefix.begin() + cbor_encoder_get_buffer_size(&encoder, prefix.data()));
+    data_.push_back(kNull);
     return *this;
   }
 
-  std::vector<uint8_t> CborEncodeStream::data() const {
+  std::vector<uint8_t> CborEncodeStream::data() const & {
     if (!is_list_) {
       return data_;
     }
-    std::array<uint8_t, 9> prefix{0};
-    CborEncoder encoder;
-    CborEncoder container;
-    cbor_encoder_init(&encoder, prefix.data(), prefix.size(), 0);
-    cbor_encoder_create_array(&encoder, &container, count_);
-    std::vector<uint8_t> result(
-        prefix.begin(),
-        prefix.begin()
-            + cbor_encoder_get_buffer_size(&container, prefix.data()));
-    result.insert(result.end(), data_.begin(), data_.end());
+    std::vector<uint8_t> result;
+    result.reserve(data_.size() + 8);
+    appendTo(result);
     return result;
   }
 
+  std::vector<uint8_t> CborEncodeStream::data() && {
+    finishList();
+    return std::move(data_);
+  }
+
   CborEncodeStream CborEncodeStream::list() {
     CborEncodeStream stream;
     stream.is_list_ = true;
+    stream.data_.push_back(0);
     return stream;
   }
 
@@ -161,4 +181,28 @@ namespace fc::codec::cbor {
   void CborEncodeStream::addCount(size_t count) {
     count_ += count;
   }
+
+  void CborEncodeStream::appendTo(std::vector<uint8_t> &out) const {
+    if (!is_list_) {
+      out.insert(out.end(), data_.begin(), data_.end());
+      return;
+    }
+    addHead(out, kListType, count_);
+    out.insert(out.end(), data_.begin() + 1, data_.end());
+  }
+
+  void CborEncodeStream::finishList() {
+    if (!is_list_) {
+      return;
+    }
+    Head head;
+    auto size{encodeHead(head, kListType, count_)};
+    // bigger head shifts elements once, lists of less than 24 fit in place
+    if (size > 1) {
+      data_.insert(data_.begin() + 1, size - 1, 0);
+    }
+    std::copy_n(head.begin(), size, data_.begin());
+    is_list_ = false;
+    count_ = 1;
+  }
 }  // namespace fc::codec::cbor
@@ -65,7 +65,7 @@ namespace fc::codec::cbor {
       for (auto &value : values) {
         l << value;
       }
-      return *this << l;
+      return *this << std::move(l);
     }
 
     /// Encodes elements into map
@@ -90,6 +90,22 @@ namespace fc::codec::cbor {
       return *this << gsl::make_span(values);
     }
 
+    /**
+     * Encodes list of fixed size in place, head is known at compile time and
+     * elements are written by encode directly into this stream
+     * @tparam size - count of elements written by encode
+     */
+    template <size_t size, typename F>
+    CborEncodeStream &tuple(const F &encode) {
+      static_assert(size < 24, "head of tuple must fit single byte");
+      addCount(1);
+      auto count{count_};
+      data_.push_back(kTupleHead | size);
+      encode();
+      count_ = count;
+      return *this;
+    }
+
     /** Encodes bytes */
     CborEncodeStream &operator<<(const std::vector<uint8_t> &bytes);
     /** Encodes bytes */
@@ -100,13 +116,20 @@ namespace fc::codec::cbor {
     CborEncodeStream &operator<<(const CID &cid);
     /** Encodes list container encode substream */
     CborEncodeStream &operator<<(const CborEncodeStream &other);
+    /**
+     * Encodes list container encode substream, empty stream takes bytes of
+     * substream without copying
+     */
+    CborEncodeStream &operator<<(CborEncodeStream &&other);
     /** Encodes map container encode substream map */
     CborEncodeStream &operator<<(
         const std::map<std::string, CborEncodeStream> &map);
     /** Encodes null */
     CborEncodeStream &operator<<(std::nullptr_t);
     /** Returns CBOR bytes of encoded elements */
-    std::vector<uint8_t> data() const;
+    std::vector<uint8_t> data() const &;
+    /** Returns CBOR bytes of encoded elements, moving them out of stream */
+    std::vector<uint8_t> data() &&;
     /** Creates list container encode substream */
     static CborEncodeStream list();
     /** Creates map container encode substream map */
@@ -115,9 +138,20 @@ namespace fc::codec::cbor {
     static CborEncodeStream wrap(gsl::span<const uint8_t> data, size_t count);
 
    private:
+    /// Major type of list, without argument
+    static constexpr uint8_t kTupleHead{0x80};
+
     void addCount(size_t count);
+    /// Appends encoded elements, with list head if stream is list
+    void appendTo(std::vector<uint8_t> &out) const;
+    /// Writes list head into reserved byte, stream becomes single element
+    void finishList();
 
     bool is_list_{false};
+    /**
+     * Encoded elements. List reserves first byte for head, which is written
+     * when count is known, so elements are encoded in place.
+     */
     std::vector<uint8_t> data_{};
     size_t count_{0};
   };
@@ -6,6 +6,8 @@
 #ifndef CPP_FILECOIN_STREAMS_ANNOTATION_HPP
 #define CPP_FILECOIN_STREAMS_ANNOTATION_HPP
 
+#include <utility>
+
 #define CBOR_ENCODE(type, var)                                            \
   template <class Stream,                                                 \
             typename = std::enable_if_t<                                  \
@@ -69,18 +71,34 @@
                 _CBOR_TUPLE_1)  \
   (op, __VA_ARGS__)
 
-#define CBOR_ENCODE_TUPLE(T, ...)                        \
-  CBOR_ENCODE(T, t) {                                    \
-    return s << (s.list() _CBOR_TUPLE(<<, __VA_ARGS__)); \
+#define _CBOR_TUPLE_SIZE(...) \
+  _CBOR_TUPLE_V(                \
+      __VA_ARGS__, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+
+/// Fields are written into stream after tuple head, without substream
+#define CBOR_ENCODE_TUPLE(T, ...)                            \
+  CBOR_ENCODE(T, t) {                                        \
+    return s.template tuple<_CBOR_TUPLE_SIZE(__VA_ARGS__)>(  \
+        [&] { s _CBOR_TUPLE(<<, __VA_ARGS__); });            \
   }
 
-#define CBOR_TUPLE(T, ...)                 \
-  CBOR_ENCODE_TUPLE(T, __VA_ARGS__)        \
-  CBOR_DECODE(T, t) {                      \
-    s.list() _CBOR_TUPLE(>>, __VA_ARGS__); \
-    return s;                              \
+/**
+ * Passes tuple fields of object into stream-like visitor in tuple order,
+ * so tuple elements can be mapped to fields
+ */
+#define CBOR_TUPLE_FIELDS(T, ...)                    \
+  template <typename Fields>                         \
+  void cborTupleFields(T &t, Fields &&s) {           \
+    s _CBOR_TUPLE(<<, __VA_ARGS__);                  \
   }
 
+#define CBOR_TUPLE(T, ...)                                         \
+  CBOR_ENCODE_TUPLE(T, __VA_ARGS__)                                \
+  CBOR_DECODE(T, t) {                                              \
+    return s.tuple([&] { s _CBOR_TUPLE(>>, __VA_ARGS__); });       \
+  }                                                                \
+  CBOR_TUPLE_FIELDS(T, __VA_ARGS__)
+
 namespace fc::codec::cbor {
   /**
    * Default value for CBORed value instantiation
@@ -27,14 +27,28 @@ namespace fc::codec::rle {
   }
 
   /**
-   * @brief RLE+ decode
-   * @tparam T - type of elements to decode
+   * @brief RLE+ encode runs
+   * @tparam T - type of elements to encode
+   * @param runs - sorted, not overlapping and not adjacent half-open
+   * intervals [first, second) of elements
+   * @return Encoded byte-vector
+   */
+  template <typename T>
+  std::vector<uint8_t> encode(const std::vector<std::pair<T, T>> &runs) {
+    RLEPlusEncodingStream encoder;
+    encoder << runs;
+    return encoder.data();
+  }
+
+  /**
+   * @brief RLE+ decode into set or runs
+   * @tparam Output - std::set or std::vector of runs
    * @param input - data to decode
    * @return Decoded data
    */
-  template <typename T>
-  outcome::result<std::set<T>> decode(gsl::span<const uint8_t> input) {
-    std::set<T> data;
+  template <typename Output>
+  outcome::result<Output> decodeInto(gsl::span<const uint8_t> input) {
+    Output data;
     RLEPlusDecodingStream decoder(input);
     try {
       decoder >> data;
@@ -49,6 +63,30 @@ namespace fc::codec::rle {
     }
     return data;
   }
+
+  /**
+   * @brief RLE+ decode
+   * @tparam T - type of elements to decode
+   * @param input - data to decode
+   * @return Decoded data
+   */
+  template <typename T>
+  outcome::result<std::set<T>> decode(gsl::span<const uint8_t> input) {
+    return decodeInto<std::set<T>>(input);
+  }
+
+  /**
+   * @brief RLE+ decode runs, sorted, not overlapping and not adjacent
+   * half-open intervals [first, second) of elements
+   * @tparam T - type of elements to decode
+   * @param input - data to decode
+   * @return Decoded runs
+   */
+  template <typename T>
+  outcome::result<std::vector<std::pair<T, T>>> decodeRuns(
+      gsl::span<const uint8_t> input) {
+    return decodeInto<std::vector<std::pair<T, T>>>(input);
+  }
 };  // namespace fc::codec::rle
 
 #endif
@@ -0,0 +1,116 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_CODEC_RLE_RLE_PLUS_BITS_HPP
+#define CPP_FILECOIN_CORE_CODEC_RLE_RLE_PLUS_BITS_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <gsl/span>
+
+#include "codec/rle/rle_plus_errors.hpp"
+
+namespace fc::codec::rle {
+  /**
+   * Reads fields of bits, least significant bit of byte first.
+   * Bytes are loaded into 64-bit word, so field is read with single shift.
+   */
+  class BitReader {
+   public:
+    explicit BitReader(gsl::span<const uint8_t> data) : data_{data} {
+      auto last{data_.size()};
+      while (last != 0 && data_[last - 1] == 0) {
+        --last;
+      }
+      if (last != 0) {
+        auto byte{data_[last - 1]};
+        end_ = (last - 1) * 8;
+        while (byte != 0) {
+          ++end_;
+          byte >>= 1;
+        }
+      }
+    }
+
+    /// Total count of bits
+    size_t size() const {
+      return data_.size() * 8;
+    }
+
+    /// Whether set bit follows, padding after last set bit is ignored
+    bool more() const {
+      return read_ < end_;
+    }
+
+    /// Reads field of count bits, no more than 57
+    uint64_t take(size_t count) {
+      if (read_ + count > size()) {
+        throw errors::IndexOutOfBound();
+      }
+      while (bits_ < count) {
+        word_ |= static_cast<uint64_t>(data_[next_++]) << bits_;
+        bits_ += 8;
+      }
+      auto value{word_ & ((uint64_t{1} << count) - 1)};
+      word_ >>= count;
+      bits_ -= count;
+      read_ += count;
+      return value;
+    }
+
+   private:
+    gsl::span<const uint8_t> data_;
+    /// Next byte to load into word
+    size_t next_{};
+    uint64_t word_{};
+    /// Count of loaded but not read bits in word
+    size_t bits_{};
+    size_t read_{};
+    /// Position after last set bit
+    size_t end_{};
+  };
+
+  /**
+   * Writes fields of bits, least significant bit of byte first.
+   * Fields are collected into 64-bit word, which is flushed by whole bytes.
+   */
+  class BitWriter {
+   public:
+    /// Writes field of count bits, no more than 57
+    void put(uint64_t value, size_t count) {
+      word_ |= value << bits_;
+      bits_ += count;
+      while (bits_ >= 8) {
+        bytes_.push_back(static_cast<uint8_t>(word_));
+        word_ >>= 8;
+        bits_ -= 8;
+      }
+    }
+
+    void clear() {
+      bytes_.clear();
+      word_ = 0;
+      bits_ = 0;
+    }
+
+    /// Written bytes, last byte is padded with zero bits
+    std::vector<uint8_t> data() const {
+      auto bytes{bytes_};
+      if (bits_ != 0) {
+        bytes.push_back(static_cast<uint8_t>(word_));
+      }
+      return bytes;
+    }
+
+   private:
+    std::vector<uint8_t> bytes_;
+    uint64_t word_{};
+    /// Count of bits in word
+    size_t bits_{};
+  };
+}  // namespace fc::codec::rle
+
+#endif  // CPP_FILECOIN_CORE_CODEC_RLE_RLE_PLUS_BITS_HPP
@@ -8,14 +8,10 @@
 namespace fc::codec::rle {
   void RLEPlusEncodingStream::initContent() {
     content_.clear();
-    content_.push_back(false);
-    content_.push_back(false);
+    content_.put(0, 2);
   }
 
   void RLEPlusEncodingStream::pushByte(uint8_t byte) {
-    for (size_t i = 0; i < BYTE_BITS_COUNT; ++i) {
-      bool bit = static_cast<bool>((byte & (1 << i)) >> i);
-      content_.push_back(bit);
-    }
+    content_.put(byte, BYTE_BITS_COUNT);
   }
 }  // namespace fc::codec::rle
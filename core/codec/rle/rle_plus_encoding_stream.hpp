@@ -9,8 +9,7 @@
 #include <vector>
 #include <set>
 
-#include <boost/dynamic_bitset.hpp>
-
+#include "codec/rle/rle_plus_bits.hpp"
 #include "codec/rle/rle_plus_config.hpp"
 
 namespace fc::codec::rle {
@@ -28,19 +27,29 @@ namespace fc::codec::rle {
      */
     template <typename T, typename A>
     RLEPlusEncodingStream &operator<<(const std::set<T, A> &input) {
-      std::vector<T> periods = this->getPeriods(input);
-      this->initContent();
       bool flag = false;
       if (!input.empty()) flag = *input.begin() == 0;
-      content_.push_back(flag);
-      for (const auto &value : periods) {
-        if (value == 1) {
-          content_.push_back(true);
-        } else if (value < LONG_BLOCK_VALUE) {
-          this->pushSmallBlock(value);
-        } else if (value >= LONG_BLOCK_VALUE) {
-          this->pushLongBlock(value);
-        }
+      this->pushPeriods(flag, this->getPeriods(input));
+      return *this;
+    }
+
+    /**
+     * @brief Encode integer set given as runs
+     * @tparam T - type of integer
+     * @param runs - sorted, not overlapping and not adjacent half-open
+     * intervals [first, second) of integers in the set
+     * @return Encoded stream
+     */
+    template <typename T>
+    RLEPlusEncodingStream &operator<<(
+        const std::vector<std::pair<T, T>> &runs) {
+      this->initContent();
+      content_.put(!runs.empty() && runs.front().first == 0, 1);
+      T prev = 0;
+      for (const auto &run : runs) {
+        if (run.first != prev) this->pushPeriod(run.first - prev);
+        this->pushPeriod(run.second - run.first);
+        prev = run.second;
       }
       return *this;
     }
@@ -50,14 +59,11 @@ namespace fc::codec::rle {
      * @return Stream content
      */
     std::vector<uint8_t> data() const {
-      std::vector<uint8_t> data_content;
-      data_content.reserve(content_.num_blocks());
-      boost::to_block_range(content_, std::back_inserter(data_content));
-      return data_content;
+      return content_.data();
     }
 
    private:
-    boost::dynamic_bitset<uint8_t> content_{}; /**< RLE+ encoded content */
+    BitWriter content_{}; /**< RLE+ encoded content */
 
     /**
      * @brief Write RLE+ header
@@ -71,11 +77,8 @@ namespace fc::codec::rle {
      */
     template <typename T>
     void pushSmallBlock(const T block) {
-      content_.push_back(false);
-      content_.push_back(true);
-      for (size_t i = 0; i < SMALL_BLOCK_LENGTH; ++i) {
-        content_.push_back((block & (1 << i)) >> i);
-      }
+      content_.put(0b10, 2);
+      content_.put(block, SMALL_BLOCK_LENGTH);
     }
 
     /**
@@ -87,8 +90,7 @@ namespace fc::codec::rle {
     void pushLongBlock(const T block) {
       uint8_t byte{};
       T slice = block;
-      content_.push_back(false);
-      content_.push_back(false);
+      content_.put(0, 2);
       while (slice >= BYTE_SLICE_VALUE) {
         byte = slice | BYTE_SLICE_VALUE;
         this->pushByte(byte);
@@ -97,6 +99,37 @@ namespace fc::codec::rle {
       this->pushByte(static_cast<uint8_t>(slice));
     }
 
+    /**
+     * @brief Write RLE+ header and blocks
+     * @tparam T - type of block value
+     * @param flag - whether first period is of set integers
+     * @param periods - lengths of alternating set and unset periods
+     */
+    template <typename T>
+    void pushPeriods(bool flag, const std::vector<T> &periods) {
+      this->initContent();
+      content_.put(flag, 1);
+      for (const auto &value : periods) {
+        this->pushPeriod(value);
+      }
+    }
+
+    /**
+     * @brief Write RLE+ block of period length
+     * @tparam T - type of block value
+     * @param value - period length
+     */
+    template <typename T>
+    void pushPeriod(const T value) {
+      if (value == 1) {
+        content_.put(1, 1);
+      } else if (value < LONG_BLOCK_VALUE) {
+        this->pushSmallBlock(value);
+      } else {
+        this->pushLongBlock(value);
+      }
+    }
+
     /**
      * @brief Write various byte
      * @param byte - content to write
@@ -0,0 +1,94 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_COMMON_ARENA_HPP
+#define CPP_FILECOIN_CORE_COMMON_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace fc::common {
+
+  /**
+   * Monotonic arena, allocates from chunks and frees them all at once.
+   * Objects allocated from arena must be destroyed before arena.
+   * Not thread-safe.
+   */
+  class Arena {
+   public:
+    explicit Arena(size_t chunk_size = 64 << 10) : chunk_size_{chunk_size} {}
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t size, size_t align) {
+      auto offset{(used_ + align - 1) & ~(align - 1)};
+      if (chunks_.empty() || offset + size > capacity_) {
+        capacity_ = std::max(chunk_size_, size + align);
+        chunks_.emplace_back(new uint8_t[capacity_]);
+        auto begin{reinterpret_cast<uintptr_t>(chunks_.back().get())};
+        offset = ((begin + align - 1) & ~(align - 1)) - begin;
+      }
+      used_ = offset + size;
+      allocated_ += size;
+      return chunks_.back().get() + offset;
+    }
+
+    /// Frees all chunks
+    void release() {
+      chunks_.clear();
+      capacity_ = 0;
+      used_ = 0;
+      allocated_ = 0;
+    }
+
+    /// Bytes allocated since construction or release
+    size_t allocated() const {
+      return allocated_;
+    }
+
+   private:
+    size_t chunk_size_;
+    std::vector<std::unique_ptr<uint8_t[]>> chunks_;
+    /// Size of last chunk
+    size_t capacity_{};
+    /// Used bytes of last chunk
+    size_t used_{};
+    size_t allocated_{};
+  };
+
+  /// Allocator of arena, deallocation is no-op
+  template <typename T>
+  struct ArenaAllocator {
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena &arena) : arena{&arena} {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena{other.arena} {}
+
+    T *allocate(size_t n) {
+      return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, size_t) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const {
+      return arena == other.arena;
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const {
+      return arena != other.arena;
+    }
+
+    Arena *arena;
+  };
+}  // namespace fc::common
+
+#endif  // CPP_FILECOIN_CORE_COMMON_ARENA_HPP
@@ -0,0 +1,112 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/async_log_sink.hpp"
+
+#include <spdlog/details/log_msg.h>
+
+namespace fc::common {
+  /// Writer checks queue at least this often, wakeup may be missed
+  constexpr std::chrono::milliseconds kIdleWait{5};
+
+  AsyncLogSink::AsyncLogSink(std::shared_ptr<spdlog::sinks::sink> target,
+                             size_t queue_size)
+      : target_{std::move(target)}, queue_{queue_size} {
+    thread_ = std::thread{[this] { run(); }};
+  }
+
+  AsyncLogSink::~AsyncLogSink() {
+    {
+      std::lock_guard lock{mutex_};
+      stopped_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+  }
+
+  void AsyncLogSink::log(const spdlog::details::log_msg &msg) {
+    Record record{
+        {msg.logger_name.data(), msg.logger_name.size()},
+        {msg.payload.data(), msg.payload.size()},
+        msg.level,
+        msg.time,
+        msg.thread_id,
+        msg.source,
+    };
+    if (!queue_.push(std::move(record))) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    // notified without lock, writer wakes on timeout if notify is missed
+    if (sleeping_.load(std::memory_order_acquire)) {
+      cv_.notify_one();
+    }
+  }
+
+  void AsyncLogSink::flush() {
+    flush_.store(true, std::memory_order_release);
+    cv_.notify_one();
+  }
+
+  void AsyncLogSink::set_pattern(const std::string &pattern) {
+    target_->set_pattern(pattern);
+  }
+
+  void AsyncLogSink::set_formatter(
+      std::unique_ptr<spdlog::formatter> formatter) {
+    target_->set_formatter(std::move(formatter));
+  }
+
+  uint64_t AsyncLogSink::dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  void AsyncLogSink::write(const Record &record) {
+    spdlog::details::log_msg msg{
+        record.source, record.logger, record.level, record.payload};
+    msg.time = record.time;
+    msg.thread_id = record.thread_id;
+    target_->log(msg);
+  }
+
+  void AsyncLogSink::run() {
+    uint64_t reported{0};
+    Record record;
+    while (true) {
+      while (queue_.pop(record)) {
+        write(record);
+      }
+      if (auto dropped{dropped_.load(std::memory_order_relaxed)};
+          dropped != reported) {
+        auto text{"dropped " + std::to_string(dropped - reported)
+                  + " log messages, queue is full"};
+        reported = dropped;
+        write({"logger",
+               text,
+               spdlog::level::warn,
+               spdlog::log_clock::now(),
+               0,
+               {}});
+      }
+      if (flush_.exchange(false, std::memory_order_acq_rel)) {
+        target_->flush();
+      }
+      std::unique_lock lock{mutex_};
+      if (stopped_) {
+        if (queue_.empty()) {
+          break;
+        }
+        continue;
+      }
+      sleeping_.store(true, std::memory_order_release);
+      cv_.wait_for(lock, kIdleWait, [&] {
+        return stopped_ || !queue_.empty()
+               || flush_.load(std::memory_order_acquire);
+      });
+      sleeping_.store(false, std::memory_order_release);
+    }
+    target_->flush();
+  }
+}  // namespace fc::common
@@ -0,0 +1,71 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_COMMON_ASYNC_LOG_SINK_HPP
+#define CPP_FILECOIN_CORE_COMMON_ASYNC_LOG_SINK_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <spdlog/sinks/sink.h>
+
+#include "common/bounded_queue.hpp"
+
+namespace fc::common {
+  /**
+   * Sink passing messages to target sink on own writer thread.
+   * Logging thread only formats message text and pushes it to lock-free
+   * queue, pattern formatting and output happen on writer. Messages are
+   * dropped when queue is full, so logging never blocks, writer reports
+   * count of dropped ones. Flush is done by writer after queued messages.
+   */
+  class AsyncLogSink : public spdlog::sinks::sink {
+   public:
+    static constexpr size_t kQueueSizeDefault{1 << 16};
+
+    AsyncLogSink(std::shared_ptr<spdlog::sinks::sink> target,
+                 size_t queue_size = kQueueSizeDefault);
+    /// Writes queued messages and stops writer
+    ~AsyncLogSink() override;
+
+    void log(const spdlog::details::log_msg &msg) override;
+
+    void flush() override;
+
+    void set_pattern(const std::string &pattern) override;
+
+    void set_formatter(std::unique_ptr<spdlog::formatter> formatter) override;
+
+    /// Messages dropped because queue was full
+    uint64_t dropped() const;
+
+   private:
+    /// Copy of message, which refers to buffers of logging thread
+    struct Record {
+      std::string logger;
+      std::string payload;
+      spdlog::level::level_enum level{};
+      spdlog::log_clock::time_point time;
+      size_t thread_id{};
+      spdlog::source_loc source;
+    };
+
+    void run();
+    void write(const Record &record);
+
+    std::shared_ptr<spdlog::sinks::sink> target_;
+    BoundedQueue<Record> queue_;
+    std::atomic<uint64_t> dropped_{};
+    std::atomic_bool flush_{false};
+    std::atomic_bool sleeping_{false};
+    bool stopped_{false};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+  };
+}  // namespace fc::common
+
+#endif  // CPP_FILECOIN_CORE_COMMON_ASYNC_LOG_SINK_HPP
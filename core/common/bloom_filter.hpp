@@ -0,0 +1,86 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_COMMON_BLOOM_FILTER_HPP
+#define CPP_FILECOIN_CORE_COMMON_BLOOM_FILTER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+#include <gsl/span>
+
+namespace fc::common {
+
+  /**
+   * Fixed size thread-safe bloom filter over byte strings. Never reports
+   * inserted key as missing, reports missing key as present with
+   * probability depending on bits per inserted key and number of hashes.
+   * Bit positions are derived by double hashing of one key hash.
+   */
+  class BloomFilter {
+   public:
+    /**
+     * @param bits - filter size, rounded up to 64
+     * @param hashes - bits set per key
+     */
+    BloomFilter(size_t bits, size_t hashes)
+        : words_{std::max<size_t>(1, (bits + 63) / 64)},
+          bits_{std::make_unique<std::atomic_uint64_t[]>(words_)},
+          hashes_{hashes} {
+      for (size_t i{0}; i < words_; ++i) {
+        bits_[i] = 0;
+      }
+    }
+
+    void insert(gsl::span<const uint8_t> key) {
+      auto [h1, h2]{hash(key)};
+      for (size_t i{0}; i < hashes_; ++i) {
+        auto bit{(h1 + i * h2) % (words_ * 64)};
+        bits_[bit / 64].fetch_or(uint64_t{1} << (bit % 64),
+                                 std::memory_order_relaxed);
+      }
+    }
+
+    /// False if key was never inserted, true if key may be inserted
+    bool mayContain(gsl::span<const uint8_t> key) const {
+      auto [h1, h2]{hash(key)};
+      for (size_t i{0}; i < hashes_; ++i) {
+        auto bit{(h1 + i * h2) % (words_ * 64)};
+        if (!(bits_[bit / 64].load(std::memory_order_relaxed)
+              & (uint64_t{1} << (bit % 64)))) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /// Filter size in bits
+    size_t bits() const {
+      return words_ * 64;
+    }
+
+   private:
+    static std::pair<uint64_t, uint64_t> hash(gsl::span<const uint8_t> key) {
+      uint64_t h1 = std::hash<std::string_view>{}(
+          {reinterpret_cast<const char *>(key.data()),
+           static_cast<size_t>(key.size())});
+      // second hash by mixing first, odd so positions don't repeat early
+      auto h2{h1 ^ (h1 >> 33)};
+      h2 *= 0xff51afd7ed558ccdull;
+      h2 ^= h2 >> 33;
+      return {h1, h2 | 1};
+    }
+
+    size_t words_;
+    std::unique_ptr<std::atomic_uint64_t[]> bits_;
+    size_t hashes_;
+  };
+
+}  // namespace fc::common
+
+#endif  // CPP_FILECOIN_CORE_COMMON_BLOOM_FILTER_HPP
@@ -0,0 +1,106 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_COMMON_BOUNDED_QUEUE_HPP
+#define CPP_FILECOIN_CORE_COMMON_BOUNDED_QUEUE_HPP
+
+#include <atomic>
+#include <memory>
+
+namespace fc::common {
+  /**
+   * Bounded lock-free multi-producer multi-consumer queue, ring of cells
+   * with sequence numbers, so producers and consumers only contend on
+   * their position counters. Capacity is rounded up to power of two.
+   */
+  template <typename T>
+  class BoundedQueue {
+   public:
+    explicit BoundedQueue(size_t capacity) {
+      size_t size{2};
+      while (size < capacity) {
+        size <<= 1;
+      }
+      mask_ = size - 1;
+      cells_ = std::make_unique<Cell[]>(size);
+      for (size_t i{0}; i < size; ++i) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    size_t capacity() const {
+      return mask_ + 1;
+    }
+
+    /// Pushes value, returns false leaving value intact if queue is full
+    bool push(T &&value) {
+      auto pos{enqueue_.load(std::memory_order_relaxed)};
+      Cell *cell;
+      while (true) {
+        cell = &cells_[pos & mask_];
+        auto sequence{cell->sequence.load(std::memory_order_acquire)};
+        auto diff{static_cast<intptr_t>(sequence)
+                  - static_cast<intptr_t>(pos)};
+        if (diff == 0) {
+          if (enqueue_.compare_exchange_weak(
+                  pos, pos + 1, std::memory_order_relaxed)) {
+            break;
+          }
+        } else if (diff < 0) {
+          return false;
+        } else {
+          pos = enqueue_.load(std::memory_order_relaxed);
+        }
+      }
+      cell->value = std::move(value);
+      cell->sequence.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+
+    /// Pops value, returns false if queue is empty
+    bool pop(T &value) {
+      auto pos{dequeue_.load(std::memory_order_relaxed)};
+      Cell *cell;
+      while (true) {
+        cell = &cells_[pos & mask_];
+        auto sequence{cell->sequence.load(std::memory_order_acquire)};
+        auto diff{static_cast<intptr_t>(sequence)
+                  - static_cast<intptr_t>(pos + 1)};
+        if (diff == 0) {
+          if (dequeue_.compare_exchange_weak(
+                  pos, pos + 1, std::memory_order_relaxed)) {
+            break;
+          }
+        } else if (diff < 0) {
+          return false;
+        } else {
+          pos = dequeue_.load(std::memory_order_relaxed);
+        }
+      }
+      value = std::move(cell->value);
+      cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+      return true;
+    }
+
+    /// Approximate, exact when producers and consumers are idle
+    bool empty() const {
+      return enqueue_.load(std::memory_order_acquire)
+             == dequeue_.load(std::memory_order_acquire);
+    }
+
+   private:
+    struct Cell {
+      std::atomic<size_t> sequence{};
+      T value{};
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_{};
+    alignas(64) std::atomic<size_t> enqueue_{};
+    alignas(64) std::atomic<size_t> dequeue_{};
+  };
+}  // namespace fc::common
+
+#endif  // CPP_FILECOIN_CORE_COMMON_BOUNDED_QUEUE_HPP
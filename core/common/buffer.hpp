@@ -237,9 +237,7 @@ namespace fc::common {
    * @return reference to stream
    */
   CBOR_DECODE(Buffer, buffer) {
-    std::vector<uint8_t> data;
-    s >> data;
-    buffer.put(data);
+    buffer.put(s.bytesView());
     return s;
   }
 
@@ -0,0 +1,97 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_COMMON_GENERATIONAL_MAP_HPP
+#define CPP_FILECOIN_CORE_COMMON_GENERATIONAL_MAP_HPP
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace fc::common {
+
+  /**
+   * Map bounded by two generations of entries. Found entries move to current
+   * generation, and previous generation is dropped when current one fills,
+   * so entries not used during whole generation are evicted. Pinned entries
+   * are never evicted. Not thread-safe, like std containers.
+   * @tparam Key - key type, must be hashable
+   * @tparam Value - value type
+   */
+  template <typename Key, typename Value, typename Hash = std::hash<Key>>
+  class GenerationalMap {
+   public:
+    using Map = std::unordered_map<Key, Value, Hash>;
+
+    /// @param generation_size - entries of generation before rotation
+    explicit GenerationalMap(size_t generation_size)
+        : generation_size_{std::max<size_t>(1, generation_size)} {}
+
+    /// Finds value and marks it as recently used, null if absent
+    Value *find(const Key &key) {
+      if (auto it{pinned_.find(key)}; it != pinned_.end()) {
+        return &it->second;
+      }
+      if (auto it{current_.find(key)}; it != current_.end()) {
+        return &it->second;
+      }
+      auto it{previous_.find(key)};
+      if (it == previous_.end()) {
+        return nullptr;
+      }
+      auto value{std::move(it->second)};
+      previous_.erase(it);
+      return &insert(key, std::move(value));
+    }
+
+    bool has(const Key &key) {
+      return find(key) != nullptr;
+    }
+
+    /// Inserts value if key is absent
+    /// @return stored value
+    Value &emplace(const Key &key, Value value) {
+      if (auto found{find(key)}) {
+        return *found;
+      }
+      return insert(key, std::move(value));
+    }
+
+    /// Inserts or replaces value, which is never evicted
+    void pin(const Key &key, Value value) {
+      current_.erase(key);
+      previous_.erase(key);
+      pinned_.insert_or_assign(key, std::move(value));
+    }
+
+    /// Number of stored values
+    size_t size() const {
+      return pinned_.size() + current_.size() + previous_.size();
+    }
+
+    /// Number of values evicted so far
+    size_t evicted() const {
+      return evicted_;
+    }
+
+   private:
+    Value &insert(const Key &key, Value value) {
+      if (current_.size() >= generation_size_) {
+        evicted_ += previous_.size();
+        previous_ = std::move(current_);
+        current_ = {};
+      }
+      return current_.emplace(key, std::move(value)).first->second;
+    }
+
+    size_t generation_size_;
+    size_t evicted_{};
+    Map pinned_;
+    Map current_;
+    Map previous_;
+  };
+
+}  // namespace fc::common
+
+#endif  // CPP_FILECOIN_CORE_COMMON_GENERATIONAL_MAP_HPP
@@ -0,0 +1,68 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/libp2p/buffer_pool.hpp"
+
+namespace fc::common::libp2p {
+  BufferPool &BufferPool::shared() {
+    static BufferPool pool;
+    return pool;
+  }
+
+  size_t BufferPool::sizeClass(size_t size) {
+    size_t size_class = kMinSize;
+    while (size_class < size) {
+      size_class <<= 1;
+    }
+    return size_class;
+  }
+
+  size_t BufferPool::classIndex(size_t size) {
+    size_t index = 0;
+    for (auto size_class = kMinSize; size_class < size; size_class <<= 1) {
+      ++index;
+    }
+    return index;
+  }
+
+  BufferPool::Bytes BufferPool::acquire(size_t size) {
+    auto size_class = sizeClass(size);
+    if (size_class <= kMaxPooledSize) {
+      std::lock_guard lock{mutex_};
+      auto index = classIndex(size_class);
+      if (index < free_.size() && !free_[index].empty()) {
+        auto buffer = std::move(free_[index].back());
+        free_[index].pop_back();
+        return buffer;
+      }
+    }
+    return Bytes(size_class);
+  }
+
+  void BufferPool::release(Bytes &buffer) {
+    auto size = buffer.size();
+    // only buffers of exact size class are reused
+    if (size >= kMinSize && size <= kMaxPooledSize && sizeClass(size) == size) {
+      std::lock_guard lock{mutex_};
+      auto index = classIndex(size);
+      if (index >= free_.size()) {
+        free_.resize(index + 1);
+      }
+      if (free_[index].size() < kMaxFreePerClass) {
+        free_[index].push_back(std::move(buffer));
+      }
+    }
+    buffer = {};
+  }
+
+  size_t BufferPool::freeCount() const {
+    std::lock_guard lock{mutex_};
+    size_t count = 0;
+    for (auto &buffers : free_) {
+      count += buffers.size();
+    }
+    return count;
+  }
+}  // namespace fc::common::libp2p
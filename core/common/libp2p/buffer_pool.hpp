@@ -0,0 +1,53 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_COMMON_LIBP2P_BUFFER_POOL_HPP
+#define CPP_FILECOIN_CORE_COMMON_LIBP2P_BUFFER_POOL_HPP
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace fc::common::libp2p {
+  /**
+   * Pool of byte buffers of power of two size classes, shared by streams,
+   * so large responses don't reallocate buffer on each read and released
+   * buffers are reused by next streams
+   */
+  class BufferPool {
+   public:
+    using Bytes = std::vector<uint8_t>;
+
+    /// Smallest size class
+    static constexpr size_t kMinSize = 4 << 10;
+    /// Buffers larger than this are not kept on release
+    static constexpr size_t kMaxPooledSize = 64 << 20;
+    /// Max number of free buffers kept for each size class
+    static constexpr size_t kMaxFreePerClass = 8;
+
+    /// Pool shared by all cbor streams
+    static BufferPool &shared();
+
+    /// Size class fitting size bytes
+    static size_t sizeClass(size_t size);
+
+    /// Get buffer of size class fitting size bytes
+    Bytes acquire(size_t size);
+
+    /// Return buffer to pool, buffer is left empty
+    void release(Bytes &buffer);
+
+    /// Number of free buffers in pool
+    size_t freeCount() const;
+
+   private:
+    static size_t classIndex(size_t size);
+
+    mutable std::mutex mutex_;
+    std::vector<std::vector<Bytes>> free_;
+  };
+}  // namespace fc::common::libp2p
+
+#endif  // CPP_FILECOIN_CORE_COMMON_LIBP2P_BUFFER_POOL_HPP
@@ -6,8 +6,12 @@
 #include "common/libp2p/cbor_stream.hpp"
 
 namespace fc::common::libp2p {
-  CborStream::CborStream(std::shared_ptr<Stream> stream)
-      : stream_{std::move(stream)} {}
+  CborStream::CborStream(std::shared_ptr<Stream> stream, BufferPool &pool)
+      : stream_{std::move(stream)}, pool_{pool} {}
+
+  CborStream::~CborStream() {
+    pool_.release(buffer_);
+  }
 
   std::shared_ptr<CborStream::Stream> CborStream::stream() const {
     return stream_;
@@ -15,9 +19,21 @@ namespace fc::common::libp2p {
 
   void CborStream::readRaw(ReadCallbackFunc cb) {
     buffering_.reset();
-    buffer_.erase(buffer_.begin(), buffer_.begin() + size_);
+    auto left = filled_ - size_;
+    if (buffer_.size() > kReserveBytes && left <= kReserveBytes) {
+      // return large buffer to pool for other streams
+      auto buffer = pool_.acquire(kReserveBytes);
+      std::copy_n(buffer_.begin() + size_, left, buffer.begin());
+      pool_.release(buffer_);
+      buffer_ = std::move(buffer);
+    } else {
+      std::copy(buffer_.begin() + size_,
+                buffer_.begin() + filled_,
+                buffer_.begin());
+    }
     size_ = 0;
-    consume(buffer_, std::move(cb));
+    filled_ = left;
+    consume(gsl::make_span(buffer_).subspan(0, filled_), std::move(cb));
   }
 
   void CborStream::writeRaw(gsl::span<const uint8_t> input,
@@ -25,20 +41,64 @@ namespace fc::common::libp2p {
     stream_->write(input, input.size(), std::move(cb));
   }
 
+  void CborStream::writeRaw(Chunks chunks, WriteCallbackFunc cb) {
+    writeChunks(
+        std::make_shared<Chunks>(std::move(chunks)), 0, 0, std::move(cb));
+  }
+
+  void CborStream::writeChunks(std::shared_ptr<Chunks> chunks,
+                               size_t index,
+                               size_t written,
+                               WriteCallbackFunc cb) {
+    while (index < chunks->size() && (*chunks)[index].empty()) {
+      ++index;
+    }
+    if (index == chunks->size()) {
+      return cb(written);
+    }
+    auto chunk = (*chunks)[index];
+    stream_->write(
+        chunk,
+        chunk.size(),
+        [self{shared_from_this()}, chunks, index, written, cb{std::move(cb)}](
+            auto count) {
+          if (!count) {
+            return cb(count.error());
+          }
+          self->writeChunks(
+              chunks, index + 1, written + count.value(), std::move(cb));
+        });
+  }
+
+  void CborStream::resizeBuffer(size_t size) {
+    auto buffer = pool_.acquire(size);
+    std::copy_n(buffer_.begin(), filled_, buffer.begin());
+    pool_.release(buffer_);
+    buffer_ = std::move(buffer);
+  }
+
   void CborStream::readMore(ReadCallbackFunc cb) {
     if (buffering_.done()) {
       return cb(gsl::make_span(buffer_).subspan(0, size_));
     }
-    buffer_.resize(size_ + kReserveBytes);
+    // remaining length of string being read is known from its head, but is
+    // not trusted, buffer is at most twice bytes received plus small hint
+    auto hint = std::min(buffering_.moreBytes(), kMaxHintBytes);
+    auto want = filled_ + std::max(hint, kReserveBytes);
+    if (buffer_.size() < want) {
+      resizeBuffer(std::max(want, 2 * buffer_.size()));
+    }
+    auto free = buffer_.size() - filled_;
     stream_->readSome(
-        gsl::make_span(buffer_).subspan(size_),
-        kReserveBytes,
+        gsl::make_span(buffer_).subspan(filled_, free),
+        free,
         [cb{std::move(cb)}, self{shared_from_this()}](auto count) {
           if (!count) {
             return cb(count.error());
           }
-          self->buffer_.resize(self->size_ + count.value());
-          self->consume(gsl::make_span(self->buffer_).subspan(self->size_),
+          self->filled_ += count.value();
+          self->consume(gsl::make_span(self->buffer_)
+                            .subspan(self->size_, self->filled_ - self->size_),
                         std::move(cb));
         });
   }
@@ -9,21 +9,35 @@
 #include <libp2p/connection/stream.hpp>
 
 #include "codec/cbor/cbor.hpp"
+#include "common/libp2p/buffer_pool.hpp"
 #include "common/libp2p/cbor_buffering.hpp"
 
 namespace fc::common::libp2p {
-  /// Reads and writes cbor objects
+  /**
+   * Reads and writes cbor objects.
+   * Read buffer is taken from shared pool and sized by lengths of byte and
+   * text strings being read, so large objects are read in few steps.
+   */
   class CborStream : public std::enable_shared_from_this<CborStream> {
    public:
     using Stream = ::libp2p::connection::Stream;
     using ReadCallback = void(outcome::result<gsl::span<const uint8_t>>);
     using ReadCallbackFunc = std::function<ReadCallback>;
     using WriteCallbackFunc = Stream::WriteCallbackFunc;
+    using Chunks = std::vector<gsl::span<const uint8_t>>;
 
-    /// Max number of bytes to read at a time
+    /// Min number of bytes to read at a time
     static constexpr size_t kReserveBytes = 4 << 10;
+    /**
+     * Max bytes reserved ahead for string length read from peer, larger
+     * strings grow buffer by doubling as their bytes arrive
+     */
+    static constexpr size_t kMaxHintBytes = 64 << 10;
 
-    explicit CborStream(std::shared_ptr<Stream> stream);
+    explicit CborStream(std::shared_ptr<Stream> stream,
+                        BufferPool &pool = BufferPool::shared());
+
+    ~CborStream();
 
     /// Get underlying stream
     std::shared_ptr<Stream> stream() const;
@@ -45,6 +59,13 @@ namespace fc::common::libp2p {
     /// Write bytes of cbor object
     void writeRaw(gsl::span<const uint8_t> input, WriteCallbackFunc cb);
 
+    /**
+     * Write bytes of cbor object in chunks, e.g. list head and pre-encoded
+     * elements, without concatenating them. Chunks must stay alive until
+     * callback, which gets total number of bytes written.
+     */
+    void writeRaw(Chunks chunks, WriteCallbackFunc cb);
+
     /// Write cbor object
     template <typename T>
     void write(const T &value, WriteCallbackFunc cb) {
@@ -62,11 +83,21 @@ namespace fc::common::libp2p {
    private:
     void readMore(ReadCallbackFunc cb);
     void consume(gsl::span<uint8_t> input, ReadCallbackFunc cb);
+    /// Replace buffer with pooled one of at least size bytes, keeping data
+    void resizeBuffer(size_t size);
+    void writeChunks(std::shared_ptr<Chunks> chunks,
+                     size_t index,
+                     size_t written,
+                     WriteCallbackFunc cb);
 
     std::shared_ptr<Stream> stream_;
+    BufferPool &pool_;
     CborBuffering buffering_;
     std::vector<uint8_t> buffer_;
+    /// Bytes of current object
     size_t size_{};
+    /// Bytes read into buffer, including start of next object
+    size_t filled_{};
   };
 }  // namespace fc::common::libp2p
 
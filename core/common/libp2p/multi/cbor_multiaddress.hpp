@@ -9,6 +9,7 @@
 #include <libp2p/multi/multiaddress.hpp>
 
 #include "codec/cbor/streams_annotation.hpp"
+#include "common/outcome.hpp"
 
 using libp2p::multi::Multiaddress;
 
@@ -29,6 +30,9 @@ namespace libp2p::multi {
   CBOR_DECODE(Multiaddress, ma) {
     std::vector<uint8_t> bytes;
     s >> bytes;
+    if (s.error()) {
+      return s;
+    }
     OUTCOME_EXCEPT(created, Multiaddress::create(bytes));
     ma = std::move(created);
     return s;
@@ -35,6 +35,9 @@ namespace libp2p::peer {
   CBOR_DECODE(PeerId, peer) {
     std::string str;
     s >> str;
+    if (s.error()) {
+      return s;
+    }
     OUTCOME_EXCEPT(peer_id, PeerId::fromBytes(fc::common::span::cbytes(str)));
     peer = std::move(peer_id);
     return s;
@@ -7,18 +7,34 @@
 
 #include <spdlog/sinks/stdout_color_sinks.h>
 
+#include "common/async_log_sink.hpp"
+
 namespace {
   void setGlobalPattern(spdlog::logger &logger) {
     logger.set_pattern("[%Y-%m-%d %H:%M:%S.%F] %n %v");
   }
 
+  constexpr auto kDebugPattern{"[%Y-%m-%d %H:%M:%S.%F][th:%t][%l] %n %v"};
+
   void setDebugPattern(spdlog::logger &logger) {
-    logger.set_pattern("[%Y-%m-%d %H:%M:%S.%F][th:%t][%l] %n %v");
+    logger.set_pattern(kDebugPattern);
   }
 
+  /// Guards async_sink and creation of loggers
+  std::mutex logger_mutex;
+
+  /// Sink of all loggers after async logging is enabled
+  std::shared_ptr<fc::common::AsyncLogSink> async_sink;
+
   std::shared_ptr<spdlog::logger> createLogger(const std::string &tag,
                                                bool debug_mode = true) {
-    auto logger = spdlog::stdout_color_mt(tag);
+    std::shared_ptr<spdlog::logger> logger;
+    if (async_sink) {
+      logger = std::make_shared<spdlog::logger>(tag, async_sink);
+      spdlog::register_logger(logger);
+    } else {
+      logger = spdlog::stdout_color_mt(tag);
+    }
     if (debug_mode) {
       setDebugPattern(*logger);
     } else {
@@ -30,12 +46,28 @@ namespace {
 
 namespace fc::common {
   Logger createLogger(const std::string &tag) {
-    static std::mutex mutex;
-    std::lock_guard<std::mutex> lock(mutex);
+    std::lock_guard<std::mutex> lock(logger_mutex);
     auto logger = spdlog::get(tag);
     if (logger == nullptr) {
       logger = ::createLogger(tag);
     }
     return logger;
   }
+
+  void enableAsyncLogging(AsyncLoggingConfig config) {
+    std::lock_guard<std::mutex> lock(logger_mutex);
+    if (async_sink) {
+      return;
+    }
+    async_sink = std::make_shared<AsyncLogSink>(
+        std::make_shared<spdlog::sinks::stdout_color_sink_mt>(),
+        config.queue_size);
+    async_sink->set_pattern(kDebugPattern);
+    // target sink formats with pattern of loggers, all use same one
+    spdlog::apply_all([](const Logger &logger) {
+      auto &sinks{logger->sinks()};
+      sinks.clear();
+      sinks.push_back(async_sink);
+    });
+  }
 }  // namespace fc::common
@@ -6,6 +6,10 @@
 #ifndef CPP_FILECOIN_LOGGER_HPP
 #define CPP_FILECOIN_LOGGER_HPP
 
+#include <atomic>
+#include <chrono>
+#include <limits>
+
 #include <spdlog/fmt/ostr.h>
 #include <spdlog/spdlog.h>
 
@@ -18,6 +22,91 @@ namespace fc::common {
    * @return logger object
    */
   Logger createLogger(const std::string &tag);
+
+  struct AsyncLoggingConfig {
+    /// Messages queued for writer thread, more are dropped
+    size_t queue_size{1 << 16};
+  };
+
+  /**
+   * Moves output of all loggers, existing and created later, to writer
+   * thread, so logging on hot paths does not wait for console. Must be
+   * called once, before threads start logging.
+   */
+  void enableAsyncLogging(AsyncLoggingConfig config = {});
+
+  /**
+   * Limits rate of messages from one call site, see FC_LOG_LIMITED.
+   * Thread-safe, lock-free.
+   */
+  class LogRateLimiter {
+   public:
+    explicit LogRateLimiter(std::chrono::nanoseconds interval)
+        : interval_{interval.count()} {}
+
+    /**
+     * Whether message may be logged now, at most one per interval
+     * @param suppressed - set to count of messages suppressed since last
+     * allowed one
+     */
+    bool allow(uint64_t &suppressed) {
+      const int64_t now{
+          std::chrono::steady_clock::now().time_since_epoch().count()};
+      auto last{last_.load(std::memory_order_relaxed)};
+      while (last == kNever || now - last >= interval_) {
+        if (last_.compare_exchange_weak(
+                last, now, std::memory_order_relaxed)) {
+          suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+          return true;
+        }
+      }
+      suppressed_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+   private:
+    static constexpr int64_t kNever{std::numeric_limits<int64_t>::min()};
+
+    int64_t interval_;
+    std::atomic<int64_t> last_{kNever};
+    std::atomic<uint64_t> suppressed_{};
+  };
 }  // namespace fc::common
 
+/**
+ * Logs message if level is enabled, arguments are not evaluated or
+ * formatted otherwise
+ */
+#define FC_LOG(logger, severity, ...)                                         \
+  do {                                                                        \
+    auto &&_fc_logger{logger};                                                \
+    if (_fc_logger->should_log(spdlog::level::severity)) {                    \
+      _fc_logger->log(spdlog::level::severity, __VA_ARGS__);                  \
+    }                                                                         \
+  } while (false)
+
+/**
+ * Logs message at most once per interval from this call site, count of
+ * suppressed messages is appended to next logged one. Suppressed messages
+ * are not formatted.
+ */
+#define FC_LOG_LIMITED(logger, severity, interval, ...)                       \
+  do {                                                                        \
+    auto &&_fc_logger{logger};                                                \
+    if (_fc_logger->should_log(spdlog::level::severity)) {                    \
+      static ::fc::common::LogRateLimiter _fc_limiter{interval};              \
+      uint64_t _fc_suppressed{};                                              \
+      if (_fc_limiter.allow(_fc_suppressed)) {                                \
+        if (_fc_suppressed == 0) {                                            \
+          _fc_logger->log(spdlog::level::severity, __VA_ARGS__);              \
+        } else {                                                              \
+          _fc_logger->log(spdlog::level::severity,                            \
+                          "{} ({} similar suppressed)",                       \
+                          fmt::format(__VA_ARGS__),                           \
+                          _fc_suppressed);                                    \
+        }                                                                     \
+      }                                                                       \
+    }                                                                         \
+  } while (false)
+
 #endif  // CPP_FILECOIN_LOGGER_HPP
@@ -0,0 +1,111 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_COMMON_LRU_CACHE_HPP
+#define CPP_FILECOIN_CORE_COMMON_LRU_CACHE_HPP
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include <boost/optional.hpp>
+
+namespace fc::common {
+
+  /**
+   * Bounded thread-safe cache, which evicts least recently used entries.
+   * @tparam Key - key type, must be hashable
+   * @tparam Value - value type, copied on get
+   */
+  template <typename Key, typename Value, typename Hash = std::hash<Key>>
+  class LruCache {
+   public:
+    explicit LruCache(size_t capacity) : capacity_{capacity} {}
+
+    /// Get value by key and mark it as recently used
+    boost::optional<Value> get(const Key &key) {
+      std::lock_guard lock{mutex_};
+      auto it = index_.find(key);
+      if (it == index_.end()) {
+        ++misses_;
+        return boost::none;
+      }
+      ++hits_;
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return it->second->second;
+    }
+
+    /// Insert or replace value, evicts least recently used if full
+    void put(const Key &key, Value value) {
+      std::lock_guard lock{mutex_};
+      if (capacity_ == 0) {
+        return;
+      }
+      auto it = index_.find(key);
+      if (it != index_.end()) {
+        it->second->second = std::move(value);
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return;
+      }
+      if (entries_.size() >= capacity_) {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+      }
+      entries_.emplace_front(key, std::move(value));
+      index_.emplace(key, entries_.begin());
+    }
+
+    /// Remove value by key
+    void remove(const Key &key) {
+      std::lock_guard lock{mutex_};
+      auto it = index_.find(key);
+      if (it != index_.end()) {
+        entries_.erase(it->second);
+        index_.erase(it);
+      }
+    }
+
+    /// Remove all values
+    void clear() {
+      std::lock_guard lock{mutex_};
+      index_.clear();
+      entries_.clear();
+    }
+
+    /// Number of cached values
+    size_t size() const {
+      std::lock_guard lock{mutex_};
+      return entries_.size();
+    }
+
+    size_t capacity() const {
+      return capacity_;
+    }
+
+    /// Number of successful lookups
+    size_t hits() const {
+      return hits_;
+    }
+
+    /// Number of failed lookups
+    size_t misses() const {
+      return misses_;
+    }
+
+   private:
+    using Entries = std::list<std::pair<Key, Value>>;
+
+    size_t capacity_;
+    Entries entries_;
+    std::unordered_map<Key, typename Entries::iterator, Hash> index_;
+    mutable std::mutex mutex_;
+    std::atomic_size_t hits_{0};
+    std::atomic_size_t misses_{0};
+  };
+
+}  // namespace fc::common
+
+#endif  // CPP_FILECOIN_CORE_COMMON_LRU_CACHE_HPP
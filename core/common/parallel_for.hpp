@@ -0,0 +1,47 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_COMMON_PARALLEL_FOR_HPP
+#define CPP_FILECOIN_CORE_COMMON_PARALLEL_FOR_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+namespace fc::common {
+  /**
+   * Calls f for each index on pool and waits for all of them, runs on
+   * calling thread without pool or for single index
+   */
+  inline void parallelFor(boost::asio::thread_pool *pool,
+                          size_t count,
+                          const std::function<void(size_t)> &f) {
+    if (!pool || count < 2) {
+      for (size_t i = 0; i < count; ++i) {
+        f(i);
+      }
+      return;
+    }
+    std::mutex mutex;
+    std::condition_variable done;
+    auto pending{count};
+    for (size_t i = 0; i < count; ++i) {
+      boost::asio::post(*pool, [&, i] {
+        f(i);
+        std::lock_guard lock{mutex};
+        if (--pending == 0) {
+          done.notify_one();
+        }
+      });
+    }
+    std::unique_lock lock{mutex};
+    done.wait(lock, [&] { return pending == 0; });
+  }
+}  // namespace fc::common
+
+#endif  // CPP_FILECOIN_CORE_COMMON_PARALLEL_FOR_HPP
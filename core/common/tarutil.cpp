@@ -5,9 +5,19 @@
 
 #include "common/tarutil.hpp"
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <libarchive/archive.h>
 #include <libarchive/archive_entry.h>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
 #include "common/ffi.hpp"
 #include "common/logger.hpp"
 
@@ -38,84 +48,386 @@ namespace fc::common {
     }
   }
 
-  outcome::result<void> extractTar(const std::string &tar_path,
-                                   const std::string &output_path) {
-    if (!fs::exists(output_path)) {
-      boost::system::error_code ec;
-      if (!fs::create_directories(output_path, ec)) {
-        if (ec.failed()) {
-          logger->error("Extract tar: {}", ec.message());
+  namespace {
+    outcome::result<void> createOutputDir(const std::string &output_path) {
+      if (!fs::exists(output_path)) {
+        boost::system::error_code ec;
+        if (!fs::create_directories(output_path, ec)) {
+          if (ec.failed()) {
+            logger->error("Extract tar: {}", ec.message());
+          }
+          return TarErrors::kCannotCreateDir;
         }
-        return TarErrors::kCannotCreateDir;
       }
+      return outcome::success();
     }
 
-    struct archive_entry *entry;
-    int flags;
-    int r;
-
-    /* Select which attributes we want to restore. */
-    flags = ARCHIVE_EXTRACT_TIME;
-    flags |= ARCHIVE_EXTRACT_PERM;
-    flags |= ARCHIVE_EXTRACT_ACL;
-    flags |= ARCHIVE_EXTRACT_FFLAGS;
+    /// Context of archive read callback
+    struct ReadContext {
+      const TarReader &read;
+      boost::optional<std::error_code> error;
+    };
 
-    auto a = ffi::wrap(archive_read_new(), archive_read_free);
-    archive_read_support_format_tar(a.get());
-    auto ext = ffi::wrap(archive_write_disk_new(), archive_write_free);
-    archive_write_disk_set_options(ext.get(), flags);
-    archive_write_disk_set_standard_lookup(ext.get());
-    if (archive_read_open_filename(a.get(), tar_path.c_str(), kTarBlockSize)
-        != ARCHIVE_OK) {
-      logger->error("Extract tar: {}", archive_error_string(a.get()));
-      return TarErrors::kCannotUntarArchive;
+    la_ssize_t readCallback(struct archive *a,
+                            void *client,
+                            const void **buffer) {
+      auto context{static_cast<ReadContext *>(client)};
+      auto chunk{context->read()};
+      if (chunk.has_error()) {
+        context->error = chunk.error();
+        archive_set_error(a, EIO, "%s", chunk.error().message().c_str());
+        return -1;
+      }
+      *buffer = chunk.value().data();
+      return static_cast<la_ssize_t>(chunk.value().size());
     }
-    for (;;) {
-      r = archive_read_next_header(a.get(), &entry);
-      if (r == ARCHIVE_EOF) {
-        break;
+
+
+    /// Regular file being extracted, closed when its last write is done
+    struct OutputFile {
+      ~OutputFile() {
+        auto fd{buffered_fd != -1 ? buffered_fd : direct_fd};
+        if (fd != -1) {
+          fchmod(fd, perm);
+          if (mtime) {
+            timespec times[2]{*mtime, *mtime};
+            futimens(fd, times);
+          }
+        }
+        if (direct_fd != -1) {
+          close(direct_fd);
+        }
+        if (buffered_fd != -1) {
+          close(buffered_fd);
+        }
       }
-      if (r < ARCHIVE_WARN) {
-        logger->error("Extract tar: {}", archive_error_string(a.get()));
-        return TarErrors::kCannotUntarArchive;
+
+      std::string path;
+      mode_t perm{};
+      boost::optional<timespec> mtime;
+      int direct_fd{-1};
+      int buffered_fd{-1};
+      /// Set after first unaligned write, rest of file is written buffered
+      bool unaligned{};
+    };
+
+    /**
+     * Writes file data on thread pool.
+     * Reader copies data to free buffer and submits it, so reading of
+     * archive waits only when all buffers are being written.
+     */
+    class ParallelWriter {
+     public:
+      explicit ParallelWriter(const TarExtractOptions &options)
+          : buffer_size_{(std::max<size_t>(options.buffer_size, 1)
+                          + kTarAlignment - 1)
+                         / kTarAlignment * kTarAlignment},
+            direct_io_{options.direct_io},
+            preallocate_{options.preallocate},
+            pool_{options.writers} {
+        auto count{std::max<size_t>(options.buffers, 1)};
+        for (size_t i{0}; i < count; ++i) {
+          auto buffer{static_cast<uint8_t *>(
+              std::aligned_alloc(kTarAlignment, buffer_size_))};
+          if (buffer) {
+            storage_.emplace_back(buffer, std::free);
+            free_.push_back(buffer);
+          }
+        }
       }
-      if (r < ARCHIVE_OK) {
-        logger->warn("Extract tar: {}", archive_error_string(a.get()));
+
+      ~ParallelWriter() {
+        std::ignore = wait();
+        pool_.join();
       }
 
-      std::string currentFile(archive_entry_pathname(entry));
-      archive_entry_set_pathname(entry,
-                                 (fs::path(output_path) / currentFile).c_str());
-      r = archive_write_header(ext.get(), entry);
-      if (r < ARCHIVE_OK) {
+      bool valid() const {
+        return !storage_.empty();
+      }
+
+      /// Copies data of entry to buffers and submits them
+      outcome::result<void> writeEntry(struct archive *a,
+                                       struct archive_entry *entry,
+                                       const std::string &path) {
+        OUTCOME_TRY(file, open(entry, path));
+        const void *data;
+        size_t size;
+        la_int64_t offset;
+        uint8_t *buffer{nullptr};
+        la_int64_t start{0};
+        size_t used{0};
+        for (;;) {
+          auto r{archive_read_data_block(a, &data, &size, &offset)};
+          if (r == ARCHIVE_EOF) {
+            break;
+          }
+          if (r < ARCHIVE_WARN) {
+            logger->error("Extract tar: {}", archive_error_string(a));
+            if (buffer) {
+              release(buffer);
+            }
+            return TarErrors::kCannotUntarArchive;
+          }
+          auto bytes{static_cast<const uint8_t *>(data)};
+          while (size != 0) {
+            // sparse archives have gaps between blocks
+            auto contiguous{offset == start + static_cast<la_int64_t>(used)};
+            if (buffer && (!contiguous || used == buffer_size_)) {
+              submit(file, buffer, start, used);
+              buffer = nullptr;
+            }
+            if (!buffer) {
+              OUTCOME_TRYA(buffer, acquire());
+              start = offset;
+              used = 0;
+            }
+            auto n{std::min(size, buffer_size_ - used)};
+            std::memcpy(buffer + used, bytes, n);
+            used += n;
+            bytes += n;
+            offset += n;
+            size -= n;
+          }
+        }
+        if (buffer) {
+          submit(file, buffer, start, used);
+        }
+        return outcome::success();
+      }
+
+      /// Waits for submitted writes, returns first write error
+      outcome::result<void> wait() {
+        std::unique_lock lock{mutex_};
+        done_.wait(lock, [&] { return pending_ == 0; });
+        if (error_) {
+          return *error_;
+        }
+        return outcome::success();
+      }
+
+     private:
+      outcome::result<std::shared_ptr<OutputFile>> open(
+          struct archive_entry *entry, const std::string &path) {
+        boost::system::error_code ec;
+        fs::create_directories(fs::path{path}.parent_path(), ec);
+        auto file{std::make_shared<OutputFile>()};
+        file->path = path;
+        file->perm = archive_entry_perm(entry);
+        if (archive_entry_mtime_is_set(entry)) {
+          file->mtime = timespec{archive_entry_mtime(entry),
+                                 archive_entry_mtime_nsec(entry)};
+        }
+        auto flags{O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC};
+        if (direct_io_) {
+          // filesystems without direct io support fail with EINVAL
+          file->direct_fd = ::open(path.c_str(), flags | O_DIRECT, 0600);
+        }
+        if (file->direct_fd == -1) {
+          file->buffered_fd = ::open(path.c_str(), flags, 0600);
+          if (file->buffered_fd == -1) {
+            logger->error("Extract tar: {} {}", path, std::strerror(errno));
+            return TarErrors::kCannotWriteFile;
+          }
+        }
+        auto size{archive_entry_size(entry)};
+        if (preallocate_ && size > 0) {
+          auto fd{file->direct_fd != -1 ? file->direct_fd : file->buffered_fd};
+          // not supported by every filesystem, data is written anyway
+          std::ignore = posix_fallocate(fd, 0, size);
+        }
+        return file;
+      }
+
+      outcome::result<uint8_t *> acquire() {
+        std::unique_lock lock{mutex_};
+        done_.wait(lock, [&] { return !free_.empty() || error_; });
+        if (error_) {
+          return *error_;
+        }
+        auto buffer{free_.back()};
+        free_.pop_back();
+        return buffer;
+      }
+
+      void release(uint8_t *buffer) {
+        std::lock_guard lock{mutex_};
+        free_.push_back(buffer);
+        done_.notify_all();
+      }
+
+      void submit(const std::shared_ptr<OutputFile> &file,
+                  uint8_t *buffer,
+                  la_int64_t offset,
+                  size_t size) {
+        if (file->direct_fd != -1
+            && (file->unaligned || offset % kTarAlignment != 0
+                || size % kTarAlignment != 0)) {
+          file->unaligned = true;
+          if (file->buffered_fd == -1) {
+            file->buffered_fd =
+                ::open(file->path.c_str(), O_WRONLY | O_CLOEXEC);
+          }
+        }
+        auto fd{file->unaligned || file->direct_fd == -1 ? file->buffered_fd
+                                                         : file->direct_fd};
+        {
+          std::lock_guard lock{mutex_};
+          ++pending_;
+        }
+        boost::asio::post(pool_, [this, file, fd, buffer, offset, size] {
+          size_t written{0};
+          int error{fd == -1 ? EBADF : 0};
+          while (error == 0 && written < size) {
+            auto r{pwrite(
+                fd, buffer + written, size - written, offset + written)};
+            if (r < 0) {
+              if (errno != EINTR) {
+                error = errno;
+              }
+              continue;
+            }
+            written += r;
+          }
+          if (error != 0) {
+            logger->error(
+                "Extract tar: {} {}", file->path, std::strerror(error));
+          }
+          std::lock_guard lock{mutex_};
+          if (error != 0 && !error_) {
+            error_ = make_error_code(TarErrors::kCannotWriteFile);
+          }
+          free_.push_back(buffer);
+          --pending_;
+          done_.notify_all();
+        });
+      }
+
+      size_t buffer_size_;
+      bool direct_io_;
+      bool preallocate_;
+      std::vector<std::unique_ptr<uint8_t, void (*)(void *)>> storage_;
+      std::mutex mutex_;
+      std::condition_variable done_;
+      std::vector<uint8_t *> free_;
+      size_t pending_{};
+      boost::optional<std::error_code> error_;
+      boost::asio::thread_pool pool_;
+    };
+
+    outcome::result<void> extract(struct archive *a,
+                                  const std::string &output_path,
+                                  const TarExtractOptions &options) {
+      struct archive_entry *entry;
+      int flags;
+      int r;
+
+      /* Select which attributes we want to restore. */
+      flags = ARCHIVE_EXTRACT_TIME;
+      flags |= ARCHIVE_EXTRACT_PERM;
+      flags |= ARCHIVE_EXTRACT_ACL;
+      flags |= ARCHIVE_EXTRACT_FFLAGS;
+
+      auto ext = ffi::wrap(archive_write_disk_new(), archive_write_free);
+      archive_write_disk_set_options(ext.get(), flags);
+      archive_write_disk_set_standard_lookup(ext.get());
+      boost::optional<ParallelWriter> writer;
+      if (options.writers != 0) {
+        writer.emplace(options);
+        if (!writer->valid()) {
+          writer.reset();
+        }
+      }
+      for (;;) {
+        r = archive_read_next_header(a, &entry);
+        if (r == ARCHIVE_EOF) {
+          break;
+        }
         if (r < ARCHIVE_WARN) {
-          logger->error("Extract tar: {}", archive_error_string(a.get()));
-        } else {
-          logger->warn("Extract tar: {}", archive_error_string(a.get()));
+          logger->error("Extract tar: {}", archive_error_string(a));
+          return TarErrors::kCannotUntarArchive;
+        }
+        if (r < ARCHIVE_OK) {
+          logger->warn("Extract tar: {}", archive_error_string(a));
         }
-      } else if (archive_entry_size(entry) > 0) {
-        r = copy_data(a.get(), ext.get());
+
+        std::string currentFile(archive_entry_pathname(entry));
+        auto path{(fs::path(output_path) / currentFile).string()};
+        if (writer && archive_entry_filetype(entry) == AE_IFREG
+            && !archive_entry_hardlink(entry)) {
+          OUTCOME_TRY(writer->writeEntry(a, entry, path));
+          continue;
+        }
+        archive_entry_set_pathname(entry, path.c_str());
+        r = archive_write_header(ext.get(), entry);
+        if (r < ARCHIVE_OK) {
+          if (r < ARCHIVE_WARN) {
+            logger->error("Extract tar: {}", archive_error_string(a));
+          } else {
+            logger->warn("Extract tar: {}", archive_error_string(a));
+          }
+        } else if (archive_entry_size(entry) > 0) {
+          r = copy_data(a, ext.get());
+          if (r < ARCHIVE_WARN) {
+            logger->error("Extract tar: {}", archive_error_string(a));
+            return TarErrors::kCannotUntarArchive;
+          }
+          if (r < ARCHIVE_OK) {
+            logger->warn("Extract tar: {}", archive_error_string(a));
+          }
+        }
+        r = archive_write_finish_entry(ext.get());
         if (r < ARCHIVE_WARN) {
-          logger->error("Extract tar: {}", archive_error_string(a.get()));
+          logger->error("Extract tar: {}", archive_error_string(a));
           return TarErrors::kCannotUntarArchive;
         }
         if (r < ARCHIVE_OK) {
-          logger->warn("Extract tar: {}", archive_error_string(a.get()));
+          logger->warn("Extract tar: {}", archive_error_string(a));
         }
       }
-      r = archive_write_finish_entry(ext.get());
-      if (r < ARCHIVE_WARN) {
-        logger->error("Extract tar: {}", archive_error_string(a.get()));
-        return TarErrors::kCannotUntarArchive;
-      }
-      if (r < ARCHIVE_OK) {
-        logger->warn("Extract tar: {}", archive_error_string(a.get()));
+      if (writer) {
+        OUTCOME_TRY(writer->wait());
       }
+      archive_read_close(a);
+      archive_write_close(ext.get());
+
+      return outcome::success();
+    }
+  }  // namespace
+
+  outcome::result<void> extractTar(const std::string &tar_path,
+                                   const std::string &output_path,
+                                   const TarExtractOptions &options) {
+    OUTCOME_TRY(createOutputDir(output_path));
+
+    auto a = ffi::wrap(archive_read_new(), archive_read_free);
+    archive_read_support_format_tar(a.get());
+    if (archive_read_open_filename(a.get(), tar_path.c_str(), kTarBlockSize)
+        != ARCHIVE_OK) {
+      logger->error("Extract tar: {}", archive_error_string(a.get()));
+      return TarErrors::kCannotUntarArchive;
     }
-    archive_read_close(a.get());
-    archive_write_close(ext.get());
+    return extract(a.get(), output_path, options);
+  }
 
-    return outcome::success();
+  outcome::result<void> extractTar(const TarReader &read,
+                                   const std::string &output_path,
+                                   const TarExtractOptions &options) {
+    OUTCOME_TRY(createOutputDir(output_path));
+
+    ReadContext context{read, boost::none};
+    auto a = ffi::wrap(archive_read_new(), archive_read_free);
+    archive_read_support_format_tar(a.get());
+    if (archive_read_open(a.get(), &context, nullptr, readCallback, nullptr)
+        != ARCHIVE_OK) {
+      logger->error("Extract tar: {}", archive_error_string(a.get()));
+      return context.error ? *context.error
+                           : make_error_code(TarErrors::kCannotUntarArchive);
+    }
+    auto result{extract(a.get(), output_path, options)};
+    if (context.error) {
+      return *context.error;
+    }
+    return result;
   }
 
 }  // namespace fc::common
@@ -127,6 +439,8 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::common, TarErrors, e) {
       return "Tar Util: cannot create output dir";
     case (TarErrors::kCannotUntarArchive):
       return "Tar Util: cannot untar archive";
+    case (TarErrors::kCannotWriteFile):
+      return "Tar Util: cannot write file";
     default:
       return "Tar Util: unknown error";
   }
@@ -6,6 +6,8 @@
 #ifndef CPP_FILECOIN_CORE_COMMON_TAR_UTIL_HPP
 #define CPP_FILECOIN_CORE_COMMON_TAR_UTIL_HPP
 
+#include <functional>
+#include <gsl/span>
 #include <string>
 #include "common/outcome.hpp"
 
@@ -13,12 +15,47 @@ namespace fc::common {
 
   constexpr int kTarBlockSize = 10240;
 
+  /// Returns next chunk of archive, empty chunk at end of archive
+  using TarReader = std::function<outcome::result<gsl::span<const uint8_t>>()>;
+
+  struct TarExtractOptions {
+    /// Threads writing data of regular files, written inline with 0
+    size_t writers{4};
+    /// Size of each data buffer, rounded up to kTarAlignment
+    size_t buffer_size{8 << 20};
+    /// Max number of buffers being filled or written
+    size_t buffers{16};
+    /// Writes aligned parts of files with O_DIRECT, bypassing page cache
+    bool direct_io{false};
+    /// Allocates whole file before writing its data
+    bool preallocate{true};
+  };
+
+  /// Alignment of buffers, offsets and sizes of direct writes
+  constexpr size_t kTarAlignment = 4096;
+
+  /**
+   * Extracts archive file.
+   * Data of regular files is copied to large buffers and written with
+   * positioned writes by writer threads, so next entries are read while
+   * previous ones are written.
+   */
   outcome::result<void> extractTar(const std::string &tar_path,
-                                   const std::string &output_path);
+                                   const std::string &output_path,
+                                   const TarExtractOptions &options = {});
+
+  /**
+   * Extracts archive while it is read, so archive received from network is
+   * not stored before extraction
+   */
+  outcome::result<void> extractTar(const TarReader &read,
+                                   const std::string &output_path,
+                                   const TarExtractOptions &options = {});
 
   enum class TarErrors {
     kCannotCreateDir = 1,
     kCannotUntarArchive,
+    kCannotWriteFile,
   };
 
 }  // namespace fc::common
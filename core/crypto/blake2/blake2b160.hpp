@@ -36,6 +36,15 @@ namespace fc::crypto::blake2b {
    */
   Blake2b256Hash blake2b_256(gsl::span<const uint8_t> to_hash);
 
+  /**
+   * @brief Get blake2b-256 hashes of many inputs, several at once with SIMD
+   * when CPU supports it
+   * @param inputs - data to hash
+   * @return hashes in order of inputs
+   */
+  std::vector<Blake2b256Hash> blake2b_256_many(
+      gsl::span<const gsl::span<const uint8_t>> inputs);
+
   Blake2b512Hash blake2b_512_from_file(std::ifstream &file_stream);
 
 }  // namespace fc::crypto::blake2b
@@ -0,0 +1,195 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "crypto/blake2/blake2b160.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define FC_BLAKE2B_AVX2
+#include <immintrin.h>
+#endif
+
+namespace fc::crypto::blake2b {
+  namespace {
+    using Input = gsl::span<const uint8_t>;
+
+#ifdef FC_BLAKE2B_AVX2
+    constexpr size_t kLanes{4};
+    constexpr size_t kBlock{128};
+
+    const uint64_t kIv[8] = {0x6A09E667F3BCC908,
+                             0xBB67AE8584CAA73B,
+                             0x3C6EF372FE94F82B,
+                             0xA54FF53A5F1D36F1,
+                             0x510E527FADE682D1,
+                             0x9B05688C2B3E6C1F,
+                             0x1F83D9ABFB41BD6B,
+                             0x5BE0CD19137E2179};
+
+    const uint8_t kSigma[12][16] = {
+        {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+        {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+        {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4},
+        {7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+        {9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13},
+        {2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+        {12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11},
+        {13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+        {6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5},
+        {10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0},
+        {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+        {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3}};
+
+    size_t blocks(Input input) {
+      auto size{static_cast<size_t>(input.size())};
+      return std::max<size_t>(1, (size + kBlock - 1) / kBlock);
+    }
+
+    __attribute__((target("avx2"))) inline __m256i load(
+        const uint64_t *words) {
+      return _mm256_load_si256(reinterpret_cast<const __m256i *>(words));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i rotr(__m256i x, int n) {
+      return _mm256_or_si256(_mm256_srli_epi64(x, n),
+                             _mm256_slli_epi64(x, 64 - n));
+    }
+
+    /**
+     * Hashes up to 4 inputs at once, each 64-bit lane of vector holds state
+     * word of one input. Lanes of shorter inputs keep their state after
+     * their last block.
+     */
+    __attribute__((target("avx2"))) void hashLanes(const Input *inputs,
+                                                   size_t count,
+                                                   Blake2b256Hash *outputs) {
+      __m256i h[8];
+      for (size_t i = 0; i < 8; ++i) {
+        h[i] = _mm256_set1_epi64x(static_cast<int64_t>(kIv[i]));
+      }
+      h[0] = _mm256_xor_si256(
+          h[0],
+          _mm256_set1_epi64x(0x01010000 ^ BLAKE2B256_HASH_LENGTH));
+
+      size_t max_blocks{};
+      for (size_t j = 0; j < count; ++j) {
+        max_blocks = std::max(max_blocks, blocks(inputs[j]));
+      }
+
+      alignas(32) uint64_t words[16][kLanes];
+      alignas(32) uint64_t counter[kLanes];
+      alignas(32) uint64_t last[kLanes];
+      alignas(32) uint64_t active[kLanes];
+      uint8_t block[kBlock];
+      for (size_t b = 0; b < max_blocks; ++b) {
+        for (size_t j = 0; j < kLanes; ++j) {
+          auto n{j < count ? blocks(inputs[j]) : 0};
+          active[j] = b < n ? ~uint64_t{0} : 0;
+          last[j] = b + 1 == n ? ~uint64_t{0} : 0;
+          std::memset(block, 0, kBlock);
+          counter[j] = 0;
+          if (active[j]) {
+            auto &input{inputs[j]};
+            auto offset{b * kBlock};
+            auto size{
+                std::min(kBlock, static_cast<size_t>(input.size()) - offset)};
+            if (size != 0) {
+              std::memcpy(block, input.data() + offset, size);
+            }
+            counter[j] = offset + size;
+          }
+          for (size_t i = 0; i < 16; ++i) {
+            std::memcpy(&words[i][j], block + 8 * i, 8);
+          }
+        }
+
+        __m256i m[16];
+        for (size_t i = 0; i < 16; ++i) {
+          m[i] = load(words[i]);
+        }
+        __m256i v[16];
+        for (size_t i = 0; i < 8; ++i) {
+          v[i] = h[i];
+          v[i + 8] = _mm256_set1_epi64x(static_cast<int64_t>(kIv[i]));
+        }
+        // inputs are shorter than 2^64 bytes, so high word of counter is 0
+        v[12] = _mm256_xor_si256(v[12], load(counter));
+        v[14] = _mm256_xor_si256(v[14], load(last));
+
+#define FC_B2B_G(a, b, c, d, x, y)                                 \
+  v[a] = _mm256_add_epi64(_mm256_add_epi64(v[a], v[b]), x);        \
+  v[d] = rotr(_mm256_xor_si256(v[d], v[a]), 32);                   \
+  v[c] = _mm256_add_epi64(v[c], v[d]);                             \
+  v[b] = rotr(_mm256_xor_si256(v[b], v[c]), 24);                   \
+  v[a] = _mm256_add_epi64(_mm256_add_epi64(v[a], v[b]), y);        \
+  v[d] = rotr(_mm256_xor_si256(v[d], v[a]), 16);                   \
+  v[c] = _mm256_add_epi64(v[c], v[d]);                             \
+  v[b] = rotr(_mm256_xor_si256(v[b], v[c]), 63);
+
+        for (size_t r = 0; r < 12; ++r) {
+          auto s{kSigma[r]};
+          FC_B2B_G(0, 4, 8, 12, m[s[0]], m[s[1]]);
+          FC_B2B_G(1, 5, 9, 13, m[s[2]], m[s[3]]);
+          FC_B2B_G(2, 6, 10, 14, m[s[4]], m[s[5]]);
+          FC_B2B_G(3, 7, 11, 15, m[s[6]], m[s[7]]);
+          FC_B2B_G(0, 5, 10, 15, m[s[8]], m[s[9]]);
+          FC_B2B_G(1, 6, 11, 12, m[s[10]], m[s[11]]);
+          FC_B2B_G(2, 7, 8, 13, m[s[12]], m[s[13]]);
+          FC_B2B_G(3, 4, 9, 14, m[s[14]], m[s[15]]);
+        }
+#undef FC_B2B_G
+
+        auto mask{load(active)};
+        for (size_t i = 0; i < 8; ++i) {
+          auto next{
+              _mm256_xor_si256(h[i], _mm256_xor_si256(v[i], v[i + 8]))};
+          h[i] = _mm256_blendv_epi8(h[i], next, mask);
+        }
+      }
+
+      alignas(32) uint64_t state[4][kLanes];
+      for (size_t i = 0; i < 4; ++i) {
+        _mm256_store_si256(reinterpret_cast<__m256i *>(state[i]), h[i]);
+      }
+      for (size_t j = 0; j < count; ++j) {
+        for (size_t i = 0; i < 4; ++i) {
+          for (size_t k = 0; k < 8; ++k) {
+            outputs[j][8 * i + k] =
+                static_cast<uint8_t>(state[i][j] >> (8 * k));
+          }
+        }
+      }
+    }
+
+    bool hasAvx2() {
+      static const bool avx2{__builtin_cpu_supports("avx2") != 0};
+      return avx2;
+    }
+#endif
+  }  // namespace
+
+  std::vector<Blake2b256Hash> blake2b_256_many(
+      gsl::span<const gsl::span<const uint8_t>> inputs) {
+    const auto size{static_cast<size_t>(inputs.size())};
+    std::vector<Blake2b256Hash> outputs(size);
+    size_t i{};
+#ifdef FC_BLAKE2B_AVX2
+    if (hasAvx2()) {
+      // single remaining input is hashed without vector overhead
+      for (; i + 1 < size; i += kLanes) {
+        hashLanes(inputs.data() + i,
+                  std::min(kLanes, size - i),
+                  outputs.data() + i);
+      }
+    }
+#endif
+    for (; i < size; ++i) {
+      outputs[i] = blake2b_256(inputs[i]);
+    }
+    return outputs;
+  }
+}  // namespace fc::crypto::blake2b
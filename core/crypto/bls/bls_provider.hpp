@@ -59,6 +59,28 @@ namespace fc::crypto::bls {
      */
     virtual outcome::result<Signature> aggregateSignatures(
         gsl::span<const Signature> signatures) const = 0;
+
+    /**
+     * @brief Verify aggregated signature of distinct messages
+     * @param messages - signed data
+     * @param keys - BLS public keys, one per message
+     * @param signature - aggregated signature
+     * @return signature status or error code
+     */
+    virtual outcome::result<bool> verifyAggregate(
+        gsl::span<const gsl::span<const uint8_t>> messages,
+        gsl::span<const PublicKey> keys,
+        const Signature &signature) const = 0;
+
+    /**
+     * @brief Verify several signatures at once
+     * Each signature is checked on its own, status is false if any signature
+     * is invalid.
+     * @param items - messages with signatures and keys
+     * @return status of all signatures or error code
+     */
+    virtual outcome::result<bool> verifyBatch(
+        gsl::span<const SignedData> items) const = 0;
   };
 }  // namespace fc::crypto::bls
 
@@ -8,6 +8,8 @@
 
 #include <array>
 
+#include <gsl/span>
+
 #include "common/outcome.hpp"
 
 namespace fc::crypto::bls {
@@ -21,6 +23,13 @@ namespace fc::crypto::bls {
     PublicKey public_key;
   };
 
+  /// Message with its signature and signer key
+  struct SignedData {
+    gsl::span<const uint8_t> message;
+    Signature signature;
+    PublicKey key;
+  };
+
   enum class Errors {
     kInternalError = 1,
     kKeyPairGenerationFailed,
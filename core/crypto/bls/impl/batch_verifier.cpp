@@ -0,0 +1,63 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "crypto/bls/impl/batch_verifier.hpp"
+
+#include <boost/asio/post.hpp>
+
+namespace fc::crypto::bls {
+  BatchVerifier::BatchVerifier(std::shared_ptr<BlsProvider> bls,
+                               std::shared_ptr<boost::asio::io_context> io,
+                               std::shared_ptr<boost::asio::thread_pool> pool,
+                               size_t max_batch)
+      : bls_{std::move(bls)},
+        io_{std::move(io)},
+        pool_{std::move(pool)},
+        max_batch_{max_batch} {
+    BOOST_ASSERT(max_batch_ > 0);
+  }
+
+  void BatchVerifier::verify(common::Buffer message,
+                             const Signature &signature,
+                             const PublicKey &key,
+                             Callback callback) {
+    queue_.push_back({std::move(message), signature, key, std::move(callback)});
+    if (queue_.size() >= max_batch_) {
+      return flush();
+    }
+    if (!flush_posted_) {
+      flush_posted_ = true;
+      boost::asio::post(*io_, [weak{weak_from_this()}] {
+        if (auto self{weak.lock()}) {
+          self->flush_posted_ = false;
+          self->flush();
+        }
+      });
+    }
+  }
+
+  void BatchVerifier::flush() {
+    if (queue_.empty()) {
+      return;
+    }
+    auto batch{std::make_shared<Batch>(std::move(queue_))};
+    queue_.clear();
+    boost::asio::post(*pool_, [self{shared_from_this()}, batch] {
+      self->verifyItems(*batch);
+      boost::asio::post(*self->io_, [batch] {
+        for (auto &item : *batch) {
+          item.callback(item.valid);
+        }
+      });
+    });
+  }
+
+  void BatchVerifier::verifyItems(gsl::span<Item> items) const {
+    for (auto &item : items) {
+      auto valid{bls_->verifySignature(item.message, item.signature, item.key)};
+      item.valid = valid && valid.value();
+    }
+  }
+}  // namespace fc::crypto::bls
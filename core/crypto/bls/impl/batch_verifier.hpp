@@ -0,0 +1,68 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_CRYPTO_BLS_BATCH_VERIFIER_HPP
+#define CPP_FILECOIN_CORE_CRYPTO_BLS_BATCH_VERIFIER_HPP
+
+#include <functional>
+#include <memory>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#include "common/buffer.hpp"
+#include "crypto/bls/bls_provider.hpp"
+
+namespace fc::crypto::bls {
+  /**
+   * Asynchronous signature verification queue.
+   * Signatures queued during one io loop turn are verified as one batch on
+   * thread pool, each signature on its own, as aggregated check of batch
+   * without random coefficients accepts invalid signatures that cancel.
+   * Must be used from io thread, callbacks are called on io thread.
+   */
+  class BatchVerifier : public std::enable_shared_from_this<BatchVerifier> {
+   public:
+    using Callback = std::function<void(bool)>;
+
+    /// Max number of signatures in one batch
+    static constexpr size_t kMaxBatch{256};
+
+    BatchVerifier(std::shared_ptr<BlsProvider> bls,
+                  std::shared_ptr<boost::asio::io_context> io,
+                  std::shared_ptr<boost::asio::thread_pool> pool,
+                  size_t max_batch = kMaxBatch);
+
+    /// Queues signature for verification
+    void verify(common::Buffer message,
+                const Signature &signature,
+                const PublicKey &key,
+                Callback callback);
+
+   private:
+    struct Item {
+      common::Buffer message;
+      Signature signature;
+      PublicKey key;
+      Callback callback;
+      bool valid{};
+    };
+    using Batch = std::vector<Item>;
+
+    /// Sends queued signatures to pool
+    void flush();
+    /// Marks valid signatures, called on pool
+    void verifyItems(gsl::span<Item> items) const;
+
+    std::shared_ptr<BlsProvider> bls_;
+    std::shared_ptr<boost::asio::io_context> io_;
+    std::shared_ptr<boost::asio::thread_pool> pool_;
+    size_t max_batch_;
+    Batch queue_;
+    bool flush_posted_{};
+  };
+}  // namespace fc::crypto::bls
+
+#endif  // CPP_FILECOIN_CORE_CRYPTO_BLS_BATCH_VERIFIER_HPP
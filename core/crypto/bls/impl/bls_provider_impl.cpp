@@ -79,6 +79,41 @@ namespace fc::crypto::bls {
     }
     return ffi::array(response->signature.inner);
   }
+
+  outcome::result<bool> BlsProviderImpl::verifyAggregate(
+      gsl::span<const gsl::span<const uint8_t>> messages,
+      gsl::span<const PublicKey> keys,
+      const Signature &signature) const {
+    if (messages.size() != keys.size()) {
+      return false;
+    }
+    std::vector<uint8_t> digests;
+    digests.reserve(messages.size() * std::tuple_size_v<Digest>);
+    for (auto &message : messages) {
+      OUTCOME_TRY(digest, generateHash(message));
+      digests.insert(digests.end(), digest.begin(), digest.end());
+    }
+    return fil_verify(signature.data(),
+                      digests.data(),
+                      digests.size(),
+                      common::span::cast<const uint8_t>(keys).data(),
+                      keys.size_bytes())
+           > 0;
+  }
+
+  outcome::result<bool> BlsProviderImpl::verifyBatch(
+      gsl::span<const SignedData> items) const {
+    // plain aggregate of signatures accepts invalid pairs whose errors
+    // cancel, ffi has no randomized batch check, so each one is verified
+    for (auto &item : items) {
+      OUTCOME_TRY(valid,
+                  verifySignature(item.message, item.signature, item.key));
+      if (!valid) {
+        return false;
+      }
+    }
+    return true;
+  }
 };  // namespace fc::crypto::bls
 
 OUTCOME_CPP_DEFINE_CATEGORY(fc::crypto::bls, Errors, e) {
@@ -26,6 +26,14 @@ namespace fc::crypto::bls {
     outcome::result<Signature> aggregateSignatures(
         gsl::span<const Signature> signatures) const override;
 
+    outcome::result<bool> verifyAggregate(
+        gsl::span<const gsl::span<const uint8_t>> messages,
+        gsl::span<const PublicKey> keys,
+        const Signature &signature) const override;
+
+    outcome::result<bool> verifyBatch(
+        gsl::span<const SignedData> items) const override;
+
    private:
     /**
      * @brief Generate BLS message digest
@@ -66,6 +66,9 @@ namespace fc::crypto::signature {
   CBOR_DECODE(Signature, signature) {
     std::vector<uint8_t> data{};
     s >> data;
+    if (s.error()) {
+      return s;
+    }
     if (data.empty() || data.size() > kSignatureMaxLength) {
       outcome::raise(SignatureError::kInvalidSignatureLength);
     }
@@ -0,0 +1,44 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "crypto/verify_cache/verify_cache.hpp"
+
+#include <cstring>
+
+#include "crypto/blake2/blake2b160.hpp"
+
+namespace fc::crypto {
+  size_t VerifyCache::KeyHash::operator()(const Hash256 &key) const {
+    // key is already uniformly distributed hash
+    size_t hash;
+    std::memcpy(&hash, key.data(), sizeof(hash));
+    return hash;
+  }
+
+  VerifyCache::VerifyCache(size_t capacity) : cache_{capacity} {}
+
+  VerifyCache &VerifyCache::shared() {
+    static VerifyCache cache;
+    return cache;
+  }
+
+  outcome::result<bool> VerifyCache::verify(BytesIn key, const Verify &verify) {
+    auto hash{blake2b::blake2b_256(key)};
+    if (auto cached{cache_.get(hash)}) {
+      return *cached;
+    }
+    OUTCOME_TRY(valid, verify());
+    cache_.put(hash, valid);
+    return valid;
+  }
+
+  size_t VerifyCache::size() const {
+    return cache_.size();
+  }
+
+  size_t VerifyCache::hits() const {
+    return cache_.hits();
+  }
+}  // namespace fc::crypto
@@ -0,0 +1,63 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_CRYPTO_VERIFY_CACHE_VERIFY_CACHE_HPP
+#define CPP_FILECOIN_CORE_CRYPTO_VERIFY_CACHE_VERIFY_CACHE_HPP
+
+#include <functional>
+
+#include "common/blob.hpp"
+#include "common/buffer.hpp"
+#include "common/lru_cache.hpp"
+#include "common/outcome.hpp"
+
+namespace fc::crypto {
+  using common::Hash256;
+
+  /**
+   * Kind of verification, first element of verify cache keys, so keys of
+   * different kinds with same inputs don't collide
+   */
+  enum class VerifyKind : uint8_t {
+    kSeal = 1,
+    kWinningPoSt,
+    kWindowPoSt,
+    kVrf,
+  };
+
+  /**
+   * Results of expensive verifications by hash of their inputs, so proofs
+   * of blocks and messages validated again on reorg are not verified again.
+   * Key must include proof type, public inputs and proof bytes.
+   * Errors are not cached. Thread-safe.
+   */
+  class VerifyCache {
+   public:
+    using Verify = std::function<outcome::result<bool>()>;
+
+    static constexpr size_t kCapacityDefault{1 << 16};
+
+    explicit VerifyCache(size_t capacity = kCapacityDefault);
+
+    /// Cache shared by proofs and vrf verification
+    static VerifyCache &shared();
+
+    /// Cached result of key, or result of verify which is then cached
+    outcome::result<bool> verify(BytesIn key, const Verify &verify);
+
+    size_t size() const;
+
+    size_t hits() const;
+
+   private:
+    struct KeyHash {
+      size_t operator()(const Hash256 &key) const;
+    };
+
+    common::LruCache<Hash256, bool, KeyHash> cache_;
+  };
+}  // namespace fc::crypto
+
+#endif  // CPP_FILECOIN_CORE_CRYPTO_VERIFY_CACHE_VERIFY_CACHE_HPP
@@ -7,6 +7,7 @@
 #include "crypto/vrf/vrf_hash_encoder.hpp"
 
 #include "common/outcome.hpp"
+#include "crypto/verify_cache/verify_cache.hpp"
 
 namespace fc::crypto::vrf {
 
@@ -32,10 +33,19 @@ namespace fc::crypto::vrf {
       const VRFParams &params,
       const VRFProof &proof) const {
     OUTCOME_TRY(hash, encodeVrfParams(params));
-    auto &&res = bls_provider_->verifySignature(hash, proof, public_key);
-    if (res.has_failure()) {
-      return VRFError::kVerificationFailed;
-    }
-    return res.value();
+    // kind separates vrf keys from proof keys in shared cache
+    common::Buffer key;
+    key.putUint8(static_cast<uint8_t>(VerifyKind::kVrf))
+        .put(public_key)
+        .put(hash)
+        .put(proof);
+    return VerifyCache::shared().verify(
+        key, [&]() -> outcome::result<bool> {
+          auto &&res = bls_provider_->verifySignature(hash, proof, public_key);
+          if (res.has_failure()) {
+            return VRFError::kVerificationFailed;
+          }
+          return res.value();
+        });
   }
 }  // namespace fc::crypto::vrf
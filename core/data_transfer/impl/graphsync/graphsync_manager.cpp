@@ -14,16 +14,18 @@ namespace fc::data_transfer::graphsync {
   using common::Buffer;
 
   GraphSyncManager::GraphSyncManager(std::shared_ptr<Host> host,
-                                     std::shared_ptr<Graphsync> graphsync)
+                                     std::shared_ptr<Graphsync> graphsync,
+                                     TransferLimits limits)
       : peer_{host->getPeerInfo()},
         network_(std::make_shared<Libp2pDataTransferNetwork>(std::move(host))),
-        graphsync_(std::move(graphsync)) {}
+        graphsync_(std::move(graphsync)),
+        transfer_queue_{std::make_shared<TransferQueue>(limits)} {}
 
   outcome::result<void> GraphSyncManager::init(
       const std::string &voucher_type,
       std::shared_ptr<RequestValidator> validator) {
     auto receiver = std::make_shared<GraphsyncReceiver>(
-        network_, graphsync_, weak_from_this(), peer_);
+        network_, graphsync_, weak_from_this(), peer_, transfer_queue_);
     OUTCOME_TRY(receiver->registerVoucherType(voucher_type, validator));
     return network_->setDelegate(receiver);
   }
@@ -76,7 +78,7 @@ namespace fc::data_transfer::graphsync {
                     .total_size = 0};
     ChannelState state{.channel = channel, .sent = 0, .received = 0};
 
-    // TODO check thread-safety of channels_
+    std::lock_guard lock{channels_mutex_};
     auto res = channels_.try_emplace(channel_id, state);
     if (!res.second) return GraphsyncManagerError::kStateAlreadyExists;
 
@@ -111,7 +113,7 @@ namespace fc::data_transfer::graphsync {
 
   boost::optional<ChannelState> GraphSyncManager::getChannelByIdAndSender(
       const ChannelId &channel_id, const PeerInfo &sender) {
-    // TODO check thread-safety of channels_
+    std::lock_guard lock{channels_mutex_};
     auto found = channels_.find(channel_id);
     if (found == channels_.end() || found->second.channel.sender != sender) {
       return boost::none;
@@ -120,6 +122,10 @@ namespace fc::data_transfer::graphsync {
     return found->second;
   }
 
+  std::shared_ptr<TransferQueue> GraphSyncManager::transferQueue() const {
+    return transfer_queue_;
+  }
+
   outcome::result<void> GraphSyncManager::sendResponse(bool is_accepted,
                                                        const PeerInfo &to,
                                                        TransferId transfer_id) {
@@ -9,7 +9,10 @@
 #include "data_transfer/manager.hpp"
 
 #include <libp2p/host/host.hpp>
+#include <mutex>
+
 #include "data_transfer/impl/libp2p_data_transfer_network.hpp"
+#include "data_transfer/transfer_queue.hpp"
 #include "data_transfer/types.hpp"
 #include "storage/ipfs/graphsync/graphsync.hpp"
 
@@ -23,7 +26,8 @@ namespace fc::data_transfer::graphsync {
         public std::enable_shared_from_this<GraphSyncManager> {
    public:
     GraphSyncManager(std::shared_ptr<Host> host,
-                     std::shared_ptr<Graphsync> graphsync);
+                     std::shared_ptr<Graphsync> graphsync,
+                     TransferLimits limits = {});
 
     outcome::result<void> init(
         const std::string &voucher_type,
@@ -55,6 +59,9 @@ namespace fc::data_transfer::graphsync {
     boost::optional<ChannelState> getChannelByIdAndSender(
         const ChannelId &channel_id, const PeerInfo &sender) override;
 
+    /// Admits graphsync requests of channels, sets priorities and has stats
+    std::shared_ptr<TransferQueue> transferQueue() const;
+
    private:
     /**
      * Encapsulates message creation and posting to the data transfer network
@@ -84,6 +91,8 @@ namespace fc::data_transfer::graphsync {
     PeerInfo peer_;
     std::shared_ptr<Libp2pDataTransferNetwork> network_;
     std::shared_ptr<Graphsync> graphsync_;
+    std::shared_ptr<TransferQueue> transfer_queue_;
+    std::mutex channels_mutex_;
     std::map<ChannelId, ChannelState> channels_;
   };
 
@@ -12,17 +12,23 @@ namespace fc::data_transfer {
 
   using storage::ipfs::graphsync::isError;
   using storage::ipfs::graphsync::isSuccess;
-  using storage::ipfs::graphsync::ResponseStatusCode;
+  using storage::ipfs::graphsync::isTerminal;
+  using storage::ipfs::graphsync::decodeResponseMetadata;
+  using storage::ipfs::graphsync::encodeDontSendCids;
+  using storage::ipfs::graphsync::encodeMetadataRequest;
+  using storage::ipfs::graphsync::kResponseMetadataProtocol;
 
   GraphsyncReceiver::GraphsyncReceiver(
       std::weak_ptr<DataTransferNetwork> network,
       std::shared_ptr<Graphsync> graphsync,
       std::weak_ptr<Manager> graphsync_manager,
-      PeerInfo peer)
+      PeerInfo peer,
+      std::shared_ptr<TransferQueue> transfer_queue)
       : network_(std::move(network)),
         graphsync_(std::move(graphsync)),
         graphsync_manager_(std::move(graphsync_manager)),
-        peer_(std::move(peer)) {}
+        peer_(std::move(peer)),
+        transfer_queue_(std::move(transfer_queue)) {}
 
   outcome::result<void> GraphsyncReceiver::receiveRequest(
       const PeerInfo &initiator, const DataTransferRequest &request) {
@@ -56,7 +62,8 @@ namespace fc::data_transfer {
                                          request.is_pull,
                                          initiator,
                                          base_cid,
-                                         request.selector));
+                                         request.selector,
+                                         request.voucher_type));
         auto channel = manager->createChannel(request.transfer_id,
                                               base_cid,
                                               selector,
@@ -97,6 +104,8 @@ namespace fc::data_transfer {
               channel_state->channel.base_cid,
               // TODO (a.chernyshov) implement selectors and
               // serialize channel_state->channel.selector
+              {},
+              // voucher type is not kept in channel, default priority
               {}));
           event.code = EventCode::PROGRESS;
           notifySubscribers(event, *channel_state);
@@ -137,42 +146,137 @@ namespace fc::data_transfer {
       bool is_pull,
       const PeerInfo &sender,
       const CID &root,
-      gsl::span<const uint8_t> selector) {
+      gsl::span<const uint8_t> selector,
+      const std::string &voucher_type) {
     ExtensionDataTransferData extension_data{
         .transfer_id = transfer_id,
         .initiator = peerInfoToPrettyString(initiator),
         .is_pull = is_pull};
     OUTCOME_TRY(extension, encodeDataTransferExtension(extension_data));
 
-    graphsync_->makeRequest(
-        sender.id,
+    ChannelId channel_id{.initiator = initiator, .id = transfer_id};
+    Transfer transfer{.initiator = initiator,
+                      .transfer_id = transfer_id,
+                      .is_pull = is_pull,
+                      .sender = sender,
+                      .root = root,
+                      .selector = {selector.begin(), selector.end()},
+                      .voucher_type = voucher_type,
+                      .extension = std::move(extension),
+                      .received = {},
+                      .restarts = 0,
+                      .subscription = {}};
+    transfers_.insert_or_assign(channel_id, std::move(transfer));
+    transfer_queue_->enqueue(is_pull, voucher_type, [this, channel_id] {
+      makeRequest(channel_id);
+    });
+    return outcome::success();
+  }
+
+  void GraphsyncReceiver::makeRequest(const ChannelId &channel_id) {
+    auto it = transfers_.find(channel_id);
+    if (it == transfers_.end()) {
+      return;
+    }
+    auto &transfer = it->second;
+    std::vector<Extension> extensions{transfer.extension,
+                                      encodeMetadataRequest()};
+    if (!transfer.received.empty()) {
+      extensions.push_back(encodeDontSendCids(
+          {transfer.received.begin(), transfer.received.end()}));
+    }
+    transfer.subscription = graphsync_->makeRequest(
+        transfer.sender.id,
         boost::none,
-        root,
-        selector,
-        {extension},
-        [this, initiator, transfer_id, sender](
-            ResponseStatusCode code, std::vector<Extension> extensions) {
-          Event event{.code = EventCode::ERROR,
-                      .message = "",
-                      .timestamp = clock::UTCClockImpl().nowUTC()};
-
-          ChannelId channel_id{.initiator = initiator, .id = transfer_id};
-          if (auto manager = graphsync_manager_.lock()) {
-            auto channel = manager->getChannelByIdAndSender(channel_id, sender);
-            if (!channel) {
-              event.code = EventCode::ERROR;
-              event.message = "cannot find a matching channel for this request";
-            } else if (isError(code)) {
-              event.code = EventCode::ERROR;
-              event.message = statusCodeToString(code);
-            } else if (isSuccess(code)) {
-              event.code = EventCode::COMPLETE;
-            }
+        transfer.root,
+        transfer.selector,
+        extensions,
+        [this, channel_id](ResponseStatusCode code,
+                           std::vector<Extension> extensions) {
+          onResponse(channel_id, code, extensions);
+        });
+  }
 
-            this->notifySubscribers(event, *channel);
+  void GraphsyncReceiver::onResponse(const ChannelId &channel_id,
+                                     ResponseStatusCode code,
+                                     const std::vector<Extension> &extensions) {
+    auto it = transfers_.find(channel_id);
+    if (it == transfers_.end()) {
+      return;
+    }
+    auto &transfer = it->second;
+    for (const auto &extension : extensions) {
+      if (extension.name == kResponseMetadataProtocol) {
+        if (auto metadata = decodeResponseMetadata(extension)) {
+          for (const auto &[cid, present] : metadata.value()) {
+            if (present) {
+              transfer.received.insert(cid);
+            }
           }
-        });
-    return outcome::success();
+        }
+      }
+    }
+    if (!isTerminal(code)) {
+      return;
+    }
+    transfer_queue_->finish(transfer.is_pull);
+
+    auto manager = graphsync_manager_.lock();
+    if (!manager) {
+      return;
+    }
+    auto channel =
+        manager->getChannelByIdAndSender(channel_id, transfer.sender);
+    Event event{.code = EventCode::ERROR,
+                .message = "",
+                .timestamp = clock::UTCClockImpl().nowUTC()};
+    if (channel && isRestartable(code)
+        && transfer.restarts < kMaxTransferRestarts) {
+      ++transfer.restarts;
+      logger_->warn("graphsync request of transfer {} failed: {}, restart {}",
+                    channel_id.id,
+                    statusCodeToString(code),
+                    transfer.restarts);
+      event.code = EventCode::PROGRESS;
+      event.message = "restarted after " + statusCodeToString(code);
+      notifySubscribers(event, *channel);
+      transfer_queue_->enqueue(
+          transfer.is_pull, transfer.voucher_type, [this, channel_id] {
+            makeRequest(channel_id);
+          });
+      return;
+    }
+
+    if (!channel) {
+      event.code = EventCode::ERROR;
+      event.message = "cannot find a matching channel for this request";
+    } else if (isError(code)) {
+      event.code = EventCode::ERROR;
+      event.message = statusCodeToString(code);
+    } else if (isSuccess(code)) {
+      event.code = EventCode::COMPLETE;
+    }
+    // subscription is dropped after callback returns
+    auto finished = std::move(transfer.subscription);
+    transfers_.erase(it);
+    if (channel) {
+      notifySubscribers(event, *channel);
+    }
+  }
+
+  bool GraphsyncReceiver::isRestartable(ResponseStatusCode code) {
+    using namespace storage::ipfs::graphsync;
+    switch (code) {
+      case RS_CANNOT_CONNECT:
+      case RS_TIMEOUT:
+      case RS_CONNECTION_ERROR:
+      case RS_SLOW_STREAM:
+      case RS_TRY_AGAIN:
+      case RS_REQUEST_FAILED:
+        return true;
+      default:
+        return false;
+    }
   }
 
   void GraphsyncReceiver::notifySubscribers(const Event &event,
@@ -8,6 +8,9 @@
 
 #include "data_transfer/message_receiver.hpp"
 
+#include <map>
+#include <set>
+
 #include "common/logger.hpp"
 #include "data_transfer/impl/graphsync/graphsync_manager.hpp"
 #include "data_transfer/impl/libp2p_data_transfer_network.hpp"
@@ -15,14 +18,21 @@
 
 namespace fc::data_transfer {
 
+  using storage::ipfs::graphsync::Extension;
   using storage::ipfs::graphsync::Graphsync;
+  using storage::ipfs::graphsync::ResponseStatusCode;
+  using storage::ipfs::graphsync::Subscription;
+
+  /// Graphsync requests of transfer restarted after failures, at most
+  constexpr size_t kMaxTransferRestarts{3};
 
   class GraphsyncReceiver : public MessageReceiver {
    public:
     GraphsyncReceiver(std::weak_ptr<DataTransferNetwork> network,
                       std::shared_ptr<Graphsync> graphsync,
                       std::weak_ptr<Manager> graphsync_manager,
-                      PeerInfo peer);
+                      PeerInfo peer,
+                      std::shared_ptr<TransferQueue> transfer_queue);
 
     outcome::result<void> receiveRequest(
         const PeerInfo &initiator, const DataTransferRequest &request) override;
@@ -43,7 +53,9 @@ namespace fc::data_transfer {
 
     /**
      * Assembles a graphsync request and determines if the transfer was
-     * completed/successful. Notifies subscribers of final request status
+     * completed/successful. Notifies subscribers of final request status.
+     * Request is started when transfer queue admits it.
+     * @param voucher_type - selects priority of request in transfer queue
      * @return
      */
     outcome::result<void> sendGraphSyncRequest(
@@ -52,7 +64,37 @@ namespace fc::data_transfer {
         bool is_pull,
         const PeerInfo &sender,
         const CID &root,
-        gsl::span<const uint8_t> selector);
+        gsl::span<const uint8_t> selector,
+        const std::string &voucher_type);
+
+    /// Graphsync request of transfer and its progress
+    struct Transfer {
+      PeerInfo initiator;
+      TransferId transfer_id;
+      bool is_pull;
+      PeerInfo sender;
+      CID root;
+      std::vector<uint8_t> selector;
+      std::string voucher_type;
+      Extension extension;
+      /// Blocks reported received by response metadata, not requested again
+      /// on restart
+      std::set<CID> received;
+      size_t restarts{};
+      Subscription subscription;
+    };
+
+    /// Starts graphsync request admitted by transfer queue, blocks received
+    /// before are excluded with "do-not-send-cids" extension
+    void makeRequest(const ChannelId &channel_id);
+
+    /// Handles progress of graphsync request
+    void onResponse(const ChannelId &channel_id,
+                    ResponseStatusCode code,
+                    const std::vector<Extension> &extensions);
+
+    /// Whether failed request may succeed if sent again
+    static bool isRestartable(ResponseStatusCode code);
 
     void notifySubscribers(const Event &event,
                            const ChannelState &channel_state);
@@ -61,7 +103,9 @@ namespace fc::data_transfer {
     std::shared_ptr<Graphsync> graphsync_;
     std::weak_ptr<Manager> graphsync_manager_;
     PeerInfo peer_;
+    std::shared_ptr<TransferQueue> transfer_queue_;
     std::vector<std::shared_ptr<Subscriber>> subscribers_;
+    std::map<ChannelId, Transfer> transfers_;
     common::Logger logger_ = common::createLogger("GraphsyncReceiver");
   };
 
@@ -0,0 +1,83 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "data_transfer/transfer_queue.hpp"
+
+#include <algorithm>
+
+namespace fc::data_transfer {
+
+  TransferQueue::TransferQueue(TransferLimits limits) {
+    pulls_.limit = std::max<size_t>(1, limits.max_pulls);
+    pushes_.limit = std::max<size_t>(1, limits.max_pushes);
+  }
+
+  void TransferQueue::setPriority(const std::string &voucher_type,
+                                  TransferPriority priority) {
+    std::lock_guard lock{mutex_};
+    priorities_[voucher_type] = priority;
+  }
+
+  void TransferQueue::enqueue(bool is_pull,
+                              const std::string &voucher_type,
+                              Start start) {
+    {
+      std::lock_guard lock{mutex_};
+      auto &queue{direction(is_pull)};
+      if (queue.active >= queue.limit) {
+        auto it{priorities_.find(voucher_type)};
+        auto priority{it != priorities_.end() ? it->second
+                                              : TransferPriority::kNormal};
+        queue.queued[priority].push_back(std::move(start));
+        return;
+      }
+      ++queue.active;
+    }
+    start();
+  }
+
+  void TransferQueue::finish(bool is_pull) {
+    Start next;
+    {
+      std::lock_guard lock{mutex_};
+      auto &queue{direction(is_pull)};
+      ++finished_;
+      if (queue.queued.empty()) {
+        if (queue.active != 0) {
+          --queue.active;
+        }
+        return;
+      }
+      // slot passes to next transfer
+      auto first{queue.queued.begin()};
+      next = std::move(first->second.front());
+      first->second.pop_front();
+      if (first->second.empty()) {
+        queue.queued.erase(first);
+      }
+    }
+    next();
+  }
+
+  TransferQueue::Stats TransferQueue::stats() const {
+    std::lock_guard lock{mutex_};
+    Stats stats;
+    stats.active_pulls = pulls_.active;
+    stats.active_pushes = pushes_.active;
+    for (const auto &[_, queued] : pulls_.queued) {
+      stats.queued_pulls += queued.size();
+    }
+    for (const auto &[_, queued] : pushes_.queued) {
+      stats.queued_pushes += queued.size();
+    }
+    stats.finished = finished_;
+    return stats;
+  }
+
+  TransferQueue::Direction &TransferQueue::direction(bool is_pull) {
+    return is_pull ? pulls_ : pushes_;
+  }
+
+}  // namespace fc::data_transfer
@@ -0,0 +1,84 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_DATA_TRANSFER_TRANSFER_QUEUE_HPP
+#define CPP_FILECOIN_DATA_TRANSFER_TRANSFER_QUEUE_HPP
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace fc::data_transfer {
+
+  /// Queued transfers of higher priority start first
+  enum class TransferPriority { kLow, kNormal, kHigh };
+
+  struct TransferLimits {
+    /// Concurrent transfers of channels opened by pull request
+    size_t max_pulls{8};
+    /// Concurrent transfers of channels opened by push request
+    size_t max_pushes{8};
+  };
+
+  /**
+   * Admits data transfers, so burst of transfers of one kind doesn't occupy
+   * all bandwidth. Transfer starts when there is a free slot of its
+   * direction, otherwise it waits in queue ordered by priority of its voucher
+   * type and then by arrival.
+   */
+  class TransferQueue {
+   public:
+    using Start = std::function<void()>;
+
+    struct Stats {
+      size_t active_pulls{};
+      size_t active_pushes{};
+      size_t queued_pulls{};
+      size_t queued_pushes{};
+      /// Transfers finished since queue creation
+      uint64_t finished{};
+    };
+
+    explicit TransferQueue(TransferLimits limits);
+
+    /// Sets priority of transfers with voucher type, default is normal
+    void setPriority(const std::string &voucher_type,
+                     TransferPriority priority);
+
+    /**
+     * Starts transfer if slot is free or queues it
+     * @param is_pull - direction of transfer
+     * @param voucher_type - selects priority
+     * @param start - starts transfer, called without lock held
+     */
+    void enqueue(bool is_pull, const std::string &voucher_type, Start start);
+
+    /// Frees slot of finished transfer and starts next queued one
+    void finish(bool is_pull);
+
+    Stats stats() const;
+
+   private:
+    struct Direction {
+      size_t limit{};
+      size_t active{};
+      /// Queued transfers by priority, fifo within same priority
+      std::map<TransferPriority, std::deque<Start>, std::greater<>> queued;
+    };
+
+    Direction &direction(bool is_pull);
+
+    mutable std::mutex mutex_;
+    std::map<std::string, TransferPriority> priorities_;
+    Direction pulls_;
+    Direction pushes_;
+    uint64_t finished_{};
+  };
+
+}  // namespace fc::data_transfer
+
+#endif  // CPP_FILECOIN_DATA_TRANSFER_TRANSFER_QUEUE_HPP
@@ -6,6 +6,7 @@
 #ifndef CPP_FILECOIN_CORE_DRAND_BEACONIZER_HPP
 #define CPP_FILECOIN_CORE_DRAND_BEACONIZER_HPP
 
+#include "common/logger.hpp"
 #include "common/outcome.hpp"
 #include "drand/messages.hpp"
 #include "primitives/chain_epoch/chain_epoch.hpp"
@@ -29,12 +30,28 @@ namespace fc::drand {
     virtual outcome::result<uint64_t> maxBeaconRoundForEpoch(
         ChainEpoch fil_epoch) = 0;
 
+    /// Fetches and verifies entries of rounds range in advance, if supported
+    virtual outcome::result<void> prefetch(uint64_t from, uint64_t to) {
+      return outcome::success();
+    }
+
     inline outcome::result<std::vector<BeaconEntry>> beaconEntriesForBlock(
         ChainEpoch fil_epoch, const BeaconEntry &prev) {
       std::vector<BeaconEntry> beacons;
       OUTCOME_TRY(max_round, maxBeaconRoundForEpoch(fil_epoch));
       if (max_round != prev.round) {
         auto prev_round{prev.round == 0 ? max_round - 1 : prev.round};
+        if (max_round - prev_round > 1) {
+          // entries are fetched one by one if prefetch fails
+          if (auto prefetched{prefetch(prev_round + 1, max_round)};
+              !prefetched) {
+            common::createLogger("beaconizer")
+                ->warn("prefetch of rounds {}-{} failed: {}",
+                       prev_round + 1,
+                       max_round,
+                       prefetched.error().message());
+          }
+        }
         for (auto round{max_round}; round > prev_round; --round) {
           OUTCOME_TRY(beacon, entry(round));
           BOOST_ASSERT(beacon.round == round);
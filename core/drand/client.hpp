@@ -6,6 +6,7 @@
 #ifndef CPP_FILECOIN_CORE_DRAND_CLIENT_HPP
 #define CPP_FILECOIN_CORE_DRAND_CLIENT_HPP
 
+#include "common/outcome.hpp"
 #include "drand/messages.hpp"
 
 namespace fc::drand {
@@ -33,12 +33,29 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::drand, BeaconizerImpl::Error, e) {
 }
 
 namespace fc::drand {
+  using common::Buffer;
+
+  /// Prefix of stored entries
+  const std::string kEntryPrefix{"/drand/"};
+
+  /// Message signed by beacon of round
+  auto beaconMessage(uint64_t round,
+                     gsl::span<const uint8_t> previous_signature) {
+    std::vector<uint8_t> buffer;
+    buffer.reserve(previous_signature.size() + sizeof(uint64_t));
+    buffer.insert(
+        buffer.end(), previous_signature.begin(), previous_signature.end());
+    libp2p::common::putUint64BE(buffer, round);
+    return libp2p::crypto::sha256(buffer);
+  }
+
   outcome::result<std::unique_ptr<BeaconizerImpl>> BeaconizerImpl::create(
       uint64_t filecoin_genesis_time,
       uint64_t filecoin_round_time,
       std::vector<std::string> drand_servers,
       gsl::span<const uint8_t> network_public_key,
-      size_t max_cache_size) {
+      size_t max_cache_size,
+      std::shared_ptr<storage::PersistentBufferMap> store) {
     if (drand_servers.empty()) {
       return Error::kEmptyServersList;
     }
@@ -56,36 +73,47 @@ namespace fc::drand {
                           uint64_t filecoin_round_time,
                           std::vector<std::string> drand_servers,
                           crypto::bls::PublicKey network_public_key,
-                          size_t max_cache_size)
+                          size_t max_cache_size,
+                          std::shared_ptr<storage::PersistentBufferMap> store)
           : BeaconizerImpl{filecoin_genesis_time,
                            filecoin_round_time,
                            std::move(drand_servers),
                            std::move(network_public_key),
-                           max_cache_size} {};
+                           max_cache_size,
+                           std::move(store)} {};
     };
     auto instance =
         std::make_unique<make_unique_enabler>(filecoin_genesis_time,
                                               filecoin_round_time,
                                               std::move(drand_servers),
                                               std::move(net_key),
-                                              max_cache_size);
+                                              max_cache_size,
+                                              std::move(store));
     OUTCOME_TRY(instance->init());
     return outcome::success(std::move(instance));
   }
 
-  BeaconizerImpl::BeaconizerImpl(uint64_t filecoin_genesis_time,
-                                 uint64_t filecoin_round_time,
-                                 std::vector<std::string> drand_servers,
-                                 crypto::bls::PublicKey network_public_key,
-                                 size_t max_cache_size)
+  BeaconizerImpl::BeaconizerImpl(
+      uint64_t filecoin_genesis_time,
+      uint64_t filecoin_round_time,
+      std::vector<std::string> drand_servers,
+      crypto::bls::PublicKey network_public_key,
+      size_t max_cache_size,
+      std::shared_ptr<storage::PersistentBufferMap> store)
       : fil_gen_time_{filecoin_genesis_time},
         fil_round_time_{filecoin_round_time},
         peers_{std::move(drand_servers)},
         network_key_{std::move(network_public_key)},
         cache_{max_cache_size},
-        bls_{std::make_unique<crypto::bls::BlsProviderImpl>()} {
+        store_{std::move(store)},
+        bls_{std::make_unique<crypto::bls::BlsProviderImpl>()},
+        scores_{std::make_shared<DrandPeers>()} {
     BOOST_ASSERT(not peers_.empty());
     BOOST_ASSERT(max_cache_size > 0);
+    for (auto &peer : peers_) {
+      scores_->clients.push_back(std::make_shared<DrandSyncClientImpl>(peer));
+    }
+    scores_->latency.resize(peers_.size());
   }
 
   outcome::result<BeaconEntry> BeaconizerImpl::entry(uint64_t round) {
@@ -96,7 +124,17 @@ namespace fc::drand {
       return entry;
     }
 
-    auto response = client_->publicRand(round);
+    auto response = hedgedPublicRand(
+        requests_, scores_, round, [&](auto &reply) -> outcome::result<void> {
+          OUTCOME_TRY(valid,
+                      verifyBeaconData(reply.round,
+                                       reply.signature,
+                                       reply.previous_signature));
+          if (!valid) {
+            return Error::kInvalidBeacon;
+          }
+          return outcome::success();
+        });
     if (response) {
       entry.data = std::move(response.value().signature);
       return entry;
@@ -121,6 +159,58 @@ namespace fc::drand {
     return outcome::success();
   }
 
+  outcome::result<void> BeaconizerImpl::prefetch(uint64_t from, uint64_t to) {
+    while (from <= to && lookupCache(from)) {
+      ++from;
+    }
+    if (from > to) {
+      return outcome::success();
+    }
+    OUTCOME_TRY(responses, client_->publicRandStream(from));
+    std::vector<PublicRandResponse> chain;
+    for (auto &response : responses) {
+      if (response.round < from || response.round > to) {
+        continue;
+      }
+      // consecutive entries must be chained by signatures
+      if (!chain.empty() && chain.back().round + 1 == response.round
+          && chain.back().signature != response.previous_signature) {
+        return Error::kInvalidBeacon;
+      }
+      chain.push_back(std::move(response));
+    }
+    if (chain.empty()) {
+      return outcome::success();
+    }
+    for (auto &response : chain) {
+      OUTCOME_TRY(valid,
+                  verifyBeaconData(response.round,
+                                   response.signature,
+                                   response.previous_signature));
+      if (!valid) {
+        return Error::kInvalidBeacon;
+      }
+    }
+    std::unique_ptr<storage::BufferBatch> batch;
+    if (store_) {
+      batch = store_->batch();
+    }
+    for (auto &response : chain) {
+      {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        cache_.insert(response.round, response.signature);
+      }
+      if (batch) {
+        OUTCOME_TRY(batch->put(storeKey(response.round),
+                               Buffer{response.signature}));
+      }
+    }
+    if (batch) {
+      OUTCOME_TRY(batch->commit());
+    }
+    return outcome::success();
+  }
+
   outcome::result<uint64_t> BeaconizerImpl::maxBeaconRoundForEpoch(
       ChainEpoch fil_epoch) {
     if (fil_epoch < 0) {
@@ -163,42 +253,61 @@ namespace fc::drand {
   }
 
   boost::optional<Bytes> BeaconizerImpl::lookupCache(uint64_t round) {
+    {
+      std::lock_guard<std::mutex> lock(cache_mutex_);
+      auto bytes = cache_.get(round);
+      if (bytes || !store_) {
+        return bytes;
+      }
+    }
+    auto key{storeKey(round)};
+    if (!store_->contains(key)) {
+      return boost::none;
+    }
+    auto stored{store_->get(key)};
+    if (!stored) {
+      return boost::none;
+    }
+    Bytes bytes{stored.value().begin(), stored.value().end()};
     std::lock_guard<std::mutex> lock(cache_mutex_);
-    auto bytes = cache_.get(round);
+    cache_.insert(round, bytes);
     return bytes;
   }
 
   void BeaconizerImpl::cacheEntry(uint64_t round, const Bytes &signature) {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    cache_.insert(round, signature);
+    {
+      std::lock_guard<std::mutex> lock(cache_mutex_);
+      cache_.insert(round, signature);
+    }
+    if (store_) {
+      // entry is verified again if it is not stored
+      std::ignore = store_->put(storeKey(round), Buffer{signature});
+    }
+  }
+
+  Buffer BeaconizerImpl::storeKey(uint64_t round) {
+    return Buffer{}.put(kEntryPrefix).putUint64(round);
   }
 
   outcome::result<bool> BeaconizerImpl::verifyBeaconData(
       uint64_t round,
       gsl::span<const uint8_t> signature,
       gsl::span<const uint8_t> previous_signature) {
-    auto message = [round, &previous_signature]() {
-      std::vector<uint8_t> buffer;
-      buffer.reserve(previous_signature.size() + sizeof(uint64_t));
-      buffer.insert(
-          buffer.end(), previous_signature.begin(), previous_signature.end());
-      libp2p::common::putUint64BE(buffer, round);
-      auto hash = libp2p::crypto::sha256(buffer);
-      return hash;
-    };
     crypto::bls::Signature bls_sig;
     if (bls_sig.size() != signature.size()) {
       return Error::kInvalidSignatureFormat;
     }
     std::copy(signature.begin(), signature.end(), bls_sig.begin());
     OUTCOME_TRY(is_valid,
-                bls_->verifySignature(message(), bls_sig, network_key_));
+                bls_->verifySignature(beaconMessage(round, previous_signature),
+                                      bls_sig,
+                                      network_key_));
     return is_valid;
   }
 
   void BeaconizerImpl::rotatePeersIndex() {
     boost::random::mt19937 rng;
-    boost::random::uniform_int_distribution<> generator(1, peers_.size());
+    boost::random::uniform_int_distribution<> generator(0, peers_.size() - 1);
     auto new_index = generator(rng);
     peer_index_.store(new_index);
   }
@@ -7,6 +7,7 @@
 #define CPP_FILECOIN_CORE_DRAND_IMPL_BEACONIZER_HPP
 
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -19,6 +20,8 @@
 #include "crypto/bls/bls_types.hpp"
 #include "drand/beaconizer.hpp"
 #include "drand/client.hpp"
+#include "drand/impl/hedged.hpp"
+#include "storage/buffer_map.hpp"
 
 namespace fc::crypto::bls {
   class BlsProvider;
@@ -46,6 +49,8 @@ namespace fc::drand {
      * specified
      * @param network_public_key - known key for the drand network
      * @param max_cache_size - beacon entries cache limit
+     * @param store - optional, keeps verified entries under "/drand/" prefix
+     * across restarts
      * @return unique pointer to an instance
      */
     static outcome::result<std::unique_ptr<BeaconizerImpl>> create(
@@ -53,7 +58,8 @@ namespace fc::drand {
         uint64_t filecoin_round_time,
         std::vector<std::string> drand_servers,
         gsl::span<const uint8_t> network_public_key,
-        size_t max_cache_size);
+        size_t max_cache_size,
+        std::shared_ptr<storage::PersistentBufferMap> store = nullptr);
 
     outcome::result<BeaconEntry> entry(uint64_t round) override;
 
@@ -63,6 +69,12 @@ namespace fc::drand {
     outcome::result<uint64_t> maxBeaconRoundForEpoch(
         ChainEpoch fil_epoch) override;
 
+    /**
+     * Streams entries from first round in one request, checks that they are
+     * chained, verifies signature of each and caches them
+     */
+    outcome::result<void> prefetch(uint64_t from, uint64_t to) override;
+
    private:
     //
     // METHODS
@@ -72,7 +84,8 @@ namespace fc::drand {
                    uint64_t filecoin_round_time,
                    std::vector<std::string> drand_servers,
                    crypto::bls::PublicKey network_public_key,
-                   size_t max_cache_size);
+                   size_t max_cache_size,
+                   std::shared_ptr<storage::PersistentBufferMap> store);
 
     outcome::result<void> init();
 
@@ -82,6 +95,8 @@ namespace fc::drand {
 
     void cacheEntry(uint64_t round, const Bytes &signature);
 
+    static common::Buffer storeKey(uint64_t round);
+
     outcome::result<bool> verifyBeaconData(
         uint64_t round,
         gsl::span<const uint8_t> signature,
@@ -106,12 +121,19 @@ namespace fc::drand {
 
     std::mutex cache_mutex_;
     boost::compute::detail::lru_cache<uint64_t, Bytes> cache_;
+    std::shared_ptr<storage::PersistentBufferMap> store_;
 
     std::unique_ptr<crypto::bls::BlsProvider> bls_;
     std::unique_ptr<DrandSyncClient> client_;
 
+    /// Clients and latency scores of servers, shared with pending requests
+    std::shared_ptr<DrandPeers> scores_;
+
     uint64_t drand_gen_time_;
     uint64_t drand_interval_;
+
+    /// Runs hedged requests, joined before other fields are destroyed
+    boost::asio::thread_pool requests_{kHedgedThreads};
   };
 }  // namespace fc::drand
 
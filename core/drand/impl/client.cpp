@@ -5,6 +5,7 @@
 
 #include "client.hpp"
 
+#include <chrono>
 #include <utility>
 
 #include "network/grpc_channel_builder.hpp"
@@ -19,6 +20,11 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::drand, DrandSyncClientImpl::Error, e) {
 }
 
 namespace fc::drand {
+  /// Deadline of single round or group request
+  constexpr std::chrono::seconds kRequestTimeout{10};
+  /// Deadline of round stream request
+  constexpr std::chrono::minutes kStreamTimeout{5};
+
   DrandSyncClientImpl::DrandSyncClientImpl(
       std::string address, boost::optional<std::string> pem_root_certs)
       : address_{std::move(address)},
@@ -37,6 +43,7 @@ namespace fc::drand {
     ::drand::PublicRandRequest request;
     request.set_round(round);
     grpc::ClientContext context;
+    context.set_deadline(std::chrono::system_clock::now() + kRequestTimeout);
     ::drand::PublicRandResponse response;
     auto status = stub_->PublicRand(&context, request, &response);
     if (not status.ok()) {
@@ -50,6 +57,7 @@ namespace fc::drand {
     ::drand::PublicRandRequest request;
     request.set_round(round);
     grpc::ClientContext context;
+    context.set_deadline(std::chrono::system_clock::now() + kStreamTimeout);
     auto reader = stub_->PublicRandStream(&context, request);
     std::vector<PublicRandResponse> result;
     ::drand::PublicRandResponse response;
@@ -66,6 +74,7 @@ namespace fc::drand {
   outcome::result<GroupPacket> DrandSyncClientImpl::group() {
     ::drand::GroupRequest request;
     grpc::ClientContext context;
+    context.set_deadline(std::chrono::system_clock::now() + kRequestTimeout);
     ::drand::GroupPacket response;
     auto status = stub_->Group(&context, request, &response);
     if (not status.ok()) {
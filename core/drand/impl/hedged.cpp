@@ -0,0 +1,124 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "drand/impl/hedged.hpp"
+
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include <condition_variable>
+#include <numeric>
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::drand, HedgedError, e) {
+  using E = fc::drand::HedgedError;
+  switch (e) {
+    case E::kNoPeers:
+      return "No drand servers to ask.";
+    case E::kRoundMismatch:
+      return "Drand server returned other round than requested.";
+    default:
+      return "unknown error";
+  }
+}
+
+namespace fc::drand {
+  /// Weight of last request in latency average
+  constexpr double kLatencyWeight{0.2};
+  /// Latency counted for failed request, in ms
+  constexpr double kFailureLatency{10000};
+  /// Servers slower than fastest by this factor are not asked
+  constexpr double kEjectFactor{4};
+
+  std::vector<size_t> DrandPeers::fastest(size_t count) {
+    std::lock_guard lock{mutex};
+    std::vector<size_t> indices(latency.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    auto score{[&](size_t i) { return latency[i].value_or(0); }};
+    std::stable_sort(indices.begin(), indices.end(), [&](auto l, auto r) {
+      return score(l) < score(r);
+    });
+    auto best{std::find_if(indices.begin(),
+                           indices.end(),
+                           [&](auto i) { return latency[i].has_value(); })};
+    size_t asked{0};
+    while (asked < std::min(count, indices.size())
+           && (asked == 0 || !latency[indices[asked]]
+               || score(indices[asked]) <= score(*best) * kEjectFactor)) {
+      ++asked;
+    }
+    indices.resize(asked);
+    return indices;
+  }
+
+  void DrandPeers::update(size_t index,
+                          boost::optional<std::chrono::nanoseconds> latency) {
+    auto sample{latency ? std::chrono::duration<double, std::milli>{*latency}
+                              .count()
+                        : kFailureLatency};
+    std::lock_guard lock{mutex};
+    auto &average{this->latency[index]};
+    average = average
+                  ? (1 - kLatencyWeight) * *average + kLatencyWeight * sample
+                  : sample;
+  }
+
+  outcome::result<PublicRandResponse> hedgedPublicRand(
+      boost::asio::thread_pool &pool,
+      const std::shared_ptr<DrandPeers> &peers,
+      uint64_t round,
+      const VerifyResponse &verify) {
+    struct Race {
+      std::mutex mutex;
+      std::condition_variable done;
+      std::vector<PublicRandResponse> responses;
+      size_t pending{};
+      std::error_code error{HedgedError::kNoPeers};
+    };
+    auto race{std::make_shared<Race>()};
+    auto asked{peers->fastest(kHedgedRequests)};
+    race->pending = asked.size();
+    for (auto peer : asked) {
+      // slower request outlives call, so it holds shared state only
+      auto request{[race, peers, client{peers->clients[peer]}, peer, round] {
+        auto start{std::chrono::steady_clock::now()};
+        auto response{client->publicRand(round)};
+        if (response && response.value().round != round) {
+          response = HedgedError::kRoundMismatch;
+        }
+        boost::optional<std::chrono::nanoseconds> latency;
+        if (response) {
+          latency = std::chrono::steady_clock::now() - start;
+        }
+        peers->update(peer, latency);
+        std::lock_guard lock{race->mutex};
+        --race->pending;
+        if (response) {
+          race->responses.push_back(std::move(response.value()));
+        } else {
+          race->error = response.error();
+        }
+        race->done.notify_one();
+      }};
+      boost::asio::post(pool, std::move(request));
+    }
+    std::unique_lock lock{race->mutex};
+    while (true) {
+      race->done.wait(lock, [&] {
+        return !race->responses.empty() || race->pending == 0;
+      });
+      if (race->responses.empty()) {
+        return race->error;
+      }
+      auto response{std::move(race->responses.back())};
+      race->responses.pop_back();
+      lock.unlock();
+      auto valid{verify(response)};
+      if (valid) {
+        return response;
+      }
+      lock.lock();
+      race->error = valid.error();
+    }
+  }
+}  // namespace fc::drand
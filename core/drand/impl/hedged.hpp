@@ -0,0 +1,64 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_DRAND_IMPL_HEDGED_HPP
+#define CPP_FILECOIN_CORE_DRAND_IMPL_HEDGED_HPP
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/asio/thread_pool.hpp>
+#include <boost/optional.hpp>
+
+#include "drand/client.hpp"
+
+namespace fc::drand {
+  enum class HedgedError {
+    kNoPeers = 1,
+    kRoundMismatch,
+  };
+
+  /// Servers asked for same round at once
+  constexpr size_t kHedgedRequests{2};
+  /// Threads of requests, slower requests of previous rounds finish on them
+  constexpr size_t kHedgedThreads{2 * kHedgedRequests};
+
+  /// Clients and latency scores of servers, shared with pending requests
+  struct DrandPeers {
+    /// Indices of fastest servers, unmeasured first, slow ones ejected
+    std::vector<size_t> fastest(size_t count);
+
+    /// Updates latency average with request time, none if it failed
+    void update(size_t index,
+                boost::optional<std::chrono::nanoseconds> latency);
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<DrandSyncClient>> clients;
+    /// Exponentially weighted request latency in ms, none until measured
+    std::vector<boost::optional<double>> latency;
+  };
+
+  using VerifyResponse =
+      std::function<outcome::result<void>(const PublicRandResponse &)>;
+
+  /**
+   * Requests round from fastest servers at once and returns first answer
+   * of requested round which passes verification, so one slow server
+   * doesn't delay entry
+   * @param pool - runs requests, slower request outlives call on it
+   */
+  outcome::result<PublicRandResponse> hedgedPublicRand(
+      boost::asio::thread_pool &pool,
+      const std::shared_ptr<DrandPeers> &peers,
+      uint64_t round,
+      const VerifyResponse &verify);
+}  // namespace fc::drand
+
+OUTCOME_HPP_DECLARE_ERROR(fc::drand, HedgedError);
+
+#endif  // CPP_FILECOIN_CORE_DRAND_IMPL_HEDGED_HPP
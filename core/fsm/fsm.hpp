@@ -6,18 +6,20 @@
 #ifndef CPP_FILECOIN_CORE_FSM_FSM_HPP
 #define CPP_FILECOIN_CORE_FSM_FSM_HPP
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <set>
 #include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
 
+#include <boost/asio/post.hpp>
+#include <boost/asio/strand.hpp>
 #include <boost/optional.hpp>
-#include <libp2p/protocol/common/asio/asio_scheduler.hpp>
-#include <libp2p/protocol/common/scheduler.hpp>
 #include "common/outcome.hpp"
 #include "host/context/host_context.hpp"
 
@@ -30,10 +32,9 @@
  */
 namespace fc::fsm {
   using fc::common::EnumClassHash;
-  using libp2p::protocol::Scheduler;
-  using Ticks = libp2p::protocol::Scheduler::Ticks;
 
-  const Scheduler::Ticks kSlowModeDelayMs = 100;
+  /// Default number of strands entities of state machine are sharded across
+  constexpr size_t kDefaultShards{8};
 
   /**
    * Container for state transitions caused by an event
@@ -225,7 +226,13 @@ namespace fc::fsm {
   };
 
   /**
-   * Finite State Machine implementation
+   * Finite State Machine implementation.
+   *
+   * Events are dispatched as soon as they are sent. Entities are sharded
+   * across strands of host io context, so events of one entity are handled
+   * in order they were sent, and entities of different shards are handled in
+   * parallel when io context is run by several threads.
+   *
    * @tparam EventEnumType - enum class with list of events
    * @tparam StateEnumType - enum class with list of states
    * @tparam Entity - type of handled objects, actually std::shared_ptr<Entity>
@@ -235,7 +242,6 @@ namespace fc::fsm {
    public:
     using EntityPtr = std::shared_ptr<Entity>;
     using TransitionRule = Transition<EventEnumType, StateEnumType, Entity>;
-    using EventQueueItem = std::pair<EntityPtr, EventEnumType>;
     using HostContext = std::shared_ptr<fc::host::HostContext>;
     using ActionFunction = std::function<void(
         std::shared_ptr<Entity> /* pointer to tracked entity */,
@@ -246,19 +252,21 @@ namespace fc::fsm {
     /**
      * Creates a state machine
      * @param transition_rules - defines state transitions
-     * @param scheduler - libp2p Scheduler for async events processing
+     * @param context - host context which io context runs events processing
+     * @param shards - number of strands entities are distributed across
      */
     FSM(std::vector<TransitionRule> transition_rules,
         HostContext context,
-        Ticks ticks = 50)
-        : running_{true},
-          delay_{kSlowModeDelayMs},
+        size_t shards = kDefaultShards)
+        : running_{std::make_shared<std::atomic_bool>(true)},
           host_context_(std::move(context)) {
       initTransitions(std::move(transition_rules));
-      scheduler_ = std::make_shared<libp2p::protocol::AsioScheduler>(
-          *host_context_->getIoContext(),
-          libp2p::protocol::SchedulerConfig{ticks});
-      scheduler_handle_ = scheduler_->schedule(1000, [this] { onTimer(); });
+      shards = std::max<size_t>(1, shards);
+      shards_.reserve(shards);
+      for (size_t i = 0; i < shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>(
+            host_context_->getIoContext()->get_executor()));
+      }
     }
 
     ~FSM() {
@@ -273,23 +281,29 @@ namespace fc::fsm {
      */
     outcome::result<void> begin(const EntityPtr &entity_ptr,
                                 StateEnumType initial_state) {
-      std::unique_lock lock(states_mutex_);
-      auto lookup = states_.find(entity_ptr);
-      if (states_.end() != lookup) {
+      auto &shard{shardOf(entity_ptr)};
+      std::unique_lock lock(shard.mutex);
+      auto lookup = shard.states.find(entity_ptr);
+      if (shard.states.end() != lookup) {
         return FsmError::kEntityAlreadyBeingTracked;
       }
-      states_.emplace(entity_ptr, initial_state);
+      shard.states.emplace(entity_ptr, initial_state);
       return outcome::success();
     }
 
     // schedule an event for an object
     outcome::result<void> send(const EntityPtr &entity_ptr,
                                EventEnumType event) {
-      if (not running_) {
+      if (not isRunning()) {
         return FsmError::kMachineStopped;
       }
-      std::lock_guard lock(event_queue_mutex_);
-      event_queue_.emplace(entity_ptr, event);
+      boost::asio::post(
+          shardOf(entity_ptr).strand,
+          [this, running{running_}, entity_ptr, event] {
+            if (*running) {
+              dispatch(entity_ptr, event);
+            }
+          });
       return outcome::success();
     }
 
@@ -307,9 +321,10 @@ namespace fc::fsm {
      * @return entity state
      */
     outcome::result<StateEnumType> get(const EntityPtr &entity_pointer) const {
-      std::shared_lock lock(states_mutex_);
-      auto lookup = states_.find(entity_pointer);
-      if (states_.end() == lookup) {
+      auto &shard{shardOf(entity_pointer)};
+      std::shared_lock lock(shard.mutex);
+      auto lookup = shard.states.find(entity_pointer);
+      if (shard.states.end() == lookup) {
         return FsmError::kEntityNotTracked;
       }
       return lookup->second;
@@ -321,19 +336,22 @@ namespace fc::fsm {
      * state
      */
     std::unordered_map<EntityPtr, StateEnumType> list() const {
-      std::shared_lock lock(states_mutex_);
-      return states_;
+      std::unordered_map<EntityPtr, StateEnumType> states;
+      for (const auto &shard : shards_) {
+        std::shared_lock lock(shard->mutex);
+        states.insert(shard->states.begin(), shard->states.end());
+      }
+      return states;
     }
 
     /// Prevent further events processing
     void stop() {
-      running_ = false;
-      scheduler_handle_.cancel();
+      *running_ = false;
     }
 
     /// Is events processing still enabled
     bool isRunning() const {
-      return running_;
+      return *running_;
     }
 
     /**
@@ -355,6 +373,23 @@ namespace fc::fsm {
     }
 
    private:
+    using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+    /// Entities of shard are handled on its strand one event at a time
+    struct Shard {
+      explicit Shard(boost::asio::io_context::executor_type executor)
+          : strand{std::move(executor)} {}
+
+      Strand strand;
+      /// guards states, which are also read outside of strand
+      mutable std::shared_mutex mutex;
+      std::unordered_map<EntityPtr, StateEnumType> states;
+    };
+
+    Shard &shardOf(const EntityPtr &entity_ptr) const {
+      return *shards_[std::hash<EntityPtr>{}(entity_ptr) % shards_.size()];
+    }
+
     /// populate transitions map
     void initTransitions(std::vector<TransitionRule> transition_rules) {
       for (auto rule : transition_rules) {
@@ -363,68 +398,48 @@ namespace fc::fsm {
       }
     }
 
-    /// async events processor routine
-    void onTimer() {
-      EventQueueItem event_pair;
-      if (not running_) {
-        return;
-      }
-      {
-        std::lock_guard lock(event_queue_mutex_);
-        if (event_queue_.empty()) {
-          scheduler_handle_.reschedule(kSlowModeDelayMs);
-          return;
-        }
-        scheduler_handle_.reschedule(0);
-        event_pair = event_queue_.front();
-        event_queue_.pop();
-      }
-
+    /// events processor routine, called on strand of entity shard
+    void dispatch(const EntityPtr &entity_ptr, EventEnumType event) {
+      auto &shard{shardOf(entity_ptr)};
       StateEnumType source_state;
       {
-        std::shared_lock lock(states_mutex_);
-        auto current_state = states_.find(event_pair.first);
-        if (states_.end() == current_state) {
+        std::shared_lock lock(shard.mutex);
+        auto current_state = shard.states.find(entity_ptr);
+        if (shard.states.end() == current_state) {
           return;  // entity is not tracked
         }
         // copy to prevent invalidation of iterator
         source_state = current_state->second;
       }
-      auto event_handler = transitions_.find(event_pair.second);
+      auto event_handler = transitions_.find(event);
       if (transitions_.end() == event_handler) {
         return;  // transition from the state by the event is not set
       }
       auto resulting_state =
-          event_handler->second.dispatch(source_state, event_pair.first);
+          event_handler->second.dispatch(source_state, entity_ptr);
       if (resulting_state) {
         {
-          std::unique_lock lock(states_mutex_);
-          states_[event_pair.first] = resulting_state.get();
+          std::unique_lock lock(shard.mutex);
+          shard.states[entity_ptr] = resulting_state.get();
         }
         if (any_change_cb_) {
-          any_change_cb_.get()(event_pair.first,        // pointer to entity
-                               event_pair.second,       // trigger event
+          any_change_cb_.get()(entity_ptr,              // pointer to entity
+                               event,                   // trigger event
                                source_state,            // source state
                                resulting_state.get());  // destination state
         }
       }
     }
 
-    bool running_;            ///< FSM is enabled to process events
-    Scheduler::Ticks delay_;  ///< minimum async loop delay
-
-    std::mutex event_queue_mutex_;
-    std::queue<EventQueueItem> event_queue_;
-    std::shared_ptr<Scheduler> scheduler_;
-    Scheduler::Handle scheduler_handle_;
+    /// FSM is enabled to process events, shared with posted handlers
+    std::shared_ptr<std::atomic_bool> running_;
     HostContext host_context_;
 
     /// a dispatching list of events and what to do on event
     std::unordered_map<EventEnumType, TransitionRule> transitions_;
 
-    /// a list of entities' current states
-    mutable std::shared_mutex states_mutex_;
-    std::unordered_map<EntityPtr, StateEnumType> states_;
+    /// entities' current states, distributed by entity pointer hash
+    std::vector<std::unique_ptr<Shard>> shards_;
 
     /// optional callback for any transition
     boost::optional<ActionFunction> any_change_cb_;
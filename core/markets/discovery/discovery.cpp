@@ -31,11 +31,15 @@ namespace fc::markets::discovery {
     peers.push_back(peer);
     OUTCOME_TRY(peers_cbored, codec::cbor::encode(peers));
     OUTCOME_TRY(datastore_->put(cid_key, peers_cbored));
+    peers_cache_.put(cid, std::move(peers));
     return outcome::success();
   }
 
   outcome::result<std::vector<PeerInfo>> Discovery::getPeers(
       const CID &cid) const {
+    if (auto cached{peers_cache_.get(cid)}) {
+      return std::move(*cached);
+    }
     OUTCOME_TRY(cid_bytes, cid.toBytes());
     Buffer cid_key{cid_bytes};
     if (!datastore_->contains(cid_key)) {
@@ -44,6 +48,7 @@ namespace fc::markets::discovery {
     OUTCOME_TRY(peers_cbored, datastore_->get(cid_key));
     OUTCOME_TRY(peers,
                 codec::cbor::decode<std::vector<PeerInfo>>(peers_cbored));
+    peers_cache_.put(cid, peers);
     return std::move(peers);
   }
 
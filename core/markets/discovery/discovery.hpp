@@ -8,6 +8,7 @@
 
 #include <libp2p/peer/peer_info.hpp>
 #include "common/buffer.hpp"
+#include "common/lru_cache.hpp"
 #include "common/outcome.hpp"
 #include "primitives/cid/cid.hpp"
 #include "storage/face/persistent_map.hpp"
@@ -18,10 +19,15 @@ namespace fc::markets::discovery {
   using libp2p::peer::PeerInfo;
   using Datastore = fc::storage::face::PersistentMap<Buffer, Buffer>;
 
+  /// Payloads with decoded peer lists kept in memory
+  constexpr size_t kDiscoveryCacheSize{1024};
+
   /**
    * Storage/retrieval markets peer resolver.
    * Storage market adds peers on deal by payload root cid. Later, retrieval
    * market can find provider peer by payload cid interested in.
+   * Recently requested peer lists are kept decoded, adding peer replaces
+   * list of its payload.
    */
   class Discovery {
    public:
@@ -46,6 +52,8 @@ namespace fc::markets::discovery {
 
    private:
     std::shared_ptr<Datastore> datastore_;
+    mutable common::LruCache<CID, std::vector<PeerInfo>> peers_cache_{
+        kDiscoveryCacheSize};
   };
 
 }  // namespace fc::markets::discovery
@@ -31,6 +31,14 @@ namespace fc::markets::pieceio {
     virtual outcome::result<std::pair<CID, UnpaddedPieceSize>>
     generatePieceCommitment(const RegisteredProof &registered_proof,
                             const Buffer &piece) = 0;
+
+    /**
+     * Computes commitment of piece file without copying it, file is padded
+     * in place with zeros up to piece size
+     */
+    virtual outcome::result<std::pair<CID, UnpaddedPieceSize>>
+    generatePieceCommitmentFromFile(const RegisteredProof &registered_proof,
+                                    const std::string &path) = 0;
   };
 
 }  // namespace fc::markets::pieceio
@@ -14,6 +14,12 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::markets::pieceio, PieceIOError, e) {
       return "PieceIOError: cannot write to pipe";
     case PieceIOError::kCannotClosePipe:
       return "PieceIOError: cannot close pipe";
+    case PieceIOError::kCannotWriteTempFile:
+      return "PieceIOError: cannot write temporary piece file";
+    case PieceIOError::kCannotReadPieceFile:
+      return "PieceIOError: cannot read piece file";
+    case PieceIOError::kCannotPadPieceFile:
+      return "PieceIOError: cannot pad piece file";
     default:
       return "Unknown error";
   }
@@ -13,7 +13,10 @@ namespace fc::markets::pieceio {
   enum class PieceIOError {
     kCannotCreatePipe = 1,
     kCannotWritePipe,
-    kCannotClosePipe
+    kCannotClosePipe,
+    kCannotWriteTempFile,
+    kCannotReadPieceFile,
+    kCannotPadPieceFile,
   };
 
 }
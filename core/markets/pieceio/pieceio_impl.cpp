@@ -5,52 +5,89 @@
 
 #include "markets/pieceio/pieceio_impl.hpp"
 
-#include <unistd.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <gsl/gsl_util>
+
 #include "markets/pieceio/pieceio_error.hpp"
-#include "proofs/proofs.hpp"
+#include "primitives/piece/comm_p.hpp"
 #include "storage/car/car.hpp"
 
 namespace fc::markets::pieceio {
-
   using primitives::piece::paddedSize;
-  using primitives::piece::PieceData;
-  using proofs::Proofs;
-  using storage::car::makeSelectiveCar;
+  using storage::car::writeSelectiveCar;
 
-  PieceIOImpl::PieceIOImpl(std::shared_ptr<Ipld> ipld)
-      : ipld_{std::move(ipld)} {}
+  PieceIOImpl::PieceIOImpl(std::shared_ptr<Ipld> ipld,
+                           std::shared_ptr<boost::asio::thread_pool> pool)
+      : ipld_{std::move(ipld)}, pool_{std::move(pool)} {}
 
   outcome::result<std::pair<CID, UnpaddedPieceSize>>
   PieceIOImpl::generatePieceCommitment(const RegisteredProof &registered_proof,
                                        const CID &payload_cid,
                                        const Selector &selector) {
-    OUTCOME_TRY(selective_car,
-                makeSelectiveCar(*ipld_, {{payload_cid, selector}}));
-    return generatePieceCommitment(registered_proof, selective_car);
+    return generatePieceCommitment(
+        registered_proof, [&](std::ostream &output) {
+          return writeSelectiveCar(output, *ipld_, {{payload_cid, selector}});
+        });
   }
 
   outcome::result<std::pair<CID, UnpaddedPieceSize>>
   PieceIOImpl::generatePieceCommitment(const RegisteredProof &registered_proof,
                                        const Buffer &piece) {
-    UnpaddedPieceSize padded_size = paddedSize(piece.size());
+    // piece in memory is hashed without temporary file
+    UnpaddedPieceSize padded_size{paddedSize(piece.size())};
+    OUTCOME_TRY(commitment,
+                primitives::piece::generatePieceCommitment(
+                    piece, padded_size, pool_));
+    return {commitment, padded_size};
+  }
 
-    int fds[2];
-    if (pipe(fds) < 0) {
-      return PieceIOError::kCannotCreatePipe;
+  outcome::result<std::pair<CID, UnpaddedPieceSize>>
+  PieceIOImpl::generatePieceCommitment(const RegisteredProof &registered_proof,
+                                       const Writer &writer) {
+    auto path = boost::filesystem::unique_path(
+        boost::filesystem::temp_directory_path() / "piece-%%%%-%%%%-%%%%");
+    auto _ = gsl::finally([&]() {
+      boost::system::error_code ec;
+      boost::filesystem::remove(path, ec);
+    });
+    {
+      std::ofstream file{path.string(), std::ios::binary};
+      if (!file.is_open()) {
+        return PieceIOError::kCannotWriteTempFile;
+      }
+      OUTCOME_TRY(writer(file));
+      file.close();
+      if (file.fail()) {
+        return PieceIOError::kCannotWriteTempFile;
+      }
     }
-    std::vector<uint8_t> data = piece.toVector();
-    data.resize(padded_size, 0);
-    if (write(fds[1], data.data(), padded_size) == -1) {
-      return PieceIOError::kCannotCreatePipe;
+    return generatePieceCommitmentFromFile(registered_proof, path.string());
+  }
+
+  outcome::result<std::pair<CID, UnpaddedPieceSize>>
+  PieceIOImpl::generatePieceCommitmentFromFile(
+      const RegisteredProof &registered_proof, const std::string &path) {
+    boost::system::error_code ec;
+    auto size{boost::filesystem::file_size(path, ec)};
+    if (ec) {
+      return PieceIOError::kCannotReadPieceFile;
     }
-    if (close(fds[1]) == -1) {
-      return PieceIOError::kCannotClosePipe;
+    UnpaddedPieceSize padded_size{paddedSize(size)};
+    // extended part reads as zeros and takes no disk space
+    if (padded_size > size) {
+      boost::filesystem::resize_file(path, padded_size, ec);
+      if (ec) {
+        return PieceIOError::kCannotPadPieceFile;
+      }
+    }
+    std::ifstream file{path, std::ios::binary};
+    if (!file.is_open()) {
+      return PieceIOError::kCannotReadPieceFile;
     }
-
     OUTCOME_TRY(commitment,
-                Proofs::generatePieceCID(
-                    registered_proof, PieceData{fds[0]}, padded_size));
-
+                primitives::piece::generatePieceCommitment(
+                    file, padded_size, pool_));
     return {commitment, padded_size};
   }
 
@@ -6,6 +6,8 @@
 #ifndef CPP_FILECOIN_CORE_MARKETS_PIECEIO_PIECEIO_IMPL_HPP
 #define CPP_FILECOIN_CORE_MARKETS_PIECEIO_PIECEIO_IMPL_HPP
 
+#include <boost/asio/thread_pool.hpp>
+
 #include "common/outcome.hpp"
 #include "markets/pieceio/pieceio.hpp"
 #include "primitives/cid/cid.hpp"
@@ -19,7 +21,13 @@ namespace fc::markets::pieceio {
 
   class PieceIOImpl : public PieceIO {
    public:
-    explicit PieceIOImpl(std::shared_ptr<Ipld> ipld);
+    /**
+     * @param pool - threads to hash piece subtrees on, commitment is computed
+     * on caller thread without it
+     */
+    explicit PieceIOImpl(
+        std::shared_ptr<Ipld> ipld,
+        std::shared_ptr<boost::asio::thread_pool> pool = nullptr);
 
     outcome::result<std::pair<CID, UnpaddedPieceSize>> generatePieceCommitment(
         const RegisteredProof &registered_proof,
@@ -29,8 +37,23 @@ namespace fc::markets::pieceio {
     outcome::result<std::pair<CID, UnpaddedPieceSize>> generatePieceCommitment(
         const RegisteredProof &registered_proof, const Buffer &piece) override;
 
+    outcome::result<std::pair<CID, UnpaddedPieceSize>>
+    generatePieceCommitmentFromFile(const RegisteredProof &registered_proof,
+                                    const std::string &path) override;
+
    private:
+    /// Writes piece payload to stream
+    using Writer = std::function<outcome::result<void>(std::ostream &)>;
+
+    /**
+     * Stream payload into temporary file and compute commitment from file,
+     * so memory use does not depend on piece size
+     */
+    outcome::result<std::pair<CID, UnpaddedPieceSize>> generatePieceCommitment(
+        const RegisteredProof &registered_proof, const Writer &writer);
+
     std::shared_ptr<Ipld> ipld_;
+    std::shared_ptr<boost::asio::thread_pool> pool_;
   };
 
 }  // namespace fc::markets::pieceio
@@ -87,27 +87,78 @@ namespace fc::markets::retrieval::client {
     DealProposal proposal{.payload_cid = payload_cid,
                           .deal_id = next_deal_id++,
                           .params = deal_params};
-    host_->newCborStream(provider_peer,
-                         kRetrievalProtocolId,
-                         [self{shared_from_this()},
-                          proposal,
-                          client_wallet,
-                          miner_wallet,
-                          total_funds,
-                          handler](auto stream_res) {
-                           if (stream_res.has_error()) {
-                             handler(stream_res.error());
-                             return;
-                           }
-                           auto deal_state =
-                               std::make_shared<DealState>(proposal,
-                                                           stream_res.value(),
-                                                           handler,
-                                                           client_wallet,
-                                                           miner_wallet,
-                                                           total_funds);
-                           self->proposeDeal(deal_state);
-                         });
+    // deal streams to provider share its connection
+    auto provider{provider_peer.id.toBase58()};
+    acquireProviderSlot(provider, [self{shared_from_this()},
+                                   provider,
+                                   proposal,
+                                   provider_peer,
+                                   client_wallet,
+                                   miner_wallet,
+                                   total_funds,
+                                   handler] {
+      self->host_->newCborStream(
+          provider_peer,
+          kRetrievalProtocolId,
+          [self,
+           provider,
+           proposal,
+           client_wallet,
+           miner_wallet,
+           total_funds,
+           handler](auto stream_res) {
+            if (stream_res.has_error()) {
+              self->releaseProviderSlot(provider);
+              handler(stream_res.error());
+              return;
+            }
+            auto deal_state = std::make_shared<DealState>(proposal,
+                                                          stream_res.value(),
+                                                          handler,
+                                                          client_wallet,
+                                                          miner_wallet,
+                                                          total_funds);
+            deal_state->provider = provider;
+            deal_state->holds_slot = true;
+            self->proposeDeal(deal_state);
+          });
+    });
+  }
+
+  void RetrievalClientImpl::acquireProviderSlot(const std::string &provider,
+                                                std::function<void()> start) {
+    {
+      std::lock_guard lock{providers_mutex_};
+      auto &slots{providers_[provider]};
+      if (slots.active >= kMaxProviderStreams) {
+        slots.waiting.push_back(std::move(start));
+        return;
+      }
+      ++slots.active;
+    }
+    start();
+  }
+
+  void RetrievalClientImpl::releaseProviderSlot(const std::string &provider) {
+    std::function<void()> next;
+    {
+      std::lock_guard lock{providers_mutex_};
+      auto it{providers_.find(provider)};
+      if (it == providers_.end()) {
+        return;
+      }
+      auto &slots{it->second};
+      if (!slots.waiting.empty()) {
+        // slot is passed to next deal
+        next = std::move(slots.waiting.front());
+        slots.waiting.pop_front();
+      } else if (--slots.active == 0) {
+        providers_.erase(it);
+      }
+    }
+    if (next) {
+      next();
+    }
   }
 
   void RetrievalClientImpl::proposeDeal(
@@ -155,22 +206,31 @@ namespace fc::markets::retrieval::client {
     return outcome::success();
   }
 
-  outcome::result<bool> RetrievalClientImpl::processBlock(
+  outcome::result<bool> RetrievalClientImpl::processBlocks(
       const std::shared_ptr<DealState> &deal_state,
-      const DealResponse::Block &block) {
-    // reconstruct cid from parsed prefix and calculated data multihash
-    auto prefix_reader = gsl::make_span(block.prefix);
-    OUTCOME_TRY(cid, CID::read(prefix_reader, true));
-    if (!prefix_reader.empty()) {
-      return RetrievalClientError::kBlockCidParseError;
-    }
-    cid.content_address =
-        crypto::Hasher::calculate(cid.content_address.getType(), block.data);
+      const std::vector<DealResponse::Block> &blocks) {
+    IpfsDatastore::Batch batch;
+    bool completed{false};
+    for (const auto &block : blocks) {
+      // reconstruct cid from parsed prefix and calculated data multihash
+      auto prefix_reader = gsl::make_span(block.prefix);
+      OUTCOME_TRY(cid, CID::read(prefix_reader, true));
+      if (!prefix_reader.empty()) {
+        return RetrievalClientError::kBlockCidParseError;
+      }
+      cid.content_address =
+          crypto::Hasher::calculate(cid.content_address.getType(), block.data);
 
-    OUTCOME_TRY(completed,
-                deal_state->verifier.verifyNextBlock(cid, block.data));
-    OUTCOME_TRY(ipfs_->set(cid, block.data));
-    deal_state->total_received += block.data.size();
+      OUTCOME_TRYA(completed,
+                   deal_state->verifier.verifyNextBlock(cid, block.data));
+      batch.emplace_back(std::move(cid), block.data);
+      deal_state->total_received += block.data.size();
+      if (completed) {
+        break;
+      }
+    }
+    // blocks of response are written at once
+    OUTCOME_TRY(ipfs_->setMany(std::move(batch)));
     return outcome::success(completed);
   }
 
@@ -194,14 +254,10 @@ namespace fc::markets::retrieval::client {
       bool completed =
           deal_state->deal_status == DealStatus::kDealStatusBlocksComplete;
       if (!completed) {
-        for (auto &&block : response.value().blocks) {
-          auto maybe_completed = self->processBlock(deal_state, block);
-          SELF_IF_ERROR_FAIL_AND_RETURN(maybe_completed);
-          if (maybe_completed.value() == true) {
-            completed = true;
-            break;
-          }
-        }
+        auto maybe_completed =
+            self->processBlocks(deal_state, response.value().blocks);
+        SELF_IF_ERROR_FAIL_AND_RETURN(maybe_completed);
+        completed = maybe_completed.value();
       }
 
       if (completed) {
@@ -321,6 +377,10 @@ namespace fc::markets::retrieval::client {
 
   void RetrievalClientImpl::completeDeal(
       const std::shared_ptr<DealState> &deal_state) {
+    if (deal_state->holds_slot) {
+      deal_state->holds_slot = false;
+      releaseProviderSlot(deal_state->provider);
+    }
     if (!deal_state->stream->stream()->isClosed()) {
       deal_state->stream->stream()->close(deal_state->handler);
     }
@@ -329,6 +389,10 @@ namespace fc::markets::retrieval::client {
   void RetrievalClientImpl::failDeal(
       const std::shared_ptr<DealState> &deal_state,
       const std::error_code &error) {
+    if (deal_state->holds_slot) {
+      deal_state->holds_slot = false;
+      releaseProviderSlot(deal_state->provider);
+    }
     if (!deal_state->stream->stream()->isClosed()) {
       deal_state->stream->stream()->close(deal_state->handler);
     }
@@ -6,7 +6,10 @@
 #ifndef CPP_FILECOIN_CORE_MARKETS_RETRIEVAL_CLIENT_IMPL_HPP
 #define CPP_FILECOIN_CORE_MARKETS_RETRIEVAL_CLIENT_IMPL_HPP
 
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
 
 #include <libp2p/host/host.hpp>
 #include "api/api.hpp"
@@ -86,6 +89,10 @@ namespace fc::markets::retrieval::client {
      * Received ipld blocks verifier
      */
     Verifier verifier;
+
+    /** Provider stream slot is held until deal ends */
+    std::string provider;
+    bool holds_slot{false};
   };
 
   class RetrievalClientImpl
@@ -101,6 +108,9 @@ namespace fc::markets::retrieval::client {
                         std::shared_ptr<Api> api,
                         std::shared_ptr<IpfsDatastore> ipfs);
 
+    /** Deals streamed from one provider at once, others wait in queue */
+    static constexpr size_t kMaxProviderStreams{16};
+
     outcome::result<std::vector<PeerInfo>> findProviders(
         const CID &piece_cid) const override;
 
@@ -131,14 +141,28 @@ namespace fc::markets::retrieval::client {
         const std::shared_ptr<DealState> &deal_state);
 
     /**
-     * Process one block from response
+     * Verify blocks from response and store them in one batch
      * @param deal_state - state of ongoing deal
-     * @param block to process
+     * @param blocks to process
      * @return true if last block processed (blocks are completed)
      */
-    outcome::result<bool> processBlock(
+    outcome::result<bool> processBlocks(
         const std::shared_ptr<DealState> &deal_state,
-        const DealResponse::Block &block);
+        const std::vector<DealResponse::Block> &blocks);
+
+    /**
+     * Runs start when provider has free stream slot, queues it otherwise
+     * @param provider - provider peer id
+     * @param start - opens deal stream, slot is held after call
+     */
+    void acquireProviderSlot(const std::string &provider,
+                             std::function<void()> start);
+
+    /**
+     * Frees provider slot of ended deal and starts next queued deal
+     * @param provider - provider peer id
+     */
+    void releaseProviderSlot(const std::string &provider);
 
     void setupPaymentChannelStart(const std::shared_ptr<DealState> &deal_state);
 
@@ -163,6 +187,14 @@ namespace fc::markets::retrieval::client {
     std::shared_ptr<CborHost> host_;
     std::shared_ptr<Api> api_;
     std::shared_ptr<IpfsDatastore> ipfs_;
+
+    struct ProviderSlots {
+      size_t active{};
+      std::deque<std::function<void()>> waiting;
+    };
+    std::mutex providers_mutex_;
+    std::map<std::string, ProviderSlots> providers_;
+
     common::Logger logger_ = common::createLogger("RetrievalMarketClient");
   };
 
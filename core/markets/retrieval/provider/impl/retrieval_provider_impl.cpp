@@ -4,6 +4,9 @@
  */
 
 #include "markets/retrieval/provider/impl/retrieval_provider_impl.hpp"
+
+#include <boost/asio/post.hpp>
+
 #include "common/libp2p/peer/peer_info_helper.hpp"
 #include "markets/common.hpp"
 #include "storage/piece/impl/piece_storage_error.hpp"
@@ -25,12 +28,35 @@ namespace fc::markets::retrieval::provider {
       std::shared_ptr<api::Api> api,
       std::shared_ptr<PieceStorage> piece_storage,
       std::shared_ptr<Ipld> ipld,
-      const ProviderConfig &config)
+      const ProviderConfig &config,
+      std::shared_ptr<Manager> sealer,
+      SectorLookup sector_lookup,
+      std::shared_ptr<boost::asio::io_context> io)
       : host_{std::make_shared<CborHost>(host)},
         api_{std::move(api)},
         piece_storage_{std::move(piece_storage)},
         ipld_{std::move(ipld)},
-        config_{config} {}
+        config_{config},
+        sealer_{std::move(sealer)},
+        sector_lookup_{std::move(sector_lookup)},
+        io_{std::move(io)} {
+    if (config_.prefetch_blocks != 0) {
+      prefetch_pool_ =
+          std::make_shared<boost::asio::thread_pool>(config_.prefetch_threads);
+    }
+    if (config_.read_ahead_threads != 0) {
+      read_ahead_pool_ = std::make_shared<boost::asio::thread_pool>(
+          config_.read_ahead_threads);
+    }
+    if (sealer_) {
+      unseal_pool_ =
+          std::make_shared<boost::asio::thread_pool>(config_.unseal_threads);
+    }
+    if (sealer_ && io_) {
+      deal_pool_ =
+          std::make_shared<boost::asio::thread_pool>(config_.deal_threads);
+    }
+  }
 
   void RetrievalProviderImpl::start() {
     host_->setCborProtocolHandler(
@@ -79,32 +105,52 @@ namespace fc::markets::retrieval::provider {
 
   outcome::result<QueryResponse> RetrievalProviderImpl::makeQueryResponse(
       const QueryRequest &query) {
-    OUTCOME_TRY(chain_head, api_->ChainHead());
-    OUTCOME_TRY(tipset_key, chain_head.makeKey());
-    OUTCOME_TRY(miner_worker_address,
-                api_->StateMinerWorker(miner_address, tipset_key));
-
-    OUTCOME_TRY(piece_available,
-                piece_storage_->hasPieceInfo(query.payload_cid,
-                                             query.params.piece_cid));
-    if (!piece_available) {
+    // piece storage is asked only when deals changed since cached answer,
+    // payloads not held are mostly rejected by its filter without IO
+    auto generation{piece_storage_->generation()};
+    auto cached{query_cache_.get(query.payload_cid)};
+    if (!cached || cached->generation != generation
+        || cached->piece_cid != query.params.piece_cid) {
+      cached = CachedQuery{query.params.piece_cid, generation, boost::none};
+      OUTCOME_TRY(piece_available,
+                  piece_storage_->hasPieceInfo(query.payload_cid,
+                                               query.params.piece_cid));
+      if (piece_available) {
+        OUTCOME_TRYA(cached->item_size,
+                     piece_storage_->getPieceSize(query.payload_cid,
+                                                  query.params.piece_cid));
+      }
+      query_cache_.put(query.payload_cid, *cached);
+    }
+    if (!cached->item_size) {
       return QueryResponse{
           .response_status = QueryResponseStatus::kQueryResponseUnavailable,
           .item_status = QueryItemStatus::kQueryItemUnavailable};
     }
-    OUTCOME_TRY(piece_size,
-                piece_storage_->getPieceSize(query.payload_cid,
-                                             query.params.piece_cid));
+    OUTCOME_TRY(miner_worker_address, workerAddress());
     return QueryResponse{
         .response_status = QueryResponseStatus::kQueryResponseAvailable,
         .item_status = QueryItemStatus::kQueryItemAvailable,
-        .item_size = piece_size,
+        .item_size = *cached->item_size,
         .payment_address = miner_worker_address,
         .min_price_per_byte = config_.price_per_byte,
         .payment_interval = config_.payment_interval,
         .interval_increase = config_.interval_increase};
   }
 
+  outcome::result<Address> RetrievalProviderImpl::workerAddress() {
+    std::lock_guard lock{worker_mutex_};
+    auto now{std::chrono::steady_clock::now()};
+    if (!worker_address_ || now >= worker_expires_) {
+      OUTCOME_TRY(chain_head, api_->ChainHead());
+      OUTCOME_TRY(tipset_key, chain_head.makeKey());
+      OUTCOME_TRYA(worker_address_,
+                   api_->StateMinerWorker(miner_address, tipset_key));
+      worker_expires_ = now + kWorkerAddressTtl;
+    }
+    return *worker_address_;
+  }
+
   void RetrievalProviderImpl::respondErrorQueryResponse(
       const std::shared_ptr<CborStream> &stream, const std::string &message) {
     QueryResponse response;
@@ -126,14 +172,89 @@ namespace fc::markets::retrieval::provider {
         [self{shared_from_this()}, stream](auto proposal_res) {
           SELF_IF_ERROR_RESPOND_AND_RETURN(
               proposal_res, DealStatus::kDealStatusErrored, stream);
-          auto deal_state = std::make_shared<DealState>(
-              self->ipld_, proposal_res.value(), stream);
-          SELF_IF_ERROR_RESPOND_AND_RETURN(self->receiveDeal(deal_state),
-                                           DealStatus::kDealStatusErrored,
-                                           stream);
+          auto &proposal{proposal_res.value()};
+          if (!self->deal_pool_) {
+            self->startDeal(stream, proposal, self->payloadIpld(proposal));
+            return;
+          }
+          // piece lookup and unsealed store reads block
+          boost::asio::post(*self->deal_pool_, [self, stream, proposal] {
+            auto ipld{self->payloadIpld(proposal)};
+            boost::asio::post(
+                *self->io_,
+                [self, stream, proposal, ipld{std::move(ipld)}]() mutable {
+                  self->startDeal(stream, proposal, std::move(ipld));
+                });
+          });
         });
   }
 
+  void RetrievalProviderImpl::startDeal(
+      const std::shared_ptr<CborStream> &stream,
+      const DealProposal &proposal,
+      outcome::result<IpldPtr> ipld) {
+    auto self{shared_from_this()};
+    SELF_IF_ERROR_RESPOND_AND_RETURN(
+        ipld, DealStatus::kDealStatusErrored, stream);
+    auto deal_state{
+        std::make_shared<DealState>(ipld.value(), proposal, stream)};
+    // unsealed piece is read in order by one traverser
+    if (prefetch_pool_ && deal_state->ipld == ipld_) {
+      deal_state->traverser.prefetch(prefetch_pool_, config_.prefetch_blocks);
+    }
+    SELF_IF_ERROR_RESPOND_AND_RETURN(
+        receiveDeal(deal_state), DealStatus::kDealStatusErrored, stream);
+  }
+
+  outcome::result<IpldPtr> RetrievalProviderImpl::payloadIpld(
+      const DealProposal &proposal) {
+    if (!sealer_) {
+      return ipld_;
+    }
+    OUTCOME_TRY(stored, ipld_->contains(proposal.payload_cid));
+    if (stored) {
+      return ipld_;
+    }
+    OUTCOME_TRY(piece_available,
+                piece_storage_->hasPieceInfo(proposal.payload_cid,
+                                             proposal.params.piece));
+    if (!piece_available) {
+      // rejected by receiveDeal
+      return ipld_;
+    }
+    OUTCOME_TRY(piece,
+                piece_storage_->getPieceInfoFromCid(proposal.payload_cid,
+                                                    proposal.params.piece));
+    for (const auto &deal : piece.deals) {
+      auto sector{sector_lookup_(deal.sector_id)};
+      if (!sector) {
+        logger_->warn("cannot unseal sector {}: {}",
+                      deal.sector_id,
+                      sector.error().message());
+        continue;
+      }
+      if (++unsealing_ > config_.unseal_threads) {
+        --unsealing_;
+        return UnsealedIpldError::kBusy;
+      }
+      auto unsealed{UnsealedIpld::open(
+          [self{shared_from_this()},
+           read{UnsealedIpld::readPiece(sealer_, sector.value(), deal)}](
+              PieceData output) {
+            auto result{read(std::move(output))};
+            --self->unsealing_;
+            return result;
+          },
+          *unseal_pool_)};
+      if (!unsealed) {
+        --unsealing_;
+        return unsealed.error();
+      }
+      return unsealed.value();
+    }
+    return ipld_;
+  }
+
   outcome::result<void> RetrievalProviderImpl::receiveDeal(
       const std::shared_ptr<DealState> &deal_state) {
     OUTCOME_TRY(piece_available,
@@ -187,36 +308,91 @@ namespace fc::markets::retrieval::provider {
 
   outcome::result<DealResponse::Block> RetrievalProviderImpl::prepareNextBlock(
       const std::shared_ptr<DealState> &deal_state) {
-    // TODO if block not found, attempt unseal
-    OUTCOME_TRY(block_cid, deal_state->traverser.advance());
-    OUTCOME_TRY(data, ipld_->get(block_cid));
-    OUTCOME_TRY(prefix, block_cid.getPrefix());
-    return DealResponse::Block{.prefix = Buffer{prefix}, .data = data};
+    OUTCOME_TRY(block, deal_state->traverser.advanceBlock());
+    OUTCOME_TRY(prefix, block.first.getPrefix());
+    return DealResponse::Block{.prefix = Buffer{prefix},
+                               .data = std::move(block.second)};
+  }
+
+  outcome::result<BlockBatch> RetrievalProviderImpl::prepareBlockBatch(
+      const std::shared_ptr<DealState> &deal_state, const BigInt &budget) {
+    BlockBatch batch;
+    while (batch.size < budget) {
+      OUTCOME_TRY(block, prepareNextBlock(deal_state));
+      batch.size += block.data.size();
+      batch.blocks.push_back(std::move(block));
+
+      if (deal_state->traverser.isCompleted()) {
+        batch.completed = true;
+        break;
+      }
+    }
+    return std::move(batch);
+  }
+
+  void RetrievalProviderImpl::readAhead(
+      const std::shared_ptr<DealState> &deal_state) {
+    if (!read_ahead_pool_ || deal_state->next_blocks.valid()) {
+      return;
+    }
+    // client pays current interval in full before next one is sent
+    BigInt budget{deal_state->current_interval
+                  + deal_state->proposal.params.payment_interval_increase};
+    using Task = std::packaged_task<outcome::result<BlockBatch>()>;
+    auto task{std::make_shared<Task>(
+        [self{shared_from_this()}, deal_state, budget] {
+          return self->prepareBlockBatch(deal_state, budget);
+        })};
+    deal_state->next_blocks = task->get_future();
+    boost::asio::post(*read_ahead_pool_, [task] { (*task)(); });
   }
 
   void RetrievalProviderImpl::prepareBlocks(
       const std::shared_ptr<DealState> &deal_state) {
     BigInt total_paid_for = bigdiv(deal_state->funds_received,
                                    deal_state->proposal.params.price_per_byte);
+    BigInt budget{deal_state->current_interval
+                  - (deal_state->total_sent - total_paid_for)};
+    auto prepare{[self{shared_from_this()}, deal_state, budget] {
+      return deal_state->next_blocks.valid()
+                 ? deal_state->next_blocks.get()
+                 : self->prepareBlockBatch(deal_state, budget);
+    }};
+    // unsealed store blocks until sealer writes piece
+    if (deal_pool_ && deal_state->ipld != ipld_) {
+      boost::asio::post(
+          *deal_pool_, [self{shared_from_this()}, deal_state, prepare] {
+            auto batch{prepare()};
+            boost::asio::post(
+                *self->io_,
+                [self, deal_state, batch{std::move(batch)}]() mutable {
+                  self->sendBlocks(deal_state, std::move(batch));
+                });
+          });
+      return;
+    }
+    sendBlocks(deal_state, prepare());
+  }
+
+  void RetrievalProviderImpl::sendBlocks(
+      const std::shared_ptr<DealState> &deal_state,
+      outcome::result<BlockBatch> maybe_batch) {
+    BigInt total_paid_for = bigdiv(deal_state->funds_received,
+                                   deal_state->proposal.params.price_per_byte);
     DealResponse response;
     response.deal_id = deal_state->proposal.deal_id;
     response.status = DealStatus::kDealStatusFundsNeeded;
-    while (deal_state->total_sent - total_paid_for
-           < deal_state->current_interval) {
-      auto maybe_block = prepareNextBlock(deal_state);
-      if (maybe_block.has_error()) {
-        respondErrorRetrievalDeal(deal_state->stream,
-                                  DealStatus::kDealStatusErrored,
-                                  maybe_block.error().message());
-        return;
-      }
-      response.blocks.push_back(maybe_block.value());
-      deal_state->total_sent += maybe_block.value().data.size();
-
-      if (deal_state->traverser.isCompleted()) {
-        response.status = DealStatus::kDealStatusFundsNeededLastPayment;
-        break;
-      }
+    if (maybe_batch.has_error()) {
+      respondErrorRetrievalDeal(deal_state->stream,
+                                DealStatus::kDealStatusErrored,
+                                maybe_batch.error().message());
+      return;
+    }
+    auto &batch{maybe_batch.value()};
+    response.blocks = std::move(batch.blocks);
+    deal_state->total_sent += batch.size;
+    if (batch.completed) {
+      response.status = DealStatus::kDealStatusFundsNeededLastPayment;
     }
 
     response.payment_owed = (deal_state->total_sent - total_paid_for)
@@ -239,6 +415,9 @@ namespace fc::markets::retrieval::provider {
 
           // data sent, now client have to pay
           deal_state->payment_owed = payment_owed;
+          if (payment_status == DealStatus::kDealStatusFundsNeeded) {
+            self->readAhead(deal_state);
+          }
           self->processPayment(deal_state, payment_status);
         });
   }
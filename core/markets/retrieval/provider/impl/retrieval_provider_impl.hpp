@@ -6,13 +6,22 @@
 #ifndef CPP_FILECOIN_CORE_MARKETS_RETRIEVAL_PROVIDER_IMPL_HPP
 #define CPP_FILECOIN_CORE_MARKETS_RETRIEVAL_PROVIDER_IMPL_HPP
 
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+
+#include <boost/asio/io_context.hpp>
+
 #include "api/api.hpp"
 #include "common/libp2p/cbor_host.hpp"
 #include "common/libp2p/cbor_stream.hpp"
+#include "common/lru_cache.hpp"
 #include "common/logger.hpp"
 #include "markets/retrieval/protocols/query_protocol.hpp"
 #include "markets/retrieval/protocols/retrieval_protocol.hpp"
 #include "markets/retrieval/provider/retrieval_provider.hpp"
+#include "markets/retrieval/provider/unsealed_ipld.hpp"
 #include "storage/ipld/traverser.hpp"
 #include "storage/piece/piece_storage.hpp"
 
@@ -25,6 +34,11 @@ namespace fc::markets::retrieval::provider {
   using libp2p::Host;
   using primitives::BigInt;
 
+  /// Payloads with cached query answer
+  constexpr size_t kQueryCacheSize{4096};
+  /// Miner worker address is requested from chain once per this period
+  constexpr std::chrono::seconds kWorkerAddressTtl{60};
+
   /**
    * @struct Provider config
    */
@@ -32,17 +46,42 @@ namespace fc::markets::retrieval::provider {
     TokenAmount price_per_byte;
     uint64_t payment_interval;
     uint64_t interval_increase;
+    /// Blocks fetched ahead per deal, 0 disables prefetch
+    size_t prefetch_blocks{0};
+    /// Threads fetching blocks for all deals
+    size_t prefetch_threads{4};
+    /**
+     * Threads preparing blocks of next payment interval while client pays
+     * for current one, 0 disables read-ahead
+     */
+    size_t read_ahead_threads{2};
+    /// Sectors unsealed at once, deals above limit are rejected
+    size_t unseal_threads{2};
+    /// Threads looking up and reading unsealed payload, off io thread
+    size_t deal_threads{2};
+  };
+
+  /// Blocks of one payment interval
+  struct BlockBatch {
+    std::vector<DealResponse::Block> blocks;
+    uint64_t size{};
+    /// Whether last block of payload is in batch
+    bool completed{};
   };
 
   struct DealState {
     DealState(std::shared_ptr<Ipld> ipld,
               DealProposal proposal,
               std::shared_ptr<CborStream> stream)
-        : proposal{proposal},
+        : ipld{std::move(ipld)},
+          proposal{proposal},
           stream{std::move(stream)},
           current_interval{proposal.params.payment_interval},
-          traverser{*ipld, proposal.payload_cid, proposal.params.selector} {}
+          traverser{
+              *this->ipld, proposal.payload_cid, proposal.params.selector} {}
 
+    /// Store of payload blocks, shared or unsealed piece of deal
+    std::shared_ptr<Ipld> ipld;
     DealProposal proposal;
     std::shared_ptr<CborStream> stream;
     BigInt current_interval;
@@ -50,6 +89,8 @@ namespace fc::markets::retrieval::provider {
     TokenAmount funds_received;
     TokenAmount payment_owed;
     Traverser traverser;
+    /// Blocks of next interval, prepared while client pays for current one
+    std::future<outcome::result<BlockBatch>> next_blocks;
   };
 
   class RetrievalProviderImpl
@@ -60,7 +101,11 @@ namespace fc::markets::retrieval::provider {
                           std::shared_ptr<api::Api> api,
                           std::shared_ptr<PieceStorage> piece_storage,
                           IpldPtr ipld,
-                          const ProviderConfig &config);
+                          const ProviderConfig &config,
+                          std::shared_ptr<Manager> sealer = nullptr,
+                          SectorLookup sector_lookup = {},
+                          std::shared_ptr<boost::asio::io_context> io =
+                              nullptr);
 
     void start() override;
 
@@ -83,6 +128,9 @@ namespace fc::markets::retrieval::provider {
      */
     outcome::result<QueryResponse> makeQueryResponse(const QueryRequest &query);
 
+    /// Miner worker address, cached for kWorkerAddressTtl
+    outcome::result<Address> workerAddress();
+
     /**
      * Send error response for query and close stream
      * @param stream to send and close
@@ -97,6 +145,24 @@ namespace fc::markets::retrieval::provider {
      */
     void handleRetrievalDeal(const std::shared_ptr<CborStream> &stream);
 
+    /**
+     * Store to serve payload from, payload missing in ipld store is read
+     * from unsealed piece of deal when sealer is set
+     * @param proposal - deal proposal
+     * @return ipld store or unsealed piece store
+     */
+    outcome::result<IpldPtr> payloadIpld(const DealProposal &proposal);
+
+    /**
+     * Makes deal state and validates deal, on io thread
+     * @param stream - deal stream
+     * @param proposal - deal proposal
+     * @param ipld - store to serve payload from
+     */
+    void startDeal(const std::shared_ptr<CborStream> &stream,
+                   const DealProposal &proposal,
+                   outcome::result<IpldPtr> ipld);
+
     /**
      * Read deal proposal and validate
      * @param deal_state
@@ -119,6 +185,22 @@ namespace fc::markets::retrieval::provider {
     outcome::result<DealResponse::Block> prepareNextBlock(
         const std::shared_ptr<DealState> &deal_state);
 
+    /**
+     * Prepares blocks until their size reaches budget or payload ends
+     * @param deal_state
+     * @param budget - bytes to send
+     * @return blocks in retrieval market response format
+     */
+    outcome::result<BlockBatch> prepareBlockBatch(
+        const std::shared_ptr<DealState> &deal_state, const BigInt &budget);
+
+    /**
+     * Starts preparing blocks of next payment interval in background,
+     * traverser is not used by other threads until payment is received
+     * @param deal_state
+     */
+    void readAhead(const std::shared_ptr<DealState> &deal_state);
+
     /**
      * Prepare blocks to send (up to size of deal interval) and requests next
      * payment (owed)
@@ -126,6 +208,14 @@ namespace fc::markets::retrieval::provider {
      */
     void prepareBlocks(const std::shared_ptr<DealState> &deal_state);
 
+    /**
+     * Sends prepared blocks and requests payment for them
+     * @param deal_state
+     * @param maybe_batch - blocks or error of preparing them
+     */
+    void sendBlocks(const std::shared_ptr<DealState> &deal_state,
+                    outcome::result<BlockBatch> maybe_batch);
+
     /**
      * Sends response - possibly payload blocks and payment request
      * @param deal_state
@@ -159,6 +249,29 @@ namespace fc::markets::retrieval::provider {
     std::shared_ptr<PieceStorage> piece_storage_;
     std::shared_ptr<Ipld> ipld_;
     ProviderConfig config_;
+    std::shared_ptr<Manager> sealer_;
+    SectorLookup sector_lookup_;
+    std::shared_ptr<boost::asio::thread_pool> prefetch_pool_;
+    /// Separate from prefetch pool, which read-ahead tasks wait for
+    std::shared_ptr<boost::asio::thread_pool> read_ahead_pool_;
+    /// Host io, stream operations are posted back to it from deal pool
+    std::shared_ptr<boost::asio::io_context> io_;
+    /// Readers of unsealed pieces, each busy for whole deal
+    std::shared_ptr<boost::asio::thread_pool> unseal_pool_;
+    /// Payload lookup and reads of unsealed stores, which block
+    std::shared_ptr<boost::asio::thread_pool> deal_pool_;
+    /// Readers started on unseal pool and not finished
+    std::atomic<size_t> unsealing_{};
+    /// Piece lookup result for payload, valid while storage generation holds
+    struct CachedQuery {
+      boost::optional<CID> piece_cid;
+      uint64_t generation{};
+      boost::optional<uint64_t> item_size;
+    };
+    common::LruCache<CID, CachedQuery> query_cache_{kQueryCacheSize};
+    std::mutex worker_mutex_;
+    boost::optional<Address> worker_address_;
+    std::chrono::steady_clock::time_point worker_expires_;
     common::Logger logger_ = common::createLogger("RetrievalProvider");
   };
 }  // namespace fc::markets::retrieval::provider
@@ -0,0 +1,189 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "markets/retrieval/provider/unsealed_ipld.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+
+#include <boost/asio/post.hpp>
+
+namespace fc::markets::retrieval::provider {
+  using primitives::piece::PaddedPieceSize;
+  using primitives::piece::unpaddedIndex;
+  using ::fc::storage::ipfs::IpfsDatastoreError;
+
+  namespace {
+    constexpr size_t kBufferSize{64 << 10};
+    /// Wait for result of reader, it may be still writing on decode error
+    constexpr std::chrono::milliseconds kReadErrorWait{100};
+
+    /// Reads stream from file descriptor, which is owned by caller
+    class FdBuffer : public std::streambuf {
+     public:
+      explicit FdBuffer(int fd) : fd_{fd}, buffer_(kBufferSize) {}
+
+     protected:
+      int_type underflow() override {
+        if (gptr() < egptr()) {
+          return traits_type::to_int_type(*gptr());
+        }
+        while (true) {
+          auto n{::read(fd_, buffer_.data(), buffer_.size())};
+          if (n < 0 && errno == EINTR) {
+            continue;
+          }
+          if (n <= 0) {
+            return traits_type::eof();
+          }
+          setg(buffer_.data(), buffer_.data(), buffer_.data() + n);
+          return traits_type::to_int_type(*gptr());
+        }
+      }
+
+     private:
+      int fd_;
+      std::vector<char> buffer_;
+    };
+  }  // namespace
+
+  UnsealedIpld::UnsealedIpld(int fd)
+      : fd_{fd},
+        buffer_{std::make_unique<FdBuffer>(fd)},
+        input_{buffer_.get()} {}
+
+  UnsealedIpld::~UnsealedIpld() {
+    // fails writes of reader task, so it stops
+    ::shutdown(fd_, SHUT_RDWR);
+    ::close(fd_);
+  }
+
+  outcome::result<std::shared_ptr<UnsealedIpld>> UnsealedIpld::open(
+      ReadPiece read_piece, boost::asio::thread_pool &pool) {
+    // socket pair, unlike pipe, fails writes to closed peer without SIGPIPE
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+      return UnsealedIpldError::kCannotCreatePipe;
+    }
+    std::shared_ptr<UnsealedIpld> ipld{new UnsealedIpld{fds[0]}};
+    using Task = std::packaged_task<outcome::result<void>()>;
+    auto task{std::make_shared<Task>(
+        [read_piece{std::move(read_piece)}, fd{fds[1]}]() mutable {
+          // output is closed when piece is read, ending car stream
+          return read_piece(PieceData{fd});
+        })};
+    ipld->read_ = task->get_future().share();
+    // unsealing may outlive deal
+    boost::asio::post(pool, [task] { (*task)(); });
+    return ipld;
+  }
+
+  ReadPiece UnsealedIpld::readPiece(std::shared_ptr<Manager> sealer,
+                                    const UnsealedSector &sector,
+                                    const DealInfo &deal) {
+    return [sealer{std::move(sealer)}, sector, deal](PieceData output) {
+      return sealer->ReadPiece(std::move(output),
+                               sector.sector,
+                               unpaddedIndex(deal.offset),
+                               PaddedPieceSize{deal.length}.unpadded(),
+                               sector.ticket,
+                               sector.unsealed_cid);
+    };
+  }
+
+  std::error_code UnsealedIpld::readError(std::error_code error) const {
+    // stream ends when reader closes output, just before it returns
+    if (read_.wait_for(kReadErrorWait) == std::future_status::ready
+        && read_.get().has_error()) {
+      return read_.get().error();
+    }
+    return error;
+  }
+
+  outcome::result<boost::optional<UnsealedIpld::Value>> UnsealedIpld::find(
+      const CID &key) const {
+    std::lock_guard lock{mutex_};
+    if (auto it{skipped_.find(key)}; it != skipped_.end()) {
+      auto value{std::move(it->second)};
+      skipped_.erase(it);
+      returned_.put(key, value);
+      return std::move(value);
+    }
+    if (auto value{returned_.get(key)}) {
+      return std::move(value);
+    }
+    if (!reader_ && !ended_) {
+      auto reader{CarReader::make(input_)};
+      if (!reader) {
+        return readError(reader.error());
+      }
+      reader_.emplace(std::move(reader.value()));
+    }
+    while (!ended_) {
+      // piece is padded with zeros after car, item size is never zero
+      if (input_.peek() == 0) {
+        ended_ = true;
+        break;
+      }
+      auto item{reader_->next()};
+      if (!item) {
+        return readError(item.error());
+      }
+      if (!item.value()) {
+        ended_ = true;
+        break;
+      }
+      auto &[cid, value]{*item.value()};
+      if (cid == key) {
+        returned_.put(key, value);
+        return std::move(value);
+      }
+      if (skipped_.size() >= kUnsealedSkippedBlocks) {
+        return UnsealedIpldError::kNotInOrder;
+      }
+      skipped_.emplace(std::move(cid), std::move(value));
+    }
+    return boost::none;
+  }
+
+  outcome::result<bool> UnsealedIpld::contains(const CID &key) const {
+    OUTCOME_TRY(value, find(key));
+    return value.has_value();
+  }
+
+  outcome::result<void> UnsealedIpld::set(const CID &key, Value value) {
+    return IpfsDatastoreError::kReadOnly;
+  }
+
+  outcome::result<UnsealedIpld::Value> UnsealedIpld::get(
+      const CID &key) const {
+    OUTCOME_TRY(value, find(key));
+    if (!value) {
+      return IpfsDatastoreError::kNotFound;
+    }
+    return std::move(*value);
+  }
+
+  outcome::result<void> UnsealedIpld::remove(const CID &key) {
+    return IpfsDatastoreError::kReadOnly;
+  }
+}  // namespace fc::markets::retrieval::provider
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::markets::retrieval::provider,
+                            UnsealedIpldError,
+                            e) {
+  using E = fc::markets::retrieval::provider::UnsealedIpldError;
+  switch (e) {
+    case E::kCannotCreatePipe:
+      return "UnsealedIpldError: cannot create socket pair";
+    case E::kNotInOrder:
+      return "UnsealedIpldError: blocks of piece are not in traversal order";
+    case E::kBusy:
+      return "UnsealedIpldError: all unseal threads are busy";
+    default:
+      return "UnsealedIpldError: unknown error";
+  }
+}
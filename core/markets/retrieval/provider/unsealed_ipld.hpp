@@ -0,0 +1,122 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_MARKETS_RETRIEVAL_PROVIDER_UNSEALED_IPLD_HPP
+#define CPP_FILECOIN_CORE_MARKETS_RETRIEVAL_PROVIDER_UNSEALED_IPLD_HPP
+
+#include <future>
+#include <istream>
+#include <mutex>
+#include <unordered_map>
+
+#include <boost/asio/thread_pool.hpp>
+
+#include "common/lru_cache.hpp"
+#include "sector_storage/manager.hpp"
+#include "storage/car/car.hpp"
+#include "storage/piece/piece_storage.hpp"
+
+namespace fc::markets::retrieval::provider {
+  using primitives::sector::SealRandomness;
+  using primitives::sector::SectorId;
+  using primitives::sector::SectorNumber;
+  using sector_storage::Manager;
+  using ::fc::storage::car::CarReader;
+  using ::fc::storage::piece::DealInfo;
+
+  /// Skipped car items kept until traversal reaches them
+  constexpr size_t kUnsealedSkippedBlocks{1024};
+  /// Returned blocks kept for traversals revisiting them
+  constexpr size_t kUnsealedReturnedBlocks{64};
+
+  /// Seal parameters of sector, needed to read its unsealed data
+  struct UnsealedSector {
+    SectorId sector;
+    SealRandomness ticket;
+    CID unsealed_cid;
+  };
+
+  /// Returns seal parameters of sector of miner
+  using SectorLookup =
+      std::function<outcome::result<UnsealedSector>(SectorNumber)>;
+
+  enum class UnsealedIpldError {
+    kCannotCreatePipe = 1,
+    kNotInOrder,
+    kBusy,
+  };
+
+  /// Writes unsealed piece bytes to output, like Manager::ReadPiece
+  using ReadPiece = std::function<outcome::result<void>(PieceData output)>;
+
+  /**
+   * Read-only store of payload blocks of deal piece, read from unsealed
+   * sector by Manager::ReadPiece on pool thread. Car items are decoded from
+   * socket as they arrive and returned to traverser without storing them,
+   * since deal cars are written in traversal order each requested block is
+   * usually next item. Items read past a requested block are kept, up to
+   * kUnsealedSkippedBlocks, so store fits one traverser and not random
+   * access. Reads block until piece data arrives.
+   */
+  class UnsealedIpld : public Ipld,
+                       public std::enable_shared_from_this<UnsealedIpld> {
+   public:
+    /**
+     * Starts reading piece on pool thread, which stays busy until piece is
+     * read or store is destroyed, so pool size bounds open stores
+     * @param read_piece - writes piece, called on pool
+     * @param pool - threads of readers
+     */
+    static outcome::result<std::shared_ptr<UnsealedIpld>> open(
+        ReadPiece read_piece, boost::asio::thread_pool &pool);
+
+    /**
+     * Reader of piece of deal from sealer
+     * @param sector - seal parameters of deal sector
+     * @param deal - location of piece in sector, padded
+     */
+    static ReadPiece readPiece(std::shared_ptr<Manager> sealer,
+                               const UnsealedSector &sector,
+                               const DealInfo &deal);
+
+    /// Stops reading, reader task ends when write to socket fails
+    ~UnsealedIpld() override;
+
+    outcome::result<bool> contains(const CID &key) const override;
+
+    outcome::result<void> set(const CID &key, Value value) override;
+
+    outcome::result<Value> get(const CID &key) const override;
+
+    outcome::result<void> remove(const CID &key) override;
+
+    IpldPtr shared() override {
+      return shared_from_this();
+    }
+
+   private:
+    explicit UnsealedIpld(int fd);
+
+    /// Reads car items until key is found, none at end of car
+    outcome::result<boost::optional<Value>> find(const CID &key) const;
+    /// Error of reader thread if it failed, or error of stream
+    std::error_code readError(std::error_code error) const;
+
+    int fd_;
+    std::unique_ptr<std::streambuf> buffer_;
+    std::shared_future<outcome::result<void>> read_;
+    /// Reading state, changed by const lookups
+    mutable std::mutex mutex_;
+    mutable std::istream input_;
+    mutable boost::optional<CarReader> reader_;
+    mutable bool ended_{};
+    mutable std::unordered_map<CID, Value> skipped_;
+    mutable common::LruCache<CID, Value> returned_{kUnsealedReturnedBlocks};
+  };
+}  // namespace fc::markets::retrieval::provider
+
+OUTCOME_HPP_DECLARE_ERROR(fc::markets::retrieval::provider, UnsealedIpldError);
+
+#endif  // CPP_FILECOIN_CORE_MARKETS_RETRIEVAL_PROVIDER_UNSEALED_IPLD_HPP
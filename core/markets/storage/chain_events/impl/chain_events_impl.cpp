@@ -4,9 +4,17 @@
  */
 
 #include "markets/storage/chain_events/impl/chain_events_impl.hpp"
+
+#include <unordered_set>
+
+#include <boost/container_hash/hash.hpp>
+
+#include "primitives/address/address_codec.hpp"
+#include "primitives/cid/cid_of_cbor.hpp"
 #include "vm/actor/builtin/miner/miner_actor.hpp"
 
 namespace fc::markets::storage::chain_events {
+  using primitives::cid::getCidOfCbor;
   using primitives::tipset::HeadChangeType;
   using vm::actor::builtin::miner::PreCommitSector;
   using vm::actor::builtin::miner::ProveCommitSector;
@@ -14,6 +22,16 @@ namespace fc::markets::storage::chain_events {
   using vm::message::SignedMessage;
   using PromiseResult = ChainEvents::PromiseResult;
 
+  bool ChainEventsImpl::Key::operator==(const Key &other) const {
+    return method == other.method && to == other.to;
+  }
+
+  size_t ChainEventsImpl::KeyHash::operator()(const Key &key) const {
+    auto seed{std::hash<Buffer>{}(key.to)};
+    boost::hash_combine(seed, key.method);
+    return seed;
+  }
+
   ChainEventsImpl::ChainEventsImpl(std::shared_ptr<Api> api)
       : api_{std::move(api)} {}
 
@@ -30,28 +48,75 @@ namespace fc::markets::storage::chain_events {
     return outcome::success();
   }
 
-  std::shared_ptr<PromiseResult> ChainEventsImpl::onDealSectorCommitted(
-      const Address &provider, const DealId &deal_id) {
-    auto result = std::make_shared<PromiseResult>();
-    std::unique_lock lock(watched_events_mutex_);
-    watched_events_.emplace_back(EventWatch{.provider = provider,
-                                            .deal_id = deal_id,
-                                            .sector_number = boost::none,
-                                            .result = result});
-    return result;
-  }
-
   /**
    * Actually sector commit consists of 2 method calls:
    *  1) PreCommitSector with desired provider address and deal id. Parameters
    * contain sector number used in the next call
    *  2) ProveCommitSector with desired provider address and sector number
    */
+  std::shared_ptr<PromiseResult> ChainEventsImpl::onDealSectorCommitted(
+      const Address &provider, const DealId &deal_id) {
+    auto result = std::make_shared<PromiseResult>();
+    std::lock_guard lock{mutex_};
+    auto [it, inserted]{providers_.emplace(provider, ProviderWatches{})};
+    if (inserted) {
+      watchLocked(provider,
+                  PreCommitSector::Number,
+                  [this, provider](const UnsignedMessage &message) {
+                    onPreCommit(provider, message);
+                    return false;
+                  });
+      watchLocked(provider,
+                  ProveCommitSector::Number,
+                  [this, provider](const UnsignedMessage &message) {
+                    onProveCommit(provider, message);
+                    return false;
+                  });
+    }
+    it->second.deals[deal_id].push_back(result);
+    return result;
+  }
+
+  ChainEventsImpl::WatchId ChainEventsImpl::watch(const Address &to,
+                                                  MethodNumber method,
+                                                  Matcher matcher) {
+    std::lock_guard lock{mutex_};
+    return watchLocked(to, method, std::move(matcher));
+  }
+
+  ChainEventsImpl::WatchId ChainEventsImpl::watchLocked(const Address &to,
+                                                        MethodNumber method,
+                                                        Matcher matcher) {
+    auto id{next_id_++};
+    Key key{Buffer{primitives::address::encode(to)}, method.method_number};
+    matchers_[key].emplace(id, std::move(matcher));
+    keys_.emplace(id, std::move(key));
+    return id;
+  }
+
+  void ChainEventsImpl::unwatch(WatchId id) {
+    std::lock_guard lock{mutex_};
+    auto key_it{keys_.find(id)};
+    if (key_it == keys_.end()) {
+      return;
+    }
+    auto it{matchers_.find(key_it->second)};
+    if (it != matchers_.end()) {
+      it->second.erase(id);
+      if (it->second.empty()) {
+        matchers_.erase(it);
+      }
+    }
+    keys_.erase(key_it);
+  }
+
   bool ChainEventsImpl::onRead(
       const boost::optional<std::vector<HeadChange>> &changes) {
     if (changes) {
       for (const auto &change : changes.get()) {
         if (change.type == HeadChangeType::APPLY) {
+          // blocks of tipset may include same messages
+          std::unordered_set<CID> seen;
           for (auto &block_cid : change.value.cids) {
             auto block_messages = api_->ChainGetBlockMessages(block_cid);
             if (block_messages.has_error()) {
@@ -60,17 +125,14 @@ namespace fc::markets::storage::chain_events {
               continue;
             }
             for (const auto &message : block_messages.value().bls) {
-              auto message_processed = onMessage(message);
-              if (onMessage(message).has_error()) {
-                logger_->error("Message process error: "
-                               + message_processed.error().message());
+              auto cid{getCidOfCbor(message)};
+              if (!cid || seen.insert(cid.value()).second) {
+                onMessage(message);
               }
             }
             for (const auto &message : block_messages.value().secp) {
-              auto message_processed = onMessage(message.message);
-              if (message_processed.has_error()) {
-                logger_->error("Message process error: "
-                               + message_processed.error().message());
+              if (seen.insert(message.getCid()).second) {
+                onMessage(message.message);
               }
             }
           }
@@ -80,56 +142,73 @@ namespace fc::markets::storage::chain_events {
     return true;
   };
 
-  outcome::result<void> ChainEventsImpl::onMessage(
-      const UnsignedMessage &message) {
-    std::vector<EventWatch>::iterator watch_it;
-    boost::optional<SectorNumber> update_sector_number;
-    bool prove_sector_committed = false;
-    {
-      std::shared_lock lock(watched_events_mutex_);
-      for (watch_it = watched_events_.begin();
-           watch_it != watched_events_.end();
-           ++watch_it) {
-        if (message.to == watch_it->provider) {
-          if (message.method == PreCommitSector::Number) {
-            OUTCOME_TRY(
-                pre_commit_info,
-                codec::cbor::decode<SectorPreCommitInfo>(message.params));
-            auto deal_ids = pre_commit_info.deal_ids;
-            // save sector number if deal id matches and it is not saved yet
-            if (std::find(deal_ids.begin(), deal_ids.end(), watch_it->deal_id)
-                    != deal_ids.end()
-                && !watch_it->sector_number) {
-              update_sector_number = pre_commit_info.sector;
-              break;
-            }
-          } else if (message.method == ProveCommitSector::Number) {
-            OUTCOME_TRY(
-                prove_commit_params,
-                codec::cbor::decode<ProveCommitSector::Params>(message.params));
-            // notify if sector number matches,
-            if (watch_it->sector_number
-                && prove_commit_params.sector == watch_it->sector_number) {
-              prove_sector_committed = true;
-              break;
-            }
-          }
-        }
+  void ChainEventsImpl::onMessage(const UnsignedMessage &message) {
+    std::lock_guard lock{mutex_};
+    if (matchers_.empty()) {
+      return;
+    }
+    auto it{matchers_.find(
+        {Buffer{primitives::address::encode(message.to)},
+         message.method.method_number})};
+    if (it == matchers_.end()) {
+      return;
+    }
+    auto &matchers{it->second};
+    for (auto matcher_it{matchers.begin()}; matcher_it != matchers.end();) {
+      if (matcher_it->second(message)) {
+        keys_.erase(matcher_it->first);
+        matcher_it = matchers.erase(matcher_it);
+      } else {
+        ++matcher_it;
       }
     }
+    if (matchers.empty()) {
+      matchers_.erase(it);
+    }
+  }
 
-    if (watch_it != watched_events_.end()) {
-      std::unique_lock lock(watched_events_mutex_);
-      if (update_sector_number) {
-        watch_it->sector_number = update_sector_number;
+  void ChainEventsImpl::onPreCommit(const Address &provider,
+                                    const UnsignedMessage &message) {
+    auto &watches{providers_.at(provider)};
+    if (watches.deals.empty()) {
+      return;
+    }
+    auto pre_commit_info{
+        codec::cbor::decode<SectorPreCommitInfo>(message.params)};
+    if (!pre_commit_info) {
+      logger_->error("Message process error: "
+                     + pre_commit_info.error().message());
+      return;
+    }
+    // deals wait for prove commit of sector
+    for (auto &deal_id : pre_commit_info.value().deal_ids) {
+      auto it{watches.deals.find(deal_id)};
+      if (it != watches.deals.end()) {
+        auto &sector{watches.sectors[pre_commit_info.value().sector]};
+        sector.insert(sector.end(), it->second.begin(), it->second.end());
+        watches.deals.erase(it);
       }
+    }
+  }
 
-      if (prove_sector_committed) {
-        watch_it->result->set_value(outcome::success());
-        watched_events_.erase(watch_it);
+  void ChainEventsImpl::onProveCommit(const Address &provider,
+                                      const UnsignedMessage &message) {
+    auto &watches{providers_.at(provider)};
+    if (watches.sectors.empty()) {
+      return;
+    }
+    auto params{codec::cbor::decode<ProveCommitSector::Params>(message.params)};
+    if (!params) {
+      logger_->error("Message process error: " + params.error().message());
+      return;
+    }
+    auto it{watches.sectors.find(params.value().sector)};
+    if (it != watches.sectors.end()) {
+      for (auto &result : it->second) {
+        result->set_value(outcome::success());
       }
+      watches.sectors.erase(it);
     }
-    return outcome::success();
   }
 
 }  // namespace fc::markets::storage::chain_events
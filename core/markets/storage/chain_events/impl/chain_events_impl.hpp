@@ -8,7 +8,9 @@
 
 #include "markets/storage/chain_events/chain_events.hpp"
 
-#include <shared_mutex>
+#include <map>
+#include <mutex>
+#include <unordered_map>
 
 #include "api/api.hpp"
 #include "common/logger.hpp"
@@ -19,11 +21,24 @@ namespace fc::markets::storage::chain_events {
   using api::Api;
   using api::Chan;
   using primitives::tipset::HeadChange;
+  using vm::actor::MethodNumber;
   using vm::message::UnsignedMessage;
 
+  /**
+   * Shared engine of chain events.
+   * Messages of each applied tipset are loaded once and dispatched to
+   * matchers registered for (to, method) by hash lookup, so messages nobody
+   * watches are not decoded and cost of tipset doesn't depend on number of
+   * watches. Deal commit watches are indexed by provider deal id and sector
+   * number, with one pair of matchers per provider.
+   */
   class ChainEventsImpl : public ChainEvents,
                           public std::enable_shared_from_this<ChainEventsImpl> {
    public:
+    /// Called with matched message, returns true to stop watching
+    using Matcher = std::function<bool(const UnsignedMessage &)>;
+    using WatchId = uint64_t;
+
     ChainEventsImpl(std::shared_ptr<Api> api);
 
     /**
@@ -34,13 +49,49 @@ namespace fc::markets::storage::chain_events {
     std::shared_ptr<PromiseResult> onDealSectorCommitted(
         const Address &provider, const DealId &deal_id) override;
 
+    /**
+     * Watches messages to actor calling method.
+     * Matchers run on chain notify thread and must not watch or unwatch.
+     */
+    WatchId watch(const Address &to, MethodNumber method, Matcher matcher);
+
+    void unwatch(WatchId id);
+
    private:
+    struct Key {
+      bool operator==(const Key &other) const;
+
+      Buffer to;
+      uint64_t method;
+    };
+    struct KeyHash {
+      size_t operator()(const Key &key) const;
+    };
+    /// Commit watches of one provider
+    struct ProviderWatches {
+      std::unordered_map<DealId, std::vector<std::shared_ptr<PromiseResult>>>
+          deals;
+      /// Watches of deals precommitted in sector
+      std::unordered_map<SectorNumber,
+                         std::vector<std::shared_ptr<PromiseResult>>>
+          sectors;
+    };
+
     bool onRead(const boost::optional<std::vector<HeadChange>> &changes);
-    outcome::result<void> onMessage(const UnsignedMessage &message);
+    void onMessage(const UnsignedMessage &message);
+    WatchId watchLocked(const Address &to,
+                        MethodNumber method,
+                        Matcher matcher);
+    void onPreCommit(const Address &provider, const UnsignedMessage &message);
+    void onProveCommit(const Address &provider,
+                       const UnsignedMessage &message);
 
     std::shared_ptr<Api> api_;
-    mutable std::shared_mutex watched_events_mutex_;
-    std::vector<EventWatch> watched_events_;
+    std::mutex mutex_;
+    WatchId next_id_{};
+    std::unordered_map<Key, std::map<WatchId, Matcher>, KeyHash> matchers_;
+    std::unordered_map<WatchId, Key> keys_;
+    std::map<Address, ProviderWatches> providers_;
 
     common::Logger logger_ = common::createLogger("StorageMarketEvents");
   };
@@ -71,7 +71,10 @@ namespace fc::markets::storage::client {
     auto scheduler = std::make_shared<libp2p::protocol::AsioScheduler>(
         *context_, libp2p::protocol::SchedulerConfig{});
     auto graphsync =
-        std::make_shared<GraphsyncImpl>(host, std::move(scheduler));
+        std::make_shared<GraphsyncImpl>(host,
+                                        std::move(scheduler),
+                                        context_,
+                                        GraphsyncImpl::kSelectThreadsDefault);
     datatransfer_ = std::make_shared<GraphSyncManager>(host, graphsync);
   }
 
@@ -105,6 +108,12 @@ namespace fc::markets::storage::client {
   StorageMarketClientImpl::listProviders() const {
     OUTCOME_TRY(chain_head, api_->ChainHead());
     OUTCOME_TRY(tipset_key, chain_head.makeKey());
+    {
+      std::lock_guard lock{providers_mutex_};
+      if (providers_ && providers_->first == tipset_key) {
+        return providers_->second;
+      }
+    }
     OUTCOME_TRY(miners, api_->StateListMiners(tipset_key));
     std::vector<StorageProviderInfo> storage_providers;
     for (const auto &miner_address : miners) {
@@ -117,6 +126,8 @@ namespace fc::markets::storage::client {
                               .sector_size = miner_info.sector_size,
                               .peer_info = peer_info});
     }
+    std::lock_guard lock{providers_mutex_};
+    providers_.emplace(std::move(tipset_key), storage_providers);
     return storage_providers;
   }
 
@@ -156,6 +167,9 @@ namespace fc::markets::storage::client {
   void StorageMarketClientImpl::getAsk(
       const StorageProviderInfo &info,
       const SignedAskHandler &signed_ask_handler) {
+    if (auto ask{cachedAsk(info.address)}) {
+      return signed_ask_handler(std::move(*ask));
+    }
     host_->newCborStream(
         info.peer_info,
         kAskProtocolId,
@@ -184,6 +198,13 @@ namespace fc::markets::storage::client {
                                   outcome::result<AskResponse> response) {
                                 auto validated_ask_response =
                                     self->validateAskResponse(response, info);
+                                if (validated_ask_response) {
+                                  std::lock_guard lock{self->asks_mutex_};
+                                  self->asks_[info.address] = {
+                                      validated_ask_response.value(),
+                                      std::chrono::steady_clock::now()
+                                          + kAskCacheTtl};
+                                }
                                 signed_ask_handler(validated_ask_response);
                                 closeStreamGracefully(stream, self->logger_);
                               });
@@ -259,6 +280,37 @@ namespace fc::markets::storage::client {
     return client_deal->proposal_cid;
   }
 
+  std::vector<outcome::result<CID>>
+  StorageMarketClientImpl::proposeStorageDeals(
+      const Address &client_address,
+      const std::vector<StorageProviderInfo> &providers,
+      const DataRef &data_ref,
+      const ChainEpoch &start_epoch,
+      const ChainEpoch &end_epoch,
+      const TokenAmount &price,
+      const TokenAmount &collateral,
+      const RegisteredProof &registered_proof) {
+    std::vector<outcome::result<CID>> proposals;
+    // commitment is computed here once, each proposal finds it in cache
+    auto comm_p{calculateCommP(registered_proof, data_ref)};
+    for (auto &provider_info : providers) {
+      if (!comm_p) {
+        proposals.emplace_back(comm_p.error());
+        continue;
+      }
+      // returns once stream is requested, deals proceed on io concurrently
+      proposals.push_back(proposeStorageDeal(client_address,
+                                             provider_info,
+                                             data_ref,
+                                             start_epoch,
+                                             end_epoch,
+                                             price,
+                                             collateral,
+                                             registered_proof));
+    }
+    return proposals;
+  }
+
   outcome::result<StorageParticipantBalance>
   StorageMarketClientImpl::getPaymentEscrow(const Address &address) const {
     OUTCOME_TRY(chain_head, api_->ChainHead());
@@ -314,7 +366,7 @@ namespace fc::markets::storage::client {
     return response.value().ask;
   }
 
-  outcome::result<std::pair<CID, UnpaddedPieceSize>>
+  outcome::result<StorageMarketClientImpl::CommP>
   StorageMarketClientImpl::calculateCommP(
       const RegisteredProof &registered_proof, const DataRef &data_ref) const {
     if (data_ref.piece_cid.has_value()) {
@@ -324,10 +376,57 @@ namespace fc::markets::storage::client {
       return StorageMarketClientError::kPieceDataNotSetManualTransfer;
     }
 
-    // TODO (a.chernyshov) selector builder
-    // https://github.com/filecoin-project/go-fil-markets/blob/master/storagemarket/impl/clientutils/clientutils.go#L31
-    return piece_io_->generatePieceCommitment(
-        registered_proof, data_ref.root, {});
+    CommPKey key{data_ref.root, registered_proof};
+    std::promise<outcome::result<CommP>> promise;
+    std::shared_future<outcome::result<CommP>> future;
+    auto first{false};
+    {
+      std::lock_guard lock{comm_p_mutex_};
+      auto it{comm_p_.find(key)};
+      if (it == comm_p_.end()) {
+        first = true;
+        future = promise.get_future().share();
+        comm_p_.emplace(key, future);
+        comm_p_order_.push_back(key);
+        if (comm_p_order_.size() > kCommPCacheSize) {
+          comm_p_.erase(comm_p_order_.front());
+          comm_p_order_.pop_front();
+        }
+      } else {
+        future = it->second;
+      }
+    }
+    if (first) {
+      // TODO (a.chernyshov) selector builder
+      // https://github.com/filecoin-project/go-fil-markets/blob/master/storagemarket/impl/clientutils/clientutils.go#L31
+      auto comm_p{piece_io_->generatePieceCommitment(
+          registered_proof, data_ref.root, {})};
+      if (!comm_p) {
+        // failure is not cached, next proposal computes again
+        std::lock_guard lock{comm_p_mutex_};
+        auto it{std::find(comm_p_order_.begin(), comm_p_order_.end(), key)};
+        if (it != comm_p_order_.end()) {
+          comm_p_.erase(key);
+          comm_p_order_.erase(it);
+        }
+      }
+      promise.set_value(std::move(comm_p));
+    }
+    return future.get();
+  }
+
+  boost::optional<SignedStorageAsk> StorageMarketClientImpl::cachedAsk(
+      const Address &miner) {
+    std::lock_guard lock{asks_mutex_};
+    auto it{asks_.find(miner)};
+    if (it == asks_.end()) {
+      return boost::none;
+    }
+    if (it->second.expires < std::chrono::steady_clock::now()) {
+      asks_.erase(it);
+      return boost::none;
+    }
+    return it->second.ask;
   }
 
   outcome::result<ClientDealProposal> StorageMarketClientImpl::signProposal(
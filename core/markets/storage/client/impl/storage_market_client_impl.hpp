@@ -6,7 +6,11 @@
 #ifndef CPP_FILECOIN_CORE_MARKETS_STORAGE_CLIENT_IMPL_HPP
 #define CPP_FILECOIN_CORE_MARKETS_STORAGE_CLIENT_IMPL_HPP
 
+#include <chrono>
+#include <deque>
+#include <future>
 #include <libp2p/host/host.hpp>
+#include <libp2p/protocol/common/scheduler.hpp>
 #include <mutex>
 #include "api/api.hpp"
 #include "common/libp2p/cbor_host.hpp"
@@ -34,6 +38,7 @@ namespace fc::markets::storage::client {
   using fsm::FSM;
   using libp2p::Host;
   using pieceio::PieceIO;
+  using primitives::tipset::TipsetKey;
   using ClientTransition =
       fsm::Transition<ClientEvent, StorageDealStatus, ClientDeal>;
   using ClientFSM = fsm::FSM<ClientEvent, StorageDealStatus, ClientDeal>;
@@ -45,6 +50,11 @@ namespace fc::markets::storage::client {
       : public StorageMarketClient,
         public std::enable_shared_from_this<StorageMarketClientImpl> {
    public:
+    /// Asks are reused for this long, so repeated deals don't ask again
+    static constexpr std::chrono::seconds kAskCacheTtl{60};
+    /// Payloads with piece commitment kept
+    static constexpr size_t kCommPCacheSize{64};
+
     StorageMarketClientImpl(std::shared_ptr<Host> host,
                             std::shared_ptr<boost::asio::io_context> context,
                             std::shared_ptr<Datastore> datastore,
@@ -81,6 +91,16 @@ namespace fc::markets::storage::client {
         const TokenAmount &collateral,
         const RegisteredProof &registered_proof) override;
 
+    std::vector<outcome::result<CID>> proposeStorageDeals(
+        const Address &client_address,
+        const std::vector<StorageProviderInfo> &providers,
+        const DataRef &data_ref,
+        const ChainEpoch &start_epoch,
+        const ChainEpoch &end_epoch,
+        const TokenAmount &price,
+        const TokenAmount &collateral,
+        const RegisteredProof &registered_proof) override;
+
     outcome::result<StorageParticipantBalance> getPaymentEscrow(
         const Address &address) const override;
 
@@ -88,13 +108,28 @@ namespace fc::markets::storage::client {
                                            const TokenAmount &amount) override;
 
    private:
+    using CommP = std::pair<CID, UnpaddedPieceSize>;
+
+    /// Ask received from provider, reused until expiration
+    struct CachedAsk {
+      SignedStorageAsk ask;
+      std::chrono::steady_clock::time_point expires;
+    };
+
     outcome::result<SignedStorageAsk> validateAskResponse(
         const outcome::result<AskResponse> &response,
         const StorageProviderInfo &info) const;
 
-    outcome::result<std::pair<CID, UnpaddedPieceSize>> calculateCommP(
+    /**
+     * Piece commitment of payload, computed once per payload root and proof,
+     * concurrent callers wait for the first one
+     */
+    outcome::result<CommP> calculateCommP(
         const RegisteredProof &registered_proof, const DataRef &data_ref) const;
 
+    /// Ask cached for provider, none if absent or expired
+    boost::optional<SignedStorageAsk> cachedAsk(const Address &miner);
+
     outcome::result<ClientDealProposal> signProposal(
         const Address &address, const DealProposal &proposal) const;
 
@@ -288,6 +323,22 @@ namespace fc::markets::storage::client {
     std::mutex connections_mutex_;
     std::map<CID, std::shared_ptr<CborStream>> connections_;
 
+    std::mutex asks_mutex_;
+    std::map<Address, CachedAsk> asks_;
+
+    /// Providers listed at chain head, listed again when head changes
+    mutable std::mutex providers_mutex_;
+    mutable boost::optional<
+        std::pair<TipsetKey, std::vector<StorageProviderInfo>>>
+        providers_;
+
+    /// Piece commitments by payload root and proof, oldest evicted first
+    using CommPKey = std::pair<CID, RegisteredProof>;
+    mutable std::mutex comm_p_mutex_;
+    mutable std::map<CommPKey, std::shared_future<outcome::result<CommP>>>
+        comm_p_;
+    mutable std::deque<CommPKey> comm_p_order_;
+
     /** State machine */
     std::shared_ptr<ClientFSM> fsm_;
 
@@ -85,6 +85,21 @@ namespace fc::markets::storage::client {
         const TokenAmount &collateral,
         const RegisteredProof &registered_proof) = 0;
 
+    /**
+     * Proposes same payload to several providers. Piece commitment is
+     * computed once and deals with providers proceed concurrently
+     * @return proposal CID or error for each provider, in providers order
+     */
+    virtual std::vector<outcome::result<CID>> proposeStorageDeals(
+        const Address &client_address,
+        const std::vector<StorageProviderInfo> &providers,
+        const DataRef &data_ref,
+        const ChainEpoch &start_epoch,
+        const ChainEpoch &end_epoch,
+        const TokenAmount &price,
+        const TokenAmount &collateral,
+        const RegisteredProof &registered_proof) = 0;
+
     virtual outcome::result<StorageParticipantBalance> getPaymentEscrow(
         const Address &address) const = 0;
 
@@ -0,0 +1,17 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "markets/storage/deal_state_store.hpp"
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::markets::storage, DealStateStoreError, e) {
+  using fc::markets::storage::DealStateStoreError;
+
+  switch (e) {
+    case (DealStateStoreError::kDealNotFound):
+      return "DealStateStoreError: deal not found";
+    default:
+      return "DealStateStoreError: unknown error";
+  }
+}
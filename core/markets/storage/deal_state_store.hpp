@@ -0,0 +1,226 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_MARKETS_STORAGE_DEAL_STATE_STORE_HPP
+#define CPP_FILECOIN_CORE_MARKETS_STORAGE_DEAL_STATE_STORE_HPP
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include "codec/cbor/cbor.hpp"
+#include "fsm/state_store.hpp"
+#include "markets/storage/deal_protocol.hpp"
+#include "storage/buffer_map.hpp"
+
+namespace fc::markets::storage {
+  using fc::storage::PersistentBufferMap;
+
+  struct DealStateStoreConfig {
+    /// Pending deal states committed at once
+    size_t max_pending{256};
+    /// Longest time deal state stays pending
+    std::chrono::milliseconds flush_interval{200};
+  };
+
+  enum class DealStateStoreError {
+    kDealNotFound = 1,
+  };
+
+  /**
+   * Persistent store of deal states, which coalesces writes. Latest state of
+   * each changed deal is kept pending and pending deals are committed in one
+   * write batch when there are enough of them or flush interval passes.
+   * Batch commit is atomic, so reloaded store has each deal in state of some
+   * committed batch. Deals are also indexed in memory by status.
+   * @tparam Deal - MinerDeal or ClientDeal
+   */
+  template <typename Deal>
+  class DealStateStore
+      : public fsm::StateStore<CID, Deal>,
+        public std::enable_shared_from_this<DealStateStore<Deal>> {
+   public:
+    /**
+     * @param store - deals are stored under "/deals/" prefix
+     * @param io - runs flush timer, pending deals are flushed only on writes
+     * and explicit flush without it
+     */
+    DealStateStore(std::shared_ptr<PersistentBufferMap> store,
+                   DealStateStoreConfig config = {},
+                   std::shared_ptr<boost::asio::io_context> io = nullptr)
+        : store_{std::move(store)}, config_{config}, io_{std::move(io)} {
+      if (io_) {
+        timer_.emplace(*io_);
+      }
+    }
+
+    ~DealStateStore() override {
+      if (timer_) {
+        timer_->cancel();
+      }
+      std::lock_guard lock{mutex_};
+      // errors on destruction can't be reported, deals stay as last committed
+      std::ignore = flushLocked();
+    }
+
+    /// Reads all stored deals in one scan, replacing ones in memory
+    outcome::result<void> load() {
+      std::lock_guard lock{mutex_};
+      deals_.clear();
+      by_status_.clear();
+      pending_.clear();
+      auto prefix{keyPrefix()};
+      auto cursor{store_->cursor()};
+      for (cursor->seek(prefix); cursor->isValid(); cursor->next()) {
+        auto key{cursor->key()};
+        if (key.size() < prefix.size()
+            || !std::equal(prefix.begin(), prefix.end(), key.begin())) {
+          break;
+        }
+        OUTCOME_TRY(deal, codec::cbor::decode<Deal>(cursor->value()));
+        index(deal);
+        auto proposal_cid{deal.proposal_cid};
+        deals_.emplace(std::move(proposal_cid), std::move(deal));
+      }
+      return outcome::success();
+    }
+
+    outcome::result<Deal> get(const CID &proposal_cid) const override {
+      std::lock_guard lock{mutex_};
+      auto it{deals_.find(proposal_cid)};
+      if (it == deals_.end()) {
+        return DealStateStoreError::kDealNotFound;
+      }
+      return it->second;
+    }
+
+    /// Records deal state, which is committed with next batch
+    outcome::result<void> put(const Deal &deal) {
+      std::lock_guard lock{mutex_};
+      auto it{deals_.find(deal.proposal_cid)};
+      if (it != deals_.end()) {
+        unindex(it->second);
+        it->second = deal;
+      } else {
+        it = deals_.emplace(deal.proposal_cid, deal).first;
+      }
+      index(it->second);
+      if (pending_.empty()) {
+        first_pending_ = std::chrono::steady_clock::now();
+        armTimer();
+      }
+      pending_.insert(deal.proposal_cid);
+      if (pending_.size() >= config_.max_pending
+          || std::chrono::steady_clock::now() - first_pending_
+                 >= config_.flush_interval) {
+        return flushLocked();
+      }
+      return outcome::success();
+    }
+
+    /// Commits pending deal states
+    outcome::result<void> flush() {
+      std::lock_guard lock{mutex_};
+      return flushLocked();
+    }
+
+    /// Proposal cids of deals with status
+    std::vector<CID> list(StorageDealStatus status) const {
+      std::lock_guard lock{mutex_};
+      auto it{by_status_.find(status)};
+      if (it == by_status_.end()) {
+        return {};
+      }
+      return {it->second.begin(), it->second.end()};
+    }
+
+    /// All deals in memory
+    std::vector<Deal> list() const {
+      std::lock_guard lock{mutex_};
+      std::vector<Deal> deals;
+      deals.reserve(deals_.size());
+      for (const auto &[_, deal] : deals_) {
+        deals.push_back(deal);
+      }
+      return deals;
+    }
+
+   private:
+    static Buffer keyPrefix() {
+      return Buffer{}.put("/deals/");
+    }
+
+    static Buffer dealKey(const CID &proposal_cid) {
+      auto key{keyPrefix()};
+      key.put(proposal_cid.toBytes().value());
+      return key;
+    }
+
+    void index(const Deal &deal) {
+      by_status_[deal.state].insert(deal.proposal_cid);
+    }
+
+    void unindex(const Deal &deal) {
+      auto it{by_status_.find(deal.state)};
+      if (it != by_status_.end()) {
+        it->second.erase(deal.proposal_cid);
+        if (it->second.empty()) {
+          by_status_.erase(it);
+        }
+      }
+    }
+
+    /// Deals stay pending after failed commit and are retried with next one
+    outcome::result<void> flushLocked() {
+      if (pending_.empty()) {
+        return outcome::success();
+      }
+      auto batch{store_->batch()};
+      for (const auto &proposal_cid : pending_) {
+        OUTCOME_TRY(value, codec::cbor::encode(deals_.at(proposal_cid)));
+        OUTCOME_TRY(batch->put(dealKey(proposal_cid), value));
+      }
+      OUTCOME_TRY(batch->commit());
+      pending_.clear();
+      return outcome::success();
+    }
+
+    /// Flushes pending deals after interval if nothing else does earlier
+    void armTimer() {
+      if (!timer_) {
+        return;
+      }
+      timer_->expires_after(config_.flush_interval);
+      timer_->async_wait([weak{this->weak_from_this()}](auto ec) {
+        if (ec) {
+          return;
+        }
+        if (auto self{weak.lock()}) {
+          std::ignore = self->flush();
+        }
+      });
+    }
+
+    std::shared_ptr<PersistentBufferMap> store_;
+    DealStateStoreConfig config_;
+    std::shared_ptr<boost::asio::io_context> io_;
+    boost::optional<boost::asio::steady_timer> timer_;
+
+    mutable std::mutex mutex_;
+    std::map<CID, Deal> deals_;
+    std::map<StorageDealStatus, std::set<CID>> by_status_;
+    /// Changed deals not committed yet
+    std::set<CID> pending_;
+    std::chrono::steady_clock::time_point first_pending_;
+  };
+}  // namespace fc::markets::storage
+
+OUTCOME_HPP_DECLARE_ERROR(fc::markets::storage, DealStateStoreError);
+
+#endif  // CPP_FILECOIN_CORE_MARKETS_STORAGE_DEAL_STATE_STORE_HPP
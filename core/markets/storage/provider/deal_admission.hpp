@@ -0,0 +1,125 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_MARKETS_STORAGE_PROVIDER_DEAL_ADMISSION_HPP
+#define CPP_FILECOIN_CORE_MARKETS_STORAGE_PROVIDER_DEAL_ADMISSION_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+#include <boost/optional.hpp>
+
+#include "api/api.hpp"
+#include "common/outcome.hpp"
+#include "primitives/address/address.hpp"
+#include "primitives/cid/cid.hpp"
+#include "primitives/types.hpp"
+
+namespace fc::markets::storage::provider {
+  using api::Api;
+  using primitives::TokenAmount;
+  using primitives::address::Address;
+  using primitives::tipset::Tipset;
+  using primitives::tipset::TipsetKey;
+
+  struct DealAdmissionConfig {
+    /// Deals admitted until sealed or failed, when capacity is not set
+    size_t max_active{32};
+    /// Proposals waiting for slot, more are rejected at once
+    size_t max_queued{64};
+    /// Chain head and balances are shared by proposals for this long
+    std::chrono::milliseconds snapshot_ttl{1000};
+  };
+
+  /**
+   * Admission of deal proposals. Admitted deals hold slot until they are
+   * sealed or failed, proposals beyond slots wait in bounded queue and are
+   * rejected when it is full, so bursts don't overcommit sealing.
+   * Concurrent proposals share one chain head snapshot and market balance
+   * view, where funds of admitted deals are reserved until published.
+   * Thread-safe.
+   */
+  class DealAdmission {
+   public:
+    enum class Result { kAdmitted, kQueued, kRejected };
+
+    /// Chain head snapshot
+    struct Head {
+      Tipset tipset;
+      TipsetKey key;
+    };
+
+    DealAdmission(std::shared_ptr<Api> api, DealAdmissionConfig config);
+
+    /**
+     * Sets expected sealing capacity, number of deals sealing can take
+     * @param capacity - called on each admission, max_active without it
+     */
+    void setCapacity(std::function<size_t()> capacity);
+
+    /**
+     * Takes slot for deal or queues it
+     * @param resume - called on slot release when deal was queued
+     */
+    Result admit(const CID &proposal_cid, std::function<void()> resume);
+
+    /// Frees slot and reservation of deal, resumes next queued deal
+    void release(const CID &proposal_cid);
+
+    /// Chain head, requested once per snapshot ttl, outside of lock
+    outcome::result<Head> head();
+
+    /**
+     * Client market balance not locked on chain nor reserved by admitted
+     * deals, at head snapshot
+     */
+    outcome::result<TokenAmount> available(const Address &client);
+
+    /// Reserves client funds for deal until unreserve or release
+    void reserve(const CID &proposal_cid,
+                 const Address &client,
+                 const TokenAmount &amount);
+
+    /// Drops reservation once funds are locked by published deal
+    void unreserve(const CID &proposal_cid);
+
+    size_t active() const;
+
+    size_t queued() const;
+
+   private:
+    struct Reservation {
+      Address client;
+      TokenAmount amount;
+    };
+
+    /// Balance less funds reserved by admitted deals of client
+    TokenAmount unreservedLocked(const Address &client,
+                                 TokenAmount balance) const;
+    void unreserveLocked(const CID &proposal_cid);
+
+    std::shared_ptr<Api> api_;
+    DealAdmissionConfig config_;
+    std::function<size_t()> capacity_;
+
+    mutable std::mutex mutex_;
+    std::set<CID> active_;
+    std::deque<std::pair<CID, std::function<void()>>> queue_;
+    boost::optional<Head> head_;
+    std::chrono::steady_clock::time_point head_expires_;
+    /// Balances at head snapshot, cleared with it
+    std::map<Address, TokenAmount> balances_;
+    std::map<CID, Reservation> reservations_;
+    std::map<Address, TokenAmount> reserved_;
+  };
+}  // namespace fc::markets::storage::provider
+
+#endif  // CPP_FILECOIN_CORE_MARKETS_STORAGE_PROVIDER_DEAL_ADMISSION_HPP
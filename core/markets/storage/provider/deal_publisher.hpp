@@ -0,0 +1,123 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_MARKETS_STORAGE_PROVIDER_DEAL_PUBLISHER_HPP
+#define CPP_FILECOIN_CORE_MARKETS_STORAGE_PROVIDER_DEAL_PUBLISHER_HPP
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include "api/api.hpp"
+#include "common/logger.hpp"
+#include "common/outcome.hpp"
+#include "primitives/cid/cid.hpp"
+#include "vm/actor/builtin/market/actor.hpp"
+
+namespace fc::markets::storage::provider {
+  using api::Api;
+  using primitives::address::Address;
+  using primitives::tipset::Tipset;
+  using primitives::tipset::TipsetKey;
+  using vm::actor::builtin::market::ClientDealProposal;
+  using vm::actor::builtin::market::DealId;
+
+  struct DealPublisherConfig {
+    /// Batch is published this long after its first deal was queued
+    std::chrono::milliseconds max_wait{std::chrono::seconds{60}};
+    /// Batch is published at once when it has this many deals
+    size_t max_deals{8};
+  };
+
+  /**
+   * Publishes accepted deals in batches, one PublishStorageDeals message per
+   * batch of up to max_deals deals queued within max_wait, so deals don't
+   * compete for block space and gas with own messages. Each deal gets cid of
+   * message publishing it and finds its deal id with dealIdOf after message
+   * lands. Deals of other provider than queued ones start new batch.
+   * Each deal of batch is validated on current head before publishing,
+   * deals starting before head or failing alone fail with own error, rest
+   * of batch is published. Thread-safe.
+   */
+  class DealPublisher : public std::enable_shared_from_this<DealPublisher> {
+   public:
+    /// Receives cid of publish message or error of publishing
+    using Callback = std::function<void(outcome::result<CID>)>;
+
+    DealPublisher(std::shared_ptr<Api> api,
+                  std::shared_ptr<boost::asio::io_context> io,
+                  DealPublisherConfig config);
+
+    /**
+     * Queues deal for next batch
+     * @param callback - called on calling thread if batch is full, or on io
+     * thread when batch times out
+     */
+    void publish(const ClientDealProposal &deal, Callback callback);
+
+    /// Publishes queued deals at once
+    void flush();
+
+    /// Deals waiting for batch
+    size_t pending() const;
+
+    /**
+     * Finds id of deal among results of publish message
+     * @param message - publish message cid
+     * @param deals - result of message
+     */
+    outcome::result<DealId> dealIdOf(const CID &message,
+                                     const std::vector<DealId> &deals,
+                                     const ClientDealProposal &deal) const;
+
+   private:
+    struct Pending {
+      ClientDealProposal deal;
+      Callback callback;
+    };
+
+    /// Takes queued deals, called with mutex locked
+    std::vector<Pending> takeBatch();
+
+    /// Publishes batch and passes result to callbacks of its deals
+    void publishBatch(std::vector<Pending> batch);
+
+    /**
+     * Checks start epochs and calls publish of each deal alone on head
+     * @return result of each deal
+     */
+    outcome::result<std::vector<outcome::result<void>>> validate(
+        const Tipset &head,
+        const TipsetKey &head_key,
+        const Address &worker,
+        const std::vector<Pending> &batch);
+
+    outcome::result<CID> push(const Address &worker,
+                              const std::vector<ClientDealProposal> &deals);
+
+    std::shared_ptr<Api> api_;
+    std::shared_ptr<boost::asio::io_context> io_;
+    DealPublisherConfig config_;
+    mutable std::mutex mutex_;
+    std::vector<Pending> batch_;
+    /// Number of current batch, timer of published batch is ignored
+    uint64_t generation_{};
+    common::Logger logger_ = common::createLogger("DealPublisher");
+  };
+
+  enum class DealPublisherError {
+    kDealNotInMessage = 1,
+    kResultSize,
+    kStartEpochPassed,
+    kDealRejected,
+  };
+}  // namespace fc::markets::storage::provider
+
+OUTCOME_HPP_DECLARE_ERROR(fc::markets::storage::provider, DealPublisherError);
+
+#endif  // CPP_FILECOIN_CORE_MARKETS_STORAGE_PROVIDER_DEAL_PUBLISHER_HPP
@@ -0,0 +1,150 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "markets/storage/provider/deal_admission.hpp"
+
+namespace fc::markets::storage::provider {
+
+  DealAdmission::DealAdmission(std::shared_ptr<Api> api,
+                               DealAdmissionConfig config)
+      : api_{std::move(api)}, config_{config} {}
+
+  void DealAdmission::setCapacity(std::function<size_t()> capacity) {
+    std::lock_guard lock{mutex_};
+    capacity_ = std::move(capacity);
+  }
+
+  DealAdmission::Result DealAdmission::admit(const CID &proposal_cid,
+                                             std::function<void()> resume) {
+    std::lock_guard lock{mutex_};
+    auto capacity{capacity_ ? capacity_() : config_.max_active};
+    if (active_.size() < capacity) {
+      active_.insert(proposal_cid);
+      return Result::kAdmitted;
+    }
+    if (queue_.size() < config_.max_queued) {
+      queue_.emplace_back(proposal_cid, std::move(resume));
+      return Result::kQueued;
+    }
+    return Result::kRejected;
+  }
+
+  void DealAdmission::release(const CID &proposal_cid) {
+    std::function<void()> resume;
+    {
+      std::lock_guard lock{mutex_};
+      unreserveLocked(proposal_cid);
+      auto queued{std::find_if(queue_.begin(), queue_.end(), [&](auto &p) {
+        return p.first == proposal_cid;
+      })};
+      if (queued != queue_.end()) {
+        queue_.erase(queued);
+        return;
+      }
+      if (active_.erase(proposal_cid) == 0) {
+        return;
+      }
+      auto capacity{capacity_ ? capacity_() : config_.max_active};
+      if (queue_.empty() || active_.size() >= capacity) {
+        return;
+      }
+      active_.insert(queue_.front().first);
+      resume = std::move(queue_.front().second);
+      queue_.pop_front();
+    }
+    // outside of lock, resumed deal already holds its slot
+    if (resume) {
+      resume();
+    }
+  }
+
+  outcome::result<DealAdmission::Head> DealAdmission::head() {
+    auto now{std::chrono::steady_clock::now()};
+    {
+      std::lock_guard lock{mutex_};
+      if (head_ && now < head_expires_) {
+        return *head_;
+      }
+    }
+    // request outside of lock, so proposals don't wait for each other
+    OUTCOME_TRY(tipset, api_->ChainHead());
+    OUTCOME_TRY(key, tipset.makeKey());
+    std::lock_guard lock{mutex_};
+    if (!head_ || now >= head_expires_) {
+      head_ = Head{std::move(tipset), std::move(key)};
+      head_expires_ = now + config_.snapshot_ttl;
+      balances_.clear();
+    }
+    return *head_;
+  }
+
+  outcome::result<TokenAmount> DealAdmission::available(
+      const Address &client) {
+    OUTCOME_TRY(snapshot, head());
+    {
+      std::lock_guard lock{mutex_};
+      if (head_ && head_->key == snapshot.key) {
+        auto balance{balances_.find(client)};
+        if (balance != balances_.end()) {
+          return unreservedLocked(client, balance->second);
+        }
+      }
+    }
+    OUTCOME_TRY(market, api_->StateMarketBalance(client, snapshot.key));
+    TokenAmount balance{market.escrow - market.locked};
+    std::lock_guard lock{mutex_};
+    // balances are dropped when snapshot was refreshed meanwhile
+    if (head_ && head_->key == snapshot.key) {
+      balances_.emplace(client, balance);
+    }
+    return unreservedLocked(client, balance);
+  }
+
+  void DealAdmission::reserve(const CID &proposal_cid,
+                              const Address &client,
+                              const TokenAmount &amount) {
+    std::lock_guard lock{mutex_};
+    unreserveLocked(proposal_cid);
+    reservations_.emplace(proposal_cid, Reservation{client, amount});
+    reserved_[client] += amount;
+  }
+
+  void DealAdmission::unreserve(const CID &proposal_cid) {
+    std::lock_guard lock{mutex_};
+    unreserveLocked(proposal_cid);
+  }
+
+  size_t DealAdmission::active() const {
+    std::lock_guard lock{mutex_};
+    return active_.size();
+  }
+
+  size_t DealAdmission::queued() const {
+    std::lock_guard lock{mutex_};
+    return queue_.size();
+  }
+
+  TokenAmount DealAdmission::unreservedLocked(const Address &client,
+                                              TokenAmount balance) const {
+    auto reserved{reserved_.find(client)};
+    if (reserved != reserved_.end()) {
+      balance -= reserved->second;
+    }
+    return balance;
+  }
+
+  void DealAdmission::unreserveLocked(const CID &proposal_cid) {
+    auto it{reservations_.find(proposal_cid)};
+    if (it == reservations_.end()) {
+      return;
+    }
+    auto reserved{reserved_.find(it->second.client)};
+    reserved->second -= it->second.amount;
+    if (reserved->second == 0) {
+      reserved_.erase(reserved);
+    }
+    reservations_.erase(it);
+  }
+}  // namespace fc::markets::storage::provider
@@ -0,0 +1,245 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "markets/storage/provider/deal_publisher.hpp"
+
+#include <boost/asio/steady_timer.hpp>
+
+namespace fc::markets::storage::provider {
+  using primitives::GasAmount;
+  using primitives::TokenAmount;
+  using vm::actor::MethodParams;
+  using vm::actor::builtin::market::PublishStorageDeals;
+  using vm::message::UnsignedMessage;
+
+  DealPublisher::DealPublisher(std::shared_ptr<Api> api,
+                               std::shared_ptr<boost::asio::io_context> io,
+                               DealPublisherConfig config)
+      : api_{std::move(api)}, io_{std::move(io)}, config_{config} {}
+
+  void DealPublisher::publish(const ClientDealProposal &deal,
+                              Callback callback) {
+    std::unique_lock lock{mutex_};
+    if (!batch_.empty()
+        && batch_.front().deal.proposal.provider != deal.proposal.provider) {
+      auto batch{takeBatch()};
+      lock.unlock();
+      publishBatch(std::move(batch));
+      lock.lock();
+    }
+    batch_.push_back({deal, std::move(callback)});
+    if (batch_.size() >= config_.max_deals) {
+      auto batch{takeBatch()};
+      lock.unlock();
+      return publishBatch(std::move(batch));
+    }
+    if (batch_.size() == 1) {
+      // timer lives until it expires, batch may be published before
+      auto timer{std::make_shared<boost::asio::steady_timer>(*io_)};
+      timer->expires_after(config_.max_wait);
+      timer->async_wait([weak{weak_from_this()},
+                         timer,
+                         generation{generation_}](auto ec) {
+        auto self{weak.lock()};
+        if (!self || ec) {
+          return;
+        }
+        std::unique_lock lock{self->mutex_};
+        if (self->generation_ != generation || self->batch_.empty()) {
+          return;
+        }
+        auto batch{self->takeBatch()};
+        lock.unlock();
+        self->publishBatch(std::move(batch));
+      });
+    }
+  }
+
+  void DealPublisher::flush() {
+    std::unique_lock lock{mutex_};
+    if (batch_.empty()) {
+      return;
+    }
+    auto batch{takeBatch()};
+    lock.unlock();
+    publishBatch(std::move(batch));
+  }
+
+  size_t DealPublisher::pending() const {
+    std::lock_guard lock{mutex_};
+    return batch_.size();
+  }
+
+  outcome::result<DealId> DealPublisher::dealIdOf(
+      const CID &message,
+      const std::vector<DealId> &deals,
+      const ClientDealProposal &deal) const {
+    // message of one deal is not loaded
+    if (deals.size() == 1) {
+      return deals.front();
+    }
+    OUTCOME_TRY(unsigned_message, api_->ChainGetMessage(message));
+    OUTCOME_TRY(params,
+                codec::cbor::decode<PublishStorageDeals::Params>(
+                    unsigned_message.params));
+    // all deals of message are published or none
+    if (params.deals.size() != deals.size()) {
+      return DealPublisherError::kResultSize;
+    }
+    for (size_t i{0}; i < params.deals.size(); ++i) {
+      if (params.deals[i] == deal) {
+        return deals[i];
+      }
+    }
+    return DealPublisherError::kDealNotInMessage;
+  }
+
+  std::vector<DealPublisher::Pending> DealPublisher::takeBatch() {
+    std::vector<Pending> batch;
+    batch.swap(batch_);
+    ++generation_;
+    return batch;
+  }
+
+  /// Publish message of deals, gas limit scales with deals
+  outcome::result<UnsignedMessage> publishMessage(
+      const Address &worker, const std::vector<ClientDealProposal> &deals) {
+    OUTCOME_TRY(encoded_params,
+                codec::cbor::encode(PublishStorageDeals::Params{deals}));
+    return UnsignedMessage(
+        vm::actor::kStorageMarketAddress,
+        worker,
+        0,
+        TokenAmount{0},
+        vm::message::kDefaultGasPrice,
+        vm::message::kDefaultGasLimit * static_cast<GasAmount>(deals.size()),
+        PublishStorageDeals::Number,
+        MethodParams{encoded_params});
+  }
+
+  void DealPublisher::publishBatch(std::vector<Pending> batch) {
+    auto fail{[&](const std::error_code &error) {
+      logger_->error(
+          "publish {} deals failed: {}", batch.size(), error.message());
+      for (auto &pending : batch) {
+        pending.callback(error);
+      }
+    }};
+    auto _head{api_->ChainHead()};
+    if (!_head) {
+      return fail(_head.error());
+    }
+    auto &head{_head.value()};
+    auto _head_key{head.makeKey()};
+    if (!_head_key) {
+      return fail(_head_key.error());
+    }
+    auto _info{api_->StateMinerInfo(batch.front().deal.proposal.provider,
+                                    _head_key.value())};
+    if (!_info) {
+      return fail(_info.error());
+    }
+    auto &worker{_info.value().worker};
+    auto _valid{validate(head, _head_key.value(), worker, batch)};
+    if (!_valid) {
+      return fail(_valid.error());
+    }
+    // invalid deals fail alone, so they don't fail message of batch
+    std::vector<Pending> valid;
+    for (size_t i{0}; i < batch.size(); ++i) {
+      auto &result{_valid.value()[i]};
+      if (result) {
+        valid.push_back(std::move(batch[i]));
+        continue;
+      }
+      logger_->warn("deal of piece {} not published: {}",
+                    batch[i].deal.proposal.piece_cid.toString().value(),
+                    result.error().message());
+      batch[i].callback(result.error());
+    }
+    if (valid.empty()) {
+      return;
+    }
+    std::vector<ClientDealProposal> deals;
+    deals.reserve(valid.size());
+    for (auto &pending : valid) {
+      deals.push_back(pending.deal);
+    }
+    auto cid{push(worker, deals)};
+    if (cid) {
+      logger_->debug("published {} deals with {}",
+                     deals.size(),
+                     cid.value().toString().value());
+    } else {
+      logger_->error("publish {} deals failed: {}",
+                     deals.size(),
+                     cid.error().message());
+    }
+    for (auto &pending : valid) {
+      pending.callback(cid);
+    }
+  }
+
+  outcome::result<std::vector<outcome::result<void>>> DealPublisher::validate(
+      const Tipset &head,
+      const TipsetKey &head_key,
+      const Address &worker,
+      const std::vector<Pending> &batch) {
+    std::vector<outcome::result<void>> results(batch.size(),
+                                               outcome::success());
+    std::vector<UnsignedMessage> calls;
+    std::vector<size_t> called;
+    for (size_t i{0}; i < batch.size(); ++i) {
+      auto &deal{batch[i].deal};
+      if (deal.proposal.start_epoch <= head.height) {
+        results[i] = DealPublisherError::kStartEpochPassed;
+        continue;
+      }
+      OUTCOME_TRY(message, publishMessage(worker, {deal}));
+      calls.push_back(std::move(message));
+      called.push_back(i);
+    }
+    if (calls.empty()) {
+      return results;
+    }
+    OUTCOME_TRY(invocs, api_->StateCallMany(calls, head_key));
+    if (invocs.size() != calls.size()) {
+      return DealPublisherError::kResultSize;
+    }
+    for (size_t j{0}; j < invocs.size(); ++j) {
+      auto &invoc{invocs[j]};
+      if (!invoc.error.empty()
+          || invoc.receipt.exit_code != vm::VMExitCode::kOk) {
+        results[called[j]] = DealPublisherError::kDealRejected;
+      }
+    }
+    return results;
+  }
+
+  outcome::result<CID> DealPublisher::push(
+      const Address &worker, const std::vector<ClientDealProposal> &deals) {
+    OUTCOME_TRY(unsigned_message, publishMessage(worker, deals));
+    OUTCOME_TRY(signed_message, api_->MpoolPushMessage(unsigned_message));
+    return signed_message.getCid();
+  }
+}  // namespace fc::markets::storage::provider
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::markets::storage::provider,
+                            DealPublisherError,
+                            e) {
+  using E = fc::markets::storage::provider::DealPublisherError;
+  switch (e) {
+    case E::kDealNotInMessage:
+      return "DealPublisherError: deal is not in publish message";
+    case E::kResultSize:
+      return "DealPublisherError: publish result size differs from deals";
+    case E::kStartEpochPassed:
+      return "DealPublisherError: deal start epoch has already passed";
+    case E::kDealRejected:
+      return "DealPublisherError: deal rejected by market actor";
+    default:
+      return "DealPublisherError: unknown error";
+  }
+}
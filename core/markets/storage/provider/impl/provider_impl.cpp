@@ -5,6 +5,7 @@
 
 #include "provider_impl.hpp"
 
+#include <boost/filesystem.hpp>
 #include <libp2p/protocol/common/asio/asio_scheduler.hpp>
 #include "common/libp2p/peer/peer_info_helper.hpp"
 #include "common/todo_error.hpp"
@@ -15,15 +16,17 @@
 #include "markets/storage/provider/storage_provider_error.hpp"
 #include "markets/storage/provider/stored_ask.hpp"
 #include "markets/storage/storage_datatransfer_voucher.hpp"
+#include "metrics/tracing.hpp"
 #include "storage/ipfs/graphsync/impl/graphsync_impl.hpp"
 #include "storage/piece/impl/piece_storage_impl.hpp"
 #include "vm/actor/builtin/market/actor.hpp"
 
-#define CALLBACK_ACTION(_action)                      \
-  [this](auto deal, auto event, auto from, auto to) { \
-    logger_->debug("Provider FSM " #_action);         \
-    _action(deal, event, from, to);                   \
-    deal->state = to;                                 \
+#define CALLBACK_ACTION(_action)                                        \
+  [this](auto deal, auto event, auto from, auto to) {                   \
+    logger_->debug("Provider FSM " #_action);                           \
+    metrics::tracing::ScopedSpan span{dealSpan(#_action, *deal, from, to)}; \
+    _action(deal, event, from, to);                                     \
+    deal->state = to;                                                   \
   }
 
 #define FSM_HALT_ON_ERROR(result, msg, deal)                            \
@@ -51,12 +54,25 @@ namespace fc::markets::storage::provider {
   using host::HostContext;
   using host::HostContextImpl;
   using vm::VMExitCode;
-  using vm::actor::MethodParams;
   using vm::actor::builtin::market::PublishStorageDeals;
-  using vm::message::kDefaultGasLimit;
-  using vm::message::kDefaultGasPrice;
   using vm::message::SignedMessage;
-  using vm::message::UnsignedMessage;
+
+  namespace {
+    /// Span of deal transition action with proposal and states as argument
+    metrics::tracing::Span dealSpan(const char *action,
+                                    const MinerDeal &deal,
+                                    StorageDealStatus from,
+                                    StorageDealStatus to) {
+      metrics::tracing::Span span{"deal", action};
+      if (span) {
+        auto cid{deal.proposal_cid.toString()};
+        span.arg((cid ? cid.value() : "") + " "
+                 + std::to_string(static_cast<int>(from)) + "->"
+                 + std::to_string(static_cast<int>(to)));
+      }
+      return span;
+    }
+  }  // namespace
 
   StorageProviderImpl::StorageProviderImpl(
       const RegisteredProof &registered_proof,
@@ -68,7 +84,9 @@ namespace fc::markets::storage::provider {
       std::shared_ptr<ChainEvents> chain_events,
       const Address &miner_actor_address,
       std::shared_ptr<PieceIO> piece_io,
-      std::shared_ptr<FileStore> filestore)
+      std::shared_ptr<FileStore> filestore,
+      DealAdmissionConfig admission_config,
+      DealPublisherConfig publisher_config)
       : registered_proof_{registered_proof},
         host_{std::make_shared<CborHost>(host)},
         context_{std::move(context)},
@@ -80,12 +98,20 @@ namespace fc::markets::storage::provider {
         miner_actor_address_{miner_actor_address},
         piece_io_{std::move(piece_io)},
         piece_storage_{std::make_shared<PieceStorageImpl>(datastore)},
-        filestore_{filestore} {
+        filestore_{filestore},
+        admission_{std::make_shared<DealAdmission>(api_, admission_config)},
+        publisher_{std::make_shared<DealPublisher>(
+            api_, context_, publisher_config)} {
     auto scheduler = std::make_shared<libp2p::protocol::AsioScheduler>(
         *context_, libp2p::protocol::SchedulerConfig{});
     auto graphsync =
-        std::make_shared<GraphsyncImpl>(host, std::move(scheduler));
+        std::make_shared<GraphsyncImpl>(host,
+                                        std::move(scheduler),
+                                        context_,
+                                        GraphsyncImpl::kSelectThreadsDefault);
     datatransfer_ = std::make_shared<GraphSyncManager>(host, graphsync);
+    deal_states_ = std::make_shared<DealStateStore<MinerDeal>>(
+        datastore, DealStateStoreConfig{}, context_);
   }
 
   outcome::result<void> StorageProviderImpl::init() {
@@ -108,6 +134,22 @@ namespace fc::markets::storage::provider {
     std::shared_ptr<HostContext> fsm_context =
         std::make_shared<HostContextImpl>(context_);
     fsm_ = std::make_shared<ProviderFSM>(makeFSMTransitions(), fsm_context);
+    OUTCOME_TRY(deal_states_->load());
+    // stored deals are tracked again in their last state, so they are listed
+    // and their pending events are handled after restart
+    for (auto &deal : deal_states_->list()) {
+      auto state{deal.state};
+      OUTCOME_TRY(fsm_->begin(std::make_shared<MinerDeal>(std::move(deal)),
+                              state));
+    }
+    fsm_->setAnyChangeAction([deal_states{deal_states_},
+                              logger{logger_}](auto deal, auto, auto, auto to) {
+      auto stored{*deal};
+      stored.state = to;
+      if (auto put{deal_states->put(stored)}; !put) {
+        logger->error("persist deal state: " + put.error().message());
+      }
+    });
 
     // register request validator
     auto state_store = std::make_shared<ProviderFsmStateStore>(fsm_);
@@ -129,7 +171,10 @@ namespace fc::markets::storage::provider {
   }
 
   outcome::result<void> StorageProviderImpl::stop() {
+    // queued deals are published before their fsm stops
+    publisher_->flush();
     fsm_->stop();
+    OUTCOME_TRY(deal_states_->flush());
     std::lock_guard<std::mutex> lock(connections_mutex_);
     for (auto &[_, stream] : connections_) {
       closeStreamGracefully(stream, logger_);
@@ -137,6 +182,11 @@ namespace fc::markets::storage::provider {
     return outcome::success();
   }
 
+  void StorageProviderImpl::setSealingCapacity(
+      std::function<size_t()> capacity) {
+    admission_->setCapacity(std::move(capacity));
+  }
+
   outcome::result<void> StorageProviderImpl::addAsk(const TokenAmount &price,
                                                     ChainEpoch duration) {
     return stored_ask_->addAsk(price, duration);
@@ -173,6 +223,54 @@ namespace fc::markets::storage::provider {
 
   outcome::result<void> StorageProviderImpl::importDataForDeal(
       const CID &proposal_cid, const Buffer &data) {
+    OUTCOME_TRY(deal, findDeal(proposal_cid));
+    OUTCOME_TRY(path, stagedPath(proposal_cid));
+    {
+      OUTCOME_TRY(file, filestore_->create(path));
+      OUTCOME_TRY(file->allocate(data.size()));
+      OUTCOME_TRY(file->write(0, data));
+      OUTCOME_TRY(file->close());
+    }
+    return importStaged(deal, path);
+  }
+
+  outcome::result<void> StorageProviderImpl::importDataForDealFromFile(
+      const CID &proposal_cid, const std::string &path) {
+    OUTCOME_TRY(deal, findDeal(proposal_cid));
+    OUTCOME_TRY(staged, stagedPath(proposal_cid));
+    // staged copy is padded, caller file stays as it was
+    boost::system::error_code ec;
+    boost::filesystem::copy_file(
+        path, staged, boost::filesystem::copy_option::overwrite_if_exists, ec);
+    if (ec) {
+      logger_->error("stage {} failed: {}", path, ec.message());
+      return StorageMarketProviderError::kStagingFailed;
+    }
+    return importStaged(deal, staged);
+  }
+
+  outcome::result<Path> StorageProviderImpl::stagedPath(
+      const CID &proposal_cid) const {
+    OUTCOME_TRY(cid_str, proposal_cid.toString());
+    return kFilestoreTempDir + cid_str;
+  }
+
+  outcome::result<void> StorageProviderImpl::importStaged(
+      std::shared_ptr<MinerDeal> deal, const Path &path) {
+    auto imported{importPieceFile(std::move(deal), path)};
+    if (!imported) {
+      // import error is returned even if staged file is left behind
+      if (auto removed{filestore_->remove(path)}; !removed) {
+        logger_->warn("remove staged {} failed: {}",
+                      path,
+                      removed.error().message());
+      }
+    }
+    return imported;
+  }
+
+  outcome::result<std::shared_ptr<MinerDeal>> StorageProviderImpl::findDeal(
+      const CID &proposal_cid) {
     auto fsm_state_table = fsm_->list();
     auto found_fsm_entity =
         std::find_if(fsm_state_table.begin(),
@@ -184,21 +282,22 @@ namespace fc::markets::storage::provider {
     if (found_fsm_entity == fsm_state_table.end()) {
       return StorageMarketProviderError::kLocalDealNotFound;
     }
-    auto deal = found_fsm_entity->first;
+    return found_fsm_entity->first;
+  }
 
+  outcome::result<void> StorageProviderImpl::importPieceFile(
+      std::shared_ptr<MinerDeal> deal, const Path &path) {
+    // commitment is streamed over staged file, piece is not loaded to memory
     OUTCOME_TRY(piece_commitment,
-                piece_io_->generatePieceCommitment(registered_proof_, data));
+                piece_io_->generatePieceCommitmentFromFile(registered_proof_,
+                                                           path));
 
     if (piece_commitment.first
         != deal->client_deal_proposal.proposal.piece_cid) {
       return StorageMarketProviderError::kPieceCIDDoesNotMatch;
     }
 
-    OUTCOME_TRY(cid_str, proposal_cid.toString());
-    Path path = kFilestoreTempDir + cid_str;
-    OUTCOME_TRY(file, filestore_->create(path));
     deal->piece_path = path;
-    OUTCOME_TRY(file->write(0, data));
 
     OUTCOME_TRY(fsm_->send(deal, ProviderEvent::ProviderEventVerifiedData));
     return outcome::success();
@@ -282,8 +381,9 @@ namespace fc::markets::storage::provider {
       return false;
     }
 
-    OUTCOME_TRY(chain_head, api_->ChainHead());
-    OUTCOME_TRY(tipset_key, chain_head.makeKey());
+    // head snapshot is shared by concurrent proposals
+    OUTCOME_TRY(head, admission_->head());
+    auto &chain_head{head.tipset};
     if (static_cast<ChainEpoch>(chain_head.height)
         > proposal.start_epoch - kDefaultDealAcceptanceBuffer) {
       deal->message =
@@ -322,10 +422,9 @@ namespace fc::markets::storage::provider {
     }
 
     // This doesn't guarantee that the client won't withdraw / lock those funds
-    // but it's a decent first filter
-    OUTCOME_TRY(client_balance,
-                api_->StateMarketBalance(proposal.client, tipset_key));
-    TokenAmount available = client_balance.escrow - client_balance.locked;
+    // but it's a decent first filter. Funds of other admitted deals are
+    // reserved, so concurrent proposals don't spend same balance
+    OUTCOME_TRY(available, admission_->available(proposal.client));
     if (available < proposal.getTotalStorageFee()) {
       std::stringstream ss;
       ss << "Deal proposal verification failed, client market available "
@@ -334,6 +433,8 @@ namespace fc::markets::storage::provider {
       deal->message = ss.str();
       return false;
     }
+    admission_->reserve(
+        deal->proposal_cid, proposal.client, proposal.getTotalStorageFee());
 
     return true;
   }
@@ -353,30 +454,6 @@ namespace fc::markets::storage::provider {
     return std::move(maybe_cid);
   }
 
-  outcome::result<CID> StorageProviderImpl::publishDeal(
-      std::shared_ptr<MinerDeal> deal) {
-    OUTCOME_TRY(chain_head, api_->ChainHead());
-    OUTCOME_TRY(tipset_key, chain_head.makeKey());
-    OUTCOME_TRY(worker_info,
-                api_->StateMinerInfo(
-                    deal->client_deal_proposal.proposal.provider, tipset_key));
-    std::vector<ClientDealProposal> params{deal->client_deal_proposal};
-    OUTCOME_TRY(encoded_params, codec::cbor::encode(params));
-    UnsignedMessage unsigned_message(vm::actor::kStorageMarketAddress,
-                                     worker_info.worker,
-                                     0,
-                                     TokenAmount{0},
-                                     kDefaultGasPrice,
-                                     kDefaultGasLimit,
-                                     PublishStorageDeals::Number,
-                                     MethodParams{encoded_params});
-    OUTCOME_TRY(signed_message, api_->MpoolPushMessage(unsigned_message));
-    CID cid = signed_message.getCid();
-    OUTCOME_TRY(str_cid, cid.toString());
-    logger_->debug("Deal published with CID = " + str_cid);
-    return std::move(cid);
-  }
-
   outcome::result<void> StorageProviderImpl::sendSignedResponse(
       std::shared_ptr<MinerDeal> deal) {
     OUTCOME_TRY(chain_head, api_->ChainHead());
@@ -458,6 +535,7 @@ namespace fc::markets::storage::provider {
 
   outcome::result<void> StorageProviderImpl::finalizeDeal(
       std::shared_ptr<MinerDeal> deal) {
+    admission_->release(deal->proposal_cid);
     std::lock_guard<std::mutex> lock(connections_mutex_);
     auto stream_it = connections_.find(deal->proposal_cid);
     if (stream_it != connections_.end()) {
@@ -539,6 +617,23 @@ namespace fc::markets::storage::provider {
                                                 ProviderEvent event,
                                                 StorageDealStatus from,
                                                 StorageDealStatus to) {
+    auto admitted{admission_->admit(
+        deal->proposal_cid, [self{shared_from_this()}, deal] {
+          self->context_->post([self, deal] { self->onDealAdmitted(deal); });
+        })};
+    if (admitted == DealAdmission::Result::kRejected) {
+      deal->message = "Deal proposal rejected, provider is overloaded";
+      FSM_SEND(deal, ProviderEvent::ProviderEventFailed);
+      return;
+    }
+    if (admitted == DealAdmission::Result::kQueued) {
+      logger_->debug("Deal proposal queued for admission");
+      return;
+    }
+    onDealAdmitted(deal);
+  }
+
+  void StorageProviderImpl::onDealAdmitted(std::shared_ptr<MinerDeal> deal) {
     auto verified = verifyDealProposal(deal);
     FSM_HALT_ON_ERROR(verified, "Deal proposal verify error", deal);
     if (!verified.value()) {
@@ -608,10 +703,14 @@ namespace fc::markets::storage::provider {
       ProviderEvent event,
       StorageDealStatus from,
       StorageDealStatus to) {
-    auto maybe_cid = publishDeal(deal);
-    FSM_HALT_ON_ERROR(maybe_cid, "Publish deal error", deal);
-    deal->publish_cid = maybe_cid.value();
-    FSM_SEND(deal, ProviderEvent::ProviderEventDealPublishInitiated);
+    // deal waits for batch, message is shared with other deals of batch
+    publisher_->publish(
+        deal->client_deal_proposal,
+        [self{shared_from_this()}, deal](outcome::result<CID> maybe_cid) {
+          SELF_FSM_HALT_ON_ERROR(maybe_cid, "Publish deal error", deal);
+          deal->publish_cid = maybe_cid.value();
+          SELF_FSM_SEND(deal, ProviderEvent::ProviderEventDealPublishInitiated);
+        });
   }
 
   void StorageProviderImpl::onProviderEventDataTransferInitiated(
@@ -676,12 +775,13 @@ namespace fc::markets::storage::provider {
           result.value().receipt.return_value);
       SELF_FSM_HALT_ON_ERROR(
           maybe_res, "Publish storage deal decode result error", deal);
-      if (maybe_res.value().deals.size() != 1) {
-        deal->message = "Publish storage deal result size error";
-        SELF_FSM_SEND(deal, ProviderEvent::ProviderEventFailed);
-        return;
-      }
-      deal->deal_id = maybe_res.value().deals.front();
+      auto maybe_deal_id{self->publisher_->dealIdOf(
+          deal->publish_cid.get(),
+          maybe_res.value().deals,
+          deal->client_deal_proposal)};
+      SELF_FSM_HALT_ON_ERROR(
+          maybe_deal_id, "Publish storage deal result error", deal);
+      deal->deal_id = maybe_deal_id.value();
       deal->state = to;
       SELF_FSM_HALT_ON_ERROR(
           self->sendSignedResponse(deal), "Error when sending response", deal);
@@ -693,6 +793,8 @@ namespace fc::markets::storage::provider {
       ProviderEvent event,
       StorageDealStatus from,
       StorageDealStatus to) {
+    // funds are locked on chain by published deal
+    admission_->unreserve(deal->proposal_cid);
     // TODO hand off
     // miner_node_api.addPiece
     FSM_SEND(deal, ProviderEvent::ProviderEventDealHandedOff);
@@ -769,6 +871,8 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::markets::storage::provider,
     case StorageMarketProviderError::kPieceCIDDoesNotMatch:
       return "StorageMarketProviderError: imported piece cid doensn't match "
              "proposal piece cid";
+    case StorageMarketProviderError::kStagingFailed:
+      return "StorageMarketProviderError: cannot stage deal data";
   }
 
   return "StorageMarketProviderError: unknown error";
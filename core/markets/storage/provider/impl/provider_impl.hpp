@@ -15,7 +15,10 @@
 #include "fsm/fsm.hpp"
 #include "markets/common.hpp"
 #include "markets/pieceio/pieceio.hpp"
+#include "markets/storage/deal_state_store.hpp"
 #include "markets/storage/chain_events/chain_events.hpp"
+#include "markets/storage/provider/deal_admission.hpp"
+#include "markets/storage/provider/deal_publisher.hpp"
 #include "markets/storage/provider/provider.hpp"
 #include "markets/storage/provider/provider_events.hpp"
 #include "markets/storage/provider/stored_ask.hpp"
@@ -60,7 +63,9 @@ namespace fc::markets::storage::provider {
                         std::shared_ptr<ChainEvents> events,
                         const Address &miner_actor_address,
                         std::shared_ptr<PieceIO> piece_io,
-                        std::shared_ptr<FileStore> filestore);
+                        std::shared_ptr<FileStore> filestore,
+                        DealAdmissionConfig admission_config = {},
+                        DealPublisherConfig publisher_config = {});
 
     auto init() -> outcome::result<void> override;
 
@@ -85,7 +90,40 @@ namespace fc::markets::storage::provider {
     auto importDataForDeal(const CID &proposal_cid, const Buffer &data)
         -> outcome::result<void> override;
 
+    auto importDataForDealFromFile(const CID &proposal_cid,
+                                   const std::string &path)
+        -> outcome::result<void> override;
+
+    /**
+     * Sets expected sealing capacity used by deal admission
+     * @param capacity - number of deals sealing can take
+     */
+    void setSealingCapacity(std::function<size_t()> capacity);
+
    private:
+    /**
+     * Look up deal in fsm by proposal cid
+     * @param proposal_cid - key to find deal
+     * @return deal state
+     */
+    outcome::result<std::shared_ptr<MinerDeal>> findDeal(
+        const CID &proposal_cid);
+
+    /**
+     * Verify commitment of staged piece file and use it as piece of deal
+     * @param deal - deal waiting for data
+     * @param path - staged piece file
+     */
+    outcome::result<void> importPieceFile(std::shared_ptr<MinerDeal> deal,
+                                          const Path &path);
+
+    /// Staged piece file of deal
+    outcome::result<Path> stagedPath(const CID &proposal_cid) const;
+
+    /// Imports staged piece file, which is removed if import fails
+    outcome::result<void> importStaged(std::shared_ptr<MinerDeal> deal,
+                                       const Path &path);
+
     /**
      * Handle incoming ask stream
      * @param stream
@@ -114,13 +152,6 @@ namespace fc::markets::storage::provider {
     outcome::result<boost::optional<CID>> ensureProviderFunds(
         std::shared_ptr<MinerDeal> deal);
 
-    /**
-     * Publish storage deal
-     * @param deal to publish
-     * @return CID of message sent
-     */
-    outcome::result<CID> publishDeal(std::shared_ptr<MinerDeal> deal);
-
     /**
      * Send signed response to storage deal proposal and close connection
      * @param deal - state of deal
@@ -177,6 +208,9 @@ namespace fc::markets::storage::provider {
                              StorageDealStatus from,
                              StorageDealStatus to);
 
+    /// Verifies proposal of deal holding admission slot
+    void onDealAdmitted(std::shared_ptr<MinerDeal> deal);
+
     /**
      * @brief Handle event deal accepted
      * @param deal  - current storage deal
@@ -361,6 +395,8 @@ namespace fc::markets::storage::provider {
 
     /** State machine */
     std::shared_ptr<ProviderFSM> fsm_;
+    /** Persisted deal states, written by fsm transitions */
+    std::shared_ptr<DealStateStore<MinerDeal>> deal_states_;
 
     std::shared_ptr<CborHost> host_;
     std::shared_ptr<boost::asio::io_context> context_;
@@ -373,6 +409,10 @@ namespace fc::markets::storage::provider {
     std::shared_ptr<PieceStorage> piece_storage_;
     std::shared_ptr<FileStore> filestore_;
     std::shared_ptr<DataTransfer> datatransfer_;
+    /// Slots, head snapshot and balance view shared by proposals
+    std::shared_ptr<DealAdmission> admission_;
+    /// Batches publish messages of funded deals
+    std::shared_ptr<DealPublisher> publisher_;
 
     common::Logger logger_ = common::createLogger("StorageMarketProvider");
   };
@@ -382,7 +422,8 @@ namespace fc::markets::storage::provider {
    */
   enum class StorageMarketProviderError {
     kLocalDealNotFound = 1,
-    kPieceCIDDoesNotMatch
+    kPieceCIDDoesNotMatch,
+    kStagingFailed,
   };
 
 }  // namespace fc::markets::storage::provider
@@ -56,6 +56,16 @@ namespace fc::markets::storage::provider {
 
     virtual auto importDataForDeal(const CID &proposal_cid, const Buffer &data)
         -> outcome::result<void> = 0;
+
+    /**
+     * Imports deal data from file, which is copied to staged piece file of
+     * deal, so file of caller is not modified
+     * @param proposal_cid - deal proposal
+     * @param path - payload file
+     */
+    virtual auto importDataForDealFromFile(const CID &proposal_cid,
+                                           const std::string &path)
+        -> outcome::result<void> = 0;
   };
 }  // namespace fc::markets::storage::provider
 
@@ -0,0 +1,98 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "metrics/http_exporter.hpp"
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+namespace fc::metrics {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  namespace net = boost::asio;
+  using tcp = boost::asio::ip::tcp;
+
+  constexpr auto kContentType{"text/plain; version=0.0.4"};
+
+  struct MetricsSession : std::enable_shared_from_this<MetricsSession> {
+    MetricsSession(tcp::socket &&socket, const Registry &registry)
+        : stream{std::move(socket)}, registry{registry} {}
+
+    void doRead() {
+      request = {};
+      http::async_read(
+          stream, buffer, request, [self{shared_from_this()}](auto ec, auto) {
+            if (ec) {
+              return;
+            }
+            self->onRead();
+          });
+    }
+
+    void onRead() {
+      response = {};
+      response.version(request.version());
+      response.keep_alive(request.keep_alive());
+      if (request.method() != http::verb::get) {
+        response.result(http::status::method_not_allowed);
+      } else if (request.target() != "/metrics") {
+        response.result(http::status::not_found);
+      } else {
+        response.result(http::status::ok);
+        response.set(http::field::content_type, kContentType);
+        response.body() = registry.prometheus();
+      }
+      response.prepare_payload();
+      http::async_write(
+          stream, response, [self{shared_from_this()}](auto ec, auto) {
+            if (ec) {
+              return;
+            }
+            if (!self->response.keep_alive()) {
+              beast::error_code ignored;
+              self->stream.socket().shutdown(tcp::socket::shutdown_send,
+                                             ignored);
+              return;
+            }
+            self->doRead();
+          });
+    }
+
+    beast::tcp_stream stream;
+    const Registry &registry;
+    beast::flat_buffer buffer;
+    http::request<http::string_body> request;
+    http::response<http::string_body> response;
+  };
+
+  struct MetricsServer : std::enable_shared_from_this<MetricsServer> {
+    MetricsServer(tcp::acceptor &&acceptor, const Registry &registry)
+        : acceptor{std::move(acceptor)}, registry{registry} {}
+
+    void doAccept() {
+      acceptor.async_accept([self{shared_from_this()}](auto ec, auto socket) {
+        if (ec) {
+          return;
+        }
+        std::make_shared<MetricsSession>(std::move(socket), self->registry)
+            ->doRead();
+        self->doAccept();
+      });
+    }
+
+    tcp::acceptor acceptor;
+    const Registry &registry;
+  };
+
+  void serveMetrics(boost::asio::io_context &ioc,
+                    std::string_view ip,
+                    unsigned short port,
+                    const Registry &registry) {
+    std::make_shared<MetricsServer>(
+        tcp::acceptor{ioc, {net::ip::make_address(ip), port}}, registry)
+        ->doAccept();
+  }
+}  // namespace fc::metrics
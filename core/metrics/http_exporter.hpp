@@ -0,0 +1,25 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_METRICS_HTTP_EXPORTER_HPP
+#define CPP_FILECOIN_CORE_METRICS_HTTP_EXPORTER_HPP
+
+#include <string_view>
+
+#include "metrics/metrics.hpp"
+
+namespace boost::asio {
+  class io_context;
+}  // namespace boost::asio
+
+namespace fc::metrics {
+  /// Serves registry in Prometheus text format on GET /metrics over http
+  void serveMetrics(boost::asio::io_context &ioc,
+                    std::string_view ip,
+                    unsigned short port,
+                    const Registry &registry = Registry::global());
+}  // namespace fc::metrics
+
+#endif  // CPP_FILECOIN_CORE_METRICS_HTTP_EXPORTER_HPP
@@ -0,0 +1,62 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_METRICS_MEMORY_HPP
+#define CPP_FILECOIN_CORE_METRICS_MEMORY_HPP
+
+#include "metrics/metrics.hpp"
+
+namespace fc::metrics {
+  /// Approximate allocation overhead of node of map or set
+  constexpr size_t kNodeOverhead{3 * sizeof(void *)};
+
+  /// Gauge of approximate heap bytes held by subsystem
+  inline Gauge &memoryGauge(const std::string &subsystem) {
+    return Registry::global().gauge("fc_memory_bytes",
+                                    "Approximate heap bytes by subsystem",
+                                    {{"subsystem", subsystem}});
+  }
+
+  /// Approximate heap bytes of container with entries of given size
+  template <typename Container>
+  size_t containerBytes(const Container &container, size_t entry_bytes) {
+    return container.size() * (entry_bytes + kNodeOverhead);
+  }
+
+  /**
+   * Bytes of subsystem held by one object. Owner reports its estimate on
+   * change, and it is removed from subsystem gauge on destruction.
+   */
+  class MemoryShare {
+   public:
+    explicit MemoryShare(Gauge &gauge) : gauge_{gauge} {}
+
+    explicit MemoryShare(const std::string &subsystem)
+        : MemoryShare{memoryGauge(subsystem)} {}
+
+    MemoryShare(const MemoryShare &) = delete;
+    MemoryShare &operator=(const MemoryShare &) = delete;
+
+    ~MemoryShare() {
+      gauge_.add(-bytes_);
+    }
+
+    void set(size_t bytes) {
+      auto value{static_cast<int64_t>(bytes)};
+      gauge_.add(value - bytes_);
+      bytes_ = value;
+    }
+
+    size_t bytes() const {
+      return bytes_;
+    }
+
+   private:
+    Gauge &gauge_;
+    int64_t bytes_{};
+  };
+}  // namespace fc::metrics
+
+#endif  // CPP_FILECOIN_CORE_METRICS_MEMORY_HPP
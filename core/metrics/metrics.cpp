@@ -0,0 +1,194 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "metrics/metrics.hpp"
+
+#include <sstream>
+
+namespace fc::metrics {
+  namespace {
+    constexpr size_t kSubBuckets{4};
+
+    /// Escapes label value or help text for exposition format
+    std::string escape(const std::string &str, bool quote) {
+      std::string out;
+      out.reserve(str.size());
+      for (auto c : str) {
+        if (c == '\\') {
+          out += "\\\\";
+        } else if (c == '\n') {
+          out += "\\n";
+        } else if (quote && c == '"') {
+          out += "\\\"";
+        } else {
+          out += c;
+        }
+      }
+      return out;
+    }
+
+    /// Adds label to formatted labels
+    std::string withLabel(const std::string &labels,
+                          const std::string &name,
+                          const std::string &value) {
+      auto label{name + "=\"" + value + "\""};
+      if (labels.empty()) {
+        return "{" + label + "}";
+      }
+      return labels.substr(0, labels.size() - 1) + "," + label + "}";
+    }
+  }  // namespace
+
+  size_t Histogram::bucketOf(uint64_t value) {
+    if (value < kSubBuckets) {
+      return value;
+    }
+    size_t exponent{63 - static_cast<size_t>(__builtin_clzll(value))};
+    auto mantissa{(value >> (exponent - 2)) & (kSubBuckets - 1)};
+    return kSubBuckets + (exponent - 2) * kSubBuckets + mantissa;
+  }
+
+  uint64_t Histogram::bucketMax(size_t index) {
+    if (index < kSubBuckets) {
+      return index;
+    }
+    auto exponent{(index - kSubBuckets) / kSubBuckets + 2};
+    auto mantissa{(index - kSubBuckets) % kSubBuckets};
+    // wraps to max value for last bucket
+    return ((kSubBuckets + mantissa + 1) << (exponent - 2)) - 1;
+  }
+
+  uint64_t Histogram::quantile(double quantile) const {
+    auto total{count()};
+    if (total == 0) {
+      return 0;
+    }
+    auto rank{static_cast<uint64_t>(quantile * total)};
+    uint64_t seen{0};
+    for (size_t i{0}; i < kBuckets; ++i) {
+      seen += bucket(i);
+      if (seen > rank) {
+        return bucketMax(i);
+      }
+    }
+    return bucketMax(kBuckets - 1);
+  }
+
+  Registry &Registry::global() {
+    static Registry registry;
+    return registry;
+  }
+
+  Counter &Registry::counter(const std::string &name,
+                             const std::string &help,
+                             const Labels &labels) {
+    std::lock_guard lock{mutex_};
+    auto &metric{
+        family(name, help, Type::kCounter, 1).counters[formatLabels(labels)]};
+    if (!metric) {
+      metric = std::make_unique<Counter>();
+    }
+    return *metric;
+  }
+
+  Gauge &Registry::gauge(const std::string &name,
+                         const std::string &help,
+                         const Labels &labels) {
+    std::lock_guard lock{mutex_};
+    auto &metric{
+        family(name, help, Type::kGauge, 1).gauges[formatLabels(labels)]};
+    if (!metric) {
+      metric = std::make_unique<Gauge>();
+    }
+    return *metric;
+  }
+
+  Histogram &Registry::histogram(const std::string &name,
+                                 const std::string &help,
+                                 const Labels &labels,
+                                 double scale) {
+    std::lock_guard lock{mutex_};
+    auto &family{this->family(name, help, Type::kHistogram, scale)};
+    auto &metric{family.histograms[formatLabels(labels)]};
+    if (!metric) {
+      metric = std::make_unique<Histogram>(family.scale);
+    }
+    return *metric;
+  }
+
+  std::string Registry::prometheus() const {
+    std::ostringstream out;
+    std::lock_guard lock{mutex_};
+    for (auto &[name, family] : families_) {
+      out << "# HELP " << name << " " << escape(family.help, false) << "\n";
+      switch (family.type) {
+        case Type::kCounter:
+          out << "# TYPE " << name << " counter\n";
+          for (auto &[labels, counter] : family.counters) {
+            out << name << labels << " " << counter->value() << "\n";
+          }
+          break;
+        case Type::kGauge:
+          out << "# TYPE " << name << " gauge\n";
+          for (auto &[labels, gauge] : family.gauges) {
+            out << name << labels << " " << gauge->value() << "\n";
+          }
+          break;
+        case Type::kHistogram:
+          out << "# TYPE " << name << " histogram\n";
+          for (auto &[labels, histogram] : family.histograms) {
+            // empty buckets are skipped, cumulative counts stay same
+            uint64_t cumulative{0};
+            for (size_t i{0}; i < Histogram::kBuckets; ++i) {
+              auto count{histogram->bucket(i)};
+              if (count == 0) {
+                continue;
+              }
+              cumulative += count;
+              std::ostringstream le;
+              le << Histogram::bucketMax(i) * family.scale;
+              out << name << "_bucket" << withLabel(labels, "le", le.str())
+                  << " " << cumulative << "\n";
+            }
+            out << name << "_bucket" << withLabel(labels, "le", "+Inf") << " "
+                << histogram->count() << "\n";
+            out << name << "_sum" << labels << " "
+                << histogram->sum() * family.scale << "\n";
+            out << name << "_count" << labels << " " << histogram->count()
+                << "\n";
+          }
+          break;
+      }
+    }
+    return out.str();
+  }
+
+  Registry::Family &Registry::family(const std::string &name,
+                                     const std::string &help,
+                                     Type type,
+                                     double scale) {
+    auto it{families_.find(name)};
+    if (it == families_.end()) {
+      it = families_.emplace(name, Family{type, help, scale, {}, {}, {}})
+               .first;
+    }
+    return it->second;
+  }
+
+  std::string formatLabels(const Labels &labels) {
+    if (labels.empty()) {
+      return {};
+    }
+    std::string out{"{"};
+    for (auto &[name, value] : labels) {
+      if (out.size() != 1) {
+        out += ',';
+      }
+      out += name + "=\"" + escape(value, true) + "\"";
+    }
+    out += '}';
+    return out;
+  }
+}  // namespace fc::metrics
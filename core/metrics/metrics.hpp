@@ -0,0 +1,180 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_METRICS_METRICS_HPP
+#define CPP_FILECOIN_CORE_METRICS_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace fc::metrics {
+  /// Label names and values of metric
+  using Labels = std::vector<std::pair<std::string, std::string>>;
+
+  /// Monotonic counter, lock-free
+  class Counter {
+   public:
+    void inc(uint64_t n = 1) {
+      value_.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const {
+      return value_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic<uint64_t> value_{};
+  };
+
+  /// Value which goes up and down, lock-free
+  class Gauge {
+   public:
+    void set(int64_t value) {
+      value_.store(value, std::memory_order_relaxed);
+    }
+
+    void add(int64_t delta) {
+      value_.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    int64_t value() const {
+      return value_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic<int64_t> value_{};
+  };
+
+  /**
+   * Log-linear histogram of unsigned values, like HDR histogram with two
+   * significant bits: each power of two range is split into four buckets,
+   * so bucket bounds are within 25% of recorded values over whole uint64
+   * range without configuration. Lock-free.
+   */
+  class Histogram {
+   public:
+    static constexpr size_t kBuckets{252};
+
+    /// @param scale - multiplier of values in export, 1e-9 for ns as seconds
+    explicit Histogram(double scale = 1) : scale_{scale} {}
+
+    void observe(uint64_t value) {
+      buckets_[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+      count_.fetch_add(1, std::memory_order_relaxed);
+      sum_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void observe(std::chrono::nanoseconds time) {
+      observe(static_cast<uint64_t>(std::max<int64_t>(0, time.count())));
+    }
+
+    uint64_t count() const {
+      return count_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t sum() const {
+      return sum_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t bucket(size_t index) const {
+      return buckets_[index].load(std::memory_order_relaxed);
+    }
+
+    double scale() const {
+      return scale_;
+    }
+
+    /// Highest value falling into bucket, so all values of bucket are "le" it
+    static uint64_t bucketMax(size_t index);
+
+    static size_t bucketOf(uint64_t value);
+
+    /// Approximate value below which quantile of observations falls
+    uint64_t quantile(double quantile) const;
+
+   private:
+    double scale_;
+    std::atomic<uint64_t> count_{};
+    std::atomic<uint64_t> sum_{};
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+  };
+
+  /// Records time since construction into histogram of nanoseconds on exit
+  class Timer {
+   public:
+    explicit Timer(Histogram &histogram)
+        : histogram_{histogram}, start_{std::chrono::steady_clock::now()} {}
+
+    ~Timer() {
+      histogram_.observe(std::chrono::steady_clock::now() - start_);
+    }
+
+   private:
+    Histogram &histogram_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+  /**
+   * Named metric families with labels, exported in Prometheus text format.
+   * Metrics are created on first lookup and live as long as registry, so hot
+   * paths look up once and keep reference; lookup takes lock, updates don't.
+   */
+  class Registry {
+   public:
+    /// Registry of process, exported by metrics server
+    static Registry &global();
+
+    Counter &counter(const std::string &name,
+                     const std::string &help,
+                     const Labels &labels = {});
+
+    Gauge &gauge(const std::string &name,
+                 const std::string &help,
+                 const Labels &labels = {});
+
+    /**
+     * @param scale - multiplier of values in export, all metrics of family
+     * use scale of first one
+     */
+    Histogram &histogram(const std::string &name,
+                         const std::string &help,
+                         const Labels &labels = {},
+                         double scale = 1);
+
+    /// Prometheus text exposition format of all metrics
+    std::string prometheus() const;
+
+   private:
+    enum class Type { kCounter, kGauge, kHistogram };
+
+    struct Family {
+      Type type;
+      std::string help;
+      double scale{1};
+      std::map<std::string, std::unique_ptr<Counter>> counters;
+      std::map<std::string, std::unique_ptr<Gauge>> gauges;
+      std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    };
+
+    Family &family(const std::string &name,
+                   const std::string &help,
+                   Type type,
+                   double scale);
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family> families_;
+  };
+
+  /// Formats labels as {name="value",...}, empty string for no labels
+  std::string formatLabels(const Labels &labels);
+}  // namespace fc::metrics
+
+#endif  // CPP_FILECOIN_CORE_METRICS_METRICS_HPP
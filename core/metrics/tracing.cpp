@@ -0,0 +1,185 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "metrics/tracing.hpp"
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace fc::metrics::tracing {
+  namespace detail {
+    std::atomic<bool> enabled{false};
+  }  // namespace detail
+
+  namespace {
+    struct SpanRecord {
+      const char *category;
+      const char *name;
+      Clock::time_point start;
+      Clock::time_point end;
+      std::string arg;
+    };
+
+    /**
+     * Spans of one thread. Mutex is only contended by export, so record
+     * is cheap.
+     */
+    struct Ring {
+      std::mutex mutex;
+      uint64_t tid{};
+      std::vector<SpanRecord> spans;
+      size_t next{};
+      /// Capacity for spans recorded after clear
+      size_t capacity{};
+    };
+
+    struct Rings {
+      std::mutex mutex;
+      std::vector<std::shared_ptr<Ring>> rings;
+      size_t capacity{kDefaultSpansPerThread};
+      /// Trace timestamps are relative to enable
+      Clock::time_point origin{Clock::now()};
+    };
+
+    Rings &rings() {
+      static Rings rings;
+      return rings;
+    }
+
+    /// Ring of current thread, which is kept by registry after thread exits
+    Ring &threadRing() {
+      thread_local std::shared_ptr<Ring> ring{[] {
+        auto &all{rings()};
+        auto ring{std::make_shared<Ring>()};
+        std::lock_guard lock{all.mutex};
+        ring->tid = all.rings.size() + 1;
+        ring->capacity = all.capacity;
+        all.rings.push_back(ring);
+        return ring;
+      }()};
+      return *ring;
+    }
+
+    void escapeJson(std::string &out, const char *str) {
+      for (; *str != 0; ++str) {
+        auto c{static_cast<unsigned char>(*str)};
+        if (c == '"' || c == '\\') {
+          out += '\\';
+          out += *str;
+        } else if (c < 0x20) {
+          constexpr auto kHex{"0123456789abcdef"};
+          out += "\\u00";
+          out += kHex[c >> 4];
+          out += kHex[c & 0xf];
+        } else {
+          out += *str;
+        }
+      }
+    }
+
+    int64_t micros(Clock::duration duration) {
+      return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+          .count();
+    }
+  }  // namespace
+
+  void enable(size_t spans_per_thread) {
+    auto &all{rings()};
+    std::lock_guard lock{all.mutex};
+    all.capacity = std::max<size_t>(1, spans_per_thread);
+    all.origin = Clock::now();
+    for (auto &ring : all.rings) {
+      std::lock_guard ring_lock{ring->mutex};
+      ring->spans.clear();
+      ring->spans.shrink_to_fit();
+      ring->next = 0;
+      ring->capacity = all.capacity;
+    }
+    detail::enabled = true;
+  }
+
+  void disable() {
+    detail::enabled = false;
+  }
+
+  void record(const char *category,
+              const char *name,
+              Clock::time_point start,
+              Clock::time_point end,
+              std::string arg) {
+    if (!enabled()) {
+      return;
+    }
+    auto &ring{threadRing()};
+    std::lock_guard lock{ring.mutex};
+    SpanRecord span{category, name, start, end, std::move(arg)};
+    if (ring.spans.size() < ring.capacity) {
+      ring.spans.push_back(std::move(span));
+    } else {
+      ring.spans[ring.next] = std::move(span);
+    }
+    ring.next = (ring.next + 1) % ring.capacity;
+  }
+
+  std::string chromeTrace() {
+    auto &all{rings()};
+    std::lock_guard lock{all.mutex};
+    std::string out{"{\"traceEvents\":["};
+    auto first{true};
+    for (auto &ring : all.rings) {
+      std::lock_guard ring_lock{ring->mutex};
+      for (auto &span : ring->spans) {
+        if (!first) {
+          out += ',';
+        }
+        first = false;
+        out += "{\"ph\":\"X\",\"pid\":1,\"tid\":";
+        out += std::to_string(ring->tid);
+        out += ",\"ts\":";
+        out += std::to_string(micros(span.start - all.origin));
+        out += ",\"dur\":";
+        out += std::to_string(micros(span.end - span.start));
+        out += ",\"cat\":\"";
+        escapeJson(out, span.category);
+        out += "\",\"name\":\"";
+        escapeJson(out, span.name);
+        out += '"';
+        if (!span.arg.empty()) {
+          out += ",\"args\":{\"arg\":\"";
+          escapeJson(out, span.arg.c_str());
+          out += "\"}";
+        }
+        out += '}';
+      }
+    }
+    out += "],\"displayTimeUnit\":\"ms\"}";
+    return out;
+  }
+
+  outcome::result<void> writeChromeTrace(const std::string &path) {
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    if (!file.is_open()) {
+      return TracingError::kCannotWriteFile;
+    }
+    file << chromeTrace();
+    file.close();
+    if (file.fail()) {
+      return TracingError::kCannotWriteFile;
+    }
+    return outcome::success();
+  }
+}  // namespace fc::metrics::tracing
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::metrics::tracing, TracingError, e) {
+  using fc::metrics::tracing::TracingError;
+  switch (e) {
+    case TracingError::kCannotWriteFile:
+      return "TracingError: cannot write trace file";
+    default:
+      return "TracingError: unknown error";
+  }
+}
@@ -0,0 +1,114 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_METRICS_TRACING_HPP
+#define CPP_FILECOIN_CORE_METRICS_TRACING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#include "common/outcome.hpp"
+
+/**
+ * Opt-in tracing of spans with begin and end time. Spans are recorded into
+ * ring buffer of recording thread, so old spans are overwritten and threads
+ * don't contend. Recorded spans are exported in Chrome trace event format,
+ * viewable in chrome://tracing and Perfetto.
+ */
+namespace fc::metrics::tracing {
+  using Clock = std::chrono::steady_clock;
+
+  enum class TracingError { kCannotWriteFile = 1 };
+
+  /// Default capacity of ring buffer of thread
+  constexpr size_t kDefaultSpansPerThread{1 << 16};
+
+  namespace detail {
+    extern std::atomic<bool> enabled;
+  }  // namespace detail
+
+  /// Starts recording, spans recorded before are cleared
+  void enable(size_t spans_per_thread = kDefaultSpansPerThread);
+
+  /// Stops recording, recorded spans are kept for export
+  void disable();
+
+  inline bool enabled() {
+    return detail::enabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Records span if tracing is enabled
+   * @param category, name - static strings, which are not copied
+   * @param arg - optional detail, like sector or peer
+   */
+  void record(const char *category,
+              const char *name,
+              Clock::time_point start,
+              Clock::time_point end,
+              std::string arg = {});
+
+  /**
+   * Span started on construction and recorded by end(). Copyable, so it can
+   * travel with async callbacks and end on other thread. Each copy records
+   * on end, so only one should be ended.
+   */
+  class Span {
+   public:
+    Span(const char *category, const char *name)
+        : category_{category}, name_{name}, active_{enabled()} {
+      if (active_) {
+        start_ = Clock::now();
+      }
+    }
+
+    /// Whether span is recorded, so args are formatted only when needed
+    explicit operator bool() const {
+      return active_;
+    }
+
+    void arg(std::string arg) {
+      arg_ = std::move(arg);
+    }
+
+    /// Records span, only first call records, const for const callbacks
+    void end() const {
+      if (active_) {
+        active_ = false;
+        record(category_, name_, start_, Clock::now(), std::move(arg_));
+      }
+    }
+
+   private:
+    const char *category_;
+    const char *name_;
+    mutable bool active_;
+    Clock::time_point start_;
+    mutable std::string arg_;
+  };
+
+  /// Span recorded on scope exit
+  class ScopedSpan : public Span {
+   public:
+    using Span::Span;
+    explicit ScopedSpan(Span span) : Span{std::move(span)} {}
+    ScopedSpan(const ScopedSpan &) = delete;
+    ScopedSpan &operator=(const ScopedSpan &) = delete;
+
+    ~ScopedSpan() {
+      end();
+    }
+  };
+
+  /// Recorded spans of all threads as Chrome trace event json
+  std::string chromeTrace();
+
+  outcome::result<void> writeChromeTrace(const std::string &path);
+}  // namespace fc::metrics::tracing
+
+OUTCOME_HPP_DECLARE_ERROR(fc::metrics::tracing, TracingError);
+
+#endif  // CPP_FILECOIN_CORE_METRICS_TRACING_HPP
@@ -0,0 +1,240 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "miner/commit_submitter.hpp"
+
+#include <boost/asio/steady_timer.hpp>
+
+namespace fc::mining {
+  using vm::message::UnsignedMessage;
+
+  CommitSubmitter::CommitSubmitter(std::shared_ptr<Api> api,
+                                   std::shared_ptr<boost::asio::io_context> io,
+                                   CommitSubmitterConfig config)
+      : api_{std::move(api)},
+        io_{std::move(io)},
+        config_{config},
+        logger_{common::createLogger("commit submitter")} {}
+
+  outcome::result<void> CommitSubmitter::preCommit(
+      const Address &miner,
+      const Address &worker,
+      const PreCommitSector::Params &params,
+      const TokenAmount &deposit,
+      Callback callback) {
+    OUTCOME_TRY(encoded, codec::cbor::encode(params));
+    submit({miner,
+            worker,
+            PreCommitSector::Number,
+            MethodParams{encoded},
+            deposit,
+            config_.pre_commit_gas_limit},
+           std::move(callback));
+    return outcome::success();
+  }
+
+  outcome::result<void> CommitSubmitter::proveCommit(
+      const Address &miner,
+      const Address &worker,
+      const ProveCommitSector::Params &params,
+      const TokenAmount &collateral,
+      Callback callback) {
+    OUTCOME_TRY(encoded, codec::cbor::encode(params));
+    submit({miner,
+            worker,
+            ProveCommitSector::Number,
+            MethodParams{encoded},
+            collateral,
+            config_.prove_commit_gas_limit},
+           std::move(callback));
+    return outcome::success();
+  }
+
+  void CommitSubmitter::submit(Commit commit, Callback callback) {
+    auto worker{commit.worker};
+    std::unique_lock lock{mutex_};
+    auto &sender{senders_[worker]};
+    sender.queue.push_back({std::move(commit),
+                            std::move(callback),
+                            std::chrono::steady_clock::now()});
+    if (sender.queue.size() - sender.released >= config_.batch_size) {
+      release(sender);
+      lock.unlock();
+      return drain(worker);
+    }
+    arm(worker, sender);
+  }
+
+  void CommitSubmitter::flush() {
+    std::vector<Address> workers;
+    {
+      std::lock_guard lock{mutex_};
+      for (auto &[worker, sender] : senders_) {
+        if (!sender.queue.empty()) {
+          sender.released = sender.queue.size();
+          workers.push_back(worker);
+        }
+      }
+    }
+    for (auto &worker : workers) {
+      drain(worker);
+    }
+  }
+
+  size_t CommitSubmitter::queued() const {
+    std::lock_guard lock{mutex_};
+    size_t queued{};
+    for (auto &[_, sender] : senders_) {
+      queued += sender.queue.size();
+    }
+    return queued;
+  }
+
+  size_t CommitSubmitter::inFlight() const {
+    std::lock_guard lock{mutex_};
+    size_t in_flight{};
+    for (auto &[_, sender] : senders_) {
+      in_flight += sender.in_flight;
+    }
+    return in_flight;
+  }
+
+  CommitSubmitter::Slot::Slot(std::weak_ptr<CommitSubmitter> submitter,
+                              Address worker)
+      : submitter_{std::move(submitter)}, worker_{std::move(worker)} {}
+
+  CommitSubmitter::Slot::~Slot() {
+    free();
+  }
+
+  void CommitSubmitter::Slot::free() {
+    if (freed_.test_and_set()) {
+      return;
+    }
+    if (auto submitter{submitter_.lock()}) {
+      submitter->freeSlot(worker_);
+    }
+  }
+
+  void CommitSubmitter::release(Sender &sender) {
+    sender.released +=
+        std::min(config_.batch_size, sender.queue.size() - sender.released);
+  }
+
+  void CommitSubmitter::arm(const Address &worker, Sender &sender) {
+    if (sender.timer || sender.queue.size() == sender.released) {
+      return;
+    }
+    sender.timer = true;
+    // timer lives until it expires, batch may be pushed before
+    auto timer{std::make_shared<boost::asio::steady_timer>(*io_)};
+    timer->expires_at(sender.queue[sender.released].queued + config_.max_wait);
+    timer->async_wait([weak{weak_from_this()}, timer, worker](auto ec) {
+      if (ec) {
+        return;
+      }
+      if (auto self{weak.lock()}) {
+        self->onTimer(worker);
+      }
+    });
+  }
+
+  void CommitSubmitter::onTimer(const Address &worker) {
+    {
+      std::lock_guard lock{mutex_};
+      auto &sender{senders_[worker]};
+      sender.timer = false;
+      if (sender.queue.size() != sender.released
+          && sender.queue[sender.released].queued + config_.max_wait
+                 <= std::chrono::steady_clock::now()) {
+        release(sender);
+      }
+      // rest of queue waits for its oldest message
+      arm(worker, sender);
+    }
+    drain(worker);
+  }
+
+  void CommitSubmitter::drain(const Address &worker) {
+    std::unique_lock lock{mutex_};
+    auto &sender{senders_[worker]};
+    if (sender.pushing) {
+      return;
+    }
+    sender.pushing = true;
+    while (sender.released != 0 && sender.in_flight < config_.max_in_flight) {
+      // slots are taken before push, so included messages free them after
+      auto count{std::min(sender.released,
+                          config_.max_in_flight - sender.in_flight)};
+      std::vector<Pending> batch;
+      for (size_t i{0}; i < count; ++i) {
+        batch.push_back(std::move(sender.queue.front()));
+        sender.queue.pop_front();
+      }
+      sender.released -= count;
+      sender.in_flight += count;
+      lock.unlock();
+      TokenAmount gas_price{config_.gas_price};
+      auto estimated{api_->GasEstimateGasPrice(
+          config_.gas_blocks, worker, batch.front().commit.gas_limit, {})};
+      if (estimated) {
+        gas_price = std::move(estimated.value());
+      } else {
+        logger_->warn("gas price estimation failed: {}",
+                      estimated.error().message());
+      }
+      for (auto &pending : batch) {
+        push(std::move(pending),
+             gas_price,
+             std::make_shared<Slot>(weak_from_this(), worker));
+      }
+      lock.lock();
+    }
+    sender.pushing = false;
+  }
+
+  void CommitSubmitter::push(Pending pending,
+                             const TokenAmount &gas_price,
+                             std::shared_ptr<Slot> slot) {
+    auto &commit{pending.commit};
+    auto callback{std::move(pending.callback)};
+    auto signed_message{api_->MpoolPushMessage(UnsignedMessage{
+        commit.miner,
+        commit.worker,
+        0,
+        commit.value,
+        gas_price,
+        commit.gas_limit,
+        commit.method,
+        commit.params,
+    })};
+    if (!signed_message) {
+      logger_->error("push of method {} failed: {}",
+                     commit.method,
+                     signed_message.error().message());
+      callback(signed_message.error());
+      return slot->free();
+    }
+    auto wait{api_->StateWaitMsg(signed_message.value().getCid())};
+    if (!wait) {
+      callback(wait.error());
+      return slot->free();
+    }
+    // dropped callback frees slot with its last reference
+    wait.value().wait([callback, slot](auto result) {
+      callback(std::move(result));
+      slot->free();
+    });
+  }
+
+  void CommitSubmitter::freeSlot(const Address &worker) {
+    {
+      std::lock_guard lock{mutex_};
+      --senders_[worker].in_flight;
+    }
+    // messages waiting for slot are pushed at once
+    drain(worker);
+  }
+}  // namespace fc::mining
@@ -0,0 +1,159 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+
+#include <boost/asio/io_context.hpp>
+
+#include "api/api.hpp"
+#include "common/logger.hpp"
+#include "vm/actor/builtin/miner/miner_actor.hpp"
+
+namespace fc::mining {
+  using api::Address;
+  using api::Api;
+  using api::MsgWait;
+  using primitives::GasAmount;
+  using primitives::TokenAmount;
+  using vm::actor::MethodNumber;
+  using vm::actor::MethodParams;
+  using vm::actor::builtin::miner::PreCommitSector;
+  using vm::actor::builtin::miner::ProveCommitSector;
+
+  struct CommitSubmitterConfig {
+    /// Messages of worker pushed to mpool and not included yet
+    size_t max_in_flight{16};
+    /// Queued messages of worker are pushed when this many are queued
+    size_t batch_size{8};
+    /// or when first of them waited this long
+    std::chrono::milliseconds max_wait{std::chrono::seconds{30}};
+    /// Messages are priced to be included within this many blocks
+    uint64_t gas_blocks{10};
+    /// Gas price of batch when estimation fails
+    TokenAmount gas_price{vm::message::kDefaultGasPrice};
+    GasAmount pre_commit_gas_limit{vm::message::kDefaultGasLimit};
+    GasAmount prove_commit_gas_limit{vm::message::kDefaultGasLimit};
+  };
+
+  /**
+   * Submits PreCommitSector and ProveCommitSector messages of sealed
+   * sectors. Messages are queued per worker and pushed in batches of up to
+   * batch_size, one batch at a time per worker, so mpool assigns
+   * consecutive nonces without concurrent pushes racing for them. Messages
+   * of batch share estimated gas price. Up to max_in_flight messages of
+   * worker wait for inclusion at once, inclusion is awaited without
+   * blocking, and released batches are pushed as soon as included ones free
+   * their slots. Thread-safe.
+   */
+  class CommitSubmitter
+      : public std::enable_shared_from_this<CommitSubmitter> {
+   public:
+    /// Receives receipt of included message or error of push
+    using Callback = std::function<void(outcome::result<MsgWait>)>;
+
+    struct Commit {
+      Address miner;
+      Address worker;
+      MethodNumber method;
+      MethodParams params;
+      /// Deposit or collateral sent with message
+      TokenAmount value;
+      GasAmount gas_limit{};
+    };
+
+    CommitSubmitter(std::shared_ptr<Api> api,
+                    std::shared_ptr<boost::asio::io_context> io,
+                    CommitSubmitterConfig config);
+
+    outcome::result<void> preCommit(const Address &miner,
+                                    const Address &worker,
+                                    const PreCommitSector::Params &params,
+                                    const TokenAmount &deposit,
+                                    Callback callback);
+
+    outcome::result<void> proveCommit(const Address &miner,
+                                      const Address &worker,
+                                      const ProveCommitSector::Params &params,
+                                      const TokenAmount &collateral,
+                                      Callback callback);
+
+    /// Queues message, it is pushed with batch of its worker
+    void submit(Commit commit, Callback callback);
+
+    /// Releases all queued messages, pushes them while workers have slots
+    void flush();
+
+    /// Messages waiting for batch or slot
+    size_t queued() const;
+
+    /// Messages pushed and not included yet
+    size_t inFlight() const;
+
+   private:
+    struct Pending {
+      Commit commit;
+      Callback callback;
+      std::chrono::steady_clock::time_point queued;
+    };
+
+    struct Sender {
+      std::deque<Pending> queue;
+      /// Messages at front of queue in released batches, waiting for slots
+      size_t released{};
+      size_t in_flight{};
+      /// Thread pushing batch, other threads leave messages to it
+      bool pushing{};
+      /// Timer of oldest unreleased message is waiting
+      bool timer{};
+    };
+
+    /**
+     * In-flight slot of message, freed once when message completes or its
+     * wait callback is dropped without being called
+     */
+    class Slot {
+     public:
+      Slot(std::weak_ptr<CommitSubmitter> submitter, Address worker);
+      ~Slot();
+      void free();
+
+     private:
+      std::weak_ptr<CommitSubmitter> submitter_;
+      Address worker_;
+      std::atomic_flag freed_ = ATOMIC_FLAG_INIT;
+    };
+
+    /// Releases next batch of up to batch_size queued messages, under lock
+    void release(Sender &sender);
+
+    /// Waits until oldest unreleased message waited max_wait, under lock
+    void arm(const Address &worker, Sender &sender);
+
+    void onTimer(const Address &worker);
+
+    /// Pushes released messages of worker while it has free slots
+    void drain(const Address &worker);
+
+    /// Pushes message and waits for its inclusion
+    void push(Pending pending,
+              const TokenAmount &gas_price,
+              std::shared_ptr<Slot> slot);
+
+    /// Frees slot of message and pushes messages waiting for it
+    void freeSlot(const Address &worker);
+
+    std::shared_ptr<Api> api_;
+    std::shared_ptr<boost::asio::io_context> io_;
+    CommitSubmitterConfig config_;
+    mutable std::mutex mutex_;
+    std::map<Address, Sender> senders_;
+    common::Logger logger_;
+  };
+}  // namespace fc::mining
@@ -4,8 +4,8 @@
  */
 
 #include "miner/mining.hpp"
-#include "vm/actor/builtin/market/policy.hpp"
-#include "vm/runtime/pricelist.hpp"
+
+#include "primitives/address/address_codec.hpp"
 
 #define OUTCOME_LOG(tag, r)                               \
   {                                                       \
@@ -19,65 +19,235 @@
 namespace fc::mining {
   using api::DomainSeparationTag;
   using crypto::randomness::drawRandomness;
-  using BlsSignature = crypto::bls::Signature;
 
   std::shared_ptr<Mining> Mining::create(std::shared_ptr<io_context> io,
                                          std::shared_ptr<Api> api,
                                          std::shared_ptr<Prover> prover,
                                          const Address &miner) {
+    return create(io, api, prover, std::vector<Address>{miner});
+  }
+
+  std::shared_ptr<Mining> Mining::create(
+      std::shared_ptr<io_context> io,
+      std::shared_ptr<Api> api,
+      std::shared_ptr<Prover> prover,
+      std::vector<Address> miners,
+      std::shared_ptr<boost::asio::thread_pool> pool,
+      std::shared_ptr<TimerWheel> wheel) {
     auto mining{std::make_shared<Mining>()};
     mining->io = io;
-    mining->timer = std::make_unique<system_timer>(*io);
+    mining->wheel =
+        wheel ? std::move(wheel) : std::make_shared<TimerWheel>(io);
     mining->api = api;
     mining->prover = prover;
-    mining->miner = miner;
+    mining->miners = std::move(miners);
+    mining->pool = std::move(pool);
     return mining;
   }
 
   void Mining::start() {
+    auto chan{api->MpoolSub()};
+    if (chan) {
+      mpool_channel = std::move(chan.value().channel);
+      mpool_channel->read([weak{weak_from_this()}](auto update) {
+        auto self{weak.lock()};
+        if (!self || !update) {
+          return false;
+        }
+        // updates come from mpool thread, selection runs on io
+        boost::asio::post(*self->io, [self] {
+          if (!self->refresh_posted) {
+            self->refresh_posted = true;
+            boost::asio::post(*self->io, [self] { self->refreshMessages(); });
+          }
+        });
+        return true;
+      });
+    } else {
+      spdlog::warn("Mining::start MpoolSub: {}", chan.error().message());
+    }
     waitParent();
   }
 
+  void Mining::refreshMessages() {
+    refresh_posted = false;
+    selected.reset();
+    if (!ts) {
+      return;
+    }
+    auto ts_key{ts->makeKey()};
+    auto messages{selectMessages(api, *ts)};
+    if (!ts_key || !messages) {
+      spdlog::warn("Mining::refreshMessages: preselection failed");
+      return;
+    }
+    selected.emplace(std::move(ts_key.value()), std::move(messages.value()));
+  }
+
+  outcome::result<std::vector<SignedMessage>> Mining::parentMessages() {
+    OUTCOME_TRY(ts_key, ts->makeKey());
+    if (!selected || selected->first != ts_key) {
+      refreshMessages();
+    }
+    if (selected && selected->first == ts_key) {
+      return selected->second;
+    }
+    return selectMessages(api, *ts);
+  }
+
   void Mining::waitParent() {
     OUTCOME_LOG("Mining::waitParent error", bestParent());
-    timer->expires_at(system_timer::time_point{
-        std::chrono::seconds{ts->getMinTimestamp()} + kPropagationDelay});
-    asyncWait([self{shared_from_this()}]() {
+    // messages are selected while waiting for parent propagation
+    auto ts_key{ts->makeKey()};
+    if (ts_key && (!selected || selected->first != ts_key.value())) {
+      refreshMessages();
+    }
+    prewarm();
+    TimerWheel::Clock::time_point time{
+        std::chrono::seconds{ts->getMinTimestamp()} + kPropagationDelay};
+    asyncWait(time, [self{shared_from_this()}]() {
       OUTCOME_LOG("Mining::prepare error", self->prepare());
     });
   }
 
+  void Mining::prewarm() {
+    auto ts_key{ts->makeKey()};
+    if (!ts_key || mined.count({ts_key.value(), skip}) != 0) {
+      return;
+    }
+    std::pair round{std::move(ts_key.value()), skip};
+    if (prewarmed && prewarmed->round == round) {
+      return;
+    }
+    prewarmed = std::make_shared<Prewarmed>();
+    prewarmed->round = std::move(round);
+    prewarmed->winners.resize(miners.size());
+    auto height{ts->height + skip + 1};
+    for (size_t i{0}; i < miners.size(); ++i) {
+      auto task{[i,
+                 miner{miners[i]},
+                 ts{*ts},
+                 height,
+                 api{api},
+                 prover{prover},
+                 cache{prewarmed}] {
+        // challenge depends on beacon of height, not on parent
+        auto winner{checkWinner(miner, ts, height, api)};
+        {
+          std::lock_guard lock{cache->mutex};
+          cache->winners[i] = winner;
+        }
+        if (!winner || !winner.value()) {
+          return;
+        }
+        auto warmed{prover->prewarmWinningPoSt(
+            miner.getId(), winner.value()->info.sectors)};
+        if (!warmed) {
+          spdlog::warn("Mining::prewarm {}: {}",
+                       primitives::address::encodeToString(miner),
+                       warmed.error().message());
+        }
+      }};
+      if (pool) {
+        boost::asio::post(*pool, std::move(task));
+      } else {
+        boost::asio::post(*io, std::move(task));
+      }
+    }
+  }
+
   outcome::result<void> Mining::prepare() {
     OUTCOME_TRY(bestParent());
     OUTCOME_TRY(ts_key, ts->makeKey());
+    auto time{TimerWheel::Clock::now() + kBlockDelay};
     if (mined.emplace(ts_key, skip).second) {
-      OUTCOME_TRY(block1,
-                  prepareBlock(miner, *ts, ts->height + skip + 1, api, prover));
-      timer->expires_at(
-          system_timer::time_point{std::chrono::seconds{ts->getMinTimestamp()}
-                                   + (skip + 1) * kBlockDelay});
-      if (block1) {
-        OUTCOME_TRYA(block1->messages, selectMessages(api, *ts));
-        asyncWait([self{shared_from_this()}, block1{std::move(*block1)}]() {
-          OUTCOME_LOG("Mining::submit error", self->submit(std::move(block1)));
-        });
+      auto height{ts->height + skip + 1};
+      // cheap eligibility checks of all miners first, so winning PoSt is
+      // generated only for winners
+      std::vector<outcome::result<boost::optional<Winner>>> winners(
+          miners.size(), boost::none);
+      std::shared_ptr<Prewarmed> cache;
+      if (prewarmed && prewarmed->round == std::pair{ts_key, skip}) {
+        cache = std::move(prewarmed);
+      }
+      forEachMiner([&](size_t i) {
+        if (cache) {
+          std::lock_guard lock{cache->mutex};
+          if (cache->winners[i]) {
+            winners[i] = std::move(*cache->winners[i]);
+            return;
+          }
+        }
+        // prewarm of miner is not done yet
+        winners[i] = checkWinner(miners[i], *ts, height, api);
+      });
+      std::vector<boost::optional<outcome::result<BlockTemplate>>> proved(
+          miners.size());
+      forEachMiner([&](size_t i) {
+        if (winners[i] && winners[i].value()) {
+          proved[i] = proveWinner(
+              std::move(*winners[i].value()), *ts, height, api, prover);
+        }
+      });
+      std::vector<BlockTemplate> blocks;
+      for (size_t i{0}; i < miners.size(); ++i) {
+        // failure of one miner doesn't stop others
+        if (!winners[i]) {
+          spdlog::error("Mining::prepare {}: {}",
+                        primitives::address::encodeToString(miners[i]),
+                        winners[i].error().message());
+        } else if (proved[i] && !*proved[i]) {
+          spdlog::error("Mining::prepare {}: {}",
+                        primitives::address::encodeToString(miners[i]),
+                        proved[i]->error().message());
+        } else if (proved[i]) {
+          blocks.push_back(std::move(proved[i]->value()));
+        }
+      }
+      time = TimerWheel::Clock::time_point{
+          std::chrono::seconds{ts->getMinTimestamp()}
+          + (skip + 1) * kBlockDelay};
+      if (!blocks.empty()) {
+        asyncWait(time,
+                  [self{shared_from_this()}, blocks{std::move(blocks)}]() {
+                    OUTCOME_LOG("Mining::submit error",
+                                self->submit(std::move(blocks)));
+                  });
         return outcome::success();
       } else {
         ++skip;
       }
-    } else {
-      timer->expires_after(kBlockDelay);
     }
-    asyncWait([self{shared_from_this()}]() { self->waitParent(); });
+    asyncWait(time, [self{shared_from_this()}]() { self->waitParent(); });
     return outcome::success();
   }
 
-  outcome::result<void> Mining::submit(BlockTemplate block1) {
-    block1.timestamp = std::chrono::duration_cast<std::chrono::seconds>(
-                           std::chrono::system_clock::now().time_since_epoch())
-                           .count();
-    OUTCOME_TRY(block2, api->MinerCreateBlock(block1));
-    OUTCOME_TRY(api->SyncSubmitBlock(block2));
+  outcome::result<void> Mining::submit(std::vector<BlockTemplate> blocks) {
+    // latest preselected messages, so submit only signs blocks
+    auto messages{parentMessages()};
+    if (!messages) {
+      spdlog::error("Mining::submit messages: {}",
+                    messages.error().message());
+    } else {
+      auto timestamp{std::chrono::duration_cast<std::chrono::seconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count()};
+      for (auto &block1 : blocks) {
+        // failure of one miner doesn't stop others
+        block1.messages = messages.value();
+        block1.timestamp = timestamp;
+        auto submitted{[&]() -> outcome::result<void> {
+          OUTCOME_TRY(block2, api->MinerCreateBlock(block1));
+          return api->SyncSubmitBlock(block2);
+        }()};
+        if (!submitted) {
+          spdlog::error("Mining::submit {}: {}",
+                        primitives::address::encodeToString(block1.miner),
+                        submitted.error().message());
+        }
+      }
+    }
+    // next round is mined even if blocks of this one failed
     waitParent();
     return outcome::success();
   }
@@ -111,105 +281,101 @@ namespace fc::mining {
   }
 
   constexpr auto kTicketRandomnessLookback{1};
-  outcome::result<boost::optional<BlockTemplate>> prepareBlock(
+  outcome::result<BlsSignature> workerVrf(const std::shared_ptr<Api> &api,
+                                          const MiningBaseInfo &info,
+                                          DomainSeparationTag tag,
+                                          ChainEpoch height,
+                                          const Buffer &seed) {
+    OUTCOME_TRY(sig,
+                api->WalletSign(info.worker,
+                                Buffer{drawRandomness(
+                                    info.beacon().data, tag, height, seed)}));
+    return boost::get<BlsSignature>(sig);
+  }
+
+  outcome::result<boost::optional<Winner>> checkWinner(
       const Address &miner,
       const Tipset &ts,
       uint64_t height,
-      std::shared_ptr<Api> api,
-      std::shared_ptr<Prover> prover) {
+      std::shared_ptr<Api> api) {
     assert(height > ts.height);
     OUTCOME_TRY(ts_key, ts.makeKey());
     OUTCOME_TRY(info, api->MinerGetBaseInfo(miner, height, ts_key));
     if (info && info->miner_power > 0) {
-      auto vrf{[&](auto tag,
-                   auto height,
-                   auto &seed) -> outcome::result<BlsSignature> {
-        OUTCOME_TRY(
-            sig,
-            api->WalletSign(info->worker,
-                            Buffer{drawRandomness(
-                                info->beacon().data, tag, height, seed)}));
-        return boost::get<BlsSignature>(sig);
-      }};
       OUTCOME_TRY(miner_seed, codec::cbor::encode(miner));
       OUTCOME_TRY(election_vrf,
-                  vrf(DomainSeparationTag::ElectionProofProduction,
-                      height,
-                      miner_seed));
+                  workerVrf(api,
+                            *info,
+                            DomainSeparationTag::ElectionProofProduction,
+                            height,
+                            miner_seed));
       if (isTicketWinner(
               election_vrf, info->miner_power, info->network_power)) {
-        auto ticket_seed{miner_seed};
-        if (info->beacons.empty()) {
-          ticket_seed.put(ts.getMinTicketBlock().ticket->bytes);
-        }
-        OUTCOME_TRY(ticket_vrf,
-                    vrf(DomainSeparationTag::TicketProduction,
-                        height - kTicketRandomnessLookback,
-                        ticket_seed));
-        OUTCOME_TRY(
-            post_proof,
-            prover->generateWinningPoSt(
-                miner.getId(),
-                info->sectors,
-                drawRandomness(info->beacon().data,
-                               DomainSeparationTag::WinningPoStChallengeSeed,
-                               height,
-                               miner_seed)));
-        return BlockTemplate{
-            miner,
-            ts.cids,
-            primitives::block::Ticket{ticket_vrf},
-            primitives::block::ElectionProof{Buffer{election_vrf}},
-            std::move(info->beacons),
-            {},
-            height,
-            {},
-            std::move(post_proof),
-        };
+        return Winner{miner,
+                      std::move(*info),
+                      std::move(miner_seed),
+                      std::move(election_vrf)};
       }
     }
     return boost::none;
   }
 
-  constexpr auto kBlockMessageLimit{512};
-  constexpr auto kBlockGasLimit{100000000};
+  outcome::result<BlockTemplate> proveWinner(Winner winner,
+                                             const Tipset &ts,
+                                             uint64_t height,
+                                             std::shared_ptr<Api> api,
+                                             std::shared_ptr<Prover> prover) {
+    auto &info{winner.info};
+    auto ticket_seed{winner.miner_seed};
+    if (info.beacons.empty()) {
+      ticket_seed.put(ts.getMinTicketBlock().ticket->bytes);
+    }
+    OUTCOME_TRY(ticket_vrf,
+                workerVrf(api,
+                          info,
+                          DomainSeparationTag::TicketProduction,
+                          height - kTicketRandomnessLookback,
+                          ticket_seed));
+    OUTCOME_TRY(
+        post_proof,
+        prover->generateWinningPoSt(
+            winner.miner.getId(),
+            info.sectors,
+            drawRandomness(info.beacon().data,
+                           DomainSeparationTag::WinningPoStChallengeSeed,
+                           height,
+                           winner.miner_seed)));
+    return BlockTemplate{
+        winner.miner,
+        ts.cids,
+        primitives::block::Ticket{ticket_vrf},
+        primitives::block::ElectionProof{Buffer{winner.election_vrf}},
+        std::move(info.beacons),
+        {},
+        height,
+        {},
+        std::move(post_proof),
+    };
+  }
+
+  outcome::result<boost::optional<BlockTemplate>> prepareBlock(
+      const Address &miner,
+      const Tipset &ts,
+      uint64_t height,
+      std::shared_ptr<Api> api,
+      std::shared_ptr<Prover> prover) {
+    OUTCOME_TRY(winner, checkWinner(miner, ts, height, api));
+    if (winner) {
+      OUTCOME_TRY(block,
+                  proveWinner(std::move(*winner), ts, height, api, prover));
+      return std::move(block);
+    }
+    return boost::none;
+  }
+
   outcome::result<std::vector<SignedMessage>> selectMessages(
       std::shared_ptr<Api> api, const Tipset &ts) {
     OUTCOME_TRY(ts_key, ts.makeKey());
-    OUTCOME_TRY(messages1, api->MpoolPending(ts_key));
-    std::vector<SignedMessage> messages2;
-    vm::runtime::Pricelist pricelist;
-    std::map<Address, vm::actor::Actor> actors;
-    for (auto &_msg : messages1) {
-      auto &msg{_msg.message};
-      if (msg.version != vm::message::kMessageVersion
-          || msg.gasLimit > kBlockGasLimit || msg.value < 0
-          || msg.value > vm::actor::builtin::market::kTotalFilecoin
-          || msg.gasPrice < 0) {
-        continue;
-      }
-      OUTCOME_TRY(message_bytes,
-                  _msg.signature.isBls() ? codec::cbor::encode(msg)
-                                         : codec::cbor::encode(_msg));
-      if (msg.gasLimit < pricelist.onChainMessage(message_bytes.size())) {
-        continue;
-      }
-      auto _actor{actors.find(msg.from)};
-      if (_actor == actors.end()) {
-        OUTCOME_TRY(actor, api->StateGetActor(msg.from, ts_key));
-        _actor = actors.emplace(msg.from, std::move(actor)).first;
-      }
-      auto &actor{_actor->second};
-      if (msg.nonce != actor.nonce || actor.balance < msg.requiredFunds()) {
-        continue;
-      }
-      actor.balance -= msg.requiredFunds();
-      ++actor.nonce;
-      messages2.push_back(std::move(_msg));
-      if (messages2.size() > kBlockMessageLimit) {
-        break;
-      }
-    }
-    return messages2;
+    return api->MpoolSelect(ts_key);
   }
 }  // namespace fc::mining
@@ -6,11 +6,15 @@
 #pragma once
 
 #include <boost/asio/io_context.hpp>
-#include <boost/asio/system_timer.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/functional/hash.hpp>
+#include <condition_variable>
+#include <mutex>
 #include <unordered_set>
 
 #include "api/api.hpp"
+#include "clock/timer_wheel.hpp"
 #include "sector_storage/spec_interfaces/prover.hpp"
 
 namespace fc::mining {
@@ -18,12 +22,17 @@ namespace fc::mining {
   using api::Api;
   using api::BigInt;
   using api::BlockTemplate;
+  using api::Buffer;
+  using api::ChainEpoch;
+  using api::MiningBaseInfo;
+  using api::MpoolUpdate;
   using api::SignedMessage;
   using api::Tipset;
   using api::TipsetKey;
   using boost::asio::io_context;
-  using boost::asio::system_timer;
+  using clock::TimerWheel;
   using sector_storage::Prover;
+  using BlsSignature = crypto::bls::Signature;
 
   struct pair_hash {
     template <class T1, class T2>
@@ -32,6 +41,14 @@ namespace fc::mining {
     }
   };
 
+  /// Eligible miner, which has election proof but no block yet
+  struct Winner {
+    Address miner;
+    MiningBaseInfo info;
+    Buffer miner_seed;
+    BlsSignature election_vrf;
+  };
+
   struct Mining : std::enable_shared_from_this<Mining> {
     static constexpr std::chrono::seconds kBlockDelay{25};
     static constexpr std::chrono::seconds kPropagationDelay{6};
@@ -39,34 +56,116 @@ namespace fc::mining {
                                           std::shared_ptr<Api> api,
                                           std::shared_ptr<Prover> prover,
                                           const Address &miner);
+    /**
+     * Mines with several miner actors sharing head tracking and message
+     * selection
+     * @param pool - runs eligibility checks and winning PoSt of miners in
+     * parallel, miners are processed one by one without it
+     * @param wheel - shared timer wheel, own one is created without it
+     */
+    static std::shared_ptr<Mining> create(
+        std::shared_ptr<io_context> io,
+        std::shared_ptr<Api> api,
+        std::shared_ptr<Prover> prover,
+        std::vector<Address> miners,
+        std::shared_ptr<boost::asio::thread_pool> pool = nullptr,
+        std::shared_ptr<TimerWheel> wheel = nullptr);
+    /// Subscribes to mpool updates and starts mining
     void start();
     void waitParent();
+    /**
+     * Selects messages for current parent ahead of block production, called
+     * on head change and posted once for burst of mpool updates
+     */
+    void refreshMessages();
+    /// Preselected messages of parent, selects them if there are none
+    outcome::result<std::vector<SignedMessage>> parentMessages();
+    /**
+     * Prefetches files of sectors challenged at next height into page cache
+     * for winners, while parent propagates, so winning PoSt doesn't wait for
+     * storage. Runs on pool or posted to io, once per parent and skip.
+     */
+    void prewarm();
     outcome::result<void> prepare();
-    outcome::result<void> submit(BlockTemplate block1);
+    outcome::result<void> submit(std::vector<BlockTemplate> blocks);
     outcome::result<void> bestParent();
+    /// Calls f(i) for each miner index, in parallel when there is pool
     template <typename F>
-    void asyncWait(F f) {
-      timer->async_wait([f{std::move(f)}](auto ec) {
-        if (!ec) {
-          f();
+    void forEachMiner(const F &f) {
+      if (!pool) {
+        for (size_t i{0}; i < miners.size(); ++i) {
+          f(i);
         }
-      });
+        return;
+      }
+      std::mutex mutex;
+      std::condition_variable done;
+      auto pending{miners.size()};
+      for (size_t i{0}; i < miners.size(); ++i) {
+        boost::asio::post(*pool, [&, i] {
+          f(i);
+          std::lock_guard lock{mutex};
+          if (--pending == 0) {
+            done.notify_one();
+          }
+        });
+      }
+      std::unique_lock lock{mutex};
+      done.wait(lock, [&] { return pending == 0; });
+    }
+    /// Calls f on io at time, replacing previous wait
+    template <typename F>
+    void asyncWait(TimerWheel::Clock::time_point time, F f) {
+      if (wait) {
+        wait->cancel();
+      }
+      wait = wheel->at(time, std::move(f));
     }
     std::shared_ptr<io_context> io;
-    std::unique_ptr<system_timer> timer;
+    std::shared_ptr<TimerWheel> wheel;
+    TimerWheel::TimerPtr wait;
     std::shared_ptr<Api> api;
     std::shared_ptr<Prover> prover;
-    Address miner;
+    std::vector<Address> miners;
+    std::shared_ptr<boost::asio::thread_pool> pool;
     boost::optional<Tipset> ts;
     BigInt weight;
     size_t skip{};
     std::unordered_set<std::pair<TipsetKey, size_t>, pair_hash> mined;
+    std::shared_ptr<api::Channel<MpoolUpdate>> mpool_channel;
+    /// Messages selected for parent, cleared when mpool or parent changes
+    boost::optional<std::pair<TipsetKey, std::vector<SignedMessage>>>
+        selected;
+    bool refresh_posted{};
+    /// Eligibility checks of prewarm, reused by prepare of same round
+    struct Prewarmed {
+      std::pair<TipsetKey, size_t> round;
+      std::mutex mutex;
+      /// Result of miner, none until its check is done
+      std::vector<boost::optional<outcome::result<boost::optional<Winner>>>>
+          winners;
+    };
+    std::shared_ptr<Prewarmed> prewarmed;
   };
 
   bool isTicketWinner(BytesIn ticket,
                       const BigInt &power,
                       const BigInt &total_power);
 
+  /// Reads base info of miner and checks election proof
+  outcome::result<boost::optional<Winner>> checkWinner(
+      const Address &miner,
+      const Tipset &ts,
+      uint64_t height,
+      std::shared_ptr<Api> api);
+
+  /// Computes ticket and winning PoSt of eligible miner
+  outcome::result<BlockTemplate> proveWinner(Winner winner,
+                                             const Tipset &ts,
+                                             uint64_t height,
+                                             std::shared_ptr<Api> api,
+                                             std::shared_ptr<Prover> prover);
+
   outcome::result<boost::optional<BlockTemplate>> prepareBlock(
       const Address &miner,
       const Tipset &ts,
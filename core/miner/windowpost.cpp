@@ -4,7 +4,12 @@
  */
 
 #include "miner/windowpost.hpp"
+
+#include <deque>
+#include <future>
+
 #include "vm/actor/builtin/miner/miner_actor.hpp"
+#include "vm/actor/builtin/miner/policy.hpp"
 
 namespace fc {
   inline constexpr auto kValue{1000};
@@ -58,20 +63,7 @@ namespace fc {
       auto parts{deadlines.count(part_size, deadline.index).first};
       if (parts != 0) {
         using vm::actor::builtin::miner::SubmitWindowedPoSt;
-        SubmitWindowedPoSt::Params params;
-        auto first_part{deadlines.partitions(part_size, deadline.index).first};
-        for (auto i{0u}; i < parts; ++i) {
-          params.partitions.push_back(first_part + i);
-        }
-        OUTCOME_TRY(sectors1,
-                    api->StateMinerSectors(
-                        miner, deadlines.due[deadline.index], false, ts_key));
-        std::vector<api::SectorInfo> sectors2;
-        for (auto &sector : sectors1) {
-          sectors2.push_back({sector.info.info.registered_proof,
-                              sector.id,
-                              sector.info.info.sealed_cid});
-        }
+        using vm::actor::builtin::miner::windowPoStMessagePartitionsMax;
         OUTCOME_TRY(seed, codec::cbor::encode(miner));
         OUTCOME_TRY(rand,
                     api->ChainGetRandomness(
@@ -79,20 +71,79 @@ namespace fc {
                         api::DomainSeparationTag::WindowedPoStChallengeSeed,
                         deadline.challenge,
                         seed));
-        OUTCOME_TRY(proof,
-                    prover->generateWindowPoSt(miner.getId(), sectors2, rand));
-        params.proofs = std::move(proof.proof);
-        OUTCOME_TRY(api->MpoolPushMessage({
-            miner,
-            worker,
-            0,
-            kValue,
-            kGasPrice,
-            kGasLimit,
-            SubmitWindowedPoSt::Number,
-            codec::cbor::encode(params).value(),
-        }));
-        // TODO: should wait result and retry?
+        auto [first_part, sectors]{
+            deadlines.partitions(part_size, deadline.index)};
+        auto batch_parts{std::max<uint64_t>(
+            1,
+            std::min<uint64_t>(parts_per_message,
+                               windowPoStMessagePartitionsMax(part_size)))};
+
+        struct Batch {
+          SubmitWindowedPoSt::Params params;
+          std::future<outcome::result<Prover::WindowPoStResponse>> proof;
+        };
+        std::deque<Batch> proving;
+        auto submit{[&](Batch &batch) -> outcome::result<void> {
+          OUTCOME_TRY(proof, batch.proof.get());
+          batch.params.proofs = std::move(proof.proof);
+          for (auto &sector : proof.skipped) {
+            batch.params.skipped.insert(sector.sector);
+          }
+          OUTCOME_TRY(api->MpoolPushMessage({
+              miner,
+              worker,
+              0,
+              kValue,
+              kGasPrice,
+              kGasLimit,
+              SubmitWindowedPoSt::Number,
+              codec::cbor::encode(batch.params).value(),
+          }));
+          // TODO: should wait result and retry?
+          return outcome::success();
+        }};
+
+        // sectors of next batch are loaded while previous batches are proved
+        auto sector{deadlines.due[deadline.index].begin()};
+        for (uint64_t part{0}; part < parts; part += batch_parts) {
+          Batch batch;
+          batch.params.deadline = deadline.index;
+          auto end_part{std::min<uint64_t>(parts, part + batch_parts)};
+          for (auto i{part}; i < end_part; ++i) {
+            batch.params.partitions.push_back(first_part + i);
+          }
+          api::RleBitset batch_sectors;
+          auto end{sector};
+          std::advance(end,
+                       std::min<uint64_t>((end_part - part) * part_size,
+                                          sectors - part * part_size));
+          batch_sectors.insert(sector, end);
+          sector = end;
+
+          OUTCOME_TRY(sectors1,
+                      api->StateMinerSectors(
+                          miner, batch_sectors, false, ts_key));
+          std::vector<api::SectorInfo> sectors2;
+          for (auto &sector1 : sectors1) {
+            sectors2.push_back({sector1.info.info.registered_proof,
+                                sector1.id,
+                                sector1.info.info.sealed_cid});
+          }
+          batch.proof = std::async(
+              std::launch::async,
+              [prover{prover}, id{miner.getId()}, sectors2, rand] {
+                return prover->generateWindowPoSt(id, sectors2, rand);
+              });
+          proving.push_back(std::move(batch));
+
+          if (proving.size() >= std::max<size_t>(1, parallel_proofs)) {
+            OUTCOME_TRY(submit(proving.front()));
+            proving.pop_front();
+          }
+        }
+        for (; !proving.empty(); proving.pop_front()) {
+          OUTCOME_TRY(submit(proving.front()));
+        }
       }
     }
     return outcome::success();
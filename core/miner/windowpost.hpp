@@ -15,10 +15,17 @@ namespace fc {
   using api::Tipset;
   using sector_storage::Prover;
 
-  // synchronous WindowPoSt
+  /**
+   * Synchronous WindowPoSt.
+   * Partitions of deadline are split into messages, proofs of several
+   * messages are generated concurrently, so they may run on different
+   * workers, while sectors of next message are loaded.
+   */
   struct WindowPoStScheduler
       : public std::enable_shared_from_this<WindowPoStScheduler> {
     static constexpr auto kStartConfidence{4};
+    static constexpr uint64_t kPartitionsPerMessage{4};
+    static constexpr size_t kParallelProofs{2};
 
     outcome::result<std::shared_ptr<WindowPoStScheduler>> create(
         std::shared_ptr<Api> api,
@@ -32,5 +39,9 @@ namespace fc {
     Address miner, worker;
     boost::optional<DeadlineInfo> last_deadline;
     uint64_t part_size;
+    /// Max count of partitions proved by one message
+    uint64_t parts_per_message{kPartitionsPerMessage};
+    /// Max count of messages proved at once
+    size_t parallel_proofs{kParallelProofs};
   };
 }  // namespace fc
@@ -6,7 +6,10 @@
 #include <libp2p/host/host.hpp>
 
 #include "common/libp2p/cbor_stream.hpp"
+#include "metrics/tracing.hpp"
 #include "node/blocksync.hpp"
+#include "node/peermgr.hpp"
+#include "primitives/cid/cbor_cached.hpp"
 #include "primitives/tipset/tipset.hpp"
 
 #define MOVE(x)  \
@@ -24,9 +27,9 @@ namespace fc::blocksync {
   using primitives::block::MsgMeta;
   using primitives::block::SignedMessage;
   using primitives::block::UnsignedMessage;
+  using primitives::cid::CborCached;
 
   static constexpr auto kProtocolId{"/fil/sync/blk/0.0.1"};
-  constexpr size_t kBlockSyncMaxRequestLength{800};
 
   struct Request {
     enum Options {
@@ -45,10 +48,10 @@ namespace fc::blocksync {
     struct Tipset {
       using Indices = std::vector<std::vector<size_t>>;
 
-      std::vector<BlockHeader> blocks;
-      std::vector<UnsignedMessage> bls_messages;
+      std::vector<CborCached<BlockHeader>> blocks;
+      std::vector<CborCached<UnsignedMessage>> bls_messages;
       Indices bls_indices;
-      std::vector<SignedMessage> secp_messages;
+      std::vector<CborCached<SignedMessage>> secp_messages;
       Indices secp_indices;
     };
 
@@ -64,9 +67,12 @@ namespace fc::blocksync {
              secp_messages,
              secp_indices)
 
-  outcome::result<Tipset> unpack(const IpldPtr &ipld, Response::Tipset packed) {
+  /// Stores messages of blocks and checks them against block headers
+  outcome::result<void> unpackMessages(const IpldPtr &ipld,
+                                       Response::Tipset &packed,
+                                       const std::vector<BlockHeader> &blocks) {
     auto safe{[&](auto &messages, auto &indices) {
-      if (indices.size() != packed.blocks.size()) {
+      if (indices.size() != blocks.size()) {
         return false;
       }
       for (auto &indices2 : indices) {
@@ -82,83 +88,242 @@ namespace fc::blocksync {
         || !safe(packed.secp_messages, packed.secp_indices)) {
       return Error::kInconsistent;
     }
-    std::vector<BlockHeader> blocks;
-    for (auto &block : packed.blocks) {
-      OUTCOME_TRY(ipld->setCbor(block));
-      blocks.push_back(std::move(block));
-    }
-    std::vector<CID> bls_cids, secp_cids;
-    for (auto &message : packed.bls_messages) {
-      OUTCOME_TRY(cid, ipld->setCbor(message));
-      bls_cids.push_back(std::move(cid));
-    }
-    for (auto &message : packed.secp_messages) {
-      OUTCOME_TRY(cid, ipld->setCbor(message));
-      secp_cids.push_back(std::move(cid));
-    }
+    Ipld::Batch batch;
+    // received bytes are stored, messages are not encoded again
+    auto add{[&](auto &messages) {
+      std::vector<Ipld::Value> values;
+      values.reserve(messages.size());
+      for (auto &message : messages) {
+        values.push_back(std::move(message.bytes));
+      }
+      return Ipld::addMany(batch, std::move(values));
+    }};
+    OUTCOME_TRY(bls_cids, add(packed.bls_messages));
+    OUTCOME_TRY(secp_cids, add(packed.secp_messages));
+    OUTCOME_TRY(ipld->setMany(std::move(batch)));
     auto i{0};
     for (auto &block : blocks) {
       MsgMeta messages;
       ipld->load(messages);
+      std::vector<CID> block_bls, block_secp;
       for (auto &j : packed.bls_indices[i]) {
-        OUTCOME_TRY(messages.bls_messages.append(bls_cids[j]));
+        block_bls.push_back(bls_cids[j]);
       }
       for (auto &j : packed.secp_indices[i]) {
-        OUTCOME_TRY(messages.secp_messages.append(secp_cids[j]));
+        block_secp.push_back(secp_cids[j]);
       }
+      OUTCOME_TRY(messages.bls_messages.assign(block_bls));
+      OUTCOME_TRY(messages.secp_messages.assign(block_secp));
       OUTCOME_TRY(cid, ipld->setCbor(messages));
       if (cid != block.messages) {
         return Error::kInconsistent;
       }
       ++i;
     }
-    return Tipset::create(blocks);
+    return outcome::success();
   }
 
-  void fetch(std::shared_ptr<Host> host,
-             const PeerInfo &peer,
-             IpldPtr ipld,
-             std::vector<CID> blocks,
-             Cb cb) {
+  /// Stores headers of tipset
+  outcome::result<Tipset> unpackHeaders(const IpldPtr &ipld,
+                                        Response::Tipset &packed) {
+    std::vector<BlockHeader> blocks;
+    std::vector<CID> cids;
+    for (auto &block : packed.blocks) {
+      OUTCOME_TRY(cid, block.cid());
+      OUTCOME_TRY(ipld->set(cid, std::move(block.bytes)));
+      blocks.push_back(std::move(block.value));
+      cids.push_back(std::move(cid));
+    }
+    return Tipset::create(std::move(blocks), std::move(cids));
+  }
+
+  outcome::result<Tipset> unpack(const IpldPtr &ipld, Response::Tipset packed) {
+    OUTCOME_TRY(ts, unpackHeaders(ipld, packed));
+    OUTCOME_TRY(unpackMessages(ipld, packed, ts.blks));
+    return std::move(ts);
+  }
+
+  /// Encoded size of headers and messages in response
+  size_t responseBytes(const Response &response) {
+    size_t bytes{0};
+    auto add{[&](auto &values) {
+      for (auto &value : values) {
+        bytes += value.bytes.size();
+      }
+    }};
+    for (auto &packed : response.chain) {
+      add(packed.blocks);
+      add(packed.bls_messages);
+      add(packed.secp_messages);
+    }
+    return bytes;
+  }
+
+  /// Sends request and reads response with ok or partial status
+  void request(std::shared_ptr<Host> host,
+               const PeerInfo &peer,
+               Request request,
+               std::function<void(outcome::result<Response>)> _cb,
+               std::shared_ptr<PeerScores> scores) {
+    metrics::tracing::Span span{"blocksync",
+                                request.options == Request::BLOCKS
+                                    ? "headers"
+                                    : request.options == Request::MESSAGES
+                                          ? "messages"
+                                          : "blocks"};
+    if (span) {
+      span.arg(peer.id.toBase58() + " depth "
+               + std::to_string(request.depth));
+    }
+    auto cb{[MOVE(_cb),
+             MOVE(scores),
+             MOVE(span),
+             id{peer.id},
+             start{peermgr::Clock::now()}](
+                outcome::result<Response> _response) {
+      span.end();
+      if (scores) {
+        if (_response) {
+          scores->onResponse(id,
+                             peermgr::Clock::now() - start,
+                             responseBytes(_response.value()));
+        } else {
+          scores->onFailure(id);
+        }
+      }
+      _cb(std::move(_response));
+    }};
     host->newStream(
-        peer, kProtocolId, [MOVE(ipld), MOVE(blocks), MOVE(cb)](auto _stream) {
+        peer, kProtocolId, [MOVE(request), MOVE(cb)](auto _stream) {
           if (!_stream) {
             return cb(_stream.error());
           }
           auto stream{std::make_shared<CborStream>(_stream.value())};
-          stream->write(
-              Request{std::move(blocks)},
-              [stream, MOVE(ipld), MOVE(cb)](auto _n) {
-                if (!_n) {
+          stream->write(request, [stream, MOVE(cb)](auto _n) {
+            if (!_n) {
+              stream->close();
+              return cb(_n.error());
+            }
+            stream->template read<Response>(
+                [stream, MOVE(cb)](auto _response) {
                   stream->close();
-                  return cb(_n.error());
-                }
-                stream->template read<Response>(
-                    [stream, MOVE(ipld), MOVE(cb)](auto _response) {
-                      stream->close();
-                      if (!_response) {
-                        return cb(_response.error());
-                      }
-                      auto &response{_response.value()};
-                      if (response.status != Error::kOk) {
-                        return cb(response.status);
-                      }
-                      if (response.chain.empty()) {
-                        return cb(Error::kPartial);
-                      }
-                      cb(unpack(ipld, std::move(response.chain.front())));
-                    });
-              });
+                  if (!_response) {
+                    return cb(_response.error());
+                  }
+                  auto &response{_response.value()};
+                  if (response.status != Error::kOk
+                      && response.status != Error::kPartial) {
+                    return cb(response.status);
+                  }
+                  if (response.chain.empty()) {
+                    return cb(Error::kPartial);
+                  }
+                  cb(std::move(response));
+                });
+          });
         });
   }
 
+  void fetch(std::shared_ptr<Host> host,
+             const PeerInfo &peer,
+             IpldPtr ipld,
+             std::vector<CID> blocks,
+             Cb cb,
+             std::shared_ptr<PeerScores> scores) {
+    request(
+        host,
+        peer,
+        {std::move(blocks)},
+        [MOVE(ipld), MOVE(cb)](auto _response) {
+          if (!_response) {
+            return cb(_response.error());
+          }
+          cb(unpack(ipld, std::move(_response.value().chain.front())));
+        },
+        std::move(scores));
+  }
+
+  void fetchHeaders(std::shared_ptr<Host> host,
+                    const PeerInfo &peer,
+                    IpldPtr ipld,
+                    std::vector<CID> blocks,
+                    size_t depth,
+                    RangeCb cb,
+                    std::shared_ptr<PeerScores> scores) {
+    depth = std::min(depth, kBlockSyncMaxRequestLength);
+    Request headers{blocks, depth, Request::BLOCKS};
+    request(host,
+            peer,
+            std::move(headers),
+            [MOVE(ipld), MOVE(blocks), depth, MOVE(cb)](auto _response) {
+              if (!_response) {
+                return cb(_response.error());
+              }
+              auto &response{_response.value()};
+              if (response.chain.size() > depth) {
+                return cb(Error::kInconsistent);
+              }
+              std::vector<Tipset> chain;
+              for (auto &packed : response.chain) {
+                auto _ts{unpackHeaders(ipld, packed)};
+                if (!_ts) {
+                  return cb(_ts.error());
+                }
+                auto expected{chain.empty() ? blocks
+                                            : chain.back().getParents().cids};
+                if (_ts.value().cids != expected) {
+                  return cb(Error::kInconsistent);
+                }
+                chain.push_back(std::move(_ts.value()));
+              }
+              cb(std::move(chain));
+            },
+            std::move(scores));
+  }
+
+  void fetchMessages(std::shared_ptr<Host> host,
+                     const PeerInfo &peer,
+                     IpldPtr ipld,
+                     std::vector<Tipset> chain,
+                     RangeCb cb,
+                     std::shared_ptr<PeerScores> scores) {
+    if (chain.empty()) {
+      return cb(std::move(chain));
+    }
+    chain.resize(std::min(chain.size(), kBlockSyncMaxRequestLength));
+    auto blocks{chain.front().cids};
+    request(host,
+            peer,
+            {std::move(blocks), chain.size(), Request::MESSAGES},
+            [MOVE(ipld), MOVE(chain), MOVE(cb)](auto _response) mutable {
+              if (!_response) {
+                return cb(_response.error());
+              }
+              auto &response{_response.value()};
+              if (response.chain.size() > chain.size()) {
+                return cb(Error::kInconsistent);
+              }
+              for (size_t i{0}; i < response.chain.size(); ++i) {
+                auto _unpacked{
+                    unpackMessages(ipld, response.chain[i], chain[i].blks)};
+                if (!_unpacked) {
+                  return cb(_unpacked.error());
+                }
+              }
+              chain.resize(response.chain.size());
+              cb(std::move(chain));
+            },
+            std::move(scores));
+  }
+
   template <typename T>
   struct MessageVisitor {
     outcome::result<void> operator()(size_t, const CID &cid) {
       auto index{visited.find(cid)};
       if (index == visited.end()) {
         index = visited.emplace(cid, messages.size()).first;
-        OUTCOME_TRY(message, ipld->getCbor<T>(cid));
+        OUTCOME_TRY(bytes, ipld->get(cid));
+        OUTCOME_TRY(message, CborCached<T>::decode(std::move(bytes)));
         messages.push_back(std::move(message));
       }
       indices.rbegin()->push_back(index->second);
@@ -166,7 +331,7 @@ namespace fc::blocksync {
     }
 
     IpldPtr &ipld;
-    std::vector<T> &messages;
+    std::vector<CborCached<T>> &messages;
     Response::Tipset::Indices &indices;
     std::map<CID, size_t> visited{};
   };
@@ -191,7 +356,10 @@ namespace fc::blocksync {
         }
       }
       if (request.options & Request::BLOCKS) {
-        packed.blocks = ts.blks;
+        for (auto &block : ts.blks) {
+          OUTCOME_TRY(cached, CborCached<BlockHeader>::make(block));
+          packed.blocks.push_back(std::move(cached));
+        }
       }
       chain.push_back(std::move(packed));
       if (chain.size() >= request.depth || ts.height == 0) {
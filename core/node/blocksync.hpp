@@ -10,6 +10,7 @@
 namespace fc::blocksync {
   using libp2p::Host;
   using libp2p::peer::PeerInfo;
+  using peermgr::PeerScores;
   using primitives::tipset::Tipset;
 
   enum class Error {
@@ -22,13 +23,44 @@ namespace fc::blocksync {
     kBadRequest = 204,
   };
 
-  // TODO: depth/count
+  /// Max tipsets returned by one request
+  constexpr size_t kBlockSyncMaxRequestLength{800};
+
   using Cb = std::function<void(outcome::result<Tipset>)>;
+  /// Requests below record response time and size of peer to scores, if set
   void fetch(std::shared_ptr<Host> host,
              const PeerInfo &peer,
              IpldPtr ipld,
              std::vector<CID> blocks,
-             Cb cb);
+             Cb cb,
+             std::shared_ptr<PeerScores> scores = nullptr);
+
+  /// Fetched tipsets, requested first, followed by its parents
+  using RangeCb = std::function<void(outcome::result<std::vector<Tipset>>)>;
+
+  /**
+   * Fetches and stores headers of up to depth tipsets, without messages.
+   * Returned chain may be shorter than requested.
+   */
+  void fetchHeaders(std::shared_ptr<Host> host,
+                    const PeerInfo &peer,
+                    IpldPtr ipld,
+                    std::vector<CID> blocks,
+                    size_t depth,
+                    RangeCb cb,
+                    std::shared_ptr<PeerScores> scores = nullptr);
+
+  /**
+   * Fetches and stores messages of consecutive tipsets with known headers.
+   * @param chain - tipsets, each followed by its parent
+   * @param cb - receives prefix of chain with messages stored
+   */
+  void fetchMessages(std::shared_ptr<Host> host,
+                     const PeerInfo &peer,
+                     IpldPtr ipld,
+                     std::vector<Tipset> chain,
+                     RangeCb cb,
+                     std::shared_ptr<PeerScores> scores = nullptr);
 
   void serve(std::shared_ptr<Host> host, IpldPtr ipld);
 }  // namespace fc::blocksync
@@ -0,0 +1,30 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "node/chain_gc.hpp"
+
+namespace fc::gc {
+  outcome::result<void> collectChain(GenerationalIpld &ipld,
+                                     const Tipset &head,
+                                     size_t state_epochs) {
+    std::vector<CID> dags, blocks;
+    auto ts{head};
+    for (size_t i{0};; ++i) {
+      for (auto &block : ts.blks) {
+        if (i < state_epochs) {
+          dags.push_back(block.messages);
+          dags.push_back(block.parent_message_receipts);
+          dags.push_back(block.parent_state_root);
+        }
+      }
+      blocks.insert(blocks.end(), ts.cids.begin(), ts.cids.end());
+      if (ts.height == 0) {
+        break;
+      }
+      OUTCOME_TRYA(ts, ts.loadParent(ipld));
+    }
+    return ipld.collect(dags, blocks);
+  }
+}  // namespace fc::gc
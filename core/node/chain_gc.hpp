@@ -0,0 +1,24 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "primitives/tipset/tipset.hpp"
+#include "storage/ipfs/impl/generational_ipld.hpp"
+
+namespace fc::gc {
+  using primitives::tipset::Tipset;
+  using storage::ipfs::GenerationalIpld;
+
+  /**
+   * Collects garbage of chain store. Headers of chain down to genesis are
+   * kept, messages, receipts and states are kept for state_epochs tipsets
+   * below head. Side chains and intermediate states are dropped with oldest
+   * generation. Blocking, so it should run in background.
+   */
+  outcome::result<void> collectChain(GenerationalIpld &ipld,
+                                     const Tipset &head,
+                                     size_t state_epochs);
+}  // namespace fc::gc
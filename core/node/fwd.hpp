@@ -25,10 +25,18 @@ namespace libp2p {
 namespace fc {
   class CID;
 
+  namespace crypto::bls {
+    class BlsProvider;
+  }  // namespace crypto::bls
+
   namespace hello {
     struct Hello;
   }  // namespace hello
 
+  namespace peermgr {
+    struct PeerScores;
+  }  // namespace peermgr
+
   namespace primitives {
     namespace block {
       struct BlockWithCids;
@@ -46,12 +54,28 @@ namespace fc {
 
     namespace ipfs {
       class IpfsDatastore;
-    }  // namespace ipfs
+
+      namespace graphsync {
+        class Graphsync;
+      }  // namespace graphsync
+    }    // namespace ipfs
+
+    namespace mpool {
+      struct Mpool;
+    }  // namespace mpool
   }    // namespace storage
 
+  namespace sync {
+    struct Sync;
+  }  // namespace sync
+
   namespace vm::interpreter {
     class Interpreter;
   }  // namespace vm::interpreter
+
+  namespace vm::message {
+    class SecpVerifier;
+  }  // namespace vm::message
 }  // namespace fc
 
 namespace fc {
@@ -0,0 +1,224 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "node/gossip.hpp"
+
+#include <algorithm>
+#include <boost/asio/post.hpp>
+
+#include "common/libp2p/cbor_buffering.hpp"
+#include "node/sync.hpp"
+#include "primitives/block/block.hpp"
+#include "storage/mpool/mpool.hpp"
+
+namespace fc::gossip {
+  using common::libp2p::CborBuffering;
+  using primitives::block::BlockWithCids;
+  using vm::message::SignedMessage;
+
+  /// Number of fields of BlockWithCids and SignedMessage tuples
+  constexpr size_t kBlockFields{3};
+  constexpr size_t kMessageFields{2};
+
+  bool isCborTuple(BytesIn bytes, size_t length) {
+    if (bytes.empty()) {
+      return false;
+    }
+    size_t more{};
+    auto head{CborBuffering::Head::first(more, bytes[0])};
+    if (!head || head.value().type != CborBuffering::Type::Array || more != 0
+        || head.value().value != length) {
+      return false;
+    }
+    CborBuffering buffering;
+    buffering.reset();
+    auto consumed{buffering.consume(bytes)};
+    return consumed && consumed.value() == static_cast<size_t>(bytes.size())
+           && buffering.done();
+  }
+
+  SeenCache::SeenCache(Clock::duration ttl, size_t max_size)
+      : ttl{ttl}, max_size{max_size} {}
+
+  bool SeenCache::insert(const CID &cid, Clock::time_point now) {
+    while (!order.empty()
+           && (order.front().first + ttl <= now || order.size() >= max_size)) {
+      auto it{seen.find(order.front().second)};
+      // cid seen again after expiry has later entry
+      if (it != seen.end() && it->second == order.front().first) {
+        seen.erase(it);
+      }
+      order.pop_front();
+    }
+    auto it{seen.find(cid)};
+    if (it != seen.end() && it->second + ttl > now) {
+      return false;
+    }
+    seen.insert_or_assign(cid, now);
+    order.emplace_back(now, cid);
+    return true;
+  }
+
+  size_t SeenCache::size() const {
+    return seen.size();
+  }
+
+  Ingest::Ingest(std::shared_ptr<boost::asio::io_context> io,
+                 std::shared_ptr<Sync> sync,
+                 std::shared_ptr<Mpool> mpool)
+      : Ingest{std::move(io), std::move(sync), std::move(mpool), Config{}} {}
+
+  Ingest::Ingest(std::shared_ptr<boost::asio::io_context> io,
+                 std::shared_ptr<Sync> sync,
+                 std::shared_ptr<Mpool> mpool,
+                 Config config)
+      : io{std::move(io)},
+        sync{std::move(sync)},
+        mpool{std::move(mpool)},
+        config{config},
+        seen{config.seen_ttl, config.seen_max} {}
+
+  void Ingest::onBlock(BytesIn bytes, const PeerId &peer) {
+    ingest(Kind::kBlock, bytes, peer);
+  }
+
+  void Ingest::onMessage(BytesIn bytes, const PeerId &peer) {
+    ingest(Kind::kMessage, bytes, peer);
+  }
+
+  void Ingest::ingest(Kind kind, BytesIn bytes, const PeerId &peer) {
+    ++metrics.received;
+    auto block{kind == Kind::kBlock};
+    auto max_bytes{block ? config.max_block_bytes : config.max_message_bytes};
+    if (static_cast<size_t>(bytes.size()) > max_bytes) {
+      ++metrics.malformed;
+      return;
+    }
+    // hash of payload is cheaper than decode, so duplicates are dropped first
+    auto cid{common::getCidOf(bytes)};
+    if (!cid) {
+      ++metrics.malformed;
+      return;
+    }
+    if (!seen.insert(cid.value())) {
+      ++metrics.duplicate;
+      return;
+    }
+    if (!isCborTuple(bytes, block ? kBlockFields : kMessageFields)) {
+      ++metrics.malformed;
+      return;
+    }
+    if (queue.size() >= config.max_queue) {
+      ++metrics.dropped;
+      return;
+    }
+    queue.push_back({kind, Buffer{bytes}, peer});
+    schedule();
+  }
+
+  void Ingest::onPeerGone(const PeerId &peer) {
+    auto end{std::remove_if(queue.begin(), queue.end(), [&](auto &item) {
+      return item.peer == peer;
+    })};
+    metrics.dropped += std::distance(end, queue.end());
+    queue.erase(end, queue.end());
+    for (auto it{adds.begin()}; it != adds.end();) {
+      if (it->second.peer == peer) {
+        it->second.timer->cancel();
+        it = adds.erase(it);
+        --in_flight;
+        ++metrics.abandoned;
+      } else {
+        ++it;
+      }
+    }
+    schedule();
+  }
+
+  void Ingest::process() {
+    while (!queue.empty() && in_flight < config.max_in_flight) {
+      auto item{std::move(queue.front())};
+      queue.pop_front();
+      ++in_flight;
+      validate(std::move(item));
+    }
+  }
+
+  void Ingest::validate(Item item) {
+    if (item.kind == Kind::kBlock) {
+      auto block{codec::cbor::decode<BlockWithCids>(item.bytes)};
+      if (!block) {
+        ++metrics.malformed;
+        return done(false);
+      }
+      return done(sync && sync->onGossip(block.value(), item.peer));
+    }
+    auto message{codec::cbor::decode<SignedMessage>(item.bytes)};
+    if (!message) {
+      ++metrics.malformed;
+      return done(false);
+    }
+    if (!mpool) {
+      return done(false);
+    }
+    auto id{next_add++};
+    auto timer{std::make_shared<boost::asio::steady_timer>(*io)};
+    timer->expires_after(config.add_timeout);
+    adds.emplace(id, Add{std::move(item.peer), timer});
+    timer->async_wait([weak{weak_from_this()}, id](auto ec) {
+      if (ec) {
+        return;
+      }
+      if (auto self{weak.lock()}) {
+        if (self->finishAdd(id)) {
+          --self->in_flight;
+          ++self->metrics.abandoned;
+          self->schedule();
+        }
+      }
+    });
+    mpool->addGossip(message.value(),
+                     [weak{weak_from_this()}, id](auto result) {
+                       if (auto self{weak.lock()}) {
+                         if (self->finishAdd(id)) {
+                           self->done(static_cast<bool>(result));
+                         }
+                       }
+                     });
+  }
+
+  bool Ingest::finishAdd(uint64_t id) {
+    auto it{adds.find(id)};
+    if (it == adds.end()) {
+      return false;
+    }
+    it->second.timer->cancel();
+    adds.erase(it);
+    return true;
+  }
+
+  void Ingest::done(bool accepted) {
+    --in_flight;
+    if (accepted) {
+      ++metrics.accepted;
+    } else {
+      ++metrics.rejected;
+    }
+    // synchronous validations return to process loop
+    schedule();
+  }
+
+  void Ingest::schedule() {
+    if (!queue.empty() && !process_posted) {
+      process_posted = true;
+      boost::asio::post(*io, [weak{weak_from_this()}] {
+        if (auto self{weak.lock()}) {
+          self->process_posted = false;
+          self->process();
+        }
+      });
+    }
+  }
+}  // namespace fc::gossip
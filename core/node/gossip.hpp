@@ -0,0 +1,134 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <libp2p/peer/peer_id.hpp>
+
+#include "common/buffer.hpp"
+#include "node/fwd.hpp"
+#include "primitives/cid/cid.hpp"
+
+namespace fc::gossip {
+  using common::Buffer;
+  using libp2p::peer::PeerId;
+  using storage::mpool::Mpool;
+  using sync::Sync;
+
+  /// Counters of gossip ingestion
+  struct Metrics {
+    uint64_t received{};
+    /// Seen within ttl, dropped before decode
+    uint64_t duplicate{};
+    /// Failed syntax check or decode
+    uint64_t malformed{};
+    /// Dropped because validation queue was full
+    uint64_t dropped{};
+    uint64_t accepted{};
+    uint64_t rejected{};
+    /// Mpool adds given up after timeout or disconnect of peer
+    uint64_t abandoned{};
+  };
+
+  /// Cids seen within ttl, bounded by max size
+  struct SeenCache {
+    using Clock = std::chrono::steady_clock;
+
+    SeenCache(Clock::duration ttl, size_t max_size);
+    /// Records cid, returns false if it was seen within ttl
+    bool insert(const CID &cid, Clock::time_point now = Clock::now());
+    size_t size() const;
+
+    Clock::duration ttl;
+    size_t max_size;
+    std::unordered_map<CID, Clock::time_point> seen;
+    /// Cids in order of insertion, with time they were seen
+    std::deque<std::pair<Clock::time_point, CID>> order;
+  };
+
+  /**
+   * Ingestion stage of block and message gossip.
+   * Duplicates are dropped by cid of payload before decode, payloads are
+   * checked to be one cbor tuple of expected length, and accepted ones are
+   * queued for validation. Queue is processed on later io turns with bounded
+   * number of mpool adds in flight, so bls signatures of gossip messages are
+   * verified in batches by mpool verifier. Payloads are dropped when queue is
+   * full, so cpu use stays bounded under gossip flood. Mpool adds which
+   * don't complete within timeout, or whose peer disconnected, free their
+   * slot and their late results are ignored.
+   * Must be used from io thread.
+   */
+  struct Ingest : public std::enable_shared_from_this<Ingest> {
+    struct Config {
+      size_t max_queue{1024};
+      /// Max number of messages being added to mpool
+      size_t max_in_flight{256};
+      size_t max_block_bytes{1 << 20};
+      size_t max_message_bytes{64 << 10};
+      SeenCache::Clock::duration seen_ttl{std::chrono::minutes{2}};
+      size_t seen_max{1 << 16};
+      SeenCache::Clock::duration add_timeout{std::chrono::seconds{30}};
+    };
+
+    Ingest(std::shared_ptr<boost::asio::io_context> io,
+           std::shared_ptr<Sync> sync,
+           std::shared_ptr<Mpool> mpool);
+    Ingest(std::shared_ptr<boost::asio::io_context> io,
+           std::shared_ptr<Sync> sync,
+           std::shared_ptr<Mpool> mpool,
+           Config config);
+
+    /// Block gossip payload, BlockWithCids
+    void onBlock(BytesIn bytes, const PeerId &peer);
+    /// Message gossip payload, SignedMessage
+    void onMessage(BytesIn bytes, const PeerId &peer);
+    /// Drops queued items and mpool adds of disconnected peer
+    void onPeerGone(const PeerId &peer);
+
+    enum class Kind { kBlock, kMessage };
+    struct Item {
+      Kind kind;
+      Buffer bytes;
+      PeerId peer;
+    };
+
+    void ingest(Kind kind, BytesIn bytes, const PeerId &peer);
+    /// Validates queued items while there are free in flight slots
+    void process();
+    void validate(Item item);
+    void done(bool accepted);
+    /// Completes mpool add, false if it was already abandoned
+    bool finishAdd(uint64_t id);
+    /// Posts process to io if queue is not empty
+    void schedule();
+
+    /// Mpool add in flight
+    struct Add {
+      PeerId peer;
+      std::shared_ptr<boost::asio::steady_timer> timer;
+    };
+
+    std::shared_ptr<boost::asio::io_context> io;
+    std::shared_ptr<Sync> sync;
+    std::shared_ptr<Mpool> mpool;
+    Config config;
+    SeenCache seen;
+    std::deque<Item> queue;
+    size_t in_flight{};
+    std::unordered_map<uint64_t, Add> adds;
+    uint64_t next_add{};
+    bool process_posted{};
+    Metrics metrics;
+  };
+
+  /// Checks that bytes are one cbor list of length, without decoding them
+  bool isCborTuple(BytesIn bytes, size_t length);
+}  // namespace fc::gossip
@@ -7,6 +7,7 @@
 
 #include "common/libp2p/cbor_stream.hpp"
 #include "node/hello.hpp"
+#include "node/peermgr.hpp"
 #include "storage/chain/chain_store.hpp"
 
 #define MOVE(x)  \
@@ -16,6 +17,7 @@
 
 namespace fc::hello {
   using common::libp2p::CborStream;
+  using peermgr::Clock;
 
   static constexpr auto kProtocolId{"/fil/hello/1.0.0"};
 
@@ -55,16 +57,26 @@ namespace fc::hello {
                 ts.height,
                 chain_store->getHeaviestWeight(),
                 chain_store->genesisCid()};
-    host->newStream(peer, kProtocolId, [MOVE(hello)](auto _stream) {
-      if (_stream) {
-        auto stream{std::make_shared<CborStream>(_stream.value())};
-        stream->write(hello, [stream](auto _n) {
-          if (!_n) {
-            return stream->close();
+    host->newStream(
+        peer,
+        kProtocolId,
+        [MOVE(hello), scores{scores}, id{peer.id}](auto _stream) {
+          if (_stream) {
+            auto stream{std::make_shared<CborStream>(_stream.value())};
+            stream->write(hello, [stream, scores, id](auto _n) {
+              if (!_n) {
+                return stream->close();
+              }
+              auto sent{Clock::now()};
+              stream->template read<Latency>(
+                  [stream, scores, id, sent](auto _latency) {
+                    if (_latency && scores) {
+                      scores->onRtt(id, Clock::now() - sent);
+                    }
+                    stream->close();
+                  });
+            });
           }
-          stream->template read<Latency>([stream](auto) { stream->close(); });
         });
-      }
-    });
   }
 }  // namespace fc::hello
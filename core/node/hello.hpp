@@ -13,6 +13,7 @@ namespace fc::hello {
   using libp2p::Host;
   using libp2p::peer::PeerId;
   using libp2p::peer::PeerInfo;
+  using peermgr::PeerScores;
   using primitives::BigInt;
   using storage::blockchain::ChainStore;
 
@@ -37,6 +38,8 @@ namespace fc::hello {
 
     std::shared_ptr<Host> host;
     std::shared_ptr<ChainStore> chain_store;
+    /// Optional, receives round trip of hello exchanges
+    std::shared_ptr<PeerScores> scores;
   };
   CBOR_TUPLE(Hello::State, blocks, height, weight, genesis)
   CBOR_TUPLE(Hello::Latency, arrival, sent)
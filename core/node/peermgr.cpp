@@ -3,6 +3,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+
 #include <libp2p/host/host.hpp>
 #include <libp2p/protocol/identify/identify.hpp>
 #include <libp2p/protocol/identify/identify_delta.hpp>
@@ -17,11 +19,83 @@
   }
 
 namespace fc::peermgr {
+  /// Weight of new measurement in moving averages
+  constexpr auto kWeight{0.2};
+  /// Assumed for peers not measured yet
+  constexpr auto kDefaultRttMs{1000.0};
+  constexpr auto kDefaultBytesPerMs{1024.0};
+
+  void average(boost::optional<double> &avg, double value) {
+    avg = avg ? (1 - kWeight) * *avg + kWeight * value : value;
+  }
+
+  double toMs(Clock::duration time) {
+    return std::chrono::duration<double, std::milli>(time).count();
+  }
+
+  void PeerScores::onRtt(const PeerId &peer, Clock::duration rtt) {
+    std::lock_guard lock{mutex};
+    average(scores[peer].rtt_ms, toMs(rtt));
+  }
+
+  void PeerScores::onResponse(const PeerId &peer,
+                              Clock::duration time,
+                              size_t bytes) {
+    std::lock_guard lock{mutex};
+    auto &score{scores[peer]};
+    ++score.successes;
+    auto ms{toMs(time)};
+    // part of time is round trip, rest is transfer
+    auto transfer{ms - score.rtt_ms.value_or(0)};
+    if (bytes != 0 && transfer > 0) {
+      average(score.bytes_per_ms, bytes / transfer);
+    } else {
+      average(score.rtt_ms, ms);
+    }
+  }
+
+  void PeerScores::onFailure(const PeerId &peer) {
+    std::lock_guard lock{mutex};
+    ++scores[peer].failures;
+  }
+
+  double PeerScores::expectedMs(const PeerId &peer, size_t bytes) const {
+    std::lock_guard lock{mutex};
+    Score score;
+    auto it{scores.find(peer)};
+    if (it != scores.end()) {
+      score = it->second;
+    }
+    auto ms{score.rtt_ms.value_or(kDefaultRttMs)
+            + bytes / score.bytes_per_ms.value_or(kDefaultBytesPerMs)};
+    // failed request is retried, so time is divided by success rate
+    auto success{(score.successes + 1.0)
+                 / (score.successes + score.failures + 2.0)};
+    return ms / success;
+  }
+
+  std::vector<PeerId> PeerScores::best(std::vector<PeerId> peers,
+                                       size_t bytes,
+                                       size_t count) const {
+    std::vector<std::pair<double, size_t>> ranked;
+    for (size_t i{0}; i < peers.size(); ++i) {
+      ranked.emplace_back(expectedMs(peers[i], bytes), i);
+    }
+    std::stable_sort(ranked.begin(), ranked.end());
+    std::vector<PeerId> result;
+    for (size_t i{0}; i < std::min(count, ranked.size()); ++i) {
+      result.push_back(peers[ranked[i].second]);
+    }
+    return result;
+  }
+
   PeerMgr::PeerMgr(std::shared_ptr<Host> host,
                    std::shared_ptr<Identify> identify,
                    std::shared_ptr<IdentifyPush> identify_push,
                    std::shared_ptr<IdentifyDelta> identify_delta,
-                   std::shared_ptr<Hello> hello) {
+                   std::shared_ptr<Hello> hello)
+      : scores{std::make_shared<PeerScores>()} {
+    hello->scores = scores;
     auto handle{[&](auto &protocol) {
       protocol->start();
       host->setProtocolHandler(
@@ -5,7 +5,14 @@
 
 #pragma once
 
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/optional.hpp>
 #include <boost/signals2/connection.hpp>
+#include <libp2p/peer/peer_id.hpp>
 
 #include "node/fwd.hpp"
 
@@ -15,6 +22,39 @@ namespace fc::peermgr {
   using libp2p::protocol::Identify;
   using libp2p::protocol::IdentifyDelta;
   using libp2p::protocol::IdentifyPush;
+  using libp2p::peer::PeerId;
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * Latency, throughput and failure rate of peers, measured on hello and
+   * blocksync exchanges. Peers are ranked by expected time of request, so
+   * peers not measured yet are tried too. Thread safe.
+   */
+  struct PeerScores {
+    struct Score {
+      /// Moving averages, none until first measurement
+      boost::optional<double> rtt_ms, bytes_per_ms;
+      size_t successes{}, failures{};
+    };
+
+    /// Round trip of exchange with small response
+    void onRtt(const PeerId &peer, Clock::duration rtt);
+    /// Successful request with response of given size
+    void onResponse(const PeerId &peer, Clock::duration time, size_t bytes);
+    void onFailure(const PeerId &peer);
+    /// Expected time of request with response of given size
+    double expectedMs(const PeerId &peer, size_t bytes) const;
+    /**
+     * Orders peers by expected time of request
+     * @return up to count best peers
+     */
+    std::vector<PeerId> best(std::vector<PeerId> peers,
+                             size_t bytes,
+                             size_t count) const;
+
+    mutable std::mutex mutex;
+    std::unordered_map<PeerId, Score> scores;
+  };
 
   struct PeerMgr {
     PeerMgr(std::shared_ptr<Host> host,
@@ -24,5 +64,7 @@ namespace fc::peermgr {
             std::shared_ptr<Hello> hello);
 
     boost::signals2::connection identify_sub;
+    /// Shared with hello and sync
+    std::shared_ptr<PeerScores> scores;
   };
 }  // namespace fc::peermgr
@@ -0,0 +1,208 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "node/snapshot.hpp"
+
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <unordered_set>
+
+#include <boost/asio/post.hpp>
+
+#include "crypto/blake2/blake2b160.hpp"
+#include "storage/car/car.hpp"
+#include "storage/car/car_store.hpp"
+#include "storage/ipld/traverser.hpp"
+#include "vm/interpreter/interpreter.hpp"
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::snapshot, SnapshotError, e) {
+  using E = fc::snapshot::SnapshotError;
+  switch (e) {
+    case E::kNoRoots:
+      return "Snapshot has no roots";
+    case E::kStateMismatch:
+      return "Snapshot state does not match execution";
+    default:
+      return "Snapshot: unknown error";
+  }
+}
+
+namespace fc::snapshot {
+  using crypto::blake2b::Blake2b160Hash;
+  using storage::car::CarWriter;
+
+  /// Dag blocks read and decoded at once by export
+  constexpr size_t kExportBatch{256};
+
+  outcome::result<Tipset> importSnapshot(const IpldPtr &ipld,
+                                         std::istream &input,
+                                         boost::asio::thread_pool &pool) {
+    OUTCOME_TRY(roots, storage::car::loadCar(*ipld, input, pool));
+    if (roots.empty()) {
+      return SnapshotError::kNoRoots;
+    }
+    return Tipset::load(*ipld, roots);
+  }
+
+  outcome::result<Tipset> importSnapshot(const IpldPtr &ipld,
+                                         const std::string &car_path,
+                                         boost::asio::thread_pool &pool) {
+    OUTCOME_TRY(car, storage::car::CarStore::open(car_path));
+    if (car->roots().empty()) {
+      return SnapshotError::kNoRoots;
+    }
+    OUTCOME_TRY(Tipset::load(*car, car->roots()));
+    std::ifstream input{car_path, std::ios::binary};
+    return importSnapshot(ipld, input, pool);
+  }
+
+  void verifySnapshot(IpldPtr ipld,
+                      std::shared_ptr<Interpreter> interpreter,
+                      const Tipset &tip,
+                      size_t depth,
+                      size_t checkpoints,
+                      std::shared_ptr<boost::asio::thread_pool> pool,
+                      VerifyCb cb) {
+    // pairs of checkpoint and its child, walk down reads headers only
+    std::vector<std::pair<Tipset, Tipset>> pairs;
+    auto step{std::max<size_t>(1, depth / std::max<size_t>(1, checkpoints))};
+    Tipset child{tip};
+    for (size_t i{1}; i <= depth && child.height != 0; ++i) {
+      auto _ts{child.loadParent(*ipld)};
+      if (!_ts) {
+        return cb(_ts.error());
+      }
+      if (i % step == 0) {
+        pairs.emplace_back(_ts.value(), child);
+      }
+      child = std::move(_ts.value());
+    }
+    if (pairs.empty()) {
+      return cb(outcome::success());
+    }
+    struct State {
+      std::mutex mutex;
+      size_t pending;
+      outcome::result<void> result{outcome::success()};
+      VerifyCb cb;
+    };
+    auto state{std::make_shared<State>()};
+    state->pending = pairs.size();
+    state->cb = std::move(cb);
+    for (auto &pair : pairs) {
+      boost::asio::post(
+          *pool, [ipld, interpreter, state, pair{std::move(pair)}] {
+            auto &[ts, child]{pair};
+            auto verified{[&]() -> outcome::result<void> {
+              OUTCOME_TRY(result, interpreter->interpret(ipld, ts));
+              if (result.state_root != child.getParentStateRoot()
+                  || result.message_receipts
+                         != child.getParentMessageReceipts()) {
+                return SnapshotError::kStateMismatch;
+              }
+              return outcome::success();
+            }()};
+            std::unique_lock lock{state->mutex};
+            if (!verified && state->result) {
+              state->result = verified.error();
+            }
+            if (--state->pending == 0) {
+              auto result{state->result};
+              lock.unlock();
+              state->cb(result);
+            }
+          });
+    }
+  }
+
+  outcome::result<void> exportSnapshot(
+      std::ostream &output,
+      const IpldPtr &ipld,
+      const Tipset &tip,
+      size_t depth,
+      size_t state_epochs,
+      const std::shared_ptr<boost::asio::thread_pool> &pool) {
+    CarWriter writer{output, tip.cids};
+    std::unordered_set<Blake2b160Hash> visited;
+    std::vector<CID> pending;
+    auto visit{[&](const CID &cid) -> outcome::result<bool> {
+      // builtin actor codes are identity cids, which are not stored
+      if (cid.content_address.getType()
+          == libp2p::multi::HashType::identity) {
+        return false;
+      }
+      OUTCOME_TRY(key, cid.toBytes());
+      return visited.insert(crypto::blake2b::blake2b_160(key)).second;
+    }};
+    auto push{[&](const CID &cid) -> outcome::result<void> {
+      OUTCOME_TRY(unvisited, visit(cid));
+      if (unvisited) {
+        pending.push_back(cid);
+      }
+      return outcome::success();
+    }};
+    using Fetched = outcome::result<std::pair<Buffer, std::vector<CID>>>;
+    auto fetch{[&](const CID &cid) -> Fetched {
+      OUTCOME_TRY(bytes, ipld->get(cid));
+      OUTCOME_TRY(links,
+                  storage::ipld::traverser::blockLinks(cid, bytes));
+      return std::make_pair(std::move(bytes), std::move(links));
+    }};
+    // pending links are a stack, so walk is depth first and stays small
+    auto walk{[&]() -> outcome::result<void> {
+      while (!pending.empty()) {
+        auto count{std::min(pending.size(), kExportBatch)};
+        std::vector<CID> batch{pending.end() - count, pending.end()};
+        pending.resize(pending.size() - count);
+        std::vector<std::future<Fetched>> futures;
+        for (auto &cid : batch) {
+          std::packaged_task<Fetched()> task{[&fetch, &cid] {
+            return fetch(cid);
+          }};
+          futures.push_back(task.get_future());
+          boost::asio::post(*pool, std::move(task));
+        }
+        // all fetches are awaited before return, they refer to batch
+        std::vector<Fetched> results;
+        for (auto &future : futures) {
+          results.push_back(future.get());
+        }
+        for (size_t i{0}; i < batch.size(); ++i) {
+          OUTCOME_TRY(fetched, std::move(results[i]));
+          OUTCOME_TRY(writer.write(batch[i], fetched.first));
+          for (auto &link : fetched.second) {
+            OUTCOME_TRY(push(link));
+          }
+        }
+      }
+      return outcome::success();
+    }};
+
+    auto ts{tip};
+    for (size_t i{0}; i <= depth; ++i) {
+      for (size_t j{0}; j < ts.cids.size(); ++j) {
+        OUTCOME_TRY(unvisited, visit(ts.cids[j]));
+        if (unvisited) {
+          OUTCOME_TRY(writer.write(*ipld, ts.cids[j]));
+        }
+        if (i < state_epochs) {
+          auto &block{ts.blks[j]};
+          OUTCOME_TRY(push(block.messages));
+          OUTCOME_TRY(push(block.parent_message_receipts));
+          OUTCOME_TRY(push(block.parent_state_root));
+        }
+      }
+      // dags of each tipset are written before next headers, so pending
+      // links don't accumulate over epochs
+      OUTCOME_TRY(walk());
+      if (ts.height == 0) {
+        break;
+      }
+      OUTCOME_TRYA(ts, ts.loadParent(*ipld));
+    }
+    return outcome::success();
+  }
+}  // namespace fc::snapshot
@@ -0,0 +1,82 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <istream>
+#include <ostream>
+
+#include <boost/asio/thread_pool.hpp>
+
+#include "node/fwd.hpp"
+#include "primitives/tipset/tipset.hpp"
+
+namespace fc::snapshot {
+  using primitives::tipset::Tipset;
+  using vm::interpreter::Interpreter;
+
+  enum class SnapshotError {
+    kNoRoots = 1,
+    kStateMismatch,
+  };
+
+  /**
+   * Loads chain snapshot car, which roots are blocks of tip, blocks are
+   * verified and written on pool. State of tip is trusted, so node starts
+   * from it without executing chain.
+   * @return tip of snapshot
+   */
+  outcome::result<Tipset> importSnapshot(const IpldPtr &ipld,
+                                         std::istream &input,
+                                         boost::asio::thread_pool &pool);
+
+  /**
+   * Loads chain snapshot car file. Car is mapped and indexed first, index
+   * is used only to check that tip loads from car before any block is
+   * written, then whole car is streamed as by istream import.
+   * @return tip of snapshot
+   */
+  outcome::result<Tipset> importSnapshot(const IpldPtr &ipld,
+                                         const std::string &car_path,
+                                         boost::asio::thread_pool &pool);
+
+  using VerifyCb = std::function<void(outcome::result<void>)>;
+
+  /**
+   * Verifies snapshot states in background. Checkpoint tipsets are picked
+   * evenly from depth tipsets below tip, each of them is executed on pool
+   * from its parent state, independently of others, and its result is
+   * compared with its child.
+   * @param depth - tipsets below tip which parent states are in snapshot
+   * @param cb - called on pool when all checkpoints are done, with first
+   * mismatch or error
+   */
+  void verifySnapshot(IpldPtr ipld,
+                      std::shared_ptr<Interpreter> interpreter,
+                      const Tipset &tip,
+                      size_t depth,
+                      size_t checkpoints,
+                      std::shared_ptr<boost::asio::thread_pool> pool,
+                      VerifyCb cb);
+
+  /**
+   * Writes chain snapshot car with tip as roots. Headers are walked down
+   * depth tipsets, messages, receipts and state trees are included for
+   * state_epochs tipsets below tip. Dags are walked in bounded batches which
+   * are read and decoded on pool, blocks are written as they are reached, so
+   * only visited digests and pending links are kept in memory.
+   * Blocking, so it should run off io thread, ipld must support concurrent
+   * reads.
+   */
+  outcome::result<void> exportSnapshot(
+      std::ostream &output,
+      const IpldPtr &ipld,
+      const Tipset &tip,
+      size_t depth,
+      size_t state_epochs,
+      const std::shared_ptr<boost::asio::thread_pool> &pool);
+}  // namespace fc::snapshot
+
+OUTCOME_HPP_DECLARE_ERROR(fc::snapshot, SnapshotError);
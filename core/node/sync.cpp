@@ -3,13 +3,23 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <libp2p/peer/peer_info.hpp>
 
 #include "blockchain/impl/weight_calculator_impl.hpp"
+#include "crypto/bls/bls_provider.hpp"
+#include "crypto/hasher/hasher.hpp"
+#include "metrics/metrics.hpp"
 #include "node/blocksync.hpp"
+#include "node/peermgr.hpp"
 #include "node/sync.hpp"
+#include "storage/ipfs/graphsync/graphsync.hpp"
+#include "storage/ipld/selector.hpp"
+#include "storage/mpool/mpool.hpp"
 #include "storage/chain/chain_store.hpp"
-#include "vm/interpreter/interpreter.hpp"
+#include "vm/message/impl/secp_verifier.hpp"
+#include "vm/message/message.hpp"
 
 #define MOVE(x)  \
   x {            \
@@ -17,62 +27,435 @@
   }
 
 namespace fc::sync {
+  using common::Buffer;
+  using libp2p::multi::HashType;
+  using primitives::address::BLSPublicKeyHash;
+  using primitives::block::BlockHeader;
   using primitives::block::MsgMeta;
-  using primitives::tipset::Tipset;
+  using storage::mpool::MpoolUpdate;
+  using vm::message::SignedMessage;
+  using vm::message::UnsignedMessage;
+
+  /// Tipsets per messages range request
+  constexpr size_t kMessagesRangeLength{100};
+  /// Requests of messages range before it is dropped
+  constexpr size_t kMessagesRangeAttempts{3};
+  /// Messages range requests in flight
+  constexpr size_t kMessagesRangesInFlight{4};
+  /// Approximate sizes of tipset parts, used to rank peers
+  constexpr size_t kHeadersRangeBytes{
+      2048 * blocksync::kBlockSyncMaxRequestLength};
+  constexpr size_t kMessagesRangeBytes{65536 * kMessagesRangeLength};
+  /// Requests sent for one headers range, including hedged ones
+  constexpr size_t kHeadersRequests{2};
+  /// Request is hedged after this times its expected time
+  constexpr auto kHedgeFactor{2.0};
+  constexpr std::chrono::milliseconds kMinHedgeDelay{500};
+
+  struct SyncMetrics {
+    metrics::Histogram &headers_time;
+    metrics::Histogram &messages_time;
+    metrics::Counter &headers_failed;
+    metrics::Counter &messages_failed;
+    metrics::Gauge &headers_in_flight;
+    metrics::Gauge &messages_in_flight;
+    metrics::Gauge &messages_queue;
+  };
+
+  SyncMetrics &syncMetrics() {
+    static SyncMetrics metrics{[] {
+      auto &registry{metrics::Registry::global()};
+      auto failed{[&](const char *what) -> metrics::Counter & {
+        return registry.counter(
+            "fc_sync_fetch_failed_total", "Failed fetches", {{"kind", what}});
+      }};
+      auto time{[&](const char *what) -> metrics::Histogram & {
+        return registry.histogram("fc_sync_fetch_seconds",
+                                  "Latency of successful fetches",
+                                  {{"kind", what}},
+                                  1e-9);
+      }};
+      return SyncMetrics{
+          time("headers"),
+          time("messages"),
+          failed("headers"),
+          failed("messages"),
+          registry.gauge("fc_sync_headers_in_flight",
+                         "Headers ranges being fetched"),
+          registry.gauge("fc_sync_messages_in_flight",
+                         "Messages ranges being fetched"),
+          registry.gauge("fc_sync_messages_queue",
+                         "Heights with tipsets waiting for messages"),
+      };
+    }()};
+    return metrics;
+  }
+
+  bool haveMessages(Ipld &ipld, const Tipset &ts) {
+    for (auto &block : ts.blks) {
+      auto _have{ipld.contains(block.messages)};
+      if (!_have || !_have.value()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  boost::optional<bool> ValidTipsets::find(const TipsetKey &key) const {
+    auto it{valid.find(key)};
+    if (it == valid.end()) {
+      return boost::none;
+    }
+    return it->second;
+  }
+
+  bool ValidTipsets::has(const TipsetKey &key) const {
+    return valid.find(key) != valid.end();
+  }
+
+  void ValidTipsets::emplace(const TipsetKey &key,
+                             uint64_t height,
+                             bool _valid) {
+    if (valid.emplace(key, _valid).second) {
+      heights[height].push_back(key);
+    }
+  }
+
+  void ValidTipsets::prune(uint64_t height) {
+    auto end{heights.lower_bound(height)};
+    for (auto it{heights.begin()}; it != end; ++it) {
+      for (auto &key : it->second) {
+        valid.erase(key);
+      }
+    }
+    heights.erase(heights.begin(), end);
+  }
+
+  size_t ValidTipsets::size() const {
+    return valid.size();
+  }
 
   TsSync::TsSync(std::shared_ptr<Host> host,
                  IpldPtr ipld,
-                 std::shared_ptr<Interpreter> interpreter)
-      : MOVE(host), MOVE(ipld), MOVE(interpreter) {}
+                 std::shared_ptr<Interpreter> interpreter,
+                 std::shared_ptr<boost::asio::io_context> io,
+                 std::shared_ptr<boost::asio::thread_pool> pool,
+                 std::shared_ptr<SecpVerifier> secp,
+                 std::shared_ptr<BlsProvider> bls)
+      : MOVE(host),
+        MOVE(ipld),
+        MOVE(interpreter),
+        MOVE(io),
+        MOVE(pool),
+        MOVE(secp),
+        MOVE(bls),
+        power_summaries{std::make_shared<
+            vm::actor::builtin::storage_power::PowerSummaries>(this->ipld)},
+        strand{this->pool->get_executor()} {}
 
   void TsSync::sync(const TipsetKey &key,
+                    uint64_t height,
                     const PeerId &peer,
                     Callback callback) {
-    auto _valid{valid.find(key)};
-    if (_valid != valid.end()) {
-      return callback(key, _valid->second);
+    if (auto _valid{isValid(key, height)}) {
+      return callback(key, *_valid);
+    }
+    auto &pending{callbacks[key]};
+    pending.height = height;
+    pending.callbacks.push_back(std::move(callback));
+    if (std::find(peers.begin(), peers.end(), peer) == peers.end()) {
+      peers.push_back(peer);
     }
-    callbacks[key].push_back(std::move(callback));
     walkDown(key, peer);
   }
 
   void TsSync::walkDown(TipsetKey key, const PeerId &peer) {
     while (true) {
+      if (fetching.find(key) != fetching.end()) {
+        return;
+      }
       auto _ts{Tipset::load(*ipld, key.cids)};
-      if (_ts) {
-        auto &ts{_ts.value()};
-        auto have_messages{true};
-        for (auto &block : ts.blks) {
-          auto _have{ipld->contains(block.messages)};
-          if (!_have || !_have.value()) {
-            have_messages = false;
-            break;
-          }
+      if (!_ts) {
+        return fetchHeaders(std::move(key), peer);
+      }
+      auto &ts{_ts.value()};
+      auto parent{ts.getParents()};
+      auto &siblings{children[parent]};
+      if (std::any_of(siblings.begin(), siblings.end(), [&](auto &child) {
+            return child.key == key;
+          })) {
+        // walked by earlier sync of same tipset
+        return fetchMessages(peer);
+      }
+      // headers are walked down first, messages are backfilled from bottom
+      if (haveMessages(*ipld, ts)) {
+        check(parent, key);
+      } else {
+        missing_messages[ts.height].insert(key);
+      }
+      siblings.push_back({std::move(key), ts.height});
+      if (siblings.size() != 1) {
+        return fetchMessages(peer);
+      }
+      if (isValid(parent)) {
+        fetchMessages(peer);
+        return walkUp(std::move(parent));
+      }
+      key = std::move(parent);
+    }
+  }
+
+  void TsSync::prefetch(TipsetKey key,
+                        const PeerId &peer,
+                        std::function<void()> done) {
+    std::vector<TipsetKey> walked;
+    while (true) {
+      if (isValid(key) || prefetched.has(key)) {
+        break;
+      }
+      if (walked.size() == kPrefetchWalkStep) {
+        // walk of long stored chain continues later, not blocking io thread
+        for (auto &key : walked) {
+          prefetched.emplace(key, true);
         }
-        if (have_messages) {
-          auto parent{ts.getParents()};
-          children[parent].push_back(std::move(key));
-          if (children.at(parent).size() != 1) {
-            return;
+        return boost::asio::post(*io,
+                                 [self{shared_from_this()},
+                                  MOVE(key),
+                                  peer,
+                                  MOVE(done)]() mutable {
+                                   self->prefetch(
+                                       std::move(key), peer, std::move(done));
+                                 });
+      }
+      auto _ts{Tipset::load(*ipld, key.cids)};
+      if (!_ts) {
+        return blocksync::fetchHeaders(
+            host,
+            {peer, {}},
+            ipld,
+            key.cids,
+            blocksync::kBlockSyncMaxRequestLength,
+            [self{shared_from_this()}, key, peer, done](auto _chain) {
+              if (!_chain) {
+                return done();
+              }
+              self->prefetch(std::move(key), peer, std::move(done));
+            },
+            scores);
+      }
+      if (_ts.value().height == 0) {
+        break;
+      }
+      walked.push_back(key);
+      key = _ts.value().getParents();
+    }
+    for (auto &key : walked) {
+      prefetched.emplace(key, true);
+    }
+    account();
+    done();
+  }
+
+  void TsSync::fetchHeaders(TipsetKey key, const PeerId &peer) {
+    struct Hedge {
+      std::vector<PeerId> peers;
+      size_t sent{}, failed{};
+      bool done{};
+      boost::asio::steady_timer timer;
+    };
+    fetching.insert(key);
+    auto &metrics{syncMetrics()};
+    metrics.headers_in_flight.set(fetching.size());
+    auto start{std::chrono::steady_clock::now()};
+    auto hedge{std::make_shared<Hedge>(
+        Hedge{rankPeers(peer, kHeadersRangeBytes, kHeadersRequests),
+              0,
+              0,
+              false,
+              boost::asio::steady_timer{*io}})};
+    // sends request to next peer, kept alive by pending callbacks
+    auto send{std::make_shared<std::function<void()>>()};
+    std::weak_ptr<std::function<void()>> weak_send{send};
+    *send = [self{shared_from_this()}, key, hedge, weak_send, start] {
+      auto send{weak_send.lock()};
+      if (!send || hedge->done || hedge->sent == hedge->peers.size()) {
+        return;
+      }
+      auto &to{hedge->peers[hedge->sent++]};
+      if (self->scores && hedge->sent < hedge->peers.size()) {
+        auto expected{self->scores->expectedMs(to, kHeadersRangeBytes)};
+        hedge->timer.expires_after(
+            std::max<std::chrono::steady_clock::duration>(
+                kMinHedgeDelay,
+                std::chrono::milliseconds{
+                    static_cast<int64_t>(expected * kHedgeFactor)}));
+        hedge->timer.async_wait([send](auto ec) {
+          if (!ec) {
+            (*send)();
           }
-          if (valid.find(parent) != valid.end()) {
-            return walkUp(std::move(parent));
+        });
+      }
+      blocksync::fetchHeaders(
+          self->host,
+          {to, {}},
+          self->ipld,
+          key.cids,
+          blocksync::kBlockSyncMaxRequestLength,
+          [self, key, to, hedge, send, start](auto _chain) {
+            if (hedge->done) {
+              return;
+            }
+            auto &metrics{syncMetrics()};
+            if (_chain) {
+              hedge->done = true;
+              hedge->timer.cancel();
+              self->fetching.erase(key);
+              metrics.headers_time.observe(std::chrono::steady_clock::now()
+                                           - start);
+              metrics.headers_in_flight.set(self->fetching.size());
+              return self->walkDown(std::move(key), to);
+            }
+            // TODO: bad block vs network failure
+            ++hedge->failed;
+            metrics.headers_failed.inc();
+            if (hedge->failed == hedge->peers.size()) {
+              hedge->done = true;
+              self->fetching.erase(key);
+              metrics.headers_in_flight.set(self->fetching.size());
+            } else if (hedge->failed == hedge->sent) {
+              hedge->timer.cancel();
+              (*send)();
+            }
+          },
+          self->scores);
+    };
+    (*send)();
+  }
+
+  std::vector<PeerId> TsSync::rankPeers(const PeerId &peer,
+                                        size_t bytes,
+                                        size_t count) const {
+    if (!scores) {
+      return {peer};
+    }
+    auto candidates{peers};
+    if (std::find(candidates.begin(), candidates.end(), peer)
+        == candidates.end()) {
+      candidates.push_back(peer);
+    }
+    return scores->best(std::move(candidates), bytes, count);
+  }
+
+  void TsSync::fetchMessages(const PeerId &peer) {
+    // ranges are spread over best peers when they are scored
+    auto ranked{scores ? rankPeers(peer,
+                                   kMessagesRangeBytes,
+                                   kMessagesRangesInFlight)
+                       : peers};
+    if (ranked.empty()) {
+      ranked.push_back(peer);
+    }
+    while (messages_in_flight < kMessagesRangesInFlight) {
+      MessagesRange range;
+      if (!retry_messages.empty()) {
+        range = std::move(retry_messages.front());
+        retry_messages.pop_front();
+      } else if (auto chain{nextMessagesRange()}) {
+        range.chain = std::move(*chain);
+      } else {
+        break;
+      }
+      auto to{ranked[next_messages_peer++ % ranked.size()]};
+      ++messages_in_flight;
+      auto chain{range.chain};
+      blocksync::fetchMessages(
+          host,
+          {to, {}},
+          ipld,
+          std::move(chain),
+          [self{shared_from_this()},
+           MOVE(range),
+           to,
+           start{std::chrono::steady_clock::now()}](auto _chain) mutable {
+            --self->messages_in_flight;
+            auto &metrics{syncMetrics()};
+            if (!_chain) {
+              metrics.messages_failed.inc();
+              // TODO: bad block vs network failure
+              if (++range.attempts < kMessagesRangeAttempts) {
+                self->retry_messages.push_back(std::move(range));
+              }
+            } else {
+              metrics.messages_time.observe(std::chrono::steady_clock::now()
+                                            - start);
+              // prefix from top is stored, rest of range is fetched again
+              auto stored{_chain.value().size()};
+              for (size_t i{0}; i < range.chain.size(); ++i) {
+                auto &ts{range.chain[i]};
+                TipsetKey key{ts.cids};
+                if (i < stored) {
+                  self->check(ts.getParents(), std::move(key));
+                } else {
+                  self->missing_messages[ts.height].insert(std::move(key));
+                }
+              }
+            }
+            self->fetchMessages(to);
+          },
+          scores);
+    }
+    auto &metrics{syncMetrics()};
+    metrics.messages_in_flight.set(messages_in_flight);
+    metrics.messages_queue.set(missing_messages.size());
+    account();
+  }
+
+  boost::optional<std::vector<Tipset>> TsSync::nextMessagesRange() {
+    auto take{[&](uint64_t height, const TipsetKey &key) {
+      auto _height{missing_messages.find(height)};
+      if (_height == missing_messages.end()
+          || _height->second.erase(key) == 0) {
+        return false;
+      }
+      if (_height->second.empty()) {
+        missing_messages.erase(_height);
+      }
+      return true;
+    }};
+    while (!missing_messages.empty()) {
+      auto &lowest{*missing_messages.begin()};
+      auto height{lowest.first};
+      auto key{*lowest.second.begin()};
+      take(height, key);
+      auto _ts{Tipset::load(*ipld, key.cids)};
+      if (!_ts) {
+        continue;
+      }
+      // lowest tipsets first, so they execute while rest is fetched
+      std::vector<Tipset> chain{std::move(_ts.value())};
+      while (chain.size() < kMessagesRangeLength) {
+        auto _children{children.find(TipsetKey{chain.back().cids})};
+        if (_children == children.end()) {
+          break;
+        }
+        boost::optional<Tipset> next;
+        for (auto &child : _children->second) {
+          auto _child{Tipset::load(*ipld, child.key.cids)};
+          if (_child && take(child.height, child.key)) {
+            next = std::move(_child.value());
+            break;
           }
-          key = std::move(parent);
-          continue;
         }
+        if (!next) {
+          break;
+        }
+        chain.push_back(std::move(*next));
       }
-      return blocksync::fetch(host,
-                              {peer, {}},
-                              ipld,
-                              key.cids,
-                              [self{shared_from_this()}, key, peer](auto _ts) {
-                                // TODO: bad block vs network failure
-                                if (_ts) {
-                                  self->walkDown(std::move(key), peer);
-                                }
-                              });
+      // range is requested from top, each tipset followed by its parent
+      std::reverse(chain.begin(), chain.end());
+      return chain;
     }
+    return boost::none;
   }
 
   void TsSync::walkUp(TipsetKey key) {
@@ -80,104 +463,542 @@ namespace fc::sync {
     while (!queue.empty()) {
       key = std::move(queue.back());
       queue.pop_back();
-      auto _valid{valid.at(key)};
+      auto found{valid.find(key)};
+      auto _valid{found && *found};
       auto _callbacks{callbacks.find(key)};
       if (_callbacks != callbacks.end()) {
-        for (auto &callback : _callbacks->second) {
+        for (auto &callback : _callbacks->second.callbacks) {
           callback(key, _valid);
         }
         callbacks.erase(_callbacks);
       }
       auto _children{children.find(key)};
       if (_children != children.end()) {
-        if (_valid) {
-          OUTCOME_EXCEPT(ts, Tipset::load(*ipld, key.cids));
-          blockchain::weight::WeightCalculatorImpl weighter{ipld};
-          OUTCOME_EXCEPT(weight, weighter.calculateWeight(ts));
-          OUTCOME_EXCEPT(vm, interpreter->interpret(ipld, ts));
-          for (auto &_child : _children->second) {
-            OUTCOME_EXCEPT(child, Tipset::load(*ipld, _child.cids));
-            auto child_valid{child.getParentStateRoot() == vm.state_root
-                             && child.getParentMessageReceipts()
-                                    == vm.message_receipts
-                             && child.getParentWeight() == weight};
-            if (child_valid) {
-              auto _vm{interpreter->interpret(ipld, child)};
-              auto _weight{weighter.calculateWeight(child)};
-              if (!_vm || !_weight) {
-                child_valid = false;
-              }
+        auto keys{std::move(_children->second)};
+        children.erase(_children);
+        for (auto &child : keys) {
+          if (_valid) {
+            validate(key, std::move(child.key));
+          } else {
+            checked.erase(child.key);
+            valid.emplace(child.key, child.height, false);
+            queue.push_back(std::move(child.key));
+          }
+        }
+      }
+    }
+    prune();
+    account();
+  }
+
+  boost::optional<bool> TsSync::isValid(const TipsetKey &key,
+                                        boost::optional<uint64_t> height) {
+    if (auto _valid{valid.find(key)}) {
+      return _valid;
+    }
+    if (!chain_store) {
+      return boost::none;
+    }
+    if (!height) {
+      auto _ts{Tipset::load(*ipld, key.cids)};
+      if (!_ts) {
+        return boost::none;
+      }
+      height = _ts.value().height;
+    }
+    if (*height > checkpoint) {
+      return boost::none;
+    }
+    auto _canonical{chain_store->getTipsetByHeight(
+        chain_store->heaviestTipset(), *height, false)};
+    if (!_canonical) {
+      return boost::none;
+    }
+    // chain can't be reorganized below checkpoint, so forks are invalid
+    auto _valid{TipsetKey{_canonical.value().cids} == key};
+    // kept until next prune, walk up reads it right after walk down
+    valid.emplace(key, *height, _valid);
+    return _valid;
+  }
+
+  void TsSync::prune() {
+    if (!chain_store) {
+      return;
+    }
+    auto height{chain_store->heaviestTipset().height};
+    if (height < checkpoint + kSyncFinality + 1) {
+      return;
+    }
+    checkpoint = height - kSyncFinality;
+    valid.prune(checkpoint);
+    // children below checkpoint can't become heaviest
+    for (auto it{children.begin()}; it != children.end();) {
+      auto &keys{it->second};
+      keys.erase(std::remove_if(keys.begin(),
+                                keys.end(),
+                                [&](auto &child) {
+                                  if (child.height >= checkpoint) {
+                                    return false;
+                                  }
+                                  checked.erase(child.key);
+                                  waiting.erase(child.key);
+                                  return true;
+                                }),
+                 keys.end());
+      it = keys.empty() ? children.erase(it) : std::next(it);
+    }
+    missing_messages.erase(missing_messages.begin(),
+                           missing_messages.lower_bound(checkpoint));
+    // abandoned syncs of final tipsets are answered from chain store
+    std::vector<std::pair<TipsetKey, uint64_t>> answered;
+    for (auto &[key, pending] : callbacks) {
+      if (pending.height <= checkpoint) {
+        answered.emplace_back(key, pending.height);
+      }
+    }
+    for (auto &[key, height] : answered) {
+      auto _valid{isValid(key, height)};
+      auto _callbacks{callbacks.find(key)};
+      if (_callbacks == callbacks.end()) {
+        continue;
+      }
+      auto pending{std::move(_callbacks->second.callbacks)};
+      callbacks.erase(_callbacks);
+      for (auto &callback : pending) {
+        callback(key, _valid && *_valid);
+      }
+    }
+  }
+
+  void TsSync::account() {
+    // keys hold cids of few blocks; chains usually have one child and one
+    // tipset per height, so nested containers are not walked
+    constexpr size_t kKeyBytes{sizeof(TipsetKey) + 3 * sizeof(CID)};
+    constexpr size_t kVectorBytes{sizeof(std::vector<TipsetKey>)};
+    memory.set(
+        metrics::containerBytes(valid, 2 * kKeyBytes + sizeof(bool))
+        + metrics::containerBytes(prefetched, kKeyBytes + sizeof(bool))
+        + metrics::containerBytes(fetching, kKeyBytes)
+        + metrics::containerBytes(checked, kKeyBytes + sizeof(bool))
+        + metrics::containerBytes(waiting, 2 * kKeyBytes)
+        + metrics::containerBytes(
+            callbacks,
+            kKeyBytes + sizeof(Pending) + sizeof(Callback))
+        + metrics::containerBytes(
+            children, 2 * kKeyBytes + sizeof(uint64_t) + kVectorBytes)
+        + metrics::containerBytes(missing_messages,
+                                  sizeof(uint64_t) + 2 * kKeyBytes));
+  }
+
+  void TsSync::check(TipsetKey parent, TipsetKey key) {
+    boost::asio::post(
+        *pool, [self{shared_from_this()}, MOVE(parent), MOVE(key)]() mutable {
+          auto _ts{Tipset::load(*self->ipld, key.cids)};
+          auto _parent{Tipset::load(*self->ipld, parent.cids)};
+          auto ok{_ts && _parent
+                  && self->checkHeaders(_parent.value(), _ts.value())
+                  && self->checkSignatures(_ts.value())};
+          boost::asio::post(*self->io, [self, MOVE(key), ok]() mutable {
+            self->onChecked(std::move(key), ok);
+          });
+        });
+  }
+
+  void TsSync::onChecked(TipsetKey key, bool ok) {
+    auto _waiting{waiting.find(key)};
+    if (_waiting != waiting.end()) {
+      auto parent{std::move(_waiting->second)};
+      waiting.erase(_waiting);
+      return execute(std::move(parent), std::move(key), ok);
+    }
+    if (!valid.has(key)) {
+      checked.emplace(std::move(key), ok);
+    }
+  }
+
+  void TsSync::validate(TipsetKey parent, TipsetKey key) {
+    auto _checked{checked.find(key)};
+    if (_checked == checked.end()) {
+      waiting.emplace(std::move(key), std::move(parent));
+      return;
+    }
+    auto ok{_checked->second};
+    checked.erase(_checked);
+    execute(std::move(parent), std::move(key), ok);
+  }
+
+  void TsSync::execute(TipsetKey parent, TipsetKey key, bool ok) {
+    auto done{[self{shared_from_this()}](
+                  TipsetKey key, uint64_t height, bool valid) {
+      boost::asio::post(
+          *self->io, [self, MOVE(key), height, valid]() mutable {
+            self->valid.emplace(key, height, valid);
+            self->walkUp(std::move(key));
+          });
+    }};
+    if (!ok) {
+      auto _ts{Tipset::load(*ipld, key.cids)};
+      auto height{_ts ? _ts.value().height : 0};
+      return done(std::move(key), height, false);
+    }
+    boost::asio::post(
+        strand,
+        [self{shared_from_this()}, MOVE(parent), MOVE(key), done]() mutable {
+          auto valid{false};
+          auto _parent{self->executed.find(parent)};
+          if (!_parent) {
+            // genesis, tipset validated before or evicted result
+            auto _parent_ts{Tipset::load(*self->ipld, parent.cids)};
+            if (_parent_ts && self->interpret(parent, _parent_ts.value())) {
+              _parent = self->executed.find(parent);
             }
-            valid.emplace(_child, child_valid);
           }
-        } else {
-          for (auto &child : _children->second) {
-            valid.emplace(child, false);
+          auto _ts{Tipset::load(*self->ipld, key.cids)};
+          auto height{_ts ? _ts.value().height : 0};
+          if (_parent && _ts) {
+            auto &ts{_ts.value()};
+            // copied, so result is kept if executing tipset evicts it
+            auto result{*_parent};
+            // tipset is executed once here, its children reuse the result
+            valid = ts.getParentStateRoot() == result.vm.state_root
+                    && ts.getParentMessageReceipts()
+                           == result.vm.message_receipts
+                    && ts.getParentWeight() == result.weight
+                    && self->interpret(key, ts);
           }
+          done(std::move(key), height, valid);
+        });
+  }
+
+  bool TsSync::checkHeaders(const Tipset &parent, const Tipset &ts) const {
+    if (ts.height <= parent.height) {
+      return false;
+    }
+    auto min_timestamp{parent.getMinTimestamp()};
+    for (auto &block : ts.blks) {
+      if (!block.ticket || block.timestamp <= min_timestamp) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool TsSync::checkSignatures(const Tipset &ts) const {
+    if (bls) {
+      for (auto &block : ts.blks) {
+        if (!checkBlsAggregate(block)) {
+          return false;
         }
-        for (auto &child : _children->second) {
-          queue.push_back(std::move(child));
-        }
-        children.erase(_children);
       }
     }
+    if (!secp) {
+      return true;
+    }
+    auto visited{ts.visitMessages(
+        ipld, [&](auto, auto bls, auto &cid) -> outcome::result<void> {
+          if (bls) {
+            return outcome::success();
+          }
+          OUTCOME_TRY(message, ipld->getCbor<SignedMessage>(cid));
+          if (!message.message.from.isKeyType()) {
+            // id address is resolved on execution
+            return outcome::success();
+          }
+          OUTCOME_TRY(ok, secp->verify(message, message.message.from));
+          if (!ok) {
+            return blocksync::Error::kInconsistent;
+          }
+          return outcome::success();
+        })};
+    return visited.has_value();
+  }
+
+  outcome::result<void> TsSync::checkBlsAggregate(
+      const BlockHeader &block) const {
+    OUTCOME_TRY(meta, ipld->getCbor<MsgMeta>(block.messages));
+    std::vector<Buffer> messages;
+    std::vector<crypto::bls::PublicKey> keys;
+    auto resolved{true};
+    OUTCOME_TRY(meta.bls_messages.visit(
+        [&](auto, auto &cid) -> outcome::result<void> {
+          OUTCOME_TRY(message, ipld->getCbor<UnsignedMessage>(cid));
+          if (message.from.data.type() != typeid(BLSPublicKeyHash)) {
+            // id address is resolved on execution
+            resolved = false;
+            return outcome::success();
+          }
+          OUTCOME_TRY(bytes, cid.toBytes());
+          messages.emplace_back(std::move(bytes));
+          auto &hash{boost::get<BLSPublicKeyHash>(message.from.data)};
+          auto &key{keys.emplace_back()};
+          std::copy_n(hash.begin(), key.size(), key.begin());
+          return outcome::success();
+        }));
+    if (messages.empty() || !resolved) {
+      return outcome::success();
+    }
+    auto aggregate{block.bls_aggregate
+                       ? boost::get<crypto::bls::Signature>(
+                           &*block.bls_aggregate)
+                       : nullptr};
+    if (!aggregate) {
+      return blocksync::Error::kInconsistent;
+    }
+    std::vector<gsl::span<const uint8_t>> spans{messages.begin(),
+                                                messages.end()};
+    OUTCOME_TRY(valid, bls->verifyAggregate(spans, keys, *aggregate));
+    if (!valid) {
+      return blocksync::Error::kInconsistent;
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> TsSync::interpret(const TipsetKey &key,
+                                          const Tipset &ts) {
+    if (executed.has(key)) {
+      return outcome::success();
+    }
+    // weight depends on parent state, which is already summarized when
+    // parent was executed by this sync
+    blockchain::weight::WeightCalculatorImpl weighter{ipld, power_summaries};
+    OUTCOME_TRY(weight, weighter.calculateWeight(ts));
+    OUTCOME_TRY(vm, interpreter->interpret(ipld, ts));
+    // summarize new state while its nodes are hot, children weights need it
+    OUTCOME_TRY(power_summaries->get(vm.state_root));
+    executed.emplace(key, Executed{std::move(vm), std::move(weight)});
+    executed_memory.set(metrics::containerBytes(
+        executed, sizeof(TipsetKey) + sizeof(Executed)));
+    return outcome::success();
   }
 
   Sync::Sync(IpldPtr ipld,
              std::shared_ptr<TsSync> ts_sync,
-             std::shared_ptr<ChainStore> chain_store)
-      : MOVE(ipld), MOVE(ts_sync), MOVE(chain_store) {
-    this->ts_sync->valid.emplace(TipsetKey{this->chain_store->genesisCid()},
-                                 true);
+             std::shared_ptr<ChainStore> chain_store,
+             std::shared_ptr<Mpool> mpool,
+             std::shared_ptr<Graphsync> graphsync)
+      : MOVE(ipld), MOVE(ts_sync), MOVE(chain_store), MOVE(graphsync) {
+    // genesis is final at any checkpoint, so it is valid by chain store
+    this->ts_sync->chain_store = this->chain_store;
+    if (this->graphsync) {
+      this->graphsync->start(
+          storage::ipfs::graphsync::MerkleDagBridge::create(this->ipld),
+          [ipld{this->ipld}](CID cid, Buffer data) {
+            auto type{cid.content_address.getType()};
+            if ((type != HashType::sha256 && type != HashType::blake2b_256)
+                || crypto::Hasher::calculate(type, data)
+                       != cid.content_address) {
+              return;
+            }
+            std::ignore = ipld->set(cid, std::move(data));
+          });
+    }
+    if (mpool) {
+      // cid of message is as in block, mpool also keeps both in ipld
+      mpool_sub = mpool->subscribe([this](const MpoolUpdate &update) {
+        auto cid{update.message.getCid()};
+        std::lock_guard lock{mpool_mutex};
+        if (update.type == MpoolUpdate::Type::ADD) {
+          mpool_messages.insert(std::move(cid));
+        } else {
+          mpool_messages.erase(cid);
+        }
+      });
+    }
+  }
+
+  blockchain::sync_manager::SyncManagerImpl &Sync::syncManager() {
+    if (manager) {
+      return *manager;
+    }
+    using blockchain::sync_manager::SyncManagerError;
+    manager = std::make_shared<blockchain::sync_manager::SyncManagerImpl>(
+        *ts_sync->io,
+        [weak{weak_from_this()}](auto &ts, auto &peer, auto cb) {
+          auto self{weak.lock()};
+          if (!self) {
+            return cb(SyncManagerError::kInvalid);
+          }
+          self->ts_sync->sync(
+              TipsetKey{ts.cids},
+              ts.height,
+              peer,
+              [weak, cb](auto &key, auto valid) {
+                auto self{weak.lock()};
+                if (!self || !valid) {
+                  return cb(SyncManagerError::kInvalid);
+                }
+                auto _ts{Tipset::load(*self->ipld, key.cids)};
+                if (!_ts) {
+                  return cb(_ts.error());
+                }
+                cb(self->chain_store->updateHeaviestTipset(_ts.value()));
+              });
+        },
+        [weak{weak_from_this()}](auto &ts, auto &peer, auto done) {
+          auto self{weak.lock()};
+          if (!self) {
+            return done();
+          }
+          self->ts_sync->prefetch(TipsetKey{ts.cids}, peer, std::move(done));
+        });
+    return *manager;
   }
 
   void Sync::onHello(const TipsetKey &key, const PeerId &peer) {
-    ts_sync->sync(key, peer, [self{shared_from_this()}](auto &key, auto valid) {
-      if (valid) {
-        OUTCOME_EXCEPT(ts, Tipset::load(*self->ipld, key.cids));
-        std::ignore = self->chain_store->updateHeaviestTipset(ts);
-      }
-    });
+    // head header is needed to bucket it by chain and weight
+    auto _ts{Tipset::load(*ipld, key.cids)};
+    if (_ts) {
+      std::ignore = syncManager().setPeerHead(peer, _ts.value());
+      return;
+    }
+    blocksync::fetchHeaders(
+        ts_sync->host,
+        {peer, {}},
+        ts_sync->ipld,
+        key.cids,
+        1,
+        [self{shared_from_this()}, peer](auto _chain) {
+          if (_chain && !_chain.value().empty()) {
+            std::ignore =
+                self->syncManager().setPeerHead(peer, _chain.value().front());
+          }
+        },
+        ts_sync->scores);
   }
 
   outcome::result<void> Sync::onGossip(const BlockWithCids &block,
                                        const PeerId &peer) {
     OUTCOME_TRY(have_messages, ipld->contains(block.header.messages));
     if (!have_messages) {
-      MsgMeta messages;
-      ipld->load(messages);
-      auto collect_messages{
-          [&](auto &cids, auto &array) -> outcome::result<bool> {
-            for (auto &cid : cids) {
-              OUTCOME_TRY(array.append(cid));
-              OUTCOME_TRY(have, ipld->contains(cid));
-              if (!have) {
-                return false;
-              }
-            }
-            return true;
-          }};
-      OUTCOME_TRY(have_bls,
-                  collect_messages(block.bls_messages, messages.bls_messages));
-      OUTCOME_TRY(
-          have_secp,
-          collect_messages(block.secp_messages, messages.secp_messages));
-      if (have_bls && have_secp) {
-        OUTCOME_TRY(messages_cid, ipld->setCbor(messages));
-        if (messages_cid != block.header.messages) {
-          return blocksync::Error::kInconsistent;
-        }
+      OUTCOME_TRY(missing, missingMessages(block));
+      if (!missing.empty() && graphsync) {
+        OUTCOME_TRY(cid, ts_sync->ipld->setCbor(block.header));
+        fetchMessages(
+            std::make_shared<BlockWithCids>(block), cid, peer, missing);
+        return outcome::success();
+      }
+      if (missing.empty()) {
+        OUTCOME_TRY(putMessages(block));
       }
     }
     OUTCOME_TRY(cid, ts_sync->ipld->setCbor(block.header));
+    syncBlock(cid, block.header, peer);
+    return outcome::success();
+  }
+
+  outcome::result<std::vector<CID>> Sync::missingMessages(
+      const BlockWithCids &block) {
+    std::vector<CID> missing;
+    auto collect{[&](auto &cids) -> outcome::result<void> {
+      for (auto &cid : cids) {
+        {
+          std::lock_guard lock{mpool_mutex};
+          if (mpool_messages.find(cid) != mpool_messages.end()) {
+            continue;
+          }
+        }
+        OUTCOME_TRY(have, ipld->contains(cid));
+        if (!have) {
+          missing.push_back(cid);
+        }
+      }
+      return outcome::success();
+    }};
+    OUTCOME_TRY(collect(block.bls_messages));
+    OUTCOME_TRY(collect(block.secp_messages));
+    return missing;
+  }
+
+  outcome::result<void> Sync::putMessages(const BlockWithCids &block) {
+    MsgMeta messages;
+    ipld->load(messages);
+    for (auto &cid : block.bls_messages) {
+      OUTCOME_TRY(messages.bls_messages.append(cid));
+    }
+    for (auto &cid : block.secp_messages) {
+      OUTCOME_TRY(messages.secp_messages.append(cid));
+    }
+    OUTCOME_TRY(messages_cid, ipld->setCbor(messages));
+    if (messages_cid != block.header.messages) {
+      return blocksync::Error::kInconsistent;
+    }
+    return outcome::success();
+  }
+
+  void Sync::fetchMessages(std::shared_ptr<BlockWithCids> block,
+                           const CID &cid,
+                           const PeerId &peer,
+                           const std::vector<CID> &missing) {
+    auto &requests{fetches[cid]};
+    if (!requests.empty()) {
+      return;
+    }
+    // requests left, zero when fetch finished or timed out
+    auto pending{std::make_shared<size_t>(missing.size())};
+    auto timer{std::make_shared<boost::asio::steady_timer>(*ts_sync->io)};
+    for (auto &message : missing) {
+      // progress is reported on network thread, so it is posted to io
+      requests.push_back(graphsync->makeRequest(
+          peer,
+          boost::none,
+          message,
+          storage::ipld::kMatcherSelector.raw,
+          {},
+          [weak{weak_from_this()}, block, cid, peer, pending, timer](
+              auto code, auto) {
+            if (!storage::ipfs::graphsync::isTerminal(code)) {
+              return;
+            }
+            auto self{weak.lock()};
+            if (!self) {
+              return;
+            }
+            boost::asio::post(
+                *self->ts_sync->io,
+                [self, block, cid, peer, pending, timer] {
+                  if (*pending == 0 || --*pending != 0) {
+                    return;
+                  }
+                  timer->cancel();
+                  self->onMessagesFetched(block, cid, peer);
+                });
+          }));
+    }
+    timer->expires_after(fetch_timeout);
+    timer->async_wait(
+        [weak{weak_from_this()}, block, cid, peer, pending](auto ec) {
+          auto self{weak.lock()};
+          if (ec || !self || *pending == 0) {
+            return;
+          }
+          *pending = 0;
+          self->onMessagesFetched(block, cid, peer);
+        });
+  }
+
+  void Sync::onMessagesFetched(const std::shared_ptr<BlockWithCids> &block,
+                               const CID &cid,
+                               const PeerId &peer) {
+    // cancels requests left after timeout
+    fetches.erase(cid);
+    // messages still missing are fetched by ts_sync
+    auto missing{missingMessages(*block)};
+    if (missing && missing.value().empty()) {
+      std::ignore = putMessages(*block);
+    }
+    syncBlock(cid, block->header, peer);
+  }
+
+  void Sync::syncBlock(const CID &cid,
+                       const BlockHeader &block,
+                       const PeerId &peer) {
     ts_sync->sync({cid},
+                  block.height,
                   peer,
-                  [self{shared_from_this()}, block{std::move(block.header)}](
-                      auto &, auto valid) {
+                  [self{shared_from_this()}, block](auto &, auto valid) {
                     if (valid) {
                       std::ignore = self->chain_store->addBlock(block);
                     }
                   });
-    return outcome::success();
   }
 }  // namespace fc::sync
@@ -5,49 +5,282 @@
 
 #pragma once
 
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/signals2/connection.hpp>
+#include <libp2p/protocol/common/subscription.hpp>
+
+#include "blockchain/impl/sync_manager_impl.hpp"
+#include "common/generational_map.hpp"
+#include "metrics/memory.hpp"
 #include "node/fwd.hpp"
+#include "primitives/big_int.hpp"
 #include "primitives/tipset/tipset_key.hpp"
+#include "vm/actor/builtin/storage_power/power_summary.hpp"
+#include "vm/interpreter/interpreter.hpp"
 
 namespace fc::sync {
   using libp2p::Host;
   using libp2p::peer::PeerId;
   using primitives::block::BlockWithCids;
+  using primitives::tipset::Tipset;
   using primitives::tipset::TipsetKey;
+  using libp2p::protocol::Subscription;
+  using peermgr::PeerScores;
   using storage::blockchain::ChainStore;
+  using storage::ipfs::graphsync::Graphsync;
+  using storage::mpool::Mpool;
+  using crypto::bls::BlsProvider;
+  using vm::message::SecpVerifier;
   using vm::interpreter::Interpreter;
 
+  /**
+   * Tipsets this many epochs below heaviest are final, their bookkeeping is
+   * dropped and their validity is answered by chain store
+   */
+  constexpr uint64_t kSyncFinality{900};
+  /// Execution results kept per generation, evicted parent is executed again
+  constexpr size_t kExecutedGeneration{1 << 12};
+  /// Prefetched tipsets kept per generation
+  constexpr size_t kPrefetchedGeneration{1 << 14};
+  /// Stored tipsets walked by prefetch before yielding io thread
+  constexpr size_t kPrefetchWalkStep{100};
+  /// Gossiped block is synced with messages fetched within this time
+  constexpr std::chrono::seconds kGossipFetchTimeout{10};
+
+  /**
+   * Validity of tipsets above finality checkpoint, indexed by height so
+   * entries are dropped as checkpoint advances
+   */
+  struct ValidTipsets {
+    boost::optional<bool> find(const TipsetKey &key) const;
+    bool has(const TipsetKey &key) const;
+    void emplace(const TipsetKey &key, uint64_t height, bool valid);
+    /// Drops entries below height
+    void prune(uint64_t height);
+    size_t size() const;
+
+    std::unordered_map<TipsetKey, bool> valid;
+    std::map<uint64_t, std::vector<TipsetKey>> heights;
+  };
+
+  /**
+   * Syncs chain to tipset.
+   * Walks down fetching headers only, down to valid tipset. Messages are
+   * backfilled in ranges from lowest tipsets, several ranges in flight, and
+   * tipsets are validated up in stages as their messages land:
+   * header and signature checks run on pool as soon as tipset is fetched,
+   * execution runs on pool strand in chain order reusing parent result, and
+   * validity is reported on io thread. Ipld must support concurrent access.
+   */
   struct TsSync : public std::enable_shared_from_this<TsSync> {
     using Callback = std::function<void(const TipsetKey &, bool)>;
 
     TsSync(std::shared_ptr<Host> host,
            IpldPtr ipld,
-           std::shared_ptr<Interpreter> interpreter);
-    void sync(const TipsetKey &key, const PeerId &peer, Callback callback);
+           std::shared_ptr<Interpreter> interpreter,
+           std::shared_ptr<boost::asio::io_context> io,
+           std::shared_ptr<boost::asio::thread_pool> pool,
+           std::shared_ptr<SecpVerifier> secp,
+           std::shared_ptr<BlsProvider> bls);
+    /// @param height - height of tipset, kept to prune callback without load
+    void sync(const TipsetKey &key,
+              uint64_t height,
+              const PeerId &peer,
+              Callback callback);
     void walkDown(TipsetKey key, const PeerId &peer);
+    /**
+     * Fetches headers down to stored chain without checks, so later sync of
+     * tipset only fetches messages.
+     * Walk of stored headers is posted to io in steps of kPrefetchWalkStep.
+     */
+    void prefetch(TipsetKey key,
+                  const PeerId &peer,
+                  std::function<void()> done);
+    /**
+     * Fetches headers from best peer, request is hedged to next peer if
+     * it is slower than expected or fails
+     */
+    void fetchHeaders(TipsetKey key, const PeerId &peer);
+    /**
+     * Peers for request, announcing peer only without scores
+     * @param bytes - expected response size
+     */
+    std::vector<PeerId> rankPeers(const PeerId &peer,
+                                  size_t bytes,
+                                  size_t count) const;
+    /// Requests ranges of tipsets missing messages while slots are free
+    void fetchMessages(const PeerId &peer);
+    /// Takes lowest tipset missing messages and its walked descendants
+    boost::optional<std::vector<Tipset>> nextMessagesRange();
     void walkUp(TipsetKey key);
+    /**
+     * Validity from window above checkpoint, or from chain store for final
+     * tipsets, which are valid only on heaviest chain
+     * @param height - height of tipset if known, tipset is loaded otherwise
+     * @return none when unknown
+     */
+    boost::optional<bool> isValid(
+        const TipsetKey &key, boost::optional<uint64_t> height = boost::none);
+    /// Drops bookkeeping below checkpoint when heaviest tipset advanced it
+    void prune();
+    /// Reports approximate memory of io thread state
+    void account();
+
+    /// Starts checks of fetched tipset on pool
+    void check(TipsetKey parent, TipsetKey key);
+    /// Receives check result on io thread
+    void onChecked(TipsetKey key, bool ok);
+    /// Executes checked tipset after its parent was validated
+    void validate(TipsetKey parent, TipsetKey key);
+    void execute(TipsetKey parent, TipsetKey key, bool ok);
+    /// Checks not depending on parent state, called on pool
+    bool checkHeaders(const Tipset &parent, const Tipset &ts) const;
+    bool checkSignatures(const Tipset &ts) const;
+    /// Checks aggregate signature of block bls messages
+    outcome::result<void> checkBlsAggregate(
+        const primitives::block::BlockHeader &block) const;
+    /**
+     * Interprets loaded tipset and computes its weight once, result is kept
+     * for validation of children, called on strand
+     */
+    outcome::result<void> interpret(const TipsetKey &key, const Tipset &ts);
 
     std::shared_ptr<Host> host;
     IpldPtr ipld;
     std::shared_ptr<Interpreter> interpreter;
-    std::unordered_map<TipsetKey, std::vector<Callback>> callbacks;
-    std::unordered_map<TipsetKey, std::vector<TipsetKey>> children;
+    std::shared_ptr<boost::asio::io_context> io;
+    std::shared_ptr<boost::asio::thread_pool> pool;
+    /// Optional, secp message signatures are not checked without it
+    std::shared_ptr<SecpVerifier> secp;
+    /// Optional, bls aggregate signatures are not checked without it
+    std::shared_ptr<BlsProvider> bls;
+    /// Optional, requests go to best scored peers with it
+    std::shared_ptr<PeerScores> scores;
+    /// Optional, bookkeeping is not pruned without it
+    std::shared_ptr<ChainStore> chain_store;
+    /// Network power of parent states, shared by weight calculations
+    std::shared_ptr<vm::actor::builtin::storage_power::PowerSummaries>
+        power_summaries;
+    boost::asio::strand<boost::asio::thread_pool::executor_type> strand;
+    /// Callbacks of synced tipset with its height
+    struct Pending {
+      uint64_t height{};
+      std::vector<Callback> callbacks;
+    };
+    std::unordered_map<TipsetKey, Pending> callbacks;
+    /// Walked child of tipset, height lets it be pruned without loading
+    struct Child {
+      TipsetKey key;
+      uint64_t height{};
+    };
+    std::unordered_map<TipsetKey, std::vector<Child>> children;
+    /// Peers to spread range requests over
+    std::vector<PeerId> peers;
+    /// Tipsets with headers requested, walk continues when range lands
+    std::unordered_set<TipsetKey> fetching;
+    /// Walked tipsets without messages by height
+    std::map<uint64_t, std::unordered_set<TipsetKey>> missing_messages;
+    /// Messages range, each tipset followed by its parent
+    struct MessagesRange {
+      std::vector<Tipset> chain;
+      size_t attempts{};
+    };
+    std::deque<MessagesRange> retry_messages;
+    size_t messages_in_flight{};
+    size_t next_messages_peer{};
+    /// Tipsets with all parent headers stored, prefetch stops at them
+    common::GenerationalMap<TipsetKey, bool> prefetched{
+        kPrefetchedGeneration};
 
-    // TODO: component, persistent/caching
-    std::unordered_map<TipsetKey, bool> valid;
+    /// Check results of tipsets waiting for parent validation
+    std::unordered_map<TipsetKey, bool> checked;
+    /// Validated parents of tipsets with checks in progress
+    std::unordered_map<TipsetKey, TipsetKey> waiting;
+
+    /// Execution result of valid tipset
+    struct Executed {
+      vm::interpreter::Result vm;
+      primitives::BigInt weight;
+    };
+    /// Accessed on strand only
+    common::GenerationalMap<TipsetKey, Executed> executed{kExecutedGeneration};
+    metrics::MemoryShare executed_memory{"sync"};
+
+    /// Validity of tipsets above checkpoint, accessed on io thread
+    ValidTipsets valid;
+    /// Height of heaviest tipset minus finality, at last prune
+    uint64_t checkpoint{};
+    metrics::MemoryShare memory{"sync"};
   };
 
+  /**
+   * Syncs to tipsets from hello and blocks from gossip.
+   * Hello heads go to sync manager, which syncs heaviest chain while headers
+   * of other chains are prefetched.
+   * Messages of gossiped block are looked up in mpool and ipld, and only
+   * missing ones are requested from gossiping peer, so block with messages
+   * from mpool is validated without network round trip.
+   */
   struct Sync : public std::enable_shared_from_this<Sync> {
+    /**
+     * @param mpool - optional, its messages are tracked as available
+     * @param graphsync - optional, started with callback storing blocks
+     * matching their cids to ipld, missing messages are left to ts_sync
+     * without it
+     */
     Sync(IpldPtr ipld,
          std::shared_ptr<TsSync> ts_sync,
-         std::shared_ptr<ChainStore> chain_store);
+         std::shared_ptr<ChainStore> chain_store,
+         std::shared_ptr<Mpool> mpool = nullptr,
+         std::shared_ptr<Graphsync> graphsync = nullptr);
     void onHello(const TipsetKey &key, const PeerId &peer);
     outcome::result<void> onGossip(const BlockWithCids &block,
                                    const PeerId &peer);
+    /// Messages of block which are neither in mpool nor in ipld
+    outcome::result<std::vector<CID>> missingMessages(
+        const BlockWithCids &block);
+    /// Stores message meta of block with all messages available
+    outcome::result<void> putMessages(const BlockWithCids &block);
+    /**
+     * Requests missing messages from peer in parallel, block is synced when
+     * all requests finish or after fetch timeout
+     */
+    void fetchMessages(std::shared_ptr<BlockWithCids> block,
+                       const CID &cid,
+                       const PeerId &peer,
+                       const std::vector<CID> &missing);
+    /// Clears requests of block and syncs it, called once per fetch
+    void onMessagesFetched(const std::shared_ptr<BlockWithCids> &block,
+                           const CID &cid,
+                           const PeerId &peer);
+    /// Creates sync manager on first use, its callbacks don't extend lifetime
+    blockchain::sync_manager::SyncManagerImpl &syncManager();
+    /// Syncs to stored block and adds it to chain store when valid
+    void syncBlock(const CID &cid,
+                   const primitives::block::BlockHeader &block,
+                   const PeerId &peer);
 
     IpldPtr ipld;
     std::shared_ptr<TsSync> ts_sync;
     std::shared_ptr<ChainStore> chain_store;
+    std::shared_ptr<Graphsync> graphsync;
+    std::shared_ptr<blockchain::sync_manager::SyncManagerImpl> manager;
+    boost::signals2::scoped_connection mpool_sub;
+    /// Cids of signed and unsigned messages in mpool, updated by mpool
+    std::mutex mpool_mutex;
+    std::unordered_set<CID> mpool_messages;
+    /// Message requests of gossiped blocks, by block cid
+    std::unordered_map<CID, std::vector<Subscription>> fetches;
+    /// Time given to message requests of gossiped block
+    std::chrono::milliseconds fetch_timeout{kGossipFetchTimeout};
   };
 }  // namespace fc::sync
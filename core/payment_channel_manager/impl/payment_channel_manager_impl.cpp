@@ -49,11 +49,12 @@ namespace fc::payment_channel_manager {
 
   outcome::result<LaneId> PaymentChannelManagerImpl::allocateLane(
       const Address &channel_address) {
-    std::unique_lock lock(channels_mutex_);
+    std::shared_lock lock(channels_mutex_);
     auto lookup = channels_.find(channel_address);
     if (lookup == channels_.end()) {
       return PaymentChannelManagerError::kChannelNotFound;
     }
+    std::lock_guard channel_lock{*lookup->second.mutex};
     lookup->second.lanes.try_emplace(lookup->second.next_lane++);
     return lookup->second.next_lane;
   }
@@ -67,11 +68,12 @@ namespace fc::payment_channel_manager {
     new_voucher.lane = lane;
     new_voucher.amount = amount;
 
-    std::unique_lock lock(channels_mutex_);
+    std::shared_lock lock(channels_mutex_);
     auto lookup_channel = channels_.find(channel_address);
     if (lookup_channel == channels_.end()) {
       return PaymentChannelManagerError::kChannelNotFound;
     }
+    std::lock_guard channel_lock{*lookup_channel->second.mutex};
     OUTCOME_TRYA(new_voucher.nonce, getNextNonce(lookup_channel->second, lane));
 
     // sign voucher
@@ -88,24 +90,34 @@ namespace fc::payment_channel_manager {
 
   outcome::result<TokenAmount> PaymentChannelManagerImpl::savePaymentVoucher(
       const Address &channel_address, const SignedVoucher &voucher) {
-    OUTCOME_TRY(validateVoucher(channel_address, voucher));
-    OUTCOME_TRY(payment_channel_actor_state,
-                loadPaymentChannelActorState(channel_address));
-    std::unique_lock lock(channels_mutex_);
+    OUTCOME_TRY(view, loadChannelView(channel_address));
+    OUTCOME_TRY(validateVoucher(*view, voucher));
+    const auto &payment_channel_actor_state{view->state};
 
     // add channel to local storage if hasn't been added yet
+    std::shared_lock lock(channels_mutex_);
     auto channel_lookup = channels_.find(channel_address);
     if (channel_lookup == channels_.end()) {
-      saveChannel(channel_address,
-                  payment_channel_actor_state.from,
-                  payment_channel_actor_state.to);
+      lock.unlock();
+      {
+        std::unique_lock insert_lock(channels_mutex_);
+        if (channels_.find(channel_address) == channels_.end()) {
+          saveChannel(channel_address,
+                      payment_channel_actor_state.from,
+                      payment_channel_actor_state.to);
+        }
+      }
+      lock.lock();
       channel_lookup = channels_.find(channel_address);
     }
 
-    // insert if no duplicates
-    auto lanes = channel_lookup->second.lanes[voucher.lane];
-    if (find(lanes.begin(), lanes.end(), voucher) == lanes.end()) {
-      channel_lookup->second.lanes[voucher.lane].push_back(voucher);
+    {
+      // insert if no duplicates
+      std::lock_guard channel_lock{*channel_lookup->second.mutex};
+      auto &lanes = channel_lookup->second.lanes[voucher.lane];
+      if (find(lanes.begin(), lanes.end(), voucher) == lanes.end()) {
+        lanes.push_back(voucher);
+      }
     }
 
     // get redeemed
@@ -120,8 +132,13 @@ namespace fc::payment_channel_manager {
 
   outcome::result<void> PaymentChannelManagerImpl::validateVoucher(
       const Address &channel_address, const SignedVoucher &voucher) const {
-    OUTCOME_TRY(payment_channel_actor_state,
-                loadPaymentChannelActorState(channel_address));
+    OUTCOME_TRY(view, loadChannelView(channel_address));
+    return validateVoucher(*view, voucher);
+  }
+
+  outcome::result<void> PaymentChannelManagerImpl::validateVoucher(
+      const ChannelStateView &view, const SignedVoucher &voucher) const {
+    const auto &payment_channel_actor_state{view.state};
 
     // check signature
     if (!voucher.signature.has_value()) {
@@ -154,9 +171,7 @@ namespace fc::payment_channel_manager {
     // check amount
     auto total_amoun =
         payment_channel_actor_state.to_send + voucher_send_amount;
-    OUTCOME_TRY(payment_channel_actor_balance,
-                api_->WalletBalance(channel_address));
-    if (payment_channel_actor_balance < total_amoun) {
+    if (view.balance < total_amoun) {
       return PaymentChannelManagerError::kInsufficientFunds;
     }
 
@@ -289,6 +304,42 @@ namespace fc::payment_channel_manager {
     return state_tree->state<PaymentChannelState>(channel_address);
   }
 
+  outcome::result<std::shared_ptr<const ChannelStateView>>
+  PaymentChannelManagerImpl::loadChannelView(
+      const Address &channel_address) const {
+    OUTCOME_TRY(tipset, api_->ChainHead());
+    auto state_root{tipset.getParentStateRoot()};
+    std::shared_ptr<const ChannelStateView> cached;
+    {
+      std::lock_guard lock{channel_views_mutex_};
+      auto it{channel_views_.find(channel_address)};
+      if (it != channel_views_.end()) {
+        cached = it->second;
+      }
+    }
+    if (cached && cached->state_root == state_root) {
+      return cached;
+    }
+
+    StateTreeImpl state_tree{ipld_, state_root};
+    OUTCOME_TRY(actor, state_tree.get(channel_address));
+    auto view{std::make_shared<ChannelStateView>()};
+    if (cached && cached->head == actor.head) {
+      *view = *cached;
+    } else {
+      OUTCOME_TRYA(view->state,
+                   ipld_->getCbor<PaymentChannelState>(actor.head));
+      view->head = actor.head;
+    }
+    view->state_root = state_root;
+    view->balance = actor.balance;
+    {
+      std::lock_guard lock{channel_views_mutex_};
+      channel_views_[channel_address] = view;
+    }
+    return view;
+  }
+
   outcome::result<uint64_t> PaymentChannelManagerImpl::getNextNonce(
       const ChannelInfo &channel, const LaneId &lane) const {
     auto lookup_lane = channel.lanes.find(lane);
@@ -6,6 +6,7 @@
 #ifndef CPP_FILECOIN_PAYCHANNEL_MANAGER_PAYCHANNEL_MANAGER_IMPL_HPP
 #define CPP_FILECOIN_PAYCHANNEL_MANAGER_PAYCHANNEL_MANAGER_IMPL_HPP
 
+#include <mutex>
 #include <shared_mutex>
 #include "api/api.hpp"
 #include "common/buffer.hpp"
@@ -25,6 +26,17 @@ namespace fc::payment_channel_manager {
     Address target;
     std::map<LaneId, std::vector<SignedVoucher>> lanes;
     LaneId next_lane;
+    /// Guards lanes, so vouchers of different channels don't wait each other
+    std::shared_ptr<std::mutex> mutex{std::make_shared<std::mutex>()};
+  };
+
+  /// Payment channel actor state read at state root
+  struct ChannelStateView {
+    CID state_root;
+    /// Actor head, state is decoded again only if head changes
+    CID head;
+    PaymentChannelState state;
+    TokenAmount balance;
   };
 
   class PaymentChannelManagerImpl
@@ -98,6 +110,24 @@ namespace fc::payment_channel_manager {
     outcome::result<PaymentChannelState> loadPaymentChannelActorState(
         const Address &channel_address) const;
 
+    /**
+     * Loads payment channel actor state and balance at chain head, cached
+     * view is reused while state root or actor head are same
+     * @param channel_address payment channel actor address
+     * @return payment channel actor state view
+     */
+    outcome::result<std::shared_ptr<const ChannelStateView>> loadChannelView(
+        const Address &channel_address) const;
+
+    /**
+     * Validates voucher against channel state view
+     * @param view of channel actor state
+     * @param voucher to validate
+     * @return error if voucher is not valid
+     */
+    outcome::result<void> validateVoucher(const ChannelStateView &view,
+                                          const SignedVoucher &voucher) const;
+
     /**
      * Get next nonce for lane in channel info
      * @param channel info
@@ -114,7 +144,11 @@ namespace fc::payment_channel_manager {
      * ChannelInfo)
      */
     std::map<Address, ChannelInfo> channels_;
+    /// Unique lock inserts channels, lanes are guarded by channel mutex
     mutable std::shared_mutex channels_mutex_;
+    mutable std::map<Address, std::shared_ptr<const ChannelStateView>>
+        channel_views_;
+    mutable std::mutex channel_views_mutex_;
   };
 
 }  // namespace fc::payment_channel_manager
@@ -6,15 +6,16 @@
 #include "power/impl/power_table_impl.hpp"
 
 #include "power/power_table_error.hpp"
-#include "primitives/address/address_codec.hpp"
 
 namespace fc::power {
 
+  PowerTableImpl::PowerTableImpl()
+      : power_table_{std::make_shared<Powers>()} {}
+
   outcome::result<Power> PowerTableImpl::getMinerPower(
       const primitives::address::Address &address) const {
-    auto result =
-        power_table_.find(primitives::address::encodeToString(address));
-    if (result == power_table_.end()) {
+    auto result = power_table_->find(address);
+    if (result == power_table_->end()) {
       return outcome::failure(PowerTableError::kNoSuchMiner);
     }
 
@@ -24,30 +25,31 @@ namespace fc::power {
   outcome::result<void> PowerTableImpl::setMinerPower(
       const primitives::address::Address &address, Power power_amount) {
     if (power_amount < 0) return PowerTableError::kNegativePower;
-    power_table_[primitives::address::encodeToString(address)] = power_amount;
+    mutablePowers()[address] = std::move(power_amount);
     return outcome::success();
   }
 
   outcome::result<void> PowerTableImpl::removeMiner(
       const primitives::address::Address &address) {
-    if (power_table_.erase(primitives::address::encodeToString(address)) == 0)
+    if (power_table_->find(address) == power_table_->end())
       return PowerTableError::kNoSuchMiner;
 
+    mutablePowers().erase(address);
     return outcome::success();
   }
 
   fc::outcome::result<size_t> PowerTableImpl::getSize() const {
-    return power_table_.size();
+    return power_table_->size();
   }
 
   fc::outcome::result<Power> PowerTableImpl::getMaxPower() const {
-    if (power_table_.empty()) return 0;
+    if (power_table_->empty()) return 0;
 
-    auto res = std::max(power_table_.cbegin(),
-                        power_table_.cend(),
-                        [&](const auto &rhs, const auto &lhs) {
-                          return rhs->second < lhs->second;
-                        });
+    auto res = std::max_element(power_table_->cbegin(),
+                                power_table_->cend(),
+                                [&](const auto &lhs, const auto &rhs) {
+                                  return lhs.second < rhs.second;
+                                });
 
     return res->second;
   }
@@ -55,12 +57,29 @@ namespace fc::power {
   outcome::result<std::vector<primitives::address::Address>>
   PowerTableImpl::getMiners() const {
     std::vector<primitives::address::Address> result;
-    result.reserve(power_table_.size());
-    for (const auto &elem : power_table_) {
-      OUTCOME_TRY(miner_addr,
-                  primitives::address::decodeFromString(elem.first));
-      result.push_back(miner_addr);
+    result.reserve(power_table_->size());
+    for (const auto &elem : *power_table_) {
+      result.push_back(elem.first);
     }
     return result;
   }
+
+  std::shared_ptr<PowerTableImpl> PowerTableImpl::snapshot() const {
+    auto table{std::make_shared<PowerTableImpl>()};
+    table->power_table_ = power_table_;
+    return table;
+  }
+
+  const PowerTableImpl::Powers &PowerTableImpl::powers() const {
+    return *power_table_;
+  }
+
+  PowerTableImpl::Powers &PowerTableImpl::mutablePowers() {
+    // snapshot may be released concurrently, then powers are copied once
+    // without need
+    if (power_table_.use_count() != 1) {
+      power_table_ = std::make_shared<Powers>(*power_table_);
+    }
+    return *power_table_;
+  }
 }  // namespace fc::power
@@ -11,8 +11,18 @@
 
 namespace fc::power {
 
+  /**
+   * In-memory power table keyed by address.
+   * Powers are shared with snapshots and copied on first change of table
+   * which shares them, so snapshots are cheap views of table at some point.
+   * Concurrent reads are safe, changes require exclusive access to table.
+   */
   class PowerTableImpl : public PowerTable {
    public:
+    using Powers = std::unordered_map<Address, Power>;
+
+    PowerTableImpl();
+
     outcome::result<Power> getMinerPower(
         const primitives::address::Address &address) const override;
 
@@ -30,8 +40,17 @@ namespace fc::power {
     outcome::result<std::vector<primitives::address::Address>> getMiners()
         const override;
 
+    /// Table with current powers, not affected by later changes of this one
+    std::shared_ptr<PowerTableImpl> snapshot() const;
+
+    /// Current powers without copying them
+    const Powers &powers() const;
+
    private:
-    std::unordered_map<std::string, Power> power_table_;
+    /// Copies powers if they are shared with snapshot
+    Powers &mutablePowers();
+
+    std::shared_ptr<Powers> power_table_;
   };
 
 }  // namespace fc::power
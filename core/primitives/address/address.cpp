@@ -5,6 +5,8 @@
 
 #include "primitives/address/address.hpp"
 
+#include <boost/functional/hash.hpp>
+
 #include "common/visitor.hpp"
 #include "crypto/blake2/blake2b160.hpp"
 
@@ -113,4 +115,16 @@ namespace fc::primitives::address {
                        && lhs.data < rhs.data)));
   }
 
+  size_t hash_value(const Address &address) {
+    size_t seed{address.network};
+    boost::hash_combine(seed, address.data.which());
+    visit_in_place(
+        address.data,
+        [&](uint64_t id) { boost::hash_combine(seed, id); },
+        [&](const auto &hash) {
+          boost::hash_range(seed, hash.begin(), hash.end());
+        });
+    return seed;
+  }
+
 };  // namespace fc::primitives::address
@@ -112,8 +112,19 @@ namespace fc::primitives::address {
   bool operator<(const Address &lhs, const Address &rhs);
 
   std::string encodeToString(const Address &address);
+
+  size_t hash_value(const Address &address);
 };  // namespace fc::primitives::address
 
+namespace std {
+  template <>
+  struct hash<fc::primitives::address::Address> {
+    size_t operator()(const fc::primitives::address::Address &address) const {
+      return hash_value(address);
+    }
+  };
+}  // namespace std
+
 template <>
 struct fmt::formatter<fc::primitives::address::Address>
     : formatter<std::string_view> {
@@ -9,6 +9,7 @@
 #include <libp2p/multi/uvarint.hpp>
 #include <stdexcept>
 
+#include "common/lru_cache.hpp"
 #include "common/visitor.hpp"
 #include "crypto/blake2/blake2b.h"
 #include "crypto/blake2/blake2b160.hpp"
@@ -23,6 +24,9 @@ namespace fc::primitives::address {
   using base32 = cppcodec::base32_rfc4648;
   using libp2p::multi::UVarint;
 
+  /// Strings of key addresses, which need checksum and base32
+  constexpr size_t kStringCacheSize{1 << 14};
+
   std::vector<uint8_t> encode(const Address &address) noexcept {
     std::vector<uint8_t> res{};
     res.push_back(address.getProtocol());
@@ -88,6 +92,19 @@ namespace fc::primitives::address {
   }
 
   std::string encodeToString(const Address &address) {
+    static common::LruCache<Address, std::string> cache{kStringCacheSize};
+    if (address.isId()) {
+      return encodeToStringUncached(address);
+    }
+    if (auto cached = cache.get(address)) {
+      return std::move(*cached);
+    }
+    auto res = encodeToStringUncached(address);
+    cache.put(address, res);
+    return res;
+  }
+
+  std::string encodeToStringUncached(const Address &address) {
     std::string res{};
 
     char networkPrefix = address.network == Network::TESTNET ? 't' : 'f';
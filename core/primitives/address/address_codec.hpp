@@ -27,10 +27,16 @@ namespace fc::primitives::address {
   outcome::result<Address> decode(gsl::span<const uint8_t> v);
 
   /**
-   * @brief Encodes an Address to a string
+   * @brief Encodes an Address to a string, strings of key addresses are
+   * cached, as their checksum is hashed
    */
   std::string encodeToString(const Address &address);
 
+  /**
+   * @brief Encodes an Address to a string without cache
+   */
+  std::string encodeToStringUncached(const Address &address);
+
   /**
    * @brief Decodes an Address from a string
    */
@@ -43,6 +49,9 @@ namespace fc::primitives::address {
   CBOR_DECODE(Address, address) {
     std::vector<uint8_t> data{};
     s >> data;
+    if (s.error()) {
+      return s;
+    }
     OUTCOME_EXCEPT(decoded, decode(data));
     address = std::move(decoded);
     return s;
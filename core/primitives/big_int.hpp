@@ -8,11 +8,35 @@
 
 #include <boost/multiprecision/cpp_int.hpp>
 
+#include "codec/cbor/cbor_errors.hpp"
 #include "codec/cbor/streams_annotation.hpp"
 
 namespace fc::primitives {
   using BigInt = boost::multiprecision::cpp_int;
 
+  /**
+   * Fixed width integer, which doesn't allocate.
+   * Overflowing operations and conversions throw std::overflow_error or
+   * std::range_error. Encoded to cbor same as BigInt.
+   */
+  using Int256 = boost::multiprecision::checked_int256_t;
+
+  /**
+   * Evaluates f with Int256 operands, and again with BigInt operands if any
+   * operand or intermediate result doesn't fit Int256, so common small
+   * values skip BigInt arithmetic and overflow doesn't change result.
+   * @param f - generic over operand type, returns value of operand type
+   */
+  template <typename F, typename... Args>
+  BigInt checkedMath(const F &f, const Args &... args) {
+    try {
+      return BigInt{f(Int256{args}...)};
+    } catch (const std::overflow_error &) {
+    } catch (const std::range_error &) {
+    }
+    return f(BigInt{args}...);
+  }
+
   /// div with round-floor, like `big.Div` from go
   inline BigInt bigdiv(const BigInt &n, const BigInt &d) {
     if (!n.is_zero() && n.sign() != d.sign()) {
@@ -49,6 +73,33 @@ namespace boost::multiprecision {
     }
     return s;
   }
+
+  CBOR_ENCODE(checked_int256_t, value) {
+    std::vector<uint8_t> bytes;
+    if (value != 0) {
+      bytes.push_back(value < 0 ? 1 : 0);
+      export_bits(value, std::back_inserter(bytes), 8);
+    }
+    return s << bytes;
+  }
+
+  CBOR_DECODE(checked_int256_t, value) {
+    std::vector<uint8_t> bytes;
+    s >> bytes;
+    if (bytes.empty()) {
+      value = 0;
+    } else {
+      // magnitude of Int256 has 256 bits
+      if (bytes.size() - 1 > 32) {
+        fc::outcome::raise(fc::codec::cbor::CborDecodeError::kIntOverflow);
+      }
+      import_bits(value, bytes.begin() + 1, bytes.end());
+      if (bytes[0] == 1) {
+        value = -value;
+      }
+    }
+    return s;
+  }
 }  // namespace boost::multiprecision
 
 #endif  // CPP_FILECOIN_CORE_PRIMITIVES_BIG_INT_HPP
@@ -0,0 +1,77 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_PRIMITIVES_CID_CB_CID_HPP
+#define CPP_FILECOIN_CORE_PRIMITIVES_CID_CB_CID_HPP
+
+#include <cstring>
+#include <variant>
+
+#include <boost/optional.hpp>
+
+#include "common/blob.hpp"
+#include "primitives/cid/cid.hpp"
+
+namespace fc {
+  /**
+   * Hash of CIDv1 DAG-CBOR blake2b-256, which is most of cids, stored inline.
+   * Hash is uniform, so its first bytes are used as hash of key.
+   */
+  struct CbCid : common::Hash256 {
+    CbCid() = default;
+    explicit CbCid(const common::Hash256 &hash) : common::Hash256{hash} {}
+
+    /// Hash of cid if it is CIDv1 DAG-CBOR blake2b-256
+    static boost::optional<CbCid> make(const CID &cid) {
+      if (cid.version != CID::Version::V1
+          || cid.content_type != CID::Multicodec::DAG_CBOR
+          || cid.content_address.getType()
+                 != libp2p::multi::HashType::blake2b_256) {
+        return boost::none;
+      }
+      auto hash{cid.content_address.getHash()};
+      if (hash.size() != static_cast<ptrdiff_t>(size())) {
+        return boost::none;
+      }
+      CbCid key;
+      std::copy(hash.begin(), hash.end(), key.begin());
+      return key;
+    }
+
+    CID toCid() const {
+      return {CID::Version::V1,
+              CID::Multicodec::DAG_CBOR,
+              libp2p::multi::Multihash::create(
+                  libp2p::multi::HashType::blake2b_256, *this)
+                  .value()};
+    }
+  };
+
+  /**
+   * Key of cid in maps and sets, which does not allocate for CbCid.
+   * Other cids are kept as is.
+   */
+  using CidKey = std::variant<CbCid, CID>;
+
+  inline CidKey cidKey(const CID &cid) {
+    if (auto key{CbCid::make(cid)}) {
+      return *key;
+    }
+    return cid;
+  }
+}  // namespace fc
+
+namespace std {
+  template <>
+  struct hash<fc::CbCid> {
+    size_t operator()(const fc::CbCid &key) const {
+      size_t seed;
+      memcpy(&seed, key.data(), sizeof(seed));
+      return seed;
+    }
+  };
+}  // namespace std
+
+#endif  // CPP_FILECOIN_CORE_PRIMITIVES_CID_CB_CID_HPP
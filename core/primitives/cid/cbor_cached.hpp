@@ -0,0 +1,66 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_PRIMITIVES_CID_CBOR_CACHED_HPP
+#define CPP_FILECOIN_CORE_PRIMITIVES_CID_CBOR_CACHED_HPP
+
+#include "primitives/cid/cid_of_cbor.hpp"
+
+namespace fc::primitives::cid {
+  using common::Buffer;
+
+  /**
+   * Value with its CBOR bytes. Decoding keeps received bytes and encoding
+   * writes them, so value is not encoded again to be stored, hashed or sent.
+   * Value must not be modified after bytes are set.
+   */
+  template <typename T>
+  struct CborCached {
+    /// Encodes value
+    static outcome::result<CborCached> make(T value) {
+      OUTCOME_TRY(bytes, codec::cbor::encode(value));
+      return CborCached{std::move(value), Buffer{std::move(bytes)}};
+    }
+
+    /// Decodes bytes
+    static outcome::result<CborCached> decode(Buffer bytes) {
+      OUTCOME_TRY(value, codec::cbor::decode<T>(bytes));
+      return CborCached{std::move(value), std::move(bytes)};
+    }
+
+    /// Cid of bytes
+    outcome::result<CID> cid() const {
+      return common::getCidOf(bytes);
+    }
+
+    T value;
+    Buffer bytes;
+  };
+
+  template <class Stream,
+            typename T,
+            typename = std::enable_if_t<
+                std::remove_reference_t<Stream>::is_cbor_encoder_stream>>
+  Stream &operator<<(Stream &&s, const CborCached<T> &cached) {
+    return s << codec::cbor::CborEncodeStream::wrap(cached.bytes, 1);
+  }
+
+  /// Decodes value from copy of stream, then takes bytes it was decoded from
+  template <class Stream,
+            typename T,
+            typename = std::enable_if_t<
+                std::remove_reference_t<Stream>::is_cbor_decoder_stream>>
+  Stream &operator>>(Stream &&s, CborCached<T> &cached) {
+    auto element{s};
+    element >> cached.value;
+    if (s.error()) {
+      return s;
+    }
+    cached.bytes = Buffer{s.rawView()};
+    return s;
+  }
+}  // namespace fc::primitives::cid
+
+#endif  // CPP_FILECOIN_CORE_PRIMITIVES_CID_CBOR_CACHED_HPP
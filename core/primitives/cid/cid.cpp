@@ -147,4 +147,16 @@ namespace fc::common {
     OUTCOME_TRY(hash, Multihash::create(HashType::blake2b_256, hash_raw));
     return CID(CID::Version::V1, CID::Multicodec::DAG_CBOR, hash);
   }
+
+  outcome::result<std::vector<CID>> getCidsOf(
+      gsl::span<const gsl::span<const uint8_t>> inputs) {
+    std::vector<CID> cids;
+    cids.reserve(inputs.size());
+    for (auto &hash_raw : crypto::blake2b::blake2b_256_many(inputs)) {
+      OUTCOME_TRY(hash, Multihash::create(HashType::blake2b_256, hash_raw));
+      cids.emplace_back(
+          CID::Version::V1, CID::Multicodec::DAG_CBOR, std::move(hash));
+    }
+    return cids;
+  }
 }  // namespace fc::common
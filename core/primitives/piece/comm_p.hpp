@@ -0,0 +1,42 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_PIECE_COMM_P_HPP
+#define CPP_FILECOIN_PIECE_COMM_P_HPP
+
+#include <boost/asio/thread_pool.hpp>
+#include <istream>
+
+#include "primitives/piece/piece.hpp"
+
+namespace fc::primitives::piece {
+  /**
+   * Computes piece commitment natively, without ffi.
+   * Data is zero padded to piece size, Fr32 padded and hashed into binary
+   * merkle tree with sha256 truncated to 254 bits. Batches of 1MiB padded
+   * subtrees are hashed on pool and caller thread, so memory used is bounded
+   * by batch size. Must not be called from pool thread.
+   * @param input - piece data, must not be larger than piece size
+   * @param size - unpadded piece size
+   * @param pool - hashing threads, subtrees are hashed on caller thread
+   * without it
+   * @return piece commitment cid
+   */
+  outcome::result<CID> generatePieceCommitment(
+      std::istream &input,
+      UnpaddedPieceSize size,
+      const std::shared_ptr<boost::asio::thread_pool> &pool = nullptr);
+
+  /**
+   * Computes piece commitment of data in memory.
+   * @see generatePieceCommitment(std::istream &, UnpaddedPieceSize, pool)
+   */
+  outcome::result<CID> generatePieceCommitment(
+      gsl::span<const uint8_t> data,
+      UnpaddedPieceSize size,
+      const std::shared_ptr<boost::asio::thread_pool> &pool = nullptr);
+}  // namespace fc::primitives::piece
+
+#endif  // CPP_FILECOIN_PIECE_COMM_P_HPP
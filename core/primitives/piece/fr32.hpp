@@ -0,0 +1,28 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_PIECE_FR32_HPP
+#define CPP_FILECOIN_PIECE_FR32_HPP
+
+#include <gsl/span>
+
+namespace fc::primitives::piece {
+  /**
+   * Fr32 padding, inserts two zero bits after each 254 bits of data.
+   * Chunks are processed with AVX2 when cpu supports it.
+   * @param in - unpadded data, 127 bytes per chunk
+   * @param out - padded data, 128 bytes per chunk, size defines chunk count
+   */
+  void pad(gsl::span<const uint8_t> in, gsl::span<uint8_t> out);
+
+  /**
+   * Reverse of Fr32 padding, with AVX2 when cpu supports it.
+   * @param in - padded data, 128 bytes per chunk, size defines chunk count
+   * @param out - unpadded data, 127 bytes per chunk
+   */
+  void unpad(gsl::span<const uint8_t> in, gsl::span<uint8_t> out);
+}  // namespace fc::primitives::piece
+
+#endif  // CPP_FILECOIN_PIECE_FR32_HPP
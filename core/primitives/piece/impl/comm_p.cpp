@@ -0,0 +1,162 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/piece/comm_p.hpp"
+
+#include <boost/asio/post.hpp>
+#include <condition_variable>
+#include <functional>
+#include <libp2p/crypto/sha/sha256.hpp>
+
+#include "primitives/cid/comm_cid.hpp"
+#include "primitives/piece/fr32.hpp"
+#include "primitives/piece/piece_error.hpp"
+
+namespace fc::primitives::piece {
+  namespace {
+    constexpr size_t kNodeSize{32};
+
+    /// Unpadded size of subtree hashed by one thread, 1MiB padded
+    constexpr uint64_t kSubtreeSize{127 << 13};
+
+    /// Subtrees read and hashed at once with pool
+    constexpr uint64_t kBatchSubtrees{8};
+
+    /// Reads up to span size bytes, returns count of bytes read
+    using Read = std::function<outcome::result<size_t>(gsl::span<uint8_t>)>;
+
+    /// Replaces node pairs with their hashes until root is left in front
+    void reduce(gsl::span<uint8_t> nodes) {
+      for (auto count = nodes.size() / kNodeSize; count > 1; count /= 2) {
+        for (size_t i = 0; i < count / 2; ++i) {
+          auto hash = libp2p::crypto::sha256(
+              nodes.subspan(2 * i * kNodeSize, 2 * kNodeSize));
+          // truncate to 254 bits to fit field element
+          hash[kNodeSize - 1] &= 0x3f;
+          std::copy(hash.begin(), hash.end(), nodes.begin() + i * kNodeSize);
+        }
+      }
+    }
+
+    /// Root of tree over zero padded data of given size
+    std::vector<uint8_t> zeroRoot(uint64_t padded) {
+      std::vector<uint8_t> nodes(2 * kNodeSize);
+      for (auto count = padded / kNodeSize; count > 1; count /= 2) {
+        reduce(nodes);
+        std::copy_n(nodes.begin(), kNodeSize, nodes.begin() + kNodeSize);
+      }
+      nodes.resize(kNodeSize);
+      return nodes;
+    }
+
+    outcome::result<CID> generate(
+        const Read &read,
+        UnpaddedPieceSize size,
+        const std::shared_ptr<boost::asio::thread_pool> &pool) {
+      OUTCOME_TRY(size.validate());
+      const uint64_t subtree = std::min<uint64_t>(size, kSubtreeSize);
+      const uint64_t padded = UnpaddedPieceSize{subtree}.padded();
+      const uint64_t count = size / subtree;
+      const uint64_t slots =
+          std::min<uint64_t>(pool ? kBatchSubtrees : 1, count);
+
+      std::vector<uint8_t> roots(count * kNodeSize);
+      std::vector<uint8_t> in(slots * subtree);
+      std::vector<uint8_t> out(slots * padded);
+      const auto zero = zeroRoot(padded);
+      auto hash = [&](uint64_t index, size_t slot) {
+        auto padded_span = gsl::make_span(out).subspan(slot * padded, padded);
+        pad(gsl::make_span(in).subspan(slot * subtree, subtree), padded_span);
+        reduce(padded_span);
+        std::copy_n(padded_span.begin(),
+                    kNodeSize,
+                    roots.begin() + index * kNodeSize);
+      };
+      std::mutex mutex;
+      std::condition_variable hashed;
+      size_t pending{};
+
+      uint64_t done{0};
+      auto end{false};
+      while (done < count) {
+        auto batch = std::min<uint64_t>(slots, count - done);
+        uint64_t filled{0};
+        if (!end) {
+          auto bytes = batch * subtree;
+          OUTCOME_TRY(read_bytes, read(gsl::make_span(in.data(), bytes)));
+          if (read_bytes < bytes) {
+            end = true;
+            std::fill(in.begin() + read_bytes, in.begin() + bytes, 0);
+          }
+          filled = (read_bytes + subtree - 1) / subtree;
+        }
+        if (filled != 0) {
+          pending = filled - 1;
+          for (size_t slot = 1; slot < filled; ++slot) {
+            boost::asio::post(*pool, [&, index{done + slot}, slot] {
+              hash(index, slot);
+              std::lock_guard lock{mutex};
+              if (--pending == 0) {
+                hashed.notify_one();
+              }
+            });
+          }
+          hash(done, 0);
+          std::unique_lock lock{mutex};
+          hashed.wait(lock, [&] { return pending == 0; });
+        }
+        // subtrees past the end of data are all zero
+        for (auto index = done + filled; index < done + batch; ++index) {
+          std::copy(
+              zero.begin(), zero.end(), roots.begin() + index * kNodeSize);
+        }
+        done += batch;
+      }
+      if (!end) {
+        uint8_t extra;
+        OUTCOME_TRY(read_bytes, read(gsl::make_span(&extra, 1)));
+        if (read_bytes != 0) {
+          return PieceError::kDataTooLarge;
+        }
+      }
+
+      reduce(roots);
+      return common::pieceCommitmentV1ToCID(
+          gsl::make_span(roots).first(kNodeSize));
+    }
+  }  // namespace
+
+  outcome::result<CID> generatePieceCommitment(
+      std::istream &input,
+      UnpaddedPieceSize size,
+      const std::shared_ptr<boost::asio::thread_pool> &pool) {
+    return generate(
+        [&](gsl::span<uint8_t> buffer) -> outcome::result<size_t> {
+          input.read(reinterpret_cast<char *>(buffer.data()), buffer.size());
+          if (input.bad()) {
+            return PieceError::kCannotReadData;
+          }
+          return input.gcount();
+        },
+        size,
+        pool);
+  }
+
+  outcome::result<CID> generatePieceCommitment(
+      gsl::span<const uint8_t> data,
+      UnpaddedPieceSize size,
+      const std::shared_ptr<boost::asio::thread_pool> &pool) {
+    size_t offset{0};
+    return generate(
+        [&](gsl::span<uint8_t> buffer) -> outcome::result<size_t> {
+          auto bytes = std::min<size_t>(buffer.size(), data.size() - offset);
+          std::copy_n(data.begin() + offset, bytes, buffer.begin());
+          offset += bytes;
+          return bytes;
+        },
+        size,
+        pool);
+  }
+}  // namespace fc::primitives::piece
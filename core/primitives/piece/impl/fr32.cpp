@@ -0,0 +1,196 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/piece/fr32.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define FC_FR32_AVX2
+#include <immintrin.h>
+#endif
+
+namespace fc::primitives::piece {
+  namespace {
+    void unpadScalar(gsl::span<const uint8_t> in, gsl::span<uint8_t> out) {
+      auto chunks = in.size() / 128;
+      for (size_t chunk = 0; chunk < chunks; chunk++) {
+        auto input_offset_next = chunk * 128 + 1;
+        auto output_offset = chunk * 127;
+
+        auto current = in[chunk * 128];
+
+        for (size_t i = 0; i < 32; i++) {
+          out[output_offset + i] = current;
+
+          current = in[i + input_offset_next];
+        }
+
+        out[output_offset + 31] |= current << 6;
+
+        for (size_t i = 32; i < 64; i++) {
+          auto next = in[i + input_offset_next];
+
+          out[output_offset + i] = current >> 2;
+          out[output_offset + i] |= next << 6;
+
+          current = next;
+        }
+
+        out[output_offset + 63] ^= (current << 6) ^ (current << 4);
+
+        for (size_t i = 64; i < 96; i++) {
+          auto next = in[i + input_offset_next];
+
+          out[output_offset + i] = current >> 4;
+          out[output_offset + i] |= next << 4;
+
+          current = next;
+        }
+
+        out[output_offset + 95] ^= (current << 4) ^ (current << 2);
+
+        for (size_t i = 96; i < 127; i++) {
+          auto next = in[i + input_offset_next];
+
+          out[output_offset + i] = current >> 6;
+          out[output_offset + i] |= next << 2;
+
+          current = next;
+        }
+      }
+    }
+
+    void padScalar(gsl::span<const uint8_t> in, gsl::span<uint8_t> out) {
+      auto chunks = out.size() / 128;
+      for (size_t chunk = 0; chunk < chunks; chunk++) {
+        size_t input_offset = chunk * 127;
+        size_t output_offset = chunk * 128;
+
+        std::copy(in.begin() + input_offset,
+                  in.begin() + input_offset + 31,
+                  out.begin() + output_offset);
+
+        auto t = in[input_offset + 31] >> 6;
+        out[output_offset + 31] = in[input_offset + 31] & 0x3f;
+        uint8_t v;
+
+        for (int i = 32; i < 64; i++) {
+          v = in[input_offset + i];
+          out[output_offset + i] = (v << 2) | t;
+          t = v >> 6;
+        }
+
+        t = v >> 4;
+        out[output_offset + 63] &= 0x3f;
+
+        for (size_t i = 64; i < 96; i++) {
+          v = in[input_offset + i];
+          out[output_offset + i] = (v << 4) | t;
+          t = v >> 4;
+        }
+
+        t = v >> 2;
+        out[output_offset + 95] &= 0x3f;
+
+        for (size_t i = 96; i < 127; i++) {
+          v = in[input_offset + i];
+          out[output_offset + i] = (v << 6) | t;
+          t = v >> 2;
+        }
+
+        out[output_offset + 127] = t & 0x3f;
+      }
+    }
+
+#ifdef FC_FR32_AVX2
+    /// Clears two high bits of 256-bit element
+    __attribute__((target("avx2"))) inline __m256i mask254(__m256i x) {
+      return _mm256_and_si256(
+          x, _mm256_set_epi64x(0x3FFFFFFFFFFFFFFF, -1, -1, -1));
+    }
+
+    /// Shifts 256-bit little-endian element right, bits less than 64
+    __attribute__((target("avx2"))) inline __m256i shiftRight(__m256i x,
+                                                              int bits) {
+      // lanes moved one down, zero in top lane
+      auto high{_mm256_blend_epi32(
+          _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 2, 1)),
+          _mm256_setzero_si256(),
+          0xC0)};
+      return _mm256_or_si256(
+          _mm256_srl_epi64(x, _mm_cvtsi32_si128(bits)),
+          _mm256_sll_epi64(high, _mm_cvtsi32_si128(64 - bits)));
+    }
+
+    /**
+     * Unpads chunk as four 254-bit elements. Writes 128 bytes, last byte
+     * belongs to next chunk and is overwritten by it.
+     */
+    __attribute__((target("avx2"))) void unpadChunk(const uint8_t *in,
+                                                    uint8_t *out) {
+      // element k ends at bit 254 * (k + 1) of output
+      for (auto k{0}; k < 4; ++k) {
+        auto element{mask254(_mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(in + 32 * k)))};
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 32 * k),
+                            shiftRight(element, 2 * k));
+      }
+      // low bits of next element fill high bits of output word
+      for (auto k{0}; k < 3; ++k) {
+        out[32 * k + 31] |= in[32 * (k + 1)] << (6 - 2 * k);
+      }
+    }
+
+    /// Pads chunk as four 254-bit elements, reads 127 bytes
+    __attribute__((target("avx2"))) void padChunk(const uint8_t *in,
+                                                  uint8_t *out) {
+      // element k starts at bit 254 * k of input
+      for (auto k{0}; k < 4; ++k) {
+        auto bit{254 * k};
+        auto element{_mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(in + bit / 8))};
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 32 * k),
+                            mask254(shiftRight(element, bit % 8)));
+      }
+      // high bits of element are beyond its load
+      for (auto k{1}; k < 3; ++k) {
+        auto bit{254 * k};
+        out[32 * k + 31] |= (in[bit / 8 + 32] << (8 - bit % 8)) & 0x3F;
+      }
+    }
+
+    bool hasAvx2() {
+      static const bool avx2{__builtin_cpu_supports("avx2") != 0};
+      return avx2;
+    }
+#endif
+  }  // namespace
+
+  void unpad(gsl::span<const uint8_t> in, gsl::span<uint8_t> out) {
+    const auto chunks{static_cast<size_t>(in.size()) / 128};
+    size_t chunk{};
+#ifdef FC_FR32_AVX2
+    if (hasAvx2()) {
+      // vector store overruns chunk by one byte, so last one is scalar
+      for (; chunk + 1 < chunks; ++chunk) {
+        unpadChunk(in.data() + chunk * 128, out.data() + chunk * 127);
+      }
+    }
+#endif
+    unpadScalar(in.subspan(chunk * 128), out.subspan(chunk * 127));
+  }
+
+  void pad(gsl::span<const uint8_t> in, gsl::span<uint8_t> out) {
+    const auto chunks{static_cast<size_t>(out.size()) / 128};
+    size_t chunk{};
+#ifdef FC_FR32_AVX2
+    if (hasAvx2()) {
+      for (; chunk < chunks; ++chunk) {
+        padChunk(in.data() + chunk * 127, out.data() + chunk * 128);
+      }
+    }
+#endif
+    padScalar(in.subspan(chunk * 127), out.subspan(chunk * 128));
+  }
+}  // namespace fc::primitives::piece
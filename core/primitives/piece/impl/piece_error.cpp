@@ -17,6 +17,10 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::primitives::piece, PieceError, e) {
       return "Piece: unpadded piece size must be a power of 2 multiple of 127";
     case (PieceError::kInvalidPaddedSize):
       return "Piece: padded piece size must be a power of 2";
+    case (PieceError::kDataTooLarge):
+      return "Piece: data is larger than piece size";
+    case (PieceError::kCannotReadData):
+      return "Piece: cannot read piece data";
     default:
       return "Piece: unknown error";
   }
@@ -78,6 +78,8 @@ namespace fc::primitives::piece {
     return lhs.size == rhs.size && lhs.cid == rhs.cid;
   }
 
+  CBOR_TUPLE(PieceInfo, size, cid)
+
   /**
    * @brief PaddedSize takes size to the next power of two and then returns the
    * number of not-bit-padded bytes that would fit into a sector of that size.
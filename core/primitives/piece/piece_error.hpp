@@ -18,6 +18,8 @@ namespace fc::primitives::piece {
     kLessThatMinimumPaddedSize,
     kInvalidUnpaddedSize,
     kInvalidPaddedSize,
+    kDataTooLarge,
+    kCannotReadData,
   };
 
 }  // namespace fc::primitives::piece
@@ -6,6 +6,45 @@
 #include "primitives/resources/active_resources.hpp"
 
 namespace fc::primitives {
+  namespace {
+    uint64_t usedOn(const std::vector<uint64_t> &used, size_t node) {
+      return node < used.size() ? used[node] : 0;
+    }
+
+    /// Whether cores and memory left on node fit task
+    bool nodeFits(const Resources &need_resources,
+                  const WorkerResources &resources,
+                  size_t node,
+                  uint64_t threads,
+                  uint64_t memory_used,
+                  uint64_t cpu_use) {
+      const auto &numa{resources.numa_nodes[node]};
+      // reserved memory is spread over nodes by their size
+      const auto reserved{
+          resources.physical_memory == 0
+              ? 0
+              : static_cast<uint64_t>(
+                  static_cast<double>(resources.reserved_memory) * numa.memory
+                  / resources.physical_memory)};
+      return cpu_use + threads <= numa.cpus.size()
+             && reserved + memory_used + need_resources.min_memory
+                        + need_resources.base_min_memory
+                    <= numa.memory;
+    }
+  }  // namespace
+
+  boost::optional<uint64_t> taskThreads(const Resources &need_resources,
+                                        const WorkerResources &resources) {
+    // table marks multithread tasks with -1
+    if (need_resources.threads && *need_resources.threads != kMultiThread) {
+      return need_resources.threads;
+    }
+    if (need_resources.can_gpu && !resources.gpus.empty()) {
+      return std::min(kGpuTaskThreads, resources.cpus);
+    }
+    return boost::none;
+  }
+
   bool canHandleRequest(const Resources &need_resources,
                         const WorkerResources &resources,
                         const ActiveResources &active) {
@@ -27,8 +66,8 @@ namespace fc::primitives {
       return false;
     }
 
-    if (need_resources.threads) {
-      if ((active.cpu_use + *need_resources.threads) > resources.cpus) {
+    if (auto threads{taskThreads(need_resources, resources)}) {
+      if ((active.cpu_use + *threads) > resources.cpus) {
         return false;
       }
     } else {
@@ -38,7 +77,7 @@ namespace fc::primitives {
     }
 
     if (!resources.gpus.empty() && need_resources.can_gpu) {
-      if (active.gpu_used) {
+      if (active.gpu_use >= resources.gpus.size()) {
         return false;
       }
     }
@@ -46,55 +85,156 @@ namespace fc::primitives {
     return true;
   }
 
+  bool isNumaBound(const Resources &need_resources,
+                   const WorkerResources &resources) {
+    if (resources.numa_nodes.size() < 2) {
+      return false;
+    }
+    if (need_resources.can_gpu && !resources.gpus.empty()) {
+      return false;
+    }
+    auto threads{taskThreads(need_resources, resources)};
+    if (!threads) {
+      return false;
+    }
+    for (const auto &node : resources.numa_nodes) {
+      if (*threads <= node.cpus.size()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  boost::optional<size_t> pickNumaNode(const Resources &need_resources,
+                                       const WorkerResources &resources,
+                                       const ActiveResources &preparing,
+                                       const ActiveResources &active) {
+    if (!isNumaBound(need_resources, resources)) {
+      return boost::none;
+    }
+    const auto threads{*taskThreads(need_resources, resources)};
+    std::shared_lock<std::shared_mutex> lock1(preparing.mutex_);
+    std::shared_lock<std::shared_mutex> lock2(active.mutex_);
+    boost::optional<size_t> picked;
+    uint64_t picked_memory{};
+    for (size_t node{0}; node < resources.numa_nodes.size(); ++node) {
+      const auto memory_used{usedOn(preparing.numa_memory_used, node)
+                             + usedOn(active.numa_memory_used, node)};
+      const auto cpu_use{usedOn(preparing.numa_cpu_use, node)
+                         + usedOn(active.numa_cpu_use, node)};
+      if (!nodeFits(need_resources,
+                    resources,
+                    node,
+                    threads,
+                    memory_used,
+                    cpu_use)) {
+        continue;
+      }
+      if (!picked || memory_used < picked_memory) {
+        picked = node;
+        picked_memory = memory_used;
+      }
+    }
+    return picked;
+  }
+
+  bool canHandleRequest(const Resources &need_resources,
+                        const WorkerResources &resources,
+                        const ActiveResources &preparing,
+                        const ActiveResources &active) {
+    if (isNumaBound(need_resources, resources)
+        && !pickNumaNode(need_resources, resources, preparing, active)) {
+      return false;
+    }
+    ActiveResources window;
+    {
+      std::shared_lock<std::shared_mutex> lock1(preparing.mutex_);
+      std::shared_lock<std::shared_mutex> lock2(active.mutex_);
+      window.memory_used_min =
+          preparing.memory_used_min + active.memory_used_min;
+      window.memory_used_max =
+          preparing.memory_used_max + active.memory_used_max;
+      window.gpu_use = preparing.gpu_use + active.gpu_use;
+      window.cpu_use = preparing.cpu_use + active.cpu_use;
+    }
+    return canHandleRequest(need_resources, resources, window);
+  }
+
   void ActiveResources::add(const WorkerResources &worker_resources,
-                            const Resources &resources) {
+                            const Resources &resources,
+                            boost::optional<size_t> numa_node) {
     std::unique_lock lock(mutex_);
-    if (resources.can_gpu) {
-      gpu_used = true;
-    }
-    if (resources.threads) {
-      cpu_use += *resources.threads;
-    } else {
-      cpu_use += worker_resources.cpus;
+    if (resources.can_gpu && !worker_resources.gpus.empty()) {
+      ++gpu_use;
     }
+    const auto threads{taskThreads(resources, worker_resources)
+                           .value_or(worker_resources.cpus)};
+    cpu_use += threads;
 
     memory_used_min += resources.min_memory;
     memory_used_max += resources.max_memory;
+
+    if (numa_node) {
+      numa_memory_used.resize(worker_resources.numa_nodes.size());
+      numa_cpu_use.resize(worker_resources.numa_nodes.size());
+      numa_memory_used[*numa_node] += resources.min_memory;
+      numa_cpu_use[*numa_node] += threads;
+    }
   }
 
   void ActiveResources::free(const WorkerResources &worker_resources,
-                             const Resources &resources) {
+                             const Resources &resources,
+                             boost::optional<size_t> numa_node) {
     std::unique_lock lock(mutex_);
-    if (resources.can_gpu) {
-      gpu_used = false;
+    if (resources.can_gpu && !worker_resources.gpus.empty()) {
+      --gpu_use;
     }
 
-    if (resources.threads) {
-      cpu_use -= *resources.threads;
-    } else {
-      cpu_use -= worker_resources.cpus;
-    }
+    const auto threads{taskThreads(resources, worker_resources)
+                           .value_or(worker_resources.cpus)};
+    cpu_use -= threads;
 
     memory_used_min -= resources.min_memory;
     memory_used_max -= resources.max_memory;
+
+    if (numa_node) {
+      numa_memory_used[*numa_node] -= resources.min_memory;
+      numa_cpu_use[*numa_node] -= threads;
+    }
   }
 
   outcome::result<void> ActiveResources::withResources(
       const WorkerResources &worker_resources,
       const Resources &resources,
+      boost::optional<size_t> numa_node,
       std::mutex &locker,
       const std::function<outcome::result<void>()> &callback) {
-    while (!canHandleRequest(resources, worker_resources, *this)) {
+    auto fits{[&] {
+      if (!canHandleRequest(resources, worker_resources, *this)) {
+        return false;
+      }
+      if (!numa_node) {
+        return true;
+      }
+      std::shared_lock lock(mutex_);
+      return nodeFits(resources,
+                      worker_resources,
+                      *numa_node,
+                      *taskThreads(resources, worker_resources),
+                      usedOn(numa_memory_used, *numa_node),
+                      usedOn(numa_cpu_use, *numa_node));
+    }};
+    while (!fits()) {
       std::unique_lock<std::mutex> lock(locker);
       cv_.wait(lock, [&]() { return unlock_; });
     }
     unlock_ = false;
 
-    add(worker_resources, resources);
+    add(worker_resources, resources, numa_node);
 
     auto res = callback();
 
-    free(worker_resources, resources);
+    free(worker_resources, resources, numa_node);
 
     unlock_ = true;
     cv_.notify_all();
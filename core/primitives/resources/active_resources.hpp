@@ -6,6 +6,7 @@
 #ifndef CPP_FILECOIN_CORE_PRIMITIVES_RESOURCES_ACTIVE_RESOURCES_HPP
 #define CPP_FILECOIN_CORE_PRIMITIVES_RESOURCES_ACTIVE_RESOURCES_HPP
 
+#include <condition_variable>
 #include <shared_mutex>
 #include "primitives/resources/resources.hpp"
 #include "primitives/types.hpp"
@@ -15,14 +16,21 @@ namespace fc::primitives {
   struct ActiveResources {
     uint64_t memory_used_min = 0;
     uint64_t memory_used_max = 0;
-    bool gpu_used = false;
+    /// Count of devices used, each gpu task holds one device
+    uint64_t gpu_use = 0;
     uint64_t cpu_use = 0;
+    /// Memory and cores held on each NUMA node by tasks bound to node
+    std::vector<uint64_t> numa_memory_used;
+    std::vector<uint64_t> numa_cpu_use;
 
+    /// @param numa_node - index of worker NUMA node task is bound to
     void add(const WorkerResources &worker_resources,
-             const Resources &resources);
+             const Resources &resources,
+             boost::optional<size_t> numa_node = boost::none);
 
     void free(const WorkerResources &worker_resources,
-              const Resources &resources);
+              const Resources &resources,
+              boost::optional<size_t> numa_node = boost::none);
 
     /**
      * @brief run @callback with @resources
@@ -30,6 +38,7 @@ namespace fc::primitives {
     outcome::result<void> withResources(
         const WorkerResources &worker_resources,
         const Resources &resources,
+        boost::optional<size_t> numa_node,
         std::mutex &locker,
         const std::function<outcome::result<void>()> &callback);
 
@@ -39,14 +48,61 @@ namespace fc::primitives {
                                  const WorkerResources &resources,
                                  const ActiveResources &active);
 
+    friend bool canHandleRequest(const Resources &need_resources,
+                                 const WorkerResources &resources,
+                                 const ActiveResources &preparing,
+                                 const ActiveResources &active);
+
+    friend boost::optional<size_t> pickNumaNode(
+        const Resources &need_resources,
+        const WorkerResources &resources,
+        const ActiveResources &preparing,
+        const ActiveResources &active);
+
    private:
     mutable std::shared_mutex mutex_;
     bool unlock_;
     std::condition_variable cv_;
   };
 
+  /**
+   * @brief cores held by task, gpu task on worker with gpu holds
+   * kGpuTaskThreads, so cpu tasks run beside it
+   * @return none if task holds all cores
+   */
+  boost::optional<uint64_t> taskThreads(const Resources &need_resources,
+                                        const WorkerResources &resources);
+
+  bool canHandleRequest(const Resources &need_resources,
+                        const WorkerResources &resources,
+                        const ActiveResources &active);
+
+  /**
+   * @brief whether task runs on cores and memory of one NUMA node: worker
+   * has several nodes, task doesn't use gpu and its threads fit node
+   */
+  bool isNumaBound(const Resources &need_resources,
+                   const WorkerResources &resources);
+
+  /**
+   * @brief NUMA node with cores and memory window for task left by
+   * preparing and active tasks, node with least memory used is picked
+   * @return index of node in worker resources, none if task is not bound to
+   * node or no node fits
+   */
+  boost::optional<size_t> pickNumaNode(const Resources &need_resources,
+                                       const WorkerResources &resources,
+                                       const ActiveResources &preparing,
+                                       const ActiveResources &active);
+
+  /**
+   * @brief whether request fits resources left by both preparing and active
+   * tasks, so several tasks run on worker at once without waiting.
+   * Task bound to NUMA node also needs node with room for it.
+   */
   bool canHandleRequest(const Resources &need_resources,
                         const WorkerResources &resources,
+                        const ActiveResources &preparing,
                         const ActiveResources &active);
 
 }  // namespace fc::primitives
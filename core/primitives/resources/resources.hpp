@@ -27,6 +27,11 @@ namespace fc::primitives {
                                // between threads)
   };
 
+  /// Value of threads of multithread tasks in resource table
+  constexpr uint64_t kMultiThread{static_cast<uint64_t>(-1)};
+  /// Cores which feed gpu device while it computes task
+  constexpr uint64_t kGpuTaskThreads{2};
+
   inline bool operator==(const Resources &lhs, const Resources &rhs) {
     return lhs.min_memory == rhs.min_memory && lhs.max_memory == rhs.max_memory
            && lhs.threads == rhs.threads && lhs.can_gpu == rhs.can_gpu
@@ -0,0 +1,245 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/rle_bitset/rle_bitset.hpp"
+
+#include <algorithm>
+
+namespace fc::primitives {
+  RleBitset::const_iterator::const_iterator(Runs::const_iterator run,
+                                            Runs::const_iterator end,
+                                            uint64_t value)
+      : run_{run}, end_{end}, value_{value} {}
+
+  RleBitset::const_iterator::reference RleBitset::const_iterator::operator*()
+      const {
+    return value_;
+  }
+
+  RleBitset::const_iterator &RleBitset::const_iterator::operator++() {
+    if (++value_ == run_->second) {
+      ++run_;
+      value_ = run_ == end_ ? 0 : run_->first;
+    }
+    return *this;
+  }
+
+  RleBitset::const_iterator RleBitset::const_iterator::operator++(int) {
+    auto copy{*this};
+    ++*this;
+    return copy;
+  }
+
+  bool RleBitset::const_iterator::operator==(
+      const const_iterator &other) const {
+    return run_ == other.run_ && value_ == other.value_;
+  }
+
+  bool RleBitset::const_iterator::operator!=(
+      const const_iterator &other) const {
+    return !(*this == other);
+  }
+
+  RleBitset::RleBitset(std::initializer_list<uint64_t> values) {
+    insert(values.begin(), values.end());
+  }
+
+  RleBitset RleBitset::fromRuns(Runs runs) {
+    RleBitset set;
+    for (auto &run : runs) {
+      set.size_ += run.second - run.first;
+    }
+    set.runs_ = std::move(runs);
+    return set;
+  }
+
+  const RleBitset::Runs &RleBitset::runs() const {
+    return runs_;
+  }
+
+  RleBitset::const_iterator RleBitset::begin() const {
+    return {runs_.begin(),
+            runs_.end(),
+            runs_.empty() ? 0 : runs_.front().first};
+  }
+
+  RleBitset::const_iterator RleBitset::end() const {
+    return {runs_.end(), runs_.end(), 0};
+  }
+
+  bool RleBitset::empty() const {
+    return runs_.empty();
+  }
+
+  size_t RleBitset::size() const {
+    return size_;
+  }
+
+  void RleBitset::clear() {
+    runs_.clear();
+    size_ = 0;
+  }
+
+  bool RleBitset::contains(uint64_t value) const {
+    auto run{upper(value)};
+    return run != runs_.end() && run->first <= value;
+  }
+
+  size_t RleBitset::count(uint64_t value) const {
+    return contains(value) ? 1 : 0;
+  }
+
+  RleBitset::const_iterator RleBitset::find(uint64_t value) const {
+    auto run{upper(value)};
+    if (run != runs_.end() && run->first <= value) {
+      return {run, runs_.end(), value};
+    }
+    return end();
+  }
+
+  std::pair<RleBitset::const_iterator, bool> RleBitset::insert(
+      uint64_t value) {
+    auto inserted{!contains(value)};
+    if (inserted) {
+      insertRun(value, value + 1);
+    }
+    return {find(value), inserted};
+  }
+
+  void RleBitset::insert(const_iterator first, const_iterator last) {
+    while (first != last) {
+      if (first.run_ == last.run_) {
+        insertRun(first.value_, last.value_);
+        break;
+      }
+      insertRun(first.value_, first.run_->second);
+      ++first.run_;
+      first.value_ = first.run_ == first.end_ ? 0 : first.run_->first;
+    }
+  }
+
+  void RleBitset::insertRun(uint64_t first, uint64_t last) {
+    if (first >= last) {
+      return;
+    }
+    // runs touching [first, last) are merged with it
+    auto begin{std::lower_bound(
+        runs_.begin(), runs_.end(), first, [](auto &run, auto value) {
+          return run.second < value;
+        })};
+    auto end{std::upper_bound(
+        begin, runs_.end(), last, [](auto value, auto &run) {
+          return value < run.first;
+        })};
+    if (begin == end) {
+      runs_.insert(begin, {first, last});
+      size_ += last - first;
+      return;
+    }
+    first = std::min(first, begin->first);
+    last = std::max(last, std::prev(end)->second);
+    for (auto it{begin}; it != end; ++it) {
+      size_ -= it->second - it->first;
+    }
+    size_ += last - first;
+    *begin = {first, last};
+    runs_.erase(std::next(begin), end);
+  }
+
+  size_t RleBitset::erase(uint64_t value) {
+    auto run{runs_.begin() + (upper(value) - runs_.cbegin())};
+    if (run == runs_.end() || run->first > value) {
+      return 0;
+    }
+    --size_;
+    if (run->first == value) {
+      if (++run->first == run->second) {
+        runs_.erase(run);
+      }
+    } else if (run->second == value + 1) {
+      --run->second;
+    } else {
+      auto last{run->second};
+      run->second = value;
+      runs_.insert(std::next(run), {value + 1, last});
+    }
+    return 1;
+  }
+
+  RleBitset RleBitset::unite(const RleBitset &other) const {
+    Runs runs;
+    runs.reserve(runs_.size() + other.runs_.size());
+    auto add{[&](const Run &run) {
+      if (!runs.empty() && runs.back().second >= run.first) {
+        runs.back().second = std::max(runs.back().second, run.second);
+      } else {
+        runs.push_back(run);
+      }
+    }};
+    auto a{runs_.begin()}, b{other.runs_.begin()};
+    while (a != runs_.end() || b != other.runs_.end()) {
+      if (b == other.runs_.end()
+          || (a != runs_.end() && a->first < b->first)) {
+        add(*a++);
+      } else {
+        add(*b++);
+      }
+    }
+    return fromRuns(std::move(runs));
+  }
+
+  RleBitset RleBitset::intersect(const RleBitset &other) const {
+    Runs runs;
+    auto a{runs_.begin()}, b{other.runs_.begin()};
+    while (a != runs_.end() && b != other.runs_.end()) {
+      auto first{std::max(a->first, b->first)};
+      auto last{std::min(a->second, b->second)};
+      if (first < last) {
+        runs.emplace_back(first, last);
+      }
+      if (a->second < b->second) {
+        ++a;
+      } else {
+        ++b;
+      }
+    }
+    return fromRuns(std::move(runs));
+  }
+
+  RleBitset RleBitset::subtract(const RleBitset &other) const {
+    Runs runs;
+    auto b{other.runs_.begin()};
+    for (auto run : runs_) {
+      while (b != other.runs_.end() && b->second <= run.first) {
+        ++b;
+      }
+      for (auto c{b}; c != other.runs_.end() && c->first < run.second; ++c) {
+        if (c->first > run.first) {
+          runs.emplace_back(run.first, c->first);
+        }
+        run.first = std::max(run.first, c->second);
+      }
+      if (run.first < run.second) {
+        runs.push_back(run);
+      }
+    }
+    return fromRuns(std::move(runs));
+  }
+
+  bool RleBitset::operator==(const RleBitset &other) const {
+    return runs_ == other.runs_;
+  }
+
+  bool RleBitset::operator!=(const RleBitset &other) const {
+    return !(*this == other);
+  }
+
+  RleBitset::Runs::const_iterator RleBitset::upper(uint64_t value) const {
+    return std::upper_bound(
+        runs_.begin(), runs_.end(), value, [](auto value, auto &run) {
+          return value < run.second;
+        });
+  }
+}  // namespace fc::primitives
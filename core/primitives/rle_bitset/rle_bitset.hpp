@@ -6,28 +6,127 @@
 #ifndef CPP_FILECOIN_CORE_PRIMITIVES_RLE_BITSET_RLE_BITSET_HPP
 #define CPP_FILECOIN_CORE_PRIMITIVES_RLE_BITSET_RLE_BITSET_HPP
 
-#include <set>
+#include <initializer_list>
+#include <iterator>
+#include <vector>
 
 #include "codec/cbor/streams_annotation.hpp"
 #include "codec/rle/rle_plus.hpp"
 #include "common/outcome.hpp"
 
 namespace fc::primitives {
-  struct RleBitset : public std::set<uint64_t> {
-    using set::set;
+  /**
+   * Set of integers stored as runs of consecutive integers, so memory and
+   * set algebra are proportional to count of runs, not count of integers.
+   * Interface follows std::set where it is used.
+   */
+  class RleBitset {
+   public:
+    using value_type = uint64_t;
+    /// Half-open interval [first, second) of integers in set
+    using Run = std::pair<uint64_t, uint64_t>;
+    /// Sorted, not overlapping and not adjacent runs
+    using Runs = std::vector<Run>;
 
-    inline RleBitset(set &&s) : set{s} {}
+    /// Iterates integers of set in ascending order
+    class const_iterator {
+     public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = uint64_t;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const uint64_t *;
+      using reference = const uint64_t &;
+
+      const_iterator() = default;
+
+      reference operator*() const;
+      const_iterator &operator++();
+      const_iterator operator++(int);
+      bool operator==(const const_iterator &other) const;
+      bool operator!=(const const_iterator &other) const;
+
+     private:
+      friend class RleBitset;
+
+      const_iterator(Runs::const_iterator run,
+                     Runs::const_iterator end,
+                     uint64_t value);
+
+      Runs::const_iterator run_{};
+      Runs::const_iterator end_{};
+      uint64_t value_{};
+    };
+    using iterator = const_iterator;
+
+    RleBitset() = default;
+    RleBitset(std::initializer_list<uint64_t> values);
+
+    template <typename It>
+    RleBitset(It first, It last) {
+      insert(first, last);
+    }
+
+    /// Creates set from sorted, not overlapping and not adjacent runs
+    static RleBitset fromRuns(Runs runs);
+
+    const Runs &runs() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    bool empty() const;
+    size_t size() const;
+    void clear();
+
+    bool contains(uint64_t value) const;
+    size_t count(uint64_t value) const;
+    const_iterator find(uint64_t value) const;
+
+    std::pair<const_iterator, bool> insert(uint64_t value);
+    /// Inserts integers of range of other set, run by run
+    void insert(const_iterator first, const_iterator last);
+
+    template <typename It>
+    void insert(It first, It last) {
+      for (; first != last; ++first) {
+        insert(static_cast<uint64_t>(*first));
+      }
+    }
+
+    /// Inserts integers [first, last)
+    void insertRun(uint64_t first, uint64_t last);
+
+    size_t erase(uint64_t value);
+
+    /// Integers in this or other set
+    RleBitset unite(const RleBitset &other) const;
+    /// Integers in both this and other set
+    RleBitset intersect(const RleBitset &other) const;
+    /// Integers in this but not in other set
+    RleBitset subtract(const RleBitset &other) const;
+
+    bool operator==(const RleBitset &other) const;
+    bool operator!=(const RleBitset &other) const;
+
+   private:
+    /// First run ending after value
+    Runs::const_iterator upper(uint64_t value) const;
+
+    Runs runs_;
+    size_t size_{};
   };
 
   CBOR_ENCODE(RleBitset, set) {
-    return s << codec::rle::encode(set);
+    return s << codec::rle::encode(set.runs());
   }
 
   CBOR_DECODE(RleBitset, set) {
     std::vector<uint8_t> rle;
     s >> rle;
-    OUTCOME_EXCEPT(decoded, codec::rle::decode<RleBitset::value_type>(rle));
-    set = RleBitset{std::move(decoded)};
+    if (s.error()) {
+      return s;
+    }
+    OUTCOME_EXCEPT(runs, codec::rle::decodeRuns<RleBitset::value_type>(rle));
+    set = RleBitset::fromRuns(std::move(runs));
     return s;
   }
 }  // namespace fc::primitives
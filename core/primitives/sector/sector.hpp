@@ -6,6 +6,8 @@
 #ifndef CPP_FILECOIN_CORE_PROOFS_SECTOR_HPP
 #define CPP_FILECOIN_CORE_PROOFS_SECTOR_HPP
 
+#include <tuple>
+
 #include "common/blob.hpp"
 #include "common/buffer.hpp"
 #include "crypto/randomness/randomness_types.hpp"
@@ -25,7 +27,7 @@ namespace fc::primitives::sector {
     SectorNumber sector;
   };
   inline bool operator<(const SectorId &lhs, const SectorId &rhs) {
-    return lhs.miner < rhs.miner && lhs.sector < rhs.sector;
+    return std::tie(lhs.miner, lhs.sector) < std::tie(rhs.miner, rhs.sector);
   }
   inline bool operator==(const SectorId &lhs, const SectorId &rhs) {
     return lhs.miner == rhs.miner && lhs.sector == rhs.sector;
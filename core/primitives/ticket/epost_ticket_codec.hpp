@@ -34,6 +34,9 @@ namespace fc::primitives::ticket {
   CBOR_DECODE(EPostTicket, ticket) {
     std::vector<uint8_t> data{};
     s.list() >> data >> ticket.sector_id >> ticket.challenge_index;
+    if (s.error()) {
+      return s;
+    }
     if (data.size() != ticket.partial.size()) {
       outcome::raise(EPoSTTicketCodecError::kInvalidPartialLength);
     }
@@ -53,6 +56,9 @@ namespace fc::primitives::ticket {
   CBOR_DECODE(EPostProof, epp) {
     std::vector<uint8_t> rand;
     s.list() >> epp.proofs >> rand >> epp.candidates;
+    if (s.error()) {
+      return s;
+    }
     if (rand.size() != epp.post_rand.size()) {
       outcome::raise(EPoSTTicketCodecError::kInvalidPostRandLength);
     }
@@ -40,6 +40,9 @@ namespace fc::primitives::ticket {
   CBOR_DECODE(Ticket, ticket) {
     std::vector<uint8_t> data{};
     s.list() >> data;
+    if (s.error()) {
+      return s;
+    }
     if (data.size() != ticket.bytes.size()) {
       outcome::raise(TicketCodecError::kInvalidTicketLength);
     }
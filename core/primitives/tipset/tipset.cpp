@@ -5,7 +5,11 @@
 
 #include "primitives/tipset/tipset.hpp"
 
+#include <boost/container_hash/hash.hpp>
+
 #include "common/logger.hpp"
+#include "common/lru_cache.hpp"
+#include "metrics/metrics.hpp"
 #include "primitives/address/address_codec.hpp"
 #include "primitives/cid/cid_of_cbor.hpp"
 
@@ -44,6 +48,18 @@ namespace fc::primitives::tipset {
   }
 
   outcome::result<Tipset> Tipset::create(std::vector<BlockHeader> blocks) {
+    std::vector<CID> cids;
+    cids.reserve(blocks.size());
+    for (auto &block : blocks) {
+      OUTCOME_TRY(cid, fc::primitives::cid::getCidOfCbor(block));
+      cids.push_back(std::move(cid));
+    }
+    return create(std::move(blocks), std::move(cids));
+  }
+
+  outcome::result<Tipset> Tipset::create(std::vector<BlockHeader> blocks,
+                                         std::vector<CID> cids) {
+    assert(blocks.size() == cids.size());
     // required to have at least one block
     if (blocks.empty()) {
       return TipsetError::kNoBlocks;
@@ -64,12 +80,9 @@ namespace fc::primitives::tipset {
 
     std::vector<std::pair<block::BlockHeader, CID>> items;
     items.reserve(blocks.size());
-    for (auto &block : blocks) {
-      assert(block.ticket);
-      OUTCOME_TRY(cid, fc::primitives::cid::getCidOfCbor(block));
-      // need to ensure that all cids are calculated before sort,
-      // since it will terminate program in case of exception
-      items.emplace_back(std::make_pair(std::move(block), cid));
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      assert(blocks[i].ticket);
+      items.emplace_back(std::move(blocks[i]), std::move(cids[i]));
     }
 
     // the sort function shouldn't throw exceptions
@@ -105,15 +118,82 @@ namespace fc::primitives::tipset {
     return ts;
   }
 
-  outcome::result<Tipset> Tipset::load(Ipld &ipld,
-                                       const std::vector<CID> &cids) {
+  namespace {
+    /// Max number of cached decoded block headers
+    constexpr size_t kHeaderCacheSize{8192};
+    /// Max number of cached tipsets, about a day of chain
+    constexpr size_t kTipsetCacheSize{4096};
+
+    /**
+     * Decoded headers and tipsets of one store.
+     * Blocks are content addressed, so entries never become stale.
+     */
+    struct LoadCache {
+      common::LruCache<CID, std::shared_ptr<const BlockHeader>> headers{
+          kHeaderCacheSize};
+      common::LruCache<TipsetKey, std::shared_ptr<const Tipset>> tipsets{
+          kTipsetCacheSize};
+    };
+
+    struct LoadCacheMetrics {
+      metrics::Counter &header_hits;
+      metrics::Counter &header_misses;
+      metrics::Counter &tipset_hits;
+      metrics::Counter &tipset_misses;
+    };
+
+    LoadCacheMetrics &loadCacheMetrics() {
+      static LoadCacheMetrics metrics{[] {
+        auto lookups{[](const char *cache,
+                        const char *result) -> metrics::Counter & {
+          return metrics::Registry::global().counter(
+              "fc_tipset_cache_lookups_total",
+              "Lookups of decoded headers and tipsets by Tipset::load",
+              {{"cache", cache}, {"result", result}});
+        }};
+        return LoadCacheMetrics{lookups("header", "hit"),
+                                lookups("header", "miss"),
+                                lookups("tipset", "hit"),
+                                lookups("tipset", "miss")};
+      }()};
+      return metrics;
+    }
+  }  // namespace
+
+  outcome::result<std::shared_ptr<const Tipset>> Tipset::loadShared(
+      Ipld &ipld, const std::vector<CID> &cids) {
+    auto &metrics{loadCacheMetrics()};
+    auto &cache{ipld.cache<LoadCache>()};
+    TipsetKey key{cids};
+    if (auto tipset{cache.tipsets.get(key)}) {
+      metrics.tipset_hits.inc();
+      return std::move(*tipset);
+    }
+    metrics.tipset_misses.inc();
     std::vector<BlockHeader> blocks;
     blocks.reserve(cids.size());
     for (auto &cid : cids) {
+      // tipsets of same height share blocks
+      if (auto header{cache.headers.get(cid)}) {
+        metrics.header_hits.inc();
+        blocks.push_back(**header);
+        continue;
+      }
+      metrics.header_misses.inc();
       OUTCOME_TRY(block, ipld.getCbor<BlockHeader>(cid));
+      cache.headers.put(cid, std::make_shared<const BlockHeader>(block));
       blocks.emplace_back(std::move(block));
     }
-    return create(std::move(blocks));
+    OUTCOME_TRY(tipset, create(std::move(blocks), cids));
+    auto shared{std::make_shared<const Tipset>(std::move(tipset))};
+    cache.tipsets.put(key, shared);
+    return std::move(shared);
+  }
+
+  outcome::result<Tipset> Tipset::load(Ipld &ipld,
+                                       const std::vector<CID> &cids) {
+    OUTCOME_TRY(tipset, loadShared(ipld, cids));
+    return *tipset;
   }
 
   outcome::result<Tipset> Tipset::loadParent(Ipld &ipld) const {
@@ -122,18 +202,18 @@ namespace fc::primitives::tipset {
 
   outcome::result<BeaconEntry> Tipset::latestBeacon(Ipld &ipld) const {
     auto ts{this};
-    Tipset parent;
+    std::shared_ptr<const Tipset> parent;
     // TODO: magic number from lotus
     for (auto i{0}; i < 20; ++i) {
-      auto beacons{ts->blks[0].beacon_entries};
+      auto &beacons{ts->blks[0].beacon_entries};
       if (!beacons.empty()) {
         return *beacons.rbegin();
       }
       if (ts->height == 0) {
         break;
       }
-      OUTCOME_TRYA(parent, ts->loadParent(ipld));
-      ts = &parent;
+      OUTCOME_TRYA(parent, loadShared(ipld, ts->blks[0].parents));
+      ts = parent.get();
     }
     return TipsetError::kNoBeacons;
   }
@@ -147,19 +227,65 @@ namespace fc::primitives::tipset {
     return outcome::success();
   }
 
+  namespace {
+    /// Tipset and round of randomness lookback
+    struct LookbackKey {
+      TipsetKey tipset;
+      ChainEpoch round;
+
+      bool operator==(const LookbackKey &other) const {
+        return round == other.round && tipset == other.tipset;
+      }
+    };
+
+    struct LookbackKeyHash {
+      size_t operator()(const LookbackKey &key) const {
+        auto seed{key.tipset.hash};
+        boost::hash_combine(seed, key.round);
+        return seed;
+      }
+    };
+
+    /// Max number of cached lookback tickets
+    constexpr size_t kLookbackCacheSize{4096};
+
+    /**
+     * Ticket of tipset found by walking back to round.
+     * Tipsets are content addressed, so entries never become stale.
+     */
+    auto &lookbackCache() {
+      static common::LruCache<LookbackKey, crypto::vrf::VRFProof,
+                              LookbackKeyHash>
+          cache{kLookbackCacheSize};
+      return cache;
+    }
+  }  // namespace
+
   outcome::result<Randomness> Tipset::randomness(
       Ipld &ipld,
       DomainSeparationTag tag,
       ChainEpoch round,
       gsl::span<const uint8_t> entropy) const {
-    auto ts{this};
-    Tipset parent;
-    while (ts->height != 0 && static_cast<ChainEpoch>(ts->height) > round) {
-      OUTCOME_TRYA(parent, ts->loadParent(ipld));
-      ts = &parent;
+    auto &cache{lookbackCache()};
+    LookbackKey key{TipsetKey{cids}, round};
+    auto ticket{cache.get(key)};
+    if (!ticket) {
+      auto ts{this};
+      std::shared_ptr<const Tipset> parent;
+      while (ts->height != 0 && static_cast<ChainEpoch>(ts->height) > round) {
+        OUTCOME_TRYA(parent, loadShared(ipld, ts->blks[0].parents));
+        ts = parent.get();
+        // resume from walk started by previous head
+        if ((ticket = cache.get({TipsetKey{ts->cids}, round}))) {
+          break;
+        }
+      }
+      if (!ticket) {
+        ticket = ts->getMinTicketBlock().ticket->bytes;
+      }
+      cache.put(key, *ticket);
     }
-    return crypto::randomness::drawRandomness(
-        ts->getMinTicketBlock().ticket->bytes, tag, round, entropy);
+    return crypto::randomness::drawRandomness(*ticket, tag, round, entropy);
   }
 
   TipsetKey Tipset::getParents() const {
@@ -47,6 +47,19 @@ namespace fc::primitives::tipset {
   struct Tipset {
     static outcome::result<Tipset> create(std::vector<BlockHeader> blocks);
 
+    /// Creates tipset from blocks with known cids, cids[i] of blocks[i]
+    static outcome::result<Tipset> create(std::vector<BlockHeader> blocks,
+                                          std::vector<CID> cids);
+
+    /**
+     * Loads tipset of blocks, decoded headers and assembled tipsets are
+     * kept in LRU caches of ipld, so recent chain is loaded without ipld
+     * lookups and without copies
+     */
+    static outcome::result<std::shared_ptr<const Tipset>> loadShared(
+        Ipld &ipld, const std::vector<CID> &cids);
+
+    /// Copy of tipset loaded by loadShared
     static outcome::result<Tipset> load(Ipld &ipld,
                                         const std::vector<CID> &cids);
 
@@ -57,6 +70,11 @@ namespace fc::primitives::tipset {
     outcome::result<void> visitMessages(
         IpldPtr ipld, const MessageVisitor::Visitor &visitor) const;
 
+    /**
+     * Draws randomness from ticket of tipset at round.
+     * Lookback tickets are cached by tipset key and round, so draws for
+     * recent rounds don't walk the chain again.
+     */
     outcome::result<Randomness> randomness(
         Ipld &ipld,
         DomainSeparationTag tag,
@@ -137,6 +155,7 @@ namespace fc::primitives::tipset {
     HeadChangeType type;
     Tipset value;
   };
+  CBOR_TUPLE(HeadChange, type, value)
 }  // namespace fc::primitives::tipset
 
 #endif  // CPP_FILECOIN_CORE_PRIMITIVES_TIPSET_TIPSET_HPP
@@ -77,6 +77,15 @@ namespace fc::primitives {
     DealWeight verified_deal_weight;
   };
 
+  /// Cores and memory of one NUMA node of worker
+  struct NumaNode {
+    /// Node number of kernel
+    uint64_t id;
+    /// Logical cores of node
+    std::vector<uint64_t> cpus;
+    uint64_t memory;
+  };
+
   struct WorkerResources {
     uint64_t physical_memory;
     uint64_t swap_memory;
@@ -85,6 +94,8 @@ namespace fc::primitives {
 
     uint64_t cpus;  // Logical cores
     std::vector<std::string> gpus;
+    /// Empty if worker has one node or topology is unknown
+    std::vector<NumaNode> numa_nodes;
   };
 
   struct WorkerInfo {
@@ -115,6 +126,20 @@ namespace fc::primitives {
   using SectorQuality = BigInt;
 
   CBOR_TUPLE(SectorStorageWeightDesc, sector_size, duration, deal_weight)
+
+  CBOR_TUPLE(StoragePath, id, weight, local_path, can_seal, can_store)
+
+  CBOR_TUPLE(NumaNode, id, cpus, memory)
+
+  CBOR_TUPLE(WorkerResources,
+             physical_memory,
+             swap_memory,
+             reserved_memory,
+             cpus,
+             gpus,
+             numa_nodes)
+
+  CBOR_TUPLE(WorkerInfo, hostname, resources)
 }  // namespace fc::primitives
 
 #endif  // CPP_FILECOIN_CORE_PRIMITIVES_TYPES_HPP
@@ -6,17 +6,24 @@
 #include "proofs/proof_param_provider.hpp"
 
 #include <cstdlib>
-#include <iostream>
-#include <regex>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <fstream>
+#include <map>
+#include <mutex>
 #include <string>
-#include <thread>
+
+#include <sys/stat.h>
 
 #include <curl/curl.h>
+#include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
 #include "common/outcome.hpp"
+#include "crypto/blake2/blake2b.h"
 #include "crypto/blake2/blake2b160.hpp"
 #include "proofs/proof_param_provider_error.hpp"
 
@@ -25,178 +32,430 @@ namespace fc::proofs {
   common::Logger ProofParamProvider::logger_ =
       common::createLogger("proofs params");
 
-  bool ProofParamProvider::errors_ = false;
+  namespace {
+    namespace fs = boost::filesystem;
 
-  auto write_data(void *ptr, size_t size, size_t nmemb, void *stream) {
-    return fwrite(ptr, size, nmemb, (FILE *)stream);
-  }
+    auto const default_gateway = "https://ipfs.io/ipfs/";
+    auto const param_dir = "/var/tmp/filecoin-proof-parameters";
+    auto const dir_env = "FIL_PROOFS_PARAMETER_CACHE";
+    /// File in param dir with stamps of files which matched their digests
+    auto const verified_file = ".verified";
+    constexpr size_t kParallelFetches{4};
+    constexpr int kPollMs{1000};
 
-  auto const default_gateway = "https://ipfs.io/ipfs/";
-  auto const param_dir = "/var/tmp/filecoin-proof-parameters";
-  auto const dir_env = "FIL_PROOFS_PARAMETER_CACHE";
+    std::string getParamDir() {
+      if (char *dir = std::getenv(dir_env)) return dir;
 
-  outcome::result<void> ProofParamProvider::doFetch(const std::string &out,
-                                                    const ParamFile &info) {
-    try {
-      /* init the curl session */
-      auto curl_handle = curl_easy_init();
+      return param_dir;
+    }
 
-      std::string gateway = default_gateway;
+    /// Gateways from comma separated IPFS_GATEWAY, tried in order
+    std::vector<std::string> getGateways() {
+      std::vector<std::string> gateways;
       if (auto custom_gateway = std::getenv("IPFS_GATEWAY")) {
-        gateway = custom_gateway;
+        boost::split(gateways, custom_gateway, boost::is_any_of(","));
       }
-
-      if (gateway[gateway.size() - 1] != '/') {
-        gateway += "/";
+      gateways.erase(std::remove(gateways.begin(), gateways.end(), ""),
+                     gateways.end());
+      if (gateways.empty()) {
+        gateways.emplace_back(default_gateway);
       }
+      for (auto &gateway : gateways) {
+        if (gateway.back() != '/') {
+          gateway += "/";
+        }
+      }
+      return gateways;
+    }
 
-      gateway += info.cid;
-
-      /* set URL to get here */
-      curl_easy_setopt(curl_handle, CURLOPT_URL, gateway.c_str());
+    bool trustParams() {
+      char *res = std::getenv("TRUST_PARAMS");
+      // Assuming parameter files are ok. DO NOT USE IN PRODUCTION
+      return res != nullptr && std::strcmp(res, "1") == 0;
+    }
 
-      /* Switch off full protocol/debug output while testing, set to 1L to
-       * enable it */
-      curl_easy_setopt(curl_handle, CURLOPT_VERBOSE, 0L);
+    std::string digestOf(blake2b_ctx &ctx) {
+      crypto::blake2b::Blake2b512Hash sum;
+      blake2b_final(&ctx, sum.data());
+      return common::hex_lower(gsl::make_span(sum).subspan(0, 16));
+    }
 
-      /* enable progress meter, set to 1L to disable it */
-      curl_easy_setopt(curl_handle, CURLOPT_NOPROGRESS, 0L);
+    /**
+     * Size, modification time and inode of file, which identify verified
+     * content. Replaced or rewritten file gets other stamp.
+     */
+    std::string fileStamp(const fs::path &path) {
+      struct stat info {};
+      if (stat(path.c_str(), &info) != 0) {
+        return {};
+      }
+      return std::to_string(info.st_size) + ":"
+             + std::to_string(info.st_mtime) + ":"
+             + std::to_string(info.st_ino);
+    }
 
-      /* send all data to this function  */
-      curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, write_data);
+    /// Hashes whole file, none if file cannot be read
+    boost::optional<std::string> hashFile(const fs::path &path) {
+      std::ifstream file{path.string(), std::ios::binary};
+      if (!file.is_open()) {
+        return boost::none;
+      }
+      blake2b_ctx ctx{};
+      blake2b_init(&ctx, crypto::blake2b::BLAKE2B512_HASH_LENGTH, nullptr, 0);
+      std::vector<char> buffer(1 << 20);
+      while (file.read(buffer.data(), buffer.size()), file.gcount() > 0) {
+        blake2b_update(&ctx, buffer.data(), file.gcount());
+      }
+      if (file.bad()) {
+        return boost::none;
+      }
+      return digestOf(ctx);
+    }
 
-      boost::uintmax_t f_size = boost::filesystem::exists(out)
-                                    ? boost::filesystem::file_size(out)
-                                    : 0;
+    /// Stamp and digest by name of verified file
+    using VerifiedFiles = std::map<std::string, std::string>;
 
-      struct curl_slist *chunk = NULL;
+    /// Serializes updates of manifest by downloads and verifications
+    std::mutex verified_mutex;
 
-      std::string header = "Range: bytes=" + std::to_string(f_size) + "-";
+    VerifiedFiles readVerified(const fs::path &dir) {
+      VerifiedFiles verified;
+      std::ifstream file{(dir / verified_file).string()};
+      std::string name, stamp, digest;
+      while (file >> name >> stamp >> digest) {
+        verified[name] = stamp + " " + digest;
+      }
+      return verified;
+    }
 
-      chunk = curl_slist_append(chunk, header.c_str());
+    void writeVerified(const fs::path &dir, const VerifiedFiles &verified) {
+      auto path{dir / verified_file};
+      auto temp_path{path.string() + ".tmp"};
+      {
+        std::ofstream file{temp_path, std::ios::trunc};
+        for (const auto &[name, entry] : verified) {
+          file << name << " " << entry << "\n";
+        }
+        if (!file.good()) {
+          return;
+        }
+      }
+      boost::system::error_code ec;
+      fs::rename(temp_path, path, ec);
+    }
 
-      curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, chunk);
+    /// Applies changes to manifest, which may be updated concurrently
+    void updateVerified(const fs::path &dir,
+                        const std::function<void(VerifiedFiles &)> &update) {
+      std::lock_guard lock{verified_mutex};
+      auto verified{readVerified(dir)};
+      update(verified);
+      writeVerified(dir, verified);
+    }
 
-      /* open the file */
-      auto pagefile = fopen(out.c_str(), "ab");
-      if (pagefile) {
-        /* write the page body to this file handle */
-        curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, pagefile);
+    /**
+     * Download of param file, which is hashed while it is written.
+     * Existing part of file is hashed, and download continues after it.
+     */
+    struct Download {
+      Download() = default;
+      Download(const Download &) = delete;
+      Download &operator=(const Download &) = delete;
+
+      ~Download() {
+        close();
+      }
 
-        /* get it! */
-        curl_easy_perform(curl_handle);
+      void close() {
+        if (curl) {
+          curl_easy_cleanup(curl);
+          curl = nullptr;
+        }
+        if (headers) {
+          curl_slist_free_all(headers);
+          headers = nullptr;
+        }
+        if (file) {
+          fclose(file);
+          file = nullptr;
+        }
+      }
 
-        /* close the header file */
-        fclose(pagefile);
+      static size_t onData(const char *ptr,
+                           size_t size,
+                           size_t nmemb,
+                           Download *download) {
+        if (download->offset != 0 && !download->checked_range) {
+          download->checked_range = true;
+          long status_code{};
+          curl_easy_getinfo(
+              download->curl, CURLINFO_RESPONSE_CODE, &status_code);
+          // gateway ignored range and sends whole file
+          if (status_code == 200) {
+            download->restart();
+          }
+        }
+        auto written{fwrite(ptr, size, nmemb, download->file) * size};
+        blake2b_update(&download->ctx, ptr, written);
+        return written;
       }
 
-      /* cleanup curl stuff */
-      curl_easy_cleanup(curl_handle);
+      /// Hashes existing part of file
+      void hashExisting() {
+        blake2b_init(
+            &ctx, crypto::blake2b::BLAKE2B512_HASH_LENGTH, nullptr, 0);
+        offset = 0;
+        std::ifstream existing{path.string(), std::ios::binary};
+        std::vector<char> buffer(1 << 20);
+        while (existing.read(buffer.data(), buffer.size()),
+               existing.gcount() > 0) {
+          blake2b_update(&ctx, buffer.data(), existing.gcount());
+          offset += existing.gcount();
+        }
+        hashed = true;
+      }
 
-      curl_slist_free_all(chunk);
+      /// Whether existing part of file is whole file, hashExisting first
+      bool existingComplete() const {
+        auto copy{ctx};
+        return offset != 0 && digestOf(copy) == info.digest;
+      }
 
-    } catch (std::exception const &e) {
-      logger_->error("Error: " + std::string(e.what()));
-      return ProofParamProviderError::kFailedDownloading;
-    }
-    return outcome::success();
-  }
+      /// Starts request to gateway, continuing existing part of file
+      bool start(const std::string &gateway) {
+        close();
+        checked_range = false;
+        if (!hashed) {
+          hashExisting();
+        }
+        // file may change by failed attempt, so next one hashes it again
+        hashed = false;
+        file = fopen(path.c_str(), "ab");
+        curl = curl_easy_init();
+        if (!file || !curl) {
+          return false;
+        }
+        url = gateway + info.cid;
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        // error bodies, like of unsatisfiable range, are not written to file
+        curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, onData);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
+        curl_easy_setopt(curl, CURLOPT_PRIVATE, this);
+        if (offset != 0) {
+          auto header{"Range: bytes=" + std::to_string(offset) + "-"};
+          headers = curl_slist_append(headers, header.c_str());
+          curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        }
+        return true;
+      }
 
-  std::string getParamDir() {
-    if (char *dir = std::getenv(dir_env)) return dir;
+      /// Drops existing part of file
+      void restart() {
+        fflush(file);
+        boost::system::error_code ec;
+        fs::resize_file(path, 0, ec);
+        blake2b_init(
+            &ctx, crypto::blake2b::BLAKE2B512_HASH_LENGTH, nullptr, 0);
+        offset = 0;
+      }
 
-    return param_dir;
-  }
+      ParamFile info;
+      fs::path path;
+      /// Index of gateway of current attempt
+      size_t gateway{};
+      /// Size of existing part of file
+      uint64_t offset{};
+      /// Existing part of file is hashed for next start
+      bool hashed{};
+      bool checked_range{};
+      std::string url;
+      blake2b_ctx ctx{};
+      CURL *curl{};
+      curl_slist *headers{};
+      FILE *file{};
+    };
+  }  // namespace
 
   outcome::result<void> ProofParamProvider::getParams(
       const gsl::span<ParamFile> &param_files, uint64_t storage_size) {
+    const fs::path dir{getParamDir()};
     try {
-      boost::filesystem::create_directories(getParamDir());
+      fs::create_directories(dir);
     } catch (const std::exception &e) {
       logger_->error("Error:" + std::string(e.what()));
       return ProofParamProviderError::kCannotCreateDir;
     }
 
-    curl_global_init(CURL_GLOBAL_ALL);
-    errors_ = false;
-    std::vector<std::thread> threads;
+    auto verified{readVerified(dir)};
+    /// Entries of files verified by this call
+    VerifiedFiles updates;
+    std::deque<std::unique_ptr<Download>> pending;
     for (const auto &param_file : param_files) {
       if (param_file.sector_size != storage_size) {
         continue;
       }
-
-      threads.emplace_back(std::thread{fetch, param_file});
-    }
-
-    for (auto &th : threads) {
-      th.join();
+      auto path{dir / param_file.name};
+      auto entry{verified.find(param_file.name)};
+      if (trustParams()
+          || (entry != verified.end()
+              && entry->second
+                     == fileStamp(path) + " " + param_file.digest)) {
+        logger_->info(param_file.name + " already downloaded");
+        continue;
+      }
+      auto download{std::make_unique<Download>()};
+      download->info = param_file;
+      download->path = path;
+      // complete file without manifest entry is not requested again
+      download->hashExisting();
+      if (download->existingComplete()) {
+        updates[param_file.name] = fileStamp(path) + " " + param_file.digest;
+        logger_->info(param_file.name + " already downloaded");
+        continue;
+      }
+      pending.push_back(std::move(download));
     }
-    curl_global_cleanup();
 
-    if (!errors_) return outcome::success();
+    const auto gateways{getGateways()};
+    bool errors{false};
+
+    /// Whether download completed and matched digest
+    auto finish{[&](Download &download, bool completed) {
+      download.close();
+      if (completed && digestOf(download.ctx) == download.info.digest) {
+        updates[download.info.name] =
+            fileStamp(download.path) + " " + download.info.digest;
+        logger_->info(download.info.name + " downloaded successfully");
+        return true;
+      }
+      if (completed) {
+        logger_->warn(download.info.name + ": "
+                      + make_error_code(
+                            ProofParamProviderError::kChecksumMismatch)
+                            .message());
+        // corrupt file, next attempt starts from zero
+        boost::system::error_code ec;
+        fs::remove(download.path, ec);
+      }
+      return false;
+    }};
 
-    return ProofParamProviderError::kFailedDownloading;
-  }
+    curl_global_init(CURL_GLOBAL_ALL);
+    auto multi{curl_multi_init()};
+    std::vector<std::unique_ptr<Download>> active;
+
+    /// Starts download from its gateway or next ones
+    auto launch{[&](std::unique_ptr<Download> download) {
+      for (; download->gateway < gateways.size(); ++download->gateway) {
+        if (download->start(gateways[download->gateway])) {
+          logger_->info("Fetch " + download->url);
+          curl_multi_add_handle(multi, download->curl);
+          active.push_back(std::move(download));
+          return;
+        }
+      }
+      logger_->error("Failed to fetch " + download->info.name);
+      errors = true;
+    }};
+
+    while (!pending.empty() || !active.empty()) {
+      while (!pending.empty() && active.size() < kParallelFetches) {
+        auto download{std::move(pending.front())};
+        pending.pop_front();
+        launch(std::move(download));
+      }
 
-  outcome::result<void> checkFile(const std::string &path,
-                                  const ParamFile &info) {
-    char *res = std::getenv("TRUST_PARAMS");
-    if (res != nullptr && std::strcmp(res, "1") == 0) {
-      // Assuming parameter files are ok. DO NOT USE IN PRODUCTION
-      return outcome::success();
+      int running{};
+      curl_multi_perform(multi, &running);
+      int left{};
+      while (auto message{curl_multi_info_read(multi, &left)}) {
+        if (message->msg != CURLMSG_DONE) {
+          continue;
+        }
+        auto easy{message->easy_handle};
+        auto result{message->data.result};
+        char *private_data{};
+        curl_easy_getinfo(easy, CURLINFO_PRIVATE, &private_data);
+        long status_code{};
+        curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &status_code);
+        curl_multi_remove_handle(multi, easy);
+
+        auto it{std::find_if(active.begin(), active.end(), [&](auto &item) {
+          return item.get() == reinterpret_cast<Download *>(private_data);
+        })};
+        auto download{std::move(*it)};
+        active.erase(it);
+        if (!finish(*download,
+                    result == CURLE_OK
+                        && (status_code == 200 || status_code == 206))) {
+          logger_->warn("Failed to fetch " + download->url);
+          ++download->gateway;
+          launch(std::move(download));
+        }
+      }
+      if (!active.empty()) {
+        curl_multi_wait(multi, nullptr, 0, kPollMs, nullptr);
+      }
     }
+    curl_multi_cleanup(multi);
+    curl_global_cleanup();
 
-    std::ifstream ifs(path, std::ios::binary);
-
-    if (!ifs.is_open()) return ProofParamProviderError::kFileDoesNotOpen;
-
-    auto sum = crypto::blake2b::blake2b_512_from_file(ifs);
+    updateVerified(dir, [&](auto &verified) {
+      for (auto &[name, entry] : updates) {
+        verified[name] = entry;
+      }
+    });
 
-    auto our_some = common::hex_lower(gsl::make_span(sum).subspan(0, 16));
-    if (our_some != info.digest) {
-      return ProofParamProviderError::kChecksumMismatch;
-    }
+    if (!errors) return outcome::success();
 
-    return outcome::success();
+    return ProofParamProviderError::kFailedDownloading;
   }
 
-  void ProofParamProvider::fetch(const ParamFile &info) {
-    auto path = boost::filesystem::path(getParamDir())
-                / boost::filesystem::path(info.name);
-
-    logger_->info("Fetch " + info.name);
-    auto res = checkFile(path.string(), info);
-    if (!res.has_error()) {
-      logger_->info(info.name + " already downloaded");
-      return;
-    }
-    if (boost::filesystem::exists(path)) {
-      logger_->warn(res.error().message());
-    }
-
-    static std::mutex mutex;
-    std::lock_guard<std::mutex> lock(mutex);
-
-    auto fetch_res = doFetch(path.string(), info);
-
-    if (fetch_res.has_error()) {
-      errors_ = true;
-      logger_->error(res.error().message());
-
-      return;
+  outcome::result<void> ProofParamProvider::verifyParams(
+      const gsl::span<const ParamFile> &param_files, uint64_t storage_size) {
+    const fs::path dir{getParamDir()};
+    bool mismatch{false};
+    for (const auto &param_file : param_files) {
+      if (param_file.sector_size != storage_size) {
+        continue;
+      }
+      auto path{dir / param_file.name};
+      auto stamp{fileStamp(path)};
+      if (stamp.empty()) {
+        continue;
+      }
+      auto digest{hashFile(path)};
+      // file may change while it is hashed
+      auto valid{digest == param_file.digest && fileStamp(path) == stamp};
+      updateVerified(dir, [&](auto &verified) {
+        if (valid) {
+          verified[param_file.name] = stamp + " " + param_file.digest;
+        } else {
+          verified.erase(param_file.name);
+        }
+      });
+      if (!valid) {
+        logger_->warn(param_file.name + ": "
+                      + make_error_code(
+                            ProofParamProviderError::kChecksumMismatch)
+                            .message());
+        mismatch = true;
+      }
     }
 
-    res = checkFile(path.string(), info);
-
-    if (res.has_error()) {
-      errors_ = true;
-      logger_->error(res.error().message());
-      boost::filesystem::remove(path);
+    if (!mismatch) return outcome::success();
 
-      return;
-    }
+    return ProofParamProviderError::kChecksumMismatch;
+  }
 
-    logger_->info(info.name + " downloaded successfully");
+  std::future<outcome::result<void>> ProofParamProvider::verifyParamsAsync(
+      std::vector<ParamFile> param_files, uint64_t storage_size) {
+    return std::async(std::launch::async,
+                      [param_files{std::move(param_files)}, storage_size] {
+                        return verifyParams(param_files, storage_size);
+                      });
   }
 
   namespace pt = boost::property_tree;
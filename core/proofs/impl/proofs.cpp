@@ -9,105 +9,15 @@
 #include <filecoin-ffi/filcrypto.h>
 
 #include <boost/filesystem.hpp>
+#include "codec/cbor/cbor.hpp"
 #include "common/ffi.hpp"
+#include "crypto/verify_cache/verify_cache.hpp"
 #include "primitives/address/address.hpp"
 #include "primitives/address/address_codec.hpp"
 #include "primitives/cid/comm_cid.hpp"
+#include "primitives/piece/fr32.hpp"
 #include "proofs/proofs_error.hpp"
 
-namespace {
-  void unpad(gsl::span<const uint8_t> in, gsl::span<uint8_t> out) {
-    auto chunks = in.size() / 128;
-    for (auto chunk = 0; chunk < chunks; chunk++) {
-      auto input_offset_next = chunk * 128 + 1;
-      auto output_offset = chunk * 127;
-
-      auto current = in[chunk * 128];
-
-      for (size_t i = 0; i < 32; i++) {
-        out[output_offset + i] = current;
-
-        current = in[i + input_offset_next];
-      }
-
-      out[output_offset + 31] |= current << 6;
-
-      for (size_t i = 32; i < 64; i++) {
-        auto next = in[i + input_offset_next];
-
-        out[output_offset + i] = current >> 2;
-        out[output_offset + i] |= next << 6;
-
-        current = next;
-      }
-
-      out[output_offset + 63] ^= (current << 6) ^ (current << 4);
-
-      for (size_t i = 64; i < 96; i++) {
-        auto next = in[i + input_offset_next];
-
-        out[output_offset + i] = current >> 4;
-        out[output_offset + i] |= next << 4;
-
-        current = next;
-      }
-
-      out[output_offset + 95] ^= (current << 4) ^ (current << 2);
-
-      for (size_t i = 96; i < 127; i++) {
-        auto next = in[i + input_offset_next];
-
-        out[output_offset + i] = current >> 6;
-        out[output_offset + i] |= next << 2;
-
-        current = next;
-      }
-    }
-  }
-
-  void pad(gsl::span<const uint8_t> in, gsl::span<uint8_t> out) {
-    auto chunks = out.size() / 128;
-    for (auto chunk = 0; chunk < chunks; chunk++) {
-      size_t input_offset = chunk * 127;
-      size_t output_offset = chunk * 128;
-
-      std::copy(in.begin() + input_offset,
-                in.begin() + input_offset + 31,
-                out.begin() + output_offset);
-
-      auto t = in[input_offset + 31] >> 6;
-      out[output_offset + 31] = in[input_offset + 31] & 0x3f;
-      uint8_t v;
-
-      for (int i = 32; i < 64; i++) {
-        v = in[input_offset + i];
-        out[output_offset + i] = (v << 2) | t;
-        t = v >> 6;
-      }
-
-      t = v >> 4;
-      out[output_offset + 63] &= 0x3f;
-
-      for (size_t i = 64; i < 96; i++) {
-        v = in[input_offset + i];
-        out[output_offset + i] = (v << 4) | t;
-        t = v >> 4;
-      }
-
-      t = v >> 2;
-      out[output_offset + 95] &= 0x3f;
-
-      for (size_t i = 96; i < 127; i++) {
-        v = in[input_offset + i];
-        out[output_offset + i] = (v << 6) | t;
-        t = v >> 2;
-      }
-
-      out[output_offset + 127] = t & 0x3f;
-    }
-  }
-}  // namespace
-
 namespace fc::proofs {
   namespace ffi = common::ffi;
   namespace fs = boost::filesystem;
@@ -124,7 +34,10 @@ namespace fc::proofs {
   using common::kCommitmentBytesLen;
   using common::pieceCommitmentV1ToCID;
   using common::replicaCommitmentV1ToCID;
+  using crypto::VerifyKind;
   using crypto::randomness::Randomness;
+  using primitives::piece::pad;
+  using primitives::piece::unpad;
   using primitives::sector::getRegisteredSealProof;
   using primitives::sector::getRegisteredWindowPoStProof;
   using primitives::sector::getRegisteredWinningPoStProof;
@@ -440,85 +353,129 @@ namespace fc::proofs {
   // VERIFIED FUNCTIONS
   // ******************
 
+  namespace {
+    template <typename PoStVerifyInfo>
+    outcome::result<Buffer> postVerifyKey(VerifyKind kind,
+                                          const PoStVerifyInfo &info) {
+      try {
+        auto s{codec::cbor::CborEncodeStream::list()};
+        s << static_cast<uint8_t>(kind) << info.randomness << info.proofs;
+        auto sectors{s.list()};
+        for (auto &sector : info.challenged_sectors) {
+          sectors << sector.registered_proof << sector.sector
+                  << sector.sealed_cid;
+        }
+        s << sectors << info.prover;
+        return Buffer{s.data()};
+      } catch (std::system_error &e) {
+        return outcome::failure(e.code());
+      }
+    }
+  }  // namespace
+
   outcome::result<bool> Proofs::verifyWinningPoSt(
       const WinningPoStVerifyInfo &info) {
-    OUTCOME_TRY(
-        c_public_replica_infos,
-        cPublicReplicaInfos(info.challenged_sectors, PoStType::Winning));
-    OUTCOME_TRY(c_post_proofs,
-                cPoStProofs(gsl::make_span(info.proofs), PoStType::Winning));
-    auto prover_id = toProverID(info.prover);
-
-    auto res_ptr =
-        ffi::wrap(fil_verify_winning_post(c32ByteArray(info.randomness),
-                                          c_public_replica_infos.data(),
-                                          c_public_replica_infos.size(),
-                                          c_post_proofs.data(),
-                                          c_post_proofs.size(),
-                                          prover_id),
-                  fil_destroy_verify_winning_post_response);
+    // results are cached, so block validated again is not verified again
+    OUTCOME_TRY(key, postVerifyKey(VerifyKind::kWinningPoSt, info));
+    auto verify{[&]() -> outcome::result<bool> {
+      OUTCOME_TRY(
+          c_public_replica_infos,
+          cPublicReplicaInfos(info.challenged_sectors, PoStType::Winning));
+      OUTCOME_TRY(c_post_proofs,
+                  cPoStProofs(gsl::make_span(info.proofs), PoStType::Winning));
+      auto prover_id = toProverID(info.prover);
+
+      auto res_ptr =
+          ffi::wrap(fil_verify_winning_post(c32ByteArray(info.randomness),
+                                            c_public_replica_infos.data(),
+                                            c_public_replica_infos.size(),
+                                            c_post_proofs.data(),
+                                            c_post_proofs.size(),
+                                            prover_id),
+                    fil_destroy_verify_winning_post_response);
 
-    if (res_ptr->status_code != 0) {
-      logger_->error("verifyWindowPoSt: " + std::string(res_ptr->error_msg));
-      return ProofsError::kUnknown;
-    }
+      if (res_ptr->status_code != 0) {
+        logger_->error("verifyWindowPoSt: " + std::string(res_ptr->error_msg));
+        return ProofsError::kUnknown;
+      }
 
-    return res_ptr->is_valid;
+      return res_ptr->is_valid;
+    }};
+    return crypto::VerifyCache::shared().verify(key, verify);
   }
 
   outcome::result<bool> Proofs::verifyWindowPoSt(
       const WindowPoStVerifyInfo &info) {
-    OUTCOME_TRY(c_public_replica_infos,
-                cPublicReplicaInfos(info.challenged_sectors, PoStType::Window));
-    OUTCOME_TRY(c_post_proofs,
-                cPoStProofs(gsl::make_span(info.proofs), PoStType::Window));
-    auto prover_id = toProverID(info.prover);
-
-    auto res_ptr =
-        ffi::wrap(fil_verify_window_post(c32ByteArray(info.randomness),
-                                         c_public_replica_infos.data(),
-                                         c_public_replica_infos.size(),
-                                         c_post_proofs.data(),
-                                         c_post_proofs.size(),
-                                         prover_id),
-                  fil_destroy_verify_window_post_response);
+    OUTCOME_TRY(key, postVerifyKey(VerifyKind::kWindowPoSt, info));
+    auto verify{[&]() -> outcome::result<bool> {
+      OUTCOME_TRY(
+          c_public_replica_infos,
+          cPublicReplicaInfos(info.challenged_sectors, PoStType::Window));
+      OUTCOME_TRY(c_post_proofs,
+                  cPoStProofs(gsl::make_span(info.proofs), PoStType::Window));
+      auto prover_id = toProverID(info.prover);
+
+      auto res_ptr =
+          ffi::wrap(fil_verify_window_post(c32ByteArray(info.randomness),
+                                           c_public_replica_infos.data(),
+                                           c_public_replica_infos.size(),
+                                           c_post_proofs.data(),
+                                           c_post_proofs.size(),
+                                           prover_id),
+                    fil_destroy_verify_window_post_response);
 
-    if (res_ptr->status_code != 0) {
-      logger_->error("verifyWindowPoSt: " + std::string(res_ptr->error_msg));
-      return ProofsError::kUnknown;
-    }
+      if (res_ptr->status_code != 0) {
+        logger_->error("verifyWindowPoSt: " + std::string(res_ptr->error_msg));
+        return ProofsError::kUnknown;
+      }
 
-    return res_ptr->is_valid;
+      return res_ptr->is_valid;
+    }};
+    return crypto::VerifyCache::shared().verify(key, verify);
   }
 
   outcome::result<bool> Proofs::verifySeal(const SealVerifyInfo &info) {
-    OUTCOME_TRY(c_proof_type, cRegisteredSealProof(info.info.registered_proof));
+    Buffer key;
+    try {
+      auto s{codec::cbor::CborEncodeStream::list()};
+      s << static_cast<uint8_t>(VerifyKind::kSeal) << info.sector << info.info
+        << info.randomness << info.interactive_randomness
+        << info.unsealed_cid;
+      key = Buffer{s.data()};
+    } catch (std::system_error &e) {
+      return outcome::failure(e.code());
+    }
+    auto verify{[&]() -> outcome::result<bool> {
+      OUTCOME_TRY(c_proof_type,
+                  cRegisteredSealProof(info.info.registered_proof));
 
-    OUTCOME_TRY(comm_r, CIDToReplicaCommitmentV1(info.info.sealed_cid));
+      OUTCOME_TRY(comm_r, CIDToReplicaCommitmentV1(info.info.sealed_cid));
 
-    OUTCOME_TRY(comm_d, CIDToDataCommitmentV1(info.unsealed_cid));
+      OUTCOME_TRY(comm_d, CIDToDataCommitmentV1(info.unsealed_cid));
 
-    auto prover_id = toProverID(info.sector.miner);
+      auto prover_id = toProverID(info.sector.miner);
 
-    auto res_ptr =
-        ffi::wrap(fil_verify_seal(c_proof_type,
-                                  c32ByteArray(comm_r),
-                                  c32ByteArray(comm_d),
-                                  prover_id,
-                                  c32ByteArray(info.randomness),
-                                  c32ByteArray(info.interactive_randomness),
-                                  info.info.sector,
-                                  info.info.proof.data(),
-                                  info.info.proof.size()),
-                  fil_destroy_verify_seal_response);
+      auto res_ptr =
+          ffi::wrap(fil_verify_seal(c_proof_type,
+                                    c32ByteArray(comm_r),
+                                    c32ByteArray(comm_d),
+                                    prover_id,
+                                    c32ByteArray(info.randomness),
+                                    c32ByteArray(info.interactive_randomness),
+                                    info.info.sector,
+                                    info.info.proof.data(),
+                                    info.info.proof.size()),
+                    fil_destroy_verify_seal_response);
 
-    if (res_ptr->status_code != 0) {
-      logger_->error("verifySeal: " + std::string(res_ptr->error_msg));
+      if (res_ptr->status_code != 0) {
+        logger_->error("verifySeal: " + std::string(res_ptr->error_msg));
 
-      return ProofsError::kUnknown;
-    }
+        return ProofsError::kUnknown;
+      }
 
-    return res_ptr->is_valid;
+      return res_ptr->is_valid;
+    }};
+    return crypto::VerifyCache::shared().verify(key, verify);
   }
 
   // ******************
@@ -1066,26 +1023,19 @@ namespace fc::proofs {
     }
 
     uint64_t left = piece_size;
-    constexpr auto kDefaultBufferSize = uint64_t(32 * 1024);
-    std::vector<uint8_t> buffer(kDefaultBufferSize);
-    auto chunks = kDefaultBufferSize / 127;
-    PaddedPieceSize outTwoPow =
-        primitives::piece::paddedSize(chunks * 128).padded();
+    // padded bytes read at once, power of two
+    constexpr auto kDefaultBufferSize = uint64_t(1 << 20);
+    PaddedPieceSize outTwoPow{std::min<uint64_t>(kDefaultBufferSize,
+                                                 piece_size.padded())};
+    std::vector<uint8_t> read(outTwoPow);
+    std::vector<uint8_t> buffer(outTwoPow.unpadded());
 
     while (left > 0) {
       if (left < outTwoPow.unpadded()) {
         outTwoPow = primitives::piece::paddedSize(left).padded();
       }
-      std::vector<uint8_t> read(outTwoPow);
-
-      size_t j;
-      char ch;
-      for (j = 0; j < outTwoPow && input; j++) {
-        input.get(ch);
-        read[j] = ch;
-      }
 
-      if (j != outTwoPow) {
+      if (!input.read(reinterpret_cast<char *>(read.data()), outTwoPow)) {
         return ProofsError::kNotReadEnough;
       }
 
@@ -6,6 +6,8 @@
 #ifndef CPP_FILECOIN_PROOF_PARAM_PROVIDER_HPP
 #define CPP_FILECOIN_PROOF_PARAM_PROVIDER_HPP
 
+#include <future>
+
 #include "common/logger.hpp"
 #include "common/outcome.hpp"
 #include "gsl/span"
@@ -23,19 +25,30 @@ namespace fc::proofs {
 
   class ProofParamProvider {
    public:
+    /**
+     * Downloads missing param files for sector size. Files listed in
+     * verification manifest of param dir with same size, modification time
+     * and inode are trusted without rehashing.
+     */
     static outcome::result<void> getParams(
         const gsl::span<ParamFile> &param_files, uint64_t storage_size);
 
+    /**
+     * Rehashes all existing param files for sector size and updates
+     * verification manifest, mismatching files are dropped from it, so next
+     * getParams downloads them again.
+     */
+    static outcome::result<void> verifyParams(
+        const gsl::span<const ParamFile> &param_files, uint64_t storage_size);
+
+    /// Runs verifyParams in background thread
+    static std::future<outcome::result<void>> verifyParamsAsync(
+        std::vector<ParamFile> param_files, uint64_t storage_size);
+
     static outcome::result<std::vector<ParamFile>> readJson(
         const std::string &path);
 
    private:
-    static void fetch(const ParamFile &info);
-    static outcome::result<void> doFetch(const std::string &out,
-                                         const ParamFile &info);
-
-    static bool errors_;
-
     static common::Logger logger_;
   };
 
@@ -7,6 +7,7 @@
 #define CPP_FILECOIN_CORE_PROOFS_HPP
 
 #include <vector>
+#include "codec/cbor/streams_annotation.hpp"
 #include "common/blob.hpp"
 #include "common/logger.hpp"
 #include "common/outcome.hpp"
@@ -84,6 +85,7 @@ namespace fc::proofs {
     CID sealed_cid;
     CID unsealed_cid;
   };
+  CBOR_TUPLE(SealedAndUnsealedCID, sealed_cid, unsealed_cid)
 
   class Proofs {
    public:
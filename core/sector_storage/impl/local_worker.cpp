@@ -15,7 +15,9 @@
 #include <boost/filesystem.hpp>
 #include <thread>
 #include "proofs/proofs.hpp"
+#include "sector_storage/impl/numa.hpp"
 #include "sector_storage/stores/store_error.hpp"
+#include "sector_storage/stores/unsealed_ranges.hpp"
 
 namespace fc::sector_storage {
 
@@ -28,6 +30,7 @@ namespace fc::sector_storage {
         local_store_(remote_store_->getLocalStore()),
         index_(local_store_->getSectorIndex()),
         config_(std::move(config)),
+        numa_nodes_(numa::detectNodes()),
         logger_(common::createLogger("local worker")) {}
 
   outcome::result<sector_storage::PreCommit1Output>
@@ -85,6 +88,7 @@ namespace fc::sector_storage {
       return WorkerErrors::kPiecesDoNotMatchSectorSize;
     }
 
+    numa::Binding binding{numa::assignedNode()};
     return proofs::Proofs::sealPreCommitPhase1(config_.seal_proof_type,
                                                response.paths.cache,
                                                response.paths.unsealed,
@@ -108,6 +112,7 @@ namespace fc::sector_storage {
                     SectorFileType::FTNone,
                     true));
 
+    numa::Binding binding{numa::assignedNode()};
     return proofs::Proofs::sealPreCommitPhase2(
         pre_commit_1_output, response.paths.cache, response.paths.sealed);
   }
@@ -213,6 +218,16 @@ namespace fc::sector_storage {
       if (maybe_unseal_file.has_error()) {
         return maybe_unseal_file.error();
       }
+      stores::removeUnsealedRanges(maybe_unseal_file.value().paths.unsealed);
+    }
+
+    const auto &unsealed_path{maybe_unseal_file.value().paths.unsealed};
+    const auto padded_offset{primitives::piece::paddedIndex(offset)};
+    OUTCOME_TRY(unsealed,
+                stores::isUnsealed(
+                    unsealed_path, padded_offset, size.padded()));
+    if (unsealed) {
+      return outcome::success();
     }
 
     OUTCOME_TRY(response,
@@ -251,15 +266,17 @@ namespace fc::sector_storage {
                                     sector.miner,
                                     randomness,
                                     unsealed_cid,
-                                    primitives::piece::paddedIndex(offset),
+                                    padded_offset,
                                     size.padded()));
 
-    return proofs::Proofs::writeUnsealPiece(
-        temp_file_path.string(),
-        maybe_unseal_file.value().paths.unsealed,
-        config_.seal_proof_type,
-        PaddedPieceSize(primitives::piece::paddedIndex(offset)),
-        size);
+    OUTCOME_TRY(proofs::Proofs::writeUnsealPiece(temp_file_path.string(),
+                                                 unsealed_path,
+                                                 config_.seal_proof_type,
+                                                 PaddedPieceSize(padded_offset),
+                                                 size));
+
+    return stores::addUnsealedRange(
+        unsealed_path, padded_offset, size.padded());
   }
 
   outcome::result<void> sector_storage::LocalWorker::readPiece(
@@ -398,6 +415,7 @@ namespace fc::sector_storage {
     }
 
     OUTCOME_TRYA(result.resources.gpus, proofs::Proofs::getGPUDevices());
+    result.resources.numa_nodes = numa_nodes_;
 
     return std::move(result);
   }
@@ -83,6 +83,8 @@ namespace fc::sector_storage {
     std::shared_ptr<stores::SectorIndex> index_;
 
     WorkerConfig config_;
+    /// Detected once, topology doesn't change while worker runs
+    std::vector<primitives::NumaNode> numa_nodes_;
     common::Logger logger_;
   };
 
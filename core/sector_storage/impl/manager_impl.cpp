@@ -5,20 +5,91 @@
 
 #include "sector_storage/impl/manager_impl.hpp"
 
+#include <fcntl.h>
 #include <pwd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
 #include <boost/filesystem.hpp>
+#include <condition_variable>
+#include <future>
 #include <unordered_set>
+#include "metrics/tracing.hpp"
 #include "sector_storage/impl/allocate_selector.hpp"
 #include "sector_storage/impl/existing_selector.hpp"
 #include "sector_storage/impl/local_worker.hpp"
 #include "sector_storage/impl/task_selector.hpp"
 #include "sector_storage/stores/store_error.hpp"
+#include "sector_storage/stores/unsealed_ranges.hpp"
 
 namespace fs = boost::filesystem;
 using fc::primitives::sector_file::SectorFileType;
 using fc::primitives::sector_file::sectorName;
+using fc::metrics::tracing::ScopedSpan;
+using fc::metrics::tracing::Span;
 
 namespace {
+  /// Sectors acquired at once for PoSt, bounds threads of acquisition
+  constexpr size_t kParallelPoStAcquires{16};
+  /// Threads checking sectors provable
+  constexpr size_t kParallelProvableChecks{32};
+  /// Sectors checked at once on one storage, so slow storage is not flooded
+  constexpr size_t kProvableChecksPerStorage{8};
+
+  /// Bounds number of concurrent users of each storage
+  class StorageLimiter {
+   public:
+    explicit StorageLimiter(size_t limit) : limit_{limit} {}
+
+    void acquire(const std::string &storage) {
+      std::unique_lock lock{mutex_};
+      cv_.wait(lock, [&] { return busy_[storage] < limit_; });
+      ++busy_[storage];
+    }
+
+    void release(const std::string &storage) {
+      {
+        std::lock_guard lock{mutex_};
+        --busy_[storage];
+      }
+      cv_.notify_all();
+    }
+
+   private:
+    size_t limit_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::unordered_map<std::string, size_t> busy_;
+  };
+
+  /// Starts asynchronous read of file into page cache
+  void willNeed(const std::string &path) {
+#ifdef POSIX_FADV_WILLNEED
+    auto fd{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (fd != -1) {
+      ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+      ::close(fd);
+    }
+#endif
+  }
+
+  /// Inode, modification time and size of file, none if it doesn't exist
+  boost::optional<std::tuple<uint64_t, int64_t, uint64_t>> fileIdentity(
+      const std::string &path) {
+    struct stat st {};
+    if (::stat(path.c_str(), &st) != 0) {
+      return boost::none;
+    }
+#ifdef __APPLE__
+    const auto &mtime{st.st_mtimespec};
+#else
+    const auto &mtime{st.st_mtim};
+#endif
+    return std::make_tuple(static_cast<uint64_t>(st.st_ino),
+                           int64_t{mtime.tv_sec} * 1000000000 + mtime.tv_nsec,
+                           static_cast<uint64_t>(st.st_size));
+  }
+
   fc::sector_storage::WorkerAction schedFetch(const SectorId &sector,
                                               SectorFileType file_type,
                                               bool sealing) {
@@ -28,6 +99,26 @@ namespace {
     };
   }
 
+  /// Starts async call and waits for its callback
+  template <typename T>
+  fc::outcome::result<T> waitResult(
+      const std::function<void(fc::sector_storage::ReturnCb<T>)> &start) {
+    std::promise<fc::outcome::result<T>> promise;
+    start([&](fc::outcome::result<T> result) {
+      promise.set_value(std::move(result));
+    });
+    return promise.get_future().get();
+  }
+
+  /// Span of seal phase of sector
+  Span sealSpan(const char *phase, const SectorId &sector) {
+    Span span{"seal", phase};
+    if (span) {
+      span.arg(sectorName(sector));
+    }
+    return span;
+  }
+
   fc::outcome::result<void> schedNothing(
       const std::shared_ptr<fc::sector_storage::Worker> &worker) {
     return fc::outcome::success();
@@ -90,11 +181,10 @@ namespace fc::sector_storage {
 
   outcome::result<std::vector<SectorId>> ManagerImpl::checkProvable(
       RegisteredProof seal_proof_type, gsl::span<const SectorId> sectors) {
-    std::vector<SectorId> bad{};
-
     OUTCOME_TRY(ssize, primitives::sector::getSectorSize(seal_proof_type));
 
-    for (const auto &sector : sectors) {
+    StorageLimiter limiter{kProvableChecksPerStorage};
+    auto check{[&](const SectorId &sector) -> outcome::result<bool> {
       auto locked = index_->storageTryLock(
           sector,
           static_cast<SectorFileType>(SectorFileType::FTSealed
@@ -104,8 +194,7 @@ namespace fc::sector_storage {
       if (!locked) {
         logger_->warn("can't acquire read lock for {} sector",
                       sectorName(sector));
-        bad.push_back(sector);
-        continue;
+        return false;
       }
 
       auto maybe_response = local_store_->acquireSector(
@@ -122,56 +211,98 @@ namespace fc::sector_storage {
                 stores::StoreErrors::kNotFoundRequestedSectorType)) {
           logger_->warn("cache an/or sealed paths not found for {} sector",
                         sectorName(sector));
-          bad.push_back(sector);
-          continue;
+          return false;
         }
         return maybe_response.error();
       }
 
-      std::unordered_map<std::string, uint64_t> to_check = {
-          {maybe_response.value().paths.sealed, 1},
-          {(fs::path(maybe_response.value().paths.cache) / "t_aux").string(),
-           0},
-          {(fs::path(maybe_response.value().paths.cache) / "p_aux").string(),
-           0},
-      };
+      const auto &storage{maybe_response.value().storages.sealed};
+      limiter.acquire(storage);
+      auto good{
+          checkProvableFiles(sector, maybe_response.value().paths, ssize)};
+      limiter.release(storage);
+      return good;
+    }};
+
+    const size_t count = sectors.size();
+    std::vector<outcome::result<bool>> results(count, false);
+    std::atomic_size_t next{0};
+    std::vector<std::future<void>> futures;
+    auto threads{std::min(kParallelProvableChecks, count)};
+    for (size_t thread{0}; thread < threads; ++thread) {
+      futures.push_back(std::async(std::launch::async, [&] {
+        for (auto i{next++}; i < count; i = next++) {
+          results[i] = check(sectors[i]);
+        }
+      }));
+    }
+    for (auto &future : futures) {
+      future.get();
+    }
 
-      addCachePathsForSectorSize(
-          to_check, maybe_response.value().paths.cache, ssize, logger_);
+    std::vector<SectorId> bad{};
+    for (size_t i = 0; i < count; ++i) {
+      OUTCOME_TRY(good, results[i]);
+      if (!good) {
+        bad.push_back(sectors[i]);
+      }
+    }
+    return std::move(bad);
+  }
 
-      for (const auto &[path, size] : to_check) {
-        if (!fs::exists(path)) {
-          logger_->warn(
-              "{} doesnt exist for {} sector", path, sectorName(sector));
-          bad.push_back(sector);
-          break;
-        }
+  bool ManagerImpl::checkProvableFiles(const SectorId &sector,
+                                       const stores::SectorPaths &paths,
+                                       SectorSize ssize) {
+    auto sealed_id{fileIdentity(paths.sealed)};
+    auto cache_id{fileIdentity(paths.cache)};
+    if (sealed_id && cache_id) {
+      auto known{provable_cache_.get(paths.sealed)};
+      if (known && *known == ProvableFiles{*sealed_id, *cache_id}) {
+        return true;
+      }
+    }
+    provable_cache_.remove(paths.sealed);
 
-        if (size != 0) {
-          boost::system::error_code ec;
-          size_t actual_size = fs::file_size(path, ec);
-          if (ec.failed()) {
-            logger_->warn("sector {}. Can't get size for {}: {}",
-                          sectorName(sector),
-                          path,
-                          ec.message());
-            bad.push_back(sector);
-            break;
-          }
+    std::unordered_map<std::string, uint64_t> to_check = {
+        {paths.sealed, 1},
+        {(fs::path(paths.cache) / "t_aux").string(), 0},
+        {(fs::path(paths.cache) / "p_aux").string(), 0},
+    };
 
-          if (actual_size != ssize * size) {
-            logger_->warn(
-                "sector {}. Actual and declared sizes do not match for {}",
-                sectorName(sector),
-                path);
-            bad.push_back(sector);
-            break;
-          }
+    addCachePathsForSectorSize(to_check, paths.cache, ssize, logger_);
+
+    for (const auto &[path, size] : to_check) {
+      if (!fs::exists(path)) {
+        logger_->warn(
+            "{} doesnt exist for {} sector", path, sectorName(sector));
+        return false;
+      }
+
+      if (size != 0) {
+        boost::system::error_code ec;
+        size_t actual_size = fs::file_size(path, ec);
+        if (ec.failed()) {
+          logger_->warn("sector {}. Can't get size for {}: {}",
+                        sectorName(sector),
+                        path,
+                        ec.message());
+          return false;
+        }
+
+        if (actual_size != ssize * size) {
+          logger_->warn(
+              "sector {}. Actual and declared sizes do not match for {}",
+              sectorName(sector),
+              path);
+          return false;
         }
       }
     }
 
-    return std::move(bad);
+    if (sealed_id && cache_id) {
+      provable_cache_.put(paths.sealed, {*sealed_id, *cache_id});
+    }
+    return true;
   }
 
   SectorSize ManagerImpl::getSectorSize() {
@@ -182,6 +313,24 @@ namespace fc::sector_storage {
     return 0;
   }
 
+  bool ManagerImpl::isLocallyUnsealed(const SectorId &sector,
+                                      UnpaddedByteIndex offset,
+                                      const UnpaddedPieceSize &size) {
+    auto maybe_response{local_store_->acquireSector(sector,
+                                                    seal_proof_type_,
+                                                    SectorFileType::FTUnsealed,
+                                                    SectorFileType::FTNone,
+                                                    false)};
+    if (maybe_response.has_error()) {
+      return false;
+    }
+    auto unsealed{
+        stores::isUnsealed(maybe_response.value().paths.unsealed,
+                           primitives::piece::paddedIndex(offset),
+                           size.padded())};
+    return unsealed.has_value() && unsealed.value();
+  }
+
   outcome::result<void> ManagerImpl::ReadPiece(proofs::PieceData output,
                                                const SectorId &sector,
                                                UnpaddedByteIndex offset,
@@ -195,7 +344,7 @@ namespace fc::sector_storage {
                                                 | SectorFileType::FTCache),
                     SectorFileType::FTUnsealed));
 
-    {
+    if (!isLocallyUnsealed(sector, offset, size)) {
       OUTCOME_TRY(
           best,
           index_->storageFindSector(sector, SectorFileType::FTUnsealed, false));
@@ -210,9 +359,6 @@ namespace fc::sector_storage {
                          index_, sector, SectorFileType::FTUnsealed, false));
       }
 
-      // TODO: Optimization: don't send unseal to a worker if the requested
-      // range is already unsealed
-
       WorkerAction unseal_fetch =
           [&](const std::shared_ptr<Worker> &worker) -> outcome::result<void> {
         SectorFileType unsealed =
@@ -278,6 +424,29 @@ namespace fc::sector_storage {
         miner_id, res.private_info, randomness);
   }
 
+  outcome::result<void> ManagerImpl::prewarmWinningPoSt(
+      ActorId miner_id, gsl::span<const SectorInfo> sector_info) {
+    OUTCOME_TRY(res,
+                publicSectorToPrivate(
+                    miner_id,
+                    sector_info,
+                    {},
+                    primitives::sector::getRegisteredWinningPoStProof));
+    // challenged leaves of sealed file are known to proofs only, so merkle
+    // trees are prefetched, which are read for every challenge
+    for (const auto &sector : res.private_info.values) {
+      std::unordered_map<std::string, uint64_t> files{
+          {(fs::path(sector.cache_dir_path) / "p_aux").string(), 0},
+      };
+      addCachePathsForSectorSize(
+          files, sector.cache_dir_path, getSectorSize(), logger_);
+      for (const auto &file : files) {
+        willNeed(file.first);
+      }
+    }
+    return outcome::success();
+  }
+
   outcome::result<Prover::WindowPoStResponse> ManagerImpl::generateWindowPoSt(
       ActorId miner_id,
       gsl::span<const SectorInfo> sector_info,
@@ -306,12 +475,30 @@ namespace fc::sector_storage {
       const SectorId &sector,
       const SealRandomness &ticket,
       gsl::span<const PieceInfo> pieces) {
-    OUTCOME_TRY(lock,
-                index_->storageLock(
-                    sector,
-                    SectorFileType::FTUnsealed,
-                    static_cast<SectorFileType>(SectorFileType::FTSealed
-                                                | SectorFileType::FTCache)));
+    return waitResult<PreCommit1Output>([&](ReturnCb<PreCommit1Output> cb) {
+      sealPreCommit1Async(sector,
+                          ticket,
+                          {pieces.begin(), pieces.end()},
+                          std::move(cb),
+                          kDefaultTaskPriority);
+    });
+  }
+
+  void ManagerImpl::sealPreCommit1Async(
+      const SectorId &sector,
+      const SealRandomness &ticket,
+      std::vector<PieceInfo> pieces,
+      const ReturnCb<PreCommit1Output> &cb,
+      uint64_t priority) {
+    auto maybe_lock{index_->storageLock(
+        sector,
+        SectorFileType::FTUnsealed,
+        static_cast<SectorFileType>(SectorFileType::FTSealed
+                                    | SectorFileType::FTCache))};
+    if (maybe_lock.has_error()) {
+      return cb(maybe_lock.error());
+    }
+    std::shared_ptr<stores::Lock> lock{std::move(maybe_lock.value())};
 
     // TODO: also consider where the unsealed data sits
 
@@ -321,51 +508,84 @@ namespace fc::sector_storage {
                                     | SectorFileType::FTCache),
         true);
 
-    PreCommit1Output out;
+    auto out{std::make_shared<PreCommit1Output>()};
 
-    OUTCOME_TRY(scheduler_->schedule(
+    scheduler_->scheduleAsync(
         sector,
         primitives::kTTPreCommit1,
         std::move(selector),
         schedFetch(sector, SectorFileType::FTUnsealed, true),
-        [&](const std::shared_ptr<Worker> &worker) -> outcome::result<void> {
-          OUTCOME_TRYA(out, worker->sealPreCommit1(sector, ticket, pieces));
+        [=](const std::shared_ptr<Worker> &worker) -> outcome::result<void> {
+          ScopedSpan span{sealSpan("PreCommit1 work", sector)};
+          OUTCOME_TRYA(*out, worker->sealPreCommit1(sector, ticket, pieces));
           return outcome::success();
-        }));
-
-    return std::move(out);
+        },
+        [lock, out, cb, span{sealSpan("PreCommit1", sector)}](
+            outcome::result<void> result) {
+          span.end();
+          if (result.has_error()) {
+            return cb(result.error());
+          }
+          cb(std::move(*out));
+        },
+        priority);
   }
 
   outcome::result<SectorCids> ManagerImpl::sealPreCommit2(
       const SectorId &sector, const PreCommit1Output &pre_commit_1_output) {
-    OUTCOME_TRY(lock,
-                index_->storageLock(
-                    sector, SectorFileType::FTSealed, SectorFileType::FTCache));
+    return waitResult<SectorCids>([&](ReturnCb<SectorCids> cb) {
+      sealPreCommit2Async(
+          sector, pre_commit_1_output, std::move(cb), kDefaultTaskPriority);
+    });
+  }
 
-    OUTCOME_TRY(selector,
-                ExistingSelector::newExistingSelector(
-                    index_,
-                    sector,
-                    static_cast<SectorFileType>(SectorFileType::FTSealed
-                                                | SectorFileType::FTCache),
-                    true));
+  void ManagerImpl::sealPreCommit2Async(
+      const SectorId &sector,
+      const PreCommit1Output &pre_commit_1_output,
+      const ReturnCb<SectorCids> &cb,
+      uint64_t priority) {
+    auto maybe_lock{index_->storageLock(
+        sector, SectorFileType::FTSealed, SectorFileType::FTCache)};
+    if (maybe_lock.has_error()) {
+      return cb(maybe_lock.error());
+    }
+    std::shared_ptr<stores::Lock> lock{std::move(maybe_lock.value())};
 
-    SectorCids out;
+    auto maybe_selector{ExistingSelector::newExistingSelector(
+        index_,
+        sector,
+        static_cast<SectorFileType>(SectorFileType::FTSealed
+                                    | SectorFileType::FTCache),
+        true)};
+    if (maybe_selector.has_error()) {
+      return cb(maybe_selector.error());
+    }
 
-    OUTCOME_TRY(scheduler_->schedule(
+    auto out{std::make_shared<SectorCids>()};
+
+    scheduler_->scheduleAsync(
         sector,
         primitives::kTTPreCommit2,
-        std::move(selector),
+        std::move(maybe_selector.value()),
         schedFetch(sector,
                    static_cast<SectorFileType>(SectorFileType::FTSealed
                                                | SectorFileType::FTCache),
                    true),
-        [&](const std::shared_ptr<Worker> &worker) -> outcome::result<void> {
-          OUTCOME_TRYA(out, worker->sealPreCommit2(sector, pre_commit_1_output))
+        [=](const std::shared_ptr<Worker> &worker) -> outcome::result<void> {
+          ScopedSpan span{sealSpan("PreCommit2 work", sector)};
+          OUTCOME_TRYA(*out,
+                       worker->sealPreCommit2(sector, pre_commit_1_output));
           return outcome::success();
-        }));
-
-    return std::move(out);
+        },
+        [lock, out, cb, span{sealSpan("PreCommit2", sector)}](
+            outcome::result<void> result) {
+          span.end();
+          if (result.has_error()) {
+            return cb(result.error());
+          }
+          cb(std::move(*out));
+        },
+        priority);
   }
 
   outcome::result<Commit1Output> ManagerImpl::sealCommit1(
@@ -374,54 +594,103 @@ namespace fc::sector_storage {
       const InteractiveRandomness &seed,
       gsl::span<const PieceInfo> pieces,
       const SectorCids &cids) {
-    OUTCOME_TRY(lock,
-                index_->storageLock(
-                    sector, SectorFileType::FTSealed, SectorFileType::FTCache));
+    return waitResult<Commit1Output>([&](ReturnCb<Commit1Output> cb) {
+      sealCommit1Async(sector,
+                       ticket,
+                       seed,
+                       {pieces.begin(), pieces.end()},
+                       cids,
+                       std::move(cb),
+                       kDefaultTaskPriority);
+    });
+  }
 
-    OUTCOME_TRY(selector,
-                ExistingSelector::newExistingSelector(
-                    index_,
-                    sector,
-                    static_cast<SectorFileType>(SectorFileType::FTSealed
-                                                | SectorFileType::FTCache),
-                    false));
+  void ManagerImpl::sealCommit1Async(const SectorId &sector,
+                                     const SealRandomness &ticket,
+                                     const InteractiveRandomness &seed,
+                                     std::vector<PieceInfo> pieces,
+                                     const SectorCids &cids,
+                                     const ReturnCb<Commit1Output> &cb,
+                                     uint64_t priority) {
+    auto maybe_lock{index_->storageLock(
+        sector, SectorFileType::FTSealed, SectorFileType::FTCache)};
+    if (maybe_lock.has_error()) {
+      return cb(maybe_lock.error());
+    }
+    std::shared_ptr<stores::Lock> lock{std::move(maybe_lock.value())};
 
-    Commit1Output out;
+    auto maybe_selector{ExistingSelector::newExistingSelector(
+        index_,
+        sector,
+        static_cast<SectorFileType>(SectorFileType::FTSealed
+                                    | SectorFileType::FTCache),
+        false)};
+    if (maybe_selector.has_error()) {
+      return cb(maybe_selector.error());
+    }
 
-    OUTCOME_TRY(scheduler_->schedule(
+    auto out{std::make_shared<Commit1Output>()};
+
+    scheduler_->scheduleAsync(
         sector,
         primitives::kTTCommit1,
-        std::move(selector),
+        std::move(maybe_selector.value()),
         schedFetch(sector,
                    static_cast<SectorFileType>(SectorFileType::FTSealed
                                                | SectorFileType::FTCache),
                    true),
-        [&](const std::shared_ptr<Worker> &worker) -> outcome::result<void> {
-          OUTCOME_TRYA(out,
+        [=](const std::shared_ptr<Worker> &worker) -> outcome::result<void> {
+          ScopedSpan span{sealSpan("Commit1 work", sector)};
+          OUTCOME_TRYA(*out,
                        worker->sealCommit1(sector, ticket, seed, pieces, cids))
           return outcome::success();
-        }));
-
-    return std::move(out);
+        },
+        [lock, out, cb, span{sealSpan("Commit1", sector)}](
+            outcome::result<void> result) {
+          span.end();
+          if (result.has_error()) {
+            return cb(result.error());
+          }
+          cb(std::move(*out));
+        },
+        priority);
   }
 
   outcome::result<Proof> ManagerImpl::sealCommit2(
       const SectorId &sector, const Commit1Output &commit_1_output) {
+    return waitResult<Proof>([&](ReturnCb<Proof> cb) {
+      sealCommit2Async(
+          sector, commit_1_output, std::move(cb), kDefaultTaskPriority);
+    });
+  }
+
+  void ManagerImpl::sealCommit2Async(const SectorId &sector,
+                                     const Commit1Output &commit_1_output,
+                                     const ReturnCb<Proof> &cb,
+                                     uint64_t priority) {
     std::unique_ptr<TaskSelector> selector = std::make_unique<TaskSelector>();
 
-    Proof out;
+    auto out{std::make_shared<Proof>()};
 
-    OUTCOME_TRY(scheduler_->schedule(
+    scheduler_->scheduleAsync(
         sector,
         primitives::kTTCommit2,
         std::move(selector),
         schedNothing,
-        [&](const std::shared_ptr<Worker> &worker) -> outcome::result<void> {
-          OUTCOME_TRYA(out, worker->sealCommit2(sector, commit_1_output))
+        [=](const std::shared_ptr<Worker> &worker) -> outcome::result<void> {
+          ScopedSpan span{sealSpan("Commit2 work", sector)};
+          OUTCOME_TRYA(*out, worker->sealCommit2(sector, commit_1_output))
           return outcome::success();
-        }));
-
-    return std::move(out);
+        },
+        [out, cb, span{sealSpan("Commit2", sector)}](
+            outcome::result<void> result) {
+          span.end();
+          if (result.has_error()) {
+            return cb(result.error());
+          }
+          cb(std::move(*out));
+        },
+        priority);
   }
 
   outcome::result<void> ManagerImpl::finalizeSector(const SectorId &sector) {
@@ -617,24 +886,46 @@ namespace fc::sector_storage {
       faults_set.insert(fault);
     }
 
-    std::vector<proofs::PrivateSectorInfo> out{};
+    std::vector<SectorInfo> sectors;
     for (const auto &sector : sector_info) {
-      if (faults_set.find(sector.sector) != faults_set.end()) {
-        continue;
+      if (faults_set.find(sector.sector) == faults_set.end()) {
+        sectors.push_back(sector);
       }
+    }
 
+    // sectors are on many storage paths, so they are acquired in parallel
+    std::vector<outcome::result<stores::AcquireSectorResponse>> acquired;
+    acquired.reserve(sectors.size());
+    for (size_t begin = 0; begin < sectors.size();
+         begin += kParallelPoStAcquires) {
+      std::vector<std::future<outcome::result<stores::AcquireSectorResponse>>>
+          futures;
+      auto end{std::min(begin + kParallelPoStAcquires, sectors.size())};
+      for (auto i{begin}; i < end; ++i) {
+        futures.push_back(std::async(std::launch::async, [&, i] {
+          return local_store_->acquireSector(
+              SectorId{.miner = miner, .sector = sectors[i].sector},
+              seal_proof_type_,
+              static_cast<SectorFileType>(SectorFileType::FTCache
+                                          | SectorFileType::FTSealed),
+              SectorFileType::FTNone,
+              false);
+        }));
+      }
+      for (auto &future : futures) {
+        acquired.push_back(future.get());
+      }
+    }
+
+    std::vector<proofs::PrivateSectorInfo> out{};
+    for (size_t i = 0; i < sectors.size(); ++i) {
+      const auto &sector{sectors[i]};
       SectorId sector_id{
           .miner = miner,
           .sector = sector.sector,
       };
 
-      auto res = local_store_->acquireSector(
-          sector_id,
-          seal_proof_type_,
-          static_cast<SectorFileType>(SectorFileType::FTCache
-                                      | SectorFileType::FTSealed),
-          SectorFileType::FTNone,
-          false);
+      auto &res{acquired[i]};
       if (res.has_error()) {
         logger_->warn("failed to acquire sector {}", sectorName(sector_id));
         result.skipped.push_back(sector_id);
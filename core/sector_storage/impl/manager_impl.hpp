@@ -8,6 +8,9 @@
 
 #include "sector_storage/manager.hpp"
 
+#include <tuple>
+
+#include "common/lru_cache.hpp"
 #include "sector_storage/scheduler.hpp"
 #include "sector_storage/stores/impl/local_store.hpp"
 #include "sector_storage/stores/impl/remote_store.hpp"
@@ -50,6 +53,9 @@ namespace fc::sector_storage {
         gsl::span<const SectorInfo> sector_info,
         PoStRandomness randomness) override;
 
+    outcome::result<void> prewarmWinningPoSt(
+        ActorId miner_id, gsl::span<const SectorInfo> sector_info) override;
+
     outcome::result<WindowPoStResponse> generateWindowPoSt(
         ActorId miner_id,
         gsl::span<const SectorInfo> sector_info,
@@ -74,6 +80,30 @@ namespace fc::sector_storage {
     outcome::result<Proof> sealCommit2(
         const SectorId &sector, const Commit1Output &commit_1_output) override;
 
+    void sealPreCommit1Async(const SectorId &sector,
+                             const SealRandomness &ticket,
+                             std::vector<PieceInfo> pieces,
+                             const ReturnCb<PreCommit1Output> &cb,
+                             uint64_t priority) override;
+
+    void sealPreCommit2Async(const SectorId &sector,
+                             const PreCommit1Output &pre_commit_1_output,
+                             const ReturnCb<SectorCids> &cb,
+                             uint64_t priority) override;
+
+    void sealCommit1Async(const SectorId &sector,
+                          const SealRandomness &ticket,
+                          const InteractiveRandomness &seed,
+                          std::vector<PieceInfo> pieces,
+                          const SectorCids &cids,
+                          const ReturnCb<Commit1Output> &cb,
+                          uint64_t priority) override;
+
+    void sealCommit2Async(const SectorId &sector,
+                          const Commit1Output &commit_1_output,
+                          const ReturnCb<Proof> &cb,
+                          uint64_t priority) override;
+
     outcome::result<void> finalizeSector(const SectorId &sector) override;
 
     outcome::result<void> remove(const SectorId &sector) override;
@@ -113,6 +143,25 @@ namespace fc::sector_storage {
         const std::function<outcome::result<RegisteredProof>(RegisteredProof)>
             &to_post_transform);
 
+    /// Whether piece is already unsealed in local storage, so its unseal is
+    /// not scheduled
+    bool isLocallyUnsealed(const SectorId &sector,
+                           UnpaddedByteIndex offset,
+                           const UnpaddedPieceSize &size);
+
+    /// Inode, modification time in ns and size of file
+    using FileIdentity = std::tuple<uint64_t, int64_t, uint64_t>;
+    /// Identities of sealed file and cache dir when sector was provable
+    using ProvableFiles = std::pair<FileIdentity, FileIdentity>;
+
+    /// Max sectors with known provable files, about as many as one miner has
+    static constexpr size_t kProvableCacheSize{1 << 16};
+
+    /// Checks files of acquired sector, skips checks when unchanged
+    bool checkProvableFiles(const SectorId &sector,
+                            const stores::SectorPaths &paths,
+                            SectorSize ssize);
+
     std::shared_ptr<stores::SectorIndex> index_;
 
     RegisteredProof seal_proof_type_;  // TODO: maybe add config
@@ -124,6 +173,10 @@ namespace fc::sector_storage {
 
     std::shared_ptr<Scheduler> scheduler_;
 
+    /// Keyed by sealed file path
+    common::LruCache<std::string, ProvableFiles> provable_cache_{
+        kProvableCacheSize};
+
     common::Logger logger_;
   };
 
@@ -0,0 +1,185 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/impl/numa.hpp"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <regex>
+
+#include "common/logger.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace fc::sector_storage::numa {
+  namespace fs = boost::filesystem;
+
+  namespace {
+    // values of <linux/mempolicy.h>, header is not always installed
+    constexpr int kMpolDefault{0};
+    constexpr int kMpolPreferred{1};
+
+    common::Logger logger() {
+      static common::Logger logger{common::createLogger("numa")};
+      return logger;
+    }
+
+    thread_local boost::optional<NumaNode> assigned;
+  }  // namespace
+
+  boost::optional<std::vector<uint64_t>> parseCpuList(
+      const std::string &cpulist) {
+    // sysfs files end with newline
+    const auto list{cpulist.substr(0, cpulist.find_last_not_of(" \n") + 1)};
+    std::vector<uint64_t> cpus;
+    size_t begin{0};
+    while (begin < list.size()) {
+      auto end{list.find(',', begin)};
+      if (end == std::string::npos) {
+        end = list.size();
+      }
+      const auto range{list.substr(begin, end - begin)};
+      begin = end + 1;
+      if (range.empty()) {
+        return boost::none;
+      }
+      try {
+        size_t parsed{};
+        const auto from{std::stoull(range, &parsed)};
+        auto to{from};
+        if (parsed < range.size() && range[parsed] == '-') {
+          const auto rest{range.substr(parsed + 1)};
+          to = std::stoull(rest, &parsed);
+          parsed += range.size() - rest.size();
+        }
+        if (to < from || parsed != range.size()) {
+          return boost::none;
+        }
+        for (auto cpu{from}; cpu <= to; ++cpu) {
+          cpus.push_back(cpu);
+        }
+      } catch (const std::logic_error &) {
+        return boost::none;
+      }
+    }
+    return cpus;
+  }
+
+  std::vector<NumaNode> detectNodes(const std::string &root) {
+    static const std::regex kNodeDir{"node([0-9]+)"};
+    static const std::regex kMemTotal{
+        "Node [0-9]+ MemTotal: *([0-9]+) kB.*"};
+    std::vector<NumaNode> nodes;
+    boost::system::error_code ec;
+    for (fs::directory_iterator it{root, ec}, end; !ec.failed() && it != end;
+         it.increment(ec)) {
+      std::smatch match;
+      const auto name{it->path().filename().string()};
+      if (!std::regex_match(name, match, kNodeDir)) {
+        continue;
+      }
+      NumaNode node{std::stoull(match[1]), {}, 0};
+
+      std::ifstream cpulist{(it->path() / "cpulist").string()};
+      std::string list;
+      std::getline(cpulist, list);
+      auto cpus{parseCpuList(list)};
+      if (!cpus) {
+        logger()->warn("cannot parse cpu list of {}", name);
+        return {};
+      }
+      node.cpus = std::move(*cpus);
+
+      std::ifstream meminfo{(it->path() / "meminfo").string()};
+      for (std::string line; std::getline(meminfo, line);) {
+        if (std::regex_match(line, match, kMemTotal)) {
+          node.memory = std::stoull(match[1]) * 1024;
+          break;
+        }
+      }
+      // memory only nodes don't run tasks
+      if (!node.cpus.empty()) {
+        nodes.push_back(std::move(node));
+      }
+    }
+    if (nodes.size() < 2) {
+      return {};
+    }
+    std::sort(nodes.begin(), nodes.end(), [](auto &lhs, auto &rhs) {
+      return lhs.id < rhs.id;
+    });
+    return nodes;
+  }
+
+  const boost::optional<NumaNode> &assignedNode() {
+    return assigned;
+  }
+
+  ScopedAssignment::ScopedAssignment(boost::optional<NumaNode> node)
+      : previous_{std::move(assigned)} {
+    assigned = std::move(node);
+  }
+
+  ScopedAssignment::~ScopedAssignment() {
+    assigned = std::move(previous_);
+  }
+
+  Binding::Binding(const boost::optional<NumaNode> &node) {
+#ifdef __linux__
+    if (!node) {
+      return;
+    }
+    cpu_set_t saved;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu : node->cpus) {
+      if (cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &set);
+      }
+    }
+    if (pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved) == 0
+        && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+      affinity_ = true;
+      auto bytes{reinterpret_cast<const uint8_t *>(&saved)};
+      saved_affinity_.assign(bytes, bytes + sizeof(saved));
+    } else {
+      logger()->warn("cannot bind thread to cores of node {}", node->id);
+    }
+
+    // preferred falls back to other nodes instead of failing allocation
+    const auto bits{8 * sizeof(unsigned long)};
+    std::vector<unsigned long> mask(node->id / bits + 1);
+    mask[node->id / bits] |= 1ul << (node->id % bits);
+    if (syscall(SYS_set_mempolicy,
+                kMpolPreferred,
+                mask.data(),
+                mask.size() * bits)
+        == 0) {
+      mempolicy_ = true;
+    } else {
+      logger()->warn("cannot prefer memory of node {}", node->id);
+    }
+#endif
+  }
+
+  Binding::~Binding() {
+#ifdef __linux__
+    if (mempolicy_) {
+      syscall(SYS_set_mempolicy, kMpolDefault, nullptr, 0);
+    }
+    if (affinity_) {
+      pthread_setaffinity_np(
+          pthread_self(),
+          sizeof(cpu_set_t),
+          reinterpret_cast<const cpu_set_t *>(saved_affinity_.data()));
+    }
+#endif
+  }
+}  // namespace fc::sector_storage::numa
@@ -0,0 +1,63 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_SECTOR_STORAGE_IMPL_NUMA_HPP
+#define CPP_FILECOIN_CORE_SECTOR_STORAGE_IMPL_NUMA_HPP
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+#include "primitives/types.hpp"
+
+namespace fc::sector_storage::numa {
+  using primitives::NumaNode;
+
+  /// Parses kernel cpu list like "0-3,8-11"
+  boost::optional<std::vector<uint64_t>> parseCpuList(const std::string &list);
+
+  /**
+   * Reads NUMA nodes from sysfs
+   * @return nodes with cores, empty if machine has one node or sysfs is
+   * unavailable
+   */
+  std::vector<NumaNode> detectNodes(
+      const std::string &root = "/sys/devices/system/node");
+
+  /// Node assigned by scheduler to task executed by current thread
+  const boost::optional<NumaNode> &assignedNode();
+
+  /// Assigns node to tasks executed by current thread until destroyed
+  class ScopedAssignment {
+   public:
+    explicit ScopedAssignment(boost::optional<NumaNode> node);
+    ScopedAssignment(const ScopedAssignment &) = delete;
+    ScopedAssignment &operator=(const ScopedAssignment &) = delete;
+    ~ScopedAssignment();
+
+   private:
+    boost::optional<NumaNode> previous_;
+  };
+
+  /**
+   * Runs current thread on cores of node and prefers its memory for
+   * allocations until destroyed, threads started meanwhile inherit both.
+   * Does nothing on platforms without NUMA api.
+   */
+  class Binding {
+   public:
+    explicit Binding(const boost::optional<NumaNode> &node);
+    Binding(const Binding &) = delete;
+    Binding &operator=(const Binding &) = delete;
+    ~Binding();
+
+   private:
+    bool affinity_{false};
+    bool mempolicy_{false};
+    std::vector<uint8_t> saved_affinity_;
+  };
+}  // namespace fc::sector_storage::numa
+
+#endif  // CPP_FILECOIN_CORE_SECTOR_STORAGE_IMPL_NUMA_HPP
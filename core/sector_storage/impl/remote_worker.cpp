@@ -0,0 +1,333 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/impl/remote_worker.hpp"
+
+#include <unistd.h>
+#include <boost/asio/post.hpp>
+#include <cerrno>
+
+#include "sector_storage/selector.hpp"
+
+namespace fc::sector_storage::remote {
+  RemoteWorker::RemoteWorker(std::shared_ptr<Host> host,
+                             PeerInfo peer,
+                             boost::asio::io_context &io,
+                             Heartbeat heartbeat,
+                             CallTimeout timeout)
+      : host_{std::move(host)},
+        peer_{std::move(peer)},
+        io_{io},
+        timeout_{std::move(timeout)},
+        heartbeat_{std::move(heartbeat)},
+        last_heartbeat_{Clock::now()},
+        logger_{common::createLogger("remote worker")} {}
+
+  void RemoteWorker::onHeartbeat(Heartbeat heartbeat) {
+    std::lock_guard lock{mutex_};
+    heartbeat_ = std::move(heartbeat);
+    last_heartbeat_ = Clock::now();
+    connected_ = true;
+  }
+
+  void RemoteWorker::onDisconnect() {
+    std::lock_guard lock{mutex_};
+    connected_ = false;
+  }
+
+  template <typename P>
+  outcome::result<std::unique_ptr<SyncStream>> RemoteWorker::startCall(
+      WorkerMethod method, const P &params) {
+    {
+      std::lock_guard lock{mutex_};
+      if (!connected_ || Clock::now() - last_heartbeat_ > kHeartbeatTimeout) {
+        return RemoteWorkerErrors::kDisconnected;
+      }
+    }
+    const auto deadline{Clock::now() + timeout_(method)};
+    // callback may outlive timed out call
+    using Promise = std::promise<outcome::result<std::shared_ptr<CborStream>>>;
+    auto promise{std::make_shared<Promise>()};
+    auto future{promise->get_future()};
+    boost::asio::post(io_, [host{host_}, peer{peer_}, promise] {
+      host->newStream(peer, kCallProtocol, [promise](auto stream) {
+        if (stream.has_error()) {
+          return promise->set_value(stream.error());
+        }
+        promise->set_value(std::make_shared<CborStream>(stream.value()));
+      });
+    });
+    if (future.wait_until(deadline) != std::future_status::ready) {
+      return RemoteWorkerErrors::kTimeout;
+    }
+    OUTCOME_TRY(cbor_stream, future.get());
+    auto stream{std::make_unique<SyncStream>(
+        std::move(cbor_stream), io_, deadline)};
+    OUTCOME_TRY(stream->write(method));
+    OUTCOME_TRY(bytes, codec::cbor::encode(params));
+    OUTCOME_TRY(stream->writeFrames(Frame::kArguments, bytes));
+    return std::move(stream);
+  }
+
+  template <typename R>
+  outcome::result<R> RemoteWorker::result(SyncStream &stream) {
+    OUTCOME_TRY(bytes, stream.readFrames(Frame::kResult));
+    if constexpr (std::is_void_v<R>) {
+      return outcome::success();
+    } else {
+      return codec::cbor::decode<R>(bytes);
+    }
+  }
+
+  template <typename R, typename P>
+  outcome::result<R> RemoteWorker::call(WorkerMethod method, const P &params) {
+    OUTCOME_TRY(stream, startCall(method, params));
+    return result<R>(*stream);
+  }
+
+  outcome::result<PreCommit1Output> RemoteWorker::sealPreCommit1(
+      const SectorId &sector,
+      const SealRandomness &ticket,
+      gsl::span<const PieceInfo> pieces) {
+    return call<PreCommit1Output>(
+        WorkerMethod::kSealPreCommit1,
+        SealPreCommit1Params{
+            sector, ticket, {pieces.begin(), pieces.end()}});
+  }
+
+  outcome::result<SectorCids> RemoteWorker::sealPreCommit2(
+      const SectorId &sector, const PreCommit1Output &pre_commit_1_output) {
+    return call<SectorCids>(
+        WorkerMethod::kSealPreCommit2,
+        SealPreCommit2Params{sector, pre_commit_1_output});
+  }
+
+  outcome::result<Commit1Output> RemoteWorker::sealCommit1(
+      const SectorId &sector,
+      const SealRandomness &ticket,
+      const InteractiveRandomness &seed,
+      gsl::span<const PieceInfo> pieces,
+      const SectorCids &cids) {
+    return call<Commit1Output>(
+        WorkerMethod::kSealCommit1,
+        SealCommit1Params{
+            sector, ticket, seed, {pieces.begin(), pieces.end()}, cids});
+  }
+
+  outcome::result<Proof> RemoteWorker::sealCommit2(
+      const SectorId &sector, const Commit1Output &commit_1_output) {
+    return call<Proof>(WorkerMethod::kSealCommit2,
+                       SealCommit2Params{sector, commit_1_output});
+  }
+
+  outcome::result<void> RemoteWorker::finalizeSector(const SectorId &sector) {
+    return call<void>(WorkerMethod::kFinalizeSector, SectorParams{sector});
+  }
+
+  outcome::result<void> RemoteWorker::remove(const SectorId &sector) {
+    return call<void>(WorkerMethod::kRemove, SectorParams{sector});
+  }
+
+  outcome::result<PieceInfo> RemoteWorker::addPiece(
+      const SectorId &sector,
+      gsl::span<const UnpaddedPieceSize> piece_sizes,
+      const UnpaddedPieceSize &new_piece_size,
+      const proofs::PieceData &piece_data) {
+    OUTCOME_TRY(stream,
+                startCall(WorkerMethod::kAddPiece,
+                          AddPieceParams{sector,
+                                         {piece_sizes.begin(),
+                                          piece_sizes.end()},
+                                         new_piece_size}));
+    // piece is sent while it is read, worker reads it from pipe
+    Buffer chunk(kChunkBytes, 0);
+    for (uint64_t left{new_piece_size};;) {
+      auto read{::read(piece_data.getFd(),
+                       chunk.data(),
+                       std::min<uint64_t>(left, chunk.size()))};
+      if (read < 0 && errno == EINTR) {
+        continue;
+      }
+      if (read < 0) {
+        return RemoteWorkerErrors::kCannotTransferPiece;
+      }
+      left -= read;
+      const auto last{read == 0 || left == 0};
+      OUTCOME_TRY(stream->write(Frame{
+          Frame::kData,
+          Buffer{gsl::make_span(chunk).first(read)},
+          last}));
+      if (last) {
+        break;
+      }
+    }
+    return result<PieceInfo>(*stream);
+  }
+
+  outcome::result<void> RemoteWorker::moveStorage(const SectorId &sector) {
+    return call<void>(WorkerMethod::kMoveStorage, SectorParams{sector});
+  }
+
+  outcome::result<void> RemoteWorker::fetch(const SectorId &sector,
+                                            const SectorFileType &file_type,
+                                            bool can_seal) {
+    return call<void>(WorkerMethod::kFetch,
+                      FetchParams{sector, file_type, can_seal});
+  }
+
+  outcome::result<void> RemoteWorker::unsealPiece(
+      const SectorId &sector,
+      UnpaddedByteIndex offset,
+      const UnpaddedPieceSize &size,
+      const SealRandomness &randomness,
+      const CID &unsealed_cid) {
+    return call<void>(
+        WorkerMethod::kUnsealPiece,
+        UnsealPieceParams{sector, offset, size, randomness, unsealed_cid});
+  }
+
+  outcome::result<void> RemoteWorker::readPiece(
+      proofs::PieceData output,
+      const SectorId &sector,
+      UnpaddedByteIndex offset,
+      const UnpaddedPieceSize &size) {
+    OUTCOME_TRY(stream,
+                startCall(WorkerMethod::kReadPiece,
+                          ReadPieceParams{sector, offset, size}));
+    // piece is written to output while it is received
+    while (true) {
+      OUTCOME_TRY(frame, stream->read<Frame>());
+      if (frame.kind != Frame::kData) {
+        if (frame.kind == Frame::kError) {
+          logger_->error("read piece failed on worker: {}",
+                         std::string{frame.chunk.begin(), frame.chunk.end()});
+          return RemoteWorkerErrors::kCallFailed;
+        }
+        return RemoteWorkerErrors::kUnexpectedFrame;
+      }
+      for (size_t written{0}; written < frame.chunk.size();) {
+        auto n{::write(output.getFd(),
+                       frame.chunk.data() + written,
+                       frame.chunk.size() - written)};
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n <= 0) {
+          return RemoteWorkerErrors::kCannotTransferPiece;
+        }
+        written += n;
+      }
+      if (frame.last) {
+        break;
+      }
+    }
+    return result<void>(*stream);
+  }
+
+  outcome::result<primitives::WorkerInfo> RemoteWorker::getInfo() {
+    std::lock_guard lock{mutex_};
+    return heartbeat_.info;
+  }
+
+  outcome::result<std::set<primitives::TaskType>>
+  RemoteWorker::getSupportedTask() {
+    std::lock_guard lock{mutex_};
+    std::set<primitives::TaskType> tasks;
+    for (const auto &task : heartbeat_.tasks) {
+      tasks.emplace(task);
+    }
+    return tasks;
+  }
+
+  outcome::result<std::vector<primitives::StoragePath>>
+  RemoteWorker::getAccessiblePaths() {
+    std::lock_guard lock{mutex_};
+    return heartbeat_.paths;
+  }
+
+  RemoteWorkers::RemoteWorkers(std::shared_ptr<Host> host,
+                               std::shared_ptr<Scheduler> scheduler,
+                               boost::asio::io_context &io,
+                               std::unordered_set<PeerId> allowed,
+                               CallTimeout timeout)
+      : host_{std::move(host)},
+        scheduler_{std::move(scheduler)},
+        io_{io},
+        allowed_{std::move(allowed)},
+        timeout_{std::move(timeout)},
+        logger_{common::createLogger("remote workers")} {}
+
+  void RemoteWorkers::start() {
+    host_->setProtocolHandler(
+        kHeartbeatProtocol, [weak{weak_from_this()}](auto stream) {
+          auto self{weak.lock()};
+          if (!self) {
+            return stream->reset();
+          }
+          auto peer{stream->remotePeerId()};
+          auto address{stream->remoteMultiaddr()};
+          if (!peer || !address) {
+            return stream->reset();
+          }
+          if (self->allowed_.count(peer.value()) == 0) {
+            self->logger_->warn("worker {} is not allowed",
+                                peer.value().toBase58());
+            return stream->reset();
+          }
+          self->readHeartbeat(std::make_shared<CborStream>(stream),
+                              PeerInfo{peer.value(), {address.value()}},
+                              nullptr);
+        });
+  }
+
+  void RemoteWorkers::readHeartbeat(std::shared_ptr<CborStream> stream,
+                                    PeerInfo peer,
+                                    std::shared_ptr<RemoteWorker> worker) {
+    stream->read<Heartbeat>([self{shared_from_this()},
+                             stream,
+                             peer{std::move(peer)},
+                             worker{std::move(worker)}](
+                                auto heartbeat) mutable {
+      if (!heartbeat) {
+        self->logger_->warn("worker {} disconnected: {}",
+                            peer.id.toBase58(),
+                            heartbeat.error().message());
+        if (worker) {
+          worker->onDisconnect();
+        }
+        return stream->close();
+      }
+      if (worker) {
+        worker->onHeartbeat(std::move(heartbeat.value()));
+      } else {
+        worker = self->workerOf(peer, std::move(heartbeat.value()));
+      }
+      self->readHeartbeat(stream, std::move(peer), std::move(worker));
+    });
+  }
+
+  std::shared_ptr<RemoteWorker> RemoteWorkers::workerOf(const PeerInfo &peer,
+                                                        Heartbeat heartbeat) {
+    std::unique_lock lock{mutex_};
+    auto it{workers_.find(peer.id)};
+    if (it != workers_.end()) {
+      lock.unlock();
+      it->second->onHeartbeat(std::move(heartbeat));
+      return it->second;
+    }
+    logger_->info("worker {} connected from {}",
+                  peer.id.toBase58(),
+                  heartbeat.info.hostname);
+    auto handle{std::make_unique<WorkerHandle>()};
+    handle->info = heartbeat.info;
+    auto worker{std::make_shared<RemoteWorker>(
+        host_, peer, io_, std::move(heartbeat), timeout_)};
+    handle->worker = worker;
+    workers_.emplace(peer.id, worker);
+    lock.unlock();
+    scheduler_->newWorker(std::move(handle));
+    return worker;
+  }
+}  // namespace fc::sector_storage::remote
@@ -0,0 +1,165 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_SECTOR_STORAGE_IMPL_REMOTE_WORKER_HPP
+#define CPP_FILECOIN_CORE_SECTOR_STORAGE_IMPL_REMOTE_WORKER_HPP
+
+#include <libp2p/host/host.hpp>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "common/logger.hpp"
+#include "sector_storage/impl/remote_worker_protocol.hpp"
+#include "sector_storage/scheduler.hpp"
+
+namespace fc::sector_storage::remote {
+  using libp2p::Host;
+  using libp2p::peer::PeerId;
+  using libp2p::peer::PeerInfo;
+
+  /// Deadline of call of method
+  using CallTimeout = std::function<Clock::duration(WorkerMethod)>;
+
+  /**
+   * Worker on other machine, connected to miner with libp2p.
+   * Each call opens stream over persistent connection of worker, arguments,
+   * piece data and results are sent in frames of kChunkBytes. Info, tasks
+   * and paths are taken from last heartbeat. Calls block caller until
+   * deadline of method and must not be made from io thread.
+   */
+  class RemoteWorker : public Worker {
+   public:
+    RemoteWorker(std::shared_ptr<Host> host,
+                 PeerInfo peer,
+                 boost::asio::io_context &io,
+                 Heartbeat heartbeat,
+                 CallTimeout timeout = callTimeout);
+
+    /// Updates info and liveness of worker
+    void onHeartbeat(Heartbeat heartbeat);
+
+    /// Marks worker disconnected until next heartbeat
+    void onDisconnect();
+
+    outcome::result<PreCommit1Output> sealPreCommit1(
+        const SectorId &sector,
+        const SealRandomness &ticket,
+        gsl::span<const PieceInfo> pieces) override;
+
+    outcome::result<SectorCids> sealPreCommit2(
+        const SectorId &sector,
+        const PreCommit1Output &pre_commit_1_output) override;
+
+    outcome::result<Commit1Output> sealCommit1(
+        const SectorId &sector,
+        const SealRandomness &ticket,
+        const InteractiveRandomness &seed,
+        gsl::span<const PieceInfo> pieces,
+        const SectorCids &cids) override;
+
+    outcome::result<Proof> sealCommit2(
+        const SectorId &sector, const Commit1Output &commit_1_output) override;
+
+    outcome::result<void> finalizeSector(const SectorId &sector) override;
+
+    outcome::result<void> remove(const SectorId &sector) override;
+
+    outcome::result<PieceInfo> addPiece(
+        const SectorId &sector,
+        gsl::span<const UnpaddedPieceSize> piece_sizes,
+        const UnpaddedPieceSize &new_piece_size,
+        const proofs::PieceData &piece_data) override;
+
+    outcome::result<void> moveStorage(const SectorId &sector) override;
+
+    outcome::result<void> fetch(const SectorId &sector,
+                                const SectorFileType &file_type,
+                                bool can_seal) override;
+
+    outcome::result<void> unsealPiece(const SectorId &sector,
+                                      UnpaddedByteIndex offset,
+                                      const UnpaddedPieceSize &size,
+                                      const SealRandomness &randomness,
+                                      const CID &unsealed_cid) override;
+
+    outcome::result<void> readPiece(proofs::PieceData output,
+                                    const SectorId &sector,
+                                    UnpaddedByteIndex offset,
+                                    const UnpaddedPieceSize &size) override;
+
+    outcome::result<primitives::WorkerInfo> getInfo() override;
+
+    outcome::result<std::set<primitives::TaskType>> getSupportedTask()
+        override;
+
+    outcome::result<std::vector<primitives::StoragePath>> getAccessiblePaths()
+        override;
+
+   private:
+    /// Opens call stream and sends method with arguments
+    template <typename P>
+    outcome::result<std::unique_ptr<SyncStream>> startCall(
+        WorkerMethod method, const P &params);
+
+    template <typename R>
+    outcome::result<R> result(SyncStream &stream);
+
+    template <typename R, typename P>
+    outcome::result<R> call(WorkerMethod method, const P &params);
+
+    std::shared_ptr<Host> host_;
+    PeerInfo peer_;
+    boost::asio::io_context &io_;
+    CallTimeout timeout_;
+    std::mutex mutex_;
+    Heartbeat heartbeat_;
+    std::chrono::steady_clock::time_point last_heartbeat_;
+    bool connected_{true};
+    common::Logger logger_;
+  };
+
+  /**
+   * Accepts heartbeats of remote workers. Worker is passed to scheduler on
+   * its first heartbeat with resources reported by it, reconnected worker
+   * with same peer id is reused. Only allowed peers are accepted.
+   */
+  class RemoteWorkers : public std::enable_shared_from_this<RemoteWorkers> {
+   public:
+    /**
+     * @param allowed - peer ids of workers of miner
+     * @param timeout - deadline of calls to workers
+     */
+    RemoteWorkers(std::shared_ptr<Host> host,
+                  std::shared_ptr<Scheduler> scheduler,
+                  boost::asio::io_context &io,
+                  std::unordered_set<PeerId> allowed,
+                  CallTimeout timeout = callTimeout);
+
+    /// Sets heartbeat protocol handler
+    void start();
+
+   private:
+    /// Reads heartbeats until stream is closed, worker is none before first
+    void readHeartbeat(std::shared_ptr<CborStream> stream,
+                       PeerInfo peer,
+                       std::shared_ptr<RemoteWorker> worker);
+
+    /// Returns worker of peer, new one is passed to scheduler
+    std::shared_ptr<RemoteWorker> workerOf(const PeerInfo &peer,
+                                           Heartbeat heartbeat);
+
+    std::shared_ptr<Host> host_;
+    std::shared_ptr<Scheduler> scheduler_;
+    boost::asio::io_context &io_;
+    std::unordered_set<PeerId> allowed_;
+    CallTimeout timeout_;
+    std::mutex mutex_;
+    std::unordered_map<PeerId, std::shared_ptr<RemoteWorker>> workers_;
+    common::Logger logger_;
+  };
+}  // namespace fc::sector_storage::remote
+
+#endif  // CPP_FILECOIN_CORE_SECTOR_STORAGE_IMPL_REMOTE_WORKER_HPP
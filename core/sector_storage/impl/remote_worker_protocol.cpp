@@ -0,0 +1,150 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/impl/remote_worker_protocol.hpp"
+
+#include <boost/asio/post.hpp>
+
+#include "common/logger.hpp"
+
+namespace fc::sector_storage::remote {
+  namespace {
+    common::Logger logger() {
+      static common::Logger logger{common::createLogger("remote worker")};
+      return logger;
+    }
+  }  // namespace
+
+  Clock::duration callTimeout(WorkerMethod method) {
+    switch (method) {
+      case WorkerMethod::kSealPreCommit1:
+      case WorkerMethod::kSealPreCommit2:
+      case WorkerMethod::kSealCommit1:
+      case WorkerMethod::kSealCommit2:
+      case WorkerMethod::kAddPiece:
+      case WorkerMethod::kFetch:
+      case WorkerMethod::kUnsealPiece:
+      case WorkerMethod::kReadPiece:
+        return kSealCallTimeout;
+      default:
+        return kCallTimeout;
+    }
+  }
+
+  std::vector<Frame> splitFrames(Frame::Kind kind, const Buffer &bytes) {
+    std::vector<Frame> frames;
+    size_t offset{0};
+    do {
+      const auto size{std::min(kChunkBytes, bytes.size() - offset)};
+      frames.push_back({kind,
+                        Buffer{gsl::make_span(bytes).subspan(offset, size)},
+                        offset + size == bytes.size()});
+      offset += size;
+    } while (offset < bytes.size());
+    return frames;
+  }
+
+  SyncStream::SyncStream(std::shared_ptr<CborStream> stream,
+                         boost::asio::io_context &io,
+                         Clock::time_point deadline)
+      : stream_{std::move(stream)}, io_{io}, deadline_{deadline} {}
+
+  SyncStream::~SyncStream() {
+    boost::asio::post(io_, [stream{std::move(stream_)}] { stream->close(); });
+  }
+
+  template <typename T>
+  outcome::result<T> SyncStream::wait(
+      std::function<void(std::shared_ptr<std::promise<outcome::result<T>>>)>
+          start) {
+    // callback may outlive timed out call
+    auto promise{std::make_shared<std::promise<outcome::result<T>>>()};
+    auto future{promise->get_future()};
+    boost::asio::post(io_, [promise, start{std::move(start)}] {
+      start(promise);
+    });
+    if (future.wait_until(deadline_) != std::future_status::ready) {
+      boost::asio::post(io_, [stream{stream_}] { stream->stream()->reset(); });
+      return RemoteWorkerErrors::kTimeout;
+    }
+    return future.get();
+  }
+
+  outcome::result<Buffer> SyncStream::readRaw() {
+    return wait<Buffer>([stream{stream_}](auto promise) {
+      stream->readRaw([promise](auto input) {
+        if (input.has_error()) {
+          return promise->set_value(input.error());
+        }
+        promise->set_value(Buffer{input.value()});
+      });
+    });
+  }
+
+  outcome::result<void> SyncStream::writeRaw(Buffer bytes) {
+    auto shared{std::make_shared<Buffer>(std::move(bytes))};
+    return wait<void>([stream{stream_}, shared](auto promise) {
+      stream->writeRaw(*shared, [promise, shared](auto written) {
+        if (written.has_error()) {
+          return promise->set_value(written.error());
+        }
+        promise->set_value(outcome::success());
+      });
+    });
+  }
+
+  void SyncStream::setDeadline(Clock::time_point deadline) {
+    deadline_ = deadline;
+  }
+
+  outcome::result<void> SyncStream::writeFrames(Frame::Kind kind,
+                                                const Buffer &bytes) {
+    for (const auto &frame : splitFrames(kind, bytes)) {
+      OUTCOME_TRY(write(frame));
+    }
+    return outcome::success();
+  }
+
+  outcome::result<Buffer> SyncStream::readFrames(Frame::Kind kind) {
+    Buffer bytes;
+    while (true) {
+      OUTCOME_TRY(frame, read<Frame>());
+      if (frame.kind == Frame::kError) {
+        logger()->error("call failed on worker: {}",
+                        std::string{frame.chunk.begin(), frame.chunk.end()});
+        return RemoteWorkerErrors::kCallFailed;
+      }
+      if (frame.kind != kind) {
+        return RemoteWorkerErrors::kUnexpectedFrame;
+      }
+      bytes.put(frame.chunk);
+      if (frame.last) {
+        return std::move(bytes);
+      }
+    }
+  }
+}  // namespace fc::sector_storage::remote
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::sector_storage::remote, RemoteWorkerErrors, e) {
+  using fc::sector_storage::remote::RemoteWorkerErrors;
+  switch (e) {
+    case (RemoteWorkerErrors::kDisconnected):
+      return "RemoteWorker: worker is disconnected";
+    case (RemoteWorkerErrors::kCallFailed):
+      return "RemoteWorker: call failed on worker";
+    case (RemoteWorkerErrors::kUnexpectedFrame):
+      return "RemoteWorker: unexpected frame of call";
+    case (RemoteWorkerErrors::kUnknownMethod):
+      return "RemoteWorker: unknown method";
+    case (RemoteWorkerErrors::kCannotCreatePipe):
+      return "RemoteWorker: cannot create pipe for piece data";
+    case (RemoteWorkerErrors::kCannotTransferPiece):
+      return "RemoteWorker: cannot transfer piece data";
+    case (RemoteWorkerErrors::kTimeout):
+      return "RemoteWorker: call deadline passed";
+    default:
+      return "RemoteWorker: unknown error";
+  }
+}
@@ -0,0 +1,219 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_SECTOR_STORAGE_IMPL_REMOTE_WORKER_PROTOCOL_HPP
+#define CPP_FILECOIN_CORE_SECTOR_STORAGE_IMPL_REMOTE_WORKER_PROTOCOL_HPP
+
+#include <boost/asio/io_context.hpp>
+#include <chrono>
+#include <future>
+
+#include "common/buffer.hpp"
+#include "common/libp2p/cbor_stream.hpp"
+#include "sector_storage/worker.hpp"
+
+namespace fc::sector_storage::remote {
+  using common::Buffer;
+  using common::libp2p::CborStream;
+  using primitives::StoragePath;
+  using primitives::WorkerInfo;
+  using Clock = std::chrono::steady_clock;
+
+  /// Worker dials miner and sends heartbeats on stream of this protocol
+  constexpr auto kHeartbeatProtocol{"/fc/sealing/worker/heartbeat/0.0.1"};
+  /// Miner opens stream of this protocol to worker for each call
+  constexpr auto kCallProtocol{"/fc/sealing/worker/call/0.0.1"};
+
+  /// Max bytes of arguments, results or piece data in one frame
+  constexpr size_t kChunkBytes{1 << 20};
+  constexpr std::chrono::seconds kHeartbeatInterval{10};
+  /// Worker without heartbeat for this time is considered disconnected
+  constexpr std::chrono::seconds kHeartbeatTimeout{3 * kHeartbeatInterval};
+  /// Deadline of calls which do not seal or transfer piece
+  constexpr std::chrono::minutes kCallTimeout{10};
+  /// Deadline of sealing phases and piece transfers, which take hours
+  constexpr std::chrono::hours kSealCallTimeout{24};
+
+  enum class WorkerMethod {
+    kSealPreCommit1 = 1,
+    kSealPreCommit2,
+    kSealCommit1,
+    kSealCommit2,
+    kFinalizeSector,
+    kRemove,
+    kAddPiece,
+    kMoveStorage,
+    kFetch,
+    kUnsealPiece,
+    kReadPiece,
+  };
+
+  /**
+   * Part of call stream. Call is its method followed by arguments frames,
+   * piece data frames for addPiece, then worker replies with piece data
+   * frames for readPiece and result frames. Error frame ends call.
+   */
+  struct Frame {
+    enum Kind {
+      kArguments = 1,
+      kData,
+      kResult,
+      kError,
+    };
+
+    Kind kind{};
+    Buffer chunk;
+    /// Last frame of its kind
+    bool last{};
+  };
+  CBOR_TUPLE(Frame, kind, chunk, last)
+
+  struct Heartbeat {
+    WorkerInfo info;
+    /// Supported task types
+    std::vector<std::string> tasks;
+    std::vector<StoragePath> paths;
+  };
+  CBOR_TUPLE(Heartbeat, info, tasks, paths)
+
+  struct SealPreCommit1Params {
+    SectorId sector;
+    SealRandomness ticket;
+    std::vector<PieceInfo> pieces;
+  };
+  CBOR_TUPLE(SealPreCommit1Params, sector, ticket, pieces)
+
+  struct SealPreCommit2Params {
+    SectorId sector;
+    PreCommit1Output pre_commit_1_output;
+  };
+  CBOR_TUPLE(SealPreCommit2Params, sector, pre_commit_1_output)
+
+  struct SealCommit1Params {
+    SectorId sector;
+    SealRandomness ticket;
+    InteractiveRandomness seed;
+    std::vector<PieceInfo> pieces;
+    SectorCids cids;
+  };
+  CBOR_TUPLE(SealCommit1Params, sector, ticket, seed, pieces, cids)
+
+  struct SealCommit2Params {
+    SectorId sector;
+    Commit1Output commit_1_output;
+  };
+  CBOR_TUPLE(SealCommit2Params, sector, commit_1_output)
+
+  /// Params of finalizeSector, remove and moveStorage
+  struct SectorParams {
+    SectorId sector;
+  };
+  CBOR_TUPLE(SectorParams, sector)
+
+  struct AddPieceParams {
+    SectorId sector;
+    std::vector<UnpaddedPieceSize> piece_sizes;
+    UnpaddedPieceSize new_piece_size;
+  };
+  CBOR_TUPLE(AddPieceParams, sector, piece_sizes, new_piece_size)
+
+  struct FetchParams {
+    SectorId sector;
+    SectorFileType file_type;
+    bool can_seal;
+  };
+  CBOR_TUPLE(FetchParams, sector, file_type, can_seal)
+
+  struct UnsealPieceParams {
+    SectorId sector;
+    UnpaddedByteIndex offset;
+    UnpaddedPieceSize size;
+    SealRandomness randomness;
+    CID unsealed_cid;
+  };
+  CBOR_TUPLE(UnsealPieceParams, sector, offset, size, randomness, unsealed_cid)
+
+  struct ReadPieceParams {
+    SectorId sector;
+    UnpaddedByteIndex offset;
+    UnpaddedPieceSize size;
+  };
+  CBOR_TUPLE(ReadPieceParams, sector, offset, size)
+
+  /// Deadline of call of method, from its start
+  Clock::duration callTimeout(WorkerMethod method);
+
+  /// Splits encoded value into frames of at most kChunkBytes
+  std::vector<Frame> splitFrames(Frame::Kind kind, const Buffer &bytes);
+
+  /**
+   * Sequential reads and writes of cbor stream from threads other than io
+   * thread, which runs libp2p callbacks. Calls block until completed, so
+   * next frame of call is read only after previous one is handled. Stream
+   * is reset when deadline passes, and calls fail with kTimeout.
+   */
+  class SyncStream {
+   public:
+    SyncStream(std::shared_ptr<CborStream> stream,
+               boost::asio::io_context &io,
+               Clock::time_point deadline);
+    SyncStream(const SyncStream &) = delete;
+    SyncStream &operator=(const SyncStream &) = delete;
+    ~SyncStream();
+
+    outcome::result<Buffer> readRaw();
+
+    template <typename T>
+    outcome::result<T> read() {
+      OUTCOME_TRY(bytes, readRaw());
+      return codec::cbor::decode<T>(bytes);
+    }
+
+    outcome::result<void> writeRaw(Buffer bytes);
+
+    template <typename T>
+    outcome::result<void> write(const T &value) {
+      OUTCOME_TRY(bytes, codec::cbor::encode(value));
+      return writeRaw(std::move(bytes));
+    }
+
+    /// Writes value encoded into frames of given kind
+    outcome::result<void> writeFrames(Frame::Kind kind, const Buffer &bytes);
+
+    /**
+     * Reads frames of given kind until last one
+     * @return joined chunks, error if peer sent error frame
+     */
+    outcome::result<Buffer> readFrames(Frame::Kind kind);
+
+    /// Moves deadline of following reads and writes
+    void setDeadline(Clock::time_point deadline);
+
+   private:
+    /// Waits for result of operation started on io until deadline
+    template <typename T>
+    outcome::result<T> wait(
+        std::function<void(std::shared_ptr<std::promise<outcome::result<T>>>)>
+            start);
+
+    std::shared_ptr<CborStream> stream_;
+    boost::asio::io_context &io_;
+    Clock::time_point deadline_;
+  };
+
+  enum class RemoteWorkerErrors {
+    kDisconnected = 1,
+    kCallFailed,
+    kUnexpectedFrame,
+    kUnknownMethod,
+    kCannotCreatePipe,
+    kCannotTransferPiece,
+    kTimeout,
+  };
+}  // namespace fc::sector_storage::remote
+
+OUTCOME_HPP_DECLARE_ERROR(fc::sector_storage::remote, RemoteWorkerErrors);
+
+#endif  // CPP_FILECOIN_CORE_SECTOR_STORAGE_IMPL_REMOTE_WORKER_PROTOCOL_HPP
@@ -0,0 +1,306 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/impl/remote_worker_server.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <boost/asio/post.hpp>
+#include <future>
+
+namespace fc::sector_storage::remote {
+  namespace {
+    /// Socket pair, unlike pipe, fails writes to closed peer without SIGPIPE
+    outcome::result<std::pair<int, int>> socketPair() {
+      int fds[2];
+      if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        return RemoteWorkerErrors::kCannotCreatePipe;
+      }
+      return std::make_pair(fds[0], fds[1]);
+    }
+
+    bool sendAll(int fd, const Buffer &bytes) {
+      for (size_t sent{0}; sent < bytes.size();) {
+        auto n{::send(
+            fd, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL)};
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n <= 0) {
+          return false;
+        }
+        sent += n;
+      }
+      return true;
+    }
+
+    template <typename T>
+    outcome::result<Buffer> encodeResult(outcome::result<T> &&result) {
+      OUTCOME_TRY(value, std::move(result));
+      return codec::cbor::encode(value);
+    }
+
+    outcome::result<Buffer> encodeResult(outcome::result<void> &&result) {
+      OUTCOME_TRY(std::move(result));
+      return Buffer{};
+    }
+  }  // namespace
+
+  WorkerServer::WorkerServer(std::shared_ptr<Host> host,
+                             std::shared_ptr<Worker> worker,
+                             boost::asio::io_context &io,
+                             size_t threads)
+      : host_{std::move(host)},
+        worker_{std::move(worker)},
+        io_{io},
+        timer_{io},
+        calls_{std::make_shared<boost::asio::thread_pool>(threads)},
+        logger_{common::createLogger("worker server")} {}
+
+  WorkerServer::~WorkerServer() {
+    if (calls_->get_executor().running_in_this_thread()) {
+      boost::asio::post(io_, [calls{std::move(calls_)}] {});
+    }
+  }
+
+  void WorkerServer::start(PeerInfo miner) {
+    miner_ = std::move(miner);
+    host_->setProtocolHandler(
+        kCallProtocol, [weak{weak_from_this()}](auto stream) {
+          auto self{weak.lock()};
+          auto peer{stream->remotePeerId()};
+          // only miner of worker calls it
+          if (!self || !peer || peer.value() != self->miner_->id) {
+            return stream->reset();
+          }
+          boost::asio::post(
+              *self->calls_,
+              [self, stream{std::make_shared<CborStream>(stream)}] {
+                self->serve(stream);
+              });
+        });
+    connect();
+  }
+
+  void WorkerServer::connect() {
+    host_->newStream(
+        *miner_, kHeartbeatProtocol, [weak{weak_from_this()}](auto stream) {
+          auto self{weak.lock()};
+          if (!self) {
+            return;
+          }
+          if (!stream) {
+            self->logger_->warn("cannot connect to miner: {}",
+                                stream.error().message());
+            return self->reconnect();
+          }
+          self->heartbeat_stream_ =
+              std::make_shared<CborStream>(stream.value());
+          self->sendHeartbeat();
+        });
+  }
+
+  void WorkerServer::sendHeartbeat() {
+    Heartbeat heartbeat;
+    auto info{worker_->getInfo()};
+    auto tasks{worker_->getSupportedTask()};
+    auto paths{worker_->getAccessiblePaths()};
+    if (!info || !tasks || !paths) {
+      logger_->error("cannot get worker info for heartbeat");
+      heartbeat_stream_->close();
+      return reconnect();
+    }
+    heartbeat.info = std::move(info.value());
+    heartbeat.tasks.assign(tasks.value().begin(), tasks.value().end());
+    heartbeat.paths = std::move(paths.value());
+    heartbeat_stream_->write(
+        heartbeat, [weak{weak_from_this()}](auto written) {
+          auto self{weak.lock()};
+          if (!self) {
+            return;
+          }
+          if (!written) {
+            self->logger_->warn("heartbeat failed: {}",
+                                written.error().message());
+            self->heartbeat_stream_->close();
+            return self->reconnect();
+          }
+          self->timer_.expires_after(kHeartbeatInterval);
+          self->timer_.async_wait([weak](auto ec) {
+            if (auto self{weak.lock()}; self && !ec) {
+              self->sendHeartbeat();
+            }
+          });
+        });
+  }
+
+  void WorkerServer::reconnect() {
+    heartbeat_stream_.reset();
+    timer_.expires_after(kHeartbeatInterval);
+    timer_.async_wait([weak{weak_from_this()}](auto ec) {
+      if (auto self{weak.lock()}; self && !ec) {
+        self->connect();
+      }
+    });
+  }
+
+  void WorkerServer::serve(std::shared_ptr<CborStream> cbor_stream) {
+    const auto start{Clock::now()};
+    SyncStream stream{std::move(cbor_stream), io_, start + kCallTimeout};
+    auto method{stream.read<WorkerMethod>()};
+    if (!method) {
+      return;
+    }
+    stream.setDeadline(start + callTimeout(method.value()));
+    auto result{[&]() -> outcome::result<Buffer> {
+      OUTCOME_TRY(arguments, stream.readFrames(Frame::kArguments));
+      return dispatch(stream, method.value(), arguments);
+    }()};
+    if (!result) {
+      auto message{result.error().message()};
+      logger_->warn("call {} failed: {}",
+                    static_cast<int>(method.value()),
+                    message);
+      if (!stream.write(Frame{Frame::kError, Buffer{}.put(message), true})) {
+        logger_->warn("cannot send error of call");
+      }
+      return;
+    }
+    if (auto written{stream.writeFrames(Frame::kResult, result.value())};
+        !written) {
+      logger_->warn("cannot send result of call {}: {}",
+                    static_cast<int>(method.value()),
+                    written.error().message());
+    }
+  }
+
+  outcome::result<Buffer> WorkerServer::dispatch(SyncStream &stream,
+                                                 WorkerMethod method,
+                                                 const Buffer &arguments) {
+    using codec::cbor::decode;
+    switch (method) {
+      case WorkerMethod::kSealPreCommit1: {
+        OUTCOME_TRY(params, decode<SealPreCommit1Params>(arguments));
+        return encodeResult(worker_->sealPreCommit1(
+            params.sector, params.ticket, params.pieces));
+      }
+      case WorkerMethod::kSealPreCommit2: {
+        OUTCOME_TRY(params, decode<SealPreCommit2Params>(arguments));
+        return encodeResult(worker_->sealPreCommit2(
+            params.sector, params.pre_commit_1_output));
+      }
+      case WorkerMethod::kSealCommit1: {
+        OUTCOME_TRY(params, decode<SealCommit1Params>(arguments));
+        return encodeResult(worker_->sealCommit1(params.sector,
+                                                 params.ticket,
+                                                 params.seed,
+                                                 params.pieces,
+                                                 params.cids));
+      }
+      case WorkerMethod::kSealCommit2: {
+        OUTCOME_TRY(params, decode<SealCommit2Params>(arguments));
+        return encodeResult(
+            worker_->sealCommit2(params.sector, params.commit_1_output));
+      }
+      case WorkerMethod::kFinalizeSector: {
+        OUTCOME_TRY(params, decode<SectorParams>(arguments));
+        return encodeResult(worker_->finalizeSector(params.sector));
+      }
+      case WorkerMethod::kRemove: {
+        OUTCOME_TRY(params, decode<SectorParams>(arguments));
+        return encodeResult(worker_->remove(params.sector));
+      }
+      case WorkerMethod::kAddPiece: {
+        OUTCOME_TRY(params, decode<AddPieceParams>(arguments));
+        return encodeResult(addPiece(stream, params));
+      }
+      case WorkerMethod::kMoveStorage: {
+        OUTCOME_TRY(params, decode<SectorParams>(arguments));
+        return encodeResult(worker_->moveStorage(params.sector));
+      }
+      case WorkerMethod::kFetch: {
+        OUTCOME_TRY(params, decode<FetchParams>(arguments));
+        return encodeResult(
+            worker_->fetch(params.sector, params.file_type, params.can_seal));
+      }
+      case WorkerMethod::kUnsealPiece: {
+        OUTCOME_TRY(params, decode<UnsealPieceParams>(arguments));
+        return encodeResult(worker_->unsealPiece(params.sector,
+                                                 params.offset,
+                                                 params.size,
+                                                 params.randomness,
+                                                 params.unsealed_cid));
+      }
+      case WorkerMethod::kReadPiece: {
+        OUTCOME_TRY(params, decode<ReadPieceParams>(arguments));
+        return encodeResult(readPiece(stream, params));
+      }
+    }
+    return RemoteWorkerErrors::kUnknownMethod;
+  }
+
+  outcome::result<PieceInfo> WorkerServer::addPiece(
+      SyncStream &stream, const AddPieceParams &params) {
+    OUTCOME_TRY(fds, socketPair());
+    proofs::PieceData input{fds.first};
+    // worker reads piece while frames are received
+    auto receive{[&stream, fd{fds.second}]() -> outcome::result<void> {
+      auto sent{true};
+      while (true) {
+        auto frame{stream.read<Frame>()};
+        if (!frame || frame.value().kind != Frame::kData) {
+          ::close(fd);
+          return RemoteWorkerErrors::kUnexpectedFrame;
+        }
+        // frames are read to end if worker gave up
+        sent = sent && sendAll(fd, frame.value().chunk);
+        if (frame.value().last) {
+          ::close(fd);
+          return outcome::success();
+        }
+      }
+    }};
+    auto received{std::async(std::launch::async, receive)};
+    auto piece{worker_->addPiece(
+        params.sector, params.piece_sizes, params.new_piece_size, input)};
+    // worker may return before reading end of piece
+    ::shutdown(input.getFd(), SHUT_RD);
+    OUTCOME_TRY(received.get());
+    return piece;
+  }
+
+  outcome::result<void> WorkerServer::readPiece(SyncStream &stream,
+                                                const ReadPieceParams &params) {
+    OUTCOME_TRY(fds, socketPair());
+    proofs::PieceData input{fds.first};
+    auto read{std::async(std::launch::async, [&, fd{fds.second}]() mutable {
+      return worker_->readPiece(
+          proofs::PieceData{fd}, params.sector, params.offset, params.size);
+    })};
+    // piece is sent while worker writes it, socket is drained until worker
+    // closes it even if miner is gone
+    auto sent{outcome::result<void>{outcome::success()}};
+    Buffer chunk(kChunkBytes, 0);
+    while (true) {
+      auto n{::read(input.getFd(), chunk.data(), chunk.size())};
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n < 0) {
+        n = 0;
+      }
+      if (sent) {
+        sent = stream.write(Frame{
+            Frame::kData, Buffer{gsl::make_span(chunk).first(n)}, n == 0});
+      }
+      if (n == 0) {
+        break;
+      }
+    }
+    OUTCOME_TRY(read.get());
+    return sent;
+  }
+}  // namespace fc::sector_storage::remote
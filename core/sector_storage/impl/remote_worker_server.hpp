@@ -0,0 +1,74 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_SECTOR_STORAGE_IMPL_REMOTE_WORKER_SERVER_HPP
+#define CPP_FILECOIN_CORE_SECTOR_STORAGE_IMPL_REMOTE_WORKER_SERVER_HPP
+
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <libp2p/host/host.hpp>
+
+#include "common/logger.hpp"
+#include "sector_storage/impl/remote_worker_protocol.hpp"
+
+namespace fc::sector_storage::remote {
+  using libp2p::Host;
+  using libp2p::peer::PeerInfo;
+
+  /// Calls served at once, others wait for free thread
+  constexpr size_t kWorkerServerThreads{8};
+
+  /**
+   * Serves calls of miner to worker on this machine.
+   * Worker dials miner and sends heartbeats with its resources, so miner's
+   * scheduler gets it, connection is kept by heartbeat stream and redialed
+   * after failure. Calls are served by pool threads until deadline of
+   * method, piece data is passed to worker through socket pair while it is
+   * received.
+   */
+  class WorkerServer : public std::enable_shared_from_this<WorkerServer> {
+   public:
+    WorkerServer(std::shared_ptr<Host> host,
+                 std::shared_ptr<Worker> worker,
+                 boost::asio::io_context &io,
+                 size_t threads = kWorkerServerThreads);
+
+    /// Pool is joined on io if last reference is released by call
+    ~WorkerServer();
+
+    /// Accepts calls of miner and starts heartbeats to it
+    void start(PeerInfo miner);
+
+   private:
+    void connect();
+    void sendHeartbeat();
+    /// Dials miner again after heartbeat interval
+    void reconnect();
+
+    void serve(std::shared_ptr<CborStream> stream);
+
+    /// Runs method of worker, returns encoded result
+    outcome::result<Buffer> dispatch(SyncStream &stream,
+                                     WorkerMethod method,
+                                     const Buffer &arguments);
+
+    outcome::result<PieceInfo> addPiece(SyncStream &stream,
+                                        const AddPieceParams &params);
+
+    outcome::result<void> readPiece(SyncStream &stream,
+                                    const ReadPieceParams &params);
+
+    std::shared_ptr<Host> host_;
+    std::shared_ptr<Worker> worker_;
+    boost::asio::io_context &io_;
+    boost::asio::steady_timer timer_;
+    std::shared_ptr<boost::asio::thread_pool> calls_;
+    boost::optional<PeerInfo> miner_;
+    std::shared_ptr<CborStream> heartbeat_stream_;
+    common::Logger logger_;
+  };
+}  // namespace fc::sector_storage::remote
+
+#endif  // CPP_FILECOIN_CORE_SECTOR_STORAGE_IMPL_REMOTE_WORKER_SERVER_HPP
@@ -6,15 +6,44 @@
 #include "sector_storage/impl/scheduler_impl.hpp"
 #include <boost/asio/post.hpp>
 #include <boost/thread.hpp>
+#include <future>
 #include <thread>
+#include "metrics/metrics.hpp"
 #include "primitives/resources/active_resources.hpp"
+#include "sector_storage/impl/numa.hpp"
 
 namespace fc::sector_storage {
   using primitives::Resources;
   using primitives::WorkerResources;
+  using primitives::sector_file::SectorFileType;
+
+  namespace {
+    /// Scheduler tasks are long, so metrics are looked up on every use
+    metrics::Gauge &queueGauge(const TaskType &task_type) {
+      return metrics::Registry::global().gauge("fc_scheduler_queue_length",
+                                               "Requests waiting for worker",
+                                               {{"task", task_type}});
+    }
+
+    metrics::Gauge &activeGauge(const TaskType &task_type) {
+      return metrics::Registry::global().gauge(
+          "fc_scheduler_active_tasks",
+          "Tasks being prepared or executed by workers",
+          {{"task", task_type}});
+    }
+
+    metrics::Histogram &timeHistogram(const char *name,
+                                      const char *help,
+                                      const TaskType &task_type) {
+      return metrics::Registry::global().histogram(
+          name, help, {{"task", task_type}}, 1e-9);
+    }
+  }  // namespace
 
-  SchedulerImpl::SchedulerImpl(RegisteredProof seal_proof_type)
+  SchedulerImpl::SchedulerImpl(RegisteredProof seal_proof_type,
+                               std::shared_ptr<stores::SectorIndex> index)
       : seal_proof_type_(seal_proof_type),
+        index_(std::move(index)),
         current_worker_id_(0),
         logger_(common::createLogger("scheduler")) {
     unsigned int nthreads = 0;
@@ -28,36 +57,46 @@ namespace fc::sector_storage {
     }
   }
 
-  outcome::result<void> SchedulerImpl::schedule(
+  void SchedulerImpl::scheduleAsync(
       const primitives::sector::SectorId &sector,
       const primitives::TaskType &task_type,
       const std::shared_ptr<WorkerSelector> &selector,
       const WorkerAction &prepare,
       const WorkerAction &work,
+      const ReturnCb<void> &callback,
       uint64_t priority) {
     std::shared_ptr<TaskRequest> request = std::make_shared<TaskRequest>(
-        sector, task_type, priority, selector, prepare, work);
-
-    {
-      std::lock_guard<std::mutex> lock(request_lock_);
+        sector, task_type, priority, selector, prepare, work, callback);
 
-      OUTCOME_TRY(scheduled, maybeScheduleRequest(request));
-
-      if (!scheduled) {
-        request_queue_.insert(request);
-      }
-    }
-
-    while (true) {
-      if (request->response) {
-        break;
-      }
+    std::lock_guard<std::mutex> lock(request_lock_);
 
-      std::unique_lock<std::mutex> lock(request->mutex_);
-      request->cv_.wait(lock, [&] { return request->response; });
+    auto maybe_scheduled = maybeScheduleRequest(request);
+    if (maybe_scheduled.has_error()) {
+      respond(request, maybe_scheduled.error());
+    } else if (!maybe_scheduled.value()) {
+      auto &queue{request_queues_[request->task_type]};
+      queue.push_back(request);
+      queueGauge(request->task_type).set(queue.size());
     }
+  }
 
-    return *request->response;
+  outcome::result<void> SchedulerImpl::schedule(
+      const primitives::sector::SectorId &sector,
+      const primitives::TaskType &task_type,
+      const std::shared_ptr<WorkerSelector> &selector,
+      const WorkerAction &prepare,
+      const WorkerAction &work,
+      uint64_t priority) {
+    std::promise<outcome::result<void>> promise;
+    scheduleAsync(
+        sector,
+        task_type,
+        selector,
+        prepare,
+        work,
+        [&](outcome::result<void> result) { promise.set_value(result); },
+        priority);
+    return promise.get_future().get();
   }
 
   void SchedulerImpl::newWorker(std::unique_ptr<WorkerHandle> worker) {
@@ -67,6 +106,9 @@ namespace fc::sector_storage {
     }
     WorkerID wid = current_worker_id_++;
     workers_.insert({wid, std::move(worker)});
+    metrics::Registry::global()
+        .gauge("fc_scheduler_workers", "Connected workers")
+        .set(workers_.size());
     lock.unlock();
 
     freeWorker(wid);
@@ -79,14 +121,6 @@ namespace fc::sector_storage {
     std::vector<WorkerID> acceptable;
     uint64_t tried = 0;
 
-    auto resource_iter =
-        primitives::kResourceTable.find({request->task_type, seal_proof_type_});
-
-    Resources need_resources{};
-    if (resource_iter != primitives::kResourceTable.end()) {
-      need_resources = resource_iter->second;
-    }
-
     for (const auto &[wid, worker] : workers_) {
       OUTCOME_TRY(satisfies,
                   request->sel->is_satisfying(
@@ -97,8 +131,7 @@ namespace fc::sector_storage {
       }
       tried++;
 
-      if (!primitives::canHandleRequest(
-              need_resources, worker->info.resources, worker->preparing)) {
+      if (!canHandle(worker, request->task_type)) {
         continue;
       }
 
@@ -106,10 +139,15 @@ namespace fc::sector_storage {
     }
 
     if (!acceptable.empty()) {
+      OUTCOME_TRY(local, localWorkers(*request, acceptable));
       bool does_error_occurs = false;
       std::stable_sort(acceptable.begin(),
                        acceptable.end(),
                        [&](WorkerID lhs, WorkerID rhs) {
+                         auto lhs_local{local.count(lhs) != 0};
+                         if (lhs_local != (local.count(rhs) != 0)) {
+                           return lhs_local;
+                         }
                          auto maybe_res = request->sel->is_preferred(
                              request->task_type, workers_[lhs], workers_[rhs]);
 
@@ -145,24 +183,36 @@ namespace fc::sector_storage {
       WorkerID wid,
       const std::shared_ptr<WorkerHandle> &worker,
       const std::shared_ptr<TaskRequest> &request) {
-    auto resource_iter =
-        primitives::kResourceTable.find({request->task_type, seal_proof_type_});
-
-    Resources need_resources{};
-    if (resource_iter != primitives::kResourceTable.end()) {
-      need_resources = resource_iter->second;
-    }
-
-    worker->preparing.add(worker->info.resources, need_resources);
-
-    boost::asio::post(*pool_, [this, wid, worker, request, need_resources]() {
+    auto need_resources{needResources(request->task_type)};
+    // node keeps cores and memory of task local, chosen with preparing tasks
+    auto numa_node{primitives::pickNumaNode(need_resources,
+                                            worker->info.resources,
+                                            worker->preparing,
+                                            worker->active)};
+
+    worker->preparing.add(worker->info.resources, need_resources, numa_node);
+    timeHistogram("fc_scheduler_wait_seconds",
+                  "Time of request in queue before assignment",
+                  request->task_type)
+        .observe(std::chrono::steady_clock::now() - request->queued);
+    activeGauge(request->task_type).add(1);
+
+    boost::asio::post(*pool_, [this,
+                               wid,
+                               worker,
+                               request,
+                               need_resources,
+                               numa_node]() {
+      auto &active{activeGauge(request->task_type)};
       {
         auto maybe_err = request->prepare(worker->worker);
         std::unique_lock<std::mutex> lock(workers_lock_);
         if (maybe_err.has_error()) {
-          worker->preparing.free(worker->info.resources, need_resources);
-          request->respond(maybe_err.error());
+          worker->preparing.free(
+              worker->info.resources, need_resources, numa_node);
+          respond(request, maybe_err.error());
           lock.unlock();
+          active.add(-1);
           freeWorker(wid);
           return;
         }
@@ -170,18 +220,28 @@ namespace fc::sector_storage {
         maybe_err = worker->active.withResources(
             worker->info.resources,
             need_resources,
+            numa_node,
             workers_lock_,
             [&]() -> outcome::result<void> {
-              worker->preparing.free(worker->info.resources, need_resources);
+              worker->preparing.free(
+                  worker->info.resources, need_resources, numa_node);
               lock.unlock();
 
-              auto res = request->work(worker->worker);
-
-              if (res.has_error()) {
-                request->respond(res.error());
-              } else {
-                request->respond(std::error_code());
+              auto start{std::chrono::steady_clock::now()};
+              boost::optional<primitives::NumaNode> node;
+              if (numa_node) {
+                node = worker->info.resources.numa_nodes[*numa_node];
               }
+              auto result{[&] {
+                // local worker binds ffi calls to node
+                numa::ScopedAssignment assignment{std::move(node)};
+                return request->work(worker->worker);
+              }()};
+              timeHistogram("fc_scheduler_work_seconds",
+                            "Time of task execution by worker",
+                            request->task_type)
+                  .observe(std::chrono::steady_clock::now() - start);
+              respond(request, std::move(result));
 
               lock.lock();
               return outcome::success();
@@ -191,6 +251,7 @@ namespace fc::sector_storage {
         }
       }
 
+      active.add(-1);
       freeWorker(wid);
     });
   }
@@ -208,8 +269,31 @@ namespace fc::sector_storage {
     }
 
     std::lock_guard<std::mutex> lock(request_lock_);
-    for (auto it = request_queue_.begin(); it != request_queue_.cend(); ++it) {
-      auto req = *it;
+    // requests of task types, which do not fit worker, are not checked
+    std::vector<std::shared_ptr<TaskRequest>> candidates;
+    for (const auto &[task_type, queue] : request_queues_) {
+      if (!queue.empty() && canHandle(worker, queue.front()->task_type)) {
+        candidates.insert(candidates.end(), queue.begin(), queue.end());
+      }
+    }
+    auto now{std::chrono::steady_clock::now()};
+    std::stable_sort(candidates.begin(),
+                     candidates.end(),
+                     [&](const auto &lhs, const auto &rhs) {
+                       return isScheduledBefore(*lhs, *rhs, now);
+                     });
+
+    // fill worker while resources are left, skipping tasks which do not fit
+    std::set<std::string> full;
+    for (const auto &req : candidates) {
+      if (full.count(req->task_type) != 0) {
+        continue;
+      }
+      if (!canHandle(worker, req->task_type)) {
+        full.insert(req->task_type);
+        continue;
+      }
+
       auto maybe_satisfying =
           req->sel->is_satisfying(req->task_type, seal_proof_type_, worker);
       if (maybe_satisfying.has_error()) {
@@ -225,17 +309,74 @@ namespace fc::sector_storage {
       auto maybe_result = maybeScheduleRequest(req);
 
       if (maybe_result.has_error()) {
-        req->respond(maybe_result.error());
+        respond(req, maybe_result.error());
       } else if (!maybe_result.value()) {
         continue;
       }
 
-      it = request_queue_.erase(it);
-      if (it == request_queue_.cend()) {
-        break;
+      auto &queue{request_queues_[req->task_type]};
+      queue.erase(std::find(queue.begin(), queue.end(), req));
+      queueGauge(req->task_type).set(queue.size());
+    }
+  }
+
+  void SchedulerImpl::respond(const std::shared_ptr<TaskRequest> &request,
+                              outcome::result<void> result) {
+    boost::asio::post(completion_pool_,
+                      [request, result{std::move(result)}]() {
+                        request->callback(result);
+                      });
+  }
+
+  Resources SchedulerImpl::needResources(const TaskType &task_type) const {
+    auto resource_iter =
+        primitives::kResourceTable.find({task_type, seal_proof_type_});
+    if (resource_iter != primitives::kResourceTable.end()) {
+      return resource_iter->second;
+    }
+    return {};
+  }
+
+  bool SchedulerImpl::canHandle(const std::shared_ptr<WorkerHandle> &worker,
+                                const TaskType &task_type) const {
+    return primitives::canHandleRequest(needResources(task_type),
+                                        worker->info.resources,
+                                        worker->preparing,
+                                        worker->active);
+  }
+
+  outcome::result<std::set<WorkerID>> SchedulerImpl::localWorkers(
+      TaskRequest &request, const std::vector<WorkerID> &workers) {
+    std::set<WorkerID> local;
+    if (!index_) {
+      return local;
+    }
+    if (!request.local_storages) {
+      OUTCOME_TRY(storages,
+                  index_->storageFindSector(
+                      request.sector,
+                      static_cast<SectorFileType>(SectorFileType::FTUnsealed
+                                                  | SectorFileType::FTSealed
+                                                  | SectorFileType::FTCache),
+                      false));
+      request.local_storages.emplace();
+      for (const auto &storage : storages) {
+        request.local_storages->insert(storage.id);
+      }
+    }
+    if (request.local_storages->empty()) {
+      return local;
+    }
+    for (auto wid : workers) {
+      OUTCOME_TRY(paths, workers_[wid]->worker->getAccessiblePaths());
+      for (const auto &path : paths) {
+        if (request.local_storages->count(path.id) != 0) {
+          local.insert(wid);
+          break;
+        }
       }
-      --it;
     }
+    return local;
   }
 
   RegisteredProof SchedulerImpl::getSealProofType() const {
@@ -9,27 +9,38 @@
 #include "sector_storage/scheduler.hpp"
 
 #include <boost/asio/thread_pool.hpp>
+#include <chrono>
 #include <mutex>
+#include <set>
 #include <unordered_map>
 #include <utility>
 
+#include "sector_storage/stores/index.hpp"
+
 namespace fc::sector_storage {
   using WorkerID = uint64_t;
 
+  /// Waiting in queue for each interval raises request priority by one
+  constexpr std::chrono::seconds kPriorityAgingInterval{60};
+  /// Threads of executor, which calls callbacks of finished requests
+  constexpr size_t kCompletionThreads{2};
+
   struct TaskRequest {
     inline TaskRequest(const SectorId &sector,
                        TaskType task_type,
                        uint64_t priority,
                        std::shared_ptr<WorkerSelector> sel,
                        WorkerAction prepare,
-                       WorkerAction work)
+                       WorkerAction work,
+                       ReturnCb<void> callback)
         : sector(sector),
           task_type(std::move(task_type)),
           priority(priority),
           sel(std::move(sel)),
           prepare(std::move(prepare)),
           work(std::move(work)),
-          response(boost::none){};
+          callback(std::move(callback)),
+          queued(std::chrono::steady_clock::now()){};
 
     SectorId sector;
     TaskType task_type;
@@ -38,36 +49,60 @@ namespace fc::sector_storage {
 
     WorkerAction prepare;
     WorkerAction work;
+    ReturnCb<void> callback;
 
-    inline void respond(const std::error_code &resp) {
-      if (resp) {
-        response = resp;
-      } else {
-        response = outcome::success();
-      }
-      cv_.notify_one();
-    }
-
-    boost::optional<outcome::result<void>> response;
-    std::mutex mutex_;
-    std::condition_variable cv_;
+    /// Time of scheduling, used for aging
+    std::chrono::steady_clock::time_point queued;
+    /// Storages with sector files, found on first scheduling attempt
+    boost::optional<std::set<primitives::StorageID>> local_storages;
   };
 
-  inline bool operator<(const TaskRequest &lhs, const TaskRequest &rhs) {
-    if (lhs.priority != rhs.priority) {
-      return lhs.priority > rhs.priority;
+  /// Priority raised by time waited in queue
+  inline uint64_t effectivePriority(
+      const TaskRequest &request, std::chrono::steady_clock::time_point now) {
+    return request.priority
+           + static_cast<uint64_t>((now - request.queued)
+                                   / kPriorityAgingInterval);
+  }
+
+  /**
+   * Whether lhs request is scheduled before rhs: by effective priority, then
+   * by task type order, so later sealing stages go first, then by age
+   */
+  inline bool isScheduledBefore(const TaskRequest &lhs,
+                                const TaskRequest &rhs,
+                                std::chrono::steady_clock::time_point now) {
+    auto lhs_priority{effectivePriority(lhs, now)};
+    auto rhs_priority{effectivePriority(rhs, now)};
+    if (lhs_priority != rhs_priority) {
+      return lhs_priority > rhs_priority;
     }
 
-    if (lhs.task_type != rhs.task_type) {
+    if (lhs.task_type < rhs.task_type || rhs.task_type < lhs.task_type) {
       return lhs.task_type < rhs.task_type;
     }
 
-    return lhs.sector.sector < rhs.sector.sector;
+    return lhs.queued < rhs.queued;
   }
 
   class SchedulerImpl : public Scheduler {
    public:
-    explicit SchedulerImpl(RegisteredProof seal_proof_type);
+    /**
+     * @param seal_proof_type - proof type of sealed sectors
+     * @param index - optional, workers which can access storage with sector
+     * files are preferred
+     */
+    explicit SchedulerImpl(
+        RegisteredProof seal_proof_type,
+        std::shared_ptr<stores::SectorIndex> index = nullptr);
+
+    void scheduleAsync(const SectorId &sector,
+                       const primitives::TaskType &task_type,
+                       const std::shared_ptr<WorkerSelector> &selector,
+                       const WorkerAction &prepare,
+                       const WorkerAction &work,
+                       const ReturnCb<void> &callback,
+                       uint64_t priority) override;
 
     outcome::result<void> schedule(
         const SectorId &sector,
@@ -91,17 +126,34 @@ namespace fc::sector_storage {
 
     void freeWorker(WorkerID wid);
 
+    /// Passes result to callback of request on completion executor
+    void respond(const std::shared_ptr<TaskRequest> &request,
+                 outcome::result<void> result);
+
+    primitives::Resources needResources(const TaskType &task_type) const;
+
+    /// Whether task fits resources left by preparing and active tasks
+    bool canHandle(const std::shared_ptr<WorkerHandle> &worker,
+                   const TaskType &task_type) const;
+
+    /// Finds workers which can access storage with sector files
+    outcome::result<std::set<WorkerID>> localWorkers(
+        TaskRequest &request, const std::vector<WorkerID> &workers);
+
     RegisteredProof seal_proof_type_;
+    std::shared_ptr<stores::SectorIndex> index_;
 
     std::mutex workers_lock_;
     WorkerID current_worker_id_;
     std::unordered_map<WorkerID, std::shared_ptr<WorkerHandle>> workers_;
 
     std::mutex request_lock_;
-    std::multiset<std::shared_ptr<TaskRequest>,
-                  std::owner_less<std::shared_ptr<TaskRequest>>>
-        request_queue_;
+    /// Queues of waiting requests by task type
+    std::unordered_map<std::string, std::vector<std::shared_ptr<TaskRequest>>>
+        request_queues_;
 
+    // destroyed after pool_, which posts results to it
+    boost::asio::thread_pool completion_pool_{kCompletionThreads};
     std::unique_ptr<boost::asio::thread_pool> pool_;
 
     common::Logger logger_;
@@ -8,6 +8,7 @@
 
 #include "common/outcome.hpp"
 #include "sector_storage/fault_tracker.hpp"
+#include "sector_storage/scheduler.hpp"
 #include "sector_storage/spec_interfaces/prover.hpp"
 #include "sector_storage/spec_interfaces/sealer.hpp"
 #include "sector_storage/spec_interfaces/storage.hpp"
@@ -27,6 +28,39 @@ namespace fc::sector_storage {
    public:
     virtual SectorSize getSectorSize() = 0;
 
+    /**
+     * Non-blocking variants of sealing calls, cb is called when task is
+     * completed on worker. Caller thread is not kept while waiting for
+     * worker, sealing calls of Sealer wait for these.
+     */
+    virtual void sealPreCommit1Async(
+        const SectorId &sector,
+        const SealRandomness &ticket,
+        std::vector<PieceInfo> pieces,
+        const ReturnCb<PreCommit1Output> &cb,
+        uint64_t priority = kDefaultTaskPriority) = 0;
+
+    virtual void sealPreCommit2Async(
+        const SectorId &sector,
+        const PreCommit1Output &pre_commit_1_output,
+        const ReturnCb<SectorCids> &cb,
+        uint64_t priority = kDefaultTaskPriority) = 0;
+
+    virtual void sealCommit1Async(
+        const SectorId &sector,
+        const SealRandomness &ticket,
+        const InteractiveRandomness &seed,
+        std::vector<PieceInfo> pieces,
+        const SectorCids &cids,
+        const ReturnCb<Commit1Output> &cb,
+        uint64_t priority = kDefaultTaskPriority) = 0;
+
+    virtual void sealCommit2Async(
+        const SectorId &sector,
+        const Commit1Output &commit_1_output,
+        const ReturnCb<Proof> &cb,
+        uint64_t priority = kDefaultTaskPriority) = 0;
+
     virtual outcome::result<void> ReadPiece(proofs::PieceData output,
                                             const SectorId &sector,
                                             UnpaddedByteIndex offset,
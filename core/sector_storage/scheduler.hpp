@@ -18,12 +18,30 @@ namespace fc::sector_storage {
   using WorkerAction =
       std::function<outcome::result<void>(const std::shared_ptr<Worker> &)>;
 
+  /// Receives result of asynchronous call
+  template <typename T>
+  using ReturnCb = std::function<void(outcome::result<T>)>;
+
   constexpr uint64_t kDefaultTaskPriority = 0;
 
   class Scheduler {
    public:
     virtual ~Scheduler() = default;
 
+    /**
+     * Schedules work without blocking caller
+     * @param callback - called once with result of work, on completion
+     * executor of scheduler
+     */
+    virtual void scheduleAsync(const SectorId &sector,
+                               const TaskType &task_type,
+                               const std::shared_ptr<WorkerSelector> &selector,
+                               const WorkerAction &prepare,
+                               const WorkerAction &work,
+                               const ReturnCb<void> &callback,
+                               uint64_t priority = kDefaultTaskPriority) = 0;
+
+    /// Schedules work and waits for its result
     virtual outcome::result<void> schedule(
         const SectorId &sector,
         const TaskType &task_type,
@@ -0,0 +1,223 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/sealing/sector_packer.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace fc::sector_storage::sealing {
+  /// Read by filler pieces
+  auto const kZeroFile = "/dev/zero";
+
+  std::vector<size_t> packPieces(gsl::span<const PendingPiece> pieces,
+                                 PaddedPieceSize sector_size) {
+    std::vector<size_t> selected;
+    uint64_t used{0};
+    for (size_t i = 0; i < static_cast<size_t>(pieces.size()); ++i) {
+      auto size{pieces[i].size.padded()};
+      if (used + size <= sector_size) {
+        selected.push_back(i);
+        used += size;
+      }
+    }
+    std::stable_sort(selected.begin(), selected.end(), [&](auto l, auto r) {
+      return pieces[l].size > pieces[r].size;
+    });
+    return selected;
+  }
+
+  std::vector<PaddedPieceSize> fillerPieces(PaddedPieceSize used,
+                                            PaddedPieceSize sector_size) {
+    std::vector<PaddedPieceSize> fillers;
+    uint64_t rest{sector_size - used};
+    while (rest != 0) {
+      auto size{rest & (~rest + 1)};
+      fillers.emplace_back(size);
+      rest -= size;
+    }
+    return fillers;
+  }
+
+  SectorPacker::SectorPacker(std::shared_ptr<Manager> manager,
+                             NextSector next_sector,
+                             GetTicket get_ticket,
+                             PackedCb on_packed,
+                             PackerConfig config)
+      : manager_{std::move(manager)},
+        next_sector_{std::move(next_sector)},
+        get_ticket_{std::move(get_ticket)},
+        on_packed_{std::move(on_packed)},
+        config_{config},
+        sector_size_{manager_->getSectorSize()},
+        logger_{common::createLogger("sector packer")} {}
+
+  outcome::result<void> SectorPacker::addPiece(PendingPiece piece) {
+    if (piece.size.validate().has_error()) {
+      return SectorPackerErrors::kInvalidPieceSize;
+    }
+    if (piece.size.padded() > sector_size_) {
+      return SectorPackerErrors::kPieceTooBig;
+    }
+    {
+      std::lock_guard lock{mutex_};
+      pending_.push_back(std::move(piece));
+    }
+    return sealPending(boost::none);
+  }
+
+  outcome::result<void> SectorPacker::onEpoch(ChainEpoch now) {
+    return sealPending(now + config_.seal_margin);
+  }
+
+  outcome::result<void> SectorPacker::flush() {
+    return sealPending(std::numeric_limits<ChainEpoch>::max());
+  }
+
+  PaddedPieceSize SectorPacker::pendingSize() const {
+    std::lock_guard lock{mutex_};
+    uint64_t size{0};
+    for (const auto &piece : pending_) {
+      size += piece.size.padded();
+    }
+    return PaddedPieceSize{size};
+  }
+
+  boost::optional<std::vector<PendingPiece>> SectorPacker::takeSector(
+      boost::optional<ChainEpoch> urgent_before) {
+    auto urgent{[&](const PendingPiece &piece) {
+      return urgent_before
+             && piece.deal.deal_schedule.start_epoch < *urgent_before;
+    }};
+    // urgent deals first, then largest pieces fill sector best
+    std::vector<PendingPiece> ordered{pending_};
+    std::stable_sort(
+        ordered.begin(), ordered.end(), [&](const auto &l, const auto &r) {
+          if (urgent(l) != urgent(r)) {
+            return urgent(l);
+          }
+          return l.size > r.size;
+        });
+
+    auto selected{packPieces(ordered, sector_size_)};
+    uint64_t used{0};
+    auto has_urgent{false};
+    for (auto i : selected) {
+      used += ordered[i].size.padded();
+      has_urgent = has_urgent || urgent(ordered[i]);
+    }
+    if (used != sector_size_ && !has_urgent) {
+      return boost::none;
+    }
+
+    std::vector<PendingPiece> pieces;
+    std::vector<bool> taken(ordered.size(), false);
+    for (auto i : selected) {
+      pieces.push_back(ordered[i]);
+      taken[i] = true;
+    }
+    pending_.clear();
+    for (size_t i = 0; i < ordered.size(); ++i) {
+      if (!taken[i]) {
+        pending_.push_back(std::move(ordered[i]));
+      }
+    }
+    return pieces;
+  }
+
+  outcome::result<void> SectorPacker::sealPending(
+      boost::optional<ChainEpoch> urgent_before) {
+    while (true) {
+      boost::optional<std::vector<PendingPiece>> pieces;
+      {
+        std::lock_guard lock{mutex_};
+        pieces = takeSector(urgent_before);
+      }
+      if (!pieces) {
+        return outcome::success();
+      }
+      auto sealed{sealSector(*pieces)};
+      if (!sealed) {
+        // pieces wait for next sector instead of being lost
+        std::lock_guard lock{mutex_};
+        pending_.insert(pending_.end(),
+                        std::make_move_iterator(pieces->begin()),
+                        std::make_move_iterator(pieces->end()));
+        return sealed.error();
+      }
+    }
+  }
+
+  outcome::result<void> SectorPacker::sealSector(
+      const std::vector<PendingPiece> &pieces) {
+    OUTCOME_TRY(sector, next_sector_());
+
+    std::vector<PackedPiece> packed;
+    std::vector<UnpaddedPieceSize> sizes;
+    uint64_t used{0};
+    auto write{[&](UnpaddedPieceSize size,
+                   const std::string &path,
+                   boost::optional<DealInfo> deal) -> outcome::result<void> {
+      OUTCOME_TRY(info,
+                  manager_->addPiece(sector, sizes, size, PieceData{path}));
+      sizes.push_back(size);
+      used += size.padded();
+      packed.push_back({std::move(info), std::move(deal)});
+      return outcome::success();
+    }};
+    auto ticket{[&]() -> outcome::result<SealRandomness> {
+      // pieces are sorted from largest, so they are written without padding
+      for (const auto &piece : pieces) {
+        OUTCOME_TRY(write(piece.size, piece.path, piece.deal));
+      }
+      for (auto filler : fillerPieces(PaddedPieceSize{used}, sector_size_)) {
+        OUTCOME_TRY(write(filler.unpadded(), kZeroFile, boost::none));
+      }
+      return get_ticket_(sector);
+    }()};
+    if (!ticket) {
+      logger_->error("packing sector {}: {}",
+                     sector.sector,
+                     ticket.error().message());
+      auto removed{manager_->remove(sector)};
+      if (!removed) {
+        logger_->warn("removing sector {}: {}",
+                      sector.sector,
+                      removed.error().message());
+      }
+      return ticket.error();
+    }
+    std::vector<PieceInfo> infos;
+    for (const auto &piece : packed) {
+      infos.push_back(piece.piece);
+    }
+    logger_->info("sector {} packed with {} deal pieces",
+                  sector.sector,
+                  pieces.size());
+    manager_->sealPreCommit1Async(
+        sector,
+        ticket.value(),
+        std::move(infos),
+        [on_packed{on_packed_}, sector, packed](
+            outcome::result<PreCommit1Output> result) {
+          on_packed(sector, packed, std::move(result));
+        });
+    return outcome::success();
+  }
+}  // namespace fc::sector_storage::sealing
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::sector_storage::sealing,
+                            SectorPackerErrors,
+                            e) {
+  using fc::sector_storage::sealing::SectorPackerErrors;
+  switch (e) {
+    case (SectorPackerErrors::kInvalidPieceSize):
+      return "SectorPacker: invalid piece size";
+    case (SectorPackerErrors::kPieceTooBig):
+      return "SectorPacker: piece is bigger than sector";
+    default:
+      return "SectorPacker: unknown error";
+  }
+}
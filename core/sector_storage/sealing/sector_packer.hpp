@@ -0,0 +1,130 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_SECTOR_STORAGE_SEALING_SECTOR_PACKER_HPP
+#define CPP_FILECOIN_CORE_SECTOR_STORAGE_SEALING_SECTOR_PACKER_HPP
+
+#include <mutex>
+
+#include "common/logger.hpp"
+#include "sector_storage/manager.hpp"
+#include "sector_storage/sealing/types.hpp"
+
+namespace fc::sector_storage::sealing {
+  using primitives::piece::PaddedPieceSize;
+  using primitives::piece::UnpaddedPieceSize;
+
+  /// Piece of accepted deal waiting to be packed into sector
+  struct PendingPiece {
+    UnpaddedPieceSize size;
+    /// Piece file, read when sector is written
+    std::string path;
+    DealInfo deal;
+  };
+
+  /// Piece written to sector, filler pieces have no deal
+  struct PackedPiece {
+    PieceInfo piece;
+    boost::optional<DealInfo> deal;
+  };
+
+  /**
+   * Selects pieces for one sector, pieces are taken in given order while
+   * they fit. Padded piece sizes are powers of two, so selected pieces
+   * written from largest to smallest need no alignment padding.
+   * @return indices of selected pieces in write order
+   */
+  std::vector<size_t> packPieces(gsl::span<const PendingPiece> pieces,
+                                 PaddedPieceSize sector_size);
+
+  /**
+   * Zero pieces filling rest of sector after used bytes, from smallest to
+   * largest, so each of them is aligned
+   */
+  std::vector<PaddedPieceSize> fillerPieces(PaddedPieceSize used,
+                                            PaddedPieceSize sector_size);
+
+  struct PackerConfig {
+    /// Partially filled sector is sealed when its deal starts within margin
+    ChainEpoch seal_margin{};
+  };
+
+  /**
+   * Buffers pieces of accepted deals and bin-packs them into sectors.
+   * Sector is written in one pass and PreCommit1 is started when sector is
+   * full or some of its deals start soon.
+   */
+  class SectorPacker {
+   public:
+    using NextSector = std::function<outcome::result<SectorId>()>;
+    using GetTicket =
+        std::function<outcome::result<SealRandomness>(const SectorId &)>;
+    /// Called with pieces of sector and result of PreCommit1
+    using PackedCb = std::function<void(const SectorId &,
+                                        const std::vector<PackedPiece> &,
+                                        outcome::result<PreCommit1Output>)>;
+
+    SectorPacker(std::shared_ptr<Manager> manager,
+                 NextSector next_sector,
+                 GetTicket get_ticket,
+                 PackedCb on_packed,
+                 PackerConfig config);
+
+    /**
+     * Adds piece of accepted deal, seals sectors which are full.
+     * Pieces of sector which failed to be written stay pending and error is
+     * returned, they are retried with next call.
+     */
+    outcome::result<void> addPiece(PendingPiece piece);
+
+    /// Seals sectors with deals starting within seal margin from now
+    outcome::result<void> onEpoch(ChainEpoch now);
+
+    /// Seals all pending pieces
+    outcome::result<void> flush();
+
+    /// Sum of padded sizes of pending pieces
+    PaddedPieceSize pendingSize() const;
+
+   private:
+    /**
+     * Takes pieces of next sector from pending
+     * @param urgent_before - pieces of deals starting before are packed into
+     * partially filled sector, none packs only full sector
+     */
+    boost::optional<std::vector<PendingPiece>> takeSector(
+        boost::optional<ChainEpoch> urgent_before);
+
+    outcome::result<void> sealPending(
+        boost::optional<ChainEpoch> urgent_before);
+
+    /**
+     * Writes pieces and fillers to new sector and starts PreCommit1.
+     * Partially written sector is removed on error.
+     */
+    outcome::result<void> sealSector(const std::vector<PendingPiece> &pieces);
+
+    std::shared_ptr<Manager> manager_;
+    NextSector next_sector_;
+    GetTicket get_ticket_;
+    PackedCb on_packed_;
+    PackerConfig config_;
+    PaddedPieceSize sector_size_;
+
+    mutable std::mutex mutex_;
+    std::vector<PendingPiece> pending_;
+
+    common::Logger logger_;
+  };
+
+  enum class SectorPackerErrors {
+    kInvalidPieceSize = 1,
+    kPieceTooBig,
+  };
+}  // namespace fc::sector_storage::sealing
+
+OUTCOME_HPP_DECLARE_ERROR(fc::sector_storage::sealing, SectorPackerErrors);
+
+#endif  // CPP_FILECOIN_CORE_SECTOR_STORAGE_SEALING_SECTOR_PACKER_HPP
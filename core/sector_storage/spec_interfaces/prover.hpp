@@ -31,6 +31,13 @@ namespace fc::sector_storage {
         gsl::span<const SectorInfo> sector_info,
         PoStRandomness randomness) = 0;
 
+    /**
+     * Prefetches files read by winning PoSt of challenged sectors into page
+     * cache ahead of proving, returns before they are read
+     */
+    virtual outcome::result<void> prewarmWinningPoSt(
+        ActorId miner_id, gsl::span<const SectorInfo> sector_info) = 0;
+
     virtual outcome::result<WindowPoStResponse> generateWindowPoSt(
         ActorId miner_id,
         gsl::span<const SectorInfo> sector_info,
@@ -5,6 +5,7 @@
 
 #include "sector_storage/stores/impl/index_impl.hpp"
 
+#include <algorithm>
 #include <boost/filesystem/path.hpp>
 #include <regex>
 #include "common/uri_parser/uri_parser.hpp"
@@ -17,10 +18,45 @@ namespace fc::sector_storage::stores {
   using primitives::sector_file::sectorName;
   using std::chrono::system_clock;
 
-  std::string toSectorsID(const SectorId &sector_id,
-                          const SectorFileType &file_type) {
-    return sectorName(sector_id) + "_" + toString(file_type);
-  }
+  namespace {
+    TokenAmount allocWeight(const StorageEntry &storage) {
+      return TokenAmount(storage.fs_stat.available) * storage.info.weight;
+    }
+
+    /// Moves store to its place in order after its stat changed
+    void placeByWeight(StoresSnapshot &snapshot, const StorageID &id) {
+      auto &order{snapshot.by_weight};
+      order.erase(std::remove(order.begin(), order.end(), id), order.end());
+      auto weight{allocWeight(snapshot.stores.at(id))};
+      order.insert(std::upper_bound(order.begin(),
+                                    order.end(),
+                                    weight,
+                                    [&](const auto &weight, const auto &other) {
+                                      return weight < allocWeight(
+                                                 snapshot.stores.at(other));
+                                    }),
+                   id);
+    }
+
+    outcome::result<StorageInfo> withSectorUrls(
+        StorageInfo store,
+        const SectorId &sector,
+        const SectorFileType &file_type) {
+      for (auto &url : store.urls) {
+        HttpUri uri;
+        try {
+          uri.parse(url);
+        } catch (const std::runtime_error &err) {
+          return IndexErrors::kInvalidUrl;
+        }
+        boost::filesystem::path path = uri.path();
+        path = path / toString(file_type) / sectorName(sector);
+        uri.setPath(path.string());
+        url = uri.str();
+      }
+      return std::move(store);
+    }
+  }  // namespace
 
   bool isValidUrl(const std::string &url) {
     static std::regex url_regex(
@@ -30,17 +66,28 @@ namespace fc::sector_storage::stores {
     return std::regex_match(url, url_regex);
   }
 
+  std::shared_ptr<const StoresSnapshot> SectorIndexImpl::loadStores() const {
+    return std::atomic_load(&stores_);
+  }
+
+  void SectorIndexImpl::publishStores(
+      std::shared_ptr<const StoresSnapshot> stores) {
+    std::atomic_store(&stores_, std::move(stores));
+  }
+
   outcome::result<void> SectorIndexImpl::storageAttach(
       const StorageInfo &storage_info, const FsStat &stat) {
-    std::unique_lock lock(mutex_);
     for (const auto &new_url : storage_info.urls) {
       if (!isValidUrl(new_url)) {
         return IndexErrors::kInvalidUrl;
       }
     }
 
-    auto stores_iter = stores_.find(storage_info.id);
-    if (stores_iter != stores_.end()) {
+    std::lock_guard lock(stores_mutex_);
+    auto snapshot{std::make_shared<StoresSnapshot>(*loadStores())};
+
+    auto stores_iter = snapshot->stores.find(storage_info.id);
+    if (stores_iter != snapshot->stores.end()) {
       bool is_duplicate;
       for (const auto &new_url : storage_info.urls) {
         is_duplicate = false;
@@ -54,36 +101,47 @@ namespace fc::sector_storage::stores {
           stores_iter->second.info.urls.push_back(new_url);
         }
       }
-      return outcome::success();
+    } else {
+      snapshot->stores[storage_info.id] = StorageEntry{
+          .info = storage_info,
+          .fs_stat = stat,
+          .last_heartbeat = system_clock::now(),
+          .error = {},
+      };
+      placeByWeight(*snapshot, storage_info.id);
     }
 
-    stores_[storage_info.id] = StorageEntry{
-        .info = storage_info,
-        .fs_stat = stat,
-        .last_heartbeat = system_clock::now(),
-        .error = {},
-    };
+    publishStores(std::move(snapshot));
     return outcome::success();
   }
 
   outcome::result<StorageInfo> SectorIndexImpl::getStorageInfo(
       const StorageID &storage_id) const {
-    std::shared_lock lock(mutex_);
-    auto maybe_storage = stores_.find(storage_id);
-    if (maybe_storage == stores_.end()) return IndexErrors::kStorageNotFound;
+    auto snapshot{loadStores()};
+    auto maybe_storage = snapshot->stores.find(storage_id);
+    if (maybe_storage == snapshot->stores.end())
+      return IndexErrors::kStorageNotFound;
     return maybe_storage->second.info;
   }
 
   outcome::result<void> SectorIndexImpl::storageReportHealth(
       const StorageID &storage_id, const HealthReport &report) {
-    std::unique_lock lock(mutex_);
-    auto storage_iter = stores_.find(storage_id);
-    if (storage_iter == stores_.end()) return IndexErrors::kStorageNotFound;
-
+    std::lock_guard lock(stores_mutex_);
+    auto snapshot{std::make_shared<StoresSnapshot>(*loadStores())};
+    auto storage_iter = snapshot->stores.find(storage_id);
+    if (storage_iter == snapshot->stores.end())
+      return IndexErrors::kStorageNotFound;
+
+    auto moved{report.stat.available
+               != storage_iter->second.fs_stat.available};
     storage_iter->second.fs_stat = report.stat;
     storage_iter->second.error = report.error;
     storage_iter->second.last_heartbeat = system_clock::now();
+    if (moved) {
+      placeByWeight(*snapshot, storage_id);
+    }
 
+    publishStores(std::move(snapshot));
     return outcome::success();
   }
 
@@ -91,28 +149,18 @@ namespace fc::sector_storage::stores {
       const StorageID &storage_id,
       const SectorId &sector,
       const SectorFileType &file_type) {
-    std::unique_lock lock(mutex_);
+    std::unique_lock lock(sectors_mutex_);
 
     for (const auto &type : primitives::sector_file::kSectorFileTypes) {
       if ((file_type & type) == 0) {
         continue;
       }
 
-      std::string sector_id = toSectorsID(sector, type);
-
-      auto sector_iter = sectors_.find(sector_id);
-      if (sector_iter == sectors_.end()) {
-        sectors_[sector_id] = {};
-        sector_iter = sectors_.find(sector_id);
-      }
-      for (const auto &s_id : sector_iter->second) {
-        if (storage_id == s_id) {
-          // already there
-          return outcome::success();
-        }
+      auto &storages{sectors_[SectorFile{sector, type}]};
+      if (std::find(storages.begin(), storages.end(), storage_id)
+          == storages.end()) {
+        storages.push_back(storage_id);
       }
-
-      sector_iter->second.push_back(storage_id);
     }
 
     return outcome::success();
@@ -122,32 +170,23 @@ namespace fc::sector_storage::stores {
       const StorageID &storage_id,
       const SectorId &sector,
       const fc::primitives::sector_file::SectorFileType &file_type) {
-    std::unique_lock lock(mutex_);
+    std::unique_lock lock(sectors_mutex_);
 
     for (const auto &type : primitives::sector_file::kSectorFileTypes) {
       if ((file_type & type) == 0) {
         continue;
       }
 
-      std::string sector_id = toSectorsID(sector, type);
-
-      auto sector_iter = sectors_.find(sector_id);
+      auto sector_iter = sectors_.find(SectorFile{sector, type});
       if (sector_iter == sectors_.end()) {
-        return outcome::success();
-      }
-      std::vector<StorageID> sectors;
-      for (const auto &s_id : sector_iter->second) {
-        if (storage_id == s_id) {
-          continue;
-        }
-        sectors.push_back(s_id);
+        continue;
       }
-      if (sectors.size() == 0) {
+      auto &storages{sector_iter->second};
+      storages.erase(std::remove(storages.begin(), storages.end(), storage_id),
+                     storages.end());
+      if (storages.empty()) {
         sectors_.erase(sector_iter);
-        return outcome::success();
       }
-
-      sector_iter->second = sectors;
     }
 
     return outcome::success();
@@ -157,72 +196,48 @@ namespace fc::sector_storage::stores {
       const SectorId &sector,
       const fc::primitives::sector_file::SectorFileType &file_type,
       bool allow_fetch) {
-    std::shared_lock lock(mutex_);
     std::unordered_map<StorageID, uint64_t> storage_ids;
+    {
+      std::shared_lock lock(sectors_mutex_);
+      for (const auto &type : primitives::sector_file::kSectorFileTypes) {
+        if ((file_type & type) == 0) {
+          continue;
+        }
 
-    for (const auto &type : primitives::sector_file::kSectorFileTypes) {
-      if ((file_type & type) == 0) {
-        continue;
-      }
-
-      std::string sector_id = toSectorsID(sector, type);
-      auto sector_iter = sectors_.find(sector_id);
-      if (sector_iter == sectors_.end()) {
-        continue;
-      }
-      for (const auto &id : sector_iter->second) {
-        ++storage_ids[id];
+        auto sector_iter = sectors_.find(SectorFile{sector, type});
+        if (sector_iter == sectors_.end()) {
+          continue;
+        }
+        for (const auto &id : sector_iter->second) {
+          ++storage_ids[id];
+        }
       }
     }
 
+    auto snapshot{loadStores()};
     std::vector<StorageInfo> result;
     for (const auto &[id, count] : storage_ids) {
-      if (stores_.find(id) == stores_.end()) {
+      auto storage_iter = snapshot->stores.find(id);
+      if (storage_iter == snapshot->stores.end()) {
         // logger
         continue;
       }
 
-      auto store = stores_[id].info;
-
-      for (uint64_t i = 0; i < store.urls.size(); i++) {
-        HttpUri uri;
-        try {
-          uri.parse(store.urls[i]);
-        } catch (const std::runtime_error &err) {
-          return IndexErrors::kInvalidUrl;
-        }
-        boost::filesystem::path path = uri.path();
-        path = path / toString(file_type) / sectorName(sector);
-        uri.setPath(path.string());
-        store.urls[i] = uri.str();
-      }
-
+      OUTCOME_TRY(store,
+                  withSectorUrls(storage_iter->second.info, sector, file_type));
       store.weight = store.weight * count;
-      result.push_back(store);
+      result.push_back(std::move(store));
     }
 
     if (allow_fetch) {
-      for (const auto &[id, storage_info] : stores_) {
+      for (const auto &[id, storage] : snapshot->stores) {
         if (storage_ids.find(id) != storage_ids.end()) {
           continue;
         }
-        auto store = stores_[id].info;
-
-        for (uint64_t i = 0; i < store.urls.size(); i++) {
-          HttpUri uri;
-          try {
-            uri.parse(store.urls[i]);
-          } catch (const std::runtime_error &err) {
-            return IndexErrors::kInvalidUrl;
-          }
-          boost::filesystem::path path = uri.path();
-          path = path / toString(file_type) / sectorName(sector);
-          uri.setPath(path.string());
-          store.urls[i] = uri.str();
-        }
 
+        OUTCOME_TRY(store, withSectorUrls(storage.info, sector, file_type));
         store.weight = 0;
-        result.push_back(store);
+        result.push_back(std::move(store));
       }
     }
 
@@ -233,15 +248,16 @@ namespace fc::sector_storage::stores {
       const fc::primitives::sector_file::SectorFileType &allocate,
       fc::primitives::sector::RegisteredProof seal_proof_type,
       bool sealing) {
-    std::shared_lock lock(mutex_);
-
     OUTCOME_TRY(
         req_space,
         fc::primitives::sector_file::sealSpaceUse(allocate, seal_proof_type));
 
-    std::vector<StorageEntry> candidates;
+    auto snapshot{loadStores()};
+    const auto now{system_clock::now()};
+    std::vector<StorageInfo> result;
 
-    for (const auto &[id, storage] : stores_) {
+    for (const auto &id : snapshot->by_weight) {
+      const auto &storage{snapshot->stores.at(id)};
       if (sealing && !storage.info.can_seal) {
         continue;
       }
@@ -253,8 +269,7 @@ namespace fc::sector_storage::stores {
         continue;
       }
 
-      if (system_clock::now() - storage.last_heartbeat
-          > kSkippedHeartbeatThreshold) {
+      if (now - storage.last_heartbeat > kSkippedHeartbeatThreshold) {
         continue;
       }
 
@@ -262,27 +277,13 @@ namespace fc::sector_storage::stores {
         continue;
       }
 
-      candidates.push_back(storage);
+      result.push_back(storage.info);
     }
 
-    if (candidates.empty()) {
+    if (result.empty()) {
       return IndexErrors::kNoSuitableCandidate;
     }
 
-    std::sort(candidates.begin(),
-              candidates.end(),
-              [](const StorageEntry &lhs, const StorageEntry &rhs) {
-                auto lw = TokenAmount(lhs.fs_stat.available) * lhs.info.weight;
-                auto rw = TokenAmount(rhs.fs_stat.available) * rhs.info.weight;
-                return lw < rw;
-              });
-
-    std::vector<StorageInfo> result;
-
-    for (const auto &candidate : candidates) {
-      result.emplace_back(candidate.info);
-    }
-
     return result;
   }
 
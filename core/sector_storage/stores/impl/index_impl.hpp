@@ -8,6 +8,8 @@
 
 #include "sector_storage/stores/index.hpp"
 
+#include <boost/functional/hash.hpp>
+#include <mutex>
 #include <shared_mutex>
 #include <unordered_map>
 #include "sector_storage/stores/impl/index_lock.hpp"
@@ -22,6 +24,33 @@ namespace fc::sector_storage::stores {
     boost::optional<std::string> error;
   };
 
+  /// Stores of index, replaced as a whole on change, so readers never lock
+  struct StoresSnapshot {
+    std::unordered_map<StorageID, StorageEntry> stores;
+    /// Ids of stores ordered by available space multiplied by weight
+    std::vector<StorageID> by_weight;
+  };
+
+  /// Key of sector file in index
+  struct SectorFile {
+    SectorId sector;
+    SectorFileType type;
+
+    bool operator==(const SectorFile &other) const {
+      return sector == other.sector && type == other.type;
+    }
+  };
+
+  struct SectorFileHash {
+    size_t operator()(const SectorFile &key) const {
+      size_t seed{};
+      boost::hash_combine(seed, key.sector.miner);
+      boost::hash_combine(seed, key.sector.sector);
+      boost::hash_combine(seed, static_cast<int>(key.type));
+      return seed;
+    }
+  };
+
   class SectorIndexImpl : public SectorIndex {
    public:
     outcome::result<void> storageAttach(const StorageInfo &storage_info,
@@ -63,9 +92,18 @@ namespace fc::sector_storage::stores {
                                          SectorFileType write) override;
 
    private:
-    mutable std::shared_mutex mutex_;
-    std::unordered_map<StorageID, StorageEntry> stores_;
-    std::unordered_map<std::string, std::vector<StorageID>> sectors_;
+    std::shared_ptr<const StoresSnapshot> loadStores() const;
+    void publishStores(std::shared_ptr<const StoresSnapshot> stores);
+
+    /// Serializes writers of stores
+    std::mutex stores_mutex_;
+    /// Accessed with atomic_load and atomic_store only
+    std::shared_ptr<const StoresSnapshot> stores_ =
+        std::make_shared<StoresSnapshot>();
+
+    mutable std::shared_mutex sectors_mutex_;
+    std::unordered_map<SectorFile, std::vector<StorageID>, SectorFileHash>
+        sectors_;
     std::shared_ptr<IndexLock> index_lock_ = std::make_shared<IndexLock>();
   };
 }  // namespace fc::sector_storage::stores
@@ -8,16 +8,39 @@
 #include <rapidjson/document.h>
 #include <boost/filesystem.hpp>
 #include <fstream>
+#include <gsl/gsl_util>
 #include <regex>
 #include <utility>
 #include "api/rpc/json.hpp"
 #include "primitives/sector_file/sector_file.hpp"
+#include "sector_storage/stores/sector_mover.hpp"
 #include "sector_storage/stores/store_error.hpp"
+#include "sector_storage/stores/unsealed_ranges.hpp"
 
 using fc::primitives::LocalStorageMeta;
 using fc::primitives::sector_file::kSectorFileTypes;
 
 namespace fc::sector_storage::stores {
+  /// Allocations reuse raw fs stat for this time, reservations are exact
+  constexpr std::chrono::seconds kFsStatCacheTtl{10};
+
+  /// Bytes already written to sector file or cache dir
+  uint64_t writtenSize(const std::string &path) {
+    boost::system::error_code ec;
+    if (!boost::filesystem::is_directory(path, ec)) {
+      auto size{boost::filesystem::file_size(path, ec)};
+      return ec ? 0 : size;
+    }
+    uint64_t size{};
+    for (boost::filesystem::recursive_directory_iterator it{path, ec}, end;
+         !ec && it != end;
+         it.increment(ec)) {
+      if (boost::filesystem::is_regular_file(it->status())) {
+        size += boost::filesystem::file_size(it->path(), ec);
+      }
+    }
+    return size;
+  }
 
   outcome::result<SectorId> parseSectorId(const std::string &filename) {
     std::regex regex(R"(s-t0([0-9]+)-([0-9]+))");
@@ -101,6 +124,19 @@ namespace fc::sector_storage::stores {
       }
     }
 
+    if (allocate == SectorFileType::FTNone) {
+      return result;
+    }
+
+    // allocation and its reservation are atomic for concurrent tasks
+    std::unique_lock reserve_lock(reserve_mutex_);
+    std::vector<uint64_t> reserved;
+    auto _ = gsl::finally([&]() {
+      for (const auto &reservation : reserved) {
+        reserved_.erase(reservation);
+      }
+    });
+
     for (const auto &type : primitives::sector_file::kSectorFileTypes) {
       if ((type & allocate) == 0) {
         continue;
@@ -108,6 +144,8 @@ namespace fc::sector_storage::stores {
 
       OUTCOME_TRY(sectors_info,
                   index_->storageBestAlloc(type, seal_proof_type, can_seal));
+      OUTCOME_TRY(space,
+                  primitives::sector_file::sealSpaceUse(type, seal_proof_type));
 
       std::string best_path;
       StorageID best_storage;
@@ -122,6 +160,12 @@ namespace fc::sector_storage::stores {
           continue;
         }
 
+        // index may not know reservations of other tasks yet
+        auto maybe_stat = reservedStat(info.id, path_iter->second, false);
+        if (!maybe_stat || maybe_stat.value().available < space) {
+          continue;
+        }
+
         boost::filesystem::path spath(path_iter->second);
         spath /= toString(type);
         spath /= primitives::sector_file::sectorName(sector);
@@ -135,11 +179,29 @@ namespace fc::sector_storage::stores {
         return StoreErrors::kNotFoundPath;
       }
 
+      reserved_.emplace(next_reservation_,
+                        ReservedSpace{best_storage,
+                                      paths_.at(best_storage),
+                                      best_path,
+                                      space});
+      reserved.push_back(next_reservation_++);
+
       result.paths.setPathByType(type, best_path);
       result.storages.setPathByType(type, best_storage);
       allocate = static_cast<SectorFileType>(allocate ^ type);
     }
 
+    std::map<StorageID, std::string> storages;
+    for (const auto &reservation : reserved) {
+      const auto &space{reserved_.at(reservation)};
+      storages.emplace(space.storage, space.root);
+    }
+    result.reservation = std::make_shared<SpaceReservation>(
+        [this, reserved{std::move(reserved)}] { release(reserved); });
+    reserved.clear();
+    reserve_lock.unlock();
+    reportReserved(storages);
+
     return result;
   }
 
@@ -179,6 +241,9 @@ namespace fc::sector_storage::stores {
         logger_->error(ec.message());
         return StoreErrors::kCannotRemoveSector;
       }
+      if (type == SectorFileType::FTUnsealed) {
+        removeUnsealedRanges(sector_path.string());
+      }
     }
 
     return outcome::success();
@@ -219,10 +284,20 @@ namespace fc::sector_storage::stores {
       OUTCOME_TRY(source_path, src.paths.getPathByType(type));
       OUTCOME_TRY(dest_path, dest.paths.getPathByType(type));
 
-      boost::system::error_code ec;
-      boost::filesystem::rename(source_path, dest_path, ec);
-      if (ec.failed()) {
-        return StoreErrors::kCannotMoveSector;
+      MoveOptions options;
+      options.progress = [&, logged{uint64_t{0}}](uint64_t copied,
+                                                  uint64_t total) mutable {
+        // logs each tenth part of copy
+        if (total != 0 && copied * 10 / total > logged) {
+          logged = copied * 10 / total;
+          logger_->info("Move {}: {}%", source_path, logged * 10);
+        }
+      };
+      OUTCOME_TRY(moveSectorFiles(source_path, dest_path, options));
+      if (type == SectorFileType::FTUnsealed) {
+        removeUnsealedRanges(dest_path);
+        std::ignore = moveSectorFiles(unsealedRangesPath(source_path),
+                                      unsealedRangesPath(dest_path));
       }
 
       OUTCOME_TRY(index_->storageDeclareSector(dest_storage_id, sector, type));
@@ -240,7 +315,67 @@ namespace fc::sector_storage::stores {
       return StoreErrors::kNotFoundStorage;
     }
 
-    return storage_->getStat(path_iter->second);
+    std::lock_guard reserve_lock(reserve_mutex_);
+    return reservedStat(id, path_iter->second, true);
+  }
+
+  outcome::result<FsStat> LocalStoreImpl::reservedStat(
+      const StorageID &id, const std::string &path, bool refresh) {
+    const auto now{std::chrono::steady_clock::now()};
+    auto cached{stats_.find(id)};
+    if (refresh || cached == stats_.end()
+        || now - cached->second.time > kFsStatCacheTtl) {
+      OUTCOME_TRY(stat, storage_->getStat(path));
+      cached = stats_.insert_or_assign(id, CachedStat{stat, now}).first;
+    }
+    auto stat{cached->second.stat};
+    for (const auto &[_, reservation] : reserved_) {
+      if (reservation.storage != id) {
+        continue;
+      }
+      // written part of file is already used space of raw stat
+      auto written{writtenSize(reservation.path)};
+      if (reservation.size > written) {
+        stat.available -= std::min(stat.available, reservation.size - written);
+      }
+    }
+    return stat;
+  }
+
+  void LocalStoreImpl::release(const std::vector<uint64_t> &reservations) {
+    std::map<StorageID, std::string> storages;
+    {
+      std::lock_guard reserve_lock(reserve_mutex_);
+      for (const auto &reservation : reservations) {
+        auto it{reserved_.find(reservation)};
+        if (it != reserved_.end()) {
+          storages.emplace(it->second.storage, it->second.root);
+          reserved_.erase(it);
+        }
+      }
+    }
+    reportReserved(storages);
+  }
+
+  void LocalStoreImpl::reportReserved(
+      const std::map<StorageID, std::string> &storages) {
+    for (const auto &[id, root] : storages) {
+      outcome::result<FsStat> stat{StoreErrors::kNotFoundStorage};
+      {
+        std::lock_guard reserve_lock(reserve_mutex_);
+        stat = reservedStat(id, root, false);
+      }
+      if (!stat) {
+        logger_->warn("reserved stat of {}: {}", id, stat.error().message());
+        continue;
+      }
+      auto reported{
+          index_->storageReportHealth(id, HealthReport{stat.value(), {}})};
+      if (!reported) {
+        logger_->warn(
+            "report reserved stat of {}: {}", id, reported.error().message());
+      }
+    }
   }
 
   outcome::result<void> LocalStoreImpl::openPath(const std::string &path) {
@@ -270,6 +405,11 @@ namespace fc::sector_storage::stores {
     }
 
     OUTCOME_TRY(stat, storage_->getStat(path));
+    {
+      std::lock_guard reserve_lock(reserve_mutex_);
+      stats_.insert_or_assign(
+          meta.id, CachedStat{stat, std::chrono::steady_clock::now()});
+    }
 
     OUTCOME_TRY(index_->storageAttach(
         StorageInfo{
@@ -292,6 +432,10 @@ namespace fc::sector_storage::stores {
 
       boost::filesystem::directory_iterator dir_iter(dir_path), end;
       while (dir_iter != end) {
+        if (dir_iter->path().extension() == kUnsealedRangesExtension) {
+          ++dir_iter;
+          continue;
+        }
         OUTCOME_TRY(sector,
                     parseSectorId(dir_iter->path().filename().string()));
 
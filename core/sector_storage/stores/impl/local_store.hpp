@@ -8,6 +8,9 @@
 
 #include "sector_storage/stores/store.hpp"
 
+#include <chrono>
+#include <map>
+#include <mutex>
 #include <shared_mutex>
 #include "common/logger.hpp"
 #include "sector_storage/stores/index.hpp"
@@ -15,6 +18,13 @@
 namespace fc::sector_storage::stores {
 
   // TODO(artyom-yurin): [FIL-231] Health Report for storages
+  /**
+   * Allocations reserve space of their files, so parallel tasks don't pick
+   * storage which is going to be filled by files not written yet.
+   * Reserved space not yet written is subtracted from available space of
+   * fs stat, which is reported to index when reservations change.
+   * Reservations must not outlive store.
+   */
   class LocalStoreImpl : public LocalStore {
    public:
     static outcome::result<std::unique_ptr<LocalStore>> newLocalStore(
@@ -47,10 +57,39 @@ namespace fc::sector_storage::stores {
     std::shared_ptr<LocalStorage> getLocalStorage() const override;
 
    private:
+    /// Space reserved for sector file
+    struct ReservedSpace {
+      StorageID storage;
+      /// Root path of storage
+      std::string root;
+      /// Path of sector file
+      std::string path;
+      uint64_t size;
+    };
+
+    /// Raw fs stat of storage, reused by allocations until stale
+    struct CachedStat {
+      FsStat stat;
+      std::chrono::steady_clock::time_point time;
+    };
+
     LocalStoreImpl(std::shared_ptr<LocalStorage> storage,
                    std::shared_ptr<SectorIndex> index,
                    gsl::span<const std::string> urls);
 
+    /**
+     * Fs stat with reserved space subtracted, requires reserve mutex
+     * @param refresh - read raw stat even if cached one is fresh
+     */
+    outcome::result<FsStat> reservedStat(const StorageID &id,
+                                         const std::string &path,
+                                         bool refresh);
+
+    void release(const std::vector<uint64_t> &reservations);
+
+    /// Reports reserved stat of storages to index, storage id to root path
+    void reportReserved(const std::map<StorageID, std::string> &storages);
+
     std::shared_ptr<LocalStorage> storage_;
     std::shared_ptr<SectorIndex> index_;
     std::vector<std::string> urls_;
@@ -58,6 +97,12 @@ namespace fc::sector_storage::stores {
     fc::common::Logger logger_;
 
     mutable std::shared_mutex mutex_;
+
+    /// Guards reservations and cached stats, serializes allocations
+    std::mutex reserve_mutex_;
+    std::map<uint64_t, ReservedSpace> reserved_;
+    uint64_t next_reservation_{};
+    std::unordered_map<StorageID, CachedStat> stats_;
   };
 
 }  // namespace fc::sector_storage::stores
@@ -7,9 +7,13 @@
 
 #include <curl/curl.h>
 #include <rapidjson/document.h>
+#include <atomic>
 #include <boost/filesystem.hpp>
+#include <fstream>
+#include <thread>
 #include <utility>
 #include "api/rpc/json.hpp"
+#include "common/ffi.hpp"
 #include "common/tarutil.hpp"
 #include "common/uri_parser/uri_parser.hpp"
 #include "sector_storage/stores/store_error.hpp"
@@ -26,13 +30,291 @@ namespace {
     return totalBytes;
   }
 
-  std::size_t callbackFile(const char *ptr,
-                           std::size_t size,
-                           std::size_t nmemb,
-                           std::ofstream *stream) {
-    const std::size_t totalBytes(size * nmemb);
-    stream->write(ptr, size);
-    return totalBytes;
+  using fc::outcome::result;
+  using fc::sector_storage::stores::HeaderName;
+  using fc::sector_storage::stores::HeaderValue;
+  using fc::sector_storage::stores::StoreErrors;
+
+  /// Files of this size and bigger are fetched by ranges in parallel
+  constexpr uint64_t kFetchChunkSize{uint64_t{64} << 20};
+  constexpr size_t kFetchThreads{4};
+  /// Attempts to fetch range, each attempt continues after fetched bytes
+  constexpr int kFetchRetries{3};
+  constexpr long kFetchPollMs{1000};
+
+  using Headers = std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)>;
+
+  Headers makeHeaders(
+      const std::unordered_map<HeaderName, HeaderValue> &auth_headers) {
+    curl_slist *headers = nullptr;
+    for (const auto &header : auth_headers) {
+      headers = curl_slist_append(
+          headers, (header.first + ": " + header.second).c_str());
+    }
+    return {headers, curl_slist_free_all};
+  }
+
+  void setCommonOptions(CURL *curl,
+                        const std::string &url,
+                        const Headers &headers) {
+    curl_easy_setopt(curl, CURLOPT_IPRESOLVE, CURL_IPRESOLVE_V4);
+
+    // Follow HTTP redirects if necessary
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+
+    if (headers) {
+      curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers.get());
+    }
+  }
+
+  /**
+   * Response of GET request, which is read by caller chunk by chunk instead
+   * of being written by curl callback, so it can be passed to stream
+   * consumer like tar extraction.
+   */
+  class HttpStream {
+   public:
+    HttpStream(const std::string &url, const Headers &headers)
+        : easy_{curl_easy_init()}, multi_{curl_multi_init()} {
+      if (easy_ && multi_) {
+        setCommonOptions(easy_, url, headers);
+        curl_easy_setopt(easy_, CURLOPT_WRITEFUNCTION, onData);
+        curl_easy_setopt(easy_, CURLOPT_WRITEDATA, this);
+        curl_multi_add_handle(multi_, easy_);
+      }
+    }
+
+    HttpStream(const HttpStream &) = delete;
+    HttpStream &operator=(const HttpStream &) = delete;
+
+    ~HttpStream() {
+      if (multi_) {
+        if (easy_) {
+          curl_multi_remove_handle(multi_, easy_);
+        }
+        curl_multi_cleanup(multi_);
+      }
+      if (easy_) {
+        curl_easy_cleanup(easy_);
+      }
+    }
+
+    /// Waits for response headers
+    result<void> open() {
+      if (!easy_ || !multi_) {
+        return StoreErrors::kUnableCreateRequest;
+      }
+      while (buffer_.empty() && !done_) {
+        OUTCOME_TRY(pump());
+      }
+      return fc::outcome::success();
+    }
+
+    long status() const {
+      long status_code{};
+      curl_easy_getinfo(easy_, CURLINFO_RESPONSE_CODE, &status_code);
+      return status_code;
+    }
+
+    std::string contentType() const {
+      char *content_type{};
+      curl_easy_getinfo(easy_, CURLINFO_CONTENT_TYPE, &content_type);
+      return content_type ? content_type : "";
+    }
+
+    /// Size of body, negative if it is unknown
+    curl_off_t contentLength() const {
+      curl_off_t size{-1};
+      curl_easy_getinfo(easy_, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &size);
+      return size;
+    }
+
+    /// Next chunk of body, empty chunk at end of body
+    result<gsl::span<const uint8_t>> read() {
+      chunk_.clear();
+      while (buffer_.empty() && !done_) {
+        OUTCOME_TRY(pump());
+      }
+      std::swap(chunk_, buffer_);
+      if (chunk_.empty() && result_ != CURLE_OK) {
+        return StoreErrors::kIncompleteFetch;
+      }
+      return gsl::make_span(chunk_);
+    }
+
+   private:
+    static size_t onData(const char *ptr,
+                         size_t size,
+                         size_t nmemb,
+                         HttpStream *stream) {
+      stream->buffer_.insert(stream->buffer_.end(), ptr, ptr + size * nmemb);
+      return size * nmemb;
+    }
+
+    result<void> pump() {
+      int running{};
+      if (curl_multi_perform(multi_, &running) != CURLM_OK) {
+        return StoreErrors::kIncompleteFetch;
+      }
+      int left{};
+      while (auto message{curl_multi_info_read(multi_, &left)}) {
+        if (message->msg == CURLMSG_DONE) {
+          done_ = true;
+          result_ = message->data.result;
+        }
+      }
+      if (!done_ && buffer_.empty()) {
+        curl_multi_wait(multi_, nullptr, 0, kFetchPollMs, nullptr);
+      }
+      return fc::outcome::success();
+    }
+
+    CURL *easy_;
+    CURLM *multi_;
+    std::vector<uint8_t> buffer_;
+    std::vector<uint8_t> chunk_;
+    bool done_{false};
+    CURLcode result_{CURLE_OK};
+  };
+
+  /// Writes range response at its offset in file
+  struct RangeWriter {
+    static size_t onData(const char *ptr,
+                         size_t size,
+                         size_t nmemb,
+                         RangeWriter *writer) {
+      const size_t bytes{size * nmemb};
+      long status_code{};
+      curl_easy_getinfo(writer->curl, CURLINFO_RESPONSE_CODE, &status_code);
+      // server which ignores range sends body from start
+      if (status_code != 206 || writer->offset + bytes > writer->end) {
+        return 0;
+      }
+      writer->file.write(ptr, static_cast<std::streamsize>(bytes));
+      if (!writer->file.good()) {
+        return 0;
+      }
+      writer->offset += bytes;
+      return bytes;
+    }
+
+    CURL *curl;
+    std::fstream &file;
+    uint64_t offset;
+    uint64_t end;
+  };
+
+  /// Fetches bytes [begin, end) of url into same bytes of file
+  result<void> fetchRange(const std::string &url,
+                          const Headers &headers,
+                          const std::string &path,
+                          uint64_t begin,
+                          uint64_t end) {
+    std::fstream file(path,
+                      std::ios_base::in | std::ios_base::out
+                          | std::ios_base::binary);
+    if (!file.good()) {
+      return StoreErrors::kCannotOpenTempFile;
+    }
+    auto offset{begin};
+    for (auto attempt{0}; offset < end && attempt < kFetchRetries; ++attempt) {
+      auto curl{fc::common::ffi::wrap(curl_easy_init(), curl_easy_cleanup)};
+      if (!curl) {
+        return StoreErrors::kUnableCreateRequest;
+      }
+      setCommonOptions(curl.get(), url, headers);
+      auto range{std::to_string(offset) + "-" + std::to_string(end - 1)};
+      curl_easy_setopt(curl.get(), CURLOPT_RANGE, range.c_str());
+      file.seekp(static_cast<std::streamoff>(offset));
+      RangeWriter writer{curl.get(), file, offset, end};
+      curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, RangeWriter::onData);
+      curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &writer);
+      curl_easy_perform(curl.get());
+      offset = writer.offset;
+      long status_code{};
+      curl_easy_getinfo(curl.get(), CURLINFO_RESPONSE_CODE, &status_code);
+      if (status_code != 0 && status_code != 206) {
+        return StoreErrors::kNotOkStatusCode;
+      }
+    }
+    file.flush();
+    if (offset != end || !file.good()) {
+      return StoreErrors::kIncompleteFetch;
+    }
+    return fc::outcome::success();
+  }
+
+  /// Fetches file of known size by ranges in parallel
+  result<void> fetchRanges(const std::string &url,
+                           const Headers &headers,
+                           const std::string &path,
+                           uint64_t size) {
+    {
+      std::ofstream file(path, std::ios_base::out | std::ios_base::binary);
+      if (!file.good()) {
+        return StoreErrors::kCannotOpenTempFile;
+      }
+    }
+    boost::system::error_code ec;
+    fs::resize_file(path, size, ec);
+    if (ec.failed()) {
+      return StoreErrors::kCannotOpenTempFile;
+    }
+
+    const auto chunks{(size + kFetchChunkSize - 1) / kFetchChunkSize};
+    std::atomic<uint64_t> next{0};
+    std::mutex error_mutex;
+    boost::optional<std::error_code> error;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < std::min<uint64_t>(kFetchThreads, chunks); ++i) {
+      threads.emplace_back([&] {
+        for (auto chunk{next++}; chunk < chunks; chunk = next++) {
+          auto begin{chunk * kFetchChunkSize};
+          auto end{std::min(size, begin + kFetchChunkSize)};
+          auto fetched{fetchRange(url, headers, path, begin, end)};
+          if (fetched.has_error()) {
+            std::lock_guard lock{error_mutex};
+            if (!error) {
+              error = fetched.error();
+            }
+            next = chunks;
+            return;
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    if (error) {
+      return *error;
+    }
+    return fc::outcome::success();
+  }
+
+  /// Writes rest of stream into file and checks its size
+  result<void> fetchStream(HttpStream &stream, const std::string &path) {
+    std::ofstream file(path, std::ios_base::out | std::ios_base::binary);
+    if (!file.good()) {
+      return StoreErrors::kCannotOpenTempFile;
+    }
+    uint64_t written{};
+    while (true) {
+      OUTCOME_TRY(chunk, stream.read());
+      if (chunk.empty()) {
+        break;
+      }
+      file.write(reinterpret_cast<const char *>(chunk.data()), chunk.size());
+      written += chunk.size();
+    }
+    file.close();
+    auto size{stream.contentLength()};
+    if (!file.good() || (size >= 0 && written != static_cast<uint64_t>(size))) {
+      return StoreErrors::kIncompleteFetch;
+    }
+    return fc::outcome::success();
   }
 }  // namespace
 
@@ -56,25 +338,21 @@ namespace fc::sector_storage::stores {
       return StoreErrors::kFindAndAllocate;
     }
 
-    while (true) {
-      {
-        const std::lock_guard<std::mutex> lock(mutex_);
-        if (processing_.insert(sector).second) {
-          unlock_ = false;
-          break;
-        }
-      }
-
-      std::unique_lock<std::mutex> lock(waiting_room_);
-
-      cv_.wait(lock, [&] { return unlock_; });
-    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto &queue{processing_[sector]};
+    ++queue.refs;
+    const auto ticket{queue.next_ticket++};
+    queue.cv.wait(lock, [&] { return queue.serving == ticket; });
+    lock.unlock();
 
     auto _ = gsl::finally([&]() {
       const std::lock_guard<std::mutex> lock(mutex_);
-      processing_.erase(sector);
-      unlock_ = true;
-      cv_.notify_all();
+      ++queue.serving;
+      if (--queue.refs == 0) {
+        processing_.erase(sector);
+      } else {
+        queue.cv.notify_all();
+      }
     });
 
     auto maybe_response = local_->acquireSector(
@@ -278,56 +556,11 @@ namespace fc::sector_storage::stores {
                                                const std::string &output_path) {
     logger_->info("fetch: {} -> {}", url, output_path);
 
-    CURL *curl = curl_easy_init();
-
-    if (!curl) {
-      return StoreErrors::kUnableCreateRequest;
-    }
-    curl_easy_setopt(curl, CURLOPT_IPRESOLVE, CURL_IPRESOLVE_V4);
-
-    // Follow HTTP redirects if necessary
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-
-    fs::path temp_file_path =
-        fs::temp_directory_path() / (fs::unique_path().string() + ".tar");
-
-    std::ofstream temp_file(temp_file_path.string(),
-                            std::ios_base::out | std::ios_base::binary);
-
-    if (!temp_file.good()) {
-      curl_easy_cleanup(curl);
-      return StoreErrors::kCannotOpenTempFile;
-    }
-
-    struct curl_slist *headers = nullptr;
-
-    for (const auto &header : auth_headers_) {
-      headers = curl_slist_append(
-          headers, (header.first + ": " + header.second).c_str());
-    }
-
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, callbackFile);
-
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &temp_file);
-
-    if (headers) {
-      curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    }
-
-    long status_code;
-    std::string content_type;
-    curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
-    curl_easy_getinfo(curl, CURLINFO_CONTENT_TYPE, &content_type);
-    curl_easy_cleanup(curl);
-    if (headers) {
-      curl_slist_free_all(headers);
-    }
-
-    temp_file.close();
+    auto headers{makeHeaders(auth_headers_)};
+    auto stream{std::make_unique<HttpStream>(url, headers)};
+    OUTCOME_TRY(stream->open());
 
+    auto status_code{stream->status()};
     if (status_code != 200) {
       logger_->error("non-200 code - {}", status_code);
       return StoreErrors::kNotOkStatusCode;
@@ -342,18 +575,29 @@ namespace fc::sector_storage::stores {
     }
     ec.clear();
 
+    auto content_type{stream->contentType()};
+
     if (content_type == "application/x-tar") {
-      auto result =
-          fc::common::extractTar(temp_file_path.string(), output_path);
-      fs::remove_all(temp_file_path, ec);
-      if (ec.failed()) {
-        logger_->warn("fetch: failed to remove archive - {}", ec.message());
-      }
-      return result;
+      return fc::common::extractTar([&] { return stream->read(); },
+                                    output_path);
     }
 
     if (content_type == "application/octet-stream") {
-      fs::rename(temp_file_path, output_path, ec);
+      // fetched next to output, so move does not copy between volumes
+      auto temp_path{output_path + ".fetch"};
+      auto size{stream->contentLength()};
+      outcome::result<void> fetched{outcome::success()};
+      if (size >= 0 && static_cast<uint64_t>(size) >= 2 * kFetchChunkSize) {
+        stream.reset();
+        fetched = fetchRanges(url, headers, temp_path, size);
+      } else {
+        fetched = fetchStream(*stream, temp_path);
+      }
+      if (fetched.has_error()) {
+        fs::remove(temp_path, ec);
+        return fetched;
+      }
+      fs::rename(temp_path, output_path, ec);
       if (ec.failed()) {
         logger_->error("Cannot move file: {}", ec.message());
         return StoreErrors::kCannotMoveFile;
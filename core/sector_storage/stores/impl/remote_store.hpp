@@ -63,10 +63,16 @@ namespace fc::sector_storage::stores {
 
     std::unordered_map<HeaderName, HeaderValue> auth_headers_;
 
-    bool unlock_;
-    std::condition_variable cv_;
-    std::set<SectorId> processing_;
-    std::mutex waiting_room_;
+    /// Acquisitions of one sector, served in order of arrival
+    struct SectorQueue {
+      std::condition_variable cv;
+      uint64_t next_ticket{};
+      uint64_t serving{};
+      /// Count of acquisitions holding or waiting
+      size_t refs{};
+    };
+
+    std::map<SectorId, SectorQueue> processing_;
     std::mutex mutex_;
 
     common::Logger logger_;
@@ -0,0 +1,308 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/stores/sector_mover.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <boost/filesystem.hpp>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "common/logger.hpp"
+#include "sector_storage/stores/store_error.hpp"
+
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+#if defined(__linux__) && defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 27)
+#define FC_COPY_FILE_RANGE
+#endif
+#endif
+
+namespace fs = boost::filesystem;
+
+namespace fc::sector_storage::stores {
+  static common::Logger logger = common::createLogger("sector mover");
+
+  namespace {
+    /// Closes descriptor when destroyed
+    struct Fd {
+      explicit Fd(int fd) : fd{fd} {}
+      Fd(const Fd &) = delete;
+      Fd(Fd &&other) noexcept : fd{other.fd} {
+        other.fd = -1;
+      }
+      Fd &operator=(const Fd &) = delete;
+      Fd &operator=(Fd &&other) noexcept {
+        std::swap(fd, other.fd);
+        return *this;
+      }
+      ~Fd() {
+        if (fd != -1) {
+          ::close(fd);
+        }
+      }
+
+      int fd;
+    };
+
+    struct CopiedFile {
+      fs::path from;
+      fs::path to;
+      uint64_t size{};
+      Fd from_fd{-1};
+      Fd to_fd{-1};
+    };
+
+    struct Chunk {
+      size_t file{};
+      uint64_t offset{};
+      uint64_t size{};
+    };
+
+    /// Copies range through buffer with positioned reads and writes
+    bool copyBuffered(int from, int to, uint64_t offset, uint64_t size) {
+      std::vector<char> buffer(std::min<uint64_t>(size, 1 << 20));
+      while (size != 0) {
+        auto read{::pread(from,
+                          buffer.data(),
+                          std::min<uint64_t>(size, buffer.size()),
+                          offset)};
+        if (read < 0 && errno == EINTR) {
+          continue;
+        }
+        if (read <= 0) {
+          return false;
+        }
+        for (ssize_t written{0}; written < read;) {
+          auto n{::pwrite(
+              to, buffer.data() + written, read - written, offset + written)};
+          if (n < 0 && errno == EINTR) {
+            continue;
+          }
+          if (n <= 0) {
+            return false;
+          }
+          written += n;
+        }
+        offset += read;
+        size -= read;
+      }
+      return true;
+    }
+
+    /// Copies range in kernel, through buffer if filesystems don't support it
+    bool copyRange(int from, int to, uint64_t offset, uint64_t size) {
+#ifdef FC_COPY_FILE_RANGE
+      loff_t in = offset, out = offset;
+      while (size != 0) {
+        auto copied{::copy_file_range(from, &in, to, &out, size, 0)};
+        if (copied > 0) {
+          size -= copied;
+          continue;
+        }
+        if (copied < 0 && errno == EINTR) {
+          continue;
+        }
+        if (copied < 0
+            && (errno == EXDEV || errno == ENOSYS || errno == EOPNOTSUPP
+                || errno == EINVAL)) {
+          return copyBuffered(from, to, in, size);
+        }
+        return false;
+      }
+      return true;
+#else
+      return copyBuffered(from, to, offset, size);
+#endif
+    }
+
+    /// Shares extents of files, works only within one filesystem
+    bool reflink(int from, int to) {
+#ifdef FICLONE
+      return ::ioctl(to, FICLONE, from) == 0;
+#else
+      return false;
+#endif
+    }
+
+    /// Lists regular files to copy and creates directories at destination
+    outcome::result<std::vector<CopiedFile>> listFiles(const fs::path &from,
+                                                       const fs::path &to) {
+      boost::system::error_code ec;
+      std::vector<CopiedFile> files;
+      if (!fs::is_directory(from, ec)) {
+        files.push_back({from, to, fs::file_size(from, ec)});
+        if (ec.failed()) {
+          logger->error("move {}: {}", from.string(), ec.message());
+          return StoreErrors::kCannotMoveSector;
+        }
+        return std::move(files);
+      }
+      fs::create_directories(to, ec);
+      for (fs::recursive_directory_iterator it{from, ec}, end;
+           !ec.failed() && it != end;
+           it.increment(ec)) {
+        auto target{to / it->path().lexically_relative(from)};
+        if (fs::is_directory(it->status())) {
+          fs::create_directories(target, ec);
+        } else if (fs::is_regular_file(it->status())) {
+          files.push_back({it->path(), target, fs::file_size(it->path(), ec)});
+        } else {
+          logger->error("move {}: unsupported file type",
+                        it->path().string());
+          return StoreErrors::kCannotMoveSector;
+        }
+      }
+      if (ec.failed()) {
+        logger->error("move {}: {}", from.string(), ec.message());
+        return StoreErrors::kCannotMoveSector;
+      }
+      return std::move(files);
+    }
+
+    /// Copies files of source to temp path next to destination
+    outcome::result<void> copyFiles(const fs::path &from,
+                                    const fs::path &to,
+                                    const MoveOptions &options) {
+      OUTCOME_TRY(files, listFiles(from, to));
+      uint64_t total{};
+      uint64_t copied{};
+      std::vector<Chunk> chunks;
+      for (size_t i{0}; i < files.size(); ++i) {
+        auto &file{files[i]};
+        total += file.size;
+        file.from_fd = Fd{::open(file.from.c_str(), O_RDONLY)};
+        file.to_fd =
+            Fd{::open(file.to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+        if (file.from_fd.fd == -1 || file.to_fd.fd == -1) {
+          logger->error("move {}: {}", file.from.string(), strerror(errno));
+          return StoreErrors::kCannotMoveSector;
+        }
+        if (options.reflink && reflink(file.from_fd.fd, file.to_fd.fd)) {
+          copied += file.size;
+          continue;
+        }
+        if (::ftruncate(file.to_fd.fd, file.size) != 0) {
+          logger->error("move {}: {}", file.to.string(), strerror(errno));
+          return StoreErrors::kCannotMoveSector;
+        }
+        for (uint64_t offset{0}; offset < file.size;
+             offset += options.chunk_size) {
+          chunks.push_back(
+              {i, offset, std::min(options.chunk_size, file.size - offset)});
+        }
+      }
+      if (options.progress) {
+        options.progress(copied, total);
+      }
+
+      std::atomic_size_t next{0};
+      std::atomic_bool failed{false};
+      std::mutex progress_mutex;
+      auto copy{[&] {
+        while (!failed) {
+          const auto i{next++};
+          if (i >= chunks.size()) {
+            return;
+          }
+          const auto &chunk{chunks[i]};
+          const auto &file{files[chunk.file]};
+          if (!copyRange(
+                  file.from_fd.fd, file.to_fd.fd, chunk.offset, chunk.size)) {
+            logger->error("move {}: {}", file.from.string(), strerror(errno));
+            failed = true;
+            return;
+          }
+          // source is not read again
+          ::posix_fadvise(file.from_fd.fd,
+                          static_cast<off_t>(chunk.offset),
+                          static_cast<off_t>(chunk.size),
+                          POSIX_FADV_DONTNEED);
+          std::lock_guard lock{progress_mutex};
+          copied += chunk.size;
+          if (options.progress) {
+            options.progress(copied, total);
+          }
+        }
+      }};
+      std::vector<std::thread> threads;
+      const auto thread_count{
+          std::min(std::max<size_t>(1, options.threads), chunks.size())};
+      for (size_t i{1}; i < thread_count; ++i) {
+        threads.emplace_back(copy);
+      }
+      copy();
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      if (failed) {
+        return StoreErrors::kCannotMoveSector;
+      }
+
+      for (const auto &file : files) {
+        // source is removed after move, so copy must be durable
+        if (::fdatasync(file.to_fd.fd) != 0) {
+          logger->error("move {}: {}", file.to.string(), strerror(errno));
+          return StoreErrors::kCannotMoveSector;
+        }
+        ::posix_fadvise(file.to_fd.fd, 0, 0, POSIX_FADV_DONTNEED);
+        boost::system::error_code ec;
+        if (fs::file_size(file.to, ec) != file.size || ec.failed()) {
+          logger->error("move {}: copied size differs", file.from.string());
+          return StoreErrors::kMovedSectorMismatch;
+        }
+      }
+      return outcome::success();
+    }
+  }  // namespace
+
+  outcome::result<void> moveSectorFiles(const std::string &from,
+                                        const std::string &to,
+                                        const MoveOptions &options) {
+    boost::system::error_code ec;
+    if (!fs::exists(from, ec)) {
+      return StoreErrors::kNotFoundSector;
+    }
+    if (options.rename) {
+      fs::remove_all(to, ec);
+      fs::rename(from, to, ec);
+      if (!ec.failed()) {
+        return outcome::success();
+      }
+      if (ec != boost::system::errc::cross_device_link) {
+        logger->error("move {} to {}: {}", from, to, ec.message());
+        return StoreErrors::kCannotMoveSector;
+      }
+    }
+
+    const auto temp{to + ".move"};
+    fs::remove_all(temp, ec);
+    auto copied{copyFiles(from, temp, options)};
+    if (copied.has_error()) {
+      fs::remove_all(temp, ec);
+      return copied.error();
+    }
+    fs::remove_all(to, ec);
+    fs::rename(temp, to, ec);
+    if (ec.failed()) {
+      logger->error("move {} to {}: {}", temp, to, ec.message());
+      fs::remove_all(temp, ec);
+      return StoreErrors::kCannotMoveSector;
+    }
+    fs::remove_all(from, ec);
+    if (ec.failed()) {
+      logger->warn("move {}: cannot remove source: {}", from, ec.message());
+    }
+    return outcome::success();
+  }
+}  // namespace fc::sector_storage::stores
@@ -56,6 +56,14 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::sector_storage::stores, StoreErrors, e) {
       return "Store: cannot move file";
     case (StoreErrors::kNotFoundRequestedSectorType):
       return "Store: Not found the requested type";
+    case (StoreErrors::kIncompleteFetch):
+      return "Store: fetched size differs from expected";
+    case (StoreErrors::kCannotReadUnsealedRanges):
+      return "Store: cannot read unsealed ranges";
+    case (StoreErrors::kCannotWriteUnsealedRanges):
+      return "Store: cannot write unsealed ranges";
+    case (StoreErrors::kMovedSectorMismatch):
+      return "Store: moved sector files differ from source";
     default:
       return "Store: unknown error";
   }
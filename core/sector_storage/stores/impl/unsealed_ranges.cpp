@@ -0,0 +1,79 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/stores/unsealed_ranges.hpp"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include "codec/cbor/cbor.hpp"
+#include "common/span.hpp"
+#include "sector_storage/stores/store_error.hpp"
+
+namespace fs = boost::filesystem;
+
+namespace fc::sector_storage::stores {
+  std::string unsealedRangesPath(const std::string &unsealed_path) {
+    return unsealed_path + kUnsealedRangesExtension;
+  }
+
+  outcome::result<RleBitset> readUnsealedRanges(
+      const std::string &unsealed_path) {
+    std::ifstream file{unsealedRangesPath(unsealed_path),
+                       std::ios::binary | std::ios::ate};
+    if (!file.good()) {
+      return RleBitset{};
+    }
+    common::Buffer buffer;
+    buffer.resize(file.tellg());
+    file.seekg(0, std::ios::beg);
+    file.read(common::span::string(buffer).data(), buffer.size());
+    if (!file.good()) {
+      return StoreErrors::kCannotReadUnsealedRanges;
+    }
+    return codec::cbor::decode<RleBitset>(buffer);
+  }
+
+  outcome::result<void> addUnsealedRange(const std::string &unsealed_path,
+                                         uint64_t offset,
+                                         uint64_t size) {
+    OUTCOME_TRY(ranges, readUnsealedRanges(unsealed_path));
+    ranges.insertRun(offset, offset + size);
+    OUTCOME_TRY(encoded, codec::cbor::encode(ranges));
+
+    // renamed over old file, so ranges are never partially written
+    auto path{unsealedRangesPath(unsealed_path)};
+    auto temp_path{path + ".tmp"};
+    {
+      std::ofstream file{temp_path, std::ios::binary | std::ios::trunc};
+      file.write(common::span::cstring(encoded).data(), encoded.size());
+      if (!file.good()) {
+        return StoreErrors::kCannotWriteUnsealedRanges;
+      }
+    }
+    boost::system::error_code ec;
+    fs::rename(temp_path, path, ec);
+    if (ec.failed()) {
+      return StoreErrors::kCannotWriteUnsealedRanges;
+    }
+    return outcome::success();
+  }
+
+  outcome::result<bool> isUnsealed(const std::string &unsealed_path,
+                                   uint64_t offset,
+                                   uint64_t size) {
+    if (size == 0) {
+      return true;
+    }
+    OUTCOME_TRY(ranges, readUnsealedRanges(unsealed_path));
+    return RleBitset::fromRuns({{offset, offset + size}})
+        .subtract(ranges)
+        .empty();
+  }
+
+  void removeUnsealedRanges(const std::string &unsealed_path) {
+    boost::system::error_code ec;
+    fs::remove(unsealedRangesPath(unsealed_path), ec);
+  }
+}  // namespace fc::sector_storage::stores
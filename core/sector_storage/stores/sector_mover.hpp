@@ -0,0 +1,46 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_SECTOR_STORAGE_STORES_SECTOR_MOVER_HPP
+#define CPP_FILECOIN_CORE_SECTOR_STORAGE_STORES_SECTOR_MOVER_HPP
+
+#include <functional>
+#include <string>
+
+#include "common/outcome.hpp"
+
+namespace fc::sector_storage::stores {
+  struct MoveOptions {
+    /// Threads copying chunks of files
+    size_t threads{4};
+    /// Bytes copied by one chunk
+    uint64_t chunk_size{64 << 20};
+    /// Rename when on same mount, disabled to force copy
+    bool rename{true};
+    /// Clone files with FICLONE when filesystem supports it
+    bool reflink{true};
+    /**
+     * Called with copied and total bytes after each chunk, from copying
+     * threads, but not concurrently
+     */
+    std::function<void(uint64_t, uint64_t)> progress;
+  };
+
+  /**
+   * Moves sector file or cache dir to other storage path.
+   * Renames if source and destination are on same mount. Otherwise files
+   * are cloned with reflinks, if filesystem doesn't share extents they are
+   * split into chunks which are copied in kernel with copy_file_range by
+   * several threads. Copy is made next to destination and renamed to it
+   * after it is synced and sizes of copied files are verified, then source
+   * is removed. Copied pages are dropped from page cache. Existing
+   * destination is replaced.
+   */
+  outcome::result<void> moveSectorFiles(const std::string &from,
+                                        const std::string &to,
+                                        const MoveOptions &options = {});
+}  // namespace fc::sector_storage::stores
+
+#endif  // CPP_FILECOIN_CORE_SECTOR_STORAGE_STORES_SECTOR_MOVER_HPP
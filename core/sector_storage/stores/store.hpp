@@ -20,9 +20,30 @@ namespace fc::sector_storage::stores {
   using primitives::sector_file::SectorFileType;
   using primitives::sector_file::SectorPaths;
 
+  /**
+   * Space reserved on storage for allocated sector files, counted as used
+   * until files are written. Released when destroyed, so task keeps it
+   * while it writes files and drops it on completion or failure.
+   */
+  class SpaceReservation {
+   public:
+    explicit SpaceReservation(std::function<void()> release)
+        : release_{std::move(release)} {}
+    SpaceReservation(const SpaceReservation &) = delete;
+    SpaceReservation &operator=(const SpaceReservation &) = delete;
+    ~SpaceReservation() {
+      release_();
+    }
+
+   private:
+    std::function<void()> release_;
+  };
+
   struct AcquireSectorResponse {
     SectorPaths paths;
     SectorPaths storages;
+    /// Reservation of allocated files, null if nothing was allocated
+    std::shared_ptr<SpaceReservation> reservation;
   };
 
   class Store {
@@ -34,6 +34,10 @@ namespace fc::sector_storage::stores {
     kCannotRemoveOutputPath,
     kCannotMoveFile,
     kNotFoundRequestedSectorType,
+    kIncompleteFetch,
+    kCannotReadUnsealedRanges,
+    kCannotWriteUnsealedRanges,
+    kMovedSectorMismatch,
   };
 }  // namespace fc::sector_storage::stores
 
@@ -0,0 +1,43 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_SECTOR_STORAGE_STORES_UNSEALED_RANGES_HPP
+#define CPP_FILECOIN_CORE_SECTOR_STORAGE_STORES_UNSEALED_RANGES_HPP
+
+#include <string>
+
+#include "common/outcome.hpp"
+#include "primitives/rle_bitset/rle_bitset.hpp"
+
+namespace fc::sector_storage::stores {
+  using primitives::RleBitset;
+
+  /// Extension of file next to unsealed sector file with its unsealed ranges
+  constexpr auto kUnsealedRangesExtension{".ranges"};
+
+  std::string unsealedRangesPath(const std::string &unsealed_path);
+
+  /**
+   * Padded bytes of unsealed sector file which were unsealed.
+   * Missing file has no unsealed ranges.
+   */
+  outcome::result<RleBitset> readUnsealedRanges(
+      const std::string &unsealed_path);
+
+  /// Marks padded bytes [offset, offset + size) of unsealed file as unsealed
+  outcome::result<void> addUnsealedRange(const std::string &unsealed_path,
+                                         uint64_t offset,
+                                         uint64_t size);
+
+  /// Whether padded bytes [offset, offset + size) were unsealed
+  outcome::result<bool> isUnsealed(const std::string &unsealed_path,
+                                   uint64_t offset,
+                                   uint64_t size);
+
+  /// Forgets unsealed ranges, when unsealed file is removed or recreated
+  void removeUnsealedRanges(const std::string &unsealed_path);
+}  // namespace fc::sector_storage::stores
+
+#endif  // CPP_FILECOIN_CORE_SECTOR_STORAGE_STORES_UNSEALED_RANGES_HPP
@@ -18,6 +18,8 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::amt, AmtError, e) {
       return "Index too big";
     case AmtError::kNotFound:
       return "Not found";
+    case AmtError::kNotAscending:
+      return "Keys are not ascending";
   }
   return "Unknown error";
 }
@@ -60,6 +62,7 @@ namespace fc::storage::amt {
       return AmtError::kIndexTooBig;
     }
     OUTCOME_TRY(loadRoot());
+    loaded_root_.reset();
     auto &root = boost::get<Root>(root_);
     while (key >= maxAt(root.height)) {
       if (!visit_in_place(root.node.items,
@@ -110,6 +113,7 @@ namespace fc::storage::amt {
     if (key >= maxAt(root.height)) {
       return AmtError::kNotFound;
     }
+    loaded_root_.reset();
     OUTCOME_TRY(remove(root.node, root.height, key));
     --root.count;
     while (root.height > 0) {
@@ -127,9 +131,17 @@ namespace fc::storage::amt {
 
   outcome::result<CID> Amt::flush() {
     if (which<Root>(root_)) {
+      if (loaded_root_) {
+        // root and its subtree were only read
+        root_ = *loaded_root_;
+        loaded_root_.reset();
+        return cid();
+      }
       auto &root = boost::get<Root>(root_);
-      OUTCOME_TRY(flush(root.node));
-      OUTCOME_TRY(root_cid, ipld->setCbor(root));
+      Ipld::Batch batch;
+      OUTCOME_TRY(flush({&root.node}, batch));
+      OUTCOME_TRY(root_cid, Ipld::addCbor(batch, root));
+      OUTCOME_TRY(ipld->setMany(std::move(batch)));
       root_ = root_cid;
     }
     return cid();
@@ -145,10 +157,68 @@ namespace fc::storage::amt {
     return visit(root.node, root.height, 0, visitor);
   }
 
+  outcome::result<void> Amt::visitRange(uint64_t from,
+                                        uint64_t to,
+                                        const WhileVisitor &visitor) {
+    OUTCOME_TRY(loadRoot());
+    auto &root = boost::get<Root>(root_);
+    to = std::min(to, maxAt(root.height));
+    if (from >= to) {
+      return outcome::success();
+    }
+    OUTCOME_TRY(visitRange(root.node, root.height, 0, from, to, visitor));
+    return outcome::success();
+  }
+
+  outcome::result<void> Amt::visitIndices(const Keys &keys,
+                                          const Visitor &visitor) {
+    OUTCOME_TRY(loadRoot());
+    auto &root = boost::get<Root>(root_);
+    return visitIndices(root.node,
+                        root.height,
+                        0,
+                        keys,
+                        keys.begin(),
+                        keys.lower_bound(maxAt(root.height)),
+                        visitor);
+  }
+
+  outcome::result<void> Amt::diff(IpldPtr ipld,
+                                  const CID &before,
+                                  const CID &after,
+                                  const DiffVisitor &visitor) {
+    if (before == after) {
+      return outcome::success();
+    }
+    Amt amt1{ipld, before}, amt2{ipld, after};
+    OUTCOME_TRY(amt1.loadRoot());
+    OUTCOME_TRY(amt2.loadRoot());
+    auto &root1 = boost::get<Root>(amt1.root_);
+    auto &root2 = boost::get<Root>(amt2.root_);
+    // lower tree is subtree at zero index of higher tree
+    for (auto root : {&root1, &root2}) {
+      auto height = std::max(root1.height, root2.height);
+      if (root->height < height
+          && !visit_in_place(root->node.items,
+                             [](auto &xs) { return xs.empty(); })) {
+        while (root->height < height) {
+          root->node = {true,
+                        Node::Links{{0,
+                                     std::make_shared<Node>(
+                                         std::move(root->node))}}};
+          ++root->height;
+        }
+      }
+      root->height = height;
+    }
+    return amt1.diff(root1.node, root2.node, root1.height, 0, visitor);
+  }
+
   outcome::result<bool> Amt::set(Node &node,
                                  uint64_t height,
                                  uint64_t key,
                                  gsl::span<const uint8_t> value) {
+    node.cid.reset();
     node.has_bits = true;
     if (height == 0) {
       auto &values = boost::get<Node::Values>(node.items);
@@ -164,6 +234,7 @@ namespace fc::storage::amt {
   }
 
   outcome::result<bool> Amt::remove(Node &node, uint64_t height, uint64_t key) {
+    node.cid.reset();
     if (height == 0) {
       auto &values = boost::get<Node::Values>(node.items);
       if (values.erase(key) == 0) {
@@ -197,18 +268,43 @@ namespace fc::storage::amt {
     return res.error();
   }
 
-  outcome::result<void> Amt::flush(Node &node) {
-    if (which<Node::Links>(node.items)) {
-      auto &links = boost::get<Node::Links>(node.items);
-      for (auto &pair : links) {
-        if (which<Node::Ptr>(pair.second)) {
-          auto &child = *boost::get<Node::Ptr>(pair.second);
-          OUTCOME_TRY(flush(child));
-          OUTCOME_TRY(cid, ipld->setCbor(child));
-          pair.second = cid;
+  outcome::result<void> Amt::flush(const std::vector<Node *> &nodes,
+                                   Ipld::Batch &batch) {
+    std::vector<Node::Link *> links;
+    std::vector<Node *> children;
+    for (auto node : nodes) {
+      if (which<Node::Links>(node->items)) {
+        for (auto &pair : boost::get<Node::Links>(node->items)) {
+          if (which<Node::Ptr>(pair.second)) {
+            auto &child = *boost::get<Node::Ptr>(pair.second);
+            if (child.cid) {
+              // changes mark path from root, so clean subtree keeps its cid
+              pair.second = *child.cid;
+              continue;
+            }
+            links.push_back(&pair.second);
+            children.push_back(&child);
+          }
         }
       }
     }
+    if (children.empty()) {
+      return outcome::success();
+    }
+    OUTCOME_TRY(flush(children, batch));
+    std::vector<Ipld::Value> values;
+    values.reserve(children.size());
+    for (auto child : children) {
+      OUTCOME_TRY(value, Ipld::encode(*child));
+      values.push_back(std::move(value));
+    }
+    OUTCOME_TRY(cids, Ipld::addMany(batch, std::move(values)));
+    for (size_t i = 0; i < links.size(); ++i) {
+      // flushed node contains only cids and values, same as decoded
+      children[i]->cid = cids[i];
+      nodeCache().put(cids[i], std::make_shared<const Node>(*children[i]));
+      *links[i] = std::move(cids[i]);
+    }
     return outcome::success();
   }
 
@@ -233,9 +329,161 @@ namespace fc::storage::amt {
     return outcome::success();
   }
 
+  outcome::result<bool> Amt::visitRange(Node &node,
+                                        uint64_t height,
+                                        uint64_t offset,
+                                        uint64_t from,
+                                        uint64_t to,
+                                        const WhileVisitor &visitor) {
+    if (height == 0) {
+      auto &values = boost::get<Node::Values>(node.items);
+      for (auto it = values.lower_bound(from > offset ? from - offset : 0);
+           it != values.end() && offset + it->first < to;
+           ++it) {
+        OUTCOME_TRY(more, visitor(offset + it->first, it->second));
+        if (!more) {
+          return false;
+        }
+      }
+      return true;
+    }
+    auto mask = maskAt(height);
+    auto &links = boost::get<Node::Links>(node.items);
+    auto first = from > offset ? (from - offset) / mask : 0;
+    for (auto it = links.lower_bound(first);
+         it != links.end() && offset + it->first * mask < to;
+         ++it) {
+      OUTCOME_TRY(child, loadLink(node, it->first, false));
+      OUTCOME_TRY(more,
+                  visitRange(*child,
+                             height - 1,
+                             offset + it->first * mask,
+                             from,
+                             to,
+                             visitor));
+      if (!more) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  outcome::result<void> Amt::visitIndices(Node &node,
+                                          uint64_t height,
+                                          uint64_t offset,
+                                          const Keys &keys,
+                                          Keys::const_iterator begin,
+                                          Keys::const_iterator end,
+                                          const Visitor &visitor) {
+    if (height == 0) {
+      auto &values = boost::get<Node::Values>(node.items);
+      for (; begin != end; ++begin) {
+        auto it = values.find(*begin - offset);
+        if (it != values.end()) {
+          OUTCOME_TRY(visitor(*begin, it->second));
+        }
+      }
+      return outcome::success();
+    }
+    auto mask = maskAt(height);
+    auto &links = boost::get<Node::Links>(node.items);
+    while (begin != end) {
+      auto index = (*begin - offset) / mask;
+      auto next = keys.lower_bound(offset + (index + 1) * mask);
+      if (links.find(index) != links.end()) {
+        OUTCOME_TRY(child, loadLink(node, index, false));
+        OUTCOME_TRY(visitIndices(*child,
+                                 height - 1,
+                                 offset + index * mask,
+                                 keys,
+                                 begin,
+                                 next,
+                                 visitor));
+      }
+      begin = next;
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> Amt::diff(Node &before,
+                                  Node &after,
+                                  uint64_t height,
+                                  uint64_t offset,
+                                  const DiffVisitor &visitor) {
+    if (height == 0) {
+      auto &values1 = boost::get<Node::Values>(before.items);
+      auto &values2 = boost::get<Node::Values>(after.items);
+      auto it1 = values1.begin();
+      auto it2 = values2.begin();
+      while (it1 != values1.end() || it2 != values2.end()) {
+        if (it2 == values2.end()
+            || (it1 != values1.end() && it1->first < it2->first)) {
+          OUTCOME_TRY(visitor(offset + it1->first, it1->second, boost::none));
+          ++it1;
+        } else if (it1 == values1.end() || it2->first < it1->first) {
+          OUTCOME_TRY(visitor(offset + it2->first, boost::none, it2->second));
+          ++it2;
+        } else {
+          if (it1->second != it2->second) {
+            OUTCOME_TRY(visitor(offset + it1->first, it1->second, it2->second));
+          }
+          ++it1;
+          ++it2;
+        }
+      }
+      return outcome::success();
+    }
+    for (auto node : {&before, &after}) {
+      if (which<Node::Values>(node->items)
+          && boost::get<Node::Values>(node->items).empty()) {
+        node->items = Node::Links{};
+      }
+    }
+    auto mask = maskAt(height);
+    auto &links1 = boost::get<Node::Links>(before.items);
+    auto &links2 = boost::get<Node::Links>(after.items);
+    std::set<uint64_t> indices;
+    for (auto links : {&links1, &links2}) {
+      for (auto &it : *links) {
+        indices.insert(it.first);
+      }
+    }
+    for (auto index : indices) {
+      auto it1 = links1.find(index);
+      auto it2 = links2.find(index);
+      auto offset2 = offset + index * mask;
+      if (it1 == links1.end() || it2 == links2.end()) {
+        auto removed = it2 == links2.end();
+        auto &node = removed ? before : after;
+        OUTCOME_TRY(child, loadLink(node, index, false));
+        OUTCOME_TRY(visit(
+            *child,
+            height - 1,
+            offset2,
+            [&](auto key, auto &value) -> outcome::result<void> {
+              if (removed) {
+                return visitor(key, value, boost::none);
+              }
+              return visitor(key, boost::none, value);
+            }));
+        continue;
+      }
+      if (which<CID>(it1->second) && which<CID>(it2->second)
+          && boost::get<CID>(it1->second) == boost::get<CID>(it2->second)) {
+        continue;
+      }
+      OUTCOME_TRY(child1, loadLink(before, index, false));
+      OUTCOME_TRY(child2, loadLink(after, index, false));
+      OUTCOME_TRY(diff(*child1, *child2, height - 1, offset2, visitor));
+    }
+    return outcome::success();
+  }
+
   outcome::result<void> Amt::loadRoot() {
     if (which<CID>(root_)) {
-      OUTCOME_TRY(root, ipld->getCbor<Root>(boost::get<CID>(root_)));
+      auto &cid = boost::get<CID>(root_);
+      OUTCOME_TRY(root, ipld->getCbor<Root>(cid));
+      loaded_root_ = cid;
       root_ = root;
     }
     return outcome::success();
@@ -260,9 +508,109 @@ namespace fc::storage::amt {
     }
     auto &link = it->second;
     if (which<CID>(link)) {
-      OUTCOME_TRY(node, ipld->getCbor<Node>(boost::get<CID>(link)));
-      link = std::make_shared<Node>(std::move(node));
+      auto &cid = boost::get<CID>(link);
+      Node::Ptr node;
+      auto cached = nodeCache().get(cid);
+      if (cached) {
+        // cache is shared by stores, node may be missing in this one
+        OUTCOME_TRY(stored, ipld->contains(cid));
+        if (!stored) {
+          cached = boost::none;
+        }
+      }
+      if (cached) {
+        node = std::make_shared<Node>(**cached);
+      } else {
+        OUTCOME_TRY(decoded, ipld->getCbor<Node>(cid));
+        node = std::make_shared<Node>(std::move(decoded));
+        nodeCache().put(cid, std::make_shared<const Node>(*node));
+      }
+      node->cid = cid;
+      link = std::move(node);
     }
     return boost::get<Node::Ptr>(link);
   }
+
+  NodeCache &Amt::nodeCache() {
+    static NodeCache cache{kNodeCacheSize};
+    return cache;
+  }
+
+  AmtBuilder::AmtBuilder(std::shared_ptr<ipfs::IpfsDatastore> store)
+      : ipld{std::move(store)} {}
+
+  outcome::result<void> AmtBuilder::append(uint64_t key,
+                                           gsl::span<const uint8_t> value) {
+    if (key >= kMaxIndex) {
+      return AmtError::kIndexTooBig;
+    }
+    if (key < next_key_) {
+      return AmtError::kNotAscending;
+    }
+    if (levels_.empty()) {
+      levels_.emplace_back();
+    }
+    if (levels_[0] && key >= levels_[0]->offset + kWidth) {
+      OUTCOME_TRY(close(0));
+    }
+    auto &leaf = levels_[0];
+    if (!leaf) {
+      leaf = Level{key - key % kWidth, {true, Node::Values{}}};
+    }
+    boost::get<Node::Values>(leaf->node.items)
+        .emplace(key - leaf->offset, Value{value});
+    ++count_;
+    next_key_ = key + 1;
+    return outcome::success();
+  }
+
+  outcome::result<CID> AmtBuilder::flush() {
+    Root root;
+    root.count = count_;
+    if (count_ != 0) {
+      auto max_key = next_key_ - 1;
+      while (max_key >= maxAt(root.height)) {
+        ++root.height;
+      }
+      for (uint64_t height = 0; height < root.height; ++height) {
+        if (levels_[height]) {
+          OUTCOME_TRY(close(height));
+        }
+      }
+      root.node = std::move(levels_[root.height]->node);
+    }
+    levels_.clear();
+    count_ = 0;
+    next_key_ = 0;
+    return ipld->setCbor(root);
+  }
+
+  outcome::result<void> AmtBuilder::addLink(uint64_t height,
+                                            uint64_t key,
+                                            CID cid) {
+    if (levels_.size() <= height) {
+      levels_.resize(height + 1);
+    }
+    auto range = maxAt(height);
+    auto offset = key - key % range;
+    if (levels_[height] && levels_[height]->offset != offset) {
+      OUTCOME_TRY(close(height));
+    }
+    auto &level = levels_[height];
+    if (!level) {
+      level = Level{offset, {true, Node::Links{}}};
+    }
+    boost::get<Node::Links>(level->node.items)
+        .emplace((key - offset) / maskAt(height), std::move(cid));
+    return outcome::success();
+  }
+
+  outcome::result<void> AmtBuilder::close(uint64_t height) {
+    auto level = std::move(*levels_[height]);
+    levels_[height] = boost::none;
+    OUTCOME_TRY(cid, ipld->setCbor(level.node));
+    Amt::nodeCache().put(cid,
+                         std::make_shared<const Node>(std::move(level.node)));
+    return addLink(height + 1, level.offset, std::move(cid));
+  }
 }  // namespace fc::storage::amt
@@ -7,8 +7,10 @@
 #define CPP_FILECOIN_STORAGE_AMT_AMT_HPP
 
 #include <boost/variant.hpp>
+#include <set>
 
 #include "codec/cbor/cbor.hpp"
+#include "common/lru_cache.hpp"
 #include "common/outcome.hpp"
 #include "common/visitor.hpp"
 #include "common/which.hpp"
@@ -21,6 +23,7 @@ namespace fc::storage::amt {
     kDecodeWrong,
     kIndexTooBig,
     kNotFound,
+    kNotAscending,
   };
 }  // namespace fc::storage::amt
 
@@ -29,6 +32,8 @@ OUTCOME_HPP_DECLARE_ERROR(fc::storage::amt, AmtError);
 namespace fc::storage::amt {
   constexpr size_t kWidth = 8;
   constexpr auto kMaxIndex = 1ull << 48;
+  /// Max number of decoded nodes kept by node cache
+  constexpr size_t kNodeCacheSize = 1 << 14;
 
   using common::which;
   using Value = ipfs::IpfsDatastore::Value;
@@ -43,8 +48,14 @@ namespace fc::storage::amt {
     /// github.com/filecoin-project/go-amt-ipld does not truncate zero bits
     bool has_bits{};
     Items items;
+    /// Cid node was loaded from, none if node was changed since
+    boost::optional<CID> cid{};
   };
 
+  /// Decoded immutable nodes by cid, shared by all amt instances and stores,
+  /// hit is used only if node is in store of instance
+  using NodeCache = common::LruCache<CID, std::shared_ptr<const Node>>;
+
   CBOR_ENCODE(Node, node) {
     std::vector<uint8_t> bits;
     auto l_links = s.list();
@@ -69,7 +80,7 @@ namespace fc::storage::amt {
             }
           });
     }
-    return s << (s.list() << bits << l_links << l_values);
+    return s << std::move(s.list() << bits << l_links << l_values);
   }
 
   CBOR_DECODE(Node, node) {
@@ -129,6 +140,15 @@ namespace fc::storage::amt {
    public:
     using Visitor =
         std::function<outcome::result<void>(uint64_t, const Value &)>;
+    /// Visitor returning false to stop iteration
+    using WhileVisitor =
+        std::function<outcome::result<bool>(uint64_t, const Value &)>;
+    using Keys = std::set<uint64_t>;
+    /// Receives none as before for added value, none as after for removed
+    using DiffVisitor =
+        std::function<outcome::result<void>(uint64_t,
+                                            const boost::optional<Value> &,
+                                            const boost::optional<Value> &)>;
 
     explicit Amt(std::shared_ptr<ipfs::IpfsDatastore> store);
     Amt(std::shared_ptr<ipfs::IpfsDatastore> store, const CID &root);
@@ -148,6 +168,28 @@ namespace fc::storage::amt {
     const CID &cid() const;
     /// Apply visitor for key value pairs
     outcome::result<void> visit(const Visitor &visitor);
+    /**
+     * Apply visitor for key value pairs with keys in [from, to) in ascending
+     * order, until visitor returns false. Only nodes overlapping range are
+     * loaded.
+     */
+    outcome::result<void> visitRange(uint64_t from,
+                                     uint64_t to,
+                                     const WhileVisitor &visitor);
+    /**
+     * Apply visitor for present keys from set in ascending order, subtrees
+     * without requested keys are not loaded
+     */
+    outcome::result<void> visitIndices(const Keys &keys,
+                                       const Visitor &visitor);
+    /**
+     * Apply visitor for added, modified and removed values between two
+     * roots. Subtrees with same CID are not loaded.
+     */
+    static outcome::result<void> diff(IpldPtr ipld,
+                                      const CID &before,
+                                      const CID &after,
+                                      const DiffVisitor &visitor);
 
     /// Store CBOR encoded value by key
     template <typename T>
@@ -163,6 +205,9 @@ namespace fc::storage::amt {
       return ipld->decode<T>(bytes);
     }
 
+    /// Get node cache shared by all amt instances
+    static NodeCache &nodeCache();
+
     IpldPtr ipld;
 
    private:
@@ -171,17 +216,76 @@ namespace fc::storage::amt {
                               uint64_t key,
                               gsl::span<const uint8_t> value);
     outcome::result<bool> remove(Node &node, uint64_t height, uint64_t key);
-    outcome::result<void> flush(Node &node);
+    /// Flush children of nodes, each level of tree is hashed together
+    outcome::result<void> flush(const std::vector<Node *> &nodes,
+                                Ipld::Batch &batch);
     outcome::result<void> visit(Node &node,
                                 uint64_t height,
                                 uint64_t offset,
                                 const Visitor &visitor);
+    outcome::result<bool> visitRange(Node &node,
+                                     uint64_t height,
+                                     uint64_t offset,
+                                     uint64_t from,
+                                     uint64_t to,
+                                     const WhileVisitor &visitor);
+    outcome::result<void> visitIndices(Node &node,
+                                       uint64_t height,
+                                       uint64_t offset,
+                                       const Keys &keys,
+                                       Keys::const_iterator begin,
+                                       Keys::const_iterator end,
+                                       const Visitor &visitor);
+    outcome::result<void> diff(Node &before,
+                               Node &after,
+                               uint64_t height,
+                               uint64_t offset,
+                               const DiffVisitor &visitor);
     outcome::result<void> loadRoot();
     outcome::result<Node::Ptr> loadLink(Node &node,
                                         uint64_t index,
                                         bool create);
 
     boost::variant<CID, Root> root_;
+    /// Cid root was loaded from, none if root was changed since
+    boost::optional<CID> loaded_root_;
+  };
+
+  /**
+   * Builds amt bottom-up from values appended in ascending key order.
+   * Full nodes are written as soon as next key leaves their range, so each
+   * node is encoded and written to storage exactly once.
+   */
+  class AmtBuilder {
+   public:
+    explicit AmtBuilder(std::shared_ptr<ipfs::IpfsDatastore> store);
+    /// Append value, key must be greater than previous key
+    outcome::result<void> append(uint64_t key, gsl::span<const uint8_t> value);
+    /// Write remaining nodes and root to storage
+    outcome::result<CID> flush();
+
+    /// Append CBOR encoded value
+    template <typename T>
+    outcome::result<void> appendCbor(uint64_t key, const T &value) {
+      OUTCOME_TRY(bytes, Ipld::encode(value));
+      return append(key, bytes);
+    }
+
+    IpldPtr ipld;
+
+   private:
+    /// Open node of level with first key of its range
+    struct Level {
+      uint64_t offset;
+      Node node;
+    };
+
+    outcome::result<void> addLink(uint64_t height, uint64_t key, CID cid);
+    outcome::result<void> close(uint64_t height);
+
+    std::vector<boost::optional<Level>> levels_;
+    uint64_t count_{};
+    uint64_t next_key_{};
   };
 }  // namespace fc::storage::amt
 
@@ -4,7 +4,14 @@
  */
 
 #include "storage/car/car.hpp"
+
+#include <condition_variable>
+#include <mutex>
+
+#include <boost/asio/post.hpp>
+
 #include "codec/uvarint.hpp"
+#include "crypto/hasher/hasher.hpp"
 #include "storage/ipld/traverser.hpp"
 
 OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::car, CarError, e) {
@@ -12,24 +19,43 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::car, CarError, e) {
   switch (e) {
     case E::kDecodeError:
       return "Decode error";
+    case E::kCidMismatch:
+      return "Block does not match cid";
+    case E::kStreamError:
+      return "Stream error";
   }
 }
 
 namespace fc::storage::car {
   using ipld::kAllSelector;
   using ipld::traverser::Traverser;
+  using libp2p::multi::HashType;
+
+  /// Max size of single car item read from stream
+  constexpr size_t kMaxItemSize{8 << 20};
+
+  /// Max blocks written with single batch
+  constexpr size_t kLoadBatchSize{1 << 12};
+
+  /// Max batches read but not written yet by parallel load
+  constexpr size_t kLoadBatchesInFlight{8};
 
   outcome::result<std::vector<CID>> loadCar(Ipld &store, Input input) {
     OUTCOME_TRY(header_bytes,
                 codec::uvarint::readBytes<CarError::kDecodeError,
                                           CarError::kDecodeError>(input));
     OUTCOME_TRY(header, codec::cbor::decode<CarHeader>(header_bytes));
+    Ipld::Batch batch;
     while (!input.empty()) {
       OUTCOME_TRY(node,
                   codec::uvarint::readBytes<CarError::kDecodeError,
                                             CarError::kDecodeError>(input));
       OUTCOME_TRY(cid, CID::read(node));
-      OUTCOME_TRY(store.set(cid, common::Buffer{node}));
+      batch.emplace_back(std::move(cid), common::Buffer{node});
+      if (batch.size() >= kLoadBatchSize || input.empty()) {
+        OUTCOME_TRY(store.setMany(std::move(batch)));
+        batch.clear();
+      }
     }
     return std::move(header.roots);
   }
@@ -95,4 +121,216 @@ namespace fc::storage::car {
     }
     return makeCar(store, roots, cid_order);
   }
+
+  /// Read uvarint from stream, none if stream ended before value
+  outcome::result<boost::optional<uint64_t>> readUvarint(std::istream &input) {
+    uint64_t value{};
+    for (auto shift = 0; shift < 64; shift += 7) {
+      auto byte = input.get();
+      if (byte == std::istream::traits_type::eof()) {
+        if (shift == 0 && input.eof()) {
+          return boost::none;
+        }
+        return CarError::kDecodeError;
+      }
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    return CarError::kDecodeError;
+  }
+
+  outcome::result<void> readBytes(std::istream &input, Buffer &bytes) {
+    OUTCOME_TRY(size, readUvarint(input));
+    if (!size || *size > kMaxItemSize) {
+      return CarError::kDecodeError;
+    }
+    bytes.resize(*size);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    input.read(reinterpret_cast<char *>(bytes.data()), bytes.size());
+    if (input.gcount() != static_cast<std::streamsize>(bytes.size())) {
+      return CarError::kDecodeError;
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> verifyCid(const CID &cid, Input bytes) {
+    auto type = cid.content_address.getType();
+    if (type != HashType::sha256 && type != HashType::blake2b_256) {
+      return outcome::success();
+    }
+    if (crypto::Hasher::calculate(type, bytes) != cid.content_address) {
+      return CarError::kCidMismatch;
+    }
+    return outcome::success();
+  }
+
+  CarReader::CarReader(std::istream &input) : input_{&input} {}
+
+  outcome::result<CarReader> CarReader::make(std::istream &input) {
+    CarReader reader{input};
+    Buffer header_bytes;
+    OUTCOME_TRY(readBytes(input, header_bytes));
+    OUTCOME_TRYA(reader.header_,
+                 codec::cbor::decode<CarHeader>(header_bytes));
+    return std::move(reader);
+  }
+
+  outcome::result<boost::optional<std::pair<CID, Buffer>>> CarReader::next(
+      bool verify) {
+    if (input_->peek() == std::istream::traits_type::eof()) {
+      return boost::none;
+    }
+    Buffer item;
+    OUTCOME_TRY(readBytes(*input_, item));
+    Input input{item};
+    OUTCOME_TRY(cid, CID::read(input));
+    if (verify) {
+      OUTCOME_TRY(verifyCid(cid, input));
+    }
+    return std::make_pair(std::move(cid), Buffer{input});
+  }
+
+  const std::vector<CID> &CarReader::roots() const {
+    return header_.roots;
+  }
+
+  outcome::result<std::vector<CID>> loadCar(Ipld &store, std::istream &input) {
+    OUTCOME_TRY(reader, CarReader::make(input));
+    Ipld::Batch batch;
+    while (true) {
+      OUTCOME_TRY(item, reader.next());
+      if (item) {
+        batch.emplace_back(std::move(*item));
+      }
+      if (!batch.empty() && (!item || batch.size() >= kLoadBatchSize)) {
+        OUTCOME_TRY(store.setMany(std::move(batch)));
+        batch.clear();
+      }
+      if (!item) {
+        break;
+      }
+    }
+    return reader.roots();
+  }
+
+  outcome::result<std::vector<CID>> loadCar(Ipld &store,
+                                            std::istream &input,
+                                            boost::asio::thread_pool &pool) {
+    OUTCOME_TRY(reader, CarReader::make(input));
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t in_flight{0};
+    outcome::result<void> result{outcome::success()};
+    std::mutex write_mutex;
+    auto failed{[&] {
+      std::lock_guard lock{mutex};
+      return result.has_error();
+    }};
+    auto submit{[&](Ipld::Batch batch) {
+      std::unique_lock lock{mutex};
+      done.wait(lock, [&] { return in_flight < kLoadBatchesInFlight; });
+      ++in_flight;
+      lock.unlock();
+      boost::asio::post(pool, [&, batch{std::move(batch)}]() mutable {
+        auto written{[&]() -> outcome::result<void> {
+          // hashing dominates load, so it runs outside of write lock
+          for (auto &[cid, bytes] : batch) {
+            OUTCOME_TRY(verifyCid(cid, bytes));
+          }
+          std::lock_guard lock{write_mutex};
+          return store.setMany(std::move(batch));
+        }()};
+        std::lock_guard lock{mutex};
+        if (!written && result) {
+          result = written.error();
+        }
+        --in_flight;
+        done.notify_all();
+      });
+    }};
+    auto read{[&]() -> outcome::result<void> {
+      Ipld::Batch batch;
+      while (!failed()) {
+        OUTCOME_TRY(item, reader.next(false));
+        if (item) {
+          batch.emplace_back(std::move(*item));
+        }
+        if (!batch.empty() && (!item || batch.size() >= kLoadBatchSize)) {
+          submit(std::move(batch));
+          batch.clear();
+        }
+        if (!item) {
+          break;
+        }
+      }
+      return outcome::success();
+    }()};
+    // posted batches refer to locals, so they are awaited on error too
+    std::unique_lock lock{mutex};
+    done.wait(lock, [&] { return in_flight == 0; });
+    OUTCOME_TRY(read);
+    OUTCOME_TRY(result);
+    return reader.roots();
+  }
+
+  CarWriter::CarWriter(std::ostream &output, const std::vector<CID> &roots)
+      : output_{output} {
+    Buffer header;
+    writeHeader(header, roots);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    output_.write(reinterpret_cast<const char *>(header.data()), header.size());
+  }
+
+  outcome::result<void> CarWriter::write(const CID &cid, Input bytes) {
+    Buffer item;
+    writeItem(item, cid, bytes);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    output_.write(reinterpret_cast<const char *>(item.data()), item.size());
+    return check();
+  }
+
+  outcome::result<void> CarWriter::write(Ipld &store, const CID &cid) {
+    return store.view(cid, [&](auto bytes) { return write(cid, bytes); });
+  }
+
+  outcome::result<void> CarWriter::check() {
+    if (!output_.good()) {
+      return CarError::kStreamError;
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> writeCar(std::ostream &output,
+                                 Ipld &store,
+                                 const std::vector<CID> &roots) {
+    std::vector<std::pair<CID, Selector>> dags;
+    for (auto &root : roots) {
+      dags.emplace_back(root, kAllSelector);
+    }
+    return writeSelectiveCar(output, store, dags);
+  }
+
+  outcome::result<void> writeSelectiveCar(
+      std::ostream &output,
+      Ipld &store,
+      const std::vector<std::pair<CID, Selector>> &dags) {
+    std::vector<CID> roots;
+    for (auto &dag : dags) {
+      roots.push_back(dag.first);
+    }
+    CarWriter writer{output, roots};
+    std::set<CID> written;
+    for (auto &dag : dags) {
+      Traverser traverser{store, dag.first, dag.second};
+      while (!traverser.isCompleted()) {
+        OUTCOME_TRY(cid, traverser.advance());
+        if (written.insert(cid).second) {
+          OUTCOME_TRY(writer.write(store, cid));
+        }
+      }
+    }
+    return outcome::success();
+  }
 }  // namespace fc::storage::car
@@ -6,6 +6,11 @@
 #ifndef CPP_FILECOIN_CORE_STORAGE_CAR_CAR_HPP
 #define CPP_FILECOIN_CORE_STORAGE_CAR_CAR_HPP
 
+#include <istream>
+#include <ostream>
+
+#include <boost/asio/thread_pool.hpp>
+
 #include "storage/ipfs/datastore.hpp"
 #include "storage/ipld/selector.hpp"
 
@@ -15,7 +20,7 @@ namespace fc::storage::car {
   using common::Buffer;
   using ipld::Selector;
 
-  enum class CarError { kDecodeError = 1 };
+  enum class CarError { kDecodeError = 1, kCidMismatch, kStreamError };
 
   struct CarHeader {
     static constexpr uint64_t V1 = 1;
@@ -48,6 +53,74 @@ namespace fc::storage::car {
 
   outcome::result<Buffer> makeSelectiveCar(
       Ipld &store, const std::vector<std::pair<CID, Selector>> &dags);
+
+  /**
+   * Reads car items from stream one by one, so only current item is kept in
+   * memory. Item bytes are verified against cid when hash type is known.
+   */
+  class CarReader {
+   public:
+    /// Read car header from stream
+    static outcome::result<CarReader> make(std::istream &input);
+
+    /**
+     * Read next item, none at end of stream
+     * @param verify - verify item bytes against cid, or leave it to caller
+     */
+    outcome::result<boost::optional<std::pair<CID, Buffer>>> next(
+        bool verify = true);
+
+    const std::vector<CID> &roots() const;
+
+   private:
+    explicit CarReader(std::istream &input);
+
+    std::istream *input_;
+    CarHeader header_;
+  };
+
+  /// Verify bytes against cid when hash type is known
+  outcome::result<void> verifyCid(const CID &cid, Input bytes);
+
+  /// Import car from stream, writes blocks in bounded batches
+  outcome::result<std::vector<CID>> loadCar(Ipld &store, std::istream &input);
+
+  /**
+   * Import car from stream, batches are verified and written on pool while
+   * next ones are read. Batches in flight are bounded, writes to store are
+   * serialized, so store needs no concurrent access.
+   */
+  outcome::result<std::vector<CID>> loadCar(Ipld &store,
+                                            std::istream &input,
+                                            boost::asio::thread_pool &pool);
+
+  /// Writes car items to stream as they are produced
+  class CarWriter {
+   public:
+    /// Write car header with roots
+    CarWriter(std::ostream &output, const std::vector<CID> &roots);
+
+    outcome::result<void> write(const CID &cid, Input bytes);
+
+    /// Write block from store
+    outcome::result<void> write(Ipld &store, const CID &cid);
+
+   private:
+    outcome::result<void> check();
+
+    std::ostream &output_;
+  };
+
+  /// Write car of all blocks reachable from roots, one traversal step at a time
+  outcome::result<void> writeCar(std::ostream &output,
+                                 Ipld &store,
+                                 const std::vector<CID> &roots);
+
+  /// Write selective car, one traversal step at a time
+  outcome::result<void> writeSelectiveCar(
+      std::ostream &output,
+      Ipld &store,
+      const std::vector<std::pair<CID, Selector>> &dags);
 }  // namespace fc::storage::car
 
 OUTCOME_HPP_DECLARE_ERROR(fc::storage::car, CarError);
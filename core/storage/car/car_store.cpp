@@ -0,0 +1,183 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/car/car_store.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+
+#include "codec/uvarint.hpp"
+
+namespace fc::storage::car {
+  using ipfs::IpfsDatastoreError;
+
+  /// Map whole file for reading, mtime is in nanoseconds
+  outcome::result<Input> mapFile(const std::string &path, int64_t &mtime) {
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+      return CarError::kStreamError;
+    }
+    struct stat stat {};
+    if (::fstat(fd, &stat) == -1 || stat.st_size == 0) {
+      ::close(fd);
+      return CarError::kStreamError;
+    }
+    auto size = static_cast<size_t>(stat.st_size);
+    mtime = int64_t{stat.st_mtim.tv_sec} * 1000000000 + stat.st_mtim.tv_nsec;
+    auto ptr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (ptr == MAP_FAILED) {
+      return CarError::kStreamError;
+    }
+    return Input{static_cast<const uint8_t *>(ptr),
+                 static_cast<ptrdiff_t>(size)};
+  }
+
+  void unmapFile(Input data) {
+    if (!data.empty()) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+      ::munmap(const_cast<uint8_t *>(data.data()), data.size());
+    }
+  }
+
+  outcome::result<CarHeader> readHeader(Input &input) {
+    OUTCOME_TRY(header_bytes,
+                codec::uvarint::readBytes<CarError::kDecodeError,
+                                          CarError::kDecodeError>(input));
+    return codec::cbor::decode<CarHeader>(header_bytes);
+  }
+
+  /// Find offsets of blocks in car
+  outcome::result<std::vector<CarIndexEntry>> scan(Input data) {
+    auto input{data};
+    OUTCOME_TRY(readHeader(input));
+    std::vector<CarIndexEntry> entries;
+    while (!input.empty()) {
+      OUTCOME_TRY(node,
+                  codec::uvarint::readBytes<CarError::kDecodeError,
+                                            CarError::kDecodeError>(input));
+      OUTCOME_TRY(cid, CID::read(node));
+      entries.push_back({std::move(cid),
+                         static_cast<uint64_t>(node.data() - data.data()),
+                         static_cast<uint64_t>(node.size())});
+    }
+    return std::move(entries);
+  }
+
+  outcome::result<void> saveIndex(const std::string &car_path,
+                                  const CarIndex &index) {
+    OUTCOME_TRY(bytes, codec::cbor::encode(index));
+    std::ofstream file{CarStore::indexPath(car_path), std::ios::binary};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    if (!file.good()) {
+      return CarError::kStreamError;
+    }
+    return outcome::success();
+  }
+
+  /// Index matching car size and mtime, none if missing, stale or corrupt
+  boost::optional<CarIndex> loadIndex(const std::string &car_path,
+                                      uint64_t car_size,
+                                      int64_t car_mtime) {
+    std::ifstream file{CarStore::indexPath(car_path), std::ios::binary};
+    if (!file.is_open()) {
+      return boost::none;
+    }
+    Buffer bytes{std::vector<uint8_t>{std::istreambuf_iterator<char>{file},
+                                      std::istreambuf_iterator<char>{}}};
+    auto index{codec::cbor::decode<CarIndex>(bytes)};
+    if (!index || index.value().car_size != car_size
+        || index.value().car_mtime != car_mtime) {
+      return boost::none;
+    }
+    return std::move(index.value());
+  }
+
+  std::string CarStore::indexPath(const std::string &car_path) {
+    return car_path + ".idx";
+  }
+
+  outcome::result<std::vector<CarIndexEntry>> CarStore::writeIndex(
+      const std::string &car_path) {
+    int64_t mtime{};
+    OUTCOME_TRY(data, mapFile(car_path, mtime));
+    auto entries = scan(data);
+    unmapFile(data);
+    if (entries) {
+      OUTCOME_TRY(saveIndex(car_path, {data.size(), mtime, entries.value()}));
+    }
+    return entries;
+  }
+
+  outcome::result<std::shared_ptr<CarStore>> CarStore::open(
+      const std::string &car_path) {
+    auto store = std::make_shared<CarStore>();
+    int64_t mtime{};
+    OUTCOME_TRY(data, mapFile(car_path, mtime));
+    store->data_ = data.data();
+    store->size_ = data.size();
+    auto input{data};
+    OUTCOME_TRY(header, readHeader(input));
+    store->roots_ = std::move(header.roots);
+    auto loaded{loadIndex(car_path, data.size(), mtime)};
+    if (!loaded) {
+      OUTCOME_TRY(entries, scan(data));
+      loaded = CarIndex{data.size(), mtime, std::move(entries)};
+      OUTCOME_TRY(saveIndex(car_path, *loaded));
+    }
+    for (auto &entry : loaded->entries) {
+      if (entry.offset + entry.size > store->size_) {
+        return CarError::kDecodeError;
+      }
+      store->index_.emplace(std::move(entry.cid),
+                            std::make_pair(entry.offset, entry.size));
+    }
+    return std::move(store);
+  }
+
+  CarStore::~CarStore() {
+    unmapFile({data_, static_cast<ptrdiff_t>(size_)});
+  }
+
+  const std::vector<CID> &CarStore::roots() const {
+    return roots_;
+  }
+
+  outcome::result<bool> CarStore::contains(const CID &key) const {
+    return index_.find(key) != index_.end();
+  }
+
+  outcome::result<void> CarStore::set(const CID &key, Value value) {
+    return IpfsDatastoreError::kReadOnly;
+  }
+
+  outcome::result<CarStore::Value> CarStore::get(const CID &key) const {
+    OUTCOME_TRY(bytes, find(key));
+    return Value{bytes};
+  }
+
+  outcome::result<void> CarStore::view(const CID &key,
+                                       const ViewCallback &callback) const {
+    OUTCOME_TRY(bytes, find(key));
+    return callback(bytes);
+  }
+
+  outcome::result<void> CarStore::remove(const CID &key) {
+    return IpfsDatastoreError::kReadOnly;
+  }
+
+  outcome::result<Input> CarStore::find(const CID &key) const {
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      return IpfsDatastoreError::kNotFound;
+    }
+    return Input{data_ + it->second.first,
+                 static_cast<ptrdiff_t>(it->second.second)};
+  }
+}  // namespace fc::storage::car
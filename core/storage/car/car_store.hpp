@@ -0,0 +1,88 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_STORAGE_CAR_CAR_STORE_HPP
+#define CPP_FILECOIN_CORE_STORAGE_CAR_CAR_STORE_HPP
+
+#include <unordered_map>
+
+#include "storage/car/car.hpp"
+
+namespace fc::storage::car {
+  /// Location of block bytes in car file
+  struct CarIndexEntry {
+    CID cid;
+    uint64_t offset;
+    uint64_t size;
+  };
+  CBOR_TUPLE(CarIndexEntry, cid, offset, size)
+
+  /// Index file content, stale when car size or mtime differ
+  struct CarIndex {
+    uint64_t car_size{};
+    int64_t car_mtime{};
+    std::vector<CarIndexEntry> entries;
+  };
+  CBOR_TUPLE(CarIndex, car_size, car_mtime, entries)
+
+  /**
+   * Read-only ipld backed by memory mapped car file. Block offsets are kept
+   * in index file next to car, which is built by scanning car once and
+   * rebuilt when car size or mtime change.
+   */
+  class CarStore : public Ipld, public std::enable_shared_from_this<CarStore> {
+   public:
+    /// Index file path for car file path
+    static std::string indexPath(const std::string &car_path);
+
+    /**
+     * Scan car file and write its index
+     * @param car_path - car file
+     * @return index entries
+     */
+    static outcome::result<std::vector<CarIndexEntry>> writeIndex(
+        const std::string &car_path);
+
+    /**
+     * Map car file, load index or build it if missing or stale
+     * @param car_path - car file
+     * @return store
+     */
+    static outcome::result<std::shared_ptr<CarStore>> open(
+        const std::string &car_path);
+
+    ~CarStore() override;
+
+    const std::vector<CID> &roots() const;
+
+    outcome::result<bool> contains(const CID &key) const override;
+
+    /// Returns kReadOnly
+    outcome::result<void> set(const CID &key, Value value) override;
+
+    outcome::result<Value> get(const CID &key) const override;
+
+    /// Passes mapped bytes without copying
+    outcome::result<void> view(const CID &key,
+                               const ViewCallback &callback) const override;
+
+    /// Returns kReadOnly
+    outcome::result<void> remove(const CID &key) override;
+
+    IpldPtr shared() override {
+      return shared_from_this();
+    }
+
+   private:
+    outcome::result<Input> find(const CID &key) const;
+
+    std::vector<CID> roots_;
+    std::unordered_map<CID, std::pair<uint64_t, uint64_t>> index_;
+    const uint8_t *data_{nullptr};
+    size_t size_{};
+  };
+}  // namespace fc::storage::car
+
+#endif  // CPP_FILECOIN_CORE_STORAGE_CAR_CAR_STORE_HPP
@@ -64,6 +64,18 @@ namespace fc::storage::blockchain {
     virtual outcome::result<void> updateHeaviestTipset(
         const Tipset &tipset) = 0;
 
+    /**
+     * @brief finds tipset at height on chain ending with given tipset
+     * @param tipset - last tipset of chain
+     * @param height - height to find
+     * @param prev - if height is null round, return last tipset before it
+     * instead of first tipset after it
+     * @return tipset at height or near null round
+     */
+    virtual outcome::result<Tipset> getTipsetByHeight(const Tipset &tipset,
+                                                      uint64_t height,
+                                                      bool prev) const = 0;
+
     inline auto genesisCid() const {
       OUTCOME_EXCEPT(cid, primitives::cid::getCidOfCbor(getGenesis()));
       return cid;
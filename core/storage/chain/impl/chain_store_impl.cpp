@@ -6,6 +6,7 @@
 #include "storage/chain/impl/chain_store_impl.hpp"
 
 #include "primitives/cid/cid_of_cbor.hpp"
+#include "storage/in_memory/in_memory_storage.hpp"
 
 namespace fc::storage::blockchain {
   /** types */
@@ -17,18 +18,53 @@ namespace fc::storage::blockchain {
   /** functions */
   using primitives::cid::getCidOfCbor;
 
+  /// Headers kept in graph below head, deeper forks are final
+  constexpr uint64_t kHeaderWindow{900};
+
+  /** @brief manifest key, outside of height keys range */
+  const common::Buffer kManifestKey{common::Buffer{}.put("manifest")};
+
+  /** @brief height index key, big endian to keep order */
+  common::Buffer heightKey(uint64_t height) {
+    return common::Buffer{}.put("height/").putUint64(height);
+  }
+
   ChainStoreImpl::ChainStoreImpl(
       IpldPtr ipld,
       std::shared_ptr<WeightCalculator> weight_calculator,
       BlockHeader genesis,
-      Tipset head)
+      Tipset head,
+      std::shared_ptr<PersistentBufferMap> height_index)
       : data_store_{std::move(ipld)},
         weight_calculator_{std::move(weight_calculator)},
         heaviest_tipset_{std::move(head)},
-        genesis_{std::move(genesis)} {
-    OUTCOME_EXCEPT(weight,
-                   weight_calculator_->calculateWeight(heaviest_tipset_));
-    heaviest_weight_ = weight;
+        genesis_{std::move(genesis)},
+        height_index_{std::move(height_index)} {
+    if (!height_index_) {
+      height_index_ = std::make_shared<InMemoryStorage>();
+    }
+    OUTCOME_EXCEPT(manifest, loadManifest(*height_index_));
+    if (manifest && manifest->head == heaviest_tipset_.cids) {
+      heaviest_weight_ = std::move(manifest->weight);
+    } else {
+      OUTCOME_EXCEPT(weight,
+                     weight_calculator_->calculateWeight(heaviest_tipset_));
+      heaviest_weight_ = weight;
+    }
+    addTipset(heaviest_tipset_);
+    // after restart only tipsets added since last run are written
+    OUTCOME_EXCEPT(indexChain(
+        heaviest_tipset_, heaviest_weight_, heaviest_tipset_.height));
+  }
+
+  outcome::result<boost::optional<ChainManifest>> ChainStoreImpl::loadManifest(
+      const PersistentBufferMap &height_index) {
+    if (!height_index.contains(kManifestKey)) {
+      return boost::none;
+    }
+    OUTCOME_TRY(value, height_index.get(kManifestKey));
+    OUTCOME_TRY(manifest, codec::cbor::decode<ChainManifest>(value));
+    return std::move(manifest);
   }
 
   const Tipset &ChainStoreImpl::heaviestTipset() const {
@@ -40,71 +76,119 @@ namespace fc::storage::blockchain {
   }
 
   outcome::result<void> ChainStoreImpl::addBlock(const BlockHeader &block) {
-    OUTCOME_TRY(data_store_->setCbor(block));
-    OUTCOME_TRY(tipset, expandTipset(block));
+    OUTCOME_TRY(cid, data_store_->setCbor(block));
+    addHeader(cid, block);
+    OUTCOME_TRY(tipset, expandTipset(cid, block));
     return updateHeaviestTipset(tipset);
   }
 
   outcome::result<Tipset> ChainStoreImpl::expandTipset(
-      const BlockHeader &block_header) {
+      const CID &block_cid, const BlockHeader &block_header) {
     std::vector<BlockHeader> all_headers{block_header};
+    std::vector<CID> all_cids{block_cid};
 
-    if (tipsets_.find(block_header.height) == std::end(tipsets_)) {
-      return Tipset::create(all_headers);
+    auto siblings = headers_by_height_.find(block_header.height);
+    if (siblings == headers_by_height_.end()) {
+      return Tipset::create(all_headers, all_cids);
     }
-    auto &&tipsets = tipsets_[block_header.height];
 
     std::set<Address> included_miners;
     included_miners.insert(block_header.miner);
 
-    OUTCOME_TRY(block_cid, getCidOfCbor(block_header));
-    for (auto &&cid : tipsets) {
+    for (auto &&cid : siblings->second) {
       if (cid == block_cid) {
         continue;
       }
 
-      OUTCOME_TRY(bh, data_store_->getCbor<BlockHeader>(cid));
+      auto &node = headers_.at(cid);
+      if (node.parents.cids != block_header.parents) {
+        continue;
+      }
 
-      if (included_miners.count(bh.miner) > 0) {
+      if (included_miners.count(node.miner) > 0) {
         logger_->warn(
             "Have multiple blocks from miner {} at height {} in our tipset "
             "cache",
-            bh.miner,
-            bh.height);
+            node.miner,
+            node.height);
         continue;
       }
 
-      if (bh.parents == block_header.parents) {
-        all_headers.push_back(bh);
-        included_miners.insert(bh.miner);
-      }
+      OUTCOME_TRY(bh, data_store_->getCbor<BlockHeader>(cid));
+      all_headers.push_back(std::move(bh));
+      all_cids.push_back(cid);
+      included_miners.insert(node.miner);
     }
 
-    return Tipset::create(all_headers);
+    return Tipset::create(all_headers, all_cids);
+  }
+
+  void ChainStoreImpl::addHeader(const CID &cid, const BlockHeader &header) {
+    auto inserted = headers_.emplace(cid,
+                                     HeaderNode{TipsetKey{header.parents},
+                                                header.height,
+                                                header.parent_weight,
+                                                header.timestamp,
+                                                header.miner});
+    if (inserted.second) {
+      headers_by_height_[header.height].push_back(cid);
+    }
+  }
+
+  void ChainStoreImpl::addTipset(const Tipset &tipset) {
+    for (size_t i = 0; i < tipset.cids.size(); ++i) {
+      addHeader(tipset.cids[i], tipset.blks[i]);
+    }
+  }
+
+  outcome::result<const ChainStoreImpl::HeaderNode *>
+  ChainStoreImpl::headerNode(const TipsetKey &key) {
+    auto it = headers_.find(key.cids[0]);
+    if (it == headers_.end()) {
+      // below window, walked once and pruned with next head
+      OUTCOME_TRY(tipset, Tipset::load(*data_store_, key.cids));
+      addTipset(tipset);
+      it = headers_.find(key.cids[0]);
+    }
+    return &it->second;
+  }
+
+  void ChainStoreImpl::pruneHeaders(uint64_t head_height) {
+    if (head_height < kHeaderWindow) {
+      return;
+    }
+    auto end = headers_by_height_.lower_bound(head_height - kHeaderWindow);
+    for (auto it = headers_by_height_.begin(); it != end; ++it) {
+      for (auto &cid : it->second) {
+        headers_.erase(cid);
+      }
+    }
+    headers_by_height_.erase(headers_by_height_.begin(), end);
   }
 
   outcome::result<void> ChainStoreImpl::updateHeaviestTipset(
       const Tipset &tipset) {
     OUTCOME_TRY(weight, weight_calculator_->calculateWeight(tipset));
 
-    OUTCOME_TRY(current_weight,
-                weight_calculator_->calculateWeight(heaviest_tipset_));
-
-    if (weight > current_weight) {
-      return takeHeaviestTipset(tipset);
+    // weight of heaviest tipset is kept, so it is not computed again
+    if (weight > heaviest_weight_) {
+      return takeHeaviestTipset(tipset, std::move(weight));
     }
 
     return outcome::success();
   }
 
   outcome::result<void> ChainStoreImpl::takeHeaviestTipset(
-      const Tipset &tipset) {
+      const Tipset &tipset, primitives::BigInt weight) {
     logger_->info("New heaviest tipset {} (height={})",
                   fmt::join(tipset.cids, ","),
                   tipset.height);
 
+    OUTCOME_TRY(indexChain(tipset, weight, heaviest_tipset_.height));
     OUTCOME_TRY(notifyHeadChange(heaviest_tipset_, tipset));
     heaviest_tipset_ = tipset;
+    heaviest_weight_ = std::move(weight);
+    pruneHeaders(heaviest_tipset_.height);
 
     return outcome::success();
   }
@@ -128,24 +212,149 @@ namespace fc::storage::blockchain {
 
   outcome::result<ChainPath> ChainStoreImpl::findChainPath(
       const Tipset &current, const Tipset &target) {
-    ChainPath path{};
-    auto l = current;
-    auto r = target;
+    addTipset(target);
+    // common ancestor is found in header graph, so only tipsets on path are
+    // loaded
+    TipsetKey l{current.cids}, r{target.cids};
+    auto l_height = current.height, r_height = target.height;
+    std::vector<TipsetKey> revert, apply;
+    auto step = [&](TipsetKey &key,
+                    uint64_t &height) -> outcome::result<void> {
+      OUTCOME_TRY(node, headerNode(key));
+      key = node->parents;
+      OUTCOME_TRY(parent, headerNode(key));
+      height = parent->height;
+      return outcome::success();
+    };
     while (l != r) {
-      if (l.height == 0 && r.height == 0) {
+      if (l_height == 0 && r_height == 0) {
         return ChainStoreError::kNoPath;
       }
-      if (l.height > r.height) {
-        path.revert_chain.emplace_back(l);
-        OUTCOME_TRYA(l, l.loadParent(*data_store_));
+      if (l_height > r_height) {
+        revert.push_back(l);
+        OUTCOME_TRY(step(l, l_height));
       } else {
-        path.apply_chain.emplace_front(r);
-        OUTCOME_TRYA(r, r.loadParent(*data_store_));
+        apply.push_back(r);
+        OUTCOME_TRY(step(r, r_height));
       }
     }
+    ChainPath path{};
+    auto load = [&](const TipsetKey &key) -> outcome::result<Tipset> {
+      if (key.cids == current.cids) {
+        return current;
+      }
+      if (key.cids == target.cids) {
+        return target;
+      }
+      return Tipset::load(*data_store_, key.cids);
+    };
+    for (auto &key : revert) {
+      OUTCOME_TRY(ts, load(key));
+      path.revert_chain.push_back(std::move(ts));
+    }
+    for (auto &key : apply) {
+      OUTCOME_TRY(ts, load(key));
+      path.apply_chain.push_front(std::move(ts));
+    }
     return path;
   }
 
+  outcome::result<Tipset> ChainStoreImpl::getTipsetByHeight(
+      const Tipset &tipset, uint64_t height, bool prev) const {
+    if (height > tipset.height) {
+      return ChainStoreError::kNoHeight;
+    }
+    // walk fork down to heaviest chain
+    auto ts{tipset};
+    while (ts.height > height) {
+      OUTCOME_TRY(indexed, isIndexed(ts));
+      if (indexed) {
+        break;
+      }
+      OUTCOME_TRY(parent, ts.loadParent(*data_store_));
+      if (parent.height < height) {
+        return prev ? parent : ts;
+      }
+      ts = std::move(parent);
+    }
+    if (ts.height == height) {
+      return ts;
+    }
+
+    auto lookup{height};
+    while (true) {
+      OUTCOME_TRY(indexed, loadIndexed(lookup));
+      if (indexed) {
+        return std::move(*indexed);
+      }
+      if (prev) {
+        if (lookup == 0) {
+          return ChainStoreError::kNoHeight;
+        }
+        --lookup;
+      } else {
+        if (lookup >= ts.height) {
+          return ChainStoreError::kNoHeight;
+        }
+        ++lookup;
+      }
+    }
+  }
+
+  outcome::result<void> ChainStoreImpl::indexChain(
+      const Tipset &head,
+      const primitives::BigInt &weight,
+      uint64_t old_height) {
+    auto batch{height_index_->batch()};
+    OUTCOME_TRY(manifest,
+                codec::cbor::encode(ChainManifest{head.cids, weight}));
+    OUTCOME_TRY(batch->put(kManifestKey, std::move(manifest)));
+    for (auto height{head.height + 1}; height <= old_height; ++height) {
+      OUTCOME_TRY(batch->remove(heightKey(height)));
+    }
+    auto ts{head};
+    while (true) {
+      OUTCOME_TRY(indexed, isIndexed(ts));
+      if (indexed) {
+        break;
+      }
+      OUTCOME_TRY(value, codec::cbor::encode(ts.cids));
+      OUTCOME_TRY(batch->put(heightKey(ts.height), std::move(value)));
+      if (ts.height == 0) {
+        break;
+      }
+      OUTCOME_TRY(parent, ts.loadParent(*data_store_));
+      // null rounds
+      for (auto height{parent.height + 1}; height < ts.height; ++height) {
+        OUTCOME_TRY(batch->remove(heightKey(height)));
+      }
+      ts = std::move(parent);
+    }
+    return batch->commit();
+  }
+
+  outcome::result<bool> ChainStoreImpl::isIndexed(const Tipset &tipset) const {
+    auto key{heightKey(tipset.height)};
+    if (!height_index_->contains(key)) {
+      return false;
+    }
+    OUTCOME_TRY(value, height_index_->get(key));
+    OUTCOME_TRY(cids, codec::cbor::decode<std::vector<CID>>(value));
+    return cids == tipset.cids;
+  }
+
+  outcome::result<boost::optional<Tipset>> ChainStoreImpl::loadIndexed(
+      uint64_t height) const {
+    auto key{heightKey(height)};
+    if (!height_index_->contains(key)) {
+      return boost::none;
+    }
+    OUTCOME_TRY(value, height_index_->get(key));
+    OUTCOME_TRY(cids, codec::cbor::decode<std::vector<CID>>(value));
+    OUTCOME_TRY(tipset, Tipset::load(*data_store_, cids));
+    return std::move(tipset);
+  }
+
 }  // namespace fc::storage::blockchain
 
 OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::blockchain, ChainStoreError, e) {
@@ -153,6 +362,8 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::blockchain, ChainStoreError, e) {
   switch (e) {
     case ChainStoreError::kNoPath:
       return "no path";
+    case ChainStoreError::kNoHeight:
+      return "no tipset at height";
   }
   return "ChainStoreError: unknown error";
 }
@@ -9,21 +9,44 @@
 #include <map>
 
 #include "blockchain/weight_calculator.hpp"
+#include "codec/cbor/streams_annotation.hpp"
 #include "common/logger.hpp"
+#include "storage/buffer_map.hpp"
 #include "storage/chain/chain_store.hpp"
 
 namespace fc::storage::blockchain {
   using ::fc::blockchain::weight::WeightCalculator;
   using ipfs::IpfsDatastore;
+  using primitives::address::Address;
 
-  enum class ChainStoreError { kNoPath = 1 };
+  enum class ChainStoreError { kNoPath = 1, kNoHeight };
+
+  /**
+   * Heaviest tipset and its weight, written with height index, so restart
+   * finds head without scanning and doesn't compute its weight from state
+   */
+  struct ChainManifest {
+    std::vector<CID> head;
+    primitives::BigInt weight;
+  };
+  CBOR_TUPLE(ChainManifest, head, weight)
 
   class ChainStoreImpl : public ChainStore {
    public:
+    /**
+     * @param height_index - persisted height to tipset key index of heaviest
+     * chain and chain manifest, kept in memory if not set
+     * @param head - weight is taken from manifest if it is manifest head
+     */
     ChainStoreImpl(IpldPtr ipld,
                    std::shared_ptr<WeightCalculator> weight_calculator,
                    BlockHeader genesis,
-                   Tipset head);
+                   Tipset head,
+                   std::shared_ptr<PersistentBufferMap> height_index = nullptr);
+
+    /// Manifest written by last run, none on first start
+    static outcome::result<boost::optional<ChainManifest>> loadManifest(
+        const PersistentBufferMap &height_index);
 
     outcome::result<void> addBlock(const BlockHeader &block) override;
 
@@ -45,15 +68,62 @@ namespace fc::storage::blockchain {
 
     outcome::result<void> updateHeaviestTipset(const Tipset &tipset) override;
 
+    outcome::result<Tipset> getTipsetByHeight(const Tipset &tipset,
+                                              uint64_t height,
+                                              bool prev) const override;
+
    private:
+    /**
+     * @brief indexes heaviest chain down to first already indexed tipset
+     * and writes manifest of head with same batch
+     * @param head new heaviest tipset
+     * @param weight weight of head
+     * @param old_height height of previous heaviest tipset
+     */
+    outcome::result<void> indexChain(const Tipset &head,
+                                     const primitives::BigInt &weight,
+                                     uint64_t old_height);
+
+    /** @brief checks if tipset is indexed as part of heaviest chain */
+    outcome::result<bool> isIndexed(const Tipset &tipset) const;
+
+    /** @brief loads indexed tipset, none if height is null round */
+    outcome::result<boost::optional<Tipset>> loadIndexed(
+        uint64_t height) const;
+
     /**
      * @brief applies new heaviest tipset if better than old item
      * @param tipset new heaviest tipset
+     * @param weight weight of new heaviest tipset
+     */
+    outcome::result<void> takeHeaviestTipset(const Tipset &tipset,
+                                             primitives::BigInt weight);
+
+    /**
+     * @brief finds and returns tipset containing given block header, siblings
+     * are matched in header graph and only matching ones are loaded
      */
-    outcome::result<void> takeHeaviestTipset(const Tipset &tipset);
+    outcome::result<Tipset> expandTipset(const CID &block_cid,
+                                         const BlockHeader &block_header);
+
+    /// Header fields needed to walk chain without loading headers
+    struct HeaderNode {
+      TipsetKey parents;
+      uint64_t height;
+      primitives::BigInt parent_weight;
+      uint64_t timestamp;
+      Address miner;
+    };
+
+    void addHeader(const CID &cid, const BlockHeader &header);
+
+    void addTipset(const Tipset &tipset);
+
+    /// Graph node of first block of tipset, tipset is loaded if not in graph
+    outcome::result<const HeaderNode *> headerNode(const TipsetKey &key);
 
-    /** @brief finds and returns tipset containing given block header */
-    outcome::result<Tipset> expandTipset(const BlockHeader &block_header);
+    /// Drops headers below window under head from graph
+    void pruneHeaders(uint64_t head_height);
 
     /**
      * @brief finds path from current tipset to new tipset
@@ -79,7 +149,10 @@ namespace fc::storage::blockchain {
     Tipset heaviest_tipset_;                 ///< current heaviest tipset
     primitives::BigInt heaviest_weight_{0};  ///< current heaviest weight
     BlockHeader genesis_;                    ///< genesis block
-    std::unordered_map<uint64_t, std::vector<CID>> tipsets_;
+    /// Header graph of unfinalized window, reorgs are walked in memory
+    std::unordered_map<CID, HeaderNode> headers_;
+    std::map<uint64_t, std::vector<CID>> headers_by_height_;
+    std::shared_ptr<PersistentBufferMap> height_index_;
 
     ///< when head tipset changes, need to notify all subscribers
     boost::signals2::signal<HeadChangeSignature> head_change_signal_;
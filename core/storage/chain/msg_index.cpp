@@ -0,0 +1,226 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/chain/msg_index.hpp"
+
+#include <set>
+
+#include "adt/array.hpp"
+#include "primitives/address/address_codec.hpp"
+
+namespace fc::storage::blockchain {
+  using vm::message::SignedMessage;
+  using vm::message::UnsignedMessage;
+
+  namespace {
+    constexpr uint8_t kMessagePrefix{'m'};
+    constexpr uint8_t kAddressPrefix{'a'};
+    constexpr uint8_t kTipsetPrefix{'t'};
+
+    Buffer messageKey(const CID &cid) {
+      Buffer key{kMessagePrefix};
+      key.put(cid.toBytes().value());
+      return key;
+    }
+
+    constexpr size_t kUint64Size{8};
+
+    /// Encoded addresses are prefix-free, so prefix selects single address
+    Buffer addressPrefix(const Address &address, MsgRole role) {
+      Buffer key{kAddressPrefix, static_cast<uint8_t>(role)};
+      key.put(primitives::address::encode(address));
+      return key;
+    }
+
+    /// Big-endian keeps keys of address ordered by height and position
+    void putUint64(Buffer &key, uint64_t value) {
+      for (auto shift{56}; shift >= 0; shift -= 8) {
+        key.putUint8(value >> shift);
+      }
+    }
+
+    uint64_t getUint64(gsl::span<const uint8_t> bytes) {
+      uint64_t value{0};
+      for (size_t i{0}; i < kUint64Size; ++i) {
+        value = (value << 8) | bytes[i];
+      }
+      return value;
+    }
+
+    Buffer addressKey(const Address &address,
+                      MsgRole role,
+                      ChainEpoch height,
+                      uint64_t position,
+                      const CID &cid) {
+      auto key{addressPrefix(address, role)};
+      putUint64(key, height);
+      putUint64(key, position);
+      key.put(cid.toBytes().value());
+      return key;
+    }
+
+    /// Visits messages of tipset with sender and recipient
+    outcome::result<void> visitAddresses(
+        IpldPtr ipld,
+        const Tipset &tipset,
+        const std::function<outcome::result<void>(
+            size_t, const CID &, const UnsignedMessage &)> &visitor) {
+      return tipset.visitMessages(
+          ipld, [&](auto i, auto bls, auto &cid) -> outcome::result<void> {
+            if (bls) {
+              OUTCOME_TRY(message, ipld->getCbor<UnsignedMessage>(cid));
+              return visitor(i, cid, message);
+            }
+            OUTCOME_TRY(message, ipld->getCbor<SignedMessage>(cid));
+            return visitor(i, cid, message.message);
+          });
+    }
+  }  // namespace
+
+  MsgIndex::MsgIndex(IpldPtr ipld, std::shared_ptr<PersistentBufferMap> store)
+      : ipld_{std::move(ipld)}, store_{std::move(store)} {}
+
+  outcome::result<Buffer> MsgIndex::tipsetKey(const Tipset &tipset) const {
+    Buffer key{kTipsetPrefix};
+    OUTCOME_TRY(cids, codec::cbor::encode(tipset.cids));
+    key.put(cids);
+    return key;
+  }
+
+  outcome::result<void> MsgIndex::apply(const Tipset &tipset,
+                                        const Visitor &visitor) {
+    OUTCOME_TRY(parent, tipset.loadParent(*ipld_));
+    OUTCOME_TRY(tipset_key, tipsetKey(tipset));
+    MsgIndexEntry entry{tipset.cids,
+                        tipset.getParentMessageReceipts(),
+                        0,
+                        static_cast<ChainEpoch>(parent.height)};
+    std::vector<std::pair<CID, MsgIndexEntry>> applied;
+    auto batch{store_->batch()};
+    OUTCOME_TRY(visitAddresses(
+        ipld_,
+        parent,
+        [&](auto i, auto &cid, auto &message) -> outcome::result<void> {
+          entry.index = i;
+          OUTCOME_TRY(value, codec::cbor::encode(entry));
+          OUTCOME_TRY(batch->put(messageKey(cid), Buffer{value}));
+          OUTCOME_TRY(batch->put(
+              addressKey(message.from, MsgRole::kFrom, entry.height, i, cid),
+              Buffer{}));
+          OUTCOME_TRY(batch->put(
+              addressKey(message.to, MsgRole::kTo, entry.height, i, cid),
+              Buffer{}));
+          applied.emplace_back(cid, entry);
+          return outcome::success();
+        }));
+    OUTCOME_TRY(batch->put(tipset_key, Buffer{1}));
+    OUTCOME_TRY(batch->commit());
+    if (visitor) {
+      for (auto &[cid, entry] : applied) {
+        visitor(cid, entry);
+      }
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> MsgIndex::revert(const Tipset &tipset) {
+    OUTCOME_TRY(parent, tipset.loadParent(*ipld_));
+    OUTCOME_TRY(tipset_key, tipsetKey(tipset));
+    ChainEpoch height = parent.height;
+    auto batch{store_->batch()};
+    OUTCOME_TRY(visitAddresses(
+        ipld_,
+        parent,
+        [&](auto i, auto &cid, auto &message) -> outcome::result<void> {
+          OUTCOME_TRY(batch->remove(messageKey(cid)));
+          OUTCOME_TRY(batch->remove(
+              addressKey(message.from, MsgRole::kFrom, height, i, cid)));
+          OUTCOME_TRY(batch->remove(
+              addressKey(message.to, MsgRole::kTo, height, i, cid)));
+          return outcome::success();
+        }));
+    OUTCOME_TRY(batch->remove(tipset_key));
+    return batch->commit();
+  }
+
+  bool MsgIndex::applied(const Tipset &tipset) const {
+    auto key{tipsetKey(tipset)};
+    return key && store_->contains(key.value());
+  }
+
+  outcome::result<boost::optional<MsgIndexEntry>> MsgIndex::find(
+      const CID &cid) const {
+    auto key{messageKey(cid)};
+    if (!store_->contains(key)) {
+      return boost::none;
+    }
+    OUTCOME_TRY(value, store_->get(key));
+    OUTCOME_TRY(entry, codec::cbor::decode<MsgIndexEntry>(value));
+    return std::move(entry);
+  }
+
+  outcome::result<MessageReceipt> MsgIndex::receipt(
+      const MsgIndexEntry &entry) const {
+    adt::Array<MessageReceipt> receipts{entry.receipts, ipld_};
+    return receipts.get(entry.index);
+  }
+
+  outcome::result<std::vector<MsgAddressEntry>> MsgIndex::byAddress(
+      const Address &address,
+      MsgRole role,
+      ChainEpoch from,
+      ChainEpoch to) const {
+    auto prefix{addressPrefix(address, role)};
+    auto start{prefix};
+    putUint64(start, std::max(from, ChainEpoch{0}));
+    std::vector<MsgAddressEntry> entries;
+    auto cursor{store_->cursor()};
+    for (cursor->seek(start); cursor->isValid(); cursor->next()) {
+      auto key{cursor->key()};
+      if (key.size() < prefix.size() + 2 * kUint64Size
+          || !std::equal(prefix.begin(), prefix.end(), key.begin())) {
+        break;
+      }
+      auto bytes{gsl::make_span(key).subspan(prefix.size())};
+      ChainEpoch height = getUint64(bytes);
+      if (height > to) {
+        break;
+      }
+      auto position{getUint64(bytes.subspan(kUint64Size))};
+      OUTCOME_TRY(cid, CID::fromBytes(bytes.subspan(2 * kUint64Size)));
+      entries.push_back({height, position, std::move(cid)});
+    }
+    return entries;
+  }
+
+  outcome::result<std::vector<CID>> MsgIndex::list(const Address &sender,
+                                                   const Address &recipient,
+                                                   ChainEpoch from,
+                                                   ChainEpoch to) const {
+    OUTCOME_TRY(received, byAddress(recipient, MsgRole::kTo, from, to));
+    OUTCOME_TRY(sent, byAddress(sender, MsgRole::kFrom, from, to));
+    std::set<CID> sent_cids;
+    for (auto &entry : sent) {
+      sent_cids.insert(entry.cid);
+    }
+    std::vector<CID> cids;
+    // heights from top, position order inside height
+    auto end{received.end()};
+    while (end != received.begin()) {
+      auto begin{std::prev(end)};
+      while (begin != received.begin()
+             && std::prev(begin)->height == begin->height) {
+        --begin;
+      }
+      for (auto it{begin}; it != end; ++it) {
+        if (sent_cids.count(it->cid) != 0) {
+          cids.push_back(it->cid);
+        }
+      }
+      end = begin;
+    }
+    return cids;
+  }
+}  // namespace fc::storage::blockchain
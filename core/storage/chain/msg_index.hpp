@@ -0,0 +1,103 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_STORAGE_CHAIN_MSG_INDEX_HPP
+#define CPP_FILECOIN_CORE_STORAGE_CHAIN_MSG_INDEX_HPP
+
+#include "codec/cbor/streams_annotation.hpp"
+#include "primitives/tipset/tipset.hpp"
+#include "storage/buffer_map.hpp"
+#include "vm/runtime/runtime_types.hpp"
+
+namespace fc::storage::blockchain {
+  using primitives::ChainEpoch;
+  using primitives::address::Address;
+  using primitives::tipset::Tipset;
+  using primitives::tipset::TipsetKey;
+  using vm::runtime::MessageReceipt;
+
+  /// Where message was executed
+  struct MsgIndexEntry {
+    /// Child tipset of tipset including message, has message receipts
+    std::vector<CID> tipset;
+    CID receipts;
+    uint64_t index{};
+    /// Height of tipset including message
+    ChainEpoch height{};
+  };
+  CBOR_TUPLE(MsgIndexEntry, tipset, receipts, index, height)
+
+  /// Role of address in message
+  enum class MsgRole : uint8_t {
+    kFrom = 'f',
+    kTo = 't',
+  };
+
+  /// Message of address, position is index of message in its tipset
+  struct MsgAddressEntry {
+    ChainEpoch height{};
+    uint64_t position{};
+    CID cid;
+  };
+
+  /**
+   * Persistent index of messages executed on current chain.
+   * Maps message cid to receipt position, and sender and recipient address
+   * to message cids ordered by height and position in tipset.
+   * Tipset is applied when its child is, so its messages have receipts.
+   */
+  class MsgIndex {
+   public:
+    using Visitor =
+        std::function<void(const CID &, const MsgIndexEntry &)>;
+
+    MsgIndex(IpldPtr ipld, std::shared_ptr<PersistentBufferMap> store);
+
+    /**
+     * Index messages of parent of tipset.
+     * @param visitor - called for each indexed message
+     */
+    outcome::result<void> apply(const Tipset &tipset, const Visitor &visitor);
+
+    /// Remove messages of parent of tipset
+    outcome::result<void> revert(const Tipset &tipset);
+
+    /// Whether messages of parent of tipset are indexed
+    bool applied(const Tipset &tipset) const;
+
+    outcome::result<boost::optional<MsgIndexEntry>> find(const CID &cid) const;
+
+    /// Receipt of indexed message
+    outcome::result<MessageReceipt> receipt(const MsgIndexEntry &entry) const;
+
+    /**
+     * Messages with address in role, with height in [from, to]
+     * @return messages by ascending height, then position in tipset
+     */
+    outcome::result<std::vector<MsgAddressEntry>> byAddress(
+        const Address &address,
+        MsgRole role,
+        ChainEpoch from,
+        ChainEpoch to) const;
+
+    /**
+     * Messages from sender to recipient with height in [from, to], same as
+     * walk of chain from tipset at height to
+     * @return messages by descending height, then position in tipset
+     */
+    outcome::result<std::vector<CID>> list(const Address &sender,
+                                           const Address &recipient,
+                                           ChainEpoch from,
+                                           ChainEpoch to) const;
+
+   private:
+    outcome::result<Buffer> tipsetKey(const Tipset &tipset) const;
+
+    IpldPtr ipld_;
+    std::shared_ptr<PersistentBufferMap> store_;
+  };
+}  // namespace fc::storage::blockchain
+
+#endif  // CPP_FILECOIN_CORE_STORAGE_CHAIN_MSG_INDEX_HPP
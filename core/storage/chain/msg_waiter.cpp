@@ -4,17 +4,22 @@
  */
 
 #include "storage/chain/msg_waiter.hpp"
-#include "adt/array.hpp"
 #include "common/logger.hpp"
+#include "storage/in_memory/in_memory_storage.hpp"
 
 namespace fc::storage::blockchain {
-  using primitives::tipset::MessageVisitor;
 
-  MsgWaiter::MsgWaiter(IpldPtr ipld) : ipld{ipld} {}
+  MsgWaiter::MsgWaiter(IpldPtr ipld,
+                       std::shared_ptr<PersistentBufferMap> store)
+      : ipld{ipld},
+        index{std::make_shared<MsgIndex>(
+            ipld, store ? store : std::make_shared<InMemoryStorage>())} {}
 
   std::shared_ptr<MsgWaiter> MsgWaiter::create(
-      IpldPtr ipld, std::shared_ptr<ChainStore> chain_store) {
-    auto waiter{std::make_shared<MsgWaiter>(ipld)};
+      IpldPtr ipld,
+      std::shared_ptr<ChainStore> chain_store,
+      std::shared_ptr<PersistentBufferMap> store) {
+    auto waiter{std::make_shared<MsgWaiter>(ipld, store)};
     waiter->head_sub = chain_store->subscribeHeadChanges([=](auto &change) {
       auto res{waiter->onHeadChange(change)};
       if (!res) {
@@ -27,44 +32,50 @@ namespace fc::storage::blockchain {
   }
 
   outcome::result<void> MsgWaiter::onHeadChange(const HeadChange &change) {
-    auto onTipset = [&](auto &ts, auto apply) -> outcome::result<Tipset> {
-      OUTCOME_TRY(parent, ts.loadParent(*ipld));
-      OUTCOME_TRY(key, ts.makeKey());
-      adt::Array<MessageReceipt> receipts{ts.getParentMessageReceipts(), ipld};
-      OUTCOME_TRY(parent.visitMessages(
-          ipld, [&](auto i, auto, auto &cid) -> outcome::result<void> {
-            if (apply) {
-              OUTCOME_TRY(receipt, receipts.get(i));
-              auto result{results.emplace(cid, std::make_pair(receipt, key))};
-              auto callbacks{waiting.find(cid)};
-              if (callbacks != waiting.end()) {
-                for (auto &callback : callbacks->second) {
-                  callback(result.first->second);
-                }
-                waiting.erase(cid);
-              }
-            } else {
-              results.erase(cid);
-            }
-            return outcome::success();
-          }));
-      return std::move(parent);
-    };
+    auto onApply{[&](auto &cid, auto &entry) {
+      auto callbacks{waiting.find(cid)};
+      if (callbacks == waiting.end()) {
+        return;
+      }
+      auto receipt{index->receipt(entry)};
+      if (!receipt) {
+        return;
+      }
+      Result result{receipt.value(), TipsetKey{entry.tipset}};
+      for (auto &callback : callbacks->second) {
+        callback(result);
+      }
+      waiting.erase(callbacks);
+    }};
     if (change.type == HeadChangeType::CURRENT) {
+      // persisted index is already applied below first indexed tipset
       auto ts{change.value};
-      while (ts.height > 0) {
-        OUTCOME_TRYA(ts, onTipset(ts, true));
+      while (ts.height > 0 && !index->applied(ts)) {
+        OUTCOME_TRY(index->apply(ts, onApply));
+        OUTCOME_TRYA(ts, ts.loadParent(*ipld));
       }
+    } else if (change.type == HeadChangeType::APPLY) {
+      OUTCOME_TRY(index->apply(change.value, onApply));
     } else {
-      OUTCOME_TRY(onTipset(change.value, change.type == HeadChangeType::APPLY));
+      OUTCOME_TRY(index->revert(change.value));
     }
     return outcome::success();
   }
 
+  outcome::result<boost::optional<MsgWaiter::Result>> MsgWaiter::find(
+      const CID &cid) const {
+    OUTCOME_TRY(entry, index->find(cid));
+    if (!entry) {
+      return boost::none;
+    }
+    OUTCOME_TRY(receipt, index->receipt(*entry));
+    return Result{std::move(receipt), TipsetKey{std::move(entry->tipset)}};
+  }
+
   void MsgWaiter::wait(const CID &cid, const Callback &callback) {
-    auto result{results.find(cid)};
-    if (result != results.end()) {
-      callback(result->second);
+    auto result{find(cid)};
+    if (result && result.value()) {
+      callback(*result.value());
     } else {
       waiting[cid].push_back(callback);
     }
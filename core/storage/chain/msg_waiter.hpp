@@ -7,24 +7,28 @@
 #define CPP_FILECOIN_CORE_STORAGE_CHAIN_MSG_WAITER_HPP
 
 #include "storage/chain/chain_store.hpp"
-#include "vm/runtime/runtime_types.hpp"
+#include "storage/chain/msg_index.hpp"
 
 namespace fc::storage::blockchain {
-  using vm::runtime::MessageReceipt;
-
   struct MsgWaiter : public std::enable_shared_from_this<MsgWaiter> {
     using Result = std::pair<MessageReceipt, TipsetKey>;
     using Callback = std::function<void(const Result &)>;
 
-    explicit MsgWaiter(IpldPtr ipld);
+    /// Index is kept in store, in memory if store is null
+    explicit MsgWaiter(IpldPtr ipld,
+                       std::shared_ptr<PersistentBufferMap> store = nullptr);
     static std::shared_ptr<MsgWaiter> create(
-        IpldPtr ipld, std::shared_ptr<ChainStore> chain_store);
+        IpldPtr ipld,
+        std::shared_ptr<ChainStore> chain_store,
+        std::shared_ptr<PersistentBufferMap> store = nullptr);
     outcome::result<void> onHeadChange(const HeadChange &change);
+    /// Receipt of message executed on current chain
+    outcome::result<boost::optional<Result>> find(const CID &cid) const;
     void wait(const CID &cid, const Callback &callback);
 
     IpldPtr ipld;
+    std::shared_ptr<MsgIndex> index;
     ChainStore::connection_t head_sub;
-    std::map<CID, Result> results;
     std::map<CID, std::vector<Callback>> waiting;
   };
 }  // namespace fc::storage::blockchain
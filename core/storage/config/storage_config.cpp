@@ -0,0 +1,93 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/config/storage_config.hpp"
+
+#include <boost/filesystem.hpp>
+
+namespace fc::storage::config {
+  template <typename T>
+  void loadOption(Config &config, const ConfigKey &key, T &value) {
+    if (auto loaded = config.get<T>(key)) {
+      value = loaded.value();
+    }
+  }
+
+  void LevelDBProfile::load(Config &config, const ConfigKey &prefix) {
+    loadOption(config, prefix + ".bloom_bits_per_key", bloom_bits_per_key);
+    loadOption(config, prefix + ".block_cache_size", block_cache_size);
+    loadOption(config, prefix + ".write_buffer_size", write_buffer_size);
+    loadOption(config, prefix + ".compression", compression);
+  }
+
+  void MmapProfile::load(Config &config, const ConfigKey &prefix) {
+    loadOption(config, prefix + ".map_size", map_size);
+    loadOption(config, prefix + ".sync", sync);
+    loadOption(config, prefix + ".sync_bytes", sync_bytes);
+  }
+
+  outcome::result<std::shared_ptr<LevelDB>> LevelDBProfile::open(
+      std::string_view path, leveldb::Options options) const {
+    std::unique_ptr<const leveldb::FilterPolicy> filter_policy;
+    if (bloom_bits_per_key > 0) {
+      filter_policy.reset(leveldb::NewBloomFilterPolicy(bloom_bits_per_key));
+    }
+    std::unique_ptr<leveldb::Cache> block_cache;
+    if (block_cache_size > 0) {
+      block_cache.reset(leveldb::NewLRUCache(block_cache_size));
+    }
+    options.write_buffer_size = write_buffer_size;
+    options.compression =
+        compression ? leveldb::kSnappyCompression : leveldb::kNoCompression;
+    return LevelDB::create(
+        path, options, std::move(filter_policy), std::move(block_cache));
+  }
+
+  StorageConfig StorageConfig::load(Config &config) {
+    StorageConfig storage;
+    loadOption(config, "storage.blocks.backend", storage.blocks_backend);
+    storage.blocks.load(config, "storage.blocks");
+    storage.blocks_mmap.load(config, "storage.blocks_mmap");
+    storage.indexes.load(config, "storage.indexes");
+    storage.market.load(config, "storage.market");
+    return storage;
+  }
+
+  outcome::result<Stores> Stores::open(const std::string &path,
+                                       const StorageConfig &config,
+                                       leveldb::Options options) {
+    boost::filesystem::create_directories(path);
+    auto dir{boost::filesystem::path{path}};
+    Stores stores;
+    OUTCOME_TRYA(stores.indexes,
+                 config.indexes.open((dir / "indexes").string(), options));
+    OUTCOME_TRYA(stores.market,
+                 config.market.open((dir / "market").string(), options));
+    return std::move(stores);
+  }
+
+  std::vector<std::pair<std::string, std::shared_ptr<LevelDB>>>
+  Stores::named() const {
+    std::vector<std::pair<std::string, std::shared_ptr<LevelDB>>> stores;
+    for (auto &[name, store] : {std::make_pair("blocks", blocks),
+                                std::make_pair("indexes", indexes),
+                                std::make_pair("market", market)}) {
+      if (store) {
+        stores.emplace_back(name, store);
+      }
+    }
+    return stores;
+  }
+
+  std::map<std::string, std::string> Stores::stats() const {
+    std::map<std::string, std::string> stats;
+    for (auto &[name, store] : named()) {
+      if (auto value = store->property("leveldb.stats")) {
+        stats.emplace(name, *value);
+      }
+    }
+    return stats;
+  }
+}  // namespace fc::storage::config
@@ -0,0 +1,124 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_STORAGE_CONFIG_STORAGE_CONFIG_HPP
+#define CPP_FILECOIN_CORE_STORAGE_CONFIG_STORAGE_CONFIG_HPP
+
+#include <map>
+
+#include "storage/config/config.hpp"
+#include "storage/leveldb/leveldb.hpp"
+
+namespace fc::storage::config {
+
+  /**
+   * @brief Tunable settings of single leveldb instance
+   */
+  struct LevelDBProfile {
+    /// Bloom filter bits per key, zero disables filter
+    int bloom_bits_per_key{10};
+    /// Block cache size in bytes, zero for leveldb default 8MB cache
+    size_t block_cache_size{};
+    /// Memtable size in bytes
+    size_t write_buffer_size{4 << 20};
+    /// Compress blocks with snappy
+    bool compression{true};
+
+    /**
+     * @brief Read "<prefix>.<option>" overrides from config
+     * @param config - node config
+     * @param prefix - profile key prefix
+     */
+    void load(Config &config, const ConfigKey &prefix);
+
+    /**
+     * @brief Open leveldb with profile settings applied over options
+     * @param path - database directory
+     * @param options - base options, e.g. create_if_missing
+     * @return leveldb instance or error
+     */
+    outcome::result<std::shared_ptr<LevelDB>> open(
+        std::string_view path, leveldb::Options options) const;
+  };
+
+  /**
+   * @brief Settings of memory-mapped blocks store
+   */
+  struct MmapProfile {
+    /// Address space reserved for blocks file, limits its size
+    uint64_t map_size{uint64_t{1} << 40};
+    /// Sync file and its index to disk
+    bool sync{true};
+    /// Appended bytes between syncs, lost if machine crashes
+    uint64_t sync_bytes{16 << 20};
+
+    /**
+     * @brief Read "<prefix>.<option>" overrides from config
+     * @param config - node config
+     * @param prefix - profile key prefix
+     */
+    void load(Config &config, const ConfigKey &prefix);
+  };
+
+  /**
+   * @brief Storage configuration, each store is separate leveldb instance
+   * with own profile, so keyspaces do not share caches and compactions
+   */
+  struct StorageConfig {
+    inline static const std::string kLevelDBBackend{"leveldb"};
+    inline static const std::string kMmapBackend{"mmap"};
+
+    /// Backend of ipld blocks store, kLevelDBBackend or kMmapBackend
+    std::string blocks_backend{kLevelDBBackend};
+    /// Ipld blocks, mostly random point lookups of missing cids
+    LevelDBProfile blocks{10, 256 << 20, 64 << 20, true};
+    /// Ipld blocks with mmap backend
+    MmapProfile blocks_mmap;
+    /// Chain indexes and interpreter results
+    LevelDBProfile indexes{10, 32 << 20, 16 << 20, true};
+    /// Market deals and piece metadata
+    LevelDBProfile market{10, 8 << 20, 4 << 20, true};
+
+    /**
+     * @brief Read "storage.blocks.*", "storage.blocks_mmap.*",
+     * "storage.indexes.*" and "storage.market.*" overrides from config
+     * @param config - node config
+     * @return config with defaults for absent keys
+     */
+    static StorageConfig load(Config &config);
+  };
+
+  /**
+   * @brief Opened stores of storage config
+   */
+  struct Stores {
+    /// Set by repository when blocks backend is leveldb
+    std::shared_ptr<LevelDB> blocks;
+    std::shared_ptr<LevelDB> indexes;
+    std::shared_ptr<LevelDB> market;
+
+    /**
+     * @brief Open stores in "indexes" and "market" subdirectories, blocks
+     * store is opened by repository with configured backend
+     * @param path - storage directory
+     * @param config - storage config
+     * @param options - base leveldb options
+     * @return stores or error
+     */
+    static outcome::result<Stores> open(const std::string &path,
+                                        const StorageConfig &config,
+                                        leveldb::Options options);
+
+    /// Opened stores with their names
+    std::vector<std::pair<std::string, std::shared_ptr<LevelDB>>> named()
+        const;
+
+    /// Leveldb stats of each store by store name
+    std::map<std::string, std::string> stats() const;
+  };
+
+}  // namespace fc::storage::config
+
+#endif  // CPP_FILECOIN_CORE_STORAGE_CONFIG_STORAGE_CONFIG_HPP
@@ -60,6 +60,40 @@ namespace fc::storage::filestore {
     virtual fc::outcome::result<size_t> write(
         size_t offset, gsl::span<const uint8_t> buffer) noexcept = 0;
 
+    /**
+     * @brief read bytes from the file into several buffers
+     * @param offset start position to read from
+     * @param buffers filled in order, next one after previous is full
+     * @return number of bytes read
+     */
+    virtual fc::outcome::result<size_t> readv(
+        size_t offset,
+        gsl::span<const gsl::span<uint8_t>> buffers) noexcept = 0;
+
+    /**
+     * @brief write several buffers to the file
+     * @param offset start position to write to
+     * @param buffers written one after another
+     * @return number of bytes written
+     */
+    virtual fc::outcome::result<size_t> writev(
+        size_t offset,
+        gsl::span<const gsl::span<const uint8_t>> buffers) noexcept = 0;
+
+    /**
+     * @brief reserve disk space for the file, so writes up to size don't
+     * fail for lack of space and file is less fragmented
+     * @param size of the file
+     */
+    virtual fc::outcome::result<void> allocate(size_t size) noexcept = 0;
+
+    /**
+     * @brief map open file into memory, reads are copied from mapping until
+     * file is closed. Suits large read-mostly files, file must not be
+     * truncated by others while mapped.
+     */
+    virtual fc::outcome::result<void> map() noexcept = 0;
+
     /**
      * @brief Whether the file is open
      * @return true if file is open, false otherwise
@@ -19,6 +19,8 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::filestore, FileStoreError, e) {
       return "FileStore: directory not found";
     case (FileStoreError::kNotDirectory):
       return "FileStore: not a directory";
+    case (FileStoreError::kNoSpace):
+      return "FileStore: no space left on device";
     default:
       return "FileStore: unknown error";
   }
@@ -19,6 +19,7 @@ namespace fc::storage::filestore {
     kFileClosed = 3,
     kDirectoryNotFound = 4,
     kNotDirectory = 5,
+    kNoSpace = 6,
 
     kUnknown = 1000
   };
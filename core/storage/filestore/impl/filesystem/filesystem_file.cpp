@@ -5,6 +5,17 @@
 
 #include "storage/filestore/impl/filesystem/filesystem_file.hpp"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <vector>
+
 #include "boost/filesystem.hpp"
 #include "storage/filestore/filestore_error.hpp"
 
@@ -12,8 +23,58 @@ using fc::storage::filestore::FileStoreError;
 using fc::storage::filestore::FileSystemFile;
 using fc::storage::filestore::Path;
 
+namespace {
+  /**
+   * Repeats vectored io until all buffers are done or end of file
+   * @param io - preadv or pwritev
+   */
+  template <typename Io>
+  fc::outcome::result<size_t> ioAll(std::vector<iovec> iov,
+                                    size_t offset,
+                                    const Io &io) {
+    size_t total{};
+    size_t first{};
+    while (first < iov.size() && iov[first].iov_len == 0) {
+      ++first;
+    }
+    while (first < iov.size()) {
+      auto count = std::min<size_t>(iov.size() - first, IOV_MAX);
+      auto n = io(iov.data() + first, static_cast<int>(count), offset + total);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return FileStoreError::kUnknown;
+      }
+      if (n == 0) {
+        break;
+      }
+      total += n;
+      auto left = static_cast<size_t>(n);
+      while (first < iov.size() && left >= iov[first].iov_len) {
+        left -= iov[first].iov_len;
+        ++first;
+      }
+      if (left != 0) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        iov[first].iov_base = reinterpret_cast<uint8_t *>(iov[first].iov_base)
+                              + left;
+        iov[first].iov_len -= left;
+      }
+    }
+    return total;
+  }
+}  // namespace
+
 FileSystemFile::FileSystemFile(Path path) : path_(std::move(path)) {}
 
+FileSystemFile::~FileSystemFile() {
+  unmap();
+  if (fd_ != -1) {
+    ::close(fd_);
+  }
+}
+
 Path FileSystemFile::path() const noexcept {
   return path_;
 }
@@ -28,62 +89,129 @@ fc::outcome::result<size_t> FileSystemFile::size() const noexcept {
 fc::outcome::result<void> FileSystemFile::open() noexcept {
   OUTCOME_TRY(file_exists, exists());
   if (!file_exists) return FileStoreError::kFileNotFound;
+  if (fd_ != -1) return FileStoreError::kCannotOpen;
 
-  fstream_.open(path_);
+  fd_ = ::open(path_.c_str(), O_RDWR | O_CLOEXEC);
 
-  if (fstream_.fail()) return FileStoreError::kCannotOpen;
+  if (fd_ == -1) return FileStoreError::kCannotOpen;
   return fc::outcome::success();
 }
 
 fc::outcome::result<void> FileSystemFile::close() noexcept {
   OUTCOME_TRY(file_exists, exists());
-  try {
-    if (!file_exists) return FileStoreError::kFileNotFound;
-    if (!fstream_.is_open()) return FileStoreError::kFileClosed;
+  if (!file_exists) return FileStoreError::kFileNotFound;
+  if (fd_ == -1) return FileStoreError::kFileClosed;
 
-    fstream_.close();
+  unmap();
+  auto res = ::close(fd_);
+  fd_ = -1;
 
-    if (fstream_.fail()) return FileStoreError::kUnknown;
-    return fc::outcome::success();
-  } catch (std::exception &) {
-    return FileStoreError::kUnknown;
-  }
+  if (res == -1) return FileStoreError::kUnknown;
+  return fc::outcome::success();
 }
 
 fc::outcome::result<size_t> FileSystemFile::read(
     size_t offset, gsl::span<uint8_t> buffer) noexcept {
-  OUTCOME_TRY(file_exists, exists());
-  if (!file_exists) return FileStoreError::kFileNotFound;
-  if (!fstream_.is_open()) return FileStoreError::kFileClosed;
-  if (fstream_.fail()) return FileStoreError::kUnknown;
-
-  fstream_.seekg(offset, std::ios_base::beg);
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  fstream_.read(reinterpret_cast<char *>(buffer.data()), buffer.size());
-  auto res = fstream_.gcount();
-
-  return res;
+  return readv(offset, gsl::make_span(&buffer, 1));
 }
 
 fc::outcome::result<size_t> FileSystemFile::write(
     size_t offset, gsl::span<const uint8_t> buffer) noexcept {
-  OUTCOME_TRY(file_exists, exists());
-  if (!file_exists) return FileStoreError::kFileNotFound;
-  if (!fstream_.is_open()) return FileStoreError::kFileClosed;
-  if (fstream_.fail()) return FileStoreError::kUnknown;
+  return writev(offset, gsl::make_span(&buffer, 1));
+}
 
-  fstream_.seekp(offset, std::ios_base::beg);
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  fstream_.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
-  fstream_.flush();
-  auto pos = fstream_.tellp();
-  if (pos == -1) return FileStoreError::kUnknown;
+fc::outcome::result<size_t> FileSystemFile::readv(
+    size_t offset, gsl::span<const gsl::span<uint8_t>> buffers) noexcept {
+  OUTCOME_TRY(checkOpen());
+
+  size_t total{};
+  std::vector<iovec> iov;
+  for (auto &buffer : buffers) {
+    auto pos = offset + total;
+    if (iov.empty() && pos < map_size_) {
+      // copy from mapping while it covers buffers
+      auto n = std::min<size_t>(buffer.size(), map_size_ - pos);
+      std::memcpy(buffer.data(), map_ + pos, n);
+      total += n;
+      if (n == static_cast<size_t>(buffer.size())) {
+        continue;
+      }
+      iov.push_back({buffer.data() + n, buffer.size() - n});
+      continue;
+    }
+    iov.push_back({buffer.data(), static_cast<size_t>(buffer.size())});
+  }
+  if (iov.empty()) {
+    return total;
+  }
+  OUTCOME_TRY(n, ioAll(std::move(iov), offset + total, [&](auto... args) {
+    return ::preadv(fd_, args...);
+  }));
+  return total + n;
+}
 
-  return static_cast<size_t>(pos) - offset;
+fc::outcome::result<size_t> FileSystemFile::writev(
+    size_t offset,
+    gsl::span<const gsl::span<const uint8_t>> buffers) noexcept {
+  OUTCOME_TRY(checkOpen());
+
+  std::vector<iovec> iov;
+  iov.reserve(buffers.size());
+  for (auto &buffer : buffers) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    iov.push_back({const_cast<uint8_t *>(buffer.data()),
+                   static_cast<size_t>(buffer.size())});
+  }
+  return ioAll(std::move(iov), offset, [&](auto... args) {
+    return ::pwritev(fd_, args...);
+  });
+}
+
+fc::outcome::result<void> FileSystemFile::allocate(size_t size) noexcept {
+  OUTCOME_TRY(checkOpen());
+
+#ifdef __linux__
+  // returns error instead of setting errno
+  auto error = ::posix_fallocate(fd_, 0, static_cast<off_t>(size));
+  if (error == 0) {
+    return fc::outcome::success();
+  }
+  if (error == ENOSPC) {
+    return FileStoreError::kNoSpace;
+  }
+  if (error != EOPNOTSUPP && error != EINVAL) {
+    return FileStoreError::kUnknown;
+  }
+#endif
+  // not supported by file system, extend file without reserving blocks
+  struct stat st {};
+  if (::fstat(fd_, &st) == -1) return FileStoreError::kUnknown;
+  if (static_cast<size_t>(st.st_size) < size
+      && ::ftruncate(fd_, static_cast<off_t>(size)) == -1) {
+    return FileStoreError::kUnknown;
+  }
+  return fc::outcome::success();
+}
+
+fc::outcome::result<void> FileSystemFile::map() noexcept {
+  OUTCOME_TRY(checkOpen());
+  OUTCOME_TRY(file_size, size());
+
+  unmap();
+  if (file_size == 0) {
+    return fc::outcome::success();
+  }
+  auto ptr = ::mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd_, 0);
+  if (ptr == MAP_FAILED) return FileStoreError::kUnknown;
+  ::madvise(ptr, file_size, MADV_SEQUENTIAL);
+
+  map_ = static_cast<const uint8_t *>(ptr);
+  map_size_ = file_size;
+  return fc::outcome::success();
 }
 
 bool FileSystemFile::is_open() const noexcept {
-  return fstream_.is_open();
+  return fd_ != -1;
 }
 
 fc::outcome::result<bool> FileSystemFile::exists() const noexcept {
@@ -96,3 +224,19 @@ fc::outcome::result<bool> FileSystemFile::exists() const noexcept {
 
   return res;
 }
+
+fc::outcome::result<void> FileSystemFile::checkOpen() const noexcept {
+  OUTCOME_TRY(file_exists, exists());
+  if (!file_exists) return FileStoreError::kFileNotFound;
+  if (fd_ == -1) return FileStoreError::kFileClosed;
+  return fc::outcome::success();
+}
+
+void FileSystemFile::unmap() noexcept {
+  if (map_) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    ::munmap(const_cast<uint8_t *>(map_), map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+  }
+}
@@ -14,13 +14,15 @@
 namespace fc::storage::filestore {
 
   /**
-   * Boost filesystem implementation of File
+   * Implementation of File over file descriptor, reads and writes go to
+   * kernel at given offset without stream buffers. Mapped file is read from
+   * mapping, reads past mapped size fall back to file.
    */
   class FileSystemFile : public virtual File {
    public:
     explicit FileSystemFile(Path path);
 
-    ~FileSystemFile() override = default;
+    ~FileSystemFile() override;
 
     /** \copydoc File::path() */
     Path path() const noexcept override;
@@ -42,6 +44,22 @@ namespace fc::storage::filestore {
     fc::outcome::result<size_t> write(
         size_t offset, gsl::span<const uint8_t> buffer) noexcept override;
 
+    /** \copydoc File::readv() */
+    fc::outcome::result<size_t> readv(
+        size_t offset,
+        gsl::span<const gsl::span<uint8_t>> buffers) noexcept override;
+
+    /** \copydoc File::writev() */
+    fc::outcome::result<size_t> writev(
+        size_t offset,
+        gsl::span<const gsl::span<const uint8_t>> buffers) noexcept override;
+
+    /** \copydoc File::allocate() */
+    fc::outcome::result<void> allocate(size_t size) noexcept override;
+
+    /** \copydoc File::map() */
+    fc::outcome::result<void> map() noexcept override;
+
     /** \copydoc File::is_open() */
     bool is_open() const noexcept override;
 
@@ -49,8 +67,14 @@ namespace fc::storage::filestore {
     fc::outcome::result<bool> exists() const noexcept override;
 
    private:
+    /// Checks that file exists and is open
+    fc::outcome::result<void> checkOpen() const noexcept;
+    void unmap() noexcept;
+
     Path path_;
-    boost::filesystem::fstream fstream_;
+    int fd_{-1};
+    const uint8_t *map_{nullptr};
+    size_t map_size_{};
   };
 
 }  // namespace fc::storage::filestore
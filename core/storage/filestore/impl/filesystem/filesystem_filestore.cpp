@@ -26,6 +26,10 @@ namespace fc::storage::filestore {
     try {
       auto file = std::make_shared<FileSystemFile>(path);
       OUTCOME_TRY(file->open());
+      OUTCOME_TRY(size, file->size());
+      if (size >= kMapMinSize) {
+        OUTCOME_TRY(file->map());
+      }
       return file;
     } catch (std::exception &) {
       return FileStoreError::kUnknown;
@@ -15,6 +15,9 @@ namespace fc::storage::filestore {
    */
   class FileSystemFileStore : public virtual FileStore {
    public:
+    /// Files of this size or larger are mapped on open
+    static constexpr size_t kMapMinSize{1 << 20};
+
     ~FileSystemFileStore() override = default;
 
     /** @copydoc FileStore::exists() */
@@ -5,6 +5,14 @@
 
 #include "storage/hamt/hamt.hpp"
 
+#include <algorithm>
+#include <future>
+#include <numeric>
+
+#include <boost/asio/post.hpp>
+#include <boost/assert.hpp>
+#include <boost/asio/thread_pool.hpp>
+
 #include "common/which.hpp"
 #include "crypto/murmur/murmur.hpp"
 
@@ -31,63 +39,143 @@ namespace fc::storage::hamt {
   Hamt::Hamt(std::shared_ptr<ipfs::IpfsDatastore> store, size_t bit_width)
       : ipld{std::move(store)},
         root_{std::make_shared<Node>()},
-        bit_width_{bit_width} {}
+        bit_width_{bit_width} {
+    BOOST_ASSERT(bit_width_ <= kMaxBitWidth);
+  }
 
   Hamt::Hamt(std::shared_ptr<ipfs::IpfsDatastore> store,
              Node::Ptr root,
              size_t bit_width)
-      : ipld{std::move(store)}, root_{std::move(root)}, bit_width_{bit_width} {}
+      : ipld{std::move(store)}, root_{std::move(root)}, bit_width_{bit_width} {
+    BOOST_ASSERT(bit_width_ <= kMaxBitWidth);
+  }
 
   Hamt::Hamt(std::shared_ptr<ipfs::IpfsDatastore> store,
              const CID &root,
              size_t bit_width)
-      : ipld{std::move(store)}, root_{root}, bit_width_{bit_width} {}
+      : ipld{std::move(store)}, root_{root}, bit_width_{bit_width} {
+    BOOST_ASSERT(bit_width_ <= kMaxBitWidth);
+  }
+
+  Hamt::HashedKey Hamt::hashKey(const std::string &key) const {
+    return {key, keyToIndices(key)};
+  }
 
   outcome::result<void> Hamt::set(const std::string &key,
                                   gsl::span<const uint8_t> value) {
+    return set(hashKey(key), value);
+  }
+
+  outcome::result<void> Hamt::set(const HashedKey &key,
+                                  gsl::span<const uint8_t> value) {
     OUTCOME_TRY(loadItem(root_));
-    return set(*boost::get<Node::Ptr>(root_), keyToIndices(key), key, value);
+    return set(*boost::get<Node::Ptr>(root_), key.indices, key.key, value);
   }
 
   outcome::result<Value> Hamt::get(const std::string &key) {
-    OUTCOME_TRY(loadItem(root_));
-    auto node = boost::get<Node::Ptr>(root_);
-    for (auto index : keyToIndices(key)) {
-      auto it = node->items.find(index);
-      if (it == node->items.end()) {
-        return HamtError::kNotFound;
-      }
-      auto &item = it->second;
-      OUTCOME_TRY(loadItem(item));
-      if (which<Node::Ptr>(item)) {
-        node = boost::get<Node::Ptr>(item);
-      } else {
-        auto &leaf = boost::get<Node::Leaf>(item);
-        if (leaf.find(key) == leaf.end()) {
-          return HamtError::kNotFound;
-        }
-        return leaf[key];
-      }
+    return get(hashKey(key));
+  }
+
+  outcome::result<Value> Hamt::get(const HashedKey &key) {
+    OUTCOME_TRY(value, find(key));
+    if (!value) {
+      return HamtError::kNotFound;
     }
-    return HamtError::kMaxDepth;
+    return *value;
   }
 
   outcome::result<void> Hamt::remove(const std::string &key) {
+    return remove(hashKey(key));
+  }
+
+  outcome::result<void> Hamt::remove(const HashedKey &key) {
     OUTCOME_TRY(loadItem(root_));
-    return remove(*boost::get<Node::Ptr>(root_), keyToIndices(key), key);
+    return remove(*boost::get<Node::Ptr>(root_), key.indices, key.key);
   }
 
   outcome::result<bool> Hamt::contains(const std::string &key) {
-    auto res = get(key);
-    if (!res) {
-      if (res.error() == HamtError::kNotFound) return false;
-      return res.error();
+    return contains(hashKey(key));
+  }
+
+  outcome::result<bool> Hamt::contains(const HashedKey &key) {
+    OUTCOME_TRY(value, find(key));
+    return value != nullptr;
+  }
+
+  outcome::result<void> Hamt::update(const std::string &key,
+                                     const Updater &updater) {
+    auto hashed = hashKey(key);
+    OUTCOME_TRY(found, find(hashed, true));
+    boost::optional<Value> value;
+    if (found) {
+      value = *found;
     }
-    return true;
+    OUTCOME_TRY(updater(value));
+    if (value) {
+      if (found) {
+        *found = std::move(*value);
+        return outcome::success();
+      }
+      return set(hashed, *value);
+    }
+    if (found) {
+      return remove(hashed);
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> Hamt::updateMany(const std::vector<HashedKey> &keys,
+                                         const ManyUpdater &updater) {
+    if (keys.empty()) {
+      return outcome::success();
+    }
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](auto l, auto r) {
+      return keys[l].indices < keys[r].indices;
+    });
+    OUTCOME_TRY(loadItem(root_));
+    return updateMany(
+        *boost::get<Node::Ptr>(root_), 0, keys, order, updater);
+  }
+
+  outcome::result<Value *> Hamt::find(const HashedKey &key, bool write) {
+    OUTCOME_TRY(loadItem(root_));
+    auto node = boost::get<Node::Ptr>(root_);
+    for (auto index : key.indices) {
+      if (write) {
+        node->cid.reset();
+      }
+      auto item = node->find(index);
+      if (!item) {
+        return nullptr;
+      }
+      OUTCOME_TRY(loadItem(*item));
+      if (which<Node::Ptr>(*item)) {
+        node = boost::get<Node::Ptr>(*item);
+      } else {
+        return Node::find(boost::get<Node::Leaf>(*item), key.key);
+      }
+    }
+    return HamtError::kMaxDepth;
   }
 
   outcome::result<CID> Hamt::flush() {
-    OUTCOME_TRY(flush(root_));
+    if (which<Node::Ptr>(root_)) {
+      auto &root = *boost::get<Node::Ptr>(root_);
+      if (root.cid) {
+        // root and its subtree were only read
+        root_ = *root.cid;
+        return cid();
+      }
+      Ipld::Batch batch;
+      OUTCOME_TRY(flush({&root}, batch));
+      OUTCOME_TRY(cid, Ipld::addCbor(batch, root));
+      root.cid = cid;
+      nodeCache().put(cid, std::make_shared<const Node>(root));
+      OUTCOME_TRY(ipld->setMany(std::move(batch)));
+      root_ = cid;
+    }
     return cid();
   }
 
@@ -126,23 +214,22 @@ namespace fc::storage::hamt {
     if (indices.empty()) {
       return HamtError::kMaxDepth;
     }
+    node.cid.reset();
     auto index = indices[0];
-    auto it = node.items.find(index);
-    if (it == node.items.end()) {
-      Node::Leaf leaf;
-      leaf.emplace(key, std::vector<uint8_t>(value.begin(), value.end()));
-      node.items[index] = leaf;
+    auto found = node.find(index);
+    if (!found) {
+      node.set(index, Node::Leaf{{key, Value(value)}});
       return outcome::success();
     }
-    auto &item = it->second;
+    auto &item = *found;
     OUTCOME_TRY(loadItem(item));
     if (which<Node::Ptr>(item)) {
       return set(
           *boost::get<Node::Ptr>(item), consumeIndex(indices), key, value);
     }
     auto &leaf = boost::get<Node::Leaf>(item);
-    if (leaf.find(key) != leaf.end() || leaf.size() < kLeafMax) {
-      leaf[key] = Value(value);
+    if (Node::find(leaf, key) || leaf.size() < kLeafMax) {
+      Node::set(leaf, key, Value(value));
     } else {
       auto child = std::make_shared<Node>();
       OUTCOME_TRY(set(*child, consumeIndex(indices), key, value));
@@ -161,12 +248,13 @@ namespace fc::storage::hamt {
     if (indices.empty()) {
       return HamtError::kMaxDepth;
     }
+    node.cid.reset();
     auto index = indices[0];
-    auto it = node.items.find(index);
-    if (it == node.items.end()) {
+    auto found = node.find(index);
+    if (!found) {
       return HamtError::kNotFound;
     }
-    auto &item = it->second;
+    auto &item = *found;
     OUTCOME_TRY(loadItem(item));
     if (which<Node::Ptr>(item)) {
       OUTCOME_TRY(
@@ -174,13 +262,79 @@ namespace fc::storage::hamt {
       OUTCOME_TRY(cleanShard(item));
     } else {
       auto &leaf = boost::get<Node::Leaf>(item);
-      if (leaf.find(key) == leaf.end()) {
+      auto it = Node::lowerBound(leaf, key);
+      if (it == leaf.end() || it->first != key) {
         return HamtError::kNotFound;
       }
       if (leaf.size() == 1) {
-        node.items.erase(index);
+        node.erase(index);
       } else {
-        leaf.erase(key);
+        leaf.erase(it);
+      }
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> Hamt::updateMany(Node &node,
+                                         size_t depth,
+                                         const std::vector<HashedKey> &keys,
+                                         gsl::span<const size_t> order,
+                                         const ManyUpdater &updater) {
+    node.cid.reset();
+    while (!order.empty()) {
+      auto &first = keys[order[0]].indices;
+      if (depth >= first.size()) {
+        return HamtError::kMaxDepth;
+      }
+      auto index = first[depth];
+      auto n = std::find_if(order.begin(),
+                            order.end(),
+                            [&](auto i) {
+                              return keys[i].indices[depth] != index;
+                            })
+               - order.begin();
+      auto group = order.first(n);
+      order = order.subspan(n);
+      if (auto item = node.find(index)) {
+        OUTCOME_TRY(loadItem(*item));
+        if (which<Node::Ptr>(*item)) {
+          auto &child = *boost::get<Node::Ptr>(*item);
+          OUTCOME_TRY(updateMany(child, depth + 1, keys, group, updater));
+          if (child.items.empty()) {
+            node.erase(index);
+          } else {
+            OUTCOME_TRY(cleanShard(*item));
+          }
+          continue;
+        }
+      }
+      // leaf or empty slot, leaf may become shard while its keys are set
+      for (auto i : group) {
+        auto &key = keys[i];
+        auto indices = gsl::make_span(key.indices).subspan(depth);
+        auto item = node.find(index);
+        boost::optional<Value> value;
+        if (item) {
+          if (which<Node::Ptr>(*item)) {
+            OUTCOME_TRY(updateMany(*boost::get<Node::Ptr>(*item),
+                                   depth + 1,
+                                   keys,
+                                   gsl::make_span(&i, 1),
+                                   updater));
+            OUTCOME_TRY(cleanShard(*item));
+            continue;
+          }
+          if (auto found = Node::find(boost::get<Node::Leaf>(*item), key.key)) {
+            value = *found;
+          }
+        }
+        auto found = value.has_value();
+        OUTCOME_TRY(updater(i, value));
+        if (value) {
+          OUTCOME_TRY(set(node, indices, key.key, *value));
+        } else if (found) {
+          OUTCOME_TRY(remove(node, indices, key.key));
+        }
       }
     }
     return outcome::success();
@@ -189,48 +343,102 @@ namespace fc::storage::hamt {
   outcome::result<void> Hamt::cleanShard(Node::Item &item) {
     auto &node = *boost::get<Node::Ptr>(item);
     if (node.items.size() == 1) {
-      auto &single_item = node.items.begin()->second;
+      auto &single_item = node.items.front();
       if (which<Node::Leaf>(single_item)) {
-        item = single_item;
+        // copy, as assignment destroys node owning single item
+        item = Node::Item{single_item};
       }
     } else if (node.items.size() <= kLeafMax) {
-      Node::Leaf leaf;
+      size_t pairs = 0;
       for (auto &item2 : node.items) {
-        if (!which<Node::Leaf>(item2.second)) {
+        if (!which<Node::Leaf>(item2)) {
           return outcome::success();
         }
-        for (auto &pair : boost::get<Node::Leaf>(item2.second)) {
-          leaf.emplace(pair);
-          if (leaf.size() > kLeafMax) {
-            return outcome::success();
-          }
+        pairs += boost::get<Node::Leaf>(item2).size();
+      }
+      if (pairs > kLeafMax) {
+        return outcome::success();
+      }
+      Node::Leaf leaf;
+      for (auto &item2 : node.items) {
+        for (auto &pair : boost::get<Node::Leaf>(item2)) {
+          Node::set(leaf, pair.first, pair.second);
         }
       }
-      item = leaf;
+      item = std::move(leaf);
     }
     return outcome::success();
   }
 
-  outcome::result<void> Hamt::flush(Node::Item &item) {
-    if (which<Node::Ptr>(item)) {
-      auto &node = *boost::get<Node::Ptr>(item);
-      for (auto &item2 : node.items) {
-        OUTCOME_TRY(flush(item2.second));
+  outcome::result<void> Hamt::flush(const std::vector<Node *> &nodes,
+                                    Ipld::Batch &batch) {
+    std::vector<Node::Item *> items;
+    std::vector<Node *> children;
+    for (auto node : nodes) {
+      for (auto &item : node->items) {
+        if (which<Node::Ptr>(item)) {
+          auto &child = *boost::get<Node::Ptr>(item);
+          if (child.cid) {
+            // changes mark path from root, so clean subtree keeps its cid
+            item = CID{*child.cid};
+            continue;
+          }
+          items.push_back(&item);
+          children.push_back(&child);
+        }
       }
-      OUTCOME_TRY(cid, ipld->setCbor(node));
-      item = cid;
+    }
+    if (children.empty()) {
+      return outcome::success();
+    }
+    OUTCOME_TRY(flush(children, batch));
+    std::vector<Ipld::Value> values;
+    values.reserve(children.size());
+    for (auto child : children) {
+      OUTCOME_TRY(value, Ipld::encode(*child));
+      values.push_back(std::move(value));
+    }
+    OUTCOME_TRY(cids, Ipld::addMany(batch, std::move(values)));
+    for (size_t i = 0; i < items.size(); ++i) {
+      // flushed node contains only cids and leaves, same as decoded
+      children[i]->cid = cids[i];
+      nodeCache().put(cids[i], std::make_shared<const Node>(*children[i]));
+      *items[i] = std::move(cids[i]);
     }
     return outcome::success();
   }
 
   outcome::result<void> Hamt::loadItem(Node::Item &item) const {
     if (which<CID>(item)) {
-      OUTCOME_TRY(child, ipld->getCbor<Node>(boost::get<CID>(item)));
-      item = std::make_shared<Node>(std::move(child));
+      auto &cid = boost::get<CID>(item);
+      auto cached = nodeCache().get(cid);
+      if (cached) {
+        // cache is shared by stores, node may be missing in this one
+        OUTCOME_TRY(stored, ipld->contains(cid));
+        if (!stored) {
+          cached = boost::none;
+        }
+      }
+      if (cached) {
+        auto node = std::make_shared<Node>(**cached);
+        node->cid = cid;
+        item = std::move(node);
+        return outcome::success();
+      }
+      OUTCOME_TRY(child, ipld->getCbor<Node>(cid));
+      auto node = std::make_shared<Node>(std::move(child));
+      node->cid = cid;
+      nodeCache().put(cid, std::make_shared<const Node>(*node));
+      item = std::move(node);
     }
     return outcome::success();
   }
 
+  NodeCache &Hamt::nodeCache() {
+    static NodeCache cache{kNodeCacheSize};
+    return cache;
+  }
+
   outcome::result<void> Hamt::visit(const Visitor &visitor) {
     return visit(root_, visitor);
   }
@@ -239,7 +447,7 @@ namespace fc::storage::hamt {
     OUTCOME_TRY(loadItem(item));
     if (which<Node::Ptr>(item)) {
       for (auto &item2 : boost::get<Node::Ptr>(item)->items) {
-        OUTCOME_TRY(visit(item2.second, visitor));
+        OUTCOME_TRY(visit(item2, visitor));
       }
     } else {
       for (auto &pair : boost::get<Node::Leaf>(item)) {
@@ -248,4 +456,194 @@ namespace fc::storage::hamt {
     }
     return outcome::success();
   }
+
+  outcome::result<void> Hamt::visitParallel(const Visitor &visitor,
+                                            boost::asio::thread_pool &pool,
+                                            bool ordered) {
+    using Pairs = std::vector<std::pair<std::string, Value>>;
+    using Task = std::packaged_task<outcome::result<Pairs>()>;
+    OUTCOME_TRY(loadItem(root_));
+    auto &items = boost::get<Node::Ptr>(root_)->items;
+    std::vector<std::future<outcome::result<Pairs>>> subtrees;
+    subtrees.reserve(items.size());
+    for (auto &item : items) {
+      // tasks load items of distinct root entries, root is not changed
+      auto task = std::make_shared<Task>(
+          [&, subtree{&item}]() -> outcome::result<Pairs> {
+            Pairs pairs;
+            OUTCOME_TRY(visit(
+                *subtree,
+                [&](auto &key, auto &value) -> outcome::result<void> {
+                  if (!ordered) {
+                    return visitor(key, value);
+                  }
+                  pairs.emplace_back(key, value);
+                  return outcome::success();
+                }));
+            return std::move(pairs);
+          });
+      subtrees.push_back(task->get_future());
+      boost::asio::post(pool, [task] { (*task)(); });
+    }
+
+    // all tasks are waited for, as they reference this visit
+    boost::optional<std::error_code> error;
+    for (auto &subtree : subtrees) {
+      auto pairs = subtree.get();
+      if (error) {
+        continue;
+      }
+      if (!pairs) {
+        error = pairs.error();
+        continue;
+      }
+      for (auto &[key, value] : pairs.value()) {
+        auto visited = visitor(key, value);
+        if (!visited) {
+          error = visited.error();
+          break;
+        }
+      }
+    }
+    if (error) {
+      return *error;
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> Hamt::visitAfter(
+      const boost::optional<std::string> &after, const WhileVisitor &visitor) {
+    std::vector<size_t> path;
+    if (after) {
+      path = keyToIndices(*after);
+    }
+    OUTCOME_TRY(visitAfter(root_,
+                           after ? &path : nullptr,
+                           0,
+                           after ? &*after : nullptr,
+                           visitor));
+    return outcome::success();
+  }
+
+  outcome::result<bool> Hamt::visitAfter(Node::Item &item,
+                                         const std::vector<size_t> *path,
+                                         size_t depth,
+                                         const std::string *after,
+                                         const WhileVisitor &visitor) {
+    OUTCOME_TRY(loadItem(item));
+    if (which<Node::Ptr>(item)) {
+      auto &node{*boost::get<Node::Ptr>(item)};
+      size_t pos{0};
+      if (path) {
+        if (depth >= path->size()) {
+          return HamtError::kMaxDepth;
+        }
+        // items before path index precede key
+        auto index{(*path)[depth]};
+        pos = node.position(index);
+        if (node.has(index)) {
+          OUTCOME_TRY(
+              more,
+              visitAfter(node.items[pos], path, depth + 1, after, visitor));
+          if (!more) {
+            return false;
+          }
+          ++pos;
+        }
+      }
+      for (; pos < node.items.size(); ++pos) {
+        OUTCOME_TRY(more,
+                    visitAfter(
+                        node.items[pos], nullptr, depth + 1, nullptr, visitor));
+        if (!more) {
+          return false;
+        }
+      }
+    } else {
+      auto &leaf{boost::get<Node::Leaf>(item)};
+      auto it{leaf.begin()};
+      if (after) {
+        it = Node::lowerBound(leaf, *after);
+        if (it != leaf.end() && it->first == *after) {
+          ++it;
+        }
+      }
+      for (; it != leaf.end(); ++it) {
+        OUTCOME_TRY(more, visitor(it->first, it->second));
+        if (!more) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  outcome::result<void> Hamt::diff(IpldPtr ipld,
+                                   const CID &before,
+                                   const CID &after,
+                                   const DiffVisitor &visitor) {
+    Hamt hamt{ipld};
+    Node::Item item1{before}, item2{after};
+    return hamt.diff(item1, item2, visitor);
+  }
+
+  outcome::result<void> Hamt::diff(Node::Item &before,
+                                   Node::Item &after,
+                                   const DiffVisitor &visitor) {
+    if (which<CID>(before) && which<CID>(after)
+        && boost::get<CID>(before) == boost::get<CID>(after)) {
+      return outcome::success();
+    }
+    OUTCOME_TRY(loadItem(before));
+    OUTCOME_TRY(loadItem(after));
+    if (which<Node::Ptr>(before) && which<Node::Ptr>(after)) {
+      auto &node1 = *boost::get<Node::Ptr>(before);
+      auto &node2 = *boost::get<Node::Ptr>(after);
+      // indices and positions of current items of both nodes
+      auto index1 = node1.next(0), index2 = node2.next(0);
+      size_t pos1 = 0, pos2 = 0;
+      while (index1 != Node::kMaxIndex || index2 != Node::kMaxIndex) {
+        if (index1 < index2) {
+          OUTCOME_TRY(visit(node1.items[pos1++], [&](auto &key, auto &value) {
+            return visitor(key, value, boost::none);
+          }));
+          index1 = node1.next(index1 + 1);
+        } else if (index2 < index1) {
+          OUTCOME_TRY(visit(node2.items[pos2++], [&](auto &key, auto &value) {
+            return visitor(key, boost::none, value);
+          }));
+          index2 = node2.next(index2 + 1);
+        } else {
+          OUTCOME_TRY(diff(node1.items[pos1++], node2.items[pos2++], visitor));
+          index1 = node1.next(index1 + 1);
+          index2 = node2.next(index2 + 1);
+        }
+      }
+      return outcome::success();
+    }
+    // leaf and small shard, compare all values
+    std::map<std::string, Value> values1, values2;
+    OUTCOME_TRY(visit(before, [&](auto &key, auto &value) {
+      values1.emplace(key, value);
+      return outcome::success();
+    }));
+    OUTCOME_TRY(visit(after, [&](auto &key, auto &value) {
+      values2.emplace(key, value);
+      return outcome::success();
+    }));
+    for (auto &[key, value] : values1) {
+      auto it = values2.find(key);
+      if (it == values2.end()) {
+        OUTCOME_TRY(visitor(key, value, boost::none));
+      } else if (it->second != value) {
+        OUTCOME_TRY(visitor(key, value, it->second));
+      }
+    }
+    for (auto &[key, value] : values2) {
+      if (values1.find(key) == values1.end()) {
+        OUTCOME_TRY(visitor(key, boost::none, value));
+      }
+    }
+    return outcome::success();
+  }
 }  // namespace fc::storage::hamt
@@ -6,20 +6,27 @@
 #ifndef CPP_FILECOIN_STORAGE_HAMT_HAMT_HPP
 #define CPP_FILECOIN_STORAGE_HAMT_HAMT_HPP
 
+#include <algorithm>
+#include <array>
 #include <string>
 #include <vector>
 
-#include <boost/multiprecision/cpp_int.hpp>
+#include <boost/container/static_vector.hpp>
 #include <boost/variant.hpp>
 
 #include "codec/cbor/cbor.hpp"
 #include "codec/cbor/streams_annotation.hpp"
+#include "common/lru_cache.hpp"
 #include "common/outcome.hpp"
 #include "common/span.hpp"
 #include "common/visitor.hpp"
 #include "primitives/cid/cid.hpp"
 #include "storage/ipfs/datastore.hpp"
 
+namespace boost::asio {
+  class thread_pool;
+}  // namespace boost::asio
+
 namespace fc::storage::hamt {
   enum class HamtError { kExpectedCID = 1, kNotFound, kMaxDepth };
 }  // namespace fc::storage::hamt
@@ -27,51 +34,144 @@ namespace fc::storage::hamt {
 OUTCOME_HPP_DECLARE_ERROR(fc::storage::hamt, HamtError);
 
 namespace fc::storage::hamt {
-  using boost::multiprecision::cpp_int;
   using common::Buffer;
   using Value = ipfs::IpfsDatastore::Value;
 
   constexpr size_t kLeafMax = 3;
   constexpr size_t kDefaultBitWidth = 5;
+  /// Max number of decoded nodes kept by node cache
+  constexpr size_t kNodeCacheSize = 1 << 14;
 
-  struct Bits : cpp_int {};
+  /// Max bit width supported by node bitfield, same as go-hamt-ipld
+  constexpr size_t kMaxBitWidth = 8;
 
-  CBOR_ENCODE(Bits, bits) {
-    std::vector<uint8_t> bytes;
-    if (bits != 0) {
-      export_bits(bits, std::back_inserter(bytes), 8);
+  /**
+   * Hamt node representation.
+   * Present indices are marked in bitfield, items are stored in index order
+   * and located by popcount of lower bits. Leaves hold up to kLeafMax pairs
+   * inline, sorted by key.
+   */
+  struct Node {
+    using Ptr = std::shared_ptr<Node>;
+    using Pair = std::pair<std::string, Value>;
+    using Leaf = boost::container::static_vector<Pair, kLeafMax>;
+    using Item = boost::variant<CID, Ptr, Leaf>;
+
+    static constexpr size_t kMaxIndex = size_t{1} << kMaxBitWidth;
+    static constexpr size_t kWordBits = 64;
+    using Bits = std::array<uint64_t, kMaxIndex / kWordBits>;
+
+    /// Checks if index is present
+    bool has(size_t index) const {
+      return (bits[index / kWordBits] >> (index % kWordBits) & 1) != 0;
     }
-    return s << bytes;
-  }
 
-  CBOR_DECODE(Bits, bits) {
-    std::vector<uint8_t> bytes;
-    s >> bytes;
-    if (bytes.empty()) {
-      bits = {0};
-    } else {
-      import_bits(bits, bytes.begin(), bytes.end());
+    /// Position of index item in items
+    size_t position(size_t index) const {
+      auto word = index / kWordBits;
+      size_t count = 0;
+      for (size_t i = 0; i < word; ++i) {
+        count += __builtin_popcountll(bits[i]);
+      }
+      auto mask = (uint64_t{1} << (index % kWordBits)) - 1;
+      return count + __builtin_popcountll(bits[word] & mask);
     }
-    return s;
-  }
 
-  /** Hamt node representation */
-  struct Node {
-    using Ptr = std::shared_ptr<Node>;
-    using Leaf = std::map<std::string, Value>;
-    using Item = boost::variant<CID, Ptr, Leaf>;
+    /// Get item by index, nullptr if not present
+    Item *find(size_t index) {
+      return has(index) ? &items[position(index)] : nullptr;
+    }
+
+    /// Get item by index, nullptr if not present
+    const Item *find(size_t index) const {
+      return has(index) ? &items[position(index)] : nullptr;
+    }
+
+    /// Insert or replace item by index
+    Item &set(size_t index, Item item) {
+      auto pos = position(index);
+      if (has(index)) {
+        items[pos] = std::move(item);
+      } else {
+        bits[index / kWordBits] |= uint64_t{1} << (index % kWordBits);
+        items.insert(items.begin() + pos, std::move(item));
+      }
+      return items[pos];
+    }
+
+    /// Remove item by index
+    void erase(size_t index) {
+      if (has(index)) {
+        items.erase(items.begin() + position(index));
+        bits[index / kWordBits] &= ~(uint64_t{1} << (index % kWordBits));
+      }
+    }
+
+    /// First present index not less than index, kMaxIndex if none
+    size_t next(size_t index) const {
+      for (auto word = index / kWordBits; word < bits.size(); ++word) {
+        auto rest = bits[word];
+        if (word == index / kWordBits) {
+          rest &= ~uint64_t{0} << (index % kWordBits);
+        }
+        if (rest != 0) {
+          return word * kWordBits + __builtin_ctzll(rest);
+        }
+      }
+      return kMaxIndex;
+    }
+
+    /// First pair with key not less than key
+    static Leaf::iterator lowerBound(Leaf &leaf, const std::string &key) {
+      return std::lower_bound(
+          leaf.begin(), leaf.end(), key, [](auto &pair, auto &key) {
+            return pair.first < key;
+          });
+    }
+
+    /// Find value by key in leaf, nullptr if not present
+    static Value *find(Leaf &leaf, const std::string &key) {
+      auto it = lowerBound(leaf, key);
+      return it != leaf.end() && it->first == key ? &it->second : nullptr;
+    }
+
+    /// Insert or replace value by key, leaf must have space for new key
+    static void set(Leaf &leaf, const std::string &key, Value value) {
+      auto it = lowerBound(leaf, key);
+      if (it != leaf.end() && it->first == key) {
+        it->second = std::move(value);
+      } else {
+        leaf.emplace(it, key, std::move(value));
+      }
+    }
 
-    std::map<size_t, Item> items;
+    Bits bits{};
+    std::vector<Item> items;
+    /// Cid node was loaded from, none if node was changed since
+    boost::optional<CID> cid{};
   };
 
+  /// Decoded immutable nodes by cid, shared by all hamt instances and stores,
+  /// hit is used only if node is in store of instance
+  using NodeCache = common::LruCache<CID, std::shared_ptr<const Node>>;
+
+  /// Bitfield is encoded as big-endian bytes without leading zeros
   CBOR_ENCODE(Node, node) {
+    std::vector<uint8_t> bytes;
+    for (auto word = node.bits.size(); word-- != 0;) {
+      for (auto shift = Node::kWordBits; shift != 0;) {
+        shift -= 8;
+        uint8_t byte = node.bits[word] >> shift;
+        if (byte != 0 || !bytes.empty()) {
+          bytes.push_back(byte);
+        }
+      }
+    }
     auto l_items = s.list();
-    Bits bits;
     for (auto &item : node.items) {
-      bit_set(bits, item.first);
       auto m_item = s.map();
       visit_in_place(
-          item.second,
+          item,
           [&m_item](const CID &cid) { m_item["0"] << cid; },
           [](const Node::Ptr &ptr) { outcome::raise(HamtError::kExpectedCID); },
           [&m_item](const Node::Leaf &leaf) {
@@ -85,40 +185,55 @@ namespace fc::storage::hamt {
           });
       l_items << m_item;
     }
-    return s << (s.list() << bits << l_items);
+    return s << std::move(s.list() << bytes << l_items);
   }
 
   CBOR_DECODE(Node, node) {
-    node.items.clear();
     auto l_node = s.list();
-    Bits bits;
-    l_node >> bits;
+    std::vector<uint8_t> bytes;
+    l_node >> bytes;
+    if (bytes.size() > sizeof(node.bits)) {
+      outcome::raise(codec::cbor::CborDecodeError::kWrongSize);
+    }
+    node.bits = {};
+    size_t n_bits = 0;
+    for (size_t i = 0; i < bytes.size(); ++i) {
+      auto shift = 8 * (bytes.size() - 1 - i);
+      node.bits[shift / Node::kWordBits] |= uint64_t{bytes[i]}
+                                            << (shift % Node::kWordBits);
+      n_bits += __builtin_popcount(bytes[i]);
+    }
     auto n_items = l_node.listLength();
+    if (n_items != n_bits) {
+      outcome::raise(codec::cbor::CborDecodeError::kWrongSize);
+    }
     auto l_items = l_node.list();
-    size_t j = 0;
+    node.items.clear();
+    node.items.reserve(n_items);
     for (size_t i = 0; i < n_items; ++i) {
-      while (!bit_test(bits, j)) {
-        ++j;
-      }
-      auto m_item = l_items.map();
-      if (m_item.find("0") != m_item.end()) {
+      if (auto s_cid = l_items.mapFind("0")) {
         CID cid;
-        m_item.at("0") >> cid;
-        node.items[j] = std::move(cid);
+        *s_cid >> cid;
+        node.items.emplace_back(std::move(cid));
       } else {
-        auto s_leaf = m_item.at("1");
-        auto n_leaf = s_leaf.listLength();
-        auto l_leaf = s_leaf.list();
+        auto s_leaf = l_items.mapFind("1");
+        if (!s_leaf) {
+          outcome::raise(codec::cbor::CborDecodeError::kWrongType);
+        }
+        auto n_leaf = s_leaf->listLength();
+        if (n_leaf > kLeafMax) {
+          outcome::raise(codec::cbor::CborDecodeError::kWrongSize);
+        }
+        auto l_leaf = s_leaf->list();
         Node::Leaf leaf;
         for (size_t j = 0; j < n_leaf; ++j) {
           auto l_pair = l_leaf.list();
-          Buffer key;
-          l_pair >> key;
-          leaf.emplace(std::string{key.begin(), key.end()}, l_pair.raw());
+          auto key = l_pair.bytesView();
+          Node::set(leaf, {key.begin(), key.end()}, Value{l_pair.raw()});
         }
-        node.items[j] = std::move(leaf);
+        node.items.emplace_back(std::move(leaf));
       }
-      ++j;
+      l_items.next();
     }
     return s;
   }
@@ -131,6 +246,27 @@ namespace fc::storage::hamt {
    public:
     using Visitor = std::function<outcome::result<void>(const std::string &,
                                                         const Value &)>;
+    /// Returns false to stop visit
+    using WhileVisitor = std::function<outcome::result<bool>(
+        const std::string &, const Value &)>;
+    /// Receives none if key is absent, set none to remove
+    using Updater =
+        std::function<outcome::result<void>(boost::optional<Value> &)>;
+    /// Receives position of key in batch, none if key is absent
+    using ManyUpdater = std::function<outcome::result<void>(
+        size_t, boost::optional<Value> &)>;
+
+    /// Receives none as before for added value, none as after for removed
+    using DiffVisitor =
+        std::function<outcome::result<void>(const std::string &,
+                                            const boost::optional<Value> &,
+                                            const boost::optional<Value> &)>;
+
+    /// Key with precomputed hash indices, valid for hamt with same bit width
+    struct HashedKey {
+      std::string key;
+      std::vector<size_t> indices;
+    };
 
     Hamt(std::shared_ptr<ipfs::IpfsDatastore> store,
          size_t bit_width = kDefaultBitWidth);
@@ -140,23 +276,49 @@ namespace fc::storage::hamt {
     Hamt(std::shared_ptr<ipfs::IpfsDatastore> store,
          const CID &root,
          size_t bit_width = kDefaultBitWidth);
+
+    /// Hash key once for repeated operations
+    HashedKey hashKey(const std::string &key) const;
+
     /** Set value by key, does not write to storage */
     outcome::result<void> set(const std::string &key,
                               gsl::span<const uint8_t> value);
+    outcome::result<void> set(const HashedKey &key,
+                              gsl::span<const uint8_t> value);
 
     /** Get value by key */
     outcome::result<Value> get(const std::string &key);
+    outcome::result<Value> get(const HashedKey &key);
 
     /**
      * Remove value by key, does not write to storage.
      * Returns kNotFound if element doesn't exist.
      */
     outcome::result<void> remove(const std::string &key);
+    outcome::result<void> remove(const HashedKey &key);
 
     /**
      * Checks if key is present
      */
     outcome::result<bool> contains(const std::string &key);
+    outcome::result<bool> contains(const HashedKey &key);
+
+    /**
+     * Read-modify-write value by key, hashes key and walks path once.
+     * Does not write to storage.
+     */
+    outcome::result<void> update(const std::string &key,
+                                 const Updater &updater);
+
+    /**
+     * Read-modify-write values of batch of keys. Keys are ordered by hash
+     * path, so nodes shared by paths are walked once and shards are cleaned
+     * once after all their keys are updated. Repeated key is updated in
+     * batch order, updater receives value left by previous update.
+     * Does not write to storage.
+     */
+    outcome::result<void> updateMany(const std::vector<HashedKey> &keys,
+                                     const ManyUpdater &updater);
 
     /**
      * Write changes made by set and remove to storage
@@ -170,23 +332,55 @@ namespace fc::storage::hamt {
     /** Apply visitor for key value pairs */
     outcome::result<void> visit(const Visitor &visitor);
 
+    /**
+     * Apply visitor for key value pairs, subtrees of root are visited
+     * concurrently on pool, each task loads own nodes. Blocks until all
+     * subtrees are visited, so must not be called from pool thread, ipld
+     * must support concurrent reads.
+     * @param ordered - pairs of each subtree are buffered and visitor is
+     * applied on calling thread in visit order, otherwise visitor is called
+     * concurrently from pool threads and must be thread-safe
+     * @return first error in visit order
+     */
+    outcome::result<void> visitParallel(const Visitor &visitor,
+                                        boost::asio::thread_pool &pool,
+                                        bool ordered);
+
+    /**
+     * Apply visitor for key value pairs following key in visit order, until
+     * visitor returns false. Subtrees preceding key are not loaded, so key of
+     * last visited pair resumes visit.
+     * @param after - key to start after, none to start from first pair
+     */
+    outcome::result<void> visitAfter(const boost::optional<std::string> &after,
+                                     const WhileVisitor &visitor);
+
+    /**
+     * Apply visitor for added, modified and removed values between two
+     * roots. Subtrees with same CID are not loaded.
+     */
+    static outcome::result<void> diff(IpldPtr ipld,
+                                      const CID &before,
+                                      const CID &after,
+                                      const DiffVisitor &visitor);
+
     /// Store CBOR encoded value by key
-    template <typename T>
-    outcome::result<void> setCbor(const std::string &key, const T &value) {
+    template <typename T, typename K>
+    outcome::result<void> setCbor(const K &key, const T &value) {
       OUTCOME_TRY(bytes, Ipld::encode(value));
       return set(key, bytes);
     }
 
     /// Get CBOR decoded value by key
-    template <typename T>
-    outcome::result<T> getCbor(const std::string &key) {
+    template <typename T, typename K>
+    outcome::result<T> getCbor(const K &key) {
       OUTCOME_TRY(bytes, get(key));
       return ipld->decode<T>(bytes);
     }
 
     /// Get CBOR decoded value by key
-    template <typename T>
-    outcome::result<boost::optional<T>> tryGetCbor(const std::string &key) {
+    template <typename T, typename K>
+    outcome::result<boost::optional<T>> tryGetCbor(const K &key) {
       auto maybe = get(key);
       if (!maybe) {
         if (maybe.error() != HamtError::kNotFound) {
@@ -198,10 +392,19 @@ namespace fc::storage::hamt {
       return std::move(value);
     }
 
+    /// Get node cache shared by all hamt instances
+    static NodeCache &nodeCache();
+
     IpldPtr ipld;
 
    private:
     std::vector<size_t> keyToIndices(const std::string &key, int n = -1) const;
+    /**
+     * Find value by key, nullptr if not present
+     * @param write - value is changed through returned pointer, so cids of
+     * nodes on path are reset and flush writes them
+     */
+    outcome::result<Value *> find(const HashedKey &key, bool write = false);
     outcome::result<void> set(Node &node,
                               gsl::span<const size_t> indices,
                               const std::string &key,
@@ -209,10 +412,25 @@ namespace fc::storage::hamt {
     outcome::result<void> remove(Node &node,
                                  gsl::span<const size_t> indices,
                                  const std::string &key);
+    outcome::result<void> updateMany(Node &node,
+                                     size_t depth,
+                                     const std::vector<HashedKey> &keys,
+                                     gsl::span<const size_t> order,
+                                     const ManyUpdater &updater);
     static outcome::result<void> cleanShard(Node::Item &item);
-    outcome::result<void> flush(Node::Item &item);
+    /// Flush children of nodes, each level of tree is hashed together
+    outcome::result<void> flush(const std::vector<Node *> &nodes,
+                                Ipld::Batch &batch);
     outcome::result<void> loadItem(Node::Item &item) const;
     outcome::result<void> visit(Node::Item &item, const Visitor &visitor);
+    outcome::result<bool> visitAfter(Node::Item &item,
+                                     const std::vector<size_t> *path,
+                                     size_t depth,
+                                     const std::string *after,
+                                     const WhileVisitor &visitor);
+    outcome::result<void> diff(Node::Item &before,
+                               Node::Item &after,
+                               const DiffVisitor &visitor);
 
     Node::Item root_;
     size_t bit_width_;
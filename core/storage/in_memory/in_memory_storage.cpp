@@ -44,8 +44,52 @@ namespace fc::storage {
     return std::make_unique<InMemoryBatch>(*this);
   }
 
+  /// Cursor over hex keys, which sort same as bytes
+  class InMemoryStorage::Cursor
+      : public fc::storage::face::MapCursor<Buffer, Buffer> {
+   public:
+    explicit Cursor(const std::map<std::string, Buffer> &storage)
+        : storage_{storage}, it_{storage.end()} {}
+
+    void seekToFirst() override {
+      it_ = storage_.begin();
+    }
+
+    void seek(const Buffer &key) override {
+      it_ = storage_.lower_bound(key.toHex());
+    }
+
+    void seekToLast() override {
+      it_ = storage_.empty() ? storage_.end() : std::prev(storage_.end());
+    }
+
+    bool isValid() const override {
+      return it_ != storage_.end();
+    }
+
+    void next() override {
+      ++it_;
+    }
+
+    void prev() override {
+      it_ = it_ == storage_.begin() ? storage_.end() : std::prev(it_);
+    }
+
+    Buffer key() const override {
+      return Buffer::fromHex(it_->first).value();
+    }
+
+    Buffer value() const override {
+      return it_->second;
+    }
+
+   private:
+    const std::map<std::string, Buffer> &storage_;
+    std::map<std::string, Buffer>::const_iterator it_;
+  };
+
   std::unique_ptr<fc::storage::face::MapCursor<Buffer, Buffer>>
   InMemoryStorage::cursor() {
-    return nullptr;
+    return std::make_unique<Cursor>(storage);
   }
 }
@@ -48,6 +48,8 @@ namespace fc::storage {
     cursor() override;
 
    private:
+    class Cursor;
+
     std::map<std::string, Buffer> storage;
   };
 
@@ -6,8 +6,14 @@
 #ifndef CPP_FILECOIN_CORE_STORAGE_IPFS_DATASTORE_HPP
 #define CPP_FILECOIN_CORE_STORAGE_IPFS_DATASTORE_HPP
 
+#include <functional>
+#include <mutex>
+#include <typeindex>
+#include <unordered_map>
 #include <vector>
 
+#include <boost/optional.hpp>
+
 #include "codec/cbor/cbor.hpp"
 #include "storage/ipfs/ipfs_datastore_error.hpp"
 
@@ -16,6 +22,11 @@ namespace fc::storage::ipfs {
   class IpfsDatastore {
    public:
     using Value = common::Buffer;
+    /// Key value pairs written together
+    using Batch = std::vector<std::pair<CID, Value>>;
+    /// Receives borrowed value bytes, valid only during call
+    using ViewCallback =
+        std::function<outcome::result<void>(gsl::span<const uint8_t>)>;
 
     virtual ~IpfsDatastore() = default;
 
@@ -34,6 +45,19 @@ namespace fc::storage::ipfs {
      */
     virtual outcome::result<void> set(const CID &key, Value value) = 0;
 
+    /**
+     * @brief associates keys with values, implementations may write all
+     * pairs at once
+     * @param batch pairs to store
+     * @return success if operation succeeded, error otherwise
+     */
+    virtual outcome::result<void> setMany(Batch batch) {
+      for (auto &[key, value] : batch) {
+        OUTCOME_TRY(set(key, std::move(value)));
+      }
+      return outcome::success();
+    }
+
     /**
      * @brief searches for a key in data store
      * @param key key to find
@@ -41,6 +65,20 @@ namespace fc::storage::ipfs {
      */
     virtual outcome::result<Value> get(const CID &key) const = 0;
 
+    /**
+     * @brief searches for a key and passes value to callback without copying
+     * it when implementation allows
+     * @param key key to find
+     * @param callback receives value bytes, which must not be used after
+     * callback returns
+     * @return callback result or error
+     */
+    virtual outcome::result<void> view(const CID &key,
+                                       const ViewCallback &callback) const {
+      OUTCOME_TRY(value, get(key));
+      return callback(value);
+    }
+
     /**
      * @brief removes key from data store
      * @param key key to remove
@@ -50,6 +88,23 @@ namespace fc::storage::ipfs {
 
     virtual std::shared_ptr<IpfsDatastore> shared() = 0;
 
+    /**
+     * @brief cache of decoded values owned by this store, created on first
+     * use, so values cached through one store are not served by another
+     * @tparam Cache - thread safe cache type, one instance per store
+     * @param args - constructor arguments of cache
+     * @return cache of this store
+     */
+    template <typename Cache, typename... Args>
+    Cache &cache(Args &&...args) const {
+      std::lock_guard lock{caches_->mutex};
+      auto &cache{caches_->caches[std::type_index{typeid(Cache)}]};
+      if (!cache) {
+        cache = std::make_shared<Cache>(std::forward<Args>(args)...);
+      }
+      return *std::static_pointer_cast<Cache>(cache);
+    }
+
     /**
      * @brief CBOR-serialize value and store
      * @param value - data to serialize and store
@@ -59,15 +114,50 @@ namespace fc::storage::ipfs {
     outcome::result<CID> setCbor(const T &value) {
       OUTCOME_TRY(bytes, encode(value));
       OUTCOME_TRY(key, common::getCidOf(bytes));
-      OUTCOME_TRY(set(key, Value(bytes)));
+      OUTCOME_TRY(set(key, Value(std::move(bytes))));
       return std::move(key);
     }
 
-    /// Get CBOR decoded value by CID
+    /**
+     * @brief CBOR-serialize value and append to batch
+     * @param batch - pairs to be written by setMany
+     * @param value - data to serialize
+     * @return cid of CBOR-serialized data
+     */
+    template <typename T>
+    static outcome::result<CID> addCbor(Batch &batch, const T &value) {
+      OUTCOME_TRY(bytes, encode(value));
+      OUTCOME_TRY(key, common::getCidOf(bytes));
+      batch.emplace_back(key, std::move(bytes));
+      return std::move(key);
+    }
+
+    /**
+     * Adds encoded values to batch, hashing them together
+     * @param batch - pairs to be written by setMany
+     * @param values - encoded values
+     * @return cids of values
+     */
+    static outcome::result<std::vector<CID>> addMany(
+        Batch &batch, std::vector<Value> values) {
+      std::vector<gsl::span<const uint8_t>> inputs{values.begin(),
+                                                   values.end()};
+      OUTCOME_TRY(keys, common::getCidsOf(inputs));
+      for (size_t i = 0; i < values.size(); ++i) {
+        batch.emplace_back(keys[i], std::move(values[i]));
+      }
+      return std::move(keys);
+    }
+
+    /// Get CBOR decoded value by CID, decodes borrowed bytes
     template <typename T>
     outcome::result<T> getCbor(const CID &key) const {
-      OUTCOME_TRY(bytes, get(key));
-      return decode<T>(bytes);
+      boost::optional<T> value;
+      OUTCOME_TRY(view(key, [&](auto bytes) -> outcome::result<void> {
+        OUTCOME_TRYA(value, decode<T>(bytes));
+        return outcome::success();
+      }));
+      return std::move(*value);
     }
 
     template <typename T>
@@ -119,6 +209,13 @@ namespace fc::storage::ipfs {
         return outcome::success();
       }
     };
+
+   private:
+    struct Caches {
+      std::mutex mutex;
+      std::unordered_map<std::type_index, std::shared_ptr<void>> caches;
+    };
+    std::shared_ptr<Caches> caches_{std::make_shared<Caches>()};
   };
 }  // namespace fc::storage::ipfs
 
@@ -8,6 +8,7 @@
 
 #include <functional>
 
+#include <boost/asio/thread_pool.hpp>
 #include <boost/optional.hpp>
 #include <libp2p/multi/multiaddress.hpp>
 #include <libp2p/peer/peer_id.hpp>
@@ -15,24 +16,26 @@
 
 #include "common/buffer.hpp"
 #include "common/outcome.hpp"
+#include "storage/ipfs/datastore.hpp"
 #include "storage/ipfs/graphsync/extension.hpp"
 
-namespace fc::storage::ipfs::merkledag {
-  class MerkleDagService;
-}
-
 namespace fc::storage::ipfs::graphsync {
 
   /// Subscription to any data stream, borrowed from libp2p
   using libp2p::protocol::Subscription;
 
-  /// Graphsync -> MerkleDagService bridge
+  /// Graphsync -> ipld store bridge
   struct MerkleDagBridge {
     /// Creates a default bridge
-    /// \param service Existing MerkleDAG service
+    /// \param ipld Existing ipld store
+    /// \param pool Optional worker pool prefetching blocks, store must
+    /// support concurrent reads
+    /// \param prefetch Count of blocks fetched ahead
     /// \return Bridge object
     static std::shared_ptr<MerkleDagBridge> create(
-        std::shared_ptr<merkledag::MerkleDagService> service);
+        IpldPtr ipld,
+        std::shared_ptr<boost::asio::thread_pool> pool = nullptr,
+        size_t prefetch = 0);
 
     virtual ~MerkleDagBridge() = default;
 
@@ -47,6 +50,25 @@ namespace fc::storage::ipfs::graphsync {
         gsl::span<const uint8_t> selector,
         std::function<bool(const CID &cid, const common::Buffer &data)> handler)
         const = 0;
+
+    /// Selected block
+    using Block = std::pair<CID, common::Buffer>;
+
+    /// Resumable selection, allows to pause walk while peer is slow
+    struct Selection {
+      virtual ~Selection() = default;
+
+      /// Returns next selected block, none if selection is completed
+      virtual outcome::result<boost::optional<Block>> next() = 0;
+    };
+
+    /// Starts resumable selection. Default implementation collects all blocks
+    /// with select()
+    /// \param cid Root CID
+    /// \param selector IPLD selector
+    /// \return Selection object or error
+    virtual outcome::result<std::shared_ptr<Selection>> startSelect(
+        const CID &cid, gsl::span<const uint8_t> selector) const;
   };
 
   /// Response status codes. Positive values are received from wire,
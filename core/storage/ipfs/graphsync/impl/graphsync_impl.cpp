@@ -5,9 +5,14 @@
 
 #include "graphsync_impl.hpp"
 
+#include <algorithm>
 #include <cassert>
 
+#include <boost/asio/post.hpp>
+
 #include "local_requests.hpp"
+#include "storage/ipfs/graphsync/extension.hpp"
+#include "network/marshalling/response_builder.hpp"
 #include "network/network.hpp"
 
 namespace fc::storage::ipfs::graphsync {
@@ -16,8 +21,15 @@ namespace fc::storage::ipfs::graphsync {
 
   GraphsyncImpl::GraphsyncImpl(
       std::shared_ptr<libp2p::Host> host,
-      std::shared_ptr<libp2p::protocol::Scheduler> scheduler)
+      std::shared_ptr<libp2p::protocol::Scheduler> scheduler,
+      std::shared_ptr<boost::asio::io_context> io,
+      size_t select_threads)
       : scheduler_(scheduler),
+        io_(std::move(io)),
+        select_pool_(io_ && select_threads != 0
+                         ? std::make_shared<boost::asio::thread_pool>(
+                             select_threads)
+                         : nullptr),
         network_(std::make_shared<Network>(std::move(host), scheduler)),
         local_requests_(std::make_shared<LocalRequests>(
             std::move(scheduler),
@@ -48,6 +60,8 @@ namespace fc::storage::ipfs::graphsync {
     if (started_) {
       started_ = false;
       block_cb_ = Graphsync::BlockCallback{};
+      paused_.clear();
+      responding_.clear();
       dag_.reset();
       network_->stop();
       local_requests_->cancelAll();
@@ -71,11 +85,38 @@ namespace fc::storage::ipfs::graphsync {
       selector = kSelectorMatcher;
     }
 
-    auto newRequest = local_requests_->newRequest(
-        root_cid, selector, extensions, std::move(callback));
+    // requests with extensions, like data transfer vouchers, must reach
+    // peer even if all blocks are local
+    auto may_complete = extensions.empty();
+
+    if (select_pool_) {
+      auto reserved = local_requests_->reserveRequest(
+          peer, root_cid, selector, extensions, std::move(callback));
+      if (reserved.pending) {
+        lookupLocal({peer,
+                     std::move(address),
+                     reserved.request_id,
+                     root_cid,
+                     common::Buffer{selector},
+                     extensions});
+      }
+      return std::move(reserved.subscription);
+    }
 
-    if (newRequest.request_id > 0) {
-      assert(newRequest.body);
+    std::vector<CID> local_cids;
+    if (selectLocal(*dag_, root_cid, selector, local_cids) && may_complete) {
+      logger()->trace("makeRequest: all blocks found locally");
+      return local_requests_->newCompletedRequest(std::move(callback));
+    }
+
+    auto newRequest = local_requests_->newRequest(peer,
+                                                  root_cid,
+                                                  selector,
+                                                  extensions,
+                                                  std::move(callback),
+                                                  local_cids);
+
+    if (newRequest.request_id > 0 && newRequest.body) {
       assert(!newRequest.body->empty());
 
       logger()->trace("makeRequest: sending request to peer {}",
@@ -90,6 +131,61 @@ namespace fc::storage::ipfs::graphsync {
     return std::move(newRequest.subscription);
   }
 
+  void GraphsyncImpl::lookupLocal(PendingRequest request) {
+    boost::asio::post(
+        *select_pool_,
+        [wptr{weak_from_this()}, dag{dag_}, io{io_}, request]() mutable {
+          std::vector<CID> local_cids;
+          auto all_local = selectLocal(
+              *dag, request.root_cid, request.selector, local_cids);
+          boost::asio::post(*io,
+                            [wptr,
+                             request{std::move(request)},
+                             all_local,
+                             local_cids{std::move(local_cids)}]() mutable {
+                              if (auto self = wptr.lock()) {
+                                self->sendRequest(std::move(request),
+                                                  all_local,
+                                                  local_cids);
+                              }
+                            });
+        });
+  }
+
+  void GraphsyncImpl::sendRequest(PendingRequest request,
+                                  bool all_local,
+                                  const std::vector<CID> &local_cids) {
+    // request may be cancelled or stopped while blocks were looked up
+    if (!started_ || !local_requests_->isActive(request.request_id)) {
+      return;
+    }
+
+    if (all_local && request.extensions.empty()) {
+      logger()->trace("makeRequest: all blocks found locally");
+      local_requests_->onResponse(request.request_id, RS_FULL_CONTENT, {});
+      return;
+    }
+
+    auto body_res = local_requests_->serializeRequest(request.request_id,
+                                                      request.root_cid,
+                                                      request.selector,
+                                                      request.extensions,
+                                                      local_cids);
+    if (!body_res) {
+      local_requests_->onResponse(
+          request.request_id, RS_REJECTED_LOCALLY, {});
+      return;
+    }
+
+    logger()->trace("makeRequest: sending request to peer {}",
+                    request.peer.toBase58().substr(46));
+
+    network_->makeRequest(request.peer,
+                          std::move(request.address),
+                          request.request_id,
+                          std::move(body_res.value()));
+  }
+
   void GraphsyncImpl::onResponse(const PeerId &peer,
                                  int request_id,
                                  ResponseStatusCode status,
@@ -112,47 +208,309 @@ namespace fc::storage::ipfs::graphsync {
       return;
     }
 
+    peerBytes(from).received.inc(data.size());
     block_cb_(std::move(cid), std::move(data));
   }
 
   void GraphsyncImpl::onRemoteRequest(const PeerId &from,
                                       Message::Request request) {
-    // TODO make this asynchronous
-
-    bool send_response = true;
-
-    auto data_handler = [&](const CID &cid,
-                            const common::Buffer &data) -> bool {
-      bool data_present = !data.empty();
+    if (!started_) {
+      return;
+    }
 
-      if (data_present) {
-        if (!network_->addBlockToResponse(from, request.id, cid, data)) {
-          send_response = false;
-          return false;
+    std::set<CID> dont_send;
+    for (const auto &extension : request.extensions) {
+      if (extension.name == kDontSendCidsProtocol) {
+        auto cids_res = decodeDontSendCids(extension);
+        if (cids_res) {
+          dont_send = std::move(cids_res.value());
         }
       }
+    }
 
-      return true;
-    };
+    responding_[from].insert(request.id);
 
-    auto select_res =
-        dag_->select(request.root_cid, request.selector, data_handler);
+    if (select_pool_) {
+      // selection is started by worker too, as it loads root block
+      scheduleBatch(
+          {from, std::move(request), nullptr, 0, std::move(dont_send)});
+      return;
+    }
 
-    if (!send_response) {
-      // ignore response due to network side
+    auto selection_res =
+        dag_->startSelect(request.root_cid, request.selector);
+    if (!selection_res) {
+      responding_[from].erase(request.id);
+      network_->sendResponse(
+          from, request.id, RS_REQUEST_FAILED, request.extensions);
       return;
     }
 
-    ResponseStatusCode status = RS_REQUEST_FAILED;
-    if (select_res) {
-      if (select_res.value() > 0) {
-        status = RS_FULL_CONTENT;
+    resume({from,
+            std::move(request),
+            std::move(selection_res.value()),
+            0,
+            std::move(dont_send)});
+  }
+
+  void GraphsyncImpl::onPeerWritable(const PeerId &peer) {
+    if (!started_) {
+      return;
+    }
+
+    std::deque<RemoteResponse> responses;
+    for (auto it = paused_.begin(); it != paused_.end();) {
+      if (it->peer == peer) {
+        responses.push_back(std::move(*it));
+        it = paused_.erase(it);
       } else {
-        status = RS_NOT_FOUND;
+        ++it;
+      }
+    }
+
+    for (auto &response : responses) {
+      resume(std::move(response));
+    }
+  }
+
+  void GraphsyncImpl::onRemoteCancel(const PeerId &peer,
+                                     RequestId request_id) {
+    if (!started_) {
+      return;
+    }
+
+    auto it = responding_.find(peer);
+    if (it != responding_.end()) {
+      it->second.erase(request_id);
+    }
+    dropPaused(peer, [&](RequestId id) { return id == request_id; });
+  }
+
+  void GraphsyncImpl::onPeerClosed(const PeerId &peer) {
+    if (!started_) {
+      return;
+    }
+
+    responding_.erase(peer);
+    dropPaused(peer, [](RequestId) { return true; });
+  }
+
+  template <typename Pred>
+  void GraphsyncImpl::dropPaused(const PeerId &peer, const Pred &pred) {
+    paused_.erase(std::remove_if(paused_.begin(),
+                                 paused_.end(),
+                                 [&](const RemoteResponse &response) {
+                                   return response.peer == peer
+                                          && pred(response.request.id);
+                                 }),
+                  paused_.end());
+  }
+
+  bool GraphsyncImpl::isResponding(const RemoteResponse &response) const {
+    auto it = responding_.find(response.peer);
+    return it != responding_.end()
+           && it->second.count(response.request.id) != 0;
+  }
+
+  void GraphsyncImpl::finish(const RemoteResponse &response) {
+    auto it = responding_.find(response.peer);
+    if (it == responding_.end()) {
+      return;
+    }
+    it->second.erase(response.request.id);
+    if (it->second.empty()) {
+      responding_.erase(it);
+    }
+  }
+
+  void GraphsyncImpl::resume(RemoteResponse response) {
+    if (!isResponding(response)) {
+      return;
+    }
+
+    if (select_pool_) {
+      scheduleBatch(std::move(response));
+      return;
+    }
+
+    while (network_->isWritable(response.peer)) {
+      auto block_res = response.selection->next();
+      if (!block_res) {
+        finish(response);
+        network_->sendResponse(response.peer,
+                               response.request.id,
+                               RS_REQUEST_FAILED,
+                               response.request.extensions);
+        return;
+      }
+
+      auto &block = block_res.value();
+      if (!block) {
+        finish(response);
+        network_->sendResponse(
+            response.peer,
+            response.request.id,
+            response.blocks > 0 ? RS_FULL_CONTENT : RS_NOT_FOUND,
+            response.request.extensions);
+        return;
+      }
+
+      ++response.blocks;
+      if (response.dont_send.count(block->first) != 0) {
+        continue;
+      }
+      if (!block->second.empty()
+          && !network_->addBlockToResponse(response.peer,
+                                           response.request.id,
+                                           block->first,
+                                           block->second)) {
+        // ignore response due to network side
+        finish(response);
+        return;
+      }
+      peerBytes(response.peer).sent.inc(block->second.size());
+    }
+
+    paused_.push_back(std::move(response));
+  }
+
+  outcome::result<GraphsyncImpl::Batch> GraphsyncImpl::prepareBatch(
+      RemoteResponse &response) {
+    ResponseBuilder builder;
+    Batch batch;
+    // non-terminal, more messages follow
+    auto status{RS_PARTIAL_RESPONSE};
+    ResponseMetadata metadata;
+    while (!batch.last && batch.block_bytes < kMaxResponseBatchSize) {
+      OUTCOME_TRY(block, response.selection->next());
+      if (!block) {
+        batch.last = true;
+        status = response.blocks > 0 ? RS_FULL_CONTENT : RS_NOT_FOUND;
+        break;
       }
+      ++response.blocks;
+      if (!block->second.empty()
+          && response.dont_send.count(block->first) == 0) {
+        builder.addDataBlock(block->first, block->second);
+        batch.block_bytes += block->second.size();
+        metadata.emplace_back(block->first, true);
+      }
+    }
+    std::vector<Extension> extensions;
+    bool wants_metadata{false};
+    for (const auto &extension : response.request.extensions) {
+      if (extension.name == kResponseMetadataProtocol) {
+        wants_metadata = true;
+      } else if (batch.last && extension.name != kDontSendCidsProtocol) {
+        extensions.push_back(extension);
+      }
+    }
+    if (wants_metadata) {
+      // lets requester record progress and resume after failure
+      extensions.push_back(encodeResponseMetadata(metadata));
+    }
+    builder.addResponse(response.request.id, status, extensions);
+    OUTCOME_TRYA(batch.message, builder.serialize());
+    return batch;
+  }
+
+  void GraphsyncImpl::scheduleBatch(RemoteResponse response) {
+    boost::asio::post(
+        *select_pool_,
+        [wptr{weak_from_this()}, dag{dag_}, io{io_}, response]() mutable {
+          outcome::result<Batch> batch{outcome::success()};
+          if (!response.selection) {
+            auto selection_res = dag->startSelect(response.request.root_cid,
+                                                  response.request.selector);
+            if (selection_res) {
+              response.selection = std::move(selection_res.value());
+            } else {
+              batch = selection_res.error();
+            }
+          }
+          if (response.selection) {
+            batch = prepareBatch(response);
+          }
+          boost::asio::post(*io,
+                            [wptr,
+                             response{std::move(response)},
+                             batch{std::move(batch)}]() mutable {
+                              if (auto self = wptr.lock()) {
+                                self->onBatch(std::move(response),
+                                              std::move(batch));
+                              }
+                            });
+        });
+  }
+
+  void GraphsyncImpl::onBatch(RemoteResponse response,
+                              outcome::result<Batch> batch) {
+    // response is dropped if peer cancelled it or closed meanwhile
+    if (!started_ || !isResponding(response)) {
+      return;
+    }
+
+    if (!batch) {
+      finish(response);
+      network_->sendResponse(response.peer,
+                             response.request.id,
+                             RS_REQUEST_FAILED,
+                             response.request.extensions);
+      return;
     }
 
-    network_->sendResponse(from, request.id, status, request.extensions);
+    network_->sendSerializedResponse(
+        response.peer, response.request.id, std::move(batch.value().message));
+    peerBytes(response.peer).sent.inc(batch.value().block_bytes);
+    if (batch.value().last) {
+      finish(response);
+      return;
+    }
+
+    if (network_->isWritable(response.peer)) {
+      scheduleBatch(std::move(response));
+    } else {
+      paused_.push_back(std::move(response));
+    }
+  }
+
+  bool GraphsyncImpl::selectLocal(MerkleDagBridge &dag,
+                                  const CID &root_cid,
+                                  gsl::span<const uint8_t> selector,
+                                  std::vector<CID> &found) {
+    auto selection_res = dag.startSelect(root_cid, selector);
+    if (!selection_res) {
+      return false;
+    }
+    while (found.size() < kMaxLocalBlocks) {
+      // fails on first block missing locally
+      auto block_res = selection_res.value()->next();
+      if (!block_res) {
+        return false;
+      }
+      if (!block_res.value()) {
+        return !found.empty();
+      }
+      found.push_back(block_res.value()->first);
+    }
+    return false;
+  }
+
+  GraphsyncImpl::PeerBytes &GraphsyncImpl::peerBytes(const PeerId &peer) {
+    auto it{peer_bytes_.find(peer)};
+    if (it == peer_bytes_.end()) {
+      auto &registry{metrics::Registry::global()};
+      auto counter{[&](const char *direction) -> metrics::Counter & {
+        return registry.counter("fc_graphsync_block_bytes_total",
+                                "Bytes of graphsync blocks by peer",
+                                {{"peer", peer.toBase58()},
+                                 {"direction", direction}});
+      }};
+      it = peer_bytes_
+               .emplace(peer, PeerBytes{counter("received"), counter("sent")})
+               .first;
+    }
+    return it->second;
   }
 
   void GraphsyncImpl::cancelLocalRequest(RequestId request_id,
@@ -6,10 +6,15 @@
 #ifndef CPP_FILECOIN_GRAPHSYNC_IMPL_HPP
 #define CPP_FILECOIN_GRAPHSYNC_IMPL_HPP
 
+#include <deque>
 #include <set>
+#include <unordered_map>
 
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <libp2p/protocol/common/scheduler.hpp>
 
+#include "metrics/metrics.hpp"
 #include "network/network_fwd.hpp"
 
 namespace libp2p {
@@ -22,16 +27,32 @@ namespace fc::storage::ipfs::graphsync {
   class LocalRequests;
   class Network;
 
-  /// Core graphsync component. The central module
+  /// Core graphsync component. The central module.
+  /// Network and request state live on io thread of libp2p host. Selection
+  /// of response blocks and their marshalling may run on worker threads,
+  /// one batch per response at a time, so responses to many peers are
+  /// prepared in parallel and io thread only enqueues ready messages
   class GraphsyncImpl : public Graphsync,
                         public std::enable_shared_from_this<GraphsyncImpl>,
                         public PeerToGraphsyncFeedback {
    public:
+    /// Worker threads preparing responses, when enabled by owner
+    static constexpr size_t kSelectThreadsDefault = 4;
+
+    /// Blocks of request looked up locally, which are not requested from
+    /// peer, on worker if enabled. Request without extensions is completed
+    /// locally if all its blocks are found
+    static constexpr size_t kMaxLocalBlocks = 1024;
+
     /// Ctor.
     /// \param host libp2p host object
     /// \param scheduler libp2p scheduler
+    /// \param io io context of host, workers post prepared batches to it
+    /// \param select_threads worker threads, 0 selects on io thread
     GraphsyncImpl(std::shared_ptr<libp2p::Host> host,
-                  std::shared_ptr<libp2p::protocol::Scheduler> scheduler);
+                  std::shared_ptr<libp2p::protocol::Scheduler> scheduler,
+                  std::shared_ptr<boost::asio::io_context> io = nullptr,
+                  size_t select_threads = 0);
 
     ~GraphsyncImpl() override;
 
@@ -60,13 +81,115 @@ namespace fc::storage::ipfs::graphsync {
                     std::vector<Extension> extensions) override;
     void onBlock(const PeerId &from, CID cid, common::Buffer data) override;
     void onRemoteRequest(const PeerId &from, Message::Request request) override;
+    void onPeerWritable(const PeerId &peer) override;
+    void onRemoteCancel(const PeerId &peer, RequestId request_id) override;
+    void onPeerClosed(const PeerId &peer) override;
+
+    /// Response to remote request which is being walked
+    struct RemoteResponse {
+      PeerId peer;
+      Message::Request request;
+      std::shared_ptr<MerkleDagBridge::Selection> selection;
+      size_t blocks{};
+      /// Blocks requester has, counted but not sent
+      std::set<CID> dont_send;
+    };
+
+    /// Walks request selection in local store, may run on worker thread
+    /// \param dag local store
+    /// \param root_cid root CID of request
+    /// \param selector IPLD selector
+    /// \param found receives CIDs of blocks found, up to kMaxLocalBlocks
+    /// \return true if all blocks of selection were found
+    static bool selectLocal(MerkleDagBridge &dag,
+                            const CID &root_cid,
+                            gsl::span<const uint8_t> selector,
+                            std::vector<CID> &found);
+
+    /// Request reserved while its local blocks are looked up on worker
+    struct PendingRequest {
+      PeerId peer;
+      boost::optional<libp2p::multi::Multiaddress> address;
+      RequestId request_id{};
+      CID root_cid;
+      common::Buffer selector;
+      std::vector<Extension> extensions;
+    };
+
+    /// Looks up local blocks of request on worker, then sends it on io
+    /// \param request reserved request
+    void lookupLocal(PendingRequest request);
+
+    /// Completes request from local blocks if it has no extensions, sends
+    /// it to peer otherwise, on io thread
+    /// \param request reserved request
+    /// \param all_local whether all blocks of request were found locally
+    /// \param local_cids blocks found locally, not sent by peer
+    void sendRequest(PendingRequest request,
+                     bool all_local,
+                     const std::vector<CID> &local_cids);
+
+    /// Whether response was neither finished nor cancelled
+    /// \param response response in progress
+    bool isResponding(const RemoteResponse &response) const;
+
+    /// Forgets response after its last message or failure
+    /// \param response response in progress
+    void finish(const RemoteResponse &response);
+
+    /// Drops paused responses of peer matching predicate
+    /// \param peer peer ID
+    /// \param pred predicate on request ID
+    template <typename Pred>
+    void dropPaused(const PeerId &peer, const Pred &pred);
+
+    /// Walks selection while peer send window is open, pauses otherwise
+    /// \param response response in progress
+    void resume(RemoteResponse response);
+
+    /// Response message prepared by worker
+    struct Batch {
+      SharedData message;
+      size_t block_bytes{};
+      bool last{};
+    };
+
+    /// Selects blocks up to batch size and serializes them with status,
+    /// runs on worker thread
+    /// \param response response in progress
+    static outcome::result<Batch> prepareBatch(RemoteResponse &response);
+
+    /// Prepares next batch of response on worker
+    /// \param response response in progress
+    void scheduleBatch(RemoteResponse response);
+
+    /// Sends batch prepared by worker, on io thread
+    /// \param response response in progress
+    /// \param batch prepared message
+    void onBatch(RemoteResponse response, outcome::result<Batch> batch);
 
     /// NVI for stop()
     void doStop();
 
+    /// Block bytes exchanged with peer, registered on first use
+    struct PeerBytes {
+      metrics::Counter &received;
+      metrics::Counter &sent;
+    };
+
+    /// Cached counters of peer
+    /// \param peer peer ID
+    PeerBytes &peerBytes(const PeerId &peer);
+
     /// Scheduler for libp2p
     std::shared_ptr<libp2p::protocol::Scheduler> scheduler_;
 
+    /// Io context of host, used with workers only
+    std::shared_ptr<boost::asio::io_context> io_;
+
+    /// Workers selecting and marshalling response blocks, optional
+    std::shared_ptr<boost::asio::thread_pool> select_pool_;
+
     /// Network module
     std::shared_ptr<Network> network_;
 
@@ -79,6 +202,15 @@ namespace fc::storage::ipfs::graphsync {
     /// The only subscription to blocks (at the moment)
     Graphsync::BlockCallback block_cb_;
 
+    /// Responses paused until their peers become writable
+    std::deque<RemoteResponse> paused_;
+
+    /// Requests of peers being responded, including paused and on worker
+    std::unordered_map<PeerId, std::set<RequestId>> responding_;
+
+    /// Metrics of peers, so registry is not locked for every block
+    std::unordered_map<PeerId, PeerBytes> peer_bytes_;
+
     /// Flag, indicates that instance is started
     bool started_ = false;
   };
@@ -7,6 +7,8 @@
 
 #include "local_requests.hpp"
 
+#include "storage/ipfs/graphsync/extension.hpp"
+
 namespace fc::storage::ipfs::graphsync {
 
   LocalRequests::LocalRequests(
@@ -18,11 +20,68 @@ namespace fc::storage::ipfs::graphsync {
   }
 
   LocalRequests::NewRequest LocalRequests::newRequest(
+      const PeerId &peer,
+      const CID &root_cid,
+      gsl::span<const uint8_t> selector,
+      const std::vector<Extension> &extensions,
+      Graphsync::RequestProgressCallback callback,
+      const std::vector<CID> &dont_send_cids) {
+    auto ctx = reserveRequest(
+        peer, root_cid, selector, extensions, std::move(callback));
+    if (!ctx.pending) {
+      return ctx;
+    }
+    auto body_res = serializeRequest(
+        ctx.request_id, root_cid, selector, extensions, dont_send_cids);
+    if (!body_res) {
+      auto callbacks = closeRequest(ctx.request_id);
+      ctx.subscription = newRejectedRequest(std::move(callbacks.front()));
+      ctx.request_id = current_rejected_request_id_;
+      ctx.pending = false;
+      return ctx;
+    }
+    ctx.body = std::move(body_res.value());
+    ctx.pending = false;
+    return ctx;
+  }
+
+  LocalRequests::NewRequest LocalRequests::reserveRequest(
+      const PeerId &peer,
       const CID &root_cid,
       gsl::span<const uint8_t> selector,
       const std::vector<Extension> &extensions,
       Graphsync::RequestProgressCallback callback) {
     NewRequest ctx;
+
+    common::Buffer key_bytes;
+    auto root_res = root_cid.toBytes();
+    if (root_res) {
+      // length prefixes keep fields apart
+      auto put = [&](gsl::span<const uint8_t> bytes) {
+        key_bytes.putUint64(bytes.size());
+        key_bytes.put(bytes);
+      };
+      put(peer.toVector());
+      put(root_res.value());
+      put(selector);
+      for (const auto &extension : extensions) {
+        put(gsl::make_span(
+            reinterpret_cast<const uint8_t *>(extension.name.data()),
+            extension.name.size()));
+        put(extension.data);
+      }
+    }
+    auto key = crypto::blake2b::blake2b_256(key_bytes);
+
+    auto existing = requests_by_key_.find(key);
+    if (root_res && existing != requests_by_key_.end()) {
+      ctx.request_id = existing->second;
+      ctx.subscription = Subscription(
+          subscribe(ctx.request_id, std::move(callback)), weak_from_this());
+      logger()->trace("{}: joined id={}", __FUNCTION__, ctx.request_id);
+      return ctx;
+    }
+
     ctx.request_id = nextRequestId();
     if (ctx.request_id == 0) {
       // Will likely not get here, possible iff INT_MAX simultaneous requests
@@ -32,23 +91,93 @@ namespace fc::storage::ipfs::graphsync {
       return ctx;
     }
 
-    request_builder_.addRequest(ctx.request_id, root_cid, selector, extensions);
+    active_requests_[ctx.request_id].key = key;
+    if (root_res) {
+      requests_by_key_[key] = ctx.request_id;
+    }
+    ctx.subscription = Subscription(
+        subscribe(ctx.request_id, std::move(callback)), weak_from_this());
+    ctx.pending = true;
+
+    logger()->trace("{}: id={}", __FUNCTION__, ctx.request_id);
+
+    return ctx;
+  }
+
+  outcome::result<SharedData> LocalRequests::serializeRequest(
+      RequestId request_id,
+      const CID &root_cid,
+      gsl::span<const uint8_t> selector,
+      const std::vector<Extension> &extensions,
+      const std::vector<CID> &dont_send_cids) {
+    if (dont_send_cids.empty()) {
+      request_builder_.addRequest(request_id, root_cid, selector, extensions);
+    } else {
+      // merged with cids caller doesn't want, e.g. received before restart
+      std::set<CID> cids{dont_send_cids.begin(), dont_send_cids.end()};
+      std::vector<Extension> wire_extensions;
+      for (const auto &extension : extensions) {
+        if (extension.name != kDontSendCidsProtocol) {
+          wire_extensions.push_back(extension);
+        } else if (auto decoded = decodeDontSendCids(extension)) {
+          cids.insert(decoded.value().begin(), decoded.value().end());
+        }
+      }
+      wire_extensions.push_back(encodeDontSendCids({cids.begin(), cids.end()}));
+      request_builder_.addRequest(
+          request_id, root_cid, selector, wire_extensions);
+    }
     auto serialize_res = request_builder_.serialize();
     request_builder_.clear();
     if (!serialize_res) {
       logger()->error("{}: serialize failed", __FUNCTION__);
-      ctx.subscription = newRejectedRequest(std::move(callback));
-      ctx.request_id = current_rejected_request_id_;
-      return ctx;
+      return serialize_res.error();
     }
+    return std::move(serialize_res.value());
+  }
 
-    ctx.subscription = Subscription(ctx.request_id, weak_from_this());
-    ctx.body = std::move(serialize_res.value());
-    active_requests_[ctx.request_id] = std::move(callback);
+  bool LocalRequests::isActive(RequestId request_id) const {
+    return active_requests_.count(request_id) != 0;
+  }
 
-    logger()->trace("{}: id={}", __FUNCTION__, ctx.request_id);
+  uint64_t LocalRequests::subscribe(
+      RequestId request_id, Graphsync::RequestProgressCallback callback) {
+    auto ticket = ++current_ticket_;
+    active_requests_[request_id].callbacks[ticket] = std::move(callback);
+    tickets_[ticket] = request_id;
+    return ticket;
+  }
 
-    return ctx;
+  std::vector<Graphsync::RequestProgressCallback> LocalRequests::closeRequest(
+      RequestId request_id) {
+    std::vector<Graphsync::RequestProgressCallback> callbacks;
+    auto it = active_requests_.find(request_id);
+    if (it == active_requests_.end()) {
+      return callbacks;
+    }
+    auto by_key = requests_by_key_.find(it->second.key);
+    if (by_key != requests_by_key_.end() && by_key->second == request_id) {
+      requests_by_key_.erase(by_key);
+    }
+    for (auto &[ticket, cb] : it->second.callbacks) {
+      tickets_.erase(ticket);
+      callbacks.push_back(std::move(cb));
+    }
+    active_requests_.erase(it);
+    return callbacks;
+  }
+
+  Subscription LocalRequests::newCompletedRequest(
+      Graphsync::RequestProgressCallback callback) {
+    RequestId request_id = --current_rejected_request_id_;
+    if (request_id == 0) {
+      logger()->error("{}: rejected request ids exhausted", __FUNCTION__);
+      // virtually impossible
+      return Subscription();
+    }
+    completed_requests_[request_id] = std::move(callback);
+    asyncNotifyRejectedRequests();
+    return Subscription(request_id, weak_from_this());
   }
 
   Subscription LocalRequests::newRejectedRequest(
@@ -73,25 +202,29 @@ namespace fc::storage::ipfs::graphsync {
           "{}: cannot find request, id={}", __FUNCTION__, request_id);
       return;
     }
+    std::vector<Graphsync::RequestProgressCallback> callbacks;
     if (isTerminal(status)) {
-      auto cb = std::move(it->second);
-      active_requests_.erase(it);
-      cb(status, std::move(extensions));
+      callbacks = closeRequest(request_id);
     } else {
-      // make copy, reentrancy is allowed here
-      auto cb = it->second;
-      cb(status, std::move(extensions));
+      // make copies, reentrancy is allowed here
+      for (const auto &[_, cb] : it->second.callbacks) {
+        callbacks.push_back(cb);
+      }
+    }
+    for (const auto &cb : callbacks) {
+      cb(status, extensions);
     }
   }
 
-  void LocalRequests::cancelAll(LocalRequests::RequestMap &requests) {
+  void LocalRequests::cancelAll(LocalRequests::RequestMap &requests,
+                                ResponseStatusCode status) {
     if (requests.empty()) {
       return;
     }
     RequestMap m;
     std::swap(m, requests);
     for (const auto &[_, cb] : m) {
-      cb(RS_REJECTED_LOCALLY, {});
+      cb(status, {});
     }
   }
 
@@ -103,34 +236,58 @@ namespace fc::storage::ipfs::graphsync {
     scheduler_
         ->schedule([wptr = weak_from_this(), this]() {
           if (!wptr.expired()) {
-            cancelAll(rejected_requests_);
-            if (rejected_requests_.empty()) {
+            rejected_notify_scheduled_ = false;
+            cancelAll(rejected_requests_, RS_REJECTED_LOCALLY);
+            cancelAll(completed_requests_, RS_FULL_CONTENT);
+            if (rejected_requests_.empty() && completed_requests_.empty()) {
               current_rejected_request_id_ = 0;
             }
           }
         })
         .detach();
+    rejected_notify_scheduled_ = true;
   }
 
   void LocalRequests::cancelAll() {
-    cancelAll(active_requests_);
-    cancelAll(rejected_requests_);
+    std::vector<Graphsync::RequestProgressCallback> callbacks;
+    while (!active_requests_.empty()) {
+      for (auto &cb : closeRequest(active_requests_.begin()->first)) {
+        callbacks.push_back(std::move(cb));
+      }
+    }
+    for (const auto &cb : callbacks) {
+      cb(RS_REJECTED_LOCALLY, {});
+    }
+    cancelAll(rejected_requests_, RS_REJECTED_LOCALLY);
+    cancelAll(completed_requests_, RS_REJECTED_LOCALLY);
   }
 
   void LocalRequests::unsubscribe(uint64_t ticket) {
-    auto request_id = static_cast<RequestId>(ticket);
-
-    if (request_id < 0) {
-      // this is rejected request
+    if (static_cast<int64_t>(ticket) < 0) {
+      // this is rejected or completed request
+      auto request_id = static_cast<RequestId>(ticket);
       rejected_requests_.erase(request_id);
+      completed_requests_.erase(request_id);
+      return;
+    }
+
+    auto t = tickets_.find(ticket);
+    if (t == tickets_.end()) {
       return;
     }
+    auto request_id = t->second;
+    tickets_.erase(t);
 
     auto it = active_requests_.find(request_id);
     if (it == active_requests_.end()) {
       return;
     }
-    active_requests_.erase(it);
+    it->second.callbacks.erase(ticket);
+    if (!it->second.callbacks.empty()) {
+      // others still wait for this request
+      return;
+    }
+    closeRequest(request_id);
 
     request_builder_.addCancelRequest(request_id);
     auto serialize_res = request_builder_.serialize();
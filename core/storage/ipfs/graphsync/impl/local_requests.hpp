@@ -10,11 +10,15 @@
 
 #include <libp2p/protocol/common/scheduler.hpp>
 
+#include "crypto/blake2/blake2b160.hpp"
 #include "network/marshalling/request_builder.hpp"
 
 namespace fc::storage::ipfs::graphsync {
 
-  /// Local requests module for graphsync, manages requests made by this host
+  /// Local requests module for graphsync, manages requests made by this host.
+  /// Requests to same peer with same root, selector and extensions made while
+  /// one of them is in flight share its network request, each caller has own
+  /// subscription and network request is cancelled with the last one
   class LocalRequests : public Subscription::Source {
    public:
     /// Context of a new request
@@ -25,8 +29,12 @@ namespace fc::storage::ipfs::graphsync {
       /// Request ID
       RequestId request_id = 0;
 
-      /// Serialized request body to be sent to the wire
+      /// Serialized request body to be sent to the wire, empty if request
+      /// joined one already in flight or is pending
       SharedData body;
+
+      /// Request is reserved, its body is made by serializeRequest
+      bool pending = false;
     };
 
     /// LocalRequests->Graphsync feedback interface
@@ -41,15 +49,50 @@ namespace fc::storage::ipfs::graphsync {
 
     /// Non-network part of Graphsync's makeRequest implementation.
     /// Creates a new request and NewRequest fields
+    /// \param peer peer the request is sent to
     /// \param root_cid Root CID of the request
     /// \param selector IPLD selector
     /// \param extensions - protocol extension data
     /// \param callback A callback which keeps track of request progress
+    /// \param dont_send_cids blocks present locally, sent to peer in
+    /// "do-not-send-cids" extension when new network request is made
     /// \return request context, including serialized body
-    NewRequest newRequest(const CID &root_cid,
+    NewRequest newRequest(const PeerId &peer,
+                          const CID &root_cid,
                           gsl::span<const uint8_t> selector,
                           const std::vector<Extension> &extensions,
-                          Graphsync::RequestProgressCallback callback);
+                          Graphsync::RequestProgressCallback callback,
+                          const std::vector<CID> &dont_send_cids = {});
+
+    /// Like newRequest, but body is not made, so later requests with same
+    /// key join it while local blocks are looked up
+    /// \return request context, pending if new network request is needed
+    NewRequest reserveRequest(const PeerId &peer,
+                              const CID &root_cid,
+                              gsl::span<const uint8_t> selector,
+                              const std::vector<Extension> &extensions,
+                              Graphsync::RequestProgressCallback callback);
+
+    /// Serializes body of reserved request
+    /// \param dont_send_cids blocks present locally, see newRequest
+    /// \return request body
+    outcome::result<SharedData> serializeRequest(
+        RequestId request_id,
+        const CID &root_cid,
+        gsl::span<const uint8_t> selector,
+        const std::vector<Extension> &extensions,
+        const std::vector<CID> &dont_send_cids);
+
+    /// Whether request has subscribers, false once it is closed or
+    /// cancelled
+    bool isActive(RequestId request_id) const;
+
+    /// Creates Subscription for request completed from local blocks
+    /// \param callback Callback which keeps track of request progress, it will
+    /// receive RS_FULL_CONTENT status asynchronously
+    /// \return Subscription tied with callback
+    Subscription newCompletedRequest(
+        Graphsync::RequestProgressCallback callback);
 
     /// Creates Subscription for rejected request callback
     /// \param callback Callback which keeps track of request progress, it will
@@ -70,17 +113,41 @@ namespace fc::storage::ipfs::graphsync {
     void cancelAll();
 
    private:
-    /// Container that tracks all local requests
+    /// Container that tracks requests answered locally
     using RequestMap = std::map<RequestId, Graphsync::RequestProgressCallback>;
 
+    /// Hash of peer, root, selector and extensions of request
+    using RequestKey = crypto::blake2b::Blake2b256Hash;
+
+    /// Network request and its subscribers
+    struct ActiveRequest {
+      RequestKey key;
+
+      /// Callbacks by subscription ticket
+      std::map<uint64_t, Graphsync::RequestProgressCallback> callbacks;
+    };
+
     /// Subscription::Source::unsubscribe override
     void unsubscribe(uint64_t ticket) override;
 
-    /// Calls rejected requests' callback functions in async manner
+    /// Calls rejected and completed requests' callback functions in async
+    /// manner
     void asyncNotifyRejectedRequests();
 
     /// Helper fr cancelAll(), avoids reentrancy
-    static void cancelAll(RequestMap &requests);
+    /// \param requests requests to close
+    /// \param status status passed to callbacks
+    static void cancelAll(RequestMap &requests, ResponseStatusCode status);
+
+    /// Adds subscriber to network request
+    /// \return subscription ticket
+    uint64_t subscribe(RequestId request_id,
+                       Graphsync::RequestProgressCallback callback);
+
+    /// Closes network request and forgets its key
+    /// \return callbacks of its subscribers
+    std::vector<Graphsync::RequestProgressCallback> closeRequest(
+        RequestId request_id);
 
     /// Returns the next available request id
     RequestId nextRequestId();
@@ -91,12 +158,21 @@ namespace fc::storage::ipfs::graphsync {
     /// Feedback to GraphsyncImpl used to cancel requests
     CancelRequestFn cancel_fn_;
 
-    /// All active requests
-    RequestMap active_requests_;
+    /// All active network requests
+    std::map<RequestId, ActiveRequest> active_requests_;
+
+    /// Active network requests by key, for coalescing
+    std::map<RequestKey, RequestId> requests_by_key_;
+
+    /// Subscription tickets of active requests
+    std::map<uint64_t, RequestId> tickets_;
 
     /// All rejected requests
     RequestMap rejected_requests_;
 
+    /// Requests completed from local blocks, share ids with rejected ones
+    RequestMap completed_requests_;
+
     /// Wire protocol requests builder (and serializer)
     RequestBuilder request_builder_;
 
@@ -109,6 +185,10 @@ namespace fc::storage::ipfs::graphsync {
 
     /// Current rejected id, always negative and decremented
     RequestId current_rejected_request_id_ = 0;
+
+    /// Current subscription ticket of active requests, positive and
+    /// incremented, negative tickets are rejected and completed request ids
+    uint64_t current_ticket_ = 0;
   };
 
 }  // namespace fc::storage::ipfs::graphsync
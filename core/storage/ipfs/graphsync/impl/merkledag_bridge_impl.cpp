@@ -6,40 +6,114 @@
 #include "merkledag_bridge_impl.hpp"
 
 #include <cassert>
+#include <deque>
 
-#include "storage/ipfs/merkledag/merkledag_service.hpp"
+#include "storage/ipld/traverser.hpp"
 
 namespace fc::storage::ipfs::graphsync {
+  using ipld::traverser::Traverser;
+
+  namespace {
+    /// Blocks collected in advance
+    struct CollectedSelection : MerkleDagBridge::Selection {
+      outcome::result<boost::optional<MerkleDagBridge::Block>> next() override {
+        if (blocks.empty()) {
+          return boost::none;
+        }
+        auto block = std::move(blocks.front());
+        blocks.pop_front();
+        return std::move(block);
+      }
+
+      std::deque<MerkleDagBridge::Block> blocks;
+    };
+
+    /// Blocks walked by traverser on demand
+    struct TraverserSelection : MerkleDagBridge::Selection {
+      TraverserSelection(IpldPtr ipld,
+                         const CID &root,
+                         const common::Buffer &selector)
+          : ipld{std::move(ipld)},
+            traverser{*this->ipld, root, ipld::Selector{selector}} {}
+
+      outcome::result<boost::optional<MerkleDagBridge::Block>> next() override {
+        if (traverser.isCompleted()) {
+          return boost::none;
+        }
+        OUTCOME_TRY(block, traverser.advanceBlock());
+        return std::move(block);
+      }
+
+      IpldPtr ipld;
+      Traverser traverser;
+    };
+  }  // namespace
+
+  outcome::result<std::shared_ptr<MerkleDagBridge::Selection>>
+  MerkleDagBridge::startSelect(const CID &cid,
+                               gsl::span<const uint8_t> selector) const {
+    auto selection = std::make_shared<CollectedSelection>();
+    OUTCOME_TRY(select(cid, selector, [&](auto &cid, auto &data) {
+      selection->blocks.emplace_back(cid, data);
+      return true;
+    }));
+    return selection;
+  }
 
   std::shared_ptr<MerkleDagBridge> MerkleDagBridge::create(
-      std::shared_ptr<merkledag::MerkleDagService> service) {
-    return std::make_shared<MerkleDagBridgeImpl>(std::move(service));
+      IpldPtr ipld,
+      std::shared_ptr<boost::asio::thread_pool> pool,
+      size_t prefetch) {
+    return std::make_shared<MerkleDagBridgeImpl>(
+        std::move(ipld), std::move(pool), prefetch);
   }
 
   MerkleDagBridgeImpl::MerkleDagBridgeImpl(
-      std::shared_ptr<merkledag::MerkleDagService> service)
-      : service_(std::move(service)) {
-    assert(service_);
+      IpldPtr ipld,
+      std::shared_ptr<boost::asio::thread_pool> pool,
+      size_t prefetch)
+      : ipld_(std::move(ipld)), pool_(std::move(pool)), prefetch_(prefetch) {
+    assert(ipld_);
   }
 
   outcome::result<size_t> MerkleDagBridgeImpl::select(
       const CID &root_cid,
       gsl::span<const uint8_t> selector,
       std::function<bool(const CID &, const common::Buffer &)> handler) const {
-    auto internal_handler =
-        [&handler](std::shared_ptr<const ipld::IPLDNode> node) -> bool {
-      return handler(node->getCID(), node->getRawBytes());
-    };
-
     if (selector.empty()) {
-      OUTCOME_TRY(node, service_->getNode(root_cid));
-      internal_handler(node);
+      OUTCOME_TRY(data, ipld_->get(root_cid));
+      handler(root_cid, data);
       return 1;
     }
 
-    // TODO(???): change MerkleDAG service to accept CID instead of bytes
-    OUTCOME_TRY(cid_encoded, root_cid.toBytes());
-    return service_->select(cid_encoded, selector, internal_handler);
+    Traverser traverser{
+        *ipld_, root_cid, ipld::Selector{common::Buffer{selector}}};
+    if (pool_) {
+      traverser.prefetch(pool_, prefetch_);
+    }
+    size_t sent_count{};
+    while (!traverser.isCompleted()) {
+      OUTCOME_TRY(block, traverser.advanceBlock());
+      ++sent_count;
+      if (!handler(block.first, block.second)) {
+        break;
+      }
+    }
+    return sent_count;
+  }
+
+  outcome::result<std::shared_ptr<MerkleDagBridge::Selection>>
+  MerkleDagBridgeImpl::startSelect(const CID &root_cid,
+                                   gsl::span<const uint8_t> selector) const {
+    if (selector.empty()) {
+      return MerkleDagBridge::startSelect(root_cid, selector);
+    }
+    auto selection = std::make_shared<TraverserSelection>(
+        ipld_, root_cid, common::Buffer{selector});
+    if (pool_) {
+      selection->traverser.prefetch(pool_, prefetch_);
+    }
+    return selection;
   }
 
 }  // namespace fc::storage::ipfs::graphsync
@@ -14,8 +14,9 @@ namespace fc::storage::ipfs::graphsync {
   class MerkleDagBridgeImpl : public MerkleDagBridge {
    public:
     /// Ctor. called form  MerkleDagBridge::create(...)
-    explicit MerkleDagBridgeImpl(
-        std::shared_ptr<merkledag::MerkleDagService> service);
+    MerkleDagBridgeImpl(IpldPtr ipld,
+                        std::shared_ptr<boost::asio::thread_pool> pool,
+                        size_t prefetch);
 
    private:
     // overrides MerkleDagBridge interface
@@ -25,8 +26,17 @@ namespace fc::storage::ipfs::graphsync {
         std::function<bool(const CID &cid, const common::Buffer &data)> handler)
         const override;
 
-    /// MerkleDAG service
-    std::shared_ptr<merkledag::MerkleDagService> service_;
+    outcome::result<std::shared_ptr<Selection>> startSelect(
+        const CID &root_cid, gsl::span<const uint8_t> selector) const override;
+
+    /// Ipld store
+    IpldPtr ipld_;
+
+    /// Optional pool prefetching blocks
+    std::shared_ptr<boost::asio::thread_pool> pool_;
+
+    /// Count of blocks fetched ahead
+    size_t prefetch_;
   };
 
 }  // namespace fc::storage::ipfs::graphsync
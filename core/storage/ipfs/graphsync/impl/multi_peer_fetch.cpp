@@ -0,0 +1,308 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "multi_peer_fetch.hpp"
+
+#include "codec/cbor/cbor.hpp"
+#include "common/hexutil.hpp"
+#include "common.hpp"
+#include "crypto/hasher/hasher.hpp"
+#include "storage/ipld/traverser.hpp"
+
+namespace fc::storage::ipfs::graphsync {
+  using common::Buffer;
+  using libp2p::multi::HashType;
+
+  namespace {
+    /// Whether data hashes to cid, other hash types are not accepted
+    bool matchesCid(const CID &cid, const Buffer &data) {
+      auto type = cid.content_address.getType();
+      return (type == HashType::sha256 || type == HashType::blake2b_256)
+             && crypto::Hasher::calculate(type, data) == cid.content_address;
+    }
+  }  // namespace
+
+  MultiPeerFetch::MultiPeerFetch(
+      std::shared_ptr<Graphsync> graphsync,
+      IpldPtr ipld,
+      std::shared_ptr<libp2p::protocol::Scheduler> scheduler,
+      MultiPeerFetchConfig config)
+      : graphsync_{std::move(graphsync)},
+        ipld_{std::move(ipld)},
+        scheduler_{std::move(scheduler)},
+        config_{config},
+        selector_{subtreeSelector(config.subtree_depth)} {
+    BOOST_ASSERT(config_.subtree_depth > 0);
+    BOOST_ASSERT(config_.requests_per_peer > 0);
+  }
+
+  Buffer MultiPeerFetch::subtreeSelector(uint64_t depth) {
+    // {"R": {"l": {"depth": depth}, ":>": {"a": {">": {"@": {}}}}}}
+    Buffer selector{common::unhex("a16152a2616ca1656465707468").value()};
+    selector.put(codec::cbor::encode(depth).value());
+    selector.put(common::unhex("623a3ea16161a1613ea16140a0").value());
+    return selector;
+  }
+
+  void MultiPeerFetch::addPeer(const PeerId &peer) {
+    for (auto &known : peers_) {
+      if (known.id == peer) {
+        return;
+      }
+    }
+    peers_.push_back({peer});
+    if (callback_) {
+      requestNext();
+    }
+  }
+
+  void MultiPeerFetch::fetch(const CID &root, Callback callback) {
+    if (callback_) {
+      return callback(MultiPeerFetchError::kFetchInProgress);
+    }
+    callback_ = std::move(callback);
+    received_ = 0;
+    seen_.insert(root);
+
+    auto present = ipld_->contains(root);
+    if (!present) {
+      return done(present.error());
+    }
+    if (present.value()) {
+      auto bytes = ipld_->get(root);
+      if (!bytes) {
+        return done(bytes.error());
+      }
+      // children of present root start new subtrees
+      onStored(root, bytes.value(), config_.subtree_depth, 0);
+    } else {
+      frontier_.push_back(root);
+    }
+    if (callback_) {
+      requestNext();
+    }
+  }
+
+  void MultiPeerFetch::cancel() {
+    callback_ = nullptr;
+    done(outcome::success());
+  }
+
+  bool MultiPeerFetch::onBlock(const CID &cid, const Buffer &data) {
+    auto it = expected_.find(cid);
+    if (it == expected_.end()) {
+      return false;
+    }
+    if (!matchesCid(cid, data)) {
+      // block stays expected and is requested from other peer if its
+      // request ends without it
+      logger()->debug("multi peer fetch: block doesn't match cid {}",
+                      cid.toPrettyString(""));
+      return true;
+    }
+    auto expected = it->second;
+    expected_.erase(it);
+
+    auto request = requests_.find(expected.request);
+    if (request != requests_.end()) {
+      request->second.timer.reschedule(config_.stall_timeout_msec);
+    }
+
+    auto stored = ipld_->set(cid, data);
+    if (!stored) {
+      done(stored.error());
+      return true;
+    }
+    ++received_;
+
+    onStored(cid, data, expected.depth, expected.request);
+    if (callback_) {
+      requestNext();
+    }
+    return true;
+  }
+
+  size_t MultiPeerFetch::received() const {
+    return received_;
+  }
+
+  void MultiPeerFetch::onStored(const CID &cid,
+                                const Buffer &data,
+                                uint64_t depth,
+                                uint64_t request) {
+    // blocks present in ipld are expanded without requests
+    std::vector<std::pair<CID, uint64_t>> present;
+    auto expand = [&](const CID &parent,
+                      const Buffer &bytes,
+                      uint64_t depth) -> bool {
+      auto links = ipld::traverser::blockLinks(parent, bytes);
+      if (!links) {
+        done(links.error());
+        return false;
+      }
+      for (auto &link : links.value()) {
+        if (!seen_.insert(link).second) {
+          continue;
+        }
+        auto has = ipld_->contains(link);
+        if (!has) {
+          done(has.error());
+          return false;
+        }
+        if (has.value()) {
+          present.emplace_back(link, depth + 1);
+        } else if (request != 0 && depth + 1 < config_.subtree_depth) {
+          expected_.emplace(link, Expected{request, depth + 1});
+        } else {
+          frontier_.push_back(link);
+        }
+      }
+      return true;
+    };
+
+    if (!expand(cid, data, depth)) {
+      return;
+    }
+    while (!present.empty()) {
+      auto [link, link_depth] = std::move(present.back());
+      present.pop_back();
+      auto bytes = ipld_->get(link);
+      if (!bytes) {
+        return done(bytes.error());
+      }
+      if (!expand(link, bytes.value(), link_depth)) {
+        return;
+      }
+    }
+  }
+
+  void MultiPeerFetch::onResponse(uint64_t request, ResponseStatusCode status) {
+    if (!isTerminal(status)) {
+      return;
+    }
+    if (!isSuccess(status)) {
+      logger()->debug("multi peer fetch: subtree request failed: {}",
+                      statusCodeToString(status));
+    }
+    finish(request);
+  }
+
+  void MultiPeerFetch::finish(uint64_t request) {
+    auto it = requests_.find(request);
+    if (it == requests_.end()) {
+      return;
+    }
+    auto peer = it->second.peer.toBase58();
+    for (auto &known : peers_) {
+      if (known.id == it->second.peer) {
+        --known.requests;
+      }
+    }
+    requests_.erase(it);
+
+    // blocks not received are requested from other peers
+    for (auto e = expected_.begin(); e != expected_.end();) {
+      if (e->second.request == request) {
+        tried_[e->first].insert(peer);
+        frontier_.push_back(e->first);
+        e = expected_.erase(e);
+      } else {
+        ++e;
+      }
+    }
+    requestNext();
+  }
+
+  void MultiPeerFetch::requestNext() {
+    while (callback_ && !frontier_.empty()) {
+      auto &tried = tried_[frontier_.front()];
+      Peer *best{nullptr};
+      auto untried{false};
+      for (auto &peer : peers_) {
+        if (tried.count(peer.id.toBase58()) != 0) {
+          continue;
+        }
+        untried = true;
+        if (peer.requests < config_.requests_per_peer
+            && (!best || peer.requests < best->requests)) {
+          best = &peer;
+        }
+      }
+      if (!untried) {
+        return done(MultiPeerFetchError::kNoPeers);
+      }
+      if (!best) {
+        // all peers are busy
+        return;
+      }
+
+      auto root = std::move(frontier_.front());
+      frontier_.pop_front();
+      auto id = ++next_request_;
+      auto peer = best->id;
+      ++best->requests;
+      expected_.emplace(root, Expected{id, 0});
+      auto &request = requests_.emplace(id, Request{peer, root, {}, {}})
+                          .first->second;
+      request.timer = scheduler_->schedule(
+          config_.stall_timeout_msec, [weak{weak_from_this()}, id] {
+            if (auto self = weak.lock()) {
+              self->finish(id);
+            }
+          });
+      auto subscription = graphsync_->makeRequest(
+          peer,
+          boost::none,
+          root,
+          selector_,
+          {},
+          [weak{weak_from_this()}, id](ResponseStatusCode status, auto) {
+            if (auto self = weak.lock()) {
+              self->onResponse(id, status);
+            }
+          });
+      // callback may have been called synchronously
+      auto it = requests_.find(id);
+      if (it != requests_.end()) {
+        it->second.subscription = std::move(subscription);
+      }
+    }
+    if (callback_ && frontier_.empty() && expected_.empty()
+        && requests_.empty()) {
+      done(outcome::success());
+    }
+  }
+
+  void MultiPeerFetch::done(outcome::result<void> result) {
+    auto callback = std::move(callback_);
+    callback_ = nullptr;
+    frontier_.clear();
+    tried_.clear();
+    expected_.clear();
+    seen_.clear();
+    requests_.clear();
+    for (auto &peer : peers_) {
+      peer.requests = 0;
+    }
+    if (callback) {
+      callback(result);
+    }
+  }
+
+}  // namespace fc::storage::ipfs::graphsync
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::ipfs::graphsync,
+                            MultiPeerFetchError,
+                            e) {
+  using E = fc::storage::ipfs::graphsync::MultiPeerFetchError;
+  switch (e) {
+    case E::kNoPeers:
+      return "MultiPeerFetchError: no peers can serve block";
+    case E::kFetchInProgress:
+      return "MultiPeerFetchError: fetch is already in progress";
+    default:
+      return "MultiPeerFetchError: unknown error";
+  }
+}
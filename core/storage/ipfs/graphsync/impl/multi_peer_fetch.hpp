@@ -0,0 +1,133 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_GRAPHSYNC_MULTI_PEER_FETCH_HPP
+#define CPP_FILECOIN_GRAPHSYNC_MULTI_PEER_FETCH_HPP
+
+#include <deque>
+#include <map>
+#include <set>
+
+#include <libp2p/protocol/common/scheduler.hpp>
+
+#include "storage/ipfs/graphsync/graphsync.hpp"
+
+namespace fc::storage::ipfs::graphsync {
+  using libp2p::peer::PeerId;
+
+  /// Multi-peer fetch errors
+  enum class MultiPeerFetchError {
+    kNoPeers = 1,
+    kFetchInProgress,
+  };
+
+  /// Multi-peer fetch tuning
+  struct MultiPeerFetchConfig {
+    /// Levels of dag requested from one peer by one request
+    uint64_t subtree_depth{8};
+    /// Max requests in flight to one peer
+    size_t requests_per_peer{4};
+    /// Request is reissued to other peer if no block arrived in time, msec
+    unsigned stall_timeout_msec{10000};
+  };
+
+  /**
+   * Fetches dag from several peers holding the same data.
+   * Dag is split by depth frontier into subtrees of subtree_depth levels, each
+   * subtree is requested from the least busy peer. Received blocks are
+   * deduplicated and stored, links on subtree boundary become new subtrees.
+   * Blocks of failed or stalled requests are requested from other peers.
+   * Graphsync has single block callback, so owner must forward blocks to
+   * onBlock.
+   */
+  class MultiPeerFetch : public std::enable_shared_from_this<MultiPeerFetch> {
+   public:
+    using Callback = std::function<void(outcome::result<void>)>;
+
+    MultiPeerFetch(std::shared_ptr<Graphsync> graphsync,
+                   IpldPtr ipld,
+                   std::shared_ptr<libp2p::protocol::Scheduler> scheduler,
+                   MultiPeerFetchConfig config = {});
+
+    /// Adds peer holding the dag, may be called during fetch
+    void addPeer(const PeerId &peer);
+
+    /**
+     * Starts fetching dag, blocks already present in ipld are not requested
+     * @param root - root cid
+     * @param callback - called when all blocks are stored, or when some
+     * block cannot be fetched from any peer
+     */
+    void fetch(const CID &root, Callback callback);
+
+    /// Cancels fetch, callback is not called
+    void cancel();
+
+    /**
+     * Stores block received from graphsync if its bytes match cid
+     * @return true if block was expected by fetch
+     */
+    bool onBlock(const CID &cid, const common::Buffer &data);
+
+    /// Number of blocks stored by fetch
+    size_t received() const;
+
+    /// Selector of subtree with given number of levels
+    static common::Buffer subtreeSelector(uint64_t depth);
+
+   private:
+    /// Block expected in response to subtree request
+    struct Expected {
+      uint64_t request;
+      uint64_t depth;
+    };
+
+    /// Subtree request in flight
+    struct Request {
+      PeerId peer;
+      CID root;
+      Subscription subscription;
+      libp2p::protocol::Scheduler::Handle timer;
+    };
+
+    /// Peer with count of its requests in flight
+    struct Peer {
+      PeerId id;
+      size_t requests{};
+    };
+
+    void onStored(const CID &cid,
+                  const common::Buffer &data,
+                  uint64_t depth,
+                  uint64_t request);
+    void onResponse(uint64_t request, ResponseStatusCode status);
+    void finish(uint64_t request);
+    void requestNext();
+    void done(outcome::result<void> result);
+
+    std::shared_ptr<Graphsync> graphsync_;
+    IpldPtr ipld_;
+    std::shared_ptr<libp2p::protocol::Scheduler> scheduler_;
+    MultiPeerFetchConfig config_;
+    common::Buffer selector_;
+    std::vector<Peer> peers_;
+    Callback callback_;
+    /// Subtree roots waiting for peer
+    std::deque<CID> frontier_;
+    /// Peers which failed to serve block
+    std::map<CID, std::set<std::string>> tried_;
+    std::map<CID, Expected> expected_;
+    std::map<uint64_t, Request> requests_;
+    /// Cids already expected, received or present
+    std::set<CID> seen_;
+    uint64_t next_request_{};
+    size_t received_{};
+  };
+
+}  // namespace fc::storage::ipfs::graphsync
+
+OUTCOME_HPP_DECLARE_ERROR(fc::storage::ipfs::graphsync, MultiPeerFetchError);
+
+#endif  // CPP_FILECOIN_GRAPHSYNC_MULTI_PEER_FETCH_HPP
@@ -24,7 +24,8 @@ namespace fc::storage::ipfs::graphsync {
       return Error::kWriteQueueOverflow;
     }
 
-    if (serialized_size + data.size() > kMaxMessageSize) {
+    if (serialized_size != 0
+        && serialized_size + data.size() > kMaxResponseBatchSize) {
       auto res = sendPartialResponse(request_id);
       if (!res) {
         return res;
@@ -54,9 +55,19 @@ namespace fc::storage::ipfs::graphsync {
     return outcome::success();
   }
 
+  outcome::result<void> InboundEndpoint::sendSerialized(SharedData message) {
+    if (queue_->getState().pending_bytes + message->size()
+        > max_pending_bytes_) {
+      return Error::kWriteQueueOverflow;
+    }
+
+    queue_->enqueue(std::move(message));
+    return outcome::success();
+  }
+
   outcome::result<void> InboundEndpoint::sendPartialResponse(int request_id) {
     static const std::vector<Extension> dummy_extensions;
-    return sendResponse(request_id, RS_PARTIAL_CONTENT, dummy_extensions);
+    return sendResponse(request_id, RS_PARTIAL_RESPONSE, dummy_extensions);
   }
 
 }  // namespace fc::storage::ipfs::graphsync
@@ -23,8 +23,8 @@ namespace fc::storage::ipfs::graphsync {
     /// \param queue Queues raw messages, dependency object
     explicit InboundEndpoint(std::shared_ptr<MessageQueue> queue);
 
-    /// Adds data block to response. Doesn't send unless sending partial
-    /// response is needed
+    /// Adds data block to response. Doesn't send unless batched blocks
+    /// exceed kMaxResponseBatchSize and partial response is sent
     /// \param cid CID of data block
     /// \param data Raw data
     outcome::result<void> addBlockToResponse(RequestId request_id,
@@ -39,9 +39,12 @@ namespace fc::storage::ipfs::graphsync {
         ResponseStatusCode status,
         const std::vector<Extension> &extensions);
 
+    /// Enqueues response message serialized by caller
+    /// \param message wire protocol message
+    outcome::result<void> sendSerialized(SharedData message);
+
    private:
-    /// Enqueues partial response when protobuf message size exceeds protocol
-    /// limits
+    /// Enqueues partial response when batched blocks exceed batch size
     /// \param request_id request id
     /// \return result of queue operation
     outcome::result<void> sendPartialResponse(RequestId request_id);
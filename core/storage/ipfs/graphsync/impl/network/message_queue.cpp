@@ -39,11 +39,13 @@ namespace fc::storage::ipfs::graphsync {
       // begin async write
       beginWrite(std::move(data));
     }
+    account();
   }
 
   void MessageQueue::clear() {
     state_.pending_bytes = 0;
     pending_buffers_.clear();
+    account();
   }
 
   void MessageQueue::close() {
@@ -51,6 +53,7 @@ namespace fc::storage::ipfs::graphsync {
     state_.active = false;
     state_.writing_bytes = 0;
     state_.stream.reset();
+    account();
   }
 
   void MessageQueue::dequeue() {
@@ -61,6 +64,7 @@ namespace fc::storage::ipfs::graphsync {
       pending_buffers_.pop_front();
       state_.pending_bytes -= buffer->size();
       beginWrite(std::move(buffer));
+      account();
     }
   }
 
@@ -94,6 +98,7 @@ namespace fc::storage::ipfs::graphsync {
 
     auto n = state_.writing_bytes;
     state_.writing_bytes = 0;
+    account();
 
     if (!res) {
       feedback_(state_.stream, res.error());
@@ -112,4 +117,8 @@ namespace fc::storage::ipfs::graphsync {
     feedback_(state_.stream, outcome::success());
   }
 
+  void MessageQueue::account() {
+    memory_.set(state_.pending_bytes + state_.writing_bytes);
+  }
+
 }  // namespace fc::storage::ipfs::graphsync
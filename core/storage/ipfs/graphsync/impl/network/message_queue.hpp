@@ -6,6 +6,7 @@
 #ifndef CPP_FILECOIN_GRAPHSYNC_MESSAGE_QUEUE_HPP
 #define CPP_FILECOIN_GRAPHSYNC_MESSAGE_QUEUE_HPP
 
+#include "metrics/memory.hpp"
 #include "network_fwd.hpp"
 
 namespace fc::storage::ipfs::graphsync {
@@ -65,6 +66,9 @@ namespace fc::storage::ipfs::graphsync {
     /// Async write result callback
     void onMessageWritten(outcome::result<size_t> res);
 
+    /// Reports pending and writing bytes to memory metrics
+    void account();
+
     /// Owner's callback
     FeedbackFn feedback_;
 
@@ -73,6 +77,9 @@ namespace fc::storage::ipfs::graphsync {
 
     /// Current state of the queue
     State state_;
+
+    /// Queued bytes of graphsync subsystem
+    metrics::MemoryShare memory_{"graphsync"};
   };
 
 }  // namespace fc::storage::ipfs::graphsync
@@ -131,6 +131,19 @@ namespace fc::storage::ipfs::graphsync {
     return ctx->addBlockToResponse(request_id, cid, data);
   }
 
+  bool Network::isWritable(const PeerId &peer) {
+    if (!started_) {
+      return true;
+    }
+
+    auto ctx = findContext(peer, false);
+    if (!ctx) {
+      return true;
+    }
+
+    return ctx->isWritable();
+  }
+
   void Network::sendResponse(const PeerId &peer,
                              int request_id,
                              ResponseStatusCode status,
@@ -147,11 +160,29 @@ namespace fc::storage::ipfs::graphsync {
     ctx->sendResponse(request_id, status, extensions);
   }
 
+  void Network::sendSerializedResponse(const PeerId &peer,
+                                       RequestId request_id,
+                                       SharedData message) {
+    if (!started_) {
+      return;
+    }
+
+    auto ctx = findContext(peer, false);
+    if (!ctx) {
+      return;
+    }
+
+    ctx->sendSerializedResponse(request_id, std::move(message));
+  }
+
   void Network::peerClosed(const PeerId &peer, ResponseStatusCode status) {
     auto it = peers_.find(peer);
     if (it != peers_.end()) {
       peers_.erase(it);
     }
+    if (feedback_) {
+      feedback_->onPeerClosed(peer);
+    }
   }
 
   PeerContextPtr Network::findContext(const PeerId &peer,
@@ -162,7 +193,7 @@ namespace fc::storage::ipfs::graphsync {
 
     auto it = peers_.find(peer);
     if (it != peers_.end()) {
-      ctx = *it;
+      ctx = it->second;
       if (ctx->getState() == PeerContext::is_closed) {
         peers_.erase(it);
         ctx.reset();
@@ -171,7 +202,7 @@ namespace fc::storage::ipfs::graphsync {
 
     if (!ctx && create_if_not_found) {
       ctx = std::make_shared<PeerContext>(peer, *feedback_, *this, *scheduler_);
-      peers_.insert(ctx);
+      peers_.emplace(peer, ctx);
     }
 
     return ctx;
@@ -226,7 +257,7 @@ namespace fc::storage::ipfs::graphsync {
 
   void Network::closeAllPeers() {
     PeerSet peers = std::move(peers_);
-    for (auto &ctx : peers) {
+    for (auto &[peer, ctx] : peers) {
       ctx->close(RS_REJECTED_LOCALLY);
     }
 
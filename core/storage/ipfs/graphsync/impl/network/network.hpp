@@ -7,6 +7,7 @@
 #define CPP_FILECOIN_GRAPHSYNC_NETWORK_HPP
 
 #include <functional>
+#include <unordered_map>
 
 #include <libp2p/host/host.hpp>
 #include <libp2p/protocol/common/scheduler.hpp>
@@ -68,6 +69,13 @@ namespace fc::storage::ipfs::graphsync {
                             const CID &cid,
                             const common::Buffer &data);
 
+    /// Checks if more response blocks may be added for the peer without
+    /// exceeding its send window
+    /// \param peer peer ID
+    /// \return false if responses to the peer should pause until
+    /// onPeerWritable, true if window is open or peer is not connected
+    bool isWritable(const PeerId &peer);
+
     /// Sends response to peer. Data blocks may be added previously
     /// to this response
     /// \param peer peer ID
@@ -79,6 +87,14 @@ namespace fc::storage::ipfs::graphsync {
                       ResponseStatusCode status,
                       const std::vector<Extension> &extensions);
 
+    /// Sends response serialized off network thread, with blocks and status
+    /// \param peer peer ID
+    /// \param request_id request ID
+    /// \param message wire protocol message
+    void sendSerializedResponse(const PeerId &peer,
+                                RequestId request_id,
+                                SharedData message);
+
    private:
     /// Callback from peer context that it's closed
     /// \param peer peer ID
@@ -124,14 +140,14 @@ namespace fc::storage::ipfs::graphsync {
     /// Feedback to graphsync core module (owning object)
     std::shared_ptr<PeerToGraphsyncFeedback> feedback_;
 
-    /// Peer set, where item can be found by const PeerID& (see operators <)
-    using PeerSet = std::set<PeerContextPtr, std::less<>>;
+    /// Peer contexts by peer id
+    using PeerSet = std::unordered_map<PeerId, PeerContextPtr>;
 
-    /// Set of peers, where item can be found by const PeerID&
+    /// Contexts of peers, looked up on every request and response
     PeerSet peers_;
 
     /// Keeps tracks of active outbound requests, maps them to peers
-    std::map<RequestId, PeerContextPtr> active_requests_per_peer_;
+    std::unordered_map<RequestId, PeerContextPtr> active_requests_per_peer_;
 
     /// Indicates if the node is active
     bool started_ = false;
@@ -54,6 +54,20 @@ namespace fc::storage::ipfs::graphsync {
                             RequestId request_id,
                             ResponseStatusCode status,
                             std::vector<Extension> extensions) = 0;
+
+    /// Called when outbound bytes to peer drop below send window after it
+    /// was reported full
+    /// \param peer peer ID
+    virtual void onPeerWritable(const PeerId &peer) = 0;
+
+    /// Called when peer cancels its request
+    /// \param peer peer ID
+    /// \param request_id request ID of peer
+    virtual void onRemoteCancel(const PeerId &peer, RequestId request_id) = 0;
+
+    /// Called when peer is closed, its requests are dropped
+    /// \param peer peer ID
+    virtual void onPeerClosed(const PeerId &peer) = 0;
   };
 
   /// PeerContext->Network feedback interface
@@ -85,11 +99,6 @@ namespace fc::storage::ipfs::graphsync {
                                outcome::result<void> result) = 0;
   };
 
-  /// Operators needed to find a PeerContext in a set by peer id
-  bool operator<(const PeerContextPtr &ctx, const PeerId &peer);
-  bool operator<(const PeerId &peer, const PeerContextPtr &ctx);
-  bool operator<(const PeerContextPtr &a, const PeerContextPtr &b);
-
   /// Protocol version
   constexpr std::string_view kProtocolVersion = "/ipfs/graphsync/1.0.0";
 
@@ -99,6 +108,12 @@ namespace fc::storage::ipfs::graphsync {
   /// Max byte size of pending message queue
   constexpr size_t kMaxPendingBytes = 64 * 1024 * 1024;
 
+  /// Max byte size of blocks batched into one response message
+  constexpr size_t kMaxResponseBatchSize = 1024 * 1024;
+
+  /// Outbound bytes per peer, above which responses are paused
+  constexpr size_t kPeerSendWindow = 16 * 1024 * 1024;
+
   /// Cleanup delay for PeerContext, msec
   constexpr unsigned kPeerCloseDelayMsec = 30000;
 
@@ -15,17 +15,13 @@
 namespace fc::storage::ipfs::graphsync {
 
   namespace {
+    /// Interval of repeated messages on per message path
+    constexpr std::chrono::seconds kLogInterval{1};
 
     std::string makeStringRepr(const PeerId &peer_id) {
       return peer_id.toBase58().substr(46);
     }
 
-    /// Needed for sets and maps
-    inline bool less(const PeerId &a, const PeerId &b) {
-      // N.B. toVector returns const std::vector&, i.e. it is fast
-      return a.toVector() < b.toVector();
-    }
-
   }  // namespace
 
   PeerContext::PeerContext(PeerId peer_id,
@@ -47,21 +43,6 @@ namespace fc::storage::ipfs::graphsync {
     }
   }
 
-  bool operator<(const PeerContextPtr &ctx, const PeerId &peer) {
-    if (!ctx) return false;
-    return less(ctx->peer, peer);
-  }
-
-  bool operator<(const PeerId &peer, const PeerContextPtr &ctx) {
-    if (!ctx) return false;
-    return less(peer, ctx->peer);
-  }
-
-  bool operator<(const PeerContextPtr &a, const PeerContextPtr &b) {
-    if (!a || !b) return false;
-    return less(a->peer, b->peer);
-  }
-
   void PeerContext::setOutboundAddress(
       boost::optional<libp2p::multi::Multiaddress> connect_to) {
     if (connect_to) {
@@ -197,10 +178,11 @@ namespace fc::storage::ipfs::graphsync {
       RequestId request_id) {
     auto r_iter = remote_requests_streams_.find(request_id);
     if (r_iter == remote_requests_streams_.end()) {
-      logger()->debug(
-          "findResponseSink: remote request {} is no longer actual, peer={}",
-          request_id,
-          str);
+      FC_LOG(logger(),
+             debug,
+             "findResponseSink: remote request {} is no longer actual, peer={}",
+             request_id,
+             str);
       return streams_.end();
     }
     auto s_iter = streams_.find(r_iter->second);
@@ -232,6 +214,24 @@ namespace fc::storage::ipfs::graphsync {
     return true;
   }
 
+  bool PeerContext::isWritable() {
+    if (pendingBytes() > kPeerSendWindow) {
+      window_full_ = true;
+    }
+    return !window_full_;
+  }
+
+  size_t PeerContext::pendingBytes() const {
+    size_t bytes = 0;
+    for (auto &[stream, ctx] : streams_) {
+      if (ctx.queue) {
+        auto &state = ctx.queue->getState();
+        bytes += state.writing_bytes + state.pending_bytes;
+      }
+    }
+    return bytes;
+  }
+
   void PeerContext::sendResponse(RequestId request_id,
                                  ResponseStatusCode status,
                                  const std::vector<Extension> &extensions) {
@@ -252,6 +252,25 @@ namespace fc::storage::ipfs::graphsync {
     }
   }
 
+  void PeerContext::sendSerializedResponse(RequestId request_id,
+                                           SharedData message) {
+    auto it = findResponseSink(request_id);
+    if (it == streams_.end()) {
+      return;
+    }
+    auto &ctx = it->second;
+
+    createResponseEndpoint(it->first, ctx);
+
+    auto res = ctx.response_endpoint->sendSerialized(std::move(message));
+    if (!res) {
+      logger()->error(
+          "sendSerializedResponse: {}, peer={}", res.error().message(), str);
+
+      close(RS_SLOW_STREAM);
+    }
+  }
+
   void PeerContext::close(ResponseStatusCode status) {
     if (closed_) {
       return;
@@ -315,7 +334,10 @@ namespace fc::storage::ipfs::graphsync {
   void PeerContext::onResponse(Message::Response &response) {
     auto it = local_request_ids_.find(response.id);
     if (it == local_request_ids_.end()) {
-      logger()->info(
+      FC_LOG_LIMITED(
+          logger(),
+          info,
+          kLogInterval,
           "ignoring response for unexpected request id={} from peer {}",
           response.id,
           str);
@@ -341,6 +363,7 @@ namespace fc::storage::ipfs::graphsync {
       remote_requests_streams_.erase(request.id);
       logger()->debug(
           "onRequest: peer {} cancelled request {}", str, request.id);
+      graphsync_feedback_.onRemoteCancel(peer, request.id);
     } else {
       createResponseEndpoint(stream, ctx);
       if (remote_requests_streams_.count(request.id)) {
@@ -388,7 +411,9 @@ namespace fc::storage::ipfs::graphsync {
 
     Message &msg = msg_res.value();
 
-    logger()->trace(
+    FC_LOG(
+        logger(),
+        trace,
         "message from peer={}, {} blocks, {} requests, {} responses",
         str,
         msg.data.size(),
@@ -438,6 +463,11 @@ namespace fc::storage::ipfs::graphsync {
     }
 
     shiftExpireTime(stream);
+
+    if (window_full_ && pendingBytes() <= kPeerSendWindow / 2) {
+      window_full_ = false;
+      graphsync_feedback_.onPeerWritable(peer);
+    }
   }
 
   void PeerContext::shiftExpireTime(PeerContext::StreamCtx &ctx) {
@@ -6,8 +6,8 @@
 #ifndef CPP_FILECOIN_GRAPHSYNC_PEER_CONTEXT_HPP
 #define CPP_FILECOIN_GRAPHSYNC_PEER_CONTEXT_HPP
 
-#include <map>
 #include <set>
+#include <unordered_map>
 
 #include <libp2p/peer/peer_info.hpp>
 
@@ -96,6 +96,11 @@ namespace fc::storage::ipfs::graphsync {
                             const CID &cid,
                             const common::Buffer &data);
 
+    /// Checks if outbound bytes to the peer are within send window. If not,
+    /// onPeerWritable feedback is sent when they drop below half of window
+    /// \return true if more response blocks may be added
+    bool isWritable();
+
     /// Sends response to peer. Data blocks may be added previously
     /// to this response
     /// \param request_id request ID
@@ -105,6 +110,12 @@ namespace fc::storage::ipfs::graphsync {
                       ResponseStatusCode status,
                       const std::vector<Extension> &extensions);
 
+    /// Sends response message serialized by caller, which contains blocks
+    /// and status of request
+    /// \param request_id request ID
+    /// \param message wire protocol message
+    void sendSerializedResponse(RequestId request_id, SharedData message);
+
     /// Closes all streams to/from this peer
     /// \param status close reason to be forwarded to local request callback,
     /// where RS_REJECTED_LOCALLY indicates that peer was closed by the owning
@@ -136,7 +147,10 @@ namespace fc::storage::ipfs::graphsync {
     };
 
     /// Container for all active streams to/from the peer
-    using Streams = std::map<StreamPtr, StreamCtx>;
+    using Streams = std::unordered_map<StreamPtr, StreamCtx>;
+
+    /// Bytes written or pending in all stream queues
+    size_t pendingBytes() const;
 
     /// Feedback from MessageReader objects
     /// \param stream libp2p stream
@@ -219,7 +233,7 @@ namespace fc::storage::ipfs::graphsync {
     std::set<RequestId> local_request_ids_;
 
     /// IDs of requests made by peer mapped to streams they were made through
-    std::map<RequestId, StreamPtr> remote_requests_streams_;
+    std::unordered_map<RequestId, StreamPtr> remote_requests_streams_;
 
     /// Active streams collection
     Streams streams_;
@@ -230,6 +244,9 @@ namespace fc::storage::ipfs::graphsync {
     /// Flag, indicates that peer is closed
     bool closed_ = false;
 
+    /// Flag, indicates that send window was reported full
+    bool window_full_ = false;
+
     /// Response status code stored to be forwarded asynchronously
     /// in the next cycle
     ResponseStatusCode close_status_ = RS_INTERNAL_ERROR;
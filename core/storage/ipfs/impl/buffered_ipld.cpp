@@ -0,0 +1,122 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/buffered_ipld.hpp"
+
+namespace fc::storage::ipfs {
+  using codec::cbor::CborDecodeStream;
+
+  namespace {
+    /// Collects cids linked from CBOR element
+    void cborLinks(CborDecodeStream &s, std::vector<CID> &links) {
+      if (s.isCid()) {
+        CID cid;
+        s >> cid;
+        links.push_back(std::move(cid));
+      } else if (s.isList()) {
+        auto n = s.listLength();
+        for (auto l = s.list(); n != 0; --n) {
+          cborLinks(l, links);
+        }
+      } else if (s.isMap()) {
+        for (auto &p : s.map()) {
+          cborLinks(p.second, links);
+        }
+      } else {
+        s.next();
+      }
+    }
+  }  // namespace
+
+  BufferedIpld::BufferedIpld(IpldPtr ipld) : ipld_{std::move(ipld)} {
+    BOOST_ASSERT_MSG(ipld_ != nullptr, "ipld argument is nullptr");
+  }
+
+  outcome::result<bool> BufferedIpld::contains(const CID &key) const {
+    if (buffer_.find(key) != buffer_.end()) {
+      return true;
+    }
+    return ipld_->contains(key);
+  }
+
+  outcome::result<void> BufferedIpld::set(const CID &key, Value value) {
+    buffer_.emplace(key, std::move(value));
+    return outcome::success();
+  }
+
+  outcome::result<void> BufferedIpld::setMany(Batch batch) {
+    for (auto &[key, value] : batch) {
+      buffer_.emplace(key, std::move(value));
+    }
+    return outcome::success();
+  }
+
+  outcome::result<BufferedIpld::Value> BufferedIpld::get(
+      const CID &key) const {
+    auto it = buffer_.find(key);
+    if (it != buffer_.end()) {
+      return it->second;
+    }
+    return ipld_->get(key);
+  }
+
+  outcome::result<void> BufferedIpld::view(const CID &key,
+                                           const ViewCallback &callback) const {
+    auto it = buffer_.find(key);
+    if (it != buffer_.end()) {
+      return callback(it->second);
+    }
+    return ipld_->view(key, callback);
+  }
+
+  outcome::result<void> BufferedIpld::remove(const CID &key) {
+    buffer_.erase(key);
+    return ipld_->remove(key);
+  }
+
+  outcome::result<void> BufferedIpld::flush(const std::vector<CID> &roots) {
+    Batch batch;
+    std::vector<CID> queue{roots};
+    while (!queue.empty()) {
+      auto cid = std::move(queue.back());
+      queue.pop_back();
+      auto it = buffer_.find(cid);
+      // not buffered or already written
+      if (it == buffer_.end()) {
+        continue;
+      }
+      if (cid.content_type == libp2p::multi::MulticodecType::DAG_CBOR) {
+        try {
+          CborDecodeStream s{it->second};
+          cborLinks(s, queue);
+        } catch (std::system_error &e) {
+          return outcome::failure(e.code());
+        }
+      }
+      batch.emplace_back(it->first, std::move(it->second));
+      buffer_.erase(it);
+    }
+    buffer_.clear();
+    if (batch.empty()) {
+      return outcome::success();
+    }
+    return ipld_->setMany(std::move(batch));
+  }
+
+  size_t BufferedIpld::size() const {
+    return buffer_.size();
+  }
+
+  BufferedIpld::Batch BufferedIpld::release() {
+    Batch batch;
+    batch.reserve(buffer_.size());
+    for (auto &[key, value] : buffer_) {
+      batch.emplace_back(key, std::move(value));
+    }
+    buffer_.clear();
+    return batch;
+  }
+
+}  // namespace fc::storage::ipfs
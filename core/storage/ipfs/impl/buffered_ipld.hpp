@@ -0,0 +1,71 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_STORAGE_IPFS_IMPL_BUFFERED_IPLD_HPP
+#define CPP_FILECOIN_CORE_STORAGE_IPFS_IMPL_BUFFERED_IPLD_HPP
+
+#include <map>
+
+#include "storage/ipfs/datastore.hpp"
+
+namespace fc::storage::ipfs {
+
+  /**
+   * @class BufferedIpld IpfsDatastore decorator, which keeps written blocks in
+   * memory until flush. Only blocks reachable from flushed roots are written
+   * to underlying store, intermediate blocks are dropped.
+   */
+  class BufferedIpld : public IpfsDatastore,
+                       public std::enable_shared_from_this<BufferedIpld> {
+   public:
+    explicit BufferedIpld(IpldPtr ipld);
+
+    ~BufferedIpld() override = default;
+
+    /** @copydoc IpfsDatastore::contains() */
+    outcome::result<bool> contains(const CID &key) const override;
+
+    /** @copydoc IpfsDatastore::set() */
+    outcome::result<void> set(const CID &key, Value value) override;
+
+    /** @copydoc IpfsDatastore::setMany() */
+    outcome::result<void> setMany(Batch batch) override;
+
+    /** @copydoc IpfsDatastore::get() */
+    outcome::result<Value> get(const CID &key) const override;
+
+    /** @copydoc IpfsDatastore::view() */
+    outcome::result<void> view(const CID &key,
+                               const ViewCallback &callback) const override;
+
+    /** @copydoc IpfsDatastore::remove() */
+    outcome::result<void> remove(const CID &key) override;
+
+    IpldPtr shared() override {
+      return shared_from_this();
+    }
+
+    /**
+     * @brief writes buffered blocks reachable from roots to underlying store
+     * with single batch and clears buffer
+     * @param roots - cids of roots to keep
+     * @return success or error
+     */
+    outcome::result<void> flush(const std::vector<CID> &roots);
+
+    /// Number of buffered blocks
+    size_t size() const;
+
+    /// Moves out all buffered blocks without writing them to underlying store
+    Batch release();
+
+   private:
+    IpldPtr ipld_;
+    std::map<CID, Value> buffer_;
+  };
+
+}  // namespace fc::storage::ipfs
+
+#endif  // CPP_FILECOIN_CORE_STORAGE_IPFS_IMPL_BUFFERED_IPLD_HPP
@@ -43,6 +43,15 @@ namespace fc::storage::ipfs {
     return leveldb_->put(encoded_key, common::Buffer(std::move(value)));
   }
 
+  outcome::result<void> LeveldbDatastore::setMany(Batch batch) {
+    auto leveldb_batch = leveldb_->batch();
+    for (auto &[key, value] : batch) {
+      OUTCOME_TRY(encoded_key, encodeKey(key));
+      OUTCOME_TRY(leveldb_batch->put(encoded_key, std::move(value)));
+    }
+    return leveldb_batch->commit();
+  }
+
   outcome::result<LeveldbDatastore::Value> LeveldbDatastore::get(
       const CID &key) const {
     OUTCOME_TRY(encoded_key, encodeKey(key));
@@ -52,6 +61,15 @@ namespace fc::storage::ipfs {
     return res;
   }
 
+  outcome::result<void> LeveldbDatastore::view(
+      const CID &key, const ViewCallback &callback) const {
+    OUTCOME_TRY(encoded_key, encodeKey(key));
+    auto res = leveldb_->view(encoded_key, callback);
+    if (res.has_error() && res.error() == fc::storage::LevelDBError::kNotFound)
+      return fc::storage::ipfs::IpfsDatastoreError::kNotFound;
+    return res;
+  }
+
   outcome::result<void> LeveldbDatastore::remove(const CID &key) {
     OUTCOME_TRY(encoded_key, encodeKey(key));
     return leveldb_->remove(encoded_key);
@@ -43,8 +43,15 @@ namespace fc::storage::ipfs {
 
     outcome::result<void> set(const CID &key, Value value) override;
 
+    /// Writes all pairs with single leveldb write batch
+    outcome::result<void> setMany(Batch batch) override;
+
     outcome::result<Value> get(const CID &key) const override;
 
+    /// Decodes from leveldb read buffer without copying to Value
+    outcome::result<void> view(const CID &key,
+                               const ViewCallback &callback) const override;
+
     outcome::result<void> remove(const CID &key) override;
 
     IpldPtr shared() override {
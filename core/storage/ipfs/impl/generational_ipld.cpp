@@ -0,0 +1,259 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/generational_ipld.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <unordered_set>
+
+#include "storage/ipld/traverser.hpp"
+
+namespace fc::storage::ipfs {
+  /// Max blocks copied with single batch by collect
+  constexpr size_t kCollectBatchSize{1 << 12};
+
+  GenerationalIpld::GenerationalIpld(Open open,
+                                     Destroy destroy,
+                                     Persist persist)
+      : open_{std::move(open)},
+        destroy_{std::move(destroy)},
+        persist_{std::move(persist)} {}
+
+  outcome::result<std::shared_ptr<GenerationalIpld>> GenerationalIpld::create(
+      Open open, Destroy destroy, Persist persist, const Marker &marker) {
+    std::shared_ptr<GenerationalIpld> ipld{new GenerationalIpld{
+        std::move(open), std::move(destroy), std::move(persist)}};
+    auto generation{marker.generation};
+    // generations older than previous one are open while collected
+    auto count{std::min<uint64_t>(generation + 1, marker.collecting ? 3 : 2)};
+    for (uint64_t i{0}; i < count; ++i) {
+      OUTCOME_TRY(store, ipld->open_(generation - i));
+      ipld->generations_.emplace_back(generation - i, std::move(store));
+    }
+    if (!marker.collecting && generation >= 2) {
+      // collection was interrupted after marker was persisted
+      OUTCOME_TRY(ipld->destroy_(generation - 2));
+    }
+    return ipld;
+  }
+
+  outcome::result<GenerationalIpld::Marker> GenerationalIpld::readMarker(
+      const std::string &path) {
+    Marker marker;
+    std::ifstream file{path};
+    if (!file.is_open()) {
+      if (boost::filesystem::exists(path)) {
+        return GenerationalIpldError::kInvalidMarker;
+      }
+      return marker;
+    }
+    if (!(file >> marker.generation >> marker.collecting)) {
+      return GenerationalIpldError::kInvalidMarker;
+    }
+    return marker;
+  }
+
+  GenerationalIpld::Persist GenerationalIpld::fileMarker(std::string path) {
+    return [path{std::move(path)}](
+               const Marker &marker) -> outcome::result<void> {
+      auto text{std::to_string(marker.generation) + " "
+                + (marker.collecting ? "1" : "0") + "\n"};
+      auto temp_path{path + ".tmp"};
+      auto fd{::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+      if (fd == -1) {
+        return GenerationalIpldError::kCannotWriteMarker;
+      }
+      auto written{::write(fd, text.data(), text.size())
+                       == static_cast<ssize_t>(text.size())
+                   && ::fdatasync(fd) == 0};
+      ::close(fd);
+      boost::system::error_code ec;
+      if (written) {
+        boost::filesystem::rename(temp_path, path, ec);
+      }
+      if (!written || ec.failed()) {
+        boost::filesystem::remove(temp_path, ec);
+        return GenerationalIpldError::kCannotWriteMarker;
+      }
+      // rename is durable when directory is synced
+      auto parent{boost::filesystem::absolute(path).parent_path().string()};
+      auto dir{::open(parent.c_str(), O_RDONLY | O_DIRECTORY)};
+      if (dir == -1) {
+        return GenerationalIpldError::kCannotWriteMarker;
+      }
+      auto synced{::fsync(dir) == 0};
+      ::close(dir);
+      if (!synced) {
+        return GenerationalIpldError::kCannotWriteMarker;
+      }
+      return outcome::success();
+    };
+  }
+
+  outcome::result<bool> GenerationalIpld::contains(const CID &key) const {
+    std::shared_lock lock{mutex_};
+    for (size_t i{0}; i < generations_.size(); ++i) {
+      OUTCOME_TRY(has, generations_[i].second->contains(key));
+      if (has) {
+        if (collected(i)) {
+          OUTCOME_TRY(value, generations_[i].second->get(key));
+          OUTCOME_TRY(generations_.front().second->set(key, std::move(value)));
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
+  outcome::result<void> GenerationalIpld::set(const CID &key, Value value) {
+    std::shared_lock lock{mutex_};
+    return generations_.front().second->set(key, std::move(value));
+  }
+
+  outcome::result<void> GenerationalIpld::setMany(Batch batch) {
+    std::shared_lock lock{mutex_};
+    return generations_.front().second->setMany(std::move(batch));
+  }
+
+  outcome::result<GenerationalIpld::Value> GenerationalIpld::get(
+      const CID &key) const {
+    OUTCOME_TRY(found, find(key, true));
+    if (!found) {
+      return IpfsDatastoreError::kNotFound;
+    }
+    return std::move(found->second);
+  }
+
+  outcome::result<void> GenerationalIpld::remove(const CID &key) {
+    std::shared_lock lock{mutex_};
+    for (auto &generation : generations_) {
+      OUTCOME_TRY(generation.second->remove(key));
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> GenerationalIpld::collect(
+      const std::vector<CID> &dags, const std::vector<CID> &blocks) {
+    {
+      std::unique_lock lock{mutex_};
+      auto next{generations_.front().first + 1};
+      OUTCOME_TRY(store, open_(next));
+      auto collecting{generations_.size() >= 2};
+      // new generation is persisted before it receives writes
+      OUTCOME_TRY(persist_({next, collecting}));
+      generations_.emplace(generations_.begin(), next, std::move(store));
+      collecting_ = collecting;
+      if (!collecting_) {
+        return outcome::success();
+      }
+    }
+    // collected generations are changed only by collect, so they are read
+    // unlocked
+    auto &current{generations_.front().second};
+    Batch batch;
+    std::unordered_set<CID> visited;
+    std::vector<CID> queue;
+    auto keep{[&](const CID &cid, bool walk) -> outcome::result<void> {
+      if (!visited.insert(cid).second) {
+        return outcome::success();
+      }
+      OUTCOME_TRY(found, find(cid, false));
+      // partial dags, like of snapshots, are kept as they are
+      if (!found) {
+        return outcome::success();
+      }
+      auto &[index, value]{*found};
+      if (walk) {
+        OUTCOME_TRY(links, ipld::traverser::blockLinks(cid, value));
+        queue.insert(queue.end(),
+                     std::make_move_iterator(links.begin()),
+                     std::make_move_iterator(links.end()));
+      }
+      if (collected(index)) {
+        batch.emplace_back(cid, std::move(value));
+        if (batch.size() >= kCollectBatchSize) {
+          OUTCOME_TRY(current->setMany(std::move(batch)));
+          batch.clear();
+        }
+      }
+      return outcome::success();
+    }};
+    for (auto &cid : blocks) {
+      OUTCOME_TRY(keep(cid, false));
+    }
+    queue = dags;
+    while (!queue.empty()) {
+      auto cid{std::move(queue.back())};
+      queue.pop_back();
+      OUTCOME_TRY(keep(cid, true));
+    }
+    if (!batch.empty()) {
+      OUTCOME_TRY(current->setMany(std::move(batch)));
+    }
+    // reachable blocks are copied, so collected generations are not opened
+    // again, before they are destroyed
+    OUTCOME_TRY(persist_({generations_.front().first, false}));
+    std::vector<std::pair<uint64_t, IpldPtr>> dropped;
+    {
+      std::unique_lock lock{mutex_};
+      dropped.assign(std::make_move_iterator(generations_.begin() + 2),
+                     std::make_move_iterator(generations_.end()));
+      generations_.resize(2);
+      collecting_ = false;
+    }
+    for (auto &[generation, store] : dropped) {
+      // store is closed before it is destroyed
+      store.reset();
+      OUTCOME_TRY(destroy_(generation));
+    }
+    return outcome::success();
+  }
+
+  bool GenerationalIpld::collected(size_t index) const {
+    // block may be referenced by writes during collection
+    return collecting_ && index >= 2;
+  }
+
+  uint64_t GenerationalIpld::generation() const {
+    std::shared_lock lock{mutex_};
+    return generations_.front().first;
+  }
+
+  outcome::result<boost::optional<std::pair<size_t, GenerationalIpld::Value>>>
+  GenerationalIpld::find(const CID &key, bool copy) const {
+    std::shared_lock lock{mutex_};
+    for (size_t i{0}; i < generations_.size(); ++i) {
+      auto &store{generations_[i].second};
+      auto value{store->get(key)};
+      if (!value) {
+        if (value.error() == IpfsDatastoreError::kNotFound) {
+          continue;
+        }
+        return value.error();
+      }
+      if (copy && collected(i)) {
+        OUTCOME_TRY(generations_.front().second->set(key, value.value()));
+      }
+      return std::make_pair(i, std::move(value.value()));
+    }
+    return boost::none;
+  }
+
+}  // namespace fc::storage::ipfs
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::ipfs, GenerationalIpldError, e) {
+  using E = fc::storage::ipfs::GenerationalIpldError;
+  switch (e) {
+    case E::kCannotWriteMarker:
+      return "GenerationalIpldError: cannot write marker";
+    case E::kInvalidMarker:
+      return "GenerationalIpldError: invalid marker";
+    default:
+      return "GenerationalIpldError: unknown error";
+  }
+}
@@ -0,0 +1,127 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_STORAGE_IPFS_IMPL_GENERATIONAL_IPLD_HPP
+#define CPP_FILECOIN_CORE_STORAGE_IPFS_IMPL_GENERATIONAL_IPLD_HPP
+
+#include <shared_mutex>
+
+#include "storage/ipfs/datastore.hpp"
+
+namespace fc::storage::ipfs {
+
+  /**
+   * @class GenerationalIpld IpfsDatastore over generations of stores.
+   * Blocks are written to current generation and read from newest
+   * generation having them. Garbage is collected by starting new generation
+   * and dropping oldest one as whole, after blocks reachable from roots are
+   * copied from it, so no store ever deletes single blocks. Blocks read from
+   * oldest generation while it is collected are copied too, so blocks
+   * referenced by writes during collection are kept.
+   * Marker of generation is persisted through callback when collection
+   * starts and after blocks are copied, before oldest generation is
+   * destroyed, so interrupted collection reopens oldest generation too.
+   */
+  class GenerationalIpld
+      : public IpfsDatastore,
+        public std::enable_shared_from_this<GenerationalIpld> {
+   public:
+    /// Opens store of generation, creating empty one if needed
+    using Open = std::function<outcome::result<IpldPtr>(uint64_t)>;
+    /// Deletes store of generation, which is closed or does not exist
+    using Destroy = std::function<outcome::result<void>(uint64_t)>;
+
+    /// Current generation, collecting while generations older than previous
+    /// one are not destroyed yet
+    struct Marker {
+      uint64_t generation{};
+      bool collecting{};
+    };
+    /// Durably stores marker, returns after it is synced
+    using Persist = std::function<outcome::result<void>(const Marker &)>;
+
+    /**
+     * Opens current and previous generations, and one before them if
+     * collection was interrupted
+     * @param marker - last persisted marker
+     */
+    static outcome::result<std::shared_ptr<GenerationalIpld>> create(
+        Open open, Destroy destroy, Persist persist, const Marker &marker);
+
+    /// Reads marker from file, default one if file does not exist
+    static outcome::result<Marker> readMarker(const std::string &path);
+
+    /// Persists marker by synced write of temporary file renamed over path
+    static Persist fileMarker(std::string path);
+
+    ~GenerationalIpld() override = default;
+
+    /** @copydoc IpfsDatastore::contains() */
+    outcome::result<bool> contains(const CID &key) const override;
+
+    /** @copydoc IpfsDatastore::set() */
+    outcome::result<void> set(const CID &key, Value value) override;
+
+    /** @copydoc IpfsDatastore::setMany() */
+    outcome::result<void> setMany(Batch batch) override;
+
+    /** @copydoc IpfsDatastore::get() */
+    outcome::result<Value> get(const CID &key) const override;
+
+    /** @copydoc IpfsDatastore::remove() */
+    outcome::result<void> remove(const CID &key) override;
+
+    IpldPtr shared() override {
+      return shared_from_this();
+    }
+
+    /**
+     * Starts new generation and drops generations older than previous one,
+     * previous generation is kept whole, so blocks written since last
+     * collection survive.
+     * Runs concurrently with reads and writes.
+     * @param dags - roots of dags kept with all reachable blocks
+     * @param blocks - blocks kept without their links, like headers
+     */
+    outcome::result<void> collect(const std::vector<CID> &dags,
+                                  const std::vector<CID> &blocks);
+
+    /// Current generation
+    uint64_t generation() const;
+
+   private:
+    GenerationalIpld(Open open, Destroy destroy, Persist persist);
+
+    /**
+     * Finds block, newest generation first
+     * @param copy - copy block found in collected generation to current
+     * @return index of generation and value, none if not found
+     */
+    outcome::result<boost::optional<std::pair<size_t, Value>>> find(
+        const CID &key, bool copy) const;
+
+    /// Whether generation is dropped by collect
+    bool collected(size_t index) const;
+
+    Open open_;
+    Destroy destroy_;
+    Persist persist_;
+    mutable std::shared_mutex mutex_;
+    /// Generations from newest, with their numbers
+    std::vector<std::pair<uint64_t, IpldPtr>> generations_;
+    /// Generations older than previous one are dropped by collect
+    bool collecting_{false};
+  };
+
+  enum class GenerationalIpldError {
+    kCannotWriteMarker = 1,
+    kInvalidMarker,
+  };
+
+}  // namespace fc::storage::ipfs
+
+OUTCOME_HPP_DECLARE_ERROR(fc::storage::ipfs, GenerationalIpldError);
+
+#endif  // CPP_FILECOIN_CORE_STORAGE_IPFS_IMPL_GENERATIONAL_IPLD_HPP
@@ -9,23 +9,32 @@ using fc::storage::ipfs::InMemoryDatastore;
 using Value = fc::storage::ipfs::IpfsDatastore::Value;
 
 fc::outcome::result<bool> InMemoryDatastore::contains(const CID &key) const {
-  return storage_.find(key) != storage_.end();
+  return storage_.find(fc::cidKey(key)) != storage_.end();
 }
 
 fc::outcome::result<void> InMemoryDatastore::set(const CID &key, Value value) {
-  storage_[key] = value;
+  storage_[fc::cidKey(key)] = std::move(value);
   return fc::outcome::success();
 }
 
 fc::outcome::result<Value> InMemoryDatastore::get(const CID &key) const {
-  OUTCOME_TRY(found, contains(key));
-  if (!found) {
+  auto it = storage_.find(fc::cidKey(key));
+  if (it == storage_.end()) {
     return IpfsDatastoreError::kNotFound;
   }
-  return storage_.at(key);
+  return it->second;
+}
+
+fc::outcome::result<void> InMemoryDatastore::view(
+    const CID &key, const ViewCallback &callback) const {
+  auto it = storage_.find(fc::cidKey(key));
+  if (it == storage_.end()) {
+    return IpfsDatastoreError::kNotFound;
+  }
+  return callback(it->second);
 }
 
 fc::outcome::result<void> InMemoryDatastore::remove(const CID &key) {
-  storage_.erase(key);
+  storage_.erase(fc::cidKey(key));
   return fc::outcome::success();
 }
@@ -6,8 +6,9 @@
 #ifndef CPP_FILECOIN_IPFS_IMPL_IN_MEMORY_DATASTORE_HPP
 #define CPP_FILECOIN_IPFS_IMPL_IN_MEMORY_DATASTORE_HPP
 
-#include <map>
+#include <unordered_map>
 
+#include "primitives/cid/cb_cid.hpp"
 #include "storage/ipfs/datastore.hpp"
 
 namespace fc::storage::ipfs {
@@ -27,6 +28,10 @@ namespace fc::storage::ipfs {
     /** @copydoc IpfsDatastore::get() */
     outcome::result<Value> get(const CID &key) const override;
 
+    /** @copydoc IpfsDatastore::view() */
+    outcome::result<void> view(const CID &key,
+                               const ViewCallback &callback) const override;
+
     /** @copydoc IpfsDatastore::remove() */
     outcome::result<void> remove(const CID &key) override;
 
@@ -35,7 +40,7 @@ namespace fc::storage::ipfs {
     }
 
    private:
-    std::map<CID, Value> storage_;
+    std::unordered_map<CidKey, Value> storage_;
   };
 
 }  // namespace fc::storage::ipfs
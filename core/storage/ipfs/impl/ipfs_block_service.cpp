@@ -20,11 +20,20 @@ namespace fc::storage::ipfs {
     return local_storage_->set(key, std::move(value));
   }
 
+  outcome::result<void> IpfsBlockService::setMany(Batch batch) {
+    return local_storage_->setMany(std::move(batch));
+  }
+
   outcome::result<IpfsBlockService::Value> IpfsBlockService::get(
       const CID &key) const {
     return local_storage_->get(key);
   }
 
+  outcome::result<void> IpfsBlockService::view(
+      const CID &key, const ViewCallback &callback) const {
+    return local_storage_->view(key, callback);
+  }
+
   outcome::result<void> IpfsBlockService::remove(const CID &key) {
     return local_storage_->remove(key);
   }
@@ -23,8 +23,13 @@ namespace fc::storage::ipfs {
 
     outcome::result<void> set(const CID &key, Value value) override;
 
+    outcome::result<void> setMany(Batch batch) override;
+
     outcome::result<Value> get(const CID &key) const override;
 
+    outcome::result<void> view(const CID &key,
+                               const ViewCallback &callback) const override;
+
     outcome::result<void> remove(const CID &key) override;
 
     IpldPtr shared() override {
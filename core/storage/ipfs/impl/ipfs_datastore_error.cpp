@@ -11,6 +11,8 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::ipfs, IpfsDatastoreError, e) {
   switch (e) {
     case IpfsDatastoreError::kNotFound:
       return "IpfsDatastoreError: cid not found";
+    case IpfsDatastoreError::kReadOnly:
+      return "IpfsDatastoreError: datastore is read-only";
     default:
       return "unknown error";
   }
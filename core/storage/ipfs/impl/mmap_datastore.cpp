@@ -0,0 +1,584 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/mmap_datastore.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#include "crypto/hasher/hasher.hpp"
+
+namespace fc::storage::ipfs {
+  using libp2p::multi::HashType;
+
+  namespace {
+    /// File header, magic, size of committed part and of its synced prefix
+    struct Header {
+      uint64_t magic;
+      uint64_t committed;
+      uint64_t synced;
+    };
+
+    /// Record is followed by key and value bytes
+    struct Record {
+      uint32_t key_size;
+      uint32_t value_size;
+    };
+
+    /// Index file header, keys of records below indexed are in slots
+    struct IndexHeader {
+      uint64_t magic;
+      uint64_t indexed;
+      uint64_t slots;
+      uint64_t used;
+    };
+
+    /// Hash of key and offset of last record of key, empty if offset is 0
+    struct Slot {
+      uint64_t hash;
+      uint64_t offset;
+    };
+
+    constexpr uint64_t kMagic{0x3244504d4d4346};       // "FCMMPD2"
+    constexpr uint64_t kIndexMagic{0x3158444d4d4346};  // "FCMMDX1"
+    constexpr uint32_t kTombstone{UINT32_MAX};
+    /// Slots of new index, index is doubled when half full
+    constexpr uint64_t kIndexSlots{1 << 16};
+
+    /// FNV-1a, stable across builds, as index file depends on it
+    uint64_t hashKey(gsl::span<const uint8_t> key) {
+      uint64_t hash{0xcbf29ce484222325};
+      for (auto byte : key) {
+        hash = (hash ^ byte) * 0x100000001b3;
+      }
+      return hash;
+    }
+
+    uint64_t indexFileSize(uint64_t slots) {
+      return sizeof(IndexHeader) + slots * sizeof(Slot);
+    }
+
+    IndexHeader &indexHeader(uint8_t *map) {
+      return *reinterpret_cast<IndexHeader *>(map);
+    }
+
+    Slot *indexSlots(uint8_t *map) {
+      return reinterpret_cast<Slot *>(map + sizeof(IndexHeader));
+    }
+
+    /// Record at offset with its key and value, none if it exceeds end
+    struct RecordView {
+      Record record;
+      gsl::span<const uint8_t> key;
+      gsl::span<const uint8_t> value;
+
+      bool removed() const {
+        return record.value_size == kTombstone;
+      }
+
+      uint64_t size() const {
+        return sizeof(Record) + key.size() + value.size();
+      }
+    };
+
+    boost::optional<RecordView> readRecord(const uint8_t *map,
+                                           uint64_t end,
+                                           uint64_t offset) {
+      RecordView view;
+      if (offset > end || end - offset < sizeof(view.record)) {
+        return boost::none;
+      }
+      memcpy(&view.record, map + offset, sizeof(view.record));
+      auto value_size{view.removed() ? 0 : view.record.value_size};
+      if (end - offset - sizeof(view.record)
+          < uint64_t{view.record.key_size} + value_size) {
+        return boost::none;
+      }
+      view.key = gsl::make_span(map + offset + sizeof(view.record),
+                                view.record.key_size);
+      view.value = gsl::make_span(view.key.data() + view.key.size(),
+                                  value_size);
+      return view;
+    }
+
+    bool sameKey(gsl::span<const uint8_t> lhs, gsl::span<const uint8_t> rhs) {
+      return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    /// Whether record key is cid and value matches it, other hashes are
+    /// trusted
+    bool validRecord(const RecordView &view) {
+      auto cid{CID::fromBytes(view.key)};
+      if (!cid) {
+        return false;
+      }
+      auto type{cid.value().content_address.getType()};
+      if (view.removed()
+          || (type != HashType::sha256 && type != HashType::blake2b_256)) {
+        return true;
+      }
+      return crypto::Hasher::calculate(type, view.value)
+             == cid.value().content_address;
+    }
+
+    outcome::result<Buffer> encodeKey(const CID &key) {
+      OUTCOME_TRY(bytes, key.toBytes());
+      return Buffer{std::move(bytes)};
+    }
+
+    bool writeAll(int fd, const uint8_t *data, size_t size, uint64_t offset) {
+      while (size != 0) {
+        auto n{::pwrite(fd, data, size, offset)};
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n <= 0) {
+          return false;
+        }
+        data += n;
+        size -= n;
+        offset += n;
+      }
+      return true;
+    }
+
+    template <typename T>
+    bool writeAll(int fd, const T &value, uint64_t offset) {
+      return writeAll(
+          fd, reinterpret_cast<const uint8_t *>(&value), sizeof(value), offset);
+    }
+
+    template <typename T>
+    void append(Buffer &out, const T &value) {
+      auto bytes{reinterpret_cast<const uint8_t *>(&value)};
+      out.put(gsl::make_span(bytes, sizeof(value)));
+    }
+  }  // namespace
+
+  MmapDatastore::MmapDatastore(int fd,
+                               const uint8_t *map,
+                               std::string index_path,
+                               MmapDatastoreConfig config)
+      : fd_{fd},
+        map_{map},
+        index_path_{std::move(index_path)},
+        config_{config} {}
+
+  MmapDatastore::~MmapDatastore() {
+    if (index_map_) {
+      std::lock_guard lock{write_mutex_};
+      std::ignore = syncLocked();
+      ::munmap(index_map_, index_map_size_);
+    }
+    if (index_fd_ >= 0) {
+      ::close(index_fd_);
+    }
+    ::munmap(const_cast<uint8_t *>(map_), config_.map_size);
+    ::close(fd_);
+  }
+
+  outcome::result<std::shared_ptr<MmapDatastore>> MmapDatastore::create(
+      const std::string &path, MmapDatastoreConfig config) {
+    auto fd{::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)};
+    if (fd < 0) {
+      return MmapDatastoreError::kCannotOpen;
+    }
+    struct stat stat {};
+    if (::fstat(fd, &stat) != 0) {
+      ::close(fd);
+      return MmapDatastoreError::kCannotOpen;
+    }
+    Header header{kMagic, sizeof(Header), sizeof(Header)};
+    if (stat.st_size == 0) {
+      if (!writeAll(fd, header, 0) || ::fdatasync(fd) != 0) {
+        ::close(fd);
+        return MmapDatastoreError::kCannotWrite;
+      }
+    } else if (stat.st_size < static_cast<off_t>(sizeof(Header))
+               || ::pread(fd, &header, sizeof(header), 0) != sizeof(header)
+               || header.magic != kMagic
+               || header.committed > static_cast<uint64_t>(stat.st_size)
+               || header.synced > header.committed
+               || header.synced < sizeof(Header)) {
+      ::close(fd);
+      return MmapDatastoreError::kCorrupted;
+    }
+    if (header.committed > config.map_size) {
+      ::close(fd);
+      return MmapDatastoreError::kMapFull;
+    }
+    // drop records of transaction interrupted before commit
+    if (header.committed < static_cast<uint64_t>(stat.st_size)
+        && ::ftruncate(fd, header.committed) != 0) {
+      ::close(fd);
+      return MmapDatastoreError::kCannotWrite;
+    }
+    // pages past end of file are not accessed, they become valid as file
+    // grows
+    auto map{::mmap(nullptr, config.map_size, PROT_READ, MAP_SHARED, fd, 0)};
+    if (map == MAP_FAILED) {
+      ::close(fd);
+      return MmapDatastoreError::kCannotMap;
+    }
+    std::shared_ptr<MmapDatastore> datastore{
+        new MmapDatastore{fd,
+                          static_cast<const uint8_t *>(map),
+                          path + ".idx",
+                          config}};
+    OUTCOME_TRY(datastore->openIndex(header.synced));
+    OUTCOME_TRY(datastore->load(header.synced, header.committed));
+    // keys read on open are moved to index file
+    OUTCOME_TRY(datastore->sync());
+    return datastore;
+  }
+
+  outcome::result<void> MmapDatastore::openIndex(uint64_t synced) {
+    index_fd_ = ::open(index_path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (index_fd_ < 0) {
+      return MmapDatastoreError::kCannotOpen;
+    }
+    struct stat stat {};
+    if (::fstat(index_fd_, &stat) != 0) {
+      return MmapDatastoreError::kCannotOpen;
+    }
+    IndexHeader header{};
+    auto valid{
+        stat.st_size >= static_cast<off_t>(sizeof(header))
+        && ::pread(index_fd_, &header, sizeof(header), 0) == sizeof(header)
+        && header.magic == kIndexMagic && header.slots >= kIndexSlots
+        && (header.slots & (header.slots - 1)) == 0
+        && static_cast<uint64_t>(stat.st_size) == indexFileSize(header.slots)
+        && header.indexed >= sizeof(Header) && header.indexed <= synced};
+    if (!valid) {
+      // missing or foreign index is rebuilt from all records
+      header = {kIndexMagic, sizeof(Header), kIndexSlots, 0};
+      if (::ftruncate(index_fd_, 0) != 0
+          || ::ftruncate(index_fd_, indexFileSize(header.slots)) != 0
+          || !writeAll(index_fd_, header, 0)) {
+        return MmapDatastoreError::kCannotWrite;
+      }
+    }
+    return mapIndex(index_fd_, header.slots);
+  }
+
+  outcome::result<void> MmapDatastore::mapIndex(int fd, uint64_t slots) {
+    auto size{indexFileSize(slots)};
+    auto map{::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+    if (map == MAP_FAILED) {
+      return MmapDatastoreError::kCannotMap;
+    }
+    index_map_ = static_cast<uint8_t *>(map);
+    index_map_size_ = size;
+    return outcome::success();
+  }
+
+  outcome::result<void> MmapDatastore::load(uint64_t synced,
+                                            uint64_t committed) {
+    auto offset{indexHeader(index_map_).indexed};
+    while (offset < committed) {
+      auto view{readRecord(map_, committed, offset)};
+      // records after sync may be lost on crash, even if committed
+      if (!view || (offset >= synced && !validRecord(*view))) {
+        if (offset < synced) {
+          return MmapDatastoreError::kCorrupted;
+        }
+        break;
+      }
+      recent_[Buffer{view->key}] = offset;
+      offset += view->size();
+    }
+    if (offset < committed) {
+      if (::ftruncate(fd_, offset) != 0
+          || !writeAll(fd_, offset, offsetof(Header, committed))) {
+        return MmapDatastoreError::kCannotWrite;
+      }
+    }
+    end_ = offset;
+    synced_ = synced;
+    return outcome::success();
+  }
+
+  boost::optional<uint64_t> MmapDatastore::lookup(const Buffer &key) const {
+    if (auto it{recent_.find(key)}; it != recent_.end()) {
+      return it->second;
+    }
+    auto &header{indexHeader(index_map_)};
+    auto slots{indexSlots(index_map_)};
+    auto mask{header.slots - 1};
+    auto hash{hashKey(key)};
+    // index is at most half full, so probe reaches empty slot
+    for (auto i{hash & mask};; i = (i + 1) & mask) {
+      auto &slot{slots[i]};
+      if (slot.offset == 0) {
+        return boost::none;
+      }
+      if (slot.hash == hash) {
+        auto view{readRecord(map_, end_, slot.offset)};
+        if (view && sameKey(view->key, key)) {
+          return slot.offset;
+        }
+      }
+    }
+  }
+
+  boost::optional<gsl::span<const uint8_t>> MmapDatastore::find(
+      const Buffer &key) const {
+    std::shared_lock lock{index_mutex_};
+    auto offset{lookup(key)};
+    if (!offset) {
+      return boost::none;
+    }
+    auto view{readRecord(map_, end_, *offset)};
+    if (!view || view->removed()) {
+      return boost::none;
+    }
+    return view->value;
+  }
+
+  outcome::result<void> MmapDatastore::commit(
+      const std::vector<std::pair<Buffer, const Value *>> &records) {
+    std::lock_guard write_lock{write_mutex_};
+    auto end{end_.load()};
+    Buffer bytes;
+    // record offsets of keys
+    std::vector<std::pair<const Buffer *, uint64_t>> offsets;
+    for (auto &[key, value] : records) {
+      // blocks are immutable, existing key has same value
+      if (value && find(key)) {
+        continue;
+      }
+      offsets.emplace_back(&key, end + bytes.size());
+      append(bytes,
+             Record{static_cast<uint32_t>(key.size()),
+                    value ? static_cast<uint32_t>(value->size()) : kTombstone});
+      bytes.put(key);
+      if (value) {
+        bytes.put(*value);
+      }
+    }
+    if (bytes.empty()) {
+      return outcome::success();
+    }
+    if (end + bytes.size() > config_.map_size) {
+      return MmapDatastoreError::kMapFull;
+    }
+    // header survives process crash, records after synced size are checked
+    // on open in case of power loss
+    if (!writeAll(fd_, bytes.data(), bytes.size(), end)
+        || !writeAll(fd_, end + bytes.size(), offsetof(Header, committed))) {
+      return MmapDatastoreError::kCannotWrite;
+    }
+    end += bytes.size();
+    {
+      std::unique_lock lock{index_mutex_};
+      for (auto &[key, offset] : offsets) {
+        recent_[*key] = offset;
+      }
+      end_ = end;
+    }
+    if (end - synced_ >= config_.sync_bytes) {
+      return syncLocked();
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> MmapDatastore::sync() {
+    std::lock_guard lock{write_mutex_};
+    return syncLocked();
+  }
+
+  outcome::result<void> MmapDatastore::syncLocked() {
+    auto end{end_.load()};
+    if (synced_ != end) {
+      // records are on disk before header marks them synced
+      if ((config_.sync && ::fdatasync(fd_) != 0)
+          || !writeAll(fd_, end, offsetof(Header, synced))
+          || (config_.sync && ::fdatasync(fd_) != 0)) {
+        return MmapDatastoreError::kCannotWrite;
+      }
+      synced_ = end;
+    }
+    return checkpoint();
+  }
+
+  outcome::result<void> MmapDatastore::checkpoint() {
+    if (recent_.empty()) {
+      return outcome::success();
+    }
+    std::unique_lock lock{index_mutex_};
+    auto used{indexHeader(index_map_).used};
+    if ((used + recent_.size()) * 2 > indexHeader(index_map_).slots) {
+      auto slots{indexHeader(index_map_).slots};
+      while ((used + recent_.size()) * 2 > slots) {
+        slots *= 2;
+      }
+      OUTCOME_TRY(growIndex(slots));
+    }
+    auto &header{indexHeader(index_map_)};
+    auto slots{indexSlots(index_map_)};
+    auto mask{header.slots - 1};
+    for (auto &[key, offset] : recent_) {
+      auto hash{hashKey(key)};
+      for (auto i{hash & mask};; i = (i + 1) & mask) {
+        auto &slot{slots[i]};
+        if (slot.offset == 0) {
+          slot = {hash, offset};
+          ++used;
+          break;
+        }
+        if (slot.hash == hash) {
+          auto view{readRecord(map_, end_, slot.offset)};
+          if (view && sameKey(view->key, key)) {
+            slot.offset = offset;
+            break;
+          }
+        }
+      }
+    }
+    // slots are on disk before header covers their records
+    if (config_.sync && ::msync(index_map_, index_map_size_, MS_SYNC) != 0) {
+      return MmapDatastoreError::kCannotWrite;
+    }
+    header.used = used;
+    header.indexed = synced_;
+    if (config_.sync && ::msync(index_map_, sizeof(header), MS_SYNC) != 0) {
+      return MmapDatastoreError::kCannotWrite;
+    }
+    recent_.clear();
+    return outcome::success();
+  }
+
+  outcome::result<void> MmapDatastore::growIndex(uint64_t slots) {
+    auto path{index_path_ + ".tmp"};
+    auto fd{::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+    if (fd < 0) {
+      return MmapDatastoreError::kCannotOpen;
+    }
+    auto size{indexFileSize(slots)};
+    auto fail{[&](MmapDatastoreError error, void *map) {
+      if (map) {
+        ::munmap(map, size);
+      }
+      ::close(fd);
+      ::unlink(path.c_str());
+      return error;
+    }};
+    if (::ftruncate(fd, size) != 0) {
+      return fail(MmapDatastoreError::kCannotWrite, nullptr);
+    }
+    auto map{::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+    if (map == MAP_FAILED) {
+      return fail(MmapDatastoreError::kCannotMap, nullptr);
+    }
+    auto new_map{static_cast<uint8_t *>(map)};
+    auto &old{indexHeader(index_map_)};
+    indexHeader(new_map) = {kIndexMagic, old.indexed, slots, old.used};
+    auto old_slots{indexSlots(index_map_)};
+    auto new_slots{indexSlots(new_map)};
+    auto mask{slots - 1};
+    // keys are unique, so slots are moved without reading records
+    for (uint64_t i{}; i < old.slots; ++i) {
+      auto &slot{old_slots[i]};
+      if (slot.offset == 0) {
+        continue;
+      }
+      auto j{slot.hash & mask};
+      while (new_slots[j].offset != 0) {
+        j = (j + 1) & mask;
+      }
+      new_slots[j] = slot;
+    }
+    if ((config_.sync && ::msync(map, size, MS_SYNC) != 0)
+        || ::rename(path.c_str(), index_path_.c_str()) != 0) {
+      return fail(MmapDatastoreError::kCannotWrite, map);
+    }
+    ::munmap(index_map_, index_map_size_);
+    ::close(index_fd_);
+    index_fd_ = fd;
+    index_map_ = new_map;
+    index_map_size_ = size;
+    return outcome::success();
+  }
+
+  outcome::result<bool> MmapDatastore::contains(const CID &key) const {
+    OUTCOME_TRY(encoded, encodeKey(key));
+    return find(encoded).has_value();
+  }
+
+  outcome::result<void> MmapDatastore::set(const CID &key, Value value) {
+    OUTCOME_TRY(encoded, encodeKey(key));
+    return commit({{std::move(encoded), &value}});
+  }
+
+  outcome::result<void> MmapDatastore::setMany(Batch batch) {
+    std::vector<std::pair<Buffer, const Value *>> records;
+    records.reserve(batch.size());
+    for (auto &[key, value] : batch) {
+      OUTCOME_TRY(encoded, encodeKey(key));
+      records.emplace_back(std::move(encoded), &value);
+    }
+    return commit(records);
+  }
+
+  outcome::result<IpfsDatastore::Value> MmapDatastore::get(
+      const CID &key) const {
+    OUTCOME_TRY(encoded, encodeKey(key));
+    if (auto bytes{find(encoded)}) {
+      return Value{*bytes};
+    }
+    return IpfsDatastoreError::kNotFound;
+  }
+
+  outcome::result<void> MmapDatastore::view(
+      const CID &key, const ViewCallback &callback) const {
+    OUTCOME_TRY(encoded, encodeKey(key));
+    // committed bytes are never overwritten while file is open
+    if (auto bytes{find(encoded)}) {
+      return callback(*bytes);
+    }
+    return IpfsDatastoreError::kNotFound;
+  }
+
+  outcome::result<void> MmapDatastore::remove(const CID &key) {
+    OUTCOME_TRY(encoded, encodeKey(key));
+    if (!find(encoded)) {
+      return outcome::success();
+    }
+    return commit({{std::move(encoded), nullptr}});
+  }
+
+  uint64_t MmapDatastore::size() const {
+    return end_;
+  }
+
+  size_t MmapDatastore::unindexed() const {
+    std::shared_lock lock{index_mutex_};
+    return recent_.size();
+  }
+}  // namespace fc::storage::ipfs
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::ipfs, MmapDatastoreError, e) {
+  using E = fc::storage::ipfs::MmapDatastoreError;
+  switch (e) {
+    case E::kCannotOpen:
+      return "MmapDatastoreError: cannot open file";
+    case E::kCannotMap:
+      return "MmapDatastoreError: cannot map file";
+    case E::kCannotWrite:
+      return "MmapDatastoreError: cannot write file";
+    case E::kCorrupted:
+      return "MmapDatastoreError: file is corrupted";
+    case E::kMapFull:
+      return "MmapDatastoreError: file exceeds map size";
+    default:
+      return "MmapDatastoreError: unknown error";
+  }
+}
@@ -0,0 +1,138 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_STORAGE_IPFS_IMPL_MMAP_DATASTORE_HPP
+#define CPP_FILECOIN_CORE_STORAGE_IPFS_IMPL_MMAP_DATASTORE_HPP
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "storage/ipfs/datastore.hpp"
+
+namespace fc::storage::ipfs {
+  enum class MmapDatastoreError {
+    kCannotOpen = 1,
+    kCannotMap,
+    kCannotWrite,
+    kCorrupted,
+    kMapFull,
+  };
+
+  struct MmapDatastoreConfig {
+    /**
+     * Address space reserved for file, it is mapped once and never
+     * remapped, so file cannot grow beyond it
+     */
+    uint64_t map_size{uint64_t{1} << 40};
+    /// Sync file and index when synced
+    bool sync{true};
+    /// Appended bytes after which file is synced and index is checkpointed
+    uint64_t sync_bytes{16 << 20};
+  };
+
+  /**
+   * Ipld blocks in single append-only file, mapped to memory.
+   * Blocks are immutable, so set and setMany append records and removed
+   * keys are marked with tombstones, there are no compactions. Each set,
+   * setMany and remove is one transaction, committed by updating committed
+   * size in file header. Writers are serialized, readers do not wait for
+   * them, view passes bytes from mapping without copying.
+   *
+   * File is synced once per sync_bytes appended, on sync() and on close.
+   * Records after last sync are checked against their cids on open, and
+   * file is truncated at first invalid record, so crash loses at most
+   * unsynced blocks.
+   *
+   * Keys are indexed by hash table in mapped "<path>.idx" file, which is
+   * updated on sync, only keys of records after last sync are kept in
+   * memory. Open reads records after last index update only.
+   */
+  class MmapDatastore : public IpfsDatastore,
+                        public std::enable_shared_from_this<MmapDatastore> {
+   public:
+    ~MmapDatastore() override;
+
+    /**
+     * Opens or creates datastore file and its index
+     * @param path - datastore file
+     */
+    static outcome::result<std::shared_ptr<MmapDatastore>> create(
+        const std::string &path, MmapDatastoreConfig config = {});
+
+    outcome::result<bool> contains(const CID &key) const override;
+
+    outcome::result<void> set(const CID &key, Value value) override;
+
+    /// Appends all pairs in single transaction
+    outcome::result<void> setMany(Batch batch) override;
+
+    outcome::result<Value> get(const CID &key) const override;
+
+    /// Passes bytes from mapping, without copying and locks during callback
+    outcome::result<void> view(const CID &key,
+                               const ViewCallback &callback) const override;
+
+    outcome::result<void> remove(const CID &key) override;
+
+    IpldPtr shared() override {
+      return shared_from_this();
+    }
+
+    /// Syncs committed records and writes them to index file
+    outcome::result<void> sync();
+
+    /// Bytes of file used by committed records
+    uint64_t size() const;
+
+    /// Keys of records after last index update, kept in memory
+    size_t unindexed() const;
+
+   private:
+    MmapDatastore(int fd,
+                  const uint8_t *map,
+                  std::string index_path,
+                  MmapDatastoreConfig config);
+
+    /// Maps index file, creates it if missing or ahead of synced records
+    outcome::result<void> openIndex(uint64_t synced);
+    outcome::result<void> mapIndex(int fd, uint64_t slots);
+    /// Reads records after index, validates unsynced ones
+    outcome::result<void> load(uint64_t synced, uint64_t committed);
+    /// Offset of last record of key, none if absent
+    boost::optional<uint64_t> lookup(const Buffer &key) const;
+    /// Value bytes of key, none if absent or removed
+    boost::optional<gsl::span<const uint8_t>> find(const Buffer &key) const;
+    /// Appends records, value of none is tombstone
+    outcome::result<void> commit(
+        const std::vector<std::pair<Buffer, const Value *>> &records);
+    outcome::result<void> syncLocked();
+    /// Moves keys of synced records from memory to index file
+    outcome::result<void> checkpoint();
+    /// Rewrites index file with more slots
+    outcome::result<void> growIndex(uint64_t slots);
+
+    int fd_;
+    const uint8_t *map_;
+    std::string index_path_;
+    MmapDatastoreConfig config_;
+    /// Serializes writers
+    std::mutex write_mutex_;
+    mutable std::shared_mutex index_mutex_;
+    int index_fd_{-1};
+    uint8_t *index_map_{nullptr};
+    uint64_t index_map_size_{};
+    /// Offsets of records after index, by key
+    std::unordered_map<Buffer, uint64_t> recent_;
+    std::atomic<uint64_t> end_{};
+    /// End of records synced to disk
+    uint64_t synced_{};
+  };
+}  // namespace fc::storage::ipfs
+
+OUTCOME_HPP_DECLARE_ERROR(fc::storage::ipfs, MmapDatastoreError);
+
+#endif  // CPP_FILECOIN_CORE_STORAGE_IPFS_IMPL_MMAP_DATASTORE_HPP
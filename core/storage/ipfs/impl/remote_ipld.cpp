@@ -0,0 +1,160 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/remote_ipld.hpp"
+
+#include <gsl/gsl_util>
+
+#include "crypto/hasher/hasher.hpp"
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::ipfs, RemoteIpldError, e) {
+  using fc::storage::ipfs::RemoteIpldError;
+  switch (e) {
+    case RemoteIpldError::kCidMismatch:
+      return "RemoteIpld: fetched block does not match cid";
+    case RemoteIpldError::kUnsupportedHash:
+      return "RemoteIpld: cid hash type cannot be verified";
+    default:
+      return "RemoteIpld: unknown error";
+  }
+}
+
+namespace fc::storage::ipfs {
+  using libp2p::multi::HashType;
+
+  /// Remote store is not trusted, so block must hash to its cid
+  outcome::result<void> verifyBlock(const CID &key,
+                                    const common::Buffer &value) {
+    auto type{key.content_address.getType()};
+    if (type != HashType::sha256 && type != HashType::blake2b_256) {
+      return RemoteIpldError::kUnsupportedHash;
+    }
+    if (crypto::Hasher::calculate(type, value) != key.content_address) {
+      return RemoteIpldError::kCidMismatch;
+    }
+    return outcome::success();
+  }
+
+  RemoteIpld::RemoteIpld(IpldPtr local, Fetch fetch)
+      : local_{std::move(local)}, fetch_{std::move(fetch)} {}
+
+  outcome::result<bool> RemoteIpld::contains(const CID &key) const {
+    OUTCOME_TRY(local, local_->contains(key));
+    if (local) {
+      return true;
+    }
+    OUTCOME_TRY(values, fetch({key}));
+    return values[0].has_value();
+  }
+
+  outcome::result<void> RemoteIpld::set(const CID &key, Value value) {
+    return local_->set(key, std::move(value));
+  }
+
+  outcome::result<void> RemoteIpld::setMany(Batch batch) {
+    return local_->setMany(std::move(batch));
+  }
+
+  outcome::result<RemoteIpld::Value> RemoteIpld::get(const CID &key) const {
+    OUTCOME_TRY(values, getMany({key}));
+    if (!values[0]) {
+      return IpfsDatastoreError::kNotFound;
+    }
+    return std::move(*values[0]);
+  }
+
+  outcome::result<void> RemoteIpld::remove(const CID &key) {
+    return local_->remove(key);
+  }
+
+  outcome::result<std::vector<boost::optional<RemoteIpld::Value>>>
+  RemoteIpld::getMany(const std::vector<CID> &keys) const {
+    std::vector<boost::optional<Value>> values(keys.size());
+    std::vector<CID> missing;
+    std::vector<size_t> positions;
+    for (size_t i{0}; i < keys.size(); ++i) {
+      OUTCOME_TRY(local, local_->contains(keys[i]));
+      if (local) {
+        OUTCOME_TRYA(values[i], local_->get(keys[i]));
+      } else {
+        missing.push_back(keys[i]);
+        positions.push_back(i);
+      }
+    }
+    if (!missing.empty()) {
+      OUTCOME_TRY(fetched, fetch(missing));
+      for (size_t i{0}; i < positions.size(); ++i) {
+        values[positions[i]] = std::move(fetched[i]);
+      }
+    }
+    return std::move(values);
+  }
+
+  outcome::result<std::vector<boost::optional<RemoteIpld::Value>>>
+  RemoteIpld::fetch(const std::vector<CID> &keys) const {
+    std::vector<std::shared_future<Fetched>> futures;
+    std::vector<CID> requested;
+    std::vector<std::promise<Fetched>> promises;
+    {
+      std::lock_guard lock{mutex_};
+      for (auto &key : keys) {
+        auto it{inflight_.find(key)};
+        if (it == inflight_.end()) {
+          auto &promise{promises.emplace_back()};
+          it = inflight_.emplace(key, promise.get_future().share()).first;
+          requested.push_back(key);
+        }
+        futures.push_back(it->second);
+      }
+    }
+
+    if (!requested.empty()) {
+      size_t answered{0};
+      // waiters are answered and requests cleared even if fetch throws
+      auto _ = gsl::finally([&] {
+        for (; answered < requested.size(); ++answered) {
+          promises[answered].set_value(
+              Fetched{IpfsDatastoreError::kNotFound});
+        }
+        std::lock_guard lock{mutex_};
+        for (auto &key : requested) {
+          inflight_.erase(key);
+        }
+      });
+      auto fetched{fetch_(requested)};
+      if (fetched && fetched.value().size() != requested.size()) {
+        fetched = IpfsDatastoreError::kNotFound;
+      }
+      for (; answered < requested.size(); ++answered) {
+        auto &key{requested[answered]};
+        Fetched result{fetched ? Fetched{std::move(fetched.value()[answered])}
+                               : Fetched{fetched.error()}};
+        if (result && result.value()) {
+          // remote block is cached only if it matches its cid
+          if (auto verified{verifyBlock(key, *result.value())}; !verified) {
+            result = verified.error();
+          } else if (auto stored{local_->set(key, *result.value())};
+                     !stored) {
+            // stored before request is done, so following reads find it
+            result = stored.error();
+          }
+        }
+        promises[answered].set_value(std::move(result));
+      }
+    }
+
+    std::vector<boost::optional<Value>> values;
+    values.reserve(keys.size());
+    for (auto &future : futures) {
+      auto &result{future.get()};
+      if (!result) {
+        return result.error();
+      }
+      values.push_back(result.value());
+    }
+    return std::move(values);
+  }
+
+}  // namespace fc::storage::ipfs
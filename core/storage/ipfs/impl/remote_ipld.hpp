@@ -0,0 +1,89 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_STORAGE_IPFS_IMPL_REMOTE_IPLD_HPP
+#define CPP_FILECOIN_CORE_STORAGE_IPFS_IMPL_REMOTE_IPLD_HPP
+
+#include <future>
+#include <map>
+#include <mutex>
+
+#include "storage/ipfs/datastore.hpp"
+
+namespace fc::storage::ipfs {
+  enum class RemoteIpldError {
+    kCidMismatch = 1,
+    kUnsupportedHash,
+  };
+
+  /**
+   * @class RemoteIpld IpfsDatastore reading through local cache store to
+   * remote authoritative block store, so read replicas don't keep full copy
+   * of chain. Fetched blocks are kept in local store, writes go to local
+   * store only. Concurrent reads of same missing block share one remote
+   * request, getMany fetches all its missing blocks with one request.
+   * Fetched blocks are verified against their cids before they are kept.
+   * Thread-safe if local store is.
+   */
+  class RemoteIpld : public IpfsDatastore,
+                     public std::enable_shared_from_this<RemoteIpld> {
+   public:
+    /// Fetches blocks from remote store, none for each absent block
+    using Fetch = std::function<outcome::result<
+        std::vector<boost::optional<Value>>>(const std::vector<CID> &)>;
+
+    /**
+     * @param local - cache tier, like leveldb or in-memory store
+     * @param fetch - transport to authoritative store
+     */
+    RemoteIpld(IpldPtr local, Fetch fetch);
+
+    ~RemoteIpld() override = default;
+
+    /** @copydoc IpfsDatastore::contains() */
+    outcome::result<bool> contains(const CID &key) const override;
+
+    /** @copydoc IpfsDatastore::set() */
+    outcome::result<void> set(const CID &key, Value value) override;
+
+    /** @copydoc IpfsDatastore::setMany() */
+    outcome::result<void> setMany(Batch batch) override;
+
+    /** @copydoc IpfsDatastore::get() */
+    outcome::result<Value> get(const CID &key) const override;
+
+    /** @copydoc IpfsDatastore::remove() */
+    outcome::result<void> remove(const CID &key) override;
+
+    IpldPtr shared() override {
+      return shared_from_this();
+    }
+
+    /**
+     * Gets blocks, blocks missing in local store are fetched together
+     * @return values by position of cids, none for blocks absent remotely
+     */
+    outcome::result<std::vector<boost::optional<Value>>> getMany(
+        const std::vector<CID> &keys) const;
+
+   private:
+    using Fetched = outcome::result<boost::optional<Value>>;
+
+    /// Fetches blocks missing locally, joining requests already in flight
+    outcome::result<std::vector<boost::optional<Value>>> fetch(
+        const std::vector<CID> &keys) const;
+
+    IpldPtr local_;
+    Fetch fetch_;
+    mutable std::mutex mutex_;
+    /// Blocks requested from remote store and not received yet
+    mutable std::map<CID, std::shared_future<Fetched>> inflight_;
+  };
+
+}  // namespace fc::storage::ipfs
+
+OUTCOME_HPP_DECLARE_ERROR(fc::storage::ipfs, RemoteIpldError);
+
+#endif  // CPP_FILECOIN_CORE_STORAGE_IPFS_IMPL_REMOTE_IPLD_HPP
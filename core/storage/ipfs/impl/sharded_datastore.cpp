@@ -0,0 +1,161 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/sharded_datastore.hpp"
+
+namespace fc::storage::ipfs {
+  ShardedDatastore::ShardedDatastore(ShardedDatastoreConfig config,
+                                     IpldPtr spill)
+      : spill_{std::move(spill)} {
+    size_t count{1};
+    while (count < config.shards) {
+      count <<= 1;
+    }
+    shards_ = std::make_unique<Shard[]>(count);
+    mask_ = count - 1;
+    if (spill_ && config.max_bytes != 0) {
+      shard_bytes_ = std::max<size_t>(1, config.max_bytes / count);
+    }
+  }
+
+  outcome::result<bool> ShardedDatastore::contains(const CID &key) const {
+    auto cid_key{cidKey(key)};
+    auto &shard{shardOf(cid_key)};
+    {
+      std::shared_lock lock{shard.mutex};
+      if (shard.entries.find(cid_key) != shard.entries.end()) {
+        return true;
+      }
+    }
+    if (spill_) {
+      return spill_->contains(key);
+    }
+    return false;
+  }
+
+  outcome::result<void> ShardedDatastore::set(const CID &key, Value value) {
+    auto cid_key{cidKey(key)};
+    auto &shard{shardOf(cid_key)};
+    std::unique_lock lock{shard.mutex};
+    auto [it, inserted]{shard.entries.try_emplace(cid_key)};
+    auto &entry{it->second};
+    if (inserted) {
+      entry.generation = ++shard.generation;
+      if (shard_bytes_ != 0) {
+        shard.clock.emplace_back(cid_key, entry.generation);
+      }
+    } else {
+      shard.bytes -= entry.value->size();
+    }
+    shard.bytes += value.size();
+    entry.value = std::make_shared<const Value>(std::move(value));
+    if (shard_bytes_ != 0 && shard.bytes > shard_bytes_) {
+      return evict(shard);
+    }
+    return outcome::success();
+  }
+
+  outcome::result<Ipld::Value> ShardedDatastore::get(const CID &key) const {
+    boost::optional<Value> value;
+    OUTCOME_TRY(view(key, [&](auto bytes) {
+      value.emplace(bytes);
+      return outcome::success();
+    }));
+    return std::move(*value);
+  }
+
+  outcome::result<void> ShardedDatastore::view(
+      const CID &key, const ViewCallback &callback) const {
+    auto cid_key{cidKey(key)};
+    auto &shard{shardOf(cid_key)};
+    std::shared_ptr<const Value> value;
+    {
+      std::shared_lock lock{shard.mutex};
+      auto it{shard.entries.find(cid_key)};
+      if (it != shard.entries.end()) {
+        it->second.referenced.store(true, std::memory_order_relaxed);
+        value = it->second.value;
+      }
+    }
+    if (value) {
+      return callback(*value);
+    }
+    if (spill_) {
+      return spill_->view(key, callback);
+    }
+    return IpfsDatastoreError::kNotFound;
+  }
+
+  outcome::result<void> ShardedDatastore::remove(const CID &key) {
+    auto cid_key{cidKey(key)};
+    auto &shard{shardOf(cid_key)};
+    {
+      std::unique_lock lock{shard.mutex};
+      auto it{shard.entries.find(cid_key)};
+      if (it != shard.entries.end()) {
+        shard.bytes -= it->second.value->size();
+        shard.entries.erase(it);
+      }
+    }
+    if (spill_) {
+      return spill_->remove(key);
+    }
+    return outcome::success();
+  }
+
+  size_t ShardedDatastore::bytes() const {
+    size_t bytes{0};
+    for (size_t i{0}; i <= mask_; ++i) {
+      std::shared_lock lock{shards_[i].mutex};
+      bytes += shards_[i].bytes;
+    }
+    return bytes;
+  }
+
+  ShardedDatastore::Shard &ShardedDatastore::shardOf(
+      const CidKey &key) const {
+    // map buckets use low bits of same hash, so shard is chosen by high bits
+    auto hash{std::hash<CidKey>{}(key) * 0x9E3779B97F4A7C15ull};
+    return shards_[(hash >> 40) & mask_];
+  }
+
+  outcome::result<void> ShardedDatastore::evict(Shard &shard) {
+    Batch batch;
+    std::vector<std::pair<CidKey, uint64_t>> evicted;
+    auto bytes{shard.bytes};
+    // each referenced key gets second chance, so loop ends after two passes
+    while (bytes > shard_bytes_ && !shard.clock.empty()) {
+      auto slot{std::move(shard.clock.front())};
+      shard.clock.pop_front();
+      auto it{shard.entries.find(slot.first)};
+      if (it == shard.entries.end() || it->second.generation != slot.second) {
+        continue;
+      }
+      auto &entry{it->second};
+      if (entry.referenced.exchange(false, std::memory_order_relaxed)) {
+        shard.clock.push_back(std::move(slot));
+        continue;
+      }
+      bytes -= entry.value->size();
+      auto &key{slot.first};
+      auto cid{std::holds_alternative<CbCid>(key)
+                   ? std::get<CbCid>(key).toCid()
+                   : std::get<CID>(key)};
+      batch.emplace_back(std::move(cid), *entry.value);
+      evicted.push_back(std::move(slot));
+    }
+    // blocks leave memory only after spill store has them
+    auto written{spill_->setMany(std::move(batch))};
+    if (!written) {
+      shard.clock.insert(shard.clock.begin(), evicted.begin(), evicted.end());
+      return written.error();
+    }
+    for (auto &slot : evicted) {
+      shard.entries.erase(slot.first);
+    }
+    shard.bytes = bytes;
+    return outcome::success();
+  }
+}  // namespace fc::storage::ipfs
@@ -0,0 +1,109 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_STORAGE_IPFS_IMPL_SHARDED_DATASTORE_HPP
+#define CPP_FILECOIN_CORE_STORAGE_IPFS_IMPL_SHARDED_DATASTORE_HPP
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "primitives/cid/cb_cid.hpp"
+#include "storage/ipfs/datastore.hpp"
+
+namespace fc::storage::ipfs {
+
+  struct ShardedDatastoreConfig {
+    /// Number of shards, rounded up to power of two
+    size_t shards{64};
+    /// Bytes of values kept in memory when spill store is set, 0 for no limit
+    size_t max_bytes{0};
+  };
+
+  /**
+   * @class ShardedDatastore Thread-safe in-memory IpfsDatastore.
+   * Blocks are split into shards by cid hash, each shard has own
+   * reader-writer lock, so concurrent reads never wait for each other and
+   * writes only wait for readers of same shard.
+   * With spill store and memory limit, shard over its part of limit moves
+   * least recently used blocks to spill store, which then serves them.
+   * Recency is approximated by clock algorithm, so reads only set flag of
+   * block and do not reorder shard under exclusive lock.
+   */
+  class ShardedDatastore
+      : public IpfsDatastore,
+        public std::enable_shared_from_this<ShardedDatastore> {
+   public:
+    /**
+     * @param spill - optional, receives blocks evicted over memory limit,
+     * must be thread-safe
+     */
+    explicit ShardedDatastore(ShardedDatastoreConfig config = {},
+                              IpldPtr spill = nullptr);
+
+    ~ShardedDatastore() override = default;
+
+    /** @copydoc IpfsDatastore::contains() */
+    outcome::result<bool> contains(const CID &key) const override;
+
+    /** @copydoc IpfsDatastore::set() */
+    outcome::result<void> set(const CID &key, Value value) override;
+
+    /** @copydoc IpfsDatastore::get() */
+    outcome::result<Value> get(const CID &key) const override;
+
+    /** @copydoc IpfsDatastore::view() */
+    outcome::result<void> view(const CID &key,
+                               const ViewCallback &callback) const override;
+
+    /** @copydoc IpfsDatastore::remove() */
+    outcome::result<void> remove(const CID &key) override;
+
+    IpldPtr shared() override {
+      return shared_from_this();
+    }
+
+    /// Bytes of values kept in memory
+    size_t bytes() const;
+
+   private:
+    struct Entry {
+      /// Shared with views, so callbacks run without shard lock
+      std::shared_ptr<const Value> value;
+      /// Distinguishes clock slot of entry from slots of removed ones
+      uint64_t generation{};
+      /// Read since last clock pass, so it is kept on eviction
+      mutable std::atomic<bool> referenced{false};
+    };
+
+    struct Shard {
+      mutable std::shared_mutex mutex;
+      std::unordered_map<CidKey, Entry> entries;
+      /**
+       * Keys with generation in clock order, one slot per entry, slots of
+       * removed or replaced entries are skipped
+       */
+      std::deque<std::pair<CidKey, uint64_t>> clock;
+      uint64_t generation{};
+      size_t bytes{};
+    };
+
+    Shard &shardOf(const CidKey &key) const;
+
+    /// Moves blocks to spill store until shard fits limit, under lock
+    outcome::result<void> evict(Shard &shard);
+
+    IpldPtr spill_;
+    /// Limit of bytes per shard, 0 for no limit
+    size_t shard_bytes_{};
+    std::unique_ptr<Shard[]> shards_;
+    size_t mask_{};
+  };
+
+}  // namespace fc::storage::ipfs
+
+#endif  // CPP_FILECOIN_CORE_STORAGE_IPFS_IMPL_SHARDED_DATASTORE_HPP
@@ -15,6 +15,7 @@ namespace fc::storage::ipfs {
    */
   enum class IpfsDatastoreError {
     kNotFound = 1,
+    kReadOnly,
   };
 
 }  // namespace fc::storage::ipfs
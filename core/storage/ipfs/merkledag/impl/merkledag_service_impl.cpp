@@ -8,13 +8,20 @@
 #include <boost/assert.hpp>
 
 #include "storage/ipld/impl/ipld_node_impl.hpp"
+#include "storage/ipld/traverser.hpp"
 
 namespace fc::storage::ipfs::merkledag {
   using ipld::IPLDNodeImpl;
+  using ipld::Selector;
+  using ipld::traverser::Traverser;
 
   MerkleDagServiceImpl::MerkleDagServiceImpl(
-      std::shared_ptr<IpfsDatastore> service)
-      : block_service_{std::move(service)} {
+      std::shared_ptr<IpfsDatastore> service,
+      std::shared_ptr<boost::asio::thread_pool> pool,
+      size_t prefetch)
+      : block_service_{std::move(service)},
+        pool_{std::move(pool)},
+        prefetch_{prefetch} {
     BOOST_ASSERT_MSG(block_service_ != nullptr,
                      "MerkleDAG service: Block service not connected");
   }
@@ -39,73 +46,81 @@ namespace fc::storage::ipfs::merkledag {
       gsl::span<const uint8_t> root_cid,
       gsl::span<const uint8_t> selector,
       std::function<bool(std::shared_ptr<const IPLDNode>)> handler) const {
-    std::ignore = selector;
     OUTCOME_TRY(cid, CID::fromBytes(root_cid));
-    OUTCOME_TRY(root_node, getNode(cid));
-    std::vector<std::shared_ptr<const IPLDNode>> node_set{};
-    node_set.emplace_back(std::move(root_node));
-    const auto &links = node_set.front()->getLinks();
-    for (const auto &link : links) {
-      auto request = getNode(link.get().getCID());
-      if (request.has_error()) return ServiceError::kUnresolvedLink;
-      node_set.emplace_back(std::move(request.value()));
+    Traverser traverser{
+        *block_service_, cid, Selector{common::Buffer{selector}}};
+    if (pool_) {
+      traverser.prefetch(pool_, prefetch_);
     }
     size_t sent_count{};
-    for (const auto &node : node_set) {
+    // nodes are passed as soon as they are loaded, only links to visit are
+    // kept by traverser
+    while (!traverser.isCompleted()) {
+      auto _block{traverser.advanceBlock()};
+      if (!_block) {
+        if (sent_count == 0) {
+          return _block.error();
+        }
+        return ServiceError::kUnresolvedLink;
+      }
+      OUTCOME_TRY(node,
+                  IPLDNodeImpl::createFromRawBytes(_block.value().second));
       ++sent_count;
-      if (!handler(node)) break;
+      if (!handler(std::move(node))) {
+        break;
+      }
     }
     return sent_count;
   }
 
   outcome::result<std::shared_ptr<Leaf>> MerkleDagServiceImpl::fetchGraph(
       const CID &cid) const {
-    OUTCOME_TRY(node, getNode(cid));
-    auto root_leaf = std::make_shared<LeafImpl>(node->content());
-    auto result = buildGraph(root_leaf, node->getLinks(), false, 0, 0);
-    if (result.has_error()) return result.error();
-    return root_leaf;
+    return buildGraph(cid, boost::none);
   }
 
   outcome::result<std::shared_ptr<Leaf>>
   MerkleDagServiceImpl::fetchGraphOnDepth(const CID &cid,
                                           uint64_t depth) const {
-    OUTCOME_TRY(node, getNode(cid));
-    auto leaf = std::make_shared<LeafImpl>(node->content());
-    auto result = buildGraph(leaf, node->getLinks(), true, depth, 0);
-    if (result.has_error()) return result.error();
-    return leaf;
+    return buildGraph(cid, depth);
   }
 
-  outcome::result<void> MerkleDagServiceImpl::buildGraph(
-      const std::shared_ptr<LeafImpl> &root,
-      const std::vector<std::reference_wrapper<const IPLDLink>> &links,
-      bool depth_limit,
-      const size_t max_depth,
-      size_t current_depth) const {
-    if (depth_limit && current_depth == max_depth) {
-      return outcome::success();
-    }
-    for (const auto &link : links) {
-      auto request = getNode(link.get().getCID());
-      if (request.has_error()) return ServiceError::kUnresolvedLink;
-      std::shared_ptr<IPLDNode> node = request.value();
-      auto child_leaf = std::make_shared<LeafImpl>(node->content());
-      auto build_result = buildGraph(child_leaf,
-                                     node->getLinks(),
-                                     depth_limit,
-                                     max_depth,
-                                     ++current_depth);
-      if (build_result.has_error()) {
-        return build_result;
+  outcome::result<std::shared_ptr<Leaf>> MerkleDagServiceImpl::buildGraph(
+      const CID &cid, boost::optional<uint64_t> max_depth) const {
+    /// Node being built with index of its next link
+    struct Frame {
+      std::shared_ptr<IPLDNode> node;
+      LeafImpl leaf;
+      size_t next{};
+    };
+    OUTCOME_TRY(root, getNode(cid));
+    std::vector<Frame> stack;
+    stack.push_back({root, LeafImpl{root->content()}});
+    while (true) {
+      auto &top{stack.back()};
+      const auto &links{top.node->getLinks()};
+      auto depth{stack.size() - 1};
+      auto limited{max_depth && depth == *max_depth};
+      if (!limited && top.next < links.size()) {
+        auto request{getNode(links[top.next].get().getCID())};
+        if (!request) {
+          return ServiceError::kUnresolvedLink;
+        }
+        auto node{std::move(request.value())};
+        LeafImpl leaf{node->content()};
+        stack.push_back({std::move(node), std::move(leaf)});
+        continue;
       }
-      auto insert_result =
-          root->insertSubLeaf(link.get().getName(), std::move(*child_leaf));
-      if (insert_result.has_error()) {
-        return insert_result;
+      // leaf is complete, it is moved into parent under its link name
+      if (stack.size() == 1) {
+        return std::make_shared<LeafImpl>(std::move(top.leaf));
       }
+      auto leaf{std::move(top.leaf)};
+      stack.pop_back();
+      auto &parent{stack.back()};
+      const auto &link{parent.node->getLinks()[parent.next].get()};
+      ++parent.next;
+      OUTCOME_TRY(parent.leaf.insertSubLeaf(link.getName(), std::move(leaf)));
     }
-    return outcome::success();
   }
 }  // namespace fc::storage::ipfs::merkledag
 
@@ -8,6 +8,8 @@
 
 #include <memory>
 
+#include <boost/asio/thread_pool.hpp>
+
 #include "storage/ipfs/datastore.hpp"
 #include "storage/ipfs/merkledag/impl/leaf_impl.hpp"
 #include "storage/ipfs/merkledag/merkledag_service.hpp"
@@ -21,8 +23,14 @@ namespace fc::storage::ipfs::merkledag {
     /**
      * @brief Construct service
      * @param service - underlying block service
+     * @param pool - optional, select fetches next blocks ahead on it, then
+     * service must support concurrent reads
+     * @param prefetch - max number of blocks fetched ahead
      */
-    explicit MerkleDagServiceImpl(std::shared_ptr<IpfsDatastore> service);
+    explicit MerkleDagServiceImpl(
+        std::shared_ptr<IpfsDatastore> service,
+        std::shared_ptr<boost::asio::thread_pool> pool = nullptr,
+        size_t prefetch = 0);
 
     outcome::result<void> addNode(
         std::shared_ptr<const IPLDNode> node) override;
@@ -46,23 +54,19 @@ namespace fc::storage::ipfs::merkledag {
 
    private:
     std::shared_ptr<IpfsDatastore> block_service_;
+    std::shared_ptr<boost::asio::thread_pool> pool_;
+    size_t prefetch_;
 
     /**
-     * @brief Fetch graph internal recursive implementation
-     * @param root - leaf, for which we should extract child nodes
-     * @param links - links to the child nodes of this leaf
-     * @param depth_limit - status of the depth control
+     * @brief Fetch graph depth-first with explicit stack, so deep graphs
+     * don't grow call stack
+     * @param cid - identifier of the root node
      * @param max_depth - e.g. "1" means "Fetch only root node with all
-     * children, but without children of their children"
-     * @param current_depth - value of the depth during current operation
+     * children, but without children of their children", none for no limit
      * @return operation result
      */
-    outcome::result<void> buildGraph(
-        const std::shared_ptr<LeafImpl> &root,
-        const std::vector<std::reference_wrapper<const IPLDLink>> &links,
-        bool depth_limit,
-        size_t max_depth,
-        size_t current_depth = 0) const;
+    outcome::result<std::shared_ptr<Leaf>> buildGraph(
+        const CID &cid, boost::optional<uint64_t> max_depth) const;
   };
 }  // namespace fc::storage::ipfs::merkledag
 
@@ -0,0 +1,156 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipld/pb_node_view.hpp"
+
+#include <google/protobuf/io/coded_stream.h>
+
+namespace fc::storage::ipld {
+  using google::protobuf::io::CodedInputStream;
+  using Input = gsl::span<const uint8_t>;
+
+  namespace {
+    constexpr uint32_t kVarint{0};
+    constexpr uint32_t kBytes{2};
+
+    /// Protobuf fields read in place, stream holds no heap state
+    struct PbReader {
+      explicit PbReader(Input input)
+          : input{input}, cs{input.data(), static_cast<int>(input.size())} {}
+
+      bool empty() const {
+        return static_cast<size_t>(cs.CurrentPosition()) >= input.size();
+      }
+
+      /// Reads tag of next field, false on error
+      bool tag(uint32_t &field, uint32_t &wire) {
+        auto tag{cs.ReadTag()};
+        field = tag >> 3;
+        wire = tag & 7;
+        return field != 0;
+      }
+
+      /// Reads length-delimited value, false on error
+      bool bytes(Input &value) {
+        int size;
+        if (!cs.ReadVarintSizeAsInt(&size)) {
+          return false;
+        }
+        auto offset{cs.CurrentPosition()};
+        if (!cs.Skip(size)) {
+          return false;
+        }
+        value = input.subspan(offset, size);
+        return true;
+      }
+
+      size_t position() const {
+        return cs.CurrentPosition();
+      }
+
+      Input input;
+      CodedInputStream cs;
+    };
+  }  // namespace
+
+  outcome::result<CID> PbLink::cid() const {
+    return CID::fromBytes(hash);
+  }
+
+  PbNodeView::Links::Links(Input bytes) : bytes_{bytes} {}
+
+  outcome::result<bool> PbNodeView::Links::next(PbLink &link) {
+    // framing was checked by create, data field is skipped
+    while (offset_ < bytes_.size()) {
+      PbReader s{bytes_.subspan(offset_)};
+      uint32_t field, wire;
+      Input value;
+      if (!s.tag(field, wire) || !s.bytes(value)) {
+        return PbNodeViewError::kInvalidEncoding;
+      }
+      offset_ += s.position();
+      if (field != 2) {
+        continue;
+      }
+      link = {};
+      PbReader l{value};
+      while (!l.empty()) {
+        if (!l.tag(field, wire)) {
+          return PbNodeViewError::kInvalidEncoding;
+        }
+        if (field == 3 && wire == kVarint) {
+          if (!l.cs.ReadVarint64(&link.size)) {
+            return PbNodeViewError::kInvalidEncoding;
+          }
+          continue;
+        }
+        if ((field != 1 && field != 2) || wire != kBytes
+            || !l.bytes(value)) {
+          return PbNodeViewError::kInvalidEncoding;
+        }
+        if (field == 1) {
+          link.hash = value;
+        } else {
+          link.name = {reinterpret_cast<const char *>(value.data()),
+                       static_cast<size_t>(value.size())};
+        }
+      }
+      return true;
+    }
+    return false;
+  }
+
+  PbNodeView::PbNodeView(const CID &cid, Input bytes)
+      : cid_{&cid}, bytes_{bytes} {}
+
+  outcome::result<PbNodeView> PbNodeView::create(const CID &cid,
+                                                 Input bytes) {
+    PbNodeView view{cid, bytes};
+    PbReader s{bytes};
+    while (!s.empty()) {
+      uint32_t field, wire;
+      Input value;
+      if (!s.tag(field, wire) || (field != 1 && field != 2) || wire != kBytes
+          || !s.bytes(value)) {
+        return PbNodeViewError::kInvalidEncoding;
+      }
+      if (field == 1) {
+        view.data_ = value;
+      } else {
+        ++view.links_count_;
+      }
+    }
+    return view;
+  }
+
+  const CID &PbNodeView::cid() const {
+    return *cid_;
+  }
+
+  Input PbNodeView::bytes() const {
+    return bytes_;
+  }
+
+  Input PbNodeView::data() const {
+    return data_;
+  }
+
+  size_t PbNodeView::linksCount() const {
+    return links_count_;
+  }
+
+  PbNodeView::Links PbNodeView::links() const {
+    return Links{bytes_};
+  }
+}  // namespace fc::storage::ipld
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::ipld, PbNodeViewError, e) {
+  using fc::storage::ipld::PbNodeViewError;
+  switch (e) {
+    case PbNodeViewError::kInvalidEncoding:
+      return "dag-pb node view: invalid encoding";
+  }
+  return "dag-pb node view: unknown error";
+}
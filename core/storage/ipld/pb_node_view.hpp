@@ -0,0 +1,87 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_STORAGE_IPLD_PB_NODE_VIEW_HPP
+#define CPP_FILECOIN_CORE_STORAGE_IPLD_PB_NODE_VIEW_HPP
+
+#include <string_view>
+
+#include <gsl/span>
+
+#include "common/outcome.hpp"
+#include "primitives/cid/cid.hpp"
+
+namespace fc::storage::ipld {
+  enum class PbNodeViewError { kInvalidEncoding = 1 };
+
+  /// Link of dag-pb node, spans point into block bytes
+  struct PbLink {
+    /// Cid bytes of target
+    gsl::span<const uint8_t> hash;
+    std::string_view name;
+    /// Cumulative size of target
+    uint64_t size{};
+
+    outcome::result<CID> cid() const;
+  };
+
+  /**
+   * Read-only view of dag-pb block over its raw bytes, bytes and cid must
+   * outlive view. Framing is checked once on create, links are decoded one
+   * by one as they are iterated, without copying names, content or cids.
+   * Cid is supplied by caller, so block is not encoded again to compute it.
+   */
+  class PbNodeView {
+   public:
+    /// Cursor over links in encoded order
+    class Links {
+     public:
+      /**
+       * Decodes next link
+       * @param link - receives next link
+       * @return false after last link
+       */
+      outcome::result<bool> next(PbLink &link);
+
+     private:
+      friend class PbNodeView;
+      explicit Links(gsl::span<const uint8_t> bytes);
+
+      gsl::span<const uint8_t> bytes_;
+      size_t offset_{};
+    };
+
+    /**
+     * Checks framing of block
+     * @param cid - cid of block
+     * @param bytes - block bytes
+     */
+    static outcome::result<PbNodeView> create(const CID &cid,
+                                              gsl::span<const uint8_t> bytes);
+
+    const CID &cid() const;
+
+    gsl::span<const uint8_t> bytes() const;
+
+    /// Opaque node data, empty if absent
+    gsl::span<const uint8_t> data() const;
+
+    size_t linksCount() const;
+
+    Links links() const;
+
+   private:
+    PbNodeView(const CID &cid, gsl::span<const uint8_t> bytes);
+
+    const CID *cid_;
+    gsl::span<const uint8_t> bytes_;
+    gsl::span<const uint8_t> data_;
+    size_t links_count_{};
+  };
+}  // namespace fc::storage::ipld
+
+OUTCOME_HPP_DECLARE_ERROR(fc::storage::ipld, PbNodeViewError);
+
+#endif  // CPP_FILECOIN_CORE_STORAGE_IPLD_PB_NODE_VIEW_HPP
@@ -35,6 +35,13 @@ namespace fc::storage::ipld {
                   "a16152a2616ca1646e6f6e65a0623a3ea16161a1613ea16140a0"))
               .value()}};
 
+  /**
+   * Selector matching only root node
+   * {".": {}}
+   */
+  static const Selector kMatcherSelector{
+      .raw = common::Buffer{common::unhex(std::string("a1612ea0")).value()}};
+
 }  // namespace fc::storage::ipld
 
 #endif  // CPP_FILECOIN_CORE_STORAGE_IPLD_SELECTOR_HPP
@@ -5,108 +5,459 @@
 
 #include "storage/ipld/traverser.hpp"
 
-#include <google/protobuf/io/coded_stream.h>
-#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <unordered_set>
+
+#include <boost/asio/post.hpp>
+
+#include "primitives/cid/cb_cid.hpp"
+#include "storage/ipld/pb_node_view.hpp"
 
 namespace fc::storage::ipld::traverser {
-  using google::protobuf::io::CodedInputStream;
+  using codec::cbor::CborDecodeStream;
   using Input = gsl::span<const uint8_t>;
 
-  struct PbDecoder {
-    PbDecoder(Input input) : input{input}, cs(input.data(), input.size()) {}
+  namespace {
+    /// Shared by all traversers, so it is looked up once
+    metrics::Gauge &traverserMemory() {
+      static auto &gauge{metrics::memoryGauge("traverser")};
+      return gauge;
+    }
+  }  // namespace
 
-    Input _str(uint64_t id) {
-      if (cs.ExpectTag((id << 3) | 2)) {
-        int size;
-        if (cs.ReadVarintSizeAsInt(&size)) {
-          auto offset = cs.CurrentPosition();
-          if (cs.Skip(size)) {
-            return input.subspan(offset, size);
-          }
+  struct SelectorNode {
+    enum class Kind {
+      kMatcher,
+      kAll,
+      kFields,
+      kIndex,
+      kRange,
+      kUnion,
+      kRecursive,
+      kEdge,
+    };
+    using Ptr = std::shared_ptr<SelectorNode>;
+
+    Kind kind{};
+    /// Unique in selector, identifies state in explored set
+    uint32_t id{};
+    /// Next selector, or sequence of recursive selector
+    Ptr next;
+    /// Field selectors, or union members with empty names
+    std::vector<std::pair<std::string, Ptr>> fields;
+    /// Index, or range start
+    uint64_t from{};
+    /// Range end
+    uint64_t to{};
+    /// Recursion depth limit
+    boost::optional<uint64_t> limit;
+  };
+
+  /// Block decoded into data model, links are not followed
+  struct DataNode {
+    enum class Kind { kOther, kLink, kList, kMap };
+
+    Kind kind{};
+    CID link;
+    /// List items or map values
+    std::vector<DataNode> items;
+    /// Map keys
+    std::vector<std::string> keys;
+  };
+
+  struct SelectorParser {
+    using Map = std::map<std::string, CborDecodeStream>;
+
+    /// Finds map entry or fails
+    static outcome::result<CborDecodeStream *> at(Map &map,
+                                                  const std::string &key) {
+      auto it = map.find(key);
+      if (it == map.end()) {
+        return TraverserError::kInvalidSelector;
+      }
+      return &it->second;
+    }
+
+    outcome::result<SelectorNode::Ptr> parse(CborDecodeStream &s) {
+      if (!s.isMap()) {
+        return TraverserError::kInvalidSelector;
+      }
+      auto outer = s.map();
+      if (outer.size() != 1) {
+        return TraverserError::kInvalidSelector;
+      }
+      auto &[type, body] = *outer.begin();
+      auto node = std::make_shared<SelectorNode>();
+      node->id = next_id++;
+      if (type == "|") {
+        node->kind = SelectorNode::Kind::kUnion;
+        auto n = body.listLength();
+        for (auto l = body.list(); n != 0; --n) {
+          OUTCOME_TRY(member, parse(l));
+          node->fields.emplace_back("", std::move(member));
+        }
+        return node;
+      }
+      if (!body.isMap()) {
+        return TraverserError::kInvalidSelector;
+      }
+      auto map = body.map();
+      if (type == ".") {
+        node->kind = SelectorNode::Kind::kMatcher;
+      } else if (type == "@") {
+        node->kind = SelectorNode::Kind::kEdge;
+      } else if (type == "a") {
+        node->kind = SelectorNode::Kind::kAll;
+        OUTCOME_TRY(next, at(map, ">"));
+        OUTCOME_TRYA(node->next, parse(*next));
+      } else if (type == "f") {
+        node->kind = SelectorNode::Kind::kFields;
+        OUTCOME_TRY(fields, at(map, "f>"));
+        for (auto &field : fields->map()) {
+          OUTCOME_TRY(next, parse(field.second));
+          node->fields.emplace_back(field.first, std::move(next));
         }
+      } else if (type == "i") {
+        node->kind = SelectorNode::Kind::kIndex;
+        OUTCOME_TRY(index, at(map, "i"));
+        *index >> node->from;
+        OUTCOME_TRY(next, at(map, ">"));
+        OUTCOME_TRYA(node->next, parse(*next));
+      } else if (type == "r") {
+        node->kind = SelectorNode::Kind::kRange;
+        OUTCOME_TRY(from, at(map, "^"));
+        *from >> node->from;
+        OUTCOME_TRY(to, at(map, "$"));
+        *to >> node->to;
+        OUTCOME_TRY(next, at(map, ">"));
+        OUTCOME_TRYA(node->next, parse(*next));
+      } else if (type == "R") {
+        node->kind = SelectorNode::Kind::kRecursive;
+        // stop condition is not supported
+        if (map.find("!") != map.end()) {
+          return TraverserError::kInvalidSelector;
+        }
+        OUTCOME_TRY(limit, at(map, "l"));
+        auto limit_map = limit->map();
+        auto depth = limit_map.find("depth");
+        if (depth != limit_map.end()) {
+          uint64_t value;
+          depth->second >> value;
+          node->limit = value;
+        } else if (limit_map.find("none") == limit_map.end()) {
+          return TraverserError::kInvalidSelector;
+        }
+        OUTCOME_TRY(sequence, at(map, ":>"));
+        OUTCOME_TRYA(node->next, parse(*sequence));
+      } else {
+        return TraverserError::kInvalidSelector;
       }
-      return {};
+      return node;
     }
 
-    bool empty() {
-      return cs.CurrentPosition() >= input.size();
+    static outcome::result<SelectorNode::Ptr> parse(const Selector &selector) {
+      try {
+        SelectorParser parser;
+        CborDecodeStream s{selector.raw.empty() ? kAllSelector.raw
+                                                 : selector.raw};
+        return parser.parse(s);
+      } catch (std::system_error &e) {
+        return outcome::failure(e.code());
+      }
     }
 
-    Input input;
-    CodedInputStream cs;
+    uint32_t next_id{};
   };
 
-  struct PbNodeDecoder {
-    static outcome::result<std::vector<CID>> links(
-        gsl::span<const uint8_t> input) {
-      std::vector<CID> cids;
-      PbDecoder s{input};
+  DataNode decodeCbor(CborDecodeStream &s) {
+    DataNode node;
+    if (s.isCid()) {
+      node.kind = DataNode::Kind::kLink;
+      s >> node.link;
+    } else if (s.isList()) {
+      node.kind = DataNode::Kind::kList;
+      auto n = s.listLength();
+      node.items.reserve(n);
+      for (auto l = s.list(); n != 0; --n) {
+        node.items.push_back(decodeCbor(l));
+      }
+    } else if (s.isMap()) {
+      node.kind = DataNode::Kind::kMap;
+      for (auto &p : s.map()) {
+        node.keys.push_back(p.first);
+        node.items.push_back(decodeCbor(p.second));
+      }
+    } else {
+      s.next();
+    }
+    return node;
+  }
+
+  /// Decodes block, dag-pb is represented as {"Data", "Links": [{"Hash"}]}
+  outcome::result<DataNode> decodeNode(const CID &cid, Input bytes) {
+    DataNode node;
+    if (cid.content_type == libp2p::multi::MulticodecType::DAG_CBOR) {
+      try {
+        CborDecodeStream s{bytes};
+        node = decodeCbor(s);
+      } catch (std::system_error &e) {
+        return outcome::failure(e.code());
+      }
+    } else if (cid.content_type == libp2p::multi::MulticodecType::DAG_PB) {
+      OUTCOME_TRY(view, PbNodeView::create(cid, bytes));
+      DataNode links;
+      links.kind = DataNode::Kind::kList;
+      links.items.reserve(view.linksCount());
+      auto cursor{view.links()};
+      PbLink pb_link;
       while (true) {
-        PbDecoder link{s._str(2)};
-        if (link.empty()) {
+        OUTCOME_TRY(more, cursor.next(pb_link));
+        if (!more) {
           break;
         }
-        auto cid_bytes = link._str(1);
-        OUTCOME_TRY(cid, CID::fromBytes(cid_bytes));
-        cids.push_back(std::move(cid));
+        DataNode hash;
+        hash.kind = DataNode::Kind::kLink;
+        OUTCOME_TRYA(hash.link, pb_link.cid());
+        DataNode link;
+        link.kind = DataNode::Kind::kMap;
+        link.keys.emplace_back("Hash");
+        link.items.push_back(std::move(hash));
+        links.items.push_back(std::move(link));
       }
-      return std::move(cids);
+      node.kind = DataNode::Kind::kMap;
+      node.keys = {"Data", "Links"};
+      node.items.resize(1);
+      node.items.push_back(std::move(links));
     }
-  };
+    return node;
+  }
+
+  /// Appends links of node and its children
+  void collectLinks(const DataNode &node, std::vector<CID> &links) {
+    if (node.kind == DataNode::Kind::kLink) {
+      links.push_back(node.link);
+    }
+    for (auto &item : node.items) {
+      collectLinks(item, links);
+    }
+  }
+
+  outcome::result<std::vector<CID>> blockLinks(const CID &cid, Input bytes) {
+    OUTCOME_TRY(node, decodeNode(cid, bytes));
+    std::vector<CID> links;
+    collectLinks(node, links);
+    return std::move(links);
+  }
+
+  Traverser::Traverser(Ipld &store, const CID &root, const Selector &selector)
+      : store{store}, memory_{traverserMemory()} {
+    auto parsed = SelectorParser::parse(selector);
+    if (!parsed) {
+      selector_error_ = parsed.error();
+      return;
+    }
+    selector_ = std::move(parsed.value());
+    if (auto state = resolve({selector_.get(), nullptr, boost::none})) {
+      to_visit_.emplace_back(root, *state);
+    }
+  }
 
   outcome::result<std::vector<CID>> Traverser::traverseAll() {
-    // TODO(turuslan): implement selectors
+    std::vector<CID> visit_order;
+    std::unordered_set<CidKey> visited;
     while (!isCompleted()) {
-      OUTCOME_TRY(advance());
+      OUTCOME_TRY(cid, advance());
+      if (visited.insert(cidKey(cid)).second) {
+        visit_order.push_back(std::move(cid));
+      }
+    }
+    return std::move(visit_order);
+  }
+
+  Traverser::~Traverser() {
+    for (auto &it : prefetched_) {
+      it.second.wait();
     }
-    return std::vector<CID>(visit_order_.begin(), visit_order_.end());
+  }
+
+  void Traverser::prefetch(std::shared_ptr<boost::asio::thread_pool> pool,
+                           size_t count) {
+    pool_ = std::move(pool);
+    prefetch_ = pool_ ? count : 0;
+    schedulePrefetch();
   }
 
   outcome::result<CID> Traverser::advance() {
+    return advance(nullptr);
+  }
+
+  outcome::result<std::pair<CID, Buffer>> Traverser::advanceBlock() {
+    Buffer data;
+    OUTCOME_TRY(cid, advance(&data));
+    return std::make_pair(std::move(cid), std::move(data));
+  }
+
+  outcome::result<CID> Traverser::advance(Buffer *data) {
+    if (selector_error_) {
+      return selector_error_;
+    }
     if (isCompleted()) {
       return TraverserError::kTraverseCompleted;
     }
-    CID cid = to_visit_.front();
-    to_visit_.pop();
-    if (visited_.insert(cid).second) {
-      visit_order_.push_back(cid);
-      OUTCOME_TRY(bytes, store.get(cid));
-      // TODO(turuslan): what about other types?
-      if (cid.content_type == libp2p::multi::MulticodecType::DAG_CBOR) {
-        CborDecodeStream s{bytes};
-        OUTCOME_TRY(parseCbor(s));
-      } else if (cid.content_type == libp2p::multi::MulticodecType::DAG_PB) {
-        OUTCOME_TRY(cids, PbNodeDecoder::links(bytes));
-        for (auto &&c : cids) {
-          to_visit_.push(c);
-        }
+    auto link = std::move(to_visit_.back());
+    to_visit_.pop_back();
+    OUTCOME_TRY(key, exploredKey(link));
+    if (explored_.insert(key).second) {
+      Fetched fetched;
+      auto it = prefetched_.find(key);
+      if (it != prefetched_.end()) {
+        auto future = std::move(it->second);
+        prefetched_.erase(it);
+        OUTCOME_TRYA(fetched, future.get());
+      } else {
+        OUTCOME_TRYA(fetched, fetch(store, link));
       }
+      // reversed, so first link is visited next
+      to_visit_.insert(to_visit_.end(),
+                       std::make_move_iterator(fetched.links.rbegin()),
+                       std::make_move_iterator(fetched.links.rend()));
+      if (data) {
+        *data = std::move(fetched.bytes);
+      }
+    } else if (data) {
+      OUTCOME_TRYA(*data, store.get(link.first));
     }
-    return cid;
+    schedulePrefetch();
+    memory_.set(metrics::containerBytes(explored_, sizeof(Key))
+                + to_visit_.size() * sizeof(Link));
+    return std::move(link.first);
   }
 
-  bool Traverser::isCompleted() const {
-    return to_visit_.empty();
+  void Traverser::schedulePrefetch() {
+    auto count = std::min(prefetch_, to_visit_.size());
+    for (size_t i = 0; i < count && prefetched_.size() < prefetch_; ++i) {
+      auto &link = to_visit_[to_visit_.size() - 1 - i];
+      auto key = exploredKey(link);
+      if (!key || explored_.count(key.value()) != 0
+          || prefetched_.count(key.value()) != 0) {
+        continue;
+      }
+      auto task =
+          std::make_shared<std::packaged_task<outcome::result<Fetched>()>>(
+              [&ipld = store, link] { return fetch(ipld, link); });
+      prefetched_.emplace(key.value(), task->get_future());
+      boost::asio::post(*pool_, [task] { (*task)(); });
+    }
   }
 
-  outcome::result<void> Traverser::parseCbor(CborDecodeStream &s) {
-    if (s.isCid()) {
-      CID cid;
-      s >> cid;
-      to_visit_.push(cid);
-    } else if (s.isList()) {
-      auto n = s.listLength();
-      for (auto l = s.list(); n != 0; --n) {
-        OUTCOME_TRY(parseCbor(l));
+  outcome::result<Traverser::Key> Traverser::exploredKey(const Link &link) {
+    auto &[cid, state] = link;
+    OUTCOME_TRY(bytes, cid.toBytes());
+    auto append = [&](uint64_t value, size_t size) {
+      for (size_t i = 0; i < size; ++i) {
+        bytes.push_back(value >> (8 * i));
       }
-    } else if (s.isMap()) {
-      for (auto &p : s.map()) {
-        OUTCOME_TRY(parseCbor(p.second));
+    };
+    append(state.selector->id, sizeof(state.selector->id));
+    append(state.depth ? *state.depth + 1 : 0, sizeof(uint64_t));
+    return crypto::blake2b::blake2b_160(bytes);
+  }
+
+  outcome::result<Traverser::Fetched> Traverser::fetch(Ipld &store,
+                                                       const Link &link) {
+    OUTCOME_TRY(bytes, store.get(link.first));
+    OUTCOME_TRY(node, decodeNode(link.first, bytes));
+    Fetched fetched{std::move(bytes), {}};
+    walk(node, link.second, fetched.links);
+    return std::move(fetched);
+  }
+
+  bool Traverser::isCompleted() const {
+    return !selector_error_ && to_visit_.empty();
+  }
+
+  boost::optional<Traverser::State> Traverser::resolve(State state) {
+    while (true) {
+      switch (state.selector->kind) {
+        case SelectorNode::Kind::kRecursive:
+          state.recursive = state.selector;
+          state.depth = state.selector->limit;
+          state.selector = state.selector->next.get();
+          break;
+        case SelectorNode::Kind::kEdge:
+          if (!state.recursive) {
+            return boost::none;
+          }
+          if (state.depth) {
+            if (*state.depth < 2) {
+              return boost::none;
+            }
+            --*state.depth;
+          }
+          state.selector = state.recursive->next.get();
+          break;
+        default:
+          return state;
       }
+    }
+  }
+
+  void Traverser::explore(const DataNode &node,
+                          const State &state,
+                          const SelectorNode *selector,
+                          std::vector<Link> &links) {
+    auto next = resolve({selector, state.recursive, state.depth});
+    if (!next) {
+      return;
+    }
+    if (node.kind == DataNode::Kind::kLink) {
+      links.emplace_back(node.link, *next);
     } else {
-      s.next();
+      walk(node, *next, links);
+    }
+  }
+
+  void Traverser::walk(const DataNode &node,
+                       const State &state,
+                       std::vector<Link> &links) {
+    auto &selector = *state.selector;
+    switch (selector.kind) {
+      case SelectorNode::Kind::kUnion:
+        for (auto &member : selector.fields) {
+          explore(node, state, member.second.get(), links);
+        }
+        break;
+      case SelectorNode::Kind::kAll:
+        for (auto &item : node.items) {
+          explore(item, state, selector.next.get(), links);
+        }
+        break;
+      case SelectorNode::Kind::kFields:
+        for (auto &field : selector.fields) {
+          for (size_t i = 0; i < node.keys.size(); ++i) {
+            if (node.keys[i] == field.first) {
+              explore(node.items[i], state, field.second.get(), links);
+            }
+          }
+        }
+        break;
+      case SelectorNode::Kind::kIndex:
+        if (node.kind == DataNode::Kind::kList
+            && selector.from < node.items.size()) {
+          explore(
+              node.items[selector.from], state, selector.next.get(), links);
+        }
+        break;
+      case SelectorNode::Kind::kRange:
+        if (node.kind == DataNode::Kind::kList) {
+          auto to = std::min<uint64_t>(selector.to, node.items.size());
+          for (auto i = selector.from; i < to; ++i) {
+            explore(node.items[i], state, selector.next.get(), links);
+          }
+        }
+        break;
+      default:
+        break;
     }
-    return outcome::success();
   }
 
 }  // namespace fc::storage::ipld::traverser
@@ -117,6 +468,8 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::ipld::traverser, TraverserError, e) {
   switch (e) {
     case TraverserError::kTraverseCompleted:
       return "Traverser: blocks already completed";
+    case TraverserError::kInvalidSelector:
+      return "Traverser: invalid or unsupported selector";
     default:
       return "Traverser: unknown error";
   }
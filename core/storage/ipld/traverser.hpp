@@ -6,22 +6,51 @@
 #ifndef CPP_FILECOIN_CORE_STORAGE_IPLD_TRAVERSER_HPP
 #define CPP_FILECOIN_CORE_STORAGE_IPLD_TRAVERSER_HPP
 
-#include <queue>
+#include <future>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <boost/asio/thread_pool.hpp>
+
+#include "crypto/blake2/blake2b160.hpp"
+#include "metrics/memory.hpp"
 #include "storage/ipfs/datastore.hpp"
 #include "storage/ipld/selector.hpp"
 
 namespace fc::storage::ipld::traverser {
-  using codec::cbor::CborDecodeStream;
-
   /**
    * @brief Type of errors returned by IPLD traverser
    */
   enum class TraverserError {
     kTraverseCompleted = 1,
+    kInvalidSelector,
   };
 
+  /// Parsed selector node, defined in traverser.cpp
+  struct SelectorNode;
+
+  /// Block data model node, defined in traverser.cpp
+  struct DataNode;
+
   /**
-   * IPLD traverser, stores current traverse state
+   * Decodes links of dag-cbor or dag-pb block in selector walk order
+   * @param cid - block cid, selects codec
+   * @param bytes - block bytes
+   * @return all links including duplicates
+   */
+  outcome::result<std::vector<CID>> blockLinks(const CID &cid,
+                                               gsl::span<const uint8_t> bytes);
+
+  /**
+   * IPLD traverser, stores current traverse state.
+   * Walks blocks depth-first as selected by selector, visiting each block as
+   * soon as it is reached. Only unvisited sibling links are kept in memory,
+   * explored blocks are remembered by 20 byte digests of cid and selector
+   * state.
+   * Supported selectors: matcher, explore all, fields, index, range, union,
+   * recursive with depth limit and recursive edge. Empty selector selects all.
+   * Optionally next blocks on stack are fetched and decoded ahead on worker
+   * pool.
    */
   class Traverser {
    public:
@@ -29,16 +58,28 @@ namespace fc::storage::ipld::traverser {
      * Constructor with selector
      * @param store - ipld store
      * @param root - root cid
-     * @param selector - selector
+     * @param selector - selector, returned by advance if invalid
+     */
+    Traverser(Ipld &store, const CID &root, const Selector &selector);
+
+    Traverser(const Traverser &) = delete;
+    Traverser &operator=(const Traverser &) = delete;
+
+    /// Waits for pending prefetches
+    ~Traverser();
+
+    /**
+     * Enables fetching up to count next blocks ahead on pool.
+     * Store must support concurrent reads and outlive traverser.
+     * @param pool - worker pool
+     * @param count - max number of blocks fetched ahead
      */
-    Traverser(Ipld &store, const CID &root, const Selector &selector)
-        : store{store} {
-      to_visit_.push(root);
-    }
+    void prefetch(std::shared_ptr<boost::asio::thread_pool> pool,
+                  size_t count);
 
     /**
      * Traverse all from the root
-     * @return all the visited cids
+     * @return all the visited cids without duplicates
      */
     outcome::result<std::vector<CID>> traverseAll();
 
@@ -49,6 +90,12 @@ namespace fc::storage::ipld::traverser {
      */
     outcome::result<CID> advance();
 
+    /**
+     * Visit only next element and get its bytes
+     * @return cid and bytes of traversed block
+     */
+    outcome::result<std::pair<CID, common::Buffer>> advanceBlock();
+
     /**
      * Checks if traversal completed
      * @return true if all cids are visited
@@ -56,12 +103,44 @@ namespace fc::storage::ipld::traverser {
     bool isCompleted() const;
 
    private:
-    outcome::result<void> parseCbor(CborDecodeStream &s);
+    /// Selector position with enclosing recursive selector
+    struct State {
+      const SelectorNode *selector;
+      const SelectorNode *recursive;
+      boost::optional<uint64_t> depth;
+    };
+    using Link = std::pair<CID, State>;
+    using Key = crypto::blake2b::Blake2b160Hash;
+    /// Block bytes with links selected from it
+    struct Fetched {
+      common::Buffer bytes;
+      std::vector<Link> links;
+    };
+
+    outcome::result<CID> advance(common::Buffer *data);
+    void schedulePrefetch();
+
+    static outcome::result<Key> exploredKey(const Link &link);
+    static outcome::result<Fetched> fetch(Ipld &store, const Link &link);
+    static boost::optional<State> resolve(State state);
+    static void walk(const DataNode &node,
+                     const State &state,
+                     std::vector<Link> &links);
+    static void explore(const DataNode &node,
+                        const State &state,
+                        const SelectorNode *selector,
+                        std::vector<Link> &links);
 
     Ipld &store;
-    std::queue<CID> to_visit_;      // set of cids to visit
-    std::vector<CID> visit_order_;  // visited cids in visit order
-    std::set<CID> visited_;         // set of visited cids
+    std::shared_ptr<SelectorNode> selector_;
+    std::error_code selector_error_;
+    std::vector<Link> to_visit_;  // stack of links to visit
+    std::unordered_set<Key> explored_;
+    std::shared_ptr<boost::asio::thread_pool> pool_;
+    size_t prefetch_{};
+    std::unordered_map<Key, std::future<outcome::result<Fetched>>> prefetched_;
+    /// Explored keys and links to visit, reported as traverser memory
+    metrics::MemoryShare memory_;
   };
 
 }  // namespace fc::storage::ipld::traverser
@@ -67,6 +67,7 @@ fc::outcome::result<void> FileSystemKeyStore::remove(
   OUTCOME_TRY(found, has(address));
   if (!found) return KeyStoreError::kNotFound;
   OUTCOME_TRY(path, addressToPath(address));
+  cache_.remove(address);
   OUTCOME_TRY(filestore_->remove(path));
   return fc::outcome::success();
 }
@@ -117,6 +118,19 @@ fc::outcome::result<typename KeyStore::TPrivateKey> FileSystemKeyStore::get(
   return KeyStoreError::kWrongAddress;
 }
 
+fc::outcome::result<typename KeyStore::TPrivateKey>
+FileSystemKeyStore::getChecked(const Address &address) const noexcept {
+  if (auto cached = cache_.get(address)) {
+    KeyStore::TPrivateKey key{*cached};
+    secureZero(*cached);
+    return key;
+  }
+  OUTCOME_TRY(private_key, KeyStore::getChecked(address));
+  auto &key = boost::get<BlsPrivateKey>(private_key);
+  cache_.put(address, key);
+  return std::move(private_key);
+}
+
 fc::outcome::result<Path> FileSystemKeyStore::addressToPath(
     const Address &address) const noexcept {
   std::stringstream ss;
@@ -8,6 +8,7 @@
 
 #include "storage/filestore/filestore.hpp"
 #include "storage/filestore/path.hpp"
+#include "storage/keystore/key_cache.hpp"
 #include "storage/keystore/keystore.hpp"
 
 namespace fc::storage::keystore {
@@ -16,7 +17,8 @@ namespace fc::storage::keystore {
   using filestore::Path;
 
   /**
-   * @brief FileSystem KeyStore implementation
+   * @brief FileSystem KeyStore implementation, keys checked for signing are
+   * cached in memory, so key files are read once
    */
   class FileSystemKeyStore : public KeyStore {
     /** @brief Extention of private key file */
@@ -47,6 +49,10 @@ namespace fc::storage::keystore {
     outcome::result<typename KeyStore::TPrivateKey> get(
         const Address &address) const noexcept override;
 
+    /** @copydoc KeyStore::getChecked() */
+    outcome::result<typename KeyStore::TPrivateKey> getChecked(
+        const Address &address) const noexcept override;
+
    private:
     /**
      * @brief Get path to private key file from address
@@ -59,6 +65,8 @@ namespace fc::storage::keystore {
     Path keystore_path_;
 
     std::shared_ptr<FileStore> filestore_;
+
+    mutable KeyCache cache_;
   };
 
 }  // namespace fc::storage::keystore
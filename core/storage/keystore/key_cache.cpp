@@ -0,0 +1,111 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/keystore/key_cache.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace fc::storage::keystore {
+  void secureZero(gsl::span<uint8_t> bytes) {
+    volatile uint8_t *p{bytes.data()};
+    for (decltype(bytes.size()) i{0}; i < bytes.size(); ++i) {
+      p[i] = 0;
+    }
+  }
+
+  KeyCache::KeyCache(size_t capacity) {
+    auto page{static_cast<size_t>(sysconf(_SC_PAGESIZE))};
+    auto size{(capacity * sizeof(PrivateKey) + page - 1) / page * page};
+    if (size == 0) {
+      return;
+    }
+    auto region{mmap(nullptr,
+                     size,
+                     PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS,
+                     -1,
+                     0)};
+    if (region == MAP_FAILED) {
+      return;
+    }
+    // without lock permission keys are still cached, but may be swapped
+    mlock(region, size);
+#ifdef MADV_DONTDUMP
+    madvise(region, size, MADV_DONTDUMP);
+#endif
+    region_ = static_cast<uint8_t *>(region);
+    region_size_ = size;
+    capacity_ = size / sizeof(PrivateKey);
+    free_.reserve(capacity_);
+    for (auto i{capacity_}; i != 0; --i) {
+      free_.push_back(i - 1);
+    }
+  }
+
+  KeyCache::~KeyCache() {
+    if (region_) {
+      secureZero({region_, static_cast<ptrdiff_t>(region_size_)});
+      munlock(region_, region_size_);
+      munmap(region_, region_size_);
+    }
+  }
+
+  boost::optional<KeyCache::PrivateKey> KeyCache::get(
+      const Address &address) const {
+    std::lock_guard lock{mutex_};
+    auto it{slots_.find(address)};
+    if (it == slots_.end()) {
+      return boost::none;
+    }
+    PrivateKey key;
+    auto bytes{slot(it->second)};
+    std::copy(bytes.begin(), bytes.end(), key.begin());
+    return key;
+  }
+
+  bool KeyCache::put(const Address &address, const PrivateKey &key) {
+    std::lock_guard lock{mutex_};
+    auto it{slots_.find(address)};
+    if (it == slots_.end()) {
+      if (free_.empty()) {
+        return false;
+      }
+      it = slots_.emplace(address, free_.back()).first;
+      free_.pop_back();
+    }
+    std::copy(key.begin(), key.end(), slot(it->second).begin());
+    return true;
+  }
+
+  void KeyCache::remove(const Address &address) {
+    std::lock_guard lock{mutex_};
+    auto it{slots_.find(address)};
+    if (it != slots_.end()) {
+      secureZero(slot(it->second));
+      free_.push_back(it->second);
+      slots_.erase(it);
+    }
+  }
+
+  void KeyCache::clear() {
+    std::lock_guard lock{mutex_};
+    for (auto &[_, index] : slots_) {
+      secureZero(slot(index));
+      free_.push_back(index);
+    }
+    slots_.clear();
+  }
+
+  size_t KeyCache::size() const {
+    std::lock_guard lock{mutex_};
+    return slots_.size();
+  }
+
+  gsl::span<uint8_t> KeyCache::slot(size_t index) const {
+    return {region_ + index * sizeof(PrivateKey),
+            static_cast<ptrdiff_t>(sizeof(PrivateKey))};
+  }
+}  // namespace fc::storage::keystore
@@ -0,0 +1,65 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef FILECOIN_CORE_STORAGE_KEYSTORE_KEY_CACHE_HPP
+#define FILECOIN_CORE_STORAGE_KEYSTORE_KEY_CACHE_HPP
+
+#include <map>
+#include <mutex>
+
+#include <boost/optional.hpp>
+#include <gsl/span>
+
+#include "crypto/bls/bls_types.hpp"
+#include "primitives/address/address.hpp"
+
+namespace fc::storage::keystore {
+  using primitives::address::Address;
+
+  /// Overwrites memory with zeros, write is not optimized away
+  void secureZero(gsl::span<uint8_t> bytes);
+
+  /**
+   * Decrypted private keys kept in memory, so signing doesn't read key files.
+   * Keys are stored in one region locked in memory, so they are not swapped,
+   * and excluded from core dumps. Slots are zeroized on removal and on
+   * destruction. Keys not fitting capacity are not cached.
+   */
+  class KeyCache {
+   public:
+    /// Bls and secp256k1 private keys are same 32 byte array
+    using PrivateKey = crypto::bls::PrivateKey;
+
+    static constexpr size_t kDefaultCapacity{128};
+
+    explicit KeyCache(size_t capacity = kDefaultCapacity);
+    KeyCache(const KeyCache &) = delete;
+    KeyCache &operator=(const KeyCache &) = delete;
+    ~KeyCache();
+
+    boost::optional<PrivateKey> get(const Address &address) const;
+
+    /// Caches key, returns false when cache is full
+    bool put(const Address &address, const PrivateKey &key);
+
+    void remove(const Address &address);
+
+    void clear();
+
+    size_t size() const;
+
+   private:
+    gsl::span<uint8_t> slot(size_t index) const;
+
+    mutable std::mutex mutex_;
+    uint8_t *region_{nullptr};
+    size_t region_size_{};
+    size_t capacity_{};
+    std::map<Address, size_t> slots_;
+    std::vector<size_t> free_;
+  };
+}  // namespace fc::storage::keystore
+
+#endif  // FILECOIN_CORE_STORAGE_KEYSTORE_KEY_CACHE_HPP
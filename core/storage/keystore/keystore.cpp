@@ -6,6 +6,7 @@
 #include "keystore.hpp"
 
 #include "common/visitor.hpp"
+#include "storage/keystore/key_cache.hpp"
 
 namespace fc::storage::keystore {
 
@@ -42,26 +43,32 @@ namespace fc::storage::keystore {
     return KeyStoreError::kWrongAddress;
   }
 
-  fc::outcome::result<Signature> KeyStore::sign(
-      const Address &address, gsl::span<const uint8_t> data) noexcept {
+  fc::outcome::result<KeyStore::TPrivateKey> KeyStore::getChecked(
+      const Address &address) const noexcept {
     OUTCOME_TRY(private_key, get(address));
     OUTCOME_TRY(valid, checkAddress(address, private_key));
     if (!valid) return KeyStoreError::kWrongAddress;
+    return std::move(private_key);
+  }
 
-    if (address.getProtocol() == Protocol::BLS) {
-      OUTCOME_TRY(
-          signature,
-          bls_provider_->sign(data, boost::get<BlsPrivateKey>(private_key)));
-      return signature;
-    }
-    if (address.getProtocol() == Protocol::SECP256K1) {
-      OUTCOME_TRY(signature,
-                  secp256k1_provider_->sign(
-                      data, boost::get<Secp256k1PrivateKey>(private_key)));
-      return std::move(signature);
-    }
-
-    return KeyStoreError::kWrongAddress;
+  fc::outcome::result<Signature> KeyStore::sign(
+      const Address &address, gsl::span<const uint8_t> data) noexcept {
+    OUTCOME_TRY(private_key, getChecked(address));
+    // copy of key doesn't outlive signing
+    auto &key{boost::get<BlsPrivateKey>(private_key)};
+    auto signature{[&]() -> outcome::result<Signature> {
+      if (address.getProtocol() == Protocol::BLS) {
+        OUTCOME_TRY(signature, bls_provider_->sign(data, key));
+        return signature;
+      }
+      if (address.getProtocol() == Protocol::SECP256K1) {
+        OUTCOME_TRY(signature, secp256k1_provider_->sign(data, key));
+        return std::move(signature);
+      }
+      return KeyStoreError::kWrongAddress;
+    }()};
+    secureZero(key);
+    return signature;
   }
 
   fc::outcome::result<bool> KeyStore::verify(const Address &address,
@@ -109,6 +109,14 @@ namespace fc::storage::keystore {
     virtual outcome::result<TPrivateKey> get(const Address &address) const
         noexcept = 0;
 
+    /**
+     * @brief Get private key checked to match address, used for signing
+     * @param address
+     * @return private key
+     */
+    virtual outcome::result<TPrivateKey> getChecked(
+        const Address &address) const noexcept;
+
    private:
     std::shared_ptr<BlsProvider> bls_provider_;
     std::shared_ptr<Secp256k1ProviderDefault> secp256k1_provider_;
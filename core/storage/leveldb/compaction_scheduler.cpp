@@ -0,0 +1,224 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/leveldb/compaction_scheduler.hpp"
+
+#include <cassert>
+
+#include "metrics/metrics.hpp"
+
+namespace fc::storage {
+  using std::chrono::milliseconds;
+
+  /// Levels of leveldb, config::kNumLevels is not public
+  constexpr size_t kLevels{7};
+  /// Size limit of level 1, each next level is 10 times larger
+  constexpr double kLevel1Bytes{10 * 1048576.0};
+
+  struct CompactionScheduler::Store {
+    Store(std::string name, std::shared_ptr<LevelDB> db)
+        : name{std::move(name)},
+          db{std::move(db)},
+          write_stalls{metrics::Registry::global().counter(
+              "fc_leveldb_write_stalls_total",
+              "Writes slower than stall threshold",
+              {{"store", this->name}})},
+          compactions{metrics::Registry::global().counter(
+              "fc_leveldb_idle_compactions_total",
+              "Range compactions in idle part of epoch",
+              {{"store", this->name}})},
+          compaction_time{metrics::Registry::global().histogram(
+              "fc_leveldb_idle_compaction_seconds",
+              "Time of range compactions in idle part of epoch",
+              {{"store", this->name}},
+              1e-9)} {
+      auto &registry{metrics::Registry::global()};
+      for (size_t level{0}; level < kLevels; ++level) {
+        metrics::Labels labels{{"store", this->name},
+                               {"level", std::to_string(level)}};
+        level_files.push_back(&registry.gauge(
+            "fc_leveldb_level_files", "Table files of level", labels));
+        level_bytes.push_back(&registry.gauge(
+            "fc_leveldb_level_bytes", "Approximate bytes of level", labels));
+      }
+    }
+
+    std::string name;
+    std::shared_ptr<LevelDB> db;
+    /// First key of next range, none for start of database
+    boost::optional<Buffer> cursor;
+    uint64_t last_write_stalls{};
+    std::vector<metrics::Gauge *> level_files;
+    std::vector<metrics::Gauge *> level_bytes;
+    metrics::Counter &write_stalls;
+    metrics::Counter &compactions;
+    metrics::Histogram &compaction_time;
+  };
+
+  CompactionScheduler::CompactionScheduler(
+      std::shared_ptr<ChainEpochClock> epoch_clock,
+      Stores stores,
+      CompactionConfig config)
+      : epoch_clock_{std::move(epoch_clock)},
+        config_{config},
+        logger_{common::createLogger("compaction")} {
+    for (auto &[name, db] : stores) {
+      stores_.push_back(std::make_unique<Store>(name, db));
+    }
+  }
+
+  CompactionScheduler::~CompactionScheduler() {
+    stop();
+  }
+
+  void CompactionScheduler::start() {
+    thread_ = std::thread{[this] { run(); }};
+  }
+
+  void CompactionScheduler::stop() {
+    {
+      std::lock_guard lock{mutex_};
+      stopped_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  void CompactionScheduler::onHeadValidated(ChainEpoch epoch) {
+    {
+      std::lock_guard lock{mutex_};
+      if (validated_ && *validated_ >= epoch) {
+        return;
+      }
+      validated_ = epoch;
+    }
+    cv_.notify_all();
+  }
+
+  void CompactionScheduler::enterCritical() {
+    std::lock_guard lock{mutex_};
+    ++critical_;
+  }
+
+  void CompactionScheduler::leaveCritical() {
+    {
+      std::lock_guard lock{mutex_};
+      assert(critical_ != 0);
+      --critical_;
+    }
+    cv_.notify_all();
+  }
+
+  bool CompactionScheduler::isIdle(const CompactionConfig &config,
+                                   milliseconds since_epoch,
+                                   bool head_validated) {
+    milliseconds epoch{clock::kEpochDuration};
+    if (since_epoch + config.idle_margin >= epoch) {
+      return false;
+    }
+    return head_validated || since_epoch >= config.validation_window;
+  }
+
+  boost::optional<std::pair<ChainEpoch, milliseconds>>
+  CompactionScheduler::epochTime() const {
+    auto now{std::chrono::duration_cast<milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch())};
+    auto since_genesis{now - epoch_clock_->genesisTime()};
+    if (since_genesis.count() < 0) {
+      return boost::none;
+    }
+    milliseconds epoch{clock::kEpochDuration};
+    return std::make_pair(ChainEpoch(since_genesis / epoch),
+                          since_genesis % epoch);
+  }
+
+  bool CompactionScheduler::idle() const {
+    if (critical_ != 0) {
+      return false;
+    }
+    auto time{epochTime()};
+    if (!time) {
+      // no blocks before genesis
+      return true;
+    }
+    auto [epoch, since_epoch]{*time};
+    return isIdle(config_, since_epoch, validated_ && *validated_ >= epoch);
+  }
+
+  bool CompactionScheduler::update(Store &store) {
+    auto stats{store.db->stats()};
+    store.write_stalls.inc(stats.write_stalls - store.last_write_stalls);
+    store.last_write_stalls = stats.write_stalls;
+
+    std::vector<LevelDBLevel> levels(kLevels);
+    for (auto &level : store.db->levels()) {
+      if (level.level < kLevels) {
+        levels[level.level] = level;
+      }
+    }
+    auto pressure{false};
+    auto limit{kLevel1Bytes};
+    for (size_t i{0}; i < kLevels; ++i) {
+      auto &level{levels[i]};
+      store.level_files[i]->set(level.files);
+      store.level_bytes[i]->set(level.bytes);
+      if (i == 0) {
+        pressure = level.files >= config_.level0_files;
+      } else {
+        // last level has no limit
+        if (i + 1 < kLevels) {
+          pressure = pressure || level.bytes >= config_.level_score * limit;
+        }
+        limit *= 10;
+      }
+    }
+    return pressure;
+  }
+
+  void CompactionScheduler::compact(Store &store) {
+    auto end{store.db->rangeEnd(store.cursor, config_.range_bytes)};
+    auto start{std::chrono::steady_clock::now()};
+    store.db->compactRange(store.cursor, end);
+    auto time{std::chrono::steady_clock::now() - start};
+    store.compactions.inc();
+    store.compaction_time.observe(time);
+    logger_->debug(
+        "compacted {} range in {} ms",
+        store.name,
+        std::chrono::duration_cast<milliseconds>(time).count());
+    // range includes end key, next one starts after it
+    if (end) {
+      end->putUint8(0);
+    }
+    store.cursor = std::move(end);
+  }
+
+  void CompactionScheduler::run() {
+    std::unique_lock lock{mutex_};
+    while (!stopped_) {
+      auto idle_now{idle()};
+      lock.unlock();
+      Store *pressured{nullptr};
+      for (size_t i{0}; i < stores_.size(); ++i) {
+        auto index{(next_store_ + i) % stores_.size()};
+        if (update(*stores_[index]) && !pressured) {
+          pressured = stores_[index].get();
+          next_store_ = index + 1;
+        }
+      }
+      if (idle_now && pressured) {
+        compact(*pressured);
+        lock.lock();
+        continue;
+      }
+      lock.lock();
+      if (!stopped_) {
+        cv_.wait_for(lock, config_.poll_interval);
+      }
+    }
+  }
+}  // namespace fc::storage
@@ -0,0 +1,115 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_STORAGE_LEVELDB_COMPACTION_SCHEDULER_HPP
+#define CPP_FILECOIN_CORE_STORAGE_LEVELDB_COMPACTION_SCHEDULER_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "clock/chain_epoch_clock.hpp"
+#include "common/logger.hpp"
+#include "storage/leveldb/leveldb.hpp"
+
+namespace fc::storage {
+  using clock::ChainEpoch;
+  using clock::ChainEpochClock;
+
+  struct CompactionConfig {
+    /**
+     * Idle part of epoch starts when head of epoch is validated, or after
+     * this time since epoch start if it is not, like after null round
+     */
+    std::chrono::milliseconds validation_window{6000};
+    /// Idle part of epoch ends this time before next epoch
+    std::chrono::milliseconds idle_margin{3000};
+    /// Interval of metrics updates and idle checks
+    std::chrono::milliseconds poll_interval{500};
+    /**
+     * Level 0 files to compact in idle time, below leveldb compaction
+     * trigger of 4 files, so it rarely compacts level 0 on its own
+     */
+    uint64_t level0_files{2};
+    /// Fraction of leveldb size limit of level to compact it in idle time
+    double level_score{0.8};
+    /// Bytes of keys and values compacted by one compaction
+    size_t range_bytes{32 << 20};
+  };
+
+  /**
+   * Runs leveldb compactions in idle part of each epoch, between validation
+   * of head and end of epoch, outside of windows marked critical like
+   * window post. Leveldb compacts level 0 and oversized levels in its
+   * background thread anytime and stalls writes until it is done, so level
+   * 0 files and levels close to their limit are compacted in ranges of
+   * range_bytes before leveldb triggers, resuming from last range in next
+   * idle time. Compactions are not interrupted, so range_bytes must fit in
+   * idle_margin. Level sizes, write stalls and compactions of stores are
+   * exported as metrics.
+   */
+  class CompactionScheduler {
+   public:
+    using Stores =
+        std::vector<std::pair<std::string, std::shared_ptr<LevelDB>>>;
+
+    CompactionScheduler(std::shared_ptr<ChainEpochClock> epoch_clock,
+                        Stores stores,
+                        CompactionConfig config = {});
+    CompactionScheduler(const CompactionScheduler &) = delete;
+    CompactionScheduler &operator=(const CompactionScheduler &) = delete;
+    /// Waits for compaction in progress
+    ~CompactionScheduler();
+
+    /// Starts thread of scheduler
+    void start();
+
+    void stop();
+
+    /// Head of epoch is validated, so rest of epoch is idle
+    void onHeadValidated(ChainEpoch epoch);
+
+    /// No compactions start until leaveCritical, calls may be nested
+    void enterCritical();
+
+    void leaveCritical();
+
+    /**
+     * Whether compaction may start at time since epoch start
+     * @param head_validated - head of epoch has been validated
+     */
+    static bool isIdle(const CompactionConfig &config,
+                       std::chrono::milliseconds since_epoch,
+                       bool head_validated);
+
+   private:
+    struct Store;
+
+    void run();
+    /// Current epoch and time since its start, none before genesis
+    boost::optional<std::pair<ChainEpoch, std::chrono::milliseconds>>
+    epochTime() const;
+    /// Whether compaction may start now, called with mutex locked
+    bool idle() const;
+    /// Updates metrics of store, returns whether it needs compaction
+    bool update(Store &store);
+    void compact(Store &store);
+
+    std::shared_ptr<ChainEpochClock> epoch_clock_;
+    CompactionConfig config_;
+    std::vector<std::unique_ptr<Store>> stores_;
+    /// Store compacted last, next idle compaction starts from next store
+    size_t next_store_{};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    boost::optional<ChainEpoch> validated_;
+    size_t critical_{};
+    bool stopped_{};
+    std::thread thread_;
+    common::Logger logger_;
+  };
+}  // namespace fc::storage
+
+#endif  // CPP_FILECOIN_CORE_STORAGE_LEVELDB_COMPACTION_SCHEDULER_HPP
@@ -9,6 +9,7 @@
 
 #include "storage/leveldb/leveldb_batch.hpp"
 #include "storage/leveldb/leveldb_cursor.hpp"
+#include "storage/leveldb/leveldb_snapshot.hpp"
 #include "storage/leveldb/leveldb_util.hpp"
 
 namespace fc::storage {
@@ -26,11 +27,89 @@ namespace fc::storage {
     return error_as_result<std::shared_ptr<LevelDB>>(status);
   }
 
+  outcome::result<std::shared_ptr<LevelDB>> LevelDB::create(
+      std::string_view path,
+      leveldb::Options options,
+      std::unique_ptr<const leveldb::FilterPolicy> filter_policy,
+      std::unique_ptr<leveldb::Cache> block_cache) {
+    options.filter_policy = filter_policy.get();
+    options.block_cache = block_cache.get();
+    OUTCOME_TRY(l, create(path, options));
+    l->filter_policy_ = std::move(filter_policy);
+    l->block_cache_ = std::move(block_cache);
+    return std::move(l);
+  }
+
+  boost::optional<std::string> LevelDB::property(
+      const std::string &name) const {
+    std::string value;
+    if (db_->GetProperty(name, &value)) {
+      return value;
+    }
+    return boost::none;
+  }
+
   std::unique_ptr<BufferMapCursor> LevelDB::cursor() {
+    LevelDBTimer timer{metrics_, LevelDBOp::kCursor};
     auto it = std::unique_ptr<leveldb::Iterator>(db_->NewIterator(ro_));
     return std::make_unique<Cursor>(std::move(it));
   }
 
+  std::shared_ptr<const LevelDB::Snapshot> LevelDB::snapshot() const {
+    return std::make_shared<Snapshot>(shared_from_this(), db_->GetSnapshot());
+  }
+
+  void LevelDB::addMetricsPrefix(std::string name, Buffer prefix) {
+    metrics_.addPrefix(std::move(name), std::move(prefix));
+  }
+
+  LevelDBStats LevelDB::stats() const {
+    auto stats{metrics_.stats()};
+    if (block_cache_) {
+      stats.block_cache_bytes = block_cache_->TotalCharge();
+    }
+    return stats;
+  }
+
+  std::vector<LevelDBLevel> LevelDB::levels() const {
+    if (auto stats{property("leveldb.stats")}) {
+      return parseLevelDBLevels(*stats);
+    }
+    return {};
+  }
+
+  void LevelDB::compactRange(const boost::optional<Buffer> &begin,
+                             const boost::optional<Buffer> &end) {
+    leveldb::Slice begin_slice, end_slice;
+    if (begin) {
+      begin_slice = make_slice(*begin);
+    }
+    if (end) {
+      end_slice = make_slice(*end);
+    }
+    db_->CompactRange(begin ? &begin_slice : nullptr,
+                      end ? &end_slice : nullptr);
+  }
+
+  boost::optional<Buffer> LevelDB::rangeEnd(
+      const boost::optional<Buffer> &begin, size_t bytes) const {
+    auto ro{ro_};
+    ro.fill_cache = false;
+    std::unique_ptr<leveldb::Iterator> it{db_->NewIterator(ro)};
+    if (begin) {
+      it->Seek(make_slice(*begin));
+    } else {
+      it->SeekToFirst();
+    }
+    for (size_t size{0}; it->Valid(); it->Next()) {
+      size += it->key().size() + it->value().size();
+      if (size >= bytes) {
+        return make_buffer(it->key());
+      }
+    }
+    return boost::none;
+  }
+
   std::unique_ptr<BufferBatch> LevelDB::batch() {
     return std::make_unique<Batch>(*this);
   }
@@ -44,8 +123,10 @@ namespace fc::storage {
   }
 
   outcome::result<Buffer> LevelDB::get(const Buffer &key) const {
+    LevelDBTimer timer{metrics_, LevelDBOp::kGet};
     std::string value;
     auto status = db_->Get(ro_, make_slice(key), &value);
+    metrics_.read(key, value.size(), status.ok());
     if (status.ok()) {
       // FIXME: is it possible to avoid copying string -> Buffer?
       return Buffer{}.put(value);
@@ -54,6 +135,28 @@ namespace fc::storage {
     return error_as_result<Buffer>(status, logger_);
   }
 
+  outcome::result<void> LevelDB::view(
+      const Buffer &key,
+      const std::function<outcome::result<void>(gsl::span<const uint8_t>)>
+          &callback) const {
+    // keeps capacity between calls, nested calls allocate own buffer
+    thread_local std::string cache;
+    std::string value{std::move(cache)};
+    leveldb::Status status;
+    {
+      LevelDBTimer timer{metrics_, LevelDBOp::kGet};
+      status = db_->Get(ro_, make_slice(key), &value);
+    }
+    metrics_.read(key, status.ok() ? value.size() : 0, status.ok());
+    if (!status.ok()) {
+      cache = std::move(value);
+      return error_as_result<void>(status, logger_);
+    }
+    auto result = callback(make_span(value));
+    cache = std::move(value);
+    return result;
+  }
+
   bool LevelDB::contains(const Buffer &key) const {
     // here we interpret all kinds of errors as "not found".
     // is there a better way?
@@ -61,6 +164,8 @@ namespace fc::storage {
   }
 
   outcome::result<void> LevelDB::put(const Buffer &key, const Buffer &value) {
+    LevelDBTimer timer{metrics_, LevelDBOp::kPut};
+    metrics_.write(key, value.size());
     auto status = db_->Put(wo_, make_slice(key), make_slice(value));
     if (status.ok()) {
       return outcome::success();
@@ -75,6 +180,7 @@ namespace fc::storage {
   }
 
   outcome::result<void> LevelDB::remove(const Buffer &key) {
+    LevelDBTimer timer{metrics_, LevelDBOp::kRemove};
     auto status = db_->Delete(wo_, make_slice(key));
     if (status.ok()) {
       return outcome::success();
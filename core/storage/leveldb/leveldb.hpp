@@ -6,21 +6,31 @@
 #ifndef CPP_FILECOIN_LEVELDB_HPP
 #define CPP_FILECOIN_LEVELDB_HPP
 
+#include <leveldb/cache.h>
 #include <leveldb/db.h>
+#include <leveldb/filter_policy.h>
 #include <leveldb/write_batch.h>
+#include <boost/optional.hpp>
 #include "common/logger.hpp"
 #include "storage/buffer_map.hpp"
+#include "storage/leveldb/leveldb_metrics.hpp"
 
 namespace fc::storage {
 
   /**
    * @brief An implementation of PersistentBufferMap interface, which uses
    * LevelDB as underlying storage.
+   * Reads, writes, batches and cursors may be used concurrently by any
+   * threads, as leveldb itself is thread-safe. Options and metrics prefixes
+   * must be set before instance is shared. Each cursor and batch must be
+   * used by one thread at a time.
    */
-  class LevelDB : public PersistentBufferMap {
+  class LevelDB : public PersistentBufferMap,
+                  public std::enable_shared_from_this<LevelDB> {
    public:
     class Batch;
     class Cursor;
+    class Snapshot;
 
     ~LevelDB() override = default;
 
@@ -33,6 +43,29 @@ namespace fc::storage {
     static outcome::result<std::shared_ptr<LevelDB>> create(
         std::string_view path, leveldb::Options options = leveldb::Options());
 
+    /**
+     * @brief Factory method, which keeps filter policy and block cache alive
+     * while database is open.
+     * @param path filesystem path where database is going to be
+     * @param options leveldb options, filter policy and block cache are
+     * replaced with given ones
+     * @param filter_policy filter policy or nullptr
+     * @param block_cache block cache or nullptr for leveldb default
+     * @return instance of LevelDB
+     */
+    static outcome::result<std::shared_ptr<LevelDB>> create(
+        std::string_view path,
+        leveldb::Options options,
+        std::unique_ptr<const leveldb::FilterPolicy> filter_policy,
+        std::unique_ptr<leveldb::Cache> block_cache);
+
+    /**
+     * @brief Get leveldb property, such as "leveldb.stats"
+     * @param name property name
+     * @return property value or none if not supported
+     */
+    boost::optional<std::string> property(const std::string &name) const;
+
     /**
      * @brief Set read options, which are used in @see LevelDB#get
      * @param ro options
@@ -47,10 +80,61 @@ namespace fc::storage {
 
     std::unique_ptr<BufferMapCursor> cursor() override;
 
+    /**
+     * @brief Consistent view of database at time of call, so several reads
+     * and cursors see same state while writes continue
+     * @return snapshot, which keeps database alive
+     */
+    std::shared_ptr<const Snapshot> snapshot() const;
+
+    /**
+     * @brief Counters of reads and writes by key prefix, like "/deals/"
+     * @param name - name of prefix in stats
+     * @param prefix - key prefix, must be registered before sharing
+     */
+    void addMetricsPrefix(std::string name, Buffer prefix);
+
+    /// Latencies, hit counts and per prefix bytes since open
+    LevelDBStats stats() const;
+
+    /// Non-empty levels with their files and sizes
+    std::vector<LevelDBLevel> levels() const;
+
+    /**
+     * @brief Compacts keys in range on calling thread, so overlapping files
+     * of all levels are merged down, blocks until done
+     * @param begin - first key or none for start of database
+     * @param end - last key or none for end of database
+     */
+    void compactRange(const boost::optional<Buffer> &begin,
+                      const boost::optional<Buffer> &end);
+
+    /**
+     * @brief Finds end of range starting at key, which holds about given
+     * bytes of keys and values. Iterates without filling block cache.
+     * @param begin - first key or none for start of database
+     * @param bytes - bytes of range
+     * @return last key of range or none if range reaches end of database
+     */
+    boost::optional<Buffer> rangeEnd(const boost::optional<Buffer> &begin,
+                                     size_t bytes) const;
+
     std::unique_ptr<BufferBatch> batch() override;
 
     outcome::result<Buffer> get(const Buffer &key) const override;
 
+    /**
+     * @brief Get value and pass it to callback without copying to Buffer.
+     * Read buffer is reused between calls on same thread.
+     * @param key key to find
+     * @param callback receives value bytes, valid only during call
+     * @return callback result or error
+     */
+    outcome::result<void> view(
+        const Buffer &key,
+        const std::function<outcome::result<void>(gsl::span<const uint8_t>)>
+            &callback) const;
+
     bool contains(const Buffer &key) const override;
 
     outcome::result<void> put(const Buffer &key, const Buffer &value) override;
@@ -61,6 +145,10 @@ namespace fc::storage {
     outcome::result<void> remove(const Buffer &key) override;
 
    private:
+    mutable LevelDBMetrics metrics_;
+    // must outlive db_
+    std::unique_ptr<const leveldb::FilterPolicy> filter_policy_;
+    std::unique_ptr<leveldb::Cache> block_cache_;
     std::unique_ptr<leveldb::DB> db_;
     leveldb::ReadOptions ro_;
     leveldb::WriteOptions wo_;
@@ -13,6 +13,7 @@ namespace fc::storage {
 
   outcome::result<void> LevelDB::Batch::put(const Buffer &key,
                                             const Buffer &value) {
+    db_.metrics_.write(key, value.size());
     batch_.Put(make_slice(key), make_slice(value));
     return outcome::success();
   }
@@ -28,6 +29,7 @@ namespace fc::storage {
   }
 
   outcome::result<void> LevelDB::Batch::commit() {
+    LevelDBTimer timer{db_.metrics_, LevelDBOp::kBatch};
     auto status = db_.db_->Write(db_.wo_, &batch_);
     if (status.ok()) {
       return outcome::success();
@@ -0,0 +1,153 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/leveldb/leveldb_metrics.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+namespace fc::storage {
+
+  void LatencyHistogram::add(std::chrono::nanoseconds time) {
+    auto ns{static_cast<uint64_t>(std::max<int64_t>(0, time.count()))};
+    size_t bucket{0};
+    for (auto us{ns / 1000}; us != 0 && bucket + 1 < kBuckets; us >>= 1) {
+      ++bucket;
+    }
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_ns_.fetch_add(ns, std::memory_order_relaxed);
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot snapshot;
+    snapshot.count = count_.load(std::memory_order_relaxed);
+    snapshot.total = std::chrono::nanoseconds{
+        static_cast<int64_t>(total_ns_.load(std::memory_order_relaxed))};
+    for (size_t i{0}; i < kBuckets; ++i) {
+      snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+  }
+
+  void LevelDBMetrics::addPrefix(std::string name, Buffer prefix) {
+    auto entry{std::make_unique<Prefix>()};
+    entry->name = std::move(name);
+    entry->prefix = std::move(prefix);
+    if (prefixes_.empty()) {
+      // empty prefix matches keys without other prefix
+      prefixes_.push_back(std::make_unique<Prefix>());
+      prefixes_.back()->name = "other";
+    }
+    prefixes_.insert(std::prev(prefixes_.end()), std::move(entry));
+  }
+
+  std::vector<LevelDBLevel> parseLevelDBLevels(const std::string &stats) {
+    // rows of "Level  Files Size(MB) Time(sec) Read(MB) Write(MB)" table
+    // follow line of dashes
+    std::vector<LevelDBLevel> levels;
+    std::istringstream lines{stats};
+    std::string line;
+    auto table{false};
+    while (std::getline(lines, line)) {
+      if (!table) {
+        table = line.rfind("---", 0) == 0;
+        continue;
+      }
+      std::istringstream row{line};
+      LevelDBLevel level;
+      double megabytes{}, seconds{};
+      if (!(row >> level.level >> level.files >> megabytes >> seconds)) {
+        break;
+      }
+      level.bytes = static_cast<uint64_t>(megabytes * 1048576);
+      level.compaction_time =
+          std::chrono::seconds{static_cast<int64_t>(seconds)};
+      levels.push_back(level);
+    }
+    return levels;
+  }
+
+  void LevelDBMetrics::record(LevelDBOp op, std::chrono::nanoseconds time) {
+    ops_[static_cast<size_t>(op)].add(time);
+    if (op != LevelDBOp::kGet && op != LevelDBOp::kCursor
+        && time >= kWriteStallThreshold) {
+      write_stalls_.fetch_add(1, std::memory_order_relaxed);
+      write_stall_ns_.fetch_add(time.count(), std::memory_order_relaxed);
+    }
+  }
+
+  void LevelDBMetrics::read(gsl::span<const uint8_t> key,
+                            size_t bytes,
+                            bool found) {
+    (found ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+    if (prefixes_.empty()) {
+      return;
+    }
+    auto &prefix{prefixOf(key)};
+    prefix.reads.fetch_add(1, std::memory_order_relaxed);
+    prefix.read_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  void LevelDBMetrics::write(gsl::span<const uint8_t> key, size_t bytes) {
+    if (prefixes_.empty()) {
+      return;
+    }
+    auto &prefix{prefixOf(key)};
+    prefix.writes.fetch_add(1, std::memory_order_relaxed);
+    prefix.write_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  LevelDBStats LevelDBMetrics::stats() const {
+    LevelDBStats stats;
+    for (size_t i{0}; i < kLevelDBOps; ++i) {
+      stats.ops[i] = ops_[i].snapshot();
+    }
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.write_stalls = write_stalls_.load(std::memory_order_relaxed);
+    stats.write_stall_time = std::chrono::nanoseconds{
+        static_cast<int64_t>(write_stall_ns_.load(std::memory_order_relaxed))};
+    for (auto &prefix : prefixes_) {
+      stats.prefixes.push_back({
+          prefix->name,
+          prefix->reads.load(std::memory_order_relaxed),
+          prefix->read_bytes.load(std::memory_order_relaxed),
+          prefix->writes.load(std::memory_order_relaxed),
+          prefix->write_bytes.load(std::memory_order_relaxed),
+      });
+    }
+    return stats;
+  }
+
+  std::string LevelDBMetrics::opName(LevelDBOp op) {
+    switch (op) {
+      case LevelDBOp::kGet:
+        return "get";
+      case LevelDBOp::kPut:
+        return "put";
+      case LevelDBOp::kRemove:
+        return "remove";
+      case LevelDBOp::kBatch:
+        return "batch";
+      case LevelDBOp::kCursor:
+        return "cursor";
+    }
+    return "unknown";
+  }
+
+  LevelDBMetrics::Prefix &LevelDBMetrics::prefixOf(
+      gsl::span<const uint8_t> key) {
+    for (auto &prefix : prefixes_) {
+      auto &bytes{prefix->prefix};
+      if (static_cast<size_t>(key.size()) >= bytes.size()
+          && std::equal(bytes.begin(), bytes.end(), key.begin())) {
+        return *prefix;
+      }
+    }
+    return *prefixes_.back();
+  }
+
+}  // namespace fc::storage
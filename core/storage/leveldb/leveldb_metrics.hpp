@@ -0,0 +1,158 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_LEVELDB_METRICS_HPP
+#define CPP_FILECOIN_LEVELDB_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/buffer.hpp"
+
+namespace fc::storage {
+
+  /// Operations of leveldb wrapper which latency is measured
+  enum class LevelDBOp { kGet, kPut, kRemove, kBatch, kCursor };
+  constexpr size_t kLevelDBOps{5};
+
+  /**
+   * Writes taking this long are counted as stalled, leveldb delays each
+   * write by 1ms when level 0 has too many files and blocks writes until
+   * compaction when memtable or level 0 are full
+   */
+  constexpr std::chrono::milliseconds kWriteStallThreshold{1};
+
+  /**
+   * Latency histogram with power of two microsecond buckets, last bucket
+   * counts all longer operations. Lock-free.
+   */
+  class LatencyHistogram {
+   public:
+    static constexpr size_t kBuckets{24};
+
+    struct Snapshot {
+      uint64_t count{};
+      std::chrono::nanoseconds total{};
+      /// Operations shorter than 2^i microseconds, but not 2^(i-1)
+      std::array<uint64_t, kBuckets> buckets{};
+    };
+
+    void add(std::chrono::nanoseconds time);
+
+    Snapshot snapshot() const;
+
+   private:
+    std::atomic<uint64_t> count_{};
+    std::atomic<uint64_t> total_ns_{};
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+  };
+
+  /// Reads and writes of keys with prefix
+  struct PrefixCounters {
+    std::string name;
+    uint64_t reads{};
+    uint64_t read_bytes{};
+    uint64_t writes{};
+    uint64_t write_bytes{};
+  };
+
+  struct LevelDBStats {
+    std::array<LatencyHistogram::Snapshot, kLevelDBOps> ops;
+    /// Reads which found key
+    uint64_t hits{};
+    /// Reads of missing keys
+    uint64_t misses{};
+    /// Registered prefixes, then keys without registered prefix as "other"
+    std::vector<PrefixCounters> prefixes;
+    /// Bytes charged to block cache owned by wrapper, zero if none
+    size_t block_cache_bytes{};
+    /// Puts, removes and batch commits slower than kWriteStallThreshold
+    uint64_t write_stalls{};
+    std::chrono::nanoseconds write_stall_time{};
+  };
+
+  /// Files of leveldb level, from "leveldb.stats" property
+  struct LevelDBLevel {
+    size_t level{};
+    uint64_t files{};
+    /// Approximate, property reports megabytes
+    uint64_t bytes{};
+    /// Time spent compacting into level
+    std::chrono::seconds compaction_time{};
+  };
+
+  /// Parses non-empty levels from compactions table of "leveldb.stats"
+  std::vector<LevelDBLevel> parseLevelDBLevels(const std::string &stats);
+
+  /**
+   * Counters of leveldb wrapper, updated without locks by all threads using
+   * it. Prefixes are registered before store is shared.
+   */
+  class LevelDBMetrics {
+   public:
+    /**
+     * Registers prefix, keys with several registered prefixes are counted
+     * under first one
+     * @param name - name in stats, like subsystem using keys
+     */
+    void addPrefix(std::string name, Buffer prefix);
+
+    void record(LevelDBOp op, std::chrono::nanoseconds time);
+
+    void read(gsl::span<const uint8_t> key, size_t bytes, bool found);
+
+    void write(gsl::span<const uint8_t> key, size_t bytes);
+
+    /// Stats without block cache bytes, which are known to wrapper
+    LevelDBStats stats() const;
+
+    static std::string opName(LevelDBOp op);
+
+   private:
+    struct Prefix {
+      std::string name;
+      Buffer prefix;
+      std::atomic<uint64_t> reads{};
+      std::atomic<uint64_t> read_bytes{};
+      std::atomic<uint64_t> writes{};
+      std::atomic<uint64_t> write_bytes{};
+    };
+
+    Prefix &prefixOf(gsl::span<const uint8_t> key);
+
+    std::array<LatencyHistogram, kLevelDBOps> ops_;
+    std::atomic<uint64_t> hits_{};
+    std::atomic<uint64_t> misses_{};
+    std::atomic<uint64_t> write_stalls_{};
+    std::atomic<uint64_t> write_stall_ns_{};
+    /// Prefixes in registration order, last one has empty prefix
+    std::vector<std::unique_ptr<Prefix>> prefixes_;
+  };
+
+  /// Records latency of operation on scope exit
+  class LevelDBTimer {
+   public:
+    LevelDBTimer(LevelDBMetrics &metrics, LevelDBOp op)
+        : metrics_{metrics},
+          op_{op},
+          start_{std::chrono::steady_clock::now()} {}
+
+    ~LevelDBTimer() {
+      metrics_.record(op_, std::chrono::steady_clock::now() - start_);
+    }
+
+   private:
+    LevelDBMetrics &metrics_;
+    LevelDBOp op_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+}  // namespace fc::storage
+
+#endif  // CPP_FILECOIN_LEVELDB_METRICS_HPP
@@ -0,0 +1,47 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/leveldb/leveldb_snapshot.hpp"
+
+#include "storage/leveldb/leveldb_cursor.hpp"
+#include "storage/leveldb/leveldb_util.hpp"
+
+namespace fc::storage {
+
+  LevelDB::Snapshot::Snapshot(std::shared_ptr<const LevelDB> db,
+                              const leveldb::Snapshot *snapshot)
+      : db_{std::move(db)}, snapshot_{snapshot}, ro_{db_->ro_} {
+    ro_.snapshot = snapshot_;
+  }
+
+  LevelDB::Snapshot::~Snapshot() {
+    db_->db_->ReleaseSnapshot(snapshot_);
+  }
+
+  outcome::result<Buffer> LevelDB::Snapshot::get(const Buffer &key) const {
+    LevelDBTimer timer{db_->metrics_, LevelDBOp::kGet};
+    std::string value;
+    auto status = db_->db_->Get(ro_, make_slice(key), &value);
+    db_->metrics_.read(key, value.size(), status.ok());
+    if (status.ok()) {
+      return Buffer{}.put(value);
+    }
+    return error_as_result<Buffer>(status);
+  }
+
+  bool LevelDB::Snapshot::contains(const Buffer &key) const {
+    return get(key).has_value();
+  }
+
+  std::unique_ptr<BufferMapCursor> LevelDB::Snapshot::cursor() const {
+    LevelDBTimer timer{db_->metrics_, LevelDBOp::kCursor};
+    std::shared_ptr<leveldb::Iterator> it{db_->db_->NewIterator(ro_)};
+    // iterator must be destroyed before snapshot is released
+    auto release{[it, self{shared_from_this()}](auto) mutable { it.reset(); }};
+    return std::make_unique<Cursor>(
+        std::shared_ptr<leveldb::Iterator>{it.get(), std::move(release)});
+  }
+
+}  // namespace fc::storage
@@ -0,0 +1,43 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_LEVELDB_SNAPSHOT_HPP
+#define CPP_FILECOIN_LEVELDB_SNAPSHOT_HPP
+
+#include "storage/leveldb/leveldb.hpp"
+
+namespace fc::storage {
+
+  /**
+   * @brief Read-only view of database at time of creation, may be shared by
+   * threads. Cursors of snapshot keep it alive.
+   */
+  class LevelDB::Snapshot
+      : public std::enable_shared_from_this<LevelDB::Snapshot> {
+   public:
+    Snapshot(std::shared_ptr<const LevelDB> db,
+             const leveldb::Snapshot *snapshot);
+
+    ~Snapshot();
+
+    Snapshot(const Snapshot &) = delete;
+    Snapshot &operator=(const Snapshot &) = delete;
+
+    outcome::result<Buffer> get(const Buffer &key) const;
+
+    bool contains(const Buffer &key) const;
+
+    /// Cursor over snapshot state
+    std::unique_ptr<BufferMapCursor> cursor() const;
+
+   private:
+    std::shared_ptr<const LevelDB> db_;
+    const leveldb::Snapshot *snapshot_;
+    leveldb::ReadOptions ro_;
+  };
+
+}  // namespace fc::storage
+
+#endif  // CPP_FILECOIN_LEVELDB_SNAPSHOT_HPP
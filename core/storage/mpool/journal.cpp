@@ -0,0 +1,183 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/mpool/journal.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+#include "codec/cbor/cbor.hpp"
+#include "codec/uvarint.hpp"
+#include "common/span.hpp"
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::mpool, MpoolJournalError, e) {
+  using E = fc::storage::mpool::MpoolJournalError;
+  switch (e) {
+    case E::kCannotOpen:
+      return "MpoolJournal: cannot open journal";
+    case E::kCannotRead:
+      return "MpoolJournal: cannot read journal";
+    case E::kCannotWrite:
+      return "MpoolJournal: cannot write journal";
+  }
+}
+
+namespace fc::storage::mpool {
+  using common::Buffer;
+
+  /// Appends length prefixed records to buffer
+  outcome::result<void> encodeRecords(
+      Buffer &output, const std::vector<JournalRecord> &records) {
+    for (const auto &record : records) {
+      OUTCOME_TRY(bytes, codec::cbor::encode(record));
+      output.put(libp2p::multi::UVarint{bytes.size()}.toBytes());
+      output.put(bytes);
+    }
+    return outcome::success();
+  }
+
+  /// Writes whole buffer, retrying partial writes
+  bool writeAll(int fd, gsl::span<const uint8_t> bytes) {
+    while (!bytes.empty()) {
+      auto written{::write(fd, bytes.data(), bytes.size())};
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+      if (written <= 0) {
+        return false;
+      }
+      bytes = bytes.subspan(written);
+    }
+    return true;
+  }
+
+  MpoolJournal::MpoolJournal(std::string path) : path_{std::move(path)} {}
+
+  MpoolJournal::~MpoolJournal() {
+    if (fd_ != -1) {
+      ::close(fd_);
+    }
+  }
+
+  outcome::result<std::shared_ptr<MpoolJournal>> MpoolJournal::open(
+      const std::string &path) {
+    auto journal{std::make_shared<MpoolJournal>(path)};
+    journal->fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (journal->fd_ == -1) {
+      return MpoolJournalError::kCannotOpen;
+    }
+    return journal;
+  }
+
+  outcome::result<std::vector<SignedMessage>> MpoolJournal::replay() {
+    std::ifstream file{path_, std::ios::binary | std::ios::ate};
+    if (!file.good()) {
+      return MpoolJournalError::kCannotRead;
+    }
+    Buffer bytes;
+    bytes.resize(file.tellg());
+    file.seekg(0, std::ios::beg);
+    file.read(common::span::string(bytes).data(), bytes.size());
+    if (!file.good()) {
+      return MpoolJournalError::kCannotRead;
+    }
+
+    std::map<std::pair<Address, uint64_t>, SignedMessage> pending;
+    codec::uvarint::Input input{bytes};
+    records_ = 0;
+    while (!input.empty()) {
+      auto next{input};
+      auto record_bytes{
+          codec::uvarint::readBytes<MpoolJournalError::kCannotRead,
+                                    MpoolJournalError::kCannotRead>(next)};
+      if (!record_bytes) {
+        break;
+      }
+      auto record{codec::cbor::decode<JournalRecord>(record_bytes.value())};
+      if (!record) {
+        break;
+      }
+      input = next;
+      ++records_;
+      auto &[added, from, nonce]{record.value()};
+      if (added) {
+        pending.insert_or_assign(std::make_pair(from, nonce),
+                                 std::move(*added));
+      } else {
+        pending.erase(std::make_pair(from, nonce));
+      }
+    }
+    if (!input.empty()) {
+      // torn tail would corrupt records appended after it
+      if (::ftruncate(fd_, static_cast<off_t>(bytes.size() - input.size()))
+          != 0) {
+        return MpoolJournalError::kCannotWrite;
+      }
+    }
+
+    std::vector<SignedMessage> messages;
+    messages.reserve(pending.size());
+    for (auto &it : pending) {
+      messages.push_back(std::move(it.second));
+    }
+    return std::move(messages);
+  }
+
+  outcome::result<void> MpoolJournal::append(
+      const std::vector<JournalRecord> &records) {
+    if (records.empty()) {
+      return outcome::success();
+    }
+    Buffer bytes;
+    OUTCOME_TRY(encodeRecords(bytes, records));
+    if (!writeAll(fd_, bytes)) {
+      return MpoolJournalError::kCannotWrite;
+    }
+    records_ += records.size();
+    return outcome::success();
+  }
+
+  outcome::result<void> MpoolJournal::compact(
+      const std::vector<SignedMessage> &pending) {
+    std::vector<JournalRecord> records;
+    records.reserve(pending.size());
+    for (const auto &message : pending) {
+      records.push_back({message, message.message.from, message.message.nonce});
+    }
+    Buffer bytes;
+    OUTCOME_TRY(encodeRecords(bytes, records));
+
+    // renamed over old journal, so it is never partially compacted
+    auto temp_path{path_ + ".tmp"};
+    auto fd{::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+    if (fd == -1) {
+      return MpoolJournalError::kCannotWrite;
+    }
+    auto written{writeAll(fd, bytes) && ::fdatasync(fd) == 0};
+    ::close(fd);
+    boost::system::error_code ec;
+    if (written) {
+      boost::filesystem::rename(temp_path, path_, ec);
+    }
+    if (!written || ec.failed()) {
+      boost::filesystem::remove(temp_path, ec);
+      return MpoolJournalError::kCannotWrite;
+    }
+    fd = ::open(path_.c_str(), O_WRONLY | O_APPEND);
+    if (fd == -1) {
+      return MpoolJournalError::kCannotOpen;
+    }
+    ::close(fd_);
+    fd_ = fd;
+    records_ = records.size();
+    return outcome::success();
+  }
+
+  size_t MpoolJournal::records() const {
+    return records_;
+  }
+}  // namespace fc::storage::mpool
@@ -0,0 +1,71 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_STORAGE_MPOOL_JOURNAL_HPP
+#define CPP_FILECOIN_CORE_STORAGE_MPOOL_JOURNAL_HPP
+
+#include "codec/cbor/streams_annotation.hpp"
+#include "vm/message/message.hpp"
+
+namespace fc::storage::mpool {
+  using primitives::address::Address;
+  using vm::message::SignedMessage;
+
+  enum class MpoolJournalError {
+    kCannotOpen = 1,
+    kCannotRead,
+    kCannotWrite,
+  };
+
+  /// Added message, or sender and nonce of removed message
+  struct JournalRecord {
+    boost::optional<SignedMessage> added;
+    Address from;
+    uint64_t nonce{};
+  };
+  CBOR_TUPLE(JournalRecord, added, from, nonce)
+
+  /**
+   * Append-only file of messages accepted by and removed from mpool.
+   * Records are length prefixed cbor, each batch is written by one write, so
+   * crash leaves at most one torn batch at end, it is dropped by replay.
+   * Compaction rewrites journal with pending messages only.
+   */
+  class MpoolJournal {
+   public:
+    explicit MpoolJournal(std::string path);
+    MpoolJournal(const MpoolJournal &) = delete;
+    MpoolJournal &operator=(const MpoolJournal &) = delete;
+    ~MpoolJournal();
+
+    /// Opens or creates journal file for appending
+    static outcome::result<std::shared_ptr<MpoolJournal>> open(
+        const std::string &path);
+
+    /**
+     * Reads journal and applies records in order, truncates torn tail.
+     * @return messages pending after last record, ordered by sender and nonce
+     */
+    outcome::result<std::vector<SignedMessage>> replay();
+
+    /// Appends records in one write
+    outcome::result<void> append(const std::vector<JournalRecord> &records);
+
+    /// Replaces journal with added records of pending messages
+    outcome::result<void> compact(const std::vector<SignedMessage> &pending);
+
+    /// Records in journal, since last compaction if any
+    size_t records() const;
+
+   private:
+    std::string path_;
+    int fd_{-1};
+    size_t records_{};
+  };
+}  // namespace fc::storage::mpool
+
+OUTCOME_HPP_DECLARE_ERROR(fc::storage::mpool, MpoolJournalError);
+
+#endif  // CPP_FILECOIN_CORE_STORAGE_MPOOL_JOURNAL_HPP
@@ -5,19 +5,52 @@
 
 #include "storage/mpool/mpool.hpp"
 #include "common/logger.hpp"
+#include "metrics/metrics.hpp"
+#include "primitives/cid/cid_of_cbor.hpp"
+#include "vm/actor/builtin/market/policy.hpp"
 #include "vm/interpreter/impl/interpreter_impl.hpp"
+#include "vm/runtime/pricelist.hpp"
 #include "vm/state/impl/state_tree_impl.hpp"
 
 namespace fc::storage::mpool {
+  using primitives::address::BLSPublicKeyHash;
+  using primitives::address::Protocol;
   using primitives::block::MsgMeta;
+  using primitives::cid::getCidOfCbor;
   using primitives::tipset::HeadChangeType;
   using vm::message::UnsignedMessage;
 
-  Mpool::Mpool(IpldPtr ipld) : ipld{ipld} {}
+  /// Checks message fields which don't depend on state
+  bool isSelectable(const SignedMessage &message) {
+    auto &msg{message.message};
+    if (msg.version != vm::message::kMessageVersion
+        || msg.gasLimit > kBlockGasLimit || msg.value < 0
+        || msg.value > vm::actor::builtin::market::kTotalFilecoin
+        || msg.gasPrice < 0) {
+      return false;
+    }
+    auto bytes{message.signature.isBls() ? codec::cbor::encode(msg)
+                                         : codec::cbor::encode(message)};
+    return bytes
+           && msg.gasLimit
+                  >= vm::runtime::Pricelist{}.onChainMessage(
+                      bytes.value().size());
+  }
+
+  Mpool::Mpool(IpldPtr ipld,
+               std::shared_ptr<BatchVerifier> bls_verifier,
+               std::shared_ptr<SecpVerifier> secp_verifier)
+      : ipld{ipld},
+        bls_verifier{std::move(bls_verifier)},
+        secp_verifier{std::move(secp_verifier)} {}
 
   std::shared_ptr<Mpool> Mpool::create(
-      IpldPtr ipld, std::shared_ptr<ChainStore> chain_store) {
-    auto mpool{std::make_shared<Mpool>(ipld)};
+      IpldPtr ipld,
+      std::shared_ptr<ChainStore> chain_store,
+      std::shared_ptr<BatchVerifier> bls_verifier,
+      std::shared_ptr<SecpVerifier> secp_verifier) {
+    auto mpool{std::make_shared<Mpool>(
+        ipld, std::move(bls_verifier), std::move(secp_verifier))};
     mpool->head_sub = chain_store->subscribeHeadChanges([=](auto &change) {
       auto res{mpool->onHeadChange(change)};
       if (!res) {
@@ -30,92 +63,324 @@ namespace fc::storage::mpool {
   }
 
   std::vector<SignedMessage> Mpool::pending() const {
-    std::vector<SignedMessage> messages;
-    for (auto &[addr, pending] : by_from) {
-      for (auto &[nonce, message] : pending.by_nonce) {
-        messages.push_back(message);
-      }
+    return messages.all();
+  }
+
+  outcome::result<std::vector<SignedMessage>> Mpool::select(
+      const Tipset &ts) const {
+    SelectLimits limits{kBlockMessageLimit, kBlockGasLimit};
+    if (ts.cids == head.cids) {
+      return messages.select(
+          [&](auto &address) { return actor(address); }, limits, isSelectable);
     }
-    return messages;
+    OUTCOME_TRY(interpreted,
+                vm::interpreter::InterpreterImpl{}.interpret(ipld, ts));
+    vm::state::StateTreeImpl tree{ipld, interpreted.state_root};
+    return messages.select(
+        [&](auto &address) -> outcome::result<ActorView> {
+          OUTCOME_TRY(actor, tree.get(address));
+          return ActorView{actor.nonce, actor.balance};
+        },
+        limits,
+        isSelectable);
   }
 
   outcome::result<uint64_t> Mpool::nonce(const Address &from) const {
-    OUTCOME_TRY(interpeted,
-                vm::interpreter::InterpreterImpl{}.interpret(ipld, head));
-    OUTCOME_TRY(
-        actor, vm::state::StateTreeImpl{ipld, interpeted.state_root}.get(from));
-    auto by_from_it{by_from.find(from)};
-    if (by_from_it != by_from.end() && by_from_it->second.nonce > actor.nonce) {
-      return by_from_it->second.nonce;
+    OUTCOME_TRY(view, actor(from));
+    auto pending{messages.nextNonce(from)};
+    if (pending && *pending > view.nonce) {
+      return *pending;
     }
-    return actor.nonce;
+    return view.nonce;
   }
 
   outcome::result<void> Mpool::add(const SignedMessage &message) {
+    if (secp_verifier && !message.signature.isBls()
+        && message.message.from.getProtocol() == Protocol::SECP256K1) {
+      OUTCOME_TRY(valid, secp_verifier->verify(message, message.message.from));
+      if (!valid) {
+        return vm::message::MessageError::kVerificationFailure;
+      }
+    }
+    OUTCOME_TRY(cid, store(message));
+    insert(message, cid);
+    publish({{MpoolUpdate::Type::ADD, message}});
+    return outcome::success();
+  }
+
+  outcome::result<CID> Mpool::store(const SignedMessage &message) {
+    // cid of bls message is cid of unsigned message
+    OUTCOME_TRY(unsigned_cid, ipld->setCbor(message.message));
     if (message.signature.isBls()) {
-      bls_cache.emplace(message.getCid(), message.signature);
+      bls_cache.emplace(cidKey(unsigned_cid), message.signature);
+    }
+    OUTCOME_TRY(signed_cid, ipld->setCbor(message));
+    return message.signature.isBls() ? unsigned_cid : signed_cid;
+  }
+
+  void Mpool::addGossip(const SignedMessage &message, AddCallback callback) {
+    auto &from{message.message.from};
+    if (secp_verifier && !message.signature.isBls()
+        && from.getProtocol() == Protocol::SECP256K1) {
+      // add checks signature again, recovered key is cached
+      return secp_verifier->verifyAsync(
+          message,
+          [weak{weak_from_this()}, message, callback{std::move(callback)}](
+              auto valid) {
+            if (!valid) {
+              return callback(valid.error());
+            }
+            if (!valid.value()) {
+              return callback(vm::message::MessageError::kVerificationFailure);
+            }
+            if (auto self{weak.lock()}) {
+              callback(self->add(message));
+            }
+          });
     }
-    OUTCOME_TRY(ipld->setCbor(message));
-    OUTCOME_TRY(ipld->setCbor(message.message));
-    auto &pending{by_from[message.message.from]};
-    if (pending.by_nonce.empty() || message.message.nonce >= pending.nonce) {
-      pending.nonce = message.message.nonce + 1;
+    if (!bls_verifier || !message.signature.isBls()
+        || from.data.type() != typeid(BLSPublicKeyHash)) {
+      return callback(add(message));
     }
-    pending.by_nonce[message.message.nonce] = message;
-    signal({MpoolUpdate::Type::ADD, message});
-    return outcome::success();
+    auto cid{getCidOfCbor(message.message)};
+    if (!cid) {
+      return callback(cid.error());
+    }
+    auto bytes{cid.value().toBytes()};
+    if (!bytes) {
+      return callback(bytes.error());
+    }
+    crypto::bls::PublicKey key;
+    auto &hash{boost::get<BLSPublicKeyHash>(from.data)};
+    std::copy_n(hash.begin(), key.size(), key.begin());
+    bls_verifier->verify(
+        common::Buffer{std::move(bytes.value())},
+        boost::get<crypto::bls::Signature>(message.signature),
+        key,
+        [weak{weak_from_this()}, message, callback{std::move(callback)}](
+            bool valid) {
+          if (!valid) {
+            return callback(vm::message::MessageError::kVerificationFailure);
+          }
+          if (auto self{weak.lock()}) {
+            callback(self->add(message));
+          }
+        });
   }
 
   void Mpool::remove(const Address &from, uint64_t nonce) {
-    auto by_from_it{by_from.find(from)};
-    if (by_from_it != by_from.end()) {
-      auto &pending{by_from_it->second};
-      auto message{pending.by_nonce.find(nonce)};
-      if (message != pending.by_nonce.end()) {
-        signal({MpoolUpdate::Type::REMOVE, message->second});
-        pending.by_nonce.erase(message);
-        if (pending.by_nonce.empty()) {
-          by_from.erase(by_from_it);
-        } else {
-          pending.nonce = std::max(pending.by_nonce.rbegin()->first, nonce) + 1;
-        }
+    if (auto message{messages.remove(from, nonce)}) {
+      unindex(from, nonce);
+      publish({{MpoolUpdate::Type::REMOVE, *message}});
+    }
+  }
+
+  outcome::result<void> Mpool::restore(
+      std::shared_ptr<MpoolJournal> journal) {
+    OUTCOME_TRY(replayed, journal->replay());
+    std::vector<MpoolUpdate> updates;
+    for (auto &message : replayed) {
+      // sender state is checked once against current head
+      auto view{actor(message.message.from)};
+      if (view && message.message.nonce < view.value().nonce) {
+        continue;
       }
+      OUTCOME_TRY(cid, store(message));
+      insert(message, cid);
+      updates.push_back({MpoolUpdate::Type::ADD, std::move(message)});
+    }
+    // restored updates are already in journal
+    publish(updates);
+    OUTCOME_TRY(journal->compact(messages.all()));
+    this->journal = std::move(journal);
+    return outcome::success();
+  }
+
+  void Mpool::insert(const SignedMessage &message, const CID &cid) {
+    auto &from{message.message.from};
+    auto nonce{message.message.nonce};
+    messages.add(message);
+    // replaced message is not pending anymore
+    unindex(from, nonce);
+    auto key{cidKey(cid)};
+    by_cid.emplace(key, std::make_pair(from, nonce));
+    cid_of.emplace(std::make_pair(from, nonce), std::move(key));
+  }
+
+  void Mpool::unindex(const Address &from, uint64_t nonce) {
+    auto it{cid_of.find(std::make_pair(from, nonce))};
+    if (it != cid_of.end()) {
+      by_cid.erase(it->second);
+      cid_of.erase(it);
     }
   }
 
+  void Mpool::publish(const std::vector<MpoolUpdate> &updates) {
+    if (updates.empty()) {
+      return;
+    }
+    journalUpdates(updates);
+    // every change of pool is published, so metrics are updated here
+    auto &registry{metrics::Registry::global()};
+    static auto &size{
+        registry.gauge("fc_mpool_size", "Pending messages in mpool")};
+    static auto &added{registry.counter("fc_mpool_updates_total",
+                                        "Messages added to and removed from "
+                                        "mpool",
+                                        {{"type", "add"}})};
+    static auto &removed{registry.counter(
+        "fc_mpool_updates_total", "", {{"type", "remove"}})};
+    for (auto &update : updates) {
+      (update.type == MpoolUpdate::Type::ADD ? added : removed).inc();
+    }
+    size.set(by_cid.size());
+    // messages are also in ipld, indices and cached signatures are counted
+    constexpr size_t kIndexBytes{2 * sizeof(CidKey) + 2 * sizeof(Address)
+                                 + 2 * sizeof(uint64_t)};
+    memory.set(
+        metrics::containerBytes(by_cid, kIndexBytes)
+        + messages.size() * (sizeof(SignedMessage) + metrics::kNodeOverhead)
+        + metrics::containerBytes(bls_cache,
+                                  sizeof(CidKey) + sizeof(Signature)));
+    for (auto &update : updates) {
+      signal(update);
+    }
+    batch_signal(updates);
+  }
+
+  void Mpool::journalUpdates(const std::vector<MpoolUpdate> &updates) {
+    if (!journal) {
+      return;
+    }
+    std::vector<JournalRecord> records;
+    records.reserve(updates.size());
+    for (auto &update : updates) {
+      auto &message{update.message};
+      records.push_back({update.type == MpoolUpdate::Type::ADD
+                             ? boost::make_optional(message)
+                             : boost::none,
+                         message.message.from,
+                         message.message.nonce});
+    }
+    auto appended{journal->append(records)};
+    if (appended && journal->records() > kJournalCompactRecords
+        && journal->records() > 2 * messages.size()) {
+      appended = journal->compact(messages.all());
+    }
+    if (!appended) {
+      spdlog::error("Mpool journal: error {} \"{}\"",
+                    appended.error(),
+                    appended.error().message());
+    }
+  }
+
+  outcome::result<ActorView> Mpool::actor(const Address &address) const {
+    auto it{actors.find(address)};
+    if (it != actors.end()) {
+      return it->second;
+    }
+    if (!head_state) {
+      OUTCOME_TRY(interpreted,
+                  vm::interpreter::InterpreterImpl{}.interpret(ipld, head));
+      head_state = interpreted.state_root;
+    }
+    OUTCOME_TRY(actor,
+                vm::state::StateTreeImpl{ipld, *head_state}.get(address));
+    return actors.emplace(address, ActorView{actor.nonce, actor.balance})
+        .first->second;
+  }
+
+  void Mpool::setHead(Tipset ts) {
+    head = std::move(ts);
+    head_state.reset();
+    actors.clear();
+  }
+
   outcome::result<void> Mpool::onHeadChange(const HeadChange &change) {
-    if (change.type == HeadChangeType::CURRENT) {
-      head = change.value;
-    } else {
+    return onHeadChanges(gsl::make_span(&change, 1));
+  }
+
+  outcome::result<void> Mpool::onHeadChanges(
+      gsl::span<const HeadChange> changes) {
+    std::vector<MpoolUpdate> updates;
+    // next nonce of senders after included pending messages
+    std::map<Address, uint64_t> included;
+    auto trim{[&] {
+      for (auto &[from, nonce] : included) {
+        for (auto &message : messages.removeBelow(from, nonce)) {
+          unindex(from, message.message.nonce);
+          updates.push_back({MpoolUpdate::Type::REMOVE, std::move(message)});
+        }
+      }
+      included.clear();
+    }};
+    const HeadChange *last{nullptr};
+    for (auto &change : changes) {
+      if (change.type == HeadChangeType::CURRENT) {
+        last = &change;
+        continue;
+      }
       auto apply{change.type == HeadChangeType::APPLY};
+      if (!apply) {
+        // reverted messages may be included again by later changes
+        trim();
+      }
       OUTCOME_TRY(change.value.visitMessages(
           ipld, [&](auto, auto bls, auto &cid) -> outcome::result<void> {
-            if (bls) {
-              OUTCOME_TRY(message, ipld->getCbor<UnsignedMessage>(cid));
-              if (apply) {
-                remove(message.from, message.nonce);
-              } else {
-                auto sig{bls_cache.find(cid)};
-                if (sig != bls_cache.end()) {
-                  OUTCOME_TRY(add({message, sig->second}));
-                }
+            auto key{cidKey(cid)};
+            if (apply) {
+              auto it{by_cid.find(key)};
+              if (it != by_cid.end()) {
+                auto &[from, nonce]{it->second};
+                auto &next{included[from]};
+                next = std::max(next, nonce + 1);
+                return outcome::success();
               }
-            } else {
-              OUTCOME_TRY(message, ipld->getCbor<SignedMessage>(cid));
-              if (apply) {
-                remove(message.message.from, message.message.nonce);
+              if (by_cid.empty()) {
+                return outcome::success();
+              }
+              // other message with same nonce replaces pending ones
+              UnsignedMessage message;
+              if (bls) {
+                OUTCOME_TRYA(message, ipld->getCbor<UnsignedMessage>(cid));
               } else {
-                OUTCOME_TRY(add(message));
+                OUTCOME_TRY(signed_message, ipld->getCbor<SignedMessage>(cid));
+                message = std::move(signed_message.message);
+              }
+              if (messages.nextNonce(message.from)) {
+                auto &next{included[message.from]};
+                next = std::max(next, message.nonce + 1);
               }
+              return outcome::success();
             }
+            SignedMessage message;
+            if (bls) {
+              auto sig{bls_cache.find(key)};
+              if (!sig) {
+                return outcome::success();
+              }
+              OUTCOME_TRYA(message.message,
+                           ipld->getCbor<UnsignedMessage>(cid));
+              message.signature = *sig;
+            } else {
+              OUTCOME_TRYA(message, ipld->getCbor<SignedMessage>(cid));
+            }
+            insert(message, cid);
+            updates.push_back({MpoolUpdate::Type::ADD, std::move(message)});
             return outcome::success();
           }));
-      if (apply) {
-        head = change.value;
+      last = &change;
+    }
+    trim();
+    if (last) {
+      if (last->type == HeadChangeType::REVERT) {
+        OUTCOME_TRY(parent, last->value.loadParent(*ipld));
+        setHead(std::move(parent));
       } else {
-        OUTCOME_TRYA(head, change.value.loadParent(*ipld));
+        setHead(last->value);
       }
     }
+    publish(updates);
     return outcome::success();
   }
 }  // namespace fc::storage::mpool
@@ -6,18 +6,35 @@
 #ifndef CPP_FILECOIN_CORE_STORAGE_MPOOL_MPOOL_HPP
 #define CPP_FILECOIN_CORE_STORAGE_MPOOL_MPOOL_HPP
 
+#include "common/generational_map.hpp"
+#include "crypto/bls/impl/batch_verifier.hpp"
+#include "metrics/memory.hpp"
+#include "primitives/cid/cb_cid.hpp"
 #include "storage/chain/chain_store.hpp"
-#include "vm/message/message.hpp"
+#include "storage/mpool/journal.hpp"
+#include "storage/mpool/pending.hpp"
+#include "vm/message/impl/secp_verifier.hpp"
 
 namespace fc::storage::mpool {
+  using crypto::bls::BatchVerifier;
   using crypto::signature::Signature;
   using primitives::address::Address;
   using primitives::tipset::HeadChange;
   using primitives::tipset::Tipset;
   using storage::blockchain::ChainStore;
+  using vm::message::SecpVerifier;
   using vm::message::SignedMessage;
   using connection_t = boost::signals2::connection;
 
+  /// Max number of messages in block
+  constexpr size_t kBlockMessageLimit{512};
+  /// Max sum of message gas limits in block
+  constexpr GasAmount kBlockGasLimit{100000000};
+  /// Bls signatures kept per generation, older unused ones are evicted
+  constexpr size_t kBlsCacheGeneration{1 << 16};
+  /// Journal is compacted when it has more records than this and twice pool
+  constexpr size_t kJournalCompactRecords{1 << 14};
+
   struct MpoolUpdate {
     enum class Type : int64_t { ADD, REMOVE };
 
@@ -26,31 +43,94 @@ namespace fc::storage::mpool {
   };
 
   struct Mpool : public std::enable_shared_from_this<Mpool> {
-    struct Pending {
-      std::map<uint64_t, SignedMessage> by_nonce;
-      uint64_t nonce;
-    };
     using Subscriber = void(const MpoolUpdate &);
+    using BatchSubscriber = void(const std::vector<MpoolUpdate> &);
+
+    using AddCallback = std::function<void(outcome::result<void>)>;
 
-    explicit Mpool(IpldPtr ipld);
+    Mpool(IpldPtr ipld,
+          std::shared_ptr<BatchVerifier> bls_verifier,
+          std::shared_ptr<SecpVerifier> secp_verifier);
     static std::shared_ptr<Mpool> create(
-        IpldPtr ipld, std::shared_ptr<ChainStore> chain_store);
+        IpldPtr ipld,
+        std::shared_ptr<ChainStore> chain_store,
+        std::shared_ptr<BatchVerifier> bls_verifier = nullptr,
+        std::shared_ptr<SecpVerifier> secp_verifier = nullptr);
     std::vector<SignedMessage> pending() const;
+    /**
+     * Selects messages for block mined on tipset
+     * @param ts - parent of block, actor view is cached for current head
+     */
+    outcome::result<std::vector<SignedMessage>> select(const Tipset &ts) const;
     outcome::result<uint64_t> nonce(const Address &from) const;
+    /// Adds message, secp signature of key address sender is checked if
+    /// secp verifier is set
     outcome::result<void> add(const SignedMessage &message);
+    /**
+     * Adds message received from network.
+     * Bls signatures of key address senders are checked in batches by
+     * verifier, secp signatures are checked on verifier pool, if set.
+     */
+    void addGossip(const SignedMessage &message, AddCallback callback);
     void remove(const Address &from, uint64_t nonce);
     outcome::result<void> onHeadChange(const HeadChange &change);
+    /**
+     * Restores messages pending before restart and records further updates
+     * to journal. Messages with nonce below sender nonce at head were
+     * included while node was stopped and are dropped, journal is compacted
+     * to restored messages.
+     * Called once after create, when head is known.
+     */
+    outcome::result<void> restore(std::shared_ptr<MpoolJournal> journal);
+    /**
+     * Applies head changes in one pass.
+     * Included messages are matched by cid against pool index first, other
+     * ones are loaded only while pool is not empty, and pending messages of
+     * their senders below included nonce are dropped. Each sender chain is
+     * trimmed once per run of applied tipsets. Reverted messages are already
+     * stored, so they are not stored again. Updates are published as one
+     * batch.
+     */
+    outcome::result<void> onHeadChanges(gsl::span<const HeadChange> changes);
     connection_t subscribe(const std::function<Subscriber> &subscriber) {
       return signal.connect(subscriber);
     }
+    /// Subscribes to updates in batches, one batch per add or head change
+    connection_t subscribeBatch(
+        const std::function<BatchSubscriber> &subscriber) {
+      return batch_signal.connect(subscriber);
+    }
 
    private:
+    outcome::result<ActorView> actor(const Address &address) const;
+    void setHead(Tipset ts);
+    /// Stores message and bls signature, returns cid to index message by
+    outcome::result<CID> store(const SignedMessage &message);
+    /// Adds message with its cid, cid of bls message is cid of unsigned one
+    void insert(const SignedMessage &message, const CID &cid);
+    void unindex(const Address &from, uint64_t nonce);
+    void publish(const std::vector<MpoolUpdate> &updates);
+    void journalUpdates(const std::vector<MpoolUpdate> &updates);
+
     IpldPtr ipld;
+    std::shared_ptr<BatchVerifier> bls_verifier;
+    std::shared_ptr<SecpVerifier> secp_verifier;
     ChainStore::connection_t head_sub;
     Tipset head;
-    std::map<Address, Pending> by_from;
-    std::map<CID, Signature> bls_cache;
+    PendingMessages messages;
+    /// State of head, computed on first use
+    mutable boost::optional<CID> head_state;
+    /// Actors at head state, reset on head change
+    mutable std::map<Address, ActorView> actors;
+    /// Signatures of bls messages, kept after inclusion for reverts
+    common::GenerationalMap<CidKey, Signature> bls_cache{kBlsCacheGeneration};
+    /// Sender and nonce of pending messages by cid
+    std::unordered_map<CidKey, std::pair<Address, uint64_t>> by_cid;
+    std::map<std::pair<Address, uint64_t>, CidKey> cid_of;
+    std::shared_ptr<MpoolJournal> journal;
     boost::signals2::signal<Subscriber> signal;
+    boost::signals2::signal<BatchSubscriber> batch_signal;
+    metrics::MemoryShare memory{"mpool"};
   };
 }  // namespace fc::storage::mpool
 
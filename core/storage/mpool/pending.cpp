@@ -0,0 +1,184 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/mpool/pending.hpp"
+
+#include <deque>
+#include <queue>
+
+namespace fc::storage::mpool {
+  bool PendingMessages::Score::operator<(const Score &other) const {
+    if (gas_price != other.gas_price) {
+      return gas_price > other.gas_price;
+    }
+    return from < other.from;
+  }
+
+  void PendingMessages::add(const SignedMessage &message) {
+    auto &from{message.message.from};
+    auto &chain{chains_[from]};
+    unindex(from, chain);
+    auto inserted{chain.insert_or_assign(message.message.nonce, message)};
+    if (inserted.second) {
+      ++size_;
+    }
+    index(from, chain);
+  }
+
+  boost::optional<SignedMessage> PendingMessages::remove(const Address &from,
+                                                         uint64_t nonce) {
+    auto chain_it{chains_.find(from)};
+    if (chain_it == chains_.end()) {
+      return boost::none;
+    }
+    auto &chain{chain_it->second};
+    auto it{chain.find(nonce)};
+    if (it == chain.end()) {
+      return boost::none;
+    }
+    unindex(from, chain);
+    auto message{std::move(it->second)};
+    chain.erase(it);
+    --size_;
+    if (chain.empty()) {
+      chains_.erase(chain_it);
+    } else {
+      index(from, chain);
+    }
+    return message;
+  }
+
+  std::vector<SignedMessage> PendingMessages::removeBelow(const Address &from,
+                                                         uint64_t nonce) {
+    std::vector<SignedMessage> removed;
+    auto chain_it{chains_.find(from)};
+    if (chain_it == chains_.end()) {
+      return removed;
+    }
+    auto &chain{chain_it->second};
+    auto end{chain.lower_bound(nonce)};
+    if (end == chain.begin()) {
+      return removed;
+    }
+    unindex(from, chain);
+    for (auto it{chain.begin()}; it != end; ++it) {
+      removed.push_back(std::move(it->second));
+    }
+    chain.erase(chain.begin(), end);
+    size_ -= removed.size();
+    if (chain.empty()) {
+      chains_.erase(chain_it);
+    } else {
+      index(from, chain);
+    }
+    return removed;
+  }
+
+  boost::optional<uint64_t> PendingMessages::nextNonce(
+      const Address &from) const {
+    auto it{chains_.find(from)};
+    if (it == chains_.end()) {
+      return boost::none;
+    }
+    return it->second.rbegin()->first + 1;
+  }
+
+  size_t PendingMessages::size() const {
+    return size_;
+  }
+
+  std::vector<SignedMessage> PendingMessages::all() const {
+    std::vector<SignedMessage> messages;
+    messages.reserve(size_);
+    for (auto &[from, chain] : chains_) {
+      for (auto &[nonce, message] : chain) {
+        messages.push_back(message);
+      }
+    }
+    return messages;
+  }
+
+  outcome::result<std::vector<SignedMessage>> PendingMessages::select(
+      const ActorLookup &actors,
+      const SelectLimits &limits,
+      const Filter &filter) const {
+    /// Next message of sender chain with remaining actor state
+    struct Cursor {
+      const Score *score;
+      Chain::const_iterator it;
+      Chain::const_iterator end;
+      ActorView actor;
+    };
+    // continuations of taken chains, ordered same as heads
+    auto less{[](const Cursor &lhs, const Cursor &rhs) {
+      return *rhs.score < *lhs.score;
+    }};
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(less)> next{
+        less};
+    // heads index owns scores of chain heads, continuations own theirs
+    std::deque<Score> scores;
+
+    std::vector<SignedMessage> selected;
+    auto gas{limits.gas};
+    auto head{heads_.begin()};
+    while (selected.size() < limits.messages) {
+      Cursor cursor;
+      if (head != heads_.end()
+          && (next.empty() || !(*next.top().score < *head))) {
+        auto &chain{chains_.at(head->from)};
+        OUTCOME_TRY(actor, actors(head->from));
+        cursor = {&*head, chain.begin(), chain.end(), std::move(actor)};
+        ++head;
+        // skip messages already applied by parent
+        cursor.it = chain.lower_bound(cursor.actor.nonce);
+        if (cursor.it != chain.begin() && cursor.it != chain.end()) {
+          cursor.score =
+              &scores.emplace_back(Score{cursor.it->second.message.gasPrice,
+                                         cursor.it->second.message.from});
+          next.push(std::move(cursor));
+          continue;
+        }
+      } else if (!next.empty()) {
+        cursor = next.top();
+        next.pop();
+      } else {
+        break;
+      }
+      if (cursor.it == cursor.end) {
+        continue;
+      }
+      auto &message{cursor.it->second};
+      auto &msg{message.message};
+      if (msg.nonce != cursor.actor.nonce || msg.gasLimit > gas
+          || cursor.actor.balance < msg.requiredFunds() || !filter(message)) {
+        continue;
+      }
+      selected.push_back(message);
+      gas -= msg.gasLimit;
+      cursor.actor.balance -= msg.requiredFunds();
+      ++cursor.actor.nonce;
+      ++cursor.it;
+      if (cursor.it != cursor.end) {
+        cursor.score =
+            &scores.emplace_back(Score{cursor.it->second.message.gasPrice,
+                                       cursor.it->second.message.from});
+        next.push(std::move(cursor));
+      }
+    }
+    return selected;
+  }
+
+  void PendingMessages::unindex(const Address &from, const Chain &chain) {
+    if (!chain.empty()) {
+      heads_.erase({chain.begin()->second.message.gasPrice, from});
+    }
+  }
+
+  void PendingMessages::index(const Address &from, const Chain &chain) {
+    if (!chain.empty()) {
+      heads_.insert({chain.begin()->second.message.gasPrice, from});
+    }
+  }
+}  // namespace fc::storage::mpool
@@ -0,0 +1,93 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_STORAGE_MPOOL_PENDING_HPP
+#define CPP_FILECOIN_CORE_STORAGE_MPOOL_PENDING_HPP
+
+#include <map>
+#include <set>
+
+#include "vm/message/message.hpp"
+
+namespace fc::storage::mpool {
+  using primitives::BigInt;
+  using primitives::GasAmount;
+  using primitives::TokenAmount;
+  using primitives::address::Address;
+  using vm::message::SignedMessage;
+
+  /// Nonce and balance of sender at head
+  struct ActorView {
+    uint64_t nonce{};
+    TokenAmount balance;
+  };
+
+  /// Limits of messages selected for block
+  struct SelectLimits {
+    size_t messages;
+    GasAmount gas;
+  };
+
+  /**
+   * Pending messages grouped in per-sender chains ordered by nonce.
+   * Chain heads (lowest nonce messages) are indexed by gas price, so block
+   * selection visits senders in price order without sorting whole pool.
+   */
+  class PendingMessages {
+   public:
+    using ActorLookup =
+        std::function<outcome::result<ActorView>(const Address &)>;
+    using Filter = std::function<bool(const SignedMessage &)>;
+
+    /// Adds message, replaces message with same sender and nonce
+    void add(const SignedMessage &message);
+
+    /// Removes message by sender and nonce, returns removed message
+    boost::optional<SignedMessage> remove(const Address &from, uint64_t nonce);
+
+    /// Removes messages of sender with nonce below given, in one chain update
+    std::vector<SignedMessage> removeBelow(const Address &from, uint64_t nonce);
+
+    /// Nonce following highest pending nonce of sender
+    boost::optional<uint64_t> nextNonce(const Address &from) const;
+
+    size_t size() const;
+
+    std::vector<SignedMessage> all() const;
+
+    /**
+     * Selects messages for block in gas price order.
+     * Each sender contributes nonce-contiguous prefix of its chain starting
+     * from actor nonce, while actor balance covers required funds.
+     * @param actors - actor view at block parent, called once per sender
+     * @param limits - block message and gas limits
+     * @param filter - messages not passing filter end chain of sender
+     */
+    outcome::result<std::vector<SignedMessage>> select(
+        const ActorLookup &actors,
+        const SelectLimits &limits,
+        const Filter &filter) const;
+
+   private:
+    using Chain = std::map<uint64_t, SignedMessage>;
+
+    /// Chain head ordering, higher gas price first
+    struct Score {
+      BigInt gas_price;
+      Address from;
+
+      bool operator<(const Score &other) const;
+    };
+
+    void unindex(const Address &from, const Chain &chain);
+    void index(const Address &from, const Chain &chain);
+
+    std::map<Address, Chain> chains_;
+    std::set<Score> heads_;
+    size_t size_{};
+  };
+}  // namespace fc::storage::mpool
+
+#endif  // CPP_FILECOIN_CORE_STORAGE_MPOOL_PENDING_HPP
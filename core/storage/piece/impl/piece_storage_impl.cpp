@@ -4,6 +4,9 @@
  */
 
 #include "storage/piece/impl/piece_storage_impl.hpp"
+
+#include <algorithm>
+
 #include "codec/cbor/cbor.hpp"
 
 namespace fc::storage::piece {
@@ -28,66 +31,104 @@ namespace fc::storage::piece {
 
   PieceStorageImpl::PieceStorageImpl(
       std::shared_ptr<PersistentMap> storage_backend)
-      : storage_{std::move(storage_backend)} {}
+      : storage_{std::move(storage_backend)} {
+    // loading failure only disables filter, lookups go to storage
+    payload_filter_loaded_ = !loadPayloadFilter().has_error();
+  }
 
   outcome::result<void> PieceStorageImpl::addDealForPiece(
       const CID &piece_cid, const DealInfo &deal_info) {
-    OUTCOME_TRY(storage_key,
-                PieceStorageImpl::makeKey(kPiecePrefix, piece_cid));
-    PieceInfo piece_info{.piece_cid = piece_cid, .deals = {}};
-    if (storage_->contains(storage_key)) {
-      OUTCOME_TRYA(piece_info, getPieceInfo(piece_cid));
-    }
-    piece_info.deals.push_back(deal_info);
-    OUTCOME_TRY(value, codec::cbor::encode(piece_info));
+    OUTCOME_TRY(storage_key, makeIndexKey(kPieceDealPrefix, piece_cid));
+    storage_key.putUint64(deal_info.deal_id);
+    storage_key.putUint64(deal_info.sector_id);
+    OUTCOME_TRY(value, codec::cbor::encode(deal_info));
     OUTCOME_TRY(storage_->put(storage_key, value));
+    piece_cache_.remove(piece_cid);
+    ++generation_;
     return outcome::success();
   }
 
   outcome::result<PieceInfo> PieceStorageImpl::getPieceInfo(
       const CID &piece_cid) const {
+    if (auto cached{piece_cache_.get(piece_cid)}) {
+      return std::move(*cached);
+    }
+    PieceInfo piece_info{.piece_cid = piece_cid, .deals = {}};
     OUTCOME_TRY(storage_key,
                 PieceStorageImpl::makeKey(kPiecePrefix, piece_cid));
-    if (!storage_->contains(storage_key)) {
+    if (storage_->contains(storage_key)) {
+      OUTCOME_TRY(value, storage_->get(storage_key));
+      OUTCOME_TRYA(piece_info, codec::cbor::decode<PieceInfo>(value));
+    }
+    OUTCOME_TRY(scan(kPieceDealPrefix,
+                     piece_cid,
+                     [&](auto, auto &value) -> outcome::result<void> {
+                       OUTCOME_TRY(deal_info,
+                                   codec::cbor::decode<DealInfo>(value));
+                       piece_info.deals.push_back(std::move(deal_info));
+                       return outcome::success();
+                     }));
+    if (piece_info.deals.empty()) {
       return PieceStorageError::kPieceNotFound;
     }
-    OUTCOME_TRY(value, storage_->get(storage_key));
-    OUTCOME_TRY(piece_info, codec::cbor::decode<PieceInfo>(value));
+    piece_cache_.put(piece_cid, piece_info);
     return std::move(piece_info);
   }
 
   outcome::result<PayloadInfo> PieceStorageImpl::getPayloadInfo(
       const CID &payload_cid) const {
+    if (auto cached{payload_cache_.get(payload_cid)}) {
+      return std::move(*cached);
+    }
+    PayloadInfo payload_info{.cid = payload_cid, .piece_block_locations = {}};
     OUTCOME_TRY(storage_key,
                 PieceStorageImpl::makeKey(kLocationPrefix, payload_cid));
-    if (!storage_->contains(storage_key)) {
+    if (storage_->contains(storage_key)) {
+      OUTCOME_TRY(buffer, storage_->get(storage_key));
+      OUTCOME_TRYA(payload_info, codec::cbor::decode<PayloadInfo>(buffer));
+    }
+    OUTCOME_TRY(scan(kPayloadIndexPrefix,
+                     payload_cid,
+                     [&](auto suffix, auto &value) -> outcome::result<void> {
+                       OUTCOME_TRY(parent_piece, CID::fromBytes(suffix));
+                       OUTCOME_TRY(location,
+                                   codec::cbor::decode<PayloadLocation>(value));
+                       payload_info.piece_block_locations.push_back(
+                           {std::move(parent_piece), location});
+                       return outcome::success();
+                     }));
+    if (payload_info.piece_block_locations.empty()) {
       return PieceStorageError::kPayloadNotFound;
     }
-    OUTCOME_TRY(buffer, storage_->get(storage_key));
-    OUTCOME_TRY(payload_info, codec::cbor::decode<PayloadInfo>(buffer));
+    payload_cache_.put(payload_cid, payload_info);
     return std::move(payload_info);
   }
 
   outcome::result<void> PieceStorageImpl::addPayloadLocations(
       const CID &parent_piece, std::map<CID, PayloadLocation> locations) {
+    OUTCOME_TRY(piece_bytes, parent_piece.toBytes());
+    auto batch{storage_->batch()};
     for (auto &&[payload_cid, location] : locations) {
-      OUTCOME_TRY(storage_key,
-                  PieceStorageImpl::makeKey(kLocationPrefix, payload_cid));
-      PayloadInfo payload_info{.cid = payload_cid, .piece_block_locations = {}};
-      if (storage_->contains(storage_key)) {
-        OUTCOME_TRYA(payload_info, getPayloadInfo(payload_cid));
-      }
-      PayloadBlockInfo payload_block_info{.parent_piece = parent_piece,
-                                          .block_location = location};
-      payload_info.piece_block_locations.push_back(payload_block_info);
-      OUTCOME_TRY(value, codec::cbor::encode(payload_info));
-      OUTCOME_TRY(storage_->put(storage_key, value));
+      OUTCOME_TRY(storage_key, makeIndexKey(kPayloadIndexPrefix, payload_cid));
+      storage_key.put(piece_bytes);
+      OUTCOME_TRY(value, codec::cbor::encode(location));
+      OUTCOME_TRY(batch->put(storage_key, value));
+    }
+    OUTCOME_TRY(batch->commit());
+    for (auto &&[payload_cid, location] : locations) {
+      OUTCOME_TRY(payload_bytes, payload_cid.toBytes());
+      payload_filter_.insert(payload_bytes);
+      payload_cache_.remove(payload_cid);
     }
+    ++generation_;
     return outcome::success();
   }
 
   outcome::result<PieceInfo> PieceStorageImpl::getPieceInfoFromCid(
       const CID &payload_cid, const boost::optional<CID> &piece_cid) const {
+    if (!mayHavePayload(payload_cid)) {
+      return PieceStorageError::kPayloadNotFound;
+    }
     OUTCOME_TRY(cid_info, getPayloadInfo(payload_cid));
     for (auto &&block_location : cid_info.piece_block_locations) {
       OUTCOME_TRY(piece_info, getPieceInfo(block_location.parent_piece));
@@ -100,11 +141,17 @@ namespace fc::storage::piece {
 
   outcome::result<bool> PieceStorageImpl::hasPieceInfo(
       CID payload_cid, const boost::optional<CID> &piece_cid) const {
+    if (!mayHavePayload(payload_cid)) {
+      return false;
+    }
     auto piece_info_res = getPieceInfoFromCid(payload_cid, piece_cid);
     if (piece_info_res.has_error()
-        && piece_info_res.error() == PieceStorageError::kPieceNotFound) {
+        && (piece_info_res.error() == PieceStorageError::kPieceNotFound
+            || piece_info_res.error()
+                   == PieceStorageError::kPayloadNotFound)) {
       return false;
     }
+    OUTCOME_TRY(piece_info_res);
     return !piece_info_res.value().deals.empty();
   }
 
@@ -117,6 +164,78 @@ namespace fc::storage::piece {
     return PieceStorageError::kPieceNotFound;
   }
 
+  uint64_t PieceStorageImpl::generation() const {
+    return generation_;
+  }
+
+  bool PieceStorageImpl::mayHavePayload(const CID &payload_cid) const {
+    if (!payload_filter_loaded_) {
+      return true;
+    }
+    auto payload_bytes{payload_cid.toBytes()};
+    return !payload_bytes || payload_filter_.mayContain(payload_bytes.value());
+  }
+
+  outcome::result<void> PieceStorageImpl::loadPayloadFilter() {
+    Buffer index_prefix;
+    index_prefix.put(kPayloadIndexPrefix);
+    Buffer location_prefix;
+    location_prefix.put(kLocationPrefix);
+    auto starts{[](const Buffer &key, const Buffer &prefix) {
+      return key.size() >= prefix.size()
+             && std::equal(prefix.begin(), prefix.end(), key.begin());
+    }};
+    auto cursor{storage_->cursor()};
+    for (cursor->seek(index_prefix);
+         cursor->isValid() && starts(cursor->key(), index_prefix);
+         cursor->next()) {
+      // prefix-free cid bytes are followed by parent piece cid bytes
+      auto key{cursor->key()};
+      auto input{gsl::span<const uint8_t>{key}.subspan(index_prefix.size())};
+      auto payload_bytes{input};
+      OUTCOME_TRY(CID::read(input));
+      payload_filter_.insert(
+          payload_bytes.first(payload_bytes.size() - input.size()));
+    }
+    for (cursor->seek(location_prefix);
+         cursor->isValid() && starts(cursor->key(), location_prefix);
+         cursor->next()) {
+      auto key{cursor->key()};
+      OUTCOME_TRY(payload_cid,
+                  CID::fromString(std::string{
+                      key.begin() + location_prefix.size(), key.end()}));
+      OUTCOME_TRY(payload_bytes, payload_cid.toBytes());
+      payload_filter_.insert(payload_bytes);
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> PieceStorageImpl::scan(const std::string &prefix,
+                                               const CID &cid,
+                                               const Visitor &visitor) const {
+    OUTCOME_TRY(key_prefix, makeIndexKey(prefix, cid));
+    auto cursor{storage_->cursor()};
+    for (cursor->seek(key_prefix); cursor->isValid(); cursor->next()) {
+      auto key{cursor->key()};
+      if (key.size() < key_prefix.size()
+          || !std::equal(key_prefix.begin(), key_prefix.end(), key.begin())) {
+        break;
+      }
+      OUTCOME_TRY(visitor(gsl::make_span(key).subspan(key_prefix.size()),
+                          cursor->value()));
+    }
+    return outcome::success();
+  }
+
+  outcome::result<Buffer> PieceStorageImpl::makeIndexKey(
+      const std::string &prefix, const CID &cid) {
+    OUTCOME_TRY(cid_bytes, cid.toBytes());
+    Buffer key;
+    key.put(prefix);
+    key.put(cid_bytes);
+    return key;
+  }
+
   outcome::result<Buffer> PieceStorageImpl::makeKey(const std::string &prefix,
                                                     const CID &cid) {
     OUTCOME_TRY(cid_key, cid.toString());
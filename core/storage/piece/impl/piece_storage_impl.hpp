@@ -6,20 +6,43 @@
 #ifndef CPP_FILECOIN_PIECE_STORAGE_IMPL_HPP
 #define CPP_FILECOIN_PIECE_STORAGE_IMPL_HPP
 
+#include <atomic>
 #include <memory>
 #include <string>
 
 #include "codec/cbor/streams_annotation.hpp"
+#include "common/bloom_filter.hpp"
 #include "common/buffer.hpp"
+#include "common/lru_cache.hpp"
 #include "storage/face/persistent_map.hpp"
 #include "storage/piece/impl/piece_storage_error.hpp"
 #include "storage/piece/piece_storage.hpp"
 
 namespace fc::storage::piece {
   using common::Buffer;
+  /// Whole piece and payload records, only read
   const std::string kPiecePrefix = "/storagemarket/pieces/";
   const std::string kLocationPrefix = "/storagemarket/cid-infos/";
-
+  /// Deal of piece under piece cid, deal id and sector bytes
+  const std::string kPieceDealPrefix = "/storagemarket/piece-deals/";
+  /// Location of payload block under payload cid and piece cid bytes
+  const std::string kPayloadIndexPrefix = "/storagemarket/payload-index/";
+  /// Recently used piece and payload infos kept in memory
+  constexpr size_t kPieceStorageCacheSize{4096};
+  /// Bloom filter of held payloads, 1 MiB, about 1% false positives for
+  /// up to 900k payload blocks
+  constexpr size_t kPayloadFilterBits{size_t{1} << 23};
+  constexpr size_t kPayloadFilterHashes{7};
+
+  /**
+   * Piece storage indexed by single deals and block locations. Each deal of
+   * piece and each location of payload block is stored under its own key,
+   * which starts with cid bytes. Cid bytes are prefix-free, so prefix scan
+   * finds all records of cid, and adding record doesn't rewrite others.
+   * Records written as whole infos by previous versions are still read.
+   * Payload cids are kept in bloom filter, filled from storage on
+   * construction, so lookups of payloads not held are answered without IO.
+   */
   class PieceStorageImpl : public PieceStorage {
    protected:
     using PersistentMap = storage::face::PersistentMap<Buffer, Buffer>;
@@ -50,8 +73,37 @@ namespace fc::storage::piece {
     outcome::result<uint64_t> getPieceSize(
         CID payload_cid, const boost::optional<CID> &piece_cid) const override;
 
+    uint64_t generation() const override;
+
+    /// False if payload is surely not held, checked without IO
+    bool mayHavePayload(const CID &payload_cid) const;
+
    private:
+    using Visitor = std::function<outcome::result<void>(
+        gsl::span<const uint8_t> key_suffix, const Buffer &value)>;
+
+    /// Visits records with keys starting with prefix and cid bytes
+    outcome::result<void> scan(const std::string &prefix,
+                               const CID &cid,
+                               const Visitor &visitor) const;
+
+    /// Key of record with prefix and cid bytes
+    static outcome::result<Buffer> makeIndexKey(const std::string &prefix,
+                                                const CID &cid);
+
+    /// Adds payload cids of all stored records to filter
+    outcome::result<void> loadPayloadFilter();
+
     std::shared_ptr<PersistentMap> storage_;
+    mutable common::LruCache<CID, PieceInfo> piece_cache_{
+        kPieceStorageCacheSize};
+    mutable common::LruCache<CID, PayloadInfo> payload_cache_{
+        kPieceStorageCacheSize};
+    common::BloomFilter payload_filter_{kPayloadFilterBits,
+                                        kPayloadFilterHashes};
+    /// Filter is not used until it holds all stored payloads
+    bool payload_filter_loaded_{false};
+    std::atomic_uint64_t generation_{0};
 
     /**
      * @brief Make a byte buffer key from cid with string prefix
@@ -129,6 +129,12 @@ namespace fc::storage::piece {
 
     virtual outcome::result<uint64_t> getPieceSize(
         CID payload_cid, const boost::optional<CID> &piece_cid) const = 0;
+
+    /**
+     * @brief Number of changes, incremented by each added deal or payload
+     * locations, so callers can invalidate what they derived from storage
+     */
+    virtual uint64_t generation() const = 0;
   };
 
 }  // namespace fc::storage::piece
@@ -11,13 +11,18 @@
 #include "crypto/bls/impl/bls_provider_impl.hpp"
 #include "crypto/secp256k1/impl/secp256k1_sha256_provider_impl.hpp"
 #include "crypto/secp256k1/secp256k1_provider.hpp"
+#include "storage/config/storage_config.hpp"
 #include "storage/ipfs/impl/datastore_leveldb.hpp"
+#include "storage/ipfs/impl/mmap_datastore.hpp"
 #include "storage/keystore/impl/filesystem/filesystem_keystore.hpp"
 #include "storage/repository/repository_error.hpp"
 
 using fc::crypto::bls::BlsProviderImpl;
 using fc::crypto::secp256k1::Secp256k1Sha256ProviderImpl;
+using fc::storage::config::StorageConfig;
+using fc::storage::config::Stores;
 using fc::storage::ipfs::LeveldbDatastore;
+using fc::storage::ipfs::MmapDatastore;
 using fc::storage::keystore::FileSystemKeyStore;
 using fc::storage::repository::FileSystemRepository;
 using fc::storage::repository::Repository;
@@ -29,10 +34,12 @@ FileSystemRepository::FileSystemRepository(
     std::shared_ptr<KeyStore> keystore,
     std::shared_ptr<Config> config,
     std::string repository_path,
-    std::unique_ptr<fslock::Locker> fs_locker)
+    std::unique_ptr<fslock::Locker> fs_locker,
+    std::shared_ptr<Stores> stores)
     : Repository{std::move(ipld_store), std::move(keystore), std::move(config)},
       repository_path_{std::move(repository_path)},
-      fs_locker_{std::move(fs_locker)} {}
+      fs_locker_{std::move(fs_locker)},
+      stores_{std::move(stores)} {}
 
 fc::outcome::result<std::shared_ptr<Repository>> FileSystemRepository::create(
     const Path &repo_path,
@@ -84,11 +91,47 @@ fc::outcome::result<std::shared_ptr<Repository>> FileSystemRepository::create(
   version_os << kFileSystemRepositoryVersion << std::endl;
   version_os.close();
 
-  // create datastore
   auto datastore_path =
       repo_path + fc::storage::filestore::DELIMITER + kDatastore;
-  OUTCOME_TRY(ipfs_datastore,
-              LeveldbDatastore::create(datastore_path, leveldb_options));
+  auto storage_config = StorageConfig::load(*config);
+  auto mmap_path = datastore_path + fc::storage::filestore::DELIMITER
+                   + kMmapBlocksFilename;
+  // blocks of other backend would be silently ignored
+  auto has_leveldb = boost::filesystem::exists(
+      datastore_path + fc::storage::filestore::DELIMITER + "CURRENT");
+  auto has_mmap = boost::filesystem::exists(mmap_path);
+  // separate stores, so indexes and market don't share blocks cache
+  OUTCOME_TRY(stores,
+              Stores::open(repo_path + fc::storage::filestore::DELIMITER
+                               + kStoresDirectory,
+                           storage_config,
+                           leveldb_options));
+  std::shared_ptr<IpfsDatastore> ipfs_datastore;
+  if (storage_config.blocks_backend == StorageConfig::kLevelDBBackend) {
+    if (has_mmap) {
+      return RepositoryError::kBackendMismatch;
+    }
+    // create datastore with blocks profile, bloom filter answers most
+    // contains() of missing cids without disk reads
+    OUTCOME_TRY(leveldb,
+                storage_config.blocks.open(datastore_path, leveldb_options));
+    ipfs_datastore = std::make_shared<LeveldbDatastore>(leveldb);
+    stores.blocks = leveldb;
+  } else if (storage_config.blocks_backend == StorageConfig::kMmapBackend) {
+    if (has_leveldb) {
+      return RepositoryError::kBackendMismatch;
+    }
+    // single blocks file in datastore directory, read without copying
+    boost::filesystem::create_directories(datastore_path);
+    auto &mmap_profile = storage_config.blocks_mmap;
+    OUTCOME_TRYA(ipfs_datastore,
+                 MmapDatastore::create(mmap_path,
+                                       {mmap_profile.map_size,
+                                        mmap_profile.sync,
+                                        mmap_profile.sync_bytes}));
+  } else {
+    return RepositoryError::kUnknownBackend;
+  }
 
   // create keystore
   auto keystore_path =
@@ -100,9 +143,18 @@ fc::outcome::result<std::shared_ptr<Repository>> FileSystemRepository::create(
       std::make_shared<Secp256k1Sha256ProviderImpl>());
 
   return std::make_shared<FileSystemRepository>(
-      ipfs_datastore, keystore, config, repo_path, std::move(fs_locker));
+      ipfs_datastore,
+      keystore,
+      config,
+      repo_path,
+      std::move(fs_locker),
+      std::make_shared<Stores>(std::move(stores)));
 }
 
 fc::outcome::result<Version> FileSystemRepository::getVersion() const {
   return kFileSystemRepositoryVersion;
 }
+
+std::shared_ptr<Stores> FileSystemRepository::getStores() const noexcept {
+  return stores_;
+}
@@ -9,6 +9,7 @@
 #include <iostream>
 
 #include "fslock/fslock.hpp"
+#include "storage/config/storage_config.hpp"
 #include "storage/filestore/path.hpp"
 #include "storage/leveldb/leveldb.hpp"
 #include "storage/repository/repository.hpp"
@@ -33,6 +34,7 @@ namespace fc::storage::repository {
    * │   ├── id.pri      <--- identity private key
    * │   └── id.pub      <--- identity public key
    * ├── datastore/      <--- datastore
+   * ├── stores/         <--- indexes and market leveldb stores
    * ├── logs/           <--- 1 or more files (log rotate)
    * │   └── events.log  <--- can be tailed
    * ├── repo.lock       <--- mutex for repo
@@ -45,6 +47,8 @@ namespace fc::storage::repository {
     inline static const std::string kConfigFilename = "config.json";
     inline static const std::string kKeysDirectory = "keys";
     inline static const std::string kDatastore = "datastore";
+    inline static const std::string kMmapBlocksFilename = "blocks.mmap";
+    inline static const std::string kStoresDirectory = "stores";
     inline static const std::string kRepositoryLock = "repo.lock";
     inline static const std::string kVersionFilename = "version";
     inline static const Version kFileSystemRepositoryVersion = 1;
@@ -53,7 +57,8 @@ namespace fc::storage::repository {
                          std::shared_ptr<KeyStore> keystore,
                          std::shared_ptr<Config> config,
                          std::string repository_path,
-                         std::unique_ptr<fslock::Locker> fs_locker);
+                         std::unique_ptr<fslock::Locker> fs_locker,
+                         std::shared_ptr<config::Stores> stores = nullptr);
 
     static outcome::result<std::shared_ptr<Repository>> create(
         const Path &repo_path,
@@ -62,9 +67,13 @@ namespace fc::storage::repository {
 
     outcome::result<Version> getVersion() const override;
 
+    /// Leveldb stores with their profiles, for stats and compactions
+    std::shared_ptr<config::Stores> getStores() const noexcept;
+
    private:
     Path repository_path_;
     std::unique_ptr<fslock::Locker> fs_locker_;
+    std::shared_ptr<config::Stores> stores_;
     inline static common::Logger logger_ = common::createLogger("repository");
   };
 
@@ -13,6 +13,10 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::repository, RepositoryError, e) {
       return "RepositoryError: wrong version";
     case RepositoryError::kOpenFileError:
       return "RepositoryError: cannot open file";
+    case RepositoryError::kUnknownBackend:
+      return "RepositoryError: unknown datastore backend";
+    case RepositoryError::kBackendMismatch:
+      return "RepositoryError: datastore has blocks of other backend";
     default:
       return "RepositoryError: unknown error";
   }
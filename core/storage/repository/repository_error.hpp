@@ -16,6 +16,8 @@ namespace fc::storage::repository {
   enum class RepositoryError {
     kWrongVersion = 1,
     kOpenFileError,
+    kUnknownBackend,
+    kBackendMismatch,
   };
 
 }  // namespace fc::storage::keystore
@@ -5,6 +5,10 @@
 
 #include "storage/unixfs/unixfs.hpp"
 
+#include <unistd.h>
+#include <cerrno>
+#include <thread>
+
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 
@@ -93,14 +97,31 @@ namespace fc::storage::unixfs {
     CID cid;
   };
 
+  /// Builds file node linking children, returns node tree and node bytes
+  std::pair<Tree, Buffer> makeNode(const std::vector<Tree> &children) {
+    Tree root;
+    PbFileBuilder pb_file;
+    PbNodeBuilder pb_node;
+    for (const auto &tree : children) {
+      root.size += tree.size;
+      root.file_size += tree.file_size;
+      pb_file.block(tree.file_size);
+      pb_node.link(tree.cid, tree.size);
+    }
+    pb_node.content(pb_file.toString());
+    auto node = pb_node.toBytes();
+    root.size += node.size();
+    root.cid =
+        CID{CID::Version::V0, CID::Multicodec::DAG_PB, Hasher::sha2_256(node)};
+    return {std::move(root), std::move(node)};
+  }
+
   outcome::result<Tree> makeTree(Ipld &ipld,
                                  size_t height,
                                  gsl::span<const uint8_t> &data,
                                  size_t chunk_size,
                                  size_t max_links) {
-    Tree root;
-    PbFileBuilder pb_file;
-    PbNodeBuilder pb_node;
+    std::vector<Tree> children;
     for (auto i = 0u; i < max_links && !data.empty(); ++i) {
       Tree tree;
       if (height == 1) {
@@ -112,18 +133,11 @@ namespace fc::storage::unixfs {
         OUTCOME_TRYA(tree,
                      makeTree(ipld, height - 1, data, chunk_size, max_links));
       }
-      root.size += tree.size;
-      root.file_size += tree.file_size;
-      pb_file.block(tree.file_size);
-      pb_node.link(std::move(tree.cid), tree.size);
+      children.push_back(std::move(tree));
     }
-    pb_node.content(pb_file.toString());
-    auto node = pb_node.toBytes();
-    root.size += node.size();
-    root.cid =
-        CID{CID::Version::V0, CID::Multicodec::DAG_PB, Hasher::sha2_256(node)};
+    auto [root, node] = makeNode(children);
     OUTCOME_TRY(ipld.set(root.cid, node));
-    return root;
+    return std::move(root);
   }
 
   outcome::result<CID> wrapFile(Ipld &ipld,
@@ -140,4 +154,220 @@ namespace fc::storage::unixfs {
     OUTCOME_TRY(tree, makeTree(ipld, height, data, chunk_size, max_links));
     return std::move(tree.cid);
   }
+
+  namespace {
+    constexpr size_t kRabinWindow{48};
+    constexpr uint64_t kRabinPrime{0x100000001b3};
+
+    constexpr uint64_t rabinPrimePower(size_t power) {
+      uint64_t result{1};
+      for (size_t i = 0; i < power; ++i) {
+        result *= kRabinPrime;
+      }
+      return result;
+    }
+
+    /// Coefficient of byte leaving rolling window
+    constexpr uint64_t kRabinOut{rabinPrimePower(kRabinWindow)};
+
+    /// Reads chunks from file descriptor
+    struct ChunkReader {
+      ChunkReader(int fd, const ImportConfig &config) : fd{fd} {
+        if (config.chunker == Chunker::kRabin) {
+          min = std::max<size_t>(1, config.chunk_size / 3);
+          max = std::max(min, config.chunk_size + config.chunk_size / 2);
+          // chunk is cut with probability 1 / (mask + 1) per byte after min
+          uint64_t average{1};
+          while (average * 2 <= config.chunk_size - min) {
+            average *= 2;
+          }
+          mask = average - 1;
+          rabin = true;
+        } else {
+          min = max = std::max<size_t>(1, config.chunk_size);
+        }
+      }
+
+      /// Reads until max bytes are buffered or file ends
+      outcome::result<void> fill() {
+        if (begin != 0) {
+          buffer.erase(buffer.begin(), buffer.begin() + begin);
+          begin = 0;
+        }
+        while (!eof && buffer.size() < max) {
+          auto size{buffer.size()};
+          buffer.resize(max);
+          auto read{::read(fd, buffer.data() + size, max - size)};
+          if (read < 0) {
+            buffer.resize(size);
+            if (errno == EINTR) {
+              continue;
+            }
+            return UnixfsError::kReadError;
+          }
+          buffer.resize(size + read);
+          eof = read == 0;
+        }
+        return outcome::success();
+      }
+
+      /// Length of next rabin chunk of data
+      size_t rabinCut(gsl::span<const uint8_t> data) const {
+        auto size{static_cast<size_t>(data.size())};
+        if (size <= min) {
+          return size;
+        }
+        uint64_t hash{};
+        auto start{min - std::min(min, kRabinWindow)};
+        for (auto i{start}; i < size; ++i) {
+          hash = hash * kRabinPrime + data[i];
+          if (i >= start + kRabinWindow) {
+            hash -= data[i - kRabinWindow] * kRabinOut;
+          }
+          if (i + 1 >= min && (hash & mask) == mask) {
+            return i + 1;
+          }
+        }
+        return size;
+      }
+
+      /// Next chunk, none at end of file
+      outcome::result<boost::optional<Buffer>> next() {
+        if (buffer.size() - begin < max && !eof) {
+          OUTCOME_TRY(fill());
+        }
+        auto data{gsl::make_span(buffer).subspan(begin)};
+        if (data.empty()) {
+          return boost::none;
+        }
+        auto size{rabin ? rabinCut(data)
+                        : std::min(max, static_cast<size_t>(data.size()))};
+        begin += size;
+        return Buffer{data.subspan(0, size)};
+      }
+
+      int fd;
+      size_t min{}, max{};
+      uint64_t mask{};
+      bool rabin{false};
+      std::vector<uint8_t> buffer;
+      /// Start of unconsumed bytes in buffer
+      size_t begin{};
+      bool eof{false};
+    };
+
+    /**
+     * Builds balanced tree bottom up. Level is turned into node only when
+     * it is full and next link comes, or at the end, so tree has same shape
+     * as one built top down for known size.
+     */
+    struct Layout {
+      void add(size_t level, Tree tree) {
+        if (levels.size() == level) {
+          levels.emplace_back();
+        }
+        if (levels[level].size() == max_links) {
+          add(level + 1, flush(level));
+        }
+        levels[level].push_back(std::move(tree));
+      }
+
+      Tree flush(size_t level) {
+        auto [tree, node] = makeNode(levels[level]);
+        levels[level].clear();
+        nodes.emplace_back(tree.cid, std::move(node));
+        return std::move(tree);
+      }
+
+      /// Root of tree, single leaf is root itself
+      Tree finish() {
+        for (size_t level = 0; level + 1 < levels.size(); ++level) {
+          if (!levels[level].empty()) {
+            add(level + 1, flush(level));
+          }
+        }
+        auto &top{levels.back()};
+        if (levels.size() == 1 && top.size() == 1) {
+          return top.front();
+        }
+        return flush(levels.size() - 1);
+      }
+
+      size_t max_links;
+      std::vector<std::vector<Tree>> levels;
+      /// Nodes built and not written yet
+      Ipld::Batch nodes;
+    };
+  }  // namespace
+
+  outcome::result<CID> importFile(Ipld &ipld,
+                                  int fd,
+                                  const ImportConfig &config) {
+    auto threads{config.threads};
+    if (threads == 0) {
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const auto batch_chunks{std::max<size_t>(1, config.batch_chunks)};
+    ChunkReader reader{fd, config};
+    Layout layout{std::max<size_t>(2, config.max_links), {}, {}};
+
+    std::vector<Buffer> chunks;
+    std::vector<boost::optional<CID>> cids;
+    while (true) {
+      chunks.clear();
+      while (chunks.size() < batch_chunks) {
+        OUTCOME_TRY(chunk, reader.next());
+        if (!chunk) {
+          break;
+        }
+        chunks.push_back(std::move(*chunk));
+      }
+      if (chunks.empty()) {
+        break;
+      }
+
+      cids.assign(chunks.size(), boost::none);
+      auto hash{[&](size_t first) {
+        for (auto i{first}; i < chunks.size(); i += threads) {
+          cids[i] = CID{CID::Version::V1,
+                        CID::Multicodec::RAW,
+                        Hasher::sha2_256(chunks[i])};
+        }
+      }};
+      std::vector<std::thread> workers;
+      for (size_t i = 1; i < std::min(threads, chunks.size()); ++i) {
+        workers.emplace_back(hash, i);
+      }
+      hash(0);
+      for (auto &worker : workers) {
+        worker.join();
+      }
+
+      Ipld::Batch batch{std::move(layout.nodes)};
+      layout.nodes.clear();
+      for (size_t i = 0; i < chunks.size(); ++i) {
+        auto size{chunks[i].size()};
+        layout.add(0, {size, size, *cids[i]});
+        batch.emplace_back(std::move(*cids[i]), std::move(chunks[i]));
+      }
+      OUTCOME_TRY(ipld.setMany(std::move(batch)));
+    }
+
+    if (layout.levels.empty()) {
+      return makeLeaf(ipld, {});
+    }
+    auto root{layout.finish()};
+    OUTCOME_TRY(ipld.setMany(std::move(layout.nodes)));
+    return std::move(root.cid);
+  }
 }  // namespace fc::storage::unixfs
+
+OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::unixfs, UnixfsError, e) {
+  using fc::storage::unixfs::UnixfsError;
+  switch (e) {
+    case UnixfsError::kReadError:
+      return "UnixfsError: cannot read file";
+    default:
+      return "UnixfsError: unknown error";
+  }
+}
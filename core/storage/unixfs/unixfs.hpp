@@ -13,11 +13,48 @@ namespace fc::storage::unixfs {
 
   constexpr size_t kMaxLinks = 1024;
   constexpr size_t kChunkSize = 1024;
+  /// Default chunk size of file import
+  constexpr size_t kImportChunkSize = 256 << 10;
 
   outcome::result<CID> wrapFile(Ipld &ipld,
                                 gsl::span<const uint8_t> data,
                                 size_t chunk_size = kChunkSize,
                                 size_t max_links = kMaxLinks);
+
+  enum class Chunker {
+    /// Chunks of chunk size
+    kFixed,
+    /// Content defined chunks of average chunk size, from chunk_size / 3 to
+    /// chunk_size * 3 / 2, cut by rabin fingerprint of rolling window
+    kRabin,
+  };
+
+  struct ImportConfig {
+    Chunker chunker{Chunker::kFixed};
+    size_t chunk_size{kImportChunkSize};
+    size_t max_links{kMaxLinks};
+    /// Chunks hashed in parallel and written to datastore in one batch
+    size_t batch_chunks{64};
+    /// Hashing threads, 0 uses hardware concurrency
+    size_t threads{};
+  };
+
+  /**
+   * Imports file read from descriptor as balanced unixfs tree. File is read
+   * in batches of chunks, so it is not loaded into memory at once. With
+   * fixed chunker, result is same as of wrapFile with same parameters.
+   * @param fd - file descriptor, read until end
+   * @return root cid
+   */
+  outcome::result<CID> importFile(Ipld &ipld,
+                                  int fd,
+                                  const ImportConfig &config = {});
+
+  enum class UnixfsError {
+    kReadError = 1,
+  };
 }  // namespace fc::storage::unixfs
 
+OUTCOME_HPP_DECLARE_ERROR(fc::storage::unixfs, UnixfsError);
+
 #endif  // CPP_FILECOIN_CORE_STORAGE_UNIXFS_UNIXFS_HPP
@@ -47,17 +47,20 @@ namespace fc::vm::actor {
     static constexpr MethodNumber Number{number};
   };
 
+  /// Decodes params, calls method directly and encodes its result
+  template <typename M>
+  outcome::result<InvocationOutput> invokeMethod(Runtime &runtime,
+                                                 const MethodParams &params) {
+    OUTCOME_TRY(params2, decodeActorParams<typename M::Params>(params));
+    OUTCOME_TRY(result, M::call(runtime, params2));
+    return encodeActorReturn(result);
+  }
+
   /// Generate export table entry
   template <typename M>
   auto exportMethod() {
-    return std::make_pair(
-        M::Number,
-        ActorMethod{[](auto &runtime,
-                       auto &params) -> outcome::result<InvocationOutput> {
-          OUTCOME_TRY(params2, decodeActorParams<typename M::Params>(params));
-          OUTCOME_TRY(result, M::call(runtime, params2));
-          return encodeActorReturn(result);
-        }});
+    // plain function is stored in place by std::function, no closure
+    return std::make_pair(M::Number, ActorMethod{&invokeMethod<M>});
   }
 }  // namespace fc::vm::actor
 
@@ -313,6 +313,34 @@ namespace fc::vm::actor::builtin::market {
     return runtime.computeUnsealedSectorCid(params.sector_type, pieces);
   }
 
+  /// Longest cron gap scanned by epoch lookups, longer one visits whole map
+  constexpr ChainEpoch kCronEpochLookupsMax{kDealUpdatesInterval};
+
+  /// Deal sets of epochs in (last cron, now], in epoch order
+  outcome::result<std::map<ChainEpoch, State::DealSet>> dueDealSets(
+      State &state, ChainEpoch now) {
+    std::map<ChainEpoch, State::DealSet> sets;
+    if (now - state.last_cron > kCronEpochLookupsMax) {
+      // deal sets are kept only for near epochs, so map is smaller than gap
+      OUTCOME_TRY(state.deals_by_epoch.visit(
+          [&](auto key, auto &set) -> outcome::result<void> {
+            auto epoch{static_cast<ChainEpoch>(key)};
+            if (epoch > state.last_cron && epoch <= now) {
+              sets.emplace(epoch, set);
+            }
+            return outcome::success();
+          }));
+    } else {
+      for (auto epoch{state.last_cron + 1}; epoch <= now; ++epoch) {
+        OUTCOME_TRY(set, state.deals_by_epoch.tryGet(epoch));
+        if (set) {
+          sets.emplace(epoch, std::move(*set));
+        }
+      }
+    }
+    return std::move(sets);
+  }
+
   ACTOR_METHOD_IMPL(CronTick) {
     OUTCOME_TRY(runtime.validateImmediateCallerIs(kCronAddress));
     auto now{runtime.getCurrentEpoch()};
@@ -320,38 +348,74 @@ namespace fc::vm::actor::builtin::market {
     TokenAmount slashed_sum;
     std::map<ChainEpoch, std::vector<DealId>> next_updates;
     std::vector<DealProposal> timed_out_verified;
-    for (auto epoch{state.last_cron + 1}; epoch <= now; ++epoch) {
-      OUTCOME_TRY(set, state.deals_by_epoch.tryGet(epoch));
-      if (set) {
-        auto visitor{[&](auto deal_id, auto) -> outcome::result<void> {
-          OUTCOME_TRY(deal_state, state.states.tryGet(deal_id));
-          if (deal_state) {
-            OUTCOME_TRY(deal, state.proposals.get(deal_id));
-            if (deal_state->sector_start_epoch == kChainEpochUndefined) {
-              VM_ASSERT(now >= deal.start_epoch);
-              OUTCOME_TRY(slashed,
-                          processDealInitTimedOut(state, deal_id, deal));
-              slashed_sum += slashed;
-              if (deal.verified) {
-                timed_out_verified.push_back(deal);
-              }
-            } else {
-              OUTCOME_TRY(slashed_next,
-                          updatePendingDealState(
-                              state, deal_id, deal, *deal_state, now));
-              slashed_sum += slashed_next.first;
-              if (slashed_next.second != kChainEpochUndefined) {
-                VM_ASSERT(slashed_next.second > now);
-                deal_state->last_updated_epoch = now;
-                OUTCOME_TRY(state.states.set(deal_id, *deal_state));
-                next_updates[slashed_next.second].push_back(deal_id);
-              }
-            }
-          }
+
+    OUTCOME_TRY(sets, dueDealSets(state, now));
+    std::vector<DealId> due;
+    for (auto &[epoch, set] : sets) {
+      OUTCOME_TRY(set.visit([&](auto deal_id, auto) {
+        due.push_back(deal_id);
+        return outcome::success();
+      }));
+      OUTCOME_TRY(state.deals_by_epoch.remove(epoch));
+    }
+
+    // states and proposals of due deals are read in one visit each
+    std::map<DealId, DealState> due_states;
+    OUTCOME_TRY(state.states.visitIndices(
+        {due.begin(), due.end()}, [&](auto deal_id, auto &deal_state) {
+          due_states.emplace(deal_id, deal_state);
+          return outcome::success();
+        }));
+    std::set<DealId> active;
+    for (auto &[deal_id, _] : due_states) {
+      active.insert(deal_id);
+    }
+    std::map<DealId, DealProposal> due_proposals;
+    OUTCOME_TRY(state.proposals.visitIndices(
+        active, [&](auto deal_id, auto &deal) {
+          due_proposals.emplace(deal_id, deal);
           return outcome::success();
-        }};
-        OUTCOME_TRY(set->visit(visitor));
-        OUTCOME_TRY(state.deals_by_epoch.remove(epoch));
+        }));
+
+    for (auto deal_id : due) {
+      // prefetched values are used once, repeated deal is read again
+      boost::optional<DealState> deal_state;
+      auto cached_state{due_states.find(deal_id)};
+      if (cached_state != due_states.end()) {
+        deal_state = std::move(cached_state->second);
+        due_states.erase(cached_state);
+      } else {
+        OUTCOME_TRYA(deal_state, state.states.tryGet(deal_id));
+      }
+      if (!deal_state) {
+        continue;
+      }
+      boost::optional<DealProposal> deal;
+      auto cached_deal{due_proposals.find(deal_id)};
+      if (cached_deal != due_proposals.end()) {
+        deal = std::move(cached_deal->second);
+        due_proposals.erase(cached_deal);
+      } else {
+        OUTCOME_TRYA(deal, state.proposals.get(deal_id));
+      }
+      if (deal_state->sector_start_epoch == kChainEpochUndefined) {
+        VM_ASSERT(now >= deal->start_epoch);
+        OUTCOME_TRY(slashed, processDealInitTimedOut(state, deal_id, *deal));
+        slashed_sum += slashed;
+        if (deal->verified) {
+          timed_out_verified.push_back(*deal);
+        }
+      } else {
+        OUTCOME_TRY(
+            slashed_next,
+            updatePendingDealState(state, deal_id, *deal, *deal_state, now));
+        slashed_sum += slashed_next.first;
+        if (slashed_next.second != kChainEpochUndefined) {
+          VM_ASSERT(slashed_next.second > now);
+          deal_state->last_updated_epoch = now;
+          OUTCOME_TRY(state.states.set(deal_id, *deal_state));
+          next_updates[slashed_next.second].push_back(deal_id);
+        }
       }
     }
     for (auto &[next, deals] : next_updates) {
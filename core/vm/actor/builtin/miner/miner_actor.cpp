@@ -5,6 +5,8 @@
 
 #include "vm/actor/builtin/miner/miner_actor.hpp"
 
+#include <limits>
+
 #include <boost/endian/buffers.hpp>
 
 #include "vm/actor/builtin/account/account_actor.hpp"
@@ -18,6 +20,7 @@ namespace fc::vm::actor::builtin::miner {
   using primitives::sector::OnChainSealVerifyInfo;
   using primitives::sector::SectorInfo;
   using runtime::DomainSeparationTag;
+  using runtime::LazyState;
   using storage_power::SectorTerminationType;
 
   outcome::result<void> burnFunds(Runtime &runtime, const TokenAmount &amount) {
@@ -165,22 +168,27 @@ namespace fc::vm::actor::builtin::miner {
     return outcome::success();
   }
 
+  /**
+   * Faults are added only for sectors not in fault set, so each faulty sector
+   * is in one fault epoch and scan stops when all removed faults are found
+   */
   outcome::result<void> removeFaults(State &state, const RleBitset &sectors) {
-    for (auto sector : sectors) {
-      state.fault_set.erase(sector);
+    auto left{state.fault_set.intersect(sectors)};
+    if (left.empty()) {
+      return outcome::success();
     }
-    OUTCOME_TRY(state.fault_epochs.visit(
-        [&](auto epoch, auto faults) -> outcome::result<void> {
-          auto change{false};
-          for (auto sector : sectors) {
-            if (faults.erase(sector) != 0) {
-              change = true;
-            }
-          }
-          if (change) {
-            OUTCOME_TRY(state.fault_epochs.set(epoch, faults));
+    state.fault_set = state.fault_set.subtract(left);
+    OUTCOME_TRY(state.fault_epochs.visitRange(
+        0,
+        std::numeric_limits<uint64_t>::max(),
+        [&](auto epoch, auto &faults) -> outcome::result<bool> {
+          auto removed{faults.intersect(left)};
+          if (!removed.empty()) {
+            OUTCOME_TRY(
+                state.fault_epochs.set(epoch, faults.subtract(removed)));
+            left = left.subtract(removed);
           }
-          return outcome::success();
+          return !left.empty();
         }));
     return outcome::success();
   }
@@ -190,12 +198,12 @@ namespace fc::vm::actor::builtin::miner {
                                                 const RleBitset &sectors) {
     for (auto sector : sectors) {
       OUTCOME_TRY(state.sectors.remove(sector));
-      state.new_sectors.erase(sector);
-      for (auto &deadline : deadlines.due) {
-        deadline.erase(sector);
-      }
-      state.recoveries.erase(sector);
     }
+    state.new_sectors = state.new_sectors.subtract(sectors);
+    for (auto &deadline : deadlines.due) {
+      deadline = deadline.subtract(sectors);
+    }
+    state.recoveries = state.recoveries.subtract(sectors);
     OUTCOME_TRY(removeFaults(state, sectors));
     return outcome::success();
   }
@@ -299,9 +307,7 @@ namespace fc::vm::actor::builtin::miner {
     auto [detected, recoveries] =
         computeFaultsFromMissingPoSts(state, deadlines, before_deadline);
     OUTCOME_TRY(state.addFaults(detected, period_start));
-    for (auto sector : recoveries) {
-      state.recoveries.erase(sector);
-    }
+    state.recoveries = state.recoveries.subtract(recoveries);
     std::vector<SectorOnChainInfo> detected_sectors;
     for (auto sector_num : detected) {
       OUTCOME_TRY(sector, state.sectors.get(sector_num));
@@ -372,6 +378,15 @@ namespace fc::vm::actor::builtin::miner {
     return std::move(state);
   }
 
+  /// Loads state with only info decoded and checks caller is worker
+  outcome::result<LazyState<State>> assertCallerIsWorkerLazy(
+      Runtime &runtime) {
+    OUTCOME_TRY(state, runtime.getCurrentActorStateLazy<State>());
+    OUTCOME_TRY(state.read(&State::info));
+    OUTCOME_TRY(runtime.validateImmediateCallerIs(state->info.worker));
+    return std::move(state);
+  }
+
   /**
    * Resolves an address to an ID address and verifies that it is address of an
    * account or multisig actor
@@ -564,34 +579,28 @@ namespace fc::vm::actor::builtin::miner {
   outcome::result<RleBitset> popSectorExpirations(State &state,
                                                   ChainEpoch epoch) {
     RleBitset result;
-    std::vector<ChainEpoch> expired;
-    OUTCOME_TRY(state.sector_expirations.visit([&](auto expiry, auto &sectors) {
-      // TODO: lotus stops iterations
-      if (static_cast<ChainEpoch>(expiry) <= epoch) {
-        expired.push_back(expiry);
-        result.insert(sectors.begin(), sectors.end());
-      }
-      return outcome::success();
-    }));
-    for (auto expiry : expired) {
-      OUTCOME_TRY(state.sector_expirations.remove(expiry));
+    if (epoch < 0) {
+      return std::move(result);
     }
+    // keys are epochs, so expired entries are prefix of queue
+    OUTCOME_TRY(state.sector_expirations.popRange(
+        0, epoch + 1, [&](auto, auto &sectors) -> outcome::result<void> {
+          result.insert(sectors.begin(), sectors.end());
+          return outcome::success();
+        }));
     return std::move(result);
   }
 
   outcome::result<RleBitset> popExpiredFaults(State &state, ChainEpoch latest) {
     RleBitset expired_sectors;
-    std::vector<ChainEpoch> expired_epochs;
-    OUTCOME_TRY(state.fault_epochs.visit([&](auto start, auto &sectors) {
-      if (static_cast<ChainEpoch>(start) <= latest) {
-        expired_epochs.push_back(start);
-        expired_sectors.insert(sectors.begin(), sectors.end());
-      }
-      return outcome::success();
-    }));
-    for (auto epoch : expired_epochs) {
-      OUTCOME_TRY(state.fault_epochs.remove(epoch));
+    if (latest < 0) {
+      return std::move(expired_sectors);
     }
+    OUTCOME_TRY(state.fault_epochs.popRange(
+        0, latest + 1, [&](auto, auto &sectors) -> outcome::result<void> {
+          expired_sectors.insert(sectors.begin(), sectors.end());
+          return outcome::success();
+        }));
     return std::move(expired_sectors);
   }
 
@@ -803,8 +812,9 @@ namespace fc::vm::actor::builtin::miner {
   }
 
   ACTOR_METHOD_IMPL(ControlAddresses) {
-    OUTCOME_TRY(state, loadState(runtime));
-    return Result{state.info.owner, state.info.worker};
+    OUTCOME_TRY(state, runtime.getCurrentActorStateLazy<State>());
+    OUTCOME_TRY(state.read(&State::info));
+    return Result{state->info.owner, state->info.worker};
   }
 
   ACTOR_METHOD_IMPL(ChangeWorkerAddress) {
@@ -828,14 +838,23 @@ namespace fc::vm::actor::builtin::miner {
   }
 
   ACTOR_METHOD_IMPL(ChangePeerId) {
-    OUTCOME_TRY(state, assertCallerIsWorker(runtime));
-    state.info.peer_id = params.new_id;
+    OUTCOME_TRY(state, assertCallerIsWorkerLazy(runtime));
+    OUTCOME_TRY(state.change(&State::info));
+    state->info.peer_id = params.new_id;
     OUTCOME_TRY(runtime.commitState(state));
     return outcome::success();
   }
 
   ACTOR_METHOD_IMPL(SubmitWindowedPoSt) {
-    OUTCOME_TRY(state, assertCallerIsWorker(runtime));
+    OUTCOME_TRY(lazy, assertCallerIsWorkerLazy(runtime));
+    // funds, precommits and expirations are not used by PoSt
+    OUTCOME_TRY(lazy.read(
+        &State::sectors, &State::proving_period_start, &State::deadlines));
+    OUTCOME_TRY(lazy.change(&State::fault_set,
+                            &State::fault_epochs,
+                            &State::recoveries,
+                            &State::post_submissions));
+    auto &state{*lazy};
     auto now{runtime.getCurrentEpoch()};
     VM_ASSERT(params.partitions.size() <= windowPoStMessagePartitionsMax(
                   state.info.window_post_partition_sectors));
@@ -860,11 +879,9 @@ namespace fc::vm::actor::builtin::miner {
       VM_ASSERT(state.post_submissions.insert(part).second);
     }
     OUTCOME_TRY(removeFaults(state, info.second));
-    for (auto sector : info.second) {
-      state.recoveries.erase(sector);
-    }
+    state.recoveries = state.recoveries.subtract(info.second);
     OUTCOME_TRY(recovered_sectors, state.getSectors(info.second));
-    OUTCOME_TRY(runtime.commitState(state));
+    OUTCOME_TRY(runtime.commitState(lazy));
     OUTCOME_TRY(requestBeginFaults(
         runtime, state.info.sector_size, detected_penalty.first));
     OUTCOME_TRY(
@@ -880,7 +897,14 @@ namespace fc::vm::actor::builtin::miner {
     VM_ASSERT(params.seal_epoch < now);
     OUTCOME_TRY(earliest, sealChallengeEarliest(now, params.registered_proof));
     VM_ASSERT(params.seal_epoch >= earliest);
-    OUTCOME_TRY(state, assertCallerIsWorker(runtime));
+    OUTCOME_TRY(lazy, assertCallerIsWorkerLazy(runtime));
+    // fault and expiration queues are not used by precommit
+    OUTCOME_TRY(lazy.read(&State::sectors, &State::proving_period_start));
+    OUTCOME_TRY(lazy.change(&State::precommit_deposit,
+                            &State::locked_funds,
+                            &State::vesting_funds,
+                            &State::precommitted_sectors));
+    auto &state{*lazy};
     VM_ASSERT(params.registered_proof == state.info.seal_proof_type);
     OUTCOME_TRY(already_precommited,
                 state.precommitted_sectors.has(params.sector));
@@ -897,7 +921,7 @@ namespace fc::vm::actor::builtin::miner {
     OUTCOME_TRY(addPreCommitDeposit(state, deposit));
     OUTCOME_TRY(
         state.precommitted_sectors.set(params.sector, {params, deposit, now}));
-    OUTCOME_TRY(runtime.commitState(state));
+    OUTCOME_TRY(runtime.commitState(lazy));
     OUTCOME_TRY(notifyPledgeChanged(runtime, -new_vest));
     OUTCOME_TRY(duration, maxSealDuration(params.registered_proof));
     OUTCOME_TRY(enrollCronEvent(
@@ -1088,8 +1112,9 @@ namespace fc::vm::actor::builtin::miner {
   }
 
   ACTOR_METHOD_IMPL(CheckSectorProven) {
-    OUTCOME_TRY(state, loadState(runtime));
-    OUTCOME_TRY(found, state.sectors.has(params.sector));
+    OUTCOME_TRY(state, runtime.getCurrentActorStateLazy<State>());
+    OUTCOME_TRY(state.read(&State::sectors));
+    OUTCOME_TRY(found, state->sectors.has(params.sector));
     if (!found) {
       return VMExitCode::kMinerActorNotFound;
     }
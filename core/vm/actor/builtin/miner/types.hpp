@@ -188,12 +188,17 @@ namespace fc::vm::actor::builtin::miner {
 
     DeadlineInfo deadlineInfo(ChainEpoch now) const;
     outcome::result<void> addFaults(const RleBitset &sectors, ChainEpoch epoch);
-    template <typename C>
-    outcome::result<std::vector<SectorOnChainInfo>> getSectors(const C &c) {
+    outcome::result<std::vector<SectorOnChainInfo>> getSectors(
+        const RleBitset &ids) {
       std::vector<SectorOnChainInfo> result;
-      for (auto i : c) {
-        OUTCOME_TRY(sector, sectors.get(i));
-        result.push_back(std::move(sector));
+      // loads only subtrees containing requested sectors
+      OUTCOME_TRY(sectors.visitIndices(
+          {ids.begin(), ids.end()}, [&](auto, auto &sector) {
+            result.push_back(sector);
+            return outcome::success();
+          }));
+      if (result.size() != ids.size()) {
+        return storage::amt::AmtError::kNotFound;
       }
       return std::move(result);
     }
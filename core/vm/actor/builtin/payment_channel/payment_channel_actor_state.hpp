@@ -39,6 +39,13 @@ namespace fc::vm::actor::builtin::payment_channel {
           });
     }
 
+    inline auto findLane(LaneId lane_id) const {
+      return std::lower_bound(
+          lanes.begin(), lanes.end(), lane_id, [](auto &lane, auto lane_id) {
+            return lane.id < lane_id;
+          });
+    }
+
     Address from;
     Address to;
     /** Token amount to send on collect after voucher was redeemed */
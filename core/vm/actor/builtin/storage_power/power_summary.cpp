@@ -0,0 +1,43 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/actor/builtin/storage_power/power_summary.hpp"
+
+#include "vm/actor/builtin/storage_power/storage_power_actor_state.hpp"
+#include "vm/state/impl/state_tree_impl.hpp"
+
+namespace fc::vm::actor::builtin::storage_power {
+  using state::StateTreeImpl;
+
+  PowerSummaries::PowerSummaries(IpldPtr ipld,
+                                 std::shared_ptr<PersistentBufferMap> store,
+                                 size_t cache_size)
+      : ipld_{std::move(ipld)}, store_{std::move(store)}, cache_{cache_size} {}
+
+  outcome::result<PowerSummary> PowerSummaries::get(const CID &state_root) {
+    if (auto summary{cache_.get(state_root)}) {
+      return std::move(*summary);
+    }
+    OUTCOME_TRY(root_bytes, state_root.toBytes());
+    auto key{common::Buffer{}.put("/power/").put(root_bytes)};
+    if (store_ && store_->contains(key)) {
+      OUTCOME_TRY(raw, store_->get(key));
+      OUTCOME_TRY(summary, codec::cbor::decode<PowerSummary>(raw));
+      cache_.put(state_root, summary);
+      return std::move(summary);
+    }
+    OUTCOME_TRY(state,
+                StateTreeImpl{ipld_, state_root}.state<StoragePowerActorState>(
+                    kStoragePowerAddress));
+    PowerSummary summary{
+        state.total_raw_power, state.total_qa_power, state.miner_count};
+    if (store_) {
+      OUTCOME_TRY(raw, codec::cbor::encode(summary));
+      OUTCOME_TRY(store_->put(key, raw));
+    }
+    cache_.put(state_root, summary);
+    return std::move(summary);
+  }
+}  // namespace fc::vm::actor::builtin::storage_power
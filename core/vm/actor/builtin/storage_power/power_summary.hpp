@@ -0,0 +1,51 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_VM_ACTOR_BUILTIN_STORAGE_POWER_POWER_SUMMARY_HPP
+#define CPP_FILECOIN_CORE_VM_ACTOR_BUILTIN_STORAGE_POWER_POWER_SUMMARY_HPP
+
+#include "common/lru_cache.hpp"
+#include "primitives/types.hpp"
+#include "storage/buffer_map.hpp"
+#include "storage/ipfs/datastore.hpp"
+
+namespace fc::vm::actor::builtin::storage_power {
+  using primitives::StoragePower;
+  using storage::PersistentBufferMap;
+
+  /// Network totals of power actor state
+  struct PowerSummary {
+    StoragePower total_raw_power;
+    StoragePower total_qa_power;
+    size_t miner_count{};
+  };
+  CBOR_TUPLE(PowerSummary, total_raw_power, total_qa_power, miner_count)
+
+  /**
+   * Power summaries of state roots. Summary is read from power actor state
+   * once and then kept in memory and optional store, so weight and mining
+   * checks of later tipsets don't decode power actor state.
+   */
+  class PowerSummaries {
+   public:
+    static constexpr size_t kDefaultCacheSize{256};
+
+    /// @param store - optional, keeps summaries under "/power/" prefix
+    explicit PowerSummaries(
+        IpldPtr ipld,
+        std::shared_ptr<PersistentBufferMap> store = nullptr,
+        size_t cache_size = kDefaultCacheSize);
+
+    /// Summary of power actor state in state tree
+    outcome::result<PowerSummary> get(const CID &state_root);
+
+   private:
+    IpldPtr ipld_;
+    std::shared_ptr<PersistentBufferMap> store_;
+    common::LruCache<CID, PowerSummary> cache_;
+  };
+}  // namespace fc::vm::actor::builtin::storage_power
+
+#endif  // CPP_FILECOIN_CORE_VM_ACTOR_BUILTIN_STORAGE_POWER_POWER_SUMMARY_HPP
@@ -20,15 +20,27 @@ namespace fc::vm::actor {
   using runtime::InvocationOutput;
 
   InvokerImpl::InvokerImpl() {
-    builtin_[kInitCodeCid] = builtin::init::exports;
-    builtin_[kRewardActorCodeID] = builtin::reward::exports;
-    builtin_[kCronCodeCid] = builtin::cron::exports;
-    builtin_[kStoragePowerCodeCid] = builtin::storage_power::exports;
-    builtin_[kStorageMarketCodeCid] = builtin::market::exports;
-    builtin_[kStorageMinerCodeCid] = builtin::miner::exports;
-    builtin_[kMultisigCodeCid] = builtin::multisig::exports;
-    builtin_[kPaymentChannelCodeCid] = builtin::payment_channel::exports;
-    builtin_[kAccountCodeCid] = builtin::account::exports;
+    addBuiltin(kInitCodeCid, builtin::init::exports);
+    addBuiltin(kRewardActorCodeID, builtin::reward::exports);
+    addBuiltin(kCronCodeCid, builtin::cron::exports);
+    addBuiltin(kStoragePowerCodeCid, builtin::storage_power::exports);
+    addBuiltin(kStorageMarketCodeCid, builtin::market::exports);
+    addBuiltin(kStorageMinerCodeCid, builtin::miner::exports);
+    addBuiltin(kMultisigCodeCid, builtin::multisig::exports);
+    addBuiltin(kPaymentChannelCodeCid, builtin::payment_channel::exports);
+    addBuiltin(kAccountCodeCid, builtin::account::exports);
+  }
+
+  void InvokerImpl::addBuiltin(const CodeId &code,
+                               const ActorExports &exports) {
+    auto &methods{builtin_[code]};
+    // method numbers are small and dense, exports map is ordered
+    if (!exports.empty()) {
+      methods.resize(exports.rbegin()->first.method_number + 1);
+    }
+    for (auto &[number, method] : exports) {
+      methods[number.method_number] = method;
+    }
   }
 
   outcome::result<InvocationOutput> InvokerImpl::invoke(
@@ -40,11 +52,11 @@ namespace fc::vm::actor {
     if (maybe_builtin_actor == builtin_.end()) {
       return VMExitCode::kSysErrorIllegalActor;
     }
-    auto builtin_actor = maybe_builtin_actor->second;
-    auto maybe_builtin_method = builtin_actor.find(method);
-    if (maybe_builtin_method == builtin_actor.end()) {
+    auto &methods = maybe_builtin_actor->second;
+    auto number = method.method_number;
+    if (number >= methods.size() || !methods[number]) {
       return VMExitCode::kSysErrInvalidMethod;
     }
-    return maybe_builtin_method->second(runtime, params);
+    return methods[number](runtime, params);
   }
 }  // namespace fc::vm::actor
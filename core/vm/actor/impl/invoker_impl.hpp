@@ -8,6 +8,8 @@
 
 #include "vm/actor/invoker.hpp"
 
+#include <unordered_map>
+
 #include "vm/actor/actor_method.hpp"
 
 namespace fc::vm::actor {
@@ -26,7 +28,12 @@ namespace fc::vm::actor {
         const MethodParams &params) override;
 
    private:
-    std::map<CID, ActorExports> builtin_;
+    /// Methods of builtin actor indexed by method number, empty if missing
+    using MethodTable = std::vector<ActorMethod>;
+
+    void addBuiltin(const CodeId &code, const ActorExports &exports);
+
+    std::unordered_map<CID, MethodTable> builtin_;
   };
 }  // namespace fc::vm::actor
 
@@ -0,0 +1,43 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/interpreter/impl/call_simulator.hpp"
+
+#include "common/parallel_for.hpp"
+#include "storage/ipfs/impl/buffered_ipld.hpp"
+#include "vm/actor/impl/invoker_impl.hpp"
+
+namespace fc::vm::interpreter {
+  using actor::InvokerImpl;
+  using runtime::Env;
+  using storage::ipfs::BufferedIpld;
+
+  CallSimulator::CallSimulator(IpldPtr ipld, size_t threads)
+      : ipld_{std::move(ipld)},
+        invoker_{std::make_shared<InvokerImpl>()},
+        pool_{std::make_shared<boost::asio::thread_pool>(threads)} {}
+
+  CallSimulator::CallResult CallSimulator::call(
+      const Tipset &tipset, const UnsignedMessage &message) const {
+    // blocks written by call are buffered and dropped with overlay
+    auto env{std::make_shared<Env>(
+        invoker_, std::make_shared<BufferedIpld>(ipld_), tipset)};
+    return env->applyImplicitMessage(message);
+  }
+
+  std::vector<CallSimulator::CallResult> CallSimulator::callMany(
+      const Tipset &tipset, const std::vector<UnsignedMessage> &messages) const {
+    std::vector<boost::optional<CallResult>> results(messages.size());
+    common::parallelFor(pool_.get(), messages.size(), [&](auto i) {
+      results[i] = call(tipset, messages[i]);
+    });
+    std::vector<CallResult> out;
+    out.reserve(results.size());
+    for (auto &result : results) {
+      out.push_back(std::move(*result));
+    }
+    return out;
+  }
+}  // namespace fc::vm::interpreter
@@ -0,0 +1,46 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_VM_INTERPRETER_CALL_SIMULATOR_HPP
+#define CPP_FILECOIN_CORE_VM_INTERPRETER_CALL_SIMULATOR_HPP
+
+#include <boost/asio/thread_pool.hpp>
+
+#include "primitives/tipset/tipset.hpp"
+#include "vm/runtime/env.hpp"
+
+namespace fc::vm::interpreter {
+  using actor::Invoker;
+  using message::UnsignedMessage;
+  using primitives::tipset::Tipset;
+  using runtime::InvocationOutput;
+
+  /**
+   * Applies messages as implicit on tipset parent state without changing it.
+   * Parent state is shared read-only base, each call runs on own overlay of
+   * state tree and blocks, which is discarded after call.
+   */
+  class CallSimulator {
+   public:
+    using CallResult = outcome::result<InvocationOutput>;
+
+    /// @param ipld - must allow concurrent reads
+    CallSimulator(IpldPtr ipld, size_t threads);
+
+    CallResult call(const Tipset &tipset, const UnsignedMessage &message) const;
+
+    /// Applies messages concurrently, each independently of others
+    std::vector<CallResult> callMany(
+        const Tipset &tipset, const std::vector<UnsignedMessage> &messages) const;
+
+   private:
+    IpldPtr ipld_;
+    /// Builtin actor exports are read-only, so invoker is shared by calls
+    std::shared_ptr<Invoker> invoker_;
+    std::shared_ptr<boost::asio::thread_pool> pool_;
+  };
+}  // namespace fc::vm::interpreter
+
+#endif  // CPP_FILECOIN_CORE_VM_INTERPRETER_CALL_SIMULATOR_HPP
@@ -0,0 +1,107 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/interpreter/impl/chain_revalidator.hpp"
+
+#include <algorithm>
+#include <future>
+
+#include <boost/asio/post.hpp>
+
+namespace fc::vm::interpreter {
+  namespace {
+    using Checked = outcome::result<boost::optional<RevalidateMismatch>>;
+
+    /**
+     * Executes chunk of tipsets below end
+     * @param end - child of last tipset of chunk
+     * @param size - max tipsets in chunk
+     */
+    Checked checkChunk(const IpldPtr &ipld,
+                       const Interpreter &interpreter,
+                       const Tipset &end,
+                       uint64_t from_height,
+                       size_t size) {
+      // chunk tipsets in execution order, followed by end
+      std::vector<Tipset> chain{end};
+      while (chain.size() <= size && chain.back().height > from_height) {
+        OUTCOME_TRY(parent, chain.back().loadParent(*ipld));
+        if (parent.height < from_height) {
+          break;
+        }
+        chain.push_back(std::move(parent));
+      }
+      std::reverse(chain.begin(), chain.end());
+      for (size_t i{0}; i + 1 < chain.size(); ++i) {
+        OUTCOME_TRY(computed, interpreter.interpret(ipld, chain[i]));
+        auto &child{chain[i + 1]};
+        if (computed.state_root != child.getParentStateRoot()
+            || computed.message_receipts
+                   != child.getParentMessageReceipts()) {
+          return RevalidateMismatch{
+              chain[i].height,
+              {child.getParentStateRoot(), child.getParentMessageReceipts()},
+              std::move(computed),
+          };
+        }
+      }
+      return boost::none;
+    }
+  }  // namespace
+
+  outcome::result<std::vector<RevalidateMismatch>> revalidateChain(
+      const IpldPtr &ipld,
+      const std::shared_ptr<Interpreter> &interpreter,
+      const Tipset &tip,
+      uint64_t from_height,
+      size_t chunk_size,
+      boost::asio::thread_pool &pool) {
+    chunk_size = std::max<size_t>(1, chunk_size);
+    // ends of chunks, walk down reads headers only
+    std::vector<Tipset> ends{tip};
+    Tipset ts{tip};
+    for (size_t count{0}; ts.height > from_height;) {
+      OUTCOME_TRY(parent, ts.loadParent(*ipld));
+      if (parent.height < from_height) {
+        break;
+      }
+      ts = std::move(parent);
+      if (++count % chunk_size == 0 && ts.height > from_height) {
+        ends.push_back(ts);
+      }
+    }
+
+    std::vector<std::future<Checked>> chunks;
+    for (auto &end : ends) {
+      auto task{std::make_shared<std::packaged_task<Checked()>>(
+          [&ipld, &interpreter, end{std::move(end)}, from_height, chunk_size] {
+            return checkChunk(
+                ipld, *interpreter, end, from_height, chunk_size);
+          })};
+      chunks.push_back(task->get_future());
+      boost::asio::post(pool, [task] { (*task)(); });
+    }
+
+    std::vector<RevalidateMismatch> mismatches;
+    boost::optional<std::error_code> error;
+    for (auto &chunk : chunks) {
+      auto checked{chunk.get()};
+      if (!checked) {
+        if (!error) {
+          error = checked.error();
+        }
+      } else if (checked.value()) {
+        mismatches.push_back(std::move(*checked.value()));
+      }
+    }
+    if (error) {
+      return *error;
+    }
+    std::sort(mismatches.begin(),
+              mismatches.end(),
+              [](auto &l, auto &r) { return l.height < r.height; });
+    return std::move(mismatches);
+  }
+}  // namespace fc::vm::interpreter
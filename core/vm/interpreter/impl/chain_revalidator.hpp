@@ -0,0 +1,51 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_VM_INTERPRETER_IMPL_CHAIN_REVALIDATOR_HPP
+#define CPP_FILECOIN_CORE_VM_INTERPRETER_IMPL_CHAIN_REVALIDATOR_HPP
+
+#include <boost/asio/thread_pool.hpp>
+
+#include "vm/interpreter/interpreter.hpp"
+
+namespace fc::vm::interpreter {
+  using primitives::tipset::Tipset;
+
+  /// Tipset which execution result differs from state claimed by its child
+  struct RevalidateMismatch {
+    uint64_t height{};
+    /// Parent state and receipts claimed by child header
+    Result claimed;
+    Result computed;
+  };
+
+  /**
+   * Executes history of chain again to audit it. Every header commits to
+   * parent state, so tipset needs only state claimed by its own header and
+   * chain is split into chunks of consecutive tipsets, which are executed
+   * concurrently on pool. Tipsets of chunk are executed in order and result
+   * of each is compared with state claimed by its child, result of chunk
+   * last tipset with first tipset of next chunk. Chunk stops at first
+   * mismatch, as following claims depend on it.
+   * Headers are walked once to find chunk bounds, chunks load own headers,
+   * so memory doesn't grow with range. Blocking, ipld must support
+   * concurrent reads, interpreter should not be cached, so results are
+   * computed and not read.
+   * @param tip - last tipset, its result is not checked as it has no child
+   * @param from_height - lowest height of executed tipsets
+   * @param chunk_size - tipsets per chunk
+   * @return first mismatch of each failed chunk by height, empty if history
+   * is valid
+   */
+  outcome::result<std::vector<RevalidateMismatch>> revalidateChain(
+      const IpldPtr &ipld,
+      const std::shared_ptr<Interpreter> &interpreter,
+      const Tipset &tip,
+      uint64_t from_height,
+      size_t chunk_size,
+      boost::asio::thread_pool &pool);
+}  // namespace fc::vm::interpreter
+
+#endif  // CPP_FILECOIN_CORE_VM_INTERPRETER_IMPL_CHAIN_REVALIDATOR_HPP
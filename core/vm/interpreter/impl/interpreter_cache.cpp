@@ -0,0 +1,117 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/interpreter/impl/interpreter_cache.hpp"
+
+#include "crypto/blake2/blake2b160.hpp"
+
+namespace fc::vm::interpreter {
+  using common::Buffer;
+
+  /// Prefix of stored results
+  const std::string kResultPrefix{"/interpreter/"};
+
+  InterpreterCache::InterpreterCache(std::shared_ptr<PersistentBufferMap> store,
+                                     size_t cache_size)
+      : store_{std::move(store)}, cache_{cache_size} {}
+
+  Hash256 InterpreterCache::hash(const TipsetKey &tipset) {
+    return crypto::blake2b::blake2b_256(legacyKey(tipset));
+  }
+
+  Buffer InterpreterCache::legacyKey(const TipsetKey &tipset) {
+    Buffer bytes;
+    for (auto &cid : tipset.cids) {
+      bytes.put(cid.toBytes().value());
+    }
+    return bytes;
+  }
+
+  Buffer InterpreterCache::storeKey(const Hash256 &hash) {
+    return Buffer{}.put(kResultPrefix).put(hash);
+  }
+
+  outcome::result<boost::optional<Result>> InterpreterCache::tryGet(
+      const TipsetKey &tipset) const {
+    auto key{hash(tipset)};
+    if (auto entry{cache_.get(key)}) {
+      return entry->result;
+    }
+    auto store_key{storeKey(key)};
+    if (!store_->contains(store_key)) {
+      return boost::none;
+    }
+    OUTCOME_TRY(raw, store_->get(store_key));
+    OUTCOME_TRY(entry, codec::cbor::decode<InterpreterCacheEntry>(raw));
+    cache_.put(key, entry);
+    return entry.result;
+  }
+
+  outcome::result<void> InterpreterCache::put(const TipsetKey &tipset,
+                                              uint64_t height,
+                                              const Result &result) {
+    auto key{hash(tipset)};
+    InterpreterCacheEntry entry{height, result};
+    OUTCOME_TRY(raw, codec::cbor::encode(entry));
+    OUTCOME_TRY(store_->put(storeKey(key), raw));
+    cache_.put(key, std::move(entry));
+    return outcome::success();
+  }
+
+  outcome::result<boost::optional<Result>> InterpreterCache::migrate(
+      const TipsetKey &tipset, uint64_t height) {
+    auto legacy_key{legacyKey(tipset)};
+    if (!store_->contains(legacy_key)) {
+      return boost::none;
+    }
+    OUTCOME_TRY(raw, store_->get(legacy_key));
+    OUTCOME_TRY(result, codec::cbor::decode<Result>(raw));
+    auto key{hash(tipset)};
+    InterpreterCacheEntry entry{height, result};
+    OUTCOME_TRY(encoded, codec::cbor::encode(entry));
+    auto batch{store_->batch()};
+    OUTCOME_TRY(batch->put(storeKey(key), encoded));
+    OUTCOME_TRY(batch->remove(legacy_key));
+    OUTCOME_TRY(batch->commit());
+    cache_.put(key, std::move(entry));
+    return std::move(result);
+  }
+
+  outcome::result<size_t> InterpreterCache::prune(uint64_t below,
+                                                  const KeepPredicate &keep) {
+    std::vector<Hash256> removed;
+    auto prefix{Buffer{}.put(kResultPrefix)};
+    auto cursor{store_->cursor()};
+    for (cursor->seek(prefix); cursor->isValid(); cursor->next()) {
+      auto key{cursor->key()};
+      if (key.size() != prefix.size() + Hash256::size()
+          || !std::equal(prefix.begin(), prefix.end(), key.begin())) {
+        break;
+      }
+      OUTCOME_TRY(entry,
+                  codec::cbor::decode<InterpreterCacheEntry>(cursor->value()));
+      if (entry.height >= below) {
+        continue;
+      }
+      OUTCOME_TRY(hash, Hash256::fromSpan(gsl::make_span(key).subspan(
+                            prefix.size())));
+      if (!keep(entry.height, hash)) {
+        removed.push_back(hash);
+      }
+    }
+    if (removed.empty()) {
+      return 0;
+    }
+    auto batch{store_->batch()};
+    for (auto &hash : removed) {
+      OUTCOME_TRY(batch->remove(storeKey(hash)));
+    }
+    OUTCOME_TRY(batch->commit());
+    for (auto &hash : removed) {
+      cache_.remove(hash);
+    }
+    return removed.size();
+  }
+}  // namespace fc::vm::interpreter
@@ -0,0 +1,77 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_VM_INTERPRETER_IMPL_INTERPRETER_CACHE_HPP
+#define CPP_FILECOIN_CORE_VM_INTERPRETER_IMPL_INTERPRETER_CACHE_HPP
+
+#include "common/blob.hpp"
+#include "common/lru_cache.hpp"
+#include "primitives/tipset/tipset_key.hpp"
+#include "storage/buffer_map.hpp"
+#include "vm/interpreter/interpreter.hpp"
+
+namespace fc::vm::interpreter {
+  using common::Hash256;
+  using primitives::tipset::TipsetKey;
+  using storage::PersistentBufferMap;
+
+  /// Stored interpreter result with height of its tipset, used by pruning
+  struct InterpreterCacheEntry {
+    uint64_t height{};
+    Result result;
+  };
+  CBOR_TUPLE(InterpreterCacheEntry, height, result)
+
+  /**
+   * Interpreter results by tipset, stored under "/interpreter/" prefix with
+   * recently used results kept in memory
+   */
+  class InterpreterCache {
+   public:
+    static constexpr size_t kDefaultCacheSize{1024};
+    /// Decides whether result of tipset below pruning height is kept
+    using KeepPredicate = std::function<bool(uint64_t, const Hash256 &)>;
+
+    explicit InterpreterCache(std::shared_ptr<PersistentBufferMap> store,
+                              size_t cache_size = kDefaultCacheSize);
+
+    /// Blake2b-256 of tipset block cids, which identifies tipset in store
+    static Hash256 hash(const TipsetKey &tipset);
+
+    /// Stored result of tipset, does not interpret it
+    outcome::result<boost::optional<Result>> tryGet(
+        const TipsetKey &tipset) const;
+
+    outcome::result<void> put(const TipsetKey &tipset,
+                              uint64_t height,
+                              const Result &result);
+
+    /**
+     * Moves result stored by earlier versions under concatenated tipset
+     * cids to hashed key, in one batch
+     * @param height - height of tipset, old results don't have it
+     * @return moved result, none if there was no old one
+     */
+    outcome::result<boost::optional<Result>> migrate(const TipsetKey &tipset,
+                                                     uint64_t height);
+
+    /**
+     * Removes results of tipsets below height, which are not kept by
+     * predicate, like side chain tipsets below finality, in one batch
+     * @return count of removed results
+     */
+    outcome::result<size_t> prune(uint64_t below, const KeepPredicate &keep);
+
+   private:
+    static common::Buffer storeKey(const Hash256 &hash);
+    /// Key of result before hashed keys
+    static common::Buffer legacyKey(const TipsetKey &tipset);
+
+    std::shared_ptr<PersistentBufferMap> store_;
+    mutable common::LruCache<Hash256, InterpreterCacheEntry> cache_;
+  };
+}  // namespace fc::vm::interpreter
+
+#endif  // CPP_FILECOIN_CORE_VM_INTERPRETER_IMPL_INTERPRETER_CACHE_HPP
@@ -5,6 +5,9 @@
 
 #include "vm/interpreter/impl/interpreter_impl.hpp"
 
+#include "metrics/metrics.hpp"
+#include "metrics/tracing.hpp"
+#include "storage/ipfs/impl/buffered_ipld.hpp"
 #include "vm/actor/builtin/cron/cron_actor.hpp"
 #include "vm/actor/builtin/reward/reward_actor.hpp"
 #include "vm/actor/impl/invoker_impl.hpp"
@@ -33,7 +36,6 @@ namespace fc::vm::interpreter {
   using actor::MethodParams;
   using actor::builtin::cron::EpochTick;
   using actor::builtin::reward::AwardBlockReward;
-  using message::SignedMessage;
   using message::UnsignedMessage;
   using primitives::TokenAmount;
   using primitives::block::MsgMeta;
@@ -41,9 +43,35 @@ namespace fc::vm::interpreter {
   using runtime::Env;
   using runtime::kInfiniteGas;
   using runtime::MessageReceipt;
+  using storage::ipfs::BufferedIpld;
+
+  namespace {
+    struct InterpretMetrics {
+      metrics::Histogram &time;
+      metrics::Counter &messages;
+      metrics::Counter &gas;
+    };
+
+    InterpretMetrics &interpretMetrics() {
+      static InterpretMetrics metrics{[] {
+        auto &registry{metrics::Registry::global()};
+        return InterpretMetrics{
+            registry.histogram("fc_interpret_seconds",
+                               "Time of tipset execution",
+                               {},
+                               1e-9),
+            registry.counter("fc_interpret_messages_total",
+                             "Messages executed by interpreter"),
+            registry.counter("fc_interpret_gas_used_total",
+                             "Gas used by executed messages"),
+        };
+      }()};
+      return metrics;
+    }
+  }  // namespace
 
   outcome::result<Result> InterpreterImpl::interpret(
-      const IpldPtr &ipld, const Tipset &tipset) const {
+      const IpldPtr &store, const Tipset &tipset) const {
     if (tipset.height == 0) {
       return Result{
           tipset.getParentStateRoot(),
@@ -55,29 +83,113 @@ namespace fc::vm::interpreter {
       return InterpreterError::kDuplicateMiner;
     }
 
+    auto &metrics{interpretMetrics()};
+    metrics::Timer timer{metrics.time};
+    metrics::tracing::ScopedSpan span{"vm", "interpret"};
+    if (span) {
+      span.arg("height " + std::to_string(tipset.height));
+    }
+
+    // intermediate blocks are kept in memory and only reachable are written
+    auto buffered = std::make_shared<BufferedIpld>(store);
+    IpldPtr ipld = buffered;
+
+    // execution objects of tipset messages are freed at once, after env
+    common::Arena arena;
     auto env =
         std::make_shared<Env>(std::make_shared<InvokerImpl>(), ipld, tipset);
+    env->profiler = profiler;
+    env->arena = &arena;
+    std::vector<runtime::MessageTrace> message_traces;
+    if (traces) {
+      env->traces = &message_traces;
+    }
 
-    adt::Array<MessageReceipt> receipts{ipld};
+    // message cids are resolved and deduplicated across blocks first, so
+    // messages can be loaded together before execution
+    std::vector<MessageRef> refs;
+    // end of messages of each block
+    std::vector<size_t> block_ends;
     MessageVisitor message_visitor{ipld};
     for (auto &block : tipset.blks) {
-      AwardBlockReward::Params reward{block.miner, 0, 0, 1};
       OUTCOME_TRY(message_visitor.visit(
           block, [&](auto, auto bls, auto &cid) -> outcome::result<void> {
-            UnsignedMessage message;
-            if (bls) {
-              OUTCOME_TRYA(message, ipld->getCbor<UnsignedMessage>(cid));
-            } else {
-              OUTCOME_TRY(signed_message, ipld->getCbor<SignedMessage>(cid));
-              message = std::move(signed_message.message);
-            }
-            TokenAmount penalty;
-            OUTCOME_TRY(receipt, env->applyMessage(message, penalty));
-            reward.gas_reward += message.gasPrice * receipt.gas_used;
-            reward.penalty += penalty;
-            OUTCOME_TRY(receipts.append(std::move(receipt)));
+            refs.push_back({cid, bls});
             return outcome::success();
           }));
+      block_ends.push_back(refs.size());
+    }
+
+    std::vector<UnsignedMessage> messages;
+    // serialized size of each message, so it is not encoded to be charged
+    std::vector<size_t> sizes;
+    if (parallel) {
+      OUTCOME_TRYA(messages, parallel->loadMessages(store, refs, sizes));
+    } else {
+      messages.reserve(refs.size());
+      sizes.reserve(refs.size());
+      for (auto &ref : refs) {
+        OUTCOME_TRY(message, ParallelExecutor::loadMessage(ipld, ref));
+        sizes.push_back(message.bytes.size());
+        messages.push_back(std::move(message.value));
+      }
+    }
+
+    if (parallel) {
+      parallel->prefetchSeals(store, tipset, messages);
+    }
+
+    std::vector<boost::optional<Speculation>> speculations;
+    // speculations run on own envs, which are not traced
+    if (parallel && !traces) {
+      speculations =
+          parallel->speculate(store, tipset, messages, sizes, profiler);
+    }
+
+    // receipts keys are ascending, so amt is built bottom-up
+    storage::amt::AmtBuilder receipts{ipld};
+    // decoded receipts are kept only for message cache
+    std::vector<MessageReceipt> cached_receipts;
+    if (message_cache) {
+      cached_receipts.reserve(messages.size());
+    }
+    size_t index{0};
+    for (size_t i{0}; i < tipset.blks.size(); ++i) {
+      AwardBlockReward::Params reward{tipset.blks[i].miner, 0, 0, 1};
+      for (; index < block_ends[i]; ++index) {
+        auto &message{messages[index]};
+        MessageReceipt receipt;
+        TokenAmount penalty;
+        std::chrono::nanoseconds time;
+        auto committed{false};
+        if (index < speculations.size() && speculations[index]) {
+          auto &speculation{*speculations[index]};
+          OUTCOME_TRYA(committed,
+                       ParallelExecutor::commit(*env, message, speculation));
+          if (committed) {
+            receipt = std::move(speculation.receipt);
+            penalty = std::move(speculation.penalty);
+            time = speculation.time;
+          }
+        }
+        if (!committed) {
+          auto start{std::chrono::steady_clock::now()};
+          OUTCOME_TRYA(receipt,
+                       env->applyMessage(message, sizes[index], penalty));
+          time = std::chrono::steady_clock::now() - start;
+        }
+        if (observer) {
+          observer(message, receipt, time);
+        }
+        metrics.messages.inc();
+        metrics.gas.inc(std::max<int64_t>(0, receipt.gas_used));
+        reward.gas_reward += message.gasPrice * receipt.gas_used;
+        reward.penalty += penalty;
+        OUTCOME_TRY(receipts.appendCbor(index, receipt));
+        if (message_cache) {
+          cached_receipts.push_back(std::move(receipt));
+        }
+      }
 
       OUTCOME_TRY(reward_encoded, codec::cbor::encode(reward));
       OUTCOME_TRY(env->applyImplicitMessage(UnsignedMessage{
@@ -105,11 +217,30 @@ namespace fc::vm::interpreter {
 
     OUTCOME_TRY(new_state_root, env->state_tree->flush());
 
-    OUTCOME_TRY(Ipld::flush(receipts));
+    OUTCOME_TRY(receipts_root, receipts.flush());
+
+    OUTCOME_TRY(buffered->flush({new_state_root, receipts_root}));
+
+    if (traces) {
+      OUTCOME_TRY(traces->put(TipsetKey{tipset.cids}, message_traces));
+    }
+
+    if (message_cache) {
+      auto executed{std::make_shared<ExecutedMessages>()};
+      executed->height = tipset.height;
+      executed->cids.reserve(refs.size());
+      for (auto &ref : refs) {
+        executed->cids.push_back(ref.cid);
+      }
+      executed->messages = std::move(messages);
+      executed->receipts_root = receipts_root;
+      executed->receipts = std::move(cached_receipts);
+      message_cache->putExecuted(TipsetKey{tipset.cids}, std::move(executed));
+    }
 
     return Result{
         new_state_root,
-        receipts.amt.cid(),
+        receipts_root,
     };
   }
 
@@ -126,20 +257,30 @@ namespace fc::vm::interpreter {
 
   outcome::result<Result> CachedInterpreter::interpret(
       const IpldPtr &ipld, const Tipset &tipset) const {
-    // TODO: TipsetKey from art-gor
-    common::Buffer key;
-    for (auto &cid : tipset.cids) {
-      OUTCOME_TRY(encoded, cid.toBytes());
-      key.put(encoded);
+    TipsetKey key{tipset.cids};
+    OUTCOME_TRY(cached, cache->tryGet(key));
+    if (cached) {
+      return std::move(*cached);
     }
-
-    if (store->contains(key)) {
-      OUTCOME_TRY(raw, store->get(key));
-      return codec::cbor::decode<Result>(raw);
+    OUTCOME_TRY(migrated, cache->migrate(key, tipset.height));
+    if (migrated) {
+      return std::move(*migrated);
     }
     OUTCOME_TRY(result, interpreter->interpret(ipld, tipset));
-    OUTCOME_TRY(raw, codec::cbor::encode(result));
-    OUTCOME_TRY(store->put(key, raw));
+    if (power_summaries) {
+      // summary is computed once, when state is new
+      OUTCOME_TRY(power_summaries->get(result.state_root));
+    }
+    OUTCOME_TRY(cache->put(key, tipset.height, result));
     return std::move(result);
   }
+
+  outcome::result<boost::optional<Result>> CachedInterpreter::tryGet(
+      const TipsetKey &tipset) const {
+    return cache->tryGet(tipset);
+  }
+
+  std::shared_ptr<InterpreterCache> CachedInterpreter::resultCache() const {
+    return cache;
+  }
 }  // namespace fc::vm::interpreter
@@ -6,14 +6,52 @@
 #ifndef CPP_FILECOIN_CORE_VM_INTERPRETER_INTERPRETER_IMPL_HPP
 #define CPP_FILECOIN_CORE_VM_INTERPRETER_INTERPRETER_IMPL_HPP
 
+#include <chrono>
+
 #include "storage/buffer_map.hpp"
+#include "vm/actor/builtin/storage_power/power_summary.hpp"
+#include "vm/interpreter/impl/interpreter_cache.hpp"
+#include "vm/interpreter/impl/message_cache.hpp"
+#include "vm/interpreter/impl/parallel_executor.hpp"
+#include "vm/interpreter/impl/trace_store.hpp"
 #include "vm/interpreter/interpreter.hpp"
+#include "vm/message/message.hpp"
+#include "vm/runtime/profiler.hpp"
+#include "vm/runtime/runtime_types.hpp"
 
 namespace fc::vm::interpreter {
+  using actor::builtin::storage_power::PowerSummaries;
   using storage::PersistentBufferMap;
 
   class InterpreterImpl : public Interpreter {
    public:
+    /// Called after each explicit message with its receipt and apply time
+    using MessageObserver =
+        std::function<void(const message::UnsignedMessage &,
+                           const runtime::MessageReceipt &,
+                           std::chrono::nanoseconds)>;
+
+    /**
+     * @param observer - optional, called after each explicit message
+     * @param profiler - optional, collects actor method stats
+     * @param parallel - optional, applies messages speculatively in parallel
+     * @param traces - optional, stores send trees of executions, messages
+     * are not speculated when set
+     * @param message_cache - optional, keeps decoded messages and receipts of
+     * interpreted tipsets for chain api
+     */
+    explicit InterpreterImpl(
+        MessageObserver observer = {},
+        std::shared_ptr<runtime::Profiler> profiler = nullptr,
+        std::shared_ptr<ParallelExecutor> parallel = nullptr,
+        std::shared_ptr<TraceStore> traces = nullptr,
+        std::shared_ptr<MessageCache> message_cache = nullptr)
+        : observer{std::move(observer)},
+          profiler{std::move(profiler)},
+          parallel{std::move(parallel)},
+          traces{std::move(traces)},
+          message_cache{std::move(message_cache)} {}
+
     outcome::result<Result> interpret(const IpldPtr &store,
                                       const Tipset &tipset) const override;
 
@@ -22,19 +60,40 @@ namespace fc::vm::interpreter {
 
    private:
     bool hasDuplicateMiners(const std::vector<BlockHeader> &blocks) const;
+
+    MessageObserver observer;
+    std::shared_ptr<runtime::Profiler> profiler;
+    std::shared_ptr<ParallelExecutor> parallel;
+    std::shared_ptr<TraceStore> traces;
+    std::shared_ptr<MessageCache> message_cache;
   };
 
   class CachedInterpreter : public Interpreter {
    public:
+    /**
+     * @param store - keeps results, see InterpreterCache
+     * @param power_summaries - optional, summary of each computed state is
+     * stored with result, so weight of child tipsets needs no state reads
+     */
     CachedInterpreter(std::shared_ptr<Interpreter> interpreter,
-                      std::shared_ptr<PersistentBufferMap> store)
-        : interpreter{std::move(interpreter)}, store{std::move(store)} {}
+                      std::shared_ptr<PersistentBufferMap> store,
+                      std::shared_ptr<PowerSummaries> power_summaries = nullptr)
+        : interpreter{std::move(interpreter)},
+          cache{std::make_shared<InterpreterCache>(std::move(store))},
+          power_summaries{std::move(power_summaries)} {}
     outcome::result<Result> interpret(const IpldPtr &store,
                                       const Tipset &tipset) const override;
 
+    outcome::result<boost::optional<Result>> tryGet(
+        const TipsetKey &tipset) const override;
+
+    /// Results store, which is pruned by chain owner
+    std::shared_ptr<InterpreterCache> resultCache() const;
+
    private:
     std::shared_ptr<Interpreter> interpreter;
-    std::shared_ptr<PersistentBufferMap> store;
+    std::shared_ptr<InterpreterCache> cache;
+    std::shared_ptr<PowerSummaries> power_summaries;
   };
 }  // namespace fc::vm::interpreter
 
@@ -0,0 +1,74 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/interpreter/impl/message_cache.hpp"
+
+namespace fc::vm::interpreter {
+  MessageCache::MessageCache(ChainEpoch epochs) : epochs_{epochs} {}
+
+  std::shared_ptr<const ExecutedMessages> MessageCache::executed(
+      const TipsetKey &tipset) const {
+    std::lock_guard lock{mutex_};
+    auto it{executed_.find(tipset)};
+    if (it == executed_.end()) {
+      return nullptr;
+    }
+    return it->second;
+  }
+
+  void MessageCache::putExecuted(
+      const TipsetKey &tipset,
+      std::shared_ptr<const ExecutedMessages> messages) {
+    std::lock_guard lock{mutex_};
+    if (!admit(messages->height)) {
+      return;
+    }
+    auto height{messages->height};
+    if (executed_.insert_or_assign(tipset, std::move(messages)).second) {
+      executed_heights_.emplace(height, tipset);
+    }
+  }
+
+  std::shared_ptr<const CachedBlockMessages> MessageCache::block(
+      const CID &meta) const {
+    std::lock_guard lock{mutex_};
+    auto it{blocks_.find(meta)};
+    if (it == blocks_.end()) {
+      return nullptr;
+    }
+    return it->second;
+  }
+
+  void MessageCache::putBlock(
+      const CID &meta, std::shared_ptr<const CachedBlockMessages> messages) {
+    std::lock_guard lock{mutex_};
+    if (!admit(messages->height)) {
+      return;
+    }
+    auto height{messages->height};
+    if (blocks_.insert_or_assign(meta, std::move(messages)).second) {
+      block_heights_.emplace(height, meta);
+    }
+  }
+
+  bool MessageCache::admit(ChainEpoch height) {
+    if (height <= max_height_) {
+      return height > max_height_ - epochs_;
+    }
+    max_height_ = height;
+    auto below{max_height_ - epochs_ + 1};
+    auto executed_end{executed_heights_.lower_bound(below)};
+    for (auto it{executed_heights_.begin()}; it != executed_end; ++it) {
+      executed_.erase(it->second);
+    }
+    executed_heights_.erase(executed_heights_.begin(), executed_end);
+    auto blocks_end{block_heights_.lower_bound(below)};
+    for (auto it{block_heights_.begin()}; it != blocks_end; ++it) {
+      blocks_.erase(it->second);
+    }
+    block_heights_.erase(block_heights_.begin(), blocks_end);
+    return true;
+  }
+}  // namespace fc::vm::interpreter
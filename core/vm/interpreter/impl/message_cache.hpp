@@ -0,0 +1,85 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_VM_INTERPRETER_IMPL_MESSAGE_CACHE_HPP
+#define CPP_FILECOIN_CORE_VM_INTERPRETER_IMPL_MESSAGE_CACHE_HPP
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include "primitives/chain_epoch/chain_epoch.hpp"
+#include "primitives/tipset/tipset_key.hpp"
+#include "vm/message/message.hpp"
+#include "vm/runtime/runtime_types.hpp"
+
+namespace fc::vm::interpreter {
+  using message::SignedMessage;
+  using message::UnsignedMessage;
+  using primitives::ChainEpoch;
+  using primitives::tipset::TipsetKey;
+  using runtime::MessageReceipt;
+
+  /// Decoded messages of executed tipset with their receipts
+  struct ExecutedMessages {
+    ChainEpoch height{};
+    /// Messages deduplicated across blocks, in order of execution
+    std::vector<CID> cids;
+    std::vector<UnsignedMessage> messages;
+    CID receipts_root;
+    /// Receipt of each message, same order as messages
+    std::vector<MessageReceipt> receipts;
+  };
+
+  /// Decoded messages of block, cids of bls messages go first
+  struct CachedBlockMessages {
+    ChainEpoch height{};
+    std::vector<UnsignedMessage> bls;
+    std::vector<SignedMessage> secp;
+    std::vector<CID> cids;
+  };
+
+  /**
+   * Decoded messages and receipts of recent tipsets, so chain api serves
+   * them without ipld reads and decoding. Executed tipsets are put by
+   * interpreter, block messages are put on first api request. Entries more
+   * than epochs below highest put height are evicted, older puts are
+   * ignored. Values are immutable and shared with readers.
+   */
+  class MessageCache {
+   public:
+    static constexpr ChainEpoch kDefaultEpochs{100};
+
+    explicit MessageCache(ChainEpoch epochs = kDefaultEpochs);
+
+    /// Messages of tipset, keyed by its cids, none if not cached
+    std::shared_ptr<const ExecutedMessages> executed(
+        const TipsetKey &tipset) const;
+
+    void putExecuted(const TipsetKey &tipset,
+                     std::shared_ptr<const ExecutedMessages> messages);
+
+    /// Messages of block, keyed by cid of its MsgMeta, none if not cached
+    std::shared_ptr<const CachedBlockMessages> block(const CID &meta) const;
+
+    void putBlock(const CID &meta,
+                  std::shared_ptr<const CachedBlockMessages> messages);
+
+   private:
+    /// Whether height is in window, evicts entries below it, called locked
+    bool admit(ChainEpoch height);
+
+    ChainEpoch epochs_;
+    mutable std::mutex mutex_;
+    ChainEpoch max_height_{};
+    std::unordered_map<TipsetKey, std::shared_ptr<const ExecutedMessages>>
+        executed_;
+    std::map<CID, std::shared_ptr<const CachedBlockMessages>> blocks_;
+    std::multimap<ChainEpoch, TipsetKey> executed_heights_;
+    std::multimap<ChainEpoch, CID> block_heights_;
+  };
+}  // namespace fc::vm::interpreter
+
+#endif  // CPP_FILECOIN_CORE_VM_INTERPRETER_IMPL_MESSAGE_CACHE_HPP
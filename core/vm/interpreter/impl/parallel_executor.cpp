@@ -0,0 +1,210 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/interpreter/impl/parallel_executor.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <numeric>
+
+#include <boost/asio/post.hpp>
+
+#include "proofs/proofs.hpp"
+#include "storage/ipfs/impl/buffered_ipld.hpp"
+#include "vm/actor/builtin/miner/miner_actor.hpp"
+#include "vm/actor/impl/invoker_impl.hpp"
+#include "vm/runtime/gas_cost.hpp"
+
+namespace fc::vm::interpreter {
+  using actor::InvokerImpl;
+  using actor::kStorageMinerCodeCid;
+  using actor::builtin::miner::ProveCommitSector;
+  using runtime::SealVerifyInfo;
+  using state::StateTreeImpl;
+  using storage::ipfs::BufferedIpld;
+
+  namespace {
+    /// Signed message with bytes of unsigned message, which size is charged
+    struct CachedSignedMessage {
+      CborCached<UnsignedMessage> message;
+      crypto::signature::Signature signature;
+    };
+    CBOR_TUPLE(CachedSignedMessage, message, signature)
+
+    boost::optional<Speculation> apply(const IpldPtr &store,
+                                       const Tipset &tipset,
+                                       const UnsignedMessage &message,
+                                       size_t size,
+                                       const std::shared_ptr<Profiler> &profiler) {
+      auto ipld{std::make_shared<BufferedIpld>(store)};
+      auto env{
+          std::make_shared<Env>(std::make_shared<InvokerImpl>(), ipld, tipset)};
+      env->speculative = true;
+      env->profiler = profiler;
+      env->state_tree->trackReads();
+      TokenAmount penalty;
+      auto start{std::chrono::steady_clock::now()};
+      auto receipt{env->applyMessage(message, size, penalty)};
+      auto time{std::chrono::steady_clock::now() - start};
+      if (!receipt) {
+        // serial application reports error
+        return boost::none;
+      }
+      return Speculation{
+          std::move(receipt.value()),
+          std::move(penalty),
+          env->state_tree->reads(),
+          env->state_tree->dirty(),
+          ipld->release(),
+          time,
+      };
+    }
+  }  // namespace
+
+  ParallelExecutor::ParallelExecutor(size_t threads)
+      : pool_{std::make_shared<boost::asio::thread_pool>(threads)} {}
+
+  std::vector<boost::optional<Speculation>> ParallelExecutor::speculate(
+      const IpldPtr &store,
+      const Tipset &tipset,
+      const std::vector<UnsignedMessage> &messages,
+      const std::vector<size_t> &sizes,
+      const std::shared_ptr<Profiler> &profiler) const {
+    std::vector<boost::optional<Speculation>> speculations(messages.size());
+    std::vector<size_t> indices;
+    std::set<Address> senders;
+    for (size_t i{0}; i < messages.size(); ++i) {
+      if (senders.insert(messages[i].from).second) {
+        indices.push_back(i);
+      }
+    }
+
+    std::mutex mutex;
+    runAll(indices, [&](auto i) {
+      auto speculation{apply(store, tipset, messages[i], sizes[i], profiler)};
+      std::lock_guard lock{mutex};
+      speculations[i] = std::move(speculation);
+    });
+    return speculations;
+  }
+
+  size_t ParallelExecutor::prefetchSeals(
+      const IpldPtr &store,
+      const Tipset &tipset,
+      const std::vector<UnsignedMessage> &messages) const {
+    std::vector<size_t> indices;
+    StateTreeImpl tree{std::make_shared<BufferedIpld>(store),
+                       tipset.getParentStateRoot()};
+    for (size_t i{0}; i < messages.size(); ++i) {
+      auto &message{messages[i]};
+      if (message.method != ProveCommitSector::Number) {
+        continue;
+      }
+      auto actor{tree.get(message.to)};
+      if (actor && actor.value().code == kStorageMinerCodeCid) {
+        indices.push_back(i);
+      }
+    }
+
+    std::atomic<size_t> verified{0};
+    runAll(indices, [&](auto i) {
+      auto &message{messages[i]};
+      auto env{std::make_shared<Env>(std::make_shared<InvokerImpl>(),
+                                     std::make_shared<BufferedIpld>(store),
+                                     tipset)};
+      std::vector<SealVerifyInfo> seals;
+      env->speculative = true;
+      env->deferred_seals = &seals;
+      // nonce and gas are not checked, execution is only searched for seals
+      std::ignore = env->applyImplicitMessage(UnsignedMessage{
+          message.to,
+          message.from,
+          {},
+          0,
+          0,
+          runtime::kInfiniteGas,
+          message.method,
+          message.params,
+      });
+      for (auto &seal : seals) {
+        // result is cached by proofs
+        std::ignore = proofs::Proofs::verifySeal(seal);
+        ++verified;
+      }
+    });
+    return verified;
+  }
+
+  outcome::result<std::vector<UnsignedMessage>> ParallelExecutor::loadMessages(
+      const IpldPtr &store,
+      const std::vector<MessageRef> &refs,
+      std::vector<size_t> &sizes) const {
+    std::vector<boost::optional<outcome::result<CborCached<UnsignedMessage>>>>
+        loaded(refs.size());
+    std::vector<size_t> indices(refs.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    // each task writes own slot, so results need no lock
+    runAll(indices, [&](auto i) { loaded[i] = loadMessage(store, refs[i]); });
+
+    std::vector<UnsignedMessage> messages;
+    messages.reserve(refs.size());
+    sizes.reserve(sizes.size() + refs.size());
+    for (auto &message : loaded) {
+      if (!*message) {
+        return message->error();
+      }
+      sizes.push_back(message->value().bytes.size());
+      messages.push_back(std::move(message->value().value));
+    }
+    return messages;
+  }
+
+  outcome::result<CborCached<UnsignedMessage>> ParallelExecutor::loadMessage(
+      const IpldPtr &ipld, const MessageRef &ref) {
+    if (ref.bls) {
+      return ipld->getCbor<CborCached<UnsignedMessage>>(ref.cid);
+    }
+    OUTCOME_TRY(signed_message, ipld->getCbor<CachedSignedMessage>(ref.cid));
+    return std::move(signed_message.message);
+  }
+
+  void ParallelExecutor::runAll(
+      const std::vector<size_t> &indices,
+      const std::function<void(size_t)> &task) const {
+    std::mutex mutex;
+    std::condition_variable done;
+    auto pending{indices.size()};
+    for (auto i : indices) {
+      boost::asio::post(*pool_, [&, i] {
+        task(i);
+        std::lock_guard lock{mutex};
+        if (--pending == 0) {
+          done.notify_one();
+        }
+      });
+    }
+    std::unique_lock lock{mutex};
+    done.wait(lock, [&] { return pending == 0; });
+  }
+
+  outcome::result<bool> ParallelExecutor::commit(
+      Env &env, const UnsignedMessage &message, Speculation &speculation) {
+    // actors not dirty since last flush are same as in parent state
+    auto &changed{env.state_tree->dirty()};
+    for (auto &address : speculation.reads) {
+      if (changed.find(address) != changed.end()) {
+        return false;
+      }
+    }
+    for (auto &[address, actor] : speculation.writes) {
+      OUTCOME_TRY(env.state_tree->set(address, actor));
+    }
+    OUTCOME_TRY(env.ipld->setMany(std::move(speculation.blocks)));
+    if (speculation.receipt.gas_used != 0) {
+      OUTCOME_TRY(env.creditGasReward(message, speculation.receipt.gas_used));
+    }
+    return true;
+  }
+}  // namespace fc::vm::interpreter
@@ -0,0 +1,124 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_VM_INTERPRETER_PARALLEL_EXECUTOR_HPP
+#define CPP_FILECOIN_CORE_VM_INTERPRETER_PARALLEL_EXECUTOR_HPP
+
+#include <chrono>
+
+#include <boost/asio/thread_pool.hpp>
+
+#include "primitives/cid/cbor_cached.hpp"
+#include "primitives/tipset/tipset.hpp"
+#include "vm/runtime/env.hpp"
+
+namespace fc::vm::interpreter {
+  using actor::Actor;
+  using message::UnsignedMessage;
+  using primitives::TokenAmount;
+  using primitives::address::Address;
+  using primitives::cid::CborCached;
+  using primitives::tipset::Tipset;
+  using runtime::Env;
+  using runtime::MessageReceipt;
+  using runtime::Profiler;
+
+  /// Message referenced by block, with its kind
+  struct MessageRef {
+    CID cid;
+    bool bls{};
+  };
+
+  /// Message applied on tipset parent state
+  struct Speculation {
+    MessageReceipt receipt;
+    TokenAmount penalty;
+    /// Id addresses of actors read
+    std::set<Address> reads;
+    /// Resulting states of changed actors
+    std::map<Address, Actor> writes;
+    /// Blocks written by execution
+    Ipld::Batch blocks;
+    std::chrono::nanoseconds time{};
+  };
+
+  /**
+   * Optimistic parallel message execution.
+   * Messages are applied concurrently, each on own state tree overlay of
+   * tipset parent state. Speculation is committed in canonical order if no
+   * actor it read was changed by previous messages, otherwise message is
+   * applied again on current state, so resulting state equals serial one.
+   * Gas reward of committed speculation is credited to reward actor on
+   * commit, so reward actor is not shared by all messages.
+   */
+  class ParallelExecutor {
+   public:
+    explicit ParallelExecutor(size_t threads);
+
+    /**
+     * Applies messages speculatively and waits for all of them.
+     * Only first message of each sender is applied, following depend on its
+     * nonce.
+     * @param store - tipset parent state store, must allow concurrent reads
+     * @param sizes - serialized size of each message
+     * @param profiler - optional, collects actor method stats
+     * @return speculation per message, none if message must be applied
+     * serially
+     */
+    std::vector<boost::optional<Speculation>> speculate(
+        const IpldPtr &store,
+        const Tipset &tipset,
+        const std::vector<UnsignedMessage> &messages,
+        const std::vector<size_t> &sizes,
+        const std::shared_ptr<Profiler> &profiler) const;
+
+    /**
+     * Verifies seals of ProveCommitSector messages in parallel and waits for
+     * them. Messages are applied on tipset parent state with seals deferred,
+     * collected seals are verified into proofs verify cache, so serial or
+     * speculative application finds results of same seals there.
+     * Results are only cached, so they are matched to messages by seal
+     * inputs and may only make execution faster.
+     * @param store - tipset parent state store, must allow concurrent reads
+     * @return number of seals verified
+     */
+    size_t prefetchSeals(const IpldPtr &store,
+                         const Tipset &tipset,
+                         const std::vector<UnsignedMessage> &messages) const;
+
+    /**
+     * Loads and decodes messages in parallel and waits for all of them, so
+     * execution doesn't wait for reads and decoding between messages
+     * @param store - must allow concurrent reads
+     * @param sizes - receives serialized size of each message
+     * @return messages in order of refs
+     */
+    outcome::result<std::vector<UnsignedMessage>> loadMessages(
+        const IpldPtr &store,
+        const std::vector<MessageRef> &refs,
+        std::vector<size_t> &sizes) const;
+
+    /// Loads message with bytes of unsigned message, which size is charged
+    static outcome::result<CborCached<UnsignedMessage>> loadMessage(
+        const IpldPtr &ipld, const MessageRef &ref);
+
+    /**
+     * Commits speculation to env if actors it read were not changed
+     * @return true if committed, false if message must be applied again
+     */
+    static outcome::result<bool> commit(Env &env,
+                                        const UnsignedMessage &message,
+                                        Speculation &speculation);
+
+   private:
+    /// Runs task for each index on pool and waits for all of them
+    void runAll(const std::vector<size_t> &indices,
+                const std::function<void(size_t)> &task) const;
+
+    std::shared_ptr<boost::asio::thread_pool> pool_;
+  };
+}  // namespace fc::vm::interpreter
+
+#endif  // CPP_FILECOIN_CORE_VM_INTERPRETER_PARALLEL_EXECUTOR_HPP
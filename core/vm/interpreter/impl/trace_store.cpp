@@ -0,0 +1,39 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/interpreter/impl/trace_store.hpp"
+
+#include "vm/interpreter/impl/interpreter_cache.hpp"
+
+namespace fc::vm::interpreter {
+  using common::Buffer;
+
+  /// Prefix of stored traces
+  const std::string kTracePrefix{"/traces/"};
+
+  TraceStore::TraceStore(std::shared_ptr<PersistentBufferMap> store)
+      : store_{std::move(store)} {}
+
+  Buffer TraceStore::storeKey(const TipsetKey &tipset) {
+    return Buffer{}.put(kTracePrefix).put(InterpreterCache::hash(tipset));
+  }
+
+  outcome::result<void> TraceStore::put(
+      const TipsetKey &tipset, const std::vector<MessageTrace> &traces) {
+    OUTCOME_TRY(raw, codec::cbor::encode(traces));
+    return store_->put(storeKey(tipset), raw);
+  }
+
+  outcome::result<boost::optional<std::vector<MessageTrace>>> TraceStore::get(
+      const TipsetKey &tipset) const {
+    auto key{storeKey(tipset)};
+    if (!store_->contains(key)) {
+      return boost::none;
+    }
+    OUTCOME_TRY(raw, store_->get(key));
+    OUTCOME_TRY(traces, codec::cbor::decode<std::vector<MessageTrace>>(raw));
+    return std::move(traces);
+  }
+}  // namespace fc::vm::interpreter
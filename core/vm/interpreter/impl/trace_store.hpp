@@ -0,0 +1,41 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_VM_INTERPRETER_IMPL_TRACE_STORE_HPP
+#define CPP_FILECOIN_CORE_VM_INTERPRETER_IMPL_TRACE_STORE_HPP
+
+#include "primitives/tipset/tipset_key.hpp"
+#include "storage/buffer_map.hpp"
+#include "vm/runtime/trace.hpp"
+
+namespace fc::vm::interpreter {
+  using primitives::tipset::TipsetKey;
+  using runtime::MessageTrace;
+  using storage::PersistentBufferMap;
+
+  /**
+   * Execution traces of interpreted tipsets, stored under "/traces/" prefix.
+   * Traces of tipset are in execution order: messages of each block
+   * followed by its reward message, then cron tick.
+   */
+  class TraceStore {
+   public:
+    explicit TraceStore(std::shared_ptr<PersistentBufferMap> store);
+
+    outcome::result<void> put(const TipsetKey &tipset,
+                              const std::vector<MessageTrace> &traces);
+
+    /// Traces of tipset, none if it was not interpreted with tracing
+    outcome::result<boost::optional<std::vector<MessageTrace>>> get(
+        const TipsetKey &tipset) const;
+
+   private:
+    static common::Buffer storeKey(const TipsetKey &tipset);
+
+    std::shared_ptr<PersistentBufferMap> store_;
+  };
+}  // namespace fc::vm::interpreter
+
+#endif  // CPP_FILECOIN_CORE_VM_INTERPRETER_IMPL_TRACE_STORE_HPP
@@ -31,6 +31,12 @@ namespace fc::vm::interpreter {
 
     virtual outcome::result<Result> interpret(const IpldPtr &store,
                                               const Tipset &tipset) const = 0;
+
+    /// Result of tipset interpreted before, does not interpret tipset
+    virtual outcome::result<boost::optional<Result>> tryGet(
+        const primitives::tipset::TipsetKey &tipset) const {
+      return boost::none;
+    }
   };
 
 }  // namespace fc::vm::interpreter
@@ -0,0 +1,73 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/message/impl/secp_verifier.hpp"
+
+#include <boost/asio/post.hpp>
+
+#include "primitives/cid/cid_of_cbor.hpp"
+
+namespace fc::vm::message {
+  using crypto::signature::Secp256k1Signature;
+  using primitives::address::Protocol;
+  using primitives::cid::getCidOfCbor;
+
+  SecpVerifier::SecpVerifier(std::shared_ptr<Secp256k1ProviderDefault> secp,
+                             std::shared_ptr<boost::asio::io_context> io,
+                             std::shared_ptr<boost::asio::thread_pool> pool,
+                             size_t cache_size)
+      : secp_{std::move(secp)},
+        io_{std::move(io)},
+        pool_{std::move(pool)},
+        cache_{cache_size} {}
+
+  outcome::result<boost::optional<PublicKeyUncompressed>> SecpVerifier::recover(
+      const SignedMessage &message) const {
+    auto signature{boost::get<Secp256k1Signature>(&message.signature)};
+    if (!signature) {
+      return boost::none;
+    }
+    auto cid{message.getCid()};
+    if (auto cached{cache_.get(cid)}) {
+      return *cached;
+    }
+    OUTCOME_TRY(unsigned_cid, getCidOfCbor(message.message));
+    OUTCOME_TRY(bytes, unsigned_cid.toBytes());
+    boost::optional<PublicKeyUncompressed> key;
+    if (auto recovered{secp_->recoverPublicKey(bytes, *signature)}) {
+      key = recovered.value();
+    }
+    cache_.put(cid, key);
+    return key;
+  }
+
+  outcome::result<bool> SecpVerifier::verify(const SignedMessage &message,
+                                             const Address &key) const {
+    if (key.getProtocol() != Protocol::SECP256K1) {
+      return false;
+    }
+    OUTCOME_TRY(public_key, recover(message));
+    return public_key && key.verifySyntax(*public_key);
+  }
+
+  void SecpVerifier::verifyAsync(SignedMessage message, Callback callback) {
+    boost::asio::post(*pool_,
+                      [self{shared_from_this()},
+                       message{std::move(message)},
+                       callback{std::move(callback)}]() mutable {
+                        auto valid{self->verify(message, message.message.from)};
+                        boost::asio::post(
+                            *self->io_,
+                            [valid{std::move(valid)},
+                             callback{std::move(callback)}] {
+                              callback(valid);
+                            });
+                      });
+  }
+
+  size_t SecpVerifier::hits() const {
+    return cache_.hits();
+  }
+}  // namespace fc::vm::message
@@ -0,0 +1,68 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_VM_MESSAGE_SECP_VERIFIER_HPP
+#define CPP_FILECOIN_CORE_VM_MESSAGE_SECP_VERIFIER_HPP
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#include "common/lru_cache.hpp"
+#include "crypto/secp256k1/secp256k1_provider.hpp"
+#include "vm/message/message.hpp"
+
+namespace fc::vm::message {
+  using crypto::secp256k1::PublicKeyUncompressed;
+  using crypto::secp256k1::Secp256k1ProviderDefault;
+
+  /**
+   * Verifies secp message signatures.
+   * Public key recovered from signature is cached by signed message cid, so
+   * message seen by mpool, sync and block submission is recovered once.
+   * Asynchronous checks run on thread pool, callbacks are called on io
+   * thread.
+   */
+  class SecpVerifier : public std::enable_shared_from_this<SecpVerifier> {
+   public:
+    using Callback = std::function<void(outcome::result<bool>)>;
+
+    /// Max number of cached public keys
+    static constexpr size_t kCacheSize{1 << 16};
+
+    SecpVerifier(std::shared_ptr<Secp256k1ProviderDefault> secp,
+                 std::shared_ptr<boost::asio::io_context> io,
+                 std::shared_ptr<boost::asio::thread_pool> pool,
+                 size_t cache_size = kCacheSize);
+
+    /**
+     * Recovers signer public key, thread-safe
+     * @return public key, or none if signature is invalid
+     */
+    outcome::result<boost::optional<PublicKeyUncompressed>> recover(
+        const SignedMessage &message) const;
+
+    /**
+     * Checks that message is signed by key address, thread-safe
+     * @param key - secp key address of message sender
+     */
+    outcome::result<bool> verify(const SignedMessage &message,
+                                 const Address &key) const;
+
+    /// Checks message sent from key address on pool
+    void verifyAsync(SignedMessage message, Callback callback);
+
+    /// Number of signatures found in cache
+    size_t hits() const;
+
+   private:
+    std::shared_ptr<Secp256k1ProviderDefault> secp_;
+    std::shared_ptr<boost::asio::io_context> io_;
+    std::shared_ptr<boost::asio::thread_pool> pool_;
+    mutable common::LruCache<CID, boost::optional<PublicKeyUncompressed>>
+        cache_;
+  };
+}  // namespace fc::vm::message
+
+#endif  // CPP_FILECOIN_CORE_VM_MESSAGE_SECP_VERIFIER_HPP
@@ -0,0 +1,52 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/message/impl/signing_service.hpp"
+
+#include <map>
+
+#include "common/parallel_for.hpp"
+
+namespace fc::vm::message {
+  SigningService::SigningService(
+      std::shared_ptr<KeyStore> keystore,
+      std::shared_ptr<boost::asio::thread_pool> pool)
+      : keystore_{keystore}, pool_{std::move(pool)}, signer_{keystore} {}
+
+  std::vector<outcome::result<Signature>> SigningService::signBatch(
+      const std::vector<SignRequest> &requests) {
+    std::vector<outcome::result<Signature>> results(
+        requests.size(), outcome::failure(std::error_code{}));
+    common::parallelFor(pool_.get(), requests.size(), [&](auto i) {
+      results[i] = keystore_->sign(requests[i].address, requests[i].data);
+    });
+    return results;
+  }
+
+  outcome::result<std::vector<SignedMessage>> SigningService::signMessages(
+      std::vector<UnsignedMessage> messages, const NextNonce &next_nonce) {
+    std::map<Address, uint64_t> nonces;
+    for (auto &message : messages) {
+      auto it{nonces.find(message.from)};
+      if (it == nonces.end()) {
+        OUTCOME_TRY(nonce, next_nonce(message.from));
+        it = nonces.emplace(message.from, nonce).first;
+      }
+      message.nonce = it->second++;
+    }
+    std::vector<outcome::result<SignedMessage>> results(
+        messages.size(), outcome::failure(std::error_code{}));
+    common::parallelFor(pool_.get(), messages.size(), [&](auto i) {
+      results[i] = signer_.sign(messages[i].from, messages[i]);
+    });
+    std::vector<SignedMessage> signed_messages;
+    signed_messages.reserve(results.size());
+    for (auto &result : results) {
+      OUTCOME_TRY(result);
+      signed_messages.push_back(std::move(result.value()));
+    }
+    return signed_messages;
+  }
+}  // namespace fc::vm::message
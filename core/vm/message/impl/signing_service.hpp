@@ -0,0 +1,54 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_VM_MESSAGE_SIGNING_SERVICE_HPP
+#define CPP_FILECOIN_CORE_VM_MESSAGE_SIGNING_SERVICE_HPP
+
+#include <boost/asio/thread_pool.hpp>
+
+#include "vm/message/impl/message_signer_impl.hpp"
+
+namespace fc::vm::message {
+  using common::Buffer;
+  using crypto::signature::Signature;
+
+  /**
+   * Signs batches of data and messages with keystore keys, signatures of
+   * batch are computed on pool when it is set. Keystore must be safe for
+   * concurrent signing.
+   */
+  class SigningService {
+   public:
+    /// Nonce of first message of sender in batch
+    using NextNonce = std::function<outcome::result<uint64_t>(const Address &)>;
+
+    /// Data signed with key of address
+    struct SignRequest {
+      Address address;
+      Buffer data;
+    };
+
+    SigningService(std::shared_ptr<KeyStore> keystore,
+                   std::shared_ptr<boost::asio::thread_pool> pool);
+
+    /// Signs each request, results are in order of requests
+    std::vector<outcome::result<Signature>> signBatch(
+        const std::vector<SignRequest> &requests);
+
+    /**
+     * Assigns consecutive nonces to messages of each sender in batch order,
+     * starting from next nonce of sender, then signs messages
+     */
+    outcome::result<std::vector<SignedMessage>> signMessages(
+        std::vector<UnsignedMessage> messages, const NextNonce &next_nonce);
+
+   private:
+    std::shared_ptr<KeyStore> keystore_;
+    std::shared_ptr<boost::asio::thread_pool> pool_;
+    MessageSignerImpl signer_;
+  };
+}  // namespace fc::vm::message
+
+#endif  // CPP_FILECOIN_CORE_VM_MESSAGE_SIGNING_SERVICE_HPP
@@ -6,15 +6,20 @@
 #ifndef FILECOIN_CORE_VM_RUNTIME_ENV_HPP
 #define FILECOIN_CORE_VM_RUNTIME_ENV_HPP
 
+#include "common/arena.hpp"
+#include "primitives/sector/sector.hpp"
 #include "primitives/tipset/tipset.hpp"
 #include "primitives/types.hpp"
 #include "storage/hamt/hamt.hpp"
 #include "vm/actor/invoker.hpp"
 #include "vm/runtime/pricelist.hpp"
+#include "vm/runtime/profiler.hpp"
+#include "vm/runtime/trace.hpp"
 #include "vm/state/impl/state_tree_impl.hpp"
 
 namespace fc::vm::runtime {
   using actor::Invoker;
+  using primitives::sector::SealVerifyInfo;
   using primitives::tipset::Tipset;
   using state::StateTreeImpl;
 
@@ -30,14 +35,36 @@ namespace fc::vm::runtime {
     outcome::result<MessageReceipt> applyMessage(const UnsignedMessage &message,
                                                  TokenAmount &penalty);
 
+    /// Applies message of known serialized size, without encoding it
+    outcome::result<MessageReceipt> applyMessage(const UnsignedMessage &message,
+                                                 size_t size,
+                                                 TokenAmount &penalty);
+
     outcome::result<InvocationOutput> applyImplicitMessage(
         UnsignedMessage message);
 
+    /// Adds gas paid by message to reward actor balance
+    outcome::result<void> creditGasReward(const UnsignedMessage &message,
+                                          GasAmount gas_used);
+
     std::shared_ptr<StateTreeImpl> state_tree;
     std::shared_ptr<Invoker> invoker;
     IpldPtr ipld;
     Tipset tipset;
     Pricelist pricelist;
+    /// Optional, collects actor method stats when set
+    std::shared_ptr<Profiler> profiler;
+    /// Message is applied speculatively, gas reward is credited by caller
+    bool speculative{false};
+    /// Optional, allocates execution objects, must outlive them
+    common::Arena *arena{};
+    /// Optional, send tree of each execution is appended when set
+    std::vector<MessageTrace> *traces{};
+    /**
+     * Optional, seal verifications are collected and reported valid instead
+     * of being verified when set. Only for throwaway executions.
+     */
+    std::vector<SealVerifyInfo> *deferred_seals{};
   };
 
   struct ChargingIpld;
@@ -55,12 +82,21 @@ namespace fc::vm::runtime {
 
     outcome::result<InvocationOutput> send(const UnsignedMessage &message);
 
+    /// Sends without recording trace
+    outcome::result<InvocationOutput> sendUntraced(
+        const UnsignedMessage &message);
+
     std::shared_ptr<Env> env;
     std::shared_ptr<StateTreeImpl> state_tree;
     std::shared_ptr<ChargingIpld> charging_ipld;
     GasAmount gas_used;
     GasAmount gas_limit;
     Address origin;
+    IpldCounters ipld_counters;
+    /// Index of trace of execution in env traces
+    size_t trace_index{};
+    /// Depth of current send in trace
+    uint64_t trace_depth{};
   };
 
   struct ChargingIpld : public Ipld,
@@ -17,10 +17,17 @@ namespace fc::vm::runtime {
   using actor::kRewardAddress;
   using actor::kSendMethodNumber;
   using actor::kSystemActorAddress;
+  using primitives::checkedMath;
   using storage::hamt::HamtError;
 
   outcome::result<MessageReceipt> Env::applyMessage(
       const UnsignedMessage &message, TokenAmount &penalty) {
+    OUTCOME_TRY(serialized_message, codec::cbor::encode(message));
+    return applyMessage(message, serialized_message.size(), penalty);
+  }
+
+  outcome::result<MessageReceipt> Env::applyMessage(
+      const UnsignedMessage &message, size_t size, TokenAmount &penalty) {
     if (message.gasLimit <= 0) {
       return RuntimeError::kUnknown;
     }
@@ -29,8 +36,7 @@ namespace fc::vm::runtime {
     MessageReceipt receipt;
     receipt.gas_used = 0;
 
-    OUTCOME_TRY(serialized_message, codec::cbor::encode(message));
-    auto msg_gas_cost{pricelist.onChainMessage(serialized_message.size())};
+    auto msg_gas_cost{pricelist.onChainMessage(size)};
     penalty = msg_gas_cost * message.gasPrice;
     if (msg_gas_cost > message.gasLimit) {
       receipt.exit_code = VMExitCode::kSysErrOutOfGas;
@@ -55,16 +61,24 @@ namespace fc::vm::runtime {
       return receipt;
     }
 
-    BigInt gas_cost = message.gasLimit * message.gasPrice;
-    if (from.balance < gas_cost + message.value) {
+    // token amounts fit fixed width, so gas math doesn't use BigInt, and gas
+    // cost isn't converted to BigInt and back between check and charge
+    auto balance_left{checkedMath(
+        [](auto balance, auto limit, auto price) -> decltype(balance) {
+          return balance - limit * price;
+        },
+        from.balance,
+        message.gasLimit,
+        message.gasPrice)};
+    if (balance_left < message.value) {
       receipt.exit_code = VMExitCode::kSysErrSenderStateInvalid;
       return receipt;
     }
-    from.balance -= gas_cost;
+    from.balance = std::move(balance_left);
     ++from.nonce;
     OUTCOME_TRY(state_tree->set(message.from, from));
 
-    OUTCOME_TRY(snapshot, state_tree->flush());
+    auto snapshot = state_tree->snapshot();
     OUTCOME_TRY(execution->chargeGas(msg_gas_cost));
     auto result = execution->send(message);
     auto exit_code = VMExitCode::kOk;
@@ -84,7 +98,7 @@ namespace fc::vm::runtime {
       }
     }
     if (exit_code != VMExitCode::kOk) {
-      OUTCOME_TRY(state_tree->revert(snapshot));
+      OUTCOME_TRY(state_tree->revertTo(snapshot));
     }
 
     BOOST_ASSERT_MSG(execution->gas_used >= 0, "negative used gas");
@@ -94,13 +108,19 @@ namespace fc::vm::runtime {
     auto gas_refund = message.gasLimit - execution->gas_used;
     if (gas_refund != 0) {
       OUTCOME_TRY(from, state_tree->get(message.from));
-      from.balance += gas_refund * message.gasPrice;
+      from.balance = checkedMath(
+          [](auto balance, auto refund, auto price) -> decltype(balance) {
+            return balance + refund * price;
+          },
+          from.balance,
+          gas_refund,
+          message.gasPrice);
       OUTCOME_TRY(state_tree->set(message.from, from));
     }
 
-    OUTCOME_TRY(reward, state_tree->get(kRewardAddress));
-    reward.balance += execution->gas_used * message.gasPrice;
-    OUTCOME_TRY(state_tree->set(kRewardAddress, reward));
+    if (!speculative) {
+      OUTCOME_TRY(creditGasReward(message, execution->gas_used));
+    }
 
     auto ret_code = normalizeVMExitCode(exit_code);
     BOOST_ASSERT_MSG(ret_code, "c++ actor code returned unknown error");
@@ -118,6 +138,19 @@ namespace fc::vm::runtime {
     return execution->send(message);
   }
 
+  outcome::result<void> Env::creditGasReward(const UnsignedMessage &message,
+                                             GasAmount gas_used) {
+    OUTCOME_TRY(reward, state_tree->get(kRewardAddress));
+    reward.balance = checkedMath(
+        [](auto balance, auto gas, auto price) -> decltype(balance) {
+          return balance + gas * price;
+        },
+        reward.balance,
+        gas_used,
+        message.gasPrice);
+    return state_tree->set(kRewardAddress, reward);
+  }
+
   outcome::result<void> Execution::chargeGas(GasAmount amount) {
     gas_used += amount;
     if (gas_limit != kInfiniteGas && gas_used > gas_limit) {
@@ -129,13 +162,25 @@ namespace fc::vm::runtime {
 
   std::shared_ptr<Execution> Execution::make(std::shared_ptr<Env> env,
                                              const UnsignedMessage &message) {
-    auto execution = std::make_shared<Execution>();
+    std::shared_ptr<Execution> execution;
+    if (env->arena) {
+      common::ArenaAllocator<Execution> allocator{*env->arena};
+      execution = std::allocate_shared<Execution>(allocator);
+      execution->charging_ipld =
+          std::allocate_shared<ChargingIpld>(allocator, execution);
+    } else {
+      execution = std::make_shared<Execution>();
+      execution->charging_ipld = std::make_shared<ChargingIpld>(execution);
+    }
     execution->env = env;
     execution->state_tree = env->state_tree;
-    execution->charging_ipld = std::make_shared<ChargingIpld>(execution);
     execution->gas_used = 0;
     execution->gas_limit = message.gasLimit;
     execution->origin = message.from;
+    if (env->traces) {
+      execution->trace_index = env->traces->size();
+      env->traces->emplace_back();
+    }
     return execution;
   }
 
@@ -162,10 +207,10 @@ namespace fc::vm::runtime {
 
   outcome::result<InvocationOutput> Execution::sendWithRevert(
       const UnsignedMessage &message) {
-    OUTCOME_TRY(snapshot, state_tree->flush());
+    auto snapshot = state_tree->snapshot();
     auto result = send(message);
     if (!result) {
-      OUTCOME_TRY(state_tree->revert(snapshot));
+      OUTCOME_TRY(state_tree->revertTo(snapshot));
       return result.error();
     }
     return result;
@@ -173,6 +218,32 @@ namespace fc::vm::runtime {
 
   outcome::result<InvocationOutput> Execution::send(
       const UnsignedMessage &message) {
+    if (!env->traces) {
+      return sendUntraced(message);
+    }
+    // nested sends grow trace, so send is referred by index
+    auto index{(*env->traces)[trace_index].sends.size()};
+    (*env->traces)[trace_index].sends.push_back({message.from,
+                                                 message.to,
+                                                 message.method,
+                                                 message.value,
+                                                 trace_depth});
+    auto gas_before{gas_used};
+    ++trace_depth;
+    auto result{sendUntraced(message)};
+    --trace_depth;
+    auto &send{(*env->traces)[trace_index].sends[index]};
+    send.gas_used = gas_used - gas_before;
+    if (result) {
+      send.return_value = result.value();
+    } else if (isVMExitCode(result.error())) {
+      send.exit_code = VMExitCode{result.error().value()};
+    }
+    return result;
+  }
+
+  outcome::result<InvocationOutput> Execution::sendUntraced(
+      const UnsignedMessage &message) {
     OUTCOME_TRY(chargeGas(env->pricelist.onMethodInvocation(
         message.value, message.method.method_number)));
 
@@ -203,8 +274,27 @@ namespace fc::vm::runtime {
     }
 
     if (message.method != kSendMethodNumber) {
+      auto profiler{env->profiler.get()};
+      std::chrono::steady_clock::time_point start;
+      auto gas_before{gas_used};
+      auto ipld_before{ipld_counters};
+      if (profiler) {
+        start = std::chrono::steady_clock::now();
+      }
       auto result = env->invoker->invoke(
           to_actor, runtime, message.method, message.params);
+      if (profiler) {
+        profiler->add(to_actor.code,
+                      message.method,
+                      std::chrono::steady_clock::now() - start,
+                      gas_used - gas_before,
+                      {
+                          ipld_counters.gets - ipld_before.gets,
+                          ipld_counters.get_bytes - ipld_before.get_bytes,
+                          ipld_counters.puts - ipld_before.puts,
+                          ipld_counters.put_bytes - ipld_before.put_bytes,
+                      });
+      }
       OUTCOME_TRYA(to_actor, state_tree->get(message.to));
       to_actor.head = runtime.getCurrentActorState();
       OUTCOME_TRY(state_tree->set(message.to, to_actor));
@@ -219,6 +309,8 @@ namespace fc::vm::runtime {
 
   outcome::result<void> ChargingIpld::set(const CID &key, Value value) {
     auto execution{execution_.lock()};
+    ++execution->ipld_counters.puts;
+    execution->ipld_counters.put_bytes += value.size();
     if (!kDisableChargingIpld) {
       OUTCOME_TRY(execution->chargeGas(
           execution->env->pricelist.onIpldPut(value.size())));
@@ -229,6 +321,8 @@ namespace fc::vm::runtime {
   outcome::result<Ipld::Value> ChargingIpld::get(const CID &key) const {
     auto execution{execution_.lock()};
     OUTCOME_TRY(value, execution->env->ipld->get(key));
+    ++execution->ipld_counters.gets;
+    execution->ipld_counters.get_bytes += value.size();
     if (!kDisableChargingIpld) {
       OUTCOME_TRY(execution->chargeGas(
           execution->env->pricelist.onIpldGet(value.size())));
@@ -0,0 +1,39 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/runtime/profiler.hpp"
+
+namespace fc::vm::runtime {
+  void Profiler::add(const CodeId &code,
+                     MethodNumber method,
+                     std::chrono::nanoseconds time,
+                     GasAmount gas,
+                     const IpldCounters &ipld) {
+    std::lock_guard lock{mutex_};
+    auto &stats{stats_[{code, method}]};
+    ++stats.calls;
+    stats.time += time;
+    stats.gas += gas;
+    stats.ipld.gets += ipld.gets;
+    stats.ipld.get_bytes += ipld.get_bytes;
+    stats.ipld.puts += ipld.puts;
+    stats.ipld.put_bytes += ipld.put_bytes;
+  }
+
+  std::vector<MethodProfile> Profiler::snapshot() const {
+    std::lock_guard lock{mutex_};
+    std::vector<MethodProfile> profiles;
+    profiles.reserve(stats_.size());
+    for (auto &[key, stats] : stats_) {
+      profiles.push_back({key.first, key.second, stats});
+    }
+    return profiles;
+  }
+
+  void Profiler::reset() {
+    std::lock_guard lock{mutex_};
+    stats_.clear();
+  }
+}  // namespace fc::vm::runtime
@@ -0,0 +1,190 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_VM_RUNTIME_LAZY_STATE_HPP
+#define CPP_FILECOIN_CORE_VM_RUNTIME_LAZY_STATE_HPP
+
+#include <algorithm>
+
+#include "storage/ipfs/datastore.hpp"
+
+namespace fc::vm::runtime {
+  using codec::cbor::CborDecodeError;
+  using codec::cbor::CborDecodeStream;
+  using codec::cbor::CborEncodeStream;
+  using common::Buffer;
+
+  /**
+   * Actor state, which is CBOR_TUPLE, with fields decoded on first access.
+   * Encoded elements of fields which were not changed are reused on flush,
+   * so method pays only for fields it reads or changes. Fields not read yet
+   * hold default values.
+   * @tparam T - CBOR_TUPLE state type
+   */
+  template <typename T>
+  class LazyState {
+   public:
+    /// Splits state into encoded tuple elements without decoding them
+    static outcome::result<LazyState> load(IpldPtr ipld, const CID &cid) {
+      OUTCOME_TRY(bytes, ipld->get(cid));
+      LazyState state{std::move(ipld), cid, std::move(bytes)};
+      OUTCOME_TRY(state.split());
+      return std::move(state);
+    }
+
+    /// Decodes fields not decoded yet
+    template <typename... Fields>
+    outcome::result<void> read(Fields T::*... fields) {
+      outcome::result<void> result{outcome::success()};
+      // decoding stops at first error
+      ((result = result ? decodeField(fields) : result), ...);
+      return result;
+    }
+
+    /// Decodes fields and marks them changed, so they are encoded on flush
+    template <typename... Fields>
+    outcome::result<void> change(Fields T::*... fields) {
+      OUTCOME_TRY(read(fields...));
+      for (auto index : {indexOf(fields)...}) {
+        changed_[index] = true;
+      }
+      return outcome::success();
+    }
+
+    T *operator->() {
+      return &value_;
+    }
+
+    T &operator*() {
+      return value_;
+    }
+
+    /**
+     * Encodes changed fields and stores state
+     * @return cid of state, which is loaded cid when nothing changed
+     */
+    outcome::result<CID> flush() {
+      if (std::none_of(
+              changed_.begin(), changed_.end(), [](auto c) { return c; })) {
+        return cid_;
+      }
+      try {
+        auto list{CborEncodeStream::list()};
+        size_t index{0};
+        outcome::result<void> flushed{outcome::success()};
+        cborTupleFields(value_, FieldVisitor{[&](auto &field) {
+                          if (changed_[index]) {
+                            if (flushed) {
+                              auto result{Ipld::flush(field)};
+                              if (!result) {
+                                flushed = result.error();
+                              }
+                            }
+                            list << field;
+                          } else {
+                            list << CborEncodeStream::wrap(element(index), 1);
+                          }
+                          ++index;
+                        }});
+        OUTCOME_TRY(flushed);
+        Buffer bytes{std::move(list).data()};
+        OUTCOME_TRY(cid, common::getCidOf(bytes));
+        OUTCOME_TRY(ipld_->set(cid, std::move(bytes)));
+        cid_ = cid;
+        return std::move(cid);
+      } catch (std::system_error &e) {
+        return outcome::failure(e.code());
+      }
+    }
+
+   private:
+    /// Passes each field to callback
+    template <typename F>
+    struct FieldVisitor {
+      template <typename Field>
+      FieldVisitor &operator<<(Field &field) {
+        visit(field);
+        return *this;
+      }
+
+      F visit;
+    };
+    template <typename F>
+    FieldVisitor(F) -> FieldVisitor<F>;
+
+    LazyState(IpldPtr ipld, const CID &cid, Buffer bytes)
+        : ipld_{std::move(ipld)},
+          cid_{cid},
+          bytes_{std::move(bytes)},
+          value_{codec::cbor::kDefaultT<T>()} {}
+
+    outcome::result<void> split() {
+      auto base{reinterpret_cast<const char *>(&value_)};
+      cborTupleFields(value_, FieldVisitor{[&](auto &field) {
+                        offsets_.push_back(
+                            reinterpret_cast<const char *>(&field) - base);
+                      }});
+      try {
+        auto s{CborDecodeStream::borrow(bytes_, true)};
+        if (!s.isList() || s.listLength() != offsets_.size()) {
+          return CborDecodeError::kWrongType;
+        }
+        auto list{s.list()};
+        for (size_t i{0}; i < offsets_.size(); ++i) {
+          auto raw{list.rawView()};
+          elements_.emplace_back(raw.data() - bytes_.data(), raw.size());
+        }
+        if (s.error()) {
+          return outcome::failure(s.error());
+        }
+      } catch (std::system_error &e) {
+        return outcome::failure(e.code());
+      }
+      decoded_.resize(offsets_.size(), false);
+      changed_.resize(offsets_.size(), false);
+      return outcome::success();
+    }
+
+    gsl::span<const uint8_t> element(size_t index) const {
+      auto [offset, size]{elements_[index]};
+      return gsl::make_span(bytes_).subspan(offset, size);
+    }
+
+    /// Index of tuple element of field, which must be one of tuple fields
+    template <typename Field>
+    size_t indexOf(Field T::*field) const {
+      auto offset{reinterpret_cast<const char *>(&(value_.*field))
+                  - reinterpret_cast<const char *>(&value_)};
+      return std::find(offsets_.begin(), offsets_.end(), offset)
+             - offsets_.begin();
+    }
+
+    template <typename Field>
+    outcome::result<void> decodeField(Field T::*field) {
+      auto index{indexOf(field)};
+      if (index == offsets_.size()) {
+        return CborDecodeError::kWrongType;
+      }
+      if (!decoded_[index]) {
+        OUTCOME_TRYA(value_.*field, ipld_->decode<Field>(element(index)));
+        decoded_[index] = true;
+      }
+      return outcome::success();
+    }
+
+    IpldPtr ipld_;
+    CID cid_;
+    Buffer bytes_;
+    /// Offset and size of encoded element of each field in bytes
+    std::vector<std::pair<size_t, size_t>> elements_;
+    /// Offset of each field in state object, in tuple order
+    std::vector<ptrdiff_t> offsets_;
+    std::vector<bool> decoded_;
+    std::vector<bool> changed_;
+    T value_;
+  };
+}  // namespace fc::vm::runtime
+
+#endif  // CPP_FILECOIN_CORE_VM_RUNTIME_LAZY_STATE_HPP
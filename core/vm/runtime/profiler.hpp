@@ -0,0 +1,66 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_VM_RUNTIME_PROFILER_HPP
+#define CPP_FILECOIN_CORE_VM_RUNTIME_PROFILER_HPP
+
+#include <chrono>
+#include <map>
+#include <mutex>
+
+#include "primitives/types.hpp"
+#include "vm/actor/actor.hpp"
+
+namespace fc::vm::runtime {
+  using actor::CodeId;
+  using actor::MethodNumber;
+  using primitives::GasAmount;
+
+  /// Ipld operations done through charging ipld of execution
+  struct IpldCounters {
+    uint64_t gets{};
+    uint64_t get_bytes{};
+    uint64_t puts{};
+    uint64_t put_bytes{};
+  };
+
+  /// Totals of actor method invocations, nested sends are included
+  struct MethodStats {
+    uint64_t calls{};
+    std::chrono::nanoseconds time{};
+    GasAmount gas{};
+    IpldCounters ipld;
+  };
+
+  /// Stats of one actor code and method
+  struct MethodProfile {
+    CodeId code;
+    MethodNumber method;
+    MethodStats stats;
+  };
+
+  /**
+   * Collects per actor code and method invocation stats.
+   * Shared by executions of interpreter, so may be written concurrently.
+   */
+  class Profiler {
+   public:
+    void add(const CodeId &code,
+             MethodNumber method,
+             std::chrono::nanoseconds time,
+             GasAmount gas,
+             const IpldCounters &ipld);
+
+    std::vector<MethodProfile> snapshot() const;
+
+    void reset();
+
+   private:
+    mutable std::mutex mutex_;
+    std::map<std::pair<CodeId, MethodNumber>, MethodStats> stats_;
+  };
+}  // namespace fc::vm::runtime
+
+#endif  // CPP_FILECOIN_CORE_VM_RUNTIME_PROFILER_HPP
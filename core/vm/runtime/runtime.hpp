@@ -20,6 +20,7 @@
 #include "vm/actor/actor_encoding.hpp"
 #include "vm/exit_code/exit_code.hpp"
 #include "vm/message/message.hpp"
+#include "vm/runtime/lazy_state.hpp"
 #include "vm/runtime/runtime_types.hpp"
 
 namespace fc::vm::runtime {
@@ -228,6 +229,29 @@ namespace fc::vm::runtime {
       return outcome::success();
     }
 
+    /**
+     * Get current actor state with fields decoded on first access
+     * @tparam T - CBOR_TUPLE state type
+     * @return state, which decodes fields on read or change
+     */
+    template <typename T>
+    outcome::result<LazyState<T>> getCurrentActorStateLazy() {
+      return LazyState<T>::load(getIpfsDatastore(), getCurrentActorState());
+    }
+
+    /**
+     * Commit actor state, encoding only changed fields
+     * @tparam T - CBOR_TUPLE state type
+     * @param state - lazily decoded actor state
+     * @return error in case of failure
+     */
+    template <typename T>
+    outcome::result<void> commitState(LazyState<T> &state) {
+      OUTCOME_TRY(state_cid, state.flush());
+      OUTCOME_TRY(commit(state_cid));
+      return outcome::success();
+    }
+
     inline operator std::shared_ptr<IpfsDatastore>() {
       return getIpfsDatastore();
     }
@@ -0,0 +1,54 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_VM_RUNTIME_TRACE_HPP
+#define CPP_FILECOIN_CORE_VM_RUNTIME_TRACE_HPP
+
+#include "codec/cbor/streams_annotation.hpp"
+#include "common/buffer.hpp"
+#include "primitives/address/address_codec.hpp"
+#include "primitives/big_int.hpp"
+#include "primitives/types.hpp"
+#include "vm/actor/actor.hpp"
+#include "vm/exit_code/exit_code.hpp"
+
+namespace fc::vm::runtime {
+  using actor::MethodNumber;
+  using common::Buffer;
+  using primitives::GasAmount;
+  using primitives::TokenAmount;
+  using primitives::address::Address;
+
+  /// Send done by execution, nested sends follow it with greater depth
+  struct TraceSend {
+    Address from;
+    Address to;
+    MethodNumber method;
+    TokenAmount value;
+    /// Zero for message itself
+    uint64_t depth{};
+    VMExitCode exit_code{VMExitCode::kOk};
+    /// Gas of send including nested sends
+    GasAmount gas_used{};
+    Buffer return_value;
+  };
+  CBOR_TUPLE(TraceSend,
+             from,
+             to,
+             method,
+             value,
+             depth,
+             exit_code,
+             gas_used,
+             return_value)
+
+  /// Send tree of one message execution, flattened in pre-order
+  struct MessageTrace {
+    std::vector<TraceSend> sends;
+  };
+  CBOR_TUPLE(MessageTrace, sends)
+}  // namespace fc::vm::runtime
+
+#endif  // CPP_FILECOIN_CORE_VM_RUNTIME_TRACE_HPP
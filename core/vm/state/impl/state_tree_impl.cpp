@@ -20,21 +20,49 @@ namespace fc::vm::state {
   outcome::result<void> StateTreeImpl::set(const Address &address,
                                            const Actor &actor) {
     OUTCOME_TRY(address_id, lookupId(address));
-    return by_id.set(address_id, actor);
+    auto it = dirty_.find(address_id);
+    if (it == dirty_.end()) {
+      journal_.emplace_back(address_id, boost::none);
+      dirty_.emplace(address_id, actor);
+    } else {
+      journal_.emplace_back(address_id, it->second);
+      it->second = actor;
+    }
+    return outcome::success();
   }
 
   outcome::result<Actor> StateTreeImpl::get(const Address &address) {
     OUTCOME_TRY(address_id, lookupId(address));
-    return by_id.get(address_id);
+    if (track_reads_) {
+      reads_.insert(address_id);
+    }
+    auto it = dirty_.find(address_id);
+    if (it != dirty_.end()) {
+      return it->second;
+    }
+    auto clean = clean_.find(address_id);
+    if (clean != clean_.end()) {
+      return clean->second;
+    }
+    OUTCOME_TRY(actor, by_id.get(address_id));
+    clean_.emplace(address_id, actor);
+    return std::move(actor);
   }
 
   outcome::result<Address> StateTreeImpl::lookupId(const Address &address) {
     if (address.isId()) {
       return address;
     }
+    auto it = ids_.find(address);
+    if (it != ids_.end()) {
+      return it->second;
+    }
     OUTCOME_TRY(init_actor_state, state<InitActorState>(actor::kInitAddress));
     OUTCOME_TRY(id, init_actor_state.address_map.get(address));
-    return Address::makeFromId(id);
+    // missing addresses are not cached, they may be registered later
+    auto address_id = Address::makeFromId(id);
+    ids_.emplace(address, address_id);
+    return std::move(address_id);
   }
 
   outcome::result<Address> StateTreeImpl::registerNewAddress(
@@ -45,20 +73,67 @@ namespace fc::vm::state {
     OUTCOME_TRY(address_id, init_actor_state.addActor(address));
     OUTCOME_TRYA(init_actor.head, store_->setCbor(init_actor_state));
     OUTCOME_TRY(set(actor::kInitAddress, init_actor));
+    ids_.emplace(address, address_id);
     return std::move(address_id);
   }
 
   outcome::result<CID> StateTreeImpl::flush() {
+    for (auto &pair : dirty_) {
+      OUTCOME_TRY(by_id.set(pair.first, pair.second));
+    }
+    for (auto &pair : dirty_) {
+      clean_[pair.first] = std::move(pair.second);
+    }
+    dirty_.clear();
+    journal_.clear();
     OUTCOME_TRY(Ipld::flush(by_id));
     return by_id.hamt.cid();
   }
 
   outcome::result<void> StateTreeImpl::revert(const CID &root) {
     by_id = {root, store_};
+    dirty_.clear();
+    clean_.clear();
+    ids_.clear();
+    journal_.clear();
+    return outcome::success();
+  }
+
+  StateTree::Snapshot StateTreeImpl::snapshot() {
+    return journal_.size();
+  }
+
+  outcome::result<void> StateTreeImpl::revertTo(Snapshot snapshot) {
+    BOOST_ASSERT_MSG(snapshot <= journal_.size(), "invalid snapshot");
+    while (journal_.size() > snapshot) {
+      auto &change = journal_.back();
+      if (change.first == actor::kInitAddress) {
+        // reverted init actor state may not have some cached addresses
+        ids_.clear();
+      }
+      if (change.second) {
+        dirty_[change.first] = std::move(*change.second);
+      } else {
+        dirty_.erase(change.first);
+      }
+      journal_.pop_back();
+    }
     return outcome::success();
   }
 
   std::shared_ptr<IpfsDatastore> StateTreeImpl::getStore() {
     return store_;
   }
+
+  void StateTreeImpl::trackReads() {
+    track_reads_ = true;
+  }
+
+  const std::set<Address> &StateTreeImpl::reads() const {
+    return reads_;
+  }
+
+  const std::map<Address, Actor> &StateTreeImpl::dirty() const {
+    return dirty_;
+  }
 }  // namespace fc::vm::state
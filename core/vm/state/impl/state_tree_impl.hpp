@@ -8,6 +8,11 @@
 
 #include "vm/state/state_tree.hpp"
 
+#include <map>
+#include <set>
+
+#include <boost/optional.hpp>
+
 #include "adt/address_key.hpp"
 #include "adt/map.hpp"
 
@@ -31,12 +36,33 @@ namespace fc::vm::state {
     outcome::result<CID> flush() override;
     /// Revert changes to last flushed state
     outcome::result<void> revert(const CID &root) override;
+    /// Take in-memory snapshot of current state
+    Snapshot snapshot() override;
+    /// Revert changes made after snapshot
+    outcome::result<void> revertTo(Snapshot snapshot) override;
     /// Get store
     std::shared_ptr<IpfsDatastore> getStore() override;
 
+    /// Start recording id addresses of actors read, including missing ones
+    void trackReads();
+    /// Actors read since trackReads, lookups of key addresses read init actor
+    const std::set<Address> &reads() const;
+    /// Actors changed since last flush
+    const std::map<Address, Actor> &dirty() const;
+
    private:
     std::shared_ptr<IpfsDatastore> store_;
     adt::Map<actor::Actor, adt::AddressKeyer> by_id;
+    /// Actors changed since last flush, not yet written to hamt
+    std::map<Address, Actor> dirty_;
+    /// Actors read from or flushed to hamt, valid until revert to root
+    std::map<Address, Actor> clean_;
+    /// Id addresses of key addresses found in init actor state
+    std::map<Address, Address> ids_;
+    /// Previous dirty values for snapshot revert, none if was not dirty
+    std::vector<std::pair<Address, boost::optional<Actor>>> journal_;
+    bool track_reads_{false};
+    std::set<Address> reads_;
   };
 }  // namespace fc::vm::state
 
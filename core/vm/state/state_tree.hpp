@@ -18,6 +18,9 @@ namespace fc::vm::state {
   /// State tree
   class StateTree {
    public:
+    /// Handle of in-memory snapshot
+    using Snapshot = size_t;
+
     virtual ~StateTree() = default;
 
     /// Set actor state, does not write to storage
@@ -39,6 +42,12 @@ namespace fc::vm::state {
     /// Revert changes to last flushed state
     virtual outcome::result<void> revert(const CID &root) = 0;
 
+    /// Take in-memory snapshot of current state, does not write to storage
+    virtual Snapshot snapshot() = 0;
+
+    /// Revert changes made after snapshot, does not write to storage
+    virtual outcome::result<void> revertTo(Snapshot snapshot) = 0;
+
     /// Get store
     virtual std::shared_ptr<IpfsDatastore> getStore() = 0;
 
@@ -0,0 +1,33 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include "adt/array.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::adt::Array;
+
+/**
+ * @given array with sparse keys
+ * @when pop range of keys
+ * @then values in range are visited in order and removed, others stay
+ */
+TEST(ArrayTest, PopRange) {
+  Array<int> array{std::make_shared<fc::storage::ipfs::InMemoryDatastore>()};
+  for (auto key : {1, 5, 9, 200}) {
+    EXPECT_OUTCOME_TRUE_1(array.set(key, key * 10));
+  }
+  std::vector<int> popped;
+  auto visitor{[&](auto, auto &value) -> fc::outcome::result<void> {
+    popped.push_back(value);
+    return fc::outcome::success();
+  }};
+  EXPECT_OUTCOME_TRUE_1(array.popRange(0, 10, visitor));
+  EXPECT_EQ(popped, (std::vector<int>{10, 50, 90}));
+  EXPECT_OUTCOME_EQ(array.has(9), false);
+  EXPECT_OUTCOME_EQ(array.get(200), 2000);
+}
@@ -89,3 +89,20 @@ TEST_F(BalanceTableHamtTest, SubtractWithMinimum) {
                     subtrahend);
   EXPECT_OUTCOME_EQ(table->get(address), difference);
 }
+
+/**
+ * @given a balance table with records
+ * @when add amounts for several addresses at once
+ * @then balances are increased, absent address fails
+ */
+TEST_F(BalanceTableHamtTest, AddMany) {
+  Address other{Address::makeFromId(456)};
+  EXPECT_OUTCOME_TRUE_1(table->set(address, 10));
+  EXPECT_OUTCOME_TRUE_1(table->set(other, 20));
+  EXPECT_OUTCOME_TRUE_1(
+      table->addMany({{address, 1}, {other, 2}, {address, 3}}));
+  EXPECT_OUTCOME_EQ(table->get(address), 14);
+  EXPECT_OUTCOME_EQ(table->get(other), 22);
+  EXPECT_OUTCOME_ERROR(HamtError::kNotFound,
+                       table->addMany({{Address::makeFromId(789), 1}}));
+}
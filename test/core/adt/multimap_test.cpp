@@ -84,3 +84,13 @@ TEST_F(MultimapTest, ReloadFromCid) {
   mmap = {mmap.hamt.cid(), ipld};
   expectVisitValues();
 }
+
+/**
+ * @given multimap with no items on key
+ * @when append values at once and visit
+ * @then items visited in order of insertion
+ */
+TEST_F(MultimapTest, AppendMany) {
+  EXPECT_OUTCOME_TRUE_1(Multimap::appendMany(mmap, key, values));
+  expectVisitValues();
+}
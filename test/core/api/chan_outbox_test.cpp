@@ -0,0 +1,188 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "api/rpc/chan_outbox.hpp"
+
+#include <future>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace fc::api::rpc {
+  /// Records values passed to session, completes their writes on demand
+  class ChanOutboxTest : public ::testing::Test {
+   public:
+    std::shared_ptr<ChanOutbox<int>> makeOutbox(size_t capacity,
+                                                ChanOverflow overflow) {
+      return std::make_shared<ChanOutbox<int>>(
+          capacity,
+          overflow,
+          [this](int value, auto sent) {
+            std::lock_guard lock{mutex};
+            values.push_back(value);
+            pending.push_back(std::move(sent));
+          },
+          [this] { ++closes; });
+    }
+
+    /// Completes oldest write
+    void sent(bool ok = true) {
+      ChanOutbox<int>::Sent cb;
+      {
+        std::lock_guard lock{mutex};
+        cb = std::move(pending.front());
+        pending.erase(pending.begin());
+      }
+      cb(ok);
+    }
+
+    void sentAll() {
+      while (!pending.empty()) {
+        sent();
+      }
+    }
+
+    std::mutex mutex;
+    std::vector<int> values;
+    std::vector<ChanOutbox<int>::Sent> pending;
+    size_t closes{};
+  };
+
+  /**
+   * @given outbox of capacity 2 dropping oldest values
+   * @when more values are pushed than are in flight and queued
+   * @then oldest queued value is dropped, others are sent in order
+   */
+  TEST_F(ChanOutboxTest, DropOldest) {
+    auto outbox{makeOutbox(2, ChanOverflow::kDropOldest)};
+    for (auto i{0}; i < 7; ++i) {
+      EXPECT_TRUE(outbox->push(i));
+    }
+    EXPECT_EQ(values.size(), kChanMaxInFlight);
+    EXPECT_EQ(outbox->queued(), 2);
+    EXPECT_EQ(outbox->dropped(), 1);
+    sentAll();
+    EXPECT_EQ(values, (std::vector<int>{0, 1, 2, 3, 5, 6}));
+    EXPECT_EQ(closes, 0);
+  }
+
+  /**
+   * @given outbox coalescing values without merge function
+   * @when values overflow queue
+   * @then queue is replaced by latest value
+   */
+  TEST_F(ChanOutboxTest, Coalesce) {
+    auto outbox{makeOutbox(1, ChanOverflow::kCoalesce)};
+    for (auto i{0}; i < 8; ++i) {
+      EXPECT_TRUE(outbox->push(i));
+    }
+    EXPECT_EQ(outbox->queued(), 1);
+    EXPECT_EQ(outbox->dropped(), 3);
+    sentAll();
+    EXPECT_EQ(values, (std::vector<int>{0, 1, 2, 3, 7}));
+  }
+
+  /**
+   * @given outbox closing channel on overflow
+   * @when values overflow queue
+   * @then close is sent and channel is not read anymore
+   */
+  TEST_F(ChanOutboxTest, CloseOnOverflow) {
+    auto outbox{makeOutbox(1, ChanOverflow::kClose)};
+    for (size_t i{0}; i <= kChanMaxInFlight; ++i) {
+      EXPECT_TRUE(outbox->push(static_cast<int>(i)));
+    }
+    EXPECT_FALSE(outbox->push(100));
+    EXPECT_EQ(closes, 1);
+    EXPECT_FALSE(outbox->push(101));
+    sentAll();
+    EXPECT_EQ(values.size(), kChanMaxInFlight);
+  }
+
+  /**
+   * @given outbox with queued values
+   * @when channel is closed by writer
+   * @then close is sent after queued values are written
+   */
+  TEST_F(ChanOutboxTest, CloseAfterQueued) {
+    auto outbox{makeOutbox(4, ChanOverflow::kWait)};
+    for (auto i{0}; i < 6; ++i) {
+      EXPECT_TRUE(outbox->push(i));
+    }
+    EXPECT_TRUE(outbox->push(boost::none));
+    EXPECT_EQ(closes, 0);
+    while (pending.size() > 1) {
+      sent();
+    }
+    EXPECT_EQ(closes, 0);
+    sent();
+    EXPECT_EQ(closes, 1);
+    EXPECT_EQ(values.size(), 6);
+  }
+
+  /**
+   * @given outbox with value in flight
+   * @when session fails to write value
+   * @then queued values are dropped, channel is not read and close is not sent
+   */
+  TEST_F(ChanOutboxTest, SendFailed) {
+    auto outbox{makeOutbox(4, ChanOverflow::kWait)};
+    for (auto i{0}; i < 6; ++i) {
+      EXPECT_TRUE(outbox->push(i));
+    }
+    sent(false);
+    EXPECT_FALSE(outbox->push(10));
+    EXPECT_EQ(outbox->queued(), 0);
+    sentAll();
+    EXPECT_EQ(values.size(), kChanMaxInFlight);
+    EXPECT_EQ(closes, 0);
+  }
+
+  /**
+   * @given waiting outbox with full queue
+   * @when writer waits for room
+   * @then writer waits until subscriber takes queued value, value is kept by
+   * writer until then
+   */
+  TEST_F(ChanOutboxTest, WaitForSubscriber) {
+    auto outbox{makeOutbox(1, ChanOverflow::kWait)};
+    for (size_t i{0}; i <= kChanMaxInFlight; ++i) {
+      EXPECT_TRUE(outbox->waitRoom());
+      EXPECT_TRUE(outbox->push(static_cast<int>(i)));
+    }
+    auto writer{std::async(std::launch::async, [&] {
+      return outbox->waitRoom()
+             && outbox->push(static_cast<int>(kChanMaxInFlight + 1));
+    })};
+    EXPECT_EQ(writer.wait_for(std::chrono::milliseconds{50}),
+              std::future_status::timeout);
+    EXPECT_EQ(outbox->queued(), 1);
+    sent();
+    EXPECT_TRUE(writer.get());
+    EXPECT_EQ(outbox->queued(), 1);
+    sentAll();
+    std::vector<int> expected(kChanMaxInFlight + 2);
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(values, expected);
+  }
+
+  /**
+   * @given waiting outbox with full queue
+   * @when value is pushed without waiting
+   * @then value is queued over capacity and sent later
+   */
+  TEST_F(ChanOutboxTest, WaitPushNeverDrops) {
+    auto outbox{makeOutbox(1, ChanOverflow::kWait)};
+    for (size_t i{0}; i <= kChanMaxInFlight + 1; ++i) {
+      EXPECT_TRUE(outbox->push(static_cast<int>(i)));
+    }
+    EXPECT_EQ(outbox->queued(), 2);
+    EXPECT_EQ(outbox->dropped(), 0);
+    sentAll();
+    EXPECT_EQ(values.size(), kChanMaxInFlight + 2);
+  }
+}  // namespace fc::api::rpc
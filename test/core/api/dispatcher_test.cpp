@@ -0,0 +1,114 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "api/rpc/dispatcher.hpp"
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace fc::api::rpc {
+  /**
+   * @given dispatcher with limit of one call for heavy method
+   * @when second heavy call and light call are dispatched while first heavy
+   * call runs
+   * @then second heavy call is queued, light call runs
+   */
+  TEST(RpcDispatcher, LimitsMethod) {
+    Dispatcher dispatcher{
+        {2, {"ChainHead"}, {"Heavy", "Light"}, {{"Heavy", 1}}}};
+    std::promise<void> release;
+    auto released{release.get_future().share()};
+    std::promise<void> heavy_started, light_done, heavy_done;
+    dispatcher.dispatch("Heavy", [&] {
+      heavy_started.set_value();
+      released.wait();
+    });
+    heavy_started.get_future().wait();
+    dispatcher.dispatch("Heavy", [&] { heavy_done.set_value(); });
+    dispatcher.dispatch("Light", [&] { light_done.set_value(); });
+    light_done.get_future().wait();
+
+    auto stats{dispatcher.stats()};
+    EXPECT_EQ(stats["Heavy"].running, 1);
+    EXPECT_EQ(stats["Heavy"].queued, 1);
+
+    release.set_value();
+    heavy_done.get_future().wait();
+    // completion is counted after call returns
+    while (dispatcher.stats()["Heavy"].completed != 2) {
+      std::this_thread::yield();
+    }
+    stats = dispatcher.stats();
+    EXPECT_EQ(stats["Heavy"].running, 0);
+    EXPECT_EQ(stats["Heavy"].queued, 0);
+  }
+
+  /**
+   * @given dispatcher with inline method
+   * @when inline method is dispatched
+   * @then it is called synchronously on calling thread
+   */
+  TEST(RpcDispatcher, Inline) {
+    Dispatcher dispatcher{{1, {"ChainHead"}, {}, {}}};
+    auto thread{std::this_thread::get_id()};
+    auto called{false};
+    dispatcher.dispatch("ChainHead", [&] {
+      EXPECT_EQ(std::this_thread::get_id(), thread);
+      called = true;
+    });
+    EXPECT_TRUE(called);
+  }
+
+  /**
+   * @given dispatcher with two threads
+   * @when two calls of method not marked pool safe are dispatched
+   * @then second call starts after first returns
+   */
+  TEST(RpcDispatcher, Serial) {
+    Dispatcher dispatcher{{2, {}, {}, {}}};
+    std::promise<void> release;
+    auto released{release.get_future().share()};
+    std::promise<void> first_started, second_done;
+    std::atomic_bool first_done{false};
+    dispatcher.dispatch("Unsafe", [&] {
+      first_started.set_value();
+      released.wait();
+      first_done = true;
+    });
+    first_started.get_future().wait();
+    dispatcher.dispatch("Other", [&] {
+      EXPECT_TRUE(first_done);
+      second_done.set_value();
+    });
+    auto second{second_done.get_future()};
+    EXPECT_EQ(second.wait_for(std::chrono::milliseconds{50}),
+              std::future_status::timeout);
+    release.set_value();
+    second.wait();
+  }
+
+  /**
+   * @given dispatcher owned by its call
+   * @when call releases last reference after it returns
+   * @then dispatcher is destroyed without joining own thread
+   */
+  TEST(RpcDispatcher, DestroyedByCall) {
+    auto dispatcher{
+        std::make_shared<Dispatcher>(DispatcherConfig{1, {}, {}, {}})};
+    std::weak_ptr<Dispatcher> weak{dispatcher};
+    std::promise<void> release;
+    auto released{release.get_future().share()};
+    dispatcher->dispatch("Method",
+                         [owner{dispatcher}, released] { released.wait(); });
+    dispatcher.reset();
+    release.set_value();
+    while (!weak.expired()) {
+      std::this_thread::yield();
+    }
+  }
+}  // namespace fc::api::rpc
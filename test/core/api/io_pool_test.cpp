@@ -0,0 +1,55 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "api/rpc/io_pool.hpp"
+
+#include <gtest/gtest.h>
+#include <boost/asio/post.hpp>
+#include <future>
+#include <set>
+
+using fc::api::rpc::IoPool;
+
+/**
+ * @given pool of three io threads
+ * @when io contexts are taken for sessions
+ * @then they are taken round-robin and each runs on own thread
+ */
+TEST(IoPoolTest, RoundRobin) {
+  IoPool pool{3};
+  EXPECT_EQ(pool.size(), 3);
+  std::vector<boost::asio::io_context *> ios;
+  for (size_t i{0}; i < 4; ++i) {
+    ios.push_back(&pool.next());
+  }
+  EXPECT_NE(ios[0], ios[1]);
+  EXPECT_NE(ios[1], ios[2]);
+  EXPECT_EQ(ios[0], ios[3]);
+
+  std::set<std::thread::id> threads;
+  for (size_t i{0}; i < pool.size(); ++i) {
+    std::promise<std::thread::id> id;
+    boost::asio::post(pool.at(i),
+                      [&] { id.set_value(std::this_thread::get_id()); });
+    threads.insert(id.get_future().get());
+  }
+  EXPECT_EQ(threads.size(), 3);
+  EXPECT_EQ(threads.count(std::this_thread::get_id()), 0);
+}
+
+/**
+ * @given pool without threads requested
+ * @when it is created and stopped twice
+ * @then it has one thread and stops once
+ */
+TEST(IoPoolTest, Stop) {
+  IoPool pool{0};
+  EXPECT_EQ(pool.size(), 1);
+  std::promise<void> ran;
+  boost::asio::post(pool.next(), [&] { ran.set_value(); });
+  ran.get_future().get();
+  pool.stop();
+  pool.stop();
+}
@@ -174,3 +174,25 @@ TEST(ApiJsonTest, MsgWait) {
       "},\"Timestamp\":8,\"BlockSig\":{\"Type\":1,\"Data\":" J65
       "},\"ForkSignaling\":9}],\"Height\":3}}");
 }
+
+/// Streamed encoding equals document encoding, output is split into chunks
+TEST(ApiJsonTest, Stream) {
+  std::map<std::string, std::vector<TipsetKey>> value{
+      {"a", {TipsetKey{}}},
+      {"b", {}},
+  };
+  std::vector<std::string> chunks;
+  fc::api::ChunkedOutput output{4, [&](auto chunk) {
+                                  EXPECT_EQ(chunk.size(), 4);
+                                  chunks.push_back(chunk);
+                                }};
+  fc::api::JsonWriter writer{output};
+  fc::api::encodeStream(writer, value);
+  std::string json;
+  for (auto &chunk : chunks) {
+    json += chunk;
+  }
+  json += output.finish();
+  EXPECT_GT(chunks.size(), 1);
+  EXPECT_EQ(json, jsonEncode(fc::api::encode(value)));
+}
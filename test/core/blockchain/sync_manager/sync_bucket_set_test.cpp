@@ -43,12 +43,31 @@ struct SyncBucketSetTest : public SyncTargetBucketTest {
   boost::optional<SyncBucketSetMock> bucket_set2;
 };
 
-/** check insert tipset */
+/** check insert tipset of other chain makes new bucket */
 TEST_F(SyncBucketSetTest, InsertTipsetSuccess) {
   bucket_set1->insert(tipset2);
   auto &bs = bucket_set1->getBuckets();
+  ASSERT_EQ(bs.size(), 2);
+  ASSERT_EQ(bs[0].tipsets.size(), 1);
+  ASSERT_EQ(bs[1].tipsets.size(), 1);
+}
+
+/** tipset between chains of two buckets merges them */
+TEST_F(SyncBucketSetTest, InsertJoinsBuckets) {
+  auto child = [](const Tipset &parent) {
+    auto block = parent.blks[0];
+    block.parents = parent.cids;
+    ++block.height;
+    return Tipset::create({block}).value();
+  };
+  auto middle = child(tipset1);
+  auto top = child(middle);
+  bucket_set1->insert(top);
+  ASSERT_EQ(bucket_set1->getBuckets().size(), 2);
+  bucket_set1->insert(middle);
+  auto &bs = bucket_set1->getBuckets();
   ASSERT_EQ(bs.size(), 1);
-  ASSERT_EQ(bs[0].tipsets.size(), 2);
+  ASSERT_EQ(bs[0].tipsets.size(), 3);
 }
 
 TEST_F(SyncBucketSetTest, AppendTipsetSuccess) {
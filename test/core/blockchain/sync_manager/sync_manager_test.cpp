@@ -3,12 +3,84 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
-#include <gtest/gtest.h>
-
 #include "blockchain/impl/sync_manager_impl.hpp"
 
-using namespace fc::blockchain;
+#include "core/blockchain/sync_manager/sync_target_bucket_test.hpp"
+#include "testutil/peer_id.hpp"
+
+using fc::blockchain::sync_manager::SyncCallback;
+using fc::blockchain::sync_manager::SyncManagerImpl;
+
+struct SyncManagerTest : public SyncTargetBucketTest {
+  void SetUp() override {
+    SyncTargetBucketTest::SetUp();
+    manager = std::make_shared<SyncManagerImpl>(
+        io,
+        [this](auto &ts, auto &, auto cb) {
+          synced.push_back(ts);
+          callbacks.push_back(cb);
+        },
+        [this](auto &ts, auto &, auto) { fetched.push_back(ts); });
+  }
+
+  Tipset child(const Tipset &parent, int64_t weight) {
+    auto block = parent.blks[0];
+    block.parents = parent.cids;
+    block.parent_weight = weight;
+    ++block.height;
+    return Tipset::create({block}).value();
+  }
+
+  void run() {
+    io.restart();
+    io.run();
+  }
+
+  boost::asio::io_context io;
+  PeerId peer{generatePeerId(1)};
+  std::shared_ptr<SyncManagerImpl> manager;
+  std::vector<Tipset> synced;
+  std::vector<SyncCallback> callbacks;
+  std::vector<Tipset> fetched;
+};
 
-/** No tests yet, they will be added after Syncer is implemented */
+/**
+ * @given chain being synced
+ * @when head of other chain is reported
+ * @then its headers are fetched by worker @and it is synced after first chain
+ */
+TEST_F(SyncManagerTest, FetchOtherBuckets) {
+  auto first = child(tipset1, 10);
+  auto other = child(tipset2, 5);
+  EXPECT_OUTCOME_TRUE_1(manager->setPeerHead(peer, first));
+  EXPECT_OUTCOME_TRUE_1(manager->setPeerHead(generatePeerId(2), other));
+  ASSERT_EQ(synced, std::vector<Tipset>{first});
+  ASSERT_EQ(fetched, std::vector<Tipset>{other});
+
+  callbacks[0](fc::outcome::success());
+  run();
+  EXPECT_TRUE(manager->isBootstrapped());
+  ASSERT_EQ(synced, (std::vector<Tipset>{first, other}));
+}
+
+/**
+ * @given chain being synced
+ * @when child of its head is reported
+ * @then child joins active bucket and is synced next
+ */
+TEST_F(SyncManagerTest, JoinActiveBucket) {
+  auto first = child(tipset1, 10);
+  auto next = child(first, 20);
+  EXPECT_OUTCOME_TRUE_1(manager->setPeerHead(peer, first));
+  EXPECT_OUTCOME_TRUE_1(manager->setPeerHead(peer, next));
+  EXPECT_TRUE(manager->syncQueue().isEmpty());
+  ASSERT_EQ(manager->activeBucket()->getSize(), 2);
+  EXPECT_TRUE(fetched.empty());
 
-// TODO: (yuraz) FIL-176 : add tests for sync manager after sincer is implemented
+  callbacks[0](fc::outcome::success());
+  run();
+  ASSERT_EQ(synced, (std::vector<Tipset>{first, next}));
+  callbacks[1](fc::outcome::success());
+  run();
+  EXPECT_FALSE(manager->activeBucket());
+}
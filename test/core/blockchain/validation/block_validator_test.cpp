@@ -46,7 +46,8 @@ class BlockValidatorTest : public testing::Test {
 
   std::shared_ptr<BlockValidator> validator_;
 
-  std::shared_ptr<BlockValidator> createValidator() {
+  std::shared_ptr<BlockValidator> createValidator(
+      std::shared_ptr<boost::asio::thread_pool> pool = nullptr) {
     auto datastore = std::make_shared<DataStore>();
     auto utc_clock = std::make_shared<UTCClockMock>();
     std::chrono::duration<uint64_t> genesis_time{config::kGenesisTime};
@@ -66,7 +67,8 @@ class BlockValidatorTest : public testing::Test {
                                             power_table,
                                             bls_provider,
                                             secp_provider,
-                                            vm_interpreter);
+                                            vm_interpreter,
+                                            pool);
   }
 
   BlockHeader getCorrectBlockHeader() const {
@@ -104,3 +106,23 @@ TEST_F(BlockValidatorTest, ValidateCorrectBlock) {
       getCorrectBlockHeader(),
       {fc::blockchain::block_validator::scenarios::Stage::SYNTAX_BV0}));
 }
+
+/**
+ * @given Correct block and block without parents
+ * @when Validating blocks together on pool
+ * @then Only block without parents fails, with stage error
+ */
+TEST_F(BlockValidatorTest, ValidateBlocksConcurrently) {
+  using fc::blockchain::block_validator::scenarios::Stage;
+  auto validator =
+      createValidator(std::make_shared<boost::asio::thread_pool>(2));
+  auto bad = getCorrectBlockHeader();
+  bad.parents.clear();
+  auto results = validator->validateBlocks({getCorrectBlockHeader(), bad},
+                                           {Stage::SYNTAX_BV0});
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_FALSE(results[0].has_error());
+  ASSERT_TRUE(results[1].has_error());
+  EXPECT_OUTCOME_ERROR(results[1].error(),
+                       validator->validateBlock(bad, {Stage::SYNTAX_BV0}));
+}
@@ -7,6 +7,7 @@
 
 #include <gtest/gtest.h>
 
+#include "storage/in_memory/in_memory_storage.hpp"
 #include "storage/ipfs/impl/in_memory_datastore.hpp"
 #include "testutil/literals.hpp"
 #include "testutil/outcome.hpp"
@@ -18,10 +19,13 @@ using fc::blockchain::weight::WeightCalculatorImpl;
 using fc::primitives::address::Address;
 using fc::primitives::block::BlockHeader;
 using fc::primitives::tipset::Tipset;
+using fc::CID;
+using fc::storage::InMemoryStorage;
 using fc::storage::ipfs::InMemoryDatastore;
 using fc::vm::actor::Actor;
 using fc::vm::actor::kStoragePowerAddress;
 using fc::vm::actor::kStoragePowerCodeCid;
+using fc::vm::actor::builtin::storage_power::PowerSummaries;
 using fc::vm::actor::builtin::storage_power::StoragePowerActorState;
 using fc::vm::state::StateTreeImpl;
 using Weight = fc::primitives::BigInt;
@@ -34,13 +38,14 @@ struct Params {
   Weight expected_weight;
 };
 
-fc::outcome::result<Weight> calculateWeight(const Params &params) {
-  auto ipld = std::make_shared<InMemoryDatastore>();
-  auto some_cid = "010001020001"_cid;
+/// State tree with power actor state of network power
+CID makeStateRoot(const std::shared_ptr<InMemoryDatastore> &ipld,
+                  const StoragePower &network_power) {
   StoragePowerActorState state;
   ipld->load(state);
-  state.total_qa_power = params.network_power;
-  EXPECT_OUTCOME_TRUE(state_cid, ipld->setCbor(state));
+  state.total_qa_power = network_power;
+  state.miner_count = 3;
+  auto state_cid{ipld->setCbor(state).value()};
   StateTreeImpl state_tree{ipld};
   EXPECT_OUTCOME_TRUE_1(state_tree.set(kStoragePowerAddress,
                                        Actor{
@@ -49,7 +54,17 @@ fc::outcome::result<Weight> calculateWeight(const Params &params) {
                                            .nonce = {},
                                            .balance = {},
                                        }));
-  EXPECT_OUTCOME_TRUE(state_root, state_tree.flush());
+  return state_tree.flush().value();
+}
+
+/// @param summaries - calculator reads network power from power summaries
+fc::outcome::result<Weight> calculateWeight(const Params &params,
+                                            bool summaries = false) {
+  auto ipld = std::make_shared<InMemoryDatastore>();
+  auto some_cid = "010001020001"_cid;
+  auto state_root{makeStateRoot(ipld, params.network_power)};
+  auto power_summaries{summaries ? std::make_shared<PowerSummaries>(ipld)
+                                 : nullptr};
   Tipset tipset{
       {},
       {params.block_count,
@@ -78,7 +93,7 @@ fc::outcome::result<Weight> calculateWeight(const Params &params) {
        }},
       {}};
 
-  return WeightCalculatorImpl{ipld}.calculateWeight(tipset);
+  return WeightCalculatorImpl{ipld, power_summaries}.calculateWeight(tipset);
 }
 
 struct WeightCalculatorTest : ::testing::TestWithParam<Params> {};
@@ -93,6 +108,36 @@ TEST_P(WeightCalculatorTest, Success) {
   EXPECT_OUTCOME_EQ(calculateWeight(params), params.expected_weight);
 }
 
+/**
+ * @given power summaries
+ * @when calculate weight with network power from summary
+ * @then weight is same as with power actor state
+ */
+TEST_P(WeightCalculatorTest, PowerSummary) {
+  auto &params = GetParam();
+  EXPECT_OUTCOME_EQ(calculateWeight(params, true), params.expected_weight);
+}
+
+/**
+ * @given summary of state root in store
+ * @when get summary from ipld without that state
+ * @then summary is read from store
+ */
+TEST(PowerSummaries, Persisted) {
+  auto ipld{std::make_shared<InMemoryDatastore>()};
+  auto store{std::make_shared<InMemoryStorage>()};
+  auto state_root{makeStateRoot(ipld, 200)};
+  PowerSummaries summaries{ipld, store};
+  EXPECT_OUTCOME_TRUE(summary, summaries.get(state_root));
+  EXPECT_EQ(summary.total_qa_power, 200);
+  EXPECT_EQ(summary.miner_count, 3);
+
+  PowerSummaries empty{std::make_shared<InMemoryDatastore>(), store};
+  EXPECT_OUTCOME_TRUE(stored, empty.get(state_root));
+  EXPECT_EQ(stored.total_qa_power, 200);
+  EXPECT_EQ(stored.miner_count, 3);
+}
+
 INSTANTIATE_TEST_CASE_P(WeightCalculatorTestCases,
                         WeightCalculatorTest,
                         ::testing::Values(Params{100, 200, 1, 2071},
@@ -0,0 +1,102 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "clock/timer_wheel.hpp"
+
+#include <gtest/gtest.h>
+
+#include "clock/impl/chain_epoch_clock_impl.hpp"
+
+using fc::clock::ChainEpochClockImpl;
+using fc::clock::kEpochDuration;
+using fc::clock::TimerWheel;
+using fc::clock::UnixTime;
+using std::chrono::milliseconds;
+using std::chrono::minutes;
+
+struct TimerWheelTest : testing::Test {
+  std::shared_ptr<TimerWheel> make(TimerWheel::Clock::time_point start) {
+    return std::make_shared<TimerWheel>(
+        io,
+        std::make_shared<ChainEpochClockImpl>(UnixTime{1000}),
+        milliseconds{100},
+        start);
+  }
+
+  TimerWheel::Callback record(int id) {
+    return [this, id] { fired.push_back(id); };
+  }
+
+  std::shared_ptr<boost::asio::io_context> io{
+      std::make_shared<boost::asio::io_context>()};
+  TimerWheel::Clock::time_point start{UnixTime{1000}};
+  std::vector<int> fired;
+};
+
+/**
+ * @given timers in near future
+ * @when advance wheel
+ * @then expired timers run in order of expiry
+ */
+TEST_F(TimerWheelTest, ExpireInOrder) {
+  auto wheel{make(start)};
+  wheel->at(start + milliseconds{250}, record(1));
+  wheel->at(start + milliseconds{50}, record(2));
+  wheel->at(start + milliseconds{1000}, record(3));
+  EXPECT_EQ(wheel->size(), 3);
+  wheel->advance(start + milliseconds{300});
+  EXPECT_EQ(fired, (std::vector<int>{2, 1}));
+  EXPECT_EQ(wheel->size(), 1);
+  wheel->advance(start + milliseconds{1000});
+  EXPECT_EQ(fired, (std::vector<int>{2, 1, 3}));
+  EXPECT_EQ(wheel->size(), 0);
+}
+
+/**
+ * @given timer far in future, in upper level of wheel
+ * @when advance wheel up to it
+ * @then timer runs at its time, not earlier
+ */
+TEST_F(TimerWheelTest, Cascade) {
+  auto wheel{make(start)};
+  wheel->at(start + minutes{30}, record(1));
+  wheel->at(start + minutes{30} + milliseconds{100}, record(2));
+  wheel->advance(start + minutes{30} - milliseconds{100});
+  EXPECT_TRUE(fired.empty());
+  wheel->advance(start + minutes{30});
+  EXPECT_EQ(fired, std::vector<int>{1});
+  wheel->advance(start + minutes{31});
+  EXPECT_EQ(fired, (std::vector<int>{1, 2}));
+}
+
+/**
+ * @given cancelled timer
+ * @when advance wheel past it
+ * @then its callback is not called and it is dropped
+ */
+TEST_F(TimerWheelTest, Cancel) {
+  auto wheel{make(start)};
+  auto timer{wheel->at(start + milliseconds{200}, record(1))};
+  wheel->at(start + milliseconds{200}, record(2));
+  timer->cancel();
+  wheel->advance(start + milliseconds{200});
+  EXPECT_EQ(fired, std::vector<int>{2});
+  EXPECT_EQ(wheel->size(), 0);
+}
+
+/**
+ * @given timer waiting for epoch
+ * @when advance wheel to epoch start
+ * @then timer runs
+ */
+TEST_F(TimerWheelTest, Epoch) {
+  auto wheel{make(start)};
+  wheel->atEpoch(2, record(1));
+  EXPECT_EQ(wheel->epochTime(2), start + 2 * kEpochDuration);
+  wheel->advance(start + 2 * kEpochDuration - milliseconds{100});
+  EXPECT_TRUE(fired.empty());
+  wheel->advance(start + 2 * kEpochDuration);
+  EXPECT_EQ(fired, std::vector<int>{1});
+}
@@ -0,0 +1,53 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/libp2p/buffer_pool.hpp"
+
+#include <gtest/gtest.h>
+
+using fc::common::libp2p::BufferPool;
+
+/**
+ * @given buffer pool
+ * @when acquire buffer for some size
+ * @then buffer has size of power of two size class fitting it
+ */
+TEST(BufferPoolTest, SizeClass) {
+  BufferPool pool;
+  EXPECT_EQ(pool.acquire(1).size(), BufferPool::kMinSize);
+  EXPECT_EQ(pool.acquire(BufferPool::kMinSize).size(), BufferPool::kMinSize);
+  EXPECT_EQ(pool.acquire(BufferPool::kMinSize + 1).size(),
+            2 * BufferPool::kMinSize);
+}
+
+/**
+ * @given released buffer
+ * @when acquire buffer of same size class
+ * @then released buffer is reused
+ */
+TEST(BufferPoolTest, Reuse) {
+  BufferPool pool;
+  auto buffer = pool.acquire(10000);
+  auto data = buffer.data();
+  pool.release(buffer);
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(pool.freeCount(), 1);
+  EXPECT_EQ(pool.acquire(5000).size(), BufferPool::kMinSize);
+  auto reused = pool.acquire(9000);
+  EXPECT_EQ(reused.data(), data);
+  EXPECT_EQ(pool.freeCount(), 0);
+}
+
+/**
+ * @given buffer not of size class
+ * @when release it
+ * @then it is not pooled
+ */
+TEST(BufferPoolTest, ReleaseForeign) {
+  BufferPool pool;
+  std::vector<uint8_t> buffer(BufferPool::kMinSize + 1);
+  pool.release(buffer);
+  EXPECT_EQ(pool.freeCount(), 0);
+}
@@ -63,6 +63,21 @@ TEST(Cbor, BigInt) {
   EXPECT_OUTCOME_EQ(decode<BigInt>("40"_unhex), 0);
 }
 
+/** Int256 is encoded same as BigInt */
+TEST(Cbor, Int256) {
+  using fc::primitives::Int256;
+  EXPECT_OUTCOME_EQ(encode(Int256(0xCAFE)), "4300CAFE"_unhex);
+  EXPECT_OUTCOME_EQ(decode<Int256>("4300CAFE"_unhex), 0xCAFE);
+  EXPECT_OUTCOME_EQ(encode(Int256(-0xCAFE)), "4301CAFE"_unhex);
+  EXPECT_OUTCOME_EQ(decode<Int256>("4301CAFE"_unhex), -0xCAFE);
+  EXPECT_OUTCOME_EQ(encode(Int256(0)), "40"_unhex);
+  EXPECT_OUTCOME_EQ(decode<Int256>("40"_unhex), 0);
+  // magnitude of 33 bytes doesn't fit
+  std::vector<uint8_t> big(34, 1);
+  EXPECT_OUTCOME_ERROR(fc::codec::cbor::CborDecodeError::kIntOverflow,
+                       decode<Int256>(encode(big).value()));
+}
+
 /** Null CBOR encoding and decoding */
 TEST(Cbor, Null) {
   EXPECT_OUTCOME_EQ(encode(nullptr), "F6"_unhex);
@@ -154,6 +169,25 @@ TEST(CborEncoder, ListNest) {
   EXPECT_EQ(s.data(), "84820102030405"_unhex);
 }
 
+/**
+ * @given Temporary lists of less and more than 23 elements
+ * @when Move into empty stream
+ * @then Encoded same as copied
+ */
+TEST(CborEncoder, ListMove) {
+  for (auto n : {2, 30}) {
+    auto l = CborEncodeStream::list();
+    for (auto i = 0; i < n; ++i) {
+      l << i;
+    }
+    auto expected = l.data();
+    CborEncodeStream s;
+    s << std::move(l);
+    EXPECT_EQ(std::move(s).data(), expected);
+  }
+  EXPECT_EQ(CborEncodeStream::list().data(), "80"_unhex);
+}
+
 /**
  * @given Nested sequence containers
  * @when Encode
@@ -328,6 +362,59 @@ TEST(CborDecoder, Map) {
   m.at("b").list() >> b;
 }
 
+/**
+ * @given Map CBOR
+ * @when Find keys by scanning map
+ * @then Values of present keys are decoded, missing key is not found
+ */
+TEST(CborDecoder, MapFind) {
+  auto input = "A261610261628101"_unhex;
+  auto s = CborDecodeStream::borrow(input);
+  int a, b;
+  auto s_a = s.mapFind("a");
+  ASSERT_TRUE(s_a);
+  *s_a >> a;
+  EXPECT_EQ(a, 2);
+  auto s_b = s.mapFind("b");
+  ASSERT_TRUE(s_b);
+  s_b->list() >> b;
+  EXPECT_EQ(b, 1);
+  EXPECT_FALSE(s.mapFind("c"));
+}
+
+/**
+ * @given Bytes and string CBOR
+ * @when Decode views
+ * @then Views point to input
+ */
+TEST(CborDecoder, Views) {
+  auto input = "42CAFE63666F6F"_unhex;
+  auto s = CborDecodeStream::borrow(input);
+  auto bytes = s.bytesView();
+  EXPECT_EQ(bytes.data(), input.data() + 1);
+  EXPECT_EQ(std::vector<uint8_t>(bytes.begin(), bytes.end()), "CAFE"_unhex);
+  EXPECT_EQ(s.strView(), "foo");
+}
+
+/**
+ * @given Nothrow stream
+ * @when Decode wrong types
+ * @then First error is recorded, following reads fail without throwing
+ */
+TEST(CborDecoder, NothrowErrors) {
+  auto input = "0102"_unhex;
+  auto s = CborDecodeStream::borrow(input, true);
+  std::string str;
+  EXPECT_NO_THROW(s >> str);
+  EXPECT_EQ(s.error(), make_error_code(CborDecodeError::kWrongType));
+  int i;
+  EXPECT_NO_THROW(s >> i >> i);
+  EXPECT_EQ(s.error(), make_error_code(CborDecodeError::kWrongType));
+
+  EXPECT_OUTCOME_ERROR(CborDecodeError::kInvalidCbor,
+                       decode<std::vector<int>>("9AFFFFFFFF01"_unhex));
+}
+
 /**
  * @given Invalid CBOR
  * @when Init decoder
@@ -444,6 +531,48 @@ TEST(CborDecoder, Misc) {
   EXPECT_EQ(CborDecodeStream("810201"_unhex).raw(), "8102"_unhex);
 }
 
+namespace fc::codec::cbor {
+  struct TupleInner {
+    int a;
+    std::string b;
+  };
+  CBOR_TUPLE(TupleInner, a, b)
+  inline bool operator==(const TupleInner &l, const TupleInner &r) {
+    return l.a == r.a && l.b == r.b;
+  }
+
+  struct TupleOuter {
+    int x;
+    TupleInner inner;
+    std::vector<TupleInner> items;
+  };
+  CBOR_TUPLE(TupleOuter, x, inner, items)
+  inline bool operator==(const TupleOuter &l, const TupleOuter &r) {
+    return l.x == r.x && l.inner == r.inner && l.items == r.items;
+  }
+}  // namespace fc::codec::cbor
+
+/**
+ * @given Nested CBOR_TUPLE types
+ * @when Encode in place and decode
+ * @then Same bytes as nested lists, value and following element decoded
+ */
+TEST(Cbor, Tuple) {
+  using fc::codec::cbor::TupleOuter;
+  TupleOuter value{7, {1, "a"}, {{2, "b"}, {3, "c"}}};
+  auto bytes = "830782016161828202616282036163"_unhex;
+  EXPECT_OUTCOME_EQ(encode(value), bytes);
+  EXPECT_OUTCOME_EQ(decode<TupleOuter>(bytes), value);
+
+  auto s = CborEncodeStream::list();
+  s << value << 5;
+  TupleOuter decoded;
+  int after;
+  CborDecodeStream{s.data()}.list() >> decoded >> after;
+  EXPECT_EQ(decoded, value);
+  EXPECT_EQ(after, 5);
+}
+
 struct CborResolve : testing::Test {
   fc::outcome::result<std::vector<uint8_t>> resolve(
       gsl::span<const uint8_t> node, const std::string &part) {
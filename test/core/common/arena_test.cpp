@@ -0,0 +1,51 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/arena.hpp"
+
+#include <gtest/gtest.h>
+
+using fc::common::Arena;
+using fc::common::ArenaAllocator;
+
+/**
+ * @given arena with small chunks
+ * @when allocate objects of different size and alignment
+ * @then objects are aligned, do not overlap and chunks are added as needed
+ */
+TEST(ArenaTest, Allocate) {
+  Arena arena{64};
+  auto a{static_cast<uint8_t *>(arena.allocate(1, 1))};
+  auto b{static_cast<uint8_t *>(arena.allocate(8, 8))};
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 8, 0);
+  EXPECT_GE(b, a + 1);
+  auto large{arena.allocate(1000, 16)};
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % 16, 0);
+  EXPECT_EQ(arena.allocated(), 1009);
+  arena.release();
+  EXPECT_EQ(arena.allocated(), 0);
+}
+
+/**
+ * @given arena allocator
+ * @when allocate shared object
+ * @then object is constructed and destroyed, its memory is kept by arena
+ */
+TEST(ArenaTest, AllocateShared) {
+  Arena arena;
+  auto destroyed{false};
+  struct Object {
+    ~Object() {
+      *destroyed = true;
+    }
+    bool *destroyed;
+  };
+  auto object{std::allocate_shared<Object>(ArenaAllocator<Object>{arena},
+                                           Object{&destroyed})};
+  destroyed = false;
+  EXPECT_GT(arena.allocated(), sizeof(Object));
+  object.reset();
+  EXPECT_TRUE(destroyed);
+}
@@ -0,0 +1,106 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/async_log_sink.hpp"
+
+#include <gtest/gtest.h>
+#include <spdlog/sinks/ostream_sink.h>
+
+#include "common/logger.hpp"
+
+using fc::common::AsyncLogSink;
+using fc::common::BoundedQueue;
+using fc::common::LogRateLimiter;
+
+/**
+ * @given queue
+ * @when push more values than capacity
+ * @then extra values are rejected, others are popped in order
+ */
+TEST(BoundedQueueTest, PushPop) {
+  BoundedQueue<int> queue{3};
+  EXPECT_EQ(queue.capacity(), 4);
+  EXPECT_TRUE(queue.empty());
+  for (auto i{0}; i < 4; ++i) {
+    EXPECT_TRUE(queue.push(int{i}));
+  }
+  EXPECT_FALSE(queue.push(4));
+  int value{};
+  for (auto i{0}; i < 4; ++i) {
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(queue.pop(value));
+  EXPECT_TRUE(queue.empty());
+}
+
+/**
+ * @given queue and several producer threads
+ * @when values are pushed concurrently
+ * @then each value is popped once
+ */
+TEST(BoundedQueueTest, Concurrent) {
+  constexpr auto kThreads{4}, kValues{1000};
+  BoundedQueue<int> queue{64};
+  std::vector<std::thread> threads;
+  for (auto t{0}; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (auto i{0}; i < kValues; ++i) {
+        while (!queue.push(t * kValues + i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  std::vector<bool> seen(kThreads * kValues);
+  for (auto popped{0}; popped < kThreads * kValues;) {
+    int value{};
+    if (queue.pop(value)) {
+      EXPECT_FALSE(seen[value]);
+      seen[value] = true;
+      ++popped;
+    }
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+/**
+ * @given logger with async sink
+ * @when messages are logged and sink is destroyed
+ * @then messages are written to target in order with logger pattern
+ */
+TEST(AsyncLogSinkTest, Writes) {
+  std::ostringstream out;
+  {
+    auto sink{std::make_shared<AsyncLogSink>(
+        std::make_shared<spdlog::sinks::ostream_sink_mt>(out), 16)};
+    spdlog::logger logger{"test", sink};
+    logger.set_pattern("%n %l %v");
+    logger.info("a {}", 1);
+    logger.warn("b");
+    logger.flush();
+    EXPECT_EQ(sink->dropped(), 0);
+  }
+  EXPECT_EQ(out.str(), "test info a 1\ntest warning b\n");
+}
+
+/**
+ * @given rate limiter
+ * @when messages are logged within interval
+ * @then only first is allowed, next allowed one reports suppressed count
+ */
+TEST(LogRateLimiterTest, Suppress) {
+  LogRateLimiter limiter{std::chrono::milliseconds{50}};
+  uint64_t suppressed{};
+  EXPECT_TRUE(limiter.allow(suppressed));
+  EXPECT_EQ(suppressed, 0);
+  EXPECT_FALSE(limiter.allow(suppressed));
+  EXPECT_FALSE(limiter.allow(suppressed));
+  std::this_thread::sleep_for(std::chrono::milliseconds{60});
+  EXPECT_TRUE(limiter.allow(suppressed));
+  EXPECT_EQ(suppressed, 2);
+}
@@ -0,0 +1,46 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/bloom_filter.hpp"
+
+#include <gtest/gtest.h>
+
+using fc::common::BloomFilter;
+
+/**
+ * @given filter with inserted keys
+ * @when check inserted and other keys
+ * @then inserted keys are found @and few other keys are reported
+ */
+TEST(BloomFilterTest, InsertedFound) {
+  BloomFilter filter{1 << 14, 7};
+  auto key{[](uint32_t i) {
+    return std::vector<uint8_t>{
+        uint8_t(i), uint8_t(i >> 8), uint8_t(i >> 16), uint8_t(i >> 24)};
+  }};
+  for (uint32_t i{0}; i < 1000; ++i) {
+    filter.insert(key(i));
+  }
+  for (uint32_t i{0}; i < 1000; ++i) {
+    EXPECT_TRUE(filter.mayContain(key(i)));
+  }
+  size_t false_positives{0};
+  for (uint32_t i{1000}; i < 11000; ++i) {
+    false_positives += filter.mayContain(key(i));
+  }
+  // about 1% expected for 16 bits per key
+  EXPECT_LT(false_positives, 500);
+}
+
+/**
+ * @given empty filter
+ * @when check key
+ * @then key is not found
+ */
+TEST(BloomFilterTest, Empty) {
+  BloomFilter filter{0, 3};
+  EXPECT_EQ(filter.bits(), 64);
+  EXPECT_FALSE(filter.mayContain(std::vector<uint8_t>{1, 2, 3}));
+}
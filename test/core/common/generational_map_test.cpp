@@ -0,0 +1,48 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/generational_map.hpp"
+
+#include <gtest/gtest.h>
+
+using fc::common::GenerationalMap;
+
+/**
+ * @given map with generation of two values
+ * @when more values are inserted
+ * @then values unused for whole generation are evicted
+ */
+TEST(GenerationalMapTest, Evict) {
+  GenerationalMap<int, int> map{2};
+  map.emplace(1, 10);
+  map.emplace(2, 20);
+  // rotates, 1 and 2 become previous generation
+  map.emplace(3, 30);
+  // used, so moved to current generation
+  EXPECT_EQ(*map.find(1), 10);
+  // rotates, 2 is evicted
+  map.emplace(4, 40);
+  EXPECT_FALSE(map.has(2));
+  EXPECT_TRUE(map.has(1));
+  EXPECT_TRUE(map.has(3));
+  EXPECT_TRUE(map.has(4));
+  EXPECT_EQ(map.evicted(), 1);
+}
+
+/**
+ * @given map with pinned value
+ * @when generations rotate
+ * @then pinned value is kept @and emplace doesn't replace values
+ */
+TEST(GenerationalMapTest, Pin) {
+  GenerationalMap<int, int> map{1};
+  map.pin(0, 1);
+  for (auto i{1}; i < 10; ++i) {
+    map.emplace(i, i);
+  }
+  EXPECT_EQ(*map.find(0), 1);
+  EXPECT_EQ(map.emplace(0, 2), 1);
+  EXPECT_EQ(map.size(), 3);
+}
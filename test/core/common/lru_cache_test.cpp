@@ -0,0 +1,47 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/lru_cache.hpp"
+
+#include <gtest/gtest.h>
+#include <boost/optional/optional_io.hpp>
+
+using fc::common::LruCache;
+
+/**
+ * @given cache with values
+ * @when get values
+ * @then hits and misses are counted
+ */
+TEST(LruCacheTest, GetPut) {
+  LruCache<int, std::string> cache{2};
+  EXPECT_EQ(cache.get(1), boost::none);
+  cache.put(1, "a");
+  EXPECT_EQ(cache.get(1), std::string{"a"});
+  cache.put(1, "b");
+  EXPECT_EQ(cache.get(1), std::string{"b"});
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_EQ(cache.hits(), 2);
+  EXPECT_EQ(cache.misses(), 1);
+}
+
+/**
+ * @given full cache
+ * @when put new value
+ * @then least recently used value is evicted
+ */
+TEST(LruCacheTest, Evict) {
+  LruCache<int, int> cache{2};
+  cache.put(1, 1);
+  cache.put(2, 2);
+  EXPECT_EQ(cache.get(1), 1);
+  cache.put(3, 3);
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.get(2), boost::none);
+  EXPECT_EQ(cache.get(1), 1);
+  EXPECT_EQ(cache.get(3), 3);
+  cache.remove(1);
+  EXPECT_EQ(cache.get(1), boost::none);
+}
@@ -44,3 +44,23 @@ TEST_F(TarUtilTest, extractTar) {
   ASSERT_EQ(str, result);
   input.close();
 }
+
+/**
+ * @given tar file
+ * @when extract it with parallel writers, small buffers and direct io
+ * @then file data does not change
+ */
+TEST_F(TarUtilTest, extractTarParallel) {
+  fc::common::TarExtractOptions options;
+  options.writers = 2;
+  options.buffer_size = 1;
+  options.buffers = 2;
+  options.direct_io = true;
+  EXPECT_OUTCOME_TRUE_1(fc::common::extractTar(
+      resourcePath("sector.tar"), base_path.string(), options));
+  std::ifstream input((base_path / "Unseal" / "test.txt").string());
+  ASSERT_TRUE(input.good());
+  std::string str;
+  std::getline(input, str);
+  EXPECT_EQ(str, "some test data here");
+}
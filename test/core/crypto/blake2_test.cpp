@@ -7,6 +7,7 @@
 #include <stdio.h>
 
 #include "crypto/blake2/blake2b.h"
+#include "crypto/blake2/blake2b160.hpp"
 #include "crypto/blake2/blake2s.h"
 #include "testutil/literals.hpp"
 
@@ -123,3 +124,27 @@ TEST(Blake2s, UnkeyedInit) {
 
   EXPECT_EQ(memcmp(out1, out2, 32), 0) << "hashes are different";
 }
+
+/**
+ * @given inputs of lengths around block boundaries, fewer and more than lanes
+ * @when hash them together
+ * @then each hash is same as hashed alone
+ */
+TEST(Blake2b, Many) {
+  using fc::crypto::blake2b::blake2b_256;
+  using fc::crypto::blake2b::blake2b_256_many;
+  std::vector<std::vector<uint8_t>> inputs;
+  for (auto size : {0, 1, 127, 128, 129, 255, 256, 300, 1000}) {
+    inputs.emplace_back(size);
+    selftest_seq(inputs.back().data(), size, size);
+  }
+  for (size_t count = 0; count <= inputs.size(); ++count) {
+    std::vector<gsl::span<const uint8_t>> spans{inputs.begin(),
+                                                inputs.begin() + count};
+    auto hashes{blake2b_256_many(spans)};
+    ASSERT_EQ(hashes.size(), count);
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(hashes[i], blake2b_256(spans[i]));
+    }
+  }
+}
@@ -0,0 +1,80 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "crypto/bls/impl/batch_verifier.hpp"
+
+#include <gtest/gtest.h>
+
+#include "crypto/bls/impl/bls_provider_impl.hpp"
+#include "testutil/outcome.hpp"
+
+namespace fc::crypto::bls {
+  class BlsBatchVerifierTest : public ::testing::Test {
+   public:
+    /// Queues signed messages, signature of invalid ones is replaced
+    void queue(size_t count, const std::set<size_t> &invalid) {
+      EXPECT_OUTCOME_TRUE(other, bls->generateKeyPair());
+      for (size_t i = 0; i < count; ++i) {
+        common::Buffer message{static_cast<uint8_t>(i), 1, 2, 3};
+        EXPECT_OUTCOME_TRUE(key_pair, bls->generateKeyPair());
+        EXPECT_OUTCOME_TRUE(
+            signature,
+            bls->sign(message,
+                      invalid.count(i) != 0 ? other.private_key
+                                            : key_pair.private_key));
+        verifier->verify(message,
+                         signature,
+                         key_pair.public_key,
+                         [this, i](bool ok) { results.emplace(i, ok); });
+      }
+    }
+
+    void run() {
+      while (results.size() < expected) {
+        io->run_for(std::chrono::milliseconds{10});
+        io->restart();
+      }
+    }
+
+    std::shared_ptr<BlsProvider> bls{std::make_shared<BlsProviderImpl>()};
+    std::shared_ptr<boost::asio::io_context> io{
+        std::make_shared<boost::asio::io_context>()};
+    std::shared_ptr<boost::asio::thread_pool> pool{
+        std::make_shared<boost::asio::thread_pool>(2)};
+    std::shared_ptr<BatchVerifier> verifier{
+        std::make_shared<BatchVerifier>(bls, io, pool, 8)};
+    std::map<size_t, bool> results;
+    size_t expected{};
+  };
+
+  /**
+   * @given several batches of valid signatures
+   * @when verify queued signatures
+   * @then all callbacks report valid
+   */
+  TEST_F(BlsBatchVerifierTest, Valid) {
+    expected = 20;
+    queue(expected, {});
+    run();
+    for (auto &[i, ok] : results) {
+      EXPECT_TRUE(ok) << i;
+    }
+  }
+
+  /**
+   * @given batches with some invalid signatures
+   * @when verify queued signatures
+   * @then only invalid signatures are reported invalid
+   */
+  TEST_F(BlsBatchVerifierTest, FindsInvalid) {
+    std::set<size_t> invalid{1, 6, 7, 12};
+    expected = 16;
+    queue(expected, invalid);
+    run();
+    for (auto &[i, ok] : results) {
+      EXPECT_EQ(ok, invalid.count(i) == 0) << i;
+    }
+  }
+}  // namespace fc::crypto::bls
@@ -82,3 +82,72 @@ TEST_F(BlsProviderTest, DifferentMessageVerificationFailure) {
                           different_message, signature, key_pair.public_key));
   ASSERT_FALSE(signature_status);
 }
+
+/**
+ * @given Several messages signed by different keys
+ * @when Verifying them as batch @and with one signature replaced
+ * @then Batch is valid @and batch with replaced signature is invalid
+ */
+TEST_F(BlsProviderTest, VerifyBatch) {
+  std::vector<std::vector<uint8_t>> messages;
+  std::vector<fc::crypto::bls::SignedData> items;
+  for (uint8_t i = 0; i < 4; ++i) {
+    messages.push_back({i, 1, 2, 3});
+  }
+  // same message twice
+  messages.push_back(messages[0]);
+  for (auto &message : messages) {
+    EXPECT_OUTCOME_TRUE(key_pair, provider_.generateKeyPair());
+    EXPECT_OUTCOME_TRUE(signature,
+                        provider_.sign(message, key_pair.private_key));
+    items.push_back({message, signature, key_pair.public_key});
+  }
+  EXPECT_OUTCOME_EQ(provider_.verifyBatch(items), true);
+
+  items[1].signature = items[2].signature;
+  EXPECT_OUTCOME_EQ(provider_.verifyBatch(items), false);
+}
+
+/**
+ * @given Two messages signed by same key
+ * @when Verifying them as batch with swapped signatures
+ * @then Batch is invalid, though aggregate of signatures is same
+ */
+TEST_F(BlsProviderTest, VerifyBatchCancelling) {
+  EXPECT_OUTCOME_TRUE(key_pair, provider_.generateKeyPair());
+  std::vector<uint8_t> message1{1, 2, 3}, message2{4, 5, 6};
+  EXPECT_OUTCOME_TRUE(signature1,
+                      provider_.sign(message1, key_pair.private_key));
+  EXPECT_OUTCOME_TRUE(signature2,
+                      provider_.sign(message2, key_pair.private_key));
+  std::vector<fc::crypto::bls::SignedData> items{
+      {message1, signature2, key_pair.public_key},
+      {message2, signature1, key_pair.public_key},
+  };
+  EXPECT_OUTCOME_EQ(provider_.verifyBatch(items), false);
+}
+
+/**
+ * @given Several messages signed by different keys
+ * @when Verifying aggregated signature
+ * @then Aggregate is valid for all messages and invalid for part of them
+ */
+TEST_F(BlsProviderTest, VerifyAggregate) {
+  std::vector<std::vector<uint8_t>> messages{{1}, {2}, {3}};
+  std::vector<gsl::span<const uint8_t>> spans;
+  std::vector<PublicKey> keys;
+  std::vector<Signature> signatures;
+  for (auto &message : messages) {
+    EXPECT_OUTCOME_TRUE(key_pair, provider_.generateKeyPair());
+    EXPECT_OUTCOME_TRUE(signature,
+                        provider_.sign(message, key_pair.private_key));
+    spans.emplace_back(message);
+    keys.push_back(key_pair.public_key);
+    signatures.push_back(signature);
+  }
+  EXPECT_OUTCOME_TRUE(aggregate, provider_.aggregateSignatures(signatures));
+  EXPECT_OUTCOME_EQ(provider_.verifyAggregate(spans, keys, aggregate), true);
+  spans.pop_back();
+  keys.pop_back();
+  EXPECT_OUTCOME_EQ(provider_.verifyAggregate(spans, keys, aggregate), false);
+}
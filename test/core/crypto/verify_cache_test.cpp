@@ -0,0 +1,55 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "crypto/verify_cache/verify_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include "testutil/outcome.hpp"
+
+using fc::common::Buffer;
+using fc::crypto::VerifyCache;
+
+/**
+ * @given verify cache
+ * @when same key is verified twice
+ * @then verify function is called once @and cached result is returned
+ */
+TEST(VerifyCache, CachesResult) {
+  VerifyCache cache{4};
+  Buffer key{1, 2, 3};
+  auto calls{0};
+  auto verify{[&]() -> fc::outcome::result<bool> {
+    ++calls;
+    return false;
+  }};
+  EXPECT_OUTCOME_EQ(cache.verify(key, verify), false);
+  EXPECT_OUTCOME_EQ(cache.verify(key, verify), false);
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_OUTCOME_EQ(cache.verify(Buffer{1, 2}, verify), false);
+  EXPECT_EQ(calls, 2);
+}
+
+/**
+ * @given verify cache
+ * @when verify function fails
+ * @then error is not cached @and key is verified again
+ */
+TEST(VerifyCache, ErrorNotCached) {
+  VerifyCache cache{4};
+  Buffer key{1};
+  auto calls{0};
+  auto verify{[&]() -> fc::outcome::result<bool> {
+    if (++calls == 1) {
+      return std::errc::io_error;
+    }
+    return true;
+  }};
+  EXPECT_OUTCOME_ERROR(std::errc::io_error, cache.verify(key, verify));
+  EXPECT_OUTCOME_EQ(cache.verify(key, verify), true);
+  EXPECT_EQ(calls, 2);
+  EXPECT_EQ(cache.size(), 1);
+}
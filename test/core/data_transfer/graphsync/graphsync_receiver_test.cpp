@@ -6,6 +6,7 @@
 #include "data_transfer/impl/graphsync/graphsync_receiver.hpp"
 
 #include <gtest/gtest.h>
+#include "storage/ipfs/graphsync/extension.hpp"
 #include "testutil/literals.hpp"
 #include "testutil/mocks/data_transfer/data_transfer_network_mock.hpp"
 #include "testutil/mocks/data_transfer/manager_mock.hpp"
@@ -17,7 +18,12 @@
 
 namespace fc::data_transfer {
 
+  using storage::ipfs::graphsync::decodeDontSendCids;
+  using storage::ipfs::graphsync::encodeResponseMetadata;
   using storage::ipfs::graphsync::GraphsyncMock;
+  using storage::ipfs::graphsync::kDontSendCidsProtocol;
+  using storage::ipfs::graphsync::RS_CONNECTION_ERROR;
+  using storage::ipfs::graphsync::RS_PARTIAL_RESPONSE;
   using storage::ipfs::graphsync::Subscription;
   using ::testing::_;
   using ::testing::Eq;
@@ -32,8 +38,12 @@ namespace fc::data_transfer {
         std::make_shared<ManagerMock>();
     PeerInfo peer_info{.id = generatePeerId(1), .addresses = {}};
 
-    GraphsyncReceiver receiver{
-        network, graphsync, graphsync_manager, peer_info};
+    GraphsyncReceiver receiver{network,
+                               graphsync,
+                               graphsync_manager,
+                               peer_info,
+                               std::make_shared<TransferQueue>(
+                                   TransferLimits{})};
 
     std::shared_ptr<RequestValidatorMock> request_validator =
         std::make_shared<RequestValidatorMock>();
@@ -176,4 +186,72 @@ namespace fc::data_transfer {
     EXPECT_FALSE(receiver.receiveRequest(initiator, request).has_error());
   }
 
+  /**
+   * @given push transfer with some blocks received
+   * @when graphsync request fails with connection error
+   * @then request is sent again @and received blocks are excluded
+   */
+  TEST_F(GraphsyncReceiverTest, RestartSkipsReceived) {
+    std::string voucher_type = "registered";
+    TransferId transfer_id = 1;
+    CID base_cid = "010001020005"_cid;
+    CID received_cid = "010001020006"_cid;
+    EXPECT_OUTCOME_TRUE(bace_cid_str, base_cid.toString());
+
+    DataTransferRequest request{.base_cid = bace_cid_str,
+                                .is_cancel = true,
+                                .pid = {},
+                                .is_part = false,
+                                .is_pull = false,
+                                .selector = {},
+                                .voucher = {},
+                                .voucher_type = voucher_type,
+                                .transfer_id = transfer_id};
+    ChannelId channel_id{.initiator = initiator, .id = transfer_id};
+    EXPECT_CALL(*graphsync_manager, createChannel(_, _, _, _, _, _, _))
+        .WillOnce(::testing::Return(outcome::success(channel_id)));
+    ChannelState channel_state{
+        .channel = {.transfer_id = transfer_id,
+                    .base_cid = base_cid,
+                    .selector = nullptr,
+                    .voucher = {},
+                    .sender = initiator,
+                    .recipient = peer_info,
+                    .total_size = 0}};
+    EXPECT_CALL(*graphsync_manager, getChannelByIdAndSender(_, _))
+        .WillRepeatedly(::testing::Return(channel_state));
+    EXPECT_CALL(*request_validator, validatePush(_, _, _, _))
+        .WillOnce(::testing::Return(outcome::success()));
+    EXPECT_CALL(*network, sendMessage(_, _)).WillOnce(::testing::Return());
+
+    std::vector<std::vector<Extension>> sent_extensions;
+    Graphsync::RequestProgressCallback callback;
+    EXPECT_CALL(*graphsync, makeRequest(Eq(initiator.id), _, _, _, _, _))
+        .Times(2)
+        .WillRepeatedly([&](auto &, auto, auto &, auto, auto &extensions,
+                            auto cb) {
+          sent_extensions.push_back(extensions);
+          callback = cb;
+          return Subscription{};
+        });
+
+    EXPECT_OUTCOME_TRUE_1(
+        receiver.registerVoucherType(voucher_type, request_validator));
+    EXPECT_OUTCOME_TRUE_1(receiver.receiveRequest(initiator, request));
+    ASSERT_EQ(sent_extensions.size(), 1);
+
+    callback(RS_PARTIAL_RESPONSE,
+             {encodeResponseMetadata({{received_cid, true}})});
+    callback(RS_CONNECTION_ERROR, {});
+    ASSERT_EQ(sent_extensions.size(), 2);
+    auto &restarted = sent_extensions.back();
+    auto dont_send = std::find_if(
+        restarted.begin(), restarted.end(), [](auto &extension) {
+          return extension.name == kDontSendCidsProtocol;
+        });
+    ASSERT_NE(dont_send, restarted.end());
+    EXPECT_OUTCOME_EQ(decodeDontSendCids(*dont_send),
+                      std::set<CID>{received_cid});
+  }
+
 }  // namespace fc::data_transfer
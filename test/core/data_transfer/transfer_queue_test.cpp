@@ -0,0 +1,46 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "data_transfer/transfer_queue.hpp"
+
+#include <gtest/gtest.h>
+
+namespace fc::data_transfer {
+
+  /**
+   * @given queue with one pull slot
+   * @when transfers are enqueued while slot is busy
+   * @then they start by priority as slot is freed
+   */
+  TEST(TransferQueueTest, Priority) {
+    TransferQueue queue{TransferLimits{1, 1}};
+    queue.setPriority("retrieval", TransferPriority::kHigh);
+    std::vector<std::string> started;
+    auto start{[&](std::string name) {
+      return [&started, name] { started.push_back(name); };
+    }};
+
+    queue.enqueue(true, "storage", start("storage1"));
+    queue.enqueue(true, "storage", start("storage2"));
+    queue.enqueue(true, "retrieval", start("retrieval"));
+    queue.enqueue(false, "storage", start("push"));
+    EXPECT_EQ(started, (std::vector<std::string>{"storage1", "push"}));
+    EXPECT_EQ(queue.stats().queued_pulls, 2);
+
+    queue.finish(true);
+    queue.finish(true);
+    EXPECT_EQ(started,
+              (std::vector<std::string>{
+                  "storage1", "push", "retrieval", "storage2"}));
+
+    queue.finish(true);
+    queue.finish(false);
+    auto stats{queue.stats()};
+    EXPECT_EQ(stats.active_pulls, 0);
+    EXPECT_EQ(stats.active_pushes, 0);
+    EXPECT_EQ(stats.finished, 4);
+  }
+
+}  // namespace fc::data_transfer
@@ -0,0 +1,116 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "drand/impl/hedged.hpp"
+
+#include <gtest/gtest.h>
+#include <future>
+
+#include "testutil/mocks/drand/drand_sync_client_mock.hpp"
+#include "testutil/outcome.hpp"
+
+namespace fc::drand {
+  using testing::_;
+
+  struct HedgedTest : testing::Test {
+    void SetUp() override {
+      for (auto i{0}; i < 2; ++i) {
+        auto client{std::make_shared<DrandSyncClientMock>()};
+        clients.push_back(client);
+        peers->clients.push_back(client);
+        peers->latency.emplace_back();
+      }
+    }
+
+    static PublicRandResponse response(uint64_t round, uint8_t signature) {
+      return {round, {signature}, {}, {}};
+    }
+
+    std::shared_ptr<DrandPeers> peers{std::make_shared<DrandPeers>()};
+    std::vector<std::shared_ptr<DrandSyncClientMock>> clients;
+    VerifyResponse accept{[](auto &) { return outcome::success(); }};
+    uint64_t round{7};
+    /// Joined first, so slower requests end before mocks are checked
+    boost::asio::thread_pool pool{kHedgedThreads};
+  };
+
+  /**
+   * @given one server returning other round than requested
+   * @when round is requested
+   * @then answer of other server is returned, mismatch counts as failure
+   */
+  TEST_F(HedgedTest, RoundMismatch) {
+    EXPECT_CALL(*clients[0], publicRand(round))
+        .WillOnce(testing::Return(response(round + 1, 1)));
+    EXPECT_CALL(*clients[1], publicRand(round)).WillOnce([&](auto) {
+      // answer after mismatch is counted
+      while (true) {
+        std::lock_guard lock{peers->mutex};
+        if (peers->latency[0]) {
+          break;
+        }
+      }
+      return response(round, 2);
+    });
+    EXPECT_OUTCOME_TRUE(result, hedgedPublicRand(pool, peers, round, accept));
+    EXPECT_EQ(result.round, round);
+    EXPECT_EQ(result.signature, Bytes{2});
+    std::lock_guard lock{peers->mutex};
+    EXPECT_EQ(peers->latency[0].value_or(0), 10000);
+  }
+
+  /**
+   * @given all servers returning other round than requested
+   * @when round is requested
+   * @then mismatch error is returned
+   */
+  TEST_F(HedgedTest, AllMismatch) {
+    for (auto &client : clients) {
+      EXPECT_CALL(*client, publicRand(round))
+          .WillOnce(testing::Return(response(round - 1, 1)));
+    }
+    EXPECT_OUTCOME_ERROR(HedgedError::kRoundMismatch,
+                         hedgedPublicRand(pool, peers, round, accept));
+  }
+
+  /**
+   * @given one server not answering
+   * @when round is requested
+   * @then answer of other server is returned without waiting
+   */
+  TEST_F(HedgedTest, SlowServer) {
+    std::promise<void> release;
+    auto released{release.get_future().share()};
+    EXPECT_CALL(*clients[0], publicRand(round)).WillOnce([=](auto) {
+      released.wait();
+      return response(round, 1);
+    });
+    EXPECT_CALL(*clients[1], publicRand(round))
+        .WillOnce(testing::Return(response(round, 2)));
+    EXPECT_OUTCOME_TRUE(result, hedgedPublicRand(pool, peers, round, accept));
+    EXPECT_EQ(result.signature, Bytes{2});
+    release.set_value();
+  }
+
+  /**
+   * @given first answer failing verification
+   * @when round is requested
+   * @then next answer is verified and returned
+   */
+  TEST_F(HedgedTest, InvalidAnswer) {
+    EXPECT_CALL(*clients[0], publicRand(round))
+        .WillOnce(testing::Return(response(round, 1)));
+    EXPECT_CALL(*clients[1], publicRand(round))
+        .WillOnce(testing::Return(response(round, 2)));
+    VerifyResponse verify{[&](auto &response) -> outcome::result<void> {
+      if (response.signature == Bytes{1}) {
+        return outcome::failure(std::make_error_code(std::errc::bad_message));
+      }
+      return outcome::success();
+    }};
+    EXPECT_OUTCOME_TRUE(result, hedgedPublicRand(pool, peers, round, verify));
+    EXPECT_EQ(result.signature, Bytes{2});
+  }
+}  // namespace fc::drand
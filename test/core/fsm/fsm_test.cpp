@@ -6,6 +6,7 @@
 #include "fsm/fsm.hpp"
 
 #include <gtest/gtest.h>
+#include <thread>
 
 #include "host/context/impl/host_context_impl.hpp"
 #include "testutil/outcome.hpp"
@@ -49,3 +50,44 @@ TEST(Dev, Main) {
   ASSERT_EQ(entity->x, 1);
   ASSERT_EQ(entity->content, "stopped");
 }
+
+/**
+ * @given many entities and state machine io context run by several threads
+ * @when events are sent to each entity
+ * @then events of each entity are handled in order they were sent
+ */
+TEST(Dev, EventsOrderPerEntity) {
+  auto context = std::make_shared<HostContext>();
+  Fsm fsm{{Transition(Events::START)
+               .from(States::READY)
+               .to(States::WORKING)
+               .action([](auto data, auto, auto, auto) { data->x = 1; }),
+           Transition(Events::STOP)
+               .from(States::WORKING)
+               .to(States::STOPPED)
+               .action([](auto data, auto, auto, auto) {
+                 data->content = data->x == 1 ? "ordered" : "reordered";
+               })},
+          context};
+  std::vector<std::shared_ptr<Data>> entities;
+  for (auto i = 0; i < 100; ++i) {
+    auto entity = std::make_shared<Data>();
+    EXPECT_OUTCOME_TRUE_1(fsm.begin(entity, States::READY))
+    entities.push_back(entity);
+  }
+  for (auto &entity : entities) {
+    EXPECT_OUTCOME_TRUE_1(fsm.send(entity, Events::START))
+    EXPECT_OUTCOME_TRUE_1(fsm.send(entity, Events::STOP))
+  }
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < 4; ++i) {
+    threads.emplace_back([context] { context->runIoContext(1); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (auto &entity : entities) {
+    EXPECT_EQ(entity->content, "ordered");
+    EXPECT_OUTCOME_EQ(fsm.get(entity), States::STOPPED);
+  }
+}
@@ -6,7 +6,10 @@
 #include "markets/pieceio/pieceio_impl.hpp"
 
 #include <gmock/gmock.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
 
+#include "storage/car/car.hpp"
 #include "storage/ipfs/impl/in_memory_datastore.hpp"
 #include "storage/unixfs/unixfs.hpp"
 #include "testutil/outcome.hpp"
@@ -48,3 +51,51 @@ TEST(PieceIO, generatePieceCommitment) {
   EXPECT_OUTCOME_TRUE(commitment_cid, res.first.toString());
   EXPECT_EQ(commitment_cid_expected, commitment_cid);
 }
+
+/**
+ * @given selective car of PAYLOAD_FILE in memory
+ * @when make commitment from car bytes
+ * @then commitment is same as from payload cid
+ */
+TEST(PieceIO, generatePieceCommitmentFromBuffer) {
+  std::shared_ptr<IpfsDatastore> ipld = std::make_shared<InMemoryDatastore>();
+  auto input = readFile(PAYLOAD_FILE);
+  EXPECT_OUTCOME_TRUE(payload_cid, fc::storage::unixfs::wrapFile(*ipld, input));
+  EXPECT_OUTCOME_TRUE(
+      car, fc::storage::car::makeSelectiveCar(*ipld, {{payload_cid, {}}}));
+
+  PieceIOImpl piece_io{ipld};
+  auto proof{fc::primitives::sector::RegisteredProof::StackedDRG2KiBWindowPoSt};
+  EXPECT_OUTCOME_TRUE(expected,
+                      piece_io.generatePieceCommitment(proof, payload_cid, {}));
+  EXPECT_OUTCOME_EQ(piece_io.generatePieceCommitment(proof, car), expected);
+}
+
+/**
+ * @given selective car of PAYLOAD_FILE staged in file
+ * @when make commitment from file
+ * @then commitment is same as from payload cid and file is padded in place
+ */
+TEST(PieceIO, generatePieceCommitmentFromFile) {
+  std::shared_ptr<IpfsDatastore> ipld = std::make_shared<InMemoryDatastore>();
+  auto input = readFile(PAYLOAD_FILE);
+  EXPECT_OUTCOME_TRUE(payload_cid, fc::storage::unixfs::wrapFile(*ipld, input));
+  EXPECT_OUTCOME_TRUE(
+      car, fc::storage::car::makeSelectiveCar(*ipld, {{payload_cid, {}}}));
+  auto path = boost::filesystem::unique_path(
+      boost::filesystem::temp_directory_path() / "piece-%%%%-%%%%-%%%%");
+  {
+    std::ofstream file{path.string(), std::ios::binary};
+    file.write(reinterpret_cast<const char *>(car.data()), car.size());
+  }
+
+  PieceIOImpl piece_io{ipld};
+  auto proof{fc::primitives::sector::RegisteredProof::StackedDRG2KiBWindowPoSt};
+  EXPECT_OUTCOME_TRUE(expected,
+                      piece_io.generatePieceCommitment(proof, payload_cid, {}));
+  EXPECT_OUTCOME_EQ(
+      piece_io.generatePieceCommitmentFromFile(proof, path.string()),
+      expected);
+  EXPECT_EQ(boost::filesystem::file_size(path), expected.second);
+  boost::filesystem::remove(path);
+}
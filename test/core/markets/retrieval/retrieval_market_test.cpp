@@ -63,4 +63,37 @@ namespace fc::markets::retrieval::test {
 
     EXPECT_OUTCOME_EQ(client_ipfs->contains(payload_cid), true);
   }
+
+  /**
+   * @given retrieval provider has payload with cid
+   * @when more deals than provider stream slots are proposed at once
+   * @then deals beyond slots wait for completed ones @and all succeed
+   */
+  TEST_F(RetrievalMarketFixture, RetrieveQueued) {
+    DealProposalParams params{.selector = kAllSelector,
+                              .piece = boost::none,
+                              .price_per_byte = 2,
+                              .payment_interval = 100,
+                              .payment_interval_increase = 10};
+    TokenAmount total_funds{100};
+    std::vector<std::promise<outcome::result<void>>> results(
+        client::RetrievalClientImpl::kMaxProviderStreams + 2);
+    for (auto &result : results) {
+      client->retrieve(
+          payload_cid,
+          params,
+          host->getPeerInfo(),
+          client_wallet,
+          miner_wallet,
+          total_funds,
+          [&](outcome::result<void> res) { result.set_value(res); });
+    }
+    for (auto &result : results) {
+      auto future = result.get_future();
+      ASSERT_EQ(future.wait_for(std::chrono::seconds(10)),
+                std::future_status::ready);
+      EXPECT_OUTCOME_TRUE_1(future.get());
+    }
+    EXPECT_OUTCOME_EQ(client_ipfs->contains(payload_cid), true);
+  }
 }  // namespace fc::markets::retrieval::test
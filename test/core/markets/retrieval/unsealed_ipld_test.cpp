@@ -0,0 +1,116 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "markets/retrieval/provider/unsealed_ipld.hpp"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "storage/ipld/traverser.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::CID;
+using fc::common::Buffer;
+using fc::markets::retrieval::provider::UnsealedIpld;
+using fc::outcome::result;
+using fc::primitives::piece::PieceData;
+using fc::storage::car::makeCar;
+using fc::storage::ipfs::InMemoryDatastore;
+using fc::storage::ipfs::IpfsDatastoreError;
+using fc::storage::ipld::traverser::Traverser;
+
+struct UnsealedIpldTest : ::testing::Test {
+  void SetUp() override {
+    a = ipld.setCbor(std::string{"a"}).value();
+    b = ipld.setCbor(std::string{"b"}).value();
+    root = ipld.setCbor(std::vector<CID>{a, b}).value();
+    piece = makeCar(ipld, {root}).value();
+    // unsealed piece is padded with zeros
+    piece.put(std::vector<uint8_t>(128, 0));
+  }
+
+  /// Store reading piece from pool
+  std::shared_ptr<UnsealedIpld> open() {
+    return UnsealedIpld::open(
+               [piece{piece}](PieceData output) -> result<void> {
+                 for (size_t written{0}; written < piece.size();) {
+                   auto n{::write(output.getFd(),
+                                  piece.data() + written,
+                                  piece.size() - written)};
+                   if (n <= 0) {
+                     return std::errc::broken_pipe;
+                   }
+                   written += n;
+                 }
+                 return fc::outcome::success();
+               },
+               pool)
+        .value();
+  }
+
+  boost::asio::thread_pool pool{1};
+  InMemoryDatastore ipld;
+  CID a, b, root;
+  Buffer piece;
+};
+
+/**
+ * @given unsealed piece with payload car
+ * @when traverse payload
+ * @then blocks are read from piece in order
+ */
+TEST_F(UnsealedIpldTest, Traverse) {
+  auto unsealed{open()};
+  Traverser traverser{*unsealed, root, {}};
+  std::vector<CID> visited;
+  while (!traverser.isCompleted()) {
+    EXPECT_OUTCOME_TRUE(block, traverser.advanceBlock());
+    EXPECT_OUTCOME_EQ(ipld.get(block.first), block.second);
+    visited.push_back(block.first);
+  }
+  EXPECT_EQ(visited, (std::vector<CID>{root, a, b}));
+}
+
+/**
+ * @given unsealed piece with payload car
+ * @when get blocks out of car order and missing block
+ * @then skipped blocks are kept, missing block is not found
+ */
+TEST_F(UnsealedIpldTest, Skipped) {
+  auto unsealed{open()};
+  EXPECT_OUTCOME_EQ(unsealed->get(b), ipld.get(b).value());
+  EXPECT_OUTCOME_EQ(unsealed->get(a), ipld.get(a).value());
+  EXPECT_OUTCOME_EQ(unsealed->contains(root), true);
+  auto missing{ipld.setCbor(std::string{"c"}).value()};
+  EXPECT_OUTCOME_ERROR(IpfsDatastoreError::kNotFound, unsealed->get(missing));
+}
+
+/**
+ * @given piece reader which fails
+ * @when get block
+ * @then error of reader is returned
+ */
+TEST_F(UnsealedIpldTest, ReadError) {
+  auto unsealed{UnsealedIpld::open(
+                     [](PieceData) -> result<void> {
+                       return std::errc::io_error;
+                     },
+                     pool)
+                     .value()};
+  EXPECT_OUTCOME_ERROR(std::errc::io_error, unsealed->get(root));
+}
+
+/**
+ * @given pool with one thread
+ * @when second store is opened while first is open
+ * @then reader of second store runs on pool after first reader ends
+ */
+TEST_F(UnsealedIpldTest, BoundedPool) {
+  auto first{open()};
+  auto second{open()};
+  EXPECT_OUTCOME_EQ(first->contains(b), true);
+  EXPECT_OUTCOME_EQ(second->contains(b), true);
+}
@@ -114,4 +114,43 @@ namespace fc::markets::storage::chain_events {
               future.wait_for(std::chrono::seconds(0)));
   }
 
+  /**
+   * @given watch of method of actor
+   * @when tipset blocks include same matching message and other messages
+   * @then matcher is called once for matching message
+   */
+  TEST_F(ChainEventsTest, WatchMethod) {
+    CID block1{"010001020002"_cid};
+    CID block2{"010001020003"_cid};
+    UnsignedMessage matching;
+    matching.to = provider;
+    matching.method = ProveCommitSector::Number;
+    UnsignedMessage other_method{matching};
+    other_method.method = PreCommitSector::Number;
+    UnsignedMessage other_actor{matching};
+    other_actor.to = Address::makeFromId(2);
+
+    api->ChainGetBlockMessages = {
+        [=](const CID &cid) -> outcome::result<BlockMessages> {
+          return BlockMessages{.bls = {matching, other_method, other_actor}};
+        }};
+    api->ChainNotify = {
+        [=]() -> outcome::result<Chan<std::vector<HeadChange>>> {
+          auto channel{std::make_shared<Channel<std::vector<HeadChange>>>()};
+          Tipset tipset{.cids = {block1, block2}};
+          channel->write({HeadChange{.type = HeadChangeType::APPLY,
+                                     .value = tipset}});
+          return Chan{std::move(channel)};
+        }};
+
+    size_t calls{0};
+    events->watch(provider, ProveCommitSector::Number, [&](auto &message) {
+      EXPECT_EQ(message, matching);
+      ++calls;
+      return false;
+    });
+    EXPECT_OUTCOME_TRUE_1(events->init());
+    EXPECT_EQ(calls, 1);
+  }
+
 }  // namespace fc::markets::storage::chain_events
@@ -0,0 +1,77 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "markets/storage/deal_state_store.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/in_memory/in_memory_storage.hpp"
+#include "testutil/cbor.hpp"
+#include "testutil/literals.hpp"
+#include "testutil/outcome.hpp"
+
+namespace fc::markets::storage {
+  using fc::storage::InMemoryStorage;
+
+  /// Has fields of deal used by store
+  struct TestDeal {
+    CID proposal_cid;
+    StorageDealStatus state;
+  };
+  CBOR_TUPLE(TestDeal, proposal_cid, state)
+
+  struct DealStateStoreTest : ::testing::Test {
+    std::shared_ptr<InMemoryStorage> datastore{
+        std::make_shared<InMemoryStorage>()};
+    DealStateStoreConfig config{2, std::chrono::hours{1}};
+    CID cid1{"010001020001"_cid};
+    CID cid2{"010001020002"_cid};
+  };
+
+  /**
+   * @given store with batch size of two deals
+   * @when deal is put
+   * @then deal is written with second deal only
+   */
+  TEST_F(DealStateStoreTest, Coalesce) {
+    DealStateStore<TestDeal> store{datastore, config};
+    EXPECT_OUTCOME_TRUE_1(
+        store.put({cid1, StorageDealStatus::STORAGE_DEAL_VALIDATING}));
+    EXPECT_OUTCOME_TRUE_1(
+        store.put({cid1, StorageDealStatus::STORAGE_DEAL_STAGED}));
+    EXPECT_FALSE(datastore->cursor()->isValid());
+
+    EXPECT_OUTCOME_TRUE_1(
+        store.put({cid2, StorageDealStatus::STORAGE_DEAL_STAGED}));
+    DealStateStore<TestDeal> reloaded{datastore, config};
+    EXPECT_OUTCOME_TRUE_1(reloaded.load());
+    EXPECT_OUTCOME_TRUE(deal, reloaded.get(cid1));
+    EXPECT_EQ(deal.state, StorageDealStatus::STORAGE_DEAL_STAGED);
+    EXPECT_EQ(reloaded.list().size(), 2);
+  }
+
+  /**
+   * @given deals in different states
+   * @when list deals by state
+   * @then deals with that state are returned
+   */
+  TEST_F(DealStateStoreTest, ListByStatus) {
+    DealStateStore<TestDeal> store{datastore, config};
+    EXPECT_OUTCOME_TRUE_1(
+        store.put({cid1, StorageDealStatus::STORAGE_DEAL_STAGED}));
+    EXPECT_OUTCOME_TRUE_1(
+        store.put({cid2, StorageDealStatus::STORAGE_DEAL_STAGED}));
+    EXPECT_EQ(store.list(StorageDealStatus::STORAGE_DEAL_STAGED).size(), 2);
+
+    EXPECT_OUTCOME_TRUE_1(
+        store.put({cid1, StorageDealStatus::STORAGE_DEAL_COMPLETED}));
+    EXPECT_EQ(store.list(StorageDealStatus::STORAGE_DEAL_STAGED),
+              std::vector<CID>{cid2});
+    EXPECT_EQ(store.list(StorageDealStatus::STORAGE_DEAL_COMPLETED),
+              std::vector<CID>{cid1});
+    EXPECT_OUTCOME_ERROR(DealStateStoreError::kDealNotFound,
+                         store.get("010001020003"_cid));
+  }
+}  // namespace fc::markets::storage
@@ -0,0 +1,74 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "markets/storage/provider/deal_admission.hpp"
+
+#include <gtest/gtest.h>
+
+#include "testutil/literals.hpp"
+#include "testutil/outcome.hpp"
+
+namespace fc::markets::storage::provider {
+  using api::MarketBalance;
+
+  struct DealAdmissionTest : ::testing::Test {
+    void SetUp() override {
+      api->ChainHead = {[this]() -> outcome::result<Tipset> {
+        ++heads;
+        return Tipset{};
+      }};
+      api->StateMarketBalance = {
+          [this](auto &, auto &) -> outcome::result<MarketBalance> {
+            ++balances;
+            return MarketBalance{100, 20};
+          }};
+    }
+
+    std::shared_ptr<Api> api{std::make_shared<Api>()};
+    size_t heads{};
+    size_t balances{};
+    CID deal1{"010001020001"_cid};
+    CID deal2{"010001020002"_cid};
+    CID deal3{"010001020003"_cid};
+  };
+
+  /**
+   * @given admission with one slot and one queue place
+   * @when three deals are proposed and first is released
+   * @then second is queued and resumed, third is rejected
+   */
+  TEST_F(DealAdmissionTest, SlotsAndQueue) {
+    DealAdmission admission{api, {1, 1, std::chrono::seconds{1}}};
+    auto resumed{false};
+    using Result = DealAdmission::Result;
+    EXPECT_EQ(admission.admit(deal1, {}), Result::kAdmitted);
+    EXPECT_EQ(admission.admit(deal2, [&] { resumed = true; }),
+              Result::kQueued);
+    EXPECT_EQ(admission.admit(deal3, {}), Result::kRejected);
+
+    admission.release(deal1);
+    EXPECT_TRUE(resumed);
+    EXPECT_EQ(admission.active(), 1);
+    EXPECT_EQ(admission.queued(), 0);
+  }
+
+  /**
+   * @given admission with snapshot ttl
+   * @when balance is read for several proposals and funds are reserved
+   * @then head and balance are requested once and reserved funds are
+   * not available
+   */
+  TEST_F(DealAdmissionTest, SharedBalanceView) {
+    DealAdmission admission{api, {1, 1, std::chrono::hours{1}}};
+    Address client{Address::makeFromId(1)};
+    EXPECT_OUTCOME_EQ(admission.available(client), TokenAmount{80});
+    admission.reserve(deal1, client, 30);
+    EXPECT_OUTCOME_EQ(admission.available(client), TokenAmount{50});
+    admission.release(deal1);
+    EXPECT_OUTCOME_EQ(admission.available(client), TokenAmount{80});
+    EXPECT_EQ(heads, 1);
+    EXPECT_EQ(balances, 1);
+  }
+}  // namespace fc::markets::storage::provider
@@ -0,0 +1,176 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "markets/storage/provider/deal_publisher.hpp"
+
+#include <gtest/gtest.h>
+#include <set>
+
+#include "testutil/outcome.hpp"
+
+namespace fc::markets::storage::provider {
+  using api::InvocResult;
+  using primitives::address::Address;
+  using primitives::tipset::Tipset;
+  using primitives::tipset::TipsetKey;
+  using vm::actor::builtin::market::PublishStorageDeals;
+  using vm::actor::builtin::miner::MinerInfo;
+  using vm::message::SignedMessage;
+  using vm::message::UnsignedMessage;
+
+  struct DealPublisherTest : ::testing::Test {
+    void SetUp() override {
+      api->ChainHead = {[]() -> outcome::result<Tipset> { return Tipset{}; }};
+      api->StateMinerInfo = {
+          [](auto &, auto &) -> outcome::result<MinerInfo> {
+            MinerInfo info;
+            info.worker = Address::makeFromId(100);
+            return info;
+          }};
+      api->MpoolPushMessage = {
+          [this](auto &message) -> outcome::result<SignedMessage> {
+            SignedMessage signed_message{message, {}};
+            messages.emplace(signed_message.getCid(), message);
+            return signed_message;
+          }};
+      api->ChainGetMessage = {
+          [this](auto &cid) -> outcome::result<UnsignedMessage> {
+            return messages.at(cid);
+          }};
+      // deals of rejected piece sizes fail alone
+      api->StateCallMany = {[this](auto &calls, auto &)
+                                -> outcome::result<std::vector<InvocResult>> {
+        std::vector<InvocResult> results;
+        for (auto &call : calls) {
+          OUTCOME_TRY(params,
+                      codec::cbor::decode<PublishStorageDeals::Params>(
+                          call.params));
+          InvocResult result;
+          result.message = call;
+          if (rejected.count(params.deals[0].proposal.piece_size) != 0) {
+            result.receipt.exit_code = vm::VMExitCode::kErrIllegalArgument;
+          }
+          results.push_back(std::move(result));
+        }
+        return results;
+      }};
+    }
+
+    ClientDealProposal deal(uint64_t provider, uint64_t piece_size) {
+      ClientDealProposal deal;
+      deal.proposal.provider = Address::makeFromId(provider);
+      deal.proposal.piece_size = piece_size;
+      deal.proposal.start_epoch = 10;
+      return deal;
+    }
+
+    /// Publishes deal and collects its message cid
+    void publish(DealPublisher &publisher, const ClientDealProposal &deal) {
+      publisher.publish(deal, [this](auto cid) {
+        ASSERT_TRUE(cid);
+        cids.push_back(cid.value());
+      });
+    }
+
+    std::shared_ptr<Api> api{std::make_shared<Api>()};
+    std::shared_ptr<boost::asio::io_context> io{
+        std::make_shared<boost::asio::io_context>()};
+    std::map<CID, UnsignedMessage> messages;
+    std::vector<CID> cids;
+    std::set<uint64_t> rejected;
+  };
+
+  /**
+   * @given publisher of up to two deals per message
+   * @when three deals are published
+   * @then first two share message, deal ids are found by proposal, third
+   * waits for batch
+   */
+  TEST_F(DealPublisherTest, BatchByCount) {
+    auto publisher{std::make_shared<DealPublisher>(
+        api, io, DealPublisherConfig{std::chrono::hours{1}, 2})};
+    auto deal1{deal(1, 128)}, deal2{deal(1, 256)}, deal3{deal(1, 512)};
+    publish(*publisher, deal1);
+    EXPECT_TRUE(cids.empty());
+    publish(*publisher, deal2);
+    ASSERT_EQ(cids.size(), 2);
+    EXPECT_EQ(cids[0], cids[1]);
+    EXPECT_OUTCOME_TRUE(params,
+                        codec::cbor::decode<PublishStorageDeals::Params>(
+                            messages.at(cids[0]).params));
+    EXPECT_EQ(params.deals.size(), 2);
+
+    std::vector<DealId> ids{10, 11};
+    EXPECT_OUTCOME_EQ(publisher->dealIdOf(cids[0], ids, deal2), 11);
+    EXPECT_OUTCOME_EQ(publisher->dealIdOf(cids[0], ids, deal1), 10);
+    EXPECT_OUTCOME_ERROR(DealPublisherError::kDealNotInMessage,
+                         publisher->dealIdOf(cids[0], ids, deal3));
+
+    publish(*publisher, deal3);
+    EXPECT_EQ(publisher->pending(), 1);
+    publisher->flush();
+    EXPECT_EQ(publisher->pending(), 0);
+    ASSERT_EQ(cids.size(), 3);
+    EXPECT_NE(cids[2], cids[0]);
+  }
+
+  /**
+   * @given publisher with short wait
+   * @when deal is queued and wait passes
+   * @then deal is published on io thread
+   */
+  TEST_F(DealPublisherTest, BatchByTime) {
+    auto publisher{std::make_shared<DealPublisher>(
+        api, io, DealPublisherConfig{std::chrono::milliseconds{10}, 8})};
+    publish(*publisher, deal(1, 128));
+    EXPECT_TRUE(cids.empty());
+    io->run_for(std::chrono::seconds{1});
+    EXPECT_EQ(cids.size(), 1);
+    EXPECT_EQ(publisher->pending(), 0);
+  }
+
+  /**
+   * @given publisher with queued deal
+   * @when deal of other provider is published
+   * @then queued deal is published in own message
+   */
+  TEST_F(DealPublisherTest, OtherProvider) {
+    auto publisher{std::make_shared<DealPublisher>(
+        api, io, DealPublisherConfig{std::chrono::hours{1}, 8})};
+    publish(*publisher, deal(1, 128));
+    publish(*publisher, deal(2, 128));
+    EXPECT_EQ(cids.size(), 1);
+    EXPECT_EQ(publisher->pending(), 1);
+  }
+
+  /**
+   * @given batch with deal rejected by market actor and deal which start
+   * epoch has passed
+   * @when batch is published
+   * @then invalid deals fail with own errors, valid ones share message
+   */
+  TEST_F(DealPublisherTest, InvalidDealsFailAlone) {
+    auto publisher{std::make_shared<DealPublisher>(
+        api, io, DealPublisherConfig{std::chrono::hours{1}, 8})};
+    rejected.insert(256);
+    auto late{deal(1, 512)};
+    late.proposal.start_epoch = 0;
+    std::vector<outcome::result<CID>> results;
+    for (auto &queued : {deal(1, 128), deal(1, 256), late, deal(1, 1024)}) {
+      publisher->publish(queued,
+                         [&](auto cid) { results.push_back(std::move(cid)); });
+    }
+    publisher->flush();
+    ASSERT_EQ(results.size(), 4);
+    EXPECT_OUTCOME_ERROR(DealPublisherError::kDealRejected, results[0]);
+    EXPECT_OUTCOME_ERROR(DealPublisherError::kStartEpochPassed, results[1]);
+    ASSERT_TRUE(results[2]);
+    EXPECT_EQ(results[2].value(), results[3].value());
+    EXPECT_OUTCOME_TRUE(params,
+                        codec::cbor::decode<PublishStorageDeals::Params>(
+                            messages.at(results[2].value()).params));
+    EXPECT_EQ(params.deals.size(), 2);
+  }
+}  // namespace fc::markets::storage::provider
@@ -69,4 +69,32 @@ namespace fc::markets::storage::test {
                          future.get());
   }
 
+  /**
+   * @given client received ask from provider
+   * @when provider changes ask and client sends get ask again
+   * @then cached ask is returned without request
+   */
+  TEST_F(StorageMarketTest, CachedAsk) {
+    TokenAmount provider_price = 1334;
+    ChainEpoch duration = 2334;
+    EXPECT_OUTCOME_TRUE_1(provider->addAsk(provider_price, duration));
+    auto get_ask = [&] {
+      std::promise<outcome::result<SignedStorageAsk>> promise_ask_res;
+      client->getAsk(*storage_provider_info,
+                     [&](outcome::result<SignedStorageAsk> ask_res) {
+                       promise_ask_res.set_value(ask_res);
+                     });
+      auto future = promise_ask_res.get_future();
+      waitForAskResponse(future);
+      return future.get();
+    };
+    EXPECT_OUTCOME_TRUE(ask, get_ask());
+    EXPECT_EQ(ask.ask.price, provider_price);
+
+    EXPECT_OUTCOME_TRUE_1(provider->addAsk(provider_price + 1, duration));
+    EXPECT_OUTCOME_TRUE(cached, get_ask());
+    EXPECT_EQ(cached.ask.price, provider_price);
+    EXPECT_EQ(cached.ask.seq_no, ask.ask.seq_no);
+  }
+
 }  // namespace fc::markets::storage::test
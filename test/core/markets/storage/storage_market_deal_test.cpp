@@ -154,4 +154,34 @@ namespace fc::markets::storage::test {
     EXPECT_EQ(client_deal_state.state, StorageDealStatus::STORAGE_DEAL_ACTIVE);
   }
 
+  /**
+   * @given deal state stored by provider before restart
+   * @when provider is created on same datastore
+   * @then deal is tracked again in its stored state
+   */
+  TEST_F(StorageMarketTest, RestoresStoredDeals) {
+    MinerDeal deal;
+    deal.proposal_cid = "010001020001"_cid;
+    deal.state = StorageDealStatus::STORAGE_DEAL_SEALING;
+    {
+      auto deal_states{
+          std::make_shared<DealStateStore<MinerDeal>>(datastore)};
+      EXPECT_OUTCOME_TRUE_1(deal_states->put(deal));
+      EXPECT_OUTCOME_TRUE_1(deal_states->flush());
+    }
+    auto restarted{makeProvider(*provider_multiaddress,
+                                registered_proof,
+                                {},
+                                nullptr,
+                                nullptr,
+                                datastore,
+                                host,
+                                context_,
+                                node_api,
+                                nullptr,
+                                chain_events_,
+                                miner_actor_address)};
+    EXPECT_OUTCOME_TRUE(restored, restarted->getDeal(deal.proposal_cid));
+    EXPECT_EQ(restored.state, StorageDealStatus::STORAGE_DEAL_SEALING);
+  }
 }  // namespace fc::markets::storage::test
@@ -120,8 +120,7 @@ namespace fc::markets::storage::test {
           std::make_shared<BlsProviderImpl>();
       std::shared_ptr<Secp256k1ProviderDefault> secp256k1_provider =
           std::make_shared<Secp256k1Sha256ProviderImpl>();
-      std::shared_ptr<Datastore> datastore =
-          std::make_shared<InMemoryStorage>();
+      datastore = std::make_shared<InMemoryStorage>();
       std::shared_ptr<IpfsDatastore> ipfs_datastore =
           std::make_shared<InMemoryDatastore>();
       piece_io_ = std::make_shared<PieceIOImpl>(ipfs_datastore);
@@ -464,6 +463,8 @@ namespace fc::markets::storage::test {
     std::shared_ptr<StorageMarketClient> client;
     std::shared_ptr<StorageProvider> provider;
     std::shared_ptr<StorageProviderInfo> storage_provider_info;
+    /// Shared by provider and client
+    std::shared_ptr<Datastore> datastore;
 
     RegisteredProof registered_proof{RegisteredProof::StackedDRG32GiBSeal};
     std::shared_ptr<PieceIO> piece_io_;
@@ -0,0 +1,79 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "metrics/metrics.hpp"
+
+#include <gtest/gtest.h>
+
+using fc::metrics::Histogram;
+using fc::metrics::Registry;
+
+/**
+ * @given values around powers of two
+ * @when bucket of each value is found
+ * @then value is not above bucket max @and above previous bucket max
+ */
+TEST(MetricsTest, HistogramBuckets) {
+  std::vector<uint64_t> values{
+      0, 1, 3, 4, 5, 7, 8, 1000, 1023, 1024, (1ull << 40) + 12345, UINT64_MAX};
+  for (auto value : values) {
+    auto bucket{Histogram::bucketOf(value)};
+    ASSERT_LT(bucket, Histogram::kBuckets);
+    EXPECT_LE(value, Histogram::bucketMax(bucket));
+    if (bucket != 0) {
+      EXPECT_GT(value, Histogram::bucketMax(bucket - 1));
+    }
+  }
+  EXPECT_EQ(Histogram::bucketOf(UINT64_MAX), Histogram::kBuckets - 1);
+  EXPECT_EQ(Histogram::bucketMax(Histogram::kBuckets - 1), UINT64_MAX);
+}
+
+/**
+ * @given histogram with observed values
+ * @when quantiles are queried
+ * @then they are within bucket precision of exact ones
+ */
+TEST(MetricsTest, HistogramQuantile) {
+  Histogram histogram;
+  for (uint64_t i{1}; i <= 1000; ++i) {
+    histogram.observe(i);
+  }
+  EXPECT_EQ(histogram.count(), 1000);
+  EXPECT_EQ(histogram.sum(), 500500);
+  auto median{histogram.quantile(0.5)};
+  EXPECT_GE(median, 500);
+  EXPECT_LE(median, 500 * 5 / 4);
+  EXPECT_GE(histogram.quantile(1), 1000);
+}
+
+/**
+ * @given registry with counter, gauge and histogram
+ * @when it is exported
+ * @then text has values of each metric @and cumulative histogram buckets
+ */
+TEST(MetricsTest, Prometheus) {
+  Registry registry;
+  registry.counter("requests_total", "Requests", {{"method", "a"}}).inc(3);
+  EXPECT_EQ(&registry.counter("requests_total", "", {{"method", "a"}}),
+            &registry.counter("requests_total", "", {{"method", "a"}}));
+  registry.gauge("queue", "Queue").set(-2);
+  auto &histogram{registry.histogram("latency", "Latency", {}, 0.5)};
+  histogram.observe(uint64_t{2});
+  histogram.observe(uint64_t{6});
+  EXPECT_EQ(registry.prometheus(),
+            "# HELP latency Latency\n"
+            "# TYPE latency histogram\n"
+            "latency_bucket{le=\"1\"} 1\n"
+            "latency_bucket{le=\"3\"} 2\n"
+            "latency_bucket{le=\"+Inf\"} 2\n"
+            "latency_sum 4\n"
+            "latency_count 2\n"
+            "# HELP queue Queue\n"
+            "# TYPE queue gauge\n"
+            "queue -2\n"
+            "# HELP requests_total Requests\n"
+            "# TYPE requests_total counter\n"
+            "requests_total{method=\"a\"} 3\n");
+}
@@ -0,0 +1,78 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "metrics/tracing.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace tracing = fc::metrics::tracing;
+
+size_t countSpans(const std::string &trace) {
+  size_t count{0};
+  for (auto i{trace.find("\"ph\"")}; i != std::string::npos;
+       i = trace.find("\"ph\"", i + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+/**
+ * @given tracing disabled
+ * @when span ends
+ * @then it is not recorded
+ */
+TEST(TracingTest, Disabled) {
+  tracing::enable();
+  tracing::disable();
+  {
+    tracing::ScopedSpan span{"test", "ignored"};
+    EXPECT_FALSE(span);
+  }
+  EXPECT_EQ(countSpans(tracing::chromeTrace()), 0);
+}
+
+/**
+ * @given tracing enabled
+ * @when spans end on different threads
+ * @then each span is exported once with its argument
+ */
+TEST(TracingTest, Threads) {
+  tracing::enable();
+  tracing::Span async{"test", "async"};
+  async.arg("a \"quoted\" arg");
+  std::thread thread{[&] {
+    tracing::ScopedSpan span{"test", "thread"};
+    async.end();
+    async.end();
+  }};
+  thread.join();
+  {
+    tracing::ScopedSpan span{"test", "main"};
+  }
+  tracing::disable();
+  auto trace{tracing::chromeTrace()};
+  EXPECT_EQ(countSpans(trace), 3);
+  EXPECT_NE(trace.find("\"name\":\"thread\""), std::string::npos);
+  EXPECT_NE(trace.find("\"name\":\"main\""), std::string::npos);
+  EXPECT_NE(trace.find(R"("args":{"arg":"a \"quoted\" arg"})"),
+            std::string::npos);
+}
+
+/**
+ * @given tracing with ring of two spans
+ * @when three spans are recorded
+ * @then oldest one is overwritten
+ */
+TEST(TracingTest, Ring) {
+  tracing::enable(2);
+  for (auto name : {"first", "second", "third"}) {
+    tracing::ScopedSpan span{"test", name};
+  }
+  tracing::disable();
+  auto trace{tracing::chromeTrace()};
+  EXPECT_EQ(countSpans(trace), 2);
+  EXPECT_EQ(trace.find("\"name\":\"first\""), std::string::npos);
+}
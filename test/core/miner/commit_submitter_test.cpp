@@ -0,0 +1,145 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "miner/commit_submitter.hpp"
+
+#include <gtest/gtest.h>
+
+#include "testutil/outcome.hpp"
+
+namespace fc::mining {
+  using adt::Channel;
+  using api::Wait;
+  using primitives::tipset::TipsetKey;
+  using vm::message::SignedMessage;
+  using vm::message::UnsignedMessage;
+
+  struct CommitSubmitterTest : testing::Test {
+    void SetUp() override {
+      api->GasEstimateGasPrice = {
+          [this](auto, auto &, auto, auto &) -> outcome::result<TokenAmount> {
+            if (!gas_price) {
+              return std::make_error_code(std::errc::invalid_argument);
+            }
+            return *gas_price;
+          }};
+      api->MpoolPushMessage = {
+          [this](auto &message) -> outcome::result<SignedMessage> {
+            pushed.push_back(message);
+            return SignedMessage{message, {}};
+          }};
+      api->StateWaitMsg = {[this](auto &) -> outcome::result<Wait<MsgWait>> {
+        if (wait_fails) {
+          return std::make_error_code(std::errc::io_error);
+        }
+        auto channel{std::make_shared<Channel<Wait<MsgWait>::Result>>()};
+        waits.push_back(channel);
+        return Wait<MsgWait>{channel};
+      }};
+    }
+
+    std::shared_ptr<CommitSubmitter> submitter(size_t max_in_flight,
+                                               size_t batch_size) {
+      CommitSubmitterConfig config;
+      config.max_in_flight = max_in_flight;
+      config.batch_size = batch_size;
+      config.max_wait = std::chrono::milliseconds{10};
+      config.gas_price = 7;
+      return std::make_shared<CommitSubmitter>(api, io, config);
+    }
+
+    void submit(CommitSubmitter &submitter) {
+      submitter.submit({Address::makeFromId(1), Address::makeFromId(2)},
+                       [this](auto result) { results.push_back(result); });
+    }
+
+    std::shared_ptr<Api> api{std::make_shared<Api>()};
+    std::shared_ptr<boost::asio::io_context> io{
+        std::make_shared<boost::asio::io_context>()};
+    boost::optional<TokenAmount> gas_price{42};
+    bool wait_fails{false};
+    std::vector<UnsignedMessage> pushed;
+    std::vector<std::shared_ptr<Channel<Wait<MsgWait>::Result>>> waits;
+    std::vector<outcome::result<MsgWait>> results;
+  };
+
+  /**
+   * @given submitter with batches of two
+   * @when five messages are submitted
+   * @then they are pushed in batches of two with estimated gas price @and
+   * last one waits for its batch
+   */
+  TEST_F(CommitSubmitterTest, BatchSize) {
+    auto submitter{this->submitter(16, 2)};
+    submit(*submitter);
+    EXPECT_TRUE(pushed.empty());
+    submit(*submitter);
+    EXPECT_EQ(pushed.size(), 2);
+    for (auto i{0}; i < 3; ++i) {
+      submit(*submitter);
+    }
+    EXPECT_EQ(pushed.size(), 4);
+    EXPECT_EQ(submitter->queued(), 1);
+    EXPECT_EQ(submitter->inFlight(), 4);
+    for (auto &message : pushed) {
+      EXPECT_EQ(message.gasPrice, 42);
+    }
+  }
+
+  /**
+   * @given submitter with batches of two
+   * @when one message waits longer than max wait
+   * @then it is pushed alone
+   */
+  TEST_F(CommitSubmitterTest, MaxWait) {
+    auto submitter{this->submitter(16, 2)};
+    submit(*submitter);
+    io->run_for(std::chrono::milliseconds{100});
+    EXPECT_EQ(pushed.size(), 1);
+    EXPECT_EQ(submitter->queued(), 0);
+  }
+
+  /**
+   * @given submitter with one slot
+   * @when waits for inclusion fail or are dropped
+   * @then callbacks get errors @and slot is freed for next message
+   */
+  TEST_F(CommitSubmitterTest, FreeSlotOnWaitError) {
+    auto submitter{this->submitter(1, 1)};
+    wait_fails = true;
+    submit(*submitter);
+    EXPECT_EQ(results.size(), 1);
+    EXPECT_FALSE(results[0]);
+    EXPECT_EQ(submitter->inFlight(), 0);
+
+    wait_fails = false;
+    submit(*submitter);
+    submit(*submitter);
+    EXPECT_EQ(pushed.size(), 2);
+    EXPECT_EQ(submitter->queued(), 1);
+    waits[0]->closeWrite();
+    EXPECT_EQ(results.size(), 2);
+    EXPECT_FALSE(results[1]);
+    EXPECT_EQ(pushed.size(), 3);
+
+    // wait dropped without result
+    waits.clear();
+    EXPECT_EQ(results.size(), 3);
+    EXPECT_EQ(submitter->inFlight(), 0);
+  }
+
+  /**
+   * @given gas price estimation failing
+   * @when batch is pushed
+   * @then configured gas price is used
+   */
+  TEST_F(CommitSubmitterTest, GasPriceFallback) {
+    auto submitter{this->submitter(16, 1)};
+    gas_price.reset();
+    submit(*submitter);
+    ASSERT_EQ(pushed.size(), 1);
+    EXPECT_EQ(pushed[0].gasPrice, 7);
+  }
+}  // namespace fc::mining
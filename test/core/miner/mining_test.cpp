@@ -0,0 +1,84 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "miner/mining.hpp"
+
+#include <gtest/gtest.h>
+
+#include "testutil/literals.hpp"
+#include "testutil/mocks/sector_storage/manager_mock.hpp"
+
+namespace fc::mining {
+  using primitives::sector::PoStProof;
+  using sector_storage::ManagerMock;
+  using testing::_;
+
+  struct MiningTest : testing::Test {
+    void SetUp() override {
+      ts.cids = {"010001020001"_cid};
+      ts.height = 10;
+      api->ChainHead = {[this]() -> outcome::result<Tipset> { return ts; }};
+      // first miner wins, second has no power
+      api->MinerGetBaseInfo = {
+          [this](auto &miner, auto, auto &)
+              -> outcome::result<boost::optional<MiningBaseInfo>> {
+            ++base_infos;
+            if (miner != winner) {
+              return boost::none;
+            }
+            MiningBaseInfo info;
+            info.miner_power = 1;
+            info.network_power = 1;
+            info.beacons.emplace_back();
+            return info;
+          }};
+      api->WalletSign = {
+          [](auto &, auto &) -> outcome::result<crypto::signature::Signature> {
+            return BlsSignature{};
+          }};
+      mining = Mining::create(io, api, prover, {winner, loser});
+      mining->ts = ts;
+    }
+
+    std::shared_ptr<io_context> io{std::make_shared<io_context>()};
+    std::shared_ptr<Api> api{std::make_shared<Api>()};
+    std::shared_ptr<ManagerMock> prover{std::make_shared<ManagerMock>()};
+    Address winner{Address::makeFromId(1)};
+    Address loser{Address::makeFromId(2)};
+    Tipset ts;
+    size_t base_infos{};
+    std::shared_ptr<Mining> mining;
+  };
+
+  /**
+   * @given winning and losing miners
+   * @when prewarm is called twice for same round
+   * @then files of winner only are prewarmed once
+   */
+  TEST_F(MiningTest, PrewarmWinners) {
+    EXPECT_CALL(*prover, prewarmWinningPoSt(1, _))
+        .WillOnce(testing::Return(outcome::success()));
+    mining->prewarm();
+    mining->prewarm();
+    io->run();
+    EXPECT_EQ(base_infos, 2);
+  }
+
+  /**
+   * @given eligibility of miners checked by prewarm
+   * @when block of same round is prepared
+   * @then checks are not repeated @and winning PoSt is generated for winner
+   */
+  TEST_F(MiningTest, PrepareReusesPrewarm) {
+    EXPECT_CALL(*prover, prewarmWinningPoSt(1, _))
+        .WillOnce(testing::Return(outcome::success()));
+    EXPECT_CALL(*prover, generateWinningPoSt(1, _, _))
+        .WillOnce(testing::Return(std::vector<PoStProof>{}));
+    mining->prewarm();
+    io->run();
+    EXPECT_TRUE(mining->prepare());
+    EXPECT_EQ(base_infos, 2);
+  }
+}  // namespace fc::mining
@@ -0,0 +1,104 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "node/gossip.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "storage/mpool/mpool.hpp"
+#include "testutil/peer_id.hpp"
+
+namespace fc::gossip {
+  using crypto::bls::BatchVerifier;
+  using primitives::address::Address;
+  using storage::ipfs::InMemoryDatastore;
+  using vm::message::SignedMessage;
+  using vm::message::UnsignedMessage;
+
+  struct GossipTest : testing::Test {
+    void SetUp() override {
+      // verifier io is never run, so mpool adds never complete
+      auto verifier{std::make_shared<BatchVerifier>(
+          nullptr, verifier_io, pool)};
+      mpool = std::make_shared<Mpool>(
+          std::make_shared<InMemoryDatastore>(), verifier, nullptr);
+    }
+
+    std::shared_ptr<Ingest> ingest(Ingest::Config config) {
+      config.max_in_flight = 1;
+      return std::make_shared<Ingest>(io, nullptr, mpool, config);
+    }
+
+    static Buffer message(uint64_t nonce) {
+      SignedMessage signed_message{
+          UnsignedMessage{Address::makeFromId(1),
+                          Address::makeBls(crypto::bls::PublicKey{}),
+                          nonce,
+                          0,
+                          0,
+                          0,
+                          0,
+                          {}},
+          crypto::bls::Signature{}};
+      return codec::cbor::encode(signed_message).value();
+    }
+
+    std::shared_ptr<boost::asio::io_context> io{
+        std::make_shared<boost::asio::io_context>()};
+    std::shared_ptr<boost::asio::io_context> verifier_io{
+        std::make_shared<boost::asio::io_context>()};
+    std::shared_ptr<boost::asio::thread_pool> pool{
+        std::make_shared<boost::asio::thread_pool>(1)};
+    std::shared_ptr<Mpool> mpool;
+    PeerId peer1{generatePeerId(1)};
+    PeerId peer2{generatePeerId(2)};
+  };
+
+  /**
+   * @given mpool which never completes adds
+   * @when add times out
+   * @then its slot is used by next queued message
+   */
+  TEST_F(GossipTest, AddTimeout) {
+    Ingest::Config config;
+    config.add_timeout = std::chrono::milliseconds{10};
+    auto gossip{ingest(config)};
+    gossip->onMessage(message(0), peer1);
+    gossip->onMessage(message(1), peer1);
+    io->run();
+    EXPECT_EQ(gossip->metrics.abandoned, 2);
+    EXPECT_EQ(gossip->in_flight, 0);
+    EXPECT_TRUE(gossip->adds.empty());
+    EXPECT_TRUE(gossip->queue.empty());
+  }
+
+  /**
+   * @given add of one peer in flight and message of other peer queued
+   * @when first peer disconnects
+   * @then its add is abandoned and queued message is added
+   */
+  TEST_F(GossipTest, PeerGone) {
+    auto gossip{ingest({})};
+    gossip->onMessage(message(0), peer1);
+    io->poll();
+    gossip->onMessage(message(1), peer2);
+    gossip->onMessage(message(2), peer1);
+    io->restart();
+    io->poll();
+    EXPECT_EQ(gossip->in_flight, 1);
+    EXPECT_EQ(gossip->queue.size(), 2);
+
+    gossip->onPeerGone(peer1);
+    EXPECT_EQ(gossip->metrics.abandoned, 1);
+    EXPECT_EQ(gossip->metrics.dropped, 1);
+    EXPECT_EQ(gossip->in_flight, 0);
+    io->restart();
+    io->poll();
+    EXPECT_EQ(gossip->in_flight, 1);
+    ASSERT_EQ(gossip->adds.size(), 1);
+    EXPECT_EQ(gossip->adds.begin()->second.peer, peer2);
+  }
+}  // namespace fc::gossip
@@ -0,0 +1,109 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "node/snapshot.hpp"
+
+#include <gtest/gtest.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <sstream>
+
+#include "storage/car/car_store.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+namespace fc::snapshot {
+  using primitives::address::Address;
+  using primitives::block::BlockHeader;
+  using storage::ipfs::InMemoryDatastore;
+
+  struct SnapshotTest : testing::Test {
+    void SetUp() override {
+      genesis = block(0, {});
+      tip = block(1, genesis.cids);
+    }
+
+    /// Stores header with its messages, receipts and state, each linking leaf
+    Tipset block(uint64_t height, const std::vector<CID> &parents) {
+      auto dag{[&](int64_t value) {
+        auto leaf{ipld->setCbor(value).value()};
+        return ipld->setCbor(std::vector<CID>{leaf}).value();
+      }};
+      BlockHeader header;
+      header.miner = Address::makeFromId(1);
+      header.ticket = primitives::ticket::Ticket{};
+      header.parents = parents;
+      header.height = height;
+      header.messages = dag(10 * height + 1);
+      header.parent_message_receipts = dag(10 * height + 2);
+      header.parent_state_root = dag(10 * height + 3);
+      ipld->setCbor(header).value();
+      return Tipset::create({header}).value();
+    }
+
+    std::string exported(size_t state_epochs) {
+      std::stringstream output;
+      EXPECT_OUTCOME_TRUE_1(
+          exportSnapshot(output, ipld, tip, 1, state_epochs, pool));
+      return output.str();
+    }
+
+    IpldPtr ipld{std::make_shared<InMemoryDatastore>()};
+    std::shared_ptr<boost::asio::thread_pool> pool{
+        std::make_shared<boost::asio::thread_pool>(2)};
+    Tipset genesis, tip;
+  };
+
+  /**
+   * @given chain of two tipsets
+   * @when snapshot of both headers and both states is exported and imported
+   * @then tip is loaded and all blocks of chain are imported
+   */
+  TEST_F(SnapshotTest, RoundTrip) {
+    std::stringstream input{exported(2)};
+    IpldPtr imported{std::make_shared<InMemoryDatastore>()};
+    EXPECT_OUTCOME_TRUE(loaded, importSnapshot(imported, input, *pool));
+    EXPECT_EQ(loaded.cids, tip.cids);
+    for (auto &ts : {tip, genesis}) {
+      EXPECT_OUTCOME_TRUE(raw, ipld->get(ts.cids[0]));
+      EXPECT_OUTCOME_EQ(imported->get(ts.cids[0]), raw);
+      auto &header{ts.blks[0]};
+      for (auto &cid : {header.messages,
+                        header.parent_message_receipts,
+                        header.parent_state_root}) {
+        EXPECT_OUTCOME_TRUE(links, imported->getCbor<std::vector<CID>>(cid));
+        EXPECT_OUTCOME_EQ(imported->contains(links[0]), true);
+      }
+    }
+  }
+
+  /**
+   * @given chain of two tipsets
+   * @when snapshot with state of tip only is imported from car file
+   * @then headers and tip dags are imported, genesis dags are not
+   */
+  TEST_F(SnapshotTest, RoundTripFile) {
+    auto path{boost::filesystem::unique_path(
+                  boost::filesystem::temp_directory_path()
+                  / "snapshot_%%%%-%%%%.car")
+                  .string()};
+    {
+      auto car{exported(1)};
+      std::ofstream file{path, std::ios::binary};
+      file.write(car.data(), car.size());
+    }
+    IpldPtr imported{std::make_shared<InMemoryDatastore>()};
+    auto loaded{importSnapshot(imported, path, *pool)};
+    boost::filesystem::remove(path);
+    boost::filesystem::remove(storage::car::CarStore::indexPath(path));
+    EXPECT_OUTCOME_TRUE(ts, loaded);
+    EXPECT_EQ(ts.cids, tip.cids);
+    EXPECT_OUTCOME_EQ(imported->contains(genesis.cids[0]), true);
+    EXPECT_OUTCOME_EQ(imported->contains(tip.blks[0].parent_state_root),
+                      true);
+    EXPECT_OUTCOME_EQ(
+        imported->contains(genesis.blks[0].parent_state_root), false);
+  }
+}  // namespace fc::snapshot
@@ -0,0 +1,172 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "node/sync.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/literals.hpp"
+#include "testutil/mocks/storage/ipfs/graphsync/graphsync_mock.hpp"
+#include "testutil/outcome.hpp"
+#include "testutil/peer_id.hpp"
+
+namespace fc::sync {
+  using common::Buffer;
+  using primitives::address::Address;
+  using primitives::block::BlockHeader;
+  using storage::ipfs::InMemoryDatastore;
+  using storage::ipfs::graphsync::GraphsyncMock;
+  using storage::ipfs::graphsync::ResponseStatusCode;
+  using testing::_;
+
+  struct SyncTest : testing::Test {
+    void SetUp() override {
+      EXPECT_CALL(*graphsync, start(_, _)).WillOnce([this](auto, auto cb) {
+        on_block = cb;
+      });
+      sync = std::make_shared<Sync>(ipld, ts_sync, nullptr, nullptr, graphsync);
+      sync->fetch_timeout = std::chrono::milliseconds{10};
+
+      block.header.miner = Address::makeFromId(1);
+      block.header.parent_state_root = "010001020005"_cid;
+      block.header.parent_message_receipts = "010001020006"_cid;
+      block.header.messages = "010001020007"_cid;
+      block.bls_messages.push_back("010001020008"_cid);
+      block_cid = ipld->setCbor(block.header).value();
+      // block is known invalid, so its sync ends without network
+      ts_sync->valid.emplace(TipsetKey{{block_cid}}, 0, false);
+    }
+
+    /// Gossips block, its missing message is requested from peer
+    void gossip() {
+      EXPECT_CALL(*graphsync, makeRequest(_, _, block.bls_messages[0], _, _, _))
+          .WillOnce([this](auto &, auto, auto &, auto, auto &, auto cb) {
+            progress = cb;
+            return Subscription{};
+          });
+      EXPECT_OUTCOME_TRUE_1(sync->onGossip(block, peer));
+      EXPECT_EQ(sync->fetches.count(block_cid), 1);
+    }
+
+    std::shared_ptr<boost::asio::io_context> io{
+        std::make_shared<boost::asio::io_context>()};
+    std::shared_ptr<boost::asio::thread_pool> pool{
+        std::make_shared<boost::asio::thread_pool>(1)};
+    IpldPtr ipld{std::make_shared<InMemoryDatastore>()};
+    std::shared_ptr<TsSync> ts_sync{std::make_shared<TsSync>(
+        nullptr, ipld, nullptr, io, pool, nullptr, nullptr)};
+    std::shared_ptr<GraphsyncMock> graphsync{
+        std::make_shared<GraphsyncMock>()};
+    std::shared_ptr<Sync> sync;
+    Graphsync::BlockCallback on_block;
+    Graphsync::RequestProgressCallback progress;
+    BlockWithCids block;
+    CID block_cid;
+    PeerId peer{generatePeerId(1)};
+  };
+
+  /**
+   * @given sync started graphsync
+   * @when blocks are received
+   * @then only blocks matching their cids are stored
+   */
+  TEST_F(SyncTest, StoresVerifiedBlocks) {
+    Buffer data{"010203"_unhex};
+    EXPECT_OUTCOME_TRUE(cid, common::getCidOf(data));
+    on_block(cid, Buffer{"040506"_unhex});
+    EXPECT_OUTCOME_EQ(ipld->contains(cid), false);
+    on_block(cid, data);
+    EXPECT_OUTCOME_EQ(ipld->contains(cid), true);
+  }
+
+  /**
+   * @given gossiped block with missing message
+   * @when message request finishes
+   * @then request of block is cleared
+   */
+  TEST_F(SyncTest, FetchFinished) {
+    gossip();
+    progress(ResponseStatusCode::RS_FULL_CONTENT, {});
+    io->run_for(std::chrono::milliseconds{5});
+    EXPECT_TRUE(sync->fetches.empty());
+  }
+
+  /**
+   * @given gossiped block with missing message
+   * @when peer never answers
+   * @then request of block is cleared after fetch timeout
+   */
+  TEST_F(SyncTest, FetchTimeout) {
+    gossip();
+    io->run_for(std::chrono::milliseconds{50});
+    EXPECT_TRUE(sync->fetches.empty());
+    // late answer after timeout is ignored
+    progress(ResponseStatusCode::RS_FULL_CONTENT, {});
+    io->run_for(std::chrono::milliseconds{5});
+    EXPECT_TRUE(sync->fetches.empty());
+  }
+
+  struct TsSyncTest : testing::Test {
+    void SetUp() override {
+      // headers of grandparent are being fetched, so walk stops at it
+      grandparent = TipsetKey{{"010001020009"_cid}};
+      ts_sync->fetching.insert(grandparent);
+      parent = stored(grandparent, 1, 1);
+    }
+
+    /// Stores header of tipset with its messages
+    TipsetKey stored(const TipsetKey &parents, uint64_t height, uint8_t miner) {
+      BlockHeader block;
+      block.miner = Address::makeFromId(miner);
+      block.ticket = primitives::ticket::Ticket{};
+      block.ticket->bytes[0] = miner;
+      block.parents = parents.cids;
+      block.height = height;
+      block.parent_state_root = "010001020005"_cid;
+      block.parent_message_receipts = "010001020006"_cid;
+      block.messages = ipld->setCbor(primitives::block::MsgMeta{}).value();
+      return TipsetKey{{ipld->setCbor(block).value()}};
+    }
+
+    std::shared_ptr<boost::asio::io_context> io{
+        std::make_shared<boost::asio::io_context>()};
+    std::shared_ptr<boost::asio::thread_pool> pool{
+        std::make_shared<boost::asio::thread_pool>(1)};
+    IpldPtr ipld{std::make_shared<InMemoryDatastore>()};
+    std::shared_ptr<TsSync> ts_sync{std::make_shared<TsSync>(
+        nullptr, ipld, nullptr, io, pool, nullptr, nullptr)};
+    TipsetKey grandparent, parent;
+    PeerId peer{generatePeerId(1)};
+  };
+
+  /**
+   * @given stored tipset being synced
+   * @when same tipset is synced again
+   * @then it is walked once, both callbacks wait for it
+   */
+  TEST_F(TsSyncTest, DedupesChildren) {
+    auto key{stored(parent, 2, 2)};
+    ts_sync->sync(key, 2, peer, [](auto &, auto) {});
+    ts_sync->sync(key, 2, peer, [](auto &, auto) {});
+    EXPECT_EQ(ts_sync->children.at(parent).size(), 1);
+    EXPECT_EQ(ts_sync->children.at(grandparent).size(), 1);
+    EXPECT_EQ(ts_sync->callbacks.at(key).callbacks.size(), 2);
+  }
+
+  /**
+   * @given two stored tipsets with same parent
+   * @when both are synced
+   * @then both are kept as children, parent is walked once
+   */
+  TEST_F(TsSyncTest, KeepsForks) {
+    auto fork1{stored(parent, 2, 2)};
+    auto fork2{stored(parent, 2, 3)};
+    ts_sync->sync(fork1, 2, peer, [](auto &, auto) {});
+    ts_sync->sync(fork2, 2, peer, [](auto &, auto) {});
+    EXPECT_EQ(ts_sync->children.at(parent).size(), 2);
+    EXPECT_EQ(ts_sync->children.at(grandparent).size(), 1);
+  }
+}  // namespace fc::sync
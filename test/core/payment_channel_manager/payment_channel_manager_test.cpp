@@ -0,0 +1,78 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "payment_channel_manager/impl/payment_channel_manager_impl.hpp"
+
+#include <gtest/gtest.h>
+
+#include "payment_channel_manager/impl/payment_channel_manager_error.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+#include "vm/actor/builtin/payment_channel/payment_channel_actor.hpp"
+#include "vm/state/impl/state_tree_impl.hpp"
+
+namespace fc::payment_channel_manager {
+  using primitives::tipset::Tipset;
+  using storage::ipfs::InMemoryDatastore;
+  using vm::actor::Actor;
+  using vm::actor::kPaymentChannelCodeCid;
+  using vm::state::StateTreeImpl;
+
+  struct PaymentChannelManagerTest : testing::Test {
+    void SetUp() override {
+      PaymentChannelState state;
+      state.from = Address::makeFromId(100);
+      state.to = Address::makeFromId(101);
+      head = ipld->setCbor(state).value();
+      setBalance(10);
+      api->ChainHead = {[this]() -> outcome::result<Tipset> { return ts; }};
+      api->WalletVerify = {
+          [](auto &, auto &, auto &) -> outcome::result<bool> {
+            return true;
+          }};
+      voucher.lane = 1;
+      voucher.nonce = 1;
+      voucher.signature = crypto::bls::Signature{};
+    }
+
+    /// Moves chain head to state root, where channel has balance
+    void setBalance(const TokenAmount &balance) {
+      StateTreeImpl tree{ipld};
+      EXPECT_OUTCOME_TRUE_1(
+          tree.set(channel, Actor{kPaymentChannelCodeCid, head, 0, balance}));
+      EXPECT_OUTCOME_TRUE(root, tree.flush());
+      ts.blks.resize(1);
+      ts.blks[0].parent_state_root = root;
+    }
+
+    std::shared_ptr<Ipld> ipld{std::make_shared<InMemoryDatastore>()};
+    std::shared_ptr<Api> api{std::make_shared<Api>()};
+    std::shared_ptr<PaymentChannelManagerImpl> manager{
+        std::make_shared<PaymentChannelManagerImpl>(api, ipld)};
+    Address channel{Address::makeFromId(300)};
+    CID head;
+    Tipset ts;
+    SignedVoucher voucher;
+  };
+
+  /**
+   * @given channel state validated once
+   * @when state block is gone and state root or only balance change
+   * @then cached state is reused @and new balance is checked
+   */
+  TEST_F(PaymentChannelManagerTest, ReusesChannelState) {
+    voucher.amount = 5;
+    EXPECT_OUTCOME_TRUE_1(manager->validateVoucher(channel, voucher));
+
+    EXPECT_OUTCOME_TRUE_1(ipld->remove(head));
+    EXPECT_OUTCOME_TRUE_1(manager->validateVoucher(channel, voucher));
+
+    voucher.amount = 15;
+    EXPECT_OUTCOME_ERROR(PaymentChannelManagerError::kInsufficientFunds,
+                         manager->validateVoucher(channel, voucher));
+    setBalance(20);
+    EXPECT_OUTCOME_TRUE_1(manager->validateVoucher(channel, voucher));
+  }
+}  // namespace fc::payment_channel_manager
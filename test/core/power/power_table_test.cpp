@@ -76,3 +76,23 @@ TEST_F(PowerTableTest, RemoveMiner_Success) {
   EXPECT_OUTCOME_ERROR(PowerTableError::kNoSuchMiner,
                        power_table.getMinerPower(addr));
 }
+
+/**
+ * @given table with 1 miner @and its snapshot
+ * @when table is changed
+ * @then snapshot keeps powers of table at time it was taken
+ */
+TEST_F(PowerTableTest, Snapshot) {
+  Address other{Address::makeFromId(1)};
+  EXPECT_OUTCOME_TRUE_1(power_table.setMinerPower(addr, power));
+  auto snapshot{power_table.snapshot()};
+  EXPECT_OUTCOME_TRUE_1(power_table.setMinerPower(other, power + 1));
+  EXPECT_OUTCOME_TRUE_1(power_table.removeMiner(addr));
+  EXPECT_OUTCOME_EQ(power_table.getSize(), 1);
+  EXPECT_OUTCOME_EQ(power_table.getMaxPower(), power + 1);
+  EXPECT_OUTCOME_EQ(snapshot->getSize(), 1);
+  EXPECT_OUTCOME_EQ(snapshot->getMinerPower(addr), power);
+  EXPECT_OUTCOME_ERROR(PowerTableError::kNoSuchMiner,
+                       snapshot->getMinerPower(other));
+  EXPECT_OUTCOME_EQ(snapshot->getMaxPower(), power);
+}
@@ -141,6 +141,26 @@ TEST_F(AddressCodecTest, RoundTripDecodeEncodeString) {
   }
 }
 
+/**
+ * @given key address on both networks
+ * @when encode it to string repeatedly
+ * @then cached strings equal uncached ones and differ by network
+ */
+TEST_F(AddressCodecTest, EncodeToStringCached) {
+  EXPECT_OUTCOME_TRUE(
+      testnet, decodeFromString("t17uoq6tp427uzv7fztkbsnn64iwotfrristwpryy"));
+  auto mainnet{testnet};
+  mainnet.network = Network::MAINNET;
+  for (auto i = 0; i < 2; ++i) {
+    EXPECT_EQ(encodeToString(testnet),
+              "t17uoq6tp427uzv7fztkbsnn64iwotfrristwpryy");
+    EXPECT_EQ(encodeToString(mainnet),
+              "f17uoq6tp427uzv7fztkbsnn64iwotfrristwpryy");
+  }
+  EXPECT_EQ(encodeToString(mainnet),
+            fc::primitives::address::encodeToStringUncached(mainnet));
+}
+
 /**
  * @given A set of addresses encoded as strings
  * @when Decoding addresses from bytes and re-encoding back to byte array
@@ -209,6 +229,20 @@ TEST(ByteStringCodec, EncodeToByteString) {
       AddressKeyer::encode(actor_address_2));
 }
 
+/**
+ * @given id addresses with varints of different lengths
+ * @when encode them as HAMT keys
+ * @then keys are same as address bytes
+ */
+TEST(ByteStringCodec, EncodeIdSameAsBytes) {
+  for (uint64_t id : {0ull, 127ull, 128ull, 16383ull, 16384ull, ~0ull}) {
+    auto address{Address::makeFromId(id)};
+    auto bytes{encode(address)};
+    EXPECT_EQ(AddressKeyer::encode(address),
+              std::string(bytes.begin(), bytes.end()));
+  }
+}
+
 /**
  * Cross-test with specs-actor
  * Decode address from byte string as HAMT key
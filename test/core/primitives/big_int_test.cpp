@@ -53,3 +53,17 @@ TEST(BigInt, DivideByZero) {
   ASSERT_THROW(BigInt{a / b}, std::exception);
   ASSERT_THROW(fc::bigdiv(a, b), std::exception);
 }
+
+/// Fixed width math gives same result as BigInt and falls back on overflow
+TEST(BigInt, CheckedMath) {
+  using fc::primitives::checkedMath;
+  auto mul{[](auto a, auto b) -> decltype(a) { return a * b; }};
+  BigInt amount{"1000000000000000000000000000"};
+  ASSERT_EQ(checkedMath(mul, int64_t{7}, amount), amount * 7);
+  BigInt big{1};
+  big <<= 200;
+  ASSERT_EQ(checkedMath(mul, big, big), BigInt{big * big});
+  BigInt huge{1};
+  huge <<= 300;
+  ASSERT_EQ(checkedMath(mul, huge, BigInt{-1}), -huge);
+}
@@ -0,0 +1,34 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/cid/cb_cid.hpp"
+
+#include <gtest/gtest.h>
+#include <unordered_set>
+#include "testutil/literals.hpp"
+#include "testutil/outcome.hpp"
+
+namespace fc {
+  /**
+   * @given DAG-CBOR blake2b-256 cid and cid of other codec
+   * @when make keys of them
+   * @then first is stored inline and converts back, second is kept as is
+   */
+  TEST(CbCidTest, Key) {
+    EXPECT_OUTCOME_TRUE(cid, common::getCidOf("01"_unhex));
+    auto cb{CbCid::make(cid)};
+    ASSERT_TRUE(cb);
+    EXPECT_EQ(cb->toCid(), cid);
+    EXPECT_EQ(cidKey(cid), CidKey{*cb});
+
+    auto raw{"010001020005"_cid};
+    EXPECT_FALSE(CbCid::make(raw));
+    EXPECT_EQ(cidKey(raw), CidKey{raw});
+
+    std::unordered_set<CidKey> keys{cidKey(cid), cidKey(raw)};
+    EXPECT_EQ(keys.count(cidKey(cid)), 1);
+    EXPECT_EQ(keys.count(cidKey(raw)), 1);
+  }
+}  // namespace fc
@@ -0,0 +1,34 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/cid/cbor_cached.hpp"
+
+#include <gtest/gtest.h>
+#include "testutil/literals.hpp"
+#include "testutil/outcome.hpp"
+
+namespace fc::primitives::cid {
+  /**
+   * @given list of non-canonically encoded integer and integer
+   * @when decode elements as cached and encode them again
+   * @then received bytes are kept, encoded and hashed instead of value
+   */
+  TEST(CborCachedTest, KeepsBytes) {
+    auto bytes{"82180102"_unhex};
+    EXPECT_OUTCOME_TRUE(list,
+                        codec::cbor::decode<std::vector<CborCached<int>>>(
+                            bytes));
+    ASSERT_EQ(list.size(), 2);
+    EXPECT_EQ(list[0].value, 1);
+    EXPECT_EQ(list[0].bytes, "1801"_unhex);
+    EXPECT_EQ(list[1].value, 2);
+    EXPECT_EQ(list[1].bytes, "02"_unhex);
+    EXPECT_OUTCOME_EQ(codec::cbor::encode(list), bytes);
+    EXPECT_OUTCOME_EQ(list[0].cid(), common::getCidOf("1801"_unhex).value());
+
+    EXPECT_OUTCOME_TRUE(made, CborCached<int>::make(1));
+    EXPECT_EQ(made.bytes, "01"_unhex);
+  }
+}  // namespace fc::primitives::cid
@@ -0,0 +1,91 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/piece/comm_p.hpp"
+
+#include <random>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "primitives/cid/comm_cid.hpp"
+#include "primitives/piece/piece_error.hpp"
+#include "testutil/literals.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::common::CIDToPieceCommitmentV1;
+using fc::primitives::piece::generatePieceCommitment;
+using fc::primitives::piece::PieceError;
+using fc::primitives::piece::UnpaddedPieceSize;
+
+/// Random bytes of given size
+std::vector<uint8_t> randomBytes(size_t size) {
+  std::mt19937 gen{0};
+  std::uniform_int_distribution<int> dis(0, 255);
+  std::vector<uint8_t> bytes(size);
+  for (auto &byte : bytes) {
+    byte = dis(gen);
+  }
+  return bytes;
+}
+
+/**
+ * @given empty data and minimal piece size
+ * @when generatePieceCommitment
+ * @then zero piece commitment is returned
+ */
+TEST(CommPTest, ZeroPiece) {
+  EXPECT_OUTCOME_TRUE(cid,
+                      generatePieceCommitment(std::vector<uint8_t>{},
+                                              UnpaddedPieceSize{127}));
+  EXPECT_OUTCOME_EQ(
+      CIDToPieceCommitmentV1(cid),
+      "3731bb99ac689f66eef5973e4a94da188f4ddcae580724fc6f3fd60dfd488333"_blob32);
+}
+
+/**
+ * @given explicit zero bytes of piece size spanning several subtrees
+ * @when generatePieceCommitment
+ * @then commitment is same as for empty data padded with zeros
+ */
+TEST(CommPTest, ZeroSubtrees) {
+  UnpaddedPieceSize size{127 << 15};
+  auto pool{std::make_shared<boost::asio::thread_pool>(2)};
+  EXPECT_OUTCOME_TRUE(
+      expected, generatePieceCommitment(std::vector<uint8_t>{}, size, pool));
+  EXPECT_OUTCOME_EQ(
+      generatePieceCommitment(std::vector<uint8_t>(size, 0), size, pool),
+      expected);
+}
+
+/**
+ * @given data spanning several subtrees
+ * @when generatePieceCommitment from buffer and stream with and without pool
+ * @then commitments are same
+ */
+TEST(CommPTest, PoolAndStream) {
+  // more subtrees than one batch
+  UnpaddedPieceSize size{127 << 17};
+  auto data = randomBytes(10000000);
+  EXPECT_OUTCOME_TRUE(expected, generatePieceCommitment(data, size));
+  auto pool{std::make_shared<boost::asio::thread_pool>(3)};
+  EXPECT_OUTCOME_EQ(generatePieceCommitment(data, size, pool), expected);
+  std::stringstream stream{std::string{data.begin(), data.end()}};
+  EXPECT_OUTCOME_EQ(generatePieceCommitment(stream, size, pool), expected);
+}
+
+/**
+ * @given data larger than piece size
+ * @when generatePieceCommitment
+ * @then error returned
+ */
+TEST(CommPTest, DataTooLarge) {
+  auto data = randomBytes(128);
+  EXPECT_OUTCOME_ERROR(PieceError::kDataTooLarge,
+                       generatePieceCommitment(data, UnpaddedPieceSize{127}));
+  std::stringstream stream{std::string{data.begin(), data.end()}};
+  EXPECT_OUTCOME_ERROR(PieceError::kDataTooLarge,
+                       generatePieceCommitment(stream, UnpaddedPieceSize{127}));
+}
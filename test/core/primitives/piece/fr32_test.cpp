@@ -0,0 +1,66 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/piece/fr32.hpp"
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+using fc::primitives::piece::pad;
+using fc::primitives::piece::unpad;
+
+/// Random bytes of given size
+std::vector<uint8_t> randomBytes(size_t size) {
+  std::mt19937 gen{0};
+  std::uniform_int_distribution<int> dis(0, 255);
+  std::vector<uint8_t> bytes(size);
+  for (auto &byte : bytes) {
+    byte = dis(gen);
+  }
+  return bytes;
+}
+
+/// Bit by bit unpadding, takes 254 low bits of each 256-bit element
+std::vector<uint8_t> referenceUnpad(const std::vector<uint8_t> &padded) {
+  std::vector<uint8_t> unpadded(padded.size() / 128 * 127);
+  size_t out{};
+  for (size_t element{0}; element < padded.size() / 32; ++element) {
+    for (size_t bit{0}; bit < 254; ++bit, ++out) {
+      auto in{element * 256 + bit};
+      if ((padded[in / 8] >> (in % 8)) & 1) {
+        unpadded[out / 8] |= 1 << (out % 8);
+      }
+    }
+  }
+  return unpadded;
+}
+
+class Fr32Test : public testing::TestWithParam<size_t> {};
+
+/**
+ * @given random data of several chunks
+ * @when pad and unpad it
+ * @then padded elements have two zero high bits, match bit by bit
+ * reference, and unpad restores data
+ */
+TEST_P(Fr32Test, PadUnpad) {
+  auto chunks{GetParam()};
+  auto data{randomBytes(chunks * 127)};
+  std::vector<uint8_t> padded(chunks * 128, 0xFF);
+  pad(data, padded);
+  for (size_t element{0}; element < chunks * 4; ++element) {
+    EXPECT_EQ(padded[element * 32 + 31] & 0xC0, 0);
+  }
+  EXPECT_EQ(referenceUnpad(padded), data);
+  std::vector<uint8_t> unpadded(chunks * 127, 0xFF);
+  unpad(padded, unpadded);
+  EXPECT_EQ(unpadded, data);
+}
+
+/// Single chunk and unaligned counts check last chunk handling
+INSTANTIATE_TEST_CASE_P(Fr32TestCases,
+                        Fr32Test,
+                        testing::Values(1, 2, 3, 7, 64, 1024));
@@ -0,0 +1,130 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/resources/active_resources.hpp"
+
+#include <gtest/gtest.h>
+
+using fc::primitives::ActiveResources;
+using fc::primitives::canHandleRequest;
+using fc::primitives::kMultiThread;
+using fc::primitives::Resources;
+using fc::primitives::WorkerResources;
+
+const Resources kGpuTask{
+    .min_memory = 1,
+    .max_memory = 1,
+    .threads = kMultiThread,
+    .can_gpu = true,
+    .base_min_memory = 0,
+};
+const Resources kCpuTask{
+    .min_memory = 1,
+    .max_memory = 1,
+    .threads = 1,
+    .can_gpu = false,
+    .base_min_memory = 0,
+};
+
+WorkerResources worker(std::vector<std::string> gpus) {
+  return {
+      .physical_memory = 100,
+      .swap_memory = 0,
+      .reserved_memory = 0,
+      .cpus = 8,
+      .gpus = std::move(gpus),
+  };
+}
+
+/**
+ * @given worker with 2 gpus
+ * @when gpu tasks are added
+ * @then each task holds one device, and cpu tasks fit beside them
+ */
+TEST(ActiveResources, GpuPerDevice) {
+  auto resources{worker({"gpu0", "gpu1"})};
+  ActiveResources active;
+  EXPECT_TRUE(canHandleRequest(kGpuTask, resources, active));
+  active.add(resources, kGpuTask);
+  EXPECT_TRUE(canHandleRequest(kGpuTask, resources, active));
+  active.add(resources, kGpuTask);
+  EXPECT_EQ(active.gpu_use, 2);
+  EXPECT_FALSE(canHandleRequest(kGpuTask, resources, active));
+  EXPECT_TRUE(canHandleRequest(kCpuTask, resources, active));
+
+  active.free(resources, kGpuTask);
+  EXPECT_TRUE(canHandleRequest(kGpuTask, resources, active));
+  active.free(resources, kGpuTask);
+  EXPECT_EQ(active.gpu_use, 0);
+  EXPECT_EQ(active.cpu_use, 0);
+}
+
+/**
+ * @given worker without gpu
+ * @when multithread task is added
+ * @then it holds all cores
+ */
+TEST(ActiveResources, MultiThreadWithoutGpu) {
+  auto resources{worker({})};
+  ActiveResources active;
+  active.add(resources, kGpuTask);
+  EXPECT_EQ(active.cpu_use, resources.cpus);
+  EXPECT_EQ(active.gpu_use, 0);
+  EXPECT_FALSE(canHandleRequest(kCpuTask, resources, active));
+}
+
+WorkerResources numaWorker() {
+  auto resources{worker({})};
+  resources.numa_nodes = {{0, {0, 1, 2, 3}, 50}, {1, {4, 5, 6, 7}, 50}};
+  return resources;
+}
+
+/**
+ * @given worker with 2 NUMA nodes
+ * @when cpu tasks are added to nodes picked for them
+ * @then tasks are spread over nodes, and node without cores left is not
+ * picked
+ */
+TEST(ActiveResources, NumaPlacement) {
+  using fc::primitives::pickNumaNode;
+  auto resources{numaWorker()};
+  auto task{kCpuTask};
+  task.threads = 3;
+  task.min_memory = 20;
+  ActiveResources preparing, active;
+
+  auto first{pickNumaNode(task, resources, preparing, active)};
+  ASSERT_TRUE(first);
+  active.add(resources, task, first);
+  auto second{pickNumaNode(task, resources, preparing, active)};
+  ASSERT_TRUE(second);
+  EXPECT_NE(*first, *second);
+  preparing.add(resources, task, second);
+  EXPECT_EQ(active.cpu_use + preparing.cpu_use, 6);
+
+  // 2 cores fit worker, but no node has 3 cores left
+  EXPECT_FALSE(pickNumaNode(task, resources, preparing, active));
+  EXPECT_FALSE(canHandleRequest(task, resources, preparing, active));
+  EXPECT_TRUE(canHandleRequest(kCpuTask, resources, preparing, active));
+
+  active.free(resources, task, first);
+  EXPECT_EQ(*pickNumaNode(task, resources, preparing, active), *first);
+  EXPECT_EQ(active.numa_cpu_use[*first], 0);
+}
+
+/**
+ * @given worker with 2 NUMA nodes
+ * @when gpu or multithread task is checked
+ * @then it is not bound to node
+ */
+TEST(ActiveResources, NumaUnboundTasks) {
+  using fc::primitives::isNumaBound;
+  auto resources{numaWorker()};
+  EXPECT_TRUE(isNumaBound(kCpuTask, resources));
+  EXPECT_FALSE(isNumaBound(kGpuTask, resources));
+  resources.gpus = {"gpu0"};
+  EXPECT_FALSE(isNumaBound(kGpuTask, resources));
+  EXPECT_FALSE(isNumaBound(kCpuTask, worker({})));
+}
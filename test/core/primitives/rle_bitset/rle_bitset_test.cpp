@@ -17,3 +17,58 @@ TEST(RleBitsetTest, RleBitsetCbor) {
   using fc::primitives::RleBitset;
   expectEncodeAndReencode(RleBitset{2, 7}, "43504a01"_unhex);
 }
+
+/**
+ * @given rle bitsets
+ * @when insert and erase values and runs
+ * @then consecutive values are kept as single runs
+ */
+TEST(RleBitsetTest, Runs) {
+  using fc::primitives::RleBitset;
+  RleBitset set{1, 2, 3, 7};
+  EXPECT_EQ(set.runs(), (RleBitset::Runs{{1, 4}, {7, 8}}));
+  EXPECT_EQ(set.size(), 4);
+  set.insertRun(4, 7);
+  EXPECT_EQ(set.runs(), (RleBitset::Runs{{1, 8}}));
+  EXPECT_EQ(set.erase(5), 1);
+  EXPECT_EQ(set.erase(5), 0);
+  EXPECT_EQ(set.runs(), (RleBitset::Runs{{1, 5}, {6, 8}}));
+  EXPECT_EQ(set.size(), 6);
+  EXPECT_TRUE(set.contains(4));
+  EXPECT_FALSE(set.contains(5));
+  EXPECT_EQ(std::vector<uint64_t>(set.begin(), set.end()),
+            (std::vector<uint64_t>{1, 2, 3, 4, 6, 7}));
+
+  RleBitset range;
+  range.insert(set.find(3), set.find(7));
+  EXPECT_EQ(range, (RleBitset{3, 4, 6}));
+}
+
+/**
+ * @given rle bitsets
+ * @when unite, intersect and subtract them
+ * @then result is same as element by element
+ */
+TEST(RleBitsetTest, Algebra) {
+  using fc::primitives::RleBitset;
+  RleBitset a{1, 2, 3, 4, 8, 9}, b{0, 3, 4, 5, 9, 10};
+  EXPECT_EQ(a.unite(b), (RleBitset{0, 1, 2, 3, 4, 5, 8, 9, 10}));
+  EXPECT_EQ(a.intersect(b), (RleBitset{3, 4, 9}));
+  EXPECT_EQ(a.subtract(b), (RleBitset{1, 2, 8}));
+  EXPECT_EQ(b.subtract(a), (RleBitset{0, 5, 10}));
+}
+
+/**
+ * @given rle bitset of million consecutive values
+ * @when encode and decode it
+ * @then it is decoded as single run
+ */
+TEST(RleBitsetTest, LargeRun) {
+  using fc::primitives::RleBitset;
+  RleBitset set;
+  set.insertRun(0, 1000000);
+  EXPECT_OUTCOME_TRUE(bytes, fc::codec::cbor::encode(set));
+  EXPECT_OUTCOME_TRUE(decoded, fc::codec::cbor::decode<RleBitset>(bytes));
+  EXPECT_EQ(decoded.runs(), (RleBitset::Runs{{0, 1000000}}));
+  EXPECT_EQ(decoded.size(), 1000000);
+}
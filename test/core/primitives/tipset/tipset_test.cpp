@@ -8,6 +8,7 @@
 #include <gtest/gtest.h>
 #include "common/hexutil.hpp"
 #include "primitives/cid/cid_of_cbor.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
 #include "testutil/cbor.hpp"
 #include "testutil/crypto/sample_signatures.hpp"
 #include "testutil/literals.hpp"
@@ -153,3 +154,45 @@ TEST_F(TipsetTest, LotusCrossTestSuccess) {
       ts,
       "8381D82A5827000171A0E402209C9796303464DF1DC914244249A0A8DA032BF08B5782A6E9121C44BAF185DBC2818F4200018158600201010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101018142F00D81820442F00D81820342F00D81D82A470001000102000242000304D82A4700010001020005D82A4700010001020006D82A4700010001020007F608F60904"_unhex);
 }
+
+/**
+ * @given tipset and its parent stored in ipld
+ * @when draw randomness for parent round @and draw again without parent in
+ * ipld
+ * @then both draws use parent ticket
+ */
+TEST_F(TipsetTest, RandomnessLookbackCached) {
+  using fc::crypto::randomness::DomainSeparationTag;
+  auto ipld{std::make_shared<fc::storage::ipfs::InMemoryDatastore>()};
+  EXPECT_OUTCOME_TRUE(parent, ipld->setCbor(bh1));
+  auto child{makeBlock()};
+  child.parents = {parent};
+  child.height = bh1.height + 2;
+  EXPECT_OUTCOME_TRUE(ts, Tipset::create({child}));
+  auto tag{DomainSeparationTag::TicketProduction};
+  auto round{static_cast<fc::primitives::ChainEpoch>(bh1.height)};
+  auto expected{fc::crypto::randomness::drawRandomness(
+      bh1.ticket->bytes, tag, round, "F00D"_unhex)};
+  EXPECT_OUTCOME_EQ(ts.randomness(*ipld, tag, round, "F00D"_unhex), expected);
+
+  fc::storage::ipfs::InMemoryDatastore empty;
+  EXPECT_OUTCOME_EQ(ts.randomness(empty, tag, round, "F00D"_unhex), expected);
+}
+
+/**
+ * @given tipset of one block loaded from ipld
+ * @when load it again @and load it from other ipld without its block
+ * @then same cached tipset is returned by first ipld only
+ */
+TEST_F(TipsetTest, LoadCached) {
+  auto block1{makeBlock()};
+  block1.height = 1000;
+  fc::storage::ipfs::InMemoryDatastore ipld;
+  EXPECT_OUTCOME_TRUE(cid1, ipld.setCbor(block1));
+  EXPECT_OUTCOME_TRUE(ts1, Tipset::loadShared(ipld, {cid1}));
+  EXPECT_OUTCOME_EQ(Tipset::loadShared(ipld, {cid1}), ts1);
+  EXPECT_OUTCOME_EQ(Tipset::load(ipld, {cid1}), *ts1);
+
+  fc::storage::ipfs::InMemoryDatastore other;
+  EXPECT_FALSE(Tipset::load(other, {cid1}));
+}
@@ -0,0 +1,90 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "proofs/proof_param_provider.hpp"
+
+#include <cstdlib>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "common/hexutil.hpp"
+#include "crypto/blake2/blake2b160.hpp"
+#include "testutil/outcome.hpp"
+#include "testutil/storage/base_fs_test.hpp"
+
+using fc::proofs::ParamFile;
+using fc::proofs::ProofParamProvider;
+using fc::proofs::ProofParamProviderError;
+
+class ProofParamProviderTest : public test::BaseFS_Test {
+ public:
+  ProofParamProviderTest()
+      : test::BaseFS_Test("fc_proof_param_provider_test") {}
+
+  void SetUp() override {
+    BaseFS_Test::SetUp();
+    setenv("FIL_PROOFS_PARAMETER_CACHE", base_path.c_str(), 1);
+    // no network in test, downloads fail fast
+    setenv("IPFS_GATEWAY", "http://127.0.0.1:1/", 1);
+    unsetenv("TRUST_PARAMS");
+
+    writeParam("content");
+    std::ifstream file{(base_path / param.name).string(), std::ios::binary};
+    auto sum{fc::crypto::blake2b::blake2b_512_from_file(file)};
+    param.digest = fc::common::hex_lower(gsl::make_span(sum).subspan(0, 16));
+    params.push_back(param);
+  }
+
+  void TearDown() override {
+    unsetenv("FIL_PROOFS_PARAMETER_CACHE");
+    unsetenv("IPFS_GATEWAY");
+    BaseFS_Test::TearDown();
+  }
+
+  void writeParam(const std::string &content) {
+    std::ofstream file{(base_path / param.name).string(),
+                       std::ios::binary | std::ios::trunc};
+    file << content;
+  }
+
+  ParamFile param{"test.params", "cid", "", 2048};
+  std::vector<ParamFile> params;
+};
+
+/**
+ * @given param file matching its digest
+ * @when verify params and get params
+ * @then file is trusted by manifest and not downloaded
+ */
+TEST_F(ProofParamProviderTest, VerifiedFileSkipped) {
+  EXPECT_OUTCOME_TRUE_1(ProofParamProvider::verifyParams(params, 2048));
+  EXPECT_TRUE(exists(".verified"));
+  EXPECT_OUTCOME_TRUE_1(ProofParamProvider::getParams(params, 2048));
+}
+
+/**
+ * @given verified param file
+ * @when file content changes
+ * @then verification fails and file is no longer trusted
+ */
+TEST_F(ProofParamProviderTest, ChangedFileNotTrusted) {
+  EXPECT_OUTCOME_TRUE_1(ProofParamProvider::verifyParams(params, 2048));
+  writeParam("other content");
+  EXPECT_OUTCOME_ERROR(ProofParamProviderError::kChecksumMismatch,
+                       ProofParamProvider::verifyParams(params, 2048));
+  EXPECT_OUTCOME_ERROR(ProofParamProviderError::kFailedDownloading,
+                       ProofParamProvider::getParams(params, 2048));
+}
+
+/**
+ * @given param file matching its digest
+ * @when verify params in background
+ * @then verification succeeds
+ */
+TEST_F(ProofParamProviderTest, VerifyAsync) {
+  auto future{ProofParamProvider::verifyParamsAsync(params, 2048)};
+  EXPECT_OUTCOME_TRUE_1(future.get());
+}
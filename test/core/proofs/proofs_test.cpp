@@ -5,10 +5,12 @@
 
 #include "proofs/proofs.hpp"
 
+#include <chrono>
 #include <random>
 
 #include <gtest/gtest.h>
 
+#include "primitives/piece/comm_p.hpp"
 #include "primitives/piece/piece.hpp"
 #include "primitives/piece/piece_data.hpp"
 #include "primitives/sector/sector.hpp"
@@ -609,3 +611,47 @@ TEST_F(ProofsTest, LibAndCustomWriteCmp) {
                  std::istreambuf_iterator<char>(),
                  std::istreambuf_iterator<char>(unseal_file.rdbuf())));
 }
+
+/**
+ * @given piece file larger than one native subtree
+ * @when generate piece cid with ffi and natively
+ * @then cids are same, durations are recorded as test properties
+ */
+TEST_F(ProofsTest, NativePieceCommitment) {
+  UnpaddedPieceSize piece_size{127 << 16};
+  std::vector<uint8_t> some_bytes(5000000);
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<int> dis(0, 255);
+  for (auto &byte : some_bytes) {
+    byte = dis(gen);
+  }
+
+  auto path_model = fs::canonical(base_path).append("%%%%%");
+  Path piece_file_path = boost::filesystem::unique_path(path_model).string();
+  boost::filesystem::ofstream piece_file(piece_file_path);
+  piece_file.write(reinterpret_cast<const char *>(some_bytes.data()),
+                   some_bytes.size());
+  piece_file.close();
+
+  auto micros = [](auto start) {
+    return static_cast<int>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+  };
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_OUTCOME_TRUE(
+      ffi_cid,
+      Proofs::generatePieceCIDFromFile(
+          fc::primitives::sector::RegisteredProof::StackedDRG8MiBSeal,
+          piece_file_path,
+          piece_size));
+  RecordProperty("ffi_us", micros(start));
+
+  start = std::chrono::steady_clock::now();
+  std::ifstream input(piece_file_path, std::ios::binary);
+  EXPECT_OUTCOME_EQ(
+      fc::primitives::piece::generatePieceCommitment(input, piece_size),
+      ffi_cid);
+  RecordProperty("native_us", micros(start));
+}
@@ -5,6 +5,9 @@
 
 #include "sector_storage/impl/manager_impl.hpp"
 
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include "sector_storage/stores/store_error.hpp"
 #include "testutil/mocks/sector_storage/scheduler_mock.hpp"
 #include "testutil/mocks/sector_storage/stores/local_storage_mock.hpp"
 #include "testutil/mocks/sector_storage/stores/local_store_mock.hpp"
@@ -162,3 +165,54 @@ TEST_F(ManagerTest, getLocalStorages) {
   EXPECT_OUTCOME_TRUE(storages, manager_->getLocalStorages());
   EXPECT_THAT(storages, ::testing::UnorderedElementsAreArray(result));
 }
+
+/**
+ * @given sectors with complete files, missing cache file and missing paths
+ * @when checkProvable is called, twice
+ * @then sectors with missing files are bad, in order of request
+ */
+TEST_F(ManagerTest, checkProvable) {
+  using fc::sector_storage::stores::AcquireSectorResponse;
+  using fc::sector_storage::stores::Lock;
+  using fc::sector_storage::stores::StoreErrors;
+  namespace fs = boost::filesystem;
+
+  auto root{fs::temp_directory_path() / fs::unique_path()};
+  auto write{[](const fs::path &path, size_t size) {
+    fs::create_directories(path.parent_path());
+    fs::ofstream{path} << std::string(size, 0);
+  }};
+  std::vector<SectorId> sectors;
+  for (auto i : {1, 2, 3, 4}) {
+    sectors.push_back(SectorId{.miner = 1, .sector = uint64_t(i)});
+    auto dir{root / std::to_string(i)};
+    write(dir / "sealed", 2048);
+    for (auto name : {"t_aux", "p_aux", "sc-02-data-tree-r-last.dat"}) {
+      write(dir / "cache" / name, 1);
+    }
+  }
+  fs::remove(root / "2" / "cache" / "p_aux");
+
+  EXPECT_CALL(*sector_index_, storageTryLock(_, _, _))
+      .WillRepeatedly(::testing::Invoke(
+          [](auto &&...) { return std::make_unique<Lock>(); }));
+  EXPECT_CALL(*local_store_, acquireSector(_, _, _, _, _))
+      .WillRepeatedly(::testing::Invoke(
+          [&](SectorId sector, auto &&...)
+              -> fc::outcome::result<AcquireSectorResponse> {
+            if (sector.sector == 3) {
+              return StoreErrors::kNotFoundRequestedSectorType;
+            }
+            auto dir{root / std::to_string(sector.sector)};
+            AcquireSectorResponse response;
+            response.paths.sealed = (dir / "sealed").string();
+            response.paths.cache = (dir / "cache").string();
+            response.storages.sealed = "storage";
+            return response;
+          }));
+
+  std::vector<SectorId> bad{sectors[1], sectors[2]};
+  EXPECT_OUTCOME_EQ(manager_->checkProvable(seal_proof_type_, sectors), bad);
+  EXPECT_OUTCOME_EQ(manager_->checkProvable(seal_proof_type_, sectors), bad);
+  fs::remove_all(root);
+}
@@ -0,0 +1,94 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/impl/numa.hpp"
+
+#include <gtest/gtest.h>
+#include <boost/filesystem/fstream.hpp>
+
+#include "testutil/storage/base_fs_test.hpp"
+
+namespace fc::sector_storage::numa {
+  using Cpus = std::vector<uint64_t>;
+
+  class NumaTest : public test::BaseFS_Test {
+   public:
+    NumaTest() : test::BaseFS_Test("fc_numa_test") {}
+
+    void node(const std::string &name,
+              const std::string &cpulist,
+              uint64_t memory_kb) {
+      auto dir{createDir(name)};
+      fs::ofstream{dir / "cpulist"} << cpulist << "\n";
+      fs::ofstream{dir / "meminfo"}
+          << "Node 0 MemTotal:       " << memory_kb << " kB\n"
+          << "Node 0 MemFree:        1 kB\n";
+    }
+  };
+
+  /**
+   * @given kernel cpu lists
+   * @when parsed
+   * @then ranges are expanded, malformed lists are rejected
+   */
+  TEST(NumaCpuList, Parse) {
+    EXPECT_EQ(*parseCpuList("0-3,8-9\n"), Cpus({0, 1, 2, 3, 8, 9}));
+    EXPECT_EQ(*parseCpuList("5"), Cpus({5}));
+    EXPECT_EQ(*parseCpuList(""), Cpus{});
+    EXPECT_FALSE(parseCpuList("3-1"));
+    EXPECT_FALSE(parseCpuList("0-x"));
+    EXPECT_FALSE(parseCpuList("0,,1"));
+  }
+
+  /**
+   * @given sysfs with 2 nodes with cores and memory only node
+   * @when nodes are detected
+   * @then nodes with cores are returned in order of id
+   */
+  TEST_F(NumaTest, Detect) {
+    node("node1", "4-7", 2);
+    node("node0", "0-3", 1);
+    node("node2", "", 3);
+    createDir("power");
+    auto nodes{detectNodes(getPathString())};
+    ASSERT_EQ(nodes.size(), 2);
+    EXPECT_EQ(nodes[0].id, 0);
+    EXPECT_EQ(nodes[0].cpus, Cpus({0, 1, 2, 3}));
+    EXPECT_EQ(nodes[0].memory, 1024);
+    EXPECT_EQ(nodes[1].id, 1);
+    EXPECT_EQ(nodes[1].memory, 2048);
+  }
+
+  /**
+   * @given sysfs with one node
+   * @when nodes are detected
+   * @then topology is not reported
+   */
+  TEST_F(NumaTest, SingleNode) {
+    node("node0", "0-3", 1);
+    EXPECT_TRUE(detectNodes(getPathString()).empty());
+    EXPECT_TRUE(detectNodes((base_path / "missing").string()).empty());
+  }
+
+  /**
+   * @given node assigned to thread
+   * @when assignment is destroyed
+   * @then previous assignment is restored
+   */
+  TEST(NumaAssignment, Scoped) {
+    EXPECT_FALSE(assignedNode());
+    {
+      ScopedAssignment assignment{NumaNode{1, {4}, 0}};
+      ASSERT_TRUE(assignedNode());
+      EXPECT_EQ(assignedNode()->id, 1);
+      {
+        ScopedAssignment inner{boost::none};
+        EXPECT_FALSE(assignedNode());
+      }
+      EXPECT_EQ(assignedNode()->id, 1);
+    }
+    EXPECT_FALSE(assignedNode());
+  }
+}  // namespace fc::sector_storage::numa
@@ -0,0 +1,66 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/impl/remote_worker_protocol.hpp"
+
+#include <gtest/gtest.h>
+
+#include "testutil/outcome.hpp"
+
+namespace fc::sector_storage::remote {
+  /**
+   * @given encoded values of different sizes
+   * @when they are split into frames
+   * @then frames have at most kChunkBytes and only last frame is marked
+   */
+  TEST(RemoteWorkerProtocol, SplitFrames) {
+    auto empty{splitFrames(Frame::kResult, {})};
+    ASSERT_EQ(empty.size(), 1);
+    EXPECT_TRUE(empty[0].last);
+    EXPECT_TRUE(empty[0].chunk.empty());
+
+    Buffer bytes(2 * kChunkBytes + 3, 7);
+    auto frames{splitFrames(Frame::kArguments, bytes)};
+    ASSERT_EQ(frames.size(), 3);
+    Buffer joined;
+    for (size_t i{0}; i < frames.size(); ++i) {
+      EXPECT_EQ(frames[i].kind, Frame::kArguments);
+      EXPECT_EQ(frames[i].last, i == frames.size() - 1);
+      EXPECT_LE(frames[i].chunk.size(), kChunkBytes);
+      joined.put(frames[i].chunk);
+    }
+    EXPECT_EQ(joined, bytes);
+  }
+
+  /**
+   * @given heartbeat of worker with NUMA nodes
+   * @when it is encoded and decoded
+   * @then resources, tasks and paths are preserved
+   */
+  TEST(RemoteWorkerProtocol, HeartbeatCbor) {
+    Heartbeat heartbeat;
+    heartbeat.info.hostname = "worker";
+    heartbeat.info.resources = {
+        .physical_memory = 100,
+        .swap_memory = 10,
+        .reserved_memory = 5,
+        .cpus = 8,
+        .gpus = {"gpu0"},
+        .numa_nodes = {{0, {0, 1, 2, 3}, 50}, {1, {4, 5, 6, 7}, 50}},
+    };
+    heartbeat.tasks = {primitives::kTTPreCommit1, primitives::kTTPreCommit2};
+    heartbeat.paths = {{"id", 10, "/sectors", true, false}};
+
+    EXPECT_OUTCOME_TRUE(bytes, codec::cbor::encode(heartbeat));
+    EXPECT_OUTCOME_TRUE(decoded, codec::cbor::decode<Heartbeat>(bytes));
+    EXPECT_EQ(decoded.info.hostname, "worker");
+    EXPECT_EQ(decoded.info.resources.gpus, heartbeat.info.resources.gpus);
+    ASSERT_EQ(decoded.info.resources.numa_nodes.size(), 2);
+    EXPECT_EQ(decoded.info.resources.numa_nodes[1].cpus,
+              heartbeat.info.resources.numa_nodes[1].cpus);
+    EXPECT_EQ(decoded.tasks, heartbeat.tasks);
+    EXPECT_EQ(decoded.paths, heartbeat.paths);
+  }
+}  // namespace fc::sector_storage::remote
@@ -0,0 +1,154 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/impl/remote_worker.hpp"
+
+#include <gtest/gtest.h>
+#include <mock/libp2p/connection/stream_mock.hpp>
+#include <mock/libp2p/host/host_mock.hpp>
+#include <thread>
+
+#include "testutil/mocks/sector_storage/scheduler_mock.hpp"
+#include "testutil/outcome.hpp"
+#include "testutil/peer_id.hpp"
+
+namespace fc::sector_storage::remote {
+  using libp2p::HostMock;
+  using libp2p::connection::Stream;
+  using libp2p::connection::StreamMock;
+  using libp2p::multi::Multiaddress;
+  using testing::_;
+
+  struct RemoteWorkerTest : testing::Test {
+    void SetUp() override {
+      thread = std::thread{[this] { io.run(); }};
+      ON_CALL(*stream, remotePeerId()).WillByDefault([this] { return peer; });
+      ON_CALL(*stream, remoteMultiaddr()).WillByDefault([] {
+        return Multiaddress::create("/ip4/127.0.0.1/tcp/40005").value();
+      });
+      // reads return input, then wait forever
+      ON_CALL(*stream, readSome(_, _, _))
+          .WillByDefault([this](auto out, auto, auto cb) {
+            if (input.empty()) {
+              pending.push_back(cb);
+              return;
+            }
+            auto n{std::min<size_t>(out.size(), input.size())};
+            std::copy_n(input.begin(), n, out.begin());
+            input.erase(input.begin(), input.begin() + n);
+            cb(n);
+          });
+      ON_CALL(*stream, write(_, _, _))
+          .WillByDefault([this](auto in, auto size, auto cb) {
+            output.put(in.first(size));
+            cb(size);
+          });
+    }
+
+    void TearDown() override {
+      work.reset();
+      thread.join();
+    }
+
+    template <typename T>
+    void feed(const T &value) {
+      input.put(codec::cbor::encode(value).value());
+    }
+
+    RemoteWorker worker(Clock::duration timeout) {
+      return RemoteWorker{host,
+                          PeerInfo{peer, {}},
+                          io,
+                          {},
+                          [timeout](auto) { return timeout; }};
+    }
+
+    boost::asio::io_context io;
+    boost::optional<boost::asio::io_context::work> work{io};
+    std::thread thread;
+    std::shared_ptr<HostMock> host{std::make_shared<HostMock>()};
+    std::shared_ptr<StreamMock> stream{std::make_shared<StreamMock>()};
+    PeerId peer{generatePeerId(1)};
+    Buffer input;
+    Buffer output;
+    std::vector<std::function<void(outcome::result<size_t>)>> pending;
+  };
+
+  /**
+   * @given heartbeat streams of allowed and unknown peers
+   * @when heartbeats are received
+   * @then only allowed worker is passed to scheduler
+   */
+  TEST_F(RemoteWorkerTest, Register) {
+    auto scheduler{std::make_shared<SchedulerMock>()};
+    std::function<void(std::shared_ptr<Stream>)> handler;
+    EXPECT_CALL(*host, setProtocolHandler(_, _))
+        .WillOnce([&](auto &, auto cb) { handler = cb; });
+    auto workers{std::make_shared<RemoteWorkers>(
+        host, scheduler, io, std::unordered_set<PeerId>{peer})};
+    workers->start();
+
+    Heartbeat heartbeat;
+    heartbeat.info.hostname = "worker";
+    feed(heartbeat);
+    WorkerInfo info;
+    EXPECT_CALL(*scheduler, doNewWorker(_)).WillOnce([&](auto handle) {
+      info = handle->info;
+    });
+    handler(stream);
+    EXPECT_EQ(info.hostname, "worker");
+
+    auto unknown{std::make_shared<StreamMock>()};
+    EXPECT_CALL(*unknown, remotePeerId()).WillOnce([] {
+      return generatePeerId(2);
+    });
+    EXPECT_CALL(*unknown, remoteMultiaddr()).WillOnce([] {
+      return Multiaddress::create("/ip4/127.0.0.1/tcp/40006").value();
+    });
+    EXPECT_CALL(*unknown, reset());
+    handler(unknown);
+  }
+
+  /**
+   * @given worker replying with result frame
+   * @when method is called
+   * @then method and arguments are sent, result is returned
+   */
+  TEST_F(RemoteWorkerTest, Call) {
+    EXPECT_CALL(*host, newStream(_, _, _))
+        .WillOnce([&](auto &, auto &, auto cb) { cb(stream); });
+    feed(Frame{Frame::kResult, {}, true});
+    auto remote{worker(std::chrono::seconds{10})};
+    SectorId sector{1, 2};
+    EXPECT_OUTCOME_TRUE_1(remote.remove(sector));
+
+    Buffer expected{codec::cbor::encode(WorkerMethod::kRemove).value()};
+    expected.put(codec::cbor::encode(
+                     Frame{Frame::kArguments,
+                           codec::cbor::encode(SectorParams{sector}).value(),
+                           true})
+                     .value());
+    EXPECT_EQ(output, expected);
+  }
+
+  /**
+   * @given worker which never replies
+   * @when method is called
+   * @then call fails after deadline and stream is reset
+   */
+  TEST_F(RemoteWorkerTest, Timeout) {
+    EXPECT_CALL(*host, newStream(_, _, _))
+        .WillOnce([&](auto &, auto &, auto cb) { cb(stream); });
+    EXPECT_CALL(*stream, reset()).WillOnce([&] {
+      for (auto &cb : pending) {
+        cb(std::errc::connection_reset);
+      }
+      pending.clear();
+    });
+    auto remote{worker(std::chrono::milliseconds{50})};
+    EXPECT_OUTCOME_ERROR(RemoteWorkerErrors::kTimeout,
+                         remote.remove(SectorId{1, 2}));
+  }
+}  // namespace fc::sector_storage::remote
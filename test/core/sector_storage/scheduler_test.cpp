@@ -9,6 +9,8 @@
 #include <gtest/gtest.h>
 #include <thread>
 #include "testutil/mocks/sector_storage/selector_mock.hpp"
+#include "testutil/mocks/sector_storage/stores/sector_index_mock.hpp"
+#include "testutil/mocks/sector_storage/worker_mock.hpp"
 #include "testutil/outcome.hpp"
 
 using fc::primitives::WorkerInfo;
@@ -177,3 +179,98 @@ TEST_F(SchedulerTest, DISABLED_RequestQueue) {
   ASSERT_FALSE(thread_error);
   EXPECT_EQ(counter, 4);
 }
+
+/**
+ * @given requests of different priority, task type and age
+ * @when order them
+ * @then higher priority goes first, then later sealing stage, and waiting
+ * request overtakes newer request of higher priority
+ */
+TEST(SchedulerOrderTest, PriorityAndAging) {
+  using fc::sector_storage::isScheduledBefore;
+  using fc::sector_storage::kPriorityAgingInterval;
+  using fc::sector_storage::TaskRequest;
+  SectorId sector{
+      .miner = 42,
+      .sector = 1,
+  };
+  auto make{[&](auto task_type, uint64_t priority) {
+    return TaskRequest{sector, task_type, priority, nullptr, {}, {}, {}};
+  }};
+  auto add_piece{make(fc::primitives::kTTAddPiece, 0)};
+  auto commit2{make(fc::primitives::kTTCommit2, 0)};
+  commit2.queued = add_piece.queued;
+  auto urgent{make(fc::primitives::kTTAddPiece, 1)};
+  auto now{add_piece.queued};
+
+  EXPECT_TRUE(isScheduledBefore(commit2, add_piece, now));
+  EXPECT_FALSE(isScheduledBefore(add_piece, commit2, now));
+  EXPECT_TRUE(isScheduledBefore(urgent, commit2, now));
+
+  now += 2 * kPriorityAgingInterval;
+  urgent.queued = now;
+  EXPECT_TRUE(isScheduledBefore(commit2, urgent, now));
+}
+
+/**
+ * @given two workers, selector prefers one without access to sector files
+ * @when task of sector is scheduled
+ * @then it runs on worker which can access storage with sector files
+ */
+TEST(SchedulerLocalTest, PrefersLocalWorker) {
+  using fc::primitives::StoragePath;
+  using fc::sector_storage::WorkerMock;
+  using fc::sector_storage::stores::SectorIndexMock;
+  using fc::sector_storage::stores::StorageInfo;
+  SectorId sector{
+      .miner = 42,
+      .sector = 1,
+  };
+  auto index{std::make_shared<SectorIndexMock>()};
+  SchedulerImpl scheduler{RegisteredProof::StackedDRG2KiBSeal, index};
+  auto add{[&](const std::string &name) {
+    auto worker{std::make_shared<WorkerMock>()};
+    StoragePath path;
+    path.id = name;
+    EXPECT_CALL(*worker, getAccessiblePaths())
+        .WillRepeatedly(
+            testing::Return(std::vector<StoragePath>{std::move(path)}));
+    auto handle{std::make_unique<WorkerHandle>()};
+    handle->worker = worker;
+    handle->info = WorkerInfo{
+        .hostname = name,
+        .resources = WorkerResources{.physical_memory = uint64_t(1) << 30,
+                                     .swap_memory = 0,
+                                     .reserved_memory = 0,
+                                     .cpus = 4,
+                                     .gpus = {}}};
+    scheduler.newWorker(std::move(handle));
+    return worker;
+  }};
+  auto remote{add("remote")};
+  auto local{add("local")};
+
+  StorageInfo storage;
+  storage.id = "local";
+  EXPECT_CALL(*index, storageFindSector(sector, _, false))
+      .WillOnce(testing::Return(std::vector<StorageInfo>{storage}));
+  auto selector{std::make_shared<SelectorMock>()};
+  EXPECT_CALL(*selector, is_satisfying(_, _, _))
+      .WillRepeatedly(testing::Return(fc::outcome::success(true)));
+  EXPECT_CALL(*selector, is_preferred(_, _, _))
+      .WillRepeatedly([](auto &, auto &lhs, auto &) {
+        return fc::outcome::success(lhs->info.hostname == "remote");
+      });
+
+  std::shared_ptr<Worker> used;
+  WorkerAction prepare = [](const std::shared_ptr<Worker> &) {
+    return fc::outcome::success();
+  };
+  WorkerAction work = [&](const std::shared_ptr<Worker> &worker) {
+    used = worker;
+    return fc::outcome::success();
+  };
+  EXPECT_OUTCOME_TRUE_1(scheduler.schedule(
+      sector, fc::primitives::kTTFinalize, selector, prepare, work, 0));
+  EXPECT_EQ(used, local);
+}
@@ -0,0 +1,131 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/sealing/sector_packer.hpp"
+
+#include <gtest/gtest.h>
+
+#include "testutil/mocks/sector_storage/manager_mock.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::outcome::result;
+using fc::primitives::SectorNumber;
+using fc::primitives::piece::PieceInfo;
+using fc::sector_storage::ManagerMock;
+using fc::sector_storage::PreCommit1Output;
+using fc::sector_storage::SealRandomness;
+using fc::sector_storage::SectorId;
+using fc::sector_storage::sealing::fillerPieces;
+using fc::sector_storage::sealing::packPieces;
+using fc::sector_storage::sealing::PaddedPieceSize;
+using fc::sector_storage::sealing::PendingPiece;
+using fc::sector_storage::sealing::SectorPacker;
+using testing::_;
+using testing::Return;
+
+const auto kNoSector{std::make_error_code(std::errc::no_space_on_device)};
+const auto kWriteError{std::make_error_code(std::errc::io_error)};
+
+PendingPiece piece(uint64_t padded_size) {
+  return {PaddedPieceSize{padded_size}.unpadded(), "", {}};
+}
+
+/**
+ * @given pieces in order smaller than sector
+ * @when pack them into sector
+ * @then pieces are taken while they fit and ordered from largest
+ */
+TEST(SectorPacker, PackPieces) {
+  std::vector<PendingPiece> pieces{
+      piece(256), piece(1024), piece(512), piece(1024), piece(256)};
+  std::vector<size_t> expected{1, 2, 0, 4};
+  EXPECT_EQ(packPieces(pieces, PaddedPieceSize{2048}), expected);
+}
+
+/**
+ * @given pieces filling part of sector
+ * @when compute fillers of rest of sector
+ * @then fillers are aligned powers of two from smallest
+ */
+TEST(SectorPacker, FillerPieces) {
+  std::vector<PaddedPieceSize> expected{
+      PaddedPieceSize{256}, PaddedPieceSize{512}, PaddedPieceSize{1024}};
+  EXPECT_EQ(fillerPieces(PaddedPieceSize{256}, PaddedPieceSize{2048}),
+            expected);
+  EXPECT_TRUE(
+      fillerPieces(PaddedPieceSize{2048}, PaddedPieceSize{2048}).empty());
+}
+
+struct SectorPackerTest : testing::Test {
+  void SetUp() override {
+    EXPECT_CALL(*manager, getSectorSize()).WillRepeatedly(Return(2048));
+  }
+
+  SectorPacker packer() {
+    return SectorPacker{
+        manager,
+        [this]() -> result<SectorId> {
+          if (!next_sector) {
+            return kNoSector;
+          }
+          return SectorId{1, ++sector};
+        },
+        [](auto &) { return SealRandomness{}; },
+        [this](auto &sector, auto &pieces, auto) {
+          packed.emplace_back(sector, pieces.size());
+        },
+        {}};
+  }
+
+  std::shared_ptr<ManagerMock> manager{std::make_shared<ManagerMock>()};
+  bool next_sector{true};
+  SectorNumber sector{0};
+  std::vector<std::pair<SectorId, size_t>> packed;
+};
+
+/**
+ * @given next sector can't be allocated
+ * @when full sector piece is added
+ * @then error is returned and piece stays pending until sector allocated
+ */
+TEST_F(SectorPackerTest, NextSectorFails) {
+  auto packer{this->packer()};
+  next_sector = false;
+  EXPECT_OUTCOME_ERROR(kNoSector, packer.addPiece(piece(2048)));
+  EXPECT_EQ(packer.pendingSize(), 2048);
+
+  next_sector = true;
+  EXPECT_CALL(*manager, addPiece(SectorId{1, 1}, _, _, _))
+      .WillOnce(Return(PieceInfo{}));
+  EXPECT_CALL(*manager, sealPreCommit1Async(SectorId{1, 1}, _, _, _, _))
+      .WillOnce([](auto, auto, auto, auto &cb, auto) {
+        cb(PreCommit1Output{});
+      });
+  EXPECT_OUTCOME_TRUE_1(packer.flush());
+  EXPECT_EQ(packer.pendingSize(), 0);
+  EXPECT_EQ(packed.size(), 1);
+}
+
+/**
+ * @given piece write failing
+ * @when full sector piece is added
+ * @then broken sector is removed and piece is packed into next sector
+ */
+TEST_F(SectorPackerTest, WriteFails) {
+  auto packer{this->packer()};
+  EXPECT_CALL(*manager, addPiece(SectorId{1, 1}, _, _, _))
+      .WillOnce(Return(kWriteError));
+  EXPECT_CALL(*manager, remove(SectorId{1, 1}))
+      .WillOnce(Return(fc::outcome::success()));
+  EXPECT_OUTCOME_ERROR(kWriteError, packer.addPiece(piece(2048)));
+  EXPECT_EQ(packer.pendingSize(), 2048);
+  EXPECT_TRUE(packed.empty());
+
+  EXPECT_CALL(*manager, addPiece(SectorId{1, 2}, _, _, _))
+      .WillOnce(Return(PieceInfo{}));
+  EXPECT_CALL(*manager, sealPreCommit1Async(SectorId{1, 2}, _, _, _, _));
+  EXPECT_OUTCOME_TRUE_1(packer.flush());
+  EXPECT_EQ(packer.pendingSize(), 0);
+}
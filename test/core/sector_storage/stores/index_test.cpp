@@ -12,6 +12,7 @@
 using fc::primitives::sector::RegisteredProof;
 using fc::primitives::sector_file::SectorFileType;
 using fc::sector_storage::stores::FsStat;
+using fc::sector_storage::stores::HealthReport;
 using fc::sector_storage::stores::IndexErrors;
 using fc::sector_storage::stores::SectorIndex;
 using fc::sector_storage::stores::SectorIndexImpl;
@@ -231,6 +232,59 @@ TEST_F(SectorIndexTest, BestAllocation) {
   ASSERT_EQ(candidates.at(1).id, id1);
 }
 
+/**
+ * @given 2 storages
+ * @when heartbeat reports changed available space
+ * @then order of candidates follows reported space
+ */
+TEST_F(SectorIndexTest, BestAllocationAfterHealthReport) {
+  StorageInfo storage_info1{
+      .id = "id1",
+      .urls = {},
+      .weight = 10,
+      .can_seal = false,
+      .can_store = true,
+  };
+  StorageInfo storage_info2{
+      .id = "id2",
+      .urls = {},
+      .weight = 10,
+      .can_seal = false,
+      .can_store = true,
+  };
+  FsStat small{
+      .capacity = 8 * 2048,
+      .available = 7 * 2048,
+      .used = 0,
+  };
+  FsStat big{
+      .capacity = 8 * 2048,
+      .available = 8 * 2048,
+      .used = 0,
+  };
+  EXPECT_OUTCOME_TRUE_1(sector_index_->storageAttach(storage_info1, small));
+  EXPECT_OUTCOME_TRUE_1(sector_index_->storageAttach(storage_info2, big));
+
+  EXPECT_OUTCOME_TRUE(
+      candidates1,
+      sector_index_->storageBestAlloc(
+          SectorFileType::FTCache, RegisteredProof::StackedDRG2KiBSeal, false));
+  ASSERT_EQ(candidates1.size(), 2);
+  EXPECT_EQ(candidates1.at(0).id, storage_info1.id);
+
+  EXPECT_OUTCOME_TRUE_1(sector_index_->storageReportHealth(
+      storage_info1.id, HealthReport{.stat = big, .error = {}}));
+  EXPECT_OUTCOME_TRUE_1(sector_index_->storageReportHealth(
+      storage_info2.id, HealthReport{.stat = small, .error = {}}));
+
+  EXPECT_OUTCOME_TRUE(
+      candidates2,
+      sector_index_->storageBestAlloc(
+          SectorFileType::FTCache, RegisteredProof::StackedDRG2KiBSeal, false));
+  ASSERT_EQ(candidates2.size(), 2);
+  EXPECT_EQ(candidates2.at(0).id, storage_info2.id);
+}
+
 /**
  * @given storage info and sector id
  * @when try to add sector to local storage
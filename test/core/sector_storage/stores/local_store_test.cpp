@@ -192,8 +192,8 @@ TEST_F(LocalStoreTest, AcquireSectorAllocateSuccess) {
   };
 
   FsStat stat{
-      .capacity = 100,
-      .available = 100,
+      .capacity = 1 << 20,
+      .available = 1 << 20,
       .used = 0,
   };
 
@@ -212,6 +212,9 @@ TEST_F(LocalStoreTest, AcquireSectorAllocateSuccess) {
   EXPECT_CALL(*index_, storageBestAlloc(file_type, seal_proof_type, false))
       .WillOnce(testing::Return(fc::outcome::success(res)));
 
+  EXPECT_CALL(*index_, storageReportHealth(storage_id, _))
+      .WillRepeatedly(testing::Return(fc::outcome::success()));
+
   EXPECT_OUTCOME_TRUE(
       sectors,
       local_store_->acquireSector(
@@ -226,6 +229,83 @@ TEST_F(LocalStoreTest, AcquireSectorAllocateSuccess) {
   EXPECT_OUTCOME_EQ(sectors.storages.getPathByType(file_type), storage_id);
 }
 
+/**
+ * @given storage with space for one cache of sector
+ * @when acquire caches of two sectors while first is not written yet
+ * @then second allocation fails, reserved space is reported to index and
+ * returned when reservation is released
+ */
+TEST_F(LocalStoreTest, AcquireSectorReservesSpace) {
+  RegisteredProof seal_proof_type = RegisteredProof::StackedDRG2KiBSeal;
+  SectorFileType file_type = SectorFileType::FTCache;
+  EXPECT_OUTCOME_TRUE(
+      space,
+      fc::primitives::sector_file::sealSpaceUse(file_type, seal_proof_type));
+
+  auto storage_path = boost::filesystem::unique_path(
+                          fs::canonical(base_path).append("%%%%%-storage"))
+                          .string();
+
+  StorageID storage_id = "storage_id";
+
+  fc::primitives::LocalStorageMeta storage_meta{
+      .id = storage_id,
+      .weight = 0,
+      .can_seal = true,
+      .can_store = true,
+  };
+
+  FsStat stat{
+      .capacity = 2 * space,
+      .available = space + space / 2,
+      .used = 0,
+  };
+
+  createStorage(storage_path, storage_meta, stat);
+
+  StorageInfo storage_info{
+      .id = storage_id,
+      .urls = urls_,
+      .weight = 0,
+      .can_seal = true,
+      .can_store = true,
+  };
+
+  EXPECT_CALL(*index_, storageBestAlloc(file_type, seal_proof_type, true))
+      .WillRepeatedly(testing::Return(
+          fc::outcome::success(std::vector{storage_info})));
+
+  std::vector<uint64_t> reported;
+  EXPECT_CALL(*index_, storageReportHealth(storage_id, _))
+      .WillRepeatedly(testing::Invoke([&](auto &, auto &report) {
+        reported.push_back(report.stat.available);
+        return fc::outcome::success();
+      }));
+
+  EXPECT_OUTCOME_TRUE(
+      first,
+      local_store_->acquireSector(
+          {42, 1}, seal_proof_type, SectorFileType::FTNone, file_type, true));
+  ASSERT_TRUE(first.reservation);
+  EXPECT_EQ(reported, std::vector{stat.available - space});
+
+  EXPECT_OUTCOME_ERROR(
+      StoreErrors::kNotFoundPath,
+      local_store_->acquireSector(
+          {42, 2}, seal_proof_type, SectorFileType::FTNone, file_type, true));
+
+  EXPECT_CALL(*storage_, getStat(storage_path))
+      .WillOnce(testing::Return(fc::outcome::success(stat)));
+  EXPECT_OUTCOME_TRUE(reserved_stat, local_store_->getFsStat(storage_id));
+  EXPECT_EQ(reserved_stat.available, stat.available - space);
+
+  first.reservation.reset();
+  EXPECT_EQ(reported.back(), stat.available);
+
+  EXPECT_OUTCOME_TRUE_1(local_store_->acquireSector(
+      {42, 2}, seal_proof_type, SectorFileType::FTNone, file_type, true));
+}
+
 /**
  * @given storage, sector, registered proof type
  * @when try to acquire sector for find existing sector
@@ -715,8 +795,8 @@ TEST_F(LocalStoreTest, moveStorageSuccess) {
   };
 
   FsStat stat2{
-      .capacity = 200,
-      .available = 200,
+      .capacity = 1 << 20,
+      .available = 1 << 20,
       .used = 0,
   };
 
@@ -756,6 +836,9 @@ TEST_F(LocalStoreTest, moveStorageSuccess) {
   EXPECT_CALL(*index_, storageBestAlloc(file_type, seal_proof_type, false))
       .WillOnce(testing::Return(fc::outcome::success(std::vector({info2}))));
 
+  EXPECT_CALL(*index_, storageReportHealth(storage_id2, _))
+      .WillRepeatedly(testing::Return(fc::outcome::success()));
+
   EXPECT_OUTCOME_TRUE_1(
       local_store_->moveStorage(sector, seal_proof_type, file_type));
 
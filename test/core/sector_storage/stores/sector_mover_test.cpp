@@ -0,0 +1,123 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/stores/sector_mover.hpp"
+
+#include <gtest/gtest.h>
+#include <boost/filesystem/fstream.hpp>
+#include "sector_storage/stores/store_error.hpp"
+#include "testutil/outcome.hpp"
+#include "testutil/storage/base_fs_test.hpp"
+
+using fc::sector_storage::stores::moveSectorFiles;
+using fc::sector_storage::stores::MoveOptions;
+using fc::sector_storage::stores::StoreErrors;
+
+class SectorMoverTest : public test::BaseFS_Test {
+ public:
+  SectorMoverTest() : test::BaseFS_Test("fc_sector_mover_test") {}
+
+  void SetUp() override {
+    BaseFS_Test::SetUp();
+    from_ = base_path / "from" / "s-t01-1";
+    to_ = base_path / "to" / "s-t01-1";
+    boost::filesystem::create_directories(from_ / "layers");
+    boost::filesystem::create_directories(to_.parent_path());
+    writeFile(from_ / "p_aux", "aux");
+    std::string layer;
+    for (auto i{0}; i < 100000; ++i) {
+      layer += std::to_string(i);
+    }
+    writeFile(from_ / "layers" / "layer-1", layer);
+    files_ = {{"p_aux", "aux"}, {"layers/layer-1", layer}};
+  }
+
+  static void writeFile(const boost::filesystem::path &path,
+                        const std::string &content) {
+    boost::filesystem::ofstream{path, std::ios::binary} << content;
+  }
+
+  static std::string readFile(const boost::filesystem::path &path) {
+    boost::filesystem::ifstream file{path, std::ios::binary};
+    return {std::istreambuf_iterator<char>{file}, {}};
+  }
+
+  /// Checks moved files and removed source
+  void expectMoved() const {
+    EXPECT_FALSE(boost::filesystem::exists(from_));
+    for (const auto &[name, content] : files_) {
+      EXPECT_EQ(readFile(to_ / name), content);
+    }
+  }
+
+  boost::filesystem::path from_;
+  boost::filesystem::path to_;
+  std::vector<std::pair<std::string, std::string>> files_;
+};
+
+/**
+ * @given cache dir and destination on same filesystem
+ * @when move it
+ * @then dir is renamed
+ */
+TEST_F(SectorMoverTest, Rename) {
+  EXPECT_OUTCOME_TRUE_1(moveSectorFiles(from_.string(), to_.string()));
+  expectMoved();
+}
+
+/**
+ * @given cache dir, copy in small chunks by several threads
+ * @when move it with rename disabled
+ * @then files are copied, progress reaches total size, source is removed
+ */
+TEST_F(SectorMoverTest, CopyChunks) {
+  // stale destination is replaced
+  boost::filesystem::create_directories(to_);
+  writeFile(to_ / "stale", "stale");
+
+  MoveOptions options;
+  options.rename = false;
+  options.reflink = false;
+  options.chunk_size = 4096;
+  options.threads = 3;
+  uint64_t copied{}, total{};
+  options.progress = [&](uint64_t progress_copied, uint64_t progress_total) {
+    EXPECT_GE(progress_copied, copied);
+    copied = progress_copied;
+    total = progress_total;
+  };
+  EXPECT_OUTCOME_TRUE_1(
+      moveSectorFiles(from_.string(), to_.string(), options));
+  expectMoved();
+  EXPECT_FALSE(boost::filesystem::exists(to_ / "stale"));
+  EXPECT_EQ(copied, total);
+  EXPECT_EQ(total, files_[0].second.size() + files_[1].second.size());
+}
+
+/**
+ * @given sealed file
+ * @when move it with copy, reflinks allowed
+ * @then file is cloned or copied
+ */
+TEST_F(SectorMoverTest, CopyFile) {
+  MoveOptions options;
+  options.rename = false;
+  auto from{from_ / "p_aux"};
+  auto to{to_.parent_path() / "s-t01-2"};
+  EXPECT_OUTCOME_TRUE_1(moveSectorFiles(from.string(), to.string(), options));
+  EXPECT_FALSE(boost::filesystem::exists(from));
+  EXPECT_EQ(readFile(to), "aux");
+}
+
+/**
+ * @given missing source
+ * @when move it
+ * @then error is returned
+ */
+TEST_F(SectorMoverTest, NotFound) {
+  EXPECT_OUTCOME_ERROR(StoreErrors::kNotFoundSector,
+                       moveSectorFiles((base_path / "missing").string(),
+                                       to_.string()));
+}
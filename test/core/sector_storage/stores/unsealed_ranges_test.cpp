@@ -0,0 +1,57 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sector_storage/stores/unsealed_ranges.hpp"
+
+#include <gtest/gtest.h>
+#include "testutil/outcome.hpp"
+#include "testutil/storage/base_fs_test.hpp"
+
+using fc::sector_storage::stores::addUnsealedRange;
+using fc::sector_storage::stores::isUnsealed;
+using fc::sector_storage::stores::readUnsealedRanges;
+using fc::sector_storage::stores::removeUnsealedRanges;
+
+class UnsealedRangesTest : public test::BaseFS_Test {
+ public:
+  UnsealedRangesTest() : test::BaseFS_Test("fc_unsealed_ranges_test") {
+    unsealed_path_ = (base_path / "s-t01-1").string();
+  }
+
+  std::string unsealed_path_;
+};
+
+/**
+ * @given unsealed file without ranges
+ * @when ranges are added
+ * @then pieces inside added ranges are unsealed, others are not
+ */
+TEST_F(UnsealedRangesTest, AddRanges) {
+  EXPECT_OUTCOME_EQ(isUnsealed(unsealed_path_, 0, 128), false);
+
+  EXPECT_OUTCOME_TRUE_1(addUnsealedRange(unsealed_path_, 0, 256));
+  EXPECT_OUTCOME_TRUE_1(addUnsealedRange(unsealed_path_, 512, 256));
+
+  EXPECT_OUTCOME_EQ(isUnsealed(unsealed_path_, 0, 256), true);
+  EXPECT_OUTCOME_EQ(isUnsealed(unsealed_path_, 128, 128), true);
+  EXPECT_OUTCOME_EQ(isUnsealed(unsealed_path_, 256, 256), false);
+  EXPECT_OUTCOME_EQ(isUnsealed(unsealed_path_, 0, 1024), false);
+
+  EXPECT_OUTCOME_TRUE_1(addUnsealedRange(unsealed_path_, 256, 256));
+  EXPECT_OUTCOME_EQ(isUnsealed(unsealed_path_, 0, 768), true);
+  EXPECT_OUTCOME_TRUE(ranges, readUnsealedRanges(unsealed_path_));
+  EXPECT_EQ(ranges.runs().size(), 1);
+}
+
+/**
+ * @given unsealed file with ranges
+ * @when ranges are removed
+ * @then nothing is unsealed
+ */
+TEST_F(UnsealedRangesTest, RemoveRanges) {
+  EXPECT_OUTCOME_TRUE_1(addUnsealedRange(unsealed_path_, 0, 256));
+  removeUnsealedRanges(unsealed_path_);
+  EXPECT_OUTCOME_EQ(isUnsealed(unsealed_path_, 0, 256), false);
+}
@@ -12,12 +12,23 @@
 using fc::codec::cbor::encode;
 using fc::common::which;
 using fc::storage::amt::Amt;
+using fc::storage::amt::AmtBuilder;
 using fc::storage::amt::AmtError;
 using fc::storage::amt::Node;
 using fc::storage::amt::Root;
 using fc::storage::amt::Value;
 using fc::storage::ipfs::InMemoryDatastore;
 
+/// Counts written blocks
+struct CountingDatastore : InMemoryDatastore {
+  fc::outcome::result<void> set(const fc::CID &key, Value value) override {
+    ++writes;
+    return InMemoryDatastore::set(key, std::move(value));
+  }
+
+  size_t writes{};
+};
+
 class AmtTest : public ::testing::Test {
  public:
   auto getRoot() {
@@ -106,6 +117,39 @@ TEST_F(AmtTest, Flush) {
   EXPECT_OUTCOME_EQ(amt.get(key), value);
 }
 
+/**
+ * @given amt loaded from flushed root
+ * @when nodes are read, one value is changed and amt is flushed
+ * @then only changed path is written, clean root is not written again
+ */
+TEST_F(AmtTest, FlushChangedOnly) {
+  auto counting{std::make_shared<CountingDatastore>()};
+  Amt expected{counting};
+  for (auto key = 0llu; key < 1000; ++key) {
+    EXPECT_OUTCOME_TRUE_1(expected.set(key, encode(key).value()));
+  }
+  EXPECT_OUTCOME_TRUE(root, expected.flush());
+
+  amt = {counting, root};
+  EXPECT_OUTCOME_TRUE_1(amt.visit([](auto, auto &) {
+    return fc::outcome::success();
+  }));
+  counting->writes = 0;
+  EXPECT_OUTCOME_EQ(amt.flush(), root);
+  EXPECT_EQ(counting->writes, 0);
+
+  EXPECT_OUTCOME_TRUE_1(amt.visit([](auto, auto &) {
+    return fc::outcome::success();
+  }));
+  EXPECT_OUTCOME_TRUE_1(amt.set(500, encode(0).value()));
+  EXPECT_OUTCOME_TRUE_1(expected.set(500, encode(0).value()));
+  EXPECT_OUTCOME_TRUE(expected_root, expected.flush());
+  counting->writes = 0;
+  EXPECT_OUTCOME_EQ(amt.flush(), expected_root);
+  // leaf, two intermediate nodes and root
+  EXPECT_EQ(counting->writes, 4);
+}
+
 class AmtVisitTest : public AmtTest {
  public:
   AmtVisitTest() : AmtTest{} {
@@ -153,3 +197,141 @@ TEST_F(AmtVisitTest, VisitError) {
                          return AmtError::kIndexTooBig;
                        }));
 }
+
+/**
+ * @given keys in ascending order
+ * @when build amt with builder and with sequential set
+ * @then roots are same
+ */
+TEST_F(AmtTest, BuilderSameRoot) {
+  for (auto keys : std::vector<std::vector<uint64_t>>{
+           {},
+           {0},
+           {3, 7},
+           {64},
+           {1, 8, 9, 63, 64, 511, 512, 4100},
+       }) {
+    AmtBuilder builder{store};
+    Amt amt2{store};
+    for (auto key : keys) {
+      auto value = encode(key).value();
+      EXPECT_OUTCOME_TRUE_1(builder.append(key, value));
+      EXPECT_OUTCOME_TRUE_1(amt2.set(key, value));
+    }
+    EXPECT_OUTCOME_TRUE(expected, amt2.flush());
+    EXPECT_OUTCOME_EQ(builder.flush(), expected);
+    amt2 = {store, expected};
+    EXPECT_OUTCOME_EQ(amt2.count(), keys.size());
+  }
+}
+
+/**
+ * @given builder with value
+ * @when append same or smaller key
+ * @then error
+ */
+TEST_F(AmtTest, BuilderNotAscending) {
+  AmtBuilder builder{store};
+  EXPECT_OUTCOME_TRUE_1(builder.append(5, "01"_unhex));
+  EXPECT_OUTCOME_ERROR(AmtError::kNotAscending, builder.append(5, "02"_unhex));
+  EXPECT_OUTCOME_ERROR(AmtError::kNotAscending, builder.append(2, "02"_unhex));
+}
+
+/**
+ * @given amt with values
+ * @when visit range and stop after first value
+ * @then only values in range are visited, iteration stops
+ */
+TEST_F(AmtVisitTest, VisitRange) {
+  EXPECT_OUTCOME_TRUE_1(amt.flush());
+
+  std::vector<uint64_t> keys;
+  auto visitor{[&](uint64_t key, const Value &) {
+    keys.push_back(key);
+    return fc::outcome::success(true);
+  }};
+  EXPECT_OUTCOME_TRUE_1(amt.visitRange(4, 100, visitor));
+  EXPECT_EQ(keys, std::vector<uint64_t>{64});
+
+  keys.clear();
+  EXPECT_OUTCOME_TRUE_1(amt.visitRange(0, 64, visitor));
+  EXPECT_EQ(keys, std::vector<uint64_t>{3});
+
+  keys.clear();
+  EXPECT_OUTCOME_TRUE_1(
+      amt.visitRange(0, 100, [&](uint64_t key, const Value &) {
+        keys.push_back(key);
+        return fc::outcome::success(false);
+      }));
+  EXPECT_EQ(keys, std::vector<uint64_t>{3});
+}
+
+/**
+ * @given amt with values
+ * @when visit indices with present and absent keys
+ * @then only present requested values are visited
+ */
+TEST_F(AmtVisitTest, VisitIndices) {
+  EXPECT_OUTCOME_TRUE_1(amt.flush());
+
+  std::vector<uint64_t> keys;
+  EXPECT_OUTCOME_TRUE_1(amt.visitIndices(
+      {2, 64, 65, 1000}, [&](uint64_t key, const Value &value) {
+        EXPECT_EQ(value, items[1].second);
+        keys.push_back(key);
+        return fc::outcome::success();
+      }));
+  EXPECT_EQ(keys, std::vector<uint64_t>{64});
+}
+
+/**
+ * @given two flushed amt roots with different heights
+ * @when diff roots
+ * @then added, modified and removed values are visited
+ */
+TEST_F(AmtVisitTest, Diff) {
+  EXPECT_OUTCOME_TRUE(root1, amt.flush());
+  EXPECT_OUTCOME_TRUE_1(amt.set(3, "08"_unhex));
+  EXPECT_OUTCOME_TRUE_1(amt.remove(64));
+  EXPECT_OUTCOME_TRUE_1(amt.set(1000, "09"_unhex));
+  EXPECT_OUTCOME_TRUE(root2, amt.flush());
+
+  std::map<uint64_t, std::pair<boost::optional<Value>, boost::optional<Value>>>
+      changes;
+  Amt::DiffVisitor visitor{[&](auto key, auto &before, auto &after) {
+    EXPECT_TRUE(changes.emplace(key, std::make_pair(before, after)).second);
+    return fc::outcome::success();
+  }};
+  EXPECT_OUTCOME_TRUE_1(Amt::diff(store, root1, root2, visitor));
+  EXPECT_EQ(changes.size(), 3);
+  EXPECT_EQ(*changes[3].first, Value{"06"_unhex});
+  EXPECT_EQ(*changes[3].second, Value{"08"_unhex});
+  EXPECT_EQ(*changes[64].first, Value{"07"_unhex});
+  EXPECT_FALSE(changes[64].second);
+  EXPECT_FALSE(changes[1000].first);
+  EXPECT_EQ(*changes[1000].second, Value{"09"_unhex});
+
+  changes.clear();
+  EXPECT_OUTCOME_TRUE_1(Amt::diff(store, root2, root1, visitor));
+  EXPECT_EQ(changes.size(), 3);
+  EXPECT_FALSE(changes[3].first == changes[3].second);
+  EXPECT_FALSE(changes[1000].second);
+}
+
+/**
+ * @given AMT flushed to one store, with nodes cached
+ * @when AMT with same root is read from other store with root only
+ * @then cached child nodes are not used and read fails
+ */
+TEST_F(AmtTest, CacheOtherStore) {
+  for (auto key = 0llu; key < 100; ++key) {
+    EXPECT_OUTCOME_TRUE_1(amt.set(key, "07"_unhex));
+  }
+  EXPECT_OUTCOME_TRUE(root, amt.flush());
+  EXPECT_OUTCOME_TRUE_1(Amt(store, root).get(99));
+
+  auto other{std::make_shared<InMemoryDatastore>()};
+  EXPECT_OUTCOME_TRUE(root_bytes, store->get(root));
+  EXPECT_OUTCOME_TRUE_1(other->set(root, root_bytes));
+  EXPECT_FALSE(Amt(other, root).get(99));
+}
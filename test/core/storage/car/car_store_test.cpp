@@ -0,0 +1,107 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/car/car_store.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::CID;
+using fc::storage::car::CarStore;
+using fc::storage::car::makeCar;
+using fc::storage::ipfs::IpfsDatastoreError;
+using fc::storage::ipfs::InMemoryDatastore;
+
+struct Sample {
+  std::vector<CID> list;
+  int i;
+};
+CBOR_TUPLE(Sample, list, i)
+
+struct CarStoreTest : public ::testing::Test {
+  void SetUp() override {
+    EXPECT_OUTCOME_TRUE(cid, ipld.setCbor(Sample{{}, 1}));
+    EXPECT_OUTCOME_TRUE(root, ipld.setCbor(Sample{{cid}, 2}));
+    child = cid;
+    this->root = root;
+    EXPECT_OUTCOME_TRUE(car, makeCar(ipld, {root}));
+    path = boost::filesystem::unique_path(
+               boost::filesystem::temp_directory_path()
+               / "car_store_%%%%-%%%%.car")
+               .string();
+    std::ofstream file{path, std::ios::binary};
+    file.write(reinterpret_cast<const char *>(car.data()), car.size());
+  }
+
+  void TearDown() override {
+    boost::filesystem::remove(path);
+    boost::filesystem::remove(CarStore::indexPath(path));
+  }
+
+  InMemoryDatastore ipld;
+  CID child, root;
+  std::string path;
+};
+
+/**
+ * @given car file without index
+ * @when open car store
+ * @then index is written, blocks are served from car
+ */
+TEST_F(CarStoreTest, OpenAndGet) {
+  EXPECT_OUTCOME_TRUE(store, CarStore::open(path));
+  EXPECT_TRUE(boost::filesystem::exists(CarStore::indexPath(path)));
+  EXPECT_THAT(store->roots(), testing::ElementsAre(root));
+  for (auto &cid : {root, child}) {
+    EXPECT_OUTCOME_TRUE(raw, ipld.get(cid));
+    EXPECT_OUTCOME_EQ(store->get(cid), raw);
+  }
+  EXPECT_OUTCOME_TRUE(sample, store->getCbor<Sample>(child));
+  EXPECT_EQ(sample.i, 1);
+  EXPECT_OUTCOME_ERROR(IpfsDatastoreError::kReadOnly,
+                       store->set(child, fc::common::Buffer{}));
+}
+
+/**
+ * @given car file with index
+ * @when reopen car store
+ * @then index is loaded and blocks are served
+ */
+TEST_F(CarStoreTest, ReopenWithIndex) {
+  EXPECT_OUTCOME_TRUE(entries, CarStore::writeIndex(path));
+  EXPECT_EQ(entries.size(), 2);
+  EXPECT_OUTCOME_TRUE(store, CarStore::open(path));
+  EXPECT_OUTCOME_EQ(store->contains(root), true);
+  EXPECT_OUTCOME_TRUE(raw, ipld.get(root));
+  EXPECT_OUTCOME_EQ(store->get(root), raw);
+}
+
+/**
+ * @given car store index
+ * @when car file is rewritten with other blocks
+ * @then stale index is rebuilt on open and new blocks are served
+ */
+TEST_F(CarStoreTest, RebuildStaleIndex) {
+  EXPECT_OUTCOME_TRUE_1(CarStore::writeIndex(path));
+  auto mtime{boost::filesystem::last_write_time(path)};
+  EXPECT_OUTCOME_TRUE(other, ipld.setCbor(Sample{{}, 3}));
+  EXPECT_OUTCOME_TRUE(car, makeCar(ipld, {other}));
+  {
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    file.write(reinterpret_cast<const char *>(car.data()), car.size());
+  }
+  boost::filesystem::last_write_time(path, mtime + 1);
+  EXPECT_OUTCOME_TRUE(store, CarStore::open(path));
+  EXPECT_THAT(store->roots(), testing::ElementsAre(other));
+  EXPECT_OUTCOME_EQ(store->contains(other), true);
+  EXPECT_OUTCOME_EQ(store->contains(root), false);
+  EXPECT_OUTCOME_TRUE(sample, store->getCbor<Sample>(other));
+  EXPECT_EQ(sample.i, 3);
+}
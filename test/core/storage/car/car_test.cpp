@@ -7,6 +7,8 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
 
 #include "storage/ipfs/impl/in_memory_datastore.hpp"
 #include "storage/unixfs/unixfs.hpp"
@@ -20,6 +22,10 @@ using fc::storage::car::CarError;
 using fc::storage::car::loadCar;
 using fc::storage::car::makeCar;
 using fc::storage::car::makeSelectiveCar;
+using fc::storage::car::writeCar;
+using fc::storage::car::writeHeader;
+using fc::storage::car::writeItem;
+using fc::storage::car::writeSelectiveCar;
 using fc::storage::ipfs::InMemoryDatastore;
 
 /**
@@ -104,3 +110,106 @@ TEST(SelectiveCar, MakeSelectiveCar) {
                                          << "expected" << std::endl
                                          << expected_car << std::endl;
 }
+
+/**
+ * @given correct car file stream
+ * @when loadCar from stream
+ * @then same roots as loaded from buffer
+ */
+TEST(CarTest, LoadStreamSuccess) {
+  InMemoryDatastore ipld;
+  std::ifstream input{resourcePath("genesis.car"), std::ios::binary};
+  EXPECT_OUTCOME_TRUE(roots, loadCar(ipld, input));
+  EXPECT_THAT(
+      roots,
+      testing::ElementsAre(
+          "0171a0e402202d4c00840d4227f198ec6c5343b8c70af7f008a7775d67393d10430ea2fa012f"_cid));
+}
+
+/**
+ * @given car item which bytes do not match cid
+ * @when loadCar from stream
+ * @then error
+ */
+TEST(CarTest, LoadStreamCidMismatch) {
+  InMemoryDatastore ipld;
+  EXPECT_OUTCOME_TRUE(cid, ipld.setCbor(Sample2{2}));
+  fc::common::Buffer car;
+  writeHeader(car, {cid});
+  writeItem(car, cid, fc::codec::cbor::encode(Sample2{3}).value());
+  std::stringstream input{std::string{car.begin(), car.end()}};
+  EXPECT_OUTCOME_ERROR(CarError::kCidMismatch, loadCar(ipld, input));
+}
+
+/**
+ * @given genesis car file stream
+ * @when loadCar from stream on pool
+ * @then same roots and blocks as loaded sequentially
+ */
+TEST(CarTest, LoadStreamParallel) {
+  boost::asio::thread_pool pool{2};
+  InMemoryDatastore ipld1, ipld2;
+  std::ifstream input1{resourcePath("genesis.car"), std::ios::binary};
+  EXPECT_OUTCOME_TRUE(roots1, loadCar(ipld1, input1));
+  std::ifstream input2{resourcePath("genesis.car"), std::ios::binary};
+  EXPECT_OUTCOME_TRUE(roots2, loadCar(ipld2, input2, pool));
+  EXPECT_EQ(roots1, roots2);
+  std::stringstream car1, car2;
+  EXPECT_OUTCOME_TRUE_1(writeCar(car1, ipld1, roots1));
+  EXPECT_OUTCOME_TRUE_1(writeCar(car2, ipld2, roots2));
+  EXPECT_EQ(car1.str(), car2.str());
+}
+
+/**
+ * @given car item which bytes do not match cid
+ * @when loadCar from stream on pool
+ * @then error
+ */
+TEST(CarTest, LoadStreamParallelCidMismatch) {
+  boost::asio::thread_pool pool{2};
+  InMemoryDatastore ipld;
+  EXPECT_OUTCOME_TRUE(cid, ipld.setCbor(Sample2{2}));
+  fc::common::Buffer car;
+  writeHeader(car, {cid});
+  writeItem(car, cid, fc::codec::cbor::encode(Sample2{3}).value());
+  std::stringstream input{std::string{car.begin(), car.end()}};
+  EXPECT_OUTCOME_ERROR(CarError::kCidMismatch, loadCar(ipld, input, pool));
+}
+
+/**
+ * @given dag in store
+ * @when write car to stream and load it from stream
+ * @then all blocks are loaded
+ */
+TEST(CarTest, StreamWriter) {
+  InMemoryDatastore ipld1;
+  EXPECT_OUTCOME_TRUE(cid2, ipld1.setCbor(Sample2{2}));
+  EXPECT_OUTCOME_TRUE(cid3, ipld1.setCbor(Sample2{3}));
+  EXPECT_OUTCOME_TRUE(root, ipld1.setCbor(Sample1{{cid2}, {{"a", cid3}}}));
+  std::stringstream stream;
+  EXPECT_OUTCOME_TRUE_1(writeCar(stream, ipld1, {root}));
+
+  InMemoryDatastore ipld2;
+  EXPECT_OUTCOME_TRUE(roots, loadCar(ipld2, stream));
+  EXPECT_THAT(roots, testing::ElementsAre(root));
+  for (auto &cid : {root, cid2, cid3}) {
+    EXPECT_OUTCOME_TRUE(raw, ipld1.get(cid));
+    EXPECT_OUTCOME_EQ(ipld2.get(cid), raw);
+  }
+}
+
+/**
+ * @given PAYLOAD_FILE dag
+ * @when write selective car to stream
+ * @then bytes are equal to CAR_FROM_PAYLOAD_FILE
+ */
+TEST(SelectiveCar, WriteSelectiveCar) {
+  InMemoryDatastore ipld;
+  auto input = readFile(PAYLOAD_FILE);
+  EXPECT_OUTCOME_TRUE(root_cid, fc::storage::unixfs::wrapFile(ipld, input));
+  std::stringstream stream;
+  EXPECT_OUTCOME_TRUE_1(writeSelectiveCar(stream, ipld, {{root_cid, {}}}));
+  auto expected_car = readFile(CAR_FROM_PAYLOAD_FILE);
+  EXPECT_EQ(stream.str(),
+            std::string(expected_car.begin(), expected_car.end()));
+}
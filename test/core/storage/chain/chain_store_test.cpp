@@ -0,0 +1,186 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/chain/impl/chain_store_impl.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/in_memory/in_memory_storage.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/literals.hpp"
+#include "testutil/mocks/blockchain/weight_calculator_mock.hpp"
+#include "testutil/outcome.hpp"
+
+namespace fc::storage::blockchain {
+  using ::fc::blockchain::weight::WeightCalculatorMock;
+  using primitives::BigInt;
+  using primitives::address::Address;
+  using primitives::ticket::Ticket;
+  using testing::_;
+  using testing::Invoke;
+
+  /**
+   * Chain: genesis(0) <- ts1(1) <- ts3(3), height 2 is null round.
+   * Fork: ts1(1) <- fork2(2) <- fork4(4)
+   */
+  class ChainStoreTest : public ::testing::Test {
+   public:
+    void SetUp() override {
+      ON_CALL(*weight_calculator, calculateWeight(_))
+          .WillByDefault(Invoke([](auto &tipset) -> outcome::result<BigInt> {
+            return BigInt{tipset.height};
+          }));
+      genesis = make(0, {});
+      ts1 = make(1, genesis.cids);
+      ts3 = make(3, ts1.cids);
+      fork2 = make(2, ts1.cids);
+      fork4 = make(4, fork2.cids);
+    }
+
+    Tipset make(uint64_t height,
+                std::vector<CID> parents,
+                uint64_t miner = 1) {
+      BlockHeader block{
+          Address::makeFromId(miner),
+          Ticket{"010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101"_blob96},
+          {},
+          {},
+          {},
+          std::move(parents),
+          BigInt(height),
+          height,
+          "010001020005"_cid,
+          "010001020006"_cid,
+          "010001020007"_cid,
+          boost::none,
+          8,
+          boost::none,
+          9,
+      };
+      EXPECT_OUTCOME_TRUE_1(ipld->setCbor(block));
+      EXPECT_OUTCOME_TRUE(tipset, Tipset::create({block}));
+      return tipset;
+    }
+
+    std::shared_ptr<ChainStoreImpl> makeStore(const Tipset &head) {
+      return std::make_shared<ChainStoreImpl>(
+          ipld, weight_calculator, genesis.blks[0], head, index);
+    }
+
+    IpldPtr ipld{std::make_shared<ipfs::InMemoryDatastore>()};
+    std::shared_ptr<WeightCalculatorMock> weight_calculator{
+        std::make_shared<testing::NiceMock<WeightCalculatorMock>>()};
+    std::shared_ptr<InMemoryStorage> index{
+        std::make_shared<InMemoryStorage>()};
+    Tipset genesis, ts1, ts3, fork2, fork4;
+  };
+
+  /**
+   * @given chain with null round
+   * @when get tipsets by height
+   * @then indexed tipsets are returned, null round resolves to next or
+   * previous tipset
+   */
+  TEST_F(ChainStoreTest, ByHeight) {
+    auto store{makeStore(ts3)};
+    EXPECT_OUTCOME_EQ(store->getTipsetByHeight(ts3, 0, false), genesis);
+    EXPECT_OUTCOME_EQ(store->getTipsetByHeight(ts3, 1, false), ts1);
+    EXPECT_OUTCOME_EQ(store->getTipsetByHeight(ts3, 2, false), ts3);
+    EXPECT_OUTCOME_EQ(store->getTipsetByHeight(ts3, 2, true), ts1);
+    EXPECT_OUTCOME_EQ(store->getTipsetByHeight(ts3, 3, false), ts3);
+    EXPECT_OUTCOME_ERROR(ChainStoreError::kNoHeight,
+                         store->getTipsetByHeight(ts3, 4, false));
+  }
+
+  /**
+   * @given fork from indexed chain
+   * @when get tipsets by height of fork
+   * @then fork tipsets are walked and indexed parents are returned
+   */
+  TEST_F(ChainStoreTest, Fork) {
+    auto store{makeStore(ts3)};
+    EXPECT_OUTCOME_EQ(store->getTipsetByHeight(fork4, 3, false), fork4);
+    EXPECT_OUTCOME_EQ(store->getTipsetByHeight(fork4, 3, true), fork2);
+    EXPECT_OUTCOME_EQ(store->getTipsetByHeight(fork4, 2, false), fork2);
+    EXPECT_OUTCOME_EQ(store->getTipsetByHeight(fork4, 1, false), ts1);
+  }
+
+  /**
+   * @given indexed chain
+   * @when heavier fork becomes head
+   * @then index follows fork, and persists for new store
+   */
+  TEST_F(ChainStoreTest, Reorg) {
+    auto store{makeStore(ts3)};
+    EXPECT_OUTCOME_TRUE_1(store->updateHeaviestTipset(fork4));
+    EXPECT_EQ(store->heaviestTipset(), fork4);
+    EXPECT_OUTCOME_EQ(store->getTipsetByHeight(fork4, 2, false), fork2);
+    EXPECT_OUTCOME_EQ(store->getTipsetByHeight(fork4, 3, true), fork2);
+
+    auto restarted{makeStore(fork4)};
+    EXPECT_OUTCOME_EQ(restarted->getTipsetByHeight(fork4, 3, false), fork4);
+    EXPECT_OUTCOME_EQ(restarted->getTipsetByHeight(fork4, 1, false), ts1);
+  }
+
+  /**
+   * @given store which took heavier head
+   * @when store restarts on manifest head
+   * @then manifest head and weight are used, weight is not computed
+   */
+  TEST_F(ChainStoreTest, RestartFromManifest) {
+    EXPECT_OUTCOME_TRUE(empty, ChainStoreImpl::loadManifest(*index));
+    EXPECT_FALSE(empty);
+    auto store{makeStore(ts3)};
+    EXPECT_OUTCOME_TRUE_1(store->updateHeaviestTipset(fork4));
+    EXPECT_OUTCOME_TRUE(manifest, ChainStoreImpl::loadManifest(*index));
+    ASSERT_TRUE(manifest);
+    EXPECT_EQ(manifest->head, fork4.cids);
+    EXPECT_EQ(manifest->weight, BigInt{4});
+
+    EXPECT_CALL(*weight_calculator, calculateWeight(_)).Times(0);
+    auto restarted{makeStore(fork4)};
+    EXPECT_EQ(restarted->getHeaviestWeight(), BigInt{4});
+    EXPECT_OUTCOME_EQ(restarted->getTipsetByHeight(fork4, 2, false), fork2);
+  }
+
+  /**
+   * @given head on chain
+   * @when heavier fork becomes head
+   * @then chain is reverted to common ancestor and fork is applied
+   */
+  TEST_F(ChainStoreTest, HeadChanges) {
+    auto store{makeStore(ts3)};
+    std::vector<std::pair<HeadChangeType, Tipset>> changes;
+    store->subscribeHeadChanges([&](auto &change) {
+      changes.emplace_back(change.type, change.value);
+    });
+    EXPECT_OUTCOME_TRUE_1(store->updateHeaviestTipset(fork4));
+    std::vector<std::pair<HeadChangeType, Tipset>> expected{
+        {HeadChangeType::REVERT, ts3},
+        {HeadChangeType::APPLY, fork2},
+        {HeadChangeType::APPLY, fork4},
+    };
+    EXPECT_EQ(changes, expected);
+  }
+
+  /**
+   * @given block with same parents as head block from other miner
+   * @when add both blocks
+   * @then sibling is found in header graph and head is tipset of both
+   */
+  TEST_F(ChainStoreTest, AddBlockSibling) {
+    ON_CALL(*weight_calculator, calculateWeight(_))
+        .WillByDefault(Invoke([](auto &tipset) -> outcome::result<BigInt> {
+          return BigInt{tipset.height * 10 + tipset.blks.size()};
+        }));
+    auto sibling{make(4, fork2.cids, 2)};
+    auto store{makeStore(ts3)};
+    EXPECT_OUTCOME_TRUE_1(store->addBlock(fork4.blks[0]));
+    EXPECT_EQ(store->heaviestTipset(), fork4);
+    EXPECT_OUTCOME_TRUE_1(store->addBlock(sibling.blks[0]));
+    EXPECT_EQ(store->heaviestTipset().blks.size(), 2);
+    EXPECT_EQ(store->heaviestTipset().getParents(), fork4.getParents());
+  }
+}  // namespace fc::storage::blockchain
@@ -0,0 +1,190 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/chain/msg_index.hpp"
+
+#include <gtest/gtest.h>
+
+#include "adt/array.hpp"
+#include "storage/in_memory/in_memory_storage.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/literals.hpp"
+#include "testutil/outcome.hpp"
+
+namespace fc::storage::blockchain {
+  using primitives::BigInt;
+  using primitives::block::BlockHeader;
+  using primitives::block::MsgMeta;
+  using primitives::ticket::Ticket;
+  using vm::VMExitCode;
+  using vm::message::UnsignedMessage;
+
+  /**
+   * Chain: genesis(0) <- ts1(1) <- ts2(2).
+   * ts1 includes message from alice to bob, ts2 has its receipt.
+   */
+  class MsgIndexTest : public ::testing::Test {
+   public:
+    void SetUp() override {
+      UnsignedMessage message{bob, alice, 0, 1, 1, 1000, 0, {}};
+      EXPECT_OUTCOME_TRUE(cid, ipld->setCbor(message));
+      message_cid = cid;
+      adt::Array<MessageReceipt> receipts;
+      ipld->load(receipts);
+      EXPECT_OUTCOME_TRUE_1(
+          receipts.append(MessageReceipt{VMExitCode::kOk, {}, 5}));
+      EXPECT_OUTCOME_TRUE(receipts_root, receipts.amt.flush());
+
+      genesis = make(0, {}, {}, "010001020006"_cid);
+      ts1 = make(1, genesis.cids, {message_cid}, "010001020006"_cid);
+      ts2 = make(2, ts1.cids, {}, receipts_root);
+    }
+
+    Tipset make(uint64_t height,
+                std::vector<CID> parents,
+                const std::vector<CID> &messages,
+                const CID &receipts) {
+      MsgMeta meta;
+      ipld->load(meta);
+      EXPECT_OUTCOME_TRUE_1(meta.bls_messages.assign(messages));
+      EXPECT_OUTCOME_TRUE(meta_cid, ipld->setCbor(meta));
+      BlockHeader block{
+          Address::makeFromId(1),
+          Ticket{"010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101"_blob96},
+          {},
+          {},
+          {},
+          std::move(parents),
+          BigInt(height),
+          height,
+          "010001020005"_cid,
+          receipts,
+          meta_cid,
+          boost::none,
+          8,
+          boost::none,
+          9,
+      };
+      EXPECT_OUTCOME_TRUE_1(ipld->setCbor(block));
+      EXPECT_OUTCOME_TRUE(tipset, Tipset::create({block}));
+      return tipset;
+    }
+
+    outcome::result<std::vector<CID>> cids(const Address &address,
+                                           MsgRole role,
+                                           ChainEpoch from,
+                                           ChainEpoch to) {
+      OUTCOME_TRY(entries, index.byAddress(address, role, from, to));
+      std::vector<CID> cids;
+      for (auto &entry : entries) {
+        cids.push_back(entry.cid);
+      }
+      return cids;
+    }
+
+    CID message(const Address &from, const Address &to, uint64_t nonce) {
+      UnsignedMessage message{to, from, nonce, 1, 1, 1000, 0, {}};
+      EXPECT_OUTCOME_TRUE(cid, ipld->setCbor(message));
+      return cid;
+    }
+
+    /// Messages from sender to recipient, walking chain from head
+    std::vector<CID> scan(const std::vector<Tipset> &chain,
+                          const Address &sender,
+                          const Address &recipient) {
+      std::vector<CID> cids;
+      for (auto it{chain.rbegin()}; it != chain.rend(); ++it) {
+        EXPECT_OUTCOME_TRUE_1(it->visitMessages(
+            ipld, [&](auto, auto, auto &cid) -> outcome::result<void> {
+              OUTCOME_TRY(message, ipld->getCbor<UnsignedMessage>(cid));
+              if (message.from == sender && message.to == recipient) {
+                cids.push_back(cid);
+              }
+              return outcome::success();
+            }));
+      }
+      return cids;
+    }
+
+    IpldPtr ipld{std::make_shared<ipfs::InMemoryDatastore>()};
+    std::shared_ptr<InMemoryStorage> store{
+        std::make_shared<InMemoryStorage>()};
+    MsgIndex index{ipld, store};
+    Address alice{Address::makeFromId(100)};
+    Address bob{Address::makeFromId(101)};
+    CID message_cid;
+    Tipset genesis, ts1, ts2;
+  };
+
+  /**
+   * @given tipset with receipts of parent messages
+   * @when apply tipset
+   * @then message receipt is found, message is listed for both addresses
+   */
+  TEST_F(MsgIndexTest, Apply) {
+    std::vector<CID> applied;
+    EXPECT_OUTCOME_TRUE_1(index.apply(ts1, {}));
+    EXPECT_OUTCOME_TRUE_1(
+        index.apply(ts2, [&](auto &cid, auto &) { applied.push_back(cid); }));
+    EXPECT_EQ(applied, std::vector<CID>{message_cid});
+    EXPECT_TRUE(index.applied(ts2));
+
+    EXPECT_OUTCOME_TRUE(entry, index.find(message_cid));
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(entry->tipset, ts2.cids);
+    EXPECT_EQ(entry->height, 1);
+    EXPECT_OUTCOME_TRUE(receipt, index.receipt(*entry));
+    EXPECT_EQ(receipt.gas_used, 5);
+
+    EXPECT_OUTCOME_EQ(cids(alice, MsgRole::kFrom, 0, 2),
+                      std::vector<CID>{message_cid});
+    EXPECT_OUTCOME_EQ(cids(bob, MsgRole::kTo, 1, 1),
+                      std::vector<CID>{message_cid});
+    EXPECT_OUTCOME_EQ(cids(alice, MsgRole::kTo, 0, 2), std::vector<CID>{});
+    EXPECT_OUTCOME_EQ(cids(bob, MsgRole::kTo, 2, 10), std::vector<CID>{});
+    EXPECT_OUTCOME_EQ(cids(Address::makeFromId(102), MsgRole::kFrom, 0, 10),
+                      std::vector<CID>{});
+  }
+
+  /**
+   * @given applied tipset
+   * @when revert tipset
+   * @then message is not indexed
+   */
+  TEST_F(MsgIndexTest, Revert) {
+    EXPECT_OUTCOME_TRUE_1(index.apply(ts2, {}));
+    EXPECT_OUTCOME_TRUE_1(index.revert(ts2));
+    EXPECT_FALSE(index.applied(ts2));
+    EXPECT_OUTCOME_TRUE(entry, index.find(message_cid));
+    EXPECT_FALSE(entry);
+    EXPECT_OUTCOME_EQ(cids(alice, MsgRole::kFrom, 0, 10), std::vector<CID>{});
+  }
+
+  /**
+   * @given chain with messages between two addresses in both directions
+   * @when list messages from index
+   * @then result matches scan of chain, roles and order included
+   */
+  TEST_F(MsgIndexTest, ListMatchesScan) {
+    auto a{message(alice, bob, 10)};
+    auto b{message(bob, alice, 10)};
+    auto c{message(alice, bob, 11)};
+    auto d{message(alice, bob, 12)};
+    auto t1{make(1, genesis.cids, {a, b, c}, "010001020006"_cid)};
+    auto t2{make(2, t1.cids, {d}, "010001020006"_cid)};
+    auto t3{make(3, t2.cids, {}, "010001020006"_cid)};
+    EXPECT_OUTCOME_TRUE_1(index.apply(t2, {}));
+    EXPECT_OUTCOME_TRUE_1(index.apply(t3, {}));
+
+    std::vector<Tipset> chain{t1, t2};
+    EXPECT_OUTCOME_TRUE(sent, index.list(alice, bob, 0, 2));
+    EXPECT_EQ(sent, scan(chain, alice, bob));
+    EXPECT_EQ(sent, (std::vector<CID>{d, a, c}));
+    EXPECT_OUTCOME_TRUE(received, index.list(bob, alice, 0, 2));
+    EXPECT_EQ(received, scan(chain, bob, alice));
+    EXPECT_EQ(received, std::vector<CID>{b});
+    EXPECT_OUTCOME_EQ(index.list(alice, bob, 2, 2), std::vector<CID>{d});
+  }
+}  // namespace fc::storage::blockchain
@@ -0,0 +1,74 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/config/storage_config.hpp"
+
+#include <gtest/gtest.h>
+
+#include "testutil/outcome.hpp"
+#include "testutil/storage/base_fs_test.hpp"
+
+using fc::common::Buffer;
+using fc::storage::config::Config;
+using fc::storage::config::StorageConfig;
+using fc::storage::config::Stores;
+
+class StorageConfigTest : public test::BaseFS_Test {
+ public:
+  StorageConfigTest() : test::BaseFS_Test("fc_storage_config_test") {}
+};
+
+/**
+ * @given config with some storage options
+ * @when load storage config
+ * @then options are overridden, other options keep defaults
+ */
+TEST_F(StorageConfigTest, Load) {
+  Config config;
+  EXPECT_OUTCOME_TRUE_1(config.set("storage.blocks.bloom_bits_per_key", 0));
+  EXPECT_OUTCOME_TRUE_1(config.set("storage.market.compression", false));
+  auto storage = StorageConfig::load(config);
+  EXPECT_EQ(storage.blocks.bloom_bits_per_key, 0);
+  EXPECT_EQ(storage.blocks.block_cache_size,
+            StorageConfig{}.blocks.block_cache_size);
+  EXPECT_FALSE(storage.market.compression);
+  EXPECT_TRUE(storage.indexes.compression);
+}
+
+/**
+ * @given config selecting mmap blocks backend
+ * @when load storage config
+ * @then backend and its options are loaded
+ */
+TEST_F(StorageConfigTest, LoadBackend) {
+  Config config;
+  EXPECT_EQ(StorageConfig::load(config).blocks_backend,
+            StorageConfig::kLevelDBBackend);
+  EXPECT_OUTCOME_TRUE_1(
+      config.set("storage.blocks.backend", StorageConfig::kMmapBackend));
+  EXPECT_OUTCOME_TRUE_1(config.set("storage.blocks_mmap.sync", false));
+  auto storage = StorageConfig::load(config);
+  EXPECT_EQ(storage.blocks_backend, StorageConfig::kMmapBackend);
+  EXPECT_FALSE(storage.blocks_mmap.sync);
+  EXPECT_EQ(storage.blocks_mmap.map_size, StorageConfig{}.blocks_mmap.map_size);
+}
+
+/**
+ * @given storage config
+ * @when open stores and write to one
+ * @then stores are separate and report stats
+ */
+TEST_F(StorageConfigTest, OpenStores) {
+  leveldb::Options options;
+  options.create_if_missing = true;
+  EXPECT_OUTCOME_TRUE(
+      stores, Stores::open(getPathString(), StorageConfig{}, options));
+  Buffer key{1, 2, 3};
+  EXPECT_OUTCOME_TRUE_1(stores.market->put(key, Buffer{4}));
+  EXPECT_TRUE(stores.market->contains(key));
+  EXPECT_FALSE(stores.indexes->contains(key));
+  EXPECT_EQ(stores.blocks, nullptr);
+  EXPECT_EQ(stores.stats().size(), 2);
+}
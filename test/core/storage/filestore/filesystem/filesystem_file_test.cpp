@@ -270,3 +270,58 @@ TEST_F(FileSystemFileTest, ReadFileFrom) {
   ASSERT_EQ(read_size, read_res);
   ASSERT_TRUE(memcmp(expected, data_read.data(), read_size) == 0);
 }
+
+/**
+ * @given open file
+ * @when write several buffers at once and read them into several buffers
+ * @then data is written one after another and read back in order
+ */
+TEST_F(FileSystemFileTest, VectoredIo) {
+  EXPECT_OUTCOME_TRUE_1(empty_file->open());
+
+  std::vector<uint8_t> hello{'H', 'e', 'l', 'l', 'o', ' '};
+  std::vector<uint8_t> world{'w', 'o', 'r', 'l', 'd'};
+  std::vector<gsl::span<const uint8_t>> writes{hello, world};
+  EXPECT_OUTCOME_EQ(empty_file->writev(2, writes), 11);
+
+  std::vector<uint8_t> first(4), second(16);
+  std::vector<gsl::span<uint8_t>> reads{first, second};
+  EXPECT_OUTCOME_EQ(empty_file->readv(2, reads), 11);
+  EXPECT_EQ(first, (std::vector<uint8_t>{'H', 'e', 'l', 'l'}));
+  EXPECT_EQ(memcmp(second.data(), "o world", 7), 0);
+}
+
+/**
+ * @given open file with data
+ * @when file is mapped, written past mapped size and read
+ * @then read combines mapping and file
+ */
+TEST_F(FileSystemFileTest, MappedRead) {
+  EXPECT_OUTCOME_TRUE_1(empty_file->open());
+
+  std::vector<uint8_t> hello{'H', 'e', 'l', 'l', 'o'};
+  EXPECT_OUTCOME_TRUE_1(empty_file->write(0, hello));
+  EXPECT_OUTCOME_TRUE_1(empty_file->map());
+  std::vector<uint8_t> world{' ', 'C', '+', '+'};
+  EXPECT_OUTCOME_TRUE_1(empty_file->write(hello.size(), world));
+
+  std::vector<uint8_t> data(32);
+  EXPECT_OUTCOME_EQ(empty_file->read(1, data), 8);
+  EXPECT_EQ(memcmp(data.data(), "ello C++", 8), 0);
+  EXPECT_OUTCOME_TRUE_1(empty_file->close());
+}
+
+/**
+ * @given open empty file
+ * @when allocate space for it
+ * @then file has allocated size and reads as zeroes
+ */
+TEST_F(FileSystemFileTest, Allocate) {
+  EXPECT_OUTCOME_TRUE_1(empty_file->open());
+
+  EXPECT_OUTCOME_TRUE_1(empty_file->allocate(100));
+  EXPECT_OUTCOME_EQ(empty_file->size(), 100);
+  std::vector<uint8_t> data(100, 1);
+  EXPECT_OUTCOME_EQ(empty_file->read(0, data), 100);
+  ASSERT_THAT(data, testing::Each(0));
+}
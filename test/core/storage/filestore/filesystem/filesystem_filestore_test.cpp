@@ -92,6 +92,25 @@ TEST_F(FileSystemFileStoreTest, OpenFile) {
   ASSERT_EQ(filename, file->path());
 }
 
+/**
+ * @given large file
+ * @when open file by path is called
+ * @then open file reads its content
+ */
+TEST_F(FileSystemFileStoreTest, OpenLargeFile) {
+  auto filename = fs::canonical(createFile("large_file.bin")).string();
+  std::vector<uint8_t> data(FileSystemFileStore::kMapMinSize, 'x');
+  data.back() = 'y';
+  {
+    EXPECT_OUTCOME_TRUE(file, fs->open(filename));
+    EXPECT_OUTCOME_EQ(file->write(0, data), data.size());
+  }
+  EXPECT_OUTCOME_TRUE(file, fs->open(filename));
+  std::vector<uint8_t> read(2);
+  EXPECT_OUTCOME_EQ(file->read(data.size() - 2, read), 2);
+  EXPECT_EQ(read, (std::vector<uint8_t>{'x', 'y'}));
+}
+
 /**
  * @given path to file that doesn't exist
  * @when create file by path is called
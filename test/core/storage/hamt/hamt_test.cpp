@@ -6,6 +6,8 @@
 #include "storage/hamt/hamt.hpp"
 
 #include <gtest/gtest.h>
+#include <boost/asio/thread_pool.hpp>
+#include <mutex>
 #include "codec/cbor/cbor.hpp"
 #include "common/which.hpp"
 #include "storage/ipfs/impl/in_memory_datastore.hpp"
@@ -17,14 +19,24 @@ using fc::storage::hamt::Hamt;
 using fc::storage::hamt::HamtError;
 using fc::storage::hamt::Node;
 
+/// Counts written blocks
+struct CountingDatastore : fc::storage::ipfs::InMemoryDatastore {
+  fc::outcome::result<void> set(const fc::CID &key, Value value) override {
+    ++writes;
+    return InMemoryDatastore::set(key, std::move(value));
+  }
+
+  size_t writes{};
+};
+
 class HamtTest : public ::testing::Test {
  public:
   auto bit(size_t i) {
-    return root_->items.find(i) != root_->items.end();
+    return root_->has(i);
   }
 
   decltype(auto) minItem(const Node &node) {
-    return node.items.begin()->second;
+    return node.items.front();
   }
 
   template <typename T>
@@ -43,21 +55,36 @@ TEST_F(HamtTest, NodeCbor) {
   Node n;
   expectEncodeAndReencode(n, "824080"_unhex);
 
-  n.items[17] = "010000020000"_cid;
+  n.set(17, "010000020000"_cid);
   expectEncodeAndReencode(n, "824302000081a16130d82a4700010000020000"_unhex);
 
-  n.items[17] =
-      Node::Leaf{{"a", fc::storage::hamt::Value(encode("b").value())}};
+  n.set(17, Node::Leaf{{"a", fc::storage::hamt::Value(encode("b").value())}});
   expectEncodeAndReencode(n, "824302000081a16131818241616162"_unhex);
 
-  n.items[2] = Node::Leaf{{"b", fc::storage::hamt::Value(encode("a").value())}};
+  n.set(2, Node::Leaf{{"b", fc::storage::hamt::Value(encode("a").value())}});
   expectEncodeAndReencode(
       n, "824302000482a16131818241626161a16131818241616162"_unhex);
 
-  n.items[17] = Node::Ptr{};
+  n.set(17, Node::Ptr{});
   EXPECT_OUTCOME_ERROR(HamtError::kExpectedCID, encode(n));
 }
 
+/** Bitfield above 64 bits of bit width 8, items count must match bitfield */
+TEST_F(HamtTest, NodeCborWide) {
+  Node n;
+  n.set(200, "010000020000"_cid);
+  n.set(3, Node::Leaf{{"a", fc::storage::hamt::Value(encode("b").value())}});
+  EXPECT_EQ(n.position(200), 1);
+  EXPECT_EQ(n.next(4), 200);
+  expectEncodeAndReencode(
+      n,
+      "82581a010000000000000000000000000000000000000000000000000882a161318182"
+      "41616162a16130d82a4700010000020000"_unhex);
+
+  EXPECT_OUTCOME_ERROR(fc::codec::cbor::CborDecodeError::kWrongSize,
+                       fc::codec::cbor::decode<Node>("82410380"_unhex));
+}
+
 /** Set-remove single element */
 TEST_F(HamtTest, SetRemoveOne) {
   EXPECT_OUTCOME_ERROR(HamtError::kNotFound, hamt_.get("aai"));
@@ -301,3 +328,277 @@ TEST_F(HamtTest, Contains) {
   EXPECT_OUTCOME_TRUE_1(hamt_.set("element", "01"_unhex));
   EXPECT_OUTCOME_EQ(hamt_.contains("element"), true);
 }
+
+/**
+ * @given HAMT and hashed key
+ * @when set, get and remove by hashed key
+ * @then results are same as for plain key
+ */
+TEST_F(HamtTest, HashedKey) {
+  auto key = hamt_.hashKey("aai");
+  EXPECT_OUTCOME_EQ(hamt_.contains(key), false);
+  EXPECT_OUTCOME_TRUE_1(hamt_.set(key, "01"_unhex));
+  EXPECT_OUTCOME_EQ(hamt_.get("aai"), "01"_unhex);
+  EXPECT_OUTCOME_EQ(hamt_.get(key), "01"_unhex);
+  EXPECT_OUTCOME_TRUE_1(hamt_.remove(key));
+  EXPECT_OUTCOME_EQ(hamt_.contains("aai"), false);
+}
+
+/**
+ * @given HAMT
+ * @when update absent, present and removed key
+ * @then value is inserted, modified and removed
+ */
+TEST_F(HamtTest, Update) {
+  using fc::storage::hamt::Value;
+  EXPECT_OUTCOME_TRUE_1(hamt_.update("aai", [](auto &value) {
+    EXPECT_FALSE(value);
+    value = Value{"01"_unhex};
+    return fc::outcome::success();
+  }));
+  EXPECT_OUTCOME_EQ(hamt_.get("aai"), "01"_unhex);
+  EXPECT_OUTCOME_TRUE_1(hamt_.update("aai", [](auto &value) {
+    EXPECT_TRUE(value);
+    EXPECT_EQ(*value, Value{"01"_unhex});
+    value = Value{"02"_unhex};
+    return fc::outcome::success();
+  }));
+  EXPECT_OUTCOME_EQ(hamt_.get("aai"), "02"_unhex);
+  EXPECT_OUTCOME_TRUE_1(hamt_.update("aai", [](auto &value) {
+    value = boost::none;
+    return fc::outcome::success();
+  }));
+  EXPECT_OUTCOME_EQ(hamt_.contains("aai"), false);
+}
+
+/**
+ * @given HAMT and batch of keys sharing shards
+ * @when update batch, then remove most of it
+ * @then roots are same as of HAMT updated key by key
+ */
+TEST_F(HamtTest, UpdateMany) {
+  using fc::storage::hamt::Value;
+  Hamt expected{store_, 8};
+  std::vector<Hamt::HashedKey> keys;
+  for (auto i = 0; i < 100; ++i) {
+    auto key = "key" + std::to_string(i);
+    EXPECT_OUTCOME_TRUE_1(expected.set(key, encode(i).value()));
+    keys.push_back(hamt_.hashKey(key));
+  }
+  EXPECT_OUTCOME_TRUE_1(hamt_.updateMany(keys, [](auto i, auto &value) {
+    EXPECT_FALSE(value);
+    value = Value{encode(i).value()};
+    return fc::outcome::success();
+  }));
+  EXPECT_OUTCOME_EQ(hamt_.flush(), expected.flush().value());
+
+  for (auto i = 1; i < 100; ++i) {
+    EXPECT_OUTCOME_TRUE_1(expected.remove(keys[i].key));
+  }
+  EXPECT_OUTCOME_TRUE_1(hamt_.updateMany(keys, [](auto i, auto &value) {
+    EXPECT_TRUE(value);
+    if (i != 0) {
+      value = boost::none;
+    }
+    return fc::outcome::success();
+  }));
+  EXPECT_OUTCOME_EQ(hamt_.flush(), expected.flush().value());
+}
+
+/**
+ * @given hamt loaded from flushed root
+ * @when values are read, one value is changed and hamt is flushed
+ * @then only changed path is written, clean root is not written again
+ */
+TEST_F(HamtTest, FlushChangedOnly) {
+  auto counting{std::make_shared<CountingDatastore>()};
+  Hamt expected{counting, 5};
+  for (auto i = 0; i < 1000; ++i) {
+    EXPECT_OUTCOME_TRUE_1(
+        expected.set("key" + std::to_string(i), encode(i).value()));
+  }
+  EXPECT_OUTCOME_TRUE(root, expected.flush());
+
+  Hamt hamt{counting, root, 5};
+  auto visit{[&] {
+    EXPECT_OUTCOME_TRUE_1(
+        hamt.visit([](auto &, auto &) { return fc::outcome::success(); }));
+  }};
+  visit();
+  counting->writes = 0;
+  EXPECT_OUTCOME_EQ(hamt.flush(), root);
+  EXPECT_EQ(counting->writes, 0);
+
+  visit();
+  EXPECT_OUTCOME_TRUE_1(hamt.set("key500", encode(0).value()));
+  EXPECT_OUTCOME_TRUE_1(expected.set("key500", encode(0).value()));
+  EXPECT_OUTCOME_TRUE(expected_root, expected.flush());
+  counting->writes = 0;
+  EXPECT_OUTCOME_EQ(hamt.flush(), expected_root);
+  // root and shards on path to key
+  EXPECT_GE(counting->writes, 1);
+  EXPECT_LE(counting->writes, 3);
+}
+
+/**
+ * @given hamt loaded from flushed root with shards
+ * @when present value is updated, hamt is flushed and loaded again
+ * @then reloaded hamt has updated value, same root as set would give
+ */
+TEST_F(HamtTest, UpdateFlushed) {
+  using fc::storage::hamt::Value;
+  Hamt expected{store_, 5};
+  for (auto i = 0; i < 100; ++i) {
+    EXPECT_OUTCOME_TRUE_1(
+        expected.set("key" + std::to_string(i), encode(i).value()));
+  }
+  EXPECT_OUTCOME_TRUE(root, expected.flush());
+
+  Hamt hamt{store_, root, 5};
+  EXPECT_OUTCOME_TRUE_1(hamt.update("key50", [](auto &value) {
+    EXPECT_TRUE(value);
+    value = Value{encode(-1).value()};
+    return fc::outcome::success();
+  }));
+  EXPECT_OUTCOME_TRUE(updated_root, hamt.flush());
+  EXPECT_NE(updated_root, root);
+  EXPECT_OUTCOME_TRUE_1(expected.set("key50", encode(-1).value()));
+  EXPECT_OUTCOME_EQ(expected.flush(), updated_root);
+
+  Hamt reloaded{store_, updated_root, 5};
+  EXPECT_OUTCOME_EQ(reloaded.get("key50"), encode(-1).value());
+  EXPECT_OUTCOME_EQ(reloaded.get("key49"), encode(49).value());
+}
+
+/**
+ * @given flushed hamt with sharded root
+ * @when visit it in parallel, ordered and unordered
+ * @then ordered visit equals serial one, unordered visits same pairs
+ */
+TEST_F(HamtTest, VisitParallel) {
+  using Pairs = std::vector<std::pair<std::string, fc::storage::hamt::Value>>;
+  Hamt hamt{store_, 5};
+  for (auto i = 0; i < 1000; ++i) {
+    EXPECT_OUTCOME_TRUE_1(
+        hamt.set("key" + std::to_string(i), encode(i).value()));
+  }
+  EXPECT_OUTCOME_TRUE(root, hamt.flush());
+  Pairs expected;
+  EXPECT_OUTCOME_TRUE_1(hamt.visit([&](auto &key, auto &value) {
+    expected.emplace_back(key, value);
+    return fc::outcome::success();
+  }));
+
+  boost::asio::thread_pool pool{4};
+  Pairs ordered;
+  Hamt hamt1{store_, root, 5};
+  EXPECT_OUTCOME_TRUE_1(hamt1.visitParallel(
+      [&](auto &key, auto &value) {
+        ordered.emplace_back(key, value);
+        return fc::outcome::success();
+      },
+      pool,
+      true));
+  EXPECT_EQ(ordered, expected);
+
+  std::mutex mutex;
+  Pairs unordered;
+  Hamt hamt2{store_, root, 5};
+  EXPECT_OUTCOME_TRUE_1(hamt2.visitParallel(
+      [&](auto &key, auto &value) {
+        std::lock_guard lock{mutex};
+        unordered.emplace_back(key, value);
+        return fc::outcome::success();
+      },
+      pool,
+      false));
+  auto by_key{[](auto &l, auto &r) { return l.first < r.first; }};
+  std::sort(unordered.begin(), unordered.end(), by_key);
+  std::sort(expected.begin(), expected.end(), by_key);
+  EXPECT_EQ(unordered, expected);
+}
+
+/**
+ * @given two flushed HAMT roots
+ * @when diff roots
+ * @then added, modified and removed values are visited
+ */
+TEST_F(HamtTest, Diff) {
+  using fc::storage::hamt::Value;
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("aai", "01"_unhex));
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("ade", "02"_unhex));
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("agd", "03"_unhex));
+  EXPECT_OUTCOME_TRUE(root1, hamt_.flush());
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("ade", "04"_unhex));
+  EXPECT_OUTCOME_TRUE_1(hamt_.remove("agd"));
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("agm", "05"_unhex));
+  EXPECT_OUTCOME_TRUE(root2, hamt_.flush());
+
+  std::map<std::string,
+           std::pair<boost::optional<Value>, boost::optional<Value>>>
+      changes;
+  Hamt::DiffVisitor visitor{[&](auto &key, auto &before, auto &after) {
+    EXPECT_TRUE(changes.emplace(key, std::make_pair(before, after)).second);
+    return fc::outcome::success();
+  }};
+  EXPECT_OUTCOME_TRUE_1(Hamt::diff(store_, root1, root2, visitor));
+  EXPECT_EQ(changes.size(), 3);
+  EXPECT_EQ(*changes["ade"].first, Value{"02"_unhex});
+  EXPECT_EQ(*changes["ade"].second, Value{"04"_unhex});
+  EXPECT_EQ(*changes["agd"].first, Value{"03"_unhex});
+  EXPECT_FALSE(changes["agd"].second);
+  EXPECT_FALSE(changes["agm"].first);
+  EXPECT_EQ(*changes["agm"].second, Value{"05"_unhex});
+
+  changes.clear();
+  EXPECT_OUTCOME_TRUE_1(Hamt::diff(store_, root2, root2, visitor));
+  EXPECT_TRUE(changes.empty());
+}
+
+/**
+ * @given flushed HAMT with collision children
+ * @when visit pages of 3 pairs, resuming after last visited key
+ * @then pages cover all pairs in visit order
+ */
+TEST_F(HamtTest, VisitAfter) {
+  for (auto i = 0; i < 50; ++i) {
+    EXPECT_OUTCOME_TRUE_1(hamt_.set(std::to_string(i), "01"_unhex));
+  }
+  EXPECT_OUTCOME_TRUE(root, hamt_.flush());
+  std::vector<std::string> all;
+  EXPECT_OUTCOME_TRUE_1(hamt_.visit([&](auto &key, auto &) {
+    all.push_back(key);
+    return fc::outcome::success();
+  }));
+
+  Hamt hamt{store_, root, 8};
+  std::vector<std::string> paged;
+  boost::optional<std::string> after;
+  while (true) {
+    auto n = 0;
+    EXPECT_OUTCOME_TRUE_1(hamt.visitAfter(after, [&](auto &key, auto &) {
+      paged.push_back(key);
+      return fc::outcome::success(++n < 3);
+    }));
+    if (n == 0) {
+      break;
+    }
+    after = paged.back();
+  }
+  EXPECT_EQ(paged, all);
+}
+
+/**
+ * @given HAMT flushed to one store, with nodes cached
+ * @when HAMT with same root is read from other store without its nodes
+ * @then cached nodes are not used and read fails
+ */
+TEST_F(HamtTest, CacheOtherStore) {
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("1", "01"_unhex));
+  EXPECT_OUTCOME_TRUE(root, hamt_.flush());
+  EXPECT_OUTCOME_TRUE_1(Hamt(store_, root, 8).get("1"));
+
+  auto other_store{std::make_shared<fc::storage::ipfs::InMemoryDatastore>()};
+  Hamt other{other_store, root, 8};
+  EXPECT_FALSE(other.get("1"));
+}
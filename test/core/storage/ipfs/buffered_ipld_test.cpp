@@ -0,0 +1,52 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/buffered_ipld.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::CID;
+using fc::storage::ipfs::BufferedIpld;
+using fc::storage::ipfs::InMemoryDatastore;
+
+class BufferedIpldTest : public ::testing::Test {
+ public:
+  std::shared_ptr<InMemoryDatastore> store{
+      std::make_shared<InMemoryDatastore>()};
+  std::shared_ptr<BufferedIpld> buffered{
+      std::make_shared<BufferedIpld>(store)};
+};
+
+/**
+ * @given buffered ipld
+ * @when set value
+ * @then value is readable from buffer, but not written to store
+ */
+TEST_F(BufferedIpldTest, SetDoesNotWrite) {
+  EXPECT_OUTCOME_TRUE(cid, buffered->setCbor(1));
+  EXPECT_OUTCOME_EQ(buffered->contains(cid), true);
+  EXPECT_OUTCOME_EQ(buffered->getCbor<int>(cid), 1);
+  EXPECT_OUTCOME_EQ(store->contains(cid), false);
+  EXPECT_EQ(buffered->size(), 1);
+}
+
+/**
+ * @given buffered ipld with linked and unreachable blocks
+ * @when flush with root
+ * @then only blocks reachable from root are written to store
+ */
+TEST_F(BufferedIpldTest, FlushReachable) {
+  EXPECT_OUTCOME_TRUE(child, buffered->setCbor(1));
+  EXPECT_OUTCOME_TRUE(root, buffered->setCbor(std::vector<CID>{child}));
+  EXPECT_OUTCOME_TRUE(dead, buffered->setCbor(2));
+  EXPECT_OUTCOME_TRUE_1(buffered->flush({root}));
+  EXPECT_OUTCOME_EQ(store->contains(root), true);
+  EXPECT_OUTCOME_EQ(store->contains(child), true);
+  EXPECT_OUTCOME_EQ(store->contains(dead), false);
+  EXPECT_EQ(buffered->size(), 0);
+}
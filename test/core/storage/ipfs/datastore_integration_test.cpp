@@ -149,3 +149,34 @@ TEST_F(DatastoreIntegrationTest, PersistentStorage) {
                       LeveldbDatastore::create(leveldb_path.string(), options));
   EXPECT_OUTCOME_EQ(open_again->contains(cid1), true);
 }
+
+/**
+ * @given opened datastore, two cids and values
+ * @when put pairs with single batch
+ * @then all values are present
+ */
+TEST_F(DatastoreIntegrationTest, SetManySuccess) {
+  Buffer value2{"FEDCBA9876543210FEDCBA9876543210"_unhex};
+  EXPECT_OUTCOME_TRUE_1(datastore->setMany({{cid1, value}, {cid2, value2}}));
+  EXPECT_OUTCOME_EQ(datastore->get(cid1), value);
+  EXPECT_OUTCOME_EQ(datastore->get(cid2), value2);
+}
+
+/**
+ * @given opened datastore with value
+ * @when view present and absent values
+ * @then callback receives stored bytes, absent value is not found
+ */
+TEST_F(DatastoreIntegrationTest, ViewSuccess) {
+  EXPECT_OUTCOME_TRUE_1(datastore->set(cid1, value));
+  auto calls = 0;
+  EXPECT_OUTCOME_TRUE_1(datastore->view(cid1, [&](auto bytes) {
+    ++calls;
+    EXPECT_EQ(Buffer{bytes}, value);
+    return fc::outcome::success();
+  }));
+  EXPECT_EQ(calls, 1);
+  EXPECT_OUTCOME_ERROR(
+      IpfsDatastoreError::kNotFound,
+      datastore->view(cid2, [](auto) { return fc::outcome::success(); }));
+}
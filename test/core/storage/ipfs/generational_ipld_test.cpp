@@ -0,0 +1,155 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/generational_ipld.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::CID;
+using fc::IpldPtr;
+using fc::storage::ipfs::GenerationalIpld;
+using fc::storage::ipfs::GenerationalIpldError;
+using fc::storage::ipfs::InMemoryDatastore;
+using Marker = GenerationalIpld::Marker;
+
+class GenerationalIpldTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    ipld = open(marker);
+  }
+
+  /// Opens stores of marker, destroy and persist fail when set to fail
+  std::shared_ptr<GenerationalIpld> open(const Marker &marker) {
+    EXPECT_OUTCOME_TRUE(
+        created,
+        GenerationalIpld::create(
+            [this](auto generation) -> fc::outcome::result<IpldPtr> {
+              auto &store{stores[generation]};
+              if (!store) {
+                store = std::make_shared<InMemoryDatastore>();
+              }
+              return store;
+            },
+            [this](auto generation) -> fc::outcome::result<void> {
+              if (fail_destroy) {
+                return fc::storage::ipfs::IpfsDatastoreError::kNotFound;
+              }
+              stores.erase(generation);
+              return fc::outcome::success();
+            },
+            [this](auto &persisted) -> fc::outcome::result<void> {
+              if (fail_persist != 0 && --fail_persist == 0) {
+                return GenerationalIpldError::kCannotWriteMarker;
+              }
+              this->marker = persisted;
+              return fc::outcome::success();
+            },
+            marker));
+    return created;
+  }
+
+  std::map<uint64_t, IpldPtr> stores;
+  Marker marker;
+  bool fail_destroy{};
+  /// Persist call which fails, counted from one
+  size_t fail_persist{};
+  std::shared_ptr<GenerationalIpld> ipld;
+};
+
+/**
+ * @given blocks written before two collections
+ * @when collect with root of some of them
+ * @then reachable and kept blocks survive, others are dropped with oldest
+ * generation
+ */
+TEST_F(GenerationalIpldTest, CollectReachable) {
+  EXPECT_OUTCOME_TRUE(child, ipld->setCbor(1));
+  EXPECT_OUTCOME_TRUE(root, ipld->setCbor(std::vector<CID>{child}));
+  EXPECT_OUTCOME_TRUE(header, ipld->setCbor(std::vector<CID>{root}));
+  EXPECT_OUTCOME_TRUE(dead, ipld->setCbor(2));
+
+  // previous generation is kept whole
+  EXPECT_OUTCOME_TRUE_1(ipld->collect({}, {}));
+  EXPECT_EQ(ipld->generation(), 1);
+  EXPECT_OUTCOME_EQ(ipld->contains(dead), true);
+
+  EXPECT_OUTCOME_TRUE_1(ipld->collect({root}, {header}));
+  EXPECT_EQ(ipld->generation(), 2);
+  EXPECT_EQ(stores.count(0), 0);
+  EXPECT_OUTCOME_EQ(ipld->getCbor<int>(child), 1);
+  EXPECT_OUTCOME_EQ(ipld->contains(root), true);
+  EXPECT_OUTCOME_EQ(ipld->contains(header), true);
+  EXPECT_OUTCOME_EQ(ipld->contains(dead), false);
+}
+
+/**
+ * @given blocks written to current generation
+ * @when reopen at same generation
+ * @then blocks are read from reopened stores
+ */
+TEST_F(GenerationalIpldTest, Reopen) {
+  EXPECT_OUTCOME_TRUE_1(ipld->collect({}, {}));
+  EXPECT_OUTCOME_TRUE(cid, ipld->setCbor(1));
+  EXPECT_EQ(marker.generation, 1);
+  auto reopened{open(marker)};
+  EXPECT_OUTCOME_EQ(reopened->getCbor<int>(cid), 1);
+}
+
+/**
+ * @given collection which crashes after reachable blocks are copied, before
+ * oldest generation is destroyed
+ * @when reopen at persisted marker
+ * @then reachable blocks are read, oldest generation is destroyed on open
+ */
+TEST_F(GenerationalIpldTest, CrashBeforeDestroy) {
+  EXPECT_OUTCOME_TRUE(child, ipld->setCbor(1));
+  EXPECT_OUTCOME_TRUE(root, ipld->setCbor(std::vector<CID>{child}));
+  EXPECT_OUTCOME_TRUE_1(ipld->collect({}, {}));
+  fail_destroy = true;
+  EXPECT_OUTCOME_ERROR(fc::storage::ipfs::IpfsDatastoreError::kNotFound,
+                       ipld->collect({root}, {}));
+  EXPECT_EQ(marker.generation, 2);
+  EXPECT_FALSE(marker.collecting);
+
+  fail_destroy = false;
+  ipld.reset();
+  auto reopened{open(marker)};
+  EXPECT_EQ(stores.count(0), 0);
+  EXPECT_OUTCOME_EQ(reopened->getCbor<int>(child), 1);
+  EXPECT_OUTCOME_EQ(reopened->contains(root), true);
+}
+
+/**
+ * @given collection which crashes while reachable blocks are copied
+ * @when reopen at persisted marker
+ * @then oldest generation is opened too, so no block is lost
+ */
+TEST_F(GenerationalIpldTest, CrashBeforeCopied) {
+  EXPECT_OUTCOME_TRUE(child, ipld->setCbor(1));
+  EXPECT_OUTCOME_TRUE(dead, ipld->setCbor(2));
+  EXPECT_OUTCOME_TRUE_1(ipld->collect({}, {}));
+  // second persist of collection, after copy
+  fail_persist = 2;
+  EXPECT_OUTCOME_ERROR(GenerationalIpldError::kCannotWriteMarker,
+                       ipld->collect({}, {child}));
+  EXPECT_EQ(marker.generation, 2);
+  EXPECT_TRUE(marker.collecting);
+  EXPECT_EQ(stores.count(0), 1);
+
+  ipld.reset();
+  auto reopened{open(marker)};
+  EXPECT_OUTCOME_EQ(reopened->getCbor<int>(child), 1);
+  EXPECT_OUTCOME_EQ(reopened->contains(dead), true);
+
+  EXPECT_OUTCOME_TRUE_1(reopened->collect({}, {child}));
+  EXPECT_EQ(marker.generation, 3);
+  EXPECT_EQ(stores.count(0), 0);
+  EXPECT_EQ(stores.count(1), 0);
+  EXPECT_OUTCOME_EQ(reopened->getCbor<int>(child), 1);
+  EXPECT_OUTCOME_EQ(reopened->contains(dead), false);
+}
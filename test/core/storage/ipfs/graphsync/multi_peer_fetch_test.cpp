@@ -0,0 +1,196 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/graphsync/impl/multi_peer_fetch.hpp"
+
+#include <gtest/gtest.h>
+#include <libp2p/protocol/common/asio/asio_scheduler.hpp>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "storage/ipld/traverser.hpp"
+#include "testutil/outcome.hpp"
+#include "testutil/peer_id.hpp"
+
+namespace fc::storage::ipfs::graphsync {
+  using ipld::traverser::Traverser;
+
+  /// Records requests, responses are sent by test
+  struct FakeGraphsync : Graphsync {
+    struct Request {
+      PeerId peer;
+      CID root;
+      common::Buffer selector;
+      RequestProgressCallback callback;
+    };
+
+    void start(std::shared_ptr<MerkleDagBridge>, BlockCallback) override {}
+
+    void stop() override {}
+
+    Subscription makeRequest(const PeerId &peer,
+                             boost::optional<libp2p::multi::Multiaddress>,
+                             const CID &root_cid,
+                             gsl::span<const uint8_t> selector,
+                             const std::vector<Extension> &,
+                             RequestProgressCallback callback) override {
+      requests.push_back(
+          {peer, root_cid, common::Buffer{selector}, std::move(callback)});
+      return {};
+    }
+
+    std::deque<Request> requests;
+  };
+
+  /**
+   * Dag of blocks:
+   * root [a, b]
+   * a [c, d]
+   * b [d, e]
+   * c, d, e [1]
+   */
+  class MultiPeerFetchTest : public ::testing::Test {
+   public:
+    void SetUp() override {
+      c = source->setCbor(std::vector<int>{1}).value();
+      d = source->setCbor(std::vector<int>{2}).value();
+      e = source->setCbor(std::vector<int>{3}).value();
+      a = source->setCbor(std::vector<CID>{c, d}).value();
+      b = source->setCbor(std::vector<CID>{d, e}).value();
+      root = source->setCbor(std::vector<CID>{a, b}).value();
+      fetch->addPeer(peer1);
+    }
+
+    /// Sends blocks selected by first request and completes it
+    void serve(bool has_data = true) {
+      auto request = std::move(graphsync->requests.front());
+      graphsync->requests.pop_front();
+      if (has_data) {
+        Traverser traverser{*source, request.root, {request.selector}};
+        while (!traverser.isCompleted()) {
+          EXPECT_OUTCOME_TRUE(block, traverser.advanceBlock());
+          fetch->onBlock(block.first, block.second);
+        }
+      }
+      request.callback(has_data ? RS_FULL_CONTENT : RS_NOT_FOUND, {});
+    }
+
+    std::shared_ptr<Ipld> source{std::make_shared<InMemoryDatastore>()};
+    std::shared_ptr<Ipld> ipld{std::make_shared<InMemoryDatastore>()};
+    std::shared_ptr<FakeGraphsync> graphsync{
+        std::make_shared<FakeGraphsync>()};
+    boost::asio::io_context io;
+    std::shared_ptr<libp2p::protocol::Scheduler> scheduler{
+        std::make_shared<libp2p::protocol::AsioScheduler>(
+            io, libp2p::protocol::SchedulerConfig{})};
+    std::shared_ptr<MultiPeerFetch> fetch{std::make_shared<MultiPeerFetch>(
+        graphsync, ipld, scheduler, MultiPeerFetchConfig{2, 4, 10000})};
+    PeerId peer1{generatePeerId(1)};
+    PeerId peer2{generatePeerId(2)};
+    CID root, a, b, c, d, e;
+    boost::optional<outcome::result<void>> result;
+  };
+
+  /**
+   * @given dag of 3 levels and subtrees of 2 levels, two peers
+   * @when fetch dag
+   * @then subtree boundary links are requested from both peers, each block is
+   * stored once
+   */
+  TEST_F(MultiPeerFetchTest, SplitsSubtrees) {
+    fetch->addPeer(peer2);
+    fetch->fetch(root, [&](auto r) { result = r; });
+    ASSERT_EQ(graphsync->requests.size(), 1);
+    EXPECT_EQ(graphsync->requests.front().root, root);
+    serve();
+    ASSERT_EQ(graphsync->requests.size(), 3);
+    EXPECT_FALSE(graphsync->requests[0].peer == graphsync->requests[1].peer);
+    while (!graphsync->requests.empty()) {
+      serve();
+    }
+    ASSERT_TRUE(result);
+    EXPECT_OUTCOME_TRUE_1(*result);
+    EXPECT_EQ(fetch->received(), 6);
+    for (auto &cid : {root, a, b, c, d, e}) {
+      EXPECT_OUTCOME_EQ(ipld->contains(cid), true);
+    }
+  }
+
+  /**
+   * @given two peers, first peer doesn't have dag
+   * @when fetch dag
+   * @then failed subtree is requested from second peer
+   */
+  TEST_F(MultiPeerFetchTest, ReissuesFailed) {
+    fetch->addPeer(peer2);
+    fetch->fetch(root, [&](auto r) { result = r; });
+    ASSERT_EQ(graphsync->requests.size(), 1);
+    auto first = graphsync->requests.front().peer;
+    serve(false);
+    ASSERT_EQ(graphsync->requests.size(), 1);
+    EXPECT_EQ(graphsync->requests.front().root, root);
+    EXPECT_FALSE(graphsync->requests.front().peer == first);
+    while (!graphsync->requests.empty()) {
+      serve();
+    }
+    ASSERT_TRUE(result);
+    EXPECT_OUTCOME_TRUE_1(*result);
+  }
+
+  /**
+   * @given single peer which doesn't have dag
+   * @when fetch dag
+   * @then fetch fails
+   */
+  TEST_F(MultiPeerFetchTest, NoPeers) {
+    fetch->fetch(root, [&](auto r) { result = r; });
+    serve(false);
+    ASSERT_TRUE(result);
+    EXPECT_OUTCOME_ERROR(MultiPeerFetchError::kNoPeers, *result);
+  }
+
+  /**
+   * @given part of dag present locally
+   * @when fetch dag
+   * @then only missing subtrees are requested
+   */
+  TEST_F(MultiPeerFetchTest, SkipsPresent) {
+    for (auto &cid : {root, a, b}) {
+      EXPECT_OUTCOME_TRUE_1(ipld->set(cid, source->get(cid).value()));
+    }
+    fetch->fetch(root, [&](auto r) { result = r; });
+    EXPECT_EQ(graphsync->requests.size(), 3);
+    while (!graphsync->requests.empty()) {
+      serve();
+    }
+    ASSERT_TRUE(result);
+    EXPECT_OUTCOME_TRUE_1(*result);
+    EXPECT_EQ(fetch->received(), 3);
+  }
+
+  /**
+   * @given two peers, first peer sends root with wrong bytes
+   * @when fetch dag
+   * @then wrong root is not stored and is requested from second peer
+   */
+  TEST_F(MultiPeerFetchTest, RejectsMismatch) {
+    fetch->addPeer(peer2);
+    fetch->fetch(root, [&](auto r) { result = r; });
+    ASSERT_EQ(graphsync->requests.size(), 1);
+    auto request = std::move(graphsync->requests.front());
+    graphsync->requests.pop_front();
+    EXPECT_TRUE(fetch->onBlock(root, source->get(a).value()));
+    EXPECT_OUTCOME_EQ(ipld->contains(root), false);
+    request.callback(RS_FULL_CONTENT, {});
+    ASSERT_EQ(graphsync->requests.size(), 1);
+    EXPECT_EQ(graphsync->requests.front().root, root);
+    EXPECT_FALSE(graphsync->requests.front().peer == request.peer);
+    while (!graphsync->requests.empty()) {
+      serve();
+    }
+    ASSERT_TRUE(result);
+    EXPECT_OUTCOME_TRUE_1(*result);
+  }
+
+}  // namespace fc::storage::ipfs::graphsync
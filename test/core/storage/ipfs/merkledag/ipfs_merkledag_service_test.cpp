@@ -10,6 +10,7 @@
 #include "core/storage/ipfs/merkledag/ipfs_merkledag_dataset.hpp"
 #include "storage/ipfs/impl/in_memory_datastore.hpp"
 #include "storage/ipfs/impl/ipfs_block_service.hpp"
+#include "storage/ipld/selector.hpp"
 
 using namespace fc::storage::ipfs;
 using namespace fc::storage::ipld;
@@ -196,12 +197,12 @@ TEST_P(CommonFeaturesTest, FetchGraphSuccess) {
 
 /**
  * @given Pre-generated nodes structure
- * @when Selecting nodes from DAG service
+ * @when Selecting nodes from DAG service with empty selector
  * @then All operations must be successful and
- *       selected nodes count must be count of root node children + 1 (self)
+ *       each node of graph is selected once
  */
 TEST_P(CommonFeaturesTest, GraphSyncSelect) {
-  const size_t nodes_count = data.nodes.front()->getLinks().size() + 1;
+  const size_t nodes_count = data.nodes.size();
   EXPECT_OUTCOME_TRUE(root_cid, data.nodes.front()->getCID().toBytes());
   std::vector<std::shared_ptr<const IPLDNode>> selected_nodes;
   std::function<bool(std::shared_ptr<const IPLDNode>)> handler =
@@ -216,6 +217,26 @@ TEST_P(CommonFeaturesTest, GraphSyncSelect) {
   ASSERT_EQ(nodes_count, selected_count);
 }
 
+/**
+ * @given Pre-generated nodes structure
+ * @when Selecting nodes with selector matching only root
+ * @then Only root node is selected
+ */
+TEST_P(CommonFeaturesTest, SelectMatcher) {
+  EXPECT_OUTCOME_TRUE(root_cid, data.nodes.front()->getCID().toBytes());
+  std::vector<std::shared_ptr<const IPLDNode>> selected_nodes;
+  std::function<bool(std::shared_ptr<const IPLDNode>)> handler =
+      [&selected_nodes](std::shared_ptr<const IPLDNode> node) -> bool {
+    selected_nodes.emplace_back(std::move(node));
+    return true;
+  };
+  EXPECT_OUTCOME_TRUE(
+      selected_count,
+      merkledag_service_->select(root_cid, kMatcherSelector.raw, handler));
+  ASSERT_EQ(selected_count, 1);
+  ASSERT_EQ(selected_nodes.front()->getCID(), data.nodes.front()->getCID());
+}
+
 /**
  * Pre-generated nodes, CIDs and serialized graph structures
  * Reference CIDs was generated by https://github.com/ipfs/go-merkledag
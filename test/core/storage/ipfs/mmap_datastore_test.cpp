@@ -0,0 +1,191 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/mmap_datastore.hpp"
+
+#include <gtest/gtest.h>
+#include <boost/filesystem/fstream.hpp>
+
+#include "testutil/outcome.hpp"
+#include "testutil/storage/base_fs_test.hpp"
+
+using fc::CID;
+using fc::common::Buffer;
+using fc::common::getCidOf;
+using fc::storage::ipfs::IpfsDatastoreError;
+using fc::storage::ipfs::MmapDatastore;
+using fc::storage::ipfs::MmapDatastoreConfig;
+using fc::storage::ipfs::MmapDatastoreError;
+
+struct MmapDatastoreTest : public test::BaseFS_Test {
+  MmapDatastoreTest() : test::BaseFS_Test("fc_mmap_datastore_test") {}
+
+  void SetUp() override {
+    BaseFS_Test::SetUp();
+    path = (base_path / "blocks").string();
+    reopen();
+  }
+
+  void reopen(MmapDatastoreConfig config = {1 << 20, true}) {
+    datastore.reset();
+    EXPECT_OUTCOME_TRUE(opened, MmapDatastore::create(path, config));
+    datastore = opened;
+  }
+
+  static std::pair<CID, Buffer> block(uint8_t seed) {
+    Buffer value{seed, 1, 2, 3};
+    return {getCidOf(value).value(), value};
+  }
+
+  std::string path;
+  std::shared_ptr<MmapDatastore> datastore;
+};
+
+/**
+ * @given datastore
+ * @when set value and view it
+ * @then value is read from mapping
+ */
+TEST_F(MmapDatastoreTest, SetGet) {
+  auto [cid, value]{block(1)};
+  EXPECT_OUTCOME_EQ(datastore->contains(cid), false);
+  EXPECT_OUTCOME_ERROR(IpfsDatastoreError::kNotFound, datastore->get(cid));
+  EXPECT_OUTCOME_TRUE_1(datastore->set(cid, value));
+  EXPECT_OUTCOME_EQ(datastore->contains(cid), true);
+  EXPECT_OUTCOME_EQ(datastore->get(cid), value);
+  EXPECT_OUTCOME_TRUE_1(datastore->view(cid, [&](auto bytes) {
+    EXPECT_EQ(Buffer{bytes}, value);
+    return fc::outcome::success();
+  }));
+  // same block is not appended again
+  auto size{datastore->size()};
+  EXPECT_OUTCOME_TRUE_1(datastore->set(cid, value));
+  EXPECT_EQ(datastore->size(), size);
+}
+
+/**
+ * @given datastore with values written by setMany and removed value
+ * @when reopen datastore
+ * @then committed values and removal are restored
+ */
+TEST_F(MmapDatastoreTest, Reopen) {
+  auto [cid1, value1]{block(1)};
+  auto [cid2, value2]{block(2)};
+  EXPECT_OUTCOME_TRUE_1(
+      datastore->setMany({{cid1, value1}, {cid2, value2}}));
+  EXPECT_OUTCOME_TRUE_1(datastore->remove(cid1));
+  reopen();
+  EXPECT_OUTCOME_EQ(datastore->contains(cid1), false);
+  EXPECT_OUTCOME_EQ(datastore->get(cid2), value2);
+}
+
+/**
+ * @given datastore file with bytes after committed size
+ * @when reopen datastore
+ * @then uncommitted bytes are truncated
+ */
+TEST_F(MmapDatastoreTest, TruncateUncommitted) {
+  auto [cid, value]{block(1)};
+  EXPECT_OUTCOME_TRUE_1(datastore->set(cid, value));
+  auto size{datastore->size()};
+  datastore.reset();
+  {
+    boost::filesystem::ofstream file{path, std::ios::app | std::ios::binary};
+    file << "partial record";
+  }
+  reopen();
+  EXPECT_EQ(datastore->size(), size);
+  EXPECT_EQ(boost::filesystem::file_size(path), size);
+  EXPECT_OUTCOME_EQ(datastore->get(cid), value);
+}
+
+/**
+ * @given file which is not datastore
+ * @when open it
+ * @then error is returned
+ */
+TEST_F(MmapDatastoreTest, Corrupted) {
+  datastore.reset();
+  {
+    boost::filesystem::ofstream file{path, std::ios::trunc};
+    file << "not a datastore file";
+  }
+  EXPECT_OUTCOME_ERROR(MmapDatastoreError::kCorrupted,
+                       MmapDatastore::create(path));
+}
+
+/**
+ * @given synced datastore
+ * @when reopen datastore
+ * @then keys are read from index file, not from records
+ */
+TEST_F(MmapDatastoreTest, IndexPersisted) {
+  auto [cid1, value1]{block(1)};
+  auto [cid2, value2]{block(2)};
+  EXPECT_OUTCOME_TRUE_1(datastore->set(cid1, value1));
+  EXPECT_OUTCOME_TRUE_1(datastore->set(cid2, value2));
+  EXPECT_EQ(datastore->unindexed(), 2);
+  EXPECT_OUTCOME_TRUE_1(datastore->remove(cid1));
+  EXPECT_OUTCOME_TRUE_1(datastore->sync());
+  EXPECT_EQ(datastore->unindexed(), 0);
+  reopen();
+  EXPECT_EQ(datastore->unindexed(), 0);
+  EXPECT_OUTCOME_EQ(datastore->contains(cid1), false);
+  EXPECT_OUTCOME_EQ(datastore->get(cid2), value2);
+  EXPECT_OUTCOME_TRUE_1(datastore->set(cid1, value1));
+  EXPECT_OUTCOME_EQ(datastore->get(cid1), value1);
+}
+
+/**
+ * @given datastore synced every few records
+ * @when more keys are written than index has slots
+ * @then index grows and all keys are found after reopen
+ */
+TEST_F(MmapDatastoreTest, GrowIndex) {
+  MmapDatastoreConfig config{16 << 20, false, 4096};
+  reopen(config);
+  std::vector<CID> cids;
+  for (uint32_t i{}; i < 40000; ++i) {
+    Buffer value{gsl::make_span(reinterpret_cast<uint8_t *>(&i), sizeof(i))};
+    EXPECT_OUTCOME_TRUE(cid, getCidOf(value));
+    EXPECT_OUTCOME_TRUE_1(datastore->set(cid, value));
+    cids.push_back(cid);
+  }
+  reopen(config);
+  EXPECT_EQ(datastore->unindexed(), 0);
+  for (auto &cid : cids) {
+    EXPECT_OUTCOME_EQ(datastore->contains(cid), true);
+  }
+}
+
+/**
+ * @given datastore with record after last sync, which was not written to
+ * disk before crash
+ * @when reopen datastore
+ * @then record doesn't match its cid and is truncated
+ */
+TEST_F(MmapDatastoreTest, TruncateUnsynced) {
+  auto [cid1, value1]{block(1)};
+  auto [cid2, value2]{block(2)};
+  EXPECT_OUTCOME_TRUE_1(datastore->set(cid1, value1));
+  EXPECT_OUTCOME_TRUE_1(datastore->sync());
+  uint64_t synced{datastore->size()};
+  EXPECT_OUTCOME_TRUE_1(datastore->set(cid2, value2));
+  datastore.reset();
+  {
+    // header keeps committed size, but synced size and record bytes are
+    // as before crash
+    boost::filesystem::fstream file{
+        path, std::ios::in | std::ios::out | std::ios::binary};
+    file.seekp(2 * sizeof(uint64_t));
+    file.write(reinterpret_cast<const char *>(&synced), sizeof(synced));
+    file.seekp(-1, std::ios::end);
+    file.put(0);
+  }
+  reopen();
+  EXPECT_EQ(datastore->size(), synced);
+  EXPECT_OUTCOME_EQ(datastore->get(cid1), value1);
+  EXPECT_OUTCOME_EQ(datastore->contains(cid2), false);
+}
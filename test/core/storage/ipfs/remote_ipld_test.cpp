@@ -0,0 +1,148 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/remote_ipld.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/literals.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::CID;
+using fc::storage::ipfs::InMemoryDatastore;
+using fc::storage::ipfs::IpfsDatastoreError;
+using fc::storage::ipfs::RemoteIpld;
+using Value = RemoteIpld::Value;
+
+class RemoteIpldTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    for (auto i = 0; i < 3; ++i) {
+      EXPECT_OUTCOME_TRUE(cid, remote->setCbor(i));
+      cids.push_back(cid);
+    }
+    ipld = std::make_shared<RemoteIpld>(
+        local,
+        [this](auto &keys)
+            -> fc::outcome::result<std::vector<boost::optional<Value>>> {
+          ++requests;
+          if (on_fetch) {
+            on_fetch();
+          }
+          std::vector<boost::optional<Value>> values;
+          for (auto &key : keys) {
+            ++fetched;
+            auto value{remote->get(key)};
+            values.push_back(value ? boost::make_optional(value.value())
+                                   : boost::none);
+          }
+          return values;
+        });
+  }
+
+  std::shared_ptr<InMemoryDatastore> remote{
+      std::make_shared<InMemoryDatastore>()};
+  std::shared_ptr<InMemoryDatastore> local{
+      std::make_shared<InMemoryDatastore>()};
+  std::shared_ptr<RemoteIpld> ipld;
+  std::vector<CID> cids;
+  std::atomic<size_t> requests{0};
+  std::atomic<size_t> fetched{0};
+  std::function<void()> on_fetch;
+};
+
+/**
+ * @given blocks only in remote store
+ * @when get block twice
+ * @then block is fetched once and kept in local store
+ */
+TEST_F(RemoteIpldTest, ReadThrough) {
+  EXPECT_OUTCOME_EQ(ipld->getCbor<int>(cids[0]), 0);
+  EXPECT_OUTCOME_EQ(ipld->getCbor<int>(cids[0]), 0);
+  EXPECT_EQ(requests, 1);
+  EXPECT_OUTCOME_EQ(local->contains(cids[0]), true);
+  EXPECT_OUTCOME_EQ(ipld->contains(cids[1]), true);
+}
+
+/**
+ * @given block absent in both stores
+ * @when get and check it
+ * @then not found, absent in local store
+ */
+TEST_F(RemoteIpldTest, Absent) {
+  EXPECT_OUTCOME_TRUE(absent, local->setCbor(3));
+  EXPECT_OUTCOME_TRUE_1(local->remove(absent));
+  EXPECT_OUTCOME_ERROR(IpfsDatastoreError::kNotFound, ipld->get(absent));
+  EXPECT_OUTCOME_EQ(ipld->contains(absent), false);
+}
+
+/**
+ * @given one block in local store
+ * @when get many blocks
+ * @then missing blocks are fetched with one request
+ */
+TEST_F(RemoteIpldTest, GetMany) {
+  EXPECT_OUTCOME_TRUE_1(ipld->get(cids[1]));
+  requests = 0;
+  fetched = 0;
+  EXPECT_OUTCOME_TRUE(values, ipld->getMany(cids));
+  ASSERT_EQ(values.size(), 3);
+  for (size_t i = 0; i < cids.size(); ++i) {
+    EXPECT_OUTCOME_EQ(local->get(cids[i]), *values[i]);
+  }
+  EXPECT_EQ(requests, 1);
+  EXPECT_EQ(fetched, 2);
+}
+
+/**
+ * @given get of block waiting for remote store
+ * @when block is requested again meanwhile
+ * @then block is fetched once
+ */
+TEST_F(RemoteIpldTest, Coalesce) {
+  std::promise<void> started, release;
+  auto release_future{release.get_future().share()};
+  on_fetch = [&] {
+    started.set_value();
+    release_future.wait();
+  };
+  std::thread first{[&] { EXPECT_OUTCOME_TRUE_1(ipld->get(cids[0])); }};
+  started.get_future().wait();
+  std::thread second{[&] { EXPECT_OUTCOME_TRUE_1(ipld->get(cids[0])); }};
+  std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  release.set_value();
+  first.join();
+  second.join();
+  EXPECT_EQ(requests, 1);
+}
+
+/**
+ * @given remote store returning bytes not matching cid
+ * @when get block
+ * @then get fails and block is not cached
+ */
+TEST_F(RemoteIpldTest, RejectsMismatch) {
+  EXPECT_OUTCOME_TRUE(cid, InMemoryDatastore{}.setCbor(7));
+  EXPECT_OUTCOME_TRUE_1(remote->set(cid, Value{"01"_unhex}));
+  EXPECT_OUTCOME_ERROR(fc::storage::ipfs::RemoteIpldError::kCidMismatch,
+                       ipld->get(cid));
+  EXPECT_OUTCOME_EQ(local->contains(cid), false);
+}
+
+/**
+ * @given fetch which throws
+ * @when get block, then get it again after fetch recovers
+ * @then request is cleared, second get fetches block
+ */
+TEST_F(RemoteIpldTest, ClearsFailedRequest) {
+  on_fetch = [] { throw std::runtime_error{"transport"}; };
+  EXPECT_THROW(std::ignore = ipld->get(cids[0]), std::runtime_error);
+  on_fetch = nullptr;
+  EXPECT_OUTCOME_TRUE(value, remote->get(cids[0]));
+  EXPECT_OUTCOME_EQ(ipld->get(cids[0]), value);
+  EXPECT_EQ(requests, 2);
+}
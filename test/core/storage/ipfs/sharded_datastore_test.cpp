@@ -0,0 +1,115 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/sharded_datastore.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::CID;
+using fc::storage::ipfs::InMemoryDatastore;
+using fc::storage::ipfs::IpfsDatastoreError;
+using fc::storage::ipfs::ShardedDatastore;
+
+/**
+ * @given sharded datastore
+ * @when threads write and read own blocks concurrently
+ * @then all blocks are readable @and removed block is not found
+ */
+TEST(ShardedDatastoreTest, ConcurrentWrites) {
+  auto ipld{std::make_shared<ShardedDatastore>()};
+  std::vector<std::thread> threads;
+  for (auto t{0}; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (auto i{0}; i < 100; ++i) {
+        auto value{t * 1000 + i};
+        EXPECT_OUTCOME_TRUE(cid, ipld->setCbor(value));
+        EXPECT_OUTCOME_EQ(ipld->getCbor<int>(cid), value);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (auto value : {0, 1099, 3042}) {
+    EXPECT_OUTCOME_TRUE(cid, ipld->setCbor(value));
+    EXPECT_OUTCOME_EQ(ipld->getCbor<int>(cid), value);
+  }
+  EXPECT_OUTCOME_TRUE(cid, ipld->setCbor(7));
+  EXPECT_OUTCOME_TRUE_1(ipld->remove(cid));
+  EXPECT_OUTCOME_EQ(ipld->contains(cid), false);
+  EXPECT_OUTCOME_ERROR(IpfsDatastoreError::kNotFound, ipld->get(cid));
+}
+
+/**
+ * @given sharded datastore with memory limit and spill store
+ * @when more bytes than limit are written
+ * @then memory stays within limit @and evicted blocks are read from spill
+ */
+TEST(ShardedDatastoreTest, SpillOverLimit) {
+  auto spill{std::make_shared<InMemoryDatastore>()};
+  auto ipld{std::make_shared<ShardedDatastore>(
+      fc::storage::ipfs::ShardedDatastoreConfig{1, 100}, spill)};
+  auto value{[](int i) { return std::string(20, 'a') + std::to_string(i); }};
+  std::vector<CID> cids;
+  for (auto i{0}; i < 50; ++i) {
+    EXPECT_OUTCOME_TRUE(cid, ipld->setCbor(value(i)));
+    cids.push_back(cid);
+  }
+  EXPECT_LE(ipld->bytes(), 100u);
+  EXPECT_OUTCOME_EQ(spill->contains(cids[0]), true);
+  for (auto i{0}; i < 50; ++i) {
+    EXPECT_OUTCOME_EQ(ipld->getCbor<std::string>(cids[i]), value(i));
+  }
+}
+
+/**
+ * @given sharded datastore with memory limit and spill store
+ * @when blocks are removed and written again before eviction
+ * @then each block is evicted once @and byte count stays consistent
+ */
+TEST(ShardedDatastoreTest, RewriteRemoved) {
+  auto spill{std::make_shared<InMemoryDatastore>()};
+  auto ipld{std::make_shared<ShardedDatastore>(
+      fc::storage::ipfs::ShardedDatastoreConfig{1, 100}, spill)};
+  auto value{[](int i) { return std::string(20, 'a') + std::to_string(i); }};
+  std::vector<CID> cids;
+  for (auto i{0}; i < 3; ++i) {
+    EXPECT_OUTCOME_TRUE(cid, ipld->setCbor(value(i)));
+    cids.push_back(cid);
+    EXPECT_OUTCOME_TRUE_1(ipld->remove(cid));
+    EXPECT_OUTCOME_TRUE_1(ipld->setCbor(value(i)));
+  }
+  auto before{ipld->bytes()};
+  for (auto i{3}; i < 20; ++i) {
+    EXPECT_OUTCOME_TRUE(cid, ipld->setCbor(value(i)));
+    cids.push_back(cid);
+    EXPECT_LE(ipld->bytes(), 100u);
+  }
+  EXPECT_GT(before, 0u);
+  for (auto i{0}; i < 20; ++i) {
+    EXPECT_OUTCOME_EQ(ipld->getCbor<std::string>(cids[i]), value(i));
+  }
+}
+
+/**
+ * @given sharded datastore with block
+ * @when view callback writes to same store
+ * @then callback doesn't wait for shard lock held by view
+ */
+TEST(ShardedDatastoreTest, ViewWithoutLock) {
+  auto ipld{std::make_shared<ShardedDatastore>(
+      fc::storage::ipfs::ShardedDatastoreConfig{1, 0})};
+  EXPECT_OUTCOME_TRUE(cid, ipld->setCbor(1));
+  EXPECT_OUTCOME_TRUE_1(
+      ipld->view(cid, [&](auto) -> fc::outcome::result<void> {
+        OUTCOME_TRY(ipld->setCbor(2));
+        return fc::outcome::success();
+      }));
+  EXPECT_OUTCOME_EQ(ipld->getCbor<int>(cid), 1);
+}
@@ -0,0 +1,59 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipld/pb_node_view.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/ipld/impl/ipld_node_impl.hpp"
+#include "testutil/outcome.hpp"
+
+namespace fc::storage::ipld {
+  /**
+   * @given dag-pb node with content and two children
+   * @when view is created over its bytes
+   * @then content and links match node without decoding it into objects
+   */
+  TEST(PbNodeViewTest, MatchesNode) {
+    auto child1{IPLDNodeImpl::createFromString("child1")};
+    auto child2{IPLDNodeImpl::createFromString("child2")};
+    auto node{IPLDNodeImpl::createFromString("content")};
+    EXPECT_OUTCOME_TRUE_1(node->addChild("a", child1));
+    EXPECT_OUTCOME_TRUE_1(node->addChild("b", child2));
+    auto &bytes{node->getRawBytes()};
+
+    EXPECT_OUTCOME_TRUE(view, PbNodeView::create(node->getCID(), bytes));
+    EXPECT_EQ(view.cid(), node->getCID());
+    auto data{view.data()};
+    EXPECT_EQ(std::string(data.begin(), data.end()), "content");
+    EXPECT_EQ(view.linksCount(), 2);
+
+    auto links{node->getLinks()};
+    auto cursor{view.links()};
+    PbLink link;
+    for (auto &expected : links) {
+      EXPECT_OUTCOME_TRUE(more, cursor.next(link));
+      ASSERT_TRUE(more);
+      EXPECT_EQ(link.name, expected.get().getName());
+      EXPECT_EQ(link.size, expected.get().getSize());
+      EXPECT_OUTCOME_TRUE(cid, link.cid());
+      EXPECT_EQ(cid, expected.get().getCID());
+    }
+    EXPECT_OUTCOME_TRUE(more, cursor.next(link));
+    EXPECT_FALSE(more);
+  }
+
+  /**
+   * @given bytes which are not dag-pb
+   * @when view is created over them
+   * @then error is returned
+   */
+  TEST(PbNodeViewTest, InvalidBytes) {
+    auto node{IPLDNodeImpl::createFromString("")};
+    // data field with varint wire type
+    std::vector<uint8_t> bytes{0x08, 0x01};
+    EXPECT_OUTCOME_FALSE_1(PbNodeView::create(node->getCID(), bytes));
+  }
+}  // namespace fc::storage::ipld
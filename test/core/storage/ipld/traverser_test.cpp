@@ -0,0 +1,120 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipld/traverser.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/literals.hpp"
+#include "testutil/outcome.hpp"
+
+namespace fc::storage::ipld::traverser {
+  using common::Buffer;
+  using ipfs::InMemoryDatastore;
+  using testing::ElementsAre;
+
+  struct Pair {
+    CID cid;
+    int i;
+  };
+  CBOR_TUPLE(Pair, cid, i)
+
+  /**
+   * Dag of blocks:
+   * root {"a": a, "b": b}
+   * a [c]
+   * b [c, 1]
+   * c [1]
+   */
+  class TraverserTest : public ::testing::Test {
+   public:
+    void SetUp() override {
+      c = store.setCbor(std::vector<int>{1}).value();
+      a = store.setCbor(std::vector<CID>{c}).value();
+      b = store.setCbor(Pair{c, 1}).value();
+      root =
+          store.setCbor(std::map<std::string, CID>{{"a", a}, {"b", b}}).value();
+    }
+
+    outcome::result<std::vector<CID>> traverse(const std::string &hex) {
+      Selector selector{Buffer{common::unhex(hex).value()}};
+      std::vector<CID> cids;
+      Traverser traverser{store, root, selector};
+      while (!traverser.isCompleted()) {
+        OUTCOME_TRY(cid, traverser.advance());
+        cids.push_back(std::move(cid));
+      }
+      return cids;
+    }
+
+    InMemoryDatastore store;
+    CID root, a, b, c;
+  };
+
+  /**
+   * @given dag with shared block
+   * @when traverse with empty selector
+   * @then all blocks are visited depth-first, duplicates are not explored
+   */
+  TEST_F(TraverserTest, All) {
+    EXPECT_OUTCOME_TRUE(cids, traverse(""));
+    EXPECT_THAT(cids, ElementsAre(root, a, c, b, c));
+  }
+
+  /**
+   * @given dag
+   * @when traverse with recursive selector limited to depth 2
+   * @then only root and its children are visited
+   * {"R": {"l": {"depth": 2}, ":>": {"a": {">": {"@": {}}}}}}
+   */
+  TEST_F(TraverserTest, RecursionDepth) {
+    EXPECT_OUTCOME_TRUE(cids,
+                        traverse("a16152a2616ca16564657074680262"
+                                 "3a3ea16161a1613ea16140a0"));
+    EXPECT_THAT(cids, ElementsAre(root, a, b));
+  }
+
+  /**
+   * @given dag
+   * @when traverse with field path selector
+   * @then only blocks on path are visited
+   * {"f": {"f>": {"b": {"i": {"i": 0, ">": {".": {}}}}}}}
+   */
+  TEST_F(TraverserTest, FieldPath) {
+    EXPECT_OUTCOME_TRUE(cids,
+                        traverse("a16166a162663ea16162a16169a2616900"
+                                 "613ea1612ea0"));
+    EXPECT_THAT(cids, ElementsAre(root, b, c));
+  }
+
+  /**
+   * @given dag and worker pool
+   * @when traverse with prefetch
+   * @then same blocks are visited in same order with their bytes
+   */
+  TEST_F(TraverserTest, Prefetch) {
+    auto pool = std::make_shared<boost::asio::thread_pool>(2);
+    Traverser traverser{store, root, {}};
+    traverser.prefetch(pool, 4);
+    std::vector<CID> cids;
+    while (!traverser.isCompleted()) {
+      EXPECT_OUTCOME_TRUE(block, traverser.advanceBlock());
+      EXPECT_OUTCOME_EQ(store.get(block.first), block.second);
+      cids.push_back(block.first);
+    }
+    EXPECT_THAT(cids, ElementsAre(root, a, c, b, c));
+  }
+
+  /**
+   * @given unsupported selector
+   * @when traverse
+   * @then error returned
+   */
+  TEST_F(TraverserTest, InvalidSelector) {
+    EXPECT_OUTCOME_ERROR(TraverserError::kInvalidSelector, traverse("a0"));
+  }
+}  // namespace fc::storage::ipld::traverser
@@ -0,0 +1,63 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/keystore/key_cache.hpp"
+
+#include <gtest/gtest.h>
+
+namespace fc::storage::keystore {
+  /**
+   * @given key cache
+   * @when put, replace and remove keys
+   * @then cached keys are returned and removed ones are not
+   */
+  TEST(KeyCacheTest, PutGetRemove) {
+    KeyCache cache;
+    auto a{Address::makeFromId(1)}, b{Address::makeFromId(2)};
+    KeyCache::PrivateKey key1{1}, key2{2};
+    EXPECT_FALSE(cache.get(a));
+    EXPECT_TRUE(cache.put(a, key1));
+    EXPECT_TRUE(cache.put(b, key2));
+    EXPECT_EQ(*cache.get(a), key1);
+    EXPECT_TRUE(cache.put(a, key2));
+    EXPECT_EQ(*cache.get(a), key2);
+    EXPECT_EQ(cache.size(), 2);
+    cache.remove(a);
+    EXPECT_FALSE(cache.get(a));
+    cache.clear();
+    EXPECT_FALSE(cache.get(b));
+    EXPECT_EQ(cache.size(), 0);
+  }
+
+  /**
+   * @given full key cache
+   * @when put new key @and remove some key
+   * @then new key is not cached until slot is free
+   */
+  TEST(KeyCacheTest, Capacity) {
+    KeyCache cache{1};
+    KeyCache::PrivateKey key{1};
+    size_t cached{0};
+    while (cache.put(Address::makeFromId(cached), key)) {
+      ++cached;
+    }
+    EXPECT_GE(cached, 1);
+    EXPECT_EQ(cache.size(), cached);
+    cache.remove(Address::makeFromId(0));
+    EXPECT_TRUE(cache.put(Address::makeFromId(cached), key));
+  }
+
+  /**
+   * @given buffer with data
+   * @when zero it
+   * @then all bytes are zero
+   */
+  TEST(KeyCacheTest, SecureZero) {
+    KeyCache::PrivateKey key;
+    key.fill(7);
+    secureZero(key);
+    EXPECT_EQ(key, KeyCache::PrivateKey{});
+  }
+}  // namespace fc::storage::keystore
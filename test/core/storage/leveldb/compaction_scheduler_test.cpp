@@ -0,0 +1,86 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/leveldb/compaction_scheduler.hpp"
+
+#include <gtest/gtest.h>
+
+#include "testutil/outcome.hpp"
+#include "testutil/storage/base_leveldb_test.hpp"
+
+using namespace fc::storage;
+using std::chrono::milliseconds;
+
+struct CompactionSchedulerTest : public test::BaseLevelDB_Test {
+  CompactionSchedulerTest()
+      : test::BaseLevelDB_Test("fc_compaction_scheduler_test") {}
+
+  CompactionConfig config_;
+};
+
+/**
+ * @given compaction config
+ * @when time of epoch changes
+ * @then idle time starts at head validation or after validation window, and
+ * ends before next epoch
+ */
+TEST_F(CompactionSchedulerTest, IdleTime) {
+  auto idle{[&](int64_t ms, bool validated) {
+    return CompactionScheduler::isIdle(config_, milliseconds{ms}, validated);
+  }};
+  EXPECT_FALSE(idle(1000, false));
+  EXPECT_TRUE(idle(1000, true));
+  EXPECT_TRUE(idle(6000, false));
+  EXPECT_TRUE(idle(11999, false));
+  EXPECT_FALSE(idle(12000, true));
+  EXPECT_FALSE(idle(14999, true));
+}
+
+/**
+ * @given "leveldb.stats" property
+ * @when it is parsed
+ * @then files and sizes of levels are returned
+ */
+TEST_F(CompactionSchedulerTest, ParseLevels) {
+  auto levels{parseLevelDBLevels(
+      "                               Compactions\n"
+      "Level  Files Size(MB) Time(sec) Read(MB) Write(MB)\n"
+      "--------------------------------------------------\n"
+      "  0        3        2         0        0         2\n"
+      "  1        5       10         4       20        10\n")};
+  ASSERT_EQ(levels.size(), 2);
+  EXPECT_EQ(levels[0].level, 0);
+  EXPECT_EQ(levels[0].files, 3);
+  EXPECT_EQ(levels[0].bytes, 2 << 20);
+  EXPECT_EQ(levels[1].level, 1);
+  EXPECT_EQ(levels[1].files, 5);
+  EXPECT_EQ(levels[1].bytes, 10 << 20);
+  EXPECT_EQ(levels[1].compaction_time.count(), 4);
+  EXPECT_TRUE(parseLevelDBLevels("").empty());
+}
+
+/**
+ * @given database with keys
+ * @when ranges of bytes are found and compacted
+ * @then ranges cover keys until end of database, level 0 is compacted
+ */
+TEST_F(CompactionSchedulerTest, CompactRanges) {
+  Buffer value(100, 1);
+  for (uint8_t i{0}; i < 10; ++i) {
+    EXPECT_OUTCOME_TRUE_1(db_->put(Buffer{i}, value));
+  }
+  auto end{db_->rangeEnd(boost::none, 250)};
+  ASSERT_TRUE(end);
+  EXPECT_EQ(*end, Buffer{2});
+  EXPECT_FALSE(db_->rangeEnd(Buffer{8}, 250));
+
+  db_->compactRange(boost::none, end);
+  db_->compactRange(Buffer{3}, boost::none);
+  EXPECT_FALSE(db_->levels().empty());
+  auto level0{db_->property("leveldb.num-files-at-level0")};
+  ASSERT_TRUE(level0);
+  EXPECT_EQ(*level0, "0");
+  EXPECT_OUTCOME_EQ(db_->get(Buffer{9}), value);
+}
@@ -11,6 +11,7 @@
 
 #include "storage/leveldb/leveldb.hpp"
 #include "storage/leveldb/leveldb_error.hpp"
+#include "storage/leveldb/leveldb_snapshot.hpp"
 #include "testutil/outcome.hpp"
 #include "testutil/storage/base_leveldb_test.hpp"
 
@@ -136,3 +137,59 @@ TEST_F(LevelDB_Integration_Test, Iterator) {
   EXPECT_FALSE(it->isValid());
   EXPECT_EQ(c, index + 1);
 }
+
+/**
+ * @given database with {key} @and its snapshot
+ * @when key is changed and other key is written
+ * @then snapshot reads and cursor see state at time of snapshot
+ */
+TEST_F(LevelDB_Integration_Test, Snapshot) {
+  Buffer other{2};
+  EXPECT_OUTCOME_TRUE_1(db_->put(key_, value_));
+  auto snapshot{db_->snapshot()};
+  EXPECT_OUTCOME_TRUE_1(db_->put(key_, other));
+  EXPECT_OUTCOME_TRUE_1(db_->put(other, other));
+
+  EXPECT_OUTCOME_EQ(snapshot->get(key_), value_);
+  EXPECT_FALSE(snapshot->contains(other));
+  EXPECT_OUTCOME_EQ(db_->get(key_), other);
+
+  auto cursor{snapshot->cursor()};
+  // cursor keeps snapshot alive
+  snapshot.reset();
+  size_t count{0};
+  for (cursor->seekToFirst(); cursor->isValid(); cursor->next()) {
+    EXPECT_EQ(cursor->key(), key_);
+    EXPECT_EQ(cursor->value(), value_);
+    ++count;
+  }
+  EXPECT_EQ(count, 1);
+}
+
+/**
+ * @given database with metrics prefix
+ * @when keys are written and read
+ * @then hits, misses and bytes of prefix are counted
+ */
+TEST_F(LevelDB_Integration_Test, Stats) {
+  Buffer prefixed{Buffer{}.put("/deals/").putUint8(1)};
+  db_->addMetricsPrefix("deals", Buffer{}.put("/deals/"));
+  EXPECT_OUTCOME_TRUE_1(db_->put(prefixed, value_));
+  EXPECT_OUTCOME_TRUE_1(db_->put(key_, value_));
+  EXPECT_OUTCOME_EQ(db_->get(prefixed), value_);
+  EXPECT_FALSE(db_->get(Buffer{9}));
+
+  auto stats{db_->stats()};
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.ops[static_cast<size_t>(LevelDBOp::kPut)].count, 2);
+  EXPECT_EQ(stats.ops[static_cast<size_t>(LevelDBOp::kGet)].count, 2);
+  ASSERT_EQ(stats.prefixes.size(), 2);
+  EXPECT_EQ(stats.prefixes[0].name, "deals");
+  EXPECT_EQ(stats.prefixes[0].writes, 1);
+  EXPECT_EQ(stats.prefixes[0].reads, 1);
+  EXPECT_EQ(stats.prefixes[0].read_bytes, value_.size());
+  EXPECT_EQ(stats.prefixes[1].name, "other");
+  EXPECT_EQ(stats.prefixes[1].writes, 1);
+  EXPECT_EQ(stats.prefixes[1].reads, 1);
+}
@@ -0,0 +1,134 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/mpool/journal.hpp"
+
+#include <gtest/gtest.h>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include "testutil/outcome.hpp"
+#include "testutil/storage/base_fs_test.hpp"
+
+namespace fc::storage::mpool {
+  using crypto::signature::Secp256k1Signature;
+  using vm::message::UnsignedMessage;
+
+  class MpoolJournalTest : public test::BaseFS_Test {
+   public:
+    MpoolJournalTest() : test::BaseFS_Test("fc_mpool_journal_test") {}
+
+    void SetUp() override {
+      BaseFS_Test::SetUp();
+      path = (base_path / "mpool.journal").string();
+    }
+
+    static SignedMessage message(uint64_t from,
+                                 uint64_t nonce,
+                                 int64_t gas_price = 1) {
+      UnsignedMessage msg;
+      msg.from = Address::makeFromId(from);
+      msg.to = Address::makeFromId(100);
+      msg.nonce = nonce;
+      msg.gasPrice = gas_price;
+      return {msg, Secp256k1Signature{}};
+    }
+
+    static JournalRecord added(const SignedMessage &message) {
+      return {message, message.message.from, message.message.nonce};
+    }
+
+    static JournalRecord removed(uint64_t from, uint64_t nonce) {
+      return {boost::none, Address::makeFromId(from), nonce};
+    }
+
+    static std::vector<std::tuple<uint64_t, uint64_t, int64_t>> ids(
+        const std::vector<SignedMessage> &messages) {
+      std::vector<std::tuple<uint64_t, uint64_t, int64_t>> result;
+      for (auto &message : messages) {
+        result.emplace_back(message.message.from.getId(),
+                            message.message.nonce,
+                            message.message.gasPrice.convert_to<int64_t>());
+      }
+      return result;
+    }
+
+    std::string path;
+  };
+
+  /**
+   * @given journal with adds, replacement and removal
+   * @when journal is reopened and replayed
+   * @then messages pending after last record are restored
+   */
+  TEST_F(MpoolJournalTest, Replay) {
+    {
+      EXPECT_OUTCOME_TRUE(journal, MpoolJournal::open(path));
+      EXPECT_OUTCOME_TRUE_1(
+          journal->append({added(message(1, 0)), added(message(1, 1))}));
+      EXPECT_OUTCOME_TRUE_1(
+          journal->append({added(message(2, 0)), removed(1, 0)}));
+      EXPECT_OUTCOME_TRUE_1(journal->append({added(message(1, 1, 5))}));
+    }
+    EXPECT_OUTCOME_TRUE(journal, MpoolJournal::open(path));
+    EXPECT_OUTCOME_TRUE(pending, journal->replay());
+    EXPECT_EQ(ids(pending),
+              (std::vector<std::tuple<uint64_t, uint64_t, int64_t>>{
+                  {1, 1, 5}, {2, 0, 1}}));
+    EXPECT_EQ(journal->records(), 5);
+  }
+
+  /**
+   * @given journal with torn record at end
+   * @when journal is replayed and appended
+   * @then torn record is dropped and appended records are replayed
+   */
+  TEST_F(MpoolJournalTest, TornTail) {
+    {
+      EXPECT_OUTCOME_TRUE(journal, MpoolJournal::open(path));
+      EXPECT_OUTCOME_TRUE_1(
+          journal->append({added(message(1, 0)), added(message(1, 1))}));
+    }
+    boost::filesystem::resize_file(path,
+                                   boost::filesystem::file_size(path) - 3);
+    {
+      EXPECT_OUTCOME_TRUE(journal, MpoolJournal::open(path));
+      EXPECT_OUTCOME_TRUE(pending, journal->replay());
+      EXPECT_EQ(ids(pending),
+                (std::vector<std::tuple<uint64_t, uint64_t, int64_t>>{
+                    {1, 0, 1}}));
+      EXPECT_OUTCOME_TRUE_1(journal->append({added(message(2, 0))}));
+    }
+    EXPECT_OUTCOME_TRUE(journal, MpoolJournal::open(path));
+    EXPECT_OUTCOME_TRUE(pending, journal->replay());
+    EXPECT_EQ(ids(pending),
+              (std::vector<std::tuple<uint64_t, uint64_t, int64_t>>{
+                  {1, 0, 1}, {2, 0, 1}}));
+  }
+
+  /**
+   * @given journal with removed messages
+   * @when journal is compacted and appended
+   * @then journal has only pending and appended records
+   */
+  TEST_F(MpoolJournalTest, Compact) {
+    EXPECT_OUTCOME_TRUE(journal, MpoolJournal::open(path));
+    EXPECT_OUTCOME_TRUE_1(journal->append(
+        {added(message(1, 0)), added(message(1, 1)), removed(1, 0)}));
+    EXPECT_OUTCOME_TRUE(pending, journal->replay());
+    auto size{boost::filesystem::file_size(path)};
+    EXPECT_OUTCOME_TRUE_1(journal->compact(pending));
+    EXPECT_EQ(journal->records(), 1);
+    EXPECT_LT(boost::filesystem::file_size(path), size);
+    EXPECT_OUTCOME_TRUE_1(journal->append({added(message(3, 0))}));
+
+    EXPECT_OUTCOME_TRUE(reopened, MpoolJournal::open(path));
+    EXPECT_OUTCOME_TRUE(restored, reopened->replay());
+    EXPECT_EQ(ids(restored),
+              (std::vector<std::tuple<uint64_t, uint64_t, int64_t>>{
+                  {1, 1, 1}, {3, 0, 1}}));
+    EXPECT_EQ(reopened->records(), 2);
+  }
+}  // namespace fc::storage::mpool
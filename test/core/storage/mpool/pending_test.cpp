@@ -0,0 +1,151 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/mpool/pending.hpp"
+
+#include <gtest/gtest.h>
+#include <boost/optional/optional_io.hpp>
+
+#include "testutil/outcome.hpp"
+
+namespace fc::storage::mpool {
+  using crypto::signature::Secp256k1Signature;
+  using vm::message::UnsignedMessage;
+
+  class MpoolPendingTest : public ::testing::Test {
+   public:
+    SignedMessage message(uint64_t from, uint64_t nonce, int64_t gas_price) {
+      UnsignedMessage msg;
+      msg.from = Address::makeFromId(from);
+      msg.to = Address::makeFromId(100);
+      msg.nonce = nonce;
+      msg.gasPrice = gas_price;
+      msg.gasLimit = 10;
+      return {msg, Secp256k1Signature{}};
+    }
+
+    outcome::result<std::vector<SignedMessage>> select(
+        SelectLimits limits = {100, 1000}) {
+      return pending.select(
+          [&](auto &address) -> outcome::result<ActorView> {
+            auto it{actors.find(address)};
+            if (it != actors.end()) {
+              return it->second;
+            }
+            return ActorView{0, 1000};
+          },
+          limits,
+          [](auto &) { return true; });
+    }
+
+    std::vector<std::pair<uint64_t, uint64_t>> ids(
+        const std::vector<SignedMessage> &messages) {
+      std::vector<std::pair<uint64_t, uint64_t>> result;
+      for (auto &message : messages) {
+        result.emplace_back(message.message.from.getId(),
+                            message.message.nonce);
+      }
+      return result;
+    }
+
+    PendingMessages pending;
+    std::map<Address, ActorView> actors;
+  };
+
+  /**
+   * @given chains of two senders with interleaving gas prices
+   * @when select messages
+   * @then messages are taken in gas price order keeping nonce order
+   */
+  TEST_F(MpoolPendingTest, SelectByGasPrice) {
+    pending.add(message(1, 0, 5));
+    pending.add(message(1, 1, 1));
+    pending.add(message(2, 0, 3));
+    pending.add(message(2, 1, 2));
+    EXPECT_EQ(pending.size(), 4);
+    EXPECT_OUTCOME_TRUE(selected, select());
+    std::vector<std::pair<uint64_t, uint64_t>> expected{
+        {1, 0}, {2, 0}, {2, 1}, {1, 1}};
+    EXPECT_EQ(ids(selected), expected);
+  }
+
+  /**
+   * @given chain with nonce gap and chain starting below actor nonce
+   * @when select messages
+   * @then messages after gap and applied messages are not selected
+   */
+  TEST_F(MpoolPendingTest, SelectContiguous) {
+    pending.add(message(1, 0, 1));
+    pending.add(message(1, 2, 1));
+    pending.add(message(2, 3, 1));
+    pending.add(message(2, 4, 1));
+    actors[Address::makeFromId(2)] = {4, 1000};
+    EXPECT_OUTCOME_TRUE(selected, select());
+    std::vector<std::pair<uint64_t, uint64_t>> expected{{1, 0}, {2, 4}};
+    EXPECT_EQ(ids(selected), expected);
+  }
+
+  /**
+   * @given pending messages
+   * @when select with gas limit @and with balance not covering all messages
+   * @then selection stops at limits
+   */
+  TEST_F(MpoolPendingTest, SelectLimits) {
+    for (auto nonce = 0; nonce < 5; ++nonce) {
+      pending.add(message(1, nonce, 2));
+    }
+    EXPECT_OUTCOME_TRUE(by_gas, select({100, 35}));
+    EXPECT_EQ(by_gas.size(), 3);
+    EXPECT_OUTCOME_TRUE(by_count, select({2, 1000}));
+    EXPECT_EQ(by_count.size(), 2);
+    actors[Address::makeFromId(1)] = {0, 40};
+    EXPECT_OUTCOME_TRUE(by_balance, select());
+    EXPECT_EQ(by_balance.size(), 2);
+  }
+
+  /**
+   * @given pending messages
+   * @when replace chain head with higher gas price @and remove it
+   * @then selection order follows updated chain heads
+   */
+  TEST_F(MpoolPendingTest, Update) {
+    pending.add(message(1, 0, 1));
+    pending.add(message(2, 0, 2));
+    pending.add(message(1, 0, 3));
+    EXPECT_EQ(pending.size(), 2);
+    EXPECT_OUTCOME_TRUE(replaced, select());
+    EXPECT_EQ(replaced[0].message.from, Address::makeFromId(1));
+    EXPECT_EQ(pending.nextNonce(Address::makeFromId(1)), uint64_t{1});
+
+    EXPECT_TRUE(pending.remove(Address::makeFromId(1), 0));
+    EXPECT_FALSE(pending.remove(Address::makeFromId(1), 0));
+    EXPECT_FALSE(pending.nextNonce(Address::makeFromId(1)));
+    EXPECT_OUTCOME_TRUE(removed, select());
+    std::vector<std::pair<uint64_t, uint64_t>> expected{{2, 0}};
+    EXPECT_EQ(ids(removed), expected);
+  }
+
+  /**
+   * @given chain of sender
+   * @when remove messages below nonce
+   * @then chain prefix is removed and rest of chain is selected
+   */
+  TEST_F(MpoolPendingTest, RemoveBelow) {
+    pending.add(message(1, 0, 1));
+    pending.add(message(1, 1, 1));
+    pending.add(message(1, 2, 1));
+    EXPECT_EQ(ids(pending.removeBelow(Address::makeFromId(1), 2)),
+              (std::vector<std::pair<uint64_t, uint64_t>>{{1, 0}, {1, 1}}));
+    EXPECT_TRUE(pending.removeBelow(Address::makeFromId(1), 2).empty());
+    EXPECT_EQ(pending.size(), 1);
+    actors[Address::makeFromId(1)] = {2, 1000};
+    EXPECT_OUTCOME_TRUE(selected, select());
+    std::vector<std::pair<uint64_t, uint64_t>> expected{{1, 2}};
+    EXPECT_EQ(ids(selected), expected);
+
+    EXPECT_EQ(pending.removeBelow(Address::makeFromId(1), 3).size(), 1);
+    EXPECT_FALSE(pending.nextNonce(Address::makeFromId(1)));
+  }
+}  // namespace fc::storage::mpool
@@ -81,3 +81,56 @@ TEST_F(PieceStorageTest, AddBlockLocationSuccess) {
   EXPECT_EQ(payload_info_B.piece_block_locations.front().block_location,
             location_B);
 }
+
+/**
+ * @given payload block stored in two pieces and piece with two deals
+ * @when locations and deals are added separately
+ * @then all of them are found by payload and piece cid
+ */
+TEST_F(PieceStorageTest, IndexSeveralRecords) {
+  CID other_piece_cid{"010001020004"_cid};
+  EXPECT_OUTCOME_TRUE_1(piece_storage->addPayloadLocations(
+      piece_cid, {{payload_cid_A, location_A}}));
+  EXPECT_OUTCOME_TRUE(cached, piece_storage->getPayloadInfo(payload_cid_A));
+  EXPECT_EQ(cached.piece_block_locations.size(), 1);
+  EXPECT_OUTCOME_TRUE_1(piece_storage->addPayloadLocations(
+      other_piece_cid, {{payload_cid_A, location_B}}));
+  EXPECT_OUTCOME_TRUE(payload_info,
+                      piece_storage->getPayloadInfo(payload_cid_A));
+  EXPECT_EQ(payload_info.piece_block_locations.size(), 2);
+  EXPECT_OUTCOME_ERROR(PieceStorageError::kPayloadNotFound,
+                       piece_storage->getPayloadInfo(payload_cid_B));
+
+  DealInfo other_deal{.deal_id = 5, .sector_id = 6, .offset = 7, .length = 8};
+  EXPECT_OUTCOME_TRUE_1(piece_storage->addDealForPiece(piece_cid, deal_info))
+  EXPECT_OUTCOME_TRUE_1(piece_storage->addDealForPiece(piece_cid, other_deal))
+  EXPECT_OUTCOME_TRUE(received_info, piece_storage->getPieceInfo(piece_cid))
+  EXPECT_EQ(received_info.deals,
+            (std::vector<DealInfo>{deal_info, other_deal}));
+  EXPECT_OUTCOME_TRUE(
+      from_payload,
+      piece_storage->getPieceInfoFromCid(payload_cid_A, piece_cid));
+  EXPECT_EQ(from_payload, received_info);
+}
+
+/**
+ * @given payload stored in piece with deal
+ * @when storage is opened again over same backend
+ * @then payload is found @and payloads not held are not @and each added
+ * record changes generation
+ */
+TEST_F(PieceStorageTest, PayloadFilter) {
+  EXPECT_EQ(piece_storage->generation(), 0);
+  EXPECT_OUTCOME_TRUE_1(piece_storage->addPayloadLocations(
+      piece_cid, {{payload_cid_A, location_A}}));
+  EXPECT_OUTCOME_TRUE_1(piece_storage->addDealForPiece(piece_cid, deal_info))
+  EXPECT_EQ(piece_storage->generation(), 2);
+
+  PieceStorageImpl reopened{storage_backend};
+  EXPECT_TRUE(reopened.mayHavePayload(payload_cid_A));
+  EXPECT_OUTCOME_EQ(reopened.hasPieceInfo(payload_cid_A, boost::none), true);
+  EXPECT_OUTCOME_EQ(reopened.hasPieceInfo(payload_cid_B, boost::none), false);
+  EXPECT_OUTCOME_ERROR(
+      PieceStorageError::kPayloadNotFound,
+      reopened.getPieceInfoFromCid(payload_cid_B, boost::none));
+}
@@ -166,3 +166,41 @@ TEST_F(FilesSystemRepositoryTest, InvalidVersion) {
                        FileSystemRepository::create(
                            base_path.string(), api_address, leveldb_options));
 }
+
+/**
+ * @given Repository with leveldb blocks
+ * @when Try open it with mmap blocks backend
+ * @then Error kBackendMismatch returned
+ */
+TEST_F(FilesSystemRepositoryTest, BackendMismatch) {
+  EXPECT_OUTCOME_TRUE_1(FileSystemRepository::create(
+      base_path.string(), api_address, leveldb_options));
+
+  std::ofstream config_file(
+      (base_path / FileSystemRepository::kConfigFilename).string());
+  config_file << R"({"storage": {"blocks": {"backend": "mmap"}}})";
+  config_file.close();
+
+  EXPECT_OUTCOME_ERROR(RepositoryError::kBackendMismatch,
+                       FileSystemRepository::create(
+                           base_path.string(), api_address, leveldb_options));
+}
+
+/**
+ * @given Empty directory
+ * @when Repository is created with leveldb blocks
+ * @then Leveldb stores of storage config are opened, blocks store is one of
+ * them
+ */
+TEST_F(FilesSystemRepositoryTest, Stores) {
+  EXPECT_OUTCOME_TRUE(repository,
+                      FileSystemRepository::create(
+                          base_path.string(), api_address, leveldb_options));
+  auto stores{
+      std::static_pointer_cast<FileSystemRepository>(repository)->getStores()};
+  ASSERT_TRUE(stores);
+  EXPECT_TRUE(stores->blocks);
+  EXPECT_TRUE(stores->indexes);
+  EXPECT_TRUE(stores->market);
+  EXPECT_TRUE(exists(FileSystemRepository::kStoresDirectory));
+}
@@ -24,6 +24,28 @@ TEST_P(UnixfsTest, MatchGo) {
       cid);
 }
 
+/**
+ * @given file data
+ * @when import file with fixed chunker in small batches
+ * @then root is same as of whole data wrapped at once
+ */
+TEST_P(UnixfsTest, ImportFile) {
+  auto &[data, chunk_size, max_links, cid_str] = GetParam();
+  fc::storage::ipfs::InMemoryDatastore ipld;
+  EXPECT_OUTCOME_TRUE(cid, fc::CID::fromString(cid_str));
+  std::unique_ptr<FILE, decltype(&fclose)> file{tmpfile(), fclose};
+  ASSERT_EQ(fwrite(data.data(), 1, data.size(), file.get()), data.size());
+  fflush(file.get());
+  rewind(file.get());
+  fc::storage::unixfs::ImportConfig config;
+  config.chunk_size = chunk_size;
+  config.max_links = max_links;
+  config.batch_chunks = 2;
+  config.threads = 2;
+  EXPECT_OUTCOME_EQ(
+      fc::storage::unixfs::importFile(ipld, fileno(file.get()), config), cid);
+}
+
 INSTANTIATE_TEST_CASE_P(
     UnixfsTestCases,
     UnixfsTest,
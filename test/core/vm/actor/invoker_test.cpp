@@ -31,6 +31,10 @@ TEST(InvokerTest, InvokeCron) {
   EXPECT_OUTCOME_ERROR(
       VMExitCode::kSysErrInvalidMethod,
       invoker.invoke({kCronCodeCid}, runtime, MethodNumber{1000}, {}));
+  // below largest exported number, but not exported
+  EXPECT_OUTCOME_ERROR(
+      VMExitCode::kSysErrInvalidMethod,
+      invoker.invoke({kCronCodeCid}, runtime, MethodNumber{0}, {}));
   EXPECT_CALL(runtime, getImmediateCaller())
       .WillOnce(testing::Return(kInitAddress));
   EXPECT_OUTCOME_ERROR(
@@ -13,8 +13,11 @@
 #include "vm/interpreter/impl/interpreter_impl.hpp"
 
 using fc::primitives::tipset::Tipset;
+using fc::vm::interpreter::InterpreterImpl;
+using fc::vm::interpreter::ParallelExecutor;
 
-TEST(ChainsTest, StoreDeal) {
+/// Interprets recorded chain, compares results with recorded parent states
+void checkChain(const InterpreterImpl &interpreter) {
   auto ipld{std::make_shared<fc::storage::ipfs::InMemoryDatastore>()};
   auto car{readFile(resourcePath("chain-store-deal.car"))};
   EXPECT_OUTCOME_TRUE(head, fc::storage::car::loadCar(*ipld, car));
@@ -36,8 +39,17 @@ TEST(ChainsTest, StoreDeal) {
         << "state differs at " << ts.height - 1;
     EXPECT_EQ(last.second, ts.getParentMessageReceipts())
         << "receipts differ at " << ts.height - 1;
-    EXPECT_OUTCOME_TRUE(
-        result, fc::vm::interpreter::InterpreterImpl{}.interpret(ipld, ts));
+    EXPECT_OUTCOME_TRUE(result, interpreter.interpret(ipld, ts));
     last = {result.state_root, result.message_receipts};
   }
 }
+
+TEST(ChainsTest, StoreDeal) {
+  checkChain(InterpreterImpl{});
+}
+
+/// Speculative parallel execution results in same states as serial
+TEST(ChainsTest, StoreDealParallel) {
+  checkChain(
+      InterpreterImpl{{}, nullptr, std::make_shared<ParallelExecutor>(4)});
+}
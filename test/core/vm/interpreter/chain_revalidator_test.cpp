@@ -0,0 +1,83 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/interpreter/impl/chain_revalidator.hpp"
+
+#include <gtest/gtest.h>
+
+#include "primitives/cid/cid_of_cbor.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/literals.hpp"
+#include "testutil/mocks/vm/interpreter/interpreter_mock.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::primitives::block::BlockHeader;
+using fc::primitives::tipset::Tipset;
+using fc::vm::interpreter::InterpreterMock;
+using fc::vm::interpreter::Result;
+using fc::vm::interpreter::revalidateChain;
+using testing::_;
+
+struct ChainRevalidatorTest : testing::Test {
+  /// State computed by executing tipset at height
+  static Result result(uint64_t height) {
+    return {fc::primitives::cid::getCidOfCbor(height).value(),
+            "010001020001"_cid};
+  }
+
+  /// Appends tipset at height, claiming parent result
+  Tipset child(const Tipset &parent, uint64_t height, Result claimed) {
+    BlockHeader block;
+    block.miner = fc::primitives::address::Address::makeFromId(1);
+    block.parents = parent.cids;
+    block.height = height;
+    block.parent_state_root = claimed.state_root;
+    block.parent_message_receipts = claimed.message_receipts;
+    block.messages = "010001020002"_cid;
+    EXPECT_OUTCOME_TRUE(cid, ipld->setCbor(block));
+    return Tipset::create({block}, {cid}).value();
+  }
+
+  std::shared_ptr<fc::storage::ipfs::InMemoryDatastore> ipld{
+      std::make_shared<fc::storage::ipfs::InMemoryDatastore>()};
+  std::shared_ptr<InterpreterMock> interpreter{
+      std::make_shared<InterpreterMock>()};
+  boost::asio::thread_pool pool{4};
+};
+
+/**
+ * @given chain with null round and wrong state claimed by one header
+ * @when chain is revalidated in chunks
+ * @then tipsets of range are executed, mismatching one is reported
+ */
+TEST_F(ChainRevalidatorTest, Mismatch) {
+  auto ts{child({}, 0, result(0))};
+  for (uint64_t height{1}; height < 12; ++height) {
+    if (height == 5) {
+      continue;
+    }
+    auto claimed{result(ts.height)};
+    if (height == 9) {
+      claimed.state_root = "010001020003"_cid;
+    }
+    ts = child(ts, height, claimed);
+  }
+  std::mutex mutex;
+  std::set<uint64_t> executed;
+  EXPECT_CALL(*interpreter, interpret(_, _))
+      .WillRepeatedly(testing::Invoke([&](auto &, const Tipset &ts) {
+        std::lock_guard lock{mutex};
+        executed.insert(ts.height);
+        return fc::outcome::success(result(ts.height));
+      }));
+
+  EXPECT_OUTCOME_TRUE(mismatches,
+                      revalidateChain(ipld, interpreter, ts, 2, 3, pool));
+  EXPECT_EQ(executed, (std::set<uint64_t>{2, 3, 4, 6, 7, 8, 9, 10}));
+  ASSERT_EQ(mismatches.size(), 1);
+  EXPECT_EQ(mismatches[0].height, 8);
+  EXPECT_EQ(mismatches[0].computed.state_root, result(8).state_root);
+  EXPECT_EQ(mismatches[0].claimed.state_root, "010001020003"_cid);
+}
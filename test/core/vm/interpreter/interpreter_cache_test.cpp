@@ -0,0 +1,94 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/interpreter/impl/interpreter_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/in_memory/in_memory_storage.hpp"
+#include "testutil/literals.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::common::Hash256;
+using fc::primitives::tipset::TipsetKey;
+using fc::storage::InMemoryStorage;
+using fc::vm::interpreter::InterpreterCache;
+using fc::vm::interpreter::Result;
+
+struct InterpreterCacheTest : testing::Test {
+  std::shared_ptr<InMemoryStorage> store{
+      std::make_shared<InMemoryStorage>()};
+  InterpreterCache cache{store};
+  TipsetKey canonical{"010001020001"_cid};
+  TipsetKey side{"010001020002"_cid};
+  TipsetKey recent{"010001020003"_cid};
+  Result result{"010001020004"_cid, "010001020005"_cid};
+};
+
+/**
+ * @given results of tipsets put to cache
+ * @when get them from cache and from new cache on same store
+ * @then stored results are returned, unknown tipset has none
+ */
+TEST_F(InterpreterCacheTest, PutGet) {
+  EXPECT_OUTCOME_TRUE(before, cache.tryGet(canonical));
+  EXPECT_FALSE(before);
+  EXPECT_OUTCOME_TRUE_1(cache.put(canonical, 1, result));
+  EXPECT_OUTCOME_TRUE(cached, cache.tryGet(canonical));
+  ASSERT_TRUE(cached);
+  EXPECT_EQ(cached->state_root, result.state_root);
+
+  InterpreterCache reloaded{store};
+  EXPECT_OUTCOME_TRUE(stored, reloaded.tryGet(canonical));
+  ASSERT_TRUE(stored);
+  EXPECT_EQ(stored->message_receipts, result.message_receipts);
+  EXPECT_OUTCOME_TRUE(unknown, reloaded.tryGet(side));
+  EXPECT_FALSE(unknown);
+}
+
+/**
+ * @given results of canonical and side tipsets below height and recent one
+ * @when prune below height keeping canonical tipset
+ * @then only side tipset result is removed
+ */
+TEST_F(InterpreterCacheTest, Prune) {
+  EXPECT_OUTCOME_TRUE_1(cache.put(canonical, 1, result));
+  EXPECT_OUTCOME_TRUE_1(cache.put(side, 1, result));
+  EXPECT_OUTCOME_TRUE_1(cache.put(recent, 10, result));
+  auto keep{InterpreterCache::hash(canonical)};
+  EXPECT_OUTCOME_EQ(
+      cache.prune(5, [&](auto, const Hash256 &hash) { return hash == keep; }),
+      size_t{1});
+  EXPECT_OUTCOME_TRUE(pruned, cache.tryGet(side));
+  EXPECT_FALSE(pruned);
+  EXPECT_OUTCOME_TRUE(canonical_result, cache.tryGet(canonical));
+  EXPECT_TRUE(canonical_result);
+  EXPECT_OUTCOME_TRUE(recent_result, cache.tryGet(recent));
+  EXPECT_TRUE(recent_result);
+}
+
+/**
+ * @given result stored under concatenated cids by earlier version
+ * @when migrate it
+ * @then result moves to hashed key and old key is removed
+ */
+TEST_F(InterpreterCacheTest, MigrateLegacy) {
+  fc::common::Buffer legacy_key{canonical.cids[0].toBytes().value()};
+  EXPECT_OUTCOME_TRUE_1(
+      store->put(legacy_key, fc::codec::cbor::encode(result).value()));
+  EXPECT_OUTCOME_TRUE(before, cache.tryGet(canonical));
+  EXPECT_FALSE(before);
+  EXPECT_OUTCOME_TRUE(migrated, cache.migrate(canonical, 1));
+  ASSERT_TRUE(migrated);
+  EXPECT_EQ(migrated->state_root, result.state_root);
+  EXPECT_FALSE(store->contains(legacy_key));
+
+  InterpreterCache reloaded{store};
+  EXPECT_OUTCOME_TRUE(stored, reloaded.tryGet(canonical));
+  ASSERT_TRUE(stored);
+  EXPECT_EQ(stored->message_receipts, result.message_receipts);
+  EXPECT_OUTCOME_TRUE(again, reloaded.migrate(canonical, 1));
+  EXPECT_FALSE(again);
+}
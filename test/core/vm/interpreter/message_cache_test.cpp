@@ -0,0 +1,76 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/interpreter/impl/message_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include "testutil/literals.hpp"
+
+using fc::CID;
+using fc::primitives::ChainEpoch;
+using fc::primitives::tipset::TipsetKey;
+using fc::vm::interpreter::CachedBlockMessages;
+using fc::vm::interpreter::ExecutedMessages;
+using fc::vm::interpreter::MessageCache;
+
+struct MessageCacheTest : testing::Test {
+  static std::shared_ptr<ExecutedMessages> executed(ChainEpoch height) {
+    auto messages{std::make_shared<ExecutedMessages>()};
+    messages->height = height;
+    return messages;
+  }
+
+  static std::shared_ptr<CachedBlockMessages> block(ChainEpoch height) {
+    auto messages{std::make_shared<CachedBlockMessages>()};
+    messages->height = height;
+    return messages;
+  }
+
+  MessageCache cache{10};
+  TipsetKey old{"010001020001"_cid};
+  TipsetKey recent{"010001020002"_cid};
+  CID old_meta{"010001020003"_cid};
+  CID recent_meta{"010001020004"_cid};
+};
+
+/**
+ * @given executed messages and block messages put to cache
+ * @when get them by tipset and meta cid
+ * @then same values are returned, unknown keys have none
+ */
+TEST_F(MessageCacheTest, PutGet) {
+  EXPECT_FALSE(cache.executed(recent));
+  EXPECT_FALSE(cache.block(recent_meta));
+  auto messages{executed(5)};
+  auto block_messages{block(5)};
+  cache.putExecuted(recent, messages);
+  cache.putBlock(recent_meta, block_messages);
+  EXPECT_EQ(cache.executed(recent), messages);
+  EXPECT_EQ(cache.block(recent_meta), block_messages);
+  EXPECT_FALSE(cache.executed(old));
+  EXPECT_FALSE(cache.block(old_meta));
+}
+
+/**
+ * @given entries at height 1 and cache of 10 epochs
+ * @when entries at height 10 and 11 are put
+ * @then entries at height 1 are kept until height 11, puts below window are
+ * ignored
+ */
+TEST_F(MessageCacheTest, EvictsOldEpochs) {
+  cache.putExecuted(old, executed(1));
+  cache.putBlock(old_meta, block(1));
+  cache.putExecuted(recent, executed(10));
+  EXPECT_TRUE(cache.executed(old));
+  EXPECT_TRUE(cache.block(old_meta));
+  cache.putBlock(recent_meta, block(11));
+  EXPECT_FALSE(cache.executed(old));
+  EXPECT_FALSE(cache.block(old_meta));
+  EXPECT_TRUE(cache.executed(recent));
+  EXPECT_TRUE(cache.block(recent_meta));
+  cache.putExecuted(old, executed(1));
+  EXPECT_FALSE(cache.executed(old));
+}
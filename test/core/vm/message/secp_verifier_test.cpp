@@ -0,0 +1,77 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/message/impl/secp_verifier.hpp"
+
+#include <gtest/gtest.h>
+
+#include "crypto/secp256k1/impl/secp256k1_sha256_provider_impl.hpp"
+#include "primitives/cid/cid_of_cbor.hpp"
+#include "testutil/outcome.hpp"
+
+namespace fc::vm::message {
+  using crypto::secp256k1::Secp256k1Sha256ProviderImpl;
+  using primitives::cid::getCidOfCbor;
+
+  class SecpVerifierTest : public ::testing::Test {
+   public:
+    void SetUp() override {
+      auto key_pair{secp->generate().value()};
+      from = Address::makeSecp256k1(key_pair.public_key);
+      message.message.from = from;
+      message.message.to = Address::makeFromId(1);
+      auto bytes{getCidOfCbor(message.message).value().toBytes().value()};
+      message.signature = secp->sign(bytes, key_pair.private_key).value();
+    }
+
+    std::shared_ptr<Secp256k1ProviderDefault> secp{
+        std::make_shared<Secp256k1Sha256ProviderImpl>()};
+    std::shared_ptr<boost::asio::io_context> io{
+        std::make_shared<boost::asio::io_context>()};
+    std::shared_ptr<boost::asio::thread_pool> pool{
+        std::make_shared<boost::asio::thread_pool>(1)};
+    std::shared_ptr<SecpVerifier> verifier{
+        std::make_shared<SecpVerifier>(secp, io, pool)};
+    Address from;
+    SignedMessage message;
+  };
+
+  /**
+   * @given message signed by secp key
+   * @when verify it twice @and verify with other key address
+   * @then signature is valid for sender, second check is found in cache
+   */
+  TEST_F(SecpVerifierTest, Cached) {
+    EXPECT_OUTCOME_EQ(verifier->verify(message, from), true);
+    EXPECT_EQ(verifier->hits(), 0);
+    EXPECT_OUTCOME_EQ(verifier->verify(message, from), true);
+    EXPECT_EQ(verifier->hits(), 1);
+    auto other{Address::makeSecp256k1(secp->generate().value().public_key)};
+    EXPECT_OUTCOME_EQ(verifier->verify(message, other), false);
+    EXPECT_OUTCOME_EQ(verifier->verify(message, Address::makeFromId(2)), false);
+  }
+
+  /**
+   * @given message signed by secp key @and message with changed field
+   * @when verify on pool
+   * @then callbacks are called on io with valid and invalid results
+   */
+  TEST_F(SecpVerifierTest, Async) {
+    auto changed{message};
+    changed.message.nonce = 1;
+    std::vector<bool> results;
+    for (auto &signed_message : {message, changed}) {
+      verifier->verifyAsync(signed_message, [&](auto valid) {
+        EXPECT_OUTCOME_TRUE(ok, valid);
+        results.push_back(ok);
+      });
+    }
+    while (results.size() < 2) {
+      io->run_for(std::chrono::milliseconds{10});
+      io->restart();
+    }
+    EXPECT_EQ(results, (std::vector<bool>{true, false}));
+  }
+}  // namespace fc::vm::message
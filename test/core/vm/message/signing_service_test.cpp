@@ -0,0 +1,84 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/message/impl/signing_service.hpp"
+
+#include <gtest/gtest.h>
+
+#include "crypto/bls/impl/bls_provider_impl.hpp"
+#include "crypto/secp256k1/impl/secp256k1_sha256_provider_impl.hpp"
+#include "storage/keystore/impl/in_memory/in_memory_keystore.hpp"
+#include "testutil/outcome.hpp"
+
+namespace fc::vm::message {
+  using crypto::bls::BlsProviderImpl;
+  using crypto::secp256k1::Secp256k1ProviderDefault;
+  using crypto::secp256k1::Secp256k1Sha256ProviderImpl;
+  using storage::keystore::InMemoryKeyStore;
+
+  class SigningServiceTest : public ::testing::Test {
+   public:
+    void SetUp() override {
+      for (auto &from : senders) {
+        auto key_pair{secp->generate().value()};
+        from = Address::makeSecp256k1(key_pair.public_key);
+        EXPECT_OUTCOME_TRUE_1(keystore->put(from, key_pair.private_key));
+      }
+    }
+
+    std::shared_ptr<Secp256k1ProviderDefault> secp{
+        std::make_shared<Secp256k1Sha256ProviderImpl>()};
+    std::shared_ptr<KeyStore> keystore{std::make_shared<InMemoryKeyStore>(
+        std::make_shared<BlsProviderImpl>(), secp)};
+    SigningService service{keystore,
+                           std::make_shared<boost::asio::thread_pool>(2)};
+    std::array<Address, 2> senders;
+  };
+
+  /**
+   * @given messages of two senders
+   * @when sign them in batch
+   * @then nonces of each sender are consecutive from its next nonce @and
+   * signatures are valid
+   */
+  TEST_F(SigningServiceTest, SignMessages) {
+    std::vector<UnsignedMessage> messages;
+    for (auto i : {0, 1, 0, 1, 0}) {
+      auto &message{messages.emplace_back()};
+      message.from = senders[i];
+      message.to = Address::makeFromId(1);
+    }
+    EXPECT_OUTCOME_TRUE(
+        signed_messages,
+        service.signMessages(
+            messages, [&](auto &from) -> outcome::result<uint64_t> {
+              return from == senders[0] ? 10 : 20;
+            }));
+    std::vector<uint64_t> nonces;
+    MessageSignerImpl signer{keystore};
+    for (auto &message : signed_messages) {
+      nonces.push_back(message.message.nonce);
+      EXPECT_OUTCOME_TRUE_1(signer.verify(message.message.from, message));
+    }
+    EXPECT_EQ(nonces, (std::vector<uint64_t>{10, 20, 11, 21, 12}));
+  }
+
+  /**
+   * @given requests of known and unknown addresses
+   * @when sign them in batch
+   * @then results are in order and only unknown address fails
+   */
+  TEST_F(SigningServiceTest, SignBatch) {
+    Buffer data{1, 2, 3};
+    auto results{service.signBatch({{senders[0], data},
+                                     {Address::makeFromId(5), data},
+                                     {senders[1], data}})};
+    ASSERT_EQ(results.size(), 3);
+    EXPECT_OUTCOME_TRUE(signature, results[0]);
+    EXPECT_OUTCOME_EQ(keystore->verify(senders[0], data, signature), true);
+    EXPECT_FALSE(results[1]);
+    EXPECT_TRUE(results[2]);
+  }
+}  // namespace fc::vm::message
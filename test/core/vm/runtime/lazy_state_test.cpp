@@ -0,0 +1,72 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/runtime/lazy_state.hpp"
+
+#include <gtest/gtest.h>
+
+#include "primitives/rle_bitset/rle_bitset.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+namespace fc::vm::runtime {
+  using primitives::RleBitset;
+  using storage::ipfs::InMemoryDatastore;
+
+  struct TestState {
+    uint64_t counter{};
+    std::string name;
+    RleBitset sectors;
+  };
+  CBOR_TUPLE(TestState, counter, name, sectors)
+
+  struct LazyStateTest : ::testing::Test {
+    IpldPtr ipld{std::make_shared<InMemoryDatastore>()};
+    TestState state{1, "miner", {2, 3, 5}};
+    CID cid{ipld->setCbor(state).value()};
+  };
+
+  /**
+   * @given stored state
+   * @when read one field
+   * @then only that field is decoded
+   */
+  TEST_F(LazyStateTest, ReadsRequestedFields) {
+    EXPECT_OUTCOME_TRUE(lazy, LazyState<TestState>::load(ipld, cid));
+    EXPECT_OUTCOME_TRUE_1(lazy.read(&TestState::name));
+    EXPECT_EQ(lazy->name, "miner");
+    EXPECT_EQ(lazy->counter, 0);
+    EXPECT_TRUE(lazy->sectors.empty());
+  }
+
+  /**
+   * @given stored state
+   * @when flush without changes
+   * @then state is not written again and cid stays same
+   */
+  TEST_F(LazyStateTest, FlushUnchanged) {
+    EXPECT_OUTCOME_TRUE(lazy, LazyState<TestState>::load(ipld, cid));
+    EXPECT_OUTCOME_TRUE_1(lazy.read(&TestState::counter, &TestState::sectors));
+    EXPECT_OUTCOME_EQ(lazy.flush(), cid);
+  }
+
+  /**
+   * @given stored state
+   * @when change one field and flush
+   * @then state equals fully encoded state with that change
+   */
+  TEST_F(LazyStateTest, FlushChanged) {
+    EXPECT_OUTCOME_TRUE(lazy, LazyState<TestState>::load(ipld, cid));
+    EXPECT_OUTCOME_TRUE_1(lazy.change(&TestState::counter));
+    ++lazy->counter;
+    EXPECT_OUTCOME_TRUE(new_cid, lazy.flush());
+
+    ++state.counter;
+    EXPECT_OUTCOME_EQ(ipld->setCbor(state), new_cid);
+    EXPECT_OUTCOME_TRUE(stored, ipld->getCbor<TestState>(new_cid));
+    EXPECT_EQ(stored.name, "miner");
+    EXPECT_EQ(stored.sectors, state.sectors);
+  }
+}  // namespace fc::vm::runtime
@@ -0,0 +1,47 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/runtime/profiler.hpp"
+
+#include <gtest/gtest.h>
+
+namespace fc::vm::runtime {
+  using actor::kAccountCodeCid;
+  using actor::kStorageMinerCodeCid;
+  using std::chrono::nanoseconds;
+
+  /**
+   * @given profiler
+   * @when add invocations of two methods, one twice
+   * @then stats are summed per code and method
+   */
+  TEST(Profiler, SumsPerMethod) {
+    Profiler profiler;
+    profiler.add(kStorageMinerCodeCid, 5, nanoseconds{10}, 100, {1, 10, 2, 20});
+    profiler.add(kStorageMinerCodeCid, 5, nanoseconds{30}, 50, {3, 30, 0, 0});
+    profiler.add(kAccountCodeCid, 1, nanoseconds{5}, 7, {});
+
+    auto profiles{profiler.snapshot()};
+    ASSERT_EQ(profiles.size(), 2);
+    for (auto &profile : profiles) {
+      if (profile.code == kStorageMinerCodeCid) {
+        EXPECT_EQ(profile.method, MethodNumber{5});
+        EXPECT_EQ(profile.stats.calls, 2);
+        EXPECT_EQ(profile.stats.time, nanoseconds{40});
+        EXPECT_EQ(profile.stats.gas, 150);
+        EXPECT_EQ(profile.stats.ipld.gets, 4);
+        EXPECT_EQ(profile.stats.ipld.get_bytes, 40);
+        EXPECT_EQ(profile.stats.ipld.puts, 2);
+        EXPECT_EQ(profile.stats.ipld.put_bytes, 20);
+      } else {
+        EXPECT_EQ(profile.code, kAccountCodeCid);
+        EXPECT_EQ(profile.stats.calls, 1);
+      }
+    }
+
+    profiler.reset();
+    EXPECT_TRUE(profiler.snapshot().empty());
+  }
+}  // namespace fc::vm::runtime
@@ -0,0 +1,91 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vm/runtime/trace.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+#include "vm/runtime/env.hpp"
+#include "vm/runtime/gas_cost.hpp"
+#include "vm/runtime/runtime_types.hpp"
+
+using fc::codec::cbor::kDefaultT;
+using fc::primitives::address::Address;
+using fc::primitives::block::BlockHeader;
+using fc::primitives::tipset::Tipset;
+using fc::storage::ipfs::InMemoryDatastore;
+using fc::vm::VMExitCode;
+using fc::vm::actor::Actor;
+using fc::vm::actor::kAccountCodeCid;
+using fc::vm::actor::kEmptyObjectCid;
+using fc::vm::actor::kSendMethodNumber;
+using fc::vm::message::UnsignedMessage;
+using fc::vm::runtime::Env;
+using fc::vm::runtime::kInfiniteGas;
+using fc::vm::runtime::MessageTrace;
+using fc::vm::state::StateTreeImpl;
+
+struct TraceTest : testing::Test {
+  void SetUp() override {
+    StateTreeImpl tree{ipld};
+    Actor account{kAccountCodeCid, kEmptyObjectCid, 0, 10};
+    EXPECT_OUTCOME_TRUE_1(tree.set(from, account));
+    EXPECT_OUTCOME_TRUE_1(tree.set(to, account));
+    EXPECT_OUTCOME_TRUE(root, tree.flush());
+    Tipset tipset;
+    tipset.blks.push_back(kDefaultT<BlockHeader>());
+    tipset.blks[0].parent_state_root = root;
+    env = std::make_shared<Env>(nullptr, ipld, tipset);
+  }
+
+  UnsignedMessage transfer(uint64_t value) const {
+    return {to, from, 0, value, 0, kInfiniteGas, kSendMethodNumber, {}};
+  }
+
+  std::shared_ptr<InMemoryDatastore> ipld{
+      std::make_shared<InMemoryDatastore>()};
+  Address from{Address::makeFromId(100)};
+  Address to{Address::makeFromId(101)};
+  std::shared_ptr<Env> env;
+};
+
+/**
+ * @given env with traces
+ * @when apply value transfer
+ * @then trace of execution has one send with transfer and its gas
+ */
+TEST_F(TraceTest, Transfer) {
+  std::vector<MessageTrace> traces;
+  env->traces = &traces;
+  EXPECT_OUTCOME_TRUE_1(env->applyImplicitMessage(transfer(3)));
+  ASSERT_EQ(traces.size(), 1);
+  ASSERT_EQ(traces[0].sends.size(), 1);
+  auto &send{traces[0].sends[0]};
+  EXPECT_EQ(send.from, from);
+  EXPECT_EQ(send.to, to);
+  EXPECT_EQ(send.method, kSendMethodNumber);
+  EXPECT_EQ(send.value, 3);
+  EXPECT_EQ(send.depth, 0);
+  EXPECT_EQ(send.exit_code, VMExitCode::kOk);
+  EXPECT_EQ(send.gas_used, env->pricelist.onMethodInvocation(3, 0));
+}
+
+/**
+ * @given env with traces
+ * @when apply transfer of more than sender balance
+ * @then send is traced with exit code
+ */
+TEST_F(TraceTest, Failed) {
+  std::vector<MessageTrace> traces;
+  env->traces = &traces;
+  EXPECT_OUTCOME_ERROR(VMExitCode::kSendTransferInsufficient,
+                       env->applyImplicitMessage(transfer(30)));
+  ASSERT_EQ(traces.size(), 1);
+  ASSERT_EQ(traces[0].sends.size(), 1);
+  EXPECT_EQ(traces[0].sends[0].exit_code,
+            VMExitCode::kSendTransferInsufficient);
+}
@@ -63,6 +63,43 @@ TEST_F(StateTreeTest, SetRevert) {
   EXPECT_OUTCOME_ERROR(HamtError::kNotFound, tree_.get(kAddressId));
 }
 
+/**
+ * @given State tree with actor state and snapshot
+ * @when Change actor state and revert to snapshot
+ * @then Actor state is same as at snapshot
+ */
+TEST_F(StateTreeTest, SnapshotRevertTo) {
+  auto actor2 = kActor;
+  actor2.nonce = 4;
+  EXPECT_OUTCOME_TRUE_1(tree_.set(kAddressId, kActor));
+  auto snapshot = tree_.snapshot();
+  EXPECT_OUTCOME_TRUE_1(tree_.set(kAddressId, actor2));
+  EXPECT_OUTCOME_EQ(tree_.get(kAddressId), actor2);
+  EXPECT_OUTCOME_TRUE_1(tree_.revertTo(snapshot));
+  EXPECT_OUTCOME_EQ(tree_.get(kAddressId), kActor);
+  EXPECT_OUTCOME_TRUE_1(tree_.revertTo(0));
+  EXPECT_OUTCOME_ERROR(HamtError::kNotFound, tree_.get(kAddressId));
+}
+
+/**
+ * @given State tree with nested snapshots
+ * @when Revert inner snapshot and flush
+ * @then Only changes before inner snapshot are written
+ */
+TEST_F(StateTreeTest, NestedSnapshotFlush) {
+  auto address2 = Address::makeFromId(14);
+  auto outer = tree_.snapshot();
+  EXPECT_OUTCOME_TRUE_1(tree_.set(kAddressId, kActor));
+  auto inner = tree_.snapshot();
+  EXPECT_OUTCOME_TRUE_1(tree_.set(address2, kActor));
+  EXPECT_OUTCOME_TRUE_1(tree_.revertTo(inner));
+  EXPECT_OUTCOME_TRUE(cid, tree_.flush());
+  StateTreeImpl tree2{store_, cid};
+  EXPECT_OUTCOME_EQ(tree2.get(kAddressId), kActor);
+  EXPECT_OUTCOME_ERROR(HamtError::kNotFound, tree2.get(address2));
+  EXPECT_EQ(outer, 0);
+}
+
 /**
  * @given State tree and actor state
  * @when Register new actor address and state
@@ -75,3 +112,38 @@ TEST_F(StateTreeTest, RegisterNewAddressLookupId) {
   EXPECT_OUTCOME_EQ(tree->registerNewAddress(address), kAddressId);
   EXPECT_OUTCOME_EQ(tree->lookupId(address), kAddressId);
 }
+
+/**
+ * @given address registered after snapshot and looked up
+ * @when revert to snapshot
+ * @then address lookup fails, cached id of address is dropped
+ */
+TEST_F(StateTreeTest, RevertRegisterNewAddress) {
+  auto tree = setupInitActor(nullptr, 13);
+  Address address{fc::primitives::address::TESTNET,
+                  fc::primitives::address::ActorExecHash{}};
+  auto snapshot = tree->snapshot();
+  EXPECT_OUTCOME_EQ(tree->registerNewAddress(address), kAddressId);
+  EXPECT_OUTCOME_EQ(tree->lookupId(address), kAddressId);
+  EXPECT_OUTCOME_TRUE_1(tree->revertTo(snapshot));
+  EXPECT_FALSE(tree->lookupId(address));
+}
+
+/**
+ * @given actor flushed and read from tree
+ * @when set actor and revert to snapshot before set
+ * @then flushed actor state is read again
+ */
+TEST_F(StateTreeTest, CachedRead) {
+  EXPECT_OUTCOME_TRUE_1(tree_.set(kAddressId, kActor));
+  EXPECT_OUTCOME_TRUE(root, tree_.flush());
+  EXPECT_OUTCOME_EQ(tree_.get(kAddressId), kActor);
+  auto snapshot = tree_.snapshot();
+  auto actor2 = kActor;
+  actor2.nonce = 4;
+  EXPECT_OUTCOME_TRUE_1(tree_.set(kAddressId, actor2));
+  EXPECT_OUTCOME_EQ(tree_.get(kAddressId), actor2);
+  EXPECT_OUTCOME_TRUE_1(tree_.revertTo(snapshot));
+  EXPECT_OUTCOME_EQ(tree_.get(kAddressId), kActor);
+  EXPECT_OUTCOME_EQ(StateTreeImpl(store_, root).get(kAddressId), kActor);
+}
@@ -28,6 +28,13 @@ namespace fc::crypto::bls {
     MOCK_CONST_METHOD1(
         aggregateSignatures,
         outcome::result<Signature>(gsl::span<const Signature>));
+    MOCK_CONST_METHOD3(
+        verifyAggregate,
+        outcome::result<bool>(gsl::span<const gsl::span<const uint8_t>>,
+                              gsl::span<const PublicKey>,
+                              const Signature &));
+    MOCK_CONST_METHOD1(verifyBatch,
+                       outcome::result<bool>(gsl::span<const SignedData>));
   };
 }  // namespace fc::crypto::bls
 
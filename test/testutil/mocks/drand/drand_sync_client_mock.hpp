@@ -10,7 +10,7 @@
 
 #include "drand/client.hpp"
 
-fc::drand {
+namespace fc::drand {
   class DrandSyncClientMock : public DrandSyncClient {
    public:
     MOCK_METHOD1(publicRand,
@@ -20,8 +20,8 @@ fc::drand {
         publicRandStream,
         outcome::result<std::vector<PublicRandResponse>>(uint64_t round));
 
-    MOCK_METHOD0(group, outcome::result<GroupPacket>())
+    MOCK_METHOD0(group, outcome::result<GroupPacket>());
   };
-};
+}  // namespace fc::drand
 
 #endif  // CPP_FILECOIN_TEST_TESTUTIL_MOCKS_DRAND_DRAND_SYNC_CLIENT_MOCK_HPP
@@ -19,6 +19,14 @@ namespace fc::markets::pieceio {
                      const RegisteredProof &registered_proof,
                      const CID &payload_cid,
                      const Selector &selector));
+    MOCK_METHOD2(generatePieceCommitment,
+                 outcome::result<std::pair<CID, UnpaddedPieceSize>>(
+                     const RegisteredProof &registered_proof,
+                     const Buffer &piece));
+    MOCK_METHOD2(generatePieceCommitmentFromFile,
+                 outcome::result<std::pair<CID, UnpaddedPieceSize>>(
+                     const RegisteredProof &registered_proof,
+                     const std::string &path));
   };
 
 }  // namespace fc::markets::pieceio
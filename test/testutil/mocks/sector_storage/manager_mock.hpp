@@ -0,0 +1,113 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_TEST_TESTUTIL_MOCKS_SECTOR_STORAGE_MANAGER_MOCK_HPP
+#define CPP_FILECOIN_TEST_TESTUTIL_MOCKS_SECTOR_STORAGE_MANAGER_MOCK_HPP
+
+#include <gmock/gmock.h>
+
+#include "sector_storage/manager.hpp"
+
+namespace fc::sector_storage {
+  using LocalStorages = std::unordered_map<StorageID, std::string>;
+
+  class ManagerMock : public Manager {
+   public:
+    MOCK_METHOD2(checkProvable,
+                 outcome::result<std::vector<SectorId>>(
+                     RegisteredProof, gsl::span<const SectorId>));
+
+    MOCK_METHOD0(getSectorSize, SectorSize());
+
+    MOCK_METHOD6(ReadPiece,
+                 outcome::result<void>(proofs::PieceData,
+                                       const SectorId &,
+                                       UnpaddedByteIndex,
+                                       const UnpaddedPieceSize &,
+                                       const SealRandomness &,
+                                       const CID &));
+
+    MOCK_METHOD3(generateWinningPoSt,
+                 outcome::result<std::vector<PoStProof>>(
+                     ActorId, gsl::span<const SectorInfo>, PoStRandomness));
+
+    MOCK_METHOD2(prewarmWinningPoSt,
+                 outcome::result<void>(ActorId, gsl::span<const SectorInfo>));
+
+    MOCK_METHOD3(generateWindowPoSt,
+                 outcome::result<WindowPoStResponse>(
+                     ActorId, gsl::span<const SectorInfo>, PoStRandomness));
+
+    MOCK_METHOD3(sealPreCommit1,
+                 outcome::result<PreCommit1Output>(
+                     const SectorId &,
+                     const SealRandomness &,
+                     gsl::span<const PieceInfo>));
+
+    MOCK_METHOD2(sealPreCommit2,
+                 outcome::result<SectorCids>(const SectorId &,
+                                             const PreCommit1Output &));
+
+    MOCK_METHOD5(sealCommit1,
+                 outcome::result<Commit1Output>(const SectorId &,
+                                                const SealRandomness &,
+                                                const InteractiveRandomness &,
+                                                gsl::span<const PieceInfo>,
+                                                const SectorCids &));
+
+    MOCK_METHOD2(sealCommit2,
+                 outcome::result<Proof>(const SectorId &,
+                                        const Commit1Output &));
+
+    MOCK_METHOD5(sealPreCommit1Async,
+                 void(const SectorId &,
+                      const SealRandomness &,
+                      std::vector<PieceInfo>,
+                      const ReturnCb<PreCommit1Output> &,
+                      uint64_t));
+
+    MOCK_METHOD4(sealPreCommit2Async,
+                 void(const SectorId &,
+                      const PreCommit1Output &,
+                      const ReturnCb<SectorCids> &,
+                      uint64_t));
+
+    MOCK_METHOD7(sealCommit1Async,
+                 void(const SectorId &,
+                      const SealRandomness &,
+                      const InteractiveRandomness &,
+                      std::vector<PieceInfo>,
+                      const SectorCids &,
+                      const ReturnCb<Commit1Output> &,
+                      uint64_t));
+
+    MOCK_METHOD4(sealCommit2Async,
+                 void(const SectorId &,
+                      const Commit1Output &,
+                      const ReturnCb<Proof> &,
+                      uint64_t));
+
+    MOCK_METHOD1(finalizeSector, outcome::result<void>(const SectorId &));
+
+    MOCK_METHOD1(remove, outcome::result<void>(const SectorId &));
+
+    MOCK_METHOD4(addPiece,
+                 outcome::result<PieceInfo>(
+                     const SectorId &,
+                     gsl::span<const UnpaddedPieceSize>,
+                     const UnpaddedPieceSize &,
+                     const proofs::PieceData &));
+
+    MOCK_METHOD1(addLocalStorage, outcome::result<void>(const std::string &));
+
+    MOCK_METHOD1(addWorker, outcome::result<void>(std::shared_ptr<Worker>));
+
+    MOCK_METHOD0(getLocalStorages, outcome::result<LocalStorages>());
+
+    MOCK_METHOD1(getFsStat, outcome::result<FsStat>(StorageID));
+  };
+}  // namespace fc::sector_storage
+
+#endif  // CPP_FILECOIN_TEST_TESTUTIL_MOCKS_SECTOR_STORAGE_MANAGER_MOCK_HPP
@@ -22,6 +22,15 @@ namespace fc::sector_storage {
                                        const WorkerAction &,
                                        uint64_t));
 
+    MOCK_METHOD7(scheduleAsync,
+                 void(const SectorId &,
+                      const TaskType &,
+                      const std::shared_ptr<WorkerSelector> &,
+                      const WorkerAction &,
+                      const WorkerAction &,
+                      const ReturnCb<void> &,
+                      uint64_t));
+
     MOCK_METHOD1(doNewWorker, void(WorkerHandle *));
     void newWorker(std::unique_ptr<WorkerHandle> worker) {
       doNewWorker(worker.get());